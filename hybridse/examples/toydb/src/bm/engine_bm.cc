@@ -104,6 +104,21 @@ static void BM_EngineRunBatchWindowMultiAggWindow25Feature25(
     EngineRunBatchWindowMultiAggWindow25Feature25(
         &state, BENCHMARK, state.range(0), state.range(1));
 }
+static void BM_EngineRunBatchWindowMultiAggWindow25Feature25Generic(
+    benchmark::State& state) {  // NOLINT
+    EngineRunBatchWindowMultiAggWindow25Feature25WithTarget(
+        &state, BENCHMARK, state.range(0), state.range(1), "", false);
+}
+static void BM_EngineRunBatchWindowMultiAggWindow25Feature25Native(
+    benchmark::State& state) {  // NOLINT
+    EngineRunBatchWindowMultiAggWindow25Feature25WithTarget(
+        &state, BENCHMARK, state.range(0), state.range(1), "native", false);
+}
+static void BM_EngineRunBatchWindowMultiAggWindow25Feature25NativeFastMath(
+    benchmark::State& state) {  // NOLINT
+    EngineRunBatchWindowMultiAggWindow25Feature25WithTarget(
+        &state, BENCHMARK, state.range(0), state.range(1), "native", true);
+}
 
 static void BM_EngineSimpleSelectVarchar(benchmark::State& state) {  // NOLINT
     EngineSimpleSelectVarchar(&state, BENCHMARK);
@@ -275,6 +290,16 @@ BENCHMARK(BM_EngineRunBatchWindowMultiAggWindow25Feature25)
     ->Args({100, 100})
     ->Args({1000, 1000})
     ->Args({10000, 10000});
+// generic vs host cpu specialized code
+BENCHMARK(BM_EngineRunBatchWindowMultiAggWindow25Feature25Generic)
+    ->Args({1000, 1000})
+    ->Args({10000, 10000});
+BENCHMARK(BM_EngineRunBatchWindowMultiAggWindow25Feature25Native)
+    ->Args({1000, 1000})
+    ->Args({10000, 10000});
+BENCHMARK(BM_EngineRunBatchWindowMultiAggWindow25Feature25NativeFastMath)
+    ->Args({1000, 1000})
+    ->Args({10000, 10000});
 
 // batch engine window bm exclude current time
 BENCHMARK(BM_EngineRunBatchWindowSumFeature1ExcludeCurrentTime)
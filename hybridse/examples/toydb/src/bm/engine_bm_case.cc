@@ -147,13 +147,15 @@ static void EngineRequestMode(const std::string sql, MODE mode,
     }
 }
 
-static void EngineBatchMode(const std::string sql, MODE mode, int64_t limit_cnt,
-                            int64_t size, benchmark::State* state) {
+static void EngineBatchMode(
+    const std::string sql, MODE mode, int64_t limit_cnt, int64_t size,
+    benchmark::State* state,
+    const vm::EngineOptions& options = vm::EngineOptions()) {
     // prepare data into table
     InitializeNativeTarget();
     InitializeNativeTargetAsmPrinter();
     auto catalog = vm::BuildOnePkTableStorage(size);
-    Engine engine(catalog);
+    Engine engine(catalog, options);
     BatchRunSession session;
     base::Status query_status;
     engine.Get(sql, "db", session, query_status);
@@ -306,11 +308,8 @@ void EngineRunBatchWindowSumFeature5Window5(benchmark::State* state, MODE mode,
         std::to_string(limit_cnt) + ";";
     EngineBatchMode(sql, mode, limit_cnt, size, state);
 }
-void EngineRunBatchWindowMultiAggWindow25Feature25(benchmark::State* state,
-                                                   MODE mode, int64_t limit_cnt,
-                                                   int64_t size) {  // NOLINT
-    // prepare data into table
-    const std::string sql =
+static std::string WindowMultiAggWindow25Feature25Sql(int64_t limit_cnt) {
+    return
         "SELECT "
         "sum(col1) OVER w1 as w1_col1_sum, "
         "sum(col3) OVER (PARTITION BY col0 ORDER BY col5 ROWS_RANGE BETWEEN "
@@ -384,7 +383,21 @@ void EngineRunBatchWindowMultiAggWindow25Feature25(benchmark::State* state,
         "BETWEEN "
         "30d PRECEDING AND CURRENT ROW) limit " +
         std::to_string(limit_cnt) + ";";
-    EngineBatchMode(sql, mode, limit_cnt, size, state);
+}
+void EngineRunBatchWindowMultiAggWindow25Feature25(benchmark::State* state,
+                                                   MODE mode, int64_t limit_cnt,
+                                                   int64_t size) {  // NOLINT
+    EngineBatchMode(WindowMultiAggWindow25Feature25Sql(limit_cnt), mode,
+                    limit_cnt, size, state);
+}
+void EngineRunBatchWindowMultiAggWindow25Feature25WithTarget(
+    benchmark::State* state, MODE mode, int64_t limit_cnt, int64_t size,
+    const std::string& target_cpu, bool fast_math) {  // NOLINT
+    vm::EngineOptions options;
+    options.jit_options().SetTargetCpu(target_cpu);
+    options.jit_options().SetEnableFastMath(fast_math);
+    EngineBatchMode(WindowMultiAggWindow25Feature25Sql(limit_cnt), mode,
+                    limit_cnt, size, state, options);
 }
 
 void EngineWindowSumFeature5ExcludeCurrentTime(benchmark::State* state,
@@ -55,6 +55,10 @@ void EngineRunBatchWindowSumFeature5Window5(benchmark::State* state, MODE mode,
 void EngineRunBatchWindowMultiAggWindow25Feature25(benchmark::State* state,
                                                    MODE mode, int64_t limit_cnt,
                                                    int64_t size);  // NOLINT
+// compile the same query for the given jit target cpu, "" for the generic one
+void EngineRunBatchWindowMultiAggWindow25Feature25WithTarget(
+    benchmark::State* state, MODE mode, int64_t limit_cnt, int64_t size,
+    const std::string& target_cpu, bool fast_math);  // NOLINT
 void EngineRunBatchWindowSumFeature5(benchmark::State* state, MODE mode,
                                      int64_t limit_cnt,
                                      int64_t size);  // NOLINT
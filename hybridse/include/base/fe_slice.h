@@ -146,9 +146,9 @@ class RefCountedSlice : public Slice {
     RefCountedSlice() : Slice(nullptr, 0), ref_cnt_(nullptr) {}
 
     RefCountedSlice(const RefCountedSlice &slice);
-    RefCountedSlice(RefCountedSlice &&);
+    RefCountedSlice(RefCountedSlice &&) noexcept;
     RefCountedSlice &operator=(const RefCountedSlice &);
-    RefCountedSlice &operator=(RefCountedSlice &&);
+    RefCountedSlice &operator=(RefCountedSlice &&) noexcept;
 
  private:
     RefCountedSlice(int8_t *data, size_t size, bool managed)
@@ -40,6 +40,7 @@ struct RawBuffer {
         return true;
     }
 
+    RawBuffer() : addr(nullptr), size(0) {}
     RawBuffer(char* addr, size_t size) : addr(addr), size(size) {}
 };
 
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_INCLUDE_BASE_RING_BUFFER_H_
+#define HYBRIDSE_INCLUDE_BASE_RING_BUFFER_H_
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace hybridse {
+namespace base {
+
+// RingBuffer is a double-ended queue in one contiguous power-of-two buffer. Pushing and popping
+// at both ends doesn't allocate until the size outgrows the capacity, which suits the windows
+// sliding through the rows, where std::deque allocates and frees a chunk every few rows.
+// The buffer grows by doubling, so the references are invalidated by the pushes, as the
+// iterators of std::deque are.
+template <class T>
+class RingBuffer {
+ public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    template <bool kConst>
+    class Iterator {
+     public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<kConst, const T*, T*>::type;
+        using reference = typename std::conditional<kConst, const T&, T&>::type;
+        using Buffer = typename std::conditional<kConst, const RingBuffer, RingBuffer>::type;
+
+        Iterator() : buffer_(nullptr), pos_(0) {}
+        Iterator(Buffer* buffer, size_t pos) : buffer_(buffer), pos_(pos) {}
+        // the iterator converts to the const one
+        template <bool kOtherConst, class = typename std::enable_if<kConst && !kOtherConst>::type>
+        Iterator(const Iterator<kOtherConst>& other)  // NOLINT
+            : buffer_(other.buffer_), pos_(other.pos_) {}
+
+        reference operator*() const { return (*buffer_)[pos_]; }
+        pointer operator->() const { return &(*buffer_)[pos_]; }
+        reference operator[](difference_type n) const { return (*buffer_)[pos_ + n]; }
+
+        Iterator& operator++() {
+            ++pos_;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator it = *this;
+            ++pos_;
+            return it;
+        }
+        Iterator& operator--() {
+            --pos_;
+            return *this;
+        }
+        Iterator operator--(int) {
+            Iterator it = *this;
+            --pos_;
+            return it;
+        }
+        Iterator& operator+=(difference_type n) {
+            pos_ += n;
+            return *this;
+        }
+        Iterator& operator-=(difference_type n) {
+            pos_ -= n;
+            return *this;
+        }
+        Iterator operator+(difference_type n) const { return Iterator(buffer_, pos_ + n); }
+        Iterator operator-(difference_type n) const { return Iterator(buffer_, pos_ - n); }
+        friend Iterator operator+(difference_type n, const Iterator& it) { return it + n; }
+        difference_type operator-(const Iterator& other) const {
+            return static_cast<difference_type>(pos_) - static_cast<difference_type>(other.pos_);
+        }
+
+        bool operator==(const Iterator& other) const { return pos_ == other.pos_; }
+        bool operator!=(const Iterator& other) const { return pos_ != other.pos_; }
+        bool operator<(const Iterator& other) const { return pos_ < other.pos_; }
+        bool operator>(const Iterator& other) const { return pos_ > other.pos_; }
+        bool operator<=(const Iterator& other) const { return pos_ <= other.pos_; }
+        bool operator>=(const Iterator& other) const { return pos_ >= other.pos_; }
+
+     private:
+        friend class Iterator<!kConst>;
+        Buffer* buffer_;
+        // the position from the front, so the iterator follows the front when the buffer grows
+        size_t pos_;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    RingBuffer() : data_(nullptr), capacity_(0), head_(0), size_(0) {}
+
+    explicit RingBuffer(size_t capacity) : RingBuffer() { reserve(capacity); }
+
+    RingBuffer(std::initializer_list<T> values) : RingBuffer() {
+        reserve(values.size());
+        for (const auto& value : values) {
+            emplace_back(value);
+        }
+    }
+
+    RingBuffer(const RingBuffer& other) : RingBuffer() {
+        reserve(other.size_);
+        for (size_t i = 0; i < other.size_; i++) {
+            emplace_back(other[i]);
+        }
+    }
+
+    RingBuffer(RingBuffer&& other) noexcept
+        : data_(other.data_), capacity_(other.capacity_), head_(other.head_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.capacity_ = 0;
+        other.head_ = 0;
+        other.size_ = 0;
+    }
+
+    RingBuffer& operator=(const RingBuffer& other) {
+        if (this != &other) {
+            RingBuffer copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    RingBuffer& operator=(RingBuffer&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~RingBuffer() {
+        clear();
+        ::operator delete(data_);
+    }
+
+    void swap(RingBuffer& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(head_, other.head_);
+        std::swap(size_, other.size_);
+    }
+
+    // make room for n elements at least, the capacity is rounded up to a power of two
+    void reserve(size_t n) {
+        if (n <= capacity_) {
+            return;
+        }
+        size_t capacity = capacity_ == 0 ? kMinCapacity : capacity_;
+        while (capacity < n) {
+            capacity <<= 1;
+        }
+        T* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+        for (size_t i = 0; i < size_; i++) {
+            T& value = (*this)[i];
+            new (data + i) T(std::move_if_noexcept(value));
+            value.~T();
+        }
+        ::operator delete(data_);
+        data_ = data;
+        capacity_ = capacity;
+        head_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](size_t pos) { return data_[(head_ + pos) & (capacity_ - 1)]; }
+    const T& operator[](size_t pos) const { return data_[(head_ + pos) & (capacity_ - 1)]; }
+    T& at(size_t pos) {
+        CheckRange(pos);
+        return (*this)[pos];
+    }
+    const T& at(size_t pos) const {
+        CheckRange(pos);
+        return (*this)[pos];
+    }
+
+    T& front() { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T& back() { return (*this)[size_ - 1]; }
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            reserve(size_ + 1);
+        }
+        new (&data_[(head_ + size_) & (capacity_ - 1)]) T(std::forward<Args>(args)...);
+        size_++;
+    }
+
+    template <class... Args>
+    void emplace_front(Args&&... args) {
+        if (size_ == capacity_) {
+            reserve(size_ + 1);
+        }
+        size_t head = (head_ + capacity_ - 1) & (capacity_ - 1);
+        new (&data_[head]) T(std::forward<Args>(args)...);
+        head_ = head;
+        size_++;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    void pop_back() {
+        back().~T();
+        size_--;
+    }
+
+    void pop_front() {
+        front().~T();
+        head_ = (head_ + 1) & (capacity_ - 1);
+        size_--;
+    }
+
+    // the capacity is kept for the elements pushed later
+    void clear() {
+        while (!empty()) {
+            pop_back();
+        }
+        head_ = 0;
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+ private:
+    static const size_t kMinCapacity = 8;
+
+    void CheckRange(size_t pos) const {
+        if (pos >= size_) {
+            throw std::out_of_range("RingBuffer::at");
+        }
+    }
+
+    T* data_;
+    // a power of two, or 0 before the first element
+    size_t capacity_;
+    size_t head_;
+    size_t size_;
+};
+
+}  // namespace base
+}  // namespace hybridse
+#endif  // HYBRIDSE_INCLUDE_BASE_RING_BUFFER_H_
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_INCLUDE_BASE_SKETCH_H_
+#define HYBRIDSE_INCLUDE_BASE_SKETCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace hybridse {
+namespace base {
+
+// HyperLogLog estimates the number of distinct values in 2^kPrecision one byte registers, with a
+// relative standard error of 1.04 / sqrt(2^kPrecision), about 1.6%, whatever the number of values.
+// The sketches of the parts of the values merge into the sketch of all of them, so the sketches can
+// be kept per pre-aggregated bucket. The serialized sketch is sparse while few registers are set.
+class HyperLogLog {
+ public:
+    static const uint32_t kPrecision = 12;
+    static const uint32_t kRegisterCnt = 1u << kPrecision;
+
+    HyperLogLog() { Clear(); }
+
+    // add a value by its 64 bits hash, the bits of the hash should be well mixed
+    void AddHash(uint64_t hash);
+
+    void Merge(const HyperLogLog& other);
+
+    uint64_t Estimate() const;
+
+    void Clear();
+
+    void Serialize(std::string* output) const;
+
+    // return false if the data is not a serialized sketch
+    bool Deserialize(const char* data, size_t size);
+
+ private:
+    uint8_t registers_[kRegisterCnt];
+};
+
+// TDigest estimates the quantiles of the values with the merging t-digest of Dunning. The values are
+// clustered in about `compression` centroids at most, the centroids near both ends are kept small, so
+// the extreme quantiles are the most accurate, and the min and the max are exact. The values are
+// buffered and clustered in batches, and the digests of the parts of the values merge into the
+// digest of all of them.
+class TDigest {
+ public:
+    static constexpr double kDefaultCompression = 200;
+
+    explicit TDigest(double compression = kDefaultCompression);
+
+    void Add(double value, double weight = 1);
+
+    void Merge(const TDigest& other);
+
+    // the estimated value at quantile q in [0, 1], NaN if the digest is empty
+    double Quantile(double q);
+
+    double TotalWeight() const { return total_weight_; }
+
+    bool Empty() const { return total_weight_ <= 0; }
+
+    void Clear();
+
+    void Serialize(std::string* output);
+
+    // return false if the data is not a serialized digest
+    bool Deserialize(const char* data, size_t size);
+
+ private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    // cluster the buffered values into the centroids
+    void Compress();
+
+    // the quantile which the centroid starting at quantile q can grow up to
+    double QuantileLimit(double q) const;
+
+    double compression_;
+    std::vector<Centroid> centroids_;
+    std::vector<Centroid> buffer_;
+    // of both the centroids and the buffered values
+    double total_weight_;
+    double min_;
+    double max_;
+};
+
+}  // namespace base
+}  // namespace hybridse
+#endif  // HYBRIDSE_INCLUDE_BASE_SKETCH_H_
@@ -38,6 +38,10 @@ class Row {
     Row();
     explicit Row(const std::string &str);
     Row(const Row &s);
+    // the moved row is left empty, its slices are taken over without touching the counts
+    Row(Row &&s) noexcept;
+    Row &operator=(const Row &s);
+    Row &operator=(Row &&s) noexcept;
     explicit Row(size_t major_slices, const Row &major, size_t secondary_slices,
         const Row &secondary);
     explicit Row(const hybridse::base::RefCountedSlice &s, size_t secondary_slices,
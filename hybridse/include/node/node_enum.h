@@ -94,6 +94,7 @@ enum SqlNodeType {
     kCreateFunctionStmt,
     kDynamicUdfFnDef,
     kDynamicUdafFnDef,
+    kBroadcast,
     kUnknow = -1
 };
 
@@ -262,12 +263,15 @@ enum CmdType {
     kCmdShowTableStatus,
     kCmdShowFunctions,
     kCmdDropFunction,
+    kCmdShowDeploymentStats,
     kCmdFake,  // not a real cmd, for testing purpose only
     kLastCmd = kCmdFake,
 };
 enum ExplainType {
     kExplainLogical,
     kExplainPhysical,
+    // run the query once and show the statistics of its runners
+    kExplainAnalyze,
 };
 enum PlanType {
     kPlanTypeCmd,
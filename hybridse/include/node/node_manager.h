@@ -22,12 +22,15 @@
 #define HYBRIDSE_INCLUDE_NODE_NODE_MANAGER_H_
 
 #include <ctype.h>
+#include <cstddef>
 #include <list>
 #include <memory>
+#include <new>
 #include <string>
 #include <utility>
 #include <vector>
 #include "base/fe_object.h"
+#include "base/mem_pool.h"
 #include "node/batch_plan_node.h"
 #include "node/plan_node.h"
 #include "node/sql_node.h"
@@ -44,7 +47,7 @@ class NodeManager {
     ~NodeManager();
 
     int GetNodeListSize() {
-        int node_size = node_list_.size();
+        int node_size = node_list_.size() + arena_node_list_.size();
         DLOG(INFO) << "GetNodeListSize: " << node_size;
         return node_size;
     }
@@ -264,6 +267,7 @@ class NodeManager {
 
     // create a delete job node
     DeleteNode* MakeDeleteNode(DeleteTarget target, std::string_view job_id);
+    DeleteNode* MakeDeleteNode(const std::string& db_name, const std::string& table_name, const ExprNode* condition);
     DeletePlanNode* MakeDeletePlanNode(const DeleteNode* node);
 
     LoadDataNode *MakeLoadDataNode(const std::string &file_name, const std::string &db, const std::string &table,
@@ -383,6 +387,8 @@ class NodeManager {
 
     SqlNode *MakeStorageModeNode(StorageMode storage_mode);
 
+    SqlNode *MakeBroadcastNode(bool broadcast);
+
     SqlNode *MakePartitionNumNode(int num);
 
     SqlNode *MakeDistributionsNode(SqlNodeList *distribution_list);
@@ -395,6 +401,7 @@ class NodeManager {
                                     const std::string &column_name,
                                     DataType data_type);
 
+    // take the ownership of a node allocated by new
     template <typename T>
     T *RegisterNode(T *node_ptr) {
         node_list_.push_back(node_ptr);
@@ -402,6 +409,19 @@ class NodeManager {
         return node_ptr;
     }
 
+    // construct a node in the arena of the manager. The nodes of a sql are
+    // allocated one after another in the chucks of the arena and all freed
+    // with the manager, instead of one malloc and free for each of them
+    template <typename T, typename... Args>
+    T *MakeNode(Args &&...args) {
+        static_assert(alignof(T) <= kArenaAlign, "over aligned node");
+        void *addr = arena_.Alloc((sizeof(T) + kArenaAlign - 1) & ~(kArenaAlign - 1));
+        T *node_ptr = new (addr) T(std::forward<Args>(args)...);
+        arena_node_list_.push_back(node_ptr);
+        SetNodeUniqueId(node_ptr);
+        return node_ptr;
+    }
+
  private:
     ProjectNode *MakeProjectNode(const int32_t pos, const std::string &name,
                                  const bool is_aggregation,
@@ -418,7 +438,14 @@ class NodeManager {
         node->SetNodeId(other_node_idx_counter_++);
     }
 
-    std::list<base::FeBaseObject *> node_list_;
+    // the chucks of the arena are allocated by new char[], which are aligned
+    // to kArenaAlign, and every node is of a multiple of it
+    static constexpr size_t kArenaAlign = alignof(std::max_align_t);
+
+    std::vector<base::FeBaseObject *> node_list_;
+    // destroyed by the manager while their memory is released with arena_
+    std::vector<base::FeBaseObject *> arena_node_list_;
+    ::openmldb::base::ByteMemoryPool arena_;
 
     // unique id counter for various types of node
     size_t expr_idx_counter_ = 1;
@@ -57,6 +57,8 @@ inline const std::string ExplainTypeName(const ExplainType &explain_type) {
             return "logical";
         case kExplainPhysical:
             return "physical";
+        case kExplainAnalyze:
+            return "analyze";
         default: {
             return "Unknow";
         }
@@ -1853,6 +1855,20 @@ class StorageModeNode : public SqlNode {
     StorageMode storage_mode_;
 };
 
+class BroadcastNode : public SqlNode {
+ public:
+    explicit BroadcastNode(bool broadcast) : SqlNode(kBroadcast, 0, 0), broadcast_(broadcast) {}
+
+    ~BroadcastNode() {}
+
+    bool GetBroadcast() const { return broadcast_; }
+
+    void Print(std::ostream &output, const std::string &org_tab) const;
+
+ private:
+    bool broadcast_;
+};
+
 class CreateStmt : public SqlNode {
  public:
     CreateStmt()
@@ -2033,7 +2049,9 @@ class CmdNode : public SqlNode {
 };
 
 enum class DeleteTarget {
-    JOB
+    JOB,
+    // the keys of a table index, DELETE FROM table WHERE col = key or col IN (keys)
+    TABLE
 };
 std::string DeleteTargetString(DeleteTarget target);
 
@@ -2041,6 +2059,12 @@ class DeleteNode : public SqlNode {
  public:
     explicit DeleteNode(DeleteTarget t, std::string job_id)
     : SqlNode(kDeleteStmt, 0, 0), target_(t), job_id_(job_id) {}
+    DeleteNode(const std::string& db_name, const std::string& table_name, const ExprNode* condition)
+        : SqlNode(kDeleteStmt, 0, 0),
+          target_(DeleteTarget::TABLE),
+          db_name_(db_name),
+          table_name_(table_name),
+          condition_(condition) {}
     ~DeleteNode() {}
 
     void Print(std::ostream &output, const std::string &org_tab) const override;
@@ -2048,10 +2072,16 @@ class DeleteNode : public SqlNode {
 
     const DeleteTarget GetTarget() const { return target_; }
     const std::string& GetJobId() const { return job_id_; }
+    const std::string& GetDbName() const { return db_name_; }
+    const std::string& GetTableName() const { return table_name_; }
+    const ExprNode* GetCondition() const { return condition_; }
 
  private:
     const DeleteTarget target_;
     const std::string job_id_;
+    const std::string db_name_;
+    const std::string table_name_;
+    const ExprNode* condition_ = nullptr;
 };
 
 class SelectIntoNode : public SqlNode {
@@ -52,6 +52,36 @@ struct IndexSt {
     std::vector<ColInfo> keys;  ///< first keys set
 };
 
+/// Represents the statistics of an index, which tell how selective the index
+/// is when the planner chooses among the indexes of a table.
+struct IndexStatistics {
+    uint64_t key_count = 0;  ///< count of distinct keys
+    uint64_t row_count = 0;  ///< count of rows
+    int64_t min_ts = 0;      ///< the min ts of the sampled rows
+    int64_t max_ts = 0;      ///< the max ts of the sampled rows
+
+    /// Return the average count of rows of a key, 0 if there is no key
+    double AvgRowsPerKey() const {
+        return key_count == 0 ? 0
+                              : static_cast<double>(row_count) / key_count;
+    }
+};
+
+/// Represents a comparison of a column with a constant in a filter, which the
+/// storage may check on the encoded rows to skip the unmatched ones early.
+/// A row whose column is null never matches.
+struct ColumnPredicate {
+    enum Op { kEq, kNe, kLt, kLe, kGt, kGe };
+    /// the kind of the constant, the column is compared as this kind
+    enum ValueType { kIntValue, kDoubleValue, kStringValue };
+    size_t col_idx;       ///< column position in the table schema
+    Op op;                ///< `column op constant`
+    ValueType value_type;
+    int64_t int_value = 0;
+    double double_value = 0;
+    std::string str_value;
+};
+
 /// \typedef IndexList repeated fields of IndexDef
 typedef ::google::protobuf::RepeatedPtrField<::hybridse::type::IndexDef>
     IndexList;
@@ -238,6 +268,30 @@ class TableHandler : public DataHandler {
         return std::shared_ptr<PartitionHandler>();
     }
 
+    /// Return RowIterator over the rows, the rows unmatched by any of
+    /// `predicates` may be skipped.
+    /// Return GetIterator() by default.
+    virtual std::unique_ptr<RowIterator> GetFilteredIterator(
+        const std::vector<ColumnPredicate>& predicates) {
+        return GetIterator();
+    }
+
+    /// Return partition handler of specify partition binding to given index,
+    /// whose rows are read at the columns of `columns` only, so the other
+    /// columns can be left null.
+    /// Return GetPartition(index_name) by default.
+    virtual std::shared_ptr<PartitionHandler> GetPrunedPartition(
+        const std::string& index_name, const std::vector<size_t>& columns) {
+        return GetPartition(index_name);
+    }
+
+    /// Get the statistics of the index of given name.
+    /// Return false by default, which means the statistics are unknown.
+    virtual bool GetIndexStatistics(const std::string& index_name,
+                                    IndexStatistics* stats) {
+        return false;
+    }
+
     /// Return the name of handler and return "TableHandler" by default.
     const std::string GetHandlerTypeName() override { return "TableHandler"; }
 
@@ -357,6 +411,14 @@ class PartitionHandler : public TableHandler {
     /// segment-by-segment.
     virtual std::unique_ptr<WindowIterator> GetWindowIterator() = 0;
 
+    /// Return WindowIterator to iterate datasets segment-by-segment, the
+    /// rows unmatched by any of `predicates` may be skipped.
+    /// Return GetWindowIterator() by default.
+    virtual std::unique_ptr<WindowIterator> GetFilteredWindowIterator(
+        const std::vector<ColumnPredicate>& predicates) {
+        return GetWindowIterator();
+    }
+
     /// Return HandlerType::kPartitionHandler by default
     const HandlerType GetHanlderType() override { return kPartitionHandler; }
 
@@ -447,19 +509,21 @@ class Tablet {
     /// Return the name of tablet.
     virtual const std::string& GetName() const = 0;
     /// Return RowHandler by calling request-mode
-    /// query on subtask which is specified by task_id and sql string
+    /// query on subtask which is specified by task_id and sql string.
+    /// The subtask is aborted if not done in `timeout_ms`, 0 for no limit
     virtual std::shared_ptr<RowHandler> SubQuery(
         uint32_t task_id, const std::string& db, const std::string& sql,
         const hybridse::codec::Row& row, const bool is_procedure,
-        const bool is_debug) = 0;
+        const bool is_debug, const uint64_t timeout_ms) = 0;
     /// Return TableHandler by calling
     /// batch-request-mode query on subtask which is specified by task_id and
-    /// sql
+    /// sql. The subtask is aborted if not done in `timeout_ms`, 0 for no limit
     virtual std::shared_ptr<TableHandler> SubQuery(
         uint32_t task_id, const std::string& db, const std::string& sql,
         const std::set<size_t>& common_column_indices,
         const std::vector<Row>& in_rows, const bool request_is_common,
-        const bool is_procedure, const bool is_debug) = 0;
+        const bool is_procedure, const bool is_debug,
+        const uint64_t timeout_ms) = 0;
 };
 struct AggrTableInfo {
     std::string aggr_table;
@@ -17,6 +17,8 @@
 #ifndef HYBRIDSE_INCLUDE_VM_ENGINE_H_
 #define HYBRIDSE_INCLUDE_VM_ENGINE_H_
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <map>
 #include <memory>
 #include <mutex>  //NOLINT
@@ -34,7 +36,9 @@
 #include "proto/fe_common.pb.h"
 #include "vm/catalog.h"
 #include "vm/engine_context.h"
+#include "vm/memory_tracker.h"
 #include "vm/router.h"
+#include "vm/runner_profile.h"
 
 namespace hybridse {
 namespace vm {
@@ -42,8 +46,16 @@ namespace vm {
 using ::hybridse::codec::Row;
 
 inline constexpr const char* LONG_WINDOWS = "long_windows";
+// "true" to compile the query with fast math, see JitOptions::SetEnableFastMath
+inline constexpr const char* FAST_MATH = "fast_math";
 
 class Engine;
+class RunnerPool;
+class RequestWindowCache;
+class CompileWorker;
+class SharedJitCache;
+class SqlCompileInfo;
+struct SqlContext;
 /// \brief An options class for controlling engine behaviour.
 class EngineOptions {
  public:
@@ -103,6 +115,92 @@ class EngineOptions {
         return enable_batch_window_parallelization_;
     }
 
+    /// Set the count of threads to run a batch mode query with, default `1`.
+    /// The window, group aggregation and table project runners process the segments or rows of their input
+    /// across the threads and merge the results in order.
+    inline EngineOptions* SetBatchParallelism(uint32_t parallelism) {
+        batch_parallelism_ = parallelism;
+        return this;
+    }
+    /// Return the count of threads to run a batch mode query with.
+    inline uint32_t GetBatchParallelism() const { return batch_parallelism_; }
+
+    /// Set the bytes of rows a batch mode sort holds in memory, default `0` for no limit.
+    /// A sort passing the limit writes its rows in sorted runs to the spill dir and merges the runs
+    /// as the sorted table is read.
+    inline EngineOptions* SetBatchSortMemoryLimit(uint64_t bytes) {
+        batch_sort_memory_limit_ = bytes;
+        return this;
+    }
+    /// Return the bytes of rows a batch mode sort holds in memory.
+    inline uint64_t GetBatchSortMemoryLimit() const { return batch_sort_memory_limit_; }
+
+    /// Set the dir the batch mode sorts spill their runs to, default `/tmp`.
+    inline EngineOptions* SetSpillDir(const std::string& dir) {
+        spill_dir_ = dir;
+        return this;
+    }
+    /// Return the dir the batch mode sorts spill their runs to.
+    inline const std::string& GetSpillDir() const { return spill_dir_; }
+
+    /// Set the bytes the intermediate tables of one query may hold, default `0` for no limit.
+    /// A query passing the limit is aborted and its Run returns RUN_MEMORY_LIMIT_EXCEEDED.
+    inline EngineOptions* SetQueryMemoryLimit(uint64_t bytes) {
+        query_memory_limit_ = bytes;
+        return this;
+    }
+    /// Return the bytes the intermediate tables of one query may hold.
+    inline uint64_t GetQueryMemoryLimit() const { return query_memory_limit_; }
+
+    /// Set the bytes the intermediate tables of all the queries running on the engine may hold,
+    /// default `0` for no limit.
+    inline EngineOptions* SetTotalQueryMemoryLimit(uint64_t bytes) {
+        total_query_memory_limit_ = bytes;
+        return this;
+    }
+    /// Return the bytes the intermediate tables of all the queries running on the engine may hold.
+    inline uint64_t GetTotalQueryMemoryLimit() const { return total_query_memory_limit_; }
+
+    /// Set the count of threads to evaluate the independent windows of a request mode query with,
+    /// default `0` to evaluate them one after another in the calling thread.
+    /// The threads are shared by all the request queries of the engine.
+    inline EngineOptions* SetRequestParallelism(uint32_t parallelism) {
+        request_parallelism_ = parallelism;
+        return this;
+    }
+    /// Return the count of threads to evaluate the independent windows of a request mode query with.
+    inline uint32_t GetRequestParallelism() const { return request_parallelism_; }
+
+    /// Set the maximum number of request windows shared among the deployments, default `0` to disable it.
+    /// The deployments defining the same window on the same table and called with the same request row
+    /// reuse the window scanned for the first of them.
+    inline EngineOptions* SetRequestWindowCacheCapacity(uint32_t capacity) {
+        request_window_cache_capacity_ = capacity;
+        return this;
+    }
+    /// Return the maximum number of request windows shared among the deployments.
+    inline uint32_t GetRequestWindowCacheCapacity() const { return request_window_cache_capacity_; }
+
+    /// Set the milliseconds a shared request window is kept, default `1000`.
+    inline EngineOptions* SetRequestWindowCacheTtl(uint64_t ttl_ms) {
+        request_window_cache_ttl_ms_ = ttl_ms;
+        return this;
+    }
+    /// Return the milliseconds a shared request window is kept.
+    inline uint64_t GetRequestWindowCacheTtl() const { return request_window_cache_ttl_ms_; }
+
+    /// Set the run count after which a query compiled quickly is recompiled with full optimization,
+    /// default `0` to always compile with full optimization.
+    ///
+    /// If it is set, the first compile of a query skips the ir optimization so that a new deployment is
+    /// available sooner, and the hot ones are optimized in background then swapped in.
+    inline EngineOptions* SetTieredCompileThreshold(uint32_t threshold) {
+        tiered_compile_threshold_ = threshold;
+        return this;
+    }
+    /// Return the run count after which a query is recompiled with full optimization.
+    inline uint32_t GetTieredCompileThreshold() const { return tiered_compile_threshold_; }
+
     /// Set `true` to enable window column purning
     inline EngineOptions* SetEnableWindowColumnPruning(bool flag) {
         enable_window_column_pruning_ = flag;
@@ -120,6 +218,58 @@ class EngineOptions {
     /// Return the maximum number of entries we can hold for compiling cache.
     inline uint32_t GetMaxSqlCacheSize() const { return max_sql_cache_size_; }
 
+    /// Set the maximum estimated bytes of the compiled queries cached per db, default `0` to bound the cache
+    /// by the count of entries only.
+    inline EngineOptions* SetMaxSqlCacheBytes(uint64_t bytes) {
+        max_sql_cache_bytes_ = bytes;
+        return this;
+    }
+    /// Return the maximum estimated bytes of the compiled queries cached per db.
+    inline uint64_t GetMaxSqlCacheBytes() const { return max_sql_cache_bytes_; }
+
+    /// Set `true` to turn the literals compared in the WHERE clause of a batch mode query without parameters
+    /// into implicit parameters, default `false`.
+    ///
+    /// If it is set, the queries only differing in these literals share one compiled plan.
+    inline EngineOptions* SetEnableLiteralNormalization(bool flag) {
+        enable_literal_normalization_ = flag;
+        return this;
+    }
+    /// Return if the literals of batch mode queries are turned into implicit parameters.
+    inline bool IsEnableLiteralNormalization() const { return enable_literal_normalization_; }
+
+    /// Set `true` to share the jitted functions among the queries whose ir is identical, default `false`.
+    ///
+    /// If it is set, e.g. a deployment compiled in both request and batch request mode jits its functions
+    /// once, only the runners are built per mode.
+    inline EngineOptions* SetEnableSharedJit(bool flag) {
+        enable_shared_jit_ = flag;
+        return this;
+    }
+    /// Return if the jitted functions are shared among the queries whose ir is identical.
+    inline bool IsEnableSharedJit() const { return enable_shared_jit_; }
+
+    /// Set the maximum bytes of the code and data sections jitted for the cached queries of all dbs, default
+    /// `0` for no bound.
+    ///
+    /// If it is exceeded, the least recently used queries of the db holding the most jitted bytes are evicted
+    /// from cache, and their modules are released once no session runs them.
+    inline EngineOptions* SetMaxJitMemoryBytes(uint64_t bytes) {
+        max_jit_memory_bytes_ = bytes;
+        return this;
+    }
+    /// Return the maximum bytes of the code and data sections jitted for the cached queries.
+    inline uint64_t GetMaxJitMemoryBytes() const { return max_jit_memory_bytes_; }
+
+    /// Set `true` to project a block of rows in one call of the jitted function for the table projects of
+    /// batch mode, default `false`.
+    inline EngineOptions* SetEnableBlockProject(bool flag) {
+        enable_block_project_ = flag;
+        return this;
+    }
+    /// Return if a block of rows is projected in one call for the table projects of batch mode.
+    inline bool IsEnableBlockProject() const { return enable_block_project_; }
+
     /// Return JitOptions
     inline hybridse::vm::JitOptions& jit_options() { return jit_options_; }
 
@@ -132,7 +282,21 @@ class EngineOptions {
     bool enable_expr_optimize_;
     bool enable_batch_window_parallelization_;
     bool enable_window_column_pruning_;
+    uint32_t batch_parallelism_;
+    uint64_t batch_sort_memory_limit_;
+    std::string spill_dir_;
+    uint64_t query_memory_limit_;
+    uint64_t total_query_memory_limit_;
+    uint32_t request_parallelism_;
+    uint32_t request_window_cache_capacity_;
+    uint64_t request_window_cache_ttl_ms_;
+    uint32_t tiered_compile_threshold_;
     uint32_t max_sql_cache_size_;
+    uint64_t max_sql_cache_bytes_;
+    bool enable_literal_normalization_;
+    bool enable_shared_jit_;
+    uint64_t max_jit_memory_bytes_;
+    bool enable_block_project_;
     JitOptions jit_options_;
 };
 
@@ -183,20 +347,53 @@ class RunSession {
         options_ = options;
     }
 
+    /// Set the profile to record the time and rows of every runner to, null to disable profiling.
+    void SetProfile(const std::shared_ptr<RunnerProfile>& profile) { profile_ = profile; }
+    /// Return the profile of the runners, null if profiling is disabled.
+    const std::shared_ptr<RunnerProfile>& GetProfile() const { return profile_; }
+
+    /// The code Run returns if the deadline passes before the query is done.
+    static constexpr int32_t RUN_DEADLINE_EXCEEDED = -3;
+    /// Set the time the query should be done by, the runners abort once it passes. No deadline by default.
+    void SetDeadline(std::chrono::steady_clock::time_point deadline) { deadline_ = deadline; }
+    /// Return the time the query should be done by.
+    std::chrono::steady_clock::time_point GetDeadline() const { return deadline_; }
+
+    /// The code Run returns if the query is aborted as its intermediate tables pass the memory limit.
+    static constexpr int32_t RUN_MEMORY_LIMIT_EXCEEDED = -4;
+    /// Set the bytes the intermediate tables of the query may hold, `0` for no limit, and the tracker of all
+    /// the queries charged as well, null for none. It is done by the engine.
+    void SetMemoryLimit(uint64_t limit, MemoryTracker* parent) {
+        memory_limit_ = limit;
+        memory_tracker_ = parent;
+    }
+
  protected:
     std::shared_ptr<hybridse::vm::CompileInfo> compile_info_;
     hybridse::vm::EngineMode engine_mode_;
     bool is_debug_;
     std::string sp_name_;
     std::shared_ptr<const std::unordered_map<std::string, std::string>> options_ = nullptr;
+    std::shared_ptr<RunnerProfile> profile_ = nullptr;
+    std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
+    uint64_t memory_limit_ = 0;
+    MemoryTracker* memory_tracker_ = nullptr;
     friend Engine;
+
+    // whether the runs count the memory of the intermediate tables, for the limits or the peak of the profile
+    bool IsMemoryTracked() const { return memory_limit_ > 0 || memory_tracker_ != nullptr || profile_ != nullptr; }
 };
 
 /// \brief BatchRunSession is a kind of RunSession designed for batch mode query.
 class BatchRunSession : public RunSession {
  public:
     explicit BatchRunSession(bool mini_batch = false)
-        : RunSession(kBatchMode), parameter_schema_() {}
+        : RunSession(kBatchMode),
+          parameter_schema_(),
+          implicit_parameter_row_(),
+          parallelism_(1),
+          sort_memory_limit_(0),
+          spill_dir_() {}
     ~BatchRunSession() {}
     /// \brief Query sql with parameter row in batch mode.
     /// Query results will be returned as std::vector<Row> in output
@@ -211,8 +408,34 @@ class BatchRunSession : public RunSession {
     void SetParameterSchema(const codec::Schema& schema) { parameter_schema_ = schema; }
     /// Return query parameter schema.
     virtual const Schema& GetParameterSchema() const { return parameter_schema_; }
+    /// Set the count of threads to run the query with
+    void SetParallelism(uint32_t parallelism) { parallelism_ = parallelism; }
+    /// Return the count of threads to run the query with
+    uint32_t GetParallelism() const { return parallelism_; }
+    /// Set the bytes of rows a sort holds in memory before spilling to dir, `0` for no limit
+    void SetSortMemoryLimit(uint64_t bytes, const std::string& dir) {
+        sort_memory_limit_ = bytes;
+        spill_dir_ = dir;
+    }
  private:
+    // the literals of the query turned into parameters, used if no parameter row is given to Run
+    void SetImplicitParameter(const codec::Schema& schema, const Row& row) {
+        parameter_schema_ = schema;
+        implicit_parameter_row_ = row;
+    }
+    void ClearImplicitParameter() {
+        if (!implicit_parameter_row_.empty()) {
+            parameter_schema_.Clear();
+            implicit_parameter_row_ = Row();
+        }
+    }
+
     codec::Schema parameter_schema_;
+    Row implicit_parameter_row_;
+    uint32_t parallelism_;
+    uint64_t sort_memory_limit_;
+    std::string spill_dir_;
+    friend Engine;
 };
 
 /// \brief MockRequestRunSession is a kind of mock RuSession design for request query
@@ -247,7 +470,7 @@ class RequestRunSession : public RunSession {
     ///
     /// \param in_row request row
     /// \param output query result will be returned as Row in output
-    /// \return `0` if run successfully else negative integer
+    /// \return `0` if run successfully, RUN_DEADLINE_EXCEEDED if the deadline passes, else negative integer
     int32_t Run(const Row& in_row, Row* output);  // NOLINT
 
     /// \brief Run a task specified by task_id in request mode.
@@ -255,7 +478,7 @@ class RequestRunSession : public RunSession {
     /// \param task_id: task id of task
     /// \param in_row: request row
     /// \param[out] output: result is written to this variable
-    /// \return `0` if run successfully else negative integer
+    /// \return `0` if run successfully, RUN_DEADLINE_EXCEEDED if the deadline passes, else negative integer
     int32_t Run(uint32_t task_id, const Row& in_row, Row* output);  // NOLINT
 
     /// \brief Return the schema of request row
@@ -270,6 +493,18 @@ class RequestRunSession : public RunSession {
     virtual const std::string& GetRequestDbName() const {
         return compile_info_->GetRequestDbName();
     }
+    /// \brief Set the pool to evaluate the independent windows of the query with
+    void SetRunnerPool(const std::shared_ptr<RunnerPool>& runner_pool) { runner_pool_ = runner_pool; }
+    /// \brief Return the pool to evaluate the independent windows of the query with
+    const std::shared_ptr<RunnerPool>& GetRunnerPool() const { return runner_pool_; }
+    /// \brief Set the cache to share the windows of the query with other deployments
+    void SetWindowCache(const std::shared_ptr<RequestWindowCache>& window_cache) { window_cache_ = window_cache; }
+    /// \brief Return the cache to share the windows of the query with other deployments
+    const std::shared_ptr<RequestWindowCache>& GetWindowCache() const { return window_cache_; }
+
+ private:
+    std::shared_ptr<RunnerPool> runner_pool_;
+    std::shared_ptr<RequestWindowCache> window_cache_;
 };
 /// \brief BatchRequestRunSession is a kind of RunSession designed for batch request mode query.
 ///
@@ -295,14 +530,14 @@ class BatchRequestRunSession : public RunSession {
     /// \brief Run query in batch request mode.
     /// \param request_batch: a batch of request rows
     /// \param output: query results will be returned as std::vector<Row> in output
-    /// \return 0 if runs successfully else negative integer
+    /// \return 0 if runs successfully, RUN_DEADLINE_EXCEEDED if the deadline passes, else negative integer
     int32_t Run(const std::vector<Row>& request_batch, std::vector<Row>& output);  // NOLINT
 
     /// \brief Run a task specified by task_id in request mode.
     /// \param id: id of task
     /// \param request_batch: a batch of request rows
     /// \param output: query results will be returned as std::vector<Row> in output
-    /// \return 0 if runs successfully else negative integer
+    /// \return 0 if runs successfully, RUN_DEADLINE_EXCEEDED if the deadline passes, else negative integer
     int32_t Run(const uint32_t id, const std::vector<Row>& request_batch, std::vector<Row>& output);  // NOLINT
 
     /// \brief Add common column idx
@@ -331,6 +566,16 @@ struct ExplainOutput {
 };
 
 
+/// The memory a cached query holds.
+struct CompileInfoStat {
+    EngineMode mode;
+    std::string db;
+    std::string sql;
+    uint64_t code_bytes;          ///< The bytes of the jitted code sections
+    uint64_t data_bytes;          ///< The bytes of the jitted data sections
+    uint64_t ir_instruction_cnt;  ///< The count of ir instructions generated
+};
+
 /// \brief An engine is responsible to compile SQL on the specific Catalog.
 ///
 /// An engine can be used to `compile sql and explain the compiling result.
@@ -418,6 +663,40 @@ class Engine {
     /// \brief Get engine's options
     EngineOptions GetEngineOptions();
 
+    /// \brief Get the pool to evaluate the independent windows of request queries, null if it is disabled
+    const std::shared_ptr<RunnerPool>& GetRunnerPool() const { return runner_pool_; }
+
+    /// \brief Set the runner pool and the window cache of the engine to a request session.
+    ///
+    /// It is done by `Get`, and should be called if the compile info of the session is set directly,
+    /// e.g. from the procedure cache.
+    void InitRequestSession(RequestRunSession* session) const;
+
+    /// \brief Count a run of the compile info and return the compile info to run.
+    ///
+    /// It is done by `Get`, and should be called if the compile info of the session is set directly.
+    /// Once a quickly compiled info is run `tiered_compile_threshold` times, it is recompiled with
+    /// full optimization in background, and the optimized one is returned after it is ready.
+    std::shared_ptr<CompileInfo> RecordRun(const std::shared_ptr<CompileInfo>& info);
+
+    /// \brief Recompile a quickly compiled info with full optimization in background now, as if it were hot.
+    ///
+    /// It is for the queries which serve no run yet but should run at full speed once they do, e.g. the
+    /// deployments of a standby tablet. The optimized one is returned by `RecordRun` after it is ready.
+    void OptimizeInBackground(const std::shared_ptr<CompileInfo>& info);
+
+    /// \brief Return the memory held by the cached queries, the latest used first in every db.
+    std::vector<CompileInfoStat> GetCompileInfoStats();
+
+    /// \brief Return the bytes of the code and data sections of all the jitted modules alive.
+    static void GetJitMemory(uint64_t* code_bytes, uint64_t* data_bytes);
+
+    /// \brief Return the counts of the compile cache lookups hit and missed.
+    void GetCacheStats(uint64_t* hit_cnt, uint64_t* miss_cnt) const {
+        *hit_cnt = cache_hit_cnt_.load(std::memory_order_relaxed);
+        *miss_cnt = cache_miss_cnt_.load(std::memory_order_relaxed);
+    }
+
  private:
     bool GetDependentTables(const node::PlanNode* node, const std::string& default_db,
                             std::set<std::pair<std::string, std::string>>* db_tables, base::Status& status);  // NOLINT
@@ -427,6 +706,22 @@ class Engine {
     bool SetCacheLocked(const std::string& db, const std::string& sql,
                         EngineMode engine_mode,
                         std::shared_ptr<CompileInfo> info);
+    // evict the cold queries until the jitted bytes fit in the budget, mu_ should be held
+    void EvictJitLocked();
+    // look up the cache by `cache_key` and the options of session which change the code, and compile `sql` if
+    // missing
+    bool GetOrCompile(const std::string& sql, const std::string& cache_key, const std::string& db,
+                      RunSession& session, base::Status& status);  // NOLINT
+    // look up the cache by `cache_key` only and compile `sql` if missing
+    bool CompileOnMiss(const std::string& sql, const std::string& cache_key, const std::string& db,
+                       RunSession& session, base::Status& status);  // NOLINT
+    // turn the literals of the batch mode query into the implicit parameters of session, return the cache key
+    // of the normalized sql, or empty if the query is not normalized
+    std::string NormalizeImplicitParameter(const std::string& sql, BatchRunSession* session, std::string* normalized);
+
+    void InitSqlContext(SqlContext* sql_context);
+    bool Compile(SqlContext& sql_context, base::Status& status);  // NOLINT
+    void Recompile(std::shared_ptr<SqlCompileInfo> info);
 
     bool IsCompatibleCache(RunSession& session,  // NOLINT
                            std::shared_ptr<CompileInfo> info,
@@ -440,6 +735,15 @@ class Engine {
     EngineOptions options_;
     base::SpinMutex mu_;
     EngineLRUCache lru_cache_;
+    std::shared_ptr<RunnerPool> runner_pool_;
+    std::shared_ptr<RequestWindowCache> window_cache_;
+    // the memory of all the queries running, null if there is no total limit
+    std::unique_ptr<MemoryTracker> memory_tracker_;
+    std::unique_ptr<SharedJitCache> shared_jits_;
+    std::atomic<uint64_t> cache_hit_cnt_{0};
+    std::atomic<uint64_t> cache_miss_cnt_{0};
+    // destroyed first, so the running recompile never sees a destroyed member
+    std::unique_ptr<CompileWorker> compile_worker_;
 };
 
 /// \brief Local tablet is responsible to run a task locally.
@@ -463,12 +767,14 @@ class LocalTablet : public Tablet {
     /// \param row: request row
     /// \param is_procedure: whether sql is a procedure or not
     /// \param is_debug: whether printing debug information while running
+    /// \param timeout_ms: the task is aborted if not done in it, 0 for no limit
     /// \return result row as RowHandler pointer
     std::shared_ptr<RowHandler> SubQuery(uint32_t task_id,
                                          const std::string& db,
                                          const std::string& sql, const Row& row,
                                          const bool is_procedure,
-                                         const bool is_debug) override;
+                                         const bool is_debug,
+                                         const uint64_t timeout_ms) override;
 
     /// Run a task in batch-request mode locally
     /// \param task_id: id of task
@@ -479,12 +785,13 @@ class LocalTablet : public Tablet {
     /// \param request_is_common: whether request is common or not
     /// \param is_procedure: whether run procedure or not
     /// \param is_debug: whether printing debug information while running
+    /// \param timeout_ms: the task is aborted if not done in it, 0 for no limit
     /// \return result rows as TableHandler pointer
     virtual std::shared_ptr<TableHandler> SubQuery(
         uint32_t task_id, const std::string& db, const std::string& sql,
         const std::set<size_t>& common_column_indices,
         const std::vector<Row>& in_rows, const bool request_is_common,
-        const bool is_procedure, const bool is_debug);
+        const bool is_procedure, const bool is_debug, const uint64_t timeout_ms);
 
     /// Return the name of tablet
     const std::string& GetName() const { return name_; }
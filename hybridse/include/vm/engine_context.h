@@ -15,11 +15,13 @@
  */
 #ifndef HYBRIDSE_INCLUDE_VM_ENGINE_CONTEXT_H_
 #define HYBRIDSE_INCLUDE_VM_ENGINE_CONTEXT_H_
+#include <functional>
+#include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
-#include "boost/compute/detail/lru_cache.hpp"
+#include <unordered_map>
 #include "vm/physical_op.h"
 namespace hybridse {
 namespace vm {
@@ -63,6 +65,47 @@ class CompileInfo {
                                   const std::string& tab) = 0;
     virtual void DumpClusterJob(std::ostream& output,
                                 const std::string& tab) = 0;
+    /// the bytes of the code and data sections of the jitted module, 0 if unknown
+    virtual uint64_t GetJitCodeSize() const { return 0; }
+    virtual uint64_t GetJitDataSize() const { return 0; }
+    virtual uint64_t GetIRInstructionCount() const { return 0; }
+};
+
+/// \brief The lru cache of compile infos, bounded by the count of entries and the estimated bytes of them.
+///
+/// The latest entry is always kept even if it alone exceeds the bytes bound.
+class CompileInfoLRU {
+ public:
+    /// `max_bytes` is `0` to bound the cache by the count of entries only
+    CompileInfoLRU(size_t capacity, uint64_t max_bytes) : capacity_(capacity), max_bytes_(max_bytes), bytes_(0) {}
+
+    /// Return the entry and mark it as the latest used, null if missing.
+    std::shared_ptr<CompileInfo> Get(const std::string& key);
+    /// Insert or replace the entry, the least recently used ones are evicted if the cache is full.
+    void Insert(const std::string& key, const std::shared_ptr<CompileInfo>& info, uint64_t bytes);
+    bool Contains(const std::string& key) const { return index_.find(key) != index_.end(); }
+    size_t Size() const { return index_.size(); }
+    uint64_t GetBytes() const { return bytes_; }
+    /// The bytes of the code and data sections of the jitted modules of the entries.
+    uint64_t GetJitBytes() const;
+    /// Evict the least recently used entry, false if the cache is empty.
+    bool PopBack();
+    /// Visit the entries from the latest used one.
+    void ForEach(const std::function<void(const std::string&, const std::shared_ptr<CompileInfo>&)>& fn) const;
+
+ private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<CompileInfo> info;
+        uint64_t bytes;
+    };
+
+    size_t capacity_;
+    uint64_t max_bytes_;
+    uint64_t bytes_;
+    // the latest used first
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
 };
 
 /// @typedef EngineLRUCache
@@ -70,10 +113,7 @@ class CompileInfo {
 ///     - DB name
 ///       - SQL string
 ///           - CompileInfo
-typedef std::map<EngineMode,
-                std::map<std::string,
-                    boost::compute::detail::lru_cache<std::string, std::shared_ptr<CompileInfo>>>>
-    EngineLRUCache;
+typedef std::map<EngineMode, std::map<std::string, CompileInfoLRU>> EngineLRUCache;
 
 class CompileInfoCache {
  public:
@@ -101,11 +141,41 @@ class JitOptions {
     bool IsEnablePerf() const { return enable_perf_; }
     void SetEnablePerf(bool flag) { enable_perf_ = flag; }
 
+    // the directory to persist compiled objects of llvm jit, empty to disable
+    const std::string& GetObjectCacheDir() const { return object_cache_dir_; }
+    void SetObjectCacheDir(const std::string& dir) { object_cache_dir_ = dir; }
+
+    // false to skip the ir optimization and compile with the lowest codegen
+    // level, which makes the module available sooner but runs slower
+    bool IsEnableOpt() const { return enable_opt_; }
+    void SetEnableOpt(bool flag) { enable_opt_ = flag; }
+
+    // the count of threads to optimize and compile the partitions of one sql
+    // module with, 1 to compile the whole module in the calling thread
+    uint32_t GetCompileParallelism() const { return compile_parallelism_; }
+    void SetCompileParallelism(uint32_t parallelism) { compile_parallelism_ = parallelism; }
+
+    // the cpu to generate code for, "native" for the host cpu with all its
+    // features, e.g. avx2 and avx512, or a llvm cpu name, e.g. "x86-64" for
+    // the code runs on any x86-64 host. Empty to keep the default of llvm
+    const std::string& GetTargetCpu() const { return target_cpu_; }
+    void SetTargetCpu(const std::string& cpu) { target_cpu_ = cpu; }
+
+    // true to let the floating point math be reassociated and vectorized,
+    // the results may differ in the last bits and nan and inf are not kept
+    bool IsEnableFastMath() const { return enable_fast_math_; }
+    void SetEnableFastMath(bool flag) { enable_fast_math_ = flag; }
+
  private:
     bool enable_mcjit_ = false;
     bool enable_vtune_ = false;
     bool enable_gdb_ = false;
     bool enable_perf_ = false;
+    bool enable_opt_ = true;
+    uint32_t compile_parallelism_ = 1;
+    std::string object_cache_dir_;
+    std::string target_cpu_;
+    bool enable_fast_math_ = false;
 };
 }  // namespace vm
 }  // namespace hybridse
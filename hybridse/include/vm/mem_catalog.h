@@ -19,12 +19,15 @@
 
 #include <deque>
 #include <functional>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include "base/fe_slice.h"
+#include "base/ring_buffer.h"
 #include "codec/list_iterator_codec.h"
 #include "glog/logging.h"
 #include "vm/catalog.h"
@@ -54,7 +57,9 @@ struct DescComparor {
     }
 };
 
-typedef std::deque<std::pair<uint64_t, Row>> MemTimeTable;
+// the rows with their keys, in one ring buffer so that the windows sliding through the rows
+// don't allocate per row
+typedef base::RingBuffer<std::pair<uint64_t, Row>> MemTimeTable;
 typedef std::vector<Row> MemTable;
 typedef std::map<std::string, MemTimeTable, std::greater<std::string>>
     MemSegmentMap;
@@ -207,10 +212,10 @@ class MemTimeTableHandler : public TableHandler {
     inline const std::string& GetDatabase() { return db_; }
     std::unique_ptr<WindowIterator> GetWindowIterator(
         const std::string& idx_name);
-    void AddRow(const uint64_t key, const Row& v);
-    void AddFrontRow(const uint64_t key, const Row& v);
-    void PopBackRow();
-    void PopFrontRow();
+    virtual void AddRow(const uint64_t key, const Row& v);
+    virtual void AddFrontRow(const uint64_t key, const Row& v);
+    virtual void PopBackRow();
+    virtual void PopFrontRow();
     virtual const std::pair<uint64_t, Row>& GetFrontRow() {
         return table_.front();
     }
@@ -239,6 +244,155 @@ class MemTimeTableHandler : public TableHandler {
     OrderType order_type_;
 };
 
+class SlidingColumnAggState {
+ public:
+    virtual ~SlidingColumnAggState() {}
+};
+
+// the column aggregation of a window kept across the instances of the window. The value of the
+// row added to the window is folded in and the value of the row slid out is retracted, the sums
+// are updated in place and the min and max are the heads of monotonic deques, so each row costs
+// O(1) amortized instead of a reduction over the whole window per instance
+template <class V>
+class SlidingColumnAgg : public SlidingColumnAggState {
+ public:
+    // the integers are added as unsigned to wrap around as ReduceColumn does
+    using Acc = typename std::conditional<std::is_integral<V>::value, std::make_unsigned<V>,
+                                          std::common_type<V>>::type::type;
+
+    SlidingColumnAgg()
+        : begin_seq_(0),
+          values_(),
+          sum_(0),
+          fsum_(0.0),
+          cnt_(0),
+          mins_(),
+          maxs_(),
+          retract_cnt_(0),
+          minmax_dirty_(false) {}
+
+    // the sequences of the window rows folded in, see Window::begin_seq
+    uint64_t begin_seq() const { return begin_seq_; }
+    uint64_t end_seq() const { return begin_seq_ + values_.size(); }
+    uint64_t size() const { return values_.size(); }
+
+    void Reset(uint64_t seq) {
+        begin_seq_ = seq;
+        values_.clear();
+        sum_ = 0;
+        fsum_ = 0.0;
+        cnt_ = 0;
+        mins_.clear();
+        maxs_.clear();
+        retract_cnt_ = 0;
+        minmax_dirty_ = false;
+    }
+
+    // fold in the value of the newest row
+    void Add(V value, bool is_null) {
+        uint64_t seq = end_seq();
+        values_.emplace_back(value, is_null);
+        if (is_null) {
+            return;
+        }
+        sum_ += static_cast<Acc>(value);
+        fsum_ += static_cast<double>(value);
+        cnt_++;
+        if (!minmax_dirty_) {
+            PushMinMax(seq, value);
+        }
+    }
+
+    // retract the value of the oldest row
+    void RetractOldest() {
+        const auto& front = values_.front();
+        if (!front.second) {
+            sum_ -= static_cast<Acc>(front.first);
+            fsum_ -= static_cast<double>(front.first);
+            cnt_--;
+            retract_cnt_++;
+            if (!mins_.empty() && mins_.front().first == begin_seq_) {
+                mins_.pop_front();
+            }
+            if (!maxs_.empty() && maxs_.front().first == begin_seq_) {
+                maxs_.pop_front();
+            }
+        }
+        values_.pop_front();
+        begin_seq_++;
+    }
+
+    // retract the value of the newest row. The rows it evicted from the monotonic deques are
+    // lost, so the min and max are rebuilt from the values kept on the next Get
+    void RetractNewest() {
+        const auto& back = values_.back();
+        if (!back.second) {
+            sum_ -= static_cast<Acc>(back.first);
+            fsum_ -= static_cast<double>(back.first);
+            cnt_--;
+            retract_cnt_++;
+            minmax_dirty_ = true;
+        }
+        values_.pop_back();
+    }
+
+    // the same outputs as ColumnAgg reduces from the whole window
+    void Get(V* sum, double* fsum, int64_t* cnt, V* min, V* max) {
+        // the float sums drift with the retractions and the retracted infinities leave nans, so
+        // they are summed again once the window has been slid through, which keeps O(1) amortized
+        if (retract_cnt_ >= values_.size()) {
+            sum_ = 0;
+            fsum_ = 0.0;
+            for (const auto& value : values_) {
+                if (!value.second) {
+                    sum_ += static_cast<Acc>(value.first);
+                    fsum_ += static_cast<double>(value.first);
+                }
+            }
+            retract_cnt_ = 0;
+        }
+        if (minmax_dirty_) {
+            mins_.clear();
+            maxs_.clear();
+            for (uint64_t i = 0; i < values_.size(); i++) {
+                if (!values_[i].second) {
+                    PushMinMax(begin_seq_ + i, values_[i].first);
+                }
+            }
+            minmax_dirty_ = false;
+        }
+        *sum = static_cast<V>(sum_);
+        *fsum = fsum_;
+        *cnt = cnt_;
+        *min = mins_.empty() ? std::numeric_limits<V>::max() : mins_.front().second;
+        *max = maxs_.empty() ? std::numeric_limits<V>::lowest() : maxs_.front().second;
+    }
+
+ private:
+    void PushMinMax(uint64_t seq, V value) {
+        while (!mins_.empty() && !(mins_.back().second < value)) {
+            mins_.pop_back();
+        }
+        mins_.emplace_back(seq, value);
+        while (!maxs_.empty() && !(value < maxs_.back().second)) {
+            maxs_.pop_back();
+        }
+        maxs_.emplace_back(seq, value);
+    }
+
+    uint64_t begin_seq_;
+    // the value and the null flag of the rows from the oldest
+    std::deque<std::pair<V, bool>> values_;
+    Acc sum_;
+    double fsum_;
+    int64_t cnt_;
+    // the candidates of min and max with their sequences, increasing and decreasing from the oldest
+    std::deque<std::pair<uint64_t, V>> mins_;
+    std::deque<std::pair<uint64_t, V>> maxs_;
+    uint64_t retract_cnt_;
+    bool minmax_dirty_;
+};
+
 class Window : public MemTimeTableHandler {
  public:
     enum WindowFrameType {
@@ -249,9 +403,30 @@ class Window : public MemTimeTableHandler {
     Window()
         : MemTimeTableHandler(),
           exclude_current_time_(false),
-          instance_not_in_window_(false) {}
+          instance_not_in_window_(false),
+          begin_seq_(0),
+          end_seq_(0),
+          sliding_agg_(false),
+          sliding_aggs_() {}
     virtual ~Window() {}
 
+    void AddRow(const uint64_t key, const Row& row) override {
+        MemTimeTableHandler::AddRow(key, row);
+        ResetSlidingAgg();
+    }
+    void AddFrontRow(const uint64_t key, const Row& row) override {
+        MemTimeTableHandler::AddFrontRow(key, row);
+        end_seq_++;
+    }
+    void PopBackRow() override {
+        MemTimeTableHandler::PopBackRow();
+        begin_seq_++;
+    }
+    void PopFrontRow() override {
+        MemTimeTableHandler::PopFrontRow();
+        end_seq_--;
+    }
+
     std::unique_ptr<RowIterator> GetIterator() override {
         std::unique_ptr<vm::MemTimeTableIterator> it(
             new vm::MemTimeTableIterator(&table_, schema_));
@@ -286,9 +461,42 @@ class Window : public MemTimeTableHandler {
         exclude_current_time_ = flag;
     }
 
+    // whether the column aggregations of the window keep their states across the instances,
+    // it suits the windows slid through the rows of a key in order
+    const bool sliding_agg() const { return sliding_agg_; }
+    void set_sliding_agg(const bool flag) {
+        sliding_agg_ = flag;
+        sliding_aggs_.clear();
+    }
+
+    // the rows of the window are numbered in the order they are added to the front, the oldest
+    // row is begin_seq and the newest is end_seq - 1
+    uint64_t begin_seq() const { return begin_seq_; }
+    uint64_t end_seq() const { return end_seq_; }
+
+    template <class V>
+    SlidingColumnAgg<V>* GetSlidingColumnAgg(size_t slice_idx, size_t col_idx) {
+        auto& state = sliding_aggs_[std::make_pair(slice_idx, col_idx)];
+        if (!state) {
+            state.reset(new SlidingColumnAgg<V>());
+        }
+        return static_cast<SlidingColumnAgg<V>*>(state.get());
+    }
+
  protected:
+    // the rows added out of order are not tracked, the states start over
+    void ResetSlidingAgg() {
+        begin_seq_ = 0;
+        end_seq_ = table_.size();
+        sliding_aggs_.clear();
+    }
+
     bool exclude_current_time_;
     bool instance_not_in_window_;
+    uint64_t begin_seq_;
+    uint64_t end_seq_;
+    bool sliding_agg_;
+    std::map<std::pair<size_t, size_t>, std::unique_ptr<SlidingColumnAggState>> sliding_aggs_;
 };
 class WindowRange {
  public:
@@ -366,7 +574,20 @@ class WindowRange {
 class HistoryWindow : public Window {
  public:
     explicit HistoryWindow(const WindowRange& window_range)
-        : Window(), window_range_(window_range), current_history_buffer_() {}
+        : Window(), window_range_(window_range), current_history_buffer_() {
+        // the bounded windows don't grow the buffer after the first rows, one row more for the
+        // row buffered before the oldest one slides out
+        uint64_t rows = 0;
+        if (kFrameRows == window_range_.frame_type_) {
+            rows = window_range_.start_row_ + 1;
+        }
+        if (window_range_.max_size_ > 0 && (rows == 0 || window_range_.max_size_ < rows)) {
+            rows = window_range_.max_size_;
+        }
+        if (rows > 0) {
+            table_.reserve(rows < kMaxReservedRows ? rows + 1 : kMaxReservedRows);
+        }
+    }
     ~HistoryWindow() {}
     virtual void PopFrontData() {
         if (current_history_buffer_.empty()) {
@@ -464,6 +685,9 @@ class HistoryWindow : public Window {
             return BufferEffectiveWindow(key, row, start_ts);
         }
     }
+    // the larger windows grow the buffer as the rows come
+    static const uint64_t kMaxReservedRows = 4096;
+
     WindowRange window_range_;
     MemTimeTable current_history_buffer_;
 };
@@ -610,6 +834,8 @@ class MemPartitionHandler
     const std::string& GetDatabase() override;
     virtual std::unique_ptr<WindowIterator> GetWindowIterator();
     bool AddRow(const std::string& key, uint64_t ts, const Row& row);
+    // append the rows grouped under key, so a group built elsewhere is merged with one lookup of the key
+    void AddSegment(const std::string& key, MemTimeTable&& rows);
     void Sort(const bool is_asc);
     void Reverse();
     void Print();
@@ -772,6 +998,19 @@ size_t RowIterGetCurSliceSize(int8_t* iter, size_t idx);
 void RowIterDelete(int8_t* iter);
 int8_t* RowGetSlice(int8_t* row_ptr, size_t idx);
 size_t RowGetSliceSize(int8_t* row_ptr, size_t idx);
+
+// column aggregation interface for llvm. the non-null values of one column of the window
+// are copied into a contiguous buffer, then reduced into sum, sum as double, count of
+// non-null values, min and max. min and max are left unset if the count is 0. The windows
+// with sliding_agg slide the state of the column instead, see SlidingColumnAgg
+template <class V>
+void ColumnAgg(int8_t* input, size_t slice_idx, size_t col_idx, size_t offset, V* sum, double* fsum, int64_t* cnt,
+               V* min, V* max);
+
+// reduce n values with several independent lanes so that the loop can be vectorized, the
+// sum of integers wraps around as the row-wise codegen does
+template <class V>
+void ReduceColumn(const V* values, size_t n, V* sum, double* fsum, V* min, V* max);
 }  // namespace vm
 }  // namespace hybridse
 #endif  // HYBRIDSE_INCLUDE_VM_MEM_CATALOG_H_
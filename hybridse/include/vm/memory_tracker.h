@@ -0,0 +1,57 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_INCLUDE_VM_MEMORY_TRACKER_H_
+#define HYBRIDSE_INCLUDE_VM_MEMORY_TRACKER_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace hybridse {
+namespace vm {
+
+/// \brief MemoryTracker counts the bytes held by a query, or by all the queries of an engine, against a limit.
+///
+/// The tracker of a query charges its parent as well, and returns the bytes it holds to the parent when it
+/// is destroyed, so the parent counts the bytes of the queries running.
+class MemoryTracker {
+ public:
+    /// \brief Create a tracker of `limit` bytes, `0` for no limit, charging `parent` if it isn't null.
+    explicit MemoryTracker(uint64_t limit = 0, MemoryTracker* parent = nullptr);
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+    ~MemoryTracker();
+
+    /// \brief Charge `bytes`. Return false and charge nothing if the tracker or a parent would pass its limit.
+    bool Consume(uint64_t bytes);
+    /// \brief Return `bytes` charged before.
+    void Release(uint64_t bytes);
+
+    uint64_t GetUsed() const { return used_.load(std::memory_order_relaxed); }
+    /// \brief Return the most bytes held at once.
+    uint64_t GetPeak() const { return peak_.load(std::memory_order_relaxed); }
+    uint64_t GetLimit() const { return limit_; }
+
+ private:
+    const uint64_t limit_;
+    MemoryTracker* parent_;
+    std::atomic<uint64_t> used_;
+    std::atomic<uint64_t> peak_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_INCLUDE_VM_MEMORY_TRACKER_H_
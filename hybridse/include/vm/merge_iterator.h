@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_INCLUDE_VM_MERGE_ITERATOR_H_
+#define HYBRIDSE_INCLUDE_VM_MERGE_ITERATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "codec/list_iterator_codec.h"
+
+namespace hybridse {
+namespace vm {
+
+using hybridse::codec::Row;
+using hybridse::codec::RowIterator;
+
+/**
+ * Merge the rows of the iterators ordered by key descending, as the
+ * rows of a window, e.g. the parts of one window in several tables or
+ * partitions. A row of an earlier iterator goes first on a tie.
+ *
+ * The iterators with a row are kept in a binary heap by their current
+ * key, so a row costs O(log k) instead of comparing all k iterators.
+ * Next sifts the advanced iterator down from the top, which stops after
+ * the first comparison while it keeps the largest key, so a run of rows
+ * from the same iterator costs one comparison per row.
+ */
+class MergeRowIterator : public RowIterator {
+ public:
+    explicit MergeRowIterator(std::vector<std::unique_ptr<RowIterator>> iters);
+    ~MergeRowIterator() override {}
+
+    bool Valid() const override { return !heap_.empty(); }
+    void Next() override;
+    const uint64_t& GetKey() const override { return iters_[heap_.front()]->GetKey(); }
+    const Row& GetValue() override { return iters_[heap_.front()]->GetValue(); }
+    // move every iterator to its first row not greater than key
+    void Seek(const uint64_t& key) override;
+    void SeekToFirst() override;
+    bool IsSeekable() const override;
+
+ private:
+    // whether the row of iterator a goes before the one of b
+    bool Before(size_t a, size_t b) const;
+    void SiftDown(size_t pos);
+    void Rebuild();
+
+ private:
+    std::vector<std::unique_ptr<RowIterator>> iters_;
+    // the indexes of the valid iterators, the front is the one of the current row
+    std::vector<size_t> heap_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+
+#endif  // HYBRIDSE_INCLUDE_VM_MERGE_ITERATOR_H_
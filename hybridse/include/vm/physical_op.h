@@ -108,6 +108,8 @@ class FnInfo {
         frames_.clear();
         schemas_ctx_ = nullptr;
         fn_ptr_ = nullptr;
+        block_fn_name_ = "";
+        block_fn_ptr_ = nullptr;
     }
 
     const node::FrameNode *GetFrame(size_t idx) const {
@@ -123,6 +125,12 @@ class FnInfo {
     const int8_t *fn_ptr() const { return fn_ptr_; }
     void SetFnPtr(const int8_t *fn) { fn_ptr_ = fn; }
 
+    // the function projecting a block of rows in one call, empty if not generated
+    const std::string &block_fn_name() const { return block_fn_name_; }
+    void SetBlockFnName(const std::string &name) { block_fn_name_ = name; }
+    const int8_t *block_fn_ptr() const { return block_fn_ptr_; }
+    void SetBlockFnPtr(const int8_t *fn) { block_fn_ptr_ = fn; }
+
  private:
     std::string fn_name_ = "";
     vm::Schema fn_schema_;
@@ -139,6 +147,9 @@ class FnInfo {
 
     // function ptr
     const int8_t *fn_ptr_ = nullptr;
+
+    std::string block_fn_name_ = "";
+    const int8_t *block_fn_ptr_ = nullptr;
 };
 
 class FnComponent {
@@ -193,8 +204,9 @@ class Sort : public FnComponent {
 
 class Range : public FnComponent {
  public:
-    Range() : range_key_(nullptr), frame_(nullptr) {}
-    Range(const node::OrderByNode *order, const node::FrameNode *frame) : range_key_(nullptr), frame_(frame) {
+    Range() : range_key_(nullptr), frame_(nullptr), rows_bound_(0) {}
+    Range(const node::OrderByNode *order, const node::FrameNode *frame)
+        : range_key_(nullptr), frame_(frame), rows_bound_(0) {
         range_key_ = nullptr == order ? nullptr
                      : node::ExprListNullOrEmpty(order->order_expressions_)
                          ? nullptr
@@ -232,6 +244,10 @@ class Range : public FnComponent {
         range_key_ = range_key;
     }
     const node::FrameNode *frame() const { return frame_; }
+    // the number of the newest rows of the window read by the projects over it, 0 if they may read
+    // all of the rows. The scan of the window stops there, as it does at the max size of the frame
+    uint64_t rows_bound() const { return rows_bound_; }
+    void set_rows_bound(uint64_t rows_bound) { rows_bound_ = rows_bound; }
     const std::string FnDetail() const { return "range=" + fn_info_.fn_name(); }
 
     void ResolvedRelatedColumns(std::vector<const node::ExprNode *> *) const;
@@ -241,6 +257,7 @@ class Range : public FnComponent {
 
     const node::ExprNode *range_key_;
     const node::FrameNode *frame_;
+    uint64_t rows_bound_;
 };
 
 class ConditionFilter : public FnComponent {
@@ -1496,12 +1513,14 @@ class PhysicalRequestAggUnionNode : public PhysicalOpNode {
     PhysicalRequestAggUnionNode(PhysicalOpNode *request, PhysicalOpNode *raw, PhysicalOpNode *aggr,
                                 const RequestWindowOp &window, const RequestWindowOp &aggr_window,
                                 bool instance_not_in_window, bool exclude_current_time, bool output_request_row,
-                                const node::FnDefNode *func, const node::ExprNode* agg_col)
+                                const node::FnDefNode *func, const node::ExprNode* agg_col,
+                                const node::ExprNode* cond = nullptr)
         : PhysicalOpNode(kPhysicalOpRequestAggUnion, true),
           window_(window),
           agg_window_(aggr_window),
           func_(func),
           agg_col_(agg_col),
+          cond_(cond),
           instance_not_in_window_(instance_not_in_window),
           exclude_current_time_(exclude_current_time),
           output_request_row_(output_request_row) {
@@ -1536,6 +1555,17 @@ class PhysicalRequestAggUnionNode : public PhysicalOpNode {
     const bool output_request_row() const { return output_request_row_; }
     const RequestWindowOp &window() const { return window_; }
 
+    // add the pre-aggr table of a coarser bucket level, which becomes the next producer
+    void AddAggrLevel(PhysicalOpNode *aggr, const RequestWindowOp &aggr_window) {
+        level_agg_windows_.push_back(aggr_window);
+        auto &window = level_agg_windows_.back();
+        fn_infos_.push_back(&window.partition_.fn_info());
+        fn_infos_.push_back(&window.sort_.fn_info());
+        fn_infos_.push_back(&window.range_.fn_info());
+        fn_infos_.push_back(&window.index_key_.fn_info());
+        AddProducer(aggr);
+    }
+
     base::Status WithNewChildren(node::NodeManager *nm,
                                  const std::vector<PhysicalOpNode *> &children,
                                  PhysicalOpNode **out) override {
@@ -1544,8 +1574,12 @@ class PhysicalRequestAggUnionNode : public PhysicalOpNode {
 
     RequestWindowOp window_;
     RequestWindowOp agg_window_;
+    // the windows of the coarser pre-aggr tables of producers()[3...], std::list keeps the fn_infos_ valid
+    std::list<RequestWindowOp> level_agg_windows_;
     const node::FnDefNode* func_ = nullptr;
     const node::ExprNode* agg_col_;
+    // the bool column of the *_where functions, null for the others
+    const node::ExprNode* cond_ = nullptr;
     const SchemasContext* parent_schema_context_ = nullptr;
 
  private:
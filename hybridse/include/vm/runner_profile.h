@@ -0,0 +1,73 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_INCLUDE_VM_RUNNER_PROFILE_H_
+#define HYBRIDSE_INCLUDE_VM_RUNNER_PROFILE_H_
+
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace hybridse {
+namespace vm {
+
+/// \brief The statistics of one runner node aggregated over the runs of a query.
+struct RunnerStat {
+    int64_t id = 0;
+    std::string type;
+    /// the count of runs, the cache hits are not counted
+    uint64_t run_cnt = 0;
+    /// the wall time of the runner itself, its producers excluded
+    uint64_t time_us = 0;
+    /// the rows of all inputs, a partition input counts its segments. the rows and the tables materialized by the
+    /// runners are counted, not the lazy tables and partitions over the storage
+    uint64_t rows_in = 0;
+    uint64_t rows_out = 0;
+    uint64_t bytes_out = 0;
+};
+
+/// \brief RunnerProfile aggregates the statistics of the runner nodes of a query, e.g. a deployment.
+///
+/// It is opt-in as counting the rows iterates the tables materialized by the runners.
+class RunnerProfile {
+ public:
+    RunnerProfile() = default;
+    RunnerProfile(const RunnerProfile&) = delete;
+    RunnerProfile& operator=(const RunnerProfile&) = delete;
+
+    void Add(int64_t id, const std::string& type, uint64_t time_us, uint64_t rows_in, uint64_t rows_out,
+             uint64_t bytes_out);
+
+    /// Return the statistics ordered by the runner id
+    std::vector<RunnerStat> GetStats() const;
+
+    /// Keep the most bytes the intermediate tables of a run held
+    void UpdatePeakMemory(uint64_t bytes);
+    /// Return the most bytes the intermediate tables of the runs held
+    uint64_t GetPeakMemory() const;
+
+    void Clear();
+
+ private:
+    mutable std::mutex mu_;
+    std::map<int64_t, RunnerStat> stats_;
+    uint64_t peak_memory_ = 0;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_INCLUDE_VM_RUNNER_PROFILE_H_
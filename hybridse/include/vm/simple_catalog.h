@@ -45,6 +45,13 @@ class SimpleCatalogTableHandler : public TableHandler {
 
     const IndexHint &GetIndex() override;
 
+    bool GetIndexStatistics(const std::string &index_name,
+                            IndexStatistics *stats) override;
+
+    /// Set the statistics of the index, which are unknown by default
+    void SetIndexStatistics(const std::string &index_name,
+                            const IndexStatistics &stats);
+
     std::unique_ptr<hybridse::codec::WindowIterator> GetWindowIterator(
         const std::string &) override;
 
@@ -75,6 +82,7 @@ class SimpleCatalogTableHandler : public TableHandler {
     hybridse::type::TableDef table_def_;
     Types types_dict_;
     IndexHint index_hint_;
+    std::map<std::string, IndexStatistics> index_stats_;
     codec::RowView row_view_;
     std::map<std::string, std::shared_ptr<MemPartitionHandler>> table_storage;
     std::shared_ptr<MemTableHandler> full_table_storage_;
@@ -44,8 +44,11 @@ RefCountedSlice::RefCountedSlice(const RefCountedSlice& slice) {
     this->Update(slice);
 }
 
-RefCountedSlice::RefCountedSlice(RefCountedSlice&& slice) {
-    this->Update(slice);
+RefCountedSlice::RefCountedSlice(RefCountedSlice&& slice) noexcept
+    : Slice(slice.data(), slice.size()), ref_cnt_(slice.ref_cnt_) {
+    // the reference is taken over without touching the count
+    slice.reset(nullptr, 0);
+    slice.ref_cnt_ = nullptr;
 }
 
 RefCountedSlice& RefCountedSlice::operator=(const RefCountedSlice& slice) {
@@ -57,12 +60,15 @@ RefCountedSlice& RefCountedSlice::operator=(const RefCountedSlice& slice) {
     return *this;
 }
 
-RefCountedSlice& RefCountedSlice::operator=(RefCountedSlice&& slice) {
+RefCountedSlice& RefCountedSlice::operator=(RefCountedSlice&& slice) noexcept {
     if (&slice == this) {
         return *this;
     }
     this->Release();
-    this->Update(slice);
+    reset(slice.data(), slice.size());
+    this->ref_cnt_ = slice.ref_cnt_;
+    slice.reset(nullptr, 0);
+    slice.ref_cnt_ = nullptr;
     return *this;
 }
 
@@ -53,6 +53,30 @@ TEST_F(MemPoolTest, ByteMemoryPoolTest) {
         ASSERT_EQ("helloworldhybri", std::string(s3, 15));
     }
 }
+
+TEST_F(MemPoolTest, ByteMemoryPoolRecycleTest) {
+    ::openmldb::base::ByteMemoryPool mem_pool;
+    char* s1 = mem_pool.Alloc(10);
+    mem_pool.Alloc(::openmldb::base::MemoryChunk::DEFAULT_CHUCK_SIZE);
+    // the chucks are reused after recycle
+    mem_pool.Recycle(2 * ::openmldb::base::MemoryChunk::DEFAULT_CHUCK_SIZE);
+    char* s2 = mem_pool.Alloc(10);
+    char* s3 = mem_pool.Alloc(::openmldb::base::MemoryChunk::DEFAULT_CHUCK_SIZE);
+    ASSERT_EQ(s1, s2);
+    ASSERT_NE(nullptr, s3);
+    memcpy(s2, "helloworld", 10);
+    ASSERT_EQ("helloworld", std::string(s2, 10));
+
+    // the chucks beyond the retained size are deleted
+    mem_pool.Recycle(0);
+    char* s4 = mem_pool.Alloc(20);
+    memcpy(s4, "helloworldhelloworld", 20);
+    ASSERT_EQ("helloworldhelloworld", std::string(s4, 20));
+    mem_pool.Reset();
+    char* s5 = mem_pool.Alloc(5);
+    memcpy(s5, "hello", 5);
+    ASSERT_EQ("hello", std::string(s5, 5));
+}
 }  // namespace base
 }  // namespace hybridse
 
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/ring_buffer.h"
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace base {
+
+class RingBufferTest : public ::testing::Test {};
+
+TEST_F(RingBufferTest, PushPop) {
+    RingBuffer<int> buffer(3);
+    ASSERT_EQ(8u, buffer.capacity());
+    ASSERT_TRUE(buffer.empty());
+    // wraps around the end of the buffer without growing
+    for (int i = 0; i < 100; i++) {
+        buffer.push_front(i);
+        if (buffer.size() > 4) {
+            buffer.pop_back();
+        }
+        ASSERT_EQ(i, buffer.front());
+    }
+    ASSERT_EQ(8u, buffer.capacity());
+    ASSERT_EQ(4u, buffer.size());
+    ASSERT_EQ(96, buffer.back());
+    ASSERT_EQ(97, buffer.at(2));
+    ASSERT_THROW(buffer.at(4), std::out_of_range);
+
+    // grows with the elements kept in order
+    for (int i = 100; i < 120; i++) {
+        buffer.emplace_back(i);
+    }
+    ASSERT_EQ(32u, buffer.capacity());
+    ASSERT_EQ(24u, buffer.size());
+    ASSERT_EQ(99, buffer.front());
+    ASSERT_EQ(96, buffer[3]);
+    ASSERT_EQ(119, buffer.back());
+    buffer.clear();
+    ASSERT_TRUE(buffer.empty());
+    ASSERT_EQ(32u, buffer.capacity());
+}
+
+TEST_F(RingBufferTest, SameAsDeque) {
+    RingBuffer<std::pair<uint64_t, std::shared_ptr<std::string>>> buffer;
+    std::deque<std::pair<uint64_t, std::shared_ptr<std::string>>> expect;
+    uint64_t seed = 1;
+    for (int i = 0; i < 10000; i++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t value = (seed >> 33) % 1000;
+        auto str = std::make_shared<std::string>(std::to_string(value));
+        switch ((seed >> 20) % 5) {
+            case 0:
+                buffer.emplace_back(value, str);
+                expect.emplace_back(value, str);
+                break;
+            case 1:
+            case 2:
+                buffer.emplace_front(value, str);
+                expect.emplace_front(value, str);
+                break;
+            case 3:
+                if (!expect.empty()) {
+                    buffer.pop_back();
+                    expect.pop_back();
+                }
+                break;
+            default:
+                if (!expect.empty()) {
+                    buffer.pop_front();
+                    expect.pop_front();
+                }
+                break;
+        }
+        ASSERT_EQ(expect.size(), buffer.size());
+        if (i % 1000 == 0) {
+            std::sort(buffer.begin(), buffer.end());
+            std::sort(expect.begin(), expect.end());
+            std::reverse(buffer.begin(), buffer.end());
+            std::reverse(expect.begin(), expect.end());
+        }
+    }
+    auto copy = buffer;
+    RingBuffer<std::pair<uint64_t, std::shared_ptr<std::string>>> moved(std::move(copy));
+    ASSERT_TRUE(copy.empty());
+    const auto& result = moved;
+    ASSERT_EQ(static_cast<std::ptrdiff_t>(expect.size()), result.cend() - result.cbegin());
+    size_t pos = 0;
+    for (auto iter = result.cbegin(); iter != result.cend(); ++iter) {
+        ASSERT_EQ(expect[pos].first, iter->first);
+        ASSERT_EQ(expect[pos].second, iter->second);
+        pos++;
+    }
+    // the elements are released with the buffer
+    std::weak_ptr<std::string> ref = expect.front().second;
+    expect.clear();
+    buffer.clear();
+    moved.clear();
+    ASSERT_TRUE(ref.expired());
+}
+
+}  // namespace base
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
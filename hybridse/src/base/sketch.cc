@@ -0,0 +1,290 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/sketch.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hybridse {
+namespace base {
+
+namespace {
+// the formats of the serialized sketches
+const uint8_t kHllDense = 1;
+const uint8_t kHllSparse = 2;
+const uint8_t kTDigestV1 = 1;
+
+// the rank of a hash is at most the number of the bits left out of the register index, plus one
+const uint8_t kMaxRank = 64 - HyperLogLog::kPrecision + 1;
+
+template <typename T>
+void Append(std::string* output, T value) {
+    output->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T Load(const char* data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+}  // namespace
+
+void HyperLogLog::AddHash(uint64_t hash) {
+    uint32_t idx = hash >> (64 - kPrecision);
+    uint64_t rest = hash << kPrecision;
+    uint8_t rank = rest == 0 ? kMaxRank : __builtin_clzll(rest) + 1;
+    if (registers_[idx] < rank) {
+        registers_[idx] = rank;
+    }
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+    for (uint32_t i = 0; i < kRegisterCnt; i++) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+uint64_t HyperLogLog::Estimate() const {
+    double sum = 0;
+    uint32_t zeros = 0;
+    for (uint32_t i = 0; i < kRegisterCnt; i++) {
+        sum += std::ldexp(1.0, -registers_[i]);
+        zeros += registers_[i] == 0;
+    }
+    double m = kRegisterCnt;
+    double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    // the raw estimate is biased for the small cardinalities, count by the empty registers then
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / zeros);
+    }
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+void HyperLogLog::Clear() { memset(registers_, 0, sizeof(registers_)); }
+
+void HyperLogLog::Serialize(std::string* output) const {
+    output->clear();
+    uint32_t non_zeros = 0;
+    for (uint32_t i = 0; i < kRegisterCnt; i++) {
+        non_zeros += registers_[i] != 0;
+    }
+    // a sparse register takes 3 bytes of the index and the rank
+    if (non_zeros * 3 < kRegisterCnt) {
+        output->reserve(1 + non_zeros * 3);
+        Append<uint8_t>(output, kHllSparse);
+        for (uint32_t i = 0; i < kRegisterCnt; i++) {
+            if (registers_[i] != 0) {
+                Append<uint16_t>(output, i);
+                Append<uint8_t>(output, registers_[i]);
+            }
+        }
+    } else {
+        output->reserve(1 + kRegisterCnt);
+        Append<uint8_t>(output, kHllDense);
+        output->append(reinterpret_cast<const char*>(registers_), kRegisterCnt);
+    }
+}
+
+bool HyperLogLog::Deserialize(const char* data, size_t size) {
+    if (size < 1) {
+        return false;
+    }
+    uint8_t format = data[0];
+    data++;
+    size--;
+    uint8_t registers[kRegisterCnt];
+    if (format == kHllDense && size == kRegisterCnt) {
+        memcpy(registers, data, kRegisterCnt);
+    } else if (format == kHllSparse && size % 3 == 0) {
+        memset(registers, 0, kRegisterCnt);
+        for (size_t pos = 0; pos < size; pos += 3) {
+            uint16_t idx = Load<uint16_t>(data + pos);
+            if (idx >= kRegisterCnt) {
+                return false;
+            }
+            registers[idx] = data[pos + 2];
+        }
+    } else {
+        return false;
+    }
+    for (uint32_t i = 0; i < kRegisterCnt; i++) {
+        if (registers[i] > kMaxRank) {
+            return false;
+        }
+    }
+    memcpy(registers_, registers, kRegisterCnt);
+    return true;
+}
+
+TDigest::TDigest(double compression)
+    : compression_(std::max(compression, 10.0)), centroids_(), buffer_() {
+    Clear();
+}
+
+void TDigest::Clear() {
+    centroids_.clear();
+    buffer_.clear();
+    total_weight_ = 0;
+    min_ = std::numeric_limits<double>::infinity();
+    max_ = -std::numeric_limits<double>::infinity();
+}
+
+void TDigest::Add(double value, double weight) {
+    if (std::isnan(value) || !(weight > 0)) {
+        return;
+    }
+    if (buffer_.empty()) {
+        buffer_.reserve(static_cast<size_t>(compression_) * 5);
+    }
+    buffer_.push_back({value, weight});
+    total_weight_ += weight;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    if (buffer_.size() >= static_cast<size_t>(compression_) * 5) {
+        Compress();
+    }
+}
+
+void TDigest::Merge(const TDigest& other) {
+    if (other.Empty()) {
+        return;
+    }
+    buffer_.insert(buffer_.end(), other.centroids_.begin(), other.centroids_.end());
+    buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+    total_weight_ += other.total_weight_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    Compress();
+}
+
+double TDigest::QuantileLimit(double q) const {
+    // the scale function k(q) = compression / (2 * pi) * asin(2q - 1), a centroid spans one in k at most
+    double k = compression_ / (2 * M_PI) * std::asin(2 * q - 1) + 1;
+    double angle = std::min(k * 2 * M_PI / compression_, M_PI / 2);
+    return (std::sin(angle) + 1) / 2;
+}
+
+void TDigest::Compress() {
+    if (buffer_.empty()) {
+        return;
+    }
+    buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+    std::sort(buffer_.begin(), buffer_.end(),
+              [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+    centroids_.clear();
+    double weight_so_far = 0;
+    double weight_limit = total_weight_ * QuantileLimit(0);
+    Centroid cur = buffer_[0];
+    for (size_t i = 1; i < buffer_.size(); i++) {
+        const Centroid& next = buffer_[i];
+        if (weight_so_far + cur.weight + next.weight <= weight_limit) {
+            cur.weight += next.weight;
+            cur.mean += (next.mean - cur.mean) * next.weight / cur.weight;
+        } else {
+            weight_so_far += cur.weight;
+            centroids_.push_back(cur);
+            weight_limit = total_weight_ * QuantileLimit(weight_so_far / total_weight_);
+            cur = next;
+        }
+    }
+    centroids_.push_back(cur);
+    buffer_.clear();
+}
+
+double TDigest::Quantile(double q) {
+    Compress();
+    if (centroids_.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (q <= 0) {
+        return min_;
+    }
+    if (q >= 1) {
+        return max_;
+    }
+    if (centroids_.size() == 1) {
+        return centroids_[0].mean;
+    }
+    // interpolate between the centers of the centroids, and between the ends and the min or the max
+    double index = q * total_weight_;
+    const Centroid& first = centroids_.front();
+    if (index < first.weight / 2) {
+        return min_ + (first.mean - min_) * index / (first.weight / 2);
+    }
+    double center = first.weight / 2;
+    for (size_t i = 0; i + 1 < centroids_.size(); i++) {
+        double delta = (centroids_[i].weight + centroids_[i + 1].weight) / 2;
+        if (index < center + delta) {
+            return centroids_[i].mean + (centroids_[i + 1].mean - centroids_[i].mean) * (index - center) / delta;
+        }
+        center += delta;
+    }
+    const Centroid& last = centroids_.back();
+    double ratio = std::min((index - center) / (last.weight / 2), 1.0);
+    return last.mean + (max_ - last.mean) * ratio;
+}
+
+void TDigest::Serialize(std::string* output) {
+    Compress();
+    output->clear();
+    output->reserve(1 + sizeof(double) * 3 + sizeof(uint32_t) + centroids_.size() * sizeof(double) * 2);
+    Append<uint8_t>(output, kTDigestV1);
+    Append<double>(output, compression_);
+    Append<double>(output, min_);
+    Append<double>(output, max_);
+    Append<uint32_t>(output, centroids_.size());
+    for (const auto& centroid : centroids_) {
+        Append<double>(output, centroid.mean);
+        Append<double>(output, centroid.weight);
+    }
+}
+
+bool TDigest::Deserialize(const char* data, size_t size) {
+    const size_t header = 1 + sizeof(double) * 3 + sizeof(uint32_t);
+    if (size < header || data[0] != kTDigestV1) {
+        return false;
+    }
+    double compression = Load<double>(data + 1);
+    uint32_t cnt = Load<uint32_t>(data + 1 + sizeof(double) * 3);
+    if (!(compression >= 10) || size != header + cnt * sizeof(double) * 2) {
+        return false;
+    }
+    std::vector<Centroid> centroids(cnt);
+    double total_weight = 0;
+    for (uint32_t i = 0; i < cnt; i++) {
+        centroids[i].mean = Load<double>(data + header + i * sizeof(double) * 2);
+        centroids[i].weight = Load<double>(data + header + i * sizeof(double) * 2 + sizeof(double));
+        if (!(centroids[i].weight > 0) || (i > 0 && centroids[i].mean < centroids[i - 1].mean)) {
+            return false;
+        }
+        total_weight += centroids[i].weight;
+    }
+    compression_ = compression;
+    centroids_.swap(centroids);
+    buffer_.clear();
+    total_weight_ = total_weight;
+    min_ = Load<double>(data + 1 + sizeof(double));
+    max_ = Load<double>(data + 1 + sizeof(double) * 2);
+    return true;
+}
+
+}  // namespace base
+}  // namespace hybridse
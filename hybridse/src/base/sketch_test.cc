@@ -0,0 +1,156 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "base/fe_hash.h"
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace base {
+
+class SketchTest : public ::testing::Test {};
+
+static uint64_t HashOf(int64_t value) { return MurmurHash64A(&value, sizeof(value), 0xe17a1465); }
+
+TEST_F(SketchTest, HyperLogLogEstimate) {
+    HyperLogLog empty;
+    ASSERT_EQ(0u, empty.Estimate());
+    for (int64_t cnt : {1, 10, 100, 1000, 10000, 100000, 1000000}) {
+        HyperLogLog hll;
+        // every value is added three times
+        for (int k = 0; k < 3; k++) {
+            for (int64_t i = 0; i < cnt; i++) {
+                hll.AddHash(HashOf(i));
+            }
+        }
+        double error = std::abs(static_cast<double>(hll.Estimate()) - cnt) / cnt;
+        ASSERT_LT(error, 0.05) << "cnt " << cnt << " estimate " << hll.Estimate();
+    }
+}
+
+TEST_F(SketchTest, HyperLogLogMergeAndSerialize) {
+    HyperLogLog left;
+    HyperLogLog right;
+    HyperLogLog all;
+    for (int64_t i = 0; i < 50000; i++) {
+        (i % 3 == 0 ? left : right).AddHash(HashOf(i));
+        all.AddHash(HashOf(i));
+    }
+    left.Merge(right);
+    ASSERT_EQ(all.Estimate(), left.Estimate());
+
+    // dense
+    std::string data;
+    all.Serialize(&data);
+    ASSERT_EQ(1 + HyperLogLog::kRegisterCnt, data.size());
+    HyperLogLog restored;
+    ASSERT_TRUE(restored.Deserialize(data.data(), data.size()));
+    ASSERT_EQ(all.Estimate(), restored.Estimate());
+
+    // sparse
+    HyperLogLog small;
+    for (int64_t i = 0; i < 100; i++) {
+        small.AddHash(HashOf(i));
+    }
+    small.Serialize(&data);
+    ASSERT_GT(HyperLogLog::kRegisterCnt / 4, data.size());
+    ASSERT_TRUE(restored.Deserialize(data.data(), data.size()));
+    ASSERT_EQ(small.Estimate(), restored.Estimate());
+
+    ASSERT_FALSE(restored.Deserialize(data.data(), data.size() - 1));
+    ASSERT_FALSE(restored.Deserialize("", 0));
+    ASSERT_EQ(small.Estimate(), restored.Estimate());
+}
+
+TEST_F(SketchTest, TDigestQuantile) {
+    TDigest empty;
+    ASSERT_TRUE(std::isnan(empty.Quantile(0.5)));
+
+    TDigest single;
+    single.Add(3);
+    ASSERT_EQ(3, single.Quantile(0));
+    ASSERT_EQ(3, single.Quantile(0.5));
+    ASSERT_EQ(3, single.Quantile(1));
+
+    // the few values are kept as they are
+    TDigest small;
+    for (int i = 1; i <= 5; i++) {
+        small.Add(i);
+    }
+    ASSERT_EQ(1, small.Quantile(0));
+    ASSERT_EQ(3, small.Quantile(0.5));
+    ASSERT_EQ(5, small.Quantile(1));
+
+    TDigest digest;
+    std::vector<double> values;
+    uint64_t seed = 1;
+    for (int i = 0; i < 1000000; i++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        // skewed values
+        double value = std::pow(static_cast<double>(seed >> 11) / (1ull << 53), 3) * 1000;
+        digest.Add(value);
+        values.push_back(value);
+    }
+    std::sort(values.begin(), values.end());
+    ASSERT_EQ(values.front(), digest.Quantile(0));
+    ASSERT_EQ(values.back(), digest.Quantile(1));
+    for (double q : {0.001, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999}) {
+        double estimate = digest.Quantile(q);
+        // the rank of the estimate is close to the quantile
+        double rank = static_cast<double>(std::lower_bound(values.begin(), values.end(), estimate) - values.begin()) /
+                      values.size();
+        ASSERT_NEAR(q, rank, 0.001) << "quantile " << q;
+    }
+}
+
+TEST_F(SketchTest, TDigestMergeAndSerialize) {
+    TDigest left;
+    TDigest right;
+    for (int i = 0; i < 100000; i++) {
+        (i % 2 == 0 ? left : right).Add(i % 1000);
+    }
+    left.Merge(right);
+    ASSERT_EQ(100000, left.TotalWeight());
+    ASSERT_EQ(0, left.Quantile(0));
+    ASSERT_EQ(999, left.Quantile(1));
+    ASSERT_NEAR(500, left.Quantile(0.5), 10);
+
+    std::string data;
+    left.Serialize(&data);
+    TDigest restored;
+    ASSERT_TRUE(restored.Deserialize(data.data(), data.size()));
+    ASSERT_EQ(left.TotalWeight(), restored.TotalWeight());
+    for (double q : {0.0, 0.1, 0.5, 0.9, 1.0}) {
+        ASSERT_EQ(left.Quantile(q), restored.Quantile(q));
+    }
+    ASSERT_FALSE(restored.Deserialize(data.data(), data.size() - 1));
+    ASSERT_FALSE(restored.Deserialize("", 0));
+    ASSERT_EQ(100000, restored.TotalWeight());
+}
+
+}  // namespace base
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+#include "benchmark/compile_bm_case.h"
+
+namespace hybridse {
+namespace bm {
+// args: the output columns, the windows and the last joins
+static void BM_CompileFeatureSql(benchmark::State& state) {  // NOLINT
+    CompileFeatureSql(&state, BENCHMARK, state.range(0), state.range(1),
+                      state.range(2));
+}
+
+// args: the output columns
+static void BM_GetCachedFeatureSql(benchmark::State& state) {  // NOLINT
+    GetCachedFeatureSql(&state, BENCHMARK, state.range(0));
+}
+
+BENCHMARK(BM_CompileFeatureSql)
+    ->Args({10, 1, 0})
+    ->Args({100, 1, 0})
+    ->Args({100, 3, 2})
+    ->Args({1000, 3, 2})
+    ->Args({1000, 8, 4})
+    ->Args({5000, 3, 2})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GetCachedFeatureSql)->Args({10})->Args({1000})->Args({5000});
+}  // namespace bm
+}  // namespace hybridse
+
+BENCHMARK_MAIN();
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/compile_bm_case.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include "absl/strings/str_cat.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "vm/engine.h"
+#include "vm/simple_catalog.h"
+#include "vm/sql_compiler.h"
+
+namespace hybridse {
+namespace bm {
+
+static const char* FEATURE_DB = "feature_db";
+// the double columns v0, v1, ... of t1 aggregated
+static const int64_t VALUE_COL_CNT = 10;
+// the double columns x0, x1, ... of the joined tables
+static const int64_t JOIN_COL_CNT = 5;
+static const char* AGGRS[] = {"sum", "avg", "max", "min", "count"};
+static const int64_t AGGR_CNT = sizeof(AGGRS) / sizeof(AGGRS[0]);
+
+static void AddColumn(type::TableDef* table, const std::string& name,
+                      type::Type type) {
+    auto column = table->add_columns();
+    column->set_name(name);
+    column->set_type(type);
+}
+
+static std::shared_ptr<vm::SimpleCatalog> BuildFeatureCatalog(
+    int64_t join_cnt) {
+    type::Database db;
+    db.set_name(FEATURE_DB);
+    auto t1 = db.add_tables();
+    t1->set_name("t1");
+    t1->set_catalog(FEATURE_DB);
+    AddColumn(t1, "id", type::kInt64);
+    AddColumn(t1, "key", type::kVarchar);
+    AddColumn(t1, "ts", type::kTimestamp);
+    for (int64_t i = 0; i < VALUE_COL_CNT; i++) {
+        AddColumn(t1, "v" + std::to_string(i), type::kDouble);
+    }
+    auto index = t1->add_indexes();
+    index->set_name("index_t1");
+    index->add_first_keys("key");
+    index->set_second_key("ts");
+    for (int64_t j = 0; j < join_cnt; j++) {
+        auto table = db.add_tables();
+        std::string name = "d" + std::to_string(j);
+        table->set_name(name);
+        table->set_catalog(FEATURE_DB);
+        AddColumn(table, "key", type::kVarchar);
+        AddColumn(table, "ts", type::kTimestamp);
+        for (int64_t i = 0; i < JOIN_COL_CNT; i++) {
+            AddColumn(table, "x" + std::to_string(i), type::kDouble);
+        }
+        auto index = table->add_indexes();
+        index->set_name("index_" + name);
+        index->add_first_keys("key");
+        index->set_second_key("ts");
+    }
+    auto catalog = std::make_shared<vm::SimpleCatalog>(true);
+    catalog->AddDatabase(db);
+    return catalog;
+}
+
+std::string BuildFeatureSql(int64_t output_cnt, int64_t window_cnt,
+                            int64_t join_cnt) {
+    window_cnt = std::max<int64_t>(1, window_cnt);
+    std::string sql = "SELECT t1.id";
+    for (int64_t i = 0; i < output_cnt; i++) {
+        int64_t col = i % VALUE_COL_CNT;
+        std::string expr;
+        if (i % 4 == 3) {
+            // every fourth column is an expression of the request row
+            // and the rows joined
+            expr = absl::StrCat("t1.v", col, " * ", i);
+            if (join_cnt > 0) {
+                absl::StrAppend(&expr, " + d", i % join_cnt, ".x",
+                                i % JOIN_COL_CNT);
+            }
+        } else {
+            // the columns, windows and aggregations are taken in turn, then
+            // the arguments are shifted to keep the expressions distinct
+            int64_t window = (i / VALUE_COL_CNT) % window_cnt;
+            int64_t aggr = (i / (VALUE_COL_CNT * window_cnt)) % AGGR_CNT;
+            int64_t shift = i / (VALUE_COL_CNT * window_cnt * AGGR_CNT);
+            std::string arg = absl::StrCat("t1.v", col);
+            if (shift > 0) {
+                absl::StrAppend(&arg, " + ", shift);
+            }
+            expr = absl::StrCat(AGGRS[aggr], "(", arg, ") OVER w", window);
+        }
+        absl::StrAppend(&sql, ", ", expr, " AS f", i);
+    }
+    absl::StrAppend(&sql, " FROM t1");
+    for (int64_t j = 0; j < join_cnt; j++) {
+        absl::StrAppend(&sql, " LAST JOIN d", j, " ORDER BY d", j,
+                        ".ts ON t1.key = d", j, ".key");
+    }
+    absl::StrAppend(&sql, " WINDOW ");
+    for (int64_t w = 0; w < window_cnt; w++) {
+        absl::StrAppend(&sql, w > 0 ? ", " : "", "w", w,
+                        " AS (PARTITION BY t1.key ORDER BY t1.ts ROWS_RANGE "
+                        "BETWEEN ",
+                        (w + 1) * 10, "s PRECEDING AND CURRENT ROW)");
+    }
+    absl::StrAppend(&sql, ";");
+    return sql;
+}
+
+struct CompileStats {
+    uint64_t compile_cnt = 0;
+    vm::CompileTimes times;
+    uint64_t ir_instruction_cnt = 0;
+    uint64_t code_bytes = 0;
+    uint64_t data_bytes = 0;
+    size_t output_cnt = 0;
+};
+
+static bool CompileOnNewEngine(
+    const std::shared_ptr<vm::SimpleCatalog>& catalog, const std::string& sql,
+    CompileStats* stats) {
+    vm::Engine engine(catalog, vm::EngineOptions());
+    vm::RequestRunSession session;
+    base::Status status;
+    if (!engine.Get(sql, FEATURE_DB, session, status)) {
+        LOG(WARNING) << "fail to compile the feature sql: " << status;
+        return false;
+    }
+    auto info =
+        std::dynamic_pointer_cast<vm::SqlCompileInfo>(session.GetCompileInfo());
+    const auto& times = info->get_sql_context().compile_times;
+    stats->compile_cnt++;
+    stats->times.parse_us += times.parse_us;
+    stats->times.plan_us += times.plan_us;
+    stats->times.codegen_us += times.codegen_us;
+    stats->times.optimize_us += times.optimize_us;
+    stats->times.link_us += times.link_us;
+    stats->ir_instruction_cnt = info->GetIRInstructionCount();
+    stats->code_bytes = info->GetJitCodeSize();
+    stats->data_bytes = info->GetJitDataSize();
+    stats->output_cnt = info->GetSchema().size();
+    return true;
+}
+
+void CompileFeatureSql(benchmark::State* state, MODE mode, int64_t output_cnt,
+                       int64_t window_cnt, int64_t join_cnt) {
+    vm::Engine::InitializeGlobalLLVM();
+    auto catalog = BuildFeatureCatalog(join_cnt);
+    std::string sql = BuildFeatureSql(output_cnt, window_cnt, join_cnt);
+    CompileStats stats;
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                if (!CompileOnNewEngine(catalog, sql, &stats)) {
+                    state->SkipWithError("fail to compile the feature sql");
+                    return;
+                }
+            }
+            double cnt = std::max<uint64_t>(1, stats.compile_cnt);
+            state->counters["parse_us"] = stats.times.parse_us / cnt;
+            state->counters["plan_us"] = stats.times.plan_us / cnt;
+            state->counters["codegen_us"] = stats.times.codegen_us / cnt;
+            state->counters["optimize_us"] = stats.times.optimize_us / cnt;
+            state->counters["link_us"] = stats.times.link_us / cnt;
+            state->counters["ir_instructions"] = stats.ir_instruction_cnt;
+            state->counters["code_bytes"] = stats.code_bytes;
+            state->counters["data_bytes"] = stats.data_bytes;
+            break;
+        }
+        case TEST: {
+            ASSERT_TRUE(CompileOnNewEngine(catalog, sql, &stats)) << sql;
+            ASSERT_EQ(static_cast<size_t>(output_cnt + 1), stats.output_cnt);
+            ASSERT_GT(stats.ir_instruction_cnt, 0u);
+            ASSERT_GT(stats.code_bytes, 0u);
+            break;
+        }
+    }
+}
+
+void GetCachedFeatureSql(benchmark::State* state, MODE mode,
+                         int64_t output_cnt) {
+    vm::Engine::InitializeGlobalLLVM();
+    auto catalog = BuildFeatureCatalog(1);
+    std::string sql = BuildFeatureSql(output_cnt, 3, 1);
+    vm::Engine engine(catalog, vm::EngineOptions());
+    base::Status status;
+    vm::RequestRunSession compiled;
+    bool ok = engine.Get(sql, FEATURE_DB, compiled, status);
+    if (mode == TEST) {
+        ASSERT_TRUE(ok) << status;
+    } else if (!ok) {
+        LOG(WARNING) << "fail to compile the feature sql: " << status;
+        state->SkipWithError("fail to compile the feature sql");
+        return;
+    }
+    uint64_t hit_cnt = 0;
+    uint64_t miss_cnt = 0;
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                vm::RequestRunSession session;
+                benchmark::DoNotOptimize(
+                    engine.Get(sql, FEATURE_DB, session, status));
+            }
+            engine.GetCacheStats(&hit_cnt, &miss_cnt);
+            state->counters["cache_hits"] = hit_cnt;
+            state->counters["cache_misses"] = miss_cnt;
+            break;
+        }
+        case TEST: {
+            vm::RequestRunSession session;
+            ASSERT_TRUE(engine.Get(sql, FEATURE_DB, session, status))
+                << status;
+            ASSERT_EQ(compiled.GetCompileInfo().get(),
+                      session.GetCompileInfo().get());
+            engine.GetCacheStats(&hit_cnt, &miss_cnt);
+            ASSERT_EQ(1u, hit_cnt);
+            ASSERT_EQ(1u, miss_cnt);
+            break;
+        }
+    }
+}
+}  // namespace bm
+}  // namespace hybridse
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_BENCHMARK_COMPILE_BM_CASE_H_
+#define HYBRIDSE_SRC_BENCHMARK_COMPILE_BM_CASE_H_
+#include <string>
+#include "benchmark/benchmark.h"
+#include "benchmark/udf_bm_case.h"
+namespace hybridse {
+namespace bm {
+// The feature sql of a deployment in request mode: output_cnt columns of the window aggregations over window_cnt
+// windows of the main table t1 and the expressions of the rows last joined from the tables d0, d1, ...
+std::string BuildFeatureSql(int64_t output_cnt, int64_t window_cnt,
+                            int64_t join_cnt);
+
+// Compile the feature sql on a new engine every iteration. The time of the compile phases, the count of the ir
+// instructions and the bytes jitted are reported as counters.
+void CompileFeatureSql(benchmark::State* state, MODE mode, int64_t output_cnt,
+                       int64_t window_cnt, int64_t join_cnt);
+
+// Get the feature sql compiled once from the compile cache of an engine.
+void GetCachedFeatureSql(benchmark::State* state, MODE mode,
+                         int64_t output_cnt);
+}  // namespace bm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_BENCHMARK_COMPILE_BM_CASE_H_
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/compile_bm_case.h"
+#include "gtest/gtest.h"
+namespace hybridse {
+namespace bm {
+class CompileBMCaseTest : public ::testing::Test {
+ public:
+    CompileBMCaseTest() {}
+    ~CompileBMCaseTest() {}
+};
+
+TEST_F(CompileBMCaseTest, BuildFeatureSql_TEST) {
+    ASSERT_EQ(
+        "SELECT t1.id, sum(t1.v0) OVER w0 AS f0, sum(t1.v1) OVER w0 AS f1, "
+        "sum(t1.v2) OVER w0 AS f2, t1.v3 * 3 + d0.x3 AS f3 FROM t1 "
+        "LAST JOIN d0 ORDER BY d0.ts ON t1.key = d0.key WINDOW w0 AS "
+        "(PARTITION BY t1.key ORDER BY t1.ts ROWS_RANGE BETWEEN 10s "
+        "PRECEDING AND CURRENT ROW);",
+        BuildFeatureSql(4, 1, 1));
+}
+
+TEST_F(CompileBMCaseTest, CompileFeatureSql_TEST) {
+    CompileFeatureSql(nullptr, TEST, 10, 1, 0);
+    CompileFeatureSql(nullptr, TEST, 100, 3, 2);
+    CompileFeatureSql(nullptr, TEST, 200, 2, 1);
+}
+
+TEST_F(CompileBMCaseTest, GetCachedFeatureSql_TEST) {
+    GetCachedFeatureSql(nullptr, TEST, 10);
+}
+}  // namespace bm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -95,6 +95,47 @@ static void BM_RequestUnionWindowExcludeCurrentTime(
     benchmark::State& state) {  // NOLINT
     RequestUnionWindowExcludeCurrentTime(&state, BENCHMARK, state.range(0));
 }
+static void BM_AvgCate(benchmark::State& state) {  // NOLINT
+    CateUdaf(&state, BENCHMARK, "avg_cate", state.range(0), state.range(1));
+}
+static void BM_CountCate(benchmark::State& state) {  // NOLINT
+    CateUdaf(&state, BENCHMARK, "count_cate", state.range(0), state.range(1));
+}
+static void BM_SumCate(benchmark::State& state) {  // NOLINT
+    CateUdaf(&state, BENCHMARK, "sum_cate", state.range(0), state.range(1));
+}
+static void BM_MaxCate(benchmark::State& state) {  // NOLINT
+    CateUdaf(&state, BENCHMARK, "max_cate", state.range(0), state.range(1));
+}
+static void BM_MinCate(benchmark::State& state) {  // NOLINT
+    CateUdaf(&state, BENCHMARK, "min_cate", state.range(0), state.range(1));
+}
+static void BM_AvgCateWhere(benchmark::State& state) {  // NOLINT
+    CateWhereUdaf(&state, BENCHMARK, "avg_cate_where", state.range(0),
+                  state.range(1));
+}
+static void BM_CountCateWhere(benchmark::State& state) {  // NOLINT
+    CateWhereUdaf(&state, BENCHMARK, "count_cate_where", state.range(0),
+                  state.range(1));
+}
+static void BM_TopNKeyAvgCateWhere(benchmark::State& state) {  // NOLINT
+    TopNKeyCateWhereUdaf(&state, BENCHMARK, "top_n_key_avg_cate_where",
+                         state.range(0), state.range(1));
+}
+static void BM_TopNKeyCountCateWhere(benchmark::State& state) {  // NOLINT
+    TopNKeyCateWhereUdaf(&state, BENCHMARK, "top_n_key_count_cate_where",
+                         state.range(0), state.range(1));
+}
+static void BM_TopNKeySumCateWhere(benchmark::State& state) {  // NOLINT
+    TopNKeyCateWhereUdaf(&state, BENCHMARK, "top_n_key_sum_cate_where",
+                         state.range(0), state.range(1));
+}
+static void BM_DistinctCount(benchmark::State& state) {  // NOLINT
+    DistinctCount(&state, BENCHMARK, state.range(0), state.range(1));
+}
+static void BM_Top(benchmark::State& state) {  // NOLINT
+    TopUdaf(&state, BENCHMARK, state.range(0));
+}
 
 BENCHMARK(BM_CopyArrayList)
     ->Args({10})
@@ -191,6 +232,74 @@ BENCHMARK(BM_RequestUnionWindowExcludeCurrentTime)
     ->Args({100})
     ->Args({1000})
     ->Args({10000});
+
+BENCHMARK(BM_AvgCate)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_CountCate)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_SumCate)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_MaxCate)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_MinCate)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_AvgCateWhere)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_CountCateWhere)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_TopNKeyAvgCateWhere)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_TopNKeyCountCateWhere)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_TopNKeySumCateWhere)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_DistinctCount)
+    ->Args({100, 10})
+    ->Args({1000, 10})
+    ->Args({1000, 100})
+    ->Args({10000, 100})
+    ->Args({10000, 1000});
+BENCHMARK(BM_Top)->Args({100})->Args({1000})->Args({10000});
 }  // namespace bm
 }  // namespace hybridse
 
@@ -15,6 +15,7 @@
  */
 
 #include "benchmark/udf_bm_case.h"
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -31,7 +32,9 @@
 namespace hybridse {
 namespace bm {
 using codec::ColumnImpl;
+using codec::ListRef;
 using codec::Row;
+using openmldb::base::StringRef;
 using sqlcase::CaseDataMock;
 using vm::MemTableHandler;
 using vm::MemTimeTableHandler;
@@ -687,5 +690,213 @@ void RequestUnionWindowExcludeCurrentTime(benchmark::State* state, MODE mode,
         }
     }
 }
+
+template <typename T, typename V>
+static ListRef<T> MakeListRef(V* list) {
+    ListRef<T> list_ref;
+    list_ref.list = reinterpret_cast<int8_t*>(list);
+    return list_ref;
+}
+
+struct CateData {
+    CateData(int64_t data_size, int64_t cate_cnt) {
+        for (int64_t i = 0; i < data_size; i++) {
+            values.push_back(static_cast<int32_t>(i));
+            keys.push_back(static_cast<int32_t>(i % cate_cnt));
+            conds.push_back(i % 2 == 0);
+        }
+    }
+
+    // the output of count_cate and count_cate_where on the rows
+    std::string ExpectCount(bool where) const {
+        std::map<int32_t, int64_t> counts;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (!where || conds[i]) {
+                counts[keys[i]] += 1;
+            }
+        }
+        std::string expect;
+        for (auto& kv : counts) {
+            if (!expect.empty()) {
+                expect.append(",");
+            }
+            expect.append(std::to_string(kv.first) + ":" +
+                          std::to_string(kv.second));
+        }
+        return expect;
+    }
+
+    std::vector<int32_t> values;
+    std::vector<int32_t> keys;
+    std::vector<int> conds;
+};
+
+void CateUdaf(benchmark::State* state, MODE mode, const std::string& udaf,
+              int64_t data_size, int64_t cate_cnt) {
+    CateData data(data_size, cate_cnt);
+    codec::ArrayListV<int32_t> values(&data.values);
+    codec::ArrayListV<int32_t> keys(&data.keys);
+    auto function = udf::UdfFunctionBuilder(udaf)
+                        .args<ListRef<int32_t>, ListRef<int32_t>>()
+                        .returns<StringRef>()
+                        .library(udf::DefaultUdfLibrary::get())
+                        .build();
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                benchmark::DoNotOptimize(
+                    function(MakeListRef<int32_t>(&values),
+                             MakeListRef<int32_t>(&keys)));
+                vm::JitRuntime::get()->ReleaseRunStep();
+            }
+            break;
+        }
+        case TEST: {
+            ASSERT_TRUE(function.valid());
+            auto output = function(MakeListRef<int32_t>(&values),
+                                   MakeListRef<int32_t>(&keys));
+            if (udaf == "count_cate") {
+                ASSERT_EQ(data.ExpectCount(false), output.ToString());
+            }
+            vm::JitRuntime::get()->ReleaseRunStep();
+            break;
+        }
+    }
+}
+
+void CateWhereUdaf(benchmark::State* state, MODE mode, const std::string& udaf,
+                   int64_t data_size, int64_t cate_cnt) {
+    CateData data(data_size, cate_cnt);
+    codec::ArrayListV<int32_t> values(&data.values);
+    codec::BoolArrayListV conds(&data.conds);
+    codec::ArrayListV<int32_t> keys(&data.keys);
+    auto function =
+        udf::UdfFunctionBuilder(udaf)
+            .args<ListRef<int32_t>, ListRef<bool>, ListRef<int32_t>>()
+            .returns<StringRef>()
+            .library(udf::DefaultUdfLibrary::get())
+            .build();
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                benchmark::DoNotOptimize(function(
+                    MakeListRef<int32_t>(&values), MakeListRef<bool>(&conds),
+                    MakeListRef<int32_t>(&keys)));
+                vm::JitRuntime::get()->ReleaseRunStep();
+            }
+            break;
+        }
+        case TEST: {
+            ASSERT_TRUE(function.valid());
+            auto output =
+                function(MakeListRef<int32_t>(&values),
+                         MakeListRef<bool>(&conds), MakeListRef<int32_t>(&keys));
+            if (udaf == "count_cate_where") {
+                ASSERT_EQ(data.ExpectCount(true), output.ToString());
+            }
+            vm::JitRuntime::get()->ReleaseRunStep();
+            break;
+        }
+    }
+}
+
+void TopNKeyCateWhereUdaf(benchmark::State* state, MODE mode,
+                          const std::string& udaf, int64_t data_size,
+                          int64_t cate_cnt) {
+    CateData data(data_size, cate_cnt);
+    std::vector<int32_t> bounds(data_size, 5);
+    codec::ArrayListV<int32_t> values(&data.values);
+    codec::BoolArrayListV conds(&data.conds);
+    codec::ArrayListV<int32_t> keys(&data.keys);
+    codec::ArrayListV<int32_t> bound(&bounds);
+    auto function = udf::UdfFunctionBuilder(udaf)
+                        .args<ListRef<int32_t>, ListRef<bool>,
+                              ListRef<int32_t>, ListRef<int32_t>>()
+                        .returns<StringRef>()
+                        .library(udf::DefaultUdfLibrary::get())
+                        .build();
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                benchmark::DoNotOptimize(function(
+                    MakeListRef<int32_t>(&values), MakeListRef<bool>(&conds),
+                    MakeListRef<int32_t>(&keys), MakeListRef<int32_t>(&bound)));
+                vm::JitRuntime::get()->ReleaseRunStep();
+            }
+            break;
+        }
+        case TEST: {
+            ASSERT_TRUE(function.valid());
+            function(MakeListRef<int32_t>(&values), MakeListRef<bool>(&conds),
+                     MakeListRef<int32_t>(&keys), MakeListRef<int32_t>(&bound));
+            vm::JitRuntime::get()->ReleaseRunStep();
+            break;
+        }
+    }
+}
+
+void DistinctCount(benchmark::State* state, MODE mode, int64_t data_size,
+                   int64_t cate_cnt) {
+    CateData data(data_size, cate_cnt);
+    codec::ArrayListV<int32_t> keys(&data.keys);
+    auto function = udf::UdfFunctionBuilder("distinct_count")
+                        .args<ListRef<int32_t>>()
+                        .returns<int64_t>()
+                        .library(udf::DefaultUdfLibrary::get())
+                        .build();
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                benchmark::DoNotOptimize(function(MakeListRef<int32_t>(&keys)));
+                vm::JitRuntime::get()->ReleaseRunStep();
+            }
+            break;
+        }
+        case TEST: {
+            ASSERT_TRUE(function.valid());
+            ASSERT_EQ(std::min(data_size, cate_cnt),
+                      function(MakeListRef<int32_t>(&keys)));
+            vm::JitRuntime::get()->ReleaseRunStep();
+            break;
+        }
+    }
+}
+
+void TopUdaf(benchmark::State* state, MODE mode, int64_t data_size) {
+    CateData data(data_size, 1);
+    std::vector<int32_t> bounds(data_size, 5);
+    codec::ArrayListV<int32_t> values(&data.values);
+    codec::ArrayListV<int32_t> bound(&bounds);
+    auto function = udf::UdfFunctionBuilder("top")
+                        .args<ListRef<int32_t>, ListRef<int32_t>>()
+                        .returns<StringRef>()
+                        .library(udf::DefaultUdfLibrary::get())
+                        .build();
+    switch (mode) {
+        case BENCHMARK: {
+            for (auto _ : *state) {
+                benchmark::DoNotOptimize(function(
+                    MakeListRef<int32_t>(&values), MakeListRef<int32_t>(&bound)));
+                vm::JitRuntime::get()->ReleaseRunStep();
+            }
+            break;
+        }
+        case TEST: {
+            ASSERT_TRUE(function.valid());
+            std::string expect;
+            for (int64_t i = data_size - 1; i >= 0 && i >= data_size - 5; i--) {
+                if (!expect.empty()) {
+                    expect.append(",");
+                }
+                expect.append(std::to_string(i));
+            }
+            ASSERT_EQ(expect, function(MakeListRef<int32_t>(&values),
+                                       MakeListRef<int32_t>(&bound))
+                                  .ToString());
+            vm::JitRuntime::get()->ReleaseRunStep();
+            break;
+        }
+    }
+}
 }  // namespace bm
 }  // namespace hybridse
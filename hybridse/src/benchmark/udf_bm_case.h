@@ -53,6 +53,18 @@ void HistoryWindowBufferExcludeCurrentTime(benchmark::State* state, MODE mode,
 void RequestUnionWindow(benchmark::State* state, MODE mode, int64_t data_size);
 void RequestUnionWindowExcludeCurrentTime(benchmark::State* state, MODE mode,
                                           int64_t data_size);
+
+// Category Udaf, the value of the i-th row is i and its key is i % cate_cnt
+void CateUdaf(benchmark::State* state, MODE mode, const std::string& udaf,
+              int64_t data_size, int64_t cate_cnt);
+void CateWhereUdaf(benchmark::State* state, MODE mode, const std::string& udaf,
+                   int64_t data_size, int64_t cate_cnt);
+void TopNKeyCateWhereUdaf(benchmark::State* state, MODE mode,
+                          const std::string& udaf, int64_t data_size,
+                          int64_t cate_cnt);
+void DistinctCount(benchmark::State* state, MODE mode, int64_t data_size,
+                   int64_t cate_cnt);
+void TopUdaf(benchmark::State* state, MODE mode, int64_t data_size);
 }  // namespace bm
 }  // namespace hybridse
 #endif  // HYBRIDSE_SRC_BENCHMARK_UDF_BM_CASE_H_
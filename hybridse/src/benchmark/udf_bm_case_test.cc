@@ -80,6 +80,35 @@ TEST_F(UdfBMCaseTest, TimestampFormat_TEST) { TimestampFormat(nullptr, TEST); }
 TEST_F(UdfBMCaseTest, DateToString_TEST) { DateToString(nullptr, TEST); }
 TEST_F(UdfBMCaseTest, DateFormat_TEST) { DateFormat(nullptr, TEST); }
 
+TEST_F(UdfBMCaseTest, CateUdaf_TEST) {
+    for (auto udaf :
+         {"avg_cate", "count_cate", "sum_cate", "max_cate", "min_cate"}) {
+        CateUdaf(nullptr, TEST, udaf, 10L, 100L);
+        CateUdaf(nullptr, TEST, udaf, 1000L, 10L);
+    }
+}
+TEST_F(UdfBMCaseTest, CateWhereUdaf_TEST) {
+    for (auto udaf : {"avg_cate_where", "count_cate_where"}) {
+        CateWhereUdaf(nullptr, TEST, udaf, 10L, 100L);
+        CateWhereUdaf(nullptr, TEST, udaf, 1000L, 10L);
+    }
+}
+TEST_F(UdfBMCaseTest, TopNKeyCateWhereUdaf_TEST) {
+    for (auto udaf :
+         {"top_n_key_avg_cate_where", "top_n_key_count_cate_where",
+          "top_n_key_sum_cate_where"}) {
+        TopNKeyCateWhereUdaf(nullptr, TEST, udaf, 1000L, 100L);
+    }
+}
+TEST_F(UdfBMCaseTest, DistinctCount_TEST) {
+    DistinctCount(nullptr, TEST, 10L, 100L);
+    DistinctCount(nullptr, TEST, 1000L, 100L);
+}
+TEST_F(UdfBMCaseTest, TopUdaf_TEST) {
+    TopUdaf(nullptr, TEST, 3L);
+    TopUdaf(nullptr, TEST, 1000L);
+}
+
 }  // namespace bm
 }  // namespace hybridse
 int main(int argc, char** argv) {
@@ -16,6 +16,8 @@
 
 #include "codec/row.h"
 
+#include <utility>
+
 namespace hybridse {
 namespace codec {
 
@@ -28,6 +30,26 @@ Row::Row(const std::string &str)
 
 Row::Row(const Row &s) : slice_(s.slice_), slices_(s.slices_) {}
 
+Row::Row(Row &&s) noexcept : slice_(std::move(s.slice_)), slices_(std::move(s.slices_)) {
+    s.slices_.clear();
+}
+
+Row &Row::operator=(const Row &s) {
+    slice_ = s.slice_;
+    slices_ = s.slices_;
+    return *this;
+}
+
+Row &Row::operator=(Row &&s) noexcept {
+    if (&s == this) {
+        return *this;
+    }
+    slice_ = std::move(s.slice_);
+    slices_ = std::move(s.slices_);
+    s.slices_.clear();
+    return *this;
+}
+
 Row::Row(size_t major_slices, const Row &major, size_t secondary_slices,
          const Row &secondary)
     : slice_(major.slice_), slices_(major_slices + secondary_slices - 1) {
@@ -589,6 +589,123 @@ base::Status ScheduleAggGenerators(
     return base::Status::OK();
 }
 
+bool AggregateIRBuilder::UseColumnAgg() const {
+    if (frame_node_ == nullptr) {
+        return true;
+    }
+    // the size of rows frame is known, the others are bounded by max size only
+    int64_t rows = -1;
+    if (frame_node_->frame_type() == node::kFrameRows) {
+        int64_t start = frame_node_->GetHistoryRowsStart();
+        int64_t end = frame_node_->GetHistoryRowsEnd();
+        if (start != INT64_MIN && end != INT64_MIN) {
+            rows = end - start + 1;
+        }
+    }
+    int64_t max_size = frame_node_->frame_maxsize();
+    if (max_size > 0 && (rows < 0 || max_size < rows)) {
+        rows = max_size;
+    }
+    return rows < 0 || rows >= kColumnAggMinWindowSize;
+}
+
+static std::string GetColumnAggFuncName(node::DataType col_type) {
+    switch (col_type) {
+        case ::hybridse::node::kInt16:
+            return "hybridse_storage_column_agg_int16";
+        case ::hybridse::node::kInt32:
+            return "hybridse_storage_column_agg_int32";
+        case ::hybridse::node::kInt64:
+            return "hybridse_storage_column_agg_int64";
+        case ::hybridse::node::kFloat:
+            return "hybridse_storage_column_agg_float";
+        case ::hybridse::node::kDouble:
+            return "hybridse_storage_column_agg_double";
+        default:
+            return "";
+    }
+}
+
+base::Status AggregateIRBuilder::BuildColumnAgg(
+    ::llvm::Function* fn, const vm::Schema& output_schema) {
+    ::llvm::LLVMContext& llvm_ctx = module_->getContext();
+    ::llvm::IRBuilder<> builder(llvm_ctx);
+    auto void_ty = llvm::Type::getVoidTy(llvm_ctx);
+    auto int64_ty = llvm::Type::getInt64Ty(llvm_ctx);
+    auto double_ty = llvm::Type::getDoubleTy(llvm_ctx);
+    auto ptr_ty = llvm::Type::getInt8Ty(llvm_ctx)->getPointerTo();
+
+    ::llvm::BasicBlock* head_block =
+        ::llvm::BasicBlock::Create(llvm_ctx, "head", fn);
+    builder.SetInsertPoint(head_block);
+    ::llvm::Value* input_arg = fn->arg_begin();
+    ::llvm::Value* output_arg = fn->arg_begin() + 1;
+
+    std::map<uint32_t, NativeValue> dummy_map;
+    BufNativeEncoderIRBuilder output_encoder(&dummy_map, &output_schema,
+                                             head_block);
+    for (auto& pair : agg_col_infos_) {
+        auto& info = pair.second;
+        std::string agg_func_name = GetColumnAggFuncName(info.col_type);
+        CHECK_TRUE(!agg_func_name.empty(), common::kCodegenUdafError,
+                   "Unsupported column type of agg: ", DataTypeName(info.col_type))
+        ::llvm::Type* col_ty =
+            GetOutputLlvmType(llvm_ctx, "sum", info.col_type);
+        size_t slice_idx = info.schema_idx;
+        if (schema_context_->GetRowFormat() != nullptr) {
+            slice_idx = schema_context_->GetRowFormat()->GetSliceId(info.schema_idx);
+        }
+
+        ::llvm::Value* sum = CreateAllocaAtHead(&builder, col_ty, "sum");
+        ::llvm::Value* fsum = CreateAllocaAtHead(&builder, double_ty, "fsum");
+        ::llvm::Value* cnt = CreateAllocaAtHead(&builder, int64_ty, "cnt");
+        ::llvm::Value* min = CreateAllocaAtHead(&builder, col_ty, "min");
+        ::llvm::Value* max = CreateAllocaAtHead(&builder, col_ty, "max");
+        auto col_ptr_ty = col_ty->getPointerTo();
+        auto agg_func = module_->getOrInsertFunction(
+            agg_func_name,
+            ::llvm::FunctionType::get(
+                void_ty,
+                {ptr_ty, int64_ty, int64_ty, int64_ty, col_ptr_ty,
+                 double_ty->getPointerTo(), int64_ty->getPointerTo(),
+                 col_ptr_ty, col_ptr_ty},
+                false));
+        builder.CreateCall(
+            agg_func, {input_arg, builder.getInt64(slice_idx),
+                       builder.getInt64(info.col_idx),
+                       builder.getInt64(info.offset), sum, fsum, cnt, min, max});
+
+        ::llvm::Value* cnt_value = builder.CreateLoad(cnt);
+        ::llvm::Value* is_empty =
+            builder.CreateICmpEQ(cnt_value, builder.getInt64(0));
+        for (size_t i = 0; i < info.GetOutputNum(); ++i) {
+            auto& fname = info.agg_funcs[i];
+            NativeValue output;
+            if (fname == "sum") {
+                output = NativeValue::Create(builder.CreateLoad(sum));
+            } else if (fname == "avg") {
+                output = NativeValue::Create(builder.CreateFDiv(
+                    builder.CreateLoad(fsum),
+                    builder.CreateSIToFP(cnt_value, double_ty)));
+            } else if (fname == "count") {
+                output = NativeValue::Create(cnt_value);
+            } else if (fname == "min") {
+                output = NativeValue::CreateWithFlag(builder.CreateLoad(min),
+                                                     is_empty);
+            } else if (fname == "max") {
+                output = NativeValue::CreateWithFlag(builder.CreateLoad(max),
+                                                     is_empty);
+            } else {
+                FAIL_STATUS(common::kCodegenUdafError, "Unknown agg function name: ", fname)
+            }
+            output_encoder.BuildEncodePrimaryField(output_arg, info.output_idxs[i],
+                                                   output);
+        }
+    }
+    builder.CreateRetVoid();
+    return base::Status::OK();
+}
+
 base::Status AggregateIRBuilder::BuildMulti(const std::string& base_funcname,
                                     ExprIRBuilder* expr_ir_builder,
                                     VariableIRBuilder* variable_ir_builder,
@@ -622,6 +739,10 @@ base::Status AggregateIRBuilder::BuildMulti(const std::string& base_funcname,
         module_->getOrInsertFunction(fn_name, fnt),
         {window_ptr.GetValue(&builder), builder.CreateLoad(output_buf)});
 
+    if (UseColumnAgg()) {
+        return BuildColumnAgg(fn, output_schema);
+    }
+
     ::llvm::BasicBlock* head_block =
         ::llvm::BasicBlock::Create(llvm_ctx, "head", fn);
     ::llvm::BasicBlock* enter_block =
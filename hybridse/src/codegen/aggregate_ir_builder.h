@@ -103,7 +103,17 @@ class AggregateIRBuilder {
 
     bool empty() const { return agg_col_infos_.empty(); }
 
+    // the windows with at least this many rows are aggregated column by column
+    static const int64_t kColumnAggMinWindowSize = 64;
+
+    // whether to reduce the decoded columns of the window instead of updating the
+    // states row by row, decided by the estimated window size of the frame
+    bool UseColumnAgg() const;
+
  private:
+    base::Status BuildColumnAgg(::llvm::Function* fn,
+                                const vm::Schema& output_schema);
+
     const vm::SchemasContext* schema_context_;
     ::llvm::Module* module_;
     const node::FrameNode* frame_node_;
@@ -124,6 +124,45 @@ TEST_F(AggregateIRBuilderTest, TestMixedMultipleAgg) {
     free(ptr);
 }
 
+// windows of a small rows frame are aggregated row by row
+TEST_F(AggregateIRBuilderTest, TestMultipleAggOfSmallRowsFrame) {
+    std::string sql =
+        "SELECT "
+        "sum(col1) OVER w1 as col1_sum, "
+        "avg(col1) OVER w1 as col1_avg, "
+        "count(col1) OVER w1 as col1_count, "
+        "min(col5) OVER w1 as col5_min, "
+        "max(col5) OVER w1 as col5_max "
+        "FROM t1 WINDOW "
+        "w1 AS "
+        "(PARTITION BY COL2 ORDER BY `TS` ROWS BETWEEN 4 PRECEDING AND "
+        "CURRENT ROW) limit 10;";
+
+    int8_t* ptr = NULL;
+    std::vector<Row> window;
+    type::TableDef table1;
+    BuildWindow(table1, window, &ptr);
+    int8_t* output = NULL;
+    int8_t* row_ptr = reinterpret_cast<int8_t*>(&window[window.size() - 1]);
+    codec::ListRef<Row> window_ref;
+    window_ref.list = ptr;
+    int8_t* window_ptr = reinterpret_cast<int8_t*>(&window_ref);
+    codec::Schema schema;
+    CheckFnLetBuilder(&manager, table1, "", sql, row_ptr, window_ptr, &schema,
+                      &output);
+
+    codec::RowView view(schema);
+    view.Reset(output, view.GetSize(output));
+    ASSERT_EQ(view.GetInt32Unsafe(0), 1 + 11 + 111 + 1111 + 11111);
+    ASSERT_FLOAT_EQ(view.GetDoubleUnsafe(1),
+                    (1 + 11 + 111 + 1111 + 11111) / 5.0);
+    ASSERT_EQ(view.GetInt64Unsafe(2), 5);
+    ASSERT_EQ(view.GetInt64Unsafe(3), 5L);
+    ASSERT_EQ(view.GetInt64Unsafe(4), 55555L);
+
+    free(ptr);
+}
+
 }  // namespace codegen
 }  // namespace hybridse
 
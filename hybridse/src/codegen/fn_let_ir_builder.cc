@@ -20,6 +20,7 @@
 #include "codegen/expr_ir_builder.h"
 #include "codegen/ir_base_builder.h"
 #include "codegen/variable_ir_builder.h"
+#include "codec/row.h"
 #include "glog/logging.h"
 #include "vm/transform.h"
 
@@ -155,6 +156,70 @@ Status RowFnLetIRBuilder::Build(
     return Status::OK();
 }
 
+Status RowFnLetIRBuilder::BuildBlock(const std::string& name,
+                                     const std::string& row_fn_name) {
+    ::llvm::Module* module = ctx_->GetModule();
+    ::llvm::Function* row_fn = module->getFunction(row_fn_name);
+    CHECK_TRUE(row_fn != nullptr, kCodegenError, "function ", row_fn_name,
+               " not found");
+    CHECK_TRUE(module->getFunction(name) == nullptr, kCodegenError,
+               "function ", name, " already exists");
+    ::llvm::LLVMContext& llvm_ctx = module->getContext();
+    ::llvm::Type* int8_ptr_ty = ::llvm::Type::getInt8PtrTy(llvm_ctx);
+    ::llvm::Type* int64_ty = ::llvm::Type::getInt64Ty(llvm_ctx);
+    ::llvm::Function* fn = nullptr;
+    CHECK_TRUE(BuildFnHeader(name,
+                             {int64_ty, int8_ptr_ty, int8_ptr_ty,
+                              int8_ptr_ty->getPointerTo()},
+                             ::llvm::Type::getInt32Ty(llvm_ctx), &fn) &&
+                   fn != nullptr,
+               kCodegenError, "Fail to build fn header for name ", name);
+    // the loop invariants of the row function, e.g. the decoding of the
+    // parameter row, are hoisted out of the loop once it is inlined
+    row_fn->addFnAttr(::llvm::Attribute::AlwaysInline);
+
+    auto arg_iter = fn->arg_begin();
+    ::llvm::Value* cnt = &*arg_iter++;
+    ::llvm::Value* rows = &*arg_iter++;
+    ::llvm::Value* parameter = &*arg_iter++;
+    ::llvm::Value* outputs = &*arg_iter;
+
+    auto entry_block = ::llvm::BasicBlock::Create(llvm_ctx, "entry", fn);
+    auto loop_block = ::llvm::BasicBlock::Create(llvm_ctx, "loop", fn);
+    auto exit_block = ::llvm::BasicBlock::Create(llvm_ctx, "exit", fn);
+    ::llvm::IRBuilder<> builder(entry_block);
+    ::llvm::Value* zero = builder.getInt64(0);
+    builder.CreateCondBr(builder.CreateICmpSGT(cnt, zero), loop_block,
+                         exit_block);
+
+    builder.SetInsertPoint(loop_block);
+    ::llvm::PHINode* idx = builder.CreatePHI(int64_ty, 2);
+    idx->addIncoming(zero, entry_block);
+    ::llvm::Value* row_ptr = builder.CreateInBoundsGEP(
+        builder.getInt8Ty(), rows,
+        builder.CreateMul(idx, builder.getInt64(sizeof(codec::Row))));
+    ::llvm::Value* output_ptr =
+        builder.CreateInBoundsGEP(int8_ptr_ty, outputs, idx);
+    ::llvm::Value* null_ptr = ::llvm::ConstantPointerNull::get(
+        ::llvm::cast<::llvm::PointerType>(int8_ptr_ty));
+    builder.CreateStore(null_ptr, output_ptr);
+    ::llvm::Value* ret = builder.CreateCall(
+        row_fn, {zero, row_ptr, null_ptr, parameter, output_ptr});
+    ::llvm::Value* output = builder.CreateLoad(int8_ptr_ty, output_ptr);
+    builder.CreateStore(
+        builder.CreateSelect(builder.CreateICmpEQ(ret, builder.getInt32(0)),
+                             output, null_ptr),
+        output_ptr);
+    ::llvm::Value* next = builder.CreateAdd(idx, builder.getInt64(1));
+    idx->addIncoming(next, loop_block);
+    builder.CreateCondBr(builder.CreateICmpSLT(next, cnt), loop_block,
+                         exit_block);
+
+    builder.SetInsertPoint(exit_block);
+    builder.CreateRet(builder.getInt32(0));
+    return Status::OK();
+}
+
 base::Status RowFnLetIRBuilder::EncodeBuf(
     const std::map<uint32_t, NativeValue>* values, const vm::Schema& schema,
     VariableIRBuilder& variable_ir_builder,  // NOLINT (runtime/references)
@@ -45,6 +45,14 @@ class RowFnLetIRBuilder {
                  const std::vector<const node::FrameNode*>& project_frames,
                  const vm::Schema& output_schema);
 
+    // build `name` projecting a block of rows with the row function
+    // `row_fn_name` built before:
+    //   int32_t name(int64_t cnt, const Row* rows, const Row* parameter,
+    //                int8_t** outputs)
+    // the row function is inlined into the loop, and the output of the row
+    // failed is null
+    Status BuildBlock(const std::string& name, const std::string& row_fn_name);
+
  private:
     bool BuildFnHeader(const std::string& name,
                        const std::vector<::llvm::Type*>& args_type,
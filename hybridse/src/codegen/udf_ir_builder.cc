@@ -27,6 +27,7 @@
 #include "llvm/IR/Attributes.h"
 #include "node/node_manager.h"
 #include "node/sql_node.h"
+#include "passes/expression/loop_invariant.h"
 #include "udf/udf.h"
 #include "udf/udf_registry.h"
 
@@ -600,6 +601,19 @@ Status UdfIRBuilder::BuildUdafCall(
                  "Build init expr ", fn->init_expr()->GetExprString(),
                  " failed: ", status.str());
 
+    // the subexpressions of the update function which are the same for every row are evaluated once here,
+    // and the values cached in the current scope are reused by the update function in the loop
+    std::vector<const node::ExprNode*> invariants;
+    passes::LoopInvariantAnalysis::Collect(
+        dynamic_cast<const node::LambdaNode*>(fn->update_func()), &invariants);
+    for (auto invariant : invariants) {
+        NativeValue invariant_value;
+        ExprIRBuilder invariant_builder(ctx_);
+        invariant_builder.set_frame(frame_arg_, frame_);
+        CHECK_STATUS(invariant_builder.Build(invariant, &invariant_value),
+                     "Build loop invariant ", invariant->GetExprString(), " failed");
+    }
+
     // local states storage
     ::llvm::IRBuilder<> builder(ctx_->GetCurrentBlock());
     std::vector<::llvm::Value*> states_storage(state_num);
@@ -29,6 +29,9 @@ NodeManager::~NodeManager() {
     for (auto node : node_list_) {
         delete node;
     }
+    for (auto node : arena_node_list_) {
+        node->~FeBaseObject();
+    }
 }
 
 QueryNode *NodeManager::MakeSelectQueryNode(bool is_distinct, SqlNodeList *select_list_ptr,
@@ -37,30 +40,27 @@ QueryNode *NodeManager::MakeSelectQueryNode(bool is_distinct, SqlNodeList *selec
                                             ExprNode *order_expr_list, SqlNodeList *window_list_ptr,
                                             SqlNode *limit_ptr) {
     SelectQueryNode *node_ptr =
-        new SelectQueryNode(is_distinct, select_list_ptr, tableref_list_ptr, where_expr, group_expr_list, having_expr,
-                            dynamic_cast<OrderByNode *>(order_expr_list), window_list_ptr, limit_ptr);
-    RegisterNode(node_ptr);
+        MakeNode<SelectQueryNode>(is_distinct, select_list_ptr, tableref_list_ptr, where_expr, group_expr_list,
+                                  having_expr, dynamic_cast<OrderByNode *>(order_expr_list), window_list_ptr,
+                                  limit_ptr);
     return node_ptr;
 }
 
 QueryNode *NodeManager::MakeUnionQueryNode(QueryNode *left, QueryNode *right, bool is_all) {
-    UnionQueryNode *node_ptr = new UnionQueryNode(left, right, is_all);
-    RegisterNode(node_ptr);
+    UnionQueryNode *node_ptr = MakeNode<UnionQueryNode>(left, right, is_all);
     return node_ptr;
 }
 TableRefNode *NodeManager::MakeTableNode(const std::string &name, const std::string &alias) {
     return MakeTableNode("", name, alias);
 }
 TableRefNode *NodeManager::MakeTableNode(const std::string& db, const std::string &name, const std::string &alias) {
-    TableRefNode *node_ptr = new TableNode(db, name, alias);
-    RegisterNode(node_ptr);
+    TableRefNode *node_ptr = MakeNode<TableNode>(db, name, alias);
     return node_ptr;
 }
 
 TableRefNode *NodeManager::MakeJoinNode(const TableRefNode *left, const TableRefNode *right, const JoinType type,
                                         const ExprNode *condition, const std::string alias) {
-    TableRefNode *node_ptr = new JoinNode(left, right, type, nullptr, condition, alias);
-    RegisterNode(node_ptr);
+    TableRefNode *node_ptr = MakeNode<JoinNode>(left, right, type, nullptr, condition, alias);
     return node_ptr;
 }
 
@@ -70,25 +70,23 @@ TableRefNode *NodeManager::MakeLastJoinNode(const TableRefNode *left, const Tabl
         LOG(WARNING) << "fail to create last join node with invalid order type " + NameOfSqlNodeType(orders->GetType());
         return nullptr;
     }
-    TableRefNode *node_ptr =
-        new JoinNode(left, right, node::kJoinTypeLast, dynamic_cast<const OrderByNode *>(orders), condition, alias);
-    RegisterNode(node_ptr);
+    TableRefNode *node_ptr = MakeNode<JoinNode>(left, right, node::kJoinTypeLast,
+                                                dynamic_cast<const OrderByNode *>(orders), condition, alias);
     return node_ptr;
 }
 
 TableRefNode *NodeManager::MakeQueryRefNode(const QueryNode *sub_query, const std::string &alias) {
-    TableRefNode *node_ptr = new QueryRefNode(sub_query, alias);
-    RegisterNode(node_ptr);
+    TableRefNode *node_ptr = MakeNode<QueryRefNode>(sub_query, alias);
     return node_ptr;
 }
 SqlNode *NodeManager::MakeResTargetNode(ExprNode *node, const std::string &name) {
-    ResTarget *node_ptr = new ResTarget(name, node);
-    return RegisterNode(node_ptr);
+    ResTarget *node_ptr = MakeNode<ResTarget>(name, node);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeLimitNode(int count) {
-    LimitNode *node_ptr = new LimitNode(count);
-    return RegisterNode(node_ptr);
+    LimitNode *node_ptr = MakeNode<LimitNode>(count);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeWindowDefNode(ExprListNode *partitions, ExprNode *orders, SqlNode *frame) {
     return MakeWindowDefNode(nullptr, partitions, orders, frame, false, false);
@@ -99,7 +97,7 @@ SqlNode *NodeManager::MakeWindowDefNode(ExprListNode *partitions, ExprNode *orde
 }
 SqlNode *NodeManager::MakeWindowDefNode(SqlNodeList *union_tables, ExprListNode *partitions, ExprNode *orders,
                                         SqlNode *frame, bool exclude_current_time, bool instance_not_in_window) {
-    WindowDefNode *node_ptr = new WindowDefNode();
+    WindowDefNode *node_ptr = MakeNode<WindowDefNode>();
     if (nullptr != orders) {
         if (node::kExprOrder != orders->GetExprType()) {
             LOG(WARNING) << "fail to create window node with invalid order type " +
@@ -114,13 +112,13 @@ SqlNode *NodeManager::MakeWindowDefNode(SqlNodeList *union_tables, ExprListNode
     node_ptr->set_union_tables(union_tables);
     node_ptr->SetPartitions(partitions);
     node_ptr->SetFrame(dynamic_cast<FrameNode *>(frame));
-    return RegisterNode(node_ptr);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeWindowDefNode(const std::string &name) {
-    WindowDefNode *node_ptr = new WindowDefNode();
+    WindowDefNode *node_ptr = MakeNode<WindowDefNode>();
     node_ptr->SetName(name);
-    return RegisterNode(node_ptr);
+    return node_ptr;
 }
 
 WindowDefNode *NodeManager::MergeWindow(const WindowDefNode *w1, const WindowDefNode *w2) {
@@ -200,8 +198,8 @@ FrameNode *NodeManager::MergeFrameNode(const FrameNode *frame1, const FrameNode
     return dynamic_cast<FrameNode *>(MakeFrameNode(frame_type, frame_range, frame_rows, maxsize));
 }
 SqlNode *NodeManager::MakeFrameBound(BoundType bound_type) {
-    FrameBound *node_ptr = new FrameBound(bound_type);
-    return RegisterNode(node_ptr);
+    FrameBound *node_ptr = MakeNode<FrameBound>(bound_type);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeFrameBound(BoundType bound_type, ExprNode *expr) {
@@ -217,16 +215,16 @@ SqlNode *NodeManager::MakeFrameBound(BoundType bound_type, ExprNode *expr) {
         case node::DataType::kInt32:
         case node::DataType::kInt64: {
             offset = primary->GetAsInt64();
-            FrameBound *node_ptr = new FrameBound(bound_type, offset, false);
-            return RegisterNode(node_ptr);
+            FrameBound *node_ptr = MakeNode<FrameBound>(bound_type, offset, false);
+            return node_ptr;
         }
         case node::DataType::kDay:
         case node::DataType::kHour:
         case node::DataType::kMinute:
         case node::DataType::kSecond: {
             offset = (primary->GetMillis());
-            FrameBound *node_ptr = new FrameBound(bound_type, offset, true);
-            return RegisterNode(node_ptr);
+            FrameBound *node_ptr = MakeNode<FrameBound>(bound_type, offset, true);
+            return node_ptr;
         } break;
         default: {
             LOG(WARNING) << "cannot create window frame, only support "
@@ -236,12 +234,12 @@ SqlNode *NodeManager::MakeFrameBound(BoundType bound_type, ExprNode *expr) {
     }
 }
 SqlNode *NodeManager::MakeFrameBound(BoundType bound_type, int64_t offset) {
-    FrameBound *node_ptr = new FrameBound(bound_type, offset, false);
-    return RegisterNode(node_ptr);
+    FrameBound *node_ptr = MakeNode<FrameBound>(bound_type, offset, false);
+    return node_ptr;
 }
 FrameExtent *NodeManager::MakeFrameExtent(SqlNode *start, SqlNode *end) {
-    FrameExtent *node_ptr = new FrameExtent(dynamic_cast<FrameBound *>(start), dynamic_cast<FrameBound *>(end));
-    return RegisterNode(node_ptr);
+    FrameExtent *node_ptr = MakeNode<FrameExtent>(dynamic_cast<FrameBound *>(start), dynamic_cast<FrameBound *>(end));
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeFrameNode(FrameType frame_type, SqlNode *frame_extent) {
     int64_t max_size = 0;
@@ -279,15 +277,15 @@ SqlNode *NodeManager::MakeFrameNode(FrameType frame_type, SqlNode *frame_extent,
     switch (frame_type) {
         case kFrameRows: {
             FrameNode *node_ptr =
-                new FrameNode(frame_type, nullptr, dynamic_cast<FrameExtent *>(frame_extent), maxsize);
-            return RegisterNode(node_ptr);
+                MakeNode<FrameNode>(frame_type, nullptr, dynamic_cast<FrameExtent *>(frame_extent), maxsize);
+            return node_ptr;
         }
         case kFrameRange:
         case kFrameRowsRange:
         case kFrameRowsMergeRowsRange: {
             FrameNode *node_ptr =
-                new FrameNode(frame_type, dynamic_cast<FrameExtent *>(frame_extent), nullptr, maxsize);
-            return RegisterNode(node_ptr);
+                MakeNode<FrameNode>(frame_type, dynamic_cast<FrameExtent *>(frame_extent), nullptr, maxsize);
+            return node_ptr;
         }
     }
     return nullptr;
@@ -295,44 +293,44 @@ SqlNode *NodeManager::MakeFrameNode(FrameType frame_type, SqlNode *frame_extent,
 
 SqlNode *NodeManager::MakeFrameNode(FrameType frame_type, FrameExtent *frame_range, FrameExtent *frame_rows,
                                     int64_t maxsize) {
-    FrameNode *node_ptr = new FrameNode(frame_type, frame_range, frame_rows, maxsize);
-    return RegisterNode(node_ptr);
+    FrameNode *node_ptr = MakeNode<FrameNode>(frame_type, frame_range, frame_rows, maxsize);
+    return node_ptr;
 }
 OrderExpression *NodeManager::MakeOrderExpression(const ExprNode *expr, const bool is_asc) {
-    OrderExpression *node_ptr = new OrderExpression(expr, is_asc);
-    return RegisterNode(node_ptr);
+    OrderExpression *node_ptr = MakeNode<OrderExpression>(expr, is_asc);
+    return node_ptr;
 }
 OrderByNode *NodeManager::MakeOrderByNode(const ExprListNode *order_expressions) {
-    OrderByNode *node_ptr = new OrderByNode(order_expressions);
-    return RegisterNode(node_ptr);
+    OrderByNode *node_ptr = MakeNode<OrderByNode>(order_expressions);
+    return node_ptr;
 }
 
 ColumnRefNode *NodeManager::MakeColumnRefNode(const std::string &column_name, const std::string &relation_name,
                                               const std::string &db_name) {
-    ColumnRefNode *node_ptr = new ColumnRefNode(column_name, relation_name, db_name);
+    ColumnRefNode *node_ptr = MakeNode<ColumnRefNode>(column_name, relation_name, db_name);
 
-    return RegisterNode(node_ptr);
+    return node_ptr;
 }
 
-ColumnIdNode *NodeManager::MakeColumnIdNode(size_t column_id) { return RegisterNode(new ColumnIdNode(column_id)); }
+ColumnIdNode *NodeManager::MakeColumnIdNode(size_t column_id) { return MakeNode<ColumnIdNode>(column_id); }
 
 GetFieldExpr *NodeManager::MakeGetFieldExpr(ExprNode *input, const std::string &column_name, size_t column_id) {
-    return RegisterNode(new GetFieldExpr(input, column_name, column_id));
+    return MakeNode<GetFieldExpr>(input, column_name, column_id);
 }
 GetFieldExpr *NodeManager::MakeGetFieldExpr(ExprNode *input, size_t idx) {
-    return RegisterNode(new GetFieldExpr(input, std::to_string(idx), idx));
+    return MakeNode<GetFieldExpr>(input, std::to_string(idx), idx);
 }
 
 ColumnRefNode *NodeManager::MakeColumnRefNode(const std::string &column_name, const std::string &relation_name) {
     return MakeColumnRefNode(column_name, relation_name, "");
 }
 CastExprNode *NodeManager::MakeCastNode(const node::DataType cast_type, ExprNode *expr) {
-    CastExprNode *node_ptr = new CastExprNode(cast_type, expr);
-    return RegisterNode(node_ptr);
+    CastExprNode *node_ptr = MakeNode<CastExprNode>(cast_type, expr);
+    return node_ptr;
 }
 WhenExprNode *NodeManager::MakeWhenNode(ExprNode *when_expr, ExprNode *then_expr) {
-    WhenExprNode *node_ptr = new WhenExprNode(when_expr, then_expr);
-    return RegisterNode(node_ptr);
+    WhenExprNode *node_ptr = MakeNode<WhenExprNode>(when_expr, then_expr);
+    return node_ptr;
 }
 ExprNode *NodeManager::MakeSimpleCaseWhenNode(ExprNode *case_expr, ExprListNode *when_list_expr, ExprNode *else_expr) {
     if (nullptr == when_list_expr || when_list_expr->GetChildNum() == 0) {
@@ -354,8 +352,8 @@ ExprNode *NodeManager::MakeSearchedCaseWhenNode(ExprListNode *when_list_expr, Ex
     if (nullptr == else_expr) {
         else_expr = MakeConstNode();
     }
-    CaseWhenExprNode *node_ptr = new CaseWhenExprNode(when_list_expr, else_expr);
-    return RegisterNode(node_ptr);
+    CaseWhenExprNode *node_ptr = MakeNode<CaseWhenExprNode>(when_list_expr, else_expr);
+    return node_ptr;
 }
 
 CallExprNode *NodeManager::MakeFuncNode(const std::string &name, const std::vector<ExprNode *> &args,
@@ -365,19 +363,19 @@ CallExprNode *NodeManager::MakeFuncNode(const std::string &name, const std::vect
         args_node.AddChild(child);
     }
     FnDefNode *def_node = dynamic_cast<FnDefNode *>(MakeUnresolvedFnDefNode(name));
-    CallExprNode *node_ptr = new CallExprNode(def_node, &args_node, dynamic_cast<const WindowDefNode *>(over));
-    return RegisterNode(node_ptr);
+    CallExprNode *node_ptr = MakeNode<CallExprNode>(def_node, &args_node, dynamic_cast<const WindowDefNode *>(over));
+    return node_ptr;
 }
 
 CallExprNode *NodeManager::MakeFuncNode(const std::string &name, ExprListNode *list_ptr, const SqlNode *over) {
     FnDefNode *def_node = dynamic_cast<FnDefNode *>(MakeUnresolvedFnDefNode(name));
-    CallExprNode *node_ptr = new CallExprNode(def_node, list_ptr, dynamic_cast<const WindowDefNode *>(over));
-    return RegisterNode(node_ptr);
+    CallExprNode *node_ptr = MakeNode<CallExprNode>(def_node, list_ptr, dynamic_cast<const WindowDefNode *>(over));
+    return node_ptr;
 }
 
 CallExprNode *NodeManager::MakeFuncNode(FnDefNode *fn, ExprListNode *list_ptr, const SqlNode *over) {
-    CallExprNode *node_ptr = new CallExprNode(fn, list_ptr, dynamic_cast<const WindowDefNode *>(over));
-    return RegisterNode(node_ptr);
+    CallExprNode *node_ptr = MakeNode<CallExprNode>(fn, list_ptr, dynamic_cast<const WindowDefNode *>(over));
+    return node_ptr;
 }
 
 CallExprNode *NodeManager::MakeFuncNode(FnDefNode *fn, const std::vector<ExprNode *> &args, const SqlNode *over) {
@@ -385,72 +383,72 @@ CallExprNode *NodeManager::MakeFuncNode(FnDefNode *fn, const std::vector<ExprNod
     for (auto child : args) {
         args_node.AddChild(child);
     }
-    CallExprNode *node_ptr = new CallExprNode(fn, &args_node, dynamic_cast<const WindowDefNode *>(over));
-    return RegisterNode(node_ptr);
+    CallExprNode *node_ptr = MakeNode<CallExprNode>(fn, &args_node, dynamic_cast<const WindowDefNode *>(over));
+    return node_ptr;
 }
 
-ConstNode *NodeManager::MakeConstNode(bool value) { return RegisterNode(new ConstNode(value)); }
-ConstNode *NodeManager::MakeConstNode(int16_t value) { return RegisterNode(new ConstNode(value)); }
-ConstNode *NodeManager::MakeConstNode(int value) { return RegisterNode(new ConstNode(value)); }
+ConstNode *NodeManager::MakeConstNode(bool value) { return MakeNode<ConstNode>(value); }
+ConstNode *NodeManager::MakeConstNode(int16_t value) { return MakeNode<ConstNode>(value); }
+ConstNode *NodeManager::MakeConstNode(int value) { return MakeNode<ConstNode>(value); }
 
 ConstNode *NodeManager::MakeConstNode(int value, TTLType ttl_type) {
-    return RegisterNode(new ConstNode(value, ttl_type));
+    return MakeNode<ConstNode>(value, ttl_type);
 }
 
-ConstNode *NodeManager::MakeConstNode(int64_t value) { return RegisterNode(new ConstNode(value)); }
+ConstNode *NodeManager::MakeConstNode(int64_t value) { return MakeNode<ConstNode>(value); }
 
 ConstNode *NodeManager::MakeConstNode(int64_t value, TTLType ttl_type) {
-    return RegisterNode(new ConstNode(value, ttl_type));
+    return MakeNode<ConstNode>(value, ttl_type);
 }
 
 ConstNode *NodeManager::MakeConstNode(int64_t value, DataType time_type) {
-    return RegisterNode(new ConstNode(value, time_type));
+    return MakeNode<ConstNode>(value, time_type);
 }
 
-ConstNode *NodeManager::MakeConstNode(float value) { return RegisterNode(new ConstNode(value)); }
+ConstNode *NodeManager::MakeConstNode(float value) { return MakeNode<ConstNode>(value); }
 
-ConstNode *NodeManager::MakeConstNode(double value) { return RegisterNode(new ConstNode(value)); }
+ConstNode *NodeManager::MakeConstNode(double value) { return MakeNode<ConstNode>(value); }
 
-ConstNode *NodeManager::MakeConstNode(const char *value) { return RegisterNode(new ConstNode(value)); }
-ConstNode *NodeManager::MakeConstNode(const std::string &value) { return RegisterNode(new ConstNode(value)); }
-ConstNode *NodeManager::MakeConstNode() { return RegisterNode(new ConstNode()); }
+ConstNode *NodeManager::MakeConstNode(const char *value) { return MakeNode<ConstNode>(value); }
+ConstNode *NodeManager::MakeConstNode(const std::string &value) { return MakeNode<ConstNode>(value); }
+ConstNode *NodeManager::MakeConstNode() { return MakeNode<ConstNode>(); }
 
-ConstNode *NodeManager::MakeConstNode(DataType type) { return RegisterNode(new ConstNode(type)); }
+ConstNode *NodeManager::MakeConstNode(DataType type) { return MakeNode<ConstNode>(type); }
 ParameterExpr *NodeManager::MakeParameterExpr(int position) {
-    ParameterExpr *node_ptr = new ParameterExpr(position);
-    return RegisterNode(node_ptr);
+    ParameterExpr *node_ptr = MakeNode<ParameterExpr>(position);
+    return node_ptr;
 }
 ExprIdNode *NodeManager::MakeExprIdNode(const std::string &name) {
-    return RegisterNode(new ::hybridse::node::ExprIdNode(name, exprid_idx_counter_++));
+    return MakeNode<::hybridse::node::ExprIdNode>(name, exprid_idx_counter_++);
 }
 ExprIdNode *NodeManager::MakeUnresolvedExprId(const std::string &name) {
-    return RegisterNode(new ::hybridse::node::ExprIdNode(name, -1));
+    return MakeNode<::hybridse::node::ExprIdNode>(name, -1);
 }
 
 BinaryExpr *NodeManager::MakeBinaryExprNode(ExprNode *left, ExprNode *right, FnOperator op) {
-    ::hybridse::node::BinaryExpr *bexpr = new ::hybridse::node::BinaryExpr(op);
+    ::hybridse::node::BinaryExpr *bexpr = MakeNode<::hybridse::node::BinaryExpr>(op);
     bexpr->AddChild(left);
     bexpr->AddChild(right);
-    return RegisterNode(bexpr);
+    return bexpr;
 }
 
 UnaryExpr *NodeManager::MakeUnaryExprNode(ExprNode *left, FnOperator op) {
-    ::hybridse::node::UnaryExpr *uexpr = new ::hybridse::node::UnaryExpr(op);
+    ::hybridse::node::UnaryExpr *uexpr = MakeNode<::hybridse::node::UnaryExpr>(op);
     uexpr->AddChild(left);
-    return RegisterNode(uexpr);
+    return uexpr;
 }
 
 SqlNode *NodeManager::MakeCreateTableNode(bool op_if_not_exist, const std::string &db_name,
                                           const std::string &table_name, SqlNodeList *column_desc_list,
                                           SqlNodeList *table_option_list) {
-    CreateStmt *node_ptr = new CreateStmt(db_name, table_name, op_if_not_exist);
+    CreateStmt *node_ptr = MakeNode<CreateStmt>(db_name, table_name, op_if_not_exist);
     FillSqlNodeList2NodeVector(column_desc_list, *(node_ptr->MutableColumnDefList()));
     FillSqlNodeList2NodeVector(table_option_list, *(node_ptr->MutableTableOptionList()));
-    return RegisterNode(node_ptr);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeColumnIndexNode(SqlNodeList *index_item_list) {
-    ColumnIndexNode *index_ptr = new ColumnIndexNode();
+    ColumnIndexNode *index_ptr = MakeNode<ColumnIndexNode>();
     if (nullptr != index_item_list && 0 != index_item_list->GetSize()) {
         for (auto node_ptr : index_item_list->GetList()) {
             switch (node_ptr->GetType()) {
@@ -482,271 +480,260 @@ SqlNode *NodeManager::MakeColumnIndexNode(SqlNodeList *index_item_list) {
             }
         }
     }
-    return RegisterNode(index_ptr);
+    return index_ptr;
 }
 SqlNode *NodeManager::MakeColumnIndexNode(SqlNodeList *keys, SqlNode *ts, SqlNode *ttl, SqlNode *version) {
-    SqlNode *node_ptr = new SqlNode(kColumnIndex, 0, 0);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<SqlNode>(kColumnIndex, 0, 0);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeColumnDescNode(const std::string &column_name, const DataType data_type, bool op_not_null,
                                          ExprNode *default_value) {
-    SqlNode *node_ptr = new ColumnDefNode(column_name, data_type, op_not_null, default_value);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<ColumnDefNode>(column_name, data_type, op_not_null, default_value);
+    return node_ptr;
 }
 
 SqlNodeList *NodeManager::MakeNodeList() {
-    SqlNodeList *new_list_ptr = new SqlNodeList();
-    RegisterNode(new_list_ptr);
+    SqlNodeList *new_list_ptr = MakeNode<SqlNodeList>();
     return new_list_ptr;
 }
 
 SqlNodeList *NodeManager::MakeNodeList(SqlNode *node) {
-    SqlNodeList *new_list_ptr = new SqlNodeList();
+    SqlNodeList *new_list_ptr = MakeNode<SqlNodeList>();
     new_list_ptr->PushBack(node);
-    RegisterNode(new_list_ptr);
     return new_list_ptr;
 }
 
 ExprListNode *NodeManager::MakeExprList() {
-    ExprListNode *new_list_ptr = new ExprListNode();
-    RegisterNode(new_list_ptr);
+    ExprListNode *new_list_ptr = MakeNode<ExprListNode>();
     return new_list_ptr;
 }
 ExprListNode *NodeManager::MakeExprList(ExprNode *expr_node) {
-    ExprListNode *new_list_ptr = new ExprListNode();
+    ExprListNode *new_list_ptr = MakeNode<ExprListNode>();
     new_list_ptr->AddChild(expr_node);
-    RegisterNode(new_list_ptr);
     return new_list_ptr;
 }
 
 PlanNode *NodeManager::MakeLeafPlanNode(const PlanType &type) {
-    PlanNode *node_ptr = new LeafPlanNode(type);
-    RegisterNode(node_ptr);
+    PlanNode *node_ptr = MakeNode<LeafPlanNode>(type);
     return node_ptr;
 }
 
 PlanNode *NodeManager::MakeUnaryPlanNode(const PlanType &type) {
-    PlanNode *node_ptr = new UnaryPlanNode(type);
-    RegisterNode(node_ptr);
+    PlanNode *node_ptr = MakeNode<UnaryPlanNode>(type);
     return node_ptr;
 }
 
 PlanNode *NodeManager::MakeBinaryPlanNode(const PlanType &type) {
-    PlanNode *node_ptr = new BinaryPlanNode(type);
-    RegisterNode(node_ptr);
+    PlanNode *node_ptr = MakeNode<BinaryPlanNode>(type);
     return node_ptr;
 }
 
 PlanNode *NodeManager::MakeMultiPlanNode(const PlanType &type) {
-    PlanNode *node_ptr = new MultiChildPlanNode(type);
-    RegisterNode(node_ptr);
+    PlanNode *node_ptr = MakeNode<MultiChildPlanNode>(type);
     return node_ptr;
 }
 
 PlanNode *NodeManager::MakeTablePlanNode(const std::string& db, const std::string &table_name) {
-    PlanNode *node_ptr = new TablePlanNode(db, table_name);
-    return RegisterNode(node_ptr);
+    PlanNode *node_ptr = MakeNode<TablePlanNode>(db, table_name);
+    return node_ptr;
 }
 
 PlanNode *NodeManager::MakeRenamePlanNode(PlanNode *node, std::string alias_name) {
-    PlanNode *node_ptr = new RenamePlanNode(node, alias_name);
-    return RegisterNode(node_ptr);
+    PlanNode *node_ptr = MakeNode<RenamePlanNode>(node, alias_name);
+    return node_ptr;
 }
 
 FilterPlanNode *NodeManager::MakeFilterPlanNode(PlanNode *node, const ExprNode *condition) {
-    node::FilterPlanNode *node_ptr = new FilterPlanNode(node, condition);
-    RegisterNode(node_ptr);
+    node::FilterPlanNode *node_ptr = MakeNode<FilterPlanNode>(node, condition);
     return node_ptr;
 }
 
 WindowPlanNode *NodeManager::MakeWindowPlanNode(int w_id) {
-    WindowPlanNode *node_ptr = new WindowPlanNode(w_id);
-    RegisterNode(node_ptr);
+    WindowPlanNode *node_ptr = MakeNode<WindowPlanNode>(w_id);
     return node_ptr;
 }
 
 ProjectListNode *NodeManager::MakeProjectListPlanNode(const WindowPlanNode *w_ptr, const bool need_agg) {
-    ProjectListNode *node_ptr = new ProjectListNode(w_ptr, need_agg);
-    RegisterNode(node_ptr);
+    ProjectListNode *node_ptr = MakeNode<ProjectListNode>(w_ptr, need_agg);
     return node_ptr;
 }
 
 FnNode *NodeManager::MakeFnHeaderNode(const std::string &name, FnNodeList *plist, const TypeNode *return_type) {
-    ::hybridse::node::FnNodeFnHeander *fn_header = new FnNodeFnHeander(name, plist, return_type);
-    return RegisterNode(fn_header);
+    ::hybridse::node::FnNodeFnHeander *fn_header = MakeNode<FnNodeFnHeander>(name, plist, return_type);
+    return fn_header;
 }
 
 FnNode *NodeManager::MakeFnDefNode(const FnNode *header, FnNodeList *block) {
-    ::hybridse::node::FnNodeFnDef *fn_def = new FnNodeFnDef(dynamic_cast<const FnNodeFnHeander *>(header), block);
-    return RegisterNode(fn_def);
+    ::hybridse::node::FnNodeFnDef *fn_def = MakeNode<FnNodeFnDef>(dynamic_cast<const FnNodeFnHeander *>(header), block);
+    return fn_def;
 }
 FnNode *NodeManager::MakeAssignNode(const std::string &name, ExprNode *expression) {
     auto var = MakeExprIdNode(name);
-    ::hybridse::node::FnAssignNode *fn_assign = new hybridse::node::FnAssignNode(var, expression);
-    return RegisterNode(fn_assign);
+    ::hybridse::node::FnAssignNode *fn_assign = MakeNode<hybridse::node::FnAssignNode>(var, expression);
+    return fn_assign;
 }
 
 FnNode *NodeManager::MakeAssignNode(const std::string &name, ExprNode *expression, const FnOperator op) {
     auto lhs_var = MakeExprIdNode(name);
     auto rhs_var = MakeUnresolvedExprId(name);
     ::hybridse::node::FnAssignNode *fn_assign =
-        new hybridse::node::FnAssignNode(lhs_var, MakeBinaryExprNode(rhs_var, expression, op));
-    return RegisterNode(fn_assign);
+        MakeNode<hybridse::node::FnAssignNode>(lhs_var, MakeBinaryExprNode(rhs_var, expression, op));
+    return fn_assign;
 }
 FnNode *NodeManager::MakeReturnStmtNode(ExprNode *value) {
-    FnNode *fn_node = new FnReturnStmt(value);
-    return RegisterNode(fn_node);
+    FnNode *fn_node = MakeNode<FnReturnStmt>(value);
+    return fn_node;
 }
 
 FnNode *NodeManager::MakeIfStmtNode(ExprNode *value) {
-    FnNode *fn_node = new FnIfNode(value);
-    return RegisterNode(fn_node);
+    FnNode *fn_node = MakeNode<FnIfNode>(value);
+    return fn_node;
 }
 FnNode *NodeManager::MakeElseStmtNode() {
-    FnNode *fn_node = new FnElseNode();
-    return RegisterNode(fn_node);
+    FnNode *fn_node = MakeNode<FnElseNode>();
+    return fn_node;
 }
 FnNode *NodeManager::MakeElifStmtNode(ExprNode *value) {
-    FnNode *fn_node = new FnElifNode(value);
-    return RegisterNode(fn_node);
+    FnNode *fn_node = MakeNode<FnElifNode>(value);
+    return fn_node;
 }
-FnNode *NodeManager::MakeFnNode(const SqlNodeType &type) { return RegisterNode(new FnNode(type)); }
+FnNode *NodeManager::MakeFnNode(const SqlNodeType &type) { return MakeNode<FnNode>(type); }
 
 FnNodeList *NodeManager::MakeFnListNode() {
-    FnNodeList *fn_list = new FnNodeList();
-    RegisterNode(fn_list);
+    FnNodeList *fn_list = MakeNode<FnNodeList>();
     return fn_list;
 }
 FnNodeList *NodeManager::MakeFnListNode(node::FnNode *fn_node) {
-    FnNodeList *fn_list = new FnNodeList();
+    FnNodeList *fn_list = MakeNode<FnNodeList>();
     fn_list->AddChild(fn_node);
-    RegisterNode(fn_list);
     return fn_list;
 }
 
 FnIfBlock *NodeManager::MakeFnIfBlock(FnIfNode *if_node, FnNodeList *block) {
-    ::hybridse::node::FnIfBlock *if_block = new ::hybridse::node::FnIfBlock(if_node, block);
-    RegisterNode(if_block);
+    ::hybridse::node::FnIfBlock *if_block = MakeNode<::hybridse::node::FnIfBlock>(if_node, block);
     return if_block;
 }
 
 FnElifBlock *NodeManager::MakeFnElifBlock(FnElifNode *elif_node, FnNodeList *block) {
-    ::hybridse::node::FnElifBlock *elif_block = new ::hybridse::node::FnElifBlock(elif_node, block);
-    RegisterNode(elif_block);
+    ::hybridse::node::FnElifBlock *elif_block = MakeNode<::hybridse::node::FnElifBlock>(elif_node, block);
     return elif_block;
 }
 FnIfElseBlock *NodeManager::MakeFnIfElseBlock(FnIfBlock *if_block, const std::vector<FnNode *> &elif_blocks,
                                               FnElseBlock *else_block) {
     ::hybridse::node::FnIfElseBlock *if_else_block =
-        new ::hybridse::node::FnIfElseBlock(if_block, elif_blocks, else_block);
-    RegisterNode(if_else_block);
+        MakeNode<::hybridse::node::FnIfElseBlock>(if_block, elif_blocks, else_block);
     return if_else_block;
 }
 FnElseBlock *NodeManager::MakeFnElseBlock(FnNodeList *block) {
-    ::hybridse::node::FnElseBlock *else_block = new ::hybridse::node::FnElseBlock(block);
-    RegisterNode(else_block);
+    ::hybridse::node::FnElseBlock *else_block = MakeNode<::hybridse::node::FnElseBlock>(block);
     return else_block;
 }
 
 FnParaNode *NodeManager::MakeFnParaNode(const std::string &name, const TypeNode *para_type) {
     auto expr_id = MakeExprIdNode(name);
     expr_id->SetOutputType(para_type);
-    ::hybridse::node::FnParaNode *para_node = new ::hybridse::node::FnParaNode(expr_id);
-    return RegisterNode(para_node);
+    ::hybridse::node::FnParaNode *para_node = MakeNode<::hybridse::node::FnParaNode>(expr_id);
+    return para_node;
 }
 SqlNode *NodeManager::MakeIndexKeyNode(const std::string &key) {
-    SqlNode *node_ptr = new IndexKeyNode(key);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<IndexKeyNode>(key);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeIndexKeyNode(const std::vector<std::string> &keys) {
-    SqlNode *node_ptr = new IndexKeyNode(keys);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<IndexKeyNode>(keys);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeIndexTsNode(const std::string &ts) {
-    SqlNode *node_ptr = new IndexTsNode(ts);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<IndexTsNode>(ts);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeIndexTTLNode(ExprListNode *ttl_expr) {
-    SqlNode *node_ptr = new IndexTTLNode(ttl_expr);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<IndexTTLNode>(ttl_expr);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeIndexTTLTypeNode(const std::string &ttl_type) {
-    SqlNode *node_ptr = new IndexTTLTypeNode(ttl_type);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<IndexTTLTypeNode>(ttl_type);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeIndexVersionNode(const std::string &version) {
-    SqlNode *node_ptr = new IndexVersionNode(version);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<IndexVersionNode>(version);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeIndexVersionNode(const std::string &version, int count) {
-    SqlNode *node_ptr = new IndexVersionNode(version, count);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<IndexVersionNode>(version, count);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeCmdNode(node::CmdType cmd_type) {
-    SqlNode *node_ptr = new CmdNode(cmd_type);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<CmdNode>(cmd_type);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeCmdNode(node::CmdType cmd_type, const std::string &arg) {
-    CmdNode *node_ptr = new CmdNode(cmd_type);
+    CmdNode *node_ptr = MakeNode<CmdNode>(cmd_type);
     node_ptr->AddArg(arg);
-    return RegisterNode(node_ptr);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeCmdNode(node::CmdType cmd_type, const std::vector<std::string> &args) {
-    CmdNode *node_ptr = new CmdNode(cmd_type);
+    CmdNode *node_ptr = MakeNode<CmdNode>(cmd_type);
     for (auto const & arg : args) {
         node_ptr->AddArg(arg);
     }
-    return RegisterNode(node_ptr);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeCmdNode(node::CmdType cmd_type, const std::string &arg1,
                                   const std::string &arg2) {
-    CmdNode *node_ptr = new CmdNode(cmd_type);
+    CmdNode *node_ptr = MakeNode<CmdNode>(cmd_type);
     node_ptr->AddArg(arg1);
     node_ptr->AddArg(arg2);
-    return RegisterNode(node_ptr);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeCreateIndexNode(const std::string &index_name,
                                           const std::string &db_name,
                                           const std::string &table_name,
                                           ColumnIndexNode *index) {
-    CreateIndexNode *node_ptr = new CreateIndexNode(index_name, db_name, table_name, index);
-    return RegisterNode(node_ptr);
+    CreateIndexNode *node_ptr = MakeNode<CreateIndexNode>(index_name, db_name, table_name, index);
+    return node_ptr;
 }
 
 DeployNode *NodeManager::MakeDeployStmt(const std::string &name, const SqlNode *stmt, const std::string &stmt_str,
                                         const std::shared_ptr<OptionsMap> options, bool if_not_exist) {
-    DeployNode *node = new DeployNode(name, stmt, stmt_str, std::move(options), if_not_exist);
-    return RegisterNode(node);
+    DeployNode *node = MakeNode<DeployNode>(name, stmt, stmt_str, std::move(options), if_not_exist);
+    return node;
 }
 
 DeployPlanNode *NodeManager::MakeDeployPlanNode(const std::string &name, const SqlNode *stmt,
                                                 const std::string &stmt_str, const std::shared_ptr<OptionsMap> options,
                                                 bool if_not_exist) {
-    DeployPlanNode *node = new DeployPlanNode(name, stmt, stmt_str, std::move(options), if_not_exist);
-    return RegisterNode(node);
+    DeployPlanNode *node = MakeNode<DeployPlanNode>(name, stmt, stmt_str, std::move(options), if_not_exist);
+    return node;
 }
 DeleteNode* NodeManager::MakeDeleteNode(DeleteTarget target, std::string_view job_id) {
-    auto node = new DeleteNode(target, std::string(job_id.data(), job_id.size()));
-    return RegisterNode(node);
+    auto node = MakeNode<DeleteNode>(target, std::string(job_id.data(), job_id.size()));
+    return node;
+}
+DeleteNode* NodeManager::MakeDeleteNode(const std::string& db_name, const std::string& table_name,
+                                        const ExprNode* condition) {
+    auto node = MakeNode<DeleteNode>(db_name, table_name, condition);
+    return node;
 }
 DeletePlanNode* NodeManager::MakeDeletePlanNode(const DeleteNode* n) {
-    auto node = new DeletePlanNode(n->GetTarget(), n->GetJobId());
-    return RegisterNode(node);
+    auto node = MakeNode<DeletePlanNode>(n->GetTarget(), n->GetJobId(), n->GetDbName(), n->GetTableName(),
+                                         n->GetCondition());
+    return node;
 }
 LoadDataNode *NodeManager::MakeLoadDataNode(const std::string &file_name, const std::string &db,
                                             const std::string &table,
                                             const std::shared_ptr<OptionsMap> options,
                                             const std::shared_ptr<OptionsMap> config_option) {
-    LoadDataNode *node = new LoadDataNode(file_name, db, table, std::move(options), std::move(config_option));
-    return RegisterNode(node);
+    LoadDataNode *node = MakeNode<LoadDataNode>(file_name, db, table, std::move(options), std::move(config_option));
+    return node;
 }
 LoadDataPlanNode *NodeManager::MakeLoadDataPlanNode(const std::string &file_name, const std::string &db,
                                                     const std::string &table, const std::shared_ptr<OptionsMap> options,
                                                     const std::shared_ptr<OptionsMap> config_option) {
-    LoadDataPlanNode *node = new LoadDataPlanNode(file_name, db, table, options, config_option);
-    return RegisterNode(node);
+    LoadDataPlanNode *node = MakeNode<LoadDataPlanNode>(file_name, db, table, options, config_option);
+    return node;
 }
 
 CreateFunctionPlanNode *NodeManager::MakeCreateFunctionPlanNode(const std::string &function_name,
@@ -754,46 +741,47 @@ CreateFunctionPlanNode *NodeManager::MakeCreateFunctionPlanNode(const std::strin
                                                                const NodePointVector& args_type,
                                                                bool is_aggregate,
                                                                std::shared_ptr<OptionsMap> options) {
-    auto node = new CreateFunctionPlanNode(function_name, return_type, args_type, is_aggregate, options);
-    return RegisterNode(node);
+    auto node = MakeNode<CreateFunctionPlanNode>(function_name, return_type, args_type, is_aggregate, options);
+    return node;
 }
 
 SelectIntoNode *NodeManager::MakeSelectIntoNode(const QueryNode *query, const std::string &query_str,
                                                 const std::string &out_file, const std::shared_ptr<OptionsMap> options,
                                                 const std::shared_ptr<OptionsMap> config_option) {
-    SelectIntoNode* node = new SelectIntoNode(query, query_str, out_file, std::move(options), std::move(config_option));
-    return RegisterNode(node);
+    SelectIntoNode* node =
+        MakeNode<SelectIntoNode>(query, query_str, out_file, std::move(options), std::move(config_option));
+    return node;
 }
 
 SelectIntoPlanNode *NodeManager::MakeSelectIntoPlanNode(PlanNode *query, const std::string &query_str,
                                                         const std::string &out_file,
                                                         const std::shared_ptr<OptionsMap> options,
                                                         const std::shared_ptr<OptionsMap> config_option) {
-    SelectIntoPlanNode* node = new SelectIntoPlanNode(query, query_str, out_file, options, config_option);
-    return RegisterNode(node);
+    SelectIntoPlanNode* node = MakeNode<SelectIntoPlanNode>(query, query_str, out_file, options, config_option);
+    return node;
 }
 
 SetNode* NodeManager::MakeSetNode(const node::VariableScope scope, const std::string &key, const
                                                       ConstNode *value) {
-    SetNode* node = new SetNode(scope, key, value);
-    return RegisterNode(node);
+    SetNode* node = MakeNode<SetNode>(scope, key, value);
+    return node;
 }
 SetPlanNode* NodeManager::MakeSetPlanNode(const SetNode *set_node) {
-    SetPlanNode* node = new SetPlanNode(set_node->Scope(), set_node->Key(), set_node->Value());
-    return RegisterNode(node);
+    SetPlanNode* node = MakeNode<SetPlanNode>(set_node->Scope(), set_node->Key(), set_node->Value());
+    return node;
 }
 
 AllNode *NodeManager::MakeAllNode(const std::string &relation_name) { return MakeAllNode(relation_name, ""); }
 
 AllNode *NodeManager::MakeAllNode(const std::string &relation_name, const std::string &db_name) {
-    return RegisterNode(new AllNode(relation_name, db_name));
+    return MakeNode<AllNode>(relation_name, db_name);
 }
 
 SqlNode *NodeManager::MakeInsertTableNode(const std::string &db_name, const std::string &table_name,
                                           const ExprListNode *columns_expr, const ExprListNode *values) {
     if (nullptr == columns_expr) {
-        InsertStmt *node_ptr = new InsertStmt(db_name, table_name, values->children_);
-        return RegisterNode(node_ptr);
+        InsertStmt *node_ptr = MakeNode<InsertStmt>(db_name, table_name, values->children_);
+        return node_ptr;
     } else {
         std::vector<std::string> column_names;
         for (auto expr : columns_expr->children_) {
@@ -809,82 +797,76 @@ SqlNode *NodeManager::MakeInsertTableNode(const std::string &db_name, const std:
                 }
             }
         }
-        InsertStmt *node_ptr = new InsertStmt(db_name, table_name, column_names, values->children_);
-        return RegisterNode(node_ptr);
+        InsertStmt *node_ptr = MakeNode<InsertStmt>(db_name, table_name, column_names, values->children_);
+        return node_ptr;
     }
 }
 
-DatasetNode *NodeManager::MakeDataset(const std::string &table) { return RegisterNode(new DatasetNode(table)); }
+DatasetNode *NodeManager::MakeDataset(const std::string &table) { return MakeNode<DatasetNode>(table); }
 
-MapNode *NodeManager::MakeMapNode(const NodePointVector &nodes) { return RegisterNode(new MapNode(nodes)); }
+MapNode *NodeManager::MakeMapNode(const NodePointVector &nodes) { return MakeNode<MapNode>(nodes); }
 
 TypeNode *NodeManager::MakeTypeNode(hybridse::node::DataType base) {
-    TypeNode *node_ptr = new TypeNode(base);
-    RegisterNode(node_ptr);
+    TypeNode *node_ptr = MakeNode<TypeNode>(base);
     return node_ptr;
 }
 TypeNode *NodeManager::MakeTypeNode(hybridse::node::DataType base, const hybridse::node::TypeNode *v1) {
-    TypeNode *node_ptr = new TypeNode(base, v1);
-    RegisterNode(node_ptr);
+    TypeNode *node_ptr = MakeNode<TypeNode>(base, v1);
     return node_ptr;
 }
 TypeNode *NodeManager::MakeTypeNode(hybridse::node::DataType base, hybridse::node::DataType v1) {
-    TypeNode *node_ptr = new TypeNode(base, MakeTypeNode(v1));
-    RegisterNode(node_ptr);
+    TypeNode *node_ptr = MakeNode<TypeNode>(base, MakeTypeNode(v1));
     return node_ptr;
 }
 TypeNode *NodeManager::MakeTypeNode(hybridse::node::DataType base, hybridse::node::DataType v1,
                                     hybridse::node::DataType v2) {
-    TypeNode *node_ptr = new TypeNode(base, MakeTypeNode(v1), MakeTypeNode(v2));
-    RegisterNode(node_ptr);
+    TypeNode *node_ptr = MakeNode<TypeNode>(base, MakeTypeNode(v1), MakeTypeNode(v2));
     return node_ptr;
 }
-OpaqueTypeNode *NodeManager::MakeOpaqueType(size_t bytes) { return RegisterNode(new OpaqueTypeNode(bytes)); }
+OpaqueTypeNode *NodeManager::MakeOpaqueType(size_t bytes) { return MakeNode<OpaqueTypeNode>(bytes); }
 RowTypeNode *NodeManager::MakeRowType(const std::vector<const codec::Schema *> &schema_source) {
-    return RegisterNode(new RowTypeNode(schema_source));
+    return MakeNode<RowTypeNode>(schema_source);
 }
 RowTypeNode *NodeManager::MakeRowType(const vm::SchemasContext *schemas_ctx) {
-    return RegisterNode(new RowTypeNode(schemas_ctx));
+    return MakeNode<RowTypeNode>(schemas_ctx);
 }
 
 FnNode *NodeManager::MakeForInStmtNode(const std::string &var_name, ExprNode *expression) {
     auto var = MakeExprIdNode(var_name);
-    FnForInNode *node_ptr = new FnForInNode(var, expression);
-    return RegisterNode(node_ptr);
+    FnForInNode *node_ptr = MakeNode<FnForInNode>(var, expression);
+    return node_ptr;
 }
 
 FnForInBlock *NodeManager::MakeForInBlock(FnForInNode *for_in_node, FnNodeList *block) {
-    FnForInBlock *node_ptr = new FnForInBlock(for_in_node, block);
-    RegisterNode(node_ptr);
+    FnForInBlock *node_ptr = MakeNode<FnForInBlock>(for_in_node, block);
     return node_ptr;
 }
 PlanNode *NodeManager::MakeJoinNode(PlanNode *left, PlanNode *right, JoinType join_type, const OrderByNode *order_by,
                                     const ExprNode *condition) {
-    node::JoinPlanNode *node_ptr = new JoinPlanNode(left, right, join_type, order_by, condition);
-    return RegisterNode(node_ptr);
+    node::JoinPlanNode *node_ptr = MakeNode<JoinPlanNode>(left, right, join_type, order_by, condition);
+    return node_ptr;
 }
 PlanNode *NodeManager::MakeSelectPlanNode(PlanNode *node) {
-    node::QueryPlanNode *select_plan_ptr = new QueryPlanNode(node);
-    return RegisterNode(select_plan_ptr);
+    node::QueryPlanNode *select_plan_ptr = MakeNode<QueryPlanNode>(node);
+    return select_plan_ptr;
 }
 PlanNode *NodeManager::MakeGroupPlanNode(PlanNode *node, const ExprListNode *by_list) {
-    node::GroupPlanNode *node_ptr = new GroupPlanNode(node, by_list);
-    return RegisterNode(node_ptr);
+    node::GroupPlanNode *node_ptr = MakeNode<GroupPlanNode>(node, by_list);
+    return node_ptr;
 }
 PlanNode *NodeManager::MakeProjectPlanNode(PlanNode *node, const std::string &table,
                                            const PlanNodeList &projection_list,
                                            const std::vector<std::pair<uint32_t, uint32_t>> &pos_mapping) {
-    node::ProjectPlanNode *node_ptr = new ProjectPlanNode(node, table, projection_list, pos_mapping);
-    return RegisterNode(node_ptr);
+    node::ProjectPlanNode *node_ptr = MakeNode<ProjectPlanNode>(node, table, projection_list, pos_mapping);
+    return node_ptr;
 }
 PlanNode *NodeManager::MakeLimitPlanNode(PlanNode *node, int limit_cnt) {
-    node::LimitPlanNode *node_ptr = new LimitPlanNode(node, limit_cnt);
-    return RegisterNode(node_ptr);
+    node::LimitPlanNode *node_ptr = MakeNode<LimitPlanNode>(node, limit_cnt);
+    return node_ptr;
 }
 ProjectNode *NodeManager::MakeProjectNode(const int32_t pos, const std::string &name, const bool is_aggregation,
                                           node::ExprNode *expression, node::FrameNode *frame) {
-    node::ProjectNode *node_ptr = new ProjectNode(pos, name, is_aggregation, expression, frame);
-    RegisterNode(node_ptr);
+    node::ProjectNode *node_ptr = MakeNode<ProjectNode>(pos, name, is_aggregation, expression, frame);
     return node_ptr;
 }
 CreatePlanNode *NodeManager::MakeCreateTablePlanNode(const std::string &db_name, const std::string &table_name,
@@ -892,8 +874,7 @@ CreatePlanNode *NodeManager::MakeCreateTablePlanNode(const std::string &db_name,
                                                      const NodePointVector &table_option_list,
                                                      const bool if_not_exist) {
     node::CreatePlanNode *node_ptr =
-        new CreatePlanNode(db_name, table_name, column_list, if_not_exist, table_option_list);
-    RegisterNode(node_ptr);
+        MakeNode<CreatePlanNode>(db_name, table_name, column_list, if_not_exist, table_option_list);
     return node_ptr;
 }
 
@@ -901,54 +882,48 @@ CreateProcedurePlanNode *NodeManager::MakeCreateProcedurePlanNode(const std::str
                                                                   const NodePointVector &input_parameter_list,
                                                                   const PlanNodeList &inner_plan_node_list) {
     node::CreateProcedurePlanNode *node_ptr =
-        new CreateProcedurePlanNode(sp_name, input_parameter_list, inner_plan_node_list);
-    RegisterNode(node_ptr);
+        MakeNode<CreateProcedurePlanNode>(sp_name, input_parameter_list, inner_plan_node_list);
     return node_ptr;
 }
 
 CmdPlanNode *NodeManager::MakeCmdPlanNode(const CmdNode *node) {
-    node::CmdPlanNode *node_ptr = new CmdPlanNode(node->GetCmdType(), node->GetArgs());
+    node::CmdPlanNode *node_ptr = MakeNode<CmdPlanNode>(node->GetCmdType(), node->GetArgs());
     node_ptr->SetIfNotExists(node->IsIfNotExists());
     node_ptr->SetIfExists(node->IsIfExists());
-    RegisterNode(node_ptr);
     return node_ptr;
 }
 InsertPlanNode *NodeManager::MakeInsertPlanNode(const InsertStmt *node) {
-    node::InsertPlanNode *node_ptr = new InsertPlanNode(node);
-    RegisterNode(node_ptr);
+    node::InsertPlanNode *node_ptr = MakeNode<InsertPlanNode>(node);
     return node_ptr;
 }
 ExplainPlanNode *NodeManager::MakeExplainPlanNode(const ExplainNode *node) {
-    node::ExplainPlanNode *node_ptr = new ExplainPlanNode(node);
-    RegisterNode(node_ptr);
+    node::ExplainPlanNode *node_ptr = MakeNode<ExplainPlanNode>(node);
     return node_ptr;
 }
 FuncDefPlanNode *NodeManager::MakeFuncPlanNode(FnNodeFnDef *node) {
-    node::FuncDefPlanNode *node_ptr = new FuncDefPlanNode(node);
-    RegisterNode(node_ptr);
+    node::FuncDefPlanNode *node_ptr = MakeNode<FuncDefPlanNode>(node);
     return node_ptr;
 }
 CreateIndexPlanNode *NodeManager::MakeCreateCreateIndexPlanNode(const CreateIndexNode *node) {
-    node::CreateIndexPlanNode *node_ptr = new CreateIndexPlanNode(node);
-    RegisterNode(node_ptr);
+    node::CreateIndexPlanNode *node_ptr = MakeNode<CreateIndexPlanNode>(node);
     return node_ptr;
 }
-QueryExpr *NodeManager::MakeQueryExprNode(const QueryNode *query) { return RegisterNode(new QueryExpr(query)); }
+QueryExpr *NodeManager::MakeQueryExprNode(const QueryNode *query) { return MakeNode<QueryExpr>(query); }
 PlanNode *NodeManager::MakeSortPlanNode(PlanNode *node, const OrderByNode *order_list) {
-    node::SortPlanNode *node_ptr = new SortPlanNode(node, order_list);
-    return RegisterNode(node_ptr);
+    node::SortPlanNode *node_ptr = MakeNode<SortPlanNode>(node, order_list);
+    return node_ptr;
 }
 PlanNode *NodeManager::MakeUnionPlanNode(PlanNode *left, PlanNode *right, const bool is_all) {
-    node::UnionPlanNode *node_ptr = new UnionPlanNode(left, right, is_all);
-    return RegisterNode(node_ptr);
+    node::UnionPlanNode *node_ptr = MakeNode<UnionPlanNode>(left, right, is_all);
+    return node_ptr;
 }
 PlanNode *NodeManager::MakeDistinctPlanNode(PlanNode *node) {
-    node::DistinctPlanNode *node_ptr = new DistinctPlanNode(node);
-    return RegisterNode(node_ptr);
+    node::DistinctPlanNode *node_ptr = MakeNode<DistinctPlanNode>(node);
+    return node_ptr;
 }
 SqlNode *NodeManager::MakeExplainNode(const QueryNode *query, ExplainType explain_type) {
-    node::ExplainNode *node_ptr = new ExplainNode(query, explain_type);
-    return RegisterNode(node_ptr);
+    node::ExplainNode *node_ptr = MakeNode<ExplainNode>(query, explain_type);
+    return node_ptr;
 }
 ProjectNode *NodeManager::MakeAggProjectNode(const int32_t pos, const std::string &name, node::ExprNode *expression,
                                              node::FrameNode *frame) {
@@ -959,17 +934,17 @@ ProjectNode *NodeManager::MakeRowProjectNode(const int32_t pos, const std::strin
 }
 
 BetweenExpr *NodeManager::MakeBetweenExpr(ExprNode *expr, ExprNode *left, ExprNode *right, const bool is_not) {
-    BetweenExpr *node = new BetweenExpr(expr, left, right);
+    BetweenExpr *node = MakeNode<BetweenExpr>(expr, left, right);
     node->set_is_not_between(is_not);
-    return RegisterNode(node);
+    return node;
 }
 InExpr *NodeManager::MakeInExpr(ExprNode* lhs, ExprNode* in_list, bool is_not) {
-    InExpr* in_expr = new InExpr(lhs, in_list, is_not);
-    return RegisterNode(in_expr);
+    InExpr* in_expr = MakeNode<InExpr>(lhs, in_list, is_not);
+    return in_expr;
 }
 EscapedExpr *NodeManager::MakeEscapeExpr(ExprNode* pattern, ExprNode* escape) {
-    EscapedExpr* escape_expr = new EscapedExpr(pattern, escape);
-    return RegisterNode(escape_expr);
+    EscapedExpr* escape_expr = MakeNode<EscapedExpr>(pattern, escape);
+    return escape_expr;
 }
 ExprNode *NodeManager::MakeAndExpr(ExprListNode *expr_list) {
     if (node::ExprListNullOrEmpty(expr_list)) {
@@ -990,8 +965,8 @@ ExternalFnDefNode *NodeManager::MakeExternalFnDefNode(const std::string &functio
                                                       const std::vector<const node::TypeNode *> &arg_types,
                                                       const std::vector<int> &arg_nullable, int variadic_pos,
                                                       bool return_by_arg) {
-    return RegisterNode(new node::ExternalFnDefNode(function_name, function_ptr, ret_type, ret_nullable, arg_types,
-                                                    arg_nullable, variadic_pos, return_by_arg));
+    return MakeNode<node::ExternalFnDefNode>(function_name, function_ptr, ret_type, ret_nullable, arg_types,
+                                             arg_nullable, variadic_pos, return_by_arg);
 }
 
 DynamicUdfFnDefNode *NodeManager::MakeDynamicUdfFnDefNode(const std::string &function_name, void *function_ptr,
@@ -999,69 +974,75 @@ DynamicUdfFnDefNode *NodeManager::MakeDynamicUdfFnDefNode(const std::string &fun
                                                       const std::vector<const node::TypeNode *> &arg_types,
                                                       const std::vector<int> &arg_nullable, bool return_by_arg,
                                                       ExternalFnDefNode *init_node) {
-    return RegisterNode(new node::DynamicUdfFnDefNode(function_name, function_ptr, ret_type, ret_nullable, arg_types,
-                                                    arg_nullable, return_by_arg, init_node));
+    return MakeNode<node::DynamicUdfFnDefNode>(function_name, function_ptr, ret_type, ret_nullable, arg_types,
+                                               arg_nullable, return_by_arg, init_node);
 }
 
 node::ExternalFnDefNode *NodeManager::MakeUnresolvedFnDefNode(const std::string &function_name) {
-    return RegisterNode(new node::ExternalFnDefNode(function_name, nullptr, nullptr, true, {}, {}, -1, false));
+    return MakeNode<node::ExternalFnDefNode>(function_name, nullptr, nullptr, true,
+                                             std::vector<const node::TypeNode *>(), std::vector<int>(), -1, false);
 }
 
-node::UdfDefNode *NodeManager::MakeUdfDefNode(FnNodeFnDef *def) { return RegisterNode(new node::UdfDefNode(def)); }
+node::UdfDefNode *NodeManager::MakeUdfDefNode(FnNodeFnDef *def) { return MakeNode<node::UdfDefNode>(def); }
 
 node::UdfByCodeGenDefNode *NodeManager::MakeUdfByCodeGenDefNode(const std::string &name,
                                                                 const std::vector<const node::TypeNode *> &arg_types,
                                                                 const std::vector<int> &arg_nullable,
                                                                 const node::TypeNode *ret_type, bool ret_nullable) {
-    return RegisterNode(new node::UdfByCodeGenDefNode(name, arg_types, arg_nullable, ret_type, ret_nullable));
+    return MakeNode<node::UdfByCodeGenDefNode>(name, arg_types, arg_nullable, ret_type, ret_nullable);
 }
 
 node::UdafDefNode *NodeManager::MakeUdafDefNode(const std::string &name, const std::vector<const TypeNode *> &arg_types,
                                                 ExprNode *init, FnDefNode *update_func, FnDefNode *merge_func,
                                                 FnDefNode *output_func) {
-    return RegisterNode(new node::UdafDefNode(name, arg_types, init, update_func, merge_func, output_func));
+    return MakeNode<node::UdafDefNode>(name, arg_types, init, update_func, merge_func, output_func);
 }
 
 LambdaNode *NodeManager::MakeLambdaNode(const std::vector<ExprIdNode *> &args, ExprNode *body) {
-    return RegisterNode(new node::LambdaNode(args, body));
+    return MakeNode<node::LambdaNode>(args, body);
 }
 
 CondExpr *NodeManager::MakeCondExpr(ExprNode *condition, ExprNode *left, ExprNode *right) {
-    return RegisterNode(new CondExpr(condition, left, right));
+    return MakeNode<CondExpr>(condition, left, right);
 }
 
 SqlNode *NodeManager::MakePartitionMetaNode(RoleType role_type, const std::string &endpoint) {
-    SqlNode *node_ptr = new PartitionMetaNode(endpoint, role_type);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<PartitionMetaNode>(endpoint, role_type);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeReplicaNumNode(int num) {
-    SqlNode *node_ptr = new ReplicaNumNode(num);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<ReplicaNumNode>(num);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeStorageModeNode(StorageMode storage_mode) {
-    SqlNode *node_ptr = new StorageModeNode(storage_mode);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<StorageModeNode>(storage_mode);
+    return node_ptr;
+}
+
+SqlNode *NodeManager::MakeBroadcastNode(bool broadcast) {
+    SqlNode *node_ptr = MakeNode<BroadcastNode>(broadcast);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakePartitionNumNode(int num) {
-    SqlNode *node_ptr = new PartitionNumNode(num);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<PartitionNumNode>(num);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeDistributionsNode(SqlNodeList *distribution_list) {
-    DistributionsNode *index_ptr = new DistributionsNode(distribution_list);
-    return RegisterNode(index_ptr);
+    DistributionsNode *index_ptr = MakeNode<DistributionsNode>(distribution_list);
+    return index_ptr;
 }
 
 SqlNode *NodeManager::MakeCreateProcedureNode(const std::string &sp_name, SqlNodeList *input_parameter_list,
                                               SqlNode *inner_node) {
-    CreateSpStmt *node_ptr = new CreateSpStmt(sp_name);
+    CreateSpStmt *node_ptr = MakeNode<CreateSpStmt>(sp_name);
     FillSqlNodeList2NodeVector(input_parameter_list, node_ptr->GetInputParameterList());
     std::vector<SqlNode *> &list = node_ptr->GetInnerNodeList();
     list.push_back(inner_node);
-    return RegisterNode(node_ptr);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeCreateFunctionNode(const std::string function_name, DataType return_type,
@@ -1071,21 +1052,21 @@ SqlNode *NodeManager::MakeCreateFunctionNode(const std::string function_name, Da
     for (const auto type : args_type) {
         type_node_vec.push_back(MakeTypeNode(type));
     }
-    auto node_ptr = new CreateFunctionNode(function_name, return_type_node, type_node_vec, is_aggregate, options);
-    return RegisterNode(node_ptr);
+    auto node_ptr = MakeNode<CreateFunctionNode>(function_name, return_type_node, type_node_vec, is_aggregate, options);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeCreateProcedureNode(const std::string &sp_name, SqlNodeList *input_parameter_list,
                                               SqlNodeList *inner_node_list) {
-    CreateSpStmt *node_ptr = new CreateSpStmt(sp_name);
+    CreateSpStmt *node_ptr = MakeNode<CreateSpStmt>(sp_name);
     FillSqlNodeList2NodeVector(input_parameter_list, node_ptr->GetInputParameterList());
     FillSqlNodeList2NodeVector(inner_node_list, node_ptr->GetInnerNodeList());
-    return RegisterNode(node_ptr);
+    return node_ptr;
 }
 
 SqlNode *NodeManager::MakeInputParameterNode(bool is_constant, const std::string &column_name, DataType data_type) {
-    SqlNode *node_ptr = new InputParameterNode(column_name, data_type, is_constant);
-    return RegisterNode(node_ptr);
+    SqlNode *node_ptr = MakeNode<InputParameterNode>(column_name, data_type, is_constant);
+    return node_ptr;
 }
 
 void NodeManager::SetNodeUniqueId(ExprNode *node) { node->SetNodeId(expr_idx_counter_++); }
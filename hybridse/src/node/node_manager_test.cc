@@ -15,6 +15,9 @@
  */
 
 #include "node/node_manager.h"
+#include <string>
+#include <vector>
+
 #include <glog/logging.h>
 #include "gtest/gtest.h"
 
@@ -41,6 +44,23 @@ TEST_F(NodeManagerTest, MakeSqlNode) {
     ASSERT_EQ(6, manager->GetNodeListSize());
     delete manager;
 }
+TEST_F(NodeManagerTest, MakeNodeInArena) {
+    NodeManager manager;
+    // more nodes than a chuck of the arena holds
+    std::vector<ConstNode *> nodes;
+    for (int i = 0; i < 1000; i++) {
+        nodes.push_back(manager.MakeConstNode(std::to_string(i)));
+    }
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(nodes[i]) % alignof(std::max_align_t));
+        ASSERT_EQ(std::to_string(i), nodes[i]->GetAsString());
+    }
+    // the nodes allocated by new are taken too
+    manager.RegisterNode(new ConstNode(1));
+    ASSERT_EQ(1001, manager.GetNodeListSize());
+    ASSERT_LT(nodes[0]->node_id(), nodes[999]->node_id());
+}
+
 TEST_F(NodeManagerTest, MakeAndExprTest) {
     NodeManager *manager = new NodeManager();
     manager->MakeTableNode("t1", "table1");
@@ -765,9 +765,13 @@ void SetPlanNode::Print(std::ostream &output, const std::string &org_tab) const
 }
 
 bool DeletePlanNode::Equals(const PlanNode *that) const {
-    return LeafPlanNode::Equals(that) && type_ == that->type_ &&
-           GetTarget() == dynamic_cast<const DeletePlanNode *>(that)->GetTarget() &&
-           GetJobId() == dynamic_cast<const DeletePlanNode *>(that)->GetJobId();
+    if (!LeafPlanNode::Equals(that) || type_ != that->type_) {
+        return false;
+    }
+    auto* delete_node = dynamic_cast<const DeletePlanNode *>(that);
+    return GetTarget() == delete_node->GetTarget() && GetJobId() == delete_node->GetJobId() &&
+           GetDbName() == delete_node->GetDbName() && GetTableName() == delete_node->GetTableName() &&
+           ExprEquals(GetCondition(), delete_node->GetCondition());
 }
 void DeletePlanNode::Print(std::ostream& output, const std::string& tab) const {
     PlanNode::Print(output, tab);
@@ -775,7 +779,15 @@ void DeletePlanNode::Print(std::ostream& output, const std::string& tab) const {
     output << "\n";
     PrintValue(output, next_tab, DeleteTargetString(target_), "target", false);
     output << "\n";
-    PrintValue(output, next_tab, GetJobId(), "job_id", true);
+    if (target_ == DeleteTarget::TABLE) {
+        PrintValue(output, next_tab, db_name_, "db_name", false);
+        output << "\n";
+        PrintValue(output, next_tab, table_name_, "table_name", false);
+        output << "\n";
+        PrintSqlNode(output, next_tab, condition_, "condition", true);
+    } else {
+        PrintValue(output, next_tab, GetJobId(), "job_id", true);
+    }
 }
 
 bool CmdPlanNode::Equals(const PlanNode *that) const {
@@ -71,6 +71,7 @@ static absl::flat_hash_map<CmdType, absl::string_view> CreateCmdTypeNamesMap() {
         {CmdType::kCmdShowTableStatus, "show table status"},
         {CmdType::kCmdDropFunction, "drop function"},
         {CmdType::kCmdShowFunctions, "show functions"},
+        {CmdType::kCmdShowDeploymentStats, "show deployment_stats"},
     };
     for (auto kind = 0; kind < CmdType::kLastCmd; ++kind) {
         DCHECK(map.find(static_cast<CmdType>(kind)) != map.end());
@@ -1136,6 +1137,9 @@ std::string NameOfSqlNodeType(const SqlNodeType &type) {
         case kStorageMode:
             output = "kStorageMode";
             break;
+        case kBroadcast:
+            output = "kBroadcast";
+            break;
         case kFn:
             output = "kFn";
             break;
@@ -2495,6 +2499,13 @@ void StorageModeNode::Print(std::ostream &output, const std::string &org_tab) co
     PrintValue(output, tab, StorageModeName(storage_mode_), "storage_mode", true);
 }
 
+void BroadcastNode::Print(std::ostream &output, const std::string &org_tab) const {
+    SqlNode::Print(output, org_tab);
+    const std::string tab = org_tab + INDENT + SPACE_ED;
+    output << "\n";
+    PrintValue(output, tab, broadcast_ ? "true" : "false", "broadcast", true);
+}
+
 void PartitionNumNode::Print(std::ostream &output, const std::string &org_tab) const {
     SqlNode::Print(output, org_tab);
     const std::string tab = org_tab + INDENT + SPACE_ED;
@@ -2537,7 +2548,15 @@ void DeleteNode::Print(std::ostream &output, const std::string &org_tab) const {
     output << "\n";
     PrintValue(output, tab, GetTargetString(), "target", false);
     output << "\n";
-    PrintValue(output, tab, GetJobId(), "job_id", true);
+    if (target_ == DeleteTarget::TABLE) {
+        PrintValue(output, tab, db_name_, "db_name", false);
+        output << "\n";
+        PrintValue(output, tab, table_name_, "table_name", false);
+        output << "\n";
+        PrintSqlNode(output, tab, condition_, "condition", true);
+    } else {
+        PrintValue(output, tab, GetJobId(), "job_id", true);
+    }
 }
 
 std::string DeleteTargetString(DeleteTarget target) {
@@ -2545,6 +2564,9 @@ std::string DeleteTargetString(DeleteTarget target) {
         case DeleteTarget::JOB: {
             return "JOB";
         }
+        case DeleteTarget::TABLE: {
+            return "TABLE";
+        }
     }
     return "unknown";
 }
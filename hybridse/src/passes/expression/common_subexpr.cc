@@ -0,0 +1,406 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "passes/expression/common_subexpr.h"
+
+#include <cstring>
+
+#include "node/node_manager.h"
+#include "passes/resolve_fn_and_attrs.h"
+
+namespace hybridse {
+namespace passes {
+
+// integers wrap on overflow as the generated code does
+template <typename T>
+static bool FoldArith(node::FnOperator op, T l, T r, T* out) {
+    uint64_t ul = static_cast<uint64_t>(l);
+    uint64_t ur = static_cast<uint64_t>(r);
+    switch (op) {
+        case node::kFnOpAdd:
+            *out = static_cast<T>(ul + ur);
+            return true;
+        case node::kFnOpMinus:
+            *out = static_cast<T>(ul - ur);
+            return true;
+        case node::kFnOpMulti:
+            *out = static_cast<T>(ul * ur);
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+static bool FoldFloatArith(node::FnOperator op, T l, T r, T* out) {
+    switch (op) {
+        case node::kFnOpAdd:
+            *out = l + r;
+            return true;
+        case node::kFnOpMinus:
+            *out = l - r;
+            return true;
+        case node::kFnOpMulti:
+            *out = l * r;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool FoldArith(node::FnOperator op, float l, float r, float* out) {
+    return FoldFloatArith(op, l, r, out);
+}
+
+static bool FoldArith(node::FnOperator op, double l, double r, double* out) {
+    return FoldFloatArith(op, l, r, out);
+}
+
+template <typename T>
+static bool FoldCompare(node::FnOperator op, T l, T r, bool* out) {
+    switch (op) {
+        case node::kFnOpEq:
+            *out = l == r;
+            return true;
+        case node::kFnOpNeq:
+            *out = l != r;
+            return true;
+        case node::kFnOpLt:
+            *out = l < r;
+            return true;
+        case node::kFnOpLe:
+            *out = l <= r;
+            return true;
+        case node::kFnOpGt:
+            *out = l > r;
+            return true;
+        case node::kFnOpGe:
+            *out = l >= r;
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+static ExprNode* FoldNumeric(node::NodeManager* nm, const node::BinaryExpr* expr,
+                             node::DataType type, T l, T r) {
+    auto out_type = expr->GetOutputType();
+    if (out_type == nullptr) {
+        return nullptr;
+    }
+    if (out_type->base() == type) {
+        T val;
+        return FoldArith(expr->GetOp(), l, r, &val) ? nm->MakeConstNode(val)
+                                                    : nullptr;
+    }
+    if (out_type->base() == node::kBool) {
+        bool val;
+        return FoldCompare(expr->GetOp(), l, r, &val) ? nm->MakeConstNode(val)
+                                                      : nullptr;
+    }
+    return nullptr;
+}
+
+static ExprNode* FoldBool(node::NodeManager* nm, const node::BinaryExpr* expr,
+                          bool l, bool r) {
+    switch (expr->GetOp()) {
+        case node::kFnOpAnd:
+            return nm->MakeConstNode(l && r);
+        case node::kFnOpOr:
+            return nm->MakeConstNode(l || r);
+        case node::kFnOpEq:
+            return nm->MakeConstNode(l == r);
+        case node::kFnOpNeq:
+            return nm->MakeConstNode(l != r);
+        default:
+            return nullptr;
+    }
+}
+
+static bool IsFoldableConst(const ExprNode* expr) {
+    auto literal = dynamic_cast<const node::ConstNode*>(expr);
+    return literal != nullptr && !literal->IsNull();
+}
+
+ExprNode* CommonSubexprEliminator::Fold(ExprNode* expr) {
+    auto nm = ctx()->node_manager();
+    if (expr->GetExprType() == node::kExprBinary) {
+        auto binary = dynamic_cast<node::BinaryExpr*>(expr);
+        if (!IsFoldableConst(binary->GetChild(0)) ||
+            !IsFoldableConst(binary->GetChild(1))) {
+            return nullptr;
+        }
+        auto lhs = dynamic_cast<node::ConstNode*>(binary->GetChild(0));
+        auto rhs = dynamic_cast<node::ConstNode*>(binary->GetChild(1));
+        if (lhs->GetDataType() != rhs->GetDataType()) {
+            return nullptr;
+        }
+        switch (lhs->GetDataType()) {
+            case node::kInt16:
+                return FoldNumeric(nm, binary, node::kInt16,
+                                   lhs->GetSmallInt(), rhs->GetSmallInt());
+            case node::kInt32:
+                return FoldNumeric(nm, binary, node::kInt32, lhs->GetInt(),
+                                   rhs->GetInt());
+            case node::kInt64:
+                return FoldNumeric(nm, binary, node::kInt64, lhs->GetLong(),
+                                   rhs->GetLong());
+            case node::kFloat:
+                return FoldNumeric(nm, binary, node::kFloat, lhs->GetFloat(),
+                                   rhs->GetFloat());
+            case node::kDouble:
+                return FoldNumeric(nm, binary, node::kDouble,
+                                   lhs->GetDouble(), rhs->GetDouble());
+            case node::kBool:
+                return FoldBool(nm, binary, lhs->GetBool(), rhs->GetBool());
+            default:
+                return nullptr;
+        }
+    }
+    if (expr->GetExprType() == node::kExprUnary) {
+        auto unary = dynamic_cast<node::UnaryExpr*>(expr);
+        if (!IsFoldableConst(unary->GetChild(0))) {
+            return nullptr;
+        }
+        auto input = dynamic_cast<node::ConstNode*>(unary->GetChild(0));
+        if (unary->GetOp() == node::kFnOpNot &&
+            input->GetDataType() == node::kBool) {
+            return nm->MakeConstNode(!input->GetBool());
+        }
+        if (unary->GetOp() != node::kFnOpMinus) {
+            return nullptr;
+        }
+        switch (input->GetDataType()) {
+            case node::kInt32:
+                return nm->MakeConstNode(static_cast<int32_t>(
+                    0 - static_cast<uint32_t>(input->GetInt())));
+            case node::kInt64:
+                return nm->MakeConstNode(static_cast<int64_t>(
+                    0 - static_cast<uint64_t>(input->GetLong())));
+            case node::kFloat:
+                return nm->MakeConstNode(-input->GetFloat());
+            case node::kDouble:
+                return nm->MakeConstNode(-input->GetDouble());
+            default:
+                return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T>
+static void AppendRaw(std::string* key, T val) {
+    key->append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+// the key of the literal, empty if the literal is not shared
+static std::string ConstKey(const node::ConstNode* literal) {
+    std::string key = std::to_string(literal->GetDataType()) + ":";
+    switch (literal->GetDataType()) {
+        case node::kNull:
+            break;
+        case node::kBool:
+            AppendRaw(&key, literal->GetBool());
+            break;
+        case node::kInt16:
+            AppendRaw(&key, literal->GetSmallInt());
+            break;
+        case node::kInt32:
+            AppendRaw(&key, literal->GetInt());
+            break;
+        case node::kInt64:
+            AppendRaw(&key, literal->GetLong());
+            break;
+        case node::kFloat:
+            AppendRaw(&key, literal->GetFloat());
+            break;
+        case node::kDouble:
+            AppendRaw(&key, literal->GetDouble());
+            break;
+        case node::kVarchar:
+            key.append(literal->GetStr(), strlen(literal->GetStr()));
+            break;
+        default:
+            return "";
+    }
+    return key;
+}
+
+// the library functions are deterministic
+static bool IsSharedFn(const node::FnDefNode* fn) {
+    if (fn == nullptr) {
+        return false;
+    }
+    switch (fn->GetType()) {
+        case node::kExternalFnDef:
+        case node::kUdfDef:
+        case node::kUdfByCodeGenDef:
+            return true;
+        default:
+            return false;
+    }
+}
+
+ExprNode* CommonSubexprEliminator::Share(ExprNode* expr) {
+    if (lambda_depth_ > 0 || expr->GetOutputType() == nullptr) {
+        return expr;
+    }
+    std::string key = std::to_string(expr->GetExprType()) + "|";
+    switch (expr->GetExprType()) {
+        case node::kExprPrimary: {
+            std::string const_key =
+                ConstKey(dynamic_cast<node::ConstNode*>(expr));
+            if (const_key.empty()) {
+                return expr;
+            }
+            key.append(const_key);
+            break;
+        }
+        case node::kExprColumnRef: {
+            auto column = dynamic_cast<node::ColumnRefNode*>(expr);
+            key.append(column->GetDBName() + "." + column->GetRelationName() +
+                       "." + column->GetColumnName());
+            break;
+        }
+        case node::kExprColumnId: {
+            key.append(std::to_string(
+                dynamic_cast<node::ColumnIdNode*>(expr)->GetColumnID()));
+            break;
+        }
+        case node::kExprId: {
+            key.append(
+                std::to_string(dynamic_cast<node::ExprIdNode*>(expr)->GetId()));
+            break;
+        }
+        case node::kExprParameter: {
+            key.append(std::to_string(
+                dynamic_cast<node::ParameterExpr*>(expr)->position()));
+            break;
+        }
+        case node::kExprBinary: {
+            key.append(
+                std::to_string(dynamic_cast<node::BinaryExpr*>(expr)->GetOp()));
+            break;
+        }
+        case node::kExprUnary: {
+            key.append(
+                std::to_string(dynamic_cast<node::UnaryExpr*>(expr)->GetOp()));
+            break;
+        }
+        case node::kExprCast: {
+            key.append(std::to_string(
+                dynamic_cast<node::CastExprNode*>(expr)->cast_type_));
+            break;
+        }
+        case node::kExprBetween: {
+            key.append(
+                dynamic_cast<node::BetweenExpr*>(expr)->is_not_between() ? "1"
+                                                                          : "0");
+            break;
+        }
+        case node::kExprGetField: {
+            auto get_field = dynamic_cast<node::GetFieldExpr*>(expr);
+            key.append(std::to_string(get_field->GetColumnID()) + "." +
+                       get_field->GetColumnName());
+            break;
+        }
+        case node::kExprCond:
+            break;
+        case node::kExprCall: {
+            auto call = dynamic_cast<node::CallExprNode*>(expr);
+            if (call->GetOver() != nullptr || !IsSharedFn(call->GetFnDef())) {
+                return expr;
+            }
+            key.append(call->GetFnDef()->GetName());
+            break;
+        }
+        default:
+            return expr;
+    }
+    // the children are shared before, so the equal children are the same node
+    for (size_t i = 0; i < expr->GetChildNum(); ++i) {
+        key.append("#" + std::to_string(expr->GetChild(i)->node_id()));
+    }
+    auto iter = shared_.find(key);
+    if (iter == shared_.end()) {
+        shared_.emplace(key, expr);
+        return expr;
+    }
+    auto origin = iter->second;
+    if (!node::TypeEquals(origin->GetOutputType(), expr->GetOutputType()) ||
+        origin->nullable() != expr->nullable()) {
+        return expr;
+    }
+    if (expr->GetExprType() == node::kExprCall &&
+        !node::FnDefEquals(dynamic_cast<node::CallExprNode*>(origin)->GetFnDef(),
+                           dynamic_cast<node::CallExprNode*>(expr)->GetFnDef())) {
+        return expr;
+    }
+    return origin;
+}
+
+Status CommonSubexprEliminator::Apply(ExprAnalysisContext* ctx, ExprNode* expr,
+                                      ExprNode** out) {
+    shared_.clear();
+    lambda_depth_ = 0;
+    return ExprInplaceTransformUp::Apply(ctx, expr, out);
+}
+
+Status CommonSubexprEliminator::VisitDefault(ExprNode* expr, ExprNode** out) {
+    *out = expr;
+    ExprNode* folded = Fold(expr);
+    if (folded != nullptr) {
+        ResolveFnAndAttrs resolver(ctx());
+        CHECK_STATUS(resolver.VisitOneStep(folded, &folded));
+        *out = folded;
+    }
+    *out = Share(*out);
+    return Status::OK();
+}
+
+Status CommonSubexprEliminator::VisitCall(node::CallExprNode* call,
+                                          ExprNode** out) {
+    *out = Share(call);
+    return Status::OK();
+}
+
+Status CommonSubexprEliminator::VisitGetField(node::GetFieldExpr* get_field,
+                                              ExprNode** out) {
+    *out = Share(get_field);
+    return Status::OK();
+}
+
+Status CommonSubexprEliminator::VisitLambda(
+    node::LambdaNode* lambda, const std::vector<node::ExprAttrNode>& arg_attrs,
+    node::FnDefNode** out) {
+    lambda_depth_ += 1;
+    Status status = ExprInplaceTransformUp::VisitLambda(lambda, arg_attrs, out);
+    lambda_depth_ -= 1;
+    return status;
+}
+
+Status CommonSubexprEliminator::VisitUdaf(
+    node::UdafDefNode* udaf, const std::vector<node::ExprAttrNode>& arg_attrs,
+    node::FnDefNode** out) {
+    lambda_depth_ += 1;
+    Status status = ExprInplaceTransformUp::VisitUdaf(udaf, arg_attrs, out);
+    lambda_depth_ -= 1;
+    return status;
+}
+
+}  // namespace passes
+}  // namespace hybridse
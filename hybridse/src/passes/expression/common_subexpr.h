@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_PASSES_EXPRESSION_COMMON_SUBEXPR_H_
+#define HYBRIDSE_SRC_PASSES_EXPRESSION_COMMON_SUBEXPR_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "passes/expression/simplify.h"
+
+namespace hybridse {
+namespace passes {
+
+/**
+ * Share the equal subexpressions of the projects of one function let, so
+ * that they are evaluated once per row as the codegen caches the value of
+ * an expression node, and fold the arithmetic, comparison and logical
+ * operations over the numeric and bool literals.
+ *
+ * The subexpressions are shared bottom up: two nodes are equal if they are
+ * of the same kind and attributes and have the same children. Only the
+ * deterministic operators and the library functions are shared, and the
+ * bodies of the lambdas and udafs are left alone as they are built in their
+ * own functions.
+ */
+class CommonSubexprEliminator : public ExprInplaceTransformUp {
+ public:
+    Status Apply(ExprAnalysisContext* ctx, ExprNode* expr,
+                 ExprNode** out) override;
+
+    Status VisitCall(node::CallExprNode*, ExprNode**) override;
+    Status VisitGetField(node::GetFieldExpr*, ExprNode**) override;
+    Status VisitDefault(ExprNode*, ExprNode**) override;
+
+    Status VisitLambda(node::LambdaNode*,
+                       const std::vector<node::ExprAttrNode>&,
+                       node::FnDefNode**) override;
+    Status VisitUdaf(node::UdafDefNode*,
+                     const std::vector<node::ExprAttrNode>&,
+                     node::FnDefNode**) override;
+
+ private:
+    // return the literal of the operation over literals, nullptr if it is not folded
+    ExprNode* Fold(ExprNode* expr);
+    // return the first visited node equal to `expr`, or `expr` itself
+    ExprNode* Share(ExprNode* expr);
+
+    // the key of the kind, attributes and children of node -> the node
+    std::unordered_map<std::string, ExprNode*> shared_;
+    // the depth of the lambda bodies visiting
+    size_t lambda_depth_ = 0;
+};
+
+}  // namespace passes
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_PASSES_EXPRESSION_COMMON_SUBEXPR_H_
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "passes/expression/common_subexpr.h"
+#include "passes/expression/expr_pass_test.h"
+#include "passes/expression/simplify.h"
+#include "udf/literal_traits.h"
+
+namespace hybridse {
+namespace passes {
+
+class CommonSubexprEliminatorTest : public ExprPassTestBase {};
+
+TEST_F(CommonSubexprEliminatorTest, ShareSubexprTest) {
+    auto schema = udf::MakeLiteralSchema<int32_t, float, double, int64_t>();
+    schemas_ctx_.BuildTrivial({&schema});
+
+    std::string sql =
+        "select log(col_2 + 1.0), log(col_2 + 1.0) * 2.0, col_0 + 1, "
+        "(col_0 + 1) * col_0, col_0 + 2, substr(\"abc\", col_0, 1) = "
+        "substr(\"abc\", col_0, 1) from t1;";
+    node::LambdaNode* function_let = nullptr;
+    InitFunctionLet(sql, &function_let);
+
+    // the lambda udfs are inlined before as the default passes do
+    ExprSimplifier simplifier;
+    node::ExprNode* output = nullptr;
+    Status status = ApplyPass(&simplifier, function_let, &output);
+    ASSERT_TRUE(status.isOK()) << status;
+
+    CommonSubexprEliminator pass;
+    status = pass.Apply(pass_ctx(), output, &output);
+    ASSERT_TRUE(status.isOK()) << status;
+    ASSERT_EQ(6u, output->GetChildNum());
+
+    ASSERT_EQ(output->GetChild(0), output->GetChild(1)->GetChild(0))
+        << output->GetTreeString();
+    ASSERT_EQ(output->GetChild(2), output->GetChild(3)->GetChild(0))
+        << output->GetTreeString();
+    ASSERT_NE(output->GetChild(2), output->GetChild(4));
+    // the row of the columns is shared
+    ASSERT_EQ(output->GetChild(2)->GetChild(0),
+              output->GetChild(4)->GetChild(0));
+    auto eq = output->GetChild(5);
+    ASSERT_EQ(eq->GetChild(0), eq->GetChild(1)) << output->GetTreeString();
+}
+
+TEST_F(CommonSubexprEliminatorTest, FoldConstTest) {
+    auto schema = udf::MakeLiteralSchema<int32_t, float, double, int64_t>();
+    schemas_ctx_.BuildTrivial({&schema});
+
+    std::string sql =
+        "select 1 + 2 * 3, 2.5 - 0.5, 3 > 2, not (1 = 1), col_0 + (2 - 1), "
+        "-(2 + 2), 1 + 0.5 from t1;";
+    node::LambdaNode* function_let = nullptr;
+    InitFunctionLet(sql, &function_let);
+
+    // the lambda udfs are inlined before as the default passes do
+    ExprSimplifier simplifier;
+    node::ExprNode* output = nullptr;
+    Status status = ApplyPass(&simplifier, function_let, &output);
+    ASSERT_TRUE(status.isOK()) << status;
+
+    CommonSubexprEliminator pass;
+    status = pass.Apply(pass_ctx(), output, &output);
+    ASSERT_TRUE(status.isOK()) << status;
+    ASSERT_EQ(7u, output->GetChildNum());
+
+    auto as_const = [](node::ExprNode* expr) {
+        return dynamic_cast<node::ConstNode*>(expr);
+    };
+    ASSERT_TRUE(as_const(output->GetChild(0)) != nullptr);
+    ASSERT_EQ(7, as_const(output->GetChild(0))->GetInt());
+    ASSERT_TRUE(as_const(output->GetChild(1)) != nullptr);
+    ASSERT_DOUBLE_EQ(2.0, as_const(output->GetChild(1))->GetDouble());
+    ASSERT_TRUE(as_const(output->GetChild(2)) != nullptr);
+    ASSERT_TRUE(as_const(output->GetChild(2))->GetBool());
+    ASSERT_TRUE(as_const(output->GetChild(3)) != nullptr);
+    ASSERT_FALSE(as_const(output->GetChild(3))->GetBool());
+
+    auto add = output->GetChild(4);
+    ASSERT_EQ(node::kExprBinary, add->GetExprType());
+    ASSERT_TRUE(as_const(add->GetChild(1)) != nullptr);
+    ASSERT_EQ(1, as_const(add->GetChild(1))->GetInt());
+
+    ASSERT_TRUE(as_const(output->GetChild(5)) != nullptr);
+    ASSERT_EQ(-4, as_const(output->GetChild(5))->GetInt());
+
+    // the literals of different types are not folded
+    ASSERT_EQ(node::kExprBinary, output->GetChild(6)->GetExprType());
+}
+
+}  // namespace passes
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::GTEST_FLAG(color) = "yes";
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -19,6 +19,7 @@
 
 #include <memory>
 
+#include "passes/expression/common_subexpr.h"
 #include "passes/expression/merge_aggregations.h"
 #include "passes/expression/simplify.h"
 #include "passes/resolve_fn_and_attrs.h"
@@ -30,6 +31,7 @@ void AddDefaultExprOptPasses(node::ExprAnalysisContext* ctx,
                              ExprPassGroup* group) {
     group->AddPass(std::make_shared<passes::MergeAggregations>());
     group->AddPass(std::make_shared<passes::ExprSimplifier>());
+    group->AddPass(std::make_shared<passes::CommonSubexprEliminator>());
     group->AddPass(std::make_shared<passes::ResolveFnAndAttrs>(ctx));
 }
 
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "passes/expression/loop_invariant.h"
+
+namespace hybridse {
+namespace passes {
+
+// the library functions, including the ones defined by expressions, and the
+// udafs are deterministic
+static bool IsInvariantFn(const node::FnDefNode* fn) {
+    if (fn == nullptr) {
+        return false;
+    }
+    switch (fn->GetType()) {
+        case node::kExternalFnDef:
+        case node::kUdfDef:
+        case node::kUdfByCodeGenDef:
+        case node::kLambdaDef:
+        case node::kUdafDef:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool IsLeaf(const node::ExprNode* expr) {
+    switch (expr->GetExprType()) {
+        case node::kExprPrimary:
+        case node::kExprParameter:
+        case node::kExprId:
+        case node::kExprGetField:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void LoopInvariantAnalysis::Collect(
+    const node::LambdaNode* update,
+    std::vector<const node::ExprNode*>* invariants) {
+    if (update == nullptr || update->body() == nullptr) {
+        return;
+    }
+    LoopInvariantAnalysis analysis;
+    for (size_t i = 0; i < update->GetArgSize(); ++i) {
+        analysis.arg_ids_.insert(update->GetArg(i)->GetId());
+    }
+    // the body itself always depends on the state argument
+    analysis.Visit(update->body(), invariants);
+}
+
+bool LoopInvariantAnalysis::Visit(
+    const node::ExprNode* expr,
+    std::vector<const node::ExprNode*>* invariants) {
+    bool invariant = expr->GetOutputType() != nullptr;
+    switch (expr->GetExprType()) {
+        case node::kExprId: {
+            auto expr_id = dynamic_cast<const node::ExprIdNode*>(expr);
+            invariant &= arg_ids_.count(expr_id->GetId()) == 0;
+            break;
+        }
+        case node::kExprPrimary:
+        case node::kExprParameter:
+        case node::kExprGetField:
+        case node::kExprBinary:
+        case node::kExprUnary:
+        case node::kExprCast:
+        case node::kExprBetween:
+        case node::kExprCond:
+            break;
+        case node::kExprCall: {
+            auto call = dynamic_cast<const node::CallExprNode*>(expr);
+            invariant &= call->GetOver() == nullptr &&
+                         IsInvariantFn(call->GetFnDef());
+            break;
+        }
+        default:
+            invariant = false;
+            break;
+    }
+    std::vector<bool> child_invariant(expr->GetChildNum());
+    for (size_t i = 0; i < expr->GetChildNum(); ++i) {
+        child_invariant[i] = Visit(expr->GetChild(i), invariants);
+        invariant &= child_invariant[i];
+    }
+    if (invariant) {
+        return true;
+    }
+    for (size_t i = 0; i < expr->GetChildNum(); ++i) {
+        auto child = expr->GetChild(i);
+        if (child_invariant[i] && !IsLeaf(child) &&
+            collected_.insert(child->node_id()).second) {
+            invariants->push_back(child);
+        }
+    }
+    return false;
+}
+
+}  // namespace passes
+}  // namespace hybridse
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_PASSES_EXPRESSION_LOOP_INVARIANT_H_
+#define HYBRIDSE_SRC_PASSES_EXPRESSION_LOOP_INVARIANT_H_
+
+#include <unordered_set>
+#include <vector>
+
+#include "node/expr_node.h"
+#include "node/sql_node.h"
+
+namespace hybridse {
+namespace passes {
+
+/**
+ * Find the subexpressions of the update function of a window aggregation
+ * which do not depend on the arguments of the update function, such as the
+ * expressions over the request row and the parameters, or the aggregations
+ * over the whole window nested in the aggregation. They evaluate to the same
+ * value for every row of the window, so the codegen evaluates them once
+ * before the loop over the rows and the update function reuses the values.
+ */
+class LoopInvariantAnalysis {
+ public:
+    // Collect the largest invariant subexpressions of the lambda update
+    // function into `invariants`, the literals and the plain references are
+    // left out as they are not worth hoisting.
+    static void Collect(const node::LambdaNode* update,
+                        std::vector<const node::ExprNode*>* invariants);
+
+ private:
+    LoopInvariantAnalysis() {}
+
+    // return whether the expression is invariant, the largest invariant
+    // subexpressions below a variant one are collected
+    bool Visit(const node::ExprNode* expr,
+               std::vector<const node::ExprNode*>* invariants);
+
+    // the ids of the arguments of the update function
+    std::unordered_set<int64_t> arg_ids_;
+    // the node ids of the collected expressions, as the shared subexpressions
+    // are visited more than once
+    std::unordered_set<size_t> collected_;
+};
+
+}  // namespace passes
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_PASSES_EXPRESSION_LOOP_INVARIANT_H_
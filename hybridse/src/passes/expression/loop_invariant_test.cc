@@ -0,0 +1,81 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "passes/expression/loop_invariant.h"
+#include <tuple>
+#include "passes/expression/expr_pass_test.h"
+#include "udf/literal_traits.h"
+
+namespace hybridse {
+namespace passes {
+
+class LoopInvariantTest : public ExprPassTestBase {};
+
+TEST_F(LoopInvariantTest, CollectTest) {
+    auto schema = udf::MakeLiteralSchema<int32_t, float, double>();
+    schemas_ctx_.BuildTrivial({&schema});
+
+    // the invariant subexpressions of the update function of the aggregation
+    std::vector<std::tuple<std::string, std::vector<std::string>>> cases = {
+        {"sum(col_0 + 1) over w1", {}},
+        {"sum(col_0) over w1", {}},
+        {"sum(col_2 * log(2.0)) over w1", {"log"}},
+        {"sum(col_0 + sum(col_1)) over w1", {"sum"}},
+        {"count_where(col_0, col_2 > log(2.0) + sqrt(3.0)) over w1", {"+"}},
+    };
+    std::string sql = "select \n";
+    for (size_t i = 0; i < cases.size(); ++i) {
+        sql.append(std::get<0>(cases[i]));
+        if (i < cases.size() - 1) {
+            sql.append(",\n");
+        }
+    }
+    sql.append(
+        " from t1 window w1 as (partition by col_1 order by col_3 rows between "
+        "3 preceding and current row);");
+
+    node::LambdaNode* function_let = nullptr;
+    InitFunctionLet(sql, &function_let);
+
+    auto expr_list = function_let->body();
+    ASSERT_EQ(cases.size(), expr_list->GetChildNum());
+    for (size_t i = 0; i < expr_list->GetChildNum(); ++i) {
+        auto call = dynamic_cast<node::CallExprNode*>(expr_list->GetChild(i));
+        ASSERT_TRUE(call != nullptr) << std::get<0>(cases[i]);
+        auto udaf = dynamic_cast<const node::UdafDefNode*>(call->GetFnDef());
+        ASSERT_TRUE(udaf != nullptr) << std::get<0>(cases[i]);
+        std::vector<const node::ExprNode*> invariants;
+        LoopInvariantAnalysis::Collect(
+            dynamic_cast<const node::LambdaNode*>(udaf->update_func()),
+            &invariants);
+        auto& expect = std::get<1>(cases[i]);
+        ASSERT_EQ(expect.size(), invariants.size()) << std::get<0>(cases[i]);
+        for (size_t k = 0; k < expect.size(); ++k) {
+            std::string expr_str = invariants[k]->GetExprString();
+            ASSERT_TRUE(expr_str.find(expect[k]) != std::string::npos)
+                << std::get<0>(cases[i]) << ": " << expr_str;
+        }
+    }
+}
+
+}  // namespace passes
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::GTEST_FLAG(color) = "yes";
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -15,10 +15,13 @@
  */
 
 #include "passes/expression/window_iter_analysis.h"
+#include <algorithm>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "boost/algorithm/string/case_conv.hpp"
+
 namespace hybridse {
 namespace passes {
 
@@ -152,6 +155,62 @@ Status WindowIterAnalysis::VisitLambdaCall(
     return status;
 }
 
+bool WindowIterAnalysis::GetRowsBound(const udf::UdfLibrary* library,
+                                      const node::ExprNode* expr,
+                                      uint64_t* rows) {
+    if (expr == nullptr) {
+        return true;
+    }
+    switch (expr->GetExprType()) {
+        case node::kExprColumnRef: {
+            *rows = std::max<uint64_t>(*rows, 1);
+            return true;
+        }
+        case node::kExprCall: {
+            auto call = dynamic_cast<const node::CallExprNode*>(expr);
+            auto fn = call->GetFnDef();
+            if (fn == nullptr || fn->GetType() != node::kExternalFnDef) {
+                return false;
+            }
+            std::string name = boost::to_lower_copy(fn->GetName());
+            size_t arg_num = call->GetChildNum();
+            if (name == "first_value" && arg_num == 1) {
+                *rows = std::max<uint64_t>(*rows, 1);
+                return GetRowsBound(library, call->GetChild(0), rows);
+            }
+            if ((name == "at" || name == "lag") && arg_num == 2) {
+                auto offset = dynamic_cast<const node::ConstNode*>(call->GetChild(1));
+                if (offset == nullptr ||
+                    (offset->GetDataType() != node::kInt16 &&
+                     offset->GetDataType() != node::kInt32 &&
+                     offset->GetDataType() != node::kInt64) ||
+                    offset->GetAsInt64() < 0) {
+                    return false;
+                }
+                *rows = std::max<uint64_t>(*rows, offset->GetAsInt64() + 1);
+                return GetRowsBound(library, call->GetChild(0), rows);
+            }
+            if (library->IsUdaf(name, arg_num)) {
+                return false;
+            }
+            for (size_t i = 0; i < arg_num; ++i) {
+                if (library->RequireListAt(name, i)) {
+                    return false;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    for (size_t i = 0; i < expr->GetChildNum(); ++i) {
+        if (!GetRowsBound(library, expr->GetChild(i), rows)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void WindowIterAnalysis::EnterLambdaScope() {
     scope_cache_list_.emplace_back(ScopeCache());
 }
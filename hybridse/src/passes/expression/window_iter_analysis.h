@@ -53,6 +53,13 @@ class WindowIterAnalysis {
     // result query interface
     bool GetRank(const node::ExprNode* expr, WindowIterRank* rank) const;
 
+    // Get the number of the newest rows of the window that the project expression reads, before the
+    // functions of the expression are resolved. Return false if it may read any row of the window, as
+    // the udafs do. The window is read by the first rows only through `at`/`lag` at constant offsets
+    // and `first_value`, and the other columns are of the current row.
+    static bool GetRowsBound(const udf::UdfLibrary* library,
+                             const node::ExprNode* expr, uint64_t* rows);
+
  private:
     // cache
     struct ScopeCache {
@@ -71,6 +71,47 @@ TEST_F(WindowIterAnalysisTest, Test) {
     }
 }
 
+TEST_F(WindowIterAnalysisTest, RowsBoundTest) {
+    // the rows of the window read, or -1 if not bounded
+    std::vector<std::tuple<std::string, int64_t>> cases = {
+        {"1", 0},
+        {"col_0 + 1", 1},
+        {"lag(col_0, 3) over w1", 4},
+        {"AT(col_0 * 2, 1) over w1", 2},
+        {"first_value(col_1) over w1", 1},
+        {"abs(lag(col_0, 2) over w1) + col_1", 3},
+        {"sum(col_0) over w1", -1},
+        {"lag(col_0, 1) over w1 + count(col_1) over w1", -1},
+        {"fz_window_split(cast(col_0 as string), \",\") over w1", -1},
+    };
+    for (auto& test : cases) {
+        std::string sql = "select " + std::get<0>(test) +
+                          " from t1 window w1 as (partition by col_1 order by "
+                          "col_3 rows_range between 3s preceding and current "
+                          "row);";
+        node::PlanNodeList trees;
+        Status status;
+        ASSERT_TRUE(plan::PlanAPI::CreatePlanTreeFromScript(
+            sql, trees, node_manager(), status))
+            << status;
+        auto query_plan = dynamic_cast<node::QueryPlanNode*>(trees[0]);
+        auto project_plan =
+            dynamic_cast<node::ProjectPlanNode*>(query_plan->GetChildren()[0]);
+        auto project_list = dynamic_cast<node::ProjectListNode*>(
+            project_plan->project_list_vec_[0]);
+        auto expr = dynamic_cast<node::ProjectNode*>(
+                        project_list->GetProjects()[0])
+                        ->GetExpression();
+        uint64_t rows = 0;
+        bool bounded = WindowIterAnalysis::GetRowsBound(lib_, expr, &rows);
+        ASSERT_EQ(std::get<1>(test) >= 0, bounded) << std::get<0>(test);
+        if (bounded) {
+            ASSERT_EQ(static_cast<uint64_t>(std::get<1>(test)), rows)
+                << std::get<0>(test);
+        }
+    }
+}
+
 }  // namespace passes
 }  // namespace hybridse
 
@@ -47,6 +47,22 @@ using hybridse::vm::PhysicalSimpleProjectNode;
 using hybridse::vm::PhysicalWindowAggrerationNode;
 using hybridse::vm::ProjectType;
 
+// Return true if cand is better than org for the same keys. The index of
+// less rows per key is more selective if the statistics of both are known,
+// or the one of more keys is taken.
+static bool IsBetterIndex(vm::TableHandler* table, const vm::IndexSt& org,
+                          const vm::IndexSt& cand) {
+    vm::IndexStatistics org_stats;
+    vm::IndexStatistics cand_stats;
+    if (table->GetIndexStatistics(org.name, &org_stats) &&
+        table->GetIndexStatistics(cand.name, &cand_stats) &&
+        org_stats.key_count > 0 && cand_stats.key_count > 0 &&
+        org_stats.AvgRowsPerKey() != cand_stats.AvgRowsPerKey()) {
+        return cand_stats.AvgRowsPerKey() < org_stats.AvgRowsPerKey();
+    }
+    return org.keys.size() < cand.keys.size();
+}
+
 static bool ResolveColumnToSourceColumnName(const node::ColumnRefNode* col,
                                             const SchemasContext* schemas_ctx,
                                             std::string* source_name);
@@ -656,7 +672,8 @@ bool GroupAndSortOptimized::MatchBestIndex(const std::vector<std::string>& colum
                 } else {
                     auto org_index = index_hint.at(best_index_name);
                     auto new_index = index_hint.at(name);
-                    if (org_index.keys.size() < new_index.keys.size()) {
+                    if (IsBetterIndex(table_handler.get(), org_index,
+                                      new_index)) {
                         // override with better index
                         best_index_name = name;
                         best_index_bitmap = sub_best_bitmap;
@@ -17,6 +17,7 @@
 #include "passes/physical/group_and_sort_optimized.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -24,6 +25,7 @@
 #include "plan/plan_api.h"
 #include "testing/test_base.h"
 #include "udf/default_udf_library.h"
+#include "vm/simple_catalog.h"
 #include "vm/transform.h"
 
 namespace hybridse {
@@ -110,6 +112,84 @@ TEST_P(GroupAndSortOptOnCombinedIndexTest, OptimizeOutOfOrderFilter) {
     EXPECT_EQ(cs.physical_tree_str, physical_plan->GetTreeString());
 }
 
+class GroupAndSortOptOnIndexStatisticsTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        hybridse::type::Database db;
+        db.set_name("db");
+
+        hybridse::type::TableDef table_def;
+        table_def.set_name("t2");
+        table_def.set_catalog("db");
+        {
+            auto* c1 = table_def.add_columns();
+            c1->set_type(::hybridse::type::kVarchar);
+            c1->set_name("a");
+
+            auto* c2 = table_def.add_columns();
+            c2->set_type(::hybridse::type::kInt32);
+            c2->set_name("b");
+
+            auto* index_a = table_def.add_indexes();
+            index_a->set_name("idx_a");
+            index_a->add_first_keys("a");
+
+            auto* index_b = table_def.add_indexes();
+            index_b->set_name("idx_b");
+            index_b->add_first_keys("b");
+        }
+        vm::AddTable(db, table_def);
+
+        catalog_ = vm::BuildSimpleCatalog(db);
+    }
+
+    // 10 rows per key of idx_a and `rows_per_key_b` rows per key of idx_b
+    std::string TransformWithStatistics(uint64_t rows_per_key_b) {
+        auto table = std::dynamic_pointer_cast<vm::SimpleCatalogTableHandler>(catalog_->GetTable("db", "t2"));
+        EXPECT_TRUE(table != nullptr);
+        vm::IndexStatistics stats_a;
+        stats_a.key_count = 1000;
+        stats_a.row_count = 10000;
+        table->SetIndexStatistics("idx_a", stats_a);
+        vm::IndexStatistics stats_b;
+        stats_b.key_count = 1000;
+        stats_b.row_count = 1000 * rows_per_key_b;
+        table->SetIndexStatistics("idx_b", stats_b);
+
+        ::hybridse::node::PlanNodeList plan_trees;
+        ::hybridse::base::Status base_status;
+        EXPECT_TRUE(plan::PlanAPI::CreatePlanTreeFromScript("select * from t2 where a = 'aaa' and b = 12;",
+                                                            plan_trees, &manager_, base_status))
+            << base_status;
+
+        auto ctx = llvm::make_unique<llvm::LLVMContext>();
+        auto m = llvm::make_unique<llvm::Module>("test_op_generator", *ctx);
+        auto lib = ::hybridse::udf::DefaultUdfLibrary::get();
+        const codec::Schema empty_schema;
+
+        vm::BatchModeTransformer tf(&manager_, "db", catalog_, &empty_schema, m.get(), lib);
+        tf.AddDefaultPasses();
+
+        PhysicalOpNode* physical_plan = nullptr;
+        base::Status status = tf.TransformPhysicalPlan(plan_trees, &physical_plan);
+        EXPECT_TRUE(status.isOK()) << status;
+        return physical_plan == nullptr ? "" : physical_plan->GetTreeString();
+    }
+
+ protected:
+    node::NodeManager manager_;
+    std::shared_ptr<vm::SimpleCatalog> catalog_;
+};
+
+TEST_F(GroupAndSortOptOnIndexStatisticsTest, ChooseSelectiveIndex) {
+    EXPECT_EQ(R"sql(FILTER_BY(condition=aaa = a, left_keys=(), right_keys=(), index_keys=(12))
+  DATA_PROVIDER(type=Partition, table=t2, index=idx_b))sql",
+              TransformWithStatistics(2));
+    EXPECT_EQ(R"sql(FILTER_BY(condition=12 = b, left_keys=(), right_keys=(), index_keys=(aaa))
+  DATA_PROVIDER(type=Partition, table=t2, index=idx_a))sql",
+              TransformWithStatistics(10000));
+}
+
 }  // namespace passes
 }  // namespace hybridse
 
@@ -15,9 +15,14 @@
  */
 #include "passes/physical/long_window_optimized.h"
 
+#include <absl/strings/match.h>
+#include <absl/strings/numbers.h>
 #include <absl/strings/str_cat.h>
 
+#include <algorithm>
+#include <cctype>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "vm/engine.h"
@@ -105,14 +110,40 @@ bool LongWindowOptimized::OptimizeWithPreAggr(vm::PhysicalAggregationNode* in, i
     auto window = aggr_op->GetOver();
 
     auto expr_type = aggr_op->GetChild(0)->GetExprType();
-    if (aggr_op->GetChildNum() != 1 || (expr_type != node::kExprColumnRef && expr_type != node::kExprAll)) {
+    std::string func_name = aggr_op->GetFnDef()->GetName();
+    // the *_where functions are pre-aggregated with a bool column as the condition
+    const node::ExprNode* cond = nullptr;
+    if (absl::EndsWith(func_name, "_where")) {
+        if (aggr_op->GetChildNum() != 2 || aggr_op->GetChild(1)->GetExprType() != node::kExprColumnRef) {
+            LOG(ERROR) << "Not support aggregation with a condition other than a bool column: "
+                       << aggr_op->GetExprString();
+            return false;
+        }
+        cond = aggr_op->GetChild(1);
+        const auto& cond_name = dynamic_cast<const node::ColumnRefNode*>(cond)->GetColumnName();
+        bool is_bool = false;
+        for (const auto& col : *orig_data_provider->GetOutputSchema()) {
+            if (col.name() == cond_name) {
+                is_bool = col.type() == type::kBool;
+                break;
+            }
+        }
+        if (!is_bool) {
+            LOG(ERROR) << "Not support aggregation with a condition other than a bool column: "
+                       << aggr_op->GetExprString();
+            return false;
+        }
+    } else if (aggr_op->GetChildNum() != 1) {
         LOG(ERROR) << "Not support aggregation over multiple cols: " << ConcatExprList(aggr_op->children_);
         return false;
     }
+    if (expr_type != node::kExprColumnRef && expr_type != node::kExprAll) {
+        LOG(ERROR) << "Not support aggregation over expression: " << ConcatExprList(aggr_op->children_);
+        return false;
+    }
 
     const std::string& db_name = orig_data_provider->GetDb();
     const std::string& table_name = orig_data_provider->GetName();
-    std::string func_name = aggr_op->GetFnDef()->GetName();
     std::string aggr_col = ConcatExprList(aggr_op->children_);
     std::string partition_col;
     if (window->GetPartitions()) {
@@ -152,19 +183,73 @@ bool LongWindowOptimized::OptimizeWithPreAggr(vm::PhysicalAggregationNode* in, i
         return false;
     }
 
-    // TODO(zhanghao): optimize the selection of the best pre-aggregation tables
-    auto table = catalog_->GetTable(table_infos[0].aggr_db, table_infos[0].aggr_table);
+    auto aggr_tables = SelectAggrTables(table_infos);
+    auto request = req_union_op->GetProducer(0);
+    auto raw = req_union_op->GetProducer(1);
+    std::vector<vm::PhysicalTableProviderNode*> aggrs;
+    std::vector<vm::RequestWindowOp> aggr_windows;
+    for (const auto& info : aggr_tables) {
+        vm::PhysicalTableProviderNode* aggr = nullptr;
+        if (!CreateAggrProvider(info, req_union_op->window(), &aggr, &aggr_windows)) {
+            return false;
+        }
+        aggrs.push_back(aggr);
+    }
+
+    vm::PhysicalRequestAggUnionNode* request_aggr_union = nullptr;
+    auto status = plan_ctx_->CreateOp<vm::PhysicalRequestAggUnionNode>(
+        &request_aggr_union, request, raw, aggrs[0], req_union_op->window(), aggr_windows[0],
+        req_union_op->instance_not_in_window(), req_union_op->exclude_current_time(),
+        req_union_op->output_request_row(), aggr_op->GetFnDef(),
+        aggr_op->GetChild(0), cond);
+    if (!status.isOK()) {
+        LOG(ERROR) << "Fail to create PhysicalRequestAggUnionNode: " << status;
+        return false;
+    }
+    for (size_t i = 1; i < aggrs.size(); i++) {
+        request_aggr_union->AddAggrLevel(aggrs[i], aggr_windows[i]);
+    }
+
+    vm::PhysicalReduceAggregationNode* reduce_aggr = nullptr;
+    auto condition = in->having_condition_.condition();
+    if (condition) {
+        condition = condition->DeepCopy(plan_ctx_->node_manager());
+    }
+
+    status = plan_ctx_->CreateOp<vm::PhysicalReduceAggregationNode>(&reduce_aggr, request_aggr_union, in->project(),
+                                                                    condition, in);
+
+    auto ctx = reduce_aggr->schemas_ctx();
+    if (ctx->GetSchemaSourceSize() != 1 || ctx->GetSchema(0)->size() != 1) {
+        LOG(ERROR) << "PhysicalReduceAggregationNode schema is unexpected";
+        return false;
+    }
+    request_aggr_union->UpdateParentSchema(ctx);
+
+    if (!status.isOK()) {
+        LOG(ERROR) << "Fail to create PhysicalReduceAggregationNode: " << status;
+        return false;
+    }
+    LOG(INFO) << "[LongWindowOptimized] Before transform sql:\n" << (*output)->GetTreeString();
+    *output = reduce_aggr;
+    LOG(INFO) << "[LongWindowOptimized] After transform sql:\n" << (*output)->GetTreeString();
+    return true;
+}
+
+bool LongWindowOptimized::CreateAggrProvider(const vm::AggrTableInfo& info, const vm::RequestWindowOp& req_window,
+                                             vm::PhysicalTableProviderNode** aggr,
+                                             std::vector<vm::RequestWindowOp>* aggr_windows) {
+    auto table = catalog_->GetTable(info.aggr_db, info.aggr_table);
     if (!table) {
-        LOG(ERROR) << "Fail to get table handler for pre-aggregation table " << table_infos[0].aggr_db << "."
-                   << table_infos[0].aggr_table;
+        LOG(ERROR) << "Fail to get table handler for pre-aggregation table " << info.aggr_db << "."
+                   << info.aggr_table;
         return false;
     }
 
-    vm::PhysicalTableProviderNode* aggr = nullptr;
-    auto status = plan_ctx_->CreateOp<vm::PhysicalTableProviderNode>(&aggr, table);
+    auto status = plan_ctx_->CreateOp<vm::PhysicalTableProviderNode>(aggr, table);
     if (!status.isOK()) {
-        LOG(ERROR) << "Fail to create PhysicalTableProviderNode for pre-aggregation table " << table_infos[0].aggr_db
-                   << "." << table_infos[0].aggr_table << ": " << status;
+        LOG(ERROR) << "Fail to create PhysicalTableProviderNode for pre-aggregation table " << info.aggr_db
+                   << "." << info.aggr_table << ": " << status;
         return false;
     }
 
@@ -175,11 +260,7 @@ bool LongWindowOptimized::OptimizeWithPreAggr(vm::PhysicalAggregationNode* in, i
     auto index = table->GetIndex().cbegin()->second;
     auto nm = plan_ctx_->node_manager();
 
-    auto request = req_union_op->GetProducer(0);
-    auto raw = req_union_op->GetProducer(1);
-
     // generate an aggregation window for the aggr table
-    auto req_window = req_union_op->window();
     auto partitions = nm->MakeExprList();
     for (size_t i = 0; i < index.keys.size(); i++) {
         auto col_ref = nm->MakeColumnRefNode(index.keys[i].name, table->GetName(), table->GetDatabase());
@@ -205,42 +286,56 @@ bool LongWindowOptimized::OptimizeWithPreAggr(vm::PhysicalAggregationNode* in, i
     aggr_window.range_ = req_window.range_;
     aggr_window.range_.range_key_ = order_col_ref;
     aggr_window.partition_.keys_ = partition_by;
+    aggr_windows->push_back(aggr_window);
+    return true;
+}
 
-    vm::PhysicalRequestAggUnionNode* request_aggr_union = nullptr;
-    status = plan_ctx_->CreateOp<vm::PhysicalRequestAggUnionNode>(
-        &request_aggr_union, request, raw, aggr, req_union_op->window(), aggr_window,
-        req_union_op->instance_not_in_window(), req_union_op->exclude_current_time(),
-        req_union_op->output_request_row(), aggr_op->GetFnDef(),
-        aggr_op->GetChild(0));
-    if (!status.isOK()) {
-        LOG(ERROR) << "Fail to create PhysicalRequestAggUnionNode: " << status;
-        return false;
+std::vector<vm::AggrTableInfo> LongWindowOptimized::SelectAggrTables(
+    const std::vector<vm::AggrTableInfo>& table_infos) {
+    std::vector<std::pair<int64_t, const vm::AggrTableInfo*>> levels;
+    for (const auto& info : table_infos) {
+        int64_t bucket_size = GetBucketSizeMs(info.bucket_size);
+        if (bucket_size <= 0) {
+            continue;
+        }
+        bool exist = std::any_of(levels.begin(), levels.end(),
+                                 [bucket_size](const auto& level) { return level.first == bucket_size; });
+        if (!exist) {
+            levels.emplace_back(bucket_size, &info);
+        }
     }
-
-    vm::PhysicalReduceAggregationNode* reduce_aggr = nullptr;
-    auto condition = in->having_condition_.condition();
-    if (condition) {
-        condition = condition->DeepCopy(plan_ctx_->node_manager());
+    if (levels.size() < 2) {
+        return {table_infos[0]};
     }
-
-    status = plan_ctx_->CreateOp<vm::PhysicalReduceAggregationNode>(&reduce_aggr, request_aggr_union, in->project(),
-                                                                    condition, in);
-
-    auto ctx = reduce_aggr->schemas_ctx();
-    if (ctx->GetSchemaSourceSize() != 1 || ctx->GetSchema(0)->size() != 1) {
-        LOG(ERROR) << "PhysicalReduceAggregationNode schema is unexpected";
-        return false;
+    std::sort(levels.begin(), levels.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    std::vector<vm::AggrTableInfo> tables;
+    for (const auto& level : levels) {
+        tables.push_back(*level.second);
     }
-    request_aggr_union->UpdateParentSchema(ctx);
+    return tables;
+}
 
-    if (!status.isOK()) {
-        LOG(ERROR) << "Fail to create PhysicalReduceAggregationNode: " << status;
-        return false;
+int64_t LongWindowOptimized::GetBucketSizeMs(const std::string& bucket_size) {
+    if (bucket_size.size() < 2) {
+        return -1;
+    }
+    int64_t size = 0;
+    if (!absl::SimpleAtoi(bucket_size.substr(0, bucket_size.size() - 1), &size) || size <= 0) {
+        return -1;
+    }
+    switch (std::tolower(bucket_size.back())) {
+        case 's':
+            return size * 1000;
+        case 'm':
+            return size * 1000 * 60;
+        case 'h':
+            return size * 1000 * 60 * 60;
+        case 'd':
+            return size * 1000 * 60 * 60 * 24;
+        default:
+            return -1;
     }
-    LOG(INFO) << "[LongWindowOptimized] Before transform sql:\n" << (*output)->GetTreeString();
-    *output = reduce_aggr;
-    LOG(INFO) << "[LongWindowOptimized] After transform sql:\n" << (*output)->GetTreeString();
-    return true;
 }
 
 bool LongWindowOptimized::VerifySingleAggregation(vm::PhysicalProjectNode* op) { return op->project().size() == 1; }
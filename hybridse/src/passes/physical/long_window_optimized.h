@@ -33,6 +33,13 @@ class LongWindowOptimized : public TransformUpPysicalPass {
     bool Transform(PhysicalOpNode* in, PhysicalOpNode** output) override;
     bool VerifySingleAggregation(vm::PhysicalProjectNode* op);
     bool OptimizeWithPreAggr(vm::PhysicalAggregationNode* in, int idx, PhysicalOpNode** output);
+    // create the provider of a pre-aggr table and append its aggregation window to `aggr_windows`
+    bool CreateAggrProvider(const vm::AggrTableInfo& info, const vm::RequestWindowOp& req_window,
+                            vm::PhysicalTableProviderNode** aggr, std::vector<vm::RequestWindowOp>* aggr_windows);
+    // the multi-level pre-aggr tables of time buckets from the finest to the coarsest, or the first table
+    static std::vector<vm::AggrTableInfo> SelectAggrTables(const std::vector<vm::AggrTableInfo>& table_infos);
+    // the bucket size like `1h` in milliseconds, or -1 for the bucket of rows number
+    static int64_t GetBucketSizeMs(const std::string& bucket_size);
     static std::string ConcatExprList(std::vector<node::ExprNode*> exprs, const std::string& delimiter = ",");
 
     std::set<std::string> long_windows_;
@@ -640,8 +640,20 @@ base::Status ConvertStatement(const zetasql::ASTStatement* statement, node::Node
                        explain_statement->statement()->GetNodeKindString())
             node::SqlNode* query_node = nullptr;
             CHECK_STATUS(ConvertStatement(explain_statement->statement(), node_manager, &query_node))
-            *output = node_manager->MakeExplainNode(dynamic_cast<node::QueryNode*>(query_node),
-                                                    node::ExplainType::kExplainPhysical);
+            auto explain_type = node::ExplainType::kExplainPhysical;
+            // EXPLAIN <query> CONFIG (analyze = true) runs the query and shows the statistics of its runners
+            auto& config_options = dynamic_cast<node::QueryNode*>(query_node)->config_options_;
+            if (config_options != nullptr) {
+                auto analyze = config_options->find("analyze");
+                if (analyze != config_options->end()) {
+                    CHECK_TRUE(analyze->second->GetDataType() == node::kBool, common::kSqlAstError,
+                               "the analyze config of explain should be a bool")
+                    if (analyze->second->GetBool()) {
+                        explain_type = node::ExplainType::kExplainAnalyze;
+                    }
+                }
+            }
+            *output = node_manager->MakeExplainNode(dynamic_cast<node::QueryNode*>(query_node), explain_type);
             break;
         }
         case zetasql::AST_CREATE_INDEX_STATEMENT: {
@@ -798,6 +810,19 @@ base::Status ConvertStatement(const zetasql::ASTStatement* statement, node::Node
             auto id = delete_stmt->GetTargetPathForNonNested().value_or(nullptr);
             CHECK_TRUE(id != nullptr, common::kSqlAstError,
                        "unsupported delete statement's target is not path expression");
+            if (delete_stmt->opt_target_name() == nullptr) {
+                // DELETE FROM [db.]table WHERE ...
+                CHECK_TRUE(id->num_names() <= 2, common::kSqlAstError, "unsupported size of table path");
+                CHECK_TRUE(delete_stmt->where() != nullptr, common::kSqlAstError,
+                           "unsupported delete statement without where clause");
+                std::vector<std::string> table_path;
+                CHECK_STATUS(AstPathExpressionToStringList(id, table_path));
+                std::string db = table_path.size() == 2 ? table_path[0] : "";
+                node::ExprNode* condition = nullptr;
+                CHECK_STATUS(ConvertExprNode(delete_stmt->where(), node_manager, &condition));
+                *output = node_manager->MakeDeleteNode(db, table_path.back(), condition);
+                break;
+            }
             CHECK_TRUE(id->num_names() == 1, common::kSqlAstError,
                        "unsupported delete statement's target path has size >= 2");
             auto id_name = id->first_name()->GetAsStringView();
@@ -1661,6 +1686,7 @@ base::Status ConvertIndexOption(const zetasql::ASTOptionsEntry* entry, node::Nod
 //   ("partitionnum", int) -> PartitionNumNode(int)
 //   ("replicanum", int)   -> ReplicaNumNode(int)
 //   ("distribution", [ (string, [string] ) ] ) ->
+//   ("broadcast", bool)   -> BroadcastNode(bool)
 base::Status ConvertTableOption(const zetasql::ASTOptionsEntry* entry, node::NodeManager* node_manager,
                                 node::SqlNode** output) {
     auto identifier = entry->name()->GetAsString();
@@ -1707,6 +1733,10 @@ base::Status ConvertTableOption(const zetasql::ASTOptionsEntry* entry, node::Nod
         CHECK_STATUS(AstStringLiteralToString(entry->value(), &storage_mode));
         boost::to_lower(storage_mode);
         *output = node_manager->MakeStorageModeNode(node::NameToStorageMode(storage_mode));
+    } else if (boost::equals("broadcast", identifier)) {
+        const auto literal = entry->value()->GetAsOrNull<zetasql::ASTBooleanLiteral>();
+        CHECK_TRUE(literal != nullptr, common::kSqlAstError, "broadcast is not a bool literal");
+        *output = node_manager->MakeBroadcastNode(literal->value());
     } else {
         return base::Status(common::kOk, "create table option ignored");
     }
@@ -2067,6 +2097,7 @@ static const absl::flat_hash_map<std::string_view, ShowTargetInfo> showTargetMap
     {"COMPONENTS", {node::CmdType::kCmdShowComponents}},
     {"TABLE STATUS", {node::CmdType::kCmdShowTableStatus}},
     {"FUNCTIONS", {node::CmdType::kCmdShowFunctions}},
+    {"DEPLOYMENT_STATS", {node::CmdType::kCmdShowDeploymentStats}},
 };
 
 base::Status convertShowStmt(const zetasql::ASTShowStatement* show_statement, node::NodeManager* node_manager,
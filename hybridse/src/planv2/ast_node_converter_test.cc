@@ -342,6 +342,39 @@ TEST_F(ASTNodeConverterTest, ConvertFrameNodeTest) {
     }
 }
 
+TEST_F(ASTNodeConverterTest, ConvertExplainAnalyzeTest) {
+    node::NodeManager node_manager;
+    auto convert = [&node_manager](const std::string& sql, node::SqlNode** output) {
+        std::unique_ptr<zetasql::ParserOutput> parser_output;
+        ZETASQL_EXPECT_OK(zetasql::ParseStatement(sql, zetasql::ParserOptions(), &parser_output));
+        return ConvertStatement(parser_output->statement(), &node_manager, output);
+    };
+    {
+        node::SqlNode* output = nullptr;
+        auto status = convert("explain select col1 from t1;", &output);
+        ASSERT_TRUE(status.isOK()) << status;
+        ASSERT_EQ(node::kExplainPhysical, dynamic_cast<node::ExplainNode*>(output)->explain_type_);
+    }
+    {
+        node::SqlNode* output = nullptr;
+        auto status = convert("explain select col1 from t1 CONFIG (analyze = true);", &output);
+        ASSERT_TRUE(status.isOK()) << status;
+        ASSERT_EQ(node::kExplainAnalyze, dynamic_cast<node::ExplainNode*>(output)->explain_type_);
+    }
+    {
+        node::SqlNode* output = nullptr;
+        auto status = convert("explain select col1 from t1 CONFIG (analyze = false);", &output);
+        ASSERT_TRUE(status.isOK()) << status;
+        ASSERT_EQ(node::kExplainPhysical, dynamic_cast<node::ExplainNode*>(output)->explain_type_);
+    }
+    {
+        node::SqlNode* output = nullptr;
+        auto status = convert("explain select col1 from t1 CONFIG (analyze = 'yes');", &output);
+        ASSERT_FALSE(status.isOK());
+        ASSERT_EQ("the analyze config of explain should be a bool", status.msg);
+    }
+}
+
 TEST_F(ASTNodeConverterTest, ConvertCreateTableNodeOkTest) {
     node::NodeManager node_manager;
     {
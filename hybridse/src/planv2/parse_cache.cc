@@ -0,0 +1,158 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "planv2/parse_cache.h"
+
+#include <cctype>
+
+#include "zetasql/public/error_helpers.h"
+
+namespace hybridse {
+namespace plan {
+
+ParseCache* ParseCache::GetInstance() {
+    static ParseCache* cache = new ParseCache(kDefaultCapacity);
+    return cache;
+}
+
+std::string ParseCache::Fingerprint(const std::string& sql) {
+    if (sql.find('\\') != std::string::npos) {
+        return sql;
+    }
+    std::string fingerprint;
+    fingerprint.reserve(sql.size());
+    bool space = false;
+    size_t pos = 0;
+    while (pos < sql.size()) {
+        char c = sql[pos];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            space = true;
+            pos++;
+            continue;
+        }
+        if (space && !fingerprint.empty()) {
+            fingerprint.push_back(' ');
+        }
+        space = false;
+        // the end of the token copied as is
+        size_t end = std::string::npos;
+        if (c == '\'' || c == '"' || c == '`') {
+            std::string triple(3, c);
+            if (c != '`' && sql.compare(pos, 3, triple) == 0) {
+                end = sql.find(triple, pos + 3);
+                end = end == std::string::npos ? end : end + 3;
+            } else {
+                end = sql.find(c, pos + 1);
+                end = end == std::string::npos ? end : end + 1;
+            }
+        } else if (c == '#' || sql.compare(pos, 2, "--") == 0) {
+            end = sql.find('\n', pos);
+            end = end == std::string::npos ? end : end + 1;
+        } else if (sql.compare(pos, 2, "/*") == 0) {
+            end = sql.find("*/", pos + 2);
+            end = end == std::string::npos ? end : end + 2;
+        } else {
+            end = pos + 1;
+        }
+        if (end == std::string::npos) {
+            end = sql.size();
+        }
+        fingerprint.append(sql, pos, end - pos);
+        pos = end;
+    }
+    return fingerprint;
+}
+
+base::Status ParseCache::Parse(const std::string& sql, std::shared_ptr<const ParsedScript>* script) {
+    std::string fingerprint = Fingerprint(sql);
+    *script = Get(fingerprint);
+    if (*script) {
+        return base::Status::OK();
+    }
+    auto parsed = std::make_shared<ParsedScript>();
+    parsed->sql = sql;
+    zetasql::ParserOptions parser_opts;
+    zetasql::LanguageOptions language_opts;
+    language_opts.EnableLanguageFeature(zetasql::FEATURE_V_1_3_COLUMN_DEFAULT_VALUE);
+    parser_opts.set_language_options(&language_opts);
+    auto zetasql_status = zetasql::ParseScript(parsed->sql, parser_opts, zetasql::ERROR_MESSAGE_MULTI_LINE_WITH_CARET,
+                                               &parsed->parser_output);
+    if (!zetasql_status.ok()) {
+        return base::Status(common::kSyntaxError, zetasql::FormatError(zetasql_status));
+    }
+    *script = parsed;
+    Insert(fingerprint, *script);
+    return base::Status::OK();
+}
+
+std::shared_ptr<const ParsedScript> ParseCache::Get(const std::string& fingerprint) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto iter = index_.find(fingerprint);
+    if (iter == index_.end()) {
+        miss_cnt_++;
+        return nullptr;
+    }
+    hit_cnt_++;
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return iter->second->second;
+}
+
+void ParseCache::Insert(const std::string& fingerprint, const std::shared_ptr<const ParsedScript>& script) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (capacity_ == 0 || index_.find(fingerprint) != index_.end()) {
+        // the sql is parsed by another compiling meanwhile
+        return;
+    }
+    entries_.emplace_front(fingerprint, script);
+    index_.emplace(fingerprint, entries_.begin());
+    while (entries_.size() > capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+}
+
+void ParseCache::SetCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mu_);
+    capacity_ = capacity;
+    while (entries_.size() > capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+}
+
+void ParseCache::Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    index_.clear();
+    entries_.clear();
+}
+
+size_t ParseCache::GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return entries_.size();
+}
+
+uint64_t ParseCache::GetHitCnt() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return hit_cnt_;
+}
+
+uint64_t ParseCache::GetMissCnt() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return miss_cnt_;
+}
+
+}  // namespace plan
+}  // namespace hybridse
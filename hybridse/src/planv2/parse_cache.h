@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_PLANV2_PARSE_CACHE_H_
+#define HYBRIDSE_SRC_PLANV2_PARSE_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "base/fe_status.h"
+#include "zetasql/parser/parser.h"
+
+namespace hybridse {
+namespace plan {
+
+// the zetasql ast of a sql script, it is read only once parsed
+struct ParsedScript {
+    // the sql parsed, kept as long as the ast
+    std::string sql;
+    std::unique_ptr<zetasql::ParserOutput> parser_output;
+};
+
+// ParseCache keeps the asts of the latest parsed sql scripts, keyed by the fingerprints of the sqls.
+//
+// The ast depends on nothing but the sql, so it is shared by all the engines, dbs and modes in the process,
+// and a compiling of the sql missing the compile cache converts the cached ast into its own node manager
+// instead of parsing the sql again. The plans are not cached as they are made in and referred to by the
+// node manager of every compiling.
+class ParseCache {
+ public:
+    static constexpr size_t kDefaultCapacity = 1024;
+
+    static ParseCache* GetInstance();
+
+    explicit ParseCache(size_t capacity) : capacity_(capacity) {}
+
+    // The sqls differing only in the whitespaces out of the literals, the quoted identifiers and the comments
+    // share the fingerprint. The sql is the fingerprint itself if it has a backslash, as the escaping in the
+    // raw strings is not followed.
+    static std::string Fingerprint(const std::string& sql);
+
+    // parse the sql or return the cached ast, the failures are not cached
+    base::Status Parse(const std::string& sql, std::shared_ptr<const ParsedScript>* script);
+
+    // the cache is disabled with 0 capacity
+    void SetCapacity(size_t capacity);
+    void Clear();
+
+    size_t GetSize();
+    uint64_t GetHitCnt();
+    uint64_t GetMissCnt();
+
+ private:
+    std::shared_ptr<const ParsedScript> Get(const std::string& fingerprint);
+    void Insert(const std::string& fingerprint, const std::shared_ptr<const ParsedScript>& script);
+
+    std::mutex mu_;
+    size_t capacity_;
+    // the latest used first
+    std::list<std::pair<std::string, std::shared_ptr<const ParsedScript>>> entries_;
+    std::unordered_map<std::string, decltype(entries_)::iterator> index_;
+    uint64_t hit_cnt_ = 0;
+    uint64_t miss_cnt_ = 0;
+};
+
+}  // namespace plan
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_PLANV2_PARSE_CACHE_H_
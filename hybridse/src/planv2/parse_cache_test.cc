@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "planv2/parse_cache.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "plan/plan_api.h"
+
+namespace hybridse {
+namespace plan {
+
+class ParseCacheTest : public ::testing::Test {};
+
+TEST_F(ParseCacheTest, Fingerprint) {
+    ASSERT_EQ("select c1 from t1;", ParseCache::Fingerprint("  select c1\n\tfrom   t1;\n"));
+    // the whitespaces in the literals, the quoted identifiers and the comments are kept
+    ASSERT_EQ("select 'a  b', `c  d` from t1;", ParseCache::Fingerprint("select 'a  b',  `c  d` from t1;"));
+    ASSERT_EQ("select '''it's  a''' from t1;", ParseCache::Fingerprint("select  '''it's  a''' from t1;"));
+    ASSERT_EQ("select c1 -- a  b\n from t1;", ParseCache::Fingerprint("select c1  -- a  b\n  from t1;"));
+    ASSERT_EQ("select /* a  b */ c1 from t1;", ParseCache::Fingerprint("select  /* a  b */ c1 from t1;"));
+    ASSERT_NE(ParseCache::Fingerprint("select c1 -- a\nfrom t1;"),
+              ParseCache::Fingerprint("select c1 -- a from t1;"));
+    // unclosed
+    ASSERT_EQ("select 'a  b", ParseCache::Fingerprint("select  'a  b"));
+    ASSERT_EQ("select r'\\'  ,  'a'", ParseCache::Fingerprint("select r'\\'  ,  'a'"));
+}
+
+TEST_F(ParseCacheTest, Parse) {
+    ParseCache cache(2);
+    std::shared_ptr<const ParsedScript> script1;
+    ASSERT_TRUE(cache.Parse("select c1 from t1;", &script1).isOK());
+    std::shared_ptr<const ParsedScript> script2;
+    ASSERT_TRUE(cache.Parse("select c1\n  from t1;", &script2).isOK());
+    ASSERT_EQ(script1, script2);
+    ASSERT_EQ(1u, cache.GetHitCnt());
+    ASSERT_EQ(1u, cache.GetMissCnt());
+
+    // the failures are not cached
+    std::shared_ptr<const ParsedScript> script3;
+    base::Status status = cache.Parse("select c1 fro t1;", &script3);
+    ASSERT_EQ(common::kSyntaxError, status.code);
+    ASSERT_EQ(1u, cache.GetSize());
+
+    ASSERT_TRUE(cache.Parse("select c2 from t1;", &script3).isOK());
+    ASSERT_TRUE(cache.Parse("select c3 from t1;", &script3).isOK());
+    ASSERT_EQ(2u, cache.GetSize());
+    // evicted, the evicted ast is still usable by its holders
+    ASSERT_TRUE(cache.Parse("select c1 from t1;", &script2).isOK());
+    ASSERT_NE(script1, script2);
+    ASSERT_EQ("select c1 from t1;", script1->sql);
+
+    cache.SetCapacity(0);
+    ASSERT_EQ(0u, cache.GetSize());
+    ASSERT_TRUE(cache.Parse("select c1 from t1;", &script2).isOK());
+    ASSERT_EQ(0u, cache.GetSize());
+}
+
+TEST_F(ParseCacheTest, PlanFromCachedAst) {
+    ParseCache::GetInstance()->Clear();
+    for (int i = 0; i < 2; i++) {
+        node::NodeManager manager;
+        node::PlanNodeList plan_trees;
+        base::Status status;
+        ASSERT_TRUE(PlanAPI::CreatePlanTreeFromScript("select c1 from t1;", plan_trees, &manager, status));
+        ASSERT_EQ(1u, plan_trees.size());
+    }
+    ASSERT_GE(ParseCache::GetInstance()->GetHitCnt(), 1u);
+}
+
+}  // namespace plan
+}  // namespace hybridse
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
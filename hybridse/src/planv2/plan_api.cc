@@ -15,9 +15,8 @@
  */
 #include "plan/plan_api.h"
 
+#include "planv2/parse_cache.h"
 #include "planv2/planner_v2.h"
-#include "zetasql/public/error_helpers.h"
-#include "zetasql/public/error_location.pb.h"
 
 namespace hybridse {
 namespace plan {
@@ -28,23 +27,13 @@ bool PlanAPI::CreatePlanTreeFromScript(const std::string &sql, PlanNodeList &pla
                                        Status &status, bool is_batch_mode, bool is_cluster,
                                        bool enable_batch_window_parallelization,
                                        const std::unordered_map<std::string, std::string>* extra_options) {
-    std::unique_ptr<zetasql::ParserOutput> parser_output;
-    zetasql::ParserOptions parser_opts;
-    zetasql::LanguageOptions language_opts;
-    language_opts.EnableLanguageFeature(zetasql::FEATURE_V_1_3_COLUMN_DEFAULT_VALUE);
-    parser_opts.set_language_options(&language_opts);
-    auto zetasql_status = zetasql::ParseScript(sql, parser_opts,
-                                               zetasql::ERROR_MESSAGE_MULTI_LINE_WITH_CARET, &parser_output);
-    zetasql::ErrorLocation location;
-    if (!zetasql_status.ok()) {
-        zetasql::ErrorLocation location;
-        GetErrorLocation(zetasql_status, &location);
-        status.msg = zetasql::FormatError(zetasql_status);
-        status.code = common::kSyntaxError;
+    std::shared_ptr<const ParsedScript> parsed;
+    status = ParseCache::GetInstance()->Parse(sql, &parsed);
+    if (!status.isOK()) {
         return false;
     }
-    DLOG(INFO) << "AST Node:\n" << parser_output->script()->DebugString();
-    const zetasql::ASTScript *script = parser_output->script();
+    DLOG(INFO) << "AST Node:\n" << parsed->parser_output->script()->DebugString();
+    const zetasql::ASTScript *script = parsed->parser_output->script();
     auto planner_ptr = std::make_unique<SimplePlannerV2>(node_manager, is_batch_mode, is_cluster,
                                                          enable_batch_window_parallelization, extra_options);
     status = planner_ptr->CreateASTScriptPlan(script, plan_trees);
@@ -48,6 +48,15 @@
 %typemap(javain) TYPE "$javainput"
 %typemap(javain) const TYPE & "$javainput"
 
+// the buffer returned is a view of the native memory, null if it is empty
+%typemap(out) TYPE %{
+    $result = $1.addr == nullptr ? nullptr : jenv->NewDirectByteBuffer($1.addr, static_cast<jlong>($1.size));
+%}
+%typemap(javaout) TYPE {
+    java.nio.ByteBuffer buf = $jnicall;
+    return buf == null ? null : buf.order(java.nio.ByteOrder.nativeOrder());
+  }
+
 
 %enddef
 
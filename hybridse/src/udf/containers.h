@@ -19,14 +19,15 @@
 
 #include <algorithm>
 #include <functional>
-#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/type.h"
 #include "codec/type_codec.h"
 #include "udf/literal_traits.h"
 #include "udf/udf.h"
+#include "vm/jit_runtime.h"
 
 namespace hybridse {
 namespace udf {
@@ -65,6 +66,171 @@ struct ContainerStorageTypeTrait<openmldb::base::Timestamp> {
     }
 };
 
+/**
+ * Allocate from the memory pool of the current run step. The memory is
+ * released as a whole by `JitRuntime::ReleaseRunStep`, so the containers on it
+ * should not outlive the run step, as the states of udafs do.
+ */
+template <typename T>
+struct RunStepAllocator {
+    using value_type = T;
+
+    RunStepAllocator() = default;
+    template <typename U>
+    RunStepAllocator(const RunStepAllocator<U>&) {}  // NOLINT
+
+    T* allocate(size_t n) {
+        // the pool does not align the memory
+        size_t bytes = n * sizeof(T) + alignof(T) - 1;
+        auto addr = reinterpret_cast<uintptr_t>(
+            vm::JitRuntime::get()->AllocManaged(bytes));
+        return reinterpret_cast<T*>((addr + alignof(T) - 1) &
+                                    ~(alignof(T) - 1));
+    }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const RunStepAllocator<U>&) const {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const RunStepAllocator<U>&) const {
+        return false;
+    }
+};
+
+/**
+ * The map of udaf states keyed by category, with the interface of `std::map`
+ * used by the udafs. The entries are kept densely and looked up by an open
+ * addressing hash index, both allocated from the run step memory pool, so an
+ * update does not allocate unless the map grows.
+ *
+ * The entries are sorted by key lazily once they are iterated from the begin,
+ * `end()` and `find()` keep the order. The iterators are invalidated by
+ * insertion and erasure.
+ */
+template <typename K, typename V>
+class FlatMap {
+ public:
+    using value_type = std::pair<K, V>;
+    using Entries = std::vector<value_type, RunStepAllocator<value_type>>;
+    using iterator = typename Entries::iterator;
+    using reverse_iterator = typename Entries::reverse_iterator;
+
+    iterator begin() {
+        Sort();
+        return entries_.begin();
+    }
+    iterator end() { return entries_.end(); }
+    reverse_iterator rbegin() {
+        Sort();
+        return entries_.rbegin();
+    }
+    reverse_iterator rend() {
+        Sort();
+        return entries_.rend();
+    }
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    void clear() {
+        entries_.clear();
+        index_.clear();
+        sorted_cnt_ = 0;
+    }
+
+    iterator find(const K& key) {
+        if (index_.empty()) {
+            return entries_.end();
+        }
+        size_t mask = index_.size() - 1;
+        for (size_t pos = std::hash<K>()(key) & mask;; pos = (pos + 1) & mask) {
+            uint32_t slot = index_[pos];
+            if (slot == 0) {
+                return entries_.end();
+            }
+            if (entries_[slot - 1].first == key) {
+                return entries_.begin() + (slot - 1);
+            }
+        }
+    }
+
+    std::pair<iterator, bool> emplace(const K& key, const V& value) {
+        auto iter = find(key);
+        if (iter != entries_.end()) {
+            return {iter, false};
+        }
+        if (sorted_cnt_ == entries_.size() &&
+            (entries_.empty() || entries_.back().first < key)) {
+            sorted_cnt_ += 1;
+        }
+        entries_.emplace_back(key, value);
+        if (entries_.size() * 2 > index_.size()) {
+            Rehash(std::max<size_t>(MIN_INDEX_SIZE, index_.size() * 2));
+        } else {
+            Index(entries_.size() - 1);
+        }
+        return {entries_.end() - 1, true};
+    }
+
+    // the hint is ignored
+    iterator insert(iterator, const value_type& value) {
+        return emplace(value.first, value.second).first;
+    }
+
+    // O(n), the udafs only erase from the maps bounded by a small top n
+    iterator erase(iterator iter) {
+        size_t pos = iter - entries_.begin();
+        if (pos < sorted_cnt_) {
+            sorted_cnt_ -= 1;
+        }
+        entries_.erase(iter);
+        Rehash(index_.size());
+        return entries_.begin() + pos;
+    }
+
+ private:
+    static const size_t MIN_INDEX_SIZE = 16;
+
+    void Index(size_t idx) {
+        size_t mask = index_.size() - 1;
+        size_t pos = std::hash<K>()(entries_[idx].first) & mask;
+        while (index_[pos] != 0) {
+            pos = (pos + 1) & mask;
+        }
+        index_[pos] = idx + 1;
+    }
+
+    void Rehash(size_t index_size) {
+        index_.assign(index_size, 0);
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            Index(i);
+        }
+    }
+
+    // only the entries appended since the last sort are sorted and merged
+    void Sort() {
+        if (sorted_cnt_ == entries_.size()) {
+            return;
+        }
+        auto less = [](const value_type& l, const value_type& r) {
+            return l.first < r.first;
+        };
+        auto mid = entries_.begin() + sorted_cnt_;
+        std::sort(mid, entries_.end(), less);
+        std::inplace_merge(entries_.begin(), mid, entries_.end(), less);
+        Rehash(index_.size());
+        sorted_cnt_ = entries_.size();
+    }
+
+    Entries entries_;
+    // the positions of entries plus 1, 0 if the slot is empty
+    std::vector<uint32_t, RunStepAllocator<uint32_t>> index_;
+    // the count of the leading entries in order
+    size_t sorted_cnt_ = 0;
+};
+
 template <typename T, typename BoundT>
 class TopKContainer {
  public:
@@ -139,8 +305,14 @@ class TopKContainer {
 
     void Push(InputT t) {
         auto key = ContainerStorageTypeTrait<T>::to_stored_value(t);
-        auto iter = map_.find(key);
-        if (iter == map_.end()) {
+        // the value no larger than the min one is evicted once pushed
+        if (elem_cnt_ >= bound_ && (map_.empty() || !(map_.front().first < key))) {
+            return;
+        }
+        auto iter = std::lower_bound(
+            map_.begin(), map_.end(), key,
+            [](const Entry& entry, const StorageT& k) { return entry.first < k; });
+        if (iter == map_.end() || key < iter->first) {
             map_.insert(iter, {key, 1});
         } else {
             iter->second += 1;
@@ -157,7 +329,9 @@ class TopKContainer {
     }
 
  private:
-    std::map<StorageT, size_t, std::less<StorageT>> map_;
+    using Entry = std::pair<StorageT, size_t>;
+    // the distinct values in ascending order with their counts, at most bound
+    std::vector<Entry, RunStepAllocator<Entry>> map_;
     BoundT elem_cnt_ = 0;
     BoundT bound_ = -1;  // delayed to be set by first push
 };
@@ -304,10 +478,10 @@ class BoundedGroupByDict {
             str_len - 1;  // must leave one '\0' for string format impl
     }
 
-    std::map<StorageK, StorageV>& map() { return map_; }
+    FlatMap<StorageK, StorageV>& map() { return map_; }
 
  private:
-    std::map<StorageK, StorageV> map_;
+    FlatMap<StorageK, StorageV> map_;
 
     static const size_t MAX_OUTPUT_STR_SIZE = 4096;
 };
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <string>
+
+#include "base/fe_hash.h"
+#include "base/sketch.h"
+#include "udf/default_udf_library.h"
+#include "udf/udf_registry.h"
+
+using openmldb::base::Date;
+using openmldb::base::StringRef;
+using openmldb::base::Timestamp;
+
+namespace hybridse {
+namespace udf {
+
+namespace {
+const uint32_t kHashSeed = 0xe17a1465;
+
+uint64_t HashBytes(const void* data, size_t size) { return base::MurmurHash64A(data, size, kHashSeed); }
+
+uint64_t HashValue(int64_t value) { return HashBytes(&value, sizeof(value)); }
+uint64_t HashValue(double value) {
+    // 0.0 and -0.0 are the same value
+    if (value == 0) {
+        value = 0;
+    }
+    return HashBytes(&value, sizeof(value));
+}
+uint64_t HashValue(bool value) { return HashValue(static_cast<int64_t>(value)); }
+uint64_t HashValue(int16_t value) { return HashValue(static_cast<int64_t>(value)); }
+uint64_t HashValue(int32_t value) { return HashValue(static_cast<int64_t>(value)); }
+uint64_t HashValue(float value) { return HashValue(static_cast<double>(value)); }
+uint64_t HashValue(Timestamp* value) { return HashValue(value->ts_); }
+uint64_t HashValue(Date* value) { return HashValue(static_cast<int64_t>(value->date_)); }
+uint64_t HashValue(StringRef* value) { return HashBytes(value->data_, value->size_); }
+}  // namespace
+
+template <typename T>
+struct ApproxDistinctCountDef {
+    using ArgT = typename DataTypeTrait<T>::CCallArgType;
+    using StateT = base::HyperLogLog;
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix = ".opaque_hll_" + DataTypeTrait<T>::to_string();
+        helper.templates<int64_t, Opaque<StateT>, Nullable<T>>()
+            .init("approx_distinct_count_init" + suffix, Init)
+            .update("approx_distinct_count_update" + suffix, Update)
+            .output("approx_distinct_count_output" + suffix, Output);
+    }
+
+    static void Init(StateT* addr) { new (addr) StateT(); }
+
+    static StateT* Update(StateT* state, ArgT value, bool is_null) {
+        if (!is_null) {
+            state->AddHash(HashValue(value));
+        }
+        return state;
+    }
+
+    static int64_t Output(StateT* state) {
+        int64_t cnt = state->Estimate();
+        state->~StateT();
+        return cnt;
+    }
+};
+
+template <typename T>
+struct ApproxPercentileDef {
+    struct StateT {
+        base::TDigest digest;
+        double percentage = 0;
+    };
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix = ".opaque_tdigest_" + DataTypeTrait<T>::to_string();
+        helper.templates<Nullable<double>, Opaque<StateT>, Nullable<T>, double>()
+            .init("approx_percentile_init" + suffix, Init)
+            .update("approx_percentile_update" + suffix, Update)
+            .output("approx_percentile_output" + suffix, reinterpret_cast<void*>(Output), true);
+    }
+
+    static void Init(StateT* addr) { new (addr) StateT(); }
+
+    static StateT* Update(StateT* state, T value, bool is_null, double percentage) {
+        state->percentage = percentage;
+        if (!is_null) {
+            state->digest.Add(static_cast<double>(value));
+        }
+        return state;
+    }
+
+    static void Output(StateT* state, double* output, bool* is_null) {
+        double percentage = state->percentage;
+        if (state->digest.Empty() || !(percentage >= 0 && percentage <= 1)) {
+            *is_null = true;
+            *output = 0;
+        } else {
+            *is_null = false;
+            *output = state->digest.Quantile(percentage);
+        }
+        state->~StateT();
+    }
+};
+
+void DefaultUdfLibrary::InitApproxUdafs() {
+    RegisterUdafTemplate<ApproxDistinctCountDef>("approx_distinct_count")
+        .doc(R"(
+            @brief Compute the approximate number of distinct values with HyperLogLog. The memory of the
+            aggregation is fixed to 4KB whatever the size of the window, and the relative standard error
+            is about 1.6%.
+
+            @param value  Specify value column to aggregate on.
+
+            Example:
+
+            |value|
+            |--|
+            |0|
+            |0|
+            |2|
+            |2|
+            |4|
+            @code{.sql}
+                SELECT approx_distinct_count(value) OVER w;
+                -- output 3
+            @endcode
+            @since 0.5.0
+        )")
+        .args_in<bool, int16_t, int32_t, int64_t, float, double, Timestamp, Date, StringRef>();
+
+    RegisterUdafTemplate<ApproxPercentileDef>("approx_percentile")
+        .doc(R"(
+            @brief Compute the approximate percentile of values with t-digest. The values are clustered
+            in about 200 centroids at most whatever the size of the window, the percentiles near 0 and 1
+            are the most accurate, and the percentiles 0 and 1 are the exact min and max.
+
+            @param value  Specify value column to aggregate on.
+            @param percentage  The percentile in [0, 1]. Null is returned if it is out of the range or the
+            window has no non-null value.
+
+            Example:
+
+            |value|
+            |--|
+            |1|
+            |2|
+            |3|
+            |4|
+            |5|
+            @code{.sql}
+                SELECT approx_percentile(value, 0.5) OVER w;
+                -- output 3
+            @endcode
+            @since 0.5.0
+        )")
+        .args_in<int16_t, int32_t, int64_t, float, double>();
+}
+
+}  // namespace udf
+}  // namespace hybridse
@@ -18,7 +18,6 @@
 
 #include <string>
 #include <tuple>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -256,7 +255,8 @@ struct AvgUdafDef {
 template <typename T>
 struct DistinctCountDef {
     using ArgT = typename DataTypeTrait<T>::CCallArgType;
-    using SetT = std::unordered_set<T>;
+    // the distinct values as keys, allocated from the run step memory pool
+    using SetT = udf::container::FlatMap<T, bool>;
 
     void operator()(UdafRegistryHelper& helper) {  // NOLINT
         std::string suffix = ".opaque_std_set_" + DataTypeTrait<T>::to_string();
@@ -279,7 +279,7 @@ struct DistinctCountDef {
     template <typename V>
     struct UpdateImpl {
         static SetT* update_set(SetT* set, V value) {
-            set->insert(value);
+            set->emplace(value, true);
             return set;
         }
     };
@@ -287,7 +287,7 @@ struct DistinctCountDef {
     template <typename V>
     struct UpdateImpl<V*> {
         static SetT* update_set(SetT* set, V* value) {
-            set->insert(*value);
+            set->emplace(*value, true);
             return set;
         }
     };
@@ -848,6 +848,34 @@ void DefaultUdfLibrary::InitStringUdf() {
 
                 @since 0.4.0
         )r");
+    RegisterExternal("regexp_like")
+        .args<StringRef, StringRef>(reinterpret_cast<void*>(
+            static_cast<void (*)(StringRef*, StringRef*, bool*, bool*)>(udf::v1::regexp_like)))
+        .return_by_arg(true)
+        .returns<Nullable<bool>>()
+        .doc(R"r(
+                @brief Return true if the target matches the regular expression anywhere in it.
+
+                Rules:
+                1. The regular expression is in RE2 syntax, anchor it with ^ and $ to match the whole target
+                2. Return false if the pattern is not a valid regular expression
+                3. Return NULL if target or pattern is NULL
+
+                Example:
+                @code{.sql}
+                    select regexp_like('Mike', 'i.e')
+                    -- output: true
+
+                    select regexp_like('Mike', '^i')
+                    -- output: false
+                @endcode
+
+                @param target: string to match
+
+                @param pattern: the regular expression
+
+                @since 0.5.0
+        )r");
     RegisterExternal("ucase")
         .args<StringRef>(
             reinterpret_cast<void*>(static_cast<void (*)(StringRef*, StringRef*, bool*)>(udf::v1::ucase)))
@@ -2326,6 +2354,7 @@ void DefaultUdfLibrary::InitUdaf() {
                  StringRef>();
 
     InitAggByCateUdafs();
+    InitApproxUdafs();
 }
 
 }  // namespace udf
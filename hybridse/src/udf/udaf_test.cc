@@ -273,6 +273,44 @@ TEST_F(UdafTest, topk_test) {
         "top", StringRef(""), MakeList<int32_t>({}), MakeList<int32_t>({}));
 }
 
+TEST_F(UdafTest, approx_distinct_count_test) {
+    CheckUdf<int64_t, ListRef<Nullable<int32_t>>>(
+        "approx_distinct_count", 3,
+        MakeList<Nullable<int32_t>>({0, 0, 2, nullptr, 2, 4}));
+    CheckUdf<int64_t, ListRef<double>>(
+        "approx_distinct_count", 2, MakeList<double>({0.0, -0.0, 1.5}));
+    CheckUdf<int64_t, ListRef<StringRef>>(
+        "approx_distinct_count", 2,
+        MakeList<StringRef>({StringRef("a"), StringRef("b"), StringRef("a")}));
+    CheckUdf<int64_t, ListRef<Timestamp>>(
+        "approx_distinct_count", 2,
+        MakeList<Timestamp>({Timestamp(1000), Timestamp(2000), Timestamp(1000)}));
+    // empty
+    CheckUdf<int64_t, ListRef<int64_t>>("approx_distinct_count", 0,
+                                        MakeList<int64_t>({}));
+}
+
+TEST_F(UdafTest, approx_percentile_test) {
+    CheckUdf<Nullable<double>, ListRef<Nullable<int32_t>>, ListRef<double>>(
+        "approx_percentile", 3.0,
+        MakeList<Nullable<int32_t>>({5, 1, nullptr, 3, 2, 4}),
+        MakeList<double>({0.5, 0.5, 0.5, 0.5, 0.5, 0.5}));
+    CheckUdf<Nullable<double>, ListRef<double>, ListRef<double>>(
+        "approx_percentile", 5.5, MakeList<double>({5.5, 1.0, 3.0}),
+        MakeList<double>({1, 1, 1}));
+    CheckUdf<Nullable<double>, ListRef<int64_t>, ListRef<double>>(
+        "approx_percentile", 1.0, MakeList<int64_t>({5, 1, 3}),
+        MakeList<double>({0, 0, 0}));
+    // out of range percentage
+    CheckUdf<Nullable<double>, ListRef<int64_t>, ListRef<double>>(
+        "approx_percentile", nullptr, MakeList<int64_t>({5, 1, 3}),
+        MakeList<double>({1.5, 1.5, 1.5}));
+    // empty
+    CheckUdf<Nullable<double>, ListRef<int64_t>, ListRef<double>>(
+        "approx_percentile", nullptr, MakeList<int64_t>({}),
+        MakeList<double>({}));
+}
+
 TEST_F(UdafTest, sum_cate_test) {
     CheckUdf<StringRef, ListRef<int32_t>, ListRef<int32_t>>(
         "sum_cate", StringRef("1:4,2:6"), MakeList<int32_t>({1, 2, 3, 4}),
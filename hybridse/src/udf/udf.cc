@@ -17,9 +17,14 @@
 #include "udf/udf.h"
 #include <stdint.h>
 #include <time.h>
+#include <algorithm>
+#include <cstring>
 #include <map>
+#include <memory>
 #include <set>
+#include <string>
 #include <utility>
+#include <vector>
 #include "absl/strings/ascii.h"
 #include "base/iterator.h"
 #include "boost/date_time.hpp"
@@ -33,6 +38,7 @@
 #include "codegen/fn_ir_builder.h"
 #include "node/node_manager.h"
 #include "node/sql_node.h"
+#include "re2/re2.h"
 #include "udf/default_udf_library.h"
 #include "udf/literal_traits.h"
 #include "vm/jit_runtime.h"
@@ -56,65 +62,121 @@ bthread_key_t B_THREAD_LOCAL_MEM_POOL_KEY;
 
 void trivial_fun() {}
 
+// the civil dates are computed from the days since 1970-01-01 in the proleptic gregorian calendar, which is
+// a few divisions instead of gmtime_r and boost::gregorian per row, see
+// http://howardhinnant.github.io/date_algorithms.html
+static inline void CivilFromDays(int64_t days, int32_t *year, int32_t *month, int32_t *day) {
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const uint32_t doe = static_cast<uint32_t>(days - era * 146097);
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const uint32_t mp = (5 * doy + 2) / 153;
+    *day = static_cast<int32_t>(doy - (153 * mp + 2) / 5 + 1);
+    *month = static_cast<int32_t>(mp < 10 ? mp + 3 : mp - 9);
+    *year = static_cast<int32_t>(yoe + era * 400 + (*month <= 2 ? 1 : 0));
+}
+
+static inline int64_t DaysFromCivil(int64_t year, int32_t month, int32_t day) {
+    year -= month <= 2 ? 1 : 0;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const uint32_t yoe = static_cast<uint32_t>(year - era * 400);
+    const uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// the days of the timestamp in the timezone, the milliseconds are truncated to seconds as time_t before
+static inline int64_t LocalDays(int64_t ts) {
+    int64_t secs = (ts + TZ_OFFSET) / 1000;
+    return secs >= 0 ? secs / 86400 : (secs - 86399) / 86400;
+}
+
+// 0 for sunday
+static inline int32_t WeekDay(int64_t days) { return static_cast<int32_t>(((days + 4) % 7 + 7) % 7); }
+
+static inline bool IsLeapYear(int32_t year) { return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0; }
+
+static inline int32_t DaysOfMonth(int32_t year, int32_t month) {
+    static const int32_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && IsLeapYear(year) ? 29 : days[month - 1];
+}
+
+// the iso 8601 week number 1..53
+static inline int32_t IsoWeekOfYear(int32_t year, int64_t days) {
+    auto weeks_of_year = [](int32_t y) {
+        // 53 weeks if the year starts on thursday, or on wednesday in a leap year
+        int32_t jan1 = WeekDay(DaysFromCivil(y, 1, 1));
+        return jan1 == 4 || (jan1 == 3 && IsLeapYear(y)) ? 53 : 52;
+    };
+    // monday as 1 and sunday as 7
+    int32_t iso_wday = (WeekDay(days) + 6) % 7 + 1;
+    int64_t yday = days - DaysFromCivil(year, 1, 1) + 1;
+    int32_t week = static_cast<int32_t>((yday - iso_wday + 10) / 7);
+    if (week < 1) {
+        return weeks_of_year(year - 1);
+    }
+    if (week > weeks_of_year(year)) {
+        return 1;
+    }
+    return week;
+}
+
+// the days of the date, false if the date is invalid or out of the range boost::gregorian supports
+static inline bool DateToDays(Date *date, int32_t *year, int64_t *days) {
+    int32_t day, month;
+    if (!Date::Decode(date->date_, year, &month, &day)) {
+        return false;
+    }
+    if (month <= 0 || month > 12 || *year > 9999) {
+        return false;
+    } else if (day <= 0 || day > DaysOfMonth(*year, month)) {
+        return false;
+    }
+    *days = DaysFromCivil(*year, month, day);
+    return true;
+}
+
 int32_t dayofyear(int64_t ts) {
-    time_t time = (ts + TZ_OFFSET) / 1000;
-    struct tm t;
-    gmtime_r(&time, &t);
-    return t.tm_yday + 1;
+    int64_t days = LocalDays(ts);
+    int32_t year, month, day;
+    CivilFromDays(days, &year, &month, &day);
+    return static_cast<int32_t>(days - DaysFromCivil(year, 1, 1) + 1);
 }
 int32_t dayofmonth(int64_t ts) {
-    time_t time = (ts + TZ_OFFSET) / 1000;
-    struct tm t;
-    gmtime_r(&time, &t);
-    return t.tm_mday;
-}
-int32_t dayofweek(int64_t ts) {
-    time_t time = (ts + TZ_OFFSET) / 1000;
-    struct tm t;
-    gmtime_r(&time, &t);
-    return t.tm_wday + 1;
+    int32_t year, month, day;
+    CivilFromDays(LocalDays(ts), &year, &month, &day);
+    return day;
 }
+int32_t dayofweek(int64_t ts) { return WeekDay(LocalDays(ts)) + 1; }
 int32_t weekofyear(int64_t ts) {
-    time_t time = (ts + TZ_OFFSET) / 1000;
-    struct tm t;
-    gmtime_r(&time, &t);
-    try {
-        boost::gregorian::date d = boost::gregorian::date_from_tm(t);
-        return d.week_number();
-    } catch (...) {
+    int64_t days = LocalDays(ts);
+    int32_t year, month, day;
+    CivilFromDays(days, &year, &month, &day);
+    if (year < 1400 || year > 9999) {
         return 0;
     }
+    return IsoWeekOfYear(year, days);
 }
 int32_t month(int64_t ts) {
-    time_t time = (ts + TZ_OFFSET) / 1000;
-    struct tm t;
-    gmtime_r(&time, &t);
-    return t.tm_mon + 1;
+    int32_t year, month, day;
+    CivilFromDays(LocalDays(ts), &year, &month, &day);
+    return month;
 }
 int32_t year(int64_t ts) {
-    time_t time = (ts + TZ_OFFSET) / 1000;
-    struct tm t;
-    gmtime_r(&time, &t);
-    return t.tm_year + 1900;
+    int32_t year, month, day;
+    CivilFromDays(LocalDays(ts), &year, &month, &day);
+    return year;
 }
 
 int32_t dayofyear(Timestamp *ts) { return dayofyear(ts->ts_); }
 int32_t dayofyear(Date *date) {
-    int32_t day, month, year;
-    if (!Date::Decode(date->date_, &year, &month, &day)) {
-        return 0;
-    }
-    try {
-        if (month <= 0 || month > 12) {
-            return 0;
-        } else if (day <= 0 || day > 31) {
-            return 0;
-        }
-        boost::gregorian::date d(year, month, day);
-        return d.day_of_year();
-    } catch (...) {
+    int32_t year;
+    int64_t days;
+    if (!DateToDays(date, &year, &days)) {
         return 0;
     }
+    return static_cast<int32_t>(days - DaysFromCivil(year, 1, 1) + 1);
 }
 int32_t dayofmonth(Timestamp *ts) { return dayofmonth(ts->ts_); }
 int32_t weekofyear(Timestamp *ts) { return weekofyear(ts->ts_); }
@@ -122,39 +184,21 @@ int32_t month(Timestamp *ts) { return month(ts->ts_); }
 int32_t year(Timestamp *ts) { return year(ts->ts_); }
 int32_t dayofweek(Timestamp *ts) { return dayofweek(ts->ts_); }
 int32_t dayofweek(Date *date) {
-    int32_t day, month, year;
-    if (!Date::Decode(date->date_, &year, &month, &day)) {
-        return 0;
-    }
-    try {
-        if (month <= 0 || month > 12) {
-            return 0;
-        } else if (day <= 0 || day > 31) {
-            return 0;
-        }
-        boost::gregorian::date d(year, month, day);
-        return d.day_of_week() + 1;
-    } catch (...) {
+    int32_t year;
+    int64_t days;
+    if (!DateToDays(date, &year, &days)) {
         return 0;
     }
+    return WeekDay(days) + 1;
 }
 // Return the iso 8601 week number 1..53
 int32_t weekofyear(Date *date) {
-    int32_t day, month, year;
-    if (!Date::Decode(date->date_, &year, &month, &day)) {
-        return 0;
-    }
-    try {
-        if (month <= 0 || month > 12) {
-            return 0;
-        } else if (day <= 0 || day > 31) {
-            return 0;
-        }
-        boost::gregorian::date d(year, month, day);
-        return d.week_number();
-    } catch (...) {
+    int32_t year;
+    int64_t days;
+    if (!DateToDays(date, &year, &days)) {
         return 0;
     }
+    return IsoWeekOfYear(year, days);
 }
 
 float Cotf(float x) { return cosf(x) / sinf(x); }
@@ -372,6 +416,127 @@ bool like_internal(std::string_view name, std::string_view pattern, const char *
     return name_it == name_end;
 }
 
+/*
+* the pattern of like compiled once for the rows matched with it
+*
+* a pattern without underscore is literal segments separated by percents, it is matched by searching the
+* segments in order, with the first and the last anchored unless the pattern starts or ends with percent.
+* So 'abc', 'abc%', '%abc' and '%abc%' are a comparison or a substring search only. The patterns with
+* underscore are matched by like_internal
+*/
+struct LikePattern {
+    // the pattern and the escape compiled, escape is -1 if disabled
+    std::string pattern;
+    int escape = -1;
+
+    bool general = true;
+    bool has_percent = false;
+    bool leading_percent = false;
+    bool trailing_percent = false;
+    std::vector<std::string> segments;
+
+    void Compile(std::string_view pattern_view, const char *esc) {
+        pattern.assign(pattern_view.data(), pattern_view.size());
+        escape = esc == nullptr ? -1 : static_cast<unsigned char>(*esc);
+        general = false;
+        has_percent = false;
+        leading_percent = false;
+        trailing_percent = false;
+        segments.clear();
+        std::string segment;
+        for (size_t i = 0; i < pattern.size(); i++) {
+            char c = pattern[i];
+            if (esc != nullptr && c == *esc) {
+                if (i + 1 == pattern.size()) {
+                    // terminated with escape character, like_internal returns false
+                    general = true;
+                    return;
+                }
+                segment.push_back(pattern[++i]);
+            } else if (c == '_') {
+                general = true;
+                return;
+            } else if (c == '%') {
+                if (i == 0) {
+                    leading_percent = true;
+                }
+                has_percent = true;
+                if (!segment.empty()) {
+                    segments.push_back(std::move(segment));
+                    segment.clear();
+                }
+            } else {
+                segment.push_back(c);
+            }
+        }
+        trailing_percent = !pattern.empty() && pattern.back() == '%' && segment.empty();
+        if (!segment.empty() || !has_percent) {
+            segments.push_back(std::move(segment));
+        }
+    }
+
+    bool Same(std::string_view pattern_view, const char *esc) const {
+        int other_escape = esc == nullptr ? -1 : static_cast<unsigned char>(*esc);
+        return escape == other_escape && pattern.size() == pattern_view.size() &&
+               memcmp(pattern.data(), pattern_view.data(), pattern.size()) == 0;
+    }
+
+    template <typename EQUAL>
+    static bool Equal(const char *lhs, const std::string &rhs, EQUAL &&equal, bool case_sensitive) {
+        if (case_sensitive) {
+            return memcmp(lhs, rhs.data(), rhs.size()) == 0;
+        }
+        for (size_t i = 0; i < rhs.size(); i++) {
+            if (!equal(lhs[i], rhs[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename EQUAL>
+    bool Match(std::string_view name, EQUAL &&equal, bool case_sensitive) const {
+        if (!has_percent) {
+            return name.size() == segments[0].size() && Equal(name.data(), segments[0], equal, case_sensitive);
+        }
+        size_t begin = 0;
+        size_t end = name.size();
+        size_t first = 0;
+        size_t last = segments.size();
+        if (!leading_percent) {
+            const auto &prefix = segments[first++];
+            if (end < prefix.size() || !Equal(name.data(), prefix, equal, case_sensitive)) {
+                return false;
+            }
+            begin = prefix.size();
+        }
+        if (!trailing_percent) {
+            const auto &suffix = segments[--last];
+            if (end - begin < suffix.size() || !Equal(name.data() + end - suffix.size(), suffix, equal,
+                                                       case_sensitive)) {
+                return false;
+            }
+            end -= suffix.size();
+        }
+        for (size_t i = first; i < last; i++) {
+            const auto &segment = segments[i];
+            std::string_view rest = name.substr(begin, end - begin);
+            size_t pos = std::string_view::npos;
+            if (case_sensitive) {
+                pos = rest.find(segment);
+            } else {
+                auto iter = std::search(rest.begin(), rest.end(), segment.begin(), segment.end(), equal);
+                pos = iter == rest.end() ? std::string_view::npos : std::distance(rest.begin(), iter);
+            }
+            if (pos == std::string_view::npos) {
+                return false;
+            }
+            begin += pos + segment.size();
+        }
+        return true;
+    }
+};
+
 /*
 * if escape is null or ref to empty string, disable escape feature
 *
@@ -379,7 +544,7 @@ bool like_internal(std::string_view name, std::string_view pattern, const char *
 * - any of (name, pattern, escape) is null, return null
 */
 template <typename EQUAL>
-void like_internal(StringRef *name, StringRef *pattern, StringRef *escape, EQUAL &&equal,
+void like_internal(StringRef *name, StringRef *pattern, StringRef *escape, EQUAL &&equal, bool case_sensitive,
                    bool *out, bool *is_null) {
     if (name == nullptr || pattern == nullptr || escape == nullptr) {
         out = nullptr;
@@ -399,13 +564,22 @@ void like_internal(StringRef *name, StringRef *pattern, StringRef *escape, EQUAL
         }
         esc = escape->data_;
     }
-    *out = like_internal(name_view, pattern_view, esc, std::forward<EQUAL>(equal));
+    // the pattern is mostly a literal or a column of few values, it is compiled again only when it changes
+    thread_local LikePattern compiled;
+    if (!compiled.Same(pattern_view, esc)) {
+        compiled.Compile(pattern_view, esc);
+    }
+    if (compiled.general) {
+        *out = like_internal(name_view, pattern_view, esc, std::forward<EQUAL>(equal));
+    } else {
+        *out = compiled.Match(name_view, std::forward<EQUAL>(equal), case_sensitive);
+    }
 }
 
 void like(StringRef *name, StringRef *pattern, StringRef *escape, bool *out,
           bool *is_null) {
     like_internal(
-        name, pattern, escape, [](char lhs, char rhs) { return lhs == rhs; }, out, is_null);
+        name, pattern, escape, [](char lhs, char rhs) { return lhs == rhs; }, true, out, is_null);
 }
 
 void like(StringRef* name, StringRef* pattern, bool* out, bool* is_null) {
@@ -419,7 +593,7 @@ void ilike(StringRef *name, StringRef *pattern, StringRef *escape, bool *out, bo
         [](char lhs, char rhs) {
             return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs));
         },
-        out, is_null);
+        false, out, is_null);
 }
 
 void ilike(StringRef* name, StringRef* pattern, bool* out, bool* is_null) {
@@ -427,6 +601,28 @@ void ilike(StringRef* name, StringRef* pattern, bool* out, bool* is_null) {
     ilike(name, pattern, &default_esc,  out, is_null);
 }
 
+void regexp_like(StringRef *name, StringRef *pattern, bool *out, bool *is_null) {
+    if (name == nullptr || pattern == nullptr) {
+        *is_null = true;
+        return;
+    }
+    *is_null = false;
+    // the regular expression is compiled again only when the pattern changes
+    thread_local std::string cached_pattern;
+    thread_local std::unique_ptr<re2::RE2> cached_re;
+    re2::StringPiece pattern_piece(pattern->data_, pattern->size_);
+    if (cached_re == nullptr || pattern_piece != cached_pattern) {
+        cached_pattern.assign(pattern->data_, pattern->size_);
+        cached_re.reset(new re2::RE2(pattern_piece, re2::RE2::Quiet));
+    }
+    if (!cached_re->ok()) {
+        DLOG(ERROR) << "invalid regular expression '" << cached_pattern << "': " << cached_re->error();
+        *out = false;
+        return;
+    }
+    *out = re2::RE2::PartialMatch(re2::StringPiece(name->data_, name->size_), *cached_re);
+}
+
 void string_to_bool(StringRef *str, bool *out, bool *is_null_ptr) {
     if (nullptr == str) {
         *out = false;
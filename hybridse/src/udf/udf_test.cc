@@ -18,6 +18,7 @@
 #include <dlfcn.h>
 #include <gtest/gtest.h>
 #include <stdint.h>
+#include <time.h>
 #include <algorithm>
 #include <tuple>
 #include <utility>
@@ -666,6 +667,33 @@ TEST_F(ExternUdfTest, TestCompoundTypedExternalCall) {
         &library, "make_tuple", TupleResT(1, nullptr, 3), 1, nullptr, 3);
 }
 
+TEST_F(ExternUdfTest, CivilDateOfTimestamp) {
+    // the same as gmtime_r in the timezone of +8, across the leap years and before 1970
+    const int64_t tz_offset = 8 * 3600000L;
+    for (int64_t ts = -2500000000000L; ts < 7000000000000L; ts += 3600000L * 13 + 777) {
+        time_t time = (ts + tz_offset) / 1000;
+        struct tm t;
+        ASSERT_TRUE(gmtime_r(&time, &t) != nullptr);
+        ASSERT_EQ(t.tm_year + 1900, v1::year(ts)) << ts;
+        ASSERT_EQ(t.tm_mon + 1, v1::month(ts)) << ts;
+        ASSERT_EQ(t.tm_mday, v1::dayofmonth(ts)) << ts;
+        ASSERT_EQ(t.tm_yday + 1, v1::dayofyear(ts)) << ts;
+        ASSERT_EQ(t.tm_wday + 1, v1::dayofweek(ts)) << ts;
+    }
+    // 2021-01-03 is in the last week of 2020, 2020-12-31 is in the 53rd week
+    ASSERT_EQ(53, v1::weekofyear(1609603200000L));
+    ASSERT_EQ(53, v1::weekofyear(1609344000000L));
+    ASSERT_EQ(1, v1::weekofyear(1609689600000L));
+    // 2024-12-30 is in the first week of 2025
+    Date date(2024, 12, 30);
+    ASSERT_EQ(1, v1::weekofyear(&date));
+    ASSERT_EQ(365, v1::dayofyear(&date));
+    ASSERT_EQ(2, v1::dayofweek(&date));
+    Date invalid(2023, 2, 29);
+    ASSERT_EQ(0, v1::dayofyear(&invalid));
+    ASSERT_EQ(0, v1::weekofyear(&invalid));
+}
+
 TEST_F(ExternUdfTest, LikeMatchTest) {
     auto check_like = [](bool match, bool is_null, const std::string_view name, const std::string_view pattern,
                          const std::string_view esc) -> void {
@@ -740,6 +768,68 @@ TEST_F(ExternUdfTest, LikeMatchTest) {
     check_like(false, false, R"r(Evan_w\)r", R"r(Evan_w\)r", "\\");
 }
 
+TEST_F(ExternUdfTest, LikeMatchCompiledPattern) {
+    auto check_like = [](bool match, bool case_sensitive, const std::string_view name,
+                         const std::string_view pattern) -> void {
+        codec::StringRef name_ref(name.size(), name.data());
+        codec::StringRef pattern_ref(pattern.size(), pattern.data());
+        bool ret = !match;
+        bool ret_null = true;
+        if (case_sensitive) {
+            v1::like(&name_ref, &pattern_ref, &ret, &ret_null);
+        } else {
+            v1::ilike(&name_ref, &pattern_ref, &ret, &ret_null);
+        }
+        EXPECT_EQ(match, ret) << (case_sensitive ? "like(" : "ilike(") << name << ", " << pattern << ")";
+        EXPECT_FALSE(ret_null);
+    };
+    // the same pattern for several rows, then changed
+    for (auto name : {"Mary", "Marianne", "mark"}) {
+        check_like(name[0] == 'M', true, name, "Mar%");
+        check_like(true, false, name, "mar%");
+    }
+    check_like(true, true, "Evan_W", "%_W");
+    check_like(true, true, "Evan_W", "%\\_W");
+    check_like(false, true, "EvanxW", "%\\_W");
+    check_like(true, false, "Evan_W", "%N\\_w");
+    check_like(true, true, "abcabc", "%bca%");
+    check_like(false, true, "abcabc", "%bcb%");
+    check_like(true, false, "abcabc", "%BCA%");
+    check_like(true, true, "abcabc", "a%c%c");
+    check_like(false, true, "abc", "abc%c");
+    check_like(false, true, "a", "a%a");
+    check_like(true, true, "aa", "a%a");
+    check_like(true, true, "", "%%");
+    check_like(true, true, "x", "%");
+    check_like(false, true, "ab", "%a");
+}
+
+TEST_F(ExternUdfTest, RegexpLikeTest) {
+    auto check_regexp = [](bool match, bool is_null, const std::string_view name, const std::string_view pattern) {
+        codec::StringRef name_ref(name.size(), name.data());
+        codec::StringRef pattern_ref(pattern.size(), pattern.data());
+        bool ret = !match;
+        bool ret_null = !is_null;
+        v1::regexp_like(&name_ref, &pattern_ref, &ret, &ret_null);
+        EXPECT_EQ(is_null, ret_null) << "regexp_like(" << name << ", " << pattern << ")";
+        if (!is_null) {
+            EXPECT_EQ(match, ret) << "regexp_like(" << name << ", " << pattern << ")";
+        }
+    };
+    check_regexp(true, false, "Mike", "i.e");
+    check_regexp(false, false, "Mike", "^i");
+    check_regexp(true, false, "Mike", "^M[a-z]+$");
+    check_regexp(false, false, "Mike2", "^M[a-z]+$");
+    // invalid pattern
+    check_regexp(false, false, "Mike", "(");
+
+    codec::StringRef name_ref("Mike");
+    bool ret = false;
+    bool ret_null = false;
+    v1::regexp_like(&name_ref, nullptr, &ret, &ret_null);
+    EXPECT_TRUE(ret_null);
+}
+
 TEST_F(ExternUdfTest, LikeMatchNullable) {
     auto check_null = [](bool expect, bool is_null, codec::StringRef* name_ref, codec::StringRef* pattern_ref,
                          codec::StringRef* escape) -> void {
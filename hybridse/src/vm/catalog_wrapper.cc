@@ -44,7 +44,7 @@ std::shared_ptr<TableHandler> PartitionFilterWrapper::GetSegment(
         return std::shared_ptr<TableHandler>();
     } else {
         return std::shared_ptr<TableHandler>(
-            new TableFilterWrapper(segment, parameter_, fun_));
+            new TableFilterWrapper(segment, parameter_, fun_, predicates_));
     }
 }
 base::ConstIterator<uint64_t, Row>* PartitionFilterWrapper::GetRawIterator() {
@@ -57,7 +57,10 @@ base::ConstIterator<uint64_t, Row>* PartitionFilterWrapper::GetRawIterator() {
 }
 std::shared_ptr<PartitionHandler> TableProjectWrapper::GetPartition(
     const std::string& index_name) {
-    auto partition = table_hander_->GetPartition(index_name);
+    auto partition =
+        source_columns_ == nullptr
+            ? table_hander_->GetPartition(index_name)
+            : table_hander_->GetPrunedPartition(index_name, *source_columns_);
     if (!partition) {
         return std::shared_ptr<PartitionHandler>();
     } else {
@@ -71,8 +74,8 @@ std::shared_ptr<PartitionHandler> TableFilterWrapper::GetPartition(
     if (!partition) {
         return std::shared_ptr<PartitionHandler>();
     } else {
-        return std::shared_ptr<PartitionHandler>(
-            new PartitionFilterWrapper(partition, parameter_, fun_));
+        return std::shared_ptr<PartitionHandler>(new PartitionFilterWrapper(
+            partition, parameter_, fun_, predicates_));
     }
 }
 }  // namespace vm
@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 #include "vm/catalog.h"
 namespace hybridse {
 namespace vm {
@@ -225,16 +226,21 @@ class PartitionProjectWrapper : public PartitionHandler {
 };
 class PartitionFilterWrapper : public PartitionHandler {
  public:
-    PartitionFilterWrapper(std::shared_ptr<PartitionHandler> partition_handler,
-                           const Row& parameter,
-                           const PredicateFun* fun)
+    PartitionFilterWrapper(
+        std::shared_ptr<PartitionHandler> partition_handler,
+        const Row& parameter, const PredicateFun* fun,
+        const std::vector<ColumnPredicate>* predicates = nullptr)
         : PartitionHandler(),
           partition_handler_(partition_handler),
           parameter_(parameter),
-          fun_(fun) {}
+          fun_(fun),
+          predicates_(predicates) {}
     virtual ~PartitionFilterWrapper() {}
     std::unique_ptr<WindowIterator> GetWindowIterator() override {
-        auto iter = partition_handler_->GetWindowIterator();
+        auto iter =
+            predicates_ == nullptr
+                ? partition_handler_->GetWindowIterator()
+                : partition_handler_->GetFilteredWindowIterator(*predicates_);
         if (!iter) {
             return std::unique_ptr<WindowIterator>();
         } else {
@@ -276,13 +282,21 @@ class PartitionFilterWrapper : public PartitionHandler {
     std::shared_ptr<PartitionHandler> partition_handler_;
     const Row& parameter_;
     const PredicateFun* fun_;
+    // the simple comparisons of fun_ checked by the storage if not null
+    const std::vector<ColumnPredicate>* predicates_;
 };
 class TableProjectWrapper : public TableHandler {
  public:
     TableProjectWrapper(std::shared_ptr<TableHandler> table_handler,
                         const Row& parameter,
-                        const ProjectFun* fun)
-        : TableHandler(), table_hander_(table_handler), parameter_(parameter), value_(), fun_(fun) {}
+                        const ProjectFun* fun,
+                        const std::vector<size_t>* source_columns = nullptr)
+        : TableHandler(),
+          table_hander_(table_handler),
+          parameter_(parameter),
+          value_(),
+          fun_(fun),
+          source_columns_(source_columns) {}
     virtual ~TableProjectWrapper() {}
 
     std::unique_ptr<RowIterator> GetIterator() {
@@ -333,18 +347,27 @@ class TableProjectWrapper : public TableHandler {
     const Row& parameter_;
     Row value_;
     const ProjectFun* fun_;
+    // the columns of the table read by fun_, the partitions are pruned to them if not null
+    const std::vector<size_t>* source_columns_;
 };
 
 class TableFilterWrapper : public TableHandler {
  public:
     TableFilterWrapper(std::shared_ptr<TableHandler> table_handler,
                        const Row& parameter,
-                       const PredicateFun* fun)
-        : TableHandler(), table_hander_(table_handler), parameter_(parameter), fun_(fun) {}
+                       const PredicateFun* fun,
+                       const std::vector<ColumnPredicate>* predicates = nullptr)
+        : TableHandler(),
+          table_hander_(table_handler),
+          parameter_(parameter),
+          fun_(fun),
+          predicates_(predicates) {}
     virtual ~TableFilterWrapper() {}
 
     std::unique_ptr<RowIterator> GetIterator() {
-        auto iter = table_hander_->GetIterator();
+        auto iter = predicates_ == nullptr
+                        ? table_hander_->GetIterator()
+                        : table_hander_->GetFilteredIterator(*predicates_);
         if (!iter) {
             return std::unique_ptr<RowIterator>();
         } else {
@@ -370,6 +393,12 @@ class TableFilterWrapper : public TableHandler {
         return table_hander_->GetDatabase();
     }
     base::ConstIterator<uint64_t, Row>* GetRawIterator() override {
+        if (predicates_ != nullptr) {
+            auto iter = table_hander_->GetFilteredIterator(*predicates_);
+            return iter ? new IteratorFilterWrapper(std::move(iter), parameter_,
+                                                    fun_)
+                        : nullptr;
+        }
         return new IteratorFilterWrapper(
             static_cast<std::unique_ptr<RowIterator>>(
                 table_hander_->GetRawIterator()),
@@ -385,6 +414,8 @@ class TableFilterWrapper : public TableHandler {
     const Row& parameter_;
     Row value_;
     const PredicateFun* fun_;
+    // the simple comparisons of fun_ checked by the storage if not null
+    const std::vector<ColumnPredicate>* predicates_;
 };
 
 class RowProjectWrapper : public RowHandler {
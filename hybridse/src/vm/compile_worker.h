@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_COMPILE_WORKER_H_
+#define HYBRIDSE_SRC_VM_COMPILE_WORKER_H_
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
+namespace hybridse {
+namespace vm {
+
+/**
+ * CompileWorker runs the recompile tasks of the engine on one background
+ * thread, so that the request which makes a query hot never waits for the
+ * optimized compile. The pending tasks are dropped on destruction.
+ */
+class CompileWorker {
+ public:
+    CompileWorker();
+    ~CompileWorker();
+    CompileWorker(const CompileWorker&) = delete;
+    CompileWorker& operator=(const CompileWorker&) = delete;
+
+    void Submit(std::function<void()> task);
+
+ private:
+    void Work();
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> queue_;
+    bool stop_;
+    std::thread thread_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_COMPILE_WORKER_H_
@@ -38,6 +38,7 @@ WindowInterface::WindowInterface(bool instance_not_in_window,
                       end_offset, rows_preceding, max_size)))) {
     window_impl_->set_instance_not_in_window(instance_not_in_window);
     window_impl_->set_exclude_current_time(exclude_current_time);
+    window_impl_->set_sliding_agg(true);
 }
 
 bool WindowInterface::BufferData(uint64_t key, const Row& row) {
@@ -188,6 +189,59 @@ hybridse::vm::TableHandler* GroupbyInterface::GetTableHandler() {
     return mem_table_handler_;
 }
 
+BatchPlanInterface::BatchPlanInterface(const hybridse::type::Database& database,
+                                       const std::string& sql)
+    : db_(database.name()),
+      sql_(sql),
+      catalog_(std::make_shared<SimpleCatalog>()) {
+    catalog_->AddDatabase(database);
+}
+
+bool BatchPlanInterface::Init(hybridse::base::Status* status) {
+    Engine::InitializeGlobalLLVM();
+    EngineOptions options;
+    std::unique_ptr<Engine> engine(new Engine(catalog_, options));
+    if (!engine->Get(sql_, db_, session_, *status)) {
+        return false;
+    }
+    engine_ = std::move(engine);
+    return true;
+}
+
+bool BatchPlanInterface::AppendRow(const std::string& table,
+                                   const hybridse::codec::Row& row) {
+    if (row.empty()) {
+        return false;
+    }
+    inputs_[table].push_back(row);
+    return true;
+}
+
+bool BatchPlanInterface::Run(hybridse::base::Status* status) {
+    if (!engine_) {
+        status->code = common::kExecutionPlanError;
+        status->msg = "batch plan is not compiled";
+        return false;
+    }
+    for (auto& kv : inputs_) {
+        if (!catalog_->GetTable(db_, kv.first) ||
+            !catalog_->InsertRows(db_, kv.first, kv.second)) {
+            status->code = common::kTableNotFound;
+            status->msg = "fail to append the rows of table " + kv.first;
+            return false;
+        }
+    }
+    inputs_.clear();
+    outputs_.clear();
+    int32_t ret = session_.Run(outputs_);
+    if (ret != 0) {
+        status->code = common::kExecutionPlanError;
+        status->msg = "fail to run batch plan, ret " + std::to_string(ret);
+        return false;
+    }
+    return true;
+}
+
 hybridse::codec::Row CoreAPI::RowConstProject(const RawPtrHandle fn,
                                               const Row parameter,
                                               const bool need_free) {
@@ -243,6 +297,36 @@ hybridse::codec::Row CoreAPI::RowProject(const RawPtrHandle fn,
         buf, hybridse::codec::RowView::GetSize(buf)));
 }
 
+void CoreAPI::RowProjectBlock(const RawPtrHandle block_fn,
+                              const hybridse::codec::Row* rows, size_t cnt,
+                              const hybridse::codec::Row& parameter,
+                              hybridse::codec::Row* outputs) {
+    if (cnt == 0) {
+        return;
+    }
+    // the temporary objects of the rows are released together
+    JitRuntime::get()->InitRunStep();
+
+    auto udf = reinterpret_cast<int32_t (*)(const int64_t, const int8_t*,
+                                            const int8_t*, int8_t**)>(
+        const_cast<int8_t*>(block_fn));
+    std::vector<int8_t*> bufs(cnt, nullptr);
+    udf(static_cast<int64_t>(cnt), reinterpret_cast<const int8_t*>(rows),
+        reinterpret_cast<const int8_t*>(&parameter), bufs.data());
+
+    JitRuntime::get()->ReleaseRunStep();
+
+    for (size_t i = 0; i < cnt; i++) {
+        if (bufs[i] == nullptr) {
+            LOG(WARNING) << "fail to run udf on row " << i << " of block";
+            outputs[i] = hybridse::codec::Row();
+        } else {
+            outputs[i] = Row(base::RefCountedSlice::CreateManaged(
+                bufs[i], hybridse::codec::RowView::GetSize(bufs[i])));
+        }
+    }
+}
+
 hybridse::codec::Row CoreAPI::UnsafeRowProject(
     const hybridse::vm::RawPtrHandle fn,
     hybridse::vm::ByteArrayPtr inputUnsafeRowBytes,
@@ -280,6 +364,107 @@ void CoreAPI::CopyRowToUnsafeRowBytes(const hybridse::codec::Row inputRow,
     memcpy(outputBytes, inputRow.buf() + codec::HEADER_LENGTH, length);
 }
 
+// the size of the row at `offset` of the batch buffer, 0 if the row is
+// broken or runs over the buffer
+static uint32_t GetBatchRowSize(const hybridse::base::RawBuffer& batch,
+                                size_t offset) {
+    if (batch.addr == nullptr || offset + codec::HEADER_LENGTH > batch.size) {
+        return 0;
+    }
+    uint32_t size = codec::RowView::GetSize(
+        reinterpret_cast<const int8_t*>(batch.addr + offset));
+    if (size < codec::HEADER_LENGTH || offset + size > batch.size) {
+        return 0;
+    }
+    return size;
+}
+
+int32_t CoreAPI::UnsafeRowProjectBatch(const RawPtrHandle fn,
+                                       const hybridse::base::RawBuffer& input,
+                                       const int32_t cnt,
+                                       const hybridse::base::RawBuffer& output) {
+    auto udf = reinterpret_cast<int32_t (*)(const int64_t, const int8_t*,
+                                            const int8_t*, const int8_t*, int8_t**)>(
+        const_cast<int8_t*>(fn));
+    size_t input_offset = 0;
+    size_t output_offset = 0;
+    int32_t projected = 0;
+
+    // the temporary objects of the rows are released together
+    JitRuntime::get()->InitRunStep();
+    for (; projected < cnt; projected++) {
+        uint32_t size = GetBatchRowSize(input, input_offset);
+        if (size == 0) {
+            LOG(WARNING) << "invalid row " << projected << " of batch";
+            projected = -1;
+            break;
+        }
+        // the row refers to the batch buffer without copying
+        auto row = Row(base::RefCountedSlice::Create(
+            reinterpret_cast<int8_t*>(input.addr + input_offset), size));
+        int8_t* buf = nullptr;
+        int32_t ret = udf(0, reinterpret_cast<const int8_t*>(&row), nullptr,
+                          nullptr, &buf);
+        if (ret != 0 || buf == nullptr) {
+            LOG(WARNING) << "fail to run udf " << ret << " on row "
+                         << projected << " of batch";
+            free(buf);
+            projected = -1;
+            break;
+        }
+        uint32_t output_size = RowView::GetSize(buf);
+        if (output_offset + output_size > output.size) {
+            free(buf);
+            break;
+        }
+        memcpy(output.addr + output_offset, buf, output_size);
+        free(buf);
+        input_offset += size;
+        output_offset += output_size;
+    }
+    JitRuntime::get()->ReleaseRunStep();
+    return projected;
+}
+
+hybridse::base::RawBuffer CoreAPI::UnsafeWindowProjectBatch(
+    const RawPtrHandle fn, const hybridse::base::RawBuffer& keys,
+    const hybridse::base::RawBuffer& input, const int32_t cnt,
+    WindowInterface* window) {
+    auto& output = window->batch_output_;
+    output.clear();
+    if (cnt < 0 || keys.addr == nullptr ||
+        keys.size < static_cast<size_t>(cnt) * sizeof(int64_t)) {
+        LOG(WARNING) << "keys of batch mismatch, size " << keys.size
+                     << ", rows " << cnt;
+        return hybridse::base::RawBuffer();
+    }
+    const int64_t* row_keys = reinterpret_cast<const int64_t*>(keys.addr);
+    size_t input_offset = 0;
+    for (int32_t i = 0; i < cnt; i++) {
+        uint32_t size = GetBatchRowSize(input, input_offset);
+        if (size == 0) {
+            LOG(WARNING) << "invalid row " << i << " of batch";
+            return hybridse::base::RawBuffer();
+        }
+        // the window keeps the row after the batch buffer is reused
+        auto buf = reinterpret_cast<int8_t*>(malloc(size));
+        memcpy(buf, input.addr + input_offset, size);
+        auto row = Row(base::RefCountedSlice::CreateManaged(buf, size));
+        Row output_row =
+            Runner::WindowProject(fn, static_cast<uint64_t>(row_keys[i]), row,
+                                  Row(), true, 0, window->GetWindow());
+        if (output_row.empty()) {
+            LOG(WARNING) << "fail to project row " << i << " of batch";
+            return hybridse::base::RawBuffer();
+        }
+        output.append(reinterpret_cast<const char*>(output_row.buf()),
+                      output_row.size());
+        input_offset += size;
+    }
+    return hybridse::base::RawBuffer(const_cast<char*>(output.data()),
+                                     output.size());
+}
+
 hybridse::codec::Row CoreAPI::WindowProject(const RawPtrHandle fn,
                                             const uint64_t row_key,
                                             const Row row,
@@ -20,11 +20,15 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
+#include "base/raw_buffer.h"
 #include "codec/fe_row_codec.h"
 #include "codec/row.h"
 #include "vm/catalog.h"
+#include "vm/engine.h"
 #include "vm/mem_catalog.h"
 #include "vm/physical_op.h"
+#include "vm/simple_catalog.h"
 
 namespace hybridse {
 namespace vm {
@@ -58,6 +62,8 @@ class WindowInterface {
     inline Window::WindowFrameType ExtractFrameType(
         const std::string& frame_type_str) const;
     std::unique_ptr<Window> window_impl_;
+    // the outputs of the last UnsafeWindowProjectBatch
+    std::string batch_output_;
 };
 
 class GroupbyInterface {
@@ -71,6 +77,39 @@ class GroupbyInterface {
     hybridse::vm::MemTableHandler* mem_table_handler_;
 };
 
+// Run the whole plan of a sql in batch mode with the runner tree compiled by
+// the engine, over the rows appended to the tables of the database. The plan
+// runs in one native call, so the rows cross JNI once to get in and once to
+// get out rather than once for each physical node.
+class BatchPlanInterface {
+ public:
+    BatchPlanInterface(const hybridse::type::Database& database,
+                       const std::string& sql);
+
+    // compile the sql, return false with the error in status
+    bool Init(hybridse::base::Status* status);
+
+    // append one row to the table, the row is shared rather than copied
+    bool AppendRow(const std::string& table, const hybridse::codec::Row& row);
+
+    // run the plan over the rows appended and keep the output rows, return
+    // false with the error in status
+    bool Run(hybridse::base::Status* status);
+
+    hybridse::codec::Row Get(uint64_t idx) const { return outputs_[idx]; }
+
+    size_t size() const { return outputs_.size(); }
+
+ private:
+    std::string db_;
+    std::string sql_;
+    std::shared_ptr<SimpleCatalog> catalog_;
+    std::unique_ptr<Engine> engine_;
+    BatchRunSession session_;
+    std::map<std::string, std::vector<hybridse::codec::Row>> inputs_;
+    std::vector<hybridse::codec::Row> outputs_;
+};
+
 class ColumnSourceInfo {
  public:
     hybridse::base::Status GetStatus() const { return status_; }
@@ -133,6 +172,12 @@ class CoreAPI {
     static hybridse::codec::Row RowConstProject(
         const hybridse::vm::RawPtrHandle fn, const hybridse::codec::Row parameter,
         const bool need_free = false);
+    // project `cnt` non-empty rows with the block function in one call, the
+    // output of the row failed is empty
+    static void RowProjectBlock(const hybridse::vm::RawPtrHandle block_fn,
+                                const hybridse::codec::Row* rows, size_t cnt,
+                                const hybridse::codec::Row& parameter,
+                                hybridse::codec::Row* outputs);
 
     // Row project API with Spark UnsafeRow optimization
     static hybridse::codec::Row UnsafeRowProject(
@@ -144,6 +189,17 @@ class CoreAPI {
                                         hybridse::vm::ByteArrayPtr outputBytes,
                                         const int length);
 
+    // Batch row project API with Spark UnsafeRow optimization. The rows of
+    // `input` are laid back to back, each is the 6 bytes HybridSE header
+    // followed by the UnsafeRow bytes, and they are projected where they are
+    // in one JNI call. The outputs are laid into `output` in the same way.
+    // Return the count of rows projected from the head of `input`, which is
+    // less than `cnt` once `output` is full, or -1 if a row fails
+    static int32_t UnsafeRowProjectBatch(
+        const hybridse::vm::RawPtrHandle fn,
+        const hybridse::base::RawBuffer& input, const int32_t cnt,
+        const hybridse::base::RawBuffer& output);
+
     static hybridse::codec::Row WindowProject(
         const hybridse::vm::RawPtrHandle fn, const uint64_t key, const Row row,
         const bool is_instance, size_t append_slices, WindowInterface* window);
@@ -155,6 +211,18 @@ class CoreAPI {
         const int inputRowSizeInBytes, const bool is_instance,
         size_t append_slices, WindowInterface* window);
 
+    // Batch window project API with Spark UnsafeRow optimization. The rows of
+    // `input` are laid as UnsafeRowProjectBatch and `keys` holds the int64 key
+    // of each row, they are all the instances of the window. The rows are
+    // copied into the window and the outputs are laid back to back in the
+    // buffer returned, which is owned by the window and valid until the next
+    // call. Return an empty buffer if a row fails
+    static hybridse::base::RawBuffer UnsafeWindowProjectBatch(
+        const hybridse::vm::RawPtrHandle fn,
+        const hybridse::base::RawBuffer& keys,
+        const hybridse::base::RawBuffer& input, const int32_t cnt,
+        WindowInterface* window);
+
     static hybridse::codec::Row WindowProject(
         const hybridse::vm::RawPtrHandle fn, const uint64_t key, const Row row,
         WindowInterface* window);
@@ -15,6 +15,8 @@
  */
 
 #include "vm/core_api.h"
+#include <string>
+#include <vector>
 #include "gtest/gtest.h"
 
 namespace hybridse {
@@ -45,6 +47,132 @@ TEST_F(CoreAPITest, test_create_new_row) {
     ASSERT_TRUE(builder.AppendBool(false));
 }
 
+// a fake compiled function, which outputs a copy of the input row
+static int32_t CopyRowFn(const int64_t key, const int8_t* row_ptr,
+                         const int8_t* window_ptr, const int8_t* parameter_ptr,
+                         int8_t** out) {
+    auto row = reinterpret_cast<const codec::Row*>(row_ptr);
+    *out = reinterpret_cast<int8_t*>(malloc(row->size()));
+    memcpy(*out, row->buf(), row->size());
+    return 0;
+}
+
+static std::string BuildBatch(const Schema& schema, int32_t cnt) {
+    std::string batch;
+    codec::RowBuilder builder(schema);
+    for (int32_t i = 0; i < cnt; i++) {
+        uint32_t size = builder.CalTotalLength(0);
+        std::string row(size, '\0');
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), size);
+        builder.AppendInt64(i);
+        batch.append(row);
+    }
+    return batch;
+}
+
+TEST_F(CoreAPITest, test_unsafe_row_project_batch) {
+    Schema schema;
+    ::hybridse::type::ColumnDef* col = schema.Add();
+    col->set_name("col1");
+    col->set_type(::hybridse::type::kInt64);
+    std::string batch = BuildBatch(schema, 10);
+    uint32_t row_size = batch.size() / 10;
+    auto fn = reinterpret_cast<RawPtrHandle>(&CopyRowFn);
+    base::RawBuffer input(&batch[0], batch.size());
+
+    std::string output(batch.size(), '\0');
+    ASSERT_EQ(10, CoreAPI::UnsafeRowProjectBatch(
+                      fn, input, 10, base::RawBuffer(&output[0], output.size())));
+    ASSERT_EQ(batch, output);
+
+    // the output buffer holds 3 rows only
+    std::string small_output(row_size * 3 + 1, '\0');
+    ASSERT_EQ(3, CoreAPI::UnsafeRowProjectBatch(
+                     fn, input, 10,
+                     base::RawBuffer(&small_output[0], small_output.size())));
+    ASSERT_EQ(batch.substr(0, row_size * 3), small_output.substr(0, row_size * 3));
+
+    // the batch holds less rows than cnt
+    ASSERT_EQ(-1, CoreAPI::UnsafeRowProjectBatch(
+                      fn, input, 11, base::RawBuffer(&output[0], output.size())));
+}
+
+TEST_F(CoreAPITest, test_unsafe_window_project_batch) {
+    Schema schema;
+    ::hybridse::type::ColumnDef* col = schema.Add();
+    col->set_name("col1");
+    col->set_type(::hybridse::type::kInt64);
+    std::string batch = BuildBatch(schema, 10);
+    std::vector<int64_t> keys;
+    for (int64_t i = 0; i < 10; i++) {
+        keys.push_back(i);
+    }
+    WindowInterface window(false, false, "kFrameRowsRange", -1000, 0, 0, 3);
+    auto output = CoreAPI::UnsafeWindowProjectBatch(
+        reinterpret_cast<RawPtrHandle>(&CopyRowFn),
+        base::RawBuffer(reinterpret_cast<char*>(keys.data()),
+                        keys.size() * sizeof(int64_t)),
+        base::RawBuffer(&batch[0], batch.size()), 10, &window);
+    ASSERT_EQ(batch, std::string(output.addr, output.size));
+    // the rows are copied into the window
+    batch.assign(batch.size(), '\0');
+    ASSERT_EQ(3u, window.size());
+    ASSERT_EQ(codec::RowView::GetSize(window.Get(0).buf()),
+              static_cast<uint32_t>(window.Get(0).size()));
+}
+
+TEST_F(CoreAPITest, test_batch_plan_run) {
+    type::Database db;
+    db.set_name("db");
+    auto table = db.add_tables();
+    table->set_name("t1");
+    Schema& schema = *table->mutable_columns();
+    for (auto name : {"col0", "col1", "col2"}) {
+        ::hybridse::type::ColumnDef* col = schema.Add();
+        col->set_name(name);
+        col->set_type(::hybridse::type::kInt64);
+    }
+
+    BatchPlanInterface plan(
+        db,
+        "select col0, sum(col2) over w as w_sum from t1 window w as "
+        "(partition by col0 order by col1 rows between 1 preceding and current row);");
+    base::Status status;
+    ASSERT_TRUE(plan.Init(&status)) << status;
+
+    codec::RowBuilder builder(schema);
+    std::vector<std::vector<int64_t>> rows = {{1, 1, 10}, {1, 2, 20}, {2, 1, 5}, {1, 3, 30}};
+    for (auto& values : rows) {
+        uint32_t size = builder.CalTotalLength(0);
+        auto row = CoreAPI::NewRow(size);
+        builder.SetBuffer(row.buf(0), size);
+        for (auto value : values) {
+            builder.AppendInt64(value);
+        }
+        ASSERT_TRUE(plan.AppendRow("t1", row));
+    }
+    ASSERT_TRUE(plan.Run(&status)) << status;
+    ASSERT_EQ(4u, plan.size());
+
+    Schema output_schema;
+    for (auto name : {"col0", "w_sum"}) {
+        ::hybridse::type::ColumnDef* col = output_schema.Add();
+        col->set_name(name);
+        col->set_type(::hybridse::type::kInt64);
+    }
+    codec::RowView view(output_schema);
+    int64_t total = 0;
+    for (size_t i = 0; i < plan.size(); i++) {
+        auto row = plan.Get(i);
+        ASSERT_TRUE(view.Reset(row.buf(), row.size()));
+        int64_t w_sum = 0;
+        ASSERT_EQ(0, view.GetInt64(1, &w_sum));
+        total += w_sum;
+    }
+    // 10 + 30 + 50 for key 1 and 5 for key 2
+    ASSERT_EQ(95, total);
+}
+
 }  // namespace vm
 }  // namespace hybridse
 
@@ -15,12 +15,13 @@
  */
 
 #include "vm/engine.h"
+#include <cstdlib>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 #include "base/fe_strings.h"
-#include "boost/none.hpp"
-#include "boost/optional.hpp"
+#include "boost/algorithm/string.hpp"
 #include "codec/fe_row_codec.h"
 #include "codec/fe_schema_codec.h"
 #include "codec/list_iterator_codec.h"
@@ -28,9 +29,14 @@
 #include "gflags/gflags.h"
 #include "llvm-c/Target.h"
 #include "udf/default_udf_library.h"
+#include "vm/compile_worker.h"
+#include "vm/literal_normalizer.h"
 #include "vm/local_tablet_handler.h"
 #include "vm/mem_catalog.h"
+#include "vm/runner_pool.h"
+#include "vm/shared_jit_cache.h"
 #include "vm/sql_compiler.h"
+#include "vm/window_cache.h"
 
 DECLARE_bool(logtostderr);
 DECLARE_string(log_dir);
@@ -41,6 +47,20 @@ namespace vm {
 
 static bool LLVM_IS_INITIALIZED = false;
 
+// the bytes of the jitted code and the plan of one ir instruction, the ir module itself is released after jit
+static constexpr uint64_t CACHE_BYTES_PER_IR_INSTRUCTION = 64;
+
+// the estimated bytes a compiled query holds in cache
+static uint64_t EstimateCacheBytes(const SqlContext& ctx) {
+    // the jitted bytes are counted if known, otherwise estimated by the ir
+    uint64_t jit_bytes = ctx.jit ? ctx.jit->GetCodeSize() + ctx.jit->GetDataSize() : 0;
+    if (jit_bytes == 0) {
+        jit_bytes = ctx.ir_instruction_cnt * CACHE_BYTES_PER_IR_INSTRUCTION;
+    }
+    return sizeof(SqlCompileInfo) + ctx.sql.size() + ctx.ir.size() + ctx.logical_plan_str.size() +
+           ctx.physical_plan_str.size() + ctx.encoded_schema.size() + ctx.encoded_request_schema.size() + jit_bytes;
+}
+
 EngineOptions::EngineOptions()
     : keep_ir_(false),
       compile_only_(false),
@@ -50,12 +70,60 @@ EngineOptions::EngineOptions()
       enable_expr_optimize_(true),
       enable_batch_window_parallelization_(false),
       enable_window_column_pruning_(false),
-      max_sql_cache_size_(50) {
+      batch_parallelism_(1),
+      batch_sort_memory_limit_(0),
+      spill_dir_("/tmp"),
+      query_memory_limit_(0),
+      total_query_memory_limit_(0),
+      request_parallelism_(0),
+      request_window_cache_capacity_(0),
+      request_window_cache_ttl_ms_(1000),
+      tiered_compile_threshold_(0),
+      max_sql_cache_size_(50),
+      max_sql_cache_bytes_(0),
+      enable_literal_normalization_(false),
+      enable_shared_jit_(false),
+      max_jit_memory_bytes_(0),
+      enable_block_project_(false) {
 }
 
-Engine::Engine(const std::shared_ptr<Catalog>& catalog) : cl_(catalog), options_(), mu_(), lru_cache_() {}
+Engine::Engine(const std::shared_ptr<Catalog>& catalog)
+    : cl_(catalog),
+      options_(),
+      mu_(),
+      lru_cache_(),
+      runner_pool_(),
+      window_cache_(),
+      memory_tracker_(),
+      shared_jits_(),
+      compile_worker_() {}
 Engine::Engine(const std::shared_ptr<Catalog>& catalog, const EngineOptions& options)
-    : cl_(catalog), options_(options), mu_(), lru_cache_() {}
+    : cl_(catalog),
+      options_(options),
+      mu_(),
+      lru_cache_(),
+      runner_pool_(),
+      window_cache_(),
+      memory_tracker_(),
+      shared_jits_(),
+      compile_worker_() {
+    if (options_.GetRequestParallelism() > 0) {
+        runner_pool_ = std::make_shared<RunnerPool>(options_.GetRequestParallelism());
+    }
+    if (options_.GetRequestWindowCacheCapacity() > 0) {
+        window_cache_ = std::make_shared<RequestWindowCache>(options_.GetRequestWindowCacheCapacity(),
+                                                             options_.GetRequestWindowCacheTtl());
+    }
+    if (options_.GetTotalQueryMemoryLimit() > 0) {
+        memory_tracker_ = std::make_unique<MemoryTracker>(options_.GetTotalQueryMemoryLimit());
+    }
+    if (options_.IsEnableSharedJit() && !options_.IsCompileOnly() && !options_.IsPlanOnly()) {
+        shared_jits_ = std::make_unique<SharedJitCache>();
+    }
+    if (options_.GetTieredCompileThreshold() > 0 && !options_.IsCompileOnly() && !options_.IsPlanOnly()) {
+        compile_worker_ = std::make_unique<CompileWorker>();
+    }
+}
 Engine::~Engine() {}
 void Engine::InitializeGlobalLLVM() {
     if (LLVM_IS_INITIALIZED) return;
@@ -202,13 +270,116 @@ bool Engine::IsCompatibleCache(RunSession& session,  // NOLINT
     return true;
 }
 
+void Engine::InitRequestSession(RequestRunSession* session) const {
+    session->SetRunnerPool(runner_pool_);
+    session->SetWindowCache(window_cache_);
+    session->SetMemoryLimit(options_.GetQueryMemoryLimit(), memory_tracker_.get());
+}
+
 bool Engine::Get(const std::string& sql, const std::string& db, RunSession& session,
                  base::Status& status) {  // NOLINT (runtime/references)
-    std::shared_ptr<CompileInfo> cached_info = GetCacheLocked(db, sql, session.engine_mode());
+    session.SetMemoryLimit(options_.GetQueryMemoryLimit(), memory_tracker_.get());
+    if (session.engine_mode() == kBatchMode) {
+        auto batch_sess = dynamic_cast<BatchRunSession*>(&session);
+        batch_sess->SetParallelism(options_.GetBatchParallelism());
+        batch_sess->SetSortMemoryLimit(options_.GetBatchSortMemoryLimit(), options_.GetSpillDir());
+        batch_sess->ClearImplicitParameter();
+        if (options_.IsEnableLiteralNormalization()) {
+            std::string normalized;
+            std::string cache_key = NormalizeImplicitParameter(sql, batch_sess, &normalized);
+            if (!cache_key.empty()) {
+                if (GetOrCompile(normalized, cache_key, db, session, status)) {
+                    return true;
+                }
+                // the literal may be required to be constant, e.g. the argument of some udf
+                DLOG(INFO) << "fail to compile the normalized sql, " << status;
+                batch_sess->ClearImplicitParameter();
+                status = base::Status::OK();
+            }
+        }
+    } else if (session.engine_mode() == kRequestMode) {
+        InitRequestSession(dynamic_cast<RequestRunSession*>(&session));
+    }
+    return GetOrCompile(sql, sql, db, session, status);
+}
+
+std::string Engine::NormalizeImplicitParameter(const std::string& sql, BatchRunSession* session,
+                                               std::string* normalized) {
+    if (!session->GetParameterSchema().empty()) {
+        return "";
+    }
+    std::vector<NormalizedLiteral> literals;
+    if (!vm::NormalizeLiterals(sql, normalized, &literals)) {
+        return "";
+    }
+    codec::Schema schema;
+    uint32_t str_len = 0;
+    // the types are a part of the cache key, as the plan compiled for other types is incompatible
+    std::string cache_key = *normalized;
+    cache_key.push_back('\0');
+    for (const auto& literal : literals) {
+        schema.Add()->set_type(literal.type);
+        if (literal.type == type::kVarchar) {
+            str_len += literal.value.size();
+        }
+        cache_key.append(type::Type_Name(literal.type)).push_back(',');
+    }
+    codec::RowBuilder builder(schema);
+    uint32_t size = builder.CalTotalLength(str_len);
+    int8_t* buf = static_cast<int8_t*>(malloc(size));
+    builder.SetBuffer(buf, size);
+    for (const auto& literal : literals) {
+        switch (literal.type) {
+            case type::kInt32:
+                builder.AppendInt32(static_cast<int32_t>(std::strtol(literal.value.c_str(), nullptr, 10)));
+                break;
+            case type::kInt64:
+                builder.AppendInt64(std::strtoll(literal.value.c_str(), nullptr, 10));
+                break;
+            case type::kDouble:
+                builder.AppendDouble(std::strtod(literal.value.c_str(), nullptr));
+                break;
+            default:
+                builder.AppendString(literal.value.data(), literal.value.size());
+                break;
+        }
+    }
+    session->SetImplicitParameter(schema, Row(base::RefCountedSlice::CreateManaged(buf, size)));
+    return cache_key;
+}
+
+// the value of the fast math option of a query, null if it is not set
+static const std::string* GetFastMathOption(
+    const std::shared_ptr<const std::unordered_map<std::string, std::string>>& options) {
+    if (!options) {
+        return nullptr;
+    }
+    auto iter = options->find(FAST_MATH);
+    return iter == options->end() ? nullptr : &iter->second;
+}
+
+bool Engine::GetOrCompile(const std::string& sql, const std::string& cache_key, const std::string& db,
+                          RunSession& session, base::Status& status) {  // NOLINT
+    auto fast_math = GetFastMathOption(session.GetOptions());
+    if (fast_math != nullptr) {
+        // the code differs in the option, so the queries with it are cached apart
+        std::string key = cache_key;
+        key.push_back('\0');
+        key.append(FAST_MATH).append("=").append(*fast_math);
+        return CompileOnMiss(sql, key, db, session, status);
+    }
+    return CompileOnMiss(sql, cache_key, db, session, status);
+}
+
+bool Engine::CompileOnMiss(const std::string& sql, const std::string& cache_key, const std::string& db,
+                           RunSession& session, base::Status& status) {  // NOLINT
+    std::shared_ptr<CompileInfo> cached_info = GetCacheLocked(db, cache_key, session.engine_mode());
     if (cached_info && IsCompatibleCache(session, cached_info, status)) {
-        session.SetCompileInfo(cached_info);
+        cache_hit_cnt_.fetch_add(1, std::memory_order_relaxed);
+        session.SetCompileInfo(RecordRun(cached_info));
         return true;
     }
+    cache_miss_cnt_.fetch_add(1, std::memory_order_relaxed);
     // TODO(baoxinqi): IsCompatibleCache fail, return false, or reset status.
     if (!status.isOK()) {
         LOG(WARNING) << status;
@@ -221,35 +392,23 @@ bool Engine::Get(const std::string& sql, const std::string& db, RunSession& sess
     sql_context.sql = sql;
     sql_context.db = db;
     sql_context.engine_mode = session.engine_mode();
-    sql_context.is_cluster_optimized = options_.IsClusterOptimzied();
-    sql_context.is_batch_request_optimized = options_.IsBatchRequestOptimized();
-    sql_context.enable_batch_window_parallelization = options_.IsEnableBatchWindowParallelization();
-    sql_context.enable_window_column_pruning = options_.IsEnableWindowColumnPruning();
-    sql_context.enable_expr_optimize = options_.IsEnableExprOptimize();
-    sql_context.jit_options = options_.jit_options();
     sql_context.options = session.GetOptions();
+    InitSqlContext(&sql_context);
+    if (compile_worker_) {
+        // the first tier, recompiled with full optimization once it is hot
+        sql_context.jit_options.SetEnableOpt(false);
+    }
     if (session.engine_mode() == kBatchMode) {
         sql_context.parameter_types = dynamic_cast<BatchRunSession*>(&session)->GetParameterSchema();
     } else if (session.engine_mode() == kBatchRequestMode) {
         auto batch_req_sess = dynamic_cast<BatchRequestRunSession*>(&session);
         sql_context.batch_request_info.common_column_indices = batch_req_sess->common_column_indices();
     }
-
-    SqlCompiler compiler(std::atomic_load_explicit(&cl_, std::memory_order_acquire), options_.IsKeepIr(), false,
-                         options_.IsPlanOnly());
-    bool ok = compiler.Compile(info->get_sql_context(), status);
-    if (!ok || 0 != status.code) {
+    if (!Compile(sql_context, status)) {
         return false;
     }
-    if (!options_.IsCompileOnly()) {
-        ok = compiler.BuildClusterJob(info->get_sql_context(), status);
-        if (!ok || 0 != status.code) {
-            LOG(WARNING) << "fail to build cluster job: " << status.msg;
-            return false;
-        }
-    }
 
-    SetCacheLocked(db, sql, session.engine_mode(), info);
+    SetCacheLocked(db, cache_key, session.engine_mode(), info);
     session.SetCompileInfo(info);
     if (session.is_debug_) {
         std::ostringstream plan_oss;
@@ -264,6 +423,94 @@ bool Engine::Get(const std::string& sql, const std::string& db, RunSession& sess
     return true;
 }
 
+void Engine::InitSqlContext(SqlContext* sql_context) {
+    sql_context->is_cluster_optimized = options_.IsClusterOptimzied();
+    sql_context->is_batch_request_optimized = options_.IsBatchRequestOptimized();
+    sql_context->enable_batch_window_parallelization = options_.IsEnableBatchWindowParallelization();
+    sql_context->enable_window_column_pruning = options_.IsEnableWindowColumnPruning();
+    sql_context->enable_block_project = options_.IsEnableBlockProject();
+    sql_context->enable_expr_optimize = options_.IsEnableExprOptimize();
+    sql_context->jit_options = options_.jit_options();
+    // the option of a query, e.g. a deployment, overrides the one of the engine
+    auto fast_math = GetFastMathOption(sql_context->options);
+    if (fast_math != nullptr) {
+        sql_context->jit_options.SetEnableFastMath(boost::iequals(*fast_math, "true"));
+    }
+}
+
+bool Engine::Compile(SqlContext& sql_context, base::Status& status) {  // NOLINT
+    SqlCompiler compiler(std::atomic_load_explicit(&cl_, std::memory_order_acquire), options_.IsKeepIr(), false,
+                         options_.IsPlanOnly());
+    compiler.SetSharedJitCache(shared_jits_.get());
+    bool ok = compiler.Compile(sql_context, status);
+    if (!ok || 0 != status.code) {
+        return false;
+    }
+    if (!options_.IsCompileOnly()) {
+        ok = compiler.BuildClusterJob(sql_context, status);
+        if (!ok || 0 != status.code) {
+            LOG(WARNING) << "fail to build cluster job: " << status.msg;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<CompileInfo> Engine::RecordRun(const std::shared_ptr<CompileInfo>& info) {
+    if (!compile_worker_) {
+        return info;
+    }
+    auto sql_info = std::dynamic_pointer_cast<SqlCompileInfo>(info);
+    if (!sql_info || sql_info->get_sql_context().jit_options.IsEnableOpt()) {
+        return info;
+    }
+    auto optimized_info = sql_info->GetOptimizedInfo();
+    if (optimized_info) {
+        return optimized_info;
+    }
+    // only the run reaching the threshold submits the recompile
+    if (sql_info->IncRunCount() == options_.GetTieredCompileThreshold()) {
+        compile_worker_->Submit([this, sql_info]() { Recompile(sql_info); });
+    }
+    return info;
+}
+
+void Engine::OptimizeInBackground(const std::shared_ptr<CompileInfo>& info) {
+    if (!compile_worker_) {
+        return;
+    }
+    auto sql_info = std::dynamic_pointer_cast<SqlCompileInfo>(info);
+    if (!sql_info || sql_info->get_sql_context().jit_options.IsEnableOpt()) {
+        return;
+    }
+    // skip the run count past the threshold, so the recompile is submitted once whichever reaches it first
+    uint32_t threshold = options_.GetTieredCompileThreshold();
+    if (sql_info->AddRunCount(threshold) < threshold) {
+        compile_worker_->Submit([this, sql_info]() { Recompile(sql_info); });
+    }
+}
+
+void Engine::Recompile(std::shared_ptr<SqlCompileInfo> info) {
+    const auto& origin_context = info->get_sql_context();
+    auto optimized_info = std::make_shared<SqlCompileInfo>();
+    auto& sql_context = optimized_info->get_sql_context();
+    sql_context.sql = origin_context.sql;
+    sql_context.db = origin_context.db;
+    sql_context.engine_mode = origin_context.engine_mode;
+    sql_context.options = origin_context.options;
+    sql_context.parameter_types = origin_context.parameter_types;
+    sql_context.batch_request_info.common_column_indices = origin_context.batch_request_info.common_column_indices;
+    InitSqlContext(&sql_context);
+    base::Status status;
+    if (!Compile(sql_context, status)) {
+        // keep running the quickly compiled one, e.g. the tables are changed since the first compile
+        LOG(WARNING) << "fail to recompile with full optimization: " << status << "\n" << sql_context.sql;
+        return;
+    }
+    info->SetOptimizedInfo(optimized_info);
+    DLOG(INFO) << "swap in the sql recompiled with full optimization\n" << sql_context.sql;
+}
+
 base::Status Engine::RegisterExternalFunction(const std::string& name, node::DataType return_type,
                                          const std::vector<node::DataType>& arg_types, bool is_aggregate,
                                          const std::string& file) {
@@ -401,12 +648,7 @@ std::shared_ptr<CompileInfo> Engine::GetCacheLocked(const std::string& db, const
     auto& lru = db_iter->second;
 
     // Check SQL
-    auto value = lru.get(sql);
-    if (value == boost::none) {
-        return nullptr;
-    } else {
-        return value.value();
-    }
+    return lru.Get(sql);
 }
 
 bool Engine::SetCacheLocked(const std::string& db, const std::string& sql, EngineMode engine_mode,
@@ -414,15 +656,15 @@ bool Engine::SetCacheLocked(const std::string& db, const std::string& sql, Engin
     std::lock_guard<base::SpinMutex> lock(mu_);
 
     auto& mode_cache = lru_cache_[engine_mode];
-    using BoostLRU = boost::compute::detail::lru_cache<std::string, std::shared_ptr<CompileInfo>>;
-    std::map<std::string, BoostLRU>::iterator db_iter = mode_cache.find(db);
+    auto db_iter = mode_cache.find(db);
     if (db_iter == mode_cache.end()) {
-        db_iter = mode_cache.insert(db_iter, {db, BoostLRU(options_.GetMaxSqlCacheSize())});
+        db_iter = mode_cache.emplace_hint(
+            db_iter, db, CompileInfoLRU(options_.GetMaxSqlCacheSize(), options_.GetMaxSqlCacheBytes()));
     }
     auto& lru = db_iter->second;
-    auto value = lru.get(sql);
-    if (value == boost::none || engine_mode == kBatchRequestMode) {
-        lru.insert(sql, info);
+    if (!lru.Contains(sql) || engine_mode == kBatchRequestMode) {
+        lru.Insert(sql, info, EstimateCacheBytes(std::dynamic_pointer_cast<SqlCompileInfo>(info)->get_sql_context()));
+        EvictJitLocked();
         return true;
     } else {
         // TODO(xxx): Ensure compile result is stable
@@ -431,6 +673,105 @@ bool Engine::SetCacheLocked(const std::string& db, const std::string& sql, Engin
     }
 }
 
+void Engine::EvictJitLocked() {
+    uint64_t budget = options_.GetMaxJitMemoryBytes();
+    if (budget == 0) {
+        return;
+    }
+    while (true) {
+        uint64_t total = 0;
+        size_t cnt = 0;
+        CompileInfoLRU* coldest = nullptr;
+        uint64_t coldest_bytes = 0;
+        for (auto& mode_cache : lru_cache_) {
+            for (auto& db_cache : mode_cache.second) {
+                uint64_t bytes = db_cache.second.GetJitBytes();
+                total += bytes;
+                cnt += db_cache.second.Size();
+                if (db_cache.second.Size() > 0 && (coldest == nullptr || bytes > coldest_bytes)) {
+                    coldest = &db_cache.second;
+                    coldest_bytes = bytes;
+                }
+            }
+        }
+        // the latest query is always kept
+        if (total <= budget || cnt <= 1 || coldest == nullptr) {
+            return;
+        }
+        DLOG(INFO) << "evict cold query as jitted bytes " << total << " exceed " << budget;
+        coldest->PopBack();
+    }
+}
+
+std::vector<CompileInfoStat> Engine::GetCompileInfoStats() {
+    std::vector<CompileInfoStat> stats;
+    std::lock_guard<base::SpinMutex> lock(mu_);
+    for (const auto& mode_cache : lru_cache_) {
+        for (const auto& db_cache : mode_cache.second) {
+            db_cache.second.ForEach([&](const std::string& key, const std::shared_ptr<CompileInfo>& info) {
+                stats.push_back({mode_cache.first, db_cache.first, info->GetSql(), info->GetJitCodeSize(),
+                                 info->GetJitDataSize(), info->GetIRInstructionCount()});
+            });
+        }
+    }
+    return stats;
+}
+
+void Engine::GetJitMemory(uint64_t* code_bytes, uint64_t* data_bytes) {
+    *code_bytes = HybridSeJitWrapper::GetTotalCodeSize();
+    *data_bytes = HybridSeJitWrapper::GetTotalDataSize();
+}
+
+std::shared_ptr<CompileInfo> CompileInfoLRU::Get(const std::string& key) {
+    auto iter = index_.find(key);
+    if (iter == index_.end()) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return iter->second->info;
+}
+
+void CompileInfoLRU::Insert(const std::string& key, const std::shared_ptr<CompileInfo>& info, uint64_t bytes) {
+    auto iter = index_.find(key);
+    if (iter != index_.end()) {
+        bytes_ -= iter->second->bytes;
+        entries_.erase(iter->second);
+        index_.erase(iter);
+    }
+    entries_.push_front({key, info, bytes});
+    index_.emplace(key, entries_.begin());
+    bytes_ += bytes;
+    while (entries_.size() > capacity_ || (max_bytes_ > 0 && bytes_ > max_bytes_ && entries_.size() > 1)) {
+        PopBack();
+    }
+}
+
+uint64_t CompileInfoLRU::GetJitBytes() const {
+    uint64_t bytes = 0;
+    for (const auto& entry : entries_) {
+        bytes += entry.info->GetJitCodeSize() + entry.info->GetJitDataSize();
+    }
+    return bytes;
+}
+
+bool CompileInfoLRU::PopBack() {
+    if (entries_.empty()) {
+        return false;
+    }
+    auto& last = entries_.back();
+    bytes_ -= last.bytes;
+    index_.erase(last.key);
+    entries_.pop_back();
+    return true;
+}
+
+void CompileInfoLRU::ForEach(
+    const std::function<void(const std::string&, const std::shared_ptr<CompileInfo>&)>& fn) const {
+    for (const auto& entry : entries_) {
+        fn(entry.key, entry.info);
+    }
+}
+
 RunSession::RunSession(EngineMode engine_mode) : engine_mode_(engine_mode), is_debug_(false), sp_name_("") {}
 RunSession::~RunSession() {}
 
@@ -456,12 +797,31 @@ int32_t RequestRunSession::Run(const uint32_t task_id, const Row& in_row, Row* o
     DLOG(INFO) << "Request Row Run with task_id " << task_id;
     RunnerContext ctx(&std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context().cluster_job, in_row,
                       sp_name_, is_debug_);
+    ctx.SetRunnerPool(runner_pool_.get());
+    ctx.SetWindowCache(window_cache_.get());
+    ctx.SetProfile(profile_.get());
+    ctx.SetDeadline(deadline_);
+    if (IsMemoryTracked()) {
+        ctx.SetMemoryLimit(memory_limit_, memory_tracker_);
+    }
     auto output = task->RunWithCache(ctx);
+    // the output of a runner aborted is incomplete
+    if (ctx.IsMemoryLimitExceeded()) {
+        LOG(WARNING) << "Run request plan aborted: memory limit exceeded";
+        return RUN_MEMORY_LIMIT_EXCEEDED;
+    }
+    if (ctx.IsCancelled()) {
+        LOG(WARNING) << "Run request plan aborted: deadline exceeded";
+        return RUN_DEADLINE_EXCEEDED;
+    }
     if (!output) {
         LOG(WARNING) << "Run request plan output is null";
         return -1;
     }
     bool ok = Runner::ExtractRow(output, out_row);
+    if (ctx.IsCancelled()) {
+        return RUN_DEADLINE_EXCEEDED;
+    }
     if (ok) {
         return 0;
     }
@@ -482,12 +842,27 @@ int32_t BatchRequestRunSession::Run(const uint32_t id, const std::vector<Row>& r
         LOG(WARNING) << "Fail to run request plan: taskid" << id << " not exist!";
         return -2;
     }
+    ctx.SetDeadline(deadline_);
+    if (IsMemoryTracked()) {
+        ctx.SetMemoryLimit(memory_limit_, memory_tracker_);
+    }
     auto handler = task->BatchRequestRun(ctx);
+    if (ctx.IsMemoryLimitExceeded()) {
+        LOG(WARNING) << "Run batch request plan aborted: memory limit exceeded";
+        return RUN_MEMORY_LIMIT_EXCEEDED;
+    }
+    if (ctx.IsCancelled()) {
+        LOG(WARNING) << "Run batch request plan aborted: deadline exceeded";
+        return RUN_DEADLINE_EXCEEDED;
+    }
     if (!handler) {
         LOG(WARNING) << "Run request plan output is null";
         return -1;
     }
     bool ok = Runner::ExtractRows(handler, output);
+    if (ctx.IsCancelled()) {
+        return RUN_DEADLINE_EXCEEDED;
+    }
     if (!ok) {
         return -1;
     }
@@ -499,8 +874,24 @@ int32_t BatchRunSession::Run(std::vector<Row>& rows, uint64_t limit) {
 }
 int32_t BatchRunSession::Run(const Row& parameter_row, std::vector<Row>& rows, uint64_t limit) {
     auto& sql_ctx = std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context();
-    RunnerContext ctx(&sql_ctx.cluster_job, parameter_row, is_debug_);
+    RunnerContext ctx(&sql_ctx.cluster_job, parameter_row.empty() ? implicit_parameter_row_ : parameter_row,
+                      is_debug_);
+    ctx.SetParallelism(parallelism_);
+    ctx.SetSortMemoryLimit(sort_memory_limit_, spill_dir_);
+    ctx.SetProfile(profile_.get());
+    ctx.SetDeadline(deadline_);
+    if (IsMemoryTracked()) {
+        ctx.SetMemoryLimit(memory_limit_, memory_tracker_);
+    }
     auto output = sql_ctx.cluster_job.GetTask(0).GetRoot()->RunWithCache(ctx);
+    if (ctx.IsMemoryLimitExceeded()) {
+        LOG(WARNING) << "Run batch plan aborted: memory limit exceeded";
+        return RUN_MEMORY_LIMIT_EXCEEDED;
+    }
+    if (ctx.IsCancelled()) {
+        LOG(WARNING) << "Run batch plan aborted: deadline exceeded";
+        return RUN_DEADLINE_EXCEEDED;
+    }
     if (!output) {
         DLOG(INFO) << "Run batch plan output is empty";
         return 0;
@@ -530,14 +921,22 @@ int32_t BatchRunSession::Run(const Row& parameter_row, std::vector<Row>& rows, u
     return 0;
 }
 
+static void SetSubQueryDeadline(uint64_t timeout_ms, RunSession* session) {
+    if (timeout_ms > 0) {
+        session->SetDeadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms));
+    }
+}
+
 std::shared_ptr<RowHandler> LocalTablet::SubQuery(uint32_t task_id, const std::string& db, const std::string& sql,
-                                                  const Row& row, const bool is_procedure, const bool is_debug) {
+                                                  const Row& row, const bool is_procedure, const bool is_debug,
+                                                  const uint64_t timeout_ms) {
     DLOG(INFO) << "Local tablet SubQuery request: task id " << task_id;
     RequestRunSession session;
     base::Status status;
     if (is_debug) {
         session.EnableDebug();
     }
+    SetSubQueryDeadline(timeout_ms, &session);
     if (is_procedure) {
         if (!sp_cache_) {
             auto error = std::shared_ptr<RowHandler>(new ErrorRowHandler(common::kProcedureNotFound,
@@ -554,6 +953,7 @@ std::shared_ptr<RowHandler> LocalTablet::SubQuery(uint32_t task_id, const std::s
         }
         session.SetSpName(sql);
         session.SetCompileInfo(request_compile_info);
+        engine_->InitRequestSession(&session);
     } else {
         if (!engine_->Get(sql, db, session, status)) {
             auto error = std::shared_ptr<RowHandler>(new ErrorRowHandler(status.code, "SubQuery Fail: " + status.msg));
@@ -567,7 +967,8 @@ std::shared_ptr<RowHandler> LocalTablet::SubQuery(uint32_t task_id, const std::s
 std::shared_ptr<TableHandler> LocalTablet::SubQuery(uint32_t task_id, const std::string& db, const std::string& sql,
                                                     const std::set<size_t>& common_column_indices,
                                                     const std::vector<Row>& in_rows, const bool request_is_common,
-                                                    const bool is_procedure, const bool is_debug) {
+                                                    const bool is_procedure, const bool is_debug,
+                                                    const uint64_t timeout_ms) {
     DLOG(INFO) << "Local tablet SubQuery batch request: task id " << task_id;
     BatchRequestRunSession session;
     for (size_t idx : common_column_indices) {
@@ -577,6 +978,7 @@ std::shared_ptr<TableHandler> LocalTablet::SubQuery(uint32_t task_id, const std:
     if (is_debug) {
         session.EnableDebug();
     }
+    SetSubQueryDeadline(timeout_ms, &session);
     if (is_procedure) {
         if (!sp_cache_) {
             auto error = std::shared_ptr<TableHandler>(new ErrorTableHandler(common::kProcedureNotFound,
@@ -14,11 +14,16 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
 #include "case/case_data_mock.h"
 #include "gtest/gtest.h"
 #include "gtest/internal/gtest-param-util.h"
 #include "testing/engine_test_base.h"
 #include "udf/openmldb_udf.h"
+#include "vm/sql_compiler.h"
 
 using namespace llvm;       // NOLINT (build/namespaces)
 using namespace llvm::orc;  // NOLINT (build/namespaces)
@@ -157,6 +162,274 @@ TEST_F(EngineCompileTest, EngineWithParameterizedLRUCacheTest) {
 }
 
 
+TEST_F(EngineCompileTest, EngineLiteralNormalizationTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    ::hybridse::type::IndexDef* index = table_def.add_indexes();
+    index->set_name("index0");
+    index->add_first_keys("col0");
+    index->set_second_key("col5");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.SetCompileOnly(true);
+    options.SetEnableLiteralNormalization(true);
+    Engine engine(catalog, options);
+
+    base::Status get_status;
+    BatchRunSession bsession1;
+    ASSERT_TRUE(engine.Get("select col1, col2 from t1 where col0='a' and col5<1000;", "simple_db", bsession1,
+                           get_status)) << get_status;
+    ASSERT_EQ(2, bsession1.GetParameterSchema().size());
+    ASSERT_EQ(hybridse::type::kVarchar, bsession1.GetParameterSchema().Get(0).type());
+    ASSERT_EQ(hybridse::type::kInt32, bsession1.GetParameterSchema().Get(1).type());
+    BatchRunSession bsession2;
+    ASSERT_TRUE(engine.Get("select col1, col2 from t1 where col0='bb' and col5<2000;", "simple_db", bsession2,
+                           get_status)) << get_status;
+    ASSERT_EQ(bsession1.GetCompileInfo().get(), bsession2.GetCompileInfo().get());
+    // the literal of another type is compiled again
+    ASSERT_TRUE(engine.Get("select col1, col2 from t1 where col0='bb' and col5<3000000000;", "simple_db",
+                           bsession2, get_status)) << get_status;
+    ASSERT_NE(bsession1.GetCompileInfo().get(), bsession2.GetCompileInfo().get());
+    ASSERT_EQ(hybridse::type::kInt64, bsession2.GetParameterSchema().Get(1).type());
+    // the query without literals are kept as it is
+    ASSERT_TRUE(engine.Get("select col1, col2 from t1;", "simple_db", bsession2, get_status)) << get_status;
+    ASSERT_TRUE(bsession2.GetParameterSchema().empty());
+}
+
+TEST_F(EngineCompileTest, EngineMaxSqlCacheBytesTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.SetCompileOnly(true);
+    // only the latest query is kept
+    options.SetMaxSqlCacheBytes(1);
+    Engine engine(catalog, options);
+
+    std::string sql = "select col1, col2 from t1;";
+    std::string sql2 = "select col1, col2 as cl2 from t1;";
+    base::Status get_status;
+    BatchRunSession bsession1;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", bsession1, get_status)) << get_status;
+    BatchRunSession bsession2;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", bsession2, get_status)) << get_status;
+    ASSERT_EQ(bsession1.GetCompileInfo().get(), bsession2.GetCompileInfo().get());
+    BatchRunSession bsession3;
+    ASSERT_TRUE(engine.Get(sql2, "simple_db", bsession3, get_status)) << get_status;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", bsession2, get_status)) << get_status;
+    ASSERT_NE(bsession1.GetCompileInfo().get(), bsession2.GetCompileInfo().get());
+}
+
+TEST_F(EngineCompileTest, EngineMaxJitMemoryBytesTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    // only the latest query is kept
+    options.SetMaxJitMemoryBytes(1);
+    Engine engine(catalog, options);
+
+    std::string sql = "select col1, col2 + 1 as c2 from t1;";
+    std::string sql2 = "select col1, col2 + 2 as c2 from t1;";
+    base::Status get_status;
+    BatchRunSession bsession1;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", bsession1, get_status)) << get_status;
+    auto stats = engine.GetCompileInfoStats();
+    ASSERT_EQ(1u, stats.size());
+    ASSERT_EQ(sql, stats[0].sql);
+    ASSERT_EQ("simple_db", stats[0].db);
+    ASSERT_GT(stats[0].code_bytes, 0u);
+    ASSERT_GT(stats[0].ir_instruction_cnt, 0u);
+    uint64_t code_bytes = 0;
+    uint64_t data_bytes = 0;
+    Engine::GetJitMemory(&code_bytes, &data_bytes);
+    ASSERT_GE(code_bytes, stats[0].code_bytes);
+
+    BatchRunSession bsession2;
+    ASSERT_TRUE(engine.Get(sql2, "simple_db", bsession2, get_status)) << get_status;
+    stats = engine.GetCompileInfoStats();
+    ASSERT_EQ(1u, stats.size());
+    ASSERT_EQ(sql2, stats[0].sql);
+    // the evicted query is compiled again
+    BatchRunSession bsession3;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", bsession3, get_status)) << get_status;
+    ASSERT_NE(bsession1.GetCompileInfo().get(), bsession3.GetCompileInfo().get());
+}
+
+TEST_F(EngineCompileTest, EngineBlockProjectTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    std::vector<Row> rows;
+    // more rows than a block
+    sqlcase::CaseDataMock::BuildOnePkTableData(table_def, rows, 2000);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+    ASSERT_TRUE(catalog->InsertRows("simple_db", "t1", rows));
+
+    std::string sql = "select col1 + 1 as c1, col3 * 2.0 as c3, concat(col6, \"x\") as c6 from t1;";
+    std::vector<std::vector<std::string>> results;
+    for (bool block : {false, true}) {
+        EngineOptions options;
+        options.SetEnableBlockProject(block);
+        Engine engine(catalog, options);
+        base::Status get_status;
+        BatchRunSession session;
+        ASSERT_TRUE(engine.Get(sql, "simple_db", session, get_status)) << get_status;
+        std::vector<Row> outputs;
+        ASSERT_EQ(0, session.Run(outputs));
+        std::vector<std::string> result;
+        for (const auto& row : outputs) {
+            result.emplace_back(reinterpret_cast<const char*>(row.buf()), row.size());
+        }
+        results.push_back(result);
+    }
+    ASSERT_EQ(2000u, results[1].size());
+    ASSERT_EQ(results[0], results[1]);
+}
+
+TEST_F(EngineCompileTest, EngineCompileParallelTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    std::vector<Row> rows;
+    sqlcase::CaseDataMock::BuildOnePkTableData(table_def, rows, 200);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+    ASSERT_TRUE(catalog->InsertRows("simple_db", "t1", rows));
+
+    // the project and the window aggregation make a module of several functions to split
+    std::string sql =
+        "select col1 + 1 as c1, concat(col6, \"x\") as c6, sum(col1) over w as w_sum, max(col3) over w as w_max "
+        "from t1 window w as (partition by col0 order by col5 rows between 10 preceding and current row);";
+    std::vector<std::vector<std::string>> results;
+    for (uint32_t parallelism : {1u, 4u}) {
+        EngineOptions options;
+        options.jit_options().SetCompileParallelism(parallelism);
+        Engine engine(catalog, options);
+        base::Status get_status;
+        BatchRunSession session;
+        ASSERT_TRUE(engine.Get(sql, "simple_db", session, get_status)) << parallelism << " " << get_status;
+        std::vector<Row> outputs;
+        ASSERT_EQ(0, session.Run(outputs));
+        std::vector<std::string> result;
+        for (const auto& row : outputs) {
+            result.emplace_back(reinterpret_cast<const char*>(row.buf()), row.size());
+        }
+        std::sort(result.begin(), result.end());
+        results.push_back(result);
+    }
+    ASSERT_EQ(200u, results[1].size());
+    ASSERT_EQ(results[0], results[1]);
+}
+
+TEST_F(EngineCompileTest, EngineRunDeadlineTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    std::vector<Row> rows;
+    sqlcase::CaseDataMock::BuildOnePkTableData(table_def, rows, 2000);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+    ASSERT_TRUE(catalog->InsertRows("simple_db", "t1", rows));
+
+    std::string sql = "select col1 + 1 as c1 from t1;";
+    Engine engine(catalog);
+    base::Status get_status;
+    BatchRunSession session;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", session, get_status)) << get_status;
+    std::vector<Row> outputs;
+    // no deadline by default
+    ASSERT_EQ(0, session.Run(outputs));
+    ASSERT_EQ(2000u, outputs.size());
+
+    outputs.clear();
+    session.SetDeadline(std::chrono::steady_clock::now() + std::chrono::seconds(60));
+    ASSERT_EQ(0, session.Run(outputs));
+    ASSERT_EQ(2000u, outputs.size());
+
+    outputs.clear();
+    session.SetDeadline(std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+    ASSERT_EQ(RunSession::RUN_DEADLINE_EXCEEDED, session.Run(outputs));
+    ASSERT_TRUE(outputs.empty());
+}
+
+TEST_F(EngineCompileTest, EngineRunnerProfileTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    std::vector<Row> rows;
+    sqlcase::CaseDataMock::BuildOnePkTableData(table_def, rows, 2000);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+    ASSERT_TRUE(catalog->InsertRows("simple_db", "t1", rows));
+
+    std::string sql = "select col1 + 1 as c1 from t1;";
+    Engine engine(catalog);
+    base::Status get_status;
+    BatchRunSession session;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", session, get_status)) << get_status;
+    auto profile = std::make_shared<RunnerProfile>();
+    session.SetProfile(profile);
+    for (int i = 0; i < 2; i++) {
+        std::vector<Row> outputs;
+        ASSERT_EQ(0, session.Run(outputs));
+        ASSERT_EQ(2000u, outputs.size());
+    }
+    auto stats = profile->GetStats();
+    ASSERT_FALSE(stats.empty());
+    bool has_data = false;
+    bool has_project = false;
+    for (const auto& stat : stats) {
+        ASSERT_EQ(2u, stat.run_cnt) << stat.type;
+        if (stat.type == "DATA") {
+            // the table of the storage is not iterated to count its rows
+            has_data = true;
+            ASSERT_EQ(0u, stat.rows_out);
+        } else if (stat.type == "TABLE_PROJECT") {
+            // the projected table is materialized and counted
+            has_project = true;
+            ASSERT_EQ(4000u, stat.rows_out);
+            ASSERT_GT(stat.bytes_out, 0u);
+        }
+    }
+    ASSERT_TRUE(has_data);
+    ASSERT_TRUE(has_project);
+
+    // the runs without the profile are not recorded
+    session.SetProfile(nullptr);
+    profile->Clear();
+    std::vector<Row> outputs;
+    ASSERT_EQ(0, session.Run(outputs));
+    ASSERT_TRUE(profile->GetStats().empty());
+}
+
 TEST_F(EngineCompileTest, EngineEmptyDefaultDBLRUCacheTest) {
     // Build Simple Catalog
     auto catalog = BuildSimpleCatalog();
@@ -295,6 +568,135 @@ TEST_F(EngineCompileTest, EngineCompileOnlyTest) {
     }
 }
 
+TEST_F(EngineCompileTest, EngineParallelismTest) {
+    // Build Simple Catalog
+    auto catalog = BuildSimpleCatalog();
+
+    // database simple_db
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+
+    // table t1
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    ::hybridse::type::IndexDef* index = table_def.add_indexes();
+    index->set_name("index12");
+    index->add_first_keys("col1");
+    index->add_first_keys("col2");
+    index->set_second_key("col5");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.SetCompileOnly(true);
+    options.SetBatchParallelism(4);
+    Engine engine(catalog, options);
+    std::string sql = "select col1, sum(col3) over w1 from t1 window w1 as (partition by col1, col2 order by col5 "
+                      "rows between 3 preceding and current row);";
+    base::Status get_status;
+    BatchRunSession session1;
+    ASSERT_EQ(1u, session1.GetParallelism());
+    ASSERT_TRUE(engine.Get(sql, "simple_db", session1, get_status)) << get_status;
+    ASSERT_EQ(4u, session1.GetParallelism());
+    // the cached compile info keeps the parallelism of the engine
+    BatchRunSession session2;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", session2, get_status)) << get_status;
+    ASSERT_EQ(session1.GetCompileInfo().get(), session2.GetCompileInfo().get());
+    ASSERT_EQ(4u, session2.GetParallelism());
+
+    // the request sessions share the runner pool of the engine
+    RequestRunSession request_session;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", request_session, get_status)) << get_status;
+    ASSERT_TRUE(request_session.GetRunnerPool() == nullptr);
+    options.SetRequestParallelism(2);
+    Engine engine2(catalog, options);
+    ASSERT_TRUE(engine2.Get(sql, "simple_db", request_session, get_status)) << get_status;
+    ASSERT_TRUE(request_session.GetRunnerPool() != nullptr);
+    ASSERT_EQ(engine2.GetRunnerPool().get(), request_session.GetRunnerPool().get());
+}
+
+TEST_F(EngineCompileTest, EngineTieredCompileTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    ::hybridse::type::IndexDef* index = table_def.add_indexes();
+    index->set_name("index12");
+    index->add_first_keys("col1");
+    index->set_second_key("col5");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.SetTieredCompileThreshold(2);
+    Engine engine(catalog, options);
+    std::string sql = "select col1, sum(col3) over w1 from t1 window w1 as (partition by col1 order by col5 "
+                      "rows between 3 preceding and current row);";
+    base::Status get_status;
+    RequestRunSession session1;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", session1, get_status)) << get_status;
+    auto quick_info = std::dynamic_pointer_cast<SqlCompileInfo>(session1.GetCompileInfo());
+    ASSERT_TRUE(quick_info != nullptr);
+    ASSERT_FALSE(quick_info->get_sql_context().jit_options.IsEnableOpt());
+
+    // the second run reaches the threshold and the recompile is done in background
+    RequestRunSession session2;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", session2, get_status)) << get_status;
+    for (int i = 0; i < 100 && !quick_info->GetOptimizedInfo(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    ASSERT_TRUE(quick_info->GetOptimizedInfo() != nullptr);
+    RequestRunSession session3;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", session3, get_status)) << get_status;
+    auto optimized_info = std::dynamic_pointer_cast<SqlCompileInfo>(session3.GetCompileInfo());
+    ASSERT_EQ(quick_info->GetOptimizedInfo().get(), optimized_info.get());
+    ASSERT_TRUE(optimized_info->get_sql_context().jit_options.IsEnableOpt());
+    ASSERT_EQ(quick_info->GetSchema().size(), optimized_info->GetSchema().size());
+    // the optimized one is run without recompile
+    ASSERT_EQ(optimized_info, engine.RecordRun(optimized_info));
+}
+
+TEST_F(EngineCompileTest, EngineOptimizeInBackgroundTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    ::hybridse::type::IndexDef* index = table_def.add_indexes();
+    index->set_name("index12");
+    index->add_first_keys("col1");
+    index->set_second_key("col5");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.SetTieredCompileThreshold(100);
+    Engine engine(catalog, options);
+    std::string sql = "select col1, sum(col3) over w1 from t1 window w1 as (partition by col1 order by col5 "
+                      "rows between 3 preceding and current row);";
+    base::Status get_status;
+    RequestRunSession session;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", session, get_status)) << get_status;
+    auto quick_info = std::dynamic_pointer_cast<SqlCompileInfo>(session.GetCompileInfo());
+    ASSERT_TRUE(quick_info != nullptr);
+    ASSERT_FALSE(quick_info->get_sql_context().jit_options.IsEnableOpt());
+
+    // optimized long before the threshold, the second call submits nothing
+    engine.OptimizeInBackground(quick_info);
+    engine.OptimizeInBackground(quick_info);
+    for (int i = 0; i < 100 && !quick_info->GetOptimizedInfo(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    auto optimized_info = quick_info->GetOptimizedInfo();
+    ASSERT_TRUE(optimized_info != nullptr);
+    ASSERT_EQ(optimized_info, engine.RecordRun(quick_info));
+    ASSERT_EQ(optimized_info, engine.RecordRun(optimized_info));
+}
+
 TEST_F(EngineCompileTest, EngineGetDependentTableTest) {
     {
         std::vector<std::pair<std::string, std::set<std::pair<std::string, std::string>>>> pairs;
@@ -15,6 +15,9 @@
  */
 
 #include "vm/jit.h"
+#include <atomic>
+#include <map>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
 extern "C" {
@@ -22,6 +25,10 @@ extern "C" {
 #include <cstdlib>
 }
 #include "glog/logging.h"
+#include "hybridse_version.h"  // NOLINT
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/ExecutionEngine/JITEventListener.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
@@ -34,12 +41,23 @@ extern "C" {
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO/AlwaysInliner.h"
 #include "llvm/Transforms/InstCombine/InstCombine.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
 #include "llvm/Transforms/Utils.h"
+#include "llvm/Transforms/Vectorize.h"
 #ifdef LLVM_EXT_ENABLE
 #include "llvm_ext/symbol_resolve.h"
 #endif
@@ -48,18 +66,88 @@ namespace hybridse {
 namespace vm {
 using ::llvm::orc::LLJIT;
 
+static std::atomic<uint64_t> TOTAL_CODE_BYTES{0};
+static std::atomic<uint64_t> TOTAL_DATA_BYTES{0};
+
+// the section memory manager of one object accounting the bytes of the
+// sections it allocates, the sections are freed with it
+class AccountedMemoryManager : public ::llvm::SectionMemoryManager {
+ public:
+    explicit AccountedMemoryManager(std::shared_ptr<JitMemoryUsage> usage)
+        : usage_(std::move(usage)) {}
+    ~AccountedMemoryManager() override {
+        usage_->code_bytes.fetch_sub(code_bytes_, std::memory_order_relaxed);
+        usage_->data_bytes.fetch_sub(data_bytes_, std::memory_order_relaxed);
+        TOTAL_CODE_BYTES.fetch_sub(code_bytes_, std::memory_order_relaxed);
+        TOTAL_DATA_BYTES.fetch_sub(data_bytes_, std::memory_order_relaxed);
+    }
+
+    uint8_t* allocateCodeSection(uintptr_t size, unsigned alignment,
+                                 unsigned section_id,
+                                 ::llvm::StringRef section_name) override {
+        code_bytes_ += size;
+        usage_->code_bytes.fetch_add(size, std::memory_order_relaxed);
+        TOTAL_CODE_BYTES.fetch_add(size, std::memory_order_relaxed);
+        return SectionMemoryManager::allocateCodeSection(
+            size, alignment, section_id, section_name);
+    }
+
+    uint8_t* allocateDataSection(uintptr_t size, unsigned alignment,
+                                 unsigned section_id,
+                                 ::llvm::StringRef section_name,
+                                 bool is_read_only) override {
+        data_bytes_ += size;
+        usage_->data_bytes.fetch_add(size, std::memory_order_relaxed);
+        TOTAL_DATA_BYTES.fetch_add(size, std::memory_order_relaxed);
+        return SectionMemoryManager::allocateDataSection(
+            size, alignment, section_id, section_name, is_read_only);
+    }
+
+ private:
+    std::shared_ptr<JitMemoryUsage> usage_;
+    uint64_t code_bytes_ = 0;
+    uint64_t data_bytes_ = 0;
+};
+
+uint64_t HybridSeJitWrapper::GetTotalCodeSize() {
+    return TOTAL_CODE_BYTES.load(std::memory_order_relaxed);
+}
+
+uint64_t HybridSeJitWrapper::GetTotalDataSize() {
+    return TOTAL_DATA_BYTES.load(std::memory_order_relaxed);
+}
+
 HybridSeJit::HybridSeJit(::llvm::orc::LLJITBuilderState& s, ::llvm::Error& e)
     : LLJIT(s, e) {}
 HybridSeJit::~HybridSeJit() {}
 
-static void RunDefaultOptPasses(::llvm::Module* m) {
+static void RunDefaultOptPasses(::llvm::Module* m,
+                                ::llvm::TargetMachine* tm = nullptr) {
+    // inline the functions marked always inline, e.g. the row function into
+    // the loop of the block function
+    ::llvm::legacy::PassManager mpm;
+    mpm.add(::llvm::createAlwaysInlinerLegacyPass());
+    mpm.run(*m);
     ::llvm::legacy::FunctionPassManager fpm(m);
+    if (tm != nullptr) {
+        fpm.add(::llvm::createTargetTransformInfoWrapperPass(
+            tm->getTargetIRAnalysis()));
+    }
     // Add some optimizations.
     fpm.add(::llvm::createInstructionCombiningPass());
     fpm.add(::llvm::createReassociatePass());
     fpm.add(::llvm::createGVNPass());
     fpm.add(::llvm::createCFGSimplificationPass());
     fpm.add(::llvm::createPromoteMemoryToRegisterPass());
+    fpm.add(::llvm::createLICMPass());
+    if (tm != nullptr) {
+        // vectorize with the vector width and the cost model of the target
+        fpm.add(::llvm::createLoopRotatePass());
+        fpm.add(::llvm::createLoopVectorizePass());
+        fpm.add(::llvm::createSLPVectorizerPass());
+        fpm.add(::llvm::createInstructionCombiningPass());
+        fpm.add(::llvm::createCFGSimplificationPass());
+    }
     fpm.doInitialization();
     for (auto it = m->begin(); it != m->end(); ++it) {
         fpm.run(*it);
@@ -78,12 +166,12 @@ static void RunDefaultOptPasses(::llvm::Module* m) {
     return CompileLayer->add(jd, std::move(tsm), key);
 }
 
-bool HybridSeJit::OptModule(::llvm::Module* m) {
+bool HybridSeJit::OptModule(::llvm::Module* m, ::llvm::TargetMachine* tm) {
     if (auto err = applyDataLayout(*m)) {
         return false;
     }
     DLOG(INFO) << "Module before opt:\n" << LlvmToString(*m);
-    RunDefaultOptPasses(m);
+    RunDefaultOptPasses(m, tm);
     DLOG(INFO) << "Module after opt:\n" << LlvmToString(*m);
     return true;
 }
@@ -148,10 +236,232 @@ bool HybridSeJit::AddSymbol(::llvm::orc::JITDylib& jd,
     }
 }
 
+static const char OBJECT_KEY_PREFIX[] = "hybridse_obj_";
+
+HybridSeObjectCache::HybridSeObjectCache(const std::string& dir) : dir_(dir) {
+    std::error_code ec = ::llvm::sys::fs::create_directories(dir_);
+    if (ec) {
+        LOG(WARNING) << "fail to create object cache dir " << dir_ << ": "
+                     << ec.message();
+    }
+}
+
+std::shared_ptr<HybridSeObjectCache> HybridSeObjectCache::Get(
+    const std::string& dir) {
+    static std::mutex mu;
+    static std::map<std::string, std::shared_ptr<HybridSeObjectCache>> caches;
+    std::lock_guard<std::mutex> lock(mu);
+    auto it = caches.find(dir);
+    if (it != caches.end()) {
+        return it->second;
+    }
+    auto cache = std::make_shared<HybridSeObjectCache>(dir);
+    caches.emplace(dir, cache);
+    return cache;
+}
+
+void HybridSeObjectCache::SetModuleKey(::llvm::Module* m) {
+    ::llvm::SHA1 sha1;
+    sha1.update(std::to_string(HYBRIDSE_VERSION_MAJOR) + "." +
+                std::to_string(HYBRIDSE_VERSION_MINOR) + "." +
+                std::to_string(HYBRIDSE_VERSION_BUG));
+    sha1.update(LLVM_VERSION_STRING);
+    sha1.update(m->getTargetTriple());
+    sha1.update(m->getDataLayoutStr());
+    sha1.update(LlvmToString(*m));
+    m->setModuleIdentifier(OBJECT_KEY_PREFIX + ::llvm::toHex(sha1.result()));
+}
+
+bool HybridSeObjectCache::GetObjectPath(const ::llvm::Module* m,
+                                        std::string* path) const {
+    ::llvm::StringRef key = m->getModuleIdentifier();
+    if (!key.startswith(OBJECT_KEY_PREFIX)) {
+        return false;
+    }
+    ::llvm::SmallString<256> object_path(dir_);
+    ::llvm::sys::path::append(object_path, key + ".o");
+    *path = std::string(object_path.str());
+    return true;
+}
+
+bool HybridSeObjectCache::Contains(const ::llvm::Module* m) const {
+    std::string path;
+    return GetObjectPath(m, &path) && ::llvm::sys::fs::exists(path);
+}
+
+void HybridSeObjectCache::notifyObjectCompiled(const ::llvm::Module* m,
+                                               ::llvm::MemoryBufferRef obj) {
+    std::string path;
+    if (!GetObjectPath(m, &path)) {
+        return;
+    }
+    // write to a temp file then rename, so that the concurrent compiles of the
+    // same module never read a partial object
+    ::llvm::SmallString<256> tmp_path;
+    int fd = -1;
+    std::error_code ec =
+        ::llvm::sys::fs::createUniqueFile(path + ".tmp%%%%%%", fd, tmp_path);
+    if (ec) {
+        LOG(WARNING) << "fail to create temp object file for " << path << ": "
+                     << ec.message();
+        return;
+    }
+    {
+        ::llvm::raw_fd_ostream os(fd, true);
+        os << obj.getBuffer();
+        os.close();
+        if (os.has_error()) {
+            os.clear_error();
+            LOG(WARNING) << "fail to write object file " << tmp_path.str().str();
+            ::llvm::sys::fs::remove(tmp_path);
+            return;
+        }
+    }
+    ec = ::llvm::sys::fs::rename(tmp_path, path);
+    if (ec) {
+        LOG(WARNING) << "fail to rename object file to " << path << ": "
+                     << ec.message();
+        ::llvm::sys::fs::remove(tmp_path);
+        return;
+    }
+    DLOG(INFO) << "cache object " << path;
+}
+
+std::unique_ptr<::llvm::MemoryBuffer> HybridSeObjectCache::getObject(
+    const ::llvm::Module* m) {
+    std::string path;
+    if (!GetObjectPath(m, &path)) {
+        return nullptr;
+    }
+    auto buf = ::llvm::MemoryBuffer::getFile(path, -1, false);
+    if (!buf) {
+        return nullptr;
+    }
+    DLOG(INFO) << "load cached object " << path;
+    return std::move(buf.get());
+}
+
+static ::llvm::Expected<::llvm::orc::JITTargetMachineBuilder>
+CreateTargetMachineBuilder(const JitOptions& options) {
+    const std::string& cpu = options.GetTargetCpu();
+    auto jtmb = ::llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!jtmb) {
+        return jtmb.takeError();
+    }
+    if (cpu == "native") {
+        jtmb->setCPU(::llvm::sys::getHostCPUName());
+        ::llvm::StringMap<bool> host_features;
+        if (::llvm::sys::getHostCPUFeatures(host_features)) {
+            ::llvm::SubtargetFeatures features;
+            for (auto& feature : host_features) {
+                features.AddFeature(feature.first(), feature.second);
+            }
+            jtmb->getFeatures() = features;
+        }
+    } else if (!cpu.empty()) {
+        // only the features of the cpu, not the ones of the host
+        jtmb->setCPU(cpu);
+        jtmb->getFeatures() = ::llvm::SubtargetFeatures();
+    }
+    if (options.IsEnableFastMath()) {
+        auto& target_options = jtmb->getOptions();
+        target_options.UnsafeFPMath = true;
+        target_options.NoInfsFPMath = true;
+        target_options.NoNaNsFPMath = true;
+        target_options.NoSignedZerosFPMath = true;
+    }
+    return jtmb;
+}
+
+void HybridSeLlvmJitWrapper::SetTargetAttributes(::llvm::Module* module) const {
+    if (!target_builder_) {
+        return;
+    }
+    bool set_cpu = !jit_options_.GetTargetCpu().empty();
+    std::string features = target_builder_->getFeatures().getString();
+    for (auto& fn : *module) {
+        if (fn.isDeclaration()) {
+            continue;
+        }
+        if (set_cpu) {
+            fn.addFnAttr("target-cpu", target_builder_->getCPU());
+            fn.addFnAttr("target-features", features);
+        }
+        if (jit_options_.IsEnableFastMath()) {
+            for (auto attr : {"unsafe-fp-math", "no-infs-fp-math",
+                              "no-nans-fp-math", "no-signed-zeros-fp-math"}) {
+                fn.addFnAttr(attr, "true");
+            }
+            for (auto& inst : ::llvm::instructions(fn)) {
+                if (::llvm::isa<::llvm::FPMathOperator>(&inst)) {
+                    inst.setFast(true);
+                }
+            }
+        }
+    }
+}
+
 bool HybridSeLlvmJitWrapper::Init() {
     DLOG(INFO) << "Start to initialize hybridse jit";
-    auto jit = ::llvm::Expected<std::unique_ptr<HybridSeJit>>(
-        HybridSeJitBuilder().create());
+    HybridSeJitBuilder builder;
+    bool set_target = !jit_options_.GetTargetCpu().empty() ||
+                      jit_options_.IsEnableFastMath();
+    if (!jit_options_.IsEnableOpt() || set_target) {
+        auto jtmb = CreateTargetMachineBuilder(jit_options_);
+        if (!jtmb) {
+            LOG(WARNING) << "fail to detect host: "
+                         << LlvmToString(jtmb.takeError());
+            return false;
+        }
+        if (!jit_options_.IsEnableOpt()) {
+            jtmb->setCodeGenOptLevel(::llvm::CodeGenOpt::None);
+        }
+        if (set_target) {
+            target_builder_ =
+                std::make_unique<::llvm::orc::JITTargetMachineBuilder>(*jtmb);
+            DLOG(INFO) << "jit target cpu " << target_builder_->getCPU()
+                       << ", fast math " << jit_options_.IsEnableFastMath();
+        }
+        builder.setJITTargetMachineBuilder(std::move(*jtmb));
+    }
+    uint32_t parallelism = jit_options_.GetCompileParallelism();
+    if (parallelism > 1) {
+        // the modules added are compiled concurrently on the lookup of them
+        builder.setNumCompileThreads(parallelism);
+    }
+    if (!jit_options_.GetObjectCacheDir().empty()) {
+        object_cache_ =
+            HybridSeObjectCache::Get(jit_options_.GetObjectCacheDir());
+        auto* object_cache = object_cache_.get();
+        builder.setCompileFunctionCreator(
+            [object_cache, parallelism](::llvm::orc::JITTargetMachineBuilder jtmb)
+                -> ::llvm::Expected<::llvm::orc::IRCompileLayer::CompileFunction> {
+                if (parallelism > 1) {
+                    // a target machine is not shared by the compile threads
+                    return ::llvm::orc::IRCompileLayer::CompileFunction(
+                        ::llvm::orc::ConcurrentIRCompiler(std::move(jtmb),
+                                                          object_cache));
+                }
+                auto tm = jtmb.createTargetMachine();
+                if (!tm) {
+                    return tm.takeError();
+                }
+                return ::llvm::orc::IRCompileLayer::CompileFunction(
+                    ::llvm::orc::TMOwningSimpleCompiler(std::move(*tm),
+                                                        object_cache));
+            });
+    }
+    auto usage = memory_usage_;
+    // the arguments of the creators differ among llvm versions
+    builder.setObjectLinkingLayerCreator(
+        [usage](::llvm::orc::ExecutionSession& es, const auto&...) {
+            return std::unique_ptr<::llvm::orc::ObjectLayer>(
+                new ::llvm::orc::RTDyldObjectLinkingLayer(
+                    es, [usage](const auto&...) {
+                        return std::make_unique<AccountedMemoryManager>(usage);
+                    }));
+        });
+    auto jit = ::llvm::Expected<std::unique_ptr<HybridSeJit>>(builder.create());
     {
         ::llvm::Error e = jit.takeError();
         if (e) {
@@ -170,6 +480,36 @@ bool HybridSeLlvmJitWrapper::Init() {
 }
 
 bool HybridSeLlvmJitWrapper::OptModule(::llvm::Module* module) {
+    // before the cache key, so the objects of different targets differ in key
+    SetTargetAttributes(module);
+    if (object_cache_) {
+        std::string identifier = module->getModuleIdentifier();
+        object_cache_->SetModuleKey(module);
+        // the cached object is compiled from the optimized module already
+        if (object_cache_->Contains(module)) {
+            DLOG(INFO) << "skip opt for cached module "
+                       << module->getModuleIdentifier();
+            return true;
+        }
+        if (!jit_options_.IsEnableOpt()) {
+            // do not cache the unoptimized object with the key of optimized one
+            module->setModuleIdentifier(identifier);
+        }
+    }
+    if (!jit_options_.IsEnableOpt()) {
+        return true;
+    }
+    if (target_builder_) {
+        // a target machine is not shared by the threads optimizing the
+        // partitions of a module
+        auto tm = target_builder_->createTargetMachine();
+        if (!tm) {
+            LOG(WARNING) << "fail to create target machine: "
+                         << LlvmToString(tm.takeError());
+            return false;
+        }
+        return jit_->OptModule(module, tm->get());
+    }
     return jit_->OptModule(module);
 }
 
@@ -209,6 +549,9 @@ bool HybridSeLlvmJitWrapper::AddExternalFunction(const std::string& name,
 bool HybridSeMcJitWrapper::Init() { return true; }
 
 bool HybridSeMcJitWrapper::OptModule(::llvm::Module* module) {
+    if (!jit_options_.IsEnableOpt()) {
+        return true;
+    }
     DLOG(INFO) << "Module before opt:\n" << LlvmToString(*module);
     RunDefaultOptPasses(module);
     DLOG(INFO) << "Module after opt:\n" << LlvmToString(*module);
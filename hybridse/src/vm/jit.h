@@ -17,11 +17,15 @@
 #ifndef HYBRIDSE_SRC_VM_JIT_H_
 #define HYBRIDSE_SRC_VM_JIT_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
 #include "llvm/ExecutionEngine/GenericValue.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Target/TargetMachine.h"
 #include "vm/jit_wrapper.h"
 
 #ifdef LLVM_EXT_ENABLE
@@ -48,7 +52,8 @@ class HybridSeJit : public ::llvm::orc::LLJIT {
                               ::llvm::orc::ThreadSafeModule tsm,
                               ::llvm::orc::VModuleKey key);
 
-    bool OptModule(::llvm::Module* m);
+    // the passes get the cost model of tm and vectorize for it if tm is set
+    bool OptModule(::llvm::Module* m, ::llvm::TargetMachine* tm = nullptr);
 
     ::llvm::orc::VModuleKey CreateVModule();
 
@@ -85,9 +90,48 @@ std::string LlvmToString(const T& value) {
     return str;
 }
 
+// Persist the objects compiled by LLJIT in a directory, so that the module
+// compiled again, e.g. the deployments recovered on restart, loads the object
+// instead of running optimization and codegen. The key of module is the sha1 of
+// its ir before optimization together with the engine and llvm version, so the
+// function names resolved by physical plan always match the cached object.
+class HybridSeObjectCache : public ::llvm::ObjectCache {
+ public:
+    explicit HybridSeObjectCache(const std::string& dir);
+    ~HybridSeObjectCache() {}
+
+    // the cache shared by all jit on the same directory
+    static std::shared_ptr<HybridSeObjectCache> Get(const std::string& dir);
+
+    // set the identifier of module to its cache key
+    void SetModuleKey(::llvm::Module* m);
+
+    bool Contains(const ::llvm::Module* m) const;
+
+    void notifyObjectCompiled(const ::llvm::Module* m,
+                              ::llvm::MemoryBufferRef obj) override;
+
+    std::unique_ptr<::llvm::MemoryBuffer> getObject(
+        const ::llvm::Module* m) override;
+
+ private:
+    bool GetObjectPath(const ::llvm::Module* m, std::string* path) const;
+
+    std::string dir_;
+};
+
+// the bytes of the sections allocated for the objects of one jit, the
+// sections are released with the jit
+struct JitMemoryUsage {
+    std::atomic<uint64_t> code_bytes{0};
+    std::atomic<uint64_t> data_bytes{0};
+};
+
 class HybridSeLlvmJitWrapper : public HybridSeJitWrapper {
  public:
     HybridSeLlvmJitWrapper() {}
+    explicit HybridSeLlvmJitWrapper(const JitOptions& jit_options)
+        : jit_options_(jit_options) {}
     ~HybridSeLlvmJitWrapper() {}
 
     bool Init() override;
@@ -102,7 +146,27 @@ class HybridSeLlvmJitWrapper : public HybridSeJitWrapper {
     hybridse::vm::RawPtrHandle FindFunction(
         const std::string& funcname) override;
 
+    uint64_t GetCodeSize() const override {
+        return memory_usage_->code_bytes.load(std::memory_order_relaxed);
+    }
+    uint64_t GetDataSize() const override {
+        return memory_usage_->data_bytes.load(std::memory_order_relaxed);
+    }
+
  private:
+    // set the target cpu, features and fast math of the options to the
+    // functions of module, so the passes and the codegen agree on them
+    void SetTargetAttributes(::llvm::Module* module) const;
+
+    const JitOptions jit_options_;
+    // the target configured by the options, null to keep the default of llvm
+    std::unique_ptr<::llvm::orc::JITTargetMachineBuilder> target_builder_;
+    // shared with the memory managers of the objects, which may be released
+    // after the wrapper
+    std::shared_ptr<JitMemoryUsage> memory_usage_ =
+        std::make_shared<JitMemoryUsage>();
+    // declared before jit_ as the compile layer refers to it
+    std::shared_ptr<HybridSeObjectCache> object_cache_;
     std::unique_ptr<HybridSeJit> jit_;
     std::unique_ptr<::llvm::orc::MangleAndInterner> mi_;
 };
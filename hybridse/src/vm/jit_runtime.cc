@@ -23,6 +23,7 @@ thread_local JitRuntime JitRuntime::tls_runtime_inst_;
 JitRuntime* JitRuntime::get() { return &tls_runtime_inst_; }
 
 int8_t* JitRuntime::AllocManaged(size_t bytes) {
+    managed_bytes_ += bytes;
     return reinterpret_cast<int8_t*>(mem_pool_.Alloc(bytes));
 }
 
@@ -35,7 +36,8 @@ void JitRuntime::AddManagedObject(base::FeBaseObject* obj) {
 void JitRuntime::InitRunStep() {}
 
 void JitRuntime::ReleaseRunStep() {
-    mem_pool_.Reset();
+    mem_pool_.Recycle(MAX_RETAINED_BYTES);
+    managed_bytes_ = 0;
     for (base::FeBaseObject* obj : allocated_obj_pool_) {
         if (obj != nullptr) {
             delete obj;
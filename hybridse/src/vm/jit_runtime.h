@@ -16,7 +16,7 @@
 #ifndef HYBRIDSE_SRC_VM_JIT_RUNTIME_H_
 #define HYBRIDSE_SRC_VM_JIT_RUNTIME_H_
 
-#include <list>
+#include <vector>
 
 #include "base/fe_object.h"
 #include "base/mem_pool.h"
@@ -26,7 +26,7 @@ namespace vm {
 
 class JitRuntime {
  public:
-    JitRuntime() {}
+    JitRuntime() : managed_bytes_(0) {}
 
     /**
      * Get TLS JIT runtime instance.
@@ -40,6 +40,12 @@ class JitRuntime {
      */
     int8_t* AllocManaged(size_t bytes);
 
+    /**
+     * Return the bytes allocated by `AllocManaged` since the last
+     * `ReleaseRunStep()`.
+     */
+    size_t GetManagedBytes() const { return managed_bytes_; }
+
     openmldb::base::ByteMemoryPool* GetMemPool() {
         return &mem_pool_;
     }
@@ -56,13 +62,17 @@ class JitRuntime {
     void InitRunStep();
 
     /**
-     * Release resources allocated in run step
+     * Release resources allocated in run step. The memory chunks up to
+     * `MAX_RETAINED_BYTES` are kept for the later run steps of the thread.
      */
     void ReleaseRunStep();
 
+    static const size_t MAX_RETAINED_BYTES = 1024 * 1024;
+
  private:
     openmldb::base::ByteMemoryPool mem_pool_;
-    std::list<base::FeBaseObject*> allocated_obj_pool_;
+    std::vector<base::FeBaseObject*> allocated_obj_pool_;
+    size_t managed_bytes_;
 
     static thread_local JitRuntime tls_runtime_inst_;
 };
@@ -16,6 +16,7 @@
 
 #include "vm/jit.h"
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 #include "gtest/gtest.h"
@@ -25,6 +26,7 @@
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
@@ -143,6 +145,49 @@ TEST_F(JITTest, test_udf_invoke_module) {
     }
 }
 
+static std::unique_ptr<Module> CreateAdd2Module(LLVMContext *ctx) {
+    auto m = make_unique<Module>("custom_fn", *ctx);
+    Function *fn = Function::Create(
+        FunctionType::get(Type::getInt32Ty(*ctx), {Type::getInt32Ty(*ctx)},
+                          false),
+        Function::ExternalLinkage, "add2", m.get());
+    BasicBlock *bb = BasicBlock::Create(*ctx, "EntryBlock", fn);
+    IRBuilder<> builder(bb);
+    Value *add = builder.CreateAdd(builder.getInt32(2), &*fn->arg_begin());
+    builder.CreateRet(add);
+    return m;
+}
+
+TEST_F(JITTest, test_object_cache) {
+    std::string dir = "/tmp/hybridse_object_cache_test";
+    ::llvm::sys::fs::remove_directories(dir);
+    JitOptions jit_options;
+    jit_options.SetObjectCacheDir(dir);
+    for (int i = 0; i < 2; i++) {
+        HybridSeLlvmJitWrapper jit(jit_options);
+        ASSERT_TRUE(jit.Init());
+        auto ctx = llvm::make_unique<LLVMContext>();
+        auto m = CreateAdd2Module(ctx.get());
+        auto object_cache = HybridSeObjectCache::Get(dir);
+        object_cache->SetModuleKey(m.get());
+        // the object is cached by the first jit
+        ASSERT_EQ(i == 1, object_cache->Contains(m.get()));
+        ASSERT_TRUE(jit.OptModule(m.get()));
+        ASSERT_TRUE(jit.AddModule(std::move(m), std::move(ctx)));
+        auto fn = reinterpret_cast<int32_t (*)(int32_t)>(
+            const_cast<int8_t *>(jit.FindFunction("add2")));
+        ASSERT_TRUE(fn != nullptr);
+        ASSERT_EQ(3, fn(1));
+    }
+    auto ctx = llvm::make_unique<LLVMContext>();
+    auto m = CreateAdd2Module(ctx.get());
+    m->getFunction("add2")->setName("add3");
+    auto object_cache = HybridSeObjectCache::Get(dir);
+    object_cache->SetModuleKey(m.get());
+    ASSERT_FALSE(object_cache->Contains(m.get()));
+    ::llvm::sys::fs::remove_directories(dir);
+}
+
 }  // namespace vm
 }  // namespace hybridse
 
@@ -83,7 +83,7 @@ HybridSeJitWrapper* HybridSeJitWrapper::Create(const JitOptions& jit_options) {
             jit_options.IsEnableGdb()) {
             LOG(WARNING) << "LLJIT do not support jit events";
         }
-        return new HybridSeLlvmJitWrapper();
+        return new HybridSeLlvmJitWrapper(jit_options);
     }
 }
 
@@ -197,6 +197,21 @@ void InitBuiltinJitSymbols(HybridSeJitWrapper* jit) {
     jit->AddExternalFunction(
         "hybridse_storage_row_iter_delete",
         reinterpret_cast<void*>(&hybridse::vm::RowIterDelete));
+    jit->AddExternalFunction(
+        "hybridse_storage_column_agg_int16",
+        reinterpret_cast<void*>(&hybridse::vm::ColumnAgg<int16_t>));
+    jit->AddExternalFunction(
+        "hybridse_storage_column_agg_int32",
+        reinterpret_cast<void*>(&hybridse::vm::ColumnAgg<int32_t>));
+    jit->AddExternalFunction(
+        "hybridse_storage_column_agg_int64",
+        reinterpret_cast<void*>(&hybridse::vm::ColumnAgg<int64_t>));
+    jit->AddExternalFunction(
+        "hybridse_storage_column_agg_float",
+        reinterpret_cast<void*>(&hybridse::vm::ColumnAgg<float>));
+    jit->AddExternalFunction(
+        "hybridse_storage_column_agg_double",
+        reinterpret_cast<void*>(&hybridse::vm::ColumnAgg<double>));
     jit->AddExternalFunction(
         "hybridse_storage_get_row_slice",
         reinterpret_cast<void*>(&hybridse::vm::RowGetSlice));
@@ -51,6 +51,15 @@ class HybridSeJitWrapper {
     virtual hybridse::vm::RawPtrHandle FindFunction(
         const std::string& funcname) = 0;
 
+    // the bytes of the code and data sections allocated for the modules
+    // added, 0 if the jit does not account them
+    virtual uint64_t GetCodeSize() const { return 0; }
+    virtual uint64_t GetDataSize() const { return 0; }
+
+    // the bytes of the code and data sections of all the jits alive
+    static uint64_t GetTotalCodeSize();
+    static uint64_t GetTotalDataSize();
+
     static HybridSeJitWrapper* Create(const JitOptions& jit_options);
     static HybridSeJitWrapper* Create();
     static void DeleteJit(HybridSeJitWrapper* jit);
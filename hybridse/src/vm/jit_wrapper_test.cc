@@ -15,6 +15,8 @@
  */
 
 #include "vm/jit_wrapper.h"
+#include <string>
+#include <vector>
 #include "codec/fe_row_codec.h"
 #include "gtest/gtest.h"
 #include "udf/udf.h"
@@ -118,6 +120,47 @@ TEST_F(JitWrapperTest, test) {
     simple_test(options);
 }
 
+TEST_F(JitWrapperTest, test_target) {
+    auto catalog = GetTestCatalog();
+    std::vector<std::string> cpus = {"", "native"};
+#if defined(__x86_64__)
+    cpus.push_back("x86-64");
+#endif
+    for (auto &cpu : cpus) {
+        for (bool fast_math : {false, true}) {
+            EngineOptions options;
+            options.jit_options().SetTargetCpu(cpu);
+            options.jit_options().SetEnableFastMath(fast_math);
+            auto compile_info = Compile(
+                "select col_1 * 2.0 + col_2 as c1, col_2 from t1;", options,
+                catalog);
+            ASSERT_TRUE(compile_info != nullptr) << cpu;
+            auto &sql_context = compile_info->get_sql_context();
+            auto fn = sql_context.physical_plan->GetFnInfos()[0]->fn_ptr();
+            ASSERT_TRUE(fn != nullptr) << cpu;
+
+            int8_t buf[1024];
+            auto schema = catalog->GetTable("db", "t1")->GetSchema();
+            codec::RowBuilder row_builder(*schema);
+            row_builder.SetBuffer(buf, 1024);
+            row_builder.AppendDouble(1.5);
+            row_builder.AppendInt64(42);
+            hybridse::codec::Row empty_parameter;
+            hybridse::codec::Row row(base::RefCountedSlice::Create(buf, 1024));
+            hybridse::codec::Row output =
+                CoreAPI::RowProject(fn, row, empty_parameter);
+            codec::RowView row_view(compile_info->GetSchema(), output.buf(),
+                                    output.size());
+            double c1;
+            int64_t c2;
+            ASSERT_EQ(row_view.GetDouble(0, &c1), 0);
+            ASSERT_EQ(row_view.GetInt64(1, &c2), 0);
+            ASSERT_EQ(c1, 45.0) << cpu << " " << fast_math;
+            ASSERT_EQ(c2, 42);
+        }
+    }
+}
+
 #ifdef LLVM_EXT_ENABLE
 TEST_F(JitWrapperTest, test_mcjit) {
     EngineOptions options;
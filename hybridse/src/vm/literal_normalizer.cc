@@ -0,0 +1,217 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "vm/literal_normalizer.h"
+
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <set>
+
+namespace hybridse {
+namespace vm {
+
+static bool IsIdentStart(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+static bool IsIdentChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+static bool IsDigit(char c) { return std::isdigit(static_cast<unsigned char>(c)); }
+
+// the keywords ending the WHERE clause of a single select
+static const std::set<std::string> WHERE_END_KEYWORDS = {"GROUP", "HAVING", "ORDER",  "LIMIT",  "WINDOW",
+                                                         "UNION", "CONFIG", "OPTIONS", "INTO"};
+
+// the two char operators are matched before the one char ones
+static const char* const OPERATORS[] = {"<=", ">=", "<>", "!=", "==", "<<", ">>", "||", "&&"};
+static const std::set<std::string> COMPARISON_OPERATORS = {"<=", ">=", "<>", "!=", "==", "=", "<", ">"};
+
+// return the type of the integer as the parser does, false if it is out of range
+static bool GetIntegerType(const std::string& text, type::Type* type) {
+    const char* digits = text.c_str() + (text[0] == '-' ? 1 : 0);
+    errno = 0;
+    uint64_t magnitude = std::strtoull(digits, nullptr, 10);
+    if (errno == ERANGE || magnitude > static_cast<uint64_t>(INT64_MAX)) {
+        return false;
+    }
+    *type = magnitude <= static_cast<uint64_t>(INT_MAX) ? type::kInt32 : type::kInt64;
+    return true;
+}
+
+bool NormalizeLiterals(const std::string& sql, std::string* normalized, std::vector<NormalizedLiteral>* literals) {
+    if (normalized == nullptr || literals == nullptr) {
+        return false;
+    }
+    normalized->clear();
+    literals->clear();
+    // the text of sql before `copied` is in normalized
+    size_t copied = 0;
+    auto replace = [&](size_t start, size_t end, type::Type type, std::string value) {
+        normalized->append(sql, copied, start - copied);
+        normalized->push_back('?');
+        copied = end;
+        literals->push_back({type, std::move(value)});
+    };
+    bool first_token = true;
+    bool in_where = false;
+    bool after_cmp = false;
+    size_t n = sql.size();
+    size_t i = 0;
+    while (i < n) {
+        char c = sql[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            i++;
+            continue;
+        }
+        if (c == '-' && i + 1 < n && sql[i + 1] == '-') {
+            size_t pos = sql.find('\n', i);
+            i = pos == std::string::npos ? n : pos + 1;
+            continue;
+        }
+        if (c == '/' && i + 1 < n && sql[i + 1] == '*') {
+            size_t pos = sql.find("*/", i + 2);
+            if (pos == std::string::npos) {
+                return false;
+            }
+            i = pos + 2;
+            continue;
+        }
+        size_t start = i;
+        bool is_cmp = false;
+        if (IsIdentStart(c)) {
+            while (i < n && IsIdentChar(sql[i])) {
+                i++;
+            }
+            if (i < n && (sql[i] == '\'' || sql[i] == '"')) {
+                // the raw or bytes string as r'...'
+                return false;
+            }
+            std::string word = sql.substr(start, i - start);
+            for (auto& ch : word) {
+                ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+            }
+            if (word == "SELECT") {
+                if (!first_token) {
+                    // the sub queries are not normalized
+                    return false;
+                }
+            } else if (first_token) {
+                return false;
+            } else if (word == "WHERE") {
+                in_where = true;
+            } else if (WHERE_END_KEYWORDS.count(word) > 0) {
+                in_where = false;
+            }
+        } else if (first_token) {
+            return false;
+        } else if (c == '`') {
+            size_t pos = sql.find('`', i + 1);
+            if (pos == std::string::npos) {
+                return false;
+            }
+            i = pos + 1;
+        } else if (c == '\'' || c == '"') {
+            if (sql.compare(i, 3, std::string(3, c)) == 0) {
+                // the triple quoted string
+                return false;
+            }
+            bool escaped = false;
+            i++;
+            while (i < n && sql[i] != c) {
+                if (sql[i] == '\\') {
+                    escaped = true;
+                    i++;
+                }
+                i++;
+            }
+            if (i >= n) {
+                return false;
+            }
+            i++;
+            if (in_where && after_cmp && !escaped) {
+                replace(start, i, type::kVarchar, sql.substr(start + 1, i - start - 2));
+            }
+        } else if (IsDigit(c) || (c == '-' && after_cmp && i + 1 < n && IsDigit(sql[i + 1]))) {
+            bool is_float = false;
+            i++;
+            while (i < n && IsDigit(sql[i])) {
+                i++;
+            }
+            if (i < n && sql[i] == '.') {
+                is_float = true;
+                i++;
+                while (i < n && IsDigit(sql[i])) {
+                    i++;
+                }
+            }
+            if (i < n && (sql[i] == 'e' || sql[i] == 'E')) {
+                size_t pos = i + 1;
+                if (pos < n && (sql[pos] == '+' || sql[pos] == '-')) {
+                    pos++;
+                }
+                if (pos < n && IsDigit(sql[pos])) {
+                    is_float = true;
+                    i = pos;
+                    while (i < n && IsDigit(sql[i])) {
+                        i++;
+                    }
+                }
+            }
+            if (i < n && (IsIdentChar(sql[i]) || sql[i] == '.')) {
+                // the suffix decides the type, e.g. 1L, 1.0f or the interval 1d
+                while (i < n && (IsIdentChar(sql[i]) || sql[i] == '.')) {
+                    i++;
+                }
+            } else if (in_where && after_cmp) {
+                std::string text = sql.substr(start, i - start);
+                type::Type type = type::kDouble;
+                if (is_float || GetIntegerType(text, &type)) {
+                    replace(start, i, type, text);
+                }
+            }
+        } else if (c == '?') {
+            // mixing the implicit parameters with the given ones is not supported
+            return false;
+        } else if (c == ';') {
+            i++;
+            while (i < n && std::isspace(static_cast<unsigned char>(sql[i]))) {
+                i++;
+            }
+            if (i < n) {
+                // multiple statements
+                return false;
+            }
+        } else {
+            size_t len = 1;
+            for (const char* op : OPERATORS) {
+                if (sql.compare(i, 2, op) == 0) {
+                    len = 2;
+                    break;
+                }
+            }
+            is_cmp = COMPARISON_OPERATORS.count(sql.substr(i, len)) > 0;
+            i += len;
+        }
+        after_cmp = is_cmp;
+        first_token = false;
+    }
+    if (literals->empty()) {
+        return false;
+    }
+    normalized->append(sql, copied, std::string::npos);
+    return true;
+}
+
+}  // namespace vm
+}  // namespace hybridse
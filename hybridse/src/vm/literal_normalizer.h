@@ -0,0 +1,43 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HYBRIDSE_SRC_VM_LITERAL_NORMALIZER_H_
+#define HYBRIDSE_SRC_VM_LITERAL_NORMALIZER_H_
+
+#include <string>
+#include <vector>
+
+#include "proto/fe_type.pb.h"
+
+namespace hybridse {
+namespace vm {
+
+struct NormalizedLiteral {
+    // kInt32, kInt64, kDouble or kVarchar, the same type the parser gives to the literal
+    type::Type type;
+    // the text of the number, or the unquoted content of the string
+    std::string value;
+};
+
+/// Replace the literals compared in the WHERE clause of a query with anonymous parameters `?`, so that the
+/// queries only differing in them share one compiled plan. Only a single SELECT without parameters is
+/// normalized and only the plain numbers and strings right after a comparison operator are replaced, the
+/// literals the plan may depend on, e.g. the ones in LIMIT, window frames or function arguments, are kept.
+/// Return false if no literal is replaced.
+bool NormalizeLiterals(const std::string& sql, std::string* normalized, std::vector<NormalizedLiteral>* literals);
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_LITERAL_NORMALIZER_H_
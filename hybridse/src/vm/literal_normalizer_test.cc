@@ -0,0 +1,78 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/literal_normalizer.h"
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+
+class LiteralNormalizerTest : public ::testing::Test {};
+
+TEST_F(LiteralNormalizerTest, Normalize) {
+    std::string normalized;
+    std::vector<NormalizedLiteral> literals;
+    ASSERT_TRUE(NormalizeLiterals(
+        "SELECT col1, 'x' AS c FROM t1 WHERE col0 = 'a' AND col1 >= -10 AND col5 < 3000000000 "
+        "and col3 <> 1.5e2 LIMIT 10;",
+        &normalized, &literals));
+    ASSERT_EQ("SELECT col1, 'x' AS c FROM t1 WHERE col0 = ? AND col1 >= ? AND col5 < ? and col3 <> ? LIMIT 10;",
+              normalized);
+    ASSERT_EQ(4u, literals.size());
+    ASSERT_EQ(type::kVarchar, literals[0].type);
+    ASSERT_EQ("a", literals[0].value);
+    ASSERT_EQ(type::kInt32, literals[1].type);
+    ASSERT_EQ("-10", literals[1].value);
+    ASSERT_EQ(type::kInt64, literals[2].type);
+    ASSERT_EQ(type::kDouble, literals[3].type);
+    ASSERT_EQ("1.5e2", literals[3].value);
+
+    // the literals out of the comparisons in where clause are kept
+    ASSERT_TRUE(NormalizeLiterals(
+        "select col1 from t1 /* where c = 1 */ where col2 = 2L and substr(col0, 1) = \"ab\" and col1 = 1 -- = 3\n"
+        "and `col = 4` = 5 group by col1 having count(col1) > 6",
+        &normalized, &literals));
+    ASSERT_EQ(
+        "select col1 from t1 /* where c = 1 */ where col2 = 2L and substr(col0, 1) = ? and col1 = ? -- = 3\n"
+        "and `col = 4` = ? group by col1 having count(col1) > 6",
+        normalized);
+    ASSERT_EQ(3u, literals.size());
+    ASSERT_EQ("ab", literals[0].value);
+    ASSERT_EQ("1", literals[1].value);
+    ASSERT_EQ("5", literals[2].value);
+}
+
+TEST_F(LiteralNormalizerTest, NotNormalized) {
+    std::string normalized;
+    std::vector<NormalizedLiteral> literals;
+    ASSERT_FALSE(NormalizeLiterals("select col1 from t1 limit 10;", &normalized, &literals));
+    ASSERT_FALSE(NormalizeLiterals("select col1 from t1 where col1 = ?;", &normalized, &literals));
+    ASSERT_FALSE(NormalizeLiterals("select * from (select col1 from t1 where col1 = 1);", &normalized, &literals));
+    ASSERT_FALSE(NormalizeLiterals("insert into t1 values (1, 'a');", &normalized, &literals));
+    ASSERT_FALSE(NormalizeLiterals("select col1 from t1 where col1 = 1; select 1;", &normalized, &literals));
+    ASSERT_FALSE(NormalizeLiterals("select col1 from t1 where col1 = 'a\\'b';", &normalized, &literals));
+    ASSERT_FALSE(NormalizeLiterals("select col1 from t1 where col1 = 'a", &normalized, &literals));
+    ASSERT_FALSE(NormalizeLiterals("select col1 from t1 where col1 << 1 > col2;", &normalized, &literals));
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
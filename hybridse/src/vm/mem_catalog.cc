@@ -16,6 +16,8 @@
 
 #include "vm/mem_catalog.h"
 #include <algorithm>
+#include <limits>
+#include <type_traits>
 namespace hybridse {
 namespace vm {
 MemTimeTableIterator::MemTimeTableIterator(const MemTimeTable* table,
@@ -194,6 +196,16 @@ bool MemPartitionHandler::AddRow(const std::string& key, uint64_t ts,
     }
     return true;
 }
+void MemPartitionHandler::AddSegment(const std::string& key, MemTimeTable&& rows) {
+    auto iter = partitions_.find(key);
+    if (iter == partitions_.end()) {
+        partitions_.emplace(key, std::move(rows));
+        return;
+    }
+    for (auto& row : rows) {
+        iter->second.push_back(std::move(row));
+    }
+}
 std::unique_ptr<WindowIterator> MemPartitionHandler::GetWindowIterator() {
     return std::unique_ptr<WindowIterator>(
         new MemWindowIterator(&partitions_, schema_));
@@ -425,5 +437,124 @@ size_t RowGetSliceSize(int8_t* row_ptr, size_t idx) {
     auto row = reinterpret_cast<Row*>(row_ptr);
     return row->size(idx);
 }
+
+template <class V>
+void ReduceColumn(const V* values, size_t n, V* sum, double* fsum, V* min, V* max) {
+    // the integers are added as unsigned to wrap around without undefined behavior
+    using Acc = typename std::conditional<std::is_integral<V>::value, std::make_unsigned<V>,
+                                          std::common_type<V>>::type::type;
+    constexpr size_t kLanes = 8;
+    Acc sums[kLanes];
+    double fsums[kLanes];
+    V mins[kLanes];
+    V maxs[kLanes];
+    for (size_t j = 0; j < kLanes; j++) {
+        sums[j] = 0;
+        fsums[j] = 0.0;
+        mins[j] = std::numeric_limits<V>::max();
+        maxs[j] = std::numeric_limits<V>::lowest();
+    }
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        for (size_t j = 0; j < kLanes; j++) {
+            V v = values[i + j];
+            sums[j] += static_cast<Acc>(v);
+            fsums[j] += static_cast<double>(v);
+            mins[j] = v < mins[j] ? v : mins[j];
+            maxs[j] = maxs[j] < v ? v : maxs[j];
+        }
+    }
+    for (size_t j = 0; i < n; i++, j++) {
+        V v = values[i];
+        sums[j] += static_cast<Acc>(v);
+        fsums[j] += static_cast<double>(v);
+        mins[j] = v < mins[j] ? v : mins[j];
+        maxs[j] = maxs[j] < v ? v : maxs[j];
+    }
+    Acc total = 0;
+    double ftotal = 0.0;
+    V min_value = mins[0];
+    V max_value = maxs[0];
+    for (size_t j = 0; j < kLanes; j++) {
+        total += sums[j];
+        ftotal += fsums[j];
+        min_value = mins[j] < min_value ? mins[j] : min_value;
+        max_value = max_value < maxs[j] ? maxs[j] : max_value;
+    }
+    *sum = static_cast<V>(total);
+    *fsum = ftotal;
+    *min = min_value;
+    *max = max_value;
+}
+
+// bring the state of the column to the rows of the window: retract the rows slid out, then
+// fold in the rows added since the last instance
+template <class V>
+static void SlideColumnAgg(Window* window, const codec::ColumnImpl<V>& column, SlidingColumnAgg<V>* state) {
+    uint64_t begin = window->begin_seq();
+    uint64_t end = window->end_seq();
+    if (state->begin_seq() > begin || state->begin_seq() > end || state->end_seq() <= begin) {
+        state->Reset(begin);
+    }
+    while (state->end_seq() > end) {
+        state->RetractNewest();
+    }
+    while (state->begin_seq() < begin) {
+        state->RetractOldest();
+    }
+    // the newest row is at the front of the window
+    for (uint64_t seq = state->end_seq(); seq < end; seq++) {
+        V value = 0;
+        bool is_null = true;
+        column.GetField(window->At(end - 1 - seq), &value, &is_null);
+        state->Add(value, is_null);
+    }
+}
+
+template <class V>
+void ColumnAgg(int8_t* input, size_t slice_idx, size_t col_idx, size_t offset, V* sum, double* fsum, int64_t* cnt,
+               V* min, V* max) {
+    auto list_ref = reinterpret_cast<codec::ListRef<Row>*>(input);
+    auto handler = reinterpret_cast<codec::ListV<Row>*>(list_ref->list);
+    codec::ColumnImpl<V> column(handler, slice_idx, col_idx, offset);
+    auto window = dynamic_cast<Window*>(handler);
+    if (window != nullptr && window->sliding_agg()) {
+        auto state = window->GetSlidingColumnAgg<V>(slice_idx, col_idx);
+        SlideColumnAgg<V>(window, column, state);
+        if (state->size() == window->GetCount()) {
+            state->Get(sum, fsum, cnt, min, max);
+            return;
+        }
+        // the window is changed in a way the state can not follow
+        state->Reset(window->end_seq());
+    }
+    // the buffer is reused by the windows computed on the same thread
+    thread_local std::vector<V> values;
+    values.clear();
+    auto iter = handler->GetIterator();
+    iter->SeekToFirst();
+    while (iter->Valid()) {
+        V value;
+        bool is_null;
+        column.GetField(iter->GetValue(), &value, &is_null);
+        if (!is_null) {
+            values.push_back(value);
+        }
+        iter->Next();
+    }
+    *cnt = values.size();
+    ReduceColumn<V>(values.data(), values.size(), sum, fsum, min, max);
+}
+
+template void ColumnAgg<int16_t>(int8_t*, size_t, size_t, size_t, int16_t*, double*, int64_t*, int16_t*, int16_t*);
+template void ColumnAgg<int32_t>(int8_t*, size_t, size_t, size_t, int32_t*, double*, int64_t*, int32_t*, int32_t*);
+template void ColumnAgg<int64_t>(int8_t*, size_t, size_t, size_t, int64_t*, double*, int64_t*, int64_t*, int64_t*);
+template void ColumnAgg<float>(int8_t*, size_t, size_t, size_t, float*, double*, int64_t*, float*, float*);
+template void ColumnAgg<double>(int8_t*, size_t, size_t, size_t, double*, double*, int64_t*, double*, double*);
+template void ReduceColumn<int16_t>(const int16_t*, size_t, int16_t*, double*, int16_t*, int16_t*);
+template void ReduceColumn<int32_t>(const int32_t*, size_t, int32_t*, double*, int32_t*, int32_t*);
+template void ReduceColumn<int64_t>(const int64_t*, size_t, int64_t*, double*, int64_t*, int64_t*);
+template void ReduceColumn<float>(const float*, size_t, float*, double*, float*, float*);
+template void ReduceColumn<double>(const double*, size_t, double*, double*, double*, double*);
 }  // namespace vm
 }  // namespace hybridse
@@ -421,6 +421,40 @@ TEST_F(MemCataLogTest, mem_partition_test) {
     }
 }
 
+TEST_F(MemCataLogTest, mem_partition_add_segment_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    auto partition_handler = std::make_shared<vm::MemPartitionHandler>("t1", "temp", &(table.columns()));
+
+    partition_handler->AddRow("group1", 1, rows[0]);
+    vm::MemTimeTable group1;
+    group1.push_back(std::make_pair(2, rows[1]));
+    group1.push_back(std::make_pair(3, rows[2]));
+    partition_handler->AddSegment("group1", std::move(group1));
+    vm::MemTimeTable group2;
+    group2.push_back(std::make_pair(4, rows[3]));
+    partition_handler->AddSegment("group2", std::move(group2));
+    ASSERT_EQ(2u, partition_handler->GetCount());
+
+    // the rows of a segment are appended after the ones of the key
+    auto segment = partition_handler->GetSegment("group1");
+    auto iter = segment->GetIterator();
+    iter->SeekToFirst();
+    for (size_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(i + 1, iter->GetKey());
+        ASSERT_TRUE(iter->GetValue().buf() == rows[i].buf());
+        iter->Next();
+    }
+    ASSERT_FALSE(iter->Valid());
+    segment = partition_handler->GetSegment("group2");
+    iter = segment->GetIterator();
+    iter->SeekToFirst();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_TRUE(iter->GetValue().buf() == rows[3].buf());
+}
+
 TEST_F(MemCataLogTest, mem_row_handler_test) {
     std::vector<Row> rows;
     ::hybridse::type::TableDef table;
@@ -465,6 +499,92 @@ TEST_F(MemCataLogTest, mem_row_comcat_test) {
     }
 }
 
+TEST_F(MemCataLogTest, reduce_column_test) {
+    // more values than the lanes with a tail
+    std::vector<int32_t> values;
+    int64_t expect_sum = 0;
+    for (int32_t i = 0; i < 37; i++) {
+        int32_t v = (i * 7) % 23 - 11;
+        values.push_back(v);
+        expect_sum += v;
+    }
+    int32_t sum, min, max;
+    double fsum;
+    ReduceColumn<int32_t>(values.data(), values.size(), &sum, &fsum, &min, &max);
+    ASSERT_EQ(expect_sum, sum);
+    ASSERT_DOUBLE_EQ(static_cast<double>(expect_sum), fsum);
+    ASSERT_EQ(*std::min_element(values.begin(), values.end()), min);
+    ASSERT_EQ(*std::max_element(values.begin(), values.end()), max);
+
+    // the sum of int16 wraps around and the double sum doesn't
+    std::vector<int16_t> shorts(4, 20000);
+    int16_t short_sum, short_min, short_max;
+    ReduceColumn<int16_t>(shorts.data(), shorts.size(), &short_sum, &fsum, &short_min, &short_max);
+    ASSERT_EQ(static_cast<int16_t>(80000), short_sum);
+    ASSERT_DOUBLE_EQ(80000.0, fsum);
+
+    std::vector<double> doubles = {1.5, -2.5, 3.0};
+    double dsum, dmin, dmax;
+    ReduceColumn<double>(doubles.data(), doubles.size(), &dsum, &fsum, &dmin, &dmax);
+    ASSERT_DOUBLE_EQ(2.0, dsum);
+    ASSERT_DOUBLE_EQ(-2.5, dmin);
+    ASSERT_DOUBLE_EQ(3.0, dmax);
+}
+
+TEST_F(MemCataLogTest, sliding_column_agg_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    codec::RowView row_view(table.columns());
+    int32_t int_offset = row_view.GetPrimaryFieldOffset(1);
+    int32_t float_offset = row_view.GetPrimaryFieldOffset(3);
+
+    // the rows slide through a window of 3 rows, the instance row is popped every other row
+    CurrentHistoryWindow sliding(Window::kFrameRows, 0, 2, 0);
+    sliding.set_sliding_agg(true);
+    CurrentHistoryWindow full(Window::kFrameRows, 0, 2, 0);
+    codec::ListRef<Row> sliding_ref;
+    sliding_ref.list = reinterpret_cast<int8_t*>(&sliding);
+    codec::ListRef<Row> full_ref;
+    full_ref.list = reinterpret_cast<int8_t*>(&full);
+    uint64_t key = 0;
+    for (int round = 0; round < 4; round++) {
+        for (size_t i = 0; i < rows.size(); i++) {
+            ASSERT_TRUE(sliding.BufferData(key, rows[i]));
+            ASSERT_TRUE(full.BufferData(key, rows[i]));
+            key++;
+            int32_t sum, min, max, exp_sum, exp_min, exp_max;
+            double fsum, exp_fsum;
+            int64_t cnt, exp_cnt;
+            ColumnAgg<int32_t>(reinterpret_cast<int8_t*>(&sliding_ref), 0, 1, int_offset, &sum, &fsum, &cnt, &min,
+                               &max);
+            ColumnAgg<int32_t>(reinterpret_cast<int8_t*>(&full_ref), 0, 1, int_offset, &exp_sum, &exp_fsum, &exp_cnt,
+                               &exp_min, &exp_max);
+            ASSERT_EQ(exp_sum, sum);
+            ASSERT_DOUBLE_EQ(exp_fsum, fsum);
+            ASSERT_EQ(exp_cnt, cnt);
+            ASSERT_EQ(exp_min, min);
+            ASSERT_EQ(exp_max, max);
+
+            float fl_sum, fl_min, fl_max, exp_fl_sum, exp_fl_min, exp_fl_max;
+            ColumnAgg<float>(reinterpret_cast<int8_t*>(&sliding_ref), 0, 3, float_offset, &fl_sum, &fsum, &cnt,
+                             &fl_min, &fl_max);
+            ColumnAgg<float>(reinterpret_cast<int8_t*>(&full_ref), 0, 3, float_offset, &exp_fl_sum, &exp_fsum,
+                             &exp_cnt, &exp_fl_min, &exp_fl_max);
+            ASSERT_FLOAT_EQ(exp_fl_sum, fl_sum);
+            ASSERT_DOUBLE_EQ(exp_fsum, fsum);
+            ASSERT_EQ(exp_cnt, cnt);
+            ASSERT_FLOAT_EQ(exp_fl_min, fl_min);
+            ASSERT_FLOAT_EQ(exp_fl_max, fl_max);
+
+            if (i % 2 == 1) {
+                sliding.PopFrontData();
+                full.PopFrontData();
+            }
+        }
+    }
+}
+
 }  // namespace vm
 }  // namespace hybridse
 int main(int argc, char** argv) {
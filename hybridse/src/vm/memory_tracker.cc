@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/memory_tracker.h"
+
+namespace hybridse {
+namespace vm {
+
+MemoryTracker::MemoryTracker(uint64_t limit, MemoryTracker* parent)
+    : limit_(limit), parent_(parent), used_(0), peak_(0) {}
+
+MemoryTracker::~MemoryTracker() {
+    if (parent_ != nullptr) {
+        parent_->Release(GetUsed());
+    }
+}
+
+bool MemoryTracker::Consume(uint64_t bytes) {
+    uint64_t used = used_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (limit_ > 0 && used > limit_) {
+        used_.fetch_sub(bytes, std::memory_order_relaxed);
+        return false;
+    }
+    if (parent_ != nullptr && !parent_->Consume(bytes)) {
+        used_.fetch_sub(bytes, std::memory_order_relaxed);
+        return false;
+    }
+    uint64_t peak = peak_.load(std::memory_order_relaxed);
+    while (used > peak && !peak_.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+void MemoryTracker::Release(uint64_t bytes) {
+    used_.fetch_sub(bytes, std::memory_order_relaxed);
+    if (parent_ != nullptr) {
+        parent_->Release(bytes);
+    }
+}
+
+}  // namespace vm
+}  // namespace hybridse
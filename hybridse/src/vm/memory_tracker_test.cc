@@ -0,0 +1,65 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/memory_tracker.h"
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+
+class MemoryTrackerTest : public ::testing::Test {};
+
+TEST_F(MemoryTrackerTest, Limit) {
+    MemoryTracker tracker(100);
+    ASSERT_TRUE(tracker.Consume(60));
+    ASSERT_FALSE(tracker.Consume(50));
+    ASSERT_EQ(60u, tracker.GetUsed());
+    ASSERT_TRUE(tracker.Consume(40));
+    tracker.Release(80);
+    ASSERT_EQ(20u, tracker.GetUsed());
+    ASSERT_EQ(100u, tracker.GetPeak());
+
+    MemoryTracker unlimited;
+    ASSERT_TRUE(unlimited.Consume(UINT64_MAX / 2));
+}
+
+TEST_F(MemoryTrackerTest, Parent) {
+    MemoryTracker total(100);
+    {
+        MemoryTracker query1(80, &total);
+        MemoryTracker query2(80, &total);
+        ASSERT_TRUE(query1.Consume(70));
+        // query2 is within its own limit but the total is passed
+        ASSERT_FALSE(query2.Consume(40));
+        ASSERT_EQ(0u, query2.GetUsed());
+        ASSERT_TRUE(query2.Consume(30));
+        ASSERT_EQ(100u, total.GetUsed());
+        ASSERT_FALSE(query1.Consume(20));
+        ASSERT_EQ(70u, query1.GetUsed());
+    }
+    // the bytes of the queries are returned with them
+    ASSERT_EQ(0u, total.GetUsed());
+    ASSERT_EQ(100u, total.GetPeak());
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/merge_iterator.h"
+
+#include <utility>
+
+namespace hybridse {
+namespace vm {
+
+MergeRowIterator::MergeRowIterator(std::vector<std::unique_ptr<RowIterator>> iters)
+    : iters_(std::move(iters)), heap_() {
+    Rebuild();
+}
+
+bool MergeRowIterator::Before(size_t a, size_t b) const {
+    uint64_t key_a = iters_[a]->GetKey();
+    uint64_t key_b = iters_[b]->GetKey();
+    if (key_a != key_b) {
+        return key_a > key_b;
+    }
+    return a < b;
+}
+
+void MergeRowIterator::SiftDown(size_t pos) {
+    size_t size = heap_.size();
+    while (true) {
+        size_t first = pos;
+        size_t left = 2 * pos + 1;
+        size_t right = left + 1;
+        if (left < size && Before(heap_[left], heap_[first])) {
+            first = left;
+        }
+        if (right < size && Before(heap_[right], heap_[first])) {
+            first = right;
+        }
+        if (first == pos) {
+            return;
+        }
+        std::swap(heap_[pos], heap_[first]);
+        pos = first;
+    }
+}
+
+void MergeRowIterator::Rebuild() {
+    heap_.clear();
+    for (size_t i = 0; i < iters_.size(); i++) {
+        if (iters_[i] && iters_[i]->Valid()) {
+            heap_.push_back(i);
+        }
+    }
+    for (size_t pos = heap_.size() / 2; pos > 0; pos--) {
+        SiftDown(pos - 1);
+    }
+}
+
+void MergeRowIterator::Next() {
+    if (heap_.empty()) {
+        return;
+    }
+    auto& top = iters_[heap_.front()];
+    top->Next();
+    if (!top->Valid()) {
+        heap_.front() = heap_.back();
+        heap_.pop_back();
+    }
+    if (!heap_.empty()) {
+        SiftDown(0);
+    }
+}
+
+void MergeRowIterator::Seek(const uint64_t& key) {
+    for (auto& iter : iters_) {
+        if (iter) {
+            iter->Seek(key);
+        }
+    }
+    Rebuild();
+}
+
+void MergeRowIterator::SeekToFirst() {
+    for (auto& iter : iters_) {
+        if (iter) {
+            iter->SeekToFirst();
+        }
+    }
+    Rebuild();
+}
+
+bool MergeRowIterator::IsSeekable() const {
+    for (const auto& iter : iters_) {
+        if (iter && !iter->IsSeekable()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/merge_iterator.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "vm/mem_catalog.h"
+
+namespace hybridse {
+namespace vm {
+
+class MergeIteratorTest : public ::testing::Test {};
+
+static std::vector<std::pair<uint64_t, std::string>> ReadAll(RowIterator* iter) {
+    std::vector<std::pair<uint64_t, std::string>> rows;
+    while (iter->Valid()) {
+        rows.emplace_back(iter->GetKey(), iter->GetValue().ToString());
+        iter->Next();
+    }
+    return rows;
+}
+
+TEST_F(MergeIteratorTest, Merge) {
+    std::vector<std::vector<uint64_t>> keys = {{9, 5, 5, 1}, {}, {8, 5, 2}, {10}};
+    std::vector<MemTimeTableHandler> tables(keys.size());
+    std::vector<std::unique_ptr<RowIterator>> iters;
+    for (size_t i = 0; i < keys.size(); i++) {
+        for (size_t j = 0; j < keys[i].size(); j++) {
+            tables[i].AddRow(keys[i][j], codec::Row("t" + std::to_string(i) + "r" + std::to_string(j)));
+        }
+        iters.push_back(tables[i].GetIterator());
+    }
+    iters.emplace_back();
+    MergeRowIterator merge(std::move(iters));
+    ASSERT_TRUE(merge.IsSeekable());
+    // the rows of equal keys keep the order of the iterators
+    std::vector<std::pair<uint64_t, std::string>> expect = {
+        {10, "t3r0"}, {9, "t0r0"}, {8, "t2r0"}, {5, "t0r1"}, {5, "t0r2"}, {5, "t2r1"}, {2, "t2r2"}, {1, "t0r3"}};
+    ASSERT_EQ(expect, ReadAll(&merge));
+
+    merge.SeekToFirst();
+    ASSERT_EQ(expect, ReadAll(&merge));
+
+    merge.Seek(6);
+    std::vector<std::pair<uint64_t, std::string>> expect_seek(expect.begin() + 3, expect.end());
+    ASSERT_EQ(expect_seek, ReadAll(&merge));
+
+    merge.Seek(0);
+    ASSERT_FALSE(merge.Valid());
+}
+
+TEST_F(MergeIteratorTest, Empty) {
+    MergeRowIterator merge({});
+    ASSERT_FALSE(merge.Valid());
+    merge.Next();
+    ASSERT_FALSE(merge.Valid());
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -16,6 +16,7 @@
 
 #include "vm/physical_op.h"
 
+#include <algorithm>
 #include <set>
 
 #include "absl/container/flat_hash_map.h"
@@ -702,6 +703,7 @@ Status Range::ReplaceExpr(const passes::ExprReplacer& replacer, node::NodeManage
     CHECK_STATUS(replacer.Replace(origin_key, &new_key));
     out->range_key_ = new_key;
     out->frame_ = frame_;
+    out->rows_bound_ = rows_bound_;
     return Status::OK();
 }
 
@@ -1276,7 +1278,8 @@ void PhysicalRequestAggUnionNode::Print(std::ostream& output, const std::string&
 }
 
 void PhysicalRequestAggUnionNode::PrintChildren(std::ostream& output, const std::string& tab) const {
-    if (3 != producers_.size() || nullptr == producers_[0] || nullptr == producers_[1] || nullptr == producers_[2]) {
+    if (producers_.size() < 3 ||
+        std::any_of(producers_.begin(), producers_.end(), [](const PhysicalOpNode* p) { return nullptr == p; })) {
         LOG(WARNING) << "fail to print PhysicalRequestAggUnionNode children";
         return;
     }
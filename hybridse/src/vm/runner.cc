@@ -16,8 +16,14 @@
 
 #include "vm/runner.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <functional>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -28,6 +34,7 @@
 #include "vm/core_api.h"
 #include "vm/jit_runtime.h"
 #include "vm/mem_catalog.h"
+#include "vm/spill_table.h"
 
 DECLARE_bool(enable_spark_unsaferow_format);
 
@@ -36,6 +43,242 @@ namespace vm {
 #define MAX_DEBUG_BATCH_SiZE 5
 #define MAX_DEBUG_LINES_CNT 20
 #define MAX_DEBUG_COLUMN_MAX 20
+#define PROJECT_MORSEL_SIZE 1024
+// the rows the runners handle between two checks of the deadline
+#define CANCEL_CHECK_INTERVAL 1024
+// the rows of the right table hashed by one task of the hash last join
+#define HASH_JOIN_MORSEL_SIZE 1024
+// the rows of a table whose partition keys are generated by one task of a parallel partition
+#define PARTITION_MORSEL_SIZE 1024
+
+// Run task(0) ... task(cnt - 1) on at most parallelism threads including the calling one. The workers take
+// the next task once the current one is done, so a slow segment doesn't hold the others. The tasks write to
+// their own output slot and the caller merges the slots in order after it returns.
+static void ParallelRun(uint32_t parallelism, size_t cnt, const std::function<void(size_t)>& task) {
+    size_t thread_cnt = std::min(static_cast<size_t>(parallelism), cnt);
+    if (thread_cnt <= 1) {
+        for (size_t i = 0; i < cnt; i++) {
+            task(i);
+        }
+        return;
+    }
+    std::atomic<size_t> next(0);
+    auto worker = [&next, cnt, &task]() {
+        size_t i = next.fetch_add(1, std::memory_order_relaxed);
+        while (i < cnt) {
+            task(i);
+            i = next.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < thread_cnt; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Resolve the columns of the input table read by a simple project of plain
+// columns, such as the one created by WindowColumnPruning. Return false if
+// the input is not a table or a project is not a column of it.
+static bool ResolveSourceColumns(const PhysicalSimpleProjectNode* op,
+                                 std::vector<size_t>* columns) {
+    auto input = op->GetProducer(0);
+    if (input->GetOpType() != kPhysicalOpDataProvider ||
+        dynamic_cast<const PhysicalDataProviderNode*>(input)->provider_type_ !=
+            kProviderTypeTable) {
+        return false;
+    }
+    auto schemas_ctx = input->schemas_ctx();
+    const auto& projects = op->project();
+    for (size_t i = 0; i < projects.size(); ++i) {
+        auto expr = projects.GetExpr(i);
+        size_t schema_idx = 0;
+        size_t col_idx = 0;
+        Status status;
+        if (expr->GetExprType() == node::kExprColumnId) {
+            status = schemas_ctx->ResolveColumnIndexByID(
+                dynamic_cast<const node::ColumnIdNode*>(expr)->GetColumnID(),
+                &schema_idx, &col_idx);
+        } else if (expr->GetExprType() == node::kExprColumnRef) {
+            status = schemas_ctx->ResolveColumnRefIndex(
+                dynamic_cast<const node::ColumnRefNode*>(expr), &schema_idx,
+                &col_idx);
+        } else {
+            return false;
+        }
+        if (!status.isOK() || schema_idx != 0) {
+            return false;
+        }
+        columns->push_back(col_idx);
+    }
+    return !columns->empty();
+}
+
+// Convert `column op constant` to a predicate of the column at col_idx,
+// return false if the storage can't check it exactly like the condition
+static bool MakeColumnPredicate(node::FnOperator fn_op, size_t col_idx,
+                                type::Type col_type,
+                                const node::ConstNode* value,
+                                ColumnPredicate* predicate) {
+    switch (fn_op) {
+        case node::kFnOpEq:
+            predicate->op = ColumnPredicate::kEq;
+            break;
+        case node::kFnOpNeq:
+            predicate->op = ColumnPredicate::kNe;
+            break;
+        case node::kFnOpLt:
+            predicate->op = ColumnPredicate::kLt;
+            break;
+        case node::kFnOpLe:
+            predicate->op = ColumnPredicate::kLe;
+            break;
+        case node::kFnOpGt:
+            predicate->op = ColumnPredicate::kGt;
+            break;
+        case node::kFnOpGe:
+            predicate->op = ColumnPredicate::kGe;
+            break;
+        default:
+            return false;
+    }
+    predicate->col_idx = col_idx;
+    bool int_value = value->GetDataType() == node::kInt16 ||
+                     value->GetDataType() == node::kInt32 ||
+                     value->GetDataType() == node::kInt64;
+    bool float_value = value->GetDataType() == node::kFloat ||
+                       value->GetDataType() == node::kDouble;
+    switch (col_type) {
+        case type::kInt16:
+        case type::kInt32:
+        case type::kInt64:
+            // an integer is casted to a float number against a float number
+            if (!int_value) {
+                return false;
+            }
+            predicate->value_type = ColumnPredicate::kIntValue;
+            predicate->int_value = value->GetAsInt64();
+            return true;
+        case type::kDouble:
+            if (!int_value && !float_value) {
+                return false;
+            }
+            predicate->value_type = ColumnPredicate::kDoubleValue;
+            predicate->double_value = value->GetAsDouble();
+            return true;
+        case type::kFloat:
+            // an integer constant is casted to float against a float column
+            if (!float_value) {
+                return false;
+            }
+            predicate->value_type = ColumnPredicate::kDoubleValue;
+            predicate->double_value = value->GetAsDouble();
+            return true;
+        case type::kVarchar:
+            if (value->GetDataType() != node::kVarchar) {
+                return false;
+            }
+            predicate->value_type = ColumnPredicate::kStringValue;
+            predicate->str_value = value->GetStr();
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Collect the `column op constant` conjuncts of the condition of a filter on
+// a table or partition, which are checked by the storage before the rows are
+// handed out. The other conjuncts are left to the condition only.
+static bool ExtractPushdownPredicates(const PhysicalFilterNode* op,
+                                      std::vector<ColumnPredicate>* out) {
+    auto input = op->GetProducer(0);
+    if (input->GetOpType() != kPhysicalOpDataProvider ||
+        !op->filter_.condition_.ValidCondition()) {
+        return false;
+    }
+    auto provider_type =
+        dynamic_cast<const PhysicalDataProviderNode*>(input)->provider_type_;
+    if (provider_type != kProviderTypeTable &&
+        provider_type != kProviderTypePartition) {
+        return false;
+    }
+    auto schemas_ctx = input->schemas_ctx();
+    std::vector<const node::ExprNode*> conjuncts = {
+        op->filter_.condition_.condition()};
+    while (!conjuncts.empty()) {
+        auto expr = conjuncts.back();
+        conjuncts.pop_back();
+        if (expr->GetExprType() != node::kExprBinary) {
+            continue;
+        }
+        auto binary = dynamic_cast<const node::BinaryExpr*>(expr);
+        if (binary->GetOp() == node::kFnOpAnd) {
+            conjuncts.push_back(binary->GetChild(0));
+            conjuncts.push_back(binary->GetChild(1));
+            continue;
+        }
+        auto lhs = binary->GetChild(0);
+        auto rhs = binary->GetChild(1);
+        auto fn_op = binary->GetOp();
+        if (lhs->GetExprType() == node::kExprPrimary) {
+            // `constant op column` is `column reversed_op constant`
+            std::swap(lhs, rhs);
+            switch (fn_op) {
+                case node::kFnOpLt:
+                    fn_op = node::kFnOpGt;
+                    break;
+                case node::kFnOpLe:
+                    fn_op = node::kFnOpGe;
+                    break;
+                case node::kFnOpGt:
+                    fn_op = node::kFnOpLt;
+                    break;
+                case node::kFnOpGe:
+                    fn_op = node::kFnOpLe;
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (rhs->GetExprType() != node::kExprPrimary) {
+            continue;
+        }
+        auto value = dynamic_cast<const node::ConstNode*>(rhs);
+        if (value->IsNull() || value->IsPlaceholder()) {
+            continue;
+        }
+        size_t schema_idx = 0;
+        size_t col_idx = 0;
+        Status status;
+        if (lhs->GetExprType() == node::kExprColumnId) {
+            status = schemas_ctx->ResolveColumnIndexByID(
+                dynamic_cast<const node::ColumnIdNode*>(lhs)->GetColumnID(),
+                &schema_idx, &col_idx);
+        } else if (lhs->GetExprType() == node::kExprColumnRef) {
+            status = schemas_ctx->ResolveColumnRefIndex(
+                dynamic_cast<const node::ColumnRefNode*>(lhs), &schema_idx,
+                &col_idx);
+        } else {
+            continue;
+        }
+        if (!status.isOK() || schema_idx != 0) {
+            continue;
+        }
+        auto schema = schemas_ctx->GetSchema(schema_idx);
+        if (schema == nullptr || col_idx >= static_cast<size_t>(schema->size())) {
+            continue;
+        }
+        ColumnPredicate predicate;
+        if (MakeColumnPredicate(fn_op, col_idx, schema->Get(col_idx).type(),
+                                value, &predicate)) {
+            out->push_back(predicate);
+        }
+    }
+    return !out->empty();
+}
 
 // Build Runner for each physical node
 // return cluster task of given runner
@@ -153,6 +396,10 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                 CreateRunner<SimpleProjectRunner>(
                     &runner, id_++, node->schemas_ctx(), op->GetLimitCnt(),
                     op->project().fn_info());
+                std::vector<size_t> source_columns;
+                if (ResolveSourceColumns(op, &source_columns)) {
+                    runner->SetSourceColumns(source_columns);
+                }
                 return RegisterTask(node,
                                     UnaryInheritTask(cluster_task, runner));
             }
@@ -311,6 +558,40 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                 &runner, id_++, node->schemas_ctx(), op->GetLimitCnt(),
                 op->window().range_, op->exclude_current_time(),
                 op->output_request_row());
+            std::ostringstream signature;
+            signature << cluster_job_.db() << "\n";
+            node->Print(signature, "");
+            signature << "\nrows_bound=" << op->window().range_.rows_bound();
+            runner->SetWindowSignature(signature.str());
+            // the windows of different frames on the same inputs, key and order share the scan
+            std::ostringstream scan_signature;
+            scan_signature << cluster_job_.db() << "\n"
+                           << op->output_request_row() << op->exclude_current_time() << op->instance_not_in_window()
+                           << "\nrange_key=" << node::ExprString(op->window().range_.range_key());
+            auto print_window = [&scan_signature](const RequestWindowOp& window) {
+                scan_signature << "\npartition_" << window.partition_.ToString() << ", " << window.sort_.ToString()
+                               << ", index_" << window.index_key_.ToString();
+            };
+            print_window(op->window());
+            for (auto window_union : op->window_unions_.window_unions_) {
+                print_window(window_union.second);
+            }
+            for (auto producer : node->producers()) {
+                scan_signature << "\n";
+                producer->Print(scan_signature, "");
+            }
+            for (auto window_union : op->window_unions_.window_unions_) {
+                scan_signature << "\n";
+                window_union.first->Print(scan_signature, "");
+            }
+            auto scan_iter = scan_runners_.find(scan_signature.str());
+            if (scan_iter == scan_runners_.end()) {
+                scan_runners_.emplace(scan_signature.str(), runner);
+            } else {
+                // only the nested windows keep the scans in the context
+                scan_iter->second->SetScanSignature(scan_signature.str());
+                runner->SetScanSignature(scan_signature.str());
+            }
             Key index_key;
             if (!op->instance_not_in_window()) {
                 runner->AddWindowUnion(op->window_, right);
@@ -490,6 +771,10 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
             FilterRunner* runner = nullptr;
             CreateRunner<FilterRunner>(&runner, id_++, node->schemas_ctx(),
                                        op->GetLimitCnt(), op->filter_);
+            std::vector<ColumnPredicate> predicates;
+            if (ExtractPushdownPredicates(op, &predicates)) {
+                runner->filter_gen_.SetPushdownPredicates(predicates);
+            }
             return RegisterTask(node, UnaryInheritTask(cluster_task, runner));
         }
         case kPhysicalOpLimit: {
@@ -562,28 +847,39 @@ ClusterTask RunnerBuilder::BuildRequestAggUnionTask(PhysicalOpNode* node, Status
         LOG(WARNING) << status;
         return fail;
     }
-    auto agg_table_task = Build(node->producers().at(2), status);
-    auto agg_table = agg_table_task.GetRoot();
-    if (!agg_table_task.IsValid()) {
-        status.msg = "fail to build agg_table input runner";
-        status.code = common::kExecutionPlanError;
-        LOG(WARNING) << status;
-        return fail;
+    // the pre-aggr tables from the finest bucket level to the coarsest
+    std::vector<ClusterTask> agg_table_tasks;
+    for (size_t i = 2; i < node->producers().size(); i++) {
+        auto agg_table_task = Build(node->producers().at(i), status);
+        if (!agg_table_task.IsValid()) {
+            status.msg = "fail to build agg_table input runner";
+            status.code = common::kExecutionPlanError;
+            LOG(WARNING) << status;
+            return fail;
+        }
+        agg_table_tasks.push_back(agg_table_task);
     }
     auto op = dynamic_cast<const PhysicalRequestAggUnionNode*>(node);
     RequestAggUnionRunner* runner = nullptr;
     CreateRunner<RequestAggUnionRunner>(
         &runner, id_++, node->schemas_ctx(), op->GetLimitCnt(),
         op->window().range_, op->exclude_current_time(),
-        op->output_request_row(), op->func_, op->agg_col_);
+        op->output_request_row(), op->func_, op->agg_col_, op->cond_);
     Key index_key;
     if (!op->instance_not_in_window()) {
         index_key = op->window_.index_key();
         runner->AddWindowUnion(op->window_, base_table);
-        runner->AddWindowUnion(op->agg_window_, agg_table);
+        runner->AddWindowUnion(op->agg_window_, agg_table_tasks[0].GetRoot());
+        size_t level = 1;
+        for (const auto& agg_window : op->level_agg_windows_) {
+            runner->AddWindowUnion(agg_window, agg_table_tasks[level++].GetRoot());
+        }
+    }
+    std::vector<const ClusterTask*> children = {&request_task, &base_table_task};
+    for (const auto& agg_table_task : agg_table_tasks) {
+        children.push_back(&agg_table_task);
     }
-    auto task = RegisterTask(node, MultipleInherit({&request_task, &base_table_task, &agg_table_task}, runner,
-                                                   index_key, kRightBias));
+    auto task = RegisterTask(node, MultipleInherit(children, runner, index_key, kRightBias));
     if (!runner->InitAggregator()) {
         return fail;
     } else {
@@ -1107,12 +1403,22 @@ std::shared_ptr<DataHandlerList> Runner::BatchRequestRun(RunnerContext& ctx) {
         batch_inputs[idx - 1] = producers_[idx - 1]->BatchRequestRun(ctx);
     }
 
+    // the requests whose inputs are the same handlers, e.g. the identical requests or the ones sharing a window,
+    // are run once. the inputs are kept as the keys so their addresses are not reused meanwhile
+    std::map<std::vector<std::shared_ptr<DataHandler>>, std::shared_ptr<DataHandler>> outputs_of_inputs;
     for (size_t idx = 0; idx < ctx.GetRequestSize(); idx++) {
         inputs.clear();
         for (size_t producer_idx = 0; producer_idx < producers_.size();
              producer_idx++) {
             inputs.push_back(batch_inputs[producer_idx]->Get(idx));
         }
+        if (!need_batch_cache_ && !inputs.empty()) {
+            auto iter = outputs_of_inputs.find(inputs);
+            if (iter != outputs_of_inputs.end()) {
+                outputs->Add(iter->second);
+                continue;
+            }
+        }
         auto res = Run(ctx, inputs);
         if (need_batch_cache_) {
             if (ctx.is_debug()) {
@@ -1130,6 +1436,9 @@ std::shared_ptr<DataHandlerList> Runner::BatchRequestRun(RunnerContext& ctx) {
             }
             return repeated_data;
         }
+        if (!inputs.empty()) {
+            outputs_of_inputs.emplace(inputs, res);
+        }
         outputs->Add(res);
     }
     if (ctx.is_debug()) {
@@ -1150,6 +1459,91 @@ std::shared_ptr<DataHandlerList> Runner::BatchRequestRun(RunnerContext& ctx) {
     }
     return outputs;
 }
+// return the rows of the data and add their bytes to `bytes`, a partition counts its segments. only the rows and
+// the tables materialized by the runners are counted, the lazy tables and partitions over the storage count none,
+// as iterating them would walk the whole index on every profiled run
+static uint64_t CountRows(const std::shared_ptr<DataHandler>& data, uint64_t* bytes) {
+    if (!data) {
+        return 0;
+    }
+    auto add_bytes = [bytes](const Row& row) {
+        for (int32_t i = 0; i < row.GetRowPtrCnt(); i++) {
+            *bytes += row.size(i);
+        }
+    };
+    switch (data->GetHanlderType()) {
+        case kRowHandler: {
+            auto row_handler = std::dynamic_pointer_cast<RowHandler>(data);
+            if (!row_handler) {
+                return 0;
+            }
+            add_bytes(row_handler->GetValue());
+            return 1;
+        }
+        case kTableHandler: {
+            if (!std::dynamic_pointer_cast<MemTableHandler>(data) &&
+                !std::dynamic_pointer_cast<MemTimeTableHandler>(data)) {
+                return 0;
+            }
+            auto iter = std::dynamic_pointer_cast<TableHandler>(data)->GetIterator();
+            if (!iter) {
+                return 0;
+            }
+            uint64_t cnt = 0;
+            for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+                add_bytes(iter->GetValue());
+                cnt++;
+            }
+            return cnt;
+        }
+        case kPartitionHandler: {
+            auto partition = std::dynamic_pointer_cast<MemPartitionHandler>(data);
+            auto iter = partition ? partition->GetWindowIterator() : nullptr;
+            if (!iter) {
+                return 0;
+            }
+            uint64_t cnt = 0;
+            for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+                cnt++;
+            }
+            return cnt;
+        }
+        default:
+            return 0;
+    }
+}
+
+// the bytes of the rows materialized in the output of a runner, the lazy outputs wrapping their inputs hold none
+static uint64_t MaterializedBytes(const std::shared_ptr<DataHandler>& output) {
+    uint64_t bytes = 0;
+    if (std::dynamic_pointer_cast<MemTableHandler>(output) || std::dynamic_pointer_cast<MemTimeTableHandler>(output)) {
+        CountRows(output, &bytes);
+    } else if (auto partition = std::dynamic_pointer_cast<MemPartitionHandler>(output)) {
+        auto iter = partition->GetWindowIterator();
+        for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+            auto segment = iter->GetValue();
+            if (!segment) {
+                continue;
+            }
+            for (segment->SeekToFirst(); segment->Valid(); segment->Next()) {
+                const Row& row = segment->GetValue();
+                for (int32_t i = 0; i < row.GetRowPtrCnt(); i++) {
+                    bytes += row.size(i);
+                }
+            }
+        }
+    }
+    return bytes;
+}
+
+// charge the output of a runner and the managed buffers its udfs allocated on the calling thread to the query,
+// return false if the query passes its memory limit
+static bool ChargeMemory(RunnerContext& ctx, const std::shared_ptr<DataHandler>& output, size_t managed_bytes) {
+    size_t managed_now = JitRuntime::get()->GetManagedBytes();
+    uint64_t bytes = MaterializedBytes(output) + (managed_now > managed_bytes ? managed_now - managed_bytes : 0);
+    return bytes == 0 || ctx.ConsumeMemory(bytes);
+}
+
 std::shared_ptr<DataHandler> Runner::RunWithCache(RunnerContext& ctx) {
     if (need_cache_) {
         auto cached = ctx.GetCache(id_);
@@ -1158,12 +1552,49 @@ std::shared_ptr<DataHandler> Runner::RunWithCache(RunnerContext& ctx) {
             return cached;
         }
     }
+    if (ctx.IsCancelled()) {
+        return std::shared_ptr<DataHandler>();
+    }
     std::vector<std::shared_ptr<DataHandler>> inputs(producers_.size());
-    for (size_t idx = producers_.size(); idx > 0; idx--) {
-        inputs[idx - 1] = producers_[idx - 1]->RunWithCache(ctx);
+    // the branches under a concat, e.g. the windows of a deployment, don't depend on each other
+    if (ctx.runner_pool() != nullptr && kRunnerConcat == type_ && producers_.size() > 1) {
+        std::vector<std::function<void()>> tasks;
+        for (size_t idx = 0; idx < producers_.size(); idx++) {
+            tasks.push_back([this, idx, &ctx, &inputs]() { inputs[idx] = producers_[idx]->RunWithCache(ctx); });
+        }
+        ctx.runner_pool()->Run(tasks);
+    } else {
+        for (size_t idx = producers_.size(); idx > 0; idx--) {
+            inputs[idx - 1] = producers_[idx - 1]->RunWithCache(ctx);
+        }
     }
 
+    size_t managed_bytes = ctx.IsMemoryTracked() ? JitRuntime::get()->GetManagedBytes() : 0;
+    if (ctx.profile() != nullptr) {
+        auto start = std::chrono::steady_clock::now();
+        auto res = Run(ctx, inputs);
+        if (ctx.IsMemoryTracked() && !ChargeMemory(ctx, res, managed_bytes)) {
+            return std::shared_ptr<DataHandler>();
+        }
+        uint64_t time_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        uint64_t rows_in = 0;
+        uint64_t bytes = 0;
+        for (const auto& input : inputs) {
+            rows_in += CountRows(input, &bytes);
+        }
+        bytes = 0;
+        uint64_t rows_out = CountRows(res, &bytes);
+        ctx.profile()->Add(id_, RunnerTypeName(type_), time_us, rows_in, rows_out, bytes);
+        if (need_cache_) {
+            ctx.SetCache(id_, res);
+        }
+        return res;
+    }
     auto res = Run(ctx, inputs);
+    if (ctx.IsMemoryTracked() && !ChargeMemory(ctx, res, managed_bytes)) {
+        return std::shared_ptr<DataHandler>();
+    }
     if (ctx.is_debug()) {
         std::ostringstream oss;
         oss << "RUNNER TYPE: " << RunnerTypeName(type_) << ", ID: " << id_ << "\n";
@@ -1220,9 +1651,15 @@ std::shared_ptr<DataHandlerList> RequestRunner::BatchRequestRun(
     }
     std::shared_ptr<DataHandlerVector> res =
         std::shared_ptr<DataHandlerVector>(new DataHandlerVector());
+    // the identical requests share one handler, so the runners taking them run once for all of them
+    std::unordered_map<std::string, std::shared_ptr<DataHandler>> requests;
     for (size_t idx = 0; idx < ctx.GetRequestSize(); idx++) {
-        res->Add(std::shared_ptr<MemRowHandler>(
-            new MemRowHandler(ctx.GetRequest(idx))));
+        const Row& request = ctx.GetRequest(idx);
+        auto& handler = requests[RequestWindowCache::GetKey("", request)];
+        if (!handler) {
+            handler = std::make_shared<MemRowHandler>(request);
+        }
+        res->Add(handler);
     }
 
     if (ctx.is_debug()) {
@@ -1256,7 +1693,7 @@ std::shared_ptr<DataHandler> GroupRunner::Run(
         LOG(WARNING) << "input is empty";
         return fail_ptr;
     }
-    return partition_gen_.Partition(input, ctx.GetParameterRow());
+    return partition_gen_.Partition(input, ctx.GetParameterRow(), ctx.GetParallelism());
 }
 std::shared_ptr<DataHandler> SortRunner::Run(
     RunnerContext& ctx,
@@ -1271,6 +1708,12 @@ std::shared_ptr<DataHandler> SortRunner::Run(
         LOG(WARNING) << "input is empty";
         return fail_ptr;
     }
+    if (ctx.GetSortMemoryLimit() > 0 && kTableHandler == input->GetHanlderType() &&
+        sort_gen_.order_gen().Valid()) {
+        auto output = sort_gen_.ExternalSort(std::dynamic_pointer_cast<TableHandler>(input),
+                                             ctx.GetSortMemoryLimit(), ctx.GetSpillDir());
+        return output ? output : fail_ptr;
+    }
     return sort_gen_.Sort(input);
 }
 
@@ -1305,10 +1748,60 @@ std::shared_ptr<DataHandler> TableProjectRunner::Run(
     auto& parameter = ctx.GetParameterRow();
     iter->SeekToFirst();
     int32_t cnt = 0;
+    if (ctx.GetParallelism() > 1) {
+        // the input rows are read in order and projected in morsels across the threads
+        std::vector<Row> rows;
+        while (iter->Valid()) {
+            if (limit_cnt_ > 0 && cnt++ >= limit_cnt_) {
+                break;
+            }
+            rows.push_back(iter->GetValue());
+            iter->Next();
+        }
+        std::vector<Row> outputs(rows.size());
+        size_t morsel_cnt = (rows.size() + PROJECT_MORSEL_SIZE - 1) / PROJECT_MORSEL_SIZE;
+        ParallelRun(ctx.GetParallelism(), morsel_cnt, [&](size_t morsel) {
+            size_t begin = morsel * PROJECT_MORSEL_SIZE;
+            size_t end = std::min(rows.size(), begin + PROJECT_MORSEL_SIZE);
+            project_gen_.Gen(rows.data() + begin, end - begin, parameter, outputs.data() + begin);
+        });
+        for (const auto& row : outputs) {
+            output_table->AddRow(row);
+        }
+        return output_table;
+    }
+    if (project_gen_.HasBlockFn()) {
+        // the rows are projected by blocks of a morsel
+        std::vector<Row> rows;
+        std::vector<Row> outputs(PROJECT_MORSEL_SIZE);
+        rows.reserve(PROJECT_MORSEL_SIZE);
+        while (true) {
+            bool valid = iter->Valid() && !(limit_cnt_ > 0 && cnt++ >= limit_cnt_);
+            if (valid) {
+                rows.push_back(iter->GetValue());
+                iter->Next();
+            }
+            if (rows.size() == PROJECT_MORSEL_SIZE || (!valid && !rows.empty())) {
+                project_gen_.Gen(rows.data(), rows.size(), parameter, outputs.data());
+                for (size_t i = 0; i < rows.size(); i++) {
+                    output_table->AddRow(outputs[i]);
+                }
+                rows.clear();
+            }
+            if (!valid) {
+                break;
+            }
+        }
+        return output_table;
+    }
+    uint64_t rows = 0;
     while (iter->Valid()) {
         if (limit_cnt_ > 0 && cnt++ >= limit_cnt_) {
             break;
         }
+        if (++rows % CANCEL_CHECK_INTERVAL == 0 && ctx.IsCancelled()) {
+            return std::shared_ptr<DataHandler>();
+        }
         output_table->AddRow(project_gen_.Gen(iter->GetValue(), parameter));
         iter->Next();
     }
@@ -1345,8 +1838,9 @@ std::shared_ptr<DataHandler> SimpleProjectRunner::Run(
     switch (input->GetHanlderType()) {
         case kTableHandler: {
             return std::shared_ptr<TableHandler>(new TableProjectWrapper(
-                std::dynamic_pointer_cast<TableHandler>(input),
-                parameter, &project_gen_.fun_));
+                std::dynamic_pointer_cast<TableHandler>(input), parameter,
+                &project_gen_.fun_,
+                source_columns_.empty() ? nullptr : &source_columns_));
         }
         case kPartitionHandler: {
             return std::shared_ptr<TableHandler>(new PartitionProjectWrapper(
@@ -1427,7 +1921,7 @@ std::shared_ptr<DataHandler> WindowAggRunner::Run(
     auto& parameter = ctx.GetParameterRow();
     // Partition Instance Table
     auto instance_partition =
-        instance_window_gen_.partition_gen_.Partition(input, parameter);
+        instance_window_gen_.partition_gen_.Partition(input, parameter, ctx.GetParallelism());
     if (!instance_partition) {
         LOG(WARNING) << "Window Aggregation Fail: input partition is empty";
         return fail_ptr;
@@ -1448,9 +1942,35 @@ std::shared_ptr<DataHandler> WindowAggRunner::Run(
 
     // Compute output
     std::shared_ptr<MemTableHandler> output_table = std::make_shared<MemTableHandler>();
+    // the limit is counted on the rows of all keys, so the query with limit runs in one thread
+    if (ctx.GetParallelism() > 1 && limit_cnt_ <= 0) {
+        std::vector<std::string> keys;
+        while (instance_partition_iter->Valid()) {
+            keys.push_back(instance_partition_iter->GetKey().ToString());
+            instance_partition_iter->Next();
+        }
+        std::vector<std::shared_ptr<MemTableHandler>> key_outputs(keys.size());
+        ParallelRun(ctx.GetParallelism(), keys.size(), [&](size_t i) {
+            key_outputs[i] = std::make_shared<MemTableHandler>();
+            RunWindowAggOnKey(ctx, parameter, instance_partition, union_partitions, join_right_tables, keys[i],
+                              key_outputs[i]);
+        });
+        if (ctx.IsCancelled()) {
+            return fail_ptr;
+        }
+        for (const auto& key_output : key_outputs) {
+            for (uint64_t pos = 0; pos < key_output->GetCount(); pos++) {
+                output_table->AddRow(key_output->At(pos));
+            }
+        }
+        return output_table;
+    }
     while (instance_partition_iter->Valid()) {
+        if (ctx.IsCancelled()) {
+            return fail_ptr;
+        }
         auto key = instance_partition_iter->GetKey().ToString();
-        RunWindowAggOnKey(parameter, instance_partition, union_partitions,
+        RunWindowAggOnKey(ctx, parameter, instance_partition, union_partitions,
                           join_right_tables, key, output_table);
         instance_partition_iter->Next();
     }
@@ -1459,7 +1979,7 @@ std::shared_ptr<DataHandler> WindowAggRunner::Run(
 
 // Run Window Aggeregation on given key
 void WindowAggRunner::RunWindowAggOnKey(
-    const Row& parameter,
+    RunnerContext& ctx, const Row& parameter,
     std::shared_ptr<PartitionHandler> instance_partition,
     std::vector<std::shared_ptr<PartitionHandler>> union_partitions,
     std::vector<std::shared_ptr<DataHandler>> join_right_tables,
@@ -1515,11 +2035,19 @@ void WindowAggRunner::RunWindowAggOnKey(
     HistoryWindow window(instance_window_gen_.range_gen_.window_range_);
     window.set_instance_not_in_window(instance_not_in_window_);
     window.set_exclude_current_time(exclude_current_time_);
+    // the window slides through the rows of the key in order, the column aggregations
+    // retract the rows slid out instead of reducing the whole window per row
+    window.set_sliding_agg(true);
 
+    uint64_t rows = 0;
     while (instance_segment_iter->Valid()) {
         if (limit_cnt_ > 0 && cnt >= limit_cnt_) {
             break;
         }
+        // the rows of a large segment are checked as well, the caller drops the output once cancelled
+        if (++rows % CANCEL_CHECK_INTERVAL == 0 && ctx.IsCancelled()) {
+            return;
+        }
         const Row& instance_row = instance_segment_iter->GetValue();
         uint64_t instance_order = instance_segment_iter->GetKey();
         while (min_union_pos >= 0 &&
@@ -1606,6 +2134,19 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(RunnerContext& ctx,
 
     switch (left->GetHanlderType()) {
         case kTableHandler: {
+            auto left_table = std::dynamic_pointer_cast<TableHandler>(left);
+            auto output_table =
+                std::shared_ptr<MemTimeTableHandler>(new MemTimeTableHandler());
+            output_table->SetOrderType(left_table->GetOrderType());
+            // the right table without an index on the join key is hashed by the key instead of partitioned
+            if (kTableHandler == right->GetHanlderType() && join_gen_.right_group_gen_.Valid() &&
+                join_gen_.left_key_gen_.Valid() && !join_gen_.index_key_gen_.Valid()) {
+                if (!join_gen_.TableHashJoin(left_table, std::dynamic_pointer_cast<TableHandler>(right), parameter,
+                                             ctx.GetParallelism(), output_table)) {
+                    return fail_ptr;
+                }
+                return output_table;
+            }
             if (join_gen_.right_group_gen_.Valid()) {
                 right = join_gen_.right_group_gen_.Partition(right, parameter);
             }
@@ -1613,11 +2154,6 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(RunnerContext& ctx,
                 LOG(WARNING) << "fail to run last join: right partition is empty";
                 return fail_ptr;
             }
-            auto left_table = std::dynamic_pointer_cast<TableHandler>(left);
-
-            auto output_table =
-                std::shared_ptr<MemTimeTableHandler>(new MemTimeTableHandler());
-            output_table->SetOrderType(left_table->GetOrderType());
             if (kPartitionHandler == right->GetHanlderType()) {
                 if (!join_gen_.TableJoin(
                         left_table,
@@ -1681,14 +2217,14 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(RunnerContext& ctx,
 }
 
 std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
-    std::shared_ptr<DataHandler> input, const Row& parameter) {
+    std::shared_ptr<DataHandler> input, const Row& parameter, uint32_t parallelism) {
     switch (input->GetHanlderType()) {
         case kPartitionHandler: {
             return Partition(
                 std::dynamic_pointer_cast<PartitionHandler>(input), parameter);
         }
         case kTableHandler: {
-            return Partition(std::dynamic_pointer_cast<TableHandler>(input), parameter);
+            return Partition(std::dynamic_pointer_cast<TableHandler>(input), parameter, parallelism);
         }
         default: {
             LOG(WARNING) << "Partition Fail: input isn't partition or table";
@@ -1734,7 +2270,7 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
     return output_partitions;
 }
 std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
-    std::shared_ptr<TableHandler> table, const Row& parameter) {
+    std::shared_ptr<TableHandler> table, const Row& parameter, uint32_t parallelism) {
     auto fail_ptr = std::shared_ptr<PartitionHandler>();
     if (!key_gen_.Valid()) {
         return fail_ptr;
@@ -1755,6 +2291,11 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
         return fail_ptr;
     }
     iter->SeekToFirst();
+    if (parallelism > 1) {
+        PartitionParallel(iter.get(), parameter, parallelism, output_partitions.get());
+        output_partitions->SetOrderType(table->GetOrderType());
+        return output_partitions;
+    }
     while (iter->Valid()) {
         std::string keys = key_gen_.Gen(iter->GetValue(), parameter);
         output_partitions->AddRow(keys, iter->GetKey(), iter->GetValue());
@@ -1763,6 +2304,64 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
     output_partitions->SetOrderType(table->GetOrderType());
     return output_partitions;
 }
+void PartitionGenerator::PartitionParallel(RowIterator* iter, const Row& parameter, uint32_t parallelism,
+                                           MemPartitionHandler* output) {
+    std::vector<std::pair<uint64_t, Row>> rows;
+    while (iter->Valid()) {
+        rows.emplace_back(iter->GetKey(), iter->GetValue());
+        iter->Next();
+    }
+    // the keys of a morsel are generated and radix partitioned by their hash, one radix partition for a thread
+    size_t radix_cnt = parallelism;
+    size_t morsel_cnt = (rows.size() + PARTITION_MORSEL_SIZE - 1) / PARTITION_MORSEL_SIZE;
+    std::vector<std::string> keys(rows.size());
+    std::vector<std::vector<std::vector<size_t>>> morsel_radixes(morsel_cnt);
+    ParallelRun(parallelism, morsel_cnt, [&](size_t morsel) {
+        auto& radixes = morsel_radixes[morsel];
+        radixes.resize(radix_cnt);
+        size_t end = std::min(rows.size(), (morsel + 1) * PARTITION_MORSEL_SIZE);
+        for (size_t i = morsel * PARTITION_MORSEL_SIZE; i < end; i++) {
+            keys[i] = key_gen_.Gen(rows[i].second, parameter);
+            radixes[std::hash<std::string>()(keys[i]) % radix_cnt].push_back(i);
+        }
+    });
+    // a thread groups the rows of its radix partition morsel by morsel, so the rows of a key keep the table order
+    std::vector<std::unordered_map<std::string, MemTimeTable>> radix_groups(radix_cnt);
+    ParallelRun(parallelism, radix_cnt, [&](size_t radix) {
+        auto& groups = radix_groups[radix];
+        for (const auto& radixes : morsel_radixes) {
+            for (size_t i : radixes[radix]) {
+                groups[keys[i]].push_back(rows[i]);
+            }
+        }
+    });
+    for (auto& groups : radix_groups) {
+        for (auto& group : groups) {
+            output->AddSegment(group.first, std::move(group.second));
+        }
+    }
+}
+std::shared_ptr<TableHandler> SortGenerator::ExternalSort(std::shared_ptr<TableHandler> table,
+                                                         uint64_t memory_limit, const std::string& dir) {
+    if (!table || !is_valid_ || !order_gen_.Valid()) {
+        return table;
+    }
+    auto iter = table->GetIterator();
+    if (!iter) {
+        LOG(WARNING) << "Sort table fail: table is Empty";
+        return std::shared_ptr<TableHandler>();
+    }
+    ExternalSorter sorter(dir, memory_limit, table->GetSchema(), is_asc_);
+    iter->SeekToFirst();
+    while (iter->Valid()) {
+        if (!sorter.Add(static_cast<uint64_t>(order_gen_.Gen(iter->GetValue())), iter->GetValue())) {
+            LOG(WARNING) << "Sort table fail: fail to spill the sorted run to " << dir;
+            return std::shared_ptr<TableHandler>();
+        }
+        iter->Next();
+    }
+    return sorter.Finish();
+}
 std::shared_ptr<DataHandler> SortGenerator::Sort(
     std::shared_ptr<DataHandler> input, const bool reverse) {
     if (!input || !is_valid_ || !order_gen_.Valid()) {
@@ -1817,15 +2416,18 @@ std::shared_ptr<PartitionHandler> SortGenerator::Sort(
         auto key = iter->GetKey().ToString();
         segment_iter->SeekToFirst();
         while (segment_iter->Valid()) {
-            int64_t ts = order_gen_.Gen(segment_iter->GetValue());
-            output->AddRow(key, static_cast<uint64_t>(ts),
-                           segment_iter->GetValue());
+            // without an order function the rows keep the ts of the partition
+            uint64_t ts = order_gen_.Valid() ? static_cast<uint64_t>(order_gen_.Gen(segment_iter->GetValue()))
+                                             : segment_iter->GetKey();
+            output->AddRow(key, ts, segment_iter->GetValue());
             segment_iter->Next();
         }
+        iter->Next();
     }
     if (order_gen_.Valid()) {
         output->Sort(is_asc);
     } else if (is_asc && OrderType::kDescOrder == partition->GetOrderType()) {
+        output->SetOrderType(OrderType::kDescOrder);
         output->Reverse();
     }
     return output;
@@ -1989,15 +2591,86 @@ bool JoinGenerator::TableJoin(std::shared_ptr<TableHandler> left,
         LOG(WARNING) << "Table Join with empty left table";
         return false;
     }
+    // the right table is sorted once rather than for every left row
+    right = right_sort_gen_.Sort(right, true);
     left_iter->SeekToFirst();
     while (left_iter->Valid()) {
         const Row& left_row = left_iter->GetValue();
         output->AddRow(
             left_iter->GetKey(),
-            Runner::RowLastJoinTable(left_slices_, left_row, right_slices_,
-                                     right, parameter, right_sort_gen_, condition_gen_));
+            Runner::RowLastJoinSortedTable(left_slices_, left_row, right_slices_,
+                                           right, parameter, condition_gen_));
+        left_iter->Next();
+    }
+    return true;
+}
+
+bool JoinGenerator::TableHashJoin(std::shared_ptr<TableHandler> left,
+                                  std::shared_ptr<TableHandler> right,
+                                  const Row& parameter, uint32_t parallelism,
+                                  std::shared_ptr<MemTimeTableHandler> output) {
+    auto left_iter = left->GetIterator();
+    if (!left_iter) {
+        LOG(WARNING) << "fail to run last join: left input empty";
+        return false;
+    }
+    // sort the right rows once in the order of the last join, so the rows of a key are hashed in that order
+    std::vector<Row> right_rows;
+    auto sorted_right = right_sort_gen_.Sort(right, true);
+    auto right_iter = sorted_right ? sorted_right->GetIterator() : nullptr;
+    if (right_iter) {
+        right_iter->SeekToFirst();
+        while (right_iter->Valid()) {
+            right_rows.push_back(right_iter->GetValue());
+            right_iter->Next();
+        }
+    }
+    std::vector<std::string> right_keys(right_rows.size());
+    size_t morsel_cnt = (right_rows.size() + HASH_JOIN_MORSEL_SIZE - 1) / HASH_JOIN_MORSEL_SIZE;
+    ParallelRun(parallelism, morsel_cnt, [&](size_t morsel) {
+        size_t end = std::min(right_rows.size(), (morsel + 1) * HASH_JOIN_MORSEL_SIZE);
+        for (size_t i = morsel * HASH_JOIN_MORSEL_SIZE; i < end; i++) {
+            right_keys[i] = right_group_gen_.GetKey(right_rows[i], parameter);
+        }
+    });
+    // without a condition only the first row of a key can be joined, so the others are not kept
+    std::unordered_map<std::string, std::vector<size_t>> hash_table;
+    for (size_t i = 0; i < right_rows.size(); i++) {
+        auto& rows = hash_table[right_keys[i]];
+        if (condition_gen_.Valid() || rows.empty()) {
+            rows.push_back(i);
+        }
+    }
+
+    std::vector<std::pair<uint64_t, Row>> left_rows;
+    left_iter->SeekToFirst();
+    while (left_iter->Valid()) {
+        left_rows.emplace_back(left_iter->GetKey(), left_iter->GetValue());
         left_iter->Next();
     }
+    std::vector<Row> joined_rows(left_rows.size());
+    morsel_cnt = (left_rows.size() + HASH_JOIN_MORSEL_SIZE - 1) / HASH_JOIN_MORSEL_SIZE;
+    ParallelRun(parallelism, morsel_cnt, [&](size_t morsel) {
+        size_t end = std::min(left_rows.size(), (morsel + 1) * HASH_JOIN_MORSEL_SIZE);
+        for (size_t i = morsel * HASH_JOIN_MORSEL_SIZE; i < end; i++) {
+            const Row& left_row = left_rows[i].second;
+            joined_rows[i] = Row(left_slices_, left_row, right_slices_, Row());
+            auto iter = hash_table.find(left_key_gen_.Gen(left_row, parameter));
+            if (iter == hash_table.end()) {
+                continue;
+            }
+            for (size_t pos : iter->second) {
+                Row joined_row(left_slices_, left_row, right_slices_, right_rows[pos]);
+                if (!condition_gen_.Valid() || condition_gen_.Gen(joined_row, parameter)) {
+                    joined_rows[i] = joined_row;
+                    break;
+                }
+            }
+        }
+    });
+    for (size_t i = 0; i < left_rows.size(); i++) {
+        output->AddRow(left_rows[i].first, joined_rows[i]);
+    }
     return true;
 }
 
@@ -2126,7 +2799,12 @@ const Row Runner::RowLastJoinTable(size_t left_slices, const Row& left_row,
                                    const Row& parameter,
                                    SortGenerator& right_sort,
                                    ConditionGenerator& cond_gen) {
-    right_table = right_sort.Sort(right_table, true);
+    return RowLastJoinSortedTable(left_slices, left_row, right_slices, right_sort.Sort(right_table, true), parameter,
+                                  cond_gen);
+}
+const Row Runner::RowLastJoinSortedTable(size_t left_slices, const Row& left_row, size_t right_slices,
+                                         std::shared_ptr<TableHandler> right_table, const Row& parameter,
+                                         ConditionGenerator& cond_gen) {
     if (!right_table) {
         LOG(WARNING) << "Last Join right table is empty";
         return Row(left_slices, left_row, right_slices, Row());
@@ -2652,10 +3330,46 @@ std::shared_ptr<DataHandler> GroupAggRunner::Run(
         }
         iter->SeekToFirst();
         int32_t cnt = 0;
+        if (ctx.GetParallelism() > 1) {
+            std::vector<std::string> keys;
+            while (iter->Valid()) {
+                if (limit_cnt_ > 0 && cnt++ >= limit_cnt_) {
+                    break;
+                }
+                keys.push_back(iter->GetKey().ToString());
+                iter->Next();
+            }
+            std::vector<Row> outputs(keys.size());
+            // 0 for filtered by having condition, 1 for output and -1 for the null segment
+            std::vector<int8_t> states(keys.size(), 0);
+            ParallelRun(ctx.GetParallelism(), keys.size(), [&](size_t i) {
+                auto segment = partition->GetSegment(keys[i]);
+                if (!segment) {
+                    states[i] = -1;
+                    return;
+                }
+                if (!having_condition_.Valid() || having_condition_.Gen(segment, parameter)) {
+                    outputs[i] = agg_gen_.Gen(parameter, segment);
+                    states[i] = 1;
+                }
+            });
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (states[i] < 0) {
+                    LOG(WARNING) << "group aggregation fail: segment segment is null";
+                    return std::shared_ptr<DataHandler>();
+                } else if (states[i] > 0) {
+                    output_table->AddRow(outputs[i]);
+                }
+            }
+            return output_table;
+        }
         while (iter->Valid()) {
             if (limit_cnt_ > 0 && cnt++ >= limit_cnt_) {
                 break;
             }
+            if (ctx.IsCancelled()) {
+                return std::shared_ptr<DataHandler>();
+            }
             auto key = iter->GetKey().ToString();
             auto segment = partition->GetSegment(key);
             if (!segment) {
@@ -2683,6 +3397,10 @@ bool RequestAggUnionRunner::InitAggregator() {
     }
 
     agg_type_ = type_it->second;
+    if (!cond_col_name_.empty() && producers_[1]->row_parser()->GetType(cond_col_name_) != type::Type::kBool) {
+        LOG(ERROR) << "RequestAggUnionRunner only support bool column as the condition of " << func_name;
+        return false;
+    }
     type::Type agg_col_type;
     if (agg_col_->GetExprType() == node::kExprColumnRef) {
         agg_col_type = producers_[1]->row_parser()->GetType(agg_col_name_);
@@ -2726,12 +3444,10 @@ std::shared_ptr<DataHandler> RequestAggUnionRunner::Run(
         LOG(WARNING) << "inputs size < 3";
         return std::shared_ptr<DataHandler>();
     }
-    auto request_handler = inputs[0];
-    auto base_handler = inputs[1];
-    auto agg_handler = inputs[2];
-    if (!request_handler || !base_handler || !agg_handler) {
+    if (std::any_of(inputs.begin(), inputs.end(), [](const auto& input) { return !input; })) {
         return std::shared_ptr<DataHandler>();
     }
+    auto request_handler = inputs[0];
     if (kRowHandler != request_handler->GetHanlderType()) {
         return std::shared_ptr<DataHandler>();
     }
@@ -2752,14 +3468,20 @@ std::shared_ptr<DataHandler> RequestAggUnionRunner::Run(
     auto& key_gen = windows_union_gen_.windows_gen_[0].index_seek_gen_.index_key_gen_;
     std::string key = key_gen.Gen(request, ctx.GetParameterRow());
     // do not use codegen to gen the union outputs for aggr segment
-    union_inputs.pop_back();
+    std::vector<std::shared_ptr<DataHandler>> agg_inputs(union_inputs.begin() + 1, union_inputs.end());
+    union_inputs.resize(1);
 
     auto union_segments =
         windows_union_gen_.GetRequestWindows(request, ctx.GetParameterRow(), union_inputs);
     // code_gen result of agg_segment is not correct. we correct the result here
-    auto agg_segment = std::dynamic_pointer_cast<PartitionHandler>(union_inputs[1])->GetSegment(key);
-    if (agg_segment) {
-        union_segments.emplace_back(agg_segment);
+    bool has_agg_segment = false;
+    for (const auto& agg_input : agg_inputs) {
+        auto partition = std::dynamic_pointer_cast<PartitionHandler>(agg_input);
+        auto agg_segment = partition ? partition->GetSegment(key) : std::shared_ptr<TableHandler>();
+        if (agg_segment) {
+            union_segments.emplace_back(agg_segment);
+            has_agg_segment = true;
+        }
     }
 
     if (ctx.is_debug()) {
@@ -2774,7 +3496,7 @@ std::shared_ptr<DataHandler> RequestAggUnionRunner::Run(
 
     // build window with start and end offset
     std::shared_ptr<TableHandler> window;
-    if (agg_segment) {
+    if (has_agg_segment) {
         window = RequestUnionWindow(request, union_segments, ts_gen, range_gen_.window_range_, output_request_row_,
                                     exclude_current_time_);
     } else {
@@ -2796,10 +3518,10 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
     std::vector<std::shared_ptr<TableHandler>> union_segments, int64_t ts_gen,
     const WindowRange& window_range, const bool output_request_row,
     const bool exclude_current_time) {
-    // TOOD(zhanghao): for now, we only support AggUnion with 1 base table and 1 agg table
+    // union_segments are the base table and the agg tables from the finest bucket level to the coarsest
     size_t unions_cnt = union_segments.size();
-    if (unions_cnt != 2) {
-        LOG(ERROR) << "Not support of RequestAggUnion with more than 2 unions";
+    if (unions_cnt < 2) {
+        LOG(ERROR) << "Not support of RequestAggUnion without agg table";
         return nullptr;
     }
 
@@ -2807,12 +3529,15 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
         LOG(ERROR) << "base table is empty";
         return nullptr;
     }
-    if (!union_segments[1]) {
-        LOG(ERROR) << "agg table is empty";
-        return nullptr;
+    for (size_t i = 1; i < unions_cnt; i++) {
+        if (!union_segments[i]) {
+            LOG(ERROR) << "agg table is empty";
+            return nullptr;
+        }
     }
 
     const auto base_row_parser = producers_[1]->row_parser();
+    // all the agg tables share the same schema
     const auto agg_row_parser = producers_[2]->row_parser();
 
     int64_t start = 0;
@@ -2841,6 +3566,13 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
         if (!agg_col_name_.empty() && row_parser->IsNull(row, agg_col_name_)) {
             return;
         }
+        if (!cond_col_name_.empty()) {
+            bool cond = false;
+            if (row_parser->IsNull(row, cond_col_name_) ||
+                row_parser->GetValue(row, cond_col_name_, type::Type::kBool, &cond) != 0 || !cond) {
+                return;
+            }
+        }
 
         auto type = aggregator_->type();
         auto aggregator = aggregator_.get();
@@ -2926,6 +3658,63 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
         DLOG(INFO) << "REQUEST AGG UNION cnt = " << window_table->GetCount();
         return window_table;
     }
+
+    // with multiple bucket levels, the range window is covered by the coarsest buckets fully inside it, the rest
+    // at both ends by the finer levels down to the base rows, so only a few buckets of every level are read
+    if (unions_cnt > 2 && window_range.frame_type_ == Window::kFrameRowsRange && max_size <= 0) {
+        std::function<void(int64_t, int64_t, size_t)> aggregate_range = [&](int64_t lo, int64_t hi, size_t level) {
+            if (lo > hi) {
+                return;
+            }
+            if (level == 0) {
+                base_it->Seek(hi);
+                while (base_it->Valid() && static_cast<int64_t>(base_it->GetKey()) >= lo) {
+                    update_base_aggregator(base_it->GetValue());
+                    base_it->Next();
+                }
+                return;
+            }
+            auto agg_it = union_segments[level]->GetIterator();
+            if (!agg_it) {
+                aggregate_range(lo, hi, level - 1);
+                return;
+            }
+            int64_t covered_lo = INT64_MAX;
+            int64_t covered_hi = INT64_MIN;
+            int64_t last_ts_start = INT64_MAX;
+            agg_it->Seek(hi);
+            while (agg_it->Valid()) {
+                int64_t ts_start = agg_it->GetKey();
+                if (ts_start < lo) {
+                    break;
+                }
+                // for mem-table, updating will inserts duplicate entries
+                if (last_ts_start == ts_start) {
+                    agg_it->Next();
+                    continue;
+                }
+                last_ts_start = ts_start;
+                int64_t ts_end = -1;
+                agg_row_parser->GetValue(agg_it->GetValue(), "ts_end", type::Type::kTimestamp, &ts_end);
+                if (ts_end <= hi) {
+                    update_agg_aggregator(agg_it->GetValue());
+                    covered_lo = ts_start;
+                    covered_hi = std::max(covered_hi, ts_end);
+                }
+                agg_it->Next();
+            }
+            if (covered_lo > covered_hi) {
+                aggregate_range(lo, hi, level - 1);
+                return;
+            }
+            aggregate_range(covered_hi + 1, hi, level - 1);
+            aggregate_range(lo, covered_lo - 1, level - 1);
+        };
+        aggregate_range(start, end, unions_cnt - 1);
+        window_table->AddRow(start, aggregator_->Output());
+        DLOG(INFO) << "REQUEST AGG UNION cnt = " << window_table->GetCount();
+        return window_table;
+    }
     base_it->Seek(end);
 
     auto agg_it = union_segments[1]->GetIterator();
@@ -2996,6 +3785,7 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
         // for mem-table, updating will inserts duplicate entries
         if (last_ts_start == ts_start) {
             DLOG(INFO) << "Found duplicate entries in agg table for ts_start = " << ts_start;
+            agg_it->Next();
             continue;
         }
         last_ts_start = ts_start;
@@ -3091,6 +3881,215 @@ std::shared_ptr<DataHandler> ReduceRunner::Run(
     return row_handler;
 }
 
+// the ts bound of the request window, it is not bounded if ts_gen < 0
+static void GetRequestWindowBound(int64_t ts_gen, const WindowRange& window_range, bool exclude_current_time,
+                                  uint64_t* start, uint64_t* end) {
+    *start = 0;
+    *end = UINT64_MAX;
+    if (ts_gen < 0) {
+        return;
+    }
+    *start = (ts_gen + window_range.start_offset_) < 0 ? 0 : (ts_gen + window_range.start_offset_);
+    if (exclude_current_time && 0 == window_range.end_offset_) {
+        *end = (ts_gen - 1) < 0 ? 0 : (ts_gen - 1);
+    } else {
+        *end = (ts_gen + window_range.end_offset_) < 0 ? 0 : (ts_gen + window_range.end_offset_);
+    }
+}
+
+// the rows of the union segments of one window key in descending order of the ts. They are pulled from the
+// segment iterators on demand, so the windows of all the requests of the key share one sweep of the iterators
+class UnionWindowRows {
+ public:
+    UnionWindowRows(const std::vector<std::shared_ptr<TableHandler>>& union_segments, uint64_t end)
+        : segments_(union_segments), iters_(union_segments.size()), status_(union_segments.size()), rows_() {
+        for (size_t i = 0; i < union_segments.size(); i++) {
+            if (!union_segments[i]) {
+                continue;
+            }
+            iters_[i] = union_segments[i]->GetIterator();
+            if (!iters_[i]) {
+                continue;
+            }
+            iters_[i]->Seek(end);
+            if (iters_[i]->Valid()) {
+                status_[i] = IteratorStatus(iters_[i]->GetKey());
+            }
+        }
+    }
+
+    // the position of the first row whose ts is not greater than end
+    size_t Seek(uint64_t end) {
+        while ((rows_.empty() || rows_.back().first > end) && Pull()) {
+        }
+        auto iter = std::lower_bound(rows_.begin(), rows_.end(), end,
+                                     [](const std::pair<uint64_t, Row>& row, uint64_t ts) { return row.first > ts; });
+        return iter - rows_.begin();
+    }
+
+    bool Has(size_t pos) {
+        while (rows_.size() <= pos && Pull()) {
+        }
+        return pos < rows_.size();
+    }
+
+    uint64_t GetKey(size_t pos) const { return rows_[pos].first; }
+    const Row& GetValue(size_t pos) const { return rows_[pos].second; }
+
+ private:
+    bool Pull() {
+        int32_t pos = IteratorStatus::FindFirstIteratorWithMaximizeKey(status_);
+        if (-1 == pos) {
+            return false;
+        }
+        rows_.emplace_back(status_[pos].key_, iters_[pos]->GetValue());
+        iters_[pos]->Next();
+        if (iters_[pos]->Valid()) {
+            status_[pos].set_key(iters_[pos]->GetKey());
+        } else {
+            status_[pos].MarkInValid();
+        }
+        return true;
+    }
+
+    // the iterators are valid while the segments are
+    std::vector<std::shared_ptr<TableHandler>> segments_;
+    std::vector<std::unique_ptr<RowIterator>> iters_;
+    std::vector<IteratorStatus> status_;
+    std::vector<std::pair<uint64_t, Row>> rows_;
+};
+
+// same as RequestUnionRunner::RequestUnionWindow but the rows of the union segments are shared
+static std::shared_ptr<TableHandler> RequestUnionWindowOfRows(const Row& request, UnionWindowRows* union_rows,
+                                                              int64_t ts_gen, const WindowRange& window_range,
+                                                              bool output_request_row, bool exclude_current_time) {
+    uint64_t start = 0;
+    uint64_t end = UINT64_MAX;
+    uint64_t rows_start_preceding = 0;
+    uint64_t max_size = 0;
+    GetRequestWindowBound(ts_gen, window_range, exclude_current_time, &start, &end);
+    if (ts_gen >= 0) {
+        rows_start_preceding = window_range.start_row_;
+        max_size = window_range.max_size_;
+    }
+    uint64_t request_key = ts_gen > 0 ? static_cast<uint64_t>(ts_gen) : 0;
+
+    auto window_table = std::make_shared<MemTimeTableHandler>();
+    uint64_t cnt = 0;
+    auto range_status =
+        window_range.GetWindowPositionStatus(cnt > rows_start_preceding, window_range.end_offset_ < 0,
+                                             request_key < start);
+    if (output_request_row) {
+        window_table->AddRow(request_key, request);
+    }
+    if (WindowRange::kInWindow == range_status) {
+        cnt++;
+    }
+    for (size_t pos = union_rows->Seek(end); union_rows->Has(pos); pos++) {
+        if (max_size > 0 && cnt >= max_size) {
+            break;
+        }
+        uint64_t key = union_rows->GetKey(pos);
+        auto range_status = window_range.GetWindowPositionStatus(cnt > rows_start_preceding, key > end, key < start);
+        if (WindowRange::kExceedWindow == range_status) {
+            break;
+        }
+        if (WindowRange::kInWindow == range_status) {
+            window_table->AddRow(key, union_rows->GetValue(pos));
+            cnt++;
+        }
+    }
+    return window_table;
+}
+
+std::shared_ptr<DataHandlerList> RequestUnionRunner::BatchRequestRun(RunnerContext& ctx) {
+    if (need_batch_cache_ || producers_.size() < 2u || windows_union_gen_.windows_gen_.empty()) {
+        return Runner::BatchRequestRun(ctx);
+    }
+    if (need_cache_) {
+        auto cached = ctx.GetBatchCache(id_);
+        if (cached != nullptr) {
+            return cached;
+        }
+    }
+    auto requests = producers_[0]->BatchRequestRun(ctx);
+    auto rights = producers_[1]->BatchRequestRun(ctx);
+    if (!requests || !rights) {
+        return std::shared_ptr<DataHandlerList>();
+    }
+    const Row& parameter = ctx.GetParameterRow();
+    auto union_inputs = windows_union_gen_.RunInputs(ctx);
+
+    // group the requests by the keys seeking the union segments
+    size_t request_cnt = ctx.GetRequestSize();
+    std::vector<Row> request_rows(request_cnt);
+    std::vector<int64_t> ts_gens(request_cnt, -1);
+    std::vector<std::string> group_keys;
+    std::map<std::string, std::vector<size_t>> groups;
+    for (size_t idx = 0; idx < request_cnt; idx++) {
+        auto left = requests->Get(idx);
+        if (!left || kRowHandler != left->GetHanlderType() || !rights->Get(idx)) {
+            continue;
+        }
+        request_rows[idx] = std::dynamic_pointer_cast<RowHandler>(left)->GetValue();
+        if (range_gen_.Valid()) {
+            ts_gens[idx] = range_gen_.ts_gen_.Gen(request_rows[idx]);
+        }
+        std::string group_key;
+        for (auto& window_gen : windows_union_gen_.windows_gen_) {
+            std::string key = window_gen.index_seek_gen_.Valid()
+                                  ? window_gen.index_seek_gen_.index_key_gen_.Gen(request_rows[idx], parameter)
+                                  : "";
+            absl::StrAppend(&group_key, key.size(), ":", key,
+                            window_gen.filter_gen_.GetKey(request_rows[idx], parameter), "|");
+        }
+        auto iter = groups.find(group_key);
+        if (iter == groups.end()) {
+            group_keys.push_back(group_key);
+            iter = groups.emplace(group_key, std::vector<size_t>()).first;
+        }
+        iter->second.push_back(idx);
+    }
+
+    std::vector<std::shared_ptr<DataHandler>> windows(request_cnt);
+    for (const auto& group_key : group_keys) {
+        const auto& indices = groups[group_key];
+        // the requests of the same ts get the same window, and the same request row too if it is in the window
+        std::unordered_map<std::string, std::shared_ptr<DataHandler>> same_windows;
+        // the segment iterators are seeked to the latest end of the windows in the group
+        uint64_t max_end = 0;
+        for (auto idx : indices) {
+            uint64_t start = 0;
+            uint64_t end = UINT64_MAX;
+            GetRequestWindowBound(ts_gens[idx], range_gen_.window_range_, exclude_current_time_, &start, &end);
+            max_end = std::max(max_end, end);
+        }
+        auto union_segments = windows_union_gen_.GetRequestWindows(request_rows[indices[0]], parameter, union_inputs);
+        UnionWindowRows union_rows(union_segments, max_end);
+        for (auto idx : indices) {
+            std::string window_key = std::to_string(ts_gens[idx]);
+            if (output_request_row_) {
+                window_key = RequestWindowCache::GetKey(window_key + "|", request_rows[idx]);
+            }
+            auto& window = same_windows[window_key];
+            if (!window) {
+                window = RequestUnionWindowOfRows(request_rows[idx], &union_rows, ts_gens[idx],
+                                                  range_gen_.window_range_, output_request_row_,
+                                                  exclude_current_time_);
+            }
+            windows[idx] = window;
+        }
+    }
+    auto outputs = std::make_shared<DataHandlerVector>();
+    for (auto& window : windows) {
+        outputs->Add(window);
+    }
+    if (need_cache_) {
+        ctx.SetBatchCache(id_, outputs);
+    }
+    return outputs;
+}
+
 std::shared_ptr<DataHandler> RequestUnionRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {
@@ -3109,17 +4108,49 @@ std::shared_ptr<DataHandler> RequestUnionRunner::Run(
     }
 
     auto request = std::dynamic_pointer_cast<RowHandler>(left)->GetValue();
+    std::string cache_key;
+    // the window depends on the request row only if there is no parameter
+    if (ctx.window_cache() != nullptr && !window_signature_.empty() && ctx.GetParameterRow().size() == 0) {
+        cache_key = RequestWindowCache::GetKey(window_signature_, request);
+        auto window = ctx.window_cache()->Get(cache_key);
+        if (window) {
+            return window;
+        }
+    }
 
     int64_t ts_gen = range_gen_.Valid() ? range_gen_.ts_gen_.Gen(request) : -1;
 
-    // Prepare Union Window
-    auto union_inputs = windows_union_gen_.RunInputs(ctx);
-    auto union_segments =
-        windows_union_gen_.GetRequestWindows(request, ctx.GetParameterRow(), union_inputs);
-    // build window with start and end offset
-    return RequestUnionWindow(request, union_segments, ts_gen,
-                              range_gen_.window_range_, output_request_row_,
-                              exclude_current_time_);
+    std::shared_ptr<TableHandler> window;
+    if (!scan_signature_.empty()) {
+        // the nested windows of the request pull the rows they need from one scan, the widest one pulls the
+        // rows beyond the narrower ones
+        uint64_t start = 0;
+        uint64_t end = UINT64_MAX;
+        GetRequestWindowBound(ts_gen, range_gen_.window_range_, exclude_current_time_, &start, &end);
+        auto scan = ctx.GetWindowScan(
+            absl::StrCat(RequestWindowCache::GetKey(scan_signature_, request), "\nend=", end));
+        std::lock_guard<std::mutex> lock(scan->mu);
+        if (!scan->rows) {
+            auto union_inputs = windows_union_gen_.RunInputs(ctx);
+            auto union_segments = windows_union_gen_.GetRequestWindows(request, ctx.GetParameterRow(), union_inputs);
+            scan->rows = std::make_shared<UnionWindowRows>(union_segments, end);
+        }
+        window = RequestUnionWindowOfRows(request, scan->rows.get(), ts_gen, range_gen_.window_range_,
+                                          output_request_row_, exclude_current_time_);
+    } else {
+        // Prepare Union Window
+        auto union_inputs = windows_union_gen_.RunInputs(ctx);
+        auto union_segments =
+            windows_union_gen_.GetRequestWindows(request, ctx.GetParameterRow(), union_inputs);
+        // build window with start and end offset
+        window = RequestUnionWindow(request, union_segments, ts_gen,
+                                    range_gen_.window_range_, output_request_row_,
+                                    exclude_current_time_);
+    }
+    if (!cache_key.empty()) {
+        ctx.window_cache()->Put(cache_key, window);
+    }
+    return window;
 }
 std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
     const Row& request,
@@ -3130,17 +4161,8 @@ std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
     uint64_t end = UINT64_MAX;
     uint64_t rows_start_preceding = 0;
     uint64_t max_size = 0;
+    GetRequestWindowBound(ts_gen, window_range, exclude_current_time, &start, &end);
     if (ts_gen >= 0) {
-        start = (ts_gen + window_range.start_offset_) < 0
-                    ? 0
-                    : (ts_gen + window_range.start_offset_);
-        if (exclude_current_time && 0 == window_range.end_offset_) {
-            end = (ts_gen - 1) < 0 ? 0 : (ts_gen - 1);
-        } else {
-            end = (ts_gen + window_range.end_offset_) < 0
-                      ? 0
-                      : (ts_gen + window_range.end_offset_);
-        }
         rows_start_preceding = window_range.start_row_;
         max_size = window_range.max_size_;
     }
@@ -3582,13 +4604,18 @@ std::shared_ptr<DataHandler> ProxyRequestRunner::RunWithRowInput(
                             "unsupported currently";
             return std::shared_ptr<DataHandler>();
         }
+        // the remote tablet aborts the sub query with the deadline left
+        if (ctx.IsCancelled()) {
+            return std::shared_ptr<DataHandler>();
+        }
         if (ctx.sp_name().empty()) {
             return tablet->SubQuery(task_id_, cluster_job->db(),
                                     cluster_job->sql(), row, false,
-                                    ctx.is_debug());
+                                    ctx.is_debug(), ctx.GetRemainingMs());
         } else {
             return tablet->SubQuery(task_id_, cluster_job->db(),
-                                    ctx.sp_name(), row, true, ctx.is_debug());
+                                    ctx.sp_name(), row, true, ctx.is_debug(),
+                                    ctx.GetRemainingMs());
         }
     }
 }
@@ -3636,16 +4663,21 @@ std::shared_ptr<TableHandler> ProxyRequestRunner::RunWithRowsInput(
             << "fail to run proxy runner with rows: subquery tablet is null";
         return fail_ptr;
     }
+    if (ctx.IsCancelled()) {
+        return fail_ptr;
+    }
     if (ctx.sp_name().empty()) {
         return tablet->SubQuery(task_id_, cluster_job->db(),
                                 cluster_job->sql(),
                                 ctx.cluster_job()->common_column_indices(),
-                                rows, request_is_common, false, ctx.is_debug());
+                                rows, request_is_common, false, ctx.is_debug(),
+                                ctx.GetRemainingMs());
     } else {
         return tablet->SubQuery(task_id_, cluster_job->db(),
                                 ctx.sp_name(),
                                 ctx.cluster_job()->common_column_indices(),
-                                rows, request_is_common, true, ctx.is_debug());
+                                rows, request_is_common, true, ctx.is_debug(),
+                                ctx.GetRemainingMs());
     }
     return fail_ptr;
 }
@@ -3777,6 +4809,20 @@ const Row ProjectGenerator::Gen(const Row& row, const Row& parameter) {
     return CoreAPI::RowProject(fn_, row, parameter, false);
 }
 
+void ProjectGenerator::Gen(const Row* rows, size_t cnt, const Row& parameter, Row* outputs) {
+    bool has_empty = false;
+    for (size_t i = 0; i < cnt && !has_empty; i++) {
+        has_empty = rows[i].empty();
+    }
+    if (block_fn_ == nullptr || has_empty) {
+        for (size_t i = 0; i < cnt; i++) {
+            outputs[i] = Gen(rows[i], parameter);
+        }
+        return;
+    }
+    CoreAPI::RowProjectBlock(block_fn_, rows, cnt, parameter, outputs);
+}
+
 const Row ConstProjectGenerator::Gen(const Row& parameter) {
     return CoreAPI::RowConstProject(fn_, parameter, false);
 }
@@ -3989,7 +5035,8 @@ std::shared_ptr<DataHandler> FilterGenerator::Filter(
         if (!condition_gen_.Valid()) {
             return partition;
         }
-        return std::shared_ptr<PartitionHandler>(new PartitionFilterWrapper(partition, parameter, this));
+        return std::shared_ptr<PartitionHandler>(
+            new PartitionFilterWrapper(partition, parameter, this, GetPushdownPredicates()));
     }
 }
 std::shared_ptr<DataHandler> FilterGenerator::Filter(
@@ -4004,7 +5051,8 @@ std::shared_ptr<DataHandler> FilterGenerator::Filter(
     if (!condition_gen_.Valid()) {
         return table;
     }
-    return std::shared_ptr<TableHandler>(new TableFilterWrapper(table, parameter, this));
+    return std::shared_ptr<TableHandler>(
+        new TableFilterWrapper(table, parameter, this, GetPushdownPredicates()));
 }
 
 std::shared_ptr<DataHandlerList> RunnerContext::GetBatchCache(
@@ -4022,7 +5070,17 @@ void RunnerContext::SetBatchCache(int64_t id,
     batch_cache_[id] = data;
 }
 
+std::shared_ptr<SharedWindowScan> RunnerContext::GetWindowScan(const std::string& key) {
+    std::lock_guard<std::mutex> lock(cache_mu_);
+    auto& scan = window_scans_[key];
+    if (!scan) {
+        scan = std::make_shared<SharedWindowScan>();
+    }
+    return scan;
+}
+
 std::shared_ptr<DataHandler> RunnerContext::GetCache(int64_t id) const {
+    std::lock_guard<std::mutex> lock(cache_mu_);
     auto iter = cache_.find(id);
     if (iter == cache_.end()) {
         return std::shared_ptr<DataHandler>();
@@ -4033,7 +5091,52 @@ std::shared_ptr<DataHandler> RunnerContext::GetCache(int64_t id) const {
 
 void RunnerContext::SetCache(int64_t id,
                              const std::shared_ptr<DataHandler> data) {
-    cache_[id] = data;
+    std::lock_guard<std::mutex> lock(cache_mu_);
+    // a shared producer may be evaluated by two concurrent branches, keep the first result so that all the
+    // later readers get the same handler
+    cache_.emplace(id, data);
+}
+
+uint64_t RunnerContext::GetRemainingMs() const {
+    if (deadline_ == std::chrono::steady_clock::time_point::max()) {
+        return 0;
+    }
+    auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline_ - std::chrono::steady_clock::now()).count();
+    // a deadline passed is still a limit
+    return remaining > 0 ? remaining : 1;
+}
+
+bool RunnerContext::IsCancelled() {
+    if (cancelled_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if (deadline_ != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= deadline_) {
+        cancelled_.store(true, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+RunnerContext::~RunnerContext() {
+    // the managed strings and udaf states allocated by the runners on the
+    // calling thread, the memory is kept for the next request of the thread
+    JitRuntime::get()->ReleaseRunStep();
+    if (profile_ != nullptr && memory_tracker_ != nullptr) {
+        profile_->UpdatePeakMemory(memory_tracker_->GetPeak());
+    }
+}
+
+bool RunnerContext::ConsumeMemory(uint64_t bytes) {
+    if (!memory_tracker_ || memory_tracker_->Consume(bytes)) {
+        return true;
+    }
+    if (!memory_exceeded_.exchange(true, std::memory_order_relaxed)) {
+        LOG(WARNING) << "abort the query: memory limit exceeded, its intermediate tables hold "
+                     << memory_tracker_->GetUsed() << " bytes and ask for " << bytes << " more";
+    }
+    Cancel();
+    return false;
 }
 
 void RunnerContext::SetRequest(const hybridse::codec::Row& request) {
@@ -17,8 +17,11 @@
 #ifndef HYBRIDSE_SRC_VM_RUNNER_H_
 #define HYBRIDSE_SRC_VM_RUNNER_H_
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -32,7 +35,11 @@
 #include "vm/catalog_wrapper.h"
 #include "vm/core_api.h"
 #include "vm/mem_catalog.h"
+#include "vm/memory_tracker.h"
 #include "vm/physical_op.h"
+#include "vm/runner_pool.h"
+#include "vm/runner_profile.h"
+#include "vm/window_cache.h"
 namespace hybridse {
 namespace vm {
 
@@ -47,6 +54,7 @@ using vm::Window;
 
 class Runner;
 class RunnerContext;
+class UnionWindowRows;
 class FnGenerator {
  public:
     explicit FnGenerator(const FnInfo& info)
@@ -78,10 +86,14 @@ class RowProjectFun : public ProjectFun {
 class ProjectGenerator : public FnGenerator {
  public:
     explicit ProjectGenerator(const FnInfo& info)
-        : FnGenerator(info), fun_(info.fn_ptr()) {}
+        : FnGenerator(info), fun_(info.fn_ptr()), block_fn_(info.block_fn_ptr()) {}
     virtual ~ProjectGenerator() {}
     const Row Gen(const Row& row, const Row& parameter);
+    // project `cnt` rows into `outputs`, in one call if the block function is generated
+    void Gen(const Row* rows, size_t cnt, const Row& parameter, Row* outputs);
+    bool HasBlockFn() const { return block_fn_ != nullptr; }
     RowProjectFun fun_;
+    const int8_t* block_fn_;
 };
 
 class ConstProjectGenerator : public FnGenerator {
@@ -154,6 +166,11 @@ class RangeGenerator {
                 (-1 * range.frame_->GetHistoryRowsStart());
             window_range_.end_row_ = (-1 * range.frame_->GetHistoryRowsEnd());
             window_range_.max_size_ = range.frame_->frame_maxsize();
+            // the rows out of the bound are not read by the projects, so the window is cut as by max size
+            if (range.rows_bound() > 0 &&
+                (window_range_.max_size_ == 0 || range.rows_bound() < window_range_.max_size_)) {
+                window_range_.max_size_ = range.rows_bound();
+            }
         }
     }
     virtual ~RangeGenerator() {}
@@ -201,15 +218,19 @@ class PartitionGenerator {
     virtual ~PartitionGenerator() {}
 
     const bool Valid() const { return key_gen_.Valid(); }
+    // a table is partitioned on at most parallelism threads
     std::shared_ptr<PartitionHandler> Partition(
-        std::shared_ptr<DataHandler> input, const Row& parameter);
+        std::shared_ptr<DataHandler> input, const Row& parameter, uint32_t parallelism = 1);
     std::shared_ptr<PartitionHandler> Partition(
         std::shared_ptr<PartitionHandler> table, const Row& parameter);
     std::shared_ptr<PartitionHandler> Partition(
-        std::shared_ptr<TableHandler> table, const Row& parameter);
+        std::shared_ptr<TableHandler> table, const Row& parameter, uint32_t parallelism = 1);
     const std::string GetKey(const Row& row, const Row& parameter) { return key_gen_.Gen(row, parameter); }
 
  private:
+    void PartitionParallel(RowIterator* iter, const Row& parameter, uint32_t parallelism,
+                           MemPartitionHandler* output);
+
     KeyGenerator key_gen_;
 };
 class SortGenerator {
@@ -229,6 +250,10 @@ class SortGenerator {
         const bool reverse = false);
     std::shared_ptr<TableHandler> Sort(std::shared_ptr<TableHandler> table,
                                        const bool reverse = false);
+    // sort the table holding at most memory_limit bytes of rows in memory, the sorted runs past the limit are
+    // spilled to files under dir and merged as the output is read
+    std::shared_ptr<TableHandler> ExternalSort(std::shared_ptr<TableHandler> table, uint64_t memory_limit,
+                                               const std::string& dir);
     const OrderGenerator& order_gen() const { return order_gen_; }
 
  private:
@@ -271,10 +296,21 @@ class FilterGenerator : public PredicateFun {
         }
         return condition_gen_.Gen(row, parameter);
     }
+    // the comparisons in the condition which the storage checks before the
+    // rows reach the condition, the condition still checks all of them
+    void SetPushdownPredicates(
+        const std::vector<ColumnPredicate>& predicates) {
+        predicates_ = predicates;
+    }
 
  private:
+    const std::vector<ColumnPredicate>* GetPushdownPredicates() const {
+        return predicates_.empty() ? nullptr : &predicates_;
+    }
+
     ConditionGenerator condition_gen_;
     IndexSeekGenerator index_seek_gen_;
+    std::vector<ColumnPredicate> predicates_;
 };
 class WindowGenerator {
  public:
@@ -512,6 +548,11 @@ class Runner : public node::NodeBase<Runner> {
                                       const hybridse::codec::Row& parameter,
                                       SortGenerator& right_sort,    // NOLINT
                                       ConditionGenerator& filter);  // NOLINT
+    // last join the left row with the right table already sorted in the order of the last join
+    static const Row RowLastJoinSortedTable(size_t left_slices, const Row& left_row, size_t right_slices,
+                                            std::shared_ptr<TableHandler> right_table,
+                                            const hybridse::codec::Row& parameter,
+                                            ConditionGenerator& filter);  // NOLINT
     static std::shared_ptr<TableHandler> TableReverse(
         std::shared_ptr<TableHandler> table);
 
@@ -666,6 +707,12 @@ class JoinGenerator {
     bool TableJoin(std::shared_ptr<TableHandler> left, std::shared_ptr<PartitionHandler> right,
                    const Row& parameter,
                    std::shared_ptr<MemTimeTableHandler> output);  // NOLINT
+    // last join the left table with the right table not partitioned by an index: the right rows are hashed by the
+    // join key once and each left row probes the hash table, rather than partitioning and sorting the right rows
+    // for every left row. The keys are generated on at most parallelism threads.
+    bool TableHashJoin(std::shared_ptr<TableHandler> left, std::shared_ptr<TableHandler> right,
+                       const Row& parameter, uint32_t parallelism,
+                       std::shared_ptr<MemTimeTableHandler> output);  // NOLINT
     bool PartitionJoin(std::shared_ptr<PartitionHandler> left,
                        std::shared_ptr<TableHandler> right,
                        const Row& parameter,
@@ -835,7 +882,13 @@ class SimpleProjectRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    // the projects only read these columns of the input table, so its
+    // partitions are scanned with the other columns left undecoded
+    void SetSourceColumns(const std::vector<size_t>& columns) {
+        source_columns_ = columns;
+    }
     ProjectGenerator project_gen_;
+    std::vector<size_t> source_columns_;
 };
 
 class SelectSliceRunner : public Runner {
@@ -938,6 +991,7 @@ class WindowAggRunner : public Runner {
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
     void RunWindowAggOnKey(
+        RunnerContext& ctx,  // NOLINT
         const Row& parameter,
         std::shared_ptr<PartitionHandler> instance_partition,
         std::vector<std::shared_ptr<PartitionHandler>> union_partitions,
@@ -968,6 +1022,10 @@ class RequestUnionRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    // the requests of the same window keys share the union segments, and their windows are built from a
+    // single sweep of the segment iterators. the requests of the same window share the window handler
+    std::shared_ptr<DataHandlerList> BatchRequestRun(
+        RunnerContext& ctx) override;  // NOLINT
     static std::shared_ptr<TableHandler> RequestUnionWindow(
         const Row& request,
         std::vector<std::shared_ptr<TableHandler>> union_segments,
@@ -976,17 +1034,26 @@ class RequestUnionRunner : public Runner {
     void AddWindowUnion(const RequestWindowOp& window, Runner* runner) {
         windows_union_gen_.AddWindowUnion(window, runner);
     }
+    // the db and the plan of the request union, the window is shared through the window cache of the
+    // context with the runners of the same signature
+    void SetWindowSignature(const std::string& signature) { window_signature_ = signature; }
+    // the db and the plan of the request union without the frame, the nested windows of the same signature
+    // in the deployment, e.g. the windows of 1h, 1d and 30d on the same key and order, are built from one
+    // scan of the segments through the context
+    void SetScanSignature(const std::string& signature) { scan_signature_ = signature; }
     RequestWindowUnionGenerator windows_union_gen_;
     RangeGenerator range_gen_;
     bool exclude_current_time_;
     bool output_request_row_;
+    std::string window_signature_;
+    std::string scan_signature_;
 };
 
 class RequestAggUnionRunner : public Runner {
  public:
     RequestAggUnionRunner(const int32_t id, const SchemasContext* schema, const int32_t limit_cnt, const Range& range,
                           bool exclude_current_time, bool output_request_row, const node::FnDefNode* func,
-                          const node::ExprNode* agg_col)
+                          const node::ExprNode* agg_col, const node::ExprNode* cond = nullptr)
         : Runner(id, kRunnerRequestAggUnion, schema, limit_cnt),
           range_gen_(range),
           exclude_current_time_(exclude_current_time),
@@ -996,6 +1063,9 @@ class RequestAggUnionRunner : public Runner {
     if (agg_col_->GetExprType() == node::kExprColumnRef) {
         agg_col_name_ = dynamic_cast<const node::ColumnRefNode*>(agg_col_)->GetColumnName();
     }
+    if (cond != nullptr && cond->GetExprType() == node::kExprColumnRef) {
+        cond_col_name_ = dynamic_cast<const node::ColumnRefNode*>(cond)->GetColumnName();
+    }
 }
 
     bool InitAggregator();
@@ -1021,6 +1091,7 @@ class RequestAggUnionRunner : public Runner {
 
     static inline const std::unordered_map<std::string, AggType> agg_type_map_ = {
         {"sum", kSum}, {"count", kCount}, {"avg", kAvg}, {"min", kMin}, {"max", kMax},
+        {"sum_where", kSum}, {"count_where", kCount}, {"avg_where", kAvg}, {"min_where", kMin}, {"max_where", kMax},
     };
 
     RequestWindowUnionGenerator windows_union_gen_;
@@ -1031,6 +1102,8 @@ class RequestAggUnionRunner : public Runner {
     AggType agg_type_;
     const node::ExprNode* agg_col_ = nullptr;
     std::string agg_col_name_;
+    // the bool column of the *_where functions, the rows of which it is not true are skipped
+    std::string cond_col_name_;
     std::unique_ptr<BaseAggregator> aggregator_ = nullptr;
 };
 
@@ -1459,6 +1532,7 @@ class RunnerBuilder {
                                Status& status) {  // NOLINT
         id_ = 0;
         cluster_job_.Reset();
+        scan_runners_.clear();
         auto task =  // NOLINT whitespace/braces
             Build(node, status);
         if (!status.isOK()) {
@@ -1506,6 +1580,8 @@ class RunnerBuilder {
     std::unordered_map<hybridse::vm::Runner*, ::hybridse::vm::Runner*>
         proxy_runner_map_;
     std::set<size_t> batch_common_node_set_;
+    // the first request union runner of every scan signature
+    std::unordered_map<std::string, RequestUnionRunner*> scan_runners_;
     ClusterTask MultipleInherit(const std::vector<const ClusterTask*>& children, Runner* runner,
                                                 const Key& index_key, const TaskBiasType bias);
     ClusterTask BinaryInherit(const ClusterTask& left, const ClusterTask& right,
@@ -1530,6 +1606,13 @@ class RunnerBuilder {
     ClusterTask BuildRequestAggUnionTask(PhysicalOpNode* node, Status& status);  // NOLINT
 };
 
+// the scan of the segments of a request window shared by the nested windows, the rows are pulled by the
+// windows one after another under mu
+struct SharedWindowScan {
+    std::mutex mu;
+    std::shared_ptr<UnionWindowRows> rows;
+};
+
 class RunnerContext {
  public:
     explicit RunnerContext(hybridse::vm::ClusterJob* cluster_job,
@@ -1541,7 +1624,17 @@ class RunnerContext {
           requests_(),
           parameter_(parameter),
           is_debug_(is_debug),
-          batch_cache_() {}
+          batch_cache_(),
+          parallelism_(1),
+          sort_memory_limit_(0),
+          spill_dir_(),
+          runner_pool_(nullptr),
+          window_cache_(nullptr),
+          profile_(nullptr),
+          deadline_(std::chrono::steady_clock::time_point::max()),
+          cancelled_(false),
+          memory_tracker_(),
+          memory_exceeded_(false) {}
     explicit RunnerContext(hybridse::vm::ClusterJob* cluster_job,
                            const hybridse::codec::Row& request,
                            const std::string& sp_name = "",
@@ -1552,7 +1645,17 @@ class RunnerContext {
           requests_(),
           parameter_(),
           is_debug_(is_debug),
-          batch_cache_() {}
+          batch_cache_(),
+          parallelism_(1),
+          sort_memory_limit_(0),
+          spill_dir_(),
+          runner_pool_(nullptr),
+          window_cache_(nullptr),
+          profile_(nullptr),
+          deadline_(std::chrono::steady_clock::time_point::max()),
+          cancelled_(false),
+          memory_tracker_(),
+          memory_exceeded_(false) {}
     explicit RunnerContext(hybridse::vm::ClusterJob* cluster_job,
                            const std::vector<Row>& request_batch,
                            const std::string& sp_name = "",
@@ -1563,7 +1666,19 @@ class RunnerContext {
           requests_(request_batch),
           parameter_(),
           is_debug_(is_debug),
-          batch_cache_() {}
+          batch_cache_(),
+          parallelism_(1),
+          sort_memory_limit_(0),
+          spill_dir_(),
+          runner_pool_(nullptr),
+          window_cache_(nullptr),
+          profile_(nullptr),
+          deadline_(std::chrono::steady_clock::time_point::max()),
+          cancelled_(false),
+          memory_tracker_(),
+          memory_exceeded_(false) {}
+    // the run step memory of the calling thread is released with the request
+    ~RunnerContext();
 
     const size_t GetRequestSize() const { return requests_.size(); }
     const hybridse::codec::Row& GetRequest() const { return request_; }
@@ -1575,13 +1690,57 @@ class RunnerContext {
     void SetRequest(const hybridse::codec::Row& request);
     void SetRequests(const std::vector<hybridse::codec::Row>& requests);
     bool is_debug() const { return is_debug_; }
+    // the count of threads the batch mode runners process the segments or rows of their input with
+    void SetParallelism(uint32_t parallelism) { parallelism_ = parallelism == 0 ? 1 : parallelism; }
+    uint32_t GetParallelism() const { return parallelism_; }
+    // the bytes of rows a batch mode sort holds in memory before it spills sorted runs to dir, 0 for no limit
+    void SetSortMemoryLimit(uint64_t bytes, const std::string& dir) {
+        sort_memory_limit_ = bytes;
+        spill_dir_ = dir;
+    }
+    uint64_t GetSortMemoryLimit() const { return sort_memory_limit_; }
+    const std::string& GetSpillDir() const { return spill_dir_; }
+    // the pool to evaluate the independent producers of a runner in request mode, null to evaluate them
+    // in the calling thread
+    void SetRunnerPool(RunnerPool* runner_pool) { runner_pool_ = runner_pool; }
+    RunnerPool* runner_pool() const { return runner_pool_; }
+    // the cache to share the request windows among the deployments, null to disable it
+    void SetWindowCache(RequestWindowCache* window_cache) { window_cache_ = window_cache; }
+    RequestWindowCache* window_cache() const { return window_cache_; }
+    // the profile to record the time and rows of every runner to, null to disable it
+    void SetProfile(RunnerProfile* profile) { profile_ = profile; }
+    RunnerProfile* profile() const { return profile_; }
+    // the time the query should be done by, the runners check it between the rows and abort once it passes
+    void SetDeadline(std::chrono::steady_clock::time_point deadline) { deadline_ = deadline; }
+    std::chrono::steady_clock::time_point deadline() const { return deadline_; }
+    // the milliseconds left to the deadline for the remote sub queries, 0 if there is no deadline
+    uint64_t GetRemainingMs() const;
+    // count the bytes of the intermediate tables of the query against limit, 0 for no limit, and charge parent
+    // as well if it isn't null
+    void SetMemoryLimit(uint64_t limit, MemoryTracker* parent) {
+        memory_tracker_ = std::make_unique<MemoryTracker>(limit, parent);
+    }
+    bool IsMemoryTracked() const { return memory_tracker_ != nullptr; }
+    // charge the bytes to the query, it is cancelled if a limit is passed. It may be called in parallel
+    bool ConsumeMemory(uint64_t bytes);
+    bool IsMemoryLimitExceeded() const { return memory_exceeded_.load(std::memory_order_relaxed); }
+    uint64_t GetPeakMemory() const { return memory_tracker_ ? memory_tracker_->GetPeak() : 0; }
+    // abort the runners of the query, e.g. the query is no longer waited for
+    void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    // whether the query is cancelled or the deadline passed, it may be called by the runners in parallel
+    bool IsCancelled();
 
     const std::string& sp_name() { return sp_name_; }
     std::shared_ptr<DataHandler> GetCache(int64_t id) const;
     void SetCache(int64_t id, std::shared_ptr<DataHandler> data);
-    void ClearCache() { cache_.clear(); }
+    void ClearCache() {
+        std::lock_guard<std::mutex> lock(cache_mu_);
+        cache_.clear();
+    }
     std::shared_ptr<DataHandlerList> GetBatchCache(int64_t id) const;
     void SetBatchCache(int64_t id, std::shared_ptr<DataHandlerList> data);
+    // the scan of the key shared by the nested request windows, it is created without rows at the first call
+    std::shared_ptr<SharedWindowScan> GetWindowScan(const std::string& key);
 
  private:
     hybridse::vm::ClusterJob* cluster_job_;
@@ -1592,8 +1751,22 @@ class RunnerContext {
     size_t idx_;
     const bool is_debug_;
     // TODO(chenjing): optimize
+    // cache_ is guarded by cache_mu_ as the producers may run concurrently with runner_pool_
+    mutable std::mutex cache_mu_;
     std::map<int64_t, std::shared_ptr<DataHandler>> cache_;
     std::map<int64_t, std::shared_ptr<DataHandlerList>> batch_cache_;
+    // guarded by cache_mu_ as well
+    std::unordered_map<std::string, std::shared_ptr<SharedWindowScan>> window_scans_;
+    uint32_t parallelism_;
+    uint64_t sort_memory_limit_;
+    std::string spill_dir_;
+    RunnerPool* runner_pool_;
+    RequestWindowCache* window_cache_;
+    RunnerProfile* profile_;
+    std::chrono::steady_clock::time_point deadline_;
+    std::atomic<bool> cancelled_;
+    std::unique_ptr<MemoryTracker> memory_tracker_;
+    std::atomic<bool> memory_exceeded_;
 };
 }  // namespace vm
 }  // namespace hybridse
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "vm/runner_pool.h"
+
+#include <atomic>
+
+#include "vm/jit_runtime.h"
+
+namespace hybridse {
+namespace vm {
+
+struct RunnerPool::TaskGroup {
+    explicit TaskGroup(const std::vector<std::function<void()>>& group_tasks)
+        : tasks(group_tasks), claimed(new std::atomic<bool>[group_tasks.size()]), remain(group_tasks.size()) {
+        for (size_t i = 0; i < tasks.size(); i++) {
+            claimed[i].store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // return true if the task is taken by the current thread
+    bool Claim(size_t idx) { return !claimed[idx].exchange(true, std::memory_order_acq_rel); }
+
+    void RunTask(size_t idx) {
+        tasks[idx]();
+        std::lock_guard<std::mutex> lock(mu);
+        if (--remain == 0) {
+            cv.notify_all();
+        }
+    }
+
+    const std::vector<std::function<void()>>& tasks;
+    std::unique_ptr<std::atomic<bool>[]> claimed;
+    size_t remain;
+    std::mutex mu;
+    std::condition_variable cv;
+};
+
+RunnerPool::RunnerPool(uint32_t thread_num) : mu_(), cv_(), queue_(), stop_(false), threads_() {
+    for (uint32_t i = 0; i < thread_num; i++) {
+        threads_.emplace_back(&RunnerPool::Work, this);
+    }
+}
+
+RunnerPool::~RunnerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void RunnerPool::Run(const std::vector<std::function<void()>>& tasks) {
+    if (tasks.size() <= 1 || threads_.empty()) {
+        for (const auto& task : tasks) {
+            task();
+        }
+        return;
+    }
+    auto group = std::make_shared<TaskGroup>(tasks);
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        // the first task is run by the calling thread
+        for (size_t i = 1; i < tasks.size(); i++) {
+            queue_.emplace_back(group, i);
+        }
+    }
+    cv_.notify_all();
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (group->Claim(i)) {
+            group->RunTask(i);
+        }
+    }
+    std::unique_lock<std::mutex> lock(group->mu);
+    group->cv.wait(lock, [&group] { return group->remain == 0; });
+}
+
+void RunnerPool::Work() {
+    while (true) {
+        std::pair<std::shared_ptr<TaskGroup>, size_t> item;
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                return;
+            }
+            item = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        if (item.first->Claim(item.second)) {
+            item.first->RunTask(item.second);
+            // the task of a request is done, release what it allocated on the pool thread
+            JitRuntime::get()->ReleaseRunStep();
+        }
+    }
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HYBRIDSE_SRC_VM_RUNNER_POOL_H_
+#define HYBRIDSE_SRC_VM_RUNNER_POOL_H_
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace hybridse {
+namespace vm {
+
+/**
+ * RunnerPool evaluates the independent producers of one runner concurrently.
+ * The calling thread takes part in the work: it runs every task which is not
+ * started by a pool thread yet, so a task can call `Run` recursively without
+ * waiting for a free pool thread.
+ */
+class RunnerPool {
+ public:
+    explicit RunnerPool(uint32_t thread_num);
+    ~RunnerPool();
+    RunnerPool(const RunnerPool&) = delete;
+    RunnerPool& operator=(const RunnerPool&) = delete;
+
+    /**
+     * Run all tasks and return after they are done.
+     */
+    void Run(const std::vector<std::function<void()>>& tasks);
+
+ private:
+    struct TaskGroup;
+
+    void Work();
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::pair<std::shared_ptr<TaskGroup>, size_t>> queue_;
+    bool stop_;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_RUNNER_POOL_H_
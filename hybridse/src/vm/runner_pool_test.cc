@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/runner_pool.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <set>
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+
+class RunnerPoolTest : public ::testing::Test {};
+
+TEST_F(RunnerPoolTest, RunAllTasks) {
+    for (uint32_t thread_num : {0, 1, 4}) {
+        RunnerPool pool(thread_num);
+        std::vector<int> outputs(10, 0);
+        std::vector<std::function<void()>> tasks;
+        for (size_t i = 0; i < outputs.size(); i++) {
+            tasks.push_back([i, &outputs]() { outputs[i] = i * 2; });
+        }
+        pool.Run(tasks);
+        for (size_t i = 0; i < outputs.size(); i++) {
+            ASSERT_EQ(static_cast<int>(i * 2), outputs[i]);
+        }
+    }
+}
+
+TEST_F(RunnerPoolTest, RunConcurrently) {
+    RunnerPool pool(3);
+    std::atomic<int> running(0);
+    std::atomic<int> max_running(0);
+    std::vector<std::function<void()>> tasks;
+    for (int i = 0; i < 4; i++) {
+        tasks.push_back([&running, &max_running]() {
+            int cur = running.fetch_add(1) + 1;
+            int max = max_running.load();
+            while (cur > max && !max_running.compare_exchange_weak(max, cur)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            running.fetch_sub(1);
+        });
+    }
+    pool.Run(tasks);
+    ASSERT_EQ(0, running.load());
+    ASSERT_GT(max_running.load(), 1);
+}
+
+// the tasks call Run recursively with more tasks than the pool threads
+TEST_F(RunnerPoolTest, RunNested) {
+    RunnerPool pool(2);
+    std::atomic<int> cnt(0);
+    std::vector<std::function<void()>> tasks;
+    for (int i = 0; i < 4; i++) {
+        tasks.push_back([&pool, &cnt]() {
+            std::vector<std::function<void()>> sub_tasks;
+            for (int j = 0; j < 4; j++) {
+                sub_tasks.push_back([&cnt]() { cnt.fetch_add(1); });
+            }
+            pool.Run(sub_tasks);
+        });
+    }
+    pool.Run(tasks);
+    ASSERT_EQ(16, cnt.load());
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
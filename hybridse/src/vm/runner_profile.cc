@@ -0,0 +1,66 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/runner_profile.h"
+
+namespace hybridse {
+namespace vm {
+
+void RunnerProfile::Add(int64_t id, const std::string& type, uint64_t time_us, uint64_t rows_in, uint64_t rows_out,
+                        uint64_t bytes_out) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto& stat = stats_[id];
+    if (stat.run_cnt == 0) {
+        stat.id = id;
+        stat.type = type;
+    }
+    stat.run_cnt++;
+    stat.time_us += time_us;
+    stat.rows_in += rows_in;
+    stat.rows_out += rows_out;
+    stat.bytes_out += bytes_out;
+}
+
+std::vector<RunnerStat> RunnerProfile::GetStats() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::vector<RunnerStat> stats;
+    stats.reserve(stats_.size());
+    for (const auto& kv : stats_) {
+        stats.push_back(kv.second);
+    }
+    return stats;
+}
+
+void RunnerProfile::UpdatePeakMemory(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (bytes > peak_memory_) {
+        peak_memory_ = bytes;
+    }
+}
+
+uint64_t RunnerProfile::GetPeakMemory() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return peak_memory_;
+}
+
+void RunnerProfile::Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    stats_.clear();
+    peak_memory_ = 0;
+}
+
+}  // namespace vm
+}  // namespace hybridse
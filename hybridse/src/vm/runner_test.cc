@@ -522,6 +522,50 @@ TEST_F(RunnerTest, RunnerPrintDataMemTimeTableTest) {
         LOG(INFO) << oss.str();
     }
 }
+
+// the partition sort used to stay on the first segment forever
+TEST_F(RunnerTest, SortPartitionTest) {
+    std::vector<Row> rows;
+    hybridse::type::TableDef table_def;
+    BuildRows(table_def, rows);
+    ASSERT_LE(2u, rows.size());
+
+    auto partition = std::make_shared<MemPartitionHandler>();
+    partition->SetOrderType(kDescOrder);
+    for (auto key : {"k1", "k2"}) {
+        partition->AddRow(key, 2000, rows[1]);
+        partition->AddRow(key, 1000, rows[0]);
+    }
+
+    node::NodeManager nm;
+    auto orders = nm.MakeExprList();
+    orders->AddChild(nm.MakeOrderExpression(nullptr, true));
+    Sort sort(nm.MakeOrderByNode(orders));
+    SortGenerator sort_gen(sort);
+    auto output = sort_gen.Sort(std::shared_ptr<PartitionHandler>(partition));
+    ASSERT_TRUE(output);
+    ASSERT_EQ(kAscOrder, output->GetOrderType());
+
+    auto iter = output->GetWindowIterator();
+    ASSERT_TRUE(iter);
+    iter->SeekToFirst();
+    size_t key_cnt = 0;
+    while (iter->Valid()) {
+        auto segment_iter = iter->GetValue();
+        ASSERT_TRUE(segment_iter);
+        segment_iter->SeekToFirst();
+        ASSERT_TRUE(segment_iter->Valid());
+        ASSERT_EQ(1000u, segment_iter->GetKey());
+        segment_iter->Next();
+        ASSERT_TRUE(segment_iter->Valid());
+        ASSERT_EQ(2000u, segment_iter->GetKey());
+        segment_iter->Next();
+        ASSERT_FALSE(segment_iter->Valid());
+        key_cnt++;
+        iter->Next();
+    }
+    ASSERT_EQ(2u, key_cnt);
+}
 }  // namespace vm
 }  // namespace hybridse
 
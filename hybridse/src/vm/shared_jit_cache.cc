@@ -0,0 +1,75 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "vm/shared_jit_cache.h"
+
+#include <algorithm>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace hybridse {
+namespace vm {
+
+std::string SharedJitCache::GetKey(const ::llvm::Module& m, const JitOptions& options) {
+    std::string ir;
+    ::llvm::raw_string_ostream ss(ir);
+    ss << m;
+    ss.flush();
+    ::llvm::SHA1 sha1;
+    sha1.update(ir);
+    std::string flags;
+    for (bool flag : {options.IsEnableOpt(), options.IsEnableMcjit(), options.IsEnableVtune(),
+                      options.IsEnableGdb(), options.IsEnablePerf(), options.IsEnableFastMath()}) {
+        flags.push_back(flag ? '1' : '0');
+    }
+    flags.append(options.GetTargetCpu());
+    sha1.update(flags);
+    return ::llvm::toHex(sha1.result());
+}
+
+std::shared_ptr<HybridSeJitWrapper> SharedJitCache::Get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = jits_.find(key);
+    if (it == jits_.end()) {
+        return nullptr;
+    }
+    return it->second.lock();
+}
+
+void SharedJitCache::Put(const std::string& key, const std::shared_ptr<HybridSeJitWrapper>& jit) {
+    std::lock_guard<std::mutex> lock(mu_);
+    // the released ones are purged once the keys doubled, so the map never grows with the dropped queries
+    if (jits_.size() >= purge_size_) {
+        for (auto it = jits_.begin(); it != jits_.end();) {
+            if (it->second.expired()) {
+                it = jits_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        purge_size_ = std::max(MIN_PURGE_SIZE, jits_.size() * 2);
+    }
+    jits_[key] = jit;
+}
+
+size_t SharedJitCache::GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return jits_.size();
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HYBRIDSE_SRC_VM_SHARED_JIT_CACHE_H_
+#define HYBRIDSE_SRC_VM_SHARED_JIT_CACHE_H_
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "llvm/IR/Module.h"
+#include "vm/engine_context.h"
+#include "vm/jit_wrapper.h"
+
+namespace hybridse {
+namespace vm {
+
+// The jits of the compiled queries keyed by the ir of their modules. A query whose module is identical to
+// one compiled before, e.g. the same deployment compiled in request and batch request mode or on another db
+// of the same tables, resolves its functions from the jit compiled before instead of optimizing and
+// compiling the module once more, only its runners are built on its own. The function names are a part of
+// the ir, so the ones resolved by the physical plan always exist in the shared jit.
+// The jits are held weakly and released with the last compiled query referring to them.
+class SharedJitCache {
+ public:
+    SharedJitCache() : mu_(), jits_(), purge_size_(MIN_PURGE_SIZE) {}
+
+    // the sha1 of the ir before optimization together with the jit options changing the compiled code
+    static std::string GetKey(const ::llvm::Module& m, const JitOptions& options);
+
+    // return null if missing or released
+    std::shared_ptr<HybridSeJitWrapper> Get(const std::string& key);
+
+    void Put(const std::string& key, const std::shared_ptr<HybridSeJitWrapper>& jit);
+
+    // the count of keys including the released ones not purged yet
+    size_t GetSize();
+
+ private:
+    static constexpr size_t MIN_PURGE_SIZE = 64;
+
+    std::mutex mu_;
+    std::unordered_map<std::string, std::weak_ptr<HybridSeJitWrapper>> jits_;
+    // the count of keys to purge the released jits at
+    size_t purge_size_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_SHARED_JIT_CACHE_H_
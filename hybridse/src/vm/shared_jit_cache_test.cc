@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/shared_jit_cache.h"
+
+#include "gtest/gtest.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+
+namespace hybridse {
+namespace vm {
+
+class SharedJitCacheTest : public ::testing::Test {};
+
+class FakeJit : public HybridSeJitWrapper {
+ public:
+    bool Init() override { return true; }
+    bool OptModule(::llvm::Module* module) override { return true; }
+    bool AddModule(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> llvm_ctx) override {
+        return true;
+    }
+    bool AddExternalFunction(const std::string& name, void* addr) override { return true; }
+    hybridse::vm::RawPtrHandle FindFunction(const std::string& funcname) override { return nullptr; }
+};
+
+static void AddFunction(::llvm::Module* m, const std::string& name) {
+    auto fn_type = ::llvm::FunctionType::get(::llvm::Type::getVoidTy(m->getContext()), false);
+    ::llvm::Function::Create(fn_type, ::llvm::Function::ExternalLinkage, name, m);
+}
+
+TEST_F(SharedJitCacheTest, GetKey) {
+    ::llvm::LLVMContext ctx;
+    ::llvm::Module m1("sql", ctx);
+    AddFunction(&m1, "__internal_sql_codegen_0");
+    ::llvm::Module m2("sql", ctx);
+    AddFunction(&m2, "__internal_sql_codegen_0");
+    JitOptions options;
+    ASSERT_EQ(SharedJitCache::GetKey(m1, options), SharedJitCache::GetKey(m2, options));
+    AddFunction(&m2, "__internal_sql_codegen_1");
+    ASSERT_NE(SharedJitCache::GetKey(m1, options), SharedJitCache::GetKey(m2, options));
+    JitOptions no_opt;
+    no_opt.SetEnableOpt(false);
+    ASSERT_NE(SharedJitCache::GetKey(m1, options), SharedJitCache::GetKey(m1, no_opt));
+}
+
+TEST_F(SharedJitCacheTest, GetAndPut) {
+    SharedJitCache cache;
+    ASSERT_FALSE(cache.Get("k1"));
+    std::shared_ptr<HybridSeJitWrapper> jit = std::make_shared<FakeJit>();
+    cache.Put("k1", jit);
+    ASSERT_EQ(jit.get(), cache.Get("k1").get());
+    // released with the last query referring to it
+    jit.reset();
+    ASSERT_FALSE(cache.Get("k1"));
+
+    std::vector<std::shared_ptr<HybridSeJitWrapper>> jits;
+    for (int i = 0; i < 200; i++) {
+        auto cur = std::make_shared<FakeJit>();
+        cache.Put("key" + std::to_string(i), cur);
+        if (i % 2 == 0) {
+            jits.push_back(cur);
+        }
+    }
+    // the released jits are purged
+    ASSERT_LT(cache.GetSize(), 150u);
+    ASSERT_TRUE(cache.Get("key198"));
+    ASSERT_FALSE(cache.Get("key199"));
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -115,6 +115,21 @@ const IndexHint &SimpleCatalogTableHandler::GetIndex() {
     return this->index_hint_;
 }
 
+bool SimpleCatalogTableHandler::GetIndexStatistics(
+    const std::string &index_name, IndexStatistics *stats) {
+    auto it = index_stats_.find(index_name);
+    if (it == index_stats_.end()) {
+        return false;
+    }
+    *stats = it->second;
+    return true;
+}
+
+void SimpleCatalogTableHandler::SetIndexStatistics(
+    const std::string &index_name, const IndexStatistics &stats) {
+    index_stats_[index_name] = stats;
+}
+
 const Schema *SimpleCatalogTableHandler::GetSchema() {
     return &this->table_def_.columns();
 }
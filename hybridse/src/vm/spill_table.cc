@@ -0,0 +1,265 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "vm/spill_table.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <queue>
+
+#include "absl/strings/str_cat.h"
+#include "glog/logging.h"
+
+namespace hybridse {
+namespace vm {
+
+namespace {
+
+// the reader of a run file, on one row of the run at a time
+class RunReader {
+ public:
+    explicit RunReader(const std::string& file) : file_(fopen(file.c_str(), "rb")), key_(0), row_() {
+        if (file_ == nullptr) {
+            LOG(WARNING) << "fail to open the sort run " << file;
+        }
+    }
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+    ~RunReader() {
+        if (file_ != nullptr) {
+            fclose(file_);
+        }
+    }
+
+    // read the next row of the run, return false at the end of the run
+    bool Next() {
+        row_ = Row();
+        uint32_t slice_cnt = 0;
+        if (file_ == nullptr || fread(&key_, sizeof(key_), 1, file_) != 1 ||
+            fread(&slice_cnt, sizeof(slice_cnt), 1, file_) != 1) {
+            return false;
+        }
+        for (uint32_t i = 0; i < slice_cnt; i++) {
+            uint32_t size = 0;
+            if (fread(&size, sizeof(size), 1, file_) != 1) {
+                return false;
+            }
+            int8_t* buf = reinterpret_cast<int8_t*>(malloc(size == 0 ? 1 : size));
+            if (size > 0 && fread(buf, 1, size, file_) != size) {
+                free(buf);
+                LOG(WARNING) << "the sort run is truncated";
+                return false;
+            }
+            auto slice = base::RefCountedSlice::CreateManaged(buf, size);
+            if (i == 0) {
+                row_ = Row(slice);
+            } else {
+                row_.Append(slice);
+            }
+        }
+        return true;
+    }
+
+    const uint64_t& key() const { return key_; }
+    const Row& row() const { return row_; }
+
+ private:
+    FILE* file_;
+    uint64_t key_;
+    Row row_;
+};
+
+// merge the runs by key, the runs are ordered by key and a row of an earlier run goes first on a tie
+class SpillMergeIterator : public RowIterator {
+ public:
+    SpillMergeIterator(std::shared_ptr<SpillRuns> runs, bool is_asc)
+        : runs_(runs), is_asc_(is_asc), readers_(), heads_(HeadCompare{this}) {
+        SeekToFirst();
+    }
+    ~SpillMergeIterator() override {}
+
+    bool Valid() const override { return !heads_.empty(); }
+    void Next() override {
+        size_t run = heads_.top();
+        heads_.pop();
+        if (readers_[run]->Next()) {
+            heads_.push(run);
+        }
+    }
+    const uint64_t& GetKey() const override { return readers_[heads_.top()]->key(); }
+    const Row& GetValue() override { return readers_[heads_.top()]->row(); }
+    bool IsSeekable() const override { return false; }
+    // move to the first row not before key in the order of the table
+    void Seek(const uint64_t& key) override {
+        SeekToFirst();
+        while (Valid() && (is_asc_ ? GetKey() < key : GetKey() > key)) {
+            Next();
+        }
+    }
+    void SeekToFirst() override {
+        heads_ = decltype(heads_)(HeadCompare{this});
+        readers_.clear();
+        for (const auto& file : runs_->files()) {
+            readers_.emplace_back(new RunReader(file));
+            if (readers_.back()->Next()) {
+                heads_.push(readers_.size() - 1);
+            }
+        }
+    }
+
+ private:
+    // the top of the heap is the run of the next row
+    struct HeadCompare {
+        const SpillMergeIterator* it;
+        bool operator()(size_t a, size_t b) const {
+            uint64_t key_a = it->readers_[a]->key();
+            uint64_t key_b = it->readers_[b]->key();
+            if (key_a != key_b) {
+                return it->is_asc_ ? key_a > key_b : key_a < key_b;
+            }
+            return a > b;
+        }
+    };
+
+    std::shared_ptr<SpillRuns> runs_;
+    const bool is_asc_;
+    std::vector<std::unique_ptr<RunReader>> readers_;
+    std::priority_queue<size_t, std::vector<size_t>, HeadCompare> heads_;
+};
+
+std::atomic<uint64_t> run_seq(0);
+
+}  // namespace
+
+SpillRuns::~SpillRuns() {
+    for (const auto& file : files_) {
+        unlink(file.c_str());
+    }
+}
+
+bool SpillRuns::Write(const std::string& dir, const MemTimeTable& rows) {
+    std::string file = absl::StrCat(dir, "/sort_run_", getpid(), "_", run_seq.fetch_add(1));
+    FILE* fd = fopen(file.c_str(), "wb");
+    if (fd == nullptr) {
+        LOG(WARNING) << "fail to create the sort run " << file;
+        return false;
+    }
+    // the file is removed with the runs even if it is written partly
+    files_.push_back(file);
+    bool ok = true;
+    for (const auto& pair : rows) {
+        const Row& row = pair.second;
+        uint32_t slice_cnt = row.GetRowPtrCnt();
+        ok = fwrite(&pair.first, sizeof(pair.first), 1, fd) == 1 && fwrite(&slice_cnt, sizeof(slice_cnt), 1, fd) == 1;
+        for (uint32_t i = 0; ok && i < slice_cnt; i++) {
+            uint32_t size = row.size(i);
+            ok = fwrite(&size, sizeof(size), 1, fd) == 1 && (size == 0 || fwrite(row.buf(i), 1, size, fd) == size);
+        }
+        if (!ok) {
+            break;
+        }
+    }
+    if (fclose(fd) != 0 || !ok) {
+        LOG(WARNING) << "fail to write the sort run " << file;
+        return false;
+    }
+    return true;
+}
+
+ExternalSorter::ExternalSorter(const std::string& dir, uint64_t memory_limit, const Schema* schema, bool is_asc)
+    : dir_(dir),
+      memory_limit_(memory_limit),
+      schema_(schema),
+      is_asc_(is_asc),
+      rows_(),
+      memory_(0),
+      count_(0),
+      runs_(std::make_shared<SpillRuns>()) {}
+
+bool ExternalSorter::Add(uint64_t key, const Row& row) {
+    rows_.push_back(std::make_pair(key, row));
+    count_++;
+    memory_ += sizeof(std::pair<uint64_t, Row>);
+    for (int32_t i = 0; i < row.GetRowPtrCnt(); i++) {
+        memory_ += row.size(i);
+    }
+    if (memory_limit_ > 0 && memory_ > memory_limit_) {
+        return Spill();
+    }
+    return true;
+}
+
+void ExternalSorter::SortRows() {
+    if (is_asc_) {
+        std::stable_sort(rows_.begin(), rows_.end(),
+                         [](const std::pair<uint64_t, Row>& a, const std::pair<uint64_t, Row>& b) {
+                             return a.first < b.first;
+                         });
+    } else {
+        std::stable_sort(rows_.begin(), rows_.end(),
+                         [](const std::pair<uint64_t, Row>& a, const std::pair<uint64_t, Row>& b) {
+                             return a.first > b.first;
+                         });
+    }
+}
+
+bool ExternalSorter::Spill() {
+    SortRows();
+    bool ok = runs_->Write(dir_, rows_);
+    rows_ = MemTimeTable();
+    memory_ = 0;
+    return ok;
+}
+
+std::shared_ptr<TableHandler> ExternalSorter::Finish() {
+    if (runs_->files().empty()) {
+        SortRows();
+        auto table = std::make_shared<MemTimeTableHandler>(schema_);
+        for (const auto& pair : rows_) {
+            table->AddRow(pair.first, pair.second);
+        }
+        table->SetOrderType(is_asc_ ? kAscOrder : kDescOrder);
+        rows_ = MemTimeTable();
+        return table;
+    }
+    if (!rows_.empty() && !Spill()) {
+        return std::shared_ptr<TableHandler>();
+    }
+    DLOG(INFO) << "sort " << count_ << " rows in " << runs_->files().size() << " runs";
+    return std::make_shared<SpillTableHandler>(schema_, runs_, count_, is_asc_);
+}
+
+SpillTableHandler::SpillTableHandler(const Schema* schema, std::shared_ptr<SpillRuns> runs, uint64_t count,
+                                     bool is_asc)
+    : table_name_(""),
+      db_(""),
+      schema_(schema),
+      types_(),
+      index_hint_(),
+      runs_(runs),
+      count_(count),
+      is_asc_(is_asc) {}
+
+std::unique_ptr<RowIterator> SpillTableHandler::GetIterator() {
+    return std::unique_ptr<RowIterator>(GetRawIterator());
+}
+
+RowIterator* SpillTableHandler::GetRawIterator() { return new SpillMergeIterator(runs_, is_asc_); }
+
+}  // namespace vm
+}  // namespace hybridse
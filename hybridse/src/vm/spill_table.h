@@ -0,0 +1,126 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HYBRIDSE_SRC_VM_SPILL_TABLE_H_
+#define HYBRIDSE_SRC_VM_SPILL_TABLE_H_
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "codec/row.h"
+#include "vm/catalog.h"
+#include "vm/mem_catalog.h"
+
+namespace hybridse {
+namespace vm {
+
+/**
+ * The sorted runs of an external sort in files. A run is the rows with
+ * their keys, each written as the key, the count of slices and the size
+ * and bytes of every slice. The files are removed with the last table or
+ * iterator reading them.
+ */
+class SpillRuns {
+ public:
+    SpillRuns() = default;
+    SpillRuns(const SpillRuns&) = delete;
+    SpillRuns& operator=(const SpillRuns&) = delete;
+    ~SpillRuns();
+
+    // write the rows as a new run under dir, return false if the file fails to be written
+    bool Write(const std::string& dir, const MemTimeTable& rows);
+
+    const std::vector<std::string>& files() const { return files_; }
+
+ private:
+    std::vector<std::string> files_;
+};
+
+/**
+ * ExternalSorter sorts the rows of a table by their keys with the memory
+ * bounded by memory_limit. The rows are kept in memory until their bytes
+ * pass the limit, then they are sorted and written to a run file under
+ * dir, and the memory is released. The sorted table merges the runs as it
+ * is iterated, holding one row of every run, so a sort larger than the
+ * memory doesn't fail. A sort within the limit is done in memory.
+ */
+class ExternalSorter {
+ public:
+    ExternalSorter(const std::string& dir, uint64_t memory_limit, const Schema* schema, bool is_asc);
+
+    // return false if a run fails to be spilled
+    bool Add(uint64_t key, const Row& row);
+
+    // the sorted table, null if a run fails to be spilled
+    std::shared_ptr<TableHandler> Finish();
+
+    size_t GetRunCount() const { return runs_->files().size(); }
+
+ private:
+    bool Spill();
+    void SortRows();
+
+    const std::string dir_;
+    const uint64_t memory_limit_;
+    const Schema* schema_;
+    const bool is_asc_;
+    MemTimeTable rows_;
+    uint64_t memory_;
+    uint64_t count_;
+    std::shared_ptr<SpillRuns> runs_;
+};
+
+/**
+ * The table of the runs of an external sort. An iterator opens every run
+ * and merges them by key, the rows of equal keys come in the order they
+ * were added. It is read forward only, as a sorted table is read by the
+ * runners of batch mode.
+ */
+class SpillTableHandler : public TableHandler {
+ public:
+    SpillTableHandler(const Schema* schema, std::shared_ptr<SpillRuns> runs, uint64_t count, bool is_asc);
+    ~SpillTableHandler() override {}
+
+    const Types& GetTypes() override { return types_; }
+    const IndexHint& GetIndex() override { return index_hint_; }
+    const Schema* GetSchema() override { return schema_; }
+    const std::string& GetName() override { return table_name_; }
+    const std::string& GetDatabase() override { return db_; }
+    std::unique_ptr<WindowIterator> GetWindowIterator(const std::string& idx_name) override {
+        return std::unique_ptr<WindowIterator>();
+    }
+    std::unique_ptr<RowIterator> GetIterator() override;
+    RowIterator* GetRawIterator() override;
+    const uint64_t GetCount() override { return count_; }
+    const OrderType GetOrderType() const override { return is_asc_ ? kAscOrder : kDescOrder; }
+    const std::string GetHandlerTypeName() override { return "SpillTableHandler"; }
+
+ private:
+    const std::string table_name_;
+    const std::string db_;
+    const Schema* schema_;
+    Types types_;
+    IndexHint index_hint_;
+    std::shared_ptr<SpillRuns> runs_;
+    const uint64_t count_;
+    const bool is_asc_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_SPILL_TABLE_H_
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/spill_table.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+
+class SpillTableTest : public ::testing::Test {};
+
+static std::vector<std::pair<uint64_t, std::string>> ReadAll(std::shared_ptr<TableHandler> table) {
+    std::vector<std::pair<uint64_t, std::string>> rows;
+    auto iter = table->GetIterator();
+    iter->SeekToFirst();
+    while (iter->Valid()) {
+        rows.emplace_back(iter->GetKey(), iter->GetValue().ToString());
+        iter->Next();
+    }
+    return rows;
+}
+
+TEST_F(SpillTableTest, SortInMemory) {
+    ExternalSorter sorter("/tmp", 0, nullptr, true);
+    ASSERT_TRUE(sorter.Add(3, codec::Row("c")));
+    ASSERT_TRUE(sorter.Add(1, codec::Row("a")));
+    ASSERT_TRUE(sorter.Add(2, codec::Row("b")));
+    auto table = sorter.Finish();
+    ASSERT_EQ(0u, sorter.GetRunCount());
+    ASSERT_EQ("MemTimeTableHandler", table->GetHandlerTypeName());
+    std::vector<std::pair<uint64_t, std::string>> expect = {{1, "a"}, {2, "b"}, {3, "c"}};
+    ASSERT_EQ(expect, ReadAll(table));
+}
+
+TEST_F(SpillTableTest, SpillAndMerge) {
+    char dir[] = "/tmp/spill_table_test_XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir) != nullptr);
+    {
+        // a run of every two rows
+        ExternalSorter sorter(dir, 2 * (sizeof(std::pair<uint64_t, codec::Row>) + 2) - 1, nullptr, false);
+        std::vector<uint64_t> keys = {5, 1, 7, 3, 5, 2, 8};
+        for (size_t i = 0; i < keys.size(); i++) {
+            ASSERT_TRUE(sorter.Add(keys[i], codec::Row("r" + std::to_string(i))));
+        }
+        auto table = sorter.Finish();
+        ASSERT_EQ(4u, sorter.GetRunCount());
+        ASSERT_EQ("SpillTableHandler", table->GetHandlerTypeName());
+        ASSERT_EQ(7u, table->GetCount());
+        ASSERT_EQ(kDescOrder, table->GetOrderType());
+        // the rows of equal keys keep the order they were added in
+        std::vector<std::pair<uint64_t, std::string>> expect = {{8, "r6"}, {7, "r2"}, {5, "r0"}, {5, "r4"},
+                                                                {3, "r3"}, {2, "r5"}, {1, "r1"}};
+        ASSERT_EQ(expect, ReadAll(table));
+        // a table is read again from the start
+        ASSERT_EQ(expect, ReadAll(table));
+
+        auto iter = table->GetIterator();
+        iter->Seek(4);
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(3u, iter->GetKey());
+        ASSERT_EQ("r3", iter->GetValue().ToString());
+    }
+    // the runs are removed with the table, so the dir is empty
+    ASSERT_EQ(0, rmdir(dir));
+}
+
+TEST_F(SpillTableTest, MultiSliceRow) {
+    ExternalSorter sorter("/tmp", 1, nullptr, true);
+    codec::Row row(1, codec::Row("left"), 1, codec::Row("right"));
+    ASSERT_TRUE(sorter.Add(2, row));
+    ASSERT_TRUE(sorter.Add(1, codec::Row("single")));
+    auto table = sorter.Finish();
+    ASSERT_EQ(2u, sorter.GetRunCount());
+    auto iter = table->GetIterator();
+    iter->SeekToFirst();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(1, iter->GetValue().GetRowPtrCnt());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(2, iter->GetValue().GetRowPtrCnt());
+    ASSERT_EQ("left", std::string(reinterpret_cast<char*>(iter->GetValue().buf(0)), iter->GetValue().size(0)));
+    ASSERT_EQ("right", std::string(reinterpret_cast<char*>(iter->GetValue().buf(1)), iter->GetValue().size(1)));
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -15,7 +15,11 @@
  */
 
 #include "vm/sql_compiler.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 #include "boost/filesystem.hpp"
@@ -26,11 +30,17 @@
 #include "codegen/fn_ir_builder.h"
 #include "codegen/ir_base_builder.h"
 #include "glog/logging.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "plan/plan_api.h"
 #include "udf/default_udf_library.h"
 #include "vm/runner.h"
+#include "vm/runner_pool.h"
 #include "vm/transform.h"
 #include "vm/engine.h"
 
@@ -49,6 +59,10 @@ SqlCompiler::SqlCompiler(const std::shared_ptr<Catalog>& cl, bool keep_ir,
 
 SqlCompiler::~SqlCompiler() {}
 
+static uint64_t ElapsedUs(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
 void SqlCompiler::KeepIR(SqlContext& ctx, llvm::Module* m) {
     if (m == NULL) {
         LOG(WARNING) << "module is null";
@@ -62,7 +76,10 @@ void SqlCompiler::KeepIR(SqlContext& ctx, llvm::Module* m) {
 }
 
 bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
+    ctx.compile_times = CompileTimes();
+    auto start = std::chrono::steady_clock::now();
     bool ok = Parse(ctx, status);
+    ctx.compile_times.parse_us = ElapsedUs(start);
     if (!ok) {
         return false;
     }
@@ -81,11 +98,15 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
     auto m = ::llvm::make_unique<::llvm::Module>("sql", *llvm_ctx);
     ctx.udf_library = udf::DefaultUdfLibrary::get();
 
+    start = std::chrono::steady_clock::now();
     status =
         BuildPhysicalPlan(&ctx, ctx.logical_plan, m.get(), &ctx.physical_plan);
     if (!status.isOK()) {
         return false;
     }
+    // the functions are generated while the plan is built
+    uint64_t plan_us = ElapsedUs(start);
+    ctx.compile_times.plan_us = plan_us - std::min(plan_us, ctx.compile_times.codegen_us);
 
     if (nullptr == ctx.physical_plan) {
         status.msg = "error: generate null physical plan";
@@ -104,10 +125,14 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
         LOG(WARNING) << "fail to encode output schema";
         return false;
     }
+    ctx.ir_instruction_cnt = m->getInstructionCount();
     if (plan_only_) {
         return true;
     }
-    if (llvm::verifyModule(*(m.get()), &llvm::errs(), nullptr)) {
+    start = std::chrono::steady_clock::now();
+    bool broken = llvm::verifyModule(*(m.get()), &llvm::errs(), nullptr);
+    ctx.compile_times.codegen_us += ElapsedUs(start);
+    if (broken) {
         LOG(WARNING) << "fail to verify codegen module";
         status.msg = "fail to verify codegen module";
         status.code = common::kCodegenError;
@@ -115,6 +140,19 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
         return false;
     }
     // ::llvm::errs() << *(m.get());
+    std::string jit_key;
+    if (shared_jits_ != nullptr && !keep_ir_) {
+        jit_key = SharedJitCache::GetKey(*m, ctx.jit_options);
+        auto shared_jit = shared_jits_->Get(jit_key);
+        if (shared_jit) {
+            if (!ResolvePlanFnAddress(ctx.physical_plan, shared_jit, status)) {
+                return false;
+            }
+            ctx.jit = shared_jit;
+            DLOG(INFO) << "compile sql " << ctx.sql << " done with shared jit";
+            return true;
+        }
+    }
     auto jit = std::shared_ptr<HybridSeJitWrapper>(
         HybridSeJitWrapper::Create(ctx.jit_options));
     if (jit == nullptr || !jit->Init()) {
@@ -125,13 +163,35 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
     }
     InitBuiltinJitSymbols(jit.get());
     ctx.udf_library->InitJITSymbols(jit.get());
+    if (ctx.jit_options.GetCompileParallelism() > 1 &&
+        !ctx.jit_options.IsEnableMcjit() && !keep_ir_) {
+        start = std::chrono::steady_clock::now();
+        if (!AddModuleParallel(ctx, std::move(m), jit.get(), status)) {
+            return false;
+        }
+        if (!ResolvePlanFnAddress(ctx.physical_plan, jit, status)) {
+            return false;
+        }
+        // the optimize time is taken by AddModuleParallel
+        uint64_t jit_us = ElapsedUs(start);
+        ctx.compile_times.link_us = jit_us - std::min(jit_us, ctx.compile_times.optimize_us);
+        ctx.jit = jit;
+        if (!jit_key.empty()) {
+            shared_jits_->Put(jit_key, jit);
+        }
+        DLOG(INFO) << "compile sql " << ctx.sql << " done";
+        return true;
+    }
+    start = std::chrono::steady_clock::now();
     if (!jit->OptModule(m.get())) {
         LOG(WARNING) << "fail to opt ir module for sql " << ctx.sql;
         return false;
     }
+    ctx.compile_times.optimize_us = ElapsedUs(start);
     if (keep_ir_) {
         KeepIR(ctx, m.get());
     }
+    start = std::chrono::steady_clock::now();
     if (!jit->AddModule(std::move(m), std::move(llvm_ctx))) {
         LOG(WARNING) << "fail to add ir module  for sql " << ctx.sql;
         return false;
@@ -139,11 +199,107 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
     if (!ResolvePlanFnAddress(ctx.physical_plan, jit, status)) {
         return false;
     }
+    ctx.compile_times.link_us = ElapsedUs(start);
     ctx.jit = jit;
+    if (!jit_key.empty()) {
+        shared_jits_->Put(jit_key, jit);
+    }
     DLOG(INFO) << "compile sql " << ctx.sql << " done";
     return true;
 }
 
+bool SqlCompiler::AddModuleParallel(SqlContext& ctx, std::unique_ptr<::llvm::Module> m,
+                                    HybridSeJitWrapper* jit, Status& status) {
+    uint32_t parallelism = ctx.jit_options.GetCompileParallelism();
+    size_t fn_cnt = 0;
+    for (const auto& fn : *m) {
+        if (!fn.isDeclaration()) {
+            fn_cnt++;
+        }
+    }
+    uint32_t part_cnt = std::min(static_cast<size_t>(parallelism), std::max(fn_cnt, static_cast<size_t>(1)));
+    // a context is not thread safe, so every partition is moved to its own
+    // context through bitcode before optimized on a pool thread
+    std::vector<::llvm::SmallVector<char, 0>> bitcodes;
+    ::llvm::SplitModule(std::move(m), part_cnt, [&bitcodes](std::unique_ptr<::llvm::Module> part) {
+        bitcodes.emplace_back();
+        ::llvm::raw_svector_ostream os(bitcodes.back());
+        ::llvm::WriteBitcodeToFile(*part, os);
+    });
+    size_t n = bitcodes.size();
+    std::vector<std::unique_ptr<::llvm::LLVMContext>> contexts(n);
+    std::vector<std::unique_ptr<::llvm::Module>> parts(n);
+    std::vector<std::string> entries(n);
+    std::vector<std::string> errors(n);
+    std::vector<std::function<void()>> tasks;
+    for (size_t i = 0; i < n; i++) {
+        tasks.emplace_back([&, i]() {
+            contexts[i] = ::llvm::make_unique<::llvm::LLVMContext>();
+            auto buf = ::llvm::MemoryBufferRef(::llvm::StringRef(bitcodes[i].data(), bitcodes[i].size()),
+                                               "sql_part_" + std::to_string(i));
+            auto part = ::llvm::parseBitcodeFile(buf, *contexts[i]);
+            if (!part) {
+                errors[i] = ::llvm::toString(part.takeError());
+                return;
+            }
+            parts[i] = std::move(*part);
+            for (const auto& fn : *parts[i]) {
+                if (!fn.isDeclaration()) {
+                    entries[i] = fn.getName().str();
+                    break;
+                }
+            }
+            if (!jit->OptModule(parts[i].get())) {
+                errors[i] = "fail to opt ir module";
+            }
+        });
+    }
+    RunnerPool pool(parallelism - 1);
+    auto start = std::chrono::steady_clock::now();
+    pool.Run(tasks);
+    ctx.compile_times.optimize_us = ElapsedUs(start);
+    for (size_t i = 0; i < n; i++) {
+        if (!errors[i].empty()) {
+            status.msg = "fail to opt partition " + std::to_string(i) + ": " + errors[i];
+            status.code = common::kJitError;
+            LOG(WARNING) << status << " for sql " << ctx.sql;
+            return false;
+        }
+    }
+    // all partitions are added before any lookup since they refer to each other
+    for (size_t i = 0; i < n; i++) {
+        if (!jit->AddModule(std::move(parts[i]), std::move(contexts[i]))) {
+            status.msg = "fail to add ir module partition " + std::to_string(i);
+            status.code = common::kJitError;
+            LOG(WARNING) << status << " for sql " << ctx.sql;
+            return false;
+        }
+    }
+    // look up one function of every partition concurrently to compile them
+    // on the compile threads of jit
+    tasks.clear();
+    for (size_t i = 0; i < n; i++) {
+        if (entries[i].empty()) {
+            continue;
+        }
+        tasks.emplace_back([&, i]() {
+            if (nullptr == jit->FindFunction(entries[i])) {
+                errors[i] = "fail to compile function " + entries[i];
+            }
+        });
+    }
+    pool.Run(tasks);
+    for (size_t i = 0; i < n; i++) {
+        if (!errors[i].empty()) {
+            status.msg = errors[i];
+            status.code = common::kJitError;
+            LOG(WARNING) << status << " for sql " << ctx.sql;
+            return false;
+        }
+    }
+    return true;
+}
+
 std::string EngineModeName(EngineMode mode) {
     switch (mode) {
         case kBatchMode:
@@ -166,8 +322,10 @@ Status SqlCompiler::BuildBatchModePhysicalPlan(SqlContext* ctx, const ::hybridse
                                          ctx->is_cluster_optimized, ctx->enable_expr_optimize,
                                          ctx->enable_batch_window_parallelization, ctx->enable_window_column_pruning,
                                          ctx->options.get());
+    transformer.SetEnableBlockProject(ctx->enable_block_project);
     transformer.AddDefaultPasses();
     CHECK_STATUS(transformer.TransformPhysicalPlan(plan_list, output), "Fail to generate physical plan batch mode");
+    ctx->compile_times.codegen_us = transformer.GetCodegenTime();
     ctx->schema = *(*output)->GetOutputSchema();
     return Status::OK();
 }
@@ -186,6 +344,7 @@ Status SqlCompiler::BuildRequestModePhysicalPlan(SqlContext* ctx, const ::hybrid
     transformer.AddDefaultPasses();
     CHECK_STATUS(transformer.TransformPhysicalPlan(plan_list, output),
                  "Fail to transform physical plan on request mode");
+    ctx->compile_times.codegen_us = transformer.GetCodegenTime();
 
     ctx->request_schema = transformer.request_schema();
     CHECK_TRUE(codec::SchemaCodec::Encode(transformer.request_schema(), &ctx->encoded_request_schema), kPlanError,
@@ -212,6 +371,7 @@ Status SqlCompiler::BuildBatchRequestModePhysicalPlan(SqlContext* ctx, const ::h
     CHECK_STATUS(transformer.TransformPhysicalPlan(plan_list, &output_plan),
                  "Fail to generate physical plan (batch request mode)");
     *output = output_plan;
+    ctx->compile_times.codegen_us = transformer.GetCodegenTime();
 
     ctx->request_schema = transformer.request_schema();
     CHECK_TRUE(codec::SchemaCodec::Encode(transformer.request_schema(),
@@ -409,6 +569,9 @@ bool SqlCompiler::ResolvePlanFnAddress(vm::PhysicalOpNode* node,
                                  << *node;
                 }
                 const_cast<FnInfo*>(info_ptr)->SetFnPtr(addr);
+                if (!info_ptr->block_fn_name().empty()) {
+                    const_cast<FnInfo*>(info_ptr)->SetBlockFnPtr(jit->FindFunction(info_ptr->block_fn_name()));
+                }
             }
         }
     }
@@ -17,6 +17,7 @@
 #ifndef HYBRIDSE_SRC_VM_SQL_COMPILER_H_
 #define HYBRIDSE_SRC_VM_SQL_COMPILER_H_
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -31,12 +32,28 @@
 #include "vm/jit_wrapper.h"
 #include "vm/physical_op.h"
 #include "vm/runner.h"
+#include "vm/shared_jit_cache.h"
 
 namespace hybridse {
 namespace vm {
 
 using hybridse::base::Status;
 
+// the microseconds spent in the phases of compiling a sql, zero for the phases skipped, e.g. the jit phases of a
+// sql reusing a shared jit
+struct CompileTimes {
+    // parsing the sql into the logical plan
+    uint64_t parse_us = 0;
+    // transforming the logical plan into the physical plan and running the passes on it
+    uint64_t plan_us = 0;
+    // generating and verifying the ir of the functions of the plan
+    uint64_t codegen_us = 0;
+    // running the llvm passes on the ir
+    uint64_t optimize_us = 0;
+    // emitting the machine code, adding it to the jit and resolving the functions of the plan
+    uint64_t link_us = 0;
+};
+
 struct SqlContext {
     // mode: batch|request|batch request
     ::hybridse::vm::EngineMode engine_mode;
@@ -45,6 +62,8 @@ struct SqlContext {
     bool enable_expr_optimize = false;
     bool enable_batch_window_parallelization = true;
     bool enable_window_column_pruning = false;
+    // project a block of rows in one call for the table projects of batch mode
+    bool enable_block_project = false;
 
     // the sql content
     std::string sql;
@@ -66,6 +85,9 @@ struct SqlContext {
     uint32_t row_size;
     uint32_t limit_cnt = 0;
     std::string ir;
+    // the count of ir instructions generated for the plan
+    uint64_t ir_instruction_cnt = 0;
+    CompileTimes compile_times;
     std::string logical_plan_str;
     std::string physical_plan_str;
     std::string encoded_schema;
@@ -92,6 +114,9 @@ class SqlCompileInfo : public CompileInfo {
         return buf.CopyFrom(str.data(), str.size());
     }
     size_t GetIRSize() { return this->sql_ctx.ir.size(); }
+    uint64_t GetJitCodeSize() const override { return sql_ctx.jit ? sql_ctx.jit->GetCodeSize() : 0; }
+    uint64_t GetJitDataSize() const override { return sql_ctx.jit ? sql_ctx.jit->GetDataSize() : 0; }
+    uint64_t GetIRInstructionCount() const override { return sql_ctx.ir_instruction_cnt; }
 
     const hybridse::vm::Schema& GetSchema() const { return sql_ctx.schema; }
 
@@ -142,8 +167,24 @@ class SqlCompileInfo : public CompileInfo {
         return dynamic_cast<SqlCompileInfo*>(node);
     }
 
+    /// Return the run count including this one
+    uint64_t IncRunCount() { return run_cnt_.fetch_add(1, std::memory_order_relaxed) + 1; }
+    /// Add `cnt` to the run count, return the run count before
+    uint64_t AddRunCount(uint64_t cnt) { return run_cnt_.fetch_add(cnt, std::memory_order_relaxed); }
+
+    /// Return the compile info recompiled with full optimization to run
+    /// instead of this one, null if it is not ready
+    std::shared_ptr<CompileInfo> GetOptimizedInfo() const {
+        return std::atomic_load_explicit(&optimized_info_, std::memory_order_acquire);
+    }
+    void SetOptimizedInfo(const std::shared_ptr<CompileInfo>& info) {
+        std::atomic_store_explicit(&optimized_info_, info, std::memory_order_release);
+    }
+
  private:
     hybridse::vm::SqlContext sql_ctx;
+    std::atomic<uint64_t> run_cnt_{0};
+    std::shared_ptr<CompileInfo> optimized_info_;
 };
 
 class SqlCompiler {
@@ -153,6 +194,10 @@ class SqlCompiler {
 
     ~SqlCompiler();
 
+    // share the jits among the queries whose module is identical, null to compile every query on its own jit.
+    // it is not used if the ir is kept
+    void SetSharedJitCache(SharedJitCache* cache) { shared_jits_ = cache; }
+
     bool Compile(SqlContext& ctx,                 // NOLINT
                  Status& status);                 // NOLINT
     bool Parse(SqlContext& ctx, Status& status);  // NOLINT
@@ -162,6 +207,13 @@ class SqlCompiler {
  private:
     void KeepIR(SqlContext& ctx, llvm::Module* m);  // NOLINT
 
+    // split the module into partitions, and optimize then compile them
+    // with `jit_options.GetCompileParallelism()` threads
+    bool AddModuleParallel(SqlContext& ctx,  // NOLINT
+                           std::unique_ptr<::llvm::Module> m,
+                           HybridSeJitWrapper* jit,
+                           Status& status);  // NOLINT
+
     bool ResolvePlanFnAddress(
         PhysicalOpNode* node,
         std::shared_ptr<HybridSeJitWrapper>& jit,  // NOLINT
@@ -189,6 +241,7 @@ class SqlCompiler {
     bool keep_ir_;
     bool dump_plan_;
     bool plan_only_;
+    SharedJitCache* shared_jits_ = nullptr;
 };
 
 }  // namespace vm
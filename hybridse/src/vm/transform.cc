@@ -15,6 +15,7 @@
  */
 
 #include "vm/transform.h"
+#include <chrono>  // NOLINT
 #include <set>
 #include <stack>
 #include <unordered_map>
@@ -26,6 +27,7 @@
 #include "vm/schemas_context.h"
 
 #include "passes/expression/expr_pass.h"
+#include "passes/expression/window_iter_analysis.h"
 #include "passes/lambdafy_projects.h"
 #include "passes/physical/batch_request_optimize.h"
 #include "passes/physical/cluster_optimized.h"
@@ -284,6 +286,10 @@ Status BatchModeTransformer::InitFnInfo(PhysicalOpNode* node,
                                           node->producers()[0]));
             CHECK_STATUS(GenRequestWindow(&request_union_op->agg_window_,
                                           node->producers()[2]));
+            size_t level = 3;
+            for (auto& agg_window : request_union_op->level_agg_windows_) {
+                CHECK_STATUS(GenRequestWindow(&agg_window, node->producers()[level++]));
+            }
             break;
         }
         case kPhysicalOpPostRequestUnion: {
@@ -307,6 +313,11 @@ Status BatchModeTransformer::InitFnInfo(PhysicalOpNode* node,
         CHECK_STATUS(InstantiateLLVMFunction(*fn_infos[i]), "Instantiate ", i,
                      "th native function \"", fn_info->fn_name(),
                      "\" failed at node:\n", node->GetTreeString());
+        if (enable_block_project_ && node->GetOpType() == kPhysicalOpProject &&
+            dynamic_cast<PhysicalProjectNode*>(node)->project_type_ == kTableProject) {
+            CHECK_STATUS(InstantiateLLVMBlockFunction(*fn_info), "Instantiate block function of \"",
+                         fn_info->fn_name(), "\" failed at node:\n", node->GetTreeString());
+        }
     }
     return Status::OK();
 }
@@ -945,6 +956,16 @@ Status BatchModeTransformer::InstantiateLLVMFunction(const FnInfo& fn_info) {
                          *fn_info.fn_schema());
 }
 
+Status BatchModeTransformer::InstantiateLLVMBlockFunction(const FnInfo& fn_info) {
+    codegen::CodeGenContext codegen_ctx(module_, fn_info.schemas_ctx(), plan_ctx_.parameter_types(), node_manager_);
+    codegen::RowFnLetIRBuilder builder(&codegen_ctx);
+    std::string name = fn_info.fn_name() + "_block";
+    CHECK_STATUS(builder.BuildBlock(name, fn_info.fn_name()));
+    // the address is resolved with the one of the row function after jit
+    const_cast<FnInfo&>(fn_info).SetBlockFnName(name);
+    return Status::OK();
+}
+
 bool BatchModeTransformer::AddDefaultPasses() {
     AddPass(PhysicalPlanPassType::kPassColumnProjectsOptimized);
     AddPass(PhysicalPlanPassType::kPassFilterOptimized);
@@ -1702,8 +1723,12 @@ Status BatchModeTransformer::TransformPhysicalPlan(const ::hybridse::node::PlanN
                 DLOG(INFO) << "After optimization: \n" << optimized_physical_plan->GetTreeString();
                 CHECK_STATUS(ValidatePlan(optimized_physical_plan));
                 std::set<PhysicalOpNode*> node_visited_dict;
+                auto codegen_start = std::chrono::steady_clock::now();
                 CHECK_STATUS(InitFnInfo(optimized_physical_plan, &node_visited_dict),
                              "Fail to generate functions for physical plan");
+                codegen_us_ += std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now() - codegen_start)
+                                   .count();
                 *output = optimized_physical_plan;
                 break;
             }
@@ -2247,6 +2272,24 @@ Status RequestModeTransformer::ValidateRequestTable(
     return Status::OK();
 }
 
+// stop the scan of the request window at the newest rows that the projects read, if they are bounded
+void RequestModeTransformer::BoundWindowRows(const node::ProjectListNode* project_list, PhysicalOpNode* window) {
+    if (window->GetOpType() == kPhysicalOpJoin) {
+        window = window->GetProducer(0);
+    }
+    if (window->GetOpType() != kPhysicalOpRequestUnion) {
+        return;
+    }
+    uint64_t rows = 0;
+    for (auto project : project_list->GetProjects()) {
+        auto expr = dynamic_cast<const node::ProjectNode*>(project)->GetExpression();
+        if (!passes::WindowIterAnalysis::GetRowsBound(GetPlanContext()->library(), expr, &rows)) {
+            return;
+        }
+    }
+    dynamic_cast<PhysicalRequestUnionNode*>(window)->window_.range_.set_rows_bound(rows);
+}
+
 Status RequestModeTransformer::TransformProjectOp(
     node::ProjectListNode* project_list, PhysicalOpNode* depend,
     bool append_input, PhysicalOpNode** output) {
@@ -2254,6 +2297,7 @@ Status RequestModeTransformer::TransformProjectOp(
     if (nullptr != project_list->GetW()) {
         CHECK_STATUS(
             TransformWindowOp(depend, project_list->GetW(), &new_depend));
+        BoundWindowRows(project_list, new_depend);
     }
     switch (new_depend->GetOutputType()) {
         case kSchemaTypeRow:
@@ -117,6 +117,12 @@ class BatchModeTransformer {
 
     bool AddPass(PhysicalPlanPassType type);
 
+    // generate the functions projecting a block of rows in one call for the table projects
+    void SetEnableBlockProject(bool flag) { enable_block_project_ = flag; }
+
+    // the microseconds spent in generating the functions of the plan
+    uint64_t GetCodegenTime() const { return codegen_us_; }
+
     typedef std::unordered_map<LogicalOp, ::hybridse::vm::PhysicalOpNode*,
                                HashLogicalOp, EqualLogicalOp>
         LogicalOpMap;
@@ -218,6 +224,7 @@ class BatchModeTransformer {
      * Instantiate underlying llvm function with specified fn info.
      */
     Status InstantiateLLVMFunction(const FnInfo& fn_info);
+    Status InstantiateLLVMBlockFunction(const FnInfo& fn_info);
 
     Status GenWindowJoinList(PhysicalWindowAggrerationNode* window_agg_op,
                              PhysicalOpNode* in);
@@ -253,6 +260,8 @@ class BatchModeTransformer {
     bool cluster_optimized_mode_;
     bool enable_batch_window_parallelization_;
     bool enable_batch_window_column_pruning_;
+    bool enable_block_project_ = false;
+    uint64_t codegen_us_ = 0;
     std::vector<PhysicalPlanPassType> passes;
     LogicalOpMap op_map_;
     const udf::UdfLibrary* library_;
@@ -294,6 +303,8 @@ class RequestModeTransformer : public BatchModeTransformer {
     Status TransformLoadDataOp(const node::LoadDataPlanNode* node, PhysicalOpNode** output) override;
 
  private:
+    void BoundWindowRows(const node::ProjectListNode* project_list, PhysicalOpNode* window);
+
     bool enable_batch_request_opt_;
     bool performance_sensitive_;
     vm::Schema request_schema_;
@@ -634,6 +634,197 @@ TEST_F(TransformRequestModePassOptimizedTest, LongWindowOptimizedTest) {
     PhysicalPlanCheck(catalog, sql, expected, extra_passes, &options);
 }
 
+TEST_F(TransformRequestModePassOptimizedTest, LongWindowOptimizedWhereTest) {
+    const std::string sql =
+        "SELECT col1, sum_where(col2, col_bool) OVER w1, col2+1, add(col2, col1), count_where(col2, col_bool) OVER w1, "
+        "sum(col2) over w2 as w1_col2_sum , sum(col2) over w3 FROM t1\n"
+        "WINDOW w1 AS (PARTITION BY col1 ORDER BY col5 ROWS_RANGE BETWEEN 3m PRECEDING AND CURRENT ROW),"
+        "w2 AS (PARTITION BY col1,col2 ORDER BY col5 ROWS_RANGE BETWEEN 3 PRECEDING AND CURRENT ROW),"
+        "w3 AS (PARTITION BY col1 ORDER BY col5 ROWS_RANGE BETWEEN 3 PRECEDING AND CURRENT ROW);";
+
+    const std::string expected =
+        "SIMPLE_PROJECT(sources=(col1, sum_where(col2, col_bool)over w1, col2 + 1, add(col2, col1), "
+        "count_where(col2, col_bool)over w1, w1_col2_sum, "
+        "sum(col2)over w3))\n"
+        "  REQUEST_JOIN(type=kJoinTypeConcat)\n"
+        "    REQUEST_JOIN(type=kJoinTypeConcat)\n"
+        "      REQUEST_JOIN(type=kJoinTypeConcat)\n"
+        "        PROJECT(type=RowProject)\n"
+        "          DATA_PROVIDER(request=t1)\n"
+        "        SIMPLE_PROJECT(sources=(sum_where(col2, col_bool)over w1, count_where(col2, col_bool)over w1))\n"
+        "          REQUEST_JOIN(type=kJoinTypeConcat)\n"
+        "            PROJECT(type=ReduceAggregation: sum_where(col2, col_bool)over w1 (range[-180000,0]))\n"
+        "              REQUEST_AGG_UNION(partition_keys=(), orders=(ASC), range=(col5, -180000, 0), "
+        "index_keys=(col1))\n"
+        "                DATA_PROVIDER(request=t1)\n"
+        "                DATA_PROVIDER(type=Partition, table=t1, index=index1)\n"
+        "                DATA_PROVIDER(type=Partition, table=aggr_t1, index=index1_t2)\n"
+        "            PROJECT(type=ReduceAggregation: count_where(col2, col_bool)over w1 (range[-180000,0]))\n"
+        "              REQUEST_AGG_UNION(partition_keys=(), orders=(ASC), range=(col5, -180000, 0), "
+        "index_keys=(col1))\n"
+        "                DATA_PROVIDER(request=t1)\n"
+        "                DATA_PROVIDER(type=Partition, table=t1, index=index1)\n"
+        "                DATA_PROVIDER(type=Partition, table=aggr_t1, index=index1_t2)\n"
+        "      PROJECT(type=ReduceAggregation: sum(col2)over w2 (range[-3,0]))\n"
+        "        REQUEST_AGG_UNION(partition_keys=(), orders=(ASC), range=(col5, -3, 0), index_keys=(col1,col2))\n"
+        "          DATA_PROVIDER(request=t1)\n"
+        "          DATA_PROVIDER(type=Partition, table=t1, index=index12)\n"
+        "          DATA_PROVIDER(type=Partition, table=aggr_t1, index=index1_t2)\n"
+        "    PROJECT(type=Aggregation)\n"
+        "      REQUEST_UNION(partition_keys=(), orders=(ASC), range=(col5, -3, 0), index_keys=(col1))\n"
+        "        DATA_PROVIDER(request=t1)\n"
+        "        DATA_PROVIDER(type=Partition, table=t1, index=index1)";
+
+    std::shared_ptr<SimpleCatalog> catalog(new SimpleCatalog(true));
+    hybridse::type::TableDef table_def;
+    BuildTableDef(table_def);
+    table_def.set_name("t1");
+    {
+        ::hybridse::type::ColumnDef* column = table_def.add_columns();
+        column->set_type(::hybridse::type::kBool);
+        column->set_name("col_bool");
+    }
+    {
+        ::hybridse::type::IndexDef* index = table_def.add_indexes();
+        index->set_name("index12");
+        index->add_first_keys("col1");
+        index->add_first_keys("col2");
+        index->set_second_key("col5");
+    }
+    {
+        ::hybridse::type::IndexDef* index = table_def.add_indexes();
+        index->set_name("index1");
+        index->add_first_keys("col1");
+        index->set_second_key("col5");
+    }
+    hybridse::type::Database db;
+    db.set_name("db");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    {
+        hybridse::type::TableDef table_def;
+        BuildAggTableDef(table_def, "aggr_t1", "aggr_db");
+        ::hybridse::type::IndexDef* index = table_def.add_indexes();
+        index->set_name("index1_t2");
+        index->add_first_keys("key");
+        index->set_second_key("ts_start");
+        hybridse::type::Database db;
+        db.set_name("aggr_db");
+        AddTable(db, table_def);
+        catalog->AddDatabase(db);
+    }
+
+    std::unordered_map<std::string, std::string> options;
+    options[LONG_WINDOWS] = "w1:1000, w2";
+    std::vector<passes::PhysicalPlanPassType> extra_passes = {passes::kPassSplitAggregationOptimized,
+                                                              passes::kPassLongWindowOptimized};
+    PhysicalPlanCheck(catalog, sql, expected, extra_passes, &options);
+}
+
+// the pre-aggr tables of the hour and day buckets, the day one comes first
+class MultiLevelAggrCatalog : public SimpleCatalog {
+ public:
+    MultiLevelAggrCatalog() : SimpleCatalog(true) {}
+    std::vector<AggrTableInfo> GetAggrTables(const std::string& base_db, const std::string& base_table,
+                                             const std::string& aggr_func, const std::string& aggr_col,
+                                             const std::string& partition_cols,
+                                             const std::string& order_col) override {
+        AggrTableInfo day = {"aggr_t1_1d", "aggr_db", base_db, base_table,
+                             aggr_func, aggr_col, partition_cols, order_col, "1d"};
+        AggrTableInfo hour = {"aggr_t1_1h", "aggr_db", base_db, base_table,
+                              aggr_func, aggr_col, partition_cols, order_col, "1h"};
+        return {day, hour};
+    }
+};
+
+TEST_F(TransformRequestModePassOptimizedTest, LongWindowOptimizedMultiLevelTest) {
+    const std::string sql =
+        "SELECT col1, sum(col2) OVER w1, col2+1, add(col2, col1), count(col2) OVER w1, "
+        "sum(col2) over w2 as w1_col2_sum , sum(col2) over w3 FROM t1\n"
+        "WINDOW w1 AS (PARTITION BY col1 ORDER BY col5 ROWS_RANGE BETWEEN 3m PRECEDING AND CURRENT ROW),"
+        "w2 AS (PARTITION BY col1,col2 ORDER BY col5 ROWS_RANGE BETWEEN 3 PRECEDING AND CURRENT ROW),"
+        "w3 AS (PARTITION BY col1 ORDER BY col5 ROWS_RANGE BETWEEN 3 PRECEDING AND CURRENT ROW);";
+
+    const std::string expected =
+        "SIMPLE_PROJECT(sources=(col1, sum(col2)over w1, col2 + 1, add(col2, col1), count(col2)over w1, w1_col2_sum, "
+        "sum(col2)over w3))\n"
+        "  REQUEST_JOIN(type=kJoinTypeConcat)\n"
+        "    REQUEST_JOIN(type=kJoinTypeConcat)\n"
+        "      REQUEST_JOIN(type=kJoinTypeConcat)\n"
+        "        PROJECT(type=RowProject)\n"
+        "          DATA_PROVIDER(request=t1)\n"
+        "        SIMPLE_PROJECT(sources=(sum(col2)over w1, count(col2)over w1))\n"
+        "          REQUEST_JOIN(type=kJoinTypeConcat)\n"
+        "            PROJECT(type=ReduceAggregation: sum(col2)over w1 (range[-180000,0]))\n"
+        "              REQUEST_AGG_UNION(partition_keys=(), orders=(ASC), range=(col5, -180000, 0), "
+        "index_keys=(col1))\n"
+        "                DATA_PROVIDER(request=t1)\n"
+        "                DATA_PROVIDER(type=Partition, table=t1, index=index1)\n"
+        "                DATA_PROVIDER(type=Partition, table=aggr_t1_1h, index=index1_t2)\n"
+        "                DATA_PROVIDER(type=Partition, table=aggr_t1_1d, index=index1_t2)\n"
+        "            PROJECT(type=ReduceAggregation: count(col2)over w1 (range[-180000,0]))\n"
+        "              REQUEST_AGG_UNION(partition_keys=(), orders=(ASC), range=(col5, -180000, 0), "
+        "index_keys=(col1))\n"
+        "                DATA_PROVIDER(request=t1)\n"
+        "                DATA_PROVIDER(type=Partition, table=t1, index=index1)\n"
+        "                DATA_PROVIDER(type=Partition, table=aggr_t1_1h, index=index1_t2)\n"
+        "                DATA_PROVIDER(type=Partition, table=aggr_t1_1d, index=index1_t2)\n"
+        "      PROJECT(type=ReduceAggregation: sum(col2)over w2 (range[-3,0]))\n"
+        "        REQUEST_AGG_UNION(partition_keys=(), orders=(ASC), range=(col5, -3, 0), index_keys=(col1,col2))\n"
+        "          DATA_PROVIDER(request=t1)\n"
+        "          DATA_PROVIDER(type=Partition, table=t1, index=index12)\n"
+        "          DATA_PROVIDER(type=Partition, table=aggr_t1_1h, index=index1_t2)\n"
+        "          DATA_PROVIDER(type=Partition, table=aggr_t1_1d, index=index1_t2)\n"
+        "    PROJECT(type=Aggregation)\n"
+        "      REQUEST_UNION(partition_keys=(), orders=(ASC), range=(col5, -3, 0), index_keys=(col1))\n"
+        "        DATA_PROVIDER(request=t1)\n"
+        "        DATA_PROVIDER(type=Partition, table=t1, index=index1)";
+
+    std::shared_ptr<SimpleCatalog> catalog(new MultiLevelAggrCatalog());
+    hybridse::type::TableDef table_def;
+    BuildTableDef(table_def);
+    table_def.set_name("t1");
+    {
+        ::hybridse::type::IndexDef* index = table_def.add_indexes();
+        index->set_name("index12");
+        index->add_first_keys("col1");
+        index->add_first_keys("col2");
+        index->set_second_key("col5");
+    }
+    {
+        ::hybridse::type::IndexDef* index = table_def.add_indexes();
+        index->set_name("index1");
+        index->add_first_keys("col1");
+        index->set_second_key("col5");
+    }
+    hybridse::type::Database db;
+    db.set_name("db");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    {
+        hybridse::type::Database db;
+        db.set_name("aggr_db");
+        for (const auto& name : {"aggr_t1_1h", "aggr_t1_1d"}) {
+            hybridse::type::TableDef table_def;
+            BuildAggTableDef(table_def, name, "aggr_db");
+            ::hybridse::type::IndexDef* index = table_def.add_indexes();
+            index->set_name("index1_t2");
+            index->add_first_keys("key");
+            index->set_second_key("ts_start");
+            AddTable(db, table_def);
+        }
+        catalog->AddDatabase(db);
+    }
+
+    std::unordered_map<std::string, std::string> options;
+    options[LONG_WINDOWS] = "w1:1h|1d, w2";
+    std::vector<passes::PhysicalPlanPassType> extra_passes = {passes::kPassSplitAggregationOptimized,
+                                                              passes::kPassLongWindowOptimized};
+    PhysicalPlanCheck(catalog, sql, expected, extra_passes, &options);
+}
+
 }  // namespace vm
 }  // namespace hybridse
 int main(int argc, char** argv) {
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "vm/window_cache.h"
+
+#include <chrono>  // NOLINT
+#include <functional>
+
+namespace hybridse {
+namespace vm {
+
+#define WINDOW_CACHE_SHARD_NUM 16
+
+RequestWindowCache::RequestWindowCache(uint32_t capacity, uint64_t ttl_ms)
+    : shard_capacity_((capacity + WINDOW_CACHE_SHARD_NUM - 1) / WINDOW_CACHE_SHARD_NUM),
+      ttl_ms_(ttl_ms),
+      shards_(WINDOW_CACHE_SHARD_NUM) {}
+
+std::string RequestWindowCache::GetKey(const std::string& signature, const codec::Row& request) {
+    std::string key;
+    key.reserve(signature.size() + request.size() + 8);
+    key.append(signature);
+    for (int32_t i = 0; i < request.GetRowPtrCnt(); i++) {
+        int32_t size = request.size(i);
+        key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        if (size > 0) {
+            key.append(reinterpret_cast<const char*>(request.buf(i)), size);
+        }
+    }
+    return key;
+}
+
+uint64_t RequestWindowCache::NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+RequestWindowCache::Shard* RequestWindowCache::GetShard(const std::string& key) {
+    return &shards_[std::hash<std::string>()(key) % shards_.size()];
+}
+
+std::shared_ptr<TableHandler> RequestWindowCache::Get(const std::string& key) {
+    Shard* shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard->mu);
+    auto iter = shard->entries.find(key);
+    if (iter == shard->entries.end()) {
+        return std::shared_ptr<TableHandler>();
+    }
+    if (iter->second.expire_time <= NowMs()) {
+        shard->lru.erase(iter->second.lru_pos);
+        shard->entries.erase(iter);
+        return std::shared_ptr<TableHandler>();
+    }
+    shard->lru.splice(shard->lru.begin(), shard->lru, iter->second.lru_pos);
+    return iter->second.window;
+}
+
+void RequestWindowCache::Put(const std::string& key, const std::shared_ptr<TableHandler>& window) {
+    if (shard_capacity_ == 0 || !window) {
+        return;
+    }
+    Shard* shard = GetShard(key);
+    uint64_t expire_time = NowMs() + ttl_ms_;
+    std::lock_guard<std::mutex> lock(shard->mu);
+    auto iter = shard->entries.find(key);
+    if (iter != shard->entries.end()) {
+        iter->second.window = window;
+        iter->second.expire_time = expire_time;
+        shard->lru.splice(shard->lru.begin(), shard->lru, iter->second.lru_pos);
+        return;
+    }
+    while (shard->entries.size() >= shard_capacity_ && !shard->lru.empty()) {
+        shard->entries.erase(shard->lru.back());
+        shard->lru.pop_back();
+    }
+    shard->lru.push_front(key);
+    shard->entries.emplace(key, Entry{window, expire_time, shard->lru.begin()});
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HYBRIDSE_SRC_VM_WINDOW_CACHE_H_
+#define HYBRIDSE_SRC_VM_WINDOW_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "codec/row.h"
+#include "vm/catalog.h"
+
+namespace hybridse {
+namespace vm {
+
+/**
+ * RequestWindowCache shares the request windows among the deployments of an
+ * engine. A window is keyed by the signature of its request union, which is
+ * the same for the deployments defining the same window on the same table,
+ * and the request row, so the window scanned for the first deployment called
+ * with a row is reused by the others called with the same row.
+ *
+ * An entry expires after ttl, the rows put within ttl after a window is
+ * cached are not seen by the later deployments reusing it.
+ */
+class RequestWindowCache {
+ public:
+    RequestWindowCache(uint32_t capacity, uint64_t ttl_ms);
+    RequestWindowCache(const RequestWindowCache&) = delete;
+    RequestWindowCache& operator=(const RequestWindowCache&) = delete;
+
+    static std::string GetKey(const std::string& signature, const codec::Row& request);
+
+    std::shared_ptr<TableHandler> Get(const std::string& key);
+
+    void Put(const std::string& key, const std::shared_ptr<TableHandler>& window);
+
+ private:
+    struct Entry {
+        std::shared_ptr<TableHandler> window;
+        uint64_t expire_time;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    struct Shard {
+        std::mutex mu;
+        // the most recently used key is at front
+        std::list<std::string> lru;
+        std::unordered_map<std::string, Entry> entries;
+    };
+
+    static uint64_t NowMs();
+
+    Shard* GetShard(const std::string& key);
+
+    uint32_t shard_capacity_;
+    uint64_t ttl_ms_;
+    std::vector<Shard> shards_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_WINDOW_CACHE_H_
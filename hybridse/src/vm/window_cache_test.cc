@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/window_cache.h"
+
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+#include "vm/mem_catalog.h"
+
+namespace hybridse {
+namespace vm {
+
+class WindowCacheTest : public ::testing::Test {};
+
+static std::shared_ptr<TableHandler> MakeWindow(const std::string& value) {
+    auto window = std::make_shared<MemTableHandler>();
+    window->AddRow(codec::Row(value));
+    return window;
+}
+
+TEST_F(WindowCacheTest, GetKey) {
+    codec::Row row1("row1");
+    codec::Row row2("row2");
+    ASSERT_EQ(RequestWindowCache::GetKey("w1", row1), RequestWindowCache::GetKey("w1", codec::Row("row1")));
+    ASSERT_NE(RequestWindowCache::GetKey("w1", row1), RequestWindowCache::GetKey("w1", row2));
+    ASSERT_NE(RequestWindowCache::GetKey("w1", row1), RequestWindowCache::GetKey("w2", row1));
+}
+
+TEST_F(WindowCacheTest, PutAndGet) {
+    RequestWindowCache cache(16, 60000);
+    ASSERT_FALSE(cache.Get("k1"));
+    auto window = MakeWindow("v1");
+    cache.Put("k1", window);
+    ASSERT_EQ(window, cache.Get("k1"));
+    ASSERT_FALSE(cache.Get("k2"));
+}
+
+TEST_F(WindowCacheTest, Expire) {
+    RequestWindowCache cache(16, 10);
+    cache.Put("k1", MakeWindow("v1"));
+    ASSERT_TRUE(cache.Get("k1"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_FALSE(cache.Get("k1"));
+}
+
+TEST_F(WindowCacheTest, Evict) {
+    // one entry for every shard
+    RequestWindowCache cache(1, 60000);
+    for (int i = 0; i < 1000; i++) {
+        cache.Put("k" + std::to_string(i), MakeWindow("v"));
+    }
+    int cnt = 0;
+    for (int i = 0; i < 1000; i++) {
+        if (cache.Get("k" + std::to_string(i))) {
+            cnt++;
+        }
+    }
+    ASSERT_GT(cnt, 0);
+    ASSERT_LE(cnt, 16);
+    ASSERT_TRUE(cache.Get("k999"));
+}
+
+TEST_F(WindowCacheTest, Disabled) {
+    RequestWindowCache cache(0, 60000);
+    cache.Put("k1", MakeWindow("v1"));
+    ASSERT_FALSE(cache.Get("k1"));
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -44,6 +44,12 @@ class MemoryChunk {
         return addr;
     }
     inline MemoryChunk* next() { return next_; }
+    inline size_t chuck_size() const { return chuck_size_; }
+    // drop the allocations and link the chuck before `next` for reuse
+    void Rewind(MemoryChunk* next) {
+        next_ = next;
+        allocated_size_ = 0;
+    }
     enum { DEFAULT_CHUCK_SIZE = 4096 };
 
  private:
@@ -55,7 +61,7 @@ class MemoryChunk {
 class ByteMemoryPool {
  public:
     explicit ByteMemoryPool(size_t init_size = MemoryChunk::DEFAULT_CHUCK_SIZE)
-        : chucks_(nullptr) {
+        : chucks_(nullptr), free_chucks_(nullptr), free_size_(0) {
         ExpandStorage(init_size);
     }
     ~ByteMemoryPool() {
@@ -68,22 +74,54 @@ class ByteMemoryPool {
         return chucks_->Alloc(request_size);
     }
 
-    // clear last chuck
-    // and delete other chucks
+    // delete all chucks
     void Reset() {
-        auto chuck = chucks_;
+        Recycle(0);
+        auto chuck = free_chucks_;
         while (chuck) {
-            chucks_ = chuck->next();
+            free_chucks_ = chuck->next();
             delete chuck;
-            chuck = chucks_;
+            chuck = free_chucks_;
         }
+        free_size_ = 0;
     }
+
+    // drop all allocations, keep at most `max_retained_size` bytes of chucks
+    // for the later allocations and delete the others
+    void Recycle(size_t max_retained_size) {
+        auto chuck = chucks_;
+        while (chuck) {
+            auto next = chuck->next();
+            if (free_size_ + chuck->chuck_size() <= max_retained_size) {
+                chuck->Rewind(free_chucks_);
+                free_chucks_ = chuck;
+                free_size_ += chuck->chuck_size();
+            } else {
+                delete chuck;
+            }
+            chuck = next;
+        }
+        chucks_ = nullptr;
+    }
+
     void ExpandStorage(size_t request_size) {
+        if (free_chucks_ != nullptr && free_chucks_->chuck_size() >= request_size) {
+            auto chuck = free_chucks_;
+            free_chucks_ = chuck->next();
+            free_size_ -= chuck->chuck_size();
+            chuck->Rewind(chucks_);
+            chucks_ = chuck;
+            return;
+        }
         chucks_ = new MemoryChunk(chucks_, request_size);
     }
 
  private:
+    // the members are appended behind chucks_ to keep the layout seen by the
+    // inlined Alloc of the udf libraries built against the older header
     MemoryChunk* chucks_;
+    MemoryChunk* free_chucks_;
+    size_t free_size_;
 };
 }  // namespace base
 }  // namespace openmldb
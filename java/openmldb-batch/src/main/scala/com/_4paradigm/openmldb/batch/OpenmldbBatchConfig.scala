@@ -70,6 +70,18 @@ class OpenmldbBatchConfig extends Serializable {
   @ConfigOption(name = "openmldb.window.skew.opt.config", doc = "The skew config for window skew optimization")
   var windowSkewOptConfig: String = ""
 
+  @ConfigOption(name = "openmldb.window.skew.opt.hotkey", doc = "Window skew optimization only splits the hot keys " +
+    "found by sampling, and expands the rows within the window range of each split rather than all the history")
+  var enableWindowSkewHotKeyOpt: Boolean = false
+
+  @ConfigOption(name = "openmldb.window.skew.opt.hotkey.sample.ratio", doc = "The ratio of rows sampled to find the " +
+    "hot keys")
+  var windowSkewHotKeySampleRatio: Double = 0.01
+
+  @ConfigOption(name = "openmldb.window.skew.opt.hotkey.threshold", doc = "The estimated rows of one key to be taken " +
+    "as a hot key")
+  var windowSkewHotKeyThreshold: Long = 100000L
+
   @ConfigOption(name = "openmldb.slowRunCacheDir", doc =
     """
       | Slow run mode cache directory path. If specified, run OpenMLDB plan with slow mode.
@@ -118,6 +130,10 @@ class OpenmldbBatchConfig extends Serializable {
   @ConfigOption(name = "openmldb.enable.native.last.join", doc = "Enable native last join or not")
   var enableNativeLastJoin = true
 
+  @ConfigOption(name = "openmldb.opt.fused.plan", doc = "Run the whole plan in one native operator if it only has " +
+    "window aggregation, project and last join over one main table, and broadcast the other tables")
+  var enableFusedPlan = false
+
   // UnsafeRow optimization
   @ConfigOption(name = "openmldb.unsaferow.opt", doc = "Enable UnsafeRow optimization or not")
   var enableUnsafeRowOptimization = false
@@ -125,6 +141,10 @@ class OpenmldbBatchConfig extends Serializable {
   @ConfigOption(name = "openmldb.opt.unsaferow.project", doc = "Enable UnsafeRow optimization for project")
   var enableUnsafeRowOptForProject = false
 
+  @ConfigOption(name = "openmldb.opt.unsaferow.project.batch",
+    doc = "The rows projected in one native call with UnsafeRow optimization, 0 to project the rows one by one")
+  var unsafeRowProjectBatchSize = 0
+
   @ConfigOption(name = "openmldb.opt.unsaferow.window", doc = "Enable UnsafeRow optimization for window")
   var enableUnsafeRowOptForWindow = false
 
@@ -24,9 +24,9 @@ import com._4paradigm.hybridse.vm.{CoreAPI, Engine, PhysicalConstProjectNode, Ph
   PhysicalOpNode, PhysicalOpType, PhysicalProjectNode, PhysicalRenameNode, PhysicalSelectIntoNode,
   PhysicalSimpleProjectNode, PhysicalSortNode, PhysicalTableProjectNode, PhysicalWindowAggrerationNode, ProjectType}
 import com._4paradigm.openmldb.batch.api.OpenmldbSession
-import com._4paradigm.openmldb.batch.nodes.{ConstProjectPlan, DataProviderPlan, GroupByAggregationPlan, GroupByPlan,
-  JoinPlan, LimitPlan, LoadDataPlan, RenamePlan, RowProjectPlan, SelectIntoPlan, SimpleProjectPlan, SortByPlan,
-  WindowAggPlan}
+import com._4paradigm.openmldb.batch.nodes.{ConstProjectPlan, DataProviderPlan, FusedPlan, GroupByAggregationPlan,
+  GroupByPlan, JoinPlan, LimitPlan, LoadDataPlan, RenamePlan, RowProjectPlan, SelectIntoPlan, SimpleProjectPlan,
+  SortByPlan, WindowAggPlan}
 import com._4paradigm.openmldb.batch.utils.{DataTypeUtil, GraphvizUtil, HybridseUtil, NodeIndexInfo, NodeIndexType}
 import com._4paradigm.openmldb.sdk.impl.SqlClusterExecutor
 import com._4paradigm.std.VectorDataType
@@ -97,20 +97,29 @@ class SparkPlanner(session: SparkSession, config: OpenmldbBatchConfig, sparkAppN
         GraphvizUtil.drawPhysicalPlan(root, config.physicalPlanGraphvizPath)
       }
 
-      logger.info("Visit physical plan to find ConcatJoin node")
-      val concatJoinNodes = mutable.ArrayBuffer[PhysicalJoinNode]()
-      findConcatJoinNode(root, concatJoinNodes)
+      // Run the whole plan in one native operator if possible
+      val fusedOutput = if (config.enableFusedPlan && config.slowRunCacheDir == null) {
+        FusedPlan.tryGen(planCtx, root, sql, databases)
+      } else {
+        None
+      }
 
-      logger.info("Visit concat join node to add node index info")
-      val processedConcatJoinNodeIds = mutable.HashSet[Long]()
-      val indexColumnName = "__CONCATJOIN_INDEX__" + System.currentTimeMillis()
-      concatJoinNodes.foreach(joinNode => bindNodeIndexInfo(joinNode, planCtx, processedConcatJoinNodeIds,
-        indexColumnName))
+      fusedOutput.getOrElse {
+        logger.info("Visit physical plan to find ConcatJoin node")
+        val concatJoinNodes = mutable.ArrayBuffer[PhysicalJoinNode]()
+        findConcatJoinNode(root, concatJoinNodes)
 
-      if (config.slowRunCacheDir != null) {
-        slowRunWithHDFSCache(root, planCtx, config.slowRunCacheDir, isRoot = true)
-      } else {
-        getSparkOutput(root, planCtx)
+        logger.info("Visit concat join node to add node index info")
+        val processedConcatJoinNodeIds = mutable.HashSet[Long]()
+        val indexColumnName = "__CONCATJOIN_INDEX__" + System.currentTimeMillis()
+        concatJoinNodes.foreach(joinNode => bindNodeIndexInfo(joinNode, planCtx, processedConcatJoinNodeIds,
+          indexColumnName))
+
+        if (config.slowRunCacheDir != null) {
+          slowRunWithHDFSCache(root, planCtx, config.slowRunCacheDir, isRoot = true)
+        } else {
+          getSparkOutput(root, planCtx)
+        }
       }
     }
 
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com._4paradigm.openmldb.batch.nodes
+
+import com._4paradigm.hybridse.`type`.TypeOuterClass.Database
+import com._4paradigm.hybridse.base.BaseStatus
+import com._4paradigm.hybridse.node.{ColumnRefNode, ExprType, JoinType}
+import com._4paradigm.hybridse.sdk.HybridSeException
+import com._4paradigm.hybridse.vm.{BatchPlanInterface, CoreAPI, PhysicalDataProviderNode, PhysicalJoinNode,
+  PhysicalOpNode, PhysicalOpType, PhysicalProjectNode, PhysicalWindowAggrerationNode, ProjectType}
+import com._4paradigm.openmldb.batch.utils.{AutoDestructibleIterator, HybridseUtil, SparkColumnUtil}
+import com._4paradigm.openmldb.batch.{PlanContext, SparkInstance, SparkRowCodec}
+import com._4paradigm.openmldb.sdk.impl.SqlClusterExecutor
+import org.apache.spark.sql.Row
+import org.apache.spark.sql.types.StructType
+import org.slf4j.LoggerFactory
+
+import scala.collection.mutable
+
+/** The planner which runs the whole physical plan of the sql in one native operator.
+ *
+ * The plan is compiled again on the executors and run by the batch mode runners of HybridSE within one mapPartitions
+ * call, so the rows are encoded and decoded once rather than once for each physical node.
+ *
+ * The main table is the leftmost table of the plan and it is repartitioned by the window keys, the other tables of
+ * the last joins and window unions are broadcast and appended to every partition. So the plan is fused only if:
+ * 1. It only has data provider, simple project, rename, row project, window aggregation and last join nodes.
+ * 2. All the windows over the main table are partitioned by the same columns of the main table.
+ * 3. The main table is not read by the other branches of the plan.
+ * */
+object FusedPlan {
+
+  private val logger = LoggerFactory.getLogger(this.getClass)
+
+  /** The serializable Spark closure class for the fused plan. */
+  case class FusedPlanConfig(sql: String,
+                             database: Array[Byte],
+                             mainTableName: String,
+                             broadcastTableNames: Array[String],
+                             tableSchemaSlices: Map[String, Array[StructType]],
+                             outputSchemaSlices: Array[StructType],
+                             outputFieldNum: Int,
+                             openmldbJsdkLibraryPath: String)
+
+  /** Generate the output of the whole plan if it could be fused, or return None. */
+  def tryGen(ctx: PlanContext, root: PhysicalOpNode, sql: String, databases: List[Database]): Option[SparkInstance] = {
+    if (ctx.getConf.enableUnsafeRowOptimization || ctx.getConf.enableWindowSkewOpt ||
+      ctx.getConf.enableWindowParallelization) {
+      logger.info("Do not fuse the plan with UnsafeRow, window skew or window parallelization optimization")
+      return None
+    }
+
+    // The main table is the leftmost one
+    val mainChainIds = mutable.HashSet[Long]()
+    var mainNode = root
+    while (mainNode.GetProducerCnt() > 0) {
+      mainChainIds.add(mainNode.GetNodeId())
+      mainNode = mainNode.GetProducer(0)
+    }
+    if (mainNode.GetOpType() != PhysicalOpType.kPhysicalOpDataProvider) {
+      return None
+    }
+    val mainProvider = PhysicalDataProviderNode.CastFrom(mainNode)
+    mainChainIds.add(mainProvider.GetNodeId())
+
+    val providers = mutable.LinkedHashMap[String, PhysicalDataProviderNode]()
+    val keyIndexes = mutable.ArrayBuffer[Int]()
+    if (!visit(root, mainChainIds, mainProvider, providers, keyIndexes)) {
+      logger.info("Do not fuse the plan which is not supported")
+      return None
+    }
+
+    val dbName = mainProvider.GetDb()
+    val database = databases.find(_.getName.equals(dbName))
+    // The sql is compiled again with the database of the main table as the default one
+    if (!dbName.equals(ctx.getConf.defaultDb) || database.isEmpty ||
+      providers.values.exists(!_.GetDb().equals(dbName))) {
+      logger.info("Do not fuse the plan which reads the tables out of the default database")
+      return None
+    }
+
+    logger.info(s"Fuse the plan over the main table ${mainProvider.GetName()}")
+    Some(gen(ctx, root, sql, database.get, mainProvider, providers.values.toSeq, keyIndexes))
+  }
+
+  /** Visit the plan to check the nodes and get the window keys of the main table. */
+  def visit(node: PhysicalOpNode,
+            mainChainIds: mutable.HashSet[Long],
+            mainProvider: PhysicalDataProviderNode,
+            providers: mutable.LinkedHashMap[String, PhysicalDataProviderNode],
+            keyIndexes: mutable.ArrayBuffer[Int]): Boolean = {
+    val supported = node.GetOpType() match {
+      case PhysicalOpType.kPhysicalOpDataProvider =>
+        val provider = PhysicalDataProviderNode.CastFrom(node)
+        val name = provider.GetName()
+        // The main table could not be read by the other branches which only get one partition of it
+        if (provider.GetLimitCnt() > 0 ||
+          (name.equals(mainProvider.GetName()) && provider.GetNodeId() != mainProvider.GetNodeId())) {
+          false
+        } else {
+          providers.put(name, provider)
+          true
+        }
+      case PhysicalOpType.kPhysicalOpSimpleProject | PhysicalOpType.kPhysicalOpRename => true
+      case PhysicalOpType.kPhysicalOpJoin =>
+        PhysicalJoinNode.CastFrom(node).join().join_type() == JoinType.kJoinTypeLast
+      case PhysicalOpType.kPhysicalOpProject =>
+        PhysicalProjectNode.CastFrom(node).getProject_type_ match {
+          case ProjectType.kTableProject => true
+          case ProjectType.kWindowAggregation =>
+            val windowNode = PhysicalWindowAggrerationNode.CastFrom(node)
+            windowNode.window_joins().Empty() &&
+              (!mainChainIds.contains(node.GetNodeId()) || visitWindowKeys(windowNode, mainProvider, keyIndexes)) &&
+              (0 until windowNode.window_unions().GetSize().toInt).forall(i =>
+                visit(windowNode.window_unions().GetUnionNode(i), mainChainIds, mainProvider, providers, keyIndexes))
+          case _ => false
+        }
+      case _ => false
+    }
+    supported && (0 until node.GetProducerCnt().toInt).forall(i =>
+      visit(node.GetProducer(i), mainChainIds, mainProvider, providers, keyIndexes))
+  }
+
+  /** Check the window over the main table is partitioned by the same columns of the main table as the others. */
+  def visitWindowKeys(windowNode: PhysicalWindowAggrerationNode,
+                      mainProvider: PhysicalDataProviderNode,
+                      keyIndexes: mutable.ArrayBuffer[Int]): Boolean = {
+    val keys = windowNode.window().partition().keys()
+    val indexes = mutable.ArrayBuffer[Int]()
+    for (i <- 0 until keys.GetChildNum()) {
+      val key = keys.GetChild(i)
+      if (key.getExpr_type_ != ExprType.kExprColumnRef) {
+        return false
+      }
+      val columnRef = ColumnRefNode.CastFrom(key)
+      val sourceInfo = CoreAPI.ResolveSourceColumn(windowNode.GetProducer(0), columnRef.GetDBName(),
+        columnRef.GetRelationName(), columnRef.GetColumnName())
+      if (!sourceInfo.GetStatus().isOK || sourceInfo.GetSourceNode() == null ||
+        sourceInfo.GetSourceNode().GetNodeId() != mainProvider.GetNodeId()) {
+        return false
+      }
+      indexes += sourceInfo.GetSourceColumnIndex()
+    }
+
+    if (indexes.isEmpty) {
+      false
+    } else if (keyIndexes.isEmpty) {
+      keyIndexes ++= indexes
+      true
+    } else {
+      keyIndexes.sorted == indexes.sorted
+    }
+  }
+
+  def gen(ctx: PlanContext,
+          root: PhysicalOpNode,
+          sql: String,
+          database: Database,
+          mainProvider: PhysicalDataProviderNode,
+          providers: Seq[PhysicalDataProviderNode],
+          keyIndexes: mutable.ArrayBuffer[Int]): SparkInstance = {
+    val mainTableName = mainProvider.GetName()
+    val mainDf = ctx.getDataFrame(mainProvider.GetDb(), mainTableName).getOrElse {
+      throw new HybridSeException(s"Input table $mainTableName from database ${mainProvider.GetDb()} not found")
+    }
+
+    // Repartition the main table by the window keys, the runners sort the rows of the partition by themselves
+    val repartitionDf = if (keyIndexes.isEmpty) {
+      mainDf
+    } else {
+      val repartitionCols = keyIndexes.map(SparkColumnUtil.getColumnFromIndex(mainDf, _))
+      if (ctx.getConf.groupbyPartitions > 0) {
+        mainDf.repartition(ctx.getConf.groupbyPartitions, repartitionCols: _*)
+      } else {
+        mainDf.repartition(repartitionCols: _*)
+      }
+    }
+
+    // Broadcast the other tables
+    val broadcastProviders = providers.filter(_.GetNodeId() != mainProvider.GetNodeId())
+    val broadcastRows = broadcastProviders.map(provider => {
+      val df = ctx.getDataFrame(provider.GetDb(), provider.GetName()).getOrElse {
+        throw new HybridSeException(s"Input table ${provider.GetName()} from database ${provider.GetDb()} not found")
+      }
+      provider.GetName() -> df.collect()
+    }).toMap
+    val broadcastTables = ctx.getSparkSession.sparkContext.broadcast(broadcastRows)
+
+    val outputSchema = HybridseUtil.getSparkSchema(root.GetOutputSchema())
+    val fusedPlanConfig = FusedPlanConfig(
+      sql = sql,
+      database = database.toByteArray,
+      mainTableName = mainTableName,
+      broadcastTableNames = broadcastProviders.map(_.GetName()).toArray,
+      tableSchemaSlices = providers.map(provider =>
+        provider.GetName() -> HybridseUtil.getOutputSchemaSlices(provider, false)).toMap,
+      outputSchemaSlices = HybridseUtil.getOutputSchemaSlices(root, false),
+      outputFieldNum = outputSchema.size,
+      openmldbJsdkLibraryPath = ctx.getConf.openmldbJsdkLibraryPath
+    )
+
+    val outputRdd = repartitionDf.rdd.mapPartitions(iter => {
+      if (iter.isEmpty) {
+        // The main table drives the plan, so nothing is output for the empty partition
+        Iterator.empty
+      } else {
+        SqlClusterExecutor.initJavaSdkLibrary(fusedPlanConfig.openmldbJsdkLibraryPath)
+        val plan = new BatchPlanInterface(Database.parseFrom(fusedPlanConfig.database), fusedPlanConfig.sql)
+        val status = new BaseStatus()
+        if (!plan.Init(status)) {
+          throw new HybridSeException(s"Fail to compile the fused plan: ${status.GetMsg()}")
+        }
+
+        appendRows(plan, fusedPlanConfig.mainTableName, iter,
+          fusedPlanConfig.tableSchemaSlices(fusedPlanConfig.mainTableName))
+        fusedPlanConfig.broadcastTableNames.foreach(name =>
+          appendRows(plan, name, broadcastTables.value(name).iterator, fusedPlanConfig.tableSchemaSlices(name)))
+
+        if (!plan.Run(status)) {
+          throw new HybridSeException(s"Fail to run the fused plan: ${status.GetMsg()}")
+        }
+        status.delete()
+
+        val decoder = new SparkRowCodec(fusedPlanConfig.outputSchemaSlices)
+        val resultIter = (0L until plan.size()).iterator.map(i => {
+          val outputNativeRow = plan.Get(i)
+          val outputArr = Array.fill[Any](fusedPlanConfig.outputFieldNum)(null)
+          decoder.decode(outputNativeRow, outputArr)
+          outputNativeRow.delete()
+          Row.fromSeq(outputArr)
+        })
+
+        AutoDestructibleIterator(resultIter) {
+          decoder.delete()
+          plan.delete()
+        }
+      }
+    })
+
+    SparkInstance.fromDataFrame(ctx.getSparkSession.createDataFrame(outputRdd, outputSchema))
+  }
+
+  /** Encode the rows and append them to the table of the native plan. */
+  def appendRows(plan: BatchPlanInterface, tableName: String, rows: Iterator[Row],
+                 schemaSlices: Array[StructType]): Unit = {
+    val encoder = new SparkRowCodec(schemaSlices)
+    rows.foreach(row => {
+      val nativeRow = encoder.encode(row)
+      plan.AppendRow(tableName, nativeRow)
+      nativeRow.delete()
+    })
+    encoder.delete()
+  }
+
+}
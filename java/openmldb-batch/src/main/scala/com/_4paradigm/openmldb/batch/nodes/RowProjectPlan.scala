@@ -25,6 +25,7 @@ import com._4paradigm.openmldb.batch.{PlanContext, SparkInstance, SparkRowCodec}
 import com._4paradigm.openmldb.common.codec.CodecUtil
 import com._4paradigm.openmldb.sdk.impl.SqlClusterExecutor
 import org.apache.spark.sql.Row
+import org.apache.spark.sql.catalyst.InternalRow
 import org.apache.spark.sql.catalyst.expressions.UnsafeRow
 import org.apache.spark.sql.types.{DateType, LongType, StructType, TimestampType}
 import org.slf4j.LoggerFactory
@@ -77,6 +78,7 @@ object RowProjectPlan {
     val inputSchema = inputDf.schema
 
     val openmldbJsdkLibraryPath = ctx.getConf.openmldbJsdkLibraryPath
+    val projectBatchSize = ctx.getConf.unsafeRowProjectBatchSize
 
     val outputDf = if (ctx.getConf.enableUnsafeRowOptForProject) { // Use UnsafeRow optimization
 
@@ -117,9 +119,8 @@ object RowProjectPlan {
           }
         }
 
-        partitionIter.map(internalRow => {
-
-          // Convert Spark UnsafeRow timestamp values for OpenMLDB Core
+        // Convert Spark UnsafeRow timestamp values for OpenMLDB Core
+        def convertInputRow(internalRow: InternalRow): Unit = {
           for (colIdx <- inputTimestampColIndexes) {
             if(!internalRow.isNullAt(colIdx)) {
               internalRow.setLong(colIdx, internalRow.getLong(colIdx) / 1000)
@@ -131,17 +132,10 @@ object RowProjectPlan {
               internalRow.setInt(colIdx, CodecUtil.daysToDateInt(internalRow.getInt(colIdx)))
             }
           }
+        }
 
-          // Create native method input from Spark InternalRow
-          val hybridseRowBytes = UnsafeRowUtil.internalRowToHybridseRowBytes(internalRow)
-
-          // Call native method to compute
-          val outputHybridseRow = CoreAPI.UnsafeRowProject(fn, hybridseRowBytes, hybridseRowBytes.length, false)
-
-          // Call methods to generate Spark InternalRow
-          val outputInternalRow = UnsafeRowUtil.hybridseRowToInternalRow(outputHybridseRow, outputSchema.size)
-
-          // Convert Spark UnsafeRow timestamp values for OpenMLDB Core
+        // Convert OpenMLDB Core timestamp values for Spark UnsafeRow
+        def convertOutputRow(outputInternalRow: InternalRow): Unit = {
           for (tsColIdx <- outputTimestampColIndexes) {
             if(!outputInternalRow.isNullAt(tsColIdx)) {
               // TODO(tobe): warning if over LONG.MAX_VALUE
@@ -154,11 +148,31 @@ object RowProjectPlan {
               outputInternalRow.setInt(colIdx, CodecUtil.dateIntToDays(outputInternalRow.getInt(colIdx)))
             }
           }
+        }
 
-          // TODO: Add index column if needed
-          outputHybridseRow.delete()
-          outputInternalRow
-        })
+        if (projectBatchSize > 0) {
+          UnsafeRowUtil.projectInBatches(fn, partitionIter, projectBatchSize, outputSchema.size, convertInputRow,
+            convertOutputRow)
+        } else {
+          partitionIter.map(internalRow => {
+            convertInputRow(internalRow)
+
+            // Create native method input from Spark InternalRow
+            val hybridseRowBytes = UnsafeRowUtil.internalRowToHybridseRowBytes(internalRow)
+
+            // Call native method to compute
+            val outputHybridseRow = CoreAPI.UnsafeRowProject(fn, hybridseRowBytes, hybridseRowBytes.length, false)
+
+            // Call methods to generate Spark InternalRow
+            val outputInternalRow = UnsafeRowUtil.hybridseRowToInternalRow(outputHybridseRow, outputSchema.size)
+
+            convertOutputRow(outputInternalRow)
+
+            // TODO: Add index column if needed
+            outputHybridseRow.delete()
+            outputInternalRow
+          })
+        }
 
       })
 
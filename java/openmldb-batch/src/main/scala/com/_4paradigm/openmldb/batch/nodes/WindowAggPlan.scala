@@ -17,6 +17,7 @@
 package com._4paradigm.openmldb.batch.nodes
 
 import com._4paradigm.hybridse.vm.PhysicalWindowAggrerationNode
+import com._4paradigm.hybridse.vm.Window.WindowFrameType
 import com._4paradigm.openmldb.batch.utils.{AutoDestructibleIterator, HybridseUtil, PhysicalNodeUtil,
   SkewDataFrameUtils, SparkUtil}
 import com._4paradigm.openmldb.batch.window.WindowAggPlanUtil.WindowAggConfig
@@ -40,6 +41,7 @@ import scala.collection.mutable
  * 2. Window with union. The window aggregation may include some union table data.
  * 3. Window skew optimization. The input table may be grouped for more partitions.
  * 4. Window skew optimization with skew config. Pre-compute the data distribution to accelerate the skew optimization.
+ * 4.1 Window skew optimization for hot keys. Only the hot keys found by sampling are split by time.
  * 5. UnsafeRow optimization. Reuse the memory layout of Spark UnsafeRow.
  * 6. Window parallel optimization. Multiple windows could be computed in parallel and the input table would has new
  * index column.
@@ -74,7 +76,9 @@ object WindowAggPlan {
     }
 
     // Do groupby and sort with window skew optimization or not
-    val repartitionDf = if (isWindowSkewOptimization) {
+    val repartitionDf = if (isWindowSkewOptimization && ctx.getConf.enableWindowSkewHotKeyOpt) {
+      windowPartitionWithHotKeySkewOpt(ctx, physicalNode, unionTable, windowAggConfig)
+    } else if (isWindowSkewOptimization) {
       windowPartitionWithSkewOpt(ctx, physicalNode, unionTable, windowAggConfig)
     } else {
       windowPartition(ctx, physicalNode, unionTable)
@@ -283,6 +287,77 @@ object WindowAggPlan {
     sortedDf
   }
 
+  /** Do repartition and sort for window skew optimization of the hot keys before aggregation.
+   *
+   * The hot keys are found by sampling and their rows are split into parts by the time, so one hot key is computed
+   * by several tasks. The other keys keep one part as the standard window.
+   * 1. Sample the table to get the hot keys and the percentiles of their order keys
+   * 2. Add "part" column and expand the rows within the window range before each part
+   * 3. Repartition and orderby
+   *
+   * The expanded rows are only buffered into the native window of the later part, so the overlap is the window size
+   * for ROWS_RANGE window. ROWS window and the unbounded window expand all the history of the hot keys.
+   */
+  def windowPartitionWithHotKeySkewOpt(ctx: PlanContext,
+                                       windowAggNode: PhysicalWindowAggrerationNode,
+                                       inputDf: DataFrame,
+                                       windowAggConfig: WindowAggConfig): DataFrame = {
+    val uniqueNamePostfix = ctx.getConf.windowSkewOptPostfix
+
+    // Cache the input table which will be used for sampling and expanding
+    if (ctx.getConf.windowSkewOptCache) {
+      inputDf.cache()
+    }
+
+    val repartitionColIndexes = PhysicalNodeUtil.getRepartitionColumnIndexes(windowAggNode, inputDf)
+    val orderByColIndex = PhysicalNodeUtil.getOrderbyColumnIndex(windowAggNode, inputDf)
+    val orderKeyCol = SkewDataFrameUtils.genOrderKeyCol(inputDf, orderByColIndex)
+
+    val partIdColName = "PART_ID" + uniqueNamePostfix
+    val expandedRowColName = "EXPANDED_ROW" + uniqueNamePostfix
+    val partitionKeyColName = "PARTITION_KEY" + uniqueNamePostfix
+
+    val quantile = ctx.getConf.skewedPartitionNum
+
+    // 1. Sample the table to get the hot keys
+    val hotKeyDf = SkewDataFrameUtils.genHotKeyDistributionDf(inputDf, quantile.intValue(), repartitionColIndexes,
+      orderKeyCol, partitionKeyColName, ctx.getConf.windowSkewHotKeySampleRatio, ctx.getConf.windowSkewHotKeyThreshold)
+    if (ctx.getConf.windowSkewOptCache) {
+      hotKeyDf.cache()
+    }
+    logger.info("Generate hot key dataframe")
+
+    // 2. Add "part" column and "expand" column and expand the rows of the window overlap
+    val windowStartOffset = if (windowAggConfig.windowFrameTypeName.equals(WindowFrameType.kFrameRowsRange.toString)) {
+      windowAggConfig.startOffset
+    } else {
+      Long.MinValue
+    }
+    val expandedDf = SkewDataFrameUtils.genHotKeyExpandedDf(inputDf, hotKeyDf, quantile.intValue(),
+      repartitionColIndexes, orderKeyCol, partitionKeyColName, partIdColName, expandedRowColName, windowStartOffset,
+      ctx.getConf.windowSkewOptBroadcastJoin)
+    logger.info("Generate expanded dataframe of hot keys")
+
+    windowAggConfig.expandedFlagIdx = expandedDf.schema.fieldNames.length - 1
+    windowAggConfig.partIdIdx = expandedDf.schema.fieldNames.length - 2
+
+    // 3. Repartition and order by
+    val repartitionCols = expandedDf(partIdColName) +: PhysicalNodeUtil.getRepartitionColumns(windowAggNode, inputDf)
+    val repartitionDf = if (ctx.getConf.groupbyPartitions > 0) {
+      expandedDf.repartition(ctx.getConf.groupbyPartitions, repartitionCols: _*)
+    } else {
+      expandedDf.repartition(repartitionCols: _*)
+    }
+
+    val sortedByCols = repartitionCols ++ PhysicalNodeUtil.getOrderbyColumns(windowAggNode, inputDf)
+
+    // Notice that we should make sure the keys in the same partition are ordering as well
+    val sortedDf = repartitionDf.sortWithinPartitions(sortedByCols: _*)
+    logger.info("Generate repartition and orderBy dataframe")
+
+    sortedDf
+  }
+
   /** Do repartition and sort for standard window computing before aggregation.
    *
    * There are two steps:
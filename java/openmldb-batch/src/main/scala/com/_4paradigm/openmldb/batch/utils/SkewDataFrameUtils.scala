@@ -17,7 +17,8 @@
 package com._4paradigm.openmldb.batch.utils
 
 import com._4paradigm.openmldb.batch.udf.PercentileApprox.percentileApprox
-import org.apache.spark.sql.functions.{approx_count_distinct, lit, when}
+import org.apache.spark.sql.functions.{approx_count_distinct, col, count, lit, round, unix_timestamp, when}
+import org.apache.spark.sql.types.{DateType, DoubleType, LongType, TimestampType}
 import org.apache.spark.sql.{Column, DataFrame}
 
 import scala.collection.mutable
@@ -141,4 +142,95 @@ object SkewDataFrameUtils {
     }
     unionDf
   }
+
+  /** Get the order key in milliseconds which is the same as the key buffered in the native window. */
+  def genOrderKeyCol(inputDf: DataFrame, orderByColIndex: Int): Column = {
+    val orderByCol = SparkColumnUtil.getColumnFromIndex(inputDf, orderByColIndex)
+    inputDf.schema(orderByColIndex).dataType match {
+      case TimestampType => round(orderByCol.cast(DoubleType) * 1000).cast(LongType)
+      case DateType => unix_timestamp(orderByCol) * 1000
+      case _ => orderByCol.cast(LongType)
+    }
+  }
+
+  /** Find the hot keys by sampling and get the percentiles of their order keys.
+   *
+   * The keys whose estimated count reaches hotKeyThreshold are kept, so the output table is small enough to be
+   * broadcast and the other keys will not be split at all.
+   */
+  def genHotKeyDistributionDf(inputDf: DataFrame, quantile: Int, repartitionColIndex: mutable.ArrayBuffer[Int],
+                              orderKeyCol: Column, partitionColName: String, sampleRatio: Double,
+                              hotKeyThreshold: Long): DataFrame = {
+
+    // TODO: Support multiple repartition keys
+    val groupByCol = SparkColumnUtil.getColumnFromIndex(inputDf, repartitionColIndex(0))
+    val countColName = partitionColName + "_COUNT"
+
+    val columns = mutable.ArrayBuffer[Column]()
+    columns += count(lit(1)).as(countColName)
+    val factor = 1.0 / quantile.toDouble
+    for (i <- 1 until quantile) {
+      val ratio = i * factor
+      columns += percentileApprox(orderKeyCol, lit(ratio)).as(s"PERCENTILE_${i}")
+    }
+
+    val sampledDf = if (sampleRatio < 1.0) inputDf.sample(withReplacement = false, sampleRatio) else inputDf
+    sampledDf.groupBy(groupByCol.as(partitionColName)).agg(columns.head, columns.tail: _*)
+      .filter(col(countColName) >= hotKeyThreshold * math.min(sampleRatio, 1.0))
+      .drop(countColName)
+  }
+
+  /** Add "part" column and "expand" column for the hot keys and expand the rows of the window overlap.
+   *
+   * The rows of the hot keys are split by the percentiles of the order key, and the rows of the other keys are all
+   * in the last part. The rows of one part are expanded into the later parts only if their order keys are within
+   * the window range before the first row of that part, or expanded as all the history if windowStartOffset is
+   * Long.MinValue.
+   */
+  def genHotKeyExpandedDf(inputDf: DataFrame, hotKeyDf: DataFrame, quantile: Int,
+                          repartitionColIndex: mutable.ArrayBuffer[Int], orderKeyCol: Column,
+                          partitionKeyColName: String, partIdColName: String, expandedRowColName: String,
+                          windowStartOffset: Long, openBroadcastJoin: Boolean): DataFrame = {
+
+    // TODO: Support multiple repartition keys
+    val inputDfJoinCol = SparkColumnUtil.getColumnFromIndex(inputDf, repartitionColIndex(0))
+    val hotKeyDfJoinCol = hotKeyDf(partitionKeyColName)
+
+    val joinDf = if (openBroadcastJoin) {
+      inputDf.join(hotKeyDf.hint("broadcast"), inputDfJoinCol === hotKeyDfJoinCol, "left")
+    } else {
+      inputDf.join(hotKeyDf, inputDfJoinCol === hotKeyDfJoinCol, "left")
+    }
+
+    // The percentiles are null for the keys which are not hot, so they go to the last part
+    var part: Column = null
+    for (i <- 1 to quantile) {
+      if (i == 1) {
+        part = when(orderKeyCol <= joinDf(s"PERCENTILE_${i}"), i)
+      } else if (i != quantile) {
+        part = part.when(orderKeyCol <= joinDf(s"PERCENTILE_${i}"), i)
+      } else {
+        part = part.otherwise(quantile)
+      }
+    }
+    val addColumnsDf = joinDf.withColumn(partIdColName, part).withColumn(expandedRowColName, lit(false))
+
+    var unionDf = addColumnsDf
+    for (i <- 2 to quantile) {
+      var expandCondition = addColumnsDf(partIdColName) < i
+      if (windowStartOffset != Long.MinValue) {
+        expandCondition = expandCondition &&
+          orderKeyCol >= addColumnsDf(s"PERCENTILE_${i - 1}") + windowStartOffset
+      }
+      unionDf = unionDf.union(
+        addColumnsDf.filter(expandCondition)
+          .withColumn(partIdColName, lit(i)).withColumn(expandedRowColName, lit(true))
+      )
+    }
+
+    // Drop "PARTITION_KEY" column and PERCENTILE_* columns
+    val outputCols = (0 until inputDf.schema.length).map(SparkColumnUtil.getColumnFromIndex(unionDf, _)) ++
+      Seq(unionDf(partIdColName), unionDf(expandedRowColName))
+    unionDf.select(outputCols: _*)
+  }
 }
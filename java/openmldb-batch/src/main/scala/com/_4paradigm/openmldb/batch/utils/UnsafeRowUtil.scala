@@ -16,7 +16,7 @@
 
 package com._4paradigm.openmldb.batch.utils
 
-import java.nio.ByteBuffer
+import java.nio.{ByteBuffer, ByteOrder}
 
 import com._4paradigm.hybridse.codec.Row
 import com._4paradigm.hybridse.vm.CoreAPI
@@ -24,6 +24,8 @@ import org.apache.spark.sql.catalyst.InternalRow
 import org.apache.spark.sql.catalyst.expressions.UnsafeRow
 import org.apache.spark.sql.catalyst.expressions.codegen.UnsafeRowWriter
 
+import scala.collection.mutable
+
 object UnsafeRowUtil {
 
   val HybridseRowHeaderSize = 6
@@ -70,4 +72,99 @@ object UnsafeRowUtil {
     unsafeRow.asInstanceOf[InternalRow]
   }
 
+  /** Project Spark InternalRows in batches with one native call for each batch.
+   *
+   * The UnsafeRows are laid into a direct buffer with the HybridSE header and projected where they are, the outputs
+   * are read from another direct buffer, so no JNI object is created for a row. The buffers grow when a row does not
+   * fit.
+   *
+   * @param preProcess converts the input row in place before it is copied into the batch.
+   * @param postProcess converts the output row in place.
+   */
+  def projectInBatches(fn: Long, input: Iterator[InternalRow], batchSize: Int, outputColumnNum: Int,
+                       preProcess: InternalRow => Unit, postProcess: InternalRow => Unit): Iterator[InternalRow] = {
+    new Iterator[InternalRow] {
+      private var inputBuffer = ByteBuffer.allocateDirect(1024 * 1024).order(ByteOrder.nativeOrder())
+      private var outputBuffer = ByteBuffer.allocateDirect(1024 * 1024).order(ByteOrder.nativeOrder())
+      private val inputRowSizes = new Array[Int](batchSize)
+      private val outputs = mutable.ArrayBuffer[InternalRow]()
+      private var outputIdx = 0
+
+      override def hasNext: Boolean = {
+        if (outputIdx < outputs.size) {
+          true
+        } else if (input.hasNext) {
+          projectBatch()
+          outputIdx < outputs.size
+        } else {
+          false
+        }
+      }
+
+      override def next(): InternalRow = {
+        if (!hasNext) {
+          throw new NoSuchElementException("no more projected rows")
+        }
+        outputIdx += 1
+        outputs(outputIdx - 1)
+      }
+
+      private def projectBatch(): Unit = {
+        outputs.clear()
+        outputIdx = 0
+        inputBuffer.clear()
+        // The input rows are reused by Spark, so they are copied into the batch as they come
+        var cnt = 0
+        while (cnt < batchSize && input.hasNext) {
+          val internalRow = input.next()
+          preProcess(internalRow)
+          val rowBytes = internalRow.asInstanceOf[UnsafeRow].getBytes
+          val size = HybridseRowHeaderSize + rowBytes.length
+          if (inputBuffer.remaining() < size) {
+            val newBuffer = ByteBuffer.allocateDirect(math.max(inputBuffer.capacity() * 2, inputBuffer.position() + size))
+              .order(ByteOrder.nativeOrder())
+            inputBuffer.flip()
+            newBuffer.put(inputBuffer)
+            inputBuffer = newBuffer
+          }
+          // FVersion, SVersion and the size
+          inputBuffer.put(1.toByte).put(1.toByte).putInt(size).put(rowBytes)
+          inputRowSizes(cnt) = size
+          cnt += 1
+        }
+
+        var inputOffset = 0
+        var projected = 0
+        while (projected < cnt) {
+          val batchInput = inputBuffer.duplicate()
+          batchInput.flip()
+          batchInput.position(inputOffset)
+          val outputCnt = CoreAPI.UnsafeRowProjectBatch(fn, batchInput.slice(), cnt - projected, outputBuffer)
+          if (outputCnt < 0) {
+            throw new RuntimeException("Fail to project the batch of rows natively")
+          }
+          if (outputCnt == 0) {
+            // The output buffer can not hold the next row
+            outputBuffer = ByteBuffer.allocateDirect(outputBuffer.capacity() * 2).order(ByteOrder.nativeOrder())
+          }
+          var outputOffset = 0
+          for (_ <- 0 until outputCnt) {
+            val outputSize = outputBuffer.getInt(outputOffset + 2)
+            val outputBytes = new Array[Byte](outputSize - HybridseRowHeaderSize)
+            outputBuffer.position(outputOffset + HybridseRowHeaderSize)
+            outputBuffer.get(outputBytes)
+            val outputRow = new UnsafeRow(outputColumnNum)
+            outputRow.pointTo(outputBytes, outputBytes.length)
+            postProcess(outputRow)
+            outputs.append(outputRow)
+            outputOffset += outputSize
+            inputOffset += inputRowSizes(projected)
+            projected += 1
+          }
+          outputBuffer.clear()
+        }
+      }
+    }
+  }
+
 }
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com._4paradigm.openmldb.batch.end2end
+
+import com._4paradigm.openmldb.batch.SparkTestSuite
+import com._4paradigm.openmldb.batch.api.OpenmldbSession
+import com._4paradigm.openmldb.batch.utils.SparkUtil
+import org.apache.spark.sql.Row
+import org.apache.spark.sql.types.{IntegerType, LongType, StringType, StructField, StructType}
+
+
+class TestFusedPlan extends SparkTestSuite {
+
+  test("Test end2end fused plan of window and last join") {
+    val spark = getSparkSession
+
+    val data1 = Seq(
+      Row(1, "tom", 100, 1L),
+      Row(2, "amy", 200, 2L),
+      Row(3, "tom", 300, 3L),
+      Row(4, "amy", 400, 4L),
+      Row(5, "tom", 500, 5L),
+      Row(6, "amy", 600, 6L))
+    val schema1 = StructType(List(
+      StructField("id", IntegerType),
+      StructField("user", StringType),
+      StructField("trans_amount", IntegerType),
+      StructField("trans_time", LongType)))
+    val df1 = spark.createDataFrame(spark.sparkContext.makeRDD(data1), schema1)
+
+    val data2 = Seq(
+      Row("tom", "beijing", 1L),
+      Row("tom", "shanghai", 4L),
+      Row("amy", "hangzhou", 2L))
+    val schema2 = StructType(List(
+      StructField("user", StringType),
+      StructField("city", StringType),
+      StructField("update_time", LongType)))
+    val df2 = spark.createDataFrame(spark.sparkContext.makeRDD(data2), schema2)
+
+    val sqlText =
+      """
+        | SELECT t1.id, t2.city, sum(t1.trans_amount) OVER w AS w_sum_amount FROM t1
+        | LAST JOIN t2 ORDER BY t2.update_time ON t1.user = t2.user
+        | WINDOW w AS (
+        |    PARTITION BY t1.user
+        |    ORDER BY t1.trans_time
+        |    ROWS BETWEEN 1 PRECEDING AND CURRENT ROW);
+        |""".stripMargin
+
+    getSparkSession.conf.set("spark.openmldb.opt.fused.plan", true)
+    val fusedSess = new OpenmldbSession(spark)
+    fusedSess.registerTable("t1", df1)
+    fusedSess.registerTable("t2", df2)
+    val fusedOutputDf = fusedSess.sql(sqlText)
+
+    getSparkSession.conf.set("spark.openmldb.opt.fused.plan", false)
+    val sess = new OpenmldbSession(spark)
+    sess.registerTable("t1", df1)
+    sess.registerTable("t2", df2)
+    val outputDf = sess.sql(sqlText)
+
+    assert(fusedOutputDf.getSparkDf().count() == 6)
+    assert(SparkUtil.approximateDfEqual(fusedOutputDf.getSparkDf(), outputDf.getSparkDf()))
+  }
+
+}
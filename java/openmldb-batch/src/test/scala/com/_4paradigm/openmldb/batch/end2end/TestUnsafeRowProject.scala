@@ -59,4 +59,34 @@ class TestUnsafeRowProject extends SparkTestSuite {
     assert(SparkUtil.approximateDfEqual(outputDf.getSparkDf(), sparksqlOutputDf, false))
   }
 
+  test("Test end2end UnsafeRow optimization for row project in batches") {
+
+    getSparkSession.conf.set("spark.openmldb.unsaferow.opt", true)
+    getSparkSession.conf.set("spark.openmldb.opt.unsaferow.project", true)
+    // 10 rows are projected in 4 batches
+    getSparkSession.conf.set("spark.openmldb.opt.unsaferow.project.batch", 3)
+    val spark = getSparkSession
+    val sess = new OpenmldbSession(spark)
+
+    val data = (1 to 10).map(i => Row(i, 111 * (i % 2 + 1), 100 * i, i))
+    val schema = StructType(List(
+      StructField("id", IntegerType),
+      StructField("user", IntegerType),
+      StructField("trans_amount", IntegerType),
+      StructField("trans_time", IntegerType)))
+    val df = spark.createDataFrame(spark.sparkContext.makeRDD(data), schema)
+
+    sess.registerTable("t1", df)
+    df.createOrReplaceTempView("t1")
+
+    val sqlText = "SELECT id * 2, user + 1000, trans_amount FROM t1"
+    val outputDf = sess.sql(sqlText)
+
+    val sparksqlOutputDf = sess.sparksql(sqlText)
+    assert(SparkUtil.approximateDfEqual(outputDf.getSparkDf(), sparksqlOutputDf, false))
+
+    getSparkSession.conf.unset("spark.openmldb.opt.unsaferow.project")
+    getSparkSession.conf.unset("spark.openmldb.opt.unsaferow.project.batch")
+  }
+
 }
@@ -21,7 +21,7 @@ import com._4paradigm.openmldb.batch.api.OpenmldbSession
 import com._4paradigm.openmldb.batch.utils.SparkUtil
 import com._4paradigm.openmldb.batch.utils.SparkUtil.approximateDfEqual
 import org.apache.spark.sql.{Row, SaveMode}
-import org.apache.spark.sql.types.{DoubleType, IntegerType, StringType, StructField, StructType}
+import org.apache.spark.sql.types.{DoubleType, IntegerType, LongType, StringType, StructField, StructType}
 
 
 class TestWindowSkewOpt extends SparkTestSuite {
@@ -281,4 +281,65 @@ class TestWindowSkewOpt extends SparkTestSuite {
     assert(approximateDfEqual(outputDf.getSparkDf(), compareDf, false))
   }
 
+  test("Test end2end window skew optimization for hot keys") {
+
+    getSparkSession.conf.set("spark.openmldb.window.skew.opt", true)
+    getSparkSession.conf.set("spark.openmldb.window.skew.opt.hotkey", true)
+    getSparkSession.conf.set("spark.openmldb.window.skew.opt.hotkey.sample.ratio", 1.0)
+    getSparkSession.conf.set("spark.openmldb.window.skew.opt.hotkey.threshold", 5)
+    val spark = getSparkSession
+    val sess = new OpenmldbSession(spark)
+
+    // Only tom is the hot key
+    val data = Seq(
+      Row(1, "tom", 100, 1L),
+      Row(2, "amy", 200, 2L),
+      Row(3, "tom", 300, 3L),
+      Row(4, "amy", 400, 4L),
+      Row(5, "tom", 500, 5L),
+      Row(6, "tom", 600, 6L),
+      Row(7, "tom", 700, 7L),
+      Row(8, "amy", 800, 8L),
+      Row(9, "tom", 900, 9L),
+      Row(10, "amy", 1000, 10L))
+    val schema = StructType(List(
+      StructField("id", IntegerType),
+      StructField("user", StringType),
+      StructField("trans_amount", IntegerType),
+      StructField("trans_time", LongType)))
+    val df = spark.createDataFrame(spark.sparkContext.makeRDD(data), schema)
+
+    sess.registerTable("t1", df)
+
+    val sqlText ="""
+                   | SELECT id, sum(trans_amount) OVER w AS w_sum_amount FROM t1
+                   | WINDOW w AS (
+                   |    PARTITION BY user
+                   |    ORDER BY trans_time
+                   |    ROWS_RANGE BETWEEN 3 PRECEDING AND CURRENT ROW);
+     """.stripMargin
+
+    val outputDf = sess.sql(sqlText)
+
+    val compareData = Seq(
+      Row(1, 100),
+      Row(3, 400),
+      Row(5, 800),
+      Row(6, 1400),
+      Row(7, 1800),
+      Row(9, 2200),
+      Row(2, 200),
+      Row(4, 600),
+      Row(8, 800),
+      Row(10, 1800))
+    val compareSchema = StructType(List(
+      StructField("id", IntegerType),
+      StructField("w_sum_amount", IntegerType)))
+    val compareDf = spark.createDataFrame(spark.sparkContext.makeRDD(compareData), compareSchema)
+
+    assert(SparkUtil.approximateDfEqual(outputDf.getSparkDf(), compareDf, false))
+
+    getSparkSession.conf.unset("spark.openmldb.window.skew.opt.hotkey")
+  }
+
 }
@@ -17,10 +17,11 @@
 package com._4paradigm.openmldb.batch.utils
 
 import com._4paradigm.openmldb.batch.SparkTestSuite
-import com._4paradigm.openmldb.batch.utils.SkewDataFrameUtils.{genAddColumnsDf, genDistributionDf, genUnionDf}
+import com._4paradigm.openmldb.batch.utils.SkewDataFrameUtils.{genAddColumnsDf, genDistributionDf,
+  genHotKeyDistributionDf, genHotKeyExpandedDf, genOrderKeyCol, genUnionDf}
 import com._4paradigm.openmldb.batch.utils.SparkUtil.approximateDfEqual
 import org.apache.spark.sql.Row
-import org.apache.spark.sql.types.{BooleanType, IntegerType, StructField, StructType}
+import org.apache.spark.sql.types.{BooleanType, IntegerType, LongType, StructField, StructType}
 
 import scala.collection.mutable
 
@@ -180,4 +181,81 @@ class TestSkewDataFrameUtils extends SparkTestSuite {
     assert(approximateDfEqual(resultDf2, compareDf2, false))
   }
 
+  test("Test genHotKeyDistributionDf") {
+    val spark = getSparkSession
+    val inputDf = spark.createDataFrame(spark.sparkContext.makeRDD(data), schema)
+    val orderKeyCol = genOrderKeyCol(inputDf, orderByColIndex)
+
+    // Both keys are hot without sampling
+    val resultDf1 = genHotKeyDistributionDf(inputDf, quantile, repartitionColIndex, orderKeyCol,
+      partitionKeyColName, 1.0, 3)
+
+    val compareData = Seq(
+      Row(550, 3L, 4L),
+      Row(50, 0L, 1L)
+    )
+
+    val compareSchema = StructType(List(
+      StructField(partitionKeyColName, IntegerType),
+      StructField("PERCENTILE_1", LongType),
+      StructField("PERCENTILE_2", LongType)))
+
+    val compareDf = spark.createDataFrame(spark.sparkContext.makeRDD(compareData), compareSchema)
+
+    assert(approximateDfEqual(resultDf1, compareDf, false))
+
+    // No key reaches the threshold
+    val resultDf2 = genHotKeyDistributionDf(inputDf, quantile, repartitionColIndex, orderKeyCol,
+      partitionKeyColName, 1.0, 4)
+    assert(resultDf2.count() == 0)
+  }
+
+  test("Test genHotKeyExpandedDf") {
+    val spark = getSparkSession
+    val inputDf = spark.createDataFrame(spark.sparkContext.makeRDD(data), schema)
+    val orderKeyCol = genOrderKeyCol(inputDf, orderByColIndex)
+
+    // Only 550 is the hot key
+    val hotKeyData = Seq(Row(550, 3L, 4L))
+    val hotKeySchema = StructType(List(
+      StructField(partitionKeyColName, IntegerType),
+      StructField("PERCENTILE_1", LongType),
+      StructField("PERCENTILE_2", LongType)))
+    val hotKeyDf = spark.createDataFrame(spark.sparkContext.makeRDD(hotKeyData), hotKeySchema)
+
+    val compareSchema = StructType(List(
+      StructField("col0", IntegerType),
+      StructField("col1", IntegerType),
+      StructField(partIdColName, IntegerType),
+      StructField(expandedRowColName, BooleanType)
+    ))
+
+    // Expand the rows within the window range of 1
+    val resultDf1 = genHotKeyExpandedDf(inputDf, hotKeyDf, quantile, repartitionColIndex, orderKeyCol,
+      partitionKeyColName, partIdColName, expandedRowColName, -1, true)
+
+    val compareData1 = Seq(
+      Row(50, 0, 3, false),
+      Row(50, 1, 3, false),
+      Row(50, 2, 3, false),
+      Row(550, 3, 1, false),
+      Row(550, 3, 2, true),
+      Row(550, 4, 2, false),
+      Row(550, 3, 3, true),
+      Row(550, 4, 3, true),
+      Row(550, 5, 3, false)
+    )
+
+    val compareDf1 = spark.createDataFrame(spark.sparkContext.makeRDD(compareData1), compareSchema)
+
+    assert(approximateDfEqual(resultDf1, compareDf1, false))
+
+    // Expand all the history of the hot key
+    val resultDf2 = genHotKeyExpandedDf(inputDf, hotKeyDf, quantile, repartitionColIndex, orderKeyCol,
+      partitionKeyColName, partIdColName, expandedRowColName, Long.MinValue, true)
+
+    assert(resultDf2.count() == 9)
+    assert(resultDf2.filter(s"${expandedRowColName} = true").count() == 3)
+  }
+
 }
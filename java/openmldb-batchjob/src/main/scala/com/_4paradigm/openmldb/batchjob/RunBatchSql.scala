@@ -26,7 +26,11 @@ object RunBatchSql {
       throw new Exception(s"Require args: sql but get args: ${args.mkString(",")}")
     }
 
-    runBatchSql(args(0))
+    if (args.length >= 3) {
+      runBatchSqlToResult(args(0), args(1), args(2))
+    } else {
+      runBatchSql(args(0))
+    }
   }
 
   def runBatchSql(sql: String): Unit = {
@@ -35,4 +39,20 @@ object RunBatchSql {
     sess.close()
   }
 
+  // write the whole result to the files of csv or parquet format under resultPath, they are read by pages by the
+  // taskmanager. the csv files have the headers and quote by "" so the strings of several lines are kept
+  def runBatchSqlToResult(sql: String, resultPath: String, format: String): Unit = {
+    val spark = SparkSession.builder().getOrCreate()
+    // the timestamps of parquet are the milliseconds rather than int96
+    spark.conf.set("spark.sql.parquet.outputTimestampType", "TIMESTAMP_MILLIS")
+    val sess = new OpenmldbSession(spark)
+    val writer = sess.sql(sql).getSparkDf().write.mode("overwrite")
+    format match {
+      case "csv" => writer.option("header", "true").option("escape", "\"").csv(resultPath)
+      case "parquet" => writer.parquet(resultPath)
+      case _ => throw new IllegalArgumentException(s"unsupported result format $format")
+    }
+    sess.close()
+  }
+
 }
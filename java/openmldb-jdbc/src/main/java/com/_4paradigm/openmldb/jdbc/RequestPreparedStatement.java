@@ -22,6 +22,7 @@ import java.io.InputStream;
 import java.io.Reader;
 import java.math.BigDecimal;
 import java.net.URL;
+import java.nio.ByteBuffer;
 import java.nio.charset.Charset;
 import java.nio.charset.StandardCharsets;
 import java.sql.Date;
@@ -44,6 +45,7 @@ public class RequestPreparedStatement implements java.sql.PreparedStatement {
     protected boolean closed = false;
     protected boolean closeOnComplete = false;
     protected Map<Integer, Integer> stringsLen = new HashMap<>();
+    protected RequestRowEncoder rowEncoder;
 
     private void checkNull() throws SQLException {
         if (db == null) {
@@ -300,49 +302,12 @@ public class RequestPreparedStatement implements java.sql.PreparedStatement {
                 throw new SQLException("data not enough, index is " + i);
             }
         }
-        int strLen = 0;
-        for (Map.Entry<Integer, Integer> entry : stringsLen.entrySet()) {
-            strLen += entry.getValue();
+        // the row is encoded in java and set with one jni call
+        if (this.rowEncoder == null) {
+            this.rowEncoder = new RequestRowEncoder(this.currentSchema);
         }
-        boolean ok = this.currentRow.Init(strLen);
-        if (!ok) {
-            throw new SQLException("build data row failed");
-        }
-        for (int i = 0; i < this.currentSchema.GetColumnCnt(); i++) {
-            DataType dataType = this.currentSchema.GetColumnType(i);
-            Object data = this.currentDatas.get(i);
-            if (data == null) {
-                ok = this.currentRow.AppendNULL();
-            } else {
-                if (DataType.kTypeBool.equals(dataType)) {
-                    ok = this.currentRow.AppendBool((boolean) data);
-                } else if (DataType.kTypeDate.equals(dataType)) {
-                    java.sql.Date date = (java.sql.Date) data;
-                    ok = this.currentRow.AppendDate(date.getYear() + 1900, date.getMonth() + 1, date.getDate());
-                } else if (DataType.kTypeDouble.equals(dataType)) {
-                    ok = this.currentRow.AppendDouble((double) data);
-                } else if (DataType.kTypeFloat.equals(dataType)) {
-                    ok = this.currentRow.AppendFloat((float) data);
-                } else if (DataType.kTypeInt16.equals(dataType)) {
-                    ok = this.currentRow.AppendInt16((short) data);
-                } else if (DataType.kTypeInt32.equals(dataType)) {
-                    ok = this.currentRow.AppendInt32((int) data);
-                } else if (DataType.kTypeInt64.equals(dataType)) {
-                    ok = this.currentRow.AppendInt64((long) data);
-                } else if (DataType.kTypeString.equals(dataType)) {
-                    byte[] bdata = (byte[])data;
-                    ok = this.currentRow.AppendString(bdata, bdata.length);
-                } else if (DataType.kTypeTimestamp.equals(dataType)) {
-                    ok = this.currentRow.AppendTimestamp((long) data);
-                } else {
-                    throw new SQLException("unkown data type " + dataType.toString());
-                }
-            }
-            if (!ok) {
-                throw new SQLException("append data failed, idx is " + i);
-            }
-        }
-        if (!this.currentRow.Build()) {
+        ByteBuffer row = this.rowEncoder.encode(this.currentDatas);
+        if (!this.currentRow.SetRow(row, row.limit())) {
             throw new SQLException("build request row failed");
         }
         clearParameters();
@@ -576,6 +541,7 @@ public class RequestPreparedStatement implements java.sql.PreparedStatement {
         this.currentDatas = null;
         this.hasSet = null;
         this.stringsLen = null;
+        this.rowEncoder = null;
         if (this.currentRow != null) {
             this.currentRow.delete();
             this.currentRow = null;
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com._4paradigm.openmldb.jdbc;
+
+import com._4paradigm.openmldb.DataType;
+import com._4paradigm.openmldb.Schema;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.sql.SQLException;
+import java.util.List;
+
+/**
+ * Encodes a request row in java, in the layout SQLRequestRow builds, into a direct buffer, so the row is handed
+ * to SQLRequestRow with one SetRow call instead of one jni call per column.
+ */
+public class RequestRowEncoder {
+    private static final int VERSION_LENGTH = 2;
+    private static final int HEADER_LENGTH = VERSION_LENGTH + 4;
+    private static final long UINT8_MAX = (1L << 8) - 1;
+    private static final long UINT16_MAX = (1L << 16) - 1;
+    private static final long UINT24_MAX = (1L << 24) - 1;
+
+    private final DataType[] types;
+    // the offsets of the fixed-width values, or the indices among the string columns for the strings
+    private final int[] offsets;
+    private final int strFieldStartOffset;
+    private final int strFieldCnt;
+    private ByteBuffer buffer;
+
+    public RequestRowEncoder(Schema schema) throws SQLException {
+        int cnt = schema.GetColumnCnt();
+        types = new DataType[cnt];
+        offsets = new int[cnt];
+        int offset = HEADER_LENGTH + (cnt >> 3) + ((cnt & 0x07) == 0 ? 0 : 1);
+        int strCnt = 0;
+        for (int i = 0; i < cnt; i++) {
+            types[i] = schema.GetColumnType(i);
+            if (DataType.kTypeString.equals(types[i])) {
+                offsets[i] = strCnt++;
+            } else {
+                offsets[i] = offset;
+                offset += getSize(types[i]);
+            }
+        }
+        strFieldStartOffset = offset;
+        strFieldCnt = strCnt;
+        buffer = ByteBuffer.allocateDirect(Math.max(offset, 64)).order(ByteOrder.nativeOrder());
+    }
+
+    private static int getSize(DataType type) throws SQLException {
+        if (DataType.kTypeBool.equals(type)) {
+            return 1;
+        } else if (DataType.kTypeInt16.equals(type)) {
+            return 2;
+        } else if (DataType.kTypeInt32.equals(type) || DataType.kTypeDate.equals(type)
+                || DataType.kTypeFloat.equals(type)) {
+            return 4;
+        } else if (DataType.kTypeInt64.equals(type) || DataType.kTypeTimestamp.equals(type)
+                || DataType.kTypeDouble.equals(type)) {
+            return 8;
+        }
+        throw new SQLException("unkown data type " + type.toString());
+    }
+
+    private static int getAddrLength(long size) {
+        if (size <= UINT8_MAX) {
+            return 1;
+        } else if (size <= UINT16_MAX) {
+            return 2;
+        } else if (size <= UINT24_MAX) {
+            return 3;
+        }
+        return 4;
+    }
+
+    private static int getDate(java.sql.Date date) {
+        int year = date.getYear() + 1900;
+        int month = date.getMonth() + 1;
+        int day = date.getDate();
+        if (year < 1900 || year > 9999 || month < 1 || month > 12 || day < 1 || day > 31) {
+            return 0;
+        }
+        return (year - 1900) << 16 | (month - 1) << 8 | day;
+    }
+
+    private void putAddr(int pos, int addr, int addrLength) {
+        if (addrLength == 1) {
+            buffer.put(pos, (byte) addr);
+        } else if (addrLength == 2) {
+            buffer.putShort(pos, (short) addr);
+        } else if (addrLength == 3) {
+            buffer.put(pos, (byte) (addr >> 16));
+            buffer.put(pos + 1, (byte) (addr >> 8));
+            buffer.put(pos + 2, (byte) addr);
+        } else {
+            buffer.putInt(pos, addr);
+        }
+    }
+
+    /**
+     * Encode the row of the values in the column order, the strings are the utf-8 bytes. The buffer returned is
+     * reused by the next call.
+     */
+    public ByteBuffer encode(List<Object> row) throws SQLException {
+        if (row.size() != types.length) {
+            throw new SQLException("the row has " + row.size() + " values but the schema has " + types.length);
+        }
+        long strLength = 0;
+        for (int i = 0; i < types.length; i++) {
+            if (DataType.kTypeString.equals(types[i]) && row.get(i) != null) {
+                strLength += ((byte[]) row.get(i)).length;
+            }
+        }
+        long total = strFieldStartOffset + strLength;
+        if (total + strFieldCnt <= UINT8_MAX) {
+            total += strFieldCnt;
+        } else if (total + strFieldCnt * 2L <= UINT16_MAX) {
+            total += strFieldCnt * 2L;
+        } else if (total + strFieldCnt * 3L <= UINT24_MAX) {
+            total += strFieldCnt * 3L;
+        } else if (total + strFieldCnt * 4L <= Integer.MAX_VALUE) {
+            total += strFieldCnt * 4L;
+        } else {
+            throw new SQLException("the row is too large, size " + total);
+        }
+        int size = (int) total;
+        if (buffer.capacity() < size) {
+            buffer = ByteBuffer.allocateDirect(Math.max(size, buffer.capacity() * 2)).order(ByteOrder.nativeOrder());
+        }
+        buffer.clear();
+        buffer.limit(size);
+        buffer.put(0, (byte) 1);
+        buffer.put(1, (byte) 1);
+        buffer.putInt(VERSION_LENGTH, size);
+        // the null bitmap and the fixed-width values of the null columns are zeros
+        for (int pos = HEADER_LENGTH; pos < strFieldStartOffset; pos++) {
+            buffer.put(pos, (byte) 0);
+        }
+        int addrLength = getAddrLength(size);
+        int strOffset = strFieldStartOffset + addrLength * strFieldCnt;
+        for (int i = 0; i < types.length; i++) {
+            DataType type = types[i];
+            Object data = row.get(i);
+            if (DataType.kTypeString.equals(type)) {
+                putAddr(strFieldStartOffset + addrLength * offsets[i], strOffset, addrLength);
+                if (data != null) {
+                    byte[] bytes = (byte[]) data;
+                    buffer.position(strOffset);
+                    buffer.put(bytes);
+                    strOffset += bytes.length;
+                }
+            }
+            if (data == null) {
+                int pos = HEADER_LENGTH + (i >> 3);
+                buffer.put(pos, (byte) (buffer.get(pos) | (1 << (i & 0x07))));
+                continue;
+            }
+            int offset = offsets[i];
+            if (DataType.kTypeBool.equals(type)) {
+                buffer.put(offset, (byte) ((boolean) data ? 1 : 0));
+            } else if (DataType.kTypeInt16.equals(type)) {
+                buffer.putShort(offset, (short) data);
+            } else if (DataType.kTypeInt32.equals(type)) {
+                buffer.putInt(offset, (int) data);
+            } else if (DataType.kTypeDate.equals(type)) {
+                buffer.putInt(offset, getDate((java.sql.Date) data));
+            } else if (DataType.kTypeFloat.equals(type)) {
+                buffer.putFloat(offset, (float) data);
+            } else if (DataType.kTypeDouble.equals(type)) {
+                buffer.putDouble(offset, (double) data);
+            } else if (DataType.kTypeInt64.equals(type) || DataType.kTypeTimestamp.equals(type)) {
+                buffer.putLong(offset, (long) data);
+            }
+        }
+        buffer.position(0);
+        return buffer;
+    }
+}
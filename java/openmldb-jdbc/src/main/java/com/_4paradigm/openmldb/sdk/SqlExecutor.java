@@ -43,6 +43,9 @@ public interface SqlExecutor {
 
     boolean executeInsert(String db, String sql, SQLInsertRows rows);
 
+    // put the rows with the batch requests grouped by the tablets of their partitions
+    boolean executeInsertBatch(String db, String sql, SQLInsertRows rows);
+
     TableReader getTableReader();
 
     @Deprecated
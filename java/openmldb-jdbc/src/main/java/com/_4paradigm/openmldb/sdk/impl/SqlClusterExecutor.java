@@ -147,6 +147,17 @@ public class SqlClusterExecutor implements SqlExecutor {
         return ok;
     }
 
+    @Override
+    public boolean executeInsertBatch(String db, String sql, SQLInsertRows rows) {
+        Status status = new Status();
+        boolean ok = sqlRouter.ExecuteInsertBatch(db, sql, rows, status);
+        if (!ok) {
+            logger.error("executeInsertBatch fail: {}", status.getMsg());
+        }
+        status.delete();
+        return ok;
+    }
+
     @Override
     public java.sql.ResultSet executeSQL(String db, String sql) {
         Status status = new Status();
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com._4paradigm.openmldb.spark;
+
+import com._4paradigm.openmldb.SQLInsertRow;
+import com._4paradigm.openmldb.sdk.SdkOption;
+import com._4paradigm.openmldb.sdk.SqlException;
+import com._4paradigm.openmldb.sdk.impl.SqlClusterExecutor;
+import com._4paradigm.openmldb.spark.write.InsertRowBuilder;
+import com._4paradigm.openmldb.spark.write.OpenmldbWriteConfig;
+import com.google.common.base.Preconditions;
+import org.apache.spark.Partitioner;
+import org.apache.spark.api.java.JavaRDD;
+import org.apache.spark.sql.Dataset;
+import org.apache.spark.sql.Row;
+import org.apache.spark.sql.catalyst.CatalystTypeConverters;
+import org.apache.spark.sql.catalyst.InternalRow;
+import org.apache.spark.sql.types.StructType;
+import org.apache.spark.sql.util.CaseInsensitiveStringMap;
+import scala.Function1;
+import scala.Tuple2;
+
+import java.io.IOException;
+import java.util.Iterator;
+import java.util.Map;
+import java.util.NoSuchElementException;
+
+// OpenmldbPartitioner puts the rows of one partition of an openmldb table into one spark partition. The partition
+// of a row is computed by the native sdk, by the same hash and partition splits as the put, so a task of the batch
+// writer, writerType=batch, puts its rows to one tablet mostly. A row is placed by the key of the first index of the
+// table, the keys of its other indexes may be put to other partitions.
+public class OpenmldbPartitioner extends Partitioner {
+    private final int partitionCnt;
+
+    public OpenmldbPartitioner(int partitionCnt) {
+        this.partitionCnt = partitionCnt;
+    }
+
+    @Override
+    public int numPartitions() {
+        return partitionCnt;
+    }
+
+    @Override
+    public int getPartition(Object key) {
+        return (Integer) key;
+    }
+
+    // repartition the rows to write to the table of the options, the options are the same as the write of
+    // openmldb format
+    public static Dataset<Row> repartition(Dataset<Row> df, Map<String, String> options) throws SqlException {
+        CaseInsensitiveStringMap caseInsensitiveOptions = new CaseInsensitiveStringMap(options);
+        String dbName = caseInsensitiveOptions.get(OpenmldbSource.DB);
+        String tableName = caseInsensitiveOptions.get(OpenmldbSource.TABLE);
+        Preconditions.checkNotNull(dbName);
+        Preconditions.checkNotNull(tableName);
+        SdkOption option = OpenmldbSource.parseSdkOption(caseInsensitiveOptions);
+        int partitionCnt;
+        SqlClusterExecutor executor = new SqlClusterExecutor(option);
+        try {
+            partitionCnt = Math.max(executor.getTableInfo(dbName, tableName).getTablePartitionCount(), 1);
+        } finally {
+            executor.close();
+        }
+        OpenmldbWriteConfig config = new OpenmldbWriteConfig(dbName, tableName, option);
+        StructType schema = df.schema();
+        JavaRDD<Row> rows = df.javaRDD()
+                .mapPartitionsToPair(iter -> new PartitionIdIterator(config, schema, iter))
+                .partitionBy(new OpenmldbPartitioner(partitionCnt))
+                .values();
+        return df.sparkSession().createDataFrame(rows, schema);
+    }
+
+    // pair the rows with their partitions, the executor is closed once the rows are exhausted
+    private static class PartitionIdIterator implements Iterator<Tuple2<Integer, Row>> {
+        private final Iterator<Row> input;
+        private final Function1<Object, Object> toInternal;
+        private SqlClusterExecutor executor;
+        private final String dbName;
+        private final String insertSql;
+
+        PartitionIdIterator(OpenmldbWriteConfig config, StructType schema, Iterator<Row> input)
+                throws Exception {
+            this.input = input;
+            this.toInternal = CatalystTypeConverters.createToCatalystConverter(schema);
+            this.dbName = config.dbName;
+            SdkOption option = new SdkOption();
+            option.setZkCluster(config.zkCluster);
+            option.setZkPath(config.zkPath);
+            this.executor = new SqlClusterExecutor(option);
+            this.insertSql = InsertRowBuilder.getInsertPlaceholder(executor, config.dbName, config.tableName);
+        }
+
+        @Override
+        public boolean hasNext() {
+            if (input.hasNext()) {
+                return true;
+            }
+            if (executor != null) {
+                executor.close();
+                executor = null;
+            }
+            return false;
+        }
+
+        @Override
+        public Tuple2<Integer, Row> next() {
+            if (!hasNext()) {
+                throw new NoSuchElementException();
+            }
+            Row row = input.next();
+            SQLInsertRow insertRow = executor.getInsertRow(dbName, insertSql);
+            if (insertRow == null) {
+                throw new IllegalStateException("fail to get the insert row of " + insertSql);
+            }
+            try {
+                InsertRowBuilder.appendRow((InternalRow) toInternal.apply(row), insertRow);
+                return new Tuple2<>((int) insertRow.GetPartitionId(), row);
+            } catch (IOException e) {
+                throw new IllegalArgumentException("fail to get the partition of row " + row, e);
+            } finally {
+                insertRow.delete();
+            }
+        }
+    }
+}
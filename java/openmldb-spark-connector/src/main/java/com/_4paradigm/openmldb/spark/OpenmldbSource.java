@@ -29,10 +29,10 @@ import org.apache.spark.sql.util.CaseInsensitiveStringMap;
 import java.util.Map;
 
 public class OpenmldbSource implements TableProvider, DataSourceRegister {
-    private final String DB = "db";
-    private final String TABLE = "table";
-    private final String ZK_CLUSTER = "zkCluster";
-    private final String ZK_PATH = "zkPath";
+    static final String DB = "db";
+    static final String TABLE = "table";
+    static final String ZK_CLUSTER = "zkCluster";
+    static final String ZK_PATH = "zkPath";
 
     private String dbName;
     private String tableName;
@@ -42,12 +42,16 @@ public class OpenmldbSource implements TableProvider, DataSourceRegister {
     public StructType inferSchema(CaseInsensitiveStringMap options) {
         Preconditions.checkNotNull(dbName = options.get(DB));
         Preconditions.checkNotNull(tableName = options.get(TABLE));
+        option = parseSdkOption(options);
+        return null;
+    }
 
+    static SdkOption parseSdkOption(CaseInsensitiveStringMap options) {
         String zkCluster = options.get(ZK_CLUSTER);
         String zkPath = options.get(ZK_PATH);
         Preconditions.checkNotNull(zkCluster);
         Preconditions.checkNotNull(zkPath);
-        option = new SdkOption();
+        SdkOption option = new SdkOption();
         option.setZkCluster(zkCluster);
         option.setZkPath(zkPath);
         String timeout = options.get("sessionTimeout");
@@ -62,8 +66,7 @@ public class OpenmldbSource implements TableProvider, DataSourceRegister {
         if (debug != null) {
             option.setEnableDebug(Boolean.valueOf(debug));
         }
-
-        return null;
+        return option;
     }
 
     @Override
@@ -63,7 +63,7 @@ public class OpenmldbTable implements SupportsWrite {
 
     @Override
     public WriteBuilder newWriteBuilder(LogicalWriteInfo info) {
-        OpenmldbWriteConfig config = new OpenmldbWriteConfig(dbName, tableName, option);
+        OpenmldbWriteConfig config = new OpenmldbWriteConfig(dbName, tableName, option, info.options());
         return new OpenmldbWriteBuilder(config, info);
     }
 
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com._4paradigm.openmldb.spark.write;
+
+import com._4paradigm.openmldb.DataType;
+import com._4paradigm.openmldb.SQLInsertRow;
+import com._4paradigm.openmldb.Schema;
+import com._4paradigm.openmldb.sdk.SqlExecutor;
+import org.apache.spark.sql.catalyst.InternalRow;
+
+import java.io.IOException;
+import java.sql.SQLException;
+import java.time.LocalDate;
+
+// build the native insert rows of the spark rows, the columns of the spark rows are in the order of the table
+public class InsertRowBuilder {
+    private InsertRowBuilder() {}
+
+    public static String getInsertPlaceholder(SqlExecutor executor, String dbName, String tableName)
+            throws SQLException {
+        int columnCnt = executor.getTableSchema(dbName, tableName).getColumnList().size();
+        StringBuilder insert = new StringBuilder("insert into " + tableName + " values(?");
+        for (int i = 1; i < columnCnt; i++) {
+            insert.append(",?");
+        }
+        insert.append(");");
+        return insert.toString();
+    }
+
+    public static void appendRow(InternalRow record, SQLInsertRow row) throws IOException {
+        Schema schema = row.GetSchema();
+        if (record.numFields() != schema.GetColumnCnt()) {
+            throw new IOException("the row has " + record.numFields() + " columns, but the table has "
+                    + schema.GetColumnCnt());
+        }
+        int strLength = 0;
+        for (int i = 0; i < record.numFields(); i++) {
+            if (DataType.kTypeString.equals(schema.GetColumnType(i)) && !record.isNullAt(i)) {
+                strLength += record.getUTF8String(i).numBytes();
+            }
+        }
+        row.Init(strLength);
+        for (int i = 0; i < record.numFields(); i++) {
+            if (!appendValue(record, i, schema.GetColumnType(i), row)) {
+                throw new IOException("fail to append column " + schema.GetColumnName(i));
+            }
+        }
+        if (!row.IsComplete()) {
+            throw new IOException("the row is not complete");
+        }
+    }
+
+    private static boolean appendValue(InternalRow record, int i, DataType type, SQLInsertRow row) {
+        if (record.isNullAt(i)) {
+            return row.AppendNULL();
+        } else if (DataType.kTypeBool.equals(type)) {
+            return row.AppendBool(record.getBoolean(i));
+        } else if (DataType.kTypeInt16.equals(type)) {
+            return row.AppendInt16(record.getShort(i));
+        } else if (DataType.kTypeInt32.equals(type)) {
+            return row.AppendInt32(record.getInt(i));
+        } else if (DataType.kTypeInt64.equals(type)) {
+            return row.AppendInt64(record.getLong(i));
+        } else if (DataType.kTypeFloat.equals(type)) {
+            return row.AppendFloat(record.getFloat(i));
+        } else if (DataType.kTypeDouble.equals(type)) {
+            return row.AppendDouble(record.getDouble(i));
+        } else if (DataType.kTypeString.equals(type)) {
+            return row.AppendString(record.getUTF8String(i).toString());
+        } else if (DataType.kTypeDate.equals(type)) {
+            // spark keeps the days since epoch
+            LocalDate date = LocalDate.ofEpochDay(record.getInt(i));
+            return row.AppendDate(date.getYear(), date.getMonthValue(), date.getDayOfMonth());
+        } else if (DataType.kTypeTimestamp.equals(type)) {
+            // spark keeps the microseconds and openmldb keeps the milliseconds
+            return row.AppendTimestamp(record.getLong(i) / 1000);
+        }
+        return false;
+    }
+}
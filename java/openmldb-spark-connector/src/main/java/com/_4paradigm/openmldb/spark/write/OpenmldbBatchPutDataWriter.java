@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com._4paradigm.openmldb.spark.write;
+
+import com._4paradigm.openmldb.SQLInsertRows;
+import com._4paradigm.openmldb.sdk.SdkOption;
+import com._4paradigm.openmldb.sdk.SqlException;
+import com._4paradigm.openmldb.sdk.impl.SqlClusterExecutor;
+import org.apache.spark.sql.catalyst.InternalRow;
+import org.apache.spark.sql.connector.write.DataWriter;
+import org.apache.spark.sql.connector.write.WriterCommitMessage;
+
+import java.io.IOException;
+import java.sql.SQLException;
+
+// write the rows of a task in batches of batchRows rows, every batch is put with the BatchPut requests grouped by
+// the tablets of the partitions instead of a Put per row. the rows repartitioned by OpenmldbPartitioner are put to
+// one partition mostly, so the batches go to one tablet
+public class OpenmldbBatchPutDataWriter implements DataWriter<InternalRow> {
+    private final String dbName;
+    private final int batchRows;
+    private final SqlClusterExecutor executor;
+    private final String insertSql;
+    private SQLInsertRows rows = null;
+    private int rowCnt = 0;
+
+    public OpenmldbBatchPutDataWriter(OpenmldbWriteConfig config) {
+        this.dbName = config.dbName;
+        this.batchRows = config.batchRows;
+        try {
+            SdkOption option = new SdkOption();
+            option.setZkCluster(config.zkCluster);
+            option.setZkPath(config.zkPath);
+            executor = new SqlClusterExecutor(option);
+            insertSql = InsertRowBuilder.getInsertPlaceholder(executor, config.dbName, config.tableName);
+        } catch (SQLException | SqlException e) {
+            throw new IllegalStateException("fail to create the writer of " + config.dbName + "."
+                    + config.tableName, e);
+        }
+    }
+
+    @Override
+    public void write(InternalRow record) throws IOException {
+        if (rows == null) {
+            rows = executor.getInsertRows(dbName, insertSql);
+            if (rows == null) {
+                throw new IOException("fail to get the insert rows of " + insertSql);
+            }
+        }
+        InsertRowBuilder.appendRow(record, rows.NewRow());
+        if (++rowCnt >= batchRows) {
+            flush();
+        }
+    }
+
+    private void flush() throws IOException {
+        if (rows == null) {
+            return;
+        }
+        try {
+            if (rowCnt > 0 && !executor.executeInsertBatch(dbName, insertSql, rows)) {
+                throw new IOException("fail to put a batch of " + rowCnt + " rows");
+            }
+        } finally {
+            rows.delete();
+            rows = null;
+            rowCnt = 0;
+        }
+    }
+
+    @Override
+    public WriterCommitMessage commit() throws IOException {
+        flush();
+        return null;
+    }
+
+    @Override
+    public void abort() throws IOException {
+        if (rows != null) {
+            rows.delete();
+            rows = null;
+            rowCnt = 0;
+        }
+    }
+
+    @Override
+    public void close() throws IOException {
+        abort();
+        executor.close();
+    }
+}
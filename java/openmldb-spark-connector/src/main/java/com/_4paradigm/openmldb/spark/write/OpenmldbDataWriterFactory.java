@@ -30,6 +30,9 @@ public class OpenmldbDataWriterFactory implements DataWriterFactory {
 
     @Override
     public DataWriter<InternalRow> createWriter(int partitionId, long taskId) {
+        if (OpenmldbWriteConfig.WRITER_TYPE_BATCH.equals(config.writerType)) {
+            return new OpenmldbBatchPutDataWriter(config);
+        }
         return new OpenmldbDataWriter(config, partitionId, taskId);
     }
 }
@@ -18,12 +18,20 @@
 package com._4paradigm.openmldb.spark.write;
 
 import com._4paradigm.openmldb.sdk.SdkOption;
+import org.apache.spark.sql.util.CaseInsensitiveStringMap;
 
 import java.io.Serializable;
 
 // Must serializable
 public class OpenmldbWriteConfig implements Serializable {
+    // the rows are inserted one by one through the insert prepared statement
+    public static final String WRITER_TYPE_SINGLE = "single";
+    // the rows are put in batches grouped by the tablets, see OpenmldbBatchPutDataWriter
+    public static final String WRITER_TYPE_BATCH = "batch";
+
     public String dbName, tableName, zkCluster, zkPath;
+    public String writerType = WRITER_TYPE_SINGLE;
+    public int batchRows = 10000;
 
     public OpenmldbWriteConfig(String dbName, String tableName, SdkOption option) {
         this.dbName = dbName;
@@ -32,4 +40,17 @@ public class OpenmldbWriteConfig implements Serializable {
         this.zkPath = option.getZkPath();
         // TODO(hw): other configs in SdkOption
     }
+
+    public OpenmldbWriteConfig(String dbName, String tableName, SdkOption option,
+                               CaseInsensitiveStringMap writeOptions) {
+        this(dbName, tableName, option);
+        this.writerType = writeOptions.getOrDefault("writerType", WRITER_TYPE_SINGLE);
+        if (!writerType.equals(WRITER_TYPE_SINGLE) && !writerType.equals(WRITER_TYPE_BATCH)) {
+            throw new IllegalArgumentException("unknown writerType " + writerType);
+        }
+        this.batchRows = writeOptions.getInt("writerBatchRows", batchRows);
+        if (batchRows <= 0) {
+            throw new IllegalArgumentException("writerBatchRows should be positive");
+        }
+    }
 }
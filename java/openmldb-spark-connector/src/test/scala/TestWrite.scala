@@ -18,9 +18,12 @@ import java.lang.Thread.currentThread
 
 import com._4paradigm.openmldb.sdk.SdkOption
 import com._4paradigm.openmldb.sdk.impl.SqlClusterExecutor
+import com._4paradigm.openmldb.spark.OpenmldbPartitioner
 import org.apache.spark.sql.{AnalysisException, SparkSession}
 import org.scalatest.FunSuite
 
+import scala.collection.JavaConverters._
+
 class TestWrite extends FunSuite {
   test("Test write a local file to openmldb") {
     val sess = SparkSession.builder().master("local[*]").getOrCreate()
@@ -74,4 +77,49 @@ class TestWrite extends FunSuite {
       case e: Any => fail(s"shouldn't catch $e")
     }
   }
+
+  test("Test write a local file to openmldb by batch put") {
+    val sess = SparkSession.builder().master("local[*]").getOrCreate()
+    val readFilePath = currentThread.getContextClassLoader.getResource("test.csv")
+    val df = sess.read.option("header", "true").option("nullValue", "null")
+      .schema("c1 boolean, c2 smallint, c3 int, c4 bigint, c5 float, c6 double,c7 string, c8 date, c9 timestamp, " +
+        "c10_str string")
+      .csv(readFilePath.toString)
+
+    val zkCluster = "127.0.0.1:6181"
+    val zkPath = "/onebox"
+    val db = "db"
+    val table = "spark_batch_write_test"
+    val options = Map("db" -> db, "table" -> table, "zkCluster" -> zkCluster, "zkPath" -> zkPath)
+
+    val option = new SdkOption
+    option.setZkCluster(zkCluster)
+    option.setZkPath(zkPath)
+    val executor = new SqlClusterExecutor(option)
+    executor.createDB(db)
+    executor.executeDDL(db, s"drop table $table")
+    executor.executeDDL(db, s"create table $table(c1 bool, c2 smallint, c3 int, c4 bigint, c5 float, c6 double," +
+      "c7 string, c8 date, c9 timestamp, c10_str string, index(key=c7)) options(partitionnum=4);")
+
+    // the rows of a task go to one partition of the table
+    val repartitioned = OpenmldbPartitioner.repartition(df, options.asJava)
+    assert(repartitioned.rdd.getNumPartitions == 4)
+    assert(repartitioned.count() == df.count())
+    repartitioned.write.format("openmldb").options(options)
+      .option("writerType", "batch").option("writerBatchRows", "2").mode("append").save()
+
+    val rs = executor.executeSQL(db, s"select * from $table")
+    var cnt = 0
+    while (rs.next()) {
+      cnt += 1
+    }
+    assert(cnt == df.count())
+
+    try {
+      df.write.format("openmldb").options(options).option("writerType", "unknown").mode("append").save()
+      fail("unreachable")
+    } catch {
+      case e: IllegalArgumentException => println(s"catch $e")
+    }
+  }
 }
@@ -58,6 +58,8 @@ public class TaskManagerConfig {
     public static String SPARK_EVENTLOG_DIR;
     public static int SPARK_YARN_MAXAPPATTEMPTS;
     public static String OFFLINE_DATA_PREFIX;
+    public static String JOB_RESULT_PREFIX;
+    public static int JOB_RESULT_READ_THREAD;
     public static String NAMENODE_URI;
     public static String BATCHJOB_JAR_PATH;
     public static String HADOOP_CONF_DIR;
@@ -215,6 +217,16 @@ public class TaskManagerConfig {
             }
         }
 
+        // the results of the offline queries read by pages are written under it
+        JOB_RESULT_PREFIX = prop.getProperty("job.result.prefix", "");
+        if (JOB_RESULT_PREFIX.isEmpty()) {
+            JOB_RESULT_PREFIX = OFFLINE_DATA_PREFIX + (OFFLINE_DATA_PREFIX.endsWith("/") ? "" : "/") + "job_results/";
+        }
+        JOB_RESULT_READ_THREAD = Integer.parseInt(prop.getProperty("job.result.read.thread", "4"));
+        if (JOB_RESULT_READ_THREAD <= 0) {
+            throw new ConfigException("job.result.read.thread", "should be larger than 0");
+        }
+
         BATCHJOB_JAR_PATH = prop.getProperty("batchjob.jar.path", "");
         if (BATCHJOB_JAR_PATH.isEmpty()) {
             try {
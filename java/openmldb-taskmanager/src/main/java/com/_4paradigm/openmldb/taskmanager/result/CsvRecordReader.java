@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package com._4paradigm.openmldb.taskmanager.result;
+
+import java.io.Closeable;
+import java.io.IOException;
+import java.io.Reader;
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * Read the records of the csv files written by spark with the escape of quote, that is the quote in a quoted value
+ * is doubled. A quoted value may have several lines, an empty value without quotes is null.
+ */
+public class CsvRecordReader implements Closeable {
+    private static final char QUOTE = '"';
+    private static final char SEPARATOR = ',';
+
+    private final Reader reader;
+    private int next;
+
+    public CsvRecordReader(Reader reader) throws IOException {
+        this.reader = reader;
+        this.next = reader.read();
+    }
+
+    /**
+     * @return the values of the next record, or null if there is no more record
+     */
+    public List<String> next() throws IOException {
+        if (next == -1) {
+            return null;
+        }
+        List<String> values = new ArrayList<>();
+        StringBuilder value = new StringBuilder();
+        boolean quoted = false;
+        boolean inQuotes = false;
+        while (true) {
+            int c = next;
+            next = reader.read();
+            if (inQuotes) {
+                if (c == -1) {
+                    throw new IOException("the quoted value is not closed");
+                } else if (c == QUOTE && next == QUOTE) {
+                    value.append(QUOTE);
+                    next = reader.read();
+                } else if (c == QUOTE) {
+                    inQuotes = false;
+                } else {
+                    value.append((char) c);
+                }
+            } else if (c == QUOTE && value.length() == 0 && !quoted) {
+                quoted = true;
+                inQuotes = true;
+            } else if (c == SEPARATOR || c == '\n' || c == '\r' || c == -1) {
+                values.add(quoted || value.length() > 0 ? value.toString() : null);
+                value.setLength(0);
+                quoted = false;
+                if (c == '\r' && next == '\n') {
+                    next = reader.read();
+                }
+                if (c != SEPARATOR) {
+                    return values;
+                }
+            } else {
+                value.append((char) c);
+            }
+        }
+    }
+
+    @Override
+    public void close() throws IOException {
+        reader.close();
+    }
+}
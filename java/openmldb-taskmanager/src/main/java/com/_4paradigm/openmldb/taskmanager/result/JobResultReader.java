@@ -0,0 +1,245 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com._4paradigm.openmldb.taskmanager.result;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.FileStatus;
+import org.apache.hadoop.fs.FileSystem;
+import org.apache.hadoop.fs.Path;
+import org.apache.parquet.example.data.Group;
+import org.apache.parquet.format.converter.ParquetMetadataConverter;
+import org.apache.parquet.hadoop.ParquetFileReader;
+import org.apache.parquet.hadoop.ParquetReader;
+import org.apache.parquet.hadoop.example.GroupReadSupport;
+import org.apache.parquet.hadoop.metadata.BlockMetaData;
+import org.apache.parquet.hadoop.metadata.ParquetMetadata;
+import org.apache.parquet.schema.GroupType;
+import org.apache.parquet.schema.PrimitiveType;
+import org.apache.parquet.schema.Type;
+
+import java.io.BufferedReader;
+import java.io.IOException;
+import java.io.InputStreamReader;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+
+/**
+ * Read the rows of a job result by pages. The result is the directory of the csv or parquet files written by spark,
+ * the rows are in the order of the sorted part files. The files and their row counts are cached by the result path
+ * as the result is not changed after the job is finished, so a page only reads the files it overlaps.
+ */
+public class JobResultReader {
+    private static final int CACHE_SIZE = 64;
+
+    /**
+     * The rows of a page, a null value is null.
+     */
+    public static class Page {
+        public List<String> columnNames;
+        public List<List<String>> rows;
+        public long totalRows;
+    }
+
+    private static class ResultFiles {
+        boolean parquet;
+        List<String> columnNames;
+        List<Path> paths = new ArrayList<>();
+        long[] rowCounts;
+        long totalRows;
+    }
+
+    private final Configuration conf;
+    private final ExecutorService executor;
+    private final Map<String, ResultFiles> cache = Collections.synchronizedMap(
+            new LinkedHashMap<String, ResultFiles>(16, 0.75f, true) {
+                @Override
+                protected boolean removeEldestEntry(Map.Entry<String, ResultFiles> eldest) {
+                    return size() > CACHE_SIZE;
+                }
+            });
+
+    public JobResultReader(Configuration conf, int threadNum) {
+        this.conf = conf;
+        this.executor = Executors.newFixedThreadPool(threadNum);
+    }
+
+    /**
+     * Read the rows in [offset, offset + limit) of the result, the files overlapped are read in parallel.
+     */
+    public Page read(String resultPath, long offset, int limit) throws Exception {
+        ResultFiles files = getFiles(resultPath);
+        List<Future<List<List<String>>>> futures = new ArrayList<>();
+        long end = offset + limit;
+        long start = 0;
+        for (int i = 0; i < files.paths.size() && start < end; i++) {
+            long fileEnd = start + files.rowCounts[i];
+            if (fileEnd > offset) {
+                final Path path = files.paths.get(i);
+                final long skip = Math.max(0, offset - start);
+                final long num = Math.min(fileEnd, end) - start - skip;
+                futures.add(executor.submit(() -> readRows(files, path, skip, num)));
+            }
+            start = fileEnd;
+        }
+        Page page = new Page();
+        page.columnNames = files.columnNames;
+        page.rows = new ArrayList<>();
+        for (Future<List<List<String>>> future : futures) {
+            page.rows.addAll(future.get());
+        }
+        page.totalRows = files.totalRows;
+        return page;
+    }
+
+    public void close() {
+        executor.shutdown();
+    }
+
+    private ResultFiles getFiles(String resultPath) throws Exception {
+        ResultFiles files = cache.get(resultPath);
+        if (files != null) {
+            return files;
+        }
+        Path dir = new Path(resultPath);
+        FileSystem fs = dir.getFileSystem(conf);
+        FileStatus[] statuses = fs.listStatus(dir);
+        Arrays.sort(statuses);
+        files = new ResultFiles();
+        for (FileStatus status : statuses) {
+            String name = status.getPath().getName();
+            // skip _SUCCESS and the checksum files
+            if (!status.isFile() || name.startsWith("_") || name.startsWith(".")) {
+                continue;
+            }
+            if (name.endsWith(".parquet")) {
+                files.parquet = true;
+            } else if (!name.endsWith(".csv")) {
+                continue;
+            }
+            files.paths.add(status.getPath());
+        }
+        List<Future<Long>> futures = new ArrayList<>();
+        for (Path path : files.paths) {
+            futures.add(executor.submit(() -> countRows(path, files.parquet)));
+        }
+        files.rowCounts = new long[files.paths.size()];
+        for (int i = 0; i < futures.size(); i++) {
+            files.rowCounts[i] = futures.get(i).get();
+            files.totalRows += files.rowCounts[i];
+        }
+        files.columnNames = files.paths.isEmpty() ? new ArrayList<>() : readColumnNames(files.paths.get(0),
+                files.parquet);
+        cache.put(resultPath, files);
+        return files;
+    }
+
+    private CsvRecordReader openCsv(Path path) throws IOException {
+        FileSystem fs = path.getFileSystem(conf);
+        return new CsvRecordReader(new BufferedReader(new InputStreamReader(fs.open(path), StandardCharsets.UTF_8)));
+    }
+
+    private List<String> readColumnNames(Path path, boolean parquet) throws IOException {
+        List<String> names = new ArrayList<>();
+        if (parquet) {
+            for (Type field : readFooter(path).getFileMetaData().getSchema().getFields()) {
+                names.add(field.getName());
+            }
+        } else {
+            try (CsvRecordReader reader = openCsv(path)) {
+                List<String> header = reader.next();
+                if (header != null) {
+                    names.addAll(header);
+                }
+            }
+        }
+        return names;
+    }
+
+    private ParquetMetadata readFooter(Path path) throws IOException {
+        return ParquetFileReader.readFooter(conf, path, ParquetMetadataConverter.NO_FILTER);
+    }
+
+    private long countRows(Path path, boolean parquet) throws IOException {
+        long count = 0;
+        if (parquet) {
+            for (BlockMetaData block : readFooter(path).getBlocks()) {
+                count += block.getRowCount();
+            }
+            return count;
+        }
+        try (CsvRecordReader reader = openCsv(path)) {
+            // the header is not a row
+            if (reader.next() == null) {
+                return 0;
+            }
+            while (reader.next() != null) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    private List<List<String>> readRows(ResultFiles files, Path path, long skip, long num) throws IOException {
+        List<List<String>> rows = new ArrayList<>();
+        if (files.parquet) {
+            try (ParquetReader<Group> reader = ParquetReader.builder(new GroupReadSupport(), path)
+                    .withConf(conf).build()) {
+                Group group;
+                for (long i = 0; rows.size() < num && (group = reader.read()) != null; i++) {
+                    if (i >= skip) {
+                        rows.add(toValues(group));
+                    }
+                }
+            }
+            return rows;
+        }
+        try (CsvRecordReader reader = openCsv(path)) {
+            reader.next();
+            List<String> values;
+            for (long i = 0; rows.size() < num && (values = reader.next()) != null; i++) {
+                if (i >= skip) {
+                    rows.add(values);
+                }
+            }
+        }
+        return rows;
+    }
+
+    private static List<String> toValues(Group group) {
+        GroupType type = group.getType();
+        List<String> values = new ArrayList<>(type.getFieldCount());
+        for (int i = 0; i < type.getFieldCount(); i++) {
+            if (group.getFieldRepetitionCount(i) == 0) {
+                values.add(null);
+            } else if (type.getType(i).isPrimitive() && type.getType(i).asPrimitiveType().getPrimitiveTypeName()
+                    == PrimitiveType.PrimitiveTypeName.BINARY) {
+                values.add(group.getString(i, 0));
+            } else {
+                values.add(group.getValueToString(i, 0));
+            }
+        }
+        return values;
+    }
+}
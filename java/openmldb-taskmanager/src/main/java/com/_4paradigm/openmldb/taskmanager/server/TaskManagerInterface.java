@@ -61,4 +61,7 @@ public interface TaskManagerInterface {
 
     @BrpcMeta(serviceName = "openmldb.taskmanager.TaskManagerServer", methodName = "GetJobLog")
     TaskManager.GetJobLogResponse GetJobLog(TaskManager.GetJobLogRequest request);
+
+    @BrpcMeta(serviceName = "openmldb.taskmanager.TaskManagerServer", methodName = "GetJobResult")
+    TaskManager.GetJobResultResponse GetJobResult(TaskManager.GetJobResultRequest request);
 }
@@ -25,14 +25,19 @@ import com._4paradigm.openmldb.taskmanager.LogManager;
 import com._4paradigm.openmldb.taskmanager.OpenmldbBatchjobManager;
 import com._4paradigm.openmldb.taskmanager.config.TaskManagerConfig;
 import com._4paradigm.openmldb.taskmanager.dao.JobInfo;
+import com._4paradigm.openmldb.taskmanager.result.JobResultReader;
 import com._4paradigm.openmldb.taskmanager.server.StatusCode;
 import com._4paradigm.openmldb.taskmanager.server.TaskManagerInterface;
 import com._4paradigm.openmldb.taskmanager.udf.ExternalFunctionManager;
 import lombok.extern.slf4j.Slf4j;
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.Path;
 import scala.Option;
+import java.io.File;
 import java.util.List;
+import java.util.UUID;
 
 @Slf4j
 public class TaskManagerImpl implements TaskManagerInterface {
@@ -58,8 +63,16 @@ public class TaskManagerImpl implements TaskManagerInterface {
         }
     }
 
+    private final JobResultReader jobResultReader;
+
     public TaskManagerImpl() {
         initExternalFunction();
+        Configuration conf = new Configuration();
+        if (!TaskManagerConfig.HADOOP_CONF_DIR.isEmpty()) {
+            conf.addResource(new Path(TaskManagerConfig.HADOOP_CONF_DIR + File.separator + "core-site.xml"));
+            conf.addResource(new Path(TaskManagerConfig.HADOOP_CONF_DIR + File.separator + "hdfs-site.xml"));
+        }
+        jobResultReader = new JobResultReader(conf, TaskManagerConfig.JOB_RESULT_READ_THREAD);
     }
 
     private void initExternalFunction() {
@@ -193,6 +206,9 @@ public class TaskManagerImpl implements TaskManagerInterface {
     @Override
     public TaskManager.RunBatchSqlResponse RunBatchSql(TaskManager.RunBatchSqlRequest request) {
         try {
+            if (request.hasResultFormat()) {
+                return runBatchSqlToResult(request);
+            }
             String output = OpenmldbBatchjobManager.runBatchSql(request.getSql(), request.getConfMap(),
                     request.getDefaultDb());
             return TaskManager.RunBatchSqlResponse.newBuilder().setCode(StatusCode.SUCCESS).setOutput(output).build();
@@ -202,6 +218,57 @@ public class TaskManagerImpl implements TaskManagerInterface {
         }
     }
 
+    private TaskManager.RunBatchSqlResponse runBatchSqlToResult(TaskManager.RunBatchSqlRequest request) {
+        String format = request.getResultFormat();
+        if (!format.equals("csv") && !format.equals("parquet")) {
+            return TaskManager.RunBatchSqlResponse.newBuilder().setCode(StatusCode.FAILED)
+                    .setMsg("unsupported result format " + format + ", should be csv or parquet").build();
+        }
+        String resultPath = TaskManagerConfig.JOB_RESULT_PREFIX + UUID.randomUUID();
+        JobInfo job = OpenmldbBatchjobManager.runBatchSqlToResult(request.getSql(), request.getConfMap(),
+                request.getDefaultDb(), resultPath, format);
+        TaskManager.RunBatchSqlResponse.Builder builder = TaskManager.RunBatchSqlResponse.newBuilder()
+                .setJobId(job.getId());
+        if (!job.getState().equalsIgnoreCase("finished")) {
+            String msg = "job " + job.getId() + " is " + job.getState();
+            if (job.getError() != null) {
+                msg += ", " + job.getError();
+            }
+            return builder.setCode(StatusCode.FAILED).setMsg(msg).build();
+        }
+        return builder.setCode(StatusCode.SUCCESS).setResultPath(resultPath).build();
+    }
+
+    @Override
+    public TaskManager.GetJobResultResponse GetJobResult(TaskManager.GetJobResultRequest request) {
+        try {
+            String resultPath = request.getResultPath();
+            // only the results written by RunBatchSql can be read
+            if (!resultPath.startsWith(TaskManagerConfig.JOB_RESULT_PREFIX) || resultPath.contains("..")) {
+                return TaskManager.GetJobResultResponse.newBuilder().setCode(StatusCode.FAILED)
+                        .setMsg("invalid result path " + resultPath).build();
+            }
+            JobResultReader.Page page = jobResultReader.read(resultPath, request.getOffset(), request.getLimit());
+            TaskManager.GetJobResultResponse.Builder builder = TaskManager.GetJobResultResponse.newBuilder();
+            builder.setCode(StatusCode.SUCCESS).addAllColumnNames(page.columnNames).setTotalRows(page.totalRows);
+            for (List<String> values : page.rows) {
+                TaskManager.JobResultRow.Builder row = builder.addRowsBuilder();
+                for (int i = 0; i < values.size(); i++) {
+                    if (values.get(i) == null) {
+                        row.addValues("").addNullIdx(i);
+                    } else {
+                        row.addValues(values.get(i));
+                    }
+                }
+            }
+            return builder.build();
+        } catch (Exception e) {
+            e.printStackTrace();
+            return TaskManager.GetJobResultResponse.newBuilder().setCode(StatusCode.FAILED).setMsg(e.getMessage())
+                    .build();
+        }
+    }
+
     // no max wait time
     private JobInfo busyWaitJobInfo(int jobId) throws InterruptedException {
         while (true) {
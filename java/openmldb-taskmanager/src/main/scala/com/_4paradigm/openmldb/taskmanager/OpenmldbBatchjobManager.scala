@@ -51,6 +51,21 @@ object OpenmldbBatchjobManager {
     LogManager.getJobLog(jobInfo.getId)
   }
 
+  /**
+   * Run the SparkSQL job and write the whole result to the files of the format under resultPath, wait until the
+   * job is done.
+   *
+   * @return the job info of the final state
+   */
+  def runBatchSqlToResult(sql: String, sparkConf: java.util.Map[String, String], defaultDb: String,
+                          resultPath: String, format: String): JobInfo = {
+    val jobType = "RunBatchSql"
+    val mainClass = "com._4paradigm.openmldb.batchjob.RunBatchSql"
+    val args = List(sql, resultPath, format)
+
+    SparkJobManager.submitSparkJob(jobType, mainClass, args, sparkConf.asScala.toMap, defaultDb, blocking=true)
+  }
+
   def runBatchAndShow(sql: String, sparkConf: java.util.Map[String, String], defaultDb: String): JobInfo = {
     val jobType = "RunBatchAndShow"
     val mainClass = "com._4paradigm.openmldb.batchjob.RunBatchAndShow"
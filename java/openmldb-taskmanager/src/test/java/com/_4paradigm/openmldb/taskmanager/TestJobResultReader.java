@@ -0,0 +1,110 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com._4paradigm.openmldb.taskmanager;
+
+import com._4paradigm.openmldb.taskmanager.result.JobResultReader;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.Path;
+import org.apache.parquet.example.data.Group;
+import org.apache.parquet.example.data.simple.SimpleGroupFactory;
+import org.apache.parquet.hadoop.ParquetWriter;
+import org.apache.parquet.hadoop.example.ExampleParquetWriter;
+import org.apache.parquet.schema.MessageType;
+import org.apache.parquet.schema.MessageTypeParser;
+import org.testng.Assert;
+import org.testng.annotations.AfterClass;
+import org.testng.annotations.Test;
+import java.io.File;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.util.Arrays;
+import java.util.List;
+
+public class TestJobResultReader {
+    private final JobResultReader reader = new JobResultReader(new Configuration(), 2);
+
+    @AfterClass
+    public void close() {
+        reader.close();
+    }
+
+    private static void writeFile(File dir, String name, String content) throws Exception {
+        Files.write(new File(dir, name).toPath(), content.getBytes(StandardCharsets.UTF_8));
+    }
+
+    @Test
+    public void testCsv() throws Exception {
+        File dir = Files.createTempDirectory("job_result").toFile();
+        writeFile(dir, "_SUCCESS", "");
+        writeFile(dir, "part-00000.csv", "c1,c2\n1,a\n2,\n");
+        writeFile(dir, "part-00001.csv", "c1,c2\n3,\"\"\n4,\"x,\"\"y\"\"\nz\"\n");
+        writeFile(dir, "part-00002.csv", "");
+        writeFile(dir, ".part-00000.csv.crc", "");
+
+        JobResultReader.Page page = reader.read(dir.getAbsolutePath(), 0, 10);
+        Assert.assertEquals(page.columnNames, Arrays.asList("c1", "c2"));
+        Assert.assertEquals(page.totalRows, 4);
+        Assert.assertEquals(page.rows.size(), 4);
+        Assert.assertEquals(page.rows.get(0), Arrays.asList("1", "a"));
+        // an empty value is null unless it is quoted
+        Assert.assertEquals(page.rows.get(1), Arrays.asList("2", null));
+        Assert.assertEquals(page.rows.get(2), Arrays.asList("3", ""));
+        Assert.assertEquals(page.rows.get(3), Arrays.asList("4", "x,\"y\"\nz"));
+
+        // a page across the files
+        page = reader.read(dir.getAbsolutePath(), 1, 2);
+        Assert.assertEquals(page.rows.size(), 2);
+        Assert.assertEquals(page.rows.get(0).get(0), "2");
+        Assert.assertEquals(page.rows.get(1).get(0), "3");
+
+        page = reader.read(dir.getAbsolutePath(), 4, 2);
+        Assert.assertTrue(page.rows.isEmpty());
+        Assert.assertEquals(page.totalRows, 4);
+    }
+
+    @Test
+    public void testParquet() throws Exception {
+        File dir = Files.createTempDirectory("job_result").toFile();
+        MessageType schema = MessageTypeParser.parseMessageType(
+                "message spark_schema { optional int32 id; optional binary name (UTF8); }");
+        SimpleGroupFactory factory = new SimpleGroupFactory(schema);
+        int id = 0;
+        for (int file = 0; file < 3; file++) {
+            Path path = new Path(new File(dir, "part-0000" + file + ".parquet").getAbsolutePath());
+            try (ParquetWriter<Group> writer = ExampleParquetWriter.builder(path).withType(schema).build()) {
+                for (int i = 0; i < 5; i++, id++) {
+                    Group group = factory.newGroup().append("id", id);
+                    if (id % 2 == 0) {
+                        group.append("name", "n" + id);
+                    }
+                    writer.write(group);
+                }
+            }
+        }
+
+        JobResultReader.Page page = reader.read(dir.getAbsolutePath(), 3, 9);
+        Assert.assertEquals(page.columnNames, Arrays.asList("id", "name"));
+        Assert.assertEquals(page.totalRows, 15);
+        Assert.assertEquals(page.rows.size(), 9);
+        for (int i = 0; i < page.rows.size(); i++) {
+            List<String> row = page.rows.get(i);
+            int expect = i + 3;
+            Assert.assertEquals(row.get(0), String.valueOf(expect));
+            Assert.assertEquals(row.get(1), expect % 2 == 0 ? "n" + expect : null);
+        }
+    }
+}
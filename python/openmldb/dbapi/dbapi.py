@@ -20,6 +20,7 @@ from typing import Union
 from typing import List
 
 sys.path.append(os.path.dirname(__file__) + "/..")
+import datetime
 import logging
 from sdk import sdk as sdk_module
 from sdk.sdk import TypeUtil
@@ -34,6 +35,101 @@ paramstyle = 'qmark'
 threadsafety = 3
 
 
+_column_format = {
+    sql_router_sdk.kTypeInt16: 'h',
+    sql_router_sdk.kTypeInt32: 'i',
+    sql_router_sdk.kTypeInt64: 'q',
+    sql_router_sdk.kTypeFloat: 'f',
+    sql_router_sdk.kTypeDouble: 'd',
+    sql_router_sdk.kTypeDate: 'i',
+    sql_router_sdk.kTypeTimestamp: 'q'
+}
+
+_epoch = datetime.date(1970, 1, 1)
+
+
+def _decode_column(columnar, idx):
+    # the memoryviews refer to the buffers of columnar, they are decoded before it is released
+    row_cnt = columnar.GetRowCnt()
+    col_type = columnar.GetColumnType(idx)
+    validity = columnar.GetValidity(idx)
+    values = columnar.GetValues(idx)
+    if col_type == sql_router_sdk.kTypeBool:
+        result = [values[i >> 3] >> (i & 7) & 1 == 1 for i in range(row_cnt)]
+    elif col_type == sql_router_sdk.kTypeString:
+        offsets = columnar.GetOffsets(idx).cast('i')
+        data = values.tobytes()
+        result = [data[offsets[i]:offsets[i + 1]].decode('utf-8') for i in range(row_cnt)]
+    else:
+        result = values.cast(_column_format[col_type]).tolist()
+        if col_type == sql_router_sdk.kTypeDate:
+            result = [_epoch + datetime.timedelta(days=d) for d in result]
+    if columnar.GetNullCnt(idx) > 0:
+        result = [v if validity[i >> 3] >> (i & 7) & 1 else None for i, v in enumerate(result)]
+    return result
+
+
+_numpy_dtype = {
+    sql_router_sdk.kTypeInt16: '<i2',
+    sql_router_sdk.kTypeInt32: '<i4',
+    sql_router_sdk.kTypeInt64: '<i8',
+    sql_router_sdk.kTypeFloat: '<f4',
+    sql_router_sdk.kTypeDouble: '<f8',
+    sql_router_sdk.kTypeDate: '<i4',
+    sql_router_sdk.kTypeTimestamp: '<i8'
+}
+
+
+def _column_to_numpy(columnar, idx):
+    # the values are copied out of the buffers of columnar in one go, the columns with nulls are masked arrays
+    import numpy as np
+    row_cnt = columnar.GetRowCnt()
+    col_type = columnar.GetColumnType(idx)
+    values = columnar.GetValues(idx)
+    if col_type == sql_router_sdk.kTypeBool:
+        bits = np.unpackbits(np.frombuffer(values, dtype=np.uint8), bitorder='little')
+        result = bits[:row_cnt].astype(bool)
+    elif col_type == sql_router_sdk.kTypeString:
+        offsets = np.frombuffer(columnar.GetOffsets(idx), dtype='<i4')
+        data = values.tobytes()
+        result = np.empty(row_cnt, dtype=object)
+        for i in range(row_cnt):
+            result[i] = data[offsets[i]:offsets[i + 1]].decode('utf-8')
+    else:
+        result = np.frombuffer(values, dtype=_numpy_dtype[col_type]).copy()
+        if col_type == sql_router_sdk.kTypeDate:
+            result = result.astype('datetime64[D]')
+        elif col_type == sql_router_sdk.kTypeTimestamp:
+            result = result.view('datetime64[ms]')
+    if columnar.GetNullCnt(idx) > 0:
+        bits = np.unpackbits(np.frombuffer(columnar.GetValidity(idx), dtype=np.uint8), bitorder='little')
+        result = np.ma.masked_array(result, mask=bits[:row_cnt] == 0)
+    return result
+
+
+def _column_to_arrow(columnar, idx):
+    # the buffers of columnar are in the arrow layout already, they are copied without any conversion
+    import pyarrow as pa
+    arrow_type = {
+        sql_router_sdk.kTypeBool: pa.bool_(),
+        sql_router_sdk.kTypeInt16: pa.int16(),
+        sql_router_sdk.kTypeInt32: pa.int32(),
+        sql_router_sdk.kTypeInt64: pa.int64(),
+        sql_router_sdk.kTypeFloat: pa.float32(),
+        sql_router_sdk.kTypeDouble: pa.float64(),
+        sql_router_sdk.kTypeString: pa.string(),
+        sql_router_sdk.kTypeDate: pa.date32(),
+        sql_router_sdk.kTypeTimestamp: pa.timestamp('ms')
+    }
+    col_type = columnar.GetColumnType(idx)
+    null_cnt = columnar.GetNullCnt(idx)
+    buffers = [pa.py_buffer(columnar.GetValidity(idx).tobytes()) if null_cnt > 0 else None]
+    if col_type == sql_router_sdk.kTypeString:
+        buffers.append(pa.py_buffer(columnar.GetOffsets(idx).tobytes()))
+    buffers.append(pa.py_buffer(columnar.GetValues(idx).tobytes()))
+    return pa.Array.from_buffers(arrow_type[col_type], columnar.GetRowCnt(), buffers, null_count=null_cnt)
+
+
 class Type(object):
     Bool = sql_router_sdk.kTypeBool
     Int16 = sql_router_sdk.kTypeInt16
@@ -426,6 +522,66 @@ class Cursor(object):
     def fetchall(self):
         return self.fetchmany(size=self.rowcount)
 
+    def _build_columnar(self):
+        if self._resultSet is None: raise DatabaseError("query data failed")
+        status = sql_router_sdk.Status()
+        columnar = sql_router_sdk.ColumnarResultSet.Build(self._resultSet, status)
+        if status.code != 0:
+            raise DatabaseError("fetch columns fail {}".format(status.msg))
+        return columnar
+
+    @connected
+    def fetchcolumns(self):
+        """fetch all the rows as a dict of column name to the list of values.
+        Every column is read from one buffer, instead of one sdk call per cell."""
+        columnar = self._build_columnar()
+        return {columnar.GetColumnName(i): _decode_column(columnar, i) for i in range(columnar.GetColumnCnt())}
+
+    @connected
+    def fetchnumpy(self):
+        """fetch all the rows as a dict of column name to the numpy array of values, the columns with nulls
+        are masked arrays. No python object is made per cell but for the strings. Requires numpy."""
+        columnar = self._build_columnar()
+        return {columnar.GetColumnName(i): _column_to_numpy(columnar, i) for i in range(columnar.GetColumnCnt())}
+
+    @connected
+    def fetcharrow(self):
+        """fetch all the rows as a pyarrow RecordBatch. Requires pyarrow."""
+        import pyarrow as pa
+        columnar = self._build_columnar()
+        return pa.RecordBatch.from_arrays([_column_to_arrow(columnar, i) for i in range(columnar.GetColumnCnt())],
+                                          names=[columnar.GetColumnName(i) for i in range(columnar.GetColumnCnt())])
+
+    @connected
+    def callproc_batch(self, procname, df, common_cols=(), chunk_size=1000):
+        """call the deployment with the rows of the pandas DataFrame df as request rows, chunk_size rows in one
+        batch request, and return the results of all the rows as a pandas DataFrame. Requires pandas."""
+        import pandas as pd
+        if chunk_size <= 0:
+            raise Exception("Given chunk_size should greater than zero")
+        ok, request_row = self.connection._sdk.getRowBySp(self.db, procname)
+        if not ok:
+            raise DatabaseError("get request row fail {}".format(request_row))
+        schema = request_row.GetSchema()
+        names = [schema.GetColumnName(i) for i in range(schema.GetColumnCnt())]
+        missing = [name for name in names if name not in df.columns]
+        if missing:
+            raise DatabaseError("columns {} not given".format(missing))
+        # the cells are appended as python objects, the missing values as None
+        rows = df[names].astype(object)
+        rows = rows.where(rows.notna(), None)
+        results = []
+        for start in range(0, len(rows), chunk_size):
+            chunk = list(rows.iloc[start:start + chunk_size].itertuples(index=False, name=None))
+            ok, rs = self.connection._sdk.doBatchProc(self.db, procname, common_cols, chunk, request_row)
+            if not ok:
+                raise DatabaseError("execute select fail {}".format(rs))
+            self._pre_process_result(rs)
+            results.append(pd.DataFrame(self.fetchnumpy()))
+        if not results:
+            return pd.DataFrame()
+        return pd.concat(results, ignore_index=True)
+
     @staticmethod
     def substitute_in_query(string_query, parameters):
         query = string_query
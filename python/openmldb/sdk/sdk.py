@@ -348,6 +348,8 @@ class OpenMLDBSdk(object):
             if colType != sql_router_sdk.kTypeString:
                 continue
             val = data[i]
+            if val is None:
+                continue
             if isinstance(val, str):
                 strSize += len(val)
             else:
@@ -472,6 +474,35 @@ class OpenMLDBSdk(object):
             return False, status.msg
         return True, rs
 
+    def doBatchProc(self, db, sp, commonCol, rows, requestRow=None):
+        # one request row is rebuilt for every row, the batch keeps a copy of each
+        if requestRow is None:
+            ok, requestRow = self.getRowBySp(db, sp)
+            if not ok:
+                return ok, requestRow
+        schema = requestRow.GetSchema()
+        commonCols = sql_router_sdk.ColumnIndicesSet(schema)
+        commnColAddCount = 0
+        for i in range(schema.GetColumnCnt()):
+            if schema.GetColumnName(i) in commonCol:
+                commonCols.AddCommonColumnIdx(i)
+                commnColAddCount += 1
+        if commnColAddCount != len(commonCol):
+            return False, "some common col is not in table schema"
+        requestRowBatch = sql_router_sdk.SQLRequestRowBatch(schema, commonCols)
+        if requestRowBatch is None:
+            return False, "generate sql request row batch fail"
+        for row in rows:
+            ok, msg = self._append_request_row(requestRow, schema, row)
+            if not ok:
+                return ok, msg
+            requestRowBatch.AddRow(requestRow)
+        status = sql_router_sdk.Status()
+        rs = self.sdk.CallSQLBatchRequestProcedure(db, sp, requestRowBatch, status)
+        if status.code != 0:
+            return False, status.msg
+        return True, rs
+
     def getJobLog(self, id):
         if not self.sdk:
             return False, "please init sdk first"
@@ -442,6 +442,95 @@ class TestSQLMagicOpenMLDB:
             assert False
             
         assert "magic_table" not in self.db.cursor().get_all_tables()
-            
+
+
+class TestOpenmldbDBAPIColumnar:
+
+    def setup_class(self):
+        self.db = openmldb.dbapi.connect('db_test', '127.0.0.1:6181', '/onebox')
+        self.cursor = self.db.cursor()
+        try:
+            self.cursor.execute("drop procedure sp_columnar;")
+        except Exception as e:
+            pass
+        try:
+            self.cursor.execute("drop table columnar_table;")
+        except Exception as e:
+            pass
+        self.cursor.execute("create table columnar_table (id int, val bigint, name string, ts timestamp, "
+                            "index(key=name, ts=ts)) OPTIONS(partitionnum=1);")
+        self.cursor.execute("insert into columnar_table values(1, 10, 'a', 1000);")
+        self.cursor.execute("insert into columnar_table values(2, null, 'b', 2000);")
+        self.cursor.execute("insert into columnar_table values(3, 30, 'c', 3000);")
+        self.cursor.execute("create procedure sp_columnar (id int, val bigint, name string, ts timestamp) "
+                            "begin select id, val + 1 as val_add, name from columnar_table; end;")
+
+    def test_fetchnumpy(self):
+        np = pytest.importorskip("numpy")
+        columns = self.cursor.execute("select id, val, name from columnar_table;").fetchnumpy()
+        order = np.argsort(columns["id"])
+        assert list(columns["id"][order]) == [1, 2, 3]
+        assert columns["id"].dtype == np.int32
+        assert list(columns["name"][order]) == ['a', 'b', 'c']
+        # the column with a null is masked
+        val = columns["val"][order]
+        assert isinstance(val, np.ma.MaskedArray)
+        assert list(val.mask) == [False, True, False]
+        assert val[0] == 10 and val[2] == 30
+
+    def test_fetcharrow(self):
+        pa = pytest.importorskip("pyarrow")
+        batch = self.cursor.execute("select id, val, name from columnar_table;").fetcharrow()
+        assert batch.num_rows == 3
+        assert batch.schema.names == ['id', 'val', 'name']
+        assert batch.schema.field('id').type == pa.int32()
+        assert batch.schema.field('val').type == pa.int64()
+        assert batch.schema.field('name').type == pa.string()
+        rows = sorted(zip(*[batch.column(i).to_pylist() for i in range(batch.num_columns)]))
+        assert rows == [(1, 10, 'a'), (2, None, 'b'), (3, 30, 'c')]
+
+    def test_callproc_batch(self):
+        pd = pytest.importorskip("pandas")
+        df = pd.DataFrame({"id": [4, 5, 6], "val": [40, None, 60], "name": ["d", None, "f"],
+                           "ts": [4000, 5000, 6000]})
+        # chunk_size 2 splits the rows into two batch requests
+        result = self.cursor.callproc_batch("sp_columnar", df, chunk_size=2)
+        assert len(result) == 3
+        assert list(result.columns) == ['id', 'val_add', 'name']
+        result = result.sort_values("id").reset_index(drop=True)
+        assert list(result["id"]) == [4, 5, 6]
+        assert result["val_add"][0] == 41 and result["val_add"][2] == 61
+        assert pd.isna(result["val_add"][1])
+        assert result["name"][0] == 'd' and result["name"][2] == 'f'
+        with pytest.raises(Exception):
+            self.cursor.callproc_batch("sp_columnar", df, chunk_size=0)
+        with pytest.raises(Exception):
+            self.cursor.callproc_batch("sp_columnar", df[["id", "val"]])
+
+    def test_doBatchProc(self):
+        sdk = self.db._sdk
+        rows = [(7, 70, 'g', 7000), (8, 80, 'h', 8000)]
+        ok, rs = sdk.doBatchProc('db_test', 'sp_columnar', (), rows)
+        assert ok
+        assert rs.Size() == 2
+        ids = []
+        while rs.Next():
+            ids.append(rs.GetInt32Unsafe(0))
+        assert sorted(ids) == [7, 8]
+        # the request row fetched by the caller is reused for every row
+        ok, request_row = sdk.getRowBySp('db_test', 'sp_columnar')
+        assert ok
+        ok, rs = sdk.doBatchProc('db_test', 'sp_columnar', ('name',), [(9, 90, 'i', 9000), (10, 100, 'i', 9001)],
+                                 request_row)
+        assert ok
+        assert rs.Size() == 2
+        ok, msg = sdk.doBatchProc('db_test', 'sp_columnar', ('unknown',), rows)
+        assert not ok
+
+    def teardown_class(self):
+        self.cursor.execute("drop procedure sp_columnar;")
+        self.cursor.execute("drop table columnar_table;")
+        self.cursor.close()
+
 if __name__ == '__main__':
     unittest.main()
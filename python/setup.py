@@ -33,6 +33,11 @@ setup(
         "prettytable",
         "pytest"
     ],
+    extras_require={
+        "numpy": ["numpy"],
+        "arrow": ["pyarrow"],
+        "pandas": ["pandas", "numpy"],
+    },
     include_package_data=True,
     package_data = {'':['*.so']},
     packages=find_packages(),
@@ -16,12 +16,19 @@
 
 #include "apiserver/api_server_impl.h"
 
+#include <future>  // NOLINT
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "apiserver/interface_provider.h"
 #include "brpc/server.h"
+#include "bthread/countdown_event.h"
+#include "gflags/gflags.h"
+
+DECLARE_uint32(apiserver_batch_window_ms);
+DECLARE_uint32(apiserver_batch_max_rows);
 
 namespace openmldb {
 namespace apiserver {
@@ -49,6 +56,7 @@ bool APIServerImpl::Init(::openmldb::sdk::DBSDK* cluster) {
     }
     sql_router_ = std::move(router);
     RegisterPut();
+    RegisterBatchPut();
     RegisterExecSP();
     RegisterExecDeployment();
     RegisterGetSP();
@@ -80,7 +88,7 @@ void APIServerImpl::Process(google::protobuf::RpcController* cntl_base, const Ht
     JsonWriter writer;
     provider_.handle(unresolved_path, method, req_body, writer);
 
-    cntl->response_attachment().append(writer.GetString());
+    cntl->response_attachment().append(writer.GetString(), writer.GetSize());
 }
 
 bool APIServerImpl::Json2SQLRequestRow(const butil::rapidjson::Value& non_common_cols_v,
@@ -244,30 +252,12 @@ void APIServerImpl::RegisterPut() {
             writer << err.Set(status.msg);
             return;
         }
-        auto schema = row->GetSchema();
-        auto cnt = schema->GetColumnCnt();
-        if (cnt != static_cast<int>(arr.Size())) {
-            writer << err.Set("column size != schema size");
+        std::string msg;
+        if (!Json2SQLInsertRow(arr, row, &msg)) {
+            writer << err.Set(msg);
             return;
         }
 
-        // scan all strings , calc the sum, to init SQLInsertRow's string length
-        decltype(arr.Size()) str_len_sum = 0;
-        for (int i = 0; i < cnt; ++i) {
-            // if null, GetStringLength() will get 0
-            if (schema->GetColumnType(i) == hybridse::sdk::kTypeString) {
-                str_len_sum += arr[i].GetStringLength();
-            }
-        }
-        row->Init(static_cast<int>(str_len_sum));
-
-        for (int i = 0; i < cnt; ++i) {
-            if (!AppendJsonValue(arr[i], schema->GetColumnType(i), schema->IsColumnNotNull(i), row)) {
-                writer << err.Set("Translate to insert row failed");
-                return;
-            }
-        }
-
         auto ok = sql_router_->ExecuteInsert(db, insert_placeholder, row, &status);
         if (ok) {
             PutResp resp;
@@ -278,6 +268,122 @@ void APIServerImpl::RegisterPut() {
     });
 }
 
+bool APIServerImpl::Json2SQLInsertRow(const butil::rapidjson::Value& arr,
+                                      std::shared_ptr<openmldb::sdk::SQLInsertRow> row, std::string* msg) {
+    auto schema = row->GetSchema();
+    auto cnt = schema->GetColumnCnt();
+    if (!arr.IsArray() || cnt != static_cast<int>(arr.Size())) {
+        *msg = "column size != schema size";
+        return false;
+    }
+
+    // scan all strings , calc the sum, to init SQLInsertRow's string length
+    decltype(arr.Size()) str_len_sum = 0;
+    for (int i = 0; i < cnt; ++i) {
+        // if null, GetStringLength() will get 0
+        if (schema->GetColumnType(i) == hybridse::sdk::kTypeString) {
+            str_len_sum += arr[i].GetStringLength();
+        }
+    }
+    row->Init(static_cast<int>(str_len_sum));
+
+    for (int i = 0; i < cnt; ++i) {
+        if (!AppendJsonValue(arr[i], schema->GetColumnType(i), schema->IsColumnNotNull(i), row)) {
+            *msg = "Translate to insert row failed";
+            return false;
+        }
+    }
+    return true;
+}
+
+void APIServerImpl::RegisterBatchPut() {
+    // the body is json lines, every line is the json array of one row. It can be uploaded with chunked
+    // encoding, the rows are written by the async inserter in batches of the tablets
+    provider_.put("/dbs/:db_name/tables/:table_name/batch", [this](const InterfaceProvider::Params& param,
+                                                                   const butil::IOBuf& req_body,
+                                                                   JsonWriter& writer) {
+        auto err = GeneralError();
+        auto db_it = param.find("db_name");
+        auto table_it = param.find("table_name");
+        if (db_it == param.end() || table_it == param.end()) {
+            writer << err.Set("Invalid path");
+            return;
+        }
+        const auto& db = db_it->second;
+        const auto& table = table_it->second;
+        auto table_info = cluster_sdk_->GetTableInfo(db, table);
+        if (!table_info) {
+            writer << err.Set("Table not found");
+            return;
+        }
+        std::string holders;
+        for (int i = 0; i < table_info->column_desc_size(); ++i) {
+            holders += ((i == 0) ? "?" : ",?");
+        }
+        std::string insert_placeholder = "insert into " + table + " values(" + holders + ");";
+        auto router = std::dynamic_pointer_cast<::openmldb::sdk::SQLClusterRouter>(sql_router_);
+        hybridse::sdk::Status status;
+        if (!router) {
+            writer << err.Set("Batch put is not supported by the router");
+            return;
+        }
+        auto inserter = router->CreateAsyncInserter(db, insert_placeholder, sdk::AsyncInsertOptions(), &status);
+        if (!inserter) {
+            writer << err.Set(status.msg);
+            return;
+        }
+
+        std::vector<std::future<hybridse::sdk::Status>> futures;
+        std::string body = req_body.to_string();
+        size_t pos = 0;
+        size_t line_no = 0;
+        std::string msg;
+        while (pos < body.size()) {
+            size_t end = body.find('\n', pos);
+            if (end == std::string::npos) {
+                end = body.size();
+            }
+            std::string line = body.substr(pos, end - pos);
+            pos = end + 1;
+            line_no++;
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+            Document document;
+            if (document.Parse(line.c_str()).HasParseError()) {
+                msg = "Json parse failed at line " + std::to_string(line_no) +
+                      ", error code: " + std::to_string(document.GetParseError());
+                break;
+            }
+            auto row = sql_router_->GetInsertRow(db, insert_placeholder, &status);
+            if (!row) {
+                msg = status.msg;
+                break;
+            }
+            if (!Json2SQLInsertRow(document, row, &msg)) {
+                msg += " at line " + std::to_string(line_no);
+                break;
+            }
+            futures.push_back(inserter->Insert(row));
+        }
+        inserter->WaitAll();
+        BatchPutResp resp;
+        for (auto& future : futures) {
+            auto put_status = future.get();
+            if (put_status.IsOK()) {
+                resp.count++;
+            } else if (msg.empty()) {
+                msg = put_status.msg;
+            }
+        }
+        if (!msg.empty()) {
+            resp.code = -1;
+            resp.msg = msg;
+        }
+        writer << resp;
+    });
+}
+
 void APIServerImpl::RegisterExecDeployment() {
     provider_.post("/dbs/:db_name/deployments/:sp_name", std::bind(&APIServerImpl::ExecuteProcedure, this,
                 false, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
@@ -300,8 +406,11 @@ void APIServerImpl::ExecuteProcedure(bool has_common_col, const InterfaceProvide
     auto db = db_it->second;
     auto sp = sp_it->second;
 
+    // parse in situ, the string values refer to `json` instead of being copied into the document, so `json`
+    // must outlive the request rows
+    std::string json = req_body.to_string();
     Document document;
-    if (document.Parse(req_body.to_string().c_str()).HasParseError()) {
+    if (document.ParseInsitu(&json[0]).HasParseError()) {
         writer << err.Set("Json parse failed");
         return;
     }
@@ -357,6 +466,34 @@ void APIServerImpl::ExecuteProcedure(bool has_common_col, const InterfaceProvide
     }
     auto expected_input_size = input_schema->GetColumnCnt() - expected_common_size;
 
+    if (rows.Size() == 1 && common_column_indices->Empty()) {
+        auto caller = GetProcedureCaller(db, sp, sp_info);
+        if (caller) {
+            if (!rows[0].IsArray() || rows[0].Size() != expected_input_size) {
+                writer << err.Set("Invalid input data row");
+                return;
+            }
+            auto row = std::make_shared<sdk::SQLRequestRow>(input_schema, std::set<std::string>());
+            if (!Json2SQLRequestRow(rows[0], common_cols_v, row)) {
+                writer << err.Set("Translate to request row failed");
+                return;
+            }
+            row->Build();
+            auto rs = CallInBatch(caller, row, &status);
+            if (!rs) {
+                writer << err.Set(status.msg);
+                return;
+            }
+            ExecSPResp resp;
+            resp.sp_info = sp_info;
+            resp.need_schema = document.HasMember("need_schema") && document["need_schema"].IsBool() &&
+                               document["need_schema"].GetBool();
+            resp.rs = rs;
+            writer << resp;
+            return;
+        }
+    }
+
     // TODO(hw): SQLRequestRowBatch should add common & non-common cols directly
     auto row_batch = std::make_shared<sdk::SQLRequestRowBatch>(input_schema, common_column_indices);
     std::set<std::string> col_set;
@@ -394,6 +531,50 @@ void APIServerImpl::ExecuteProcedure(bool has_common_col, const InterfaceProvide
     writer << resp;
 }
 
+std::shared_ptr<sdk::AsyncProcedureCaller> APIServerImpl::GetProcedureCaller(
+    const std::string& db, const std::string& sp, const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info) {
+    if (FLAGS_apiserver_batch_window_ms == 0 || FLAGS_apiserver_batch_max_rows <= 1) {
+        return {};
+    }
+    std::string key = db + "." + sp;
+    std::lock_guard<std::mutex> lock(callers_mu_);
+    auto it = callers_.find(key);
+    if (it != callers_.end() && it->second.first == sp_info) {
+        return it->second.second;
+    }
+    auto router = std::dynamic_pointer_cast<::openmldb::sdk::SQLClusterRouter>(sql_router_);
+    if (!router) {
+        return {};
+    }
+    sdk::AsyncCallOptions options;
+    options.max_batch_rows = FLAGS_apiserver_batch_max_rows;
+    options.flush_interval_ms = FLAGS_apiserver_batch_window_ms;
+    hybridse::sdk::Status status;
+    auto caller = router->CreateAsyncProcedureCaller(db, sp, options, &status);
+    if (!caller) {
+        LOG(WARNING) << "fail to create the caller of " << key << ", " << status.msg;
+        return {};
+    }
+    // the caller of the stale procedure info is released once its calls are done
+    callers_[key] = std::make_pair(sp_info, caller);
+    return caller;
+}
+
+std::shared_ptr<hybridse::sdk::ResultSet> APIServerImpl::CallInBatch(
+    const std::shared_ptr<sdk::AsyncProcedureCaller>& caller, const std::shared_ptr<sdk::SQLRequestRow>& row,
+    hybridse::sdk::Status* status) {
+    // the handler runs in a bthread, so wait without blocking the worker pthread which may run the callback
+    bthread::CountdownEvent event(1);
+    std::shared_ptr<hybridse::sdk::ResultSet> result;
+    caller->Call(row, [&](const hybridse::sdk::Status& call_status, std::shared_ptr<hybridse::sdk::ResultSet> rs) {
+        *status = call_status;
+        result = rs;
+        event.signal();
+    });
+    event.wait();
+    return result;
+}
+
 void APIServerImpl::RegisterGetSP() {
     provider_.get("/dbs/:db_name/procedures/:sp_name",
                   [this](const InterfaceProvider::Params& param, const butil::IOBuf& req_body, JsonWriter& writer) {
@@ -637,10 +818,10 @@ void WriteValue(JsonWriter& ar, std::shared_ptr<hybridse::sdk::ResultSet> rs, in
             int32_t year = 0;
             int32_t month = 0;
             int32_t day = 0;
-            std::stringstream ss;
             rs->GetDate(i, &year, &month, &day);
-            ss << year << "-" << month << "-" << day;
-            ar& ss.str();
+            char buf[32];
+            int len = snprintf(buf, sizeof(buf), "%d-%d-%d", year, month, day);
+            ar.String(buf, len);
             break;
         }
         case hybridse::sdk::kTypeBool: {
@@ -18,7 +18,9 @@
 #define SRC_APISERVER_API_SERVER_IMPL_H_
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,6 +29,7 @@
 #include "apiserver/json_helper.h"
 #include "json2pb/rapidjson.h"  // rapidjson's DOM-style API
 #include "proto/api_server.pb.h"
+#include "sdk/async_procedure_caller.h"
 #include "sdk/sql_cluster_router.h"
 
 namespace openmldb {
@@ -56,6 +59,7 @@ class APIServerImpl : public APIServer {
 
  private:
     void RegisterPut();
+    void RegisterBatchPut();
     void RegisterExecSP();
     void RegisterExecDeployment();
     void RegisterGetSP();
@@ -69,6 +73,16 @@ class APIServerImpl : public APIServer {
     static bool Json2SQLRequestRow(const butil::rapidjson::Value& non_common_cols_v,
                                    const butil::rapidjson::Value& common_cols_v,
                                    std::shared_ptr<openmldb::sdk::SQLRequestRow> row);
+    static bool Json2SQLInsertRow(const butil::rapidjson::Value& arr, std::shared_ptr<openmldb::sdk::SQLInsertRow> row,
+                                  std::string* msg);
+    // the caller merging the single row calls of the deployment, null if the calls are not merged
+    std::shared_ptr<sdk::AsyncProcedureCaller> GetProcedureCaller(
+        const std::string& db, const std::string& sp, const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info);
+    // call the deployment with one row by `caller`, block until the merged batch request is answered
+    static std::shared_ptr<hybridse::sdk::ResultSet> CallInBatch(
+        const std::shared_ptr<sdk::AsyncProcedureCaller>& caller, const std::shared_ptr<sdk::SQLRequestRow>& row,
+        hybridse::sdk::Status* status);
+
     template <typename T>
     static bool AppendJsonValue(const butil::rapidjson::Value& v, hybridse::sdk::DataType type, bool is_not_null,
                                 T row);
@@ -78,6 +92,11 @@ class APIServerImpl : public APIServer {
     InterfaceProvider provider_;
     // cluster_sdk_ is not owned by this class.
     ::openmldb::sdk::DBSDK* cluster_sdk_ = nullptr;
+    std::mutex callers_mu_;
+    // db.sp -> the caller of the deployment, it's rebuilt once the procedure info is refreshed
+    std::map<std::string, std::pair<std::shared_ptr<hybridse::sdk::ProcedureInfo>,
+                                    std::shared_ptr<sdk::AsyncProcedureCaller>>>
+        callers_;
 };
 
 struct PutResp {
@@ -94,6 +113,23 @@ Archiver& operator&(Archiver& ar, PutResp& s) {  // NOLINT
     return ar.EndObject();
 }
 
+struct BatchPutResp {
+    BatchPutResp() = default;
+    int code = 0;
+    std::string msg = "ok";
+    // the count of the rows put
+    int64_t count = 0;
+};
+
+template <typename Archiver>
+Archiver& operator&(Archiver& ar, BatchPutResp& s) {  // NOLINT
+    ar.StartObject();
+    ar.Member("code") & s.code;
+    ar.Member("msg") & s.msg;
+    ar.Member("count") & s.count;
+    return ar.EndObject();
+}
+
 struct ExecSPResp {
     ExecSPResp() = default;
     int code = 0;
@@ -14,6 +14,10 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
 #include "apiserver/api_server_impl.h"
 #include "brpc/channel.h"
 #include "memory"
@@ -25,6 +29,8 @@
 #include "json2pb/rapidjson.h"
 #include "sdk/mini_cluster.h"
 
+DECLARE_uint32(apiserver_batch_window_ms);
+
 
 namespace openmldb::apiserver {
 
@@ -260,6 +266,60 @@ TEST_F(APIServerTest, validPut) {
     ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, "drop table " + table + ";", &status)) << status.msg;
 }
 
+TEST_F(APIServerTest, batchPut) {
+    const auto env = APIServerTestEnv::Instance();
+
+    std::string table = "batch_put";
+    std::string ddl = "create table if not exists " + table +
+                      "(c1 string, "
+                      "c3 int, "
+                      "c7 timestamp, "
+                      "index(key=(c1), ts=c7));";
+    hybridse::sdk::Status status;
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, ddl, &status)) << status.msg;
+    ASSERT_TRUE(env->cluster_sdk->Refresh());
+
+    int insert_cnt = 100;
+    std::string body;
+    for (int i = 0; i < insert_cnt; i++) {
+        body += "[\"k" + std::to_string(i % 10) + "\", " + std::to_string(i) + ", " + std::to_string(1000 + i) +
+                "]\n";
+    }
+    {
+        brpc::Controller cntl;
+        cntl.http_request().set_method(brpc::HTTP_METHOD_PUT);
+        cntl.http_request().uri() = "http://127.0.0.1:8010/dbs/" + env->db + "/tables/" + table + "/batch";
+        cntl.request_attachment().append(body);
+        env->http_channel.CallMethod(NULL, &cntl, NULL, NULL, NULL);
+        ASSERT_FALSE(cntl.Failed()) << cntl.ErrorText();
+        BatchPutResp resp;
+        JsonReader reader(cntl.response_attachment().to_string().c_str());
+        reader >> resp;
+        ASSERT_EQ(0, resp.code) << resp.msg;
+        ASSERT_EQ(insert_cnt, resp.count);
+    }
+    auto rs = env->cluster_remote->ExecuteSQL(env->db, "select * from " + table + ";", &status);
+    ASSERT_TRUE(rs) << "fail to execute sql";
+    ASSERT_EQ(insert_cnt, rs->Size());
+
+    // the rows before the invalid line are put
+    {
+        brpc::Controller cntl;
+        cntl.http_request().set_method(brpc::HTTP_METHOD_PUT);
+        cntl.http_request().uri() = "http://127.0.0.1:8010/dbs/" + env->db + "/tables/" + table + "/batch";
+        cntl.request_attachment().append("[\"k0\", 1, 2000]\n[\"k1\", 1]\n[\"k2\", 1, 2001]\n");
+        env->http_channel.CallMethod(NULL, &cntl, NULL, NULL, NULL);
+        ASSERT_FALSE(cntl.Failed()) << cntl.ErrorText();
+        BatchPutResp resp;
+        JsonReader reader(cntl.response_attachment().to_string().c_str());
+        reader >> resp;
+        ASSERT_EQ(-1, resp.code);
+        ASSERT_EQ(1, resp.count);
+        LOG(INFO) << resp.msg;
+    }
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, "drop table " + table + ";", &status)) << status.msg;
+}
+
 TEST_F(APIServerTest, putCase1) {
     const auto env = APIServerTestEnv::Instance();
 
@@ -567,6 +627,110 @@ TEST_F(APIServerTest, no_common) {
     ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, "drop table trans;", &status));
 }
 
+TEST_F(APIServerTest, procedureEscapedStringAndDate) {
+    const auto env = APIServerTestEnv::Instance();
+
+    std::string ddl = "create table trans(c1 string, c7 timestamp, c8 date, index(key=c1, ts=c7));";
+    hybridse::sdk::Status status;
+    env->cluster_remote->ExecuteDDL(env->db, "drop table trans;", &status);
+    ASSERT_TRUE(env->cluster_sdk->Refresh());
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, ddl, &status)) << "fail to create table";
+    ASSERT_TRUE(env->cluster_sdk->Refresh());
+    std::string sp_name = "sp";
+    std::string sql =
+        "SELECT c1, c8, count(c1) OVER w1 as w1_c1_cnt FROM trans WINDOW w1 AS"
+        " (PARTITION BY trans.c1 ORDER BY trans.c7 ROWS BETWEEN 2 PRECEDING AND CURRENT ROW);";
+    std::string sp_ddl = "create procedure " + sp_name + " (c1 string, c7 timestamp, c8 date) begin " + sql + " end;";
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, sp_ddl, &status)) << "fail to create procedure";
+    ASSERT_TRUE(env->cluster_sdk->Refresh());
+
+    // the escaped strings are decoded in the request buffer, the long one checks the whole response is sent
+    std::string long_key(1000, 'k');
+    brpc::Controller cntl;
+    cntl.http_request().set_method(brpc::HTTP_METHOD_POST);
+    cntl.http_request().uri() = "http://127.0.0.1:8010/dbs/" + env->db + "/deployments/" + sp_name;
+    cntl.request_attachment().append(R"({
+        "input": [["a\"b\\cA", 1590738994000, "2021-08-01"],
+                  [")" + long_key + R"(", 1590738994000, "2021-12-31"]],
+        "need_schema": false
+    })");
+    env->http_channel.CallMethod(NULL, &cntl, NULL, NULL, NULL);
+    ASSERT_FALSE(cntl.Failed()) << cntl.ErrorText();
+    LOG(INFO) << "exec procedure resp:\n" << cntl.response_attachment().to_string();
+
+    butil::rapidjson::Document document;
+    if (document.Parse(cntl.response_attachment().to_string().c_str()).HasParseError()) {
+        ASSERT_TRUE(false) << "response parse failed with code " << document.GetParseError()
+                           << ", raw resp: " << cntl.response_attachment().to_string();
+    }
+    ASSERT_EQ(0, document["code"].GetInt());
+    ASSERT_STREQ("ok", document["msg"].GetString());
+    const auto& data = document["data"]["data"];
+    ASSERT_EQ(2, data.Size());
+    ASSERT_STREQ("a\"b\\cA", data[0][0].GetString());
+    ASSERT_STREQ("2021-8-1", data[0][1].GetString());
+    ASSERT_EQ(1, data[0][2].GetInt64());
+    ASSERT_EQ(long_key, data[1][0].GetString());
+    ASSERT_STREQ("2021-12-31", data[1][1].GetString());
+
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, "drop procedure " + sp_name + ";", &status));
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, "drop table trans;", &status));
+}
+
+TEST_F(APIServerTest, batchCall) {
+    const auto env = APIServerTestEnv::Instance();
+    FLAGS_apiserver_batch_window_ms = 1;
+
+    std::string ddl = "create table trans_batch_call(c1 string, c3 int, c4 bigint, c7 timestamp, "
+                      "index(key=c1, ts=c7));";
+    hybridse::sdk::Status status;
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, ddl, &status)) << status.msg;
+    ASSERT_TRUE(env->cluster_sdk->Refresh());
+    std::string sp_name = "sp_batch_call";
+    std::string sp_ddl = "create procedure " + sp_name +
+                         " (c1 string, c3 int, c4 bigint, c7 timestamp) begin"
+                         " SELECT c1, c3, sum(c4) OVER w1 as w1_c4_sum FROM trans_batch_call WINDOW w1 AS"
+                         " (PARTITION BY trans_batch_call.c1 ORDER BY trans_batch_call.c7"
+                         " ROWS BETWEEN 2 PRECEDING AND CURRENT ROW); end;";
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, sp_ddl, &status)) << status.msg;
+    ASSERT_TRUE(env->cluster_sdk->Refresh());
+
+    // the concurrent single row calls are merged, every caller gets its own row
+    int thread_num = 8;
+    std::vector<std::thread> threads;
+    std::atomic<int> ok_cnt(0);
+    for (int t = 0; t < thread_num; t++) {
+        threads.emplace_back([&, t] {
+            brpc::Controller cntl;
+            cntl.http_request().set_method(brpc::HTTP_METHOD_POST);
+            cntl.http_request().uri() = "http://127.0.0.1:8010/dbs/" + env->db + "/deployments/" + sp_name;
+            cntl.request_attachment().append("{\"input\": [[\"k" + std::to_string(t) + "\", " + std::to_string(t) +
+                                             ", " + std::to_string(t * 10) + ", 1590738994000]]}");
+            env->http_channel.CallMethod(NULL, &cntl, NULL, NULL, NULL);
+            if (cntl.Failed()) {
+                return;
+            }
+            butil::rapidjson::Document document;
+            if (document.Parse(cntl.response_attachment().to_string().c_str()).HasParseError() ||
+                document["code"].GetInt() != 0 || document["data"]["data"].Size() != 1) {
+                return;
+            }
+            const auto& row = document["data"]["data"][0];
+            if (row[1].GetInt() == t && row[2].GetInt64() == t * 10) {
+                ok_cnt++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(thread_num, ok_cnt.load());
+
+    FLAGS_apiserver_batch_window_ms = 0;
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, "drop procedure " + sp_name + ";", &status));
+    ASSERT_TRUE(env->cluster_remote->ExecuteDDL(env->db, "drop table trans_batch_call;", &status));
+}
+
 TEST_F(APIServerTest, no_common_not_first_string) {
     const auto env = APIServerTestEnv::Instance();
 
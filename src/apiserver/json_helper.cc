@@ -252,6 +252,8 @@ JsonWriter::~JsonWriter() {
 
 const char* JsonWriter::GetString() const { return STREAM->GetString(); }
 
+size_t JsonWriter::GetSize() const { return STREAM->GetSize(); }
+
 JsonWriter& JsonWriter::StartObject() {
     WRITER->StartObject();
     return *this;
@@ -318,6 +320,11 @@ JsonWriter& JsonWriter::operator&(const std::string& s) {
     return *this;
 }
 
+JsonWriter& JsonWriter::String(const char* s, size_t len) {
+    WRITER->String(s, static_cast<SizeType>(len));
+    return *this;
+}
+
 JsonWriter& JsonWriter::SetNull() {
     WRITER->Null();
     return *this;
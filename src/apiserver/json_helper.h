@@ -94,6 +94,8 @@ class JsonWriter {
 
     /// Obtains the serialized JSON string.
     const char* GetString() const;
+    /// The length of the serialized JSON string.
+    size_t GetSize() const;
 
     // Archive concept
 
@@ -114,6 +116,7 @@ class JsonWriter {
     JsonWriter& operator&(uint64_t i);
     JsonWriter& operator&(const double& d);
     JsonWriter& operator&(const std::string& s);
+    JsonWriter& String(const char* s, size_t len);
     JsonWriter& SetNull();
 
     static const bool IsReader = false;
@@ -21,9 +21,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <deque>
+#include <memory>
 #include <string>
 
 #include "base/slice.h"
+#include "butil/iobuf.h"
 #include "proto/tablet.pb.h"
 
 namespace openmldb {
@@ -99,6 +102,29 @@ class KvIterator {
         Next();
     }
 
+    // the pairs are in the attachment instead of the response. The values refer to the blocks of the attachment
+    // rather than a flattened copy of it, only the ones split across the blocks are copied
+    KvIterator(::openmldb::api::TraverseResponse* response, butil::IOBuf* attachment, bool clean)
+        : response_(response),
+          buffer_(NULL),
+          is_finish_(response->is_finish()),
+          tsize_(0),
+          offset_(0),
+          c_size_(0),
+          tmp_(NULL),
+          last_pk_(response->pk()),
+          last_ts_(response->ts()),
+          has_pk_(true),
+          auto_clean_(clean),
+          attachment_(std::make_shared<butil::IOBuf>()),
+          split_values_(std::make_shared<std::deque<std::string>>()) {
+        attachment_->swap(*attachment);
+        rest_ = *attachment_;
+        tsize_ = attachment_->size();
+        tmp_ = new Slice();
+        Next();
+    }
+
     ~KvIterator() {
         if (auto_clean_) {
             delete response_;
@@ -123,7 +149,9 @@ class KvIterator {
     }
 
     void Next() {
-        if (has_pk_) {
+        if (attachment_) {
+            NextFromAttachment();
+        } else if (has_pk_) {
             if (offset_ + 8 > tsize_) {
                 offset_ += 8;
                 return;
@@ -171,7 +199,41 @@ class KvIterator {
 
     ::google::protobuf::Message* GetResponse() const { return response_; }
 
+    // take the response of the iterator not cleaning it. The attachment is kept with the response, so the values
+    // stay valid as long as the response rather than the iterator
+    std::shared_ptr<::google::protobuf::Message> ShareResponse() const {
+        auto attachment = attachment_;
+        auto split_values = split_values_;
+        return std::shared_ptr<::google::protobuf::Message>(
+            response_, [attachment, split_values](::google::protobuf::Message* response) { delete response; });
+    }
+
  private:
+    void NextFromAttachment() {
+        if (offset_ + 8 > tsize_) {
+            offset_ += 8;
+            return;
+        }
+        uint32_t total_size = 0;
+        rest_.cutn(&total_size, 4);
+        uint32_t pk_size = 0;
+        rest_.cutn(&pk_size, 4);
+        rest_.cutn(&time_, 8);
+        pk_.clear();
+        rest_.cutn(&pk_, pk_size);
+        uint32_t value_size = total_size - pk_size - 8;
+        butil::StringPiece block = rest_.backing_block(0);
+        if (block.size() >= value_size) {
+            tmp_->reset(block.data(), value_size);
+            rest_.pop_front(value_size);
+        } else {
+            split_values_->emplace_back();
+            rest_.cutn(&split_values_->back(), value_size);
+            tmp_->reset(split_values_->back().data(), value_size);
+        }
+        offset_ += (8 + total_size);
+    }
+
     ::google::protobuf::Message* response_;
     char* buffer_;
     bool is_finish_;
@@ -185,6 +247,11 @@ class KvIterator {
     uint64_t last_ts_;
     bool has_pk_;
     bool auto_clean_;
+    // the blocks and the copied values referred to by the values, shared with the responses taken by ShareResponse
+    std::shared_ptr<butil::IOBuf> attachment_;
+    std::shared_ptr<std::deque<std::string>> split_values_;
+    // the part of the attachment after the current pair
+    butil::IOBuf rest_;
 };
 
 }  // namespace base
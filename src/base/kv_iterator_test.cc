@@ -17,6 +17,8 @@
 #include "base/kv_iterator.h"
 
 #include <iostream>
+#include <memory>
+#include <string>
 
 #include "base/strings.h"
 #include "codec/row_codec.h"
@@ -100,6 +102,45 @@ TEST_F(KvIteratorTest, HasPK) {
     ASSERT_FALSE(kv_it.Valid());
 }
 
+TEST_F(KvIteratorTest, Attachment) {
+    std::string pairs(52, '\0');
+    char* data = reinterpret_cast<char*>(&pairs[0]);
+    ::openmldb::codec::EncodeFull("test1", 9527, "hello", 5, data, 0);
+    ::openmldb::codec::EncodeFull("test2", 9528, "hell1", 5, data, 26);
+    // the value of the second pair is split across the blocks
+    butil::IOBuf attachment;
+    attachment.append_user_data(data, 49, [](void*) {});
+    attachment.append_user_data(data + 49, 3, [](void*) {});
+    auto* response = new ::openmldb::api::TraverseResponse();
+    response->set_buf_size(attachment.size());
+    std::shared_ptr<::google::protobuf::Message> shared_response;
+    Slice value1;
+    Slice value2;
+    {
+        KvIterator kv_it(response, &attachment, false);
+        ASSERT_TRUE(attachment.empty());
+        ASSERT_TRUE(kv_it.Valid());
+        ASSERT_EQ("test1", kv_it.GetPK());
+        ASSERT_EQ(9527u, kv_it.GetKey());
+        value1 = kv_it.GetValue();
+        ASSERT_EQ("hello", value1.ToString());
+        // referred to rather than copied
+        ASSERT_EQ(data + 21, value1.data());
+        kv_it.Next();
+        ASSERT_TRUE(kv_it.Valid());
+        ASSERT_EQ("test2", kv_it.GetPK());
+        ASSERT_EQ(9528u, kv_it.GetKey());
+        value2 = kv_it.GetValue();
+        ASSERT_EQ("hell1", value2.ToString());
+        kv_it.Next();
+        ASSERT_FALSE(kv_it.Valid());
+        shared_response = kv_it.ShareResponse();
+    }
+    // the values outlive the iterator with the response
+    ASSERT_EQ("hello", value1.ToString());
+    ASSERT_EQ("hell1", value2.ToString());
+}
+
 }  // namespace base
 }  // namespace openmldb
 
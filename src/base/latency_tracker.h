@@ -0,0 +1,75 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_LATENCY_TRACKER_H_
+#define SRC_BASE_LATENCY_TRACKER_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <vector>
+
+namespace openmldb {
+namespace base {
+
+// A percentile of the latencies over the last window of samples, e.g. the p95 to hedge the requests after. The
+// percentile is recomputed once every window / 4 samples, so reading it is as cheap as a load.
+class LatencyTracker {
+ public:
+    // percentile is in (0, 100], nothing is reported until `window` samples are added
+    explicit LatencyTracker(double percentile, uint32_t window = 128)
+        : percentile_(percentile), window_(std::max(window, 4u)), samples_(), pos_(0), added_(0), value_(0) {
+        samples_.reserve(window_);
+    }
+    LatencyTracker(const LatencyTracker&) = delete;
+    LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+    void Add(uint64_t latency_us) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (samples_.size() < window_) {
+            samples_.push_back(latency_us);
+        } else {
+            samples_[pos_] = latency_us;
+        }
+        pos_ = (pos_ + 1) % window_;
+        added_++;
+        if (samples_.size() == window_ && added_ % (window_ / 4) == 0) {
+            std::vector<uint64_t> sorted = samples_;
+            size_t rank = static_cast<size_t>(percentile_ / 100 * (window_ - 1));
+            std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+            value_.store(sorted[rank], std::memory_order_relaxed);
+        }
+    }
+
+    // the percentile in microseconds, 0 if there are not enough samples yet
+    uint64_t Get() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+    const double percentile_;
+    const uint32_t window_;
+    std::mutex mu_;
+    std::vector<uint64_t> samples_;
+    uint32_t pos_;
+    uint64_t added_;
+    std::atomic<uint64_t> value_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_LATENCY_TRACKER_H_
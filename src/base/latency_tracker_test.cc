@@ -0,0 +1,58 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/latency_tracker.h"
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class LatencyTrackerTest : public ::testing::Test {};
+
+TEST_F(LatencyTrackerTest, Percentile) {
+    LatencyTracker tracker(95, 100);
+    for (uint64_t i = 1; i < 100; i++) {
+        tracker.Add(i);
+    }
+    // not enough samples
+    ASSERT_EQ(0u, tracker.Get());
+    tracker.Add(100);
+    ASSERT_EQ(95u, tracker.Get());
+}
+
+TEST_F(LatencyTrackerTest, Window) {
+    LatencyTracker tracker(50, 8);
+    for (int i = 0; i < 8; i++) {
+        tracker.Add(1000);
+    }
+    ASSERT_EQ(1000u, tracker.Get());
+    // the old samples are replaced, the percentile is recomputed every 2 samples
+    for (int i = 0; i < 7; i++) {
+        tracker.Add(10);
+    }
+    ASSERT_EQ(10u, tracker.Get());
+    tracker.Add(10);
+    ASSERT_EQ(10u, tracker.Get());
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -97,6 +97,14 @@ class lru_cache {
         }
     }
 
+    void remove(const key_type &key) {
+        typename map_type::iterator i = m_map.find(key);
+        if (i != m_map.end()) {
+            m_list.erase(i->second.second);
+            m_map.erase(i);
+        }
+    }
+
     void clear() {
         m_map.clear();
         m_list.clear();
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_MPMC_QUEUE_H_
+#define SRC_BASE_MPMC_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace openmldb {
+namespace base {
+
+// MPMCQueue is a bounded lock-free queue of multiple producers and consumers. Every cell carries a sequence
+// which tells whether it is ready for the next push or pop of its round, so a push or pop only contends on
+// one position counter. The counters live on their own cache lines to keep the producers from invalidating
+// the consumers.
+template <class T>
+class MPMCQueue {
+ public:
+    // the capacity is rounded up to a power of 2
+    explicit MPMCQueue(uint32_t capacity) : mask_(RoundUp(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (uint64_t i = 0; i <= mask_; i++) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+        push_pos_.store(0, std::memory_order_relaxed);
+        pop_pos_.store(0, std::memory_order_relaxed);
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    // return false if the queue is full, item is untouched then
+    bool TryPush(T&& item) {
+        Cell* cell = nullptr;
+        uint64_t pos = push_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            uint64_t seq = cell->seq.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (push_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = push_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPush(const T& item) {
+        T copy = item;
+        return TryPush(std::move(copy));
+    }
+
+    bool TryPop(T* item) { return PopBatch(item, 1) == 1; }
+
+    // pop up to max_num items into items with one claim of the pop position, return the count popped
+    uint32_t PopBatch(T* items, uint32_t max_num) {
+        uint64_t pos = pop_pos_.load(std::memory_order_relaxed);
+        uint32_t num = 0;
+        while (true) {
+            // the successive cells already pushed are claimed together
+            num = 0;
+            while (num < max_num) {
+                uint64_t seq = cells_[(pos + num) & mask_].seq.load(std::memory_order_acquire);
+                if (seq != pos + num + 1) {
+                    break;
+                }
+                num++;
+            }
+            if (num == 0) {
+                uint64_t seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+                if (static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1) < 0) {
+                    return 0;
+                }
+                // another consumer took the cell
+                pos = pop_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (pop_pos_.compare_exchange_weak(pos, pos + num, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (uint32_t i = 0; i < num; i++) {
+            Cell* cell = &cells_[(pos + i) & mask_];
+            items[i] = std::move(cell->data);
+            cell->seq.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        return num;
+    }
+
+    uint32_t PopBatch(std::vector<T>* items, uint32_t max_num) {
+        size_t size = items->size();
+        items->resize(size + max_num);
+        uint32_t num = PopBatch(items->data() + size, max_num);
+        items->resize(size + num);
+        return num;
+    }
+
+    // it may be stale once returned
+    uint32_t SizeApprox() const {
+        uint64_t push_pos = push_pos_.load(std::memory_order_relaxed);
+        uint64_t pop_pos = pop_pos_.load(std::memory_order_relaxed);
+        return push_pos > pop_pos ? push_pos - pop_pos : 0;
+    }
+
+    bool Empty() const { return SizeApprox() == 0; }
+
+    uint32_t Capacity() const { return mask_ + 1; }
+
+ private:
+    static constexpr uint32_t kCacheLineSize = 64;
+
+    struct Cell {
+        std::atomic<uint64_t> seq;
+        T data;
+    };
+
+    static uint64_t RoundUp(uint32_t capacity) {
+        uint64_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    const uint64_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(kCacheLineSize) std::atomic<uint64_t> push_pos_;
+    alignas(kCacheLineSize) std::atomic<uint64_t> pop_pos_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_MPMC_QUEUE_H_
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/mpmc_queue.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <deque>
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class MPMCQueueTest : public ::testing::Test {
+ public:
+    MPMCQueueTest() {}
+    ~MPMCQueueTest() {}
+};
+
+TEST_F(MPMCQueueTest, PushPop) {
+    MPMCQueue<std::string> queue(3);
+    ASSERT_EQ(4u, queue.Capacity());
+    ASSERT_TRUE(queue.Empty());
+    std::string value;
+    ASSERT_FALSE(queue.TryPop(&value));
+    for (uint32_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(queue.TryPush(std::to_string(i)));
+    }
+    std::string rejected = "4";
+    ASSERT_FALSE(queue.TryPush(std::move(rejected)));
+    // a failed push leaves the item untouched
+    ASSERT_EQ("4", rejected);
+    ASSERT_EQ(4u, queue.SizeApprox());
+    for (uint32_t round = 0; round < 10; round++) {
+        ASSERT_TRUE(queue.TryPop(&value));
+        ASSERT_EQ(std::to_string(round), value);
+        ASSERT_TRUE(queue.TryPush(std::to_string(round + 4)));
+    }
+    std::vector<std::string> values;
+    ASSERT_EQ(3u, queue.PopBatch(&values, 3));
+    ASSERT_EQ(1u, queue.PopBatch(&values, 3));
+    ASSERT_EQ(0u, queue.PopBatch(&values, 3));
+    ASSERT_EQ(std::vector<std::string>({"10", "11", "12", "13"}), values);
+    ASSERT_TRUE(queue.Empty());
+}
+
+TEST_F(MPMCQueueTest, MultiThread) {
+    MPMCQueue<uint64_t> queue(64);
+    const uint32_t producer_num = 4;
+    const uint32_t consumer_num = 4;
+    const uint64_t item_num = 100000;
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> popped{0};
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < producer_num; i++) {
+        threads.emplace_back([&queue, i] {
+            for (uint64_t j = 0; j < item_num; j++) {
+                uint64_t value = i * item_num + j;
+                while (!queue.TryPush(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (uint32_t i = 0; i < consumer_num; i++) {
+        threads.emplace_back([&] {
+            uint64_t values[16];
+            // the items of one producer are popped in order by every consumer
+            std::vector<int64_t> last(producer_num, -1);
+            while (popped.load() < producer_num * item_num) {
+                uint32_t num = queue.PopBatch(values, 16);
+                for (uint32_t k = 0; k < num; k++) {
+                    uint32_t producer = values[k] / item_num;
+                    int64_t seq = values[k] % item_num;
+                    ASSERT_LT(last[producer], seq);
+                    last[producer] = seq;
+                    sum += values[k];
+                }
+                popped += num;
+                if (num == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    uint64_t total = producer_num * item_num;
+    ASSERT_EQ(total, popped.load());
+    ASSERT_EQ(total * (total - 1) / 2, sum.load());
+}
+
+// the queue with one lock that MPMCQueue replaces
+template <class T>
+class MutexQueue {
+ public:
+    bool TryPush(T&& item) {
+        std::lock_guard<std::mutex> lock(mu_);
+        queue_.push_back(std::move(item));
+        return true;
+    }
+
+    uint32_t PopBatch(T* items, uint32_t max_num) {
+        std::lock_guard<std::mutex> lock(mu_);
+        uint32_t num = 0;
+        while (num < max_num && !queue_.empty()) {
+            items[num++] = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        return num;
+    }
+
+ private:
+    std::mutex mu_;
+    std::deque<T> queue_;
+};
+
+template <class Queue>
+static uint64_t RunBench(Queue* queue, uint32_t thread_num, uint64_t item_num) {
+    std::atomic<uint64_t> popped{0};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < thread_num; i++) {
+        threads.emplace_back([&] {
+            for (uint64_t j = 0; j < item_num; j++) {
+                uint64_t value = j;
+                while (!queue->TryPush(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&] {
+            uint64_t values[32];
+            while (popped.load(std::memory_order_relaxed) < thread_num * item_num) {
+                uint32_t num = queue->PopBatch(values, 32);
+                if (num == 0) {
+                    std::this_thread::yield();
+                }
+                popped += num;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST_F(MPMCQueueTest, Bench) {
+    const uint64_t item_num = 200000;
+    for (uint32_t thread_num : {1, 2, 4}) {
+        MPMCQueue<uint64_t> queue(4096);
+        MutexQueue<uint64_t> mutex_queue;
+        uint64_t lock_free_us = RunBench(&queue, thread_num, item_num);
+        uint64_t mutex_us = RunBench(&mutex_queue, thread_num, item_num);
+        std::cout << thread_num << " producers and consumers, " << item_num << " items each. mpmc queue "
+                  << lock_free_us << "us, mutex queue " << mutex_us << "us" << std::endl;
+    }
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "base/numa.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+namespace openmldb {
+namespace base {
+
+static const char NUMA_NODE_PATH[] = "/sys/devices/system/node/node";
+
+std::vector<uint32_t> ParseCpuList(const std::string& list) {
+    std::vector<uint32_t> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        while (!range.empty() && (range.back() == '\n' || range.back() == ' ')) {
+            range.pop_back();
+        }
+        if (range.empty()) {
+            continue;
+        }
+        try {
+            size_t pos = range.find('-');
+            uint32_t begin = std::stoul(range.substr(0, pos));
+            uint32_t end = pos == std::string::npos ? begin : std::stoul(range.substr(pos + 1));
+            if (end < begin) {
+                return {};
+            }
+            for (uint32_t cpu = begin; cpu <= end; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception& e) {
+            return {};
+        }
+    }
+    return cpus;
+}
+
+std::vector<std::vector<uint32_t>> GetNumaNodeCpus() {
+    std::vector<std::vector<uint32_t>> nodes;
+    // the node ids are contiguous on the machines we run
+    while (true) {
+        std::ifstream file(NUMA_NODE_PATH + std::to_string(nodes.size()) + "/cpulist");
+        if (!file.is_open()) {
+            break;
+        }
+        std::string list;
+        std::getline(file, list);
+        std::vector<uint32_t> cpus = ParseCpuList(list);
+        if (cpus.empty()) {
+            return {};
+        }
+        nodes.push_back(std::move(cpus));
+    }
+    return nodes;
+}
+
+bool BindThreadToCpus(const std::vector<uint32_t>& cpus) {
+#ifdef __linux__
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+}  // namespace base
+}  // namespace openmldb
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SRC_BASE_NUMA_H_
+#define SRC_BASE_NUMA_H_
+
+#include <string>
+#include <vector>
+
+namespace openmldb {
+namespace base {
+
+// parse the cpu list of sysfs like "0-3,8,10-11", empty if it is invalid
+std::vector<uint32_t> ParseCpuList(const std::string& list);
+
+// the cpus of every numa node in the order of node id, empty if the topology is unknown
+std::vector<std::vector<uint32_t>> GetNumaNodeCpus();
+
+// bind the current thread to the cpus, return false if fails or unsupported
+bool BindThreadToCpus(const std::vector<uint32_t>& cpus);
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_NUMA_H_
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "base/numa.h"
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "base/taskpool.hpp"
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class NumaTest : public ::testing::Test {};
+
+TEST_F(NumaTest, ParseCpuList) {
+    ASSERT_EQ(std::vector<uint32_t>({0, 1, 2, 3, 8, 10, 11}), ParseCpuList("0-3,8,10-11\n"));
+    ASSERT_EQ(std::vector<uint32_t>({5}), ParseCpuList("5"));
+    ASSERT_TRUE(ParseCpuList("").empty());
+    ASSERT_TRUE(ParseCpuList("3-1").empty());
+    ASSERT_TRUE(ParseCpuList("a-b").empty());
+}
+
+TEST_F(NumaTest, BoundTaskPool) {
+    auto nodes = GetNumaNodeCpus();
+    for (const auto& cpus : nodes) {
+        ASSERT_FALSE(cpus.empty());
+    }
+    // the threads run the tasks even if the binding is unsupported
+    std::atomic<int> cnt(0);
+    {
+        TaskPool pool(2, 16, nodes.empty() ? std::vector<uint32_t>({0}) : nodes[0]);
+        for (int i = 0; i < 100; i++) {
+            pool.AddTask([&cnt] { cnt++; });
+        }
+    }
+    ASSERT_EQ(100, cnt.load());
+}
+
+TEST_F(NumaTest, TryAddTask) {
+    std::mutex mu;
+    std::unique_lock<std::mutex> blocker(mu);
+    std::atomic<int> cnt(0);
+    {
+        TaskPool pool(1, 2, {0});
+        // the worker is blocked by the first task, the next two fill the queue
+        ASSERT_TRUE(pool.TryAddTask([&mu, &cnt] {
+            std::lock_guard<std::mutex> lock(mu);
+            cnt++;
+        }));
+        while (pool.GetQueueSize() > 0) {
+            std::this_thread::yield();
+        }
+        ASSERT_TRUE(pool.TryAddTask([&cnt] { cnt++; }));
+        ASSERT_TRUE(pool.TryAddTask([&cnt] { cnt++; }));
+        ASSERT_EQ(2u, pool.GetQueueSize());
+        ASSERT_FALSE(pool.TryAddTask([&cnt] { cnt++; }));
+        blocker.unlock();
+    }
+    ASSERT_EQ(3, cnt.load());
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_PARTITION_ROUTER_H_
+#define SRC_BASE_PARTITION_ROUTER_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/hash.h"
+
+namespace openmldb {
+namespace base {
+
+// PartitionRouter routes a key to the partition of a table by its hash. The table is created with pid_num
+// partitions and the partition p takes the hashes h with h % pid_num == p. A split of the partition taking the
+// hashes h % m == r moves the half of them with h % (2 * m) == r + m to a new partition, the child, so only the
+// keys of the partition split change their partition. The children are appended to the partitions of the table
+// in the order of the splits and a partition may be split again, as may the children.
+// Without splits a key goes to hash64(key) % pid_num as before.
+class PartitionRouter {
+ public:
+    // the max times the hashes of a partition are halved, the non-negative hashes are below 2^63
+    static constexpr uint32_t kMaxSplitDepth = 62;
+
+    explicit PartitionRouter(uint32_t pid_num)
+        : base_num_(pid_num > 0 ? pid_num : 1), children_(base_num_), depths_(base_num_, 0) {}
+
+    // splits are in the order they are done, each has pid() and child_pid() like common::PartitionSplit.
+    // pid_num counts the children too
+    template <class Splits>
+    PartitionRouter(uint32_t pid_num, const Splits& splits)
+        : base_num_(pid_num > static_cast<uint32_t>(splits.size()) ? pid_num - splits.size() : 1),
+          children_(pid_num > base_num_ ? pid_num : base_num_),
+          depths_(children_.size(), 0) {
+        for (const auto& split : splits) {
+            if (split.pid() < children_.size() && split.child_pid() < children_.size()) {
+                children_[split.pid()].push_back(split.child_pid());
+                depths_[split.pid()]++;
+                depths_[split.child_pid()] = depths_[split.pid()];
+            }
+        }
+    }
+
+    uint32_t GetPartitionNum() const { return children_.size(); }
+
+    bool HasSplit() const { return children_.size() > base_num_; }
+
+    uint32_t GetPid(const std::string& key) const { return GetPidByHash(static_cast<uint64_t>(hash64(key))); }
+
+    uint32_t GetPidByHash(uint64_t hash) const {
+        uint32_t pid = hash % base_num_;
+        uint64_t modulus = base_num_;
+        size_t idx = 0;
+        // a hash below the modulus stays in the partition at the later splits, which also keeps the doubled
+        // modulus in 64 bits
+        while (idx < children_[pid].size() && modulus <= hash && modulus <= (UINT64_MAX >> 1)) {
+            // the partition taking hash % modulus is split into itself and a child taking the upper half
+            if (hash % (modulus * 2) != hash % modulus) {
+                pid = children_[pid][idx];
+                idx = 0;
+            } else {
+                idx++;
+            }
+            modulus *= 2;
+        }
+        return pid;
+    }
+
+    // the pid of the child if a partition is split once more
+    uint32_t GetNextChild() const { return children_.size(); }
+
+    // the times the hashes of pid are halved, it cannot be split again at kMaxSplitDepth
+    uint32_t GetDepth(uint32_t pid) const { return pid < depths_.size() ? depths_[pid] : 0; }
+
+ private:
+    uint32_t base_num_;
+    // pid -> the children split out of it in order
+    std::vector<std::vector<uint32_t>> children_;
+    std::vector<uint32_t> depths_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_PARTITION_ROUTER_H_
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/partition_router.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class PartitionRouterTest : public ::testing::Test {
+ public:
+    PartitionRouterTest() {}
+    ~PartitionRouterTest() {}
+};
+
+struct Split {
+    uint32_t pid() const { return pid_; }
+    uint32_t child_pid() const { return child_pid_; }
+    uint32_t pid_;
+    uint32_t child_pid_;
+};
+
+TEST_F(PartitionRouterTest, NoSplit) {
+    PartitionRouter router(8);
+    ASSERT_FALSE(router.HasSplit());
+    ASSERT_EQ(8u, router.GetPartitionNum());
+    ASSERT_EQ(8u, router.GetNextChild());
+    for (int i = 0; i < 1000; i++) {
+        std::string key = "key" + std::to_string(i);
+        ASSERT_EQ(static_cast<uint32_t>(hash64(key) % 8), router.GetPid(key));
+    }
+}
+
+TEST_F(PartitionRouterTest, Split) {
+    // 3 partitions, 1 is split into 1 and 3, then 1 into 1 and 4, then 3 into 3 and 5
+    std::vector<Split> splits = {{1, 3}, {1, 4}, {3, 5}};
+    PartitionRouter router(6, splits);
+    ASSERT_TRUE(router.HasSplit());
+    ASSERT_EQ(6u, router.GetNextChild());
+    ASSERT_EQ(0u, router.GetDepth(0));
+    ASSERT_EQ(2u, router.GetDepth(1));
+    ASSERT_EQ(2u, router.GetDepth(3));
+    ASSERT_EQ(2u, router.GetDepth(4));
+    ASSERT_EQ(2u, router.GetDepth(5));
+    ASSERT_EQ(0u, router.GetPidByHash(0));
+    ASSERT_EQ(2u, router.GetPidByHash(5));
+    // a hash below the modulus is not moved
+    ASSERT_EQ(1u, router.GetPidByHash(1));
+    ASSERT_EQ(1u, router.GetPidByHash(13));
+    ASSERT_EQ(4u, router.GetPidByHash(7));
+    ASSERT_EQ(3u, router.GetPidByHash(4));
+    ASSERT_EQ(5u, router.GetPidByHash(10));
+    ASSERT_EQ(3u, router.GetPidByHash(16));
+}
+
+TEST_F(PartitionRouterTest, OnlySplitKeysMove) {
+    PartitionRouter before(4);
+    std::vector<Split> splits = {{2, 4}};
+    PartitionRouter after(5, splits);
+    std::map<uint32_t, uint32_t> cnt;
+    for (int i = 0; i < 10000; i++) {
+        std::string key = "key" + std::to_string(i);
+        uint32_t old_pid = before.GetPid(key);
+        uint32_t new_pid = after.GetPid(key);
+        if (old_pid != 2) {
+            ASSERT_EQ(old_pid, new_pid);
+        } else {
+            ASSERT_TRUE(new_pid == 2 || new_pid == 4);
+        }
+        cnt[new_pid]++;
+    }
+    // the keys of the partition split are halved
+    ASSERT_GT(cnt[4], cnt[2] / 2);
+    ASSERT_GT(cnt[2], cnt[4] / 2);
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
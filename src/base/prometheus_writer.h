@@ -0,0 +1,144 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_PROMETHEUS_WRITER_H_
+#define SRC_BASE_PROMETHEUS_WRITER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace openmldb {
+namespace base {
+
+// PrometheusWriter builds the text exposition format of prometheus. The samples of a family may be added in any
+// order, they are grouped under the HELP and TYPE lines of the family when dumped.
+class PrometheusWriter {
+ public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    // `type` is counter, gauge, histogram or summary. a family declared again is ignored
+    void Declare(const std::string& name, const std::string& type, const std::string& help) {
+        if (index_.find(name) != index_.end()) {
+            return;
+        }
+        index_.emplace(name, families_.size());
+        families_.emplace_back();
+        families_.back().text = "# HELP " + name + " " + help + "\n# TYPE " + name + " " + type + "\n";
+    }
+
+    // add a sample to the family declared, `suffix` is appended to the name of the sample, e.g. _count
+    void Add(const std::string& name, const Labels& labels, double value, const std::string& suffix = "") {
+        auto it = index_.find(name);
+        if (it == index_.end()) {
+            return;
+        }
+        std::string& text = families_[it->second].text;
+        text.append(name).append(suffix);
+        AppendLabels(labels, &text);
+        text.append(" ").append(FormatValue(value)).append("\n");
+    }
+
+    // add a histogram with the cumulative counts of the buckets as {upper bound, count}. the +Inf bucket is
+    // added with `count`, so it should not be in `buckets`
+    void AddHistogram(const std::string& name, const Labels& labels,
+                      const std::vector<std::pair<double, uint64_t>>& buckets, double sum, uint64_t count) {
+        Labels bucket_labels = labels;
+        bucket_labels.emplace_back("le", "");
+        for (const auto& bucket : buckets) {
+            bucket_labels.back().second = FormatValue(bucket.first);
+            Add(name, bucket_labels, bucket.second, "_bucket");
+        }
+        bucket_labels.back().second = "+Inf";
+        Add(name, bucket_labels, count, "_bucket");
+        Add(name, labels, sum, "_sum");
+        Add(name, labels, count, "_count");
+    }
+
+    std::string Dump() const {
+        std::string out;
+        for (const auto& family : families_) {
+            out.append(family.text);
+        }
+        return out;
+    }
+
+    // the integral values are written as integers, so the counters are exact below 2^53
+    static std::string FormatValue(double value) {
+        if (std::isnan(value)) {
+            return "NaN";
+        }
+        if (std::isinf(value)) {
+            return value > 0 ? "+Inf" : "-Inf";
+        }
+        char buf[32];
+        if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+            snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(value));  // NOLINT
+        } else {
+            snprintf(buf, sizeof(buf), "%.17g", value);
+        }
+        return buf;
+    }
+
+    static std::string EscapeLabelValue(const std::string& value) {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (char c : value) {
+            if (c == '\\') {
+                escaped.append("\\\\");
+            } else if (c == '"') {
+                escaped.append("\\\"");
+            } else if (c == '\n') {
+                escaped.append("\\n");
+            } else {
+                escaped.push_back(c);
+            }
+        }
+        return escaped;
+    }
+
+ private:
+    struct Family {
+        std::string text;
+    };
+
+    static void AppendLabels(const Labels& labels, std::string* text) {
+        if (labels.empty()) {
+            return;
+        }
+        text->push_back('{');
+        for (size_t i = 0; i < labels.size(); i++) {
+            if (i > 0) {
+                text->push_back(',');
+            }
+            text->append(labels[i].first).append("=\"").append(EscapeLabelValue(labels[i].second)).push_back('"');
+        }
+        text->push_back('}');
+    }
+
+    std::vector<Family> families_;
+    std::map<std::string, size_t> index_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_PROMETHEUS_WRITER_H_
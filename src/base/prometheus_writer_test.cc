@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/prometheus_writer.h"
+
+#include <limits>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class PrometheusWriterTest : public ::testing::Test {};
+
+TEST_F(PrometheusWriterTest, Family) {
+    PrometheusWriter writer;
+    writer.Declare("rows", "gauge", "the rows");
+    writer.Declare("gc_total", "counter", "the gc rounds");
+    writer.Add("rows", {{"tid", "1"}, {"pid", "0"}}, 10);
+    writer.Add("gc_total", {}, 3);
+    writer.Add("rows", {{"tid", "2"}, {"pid", "0"}}, 0.5);
+    // the samples of undeclared families are dropped
+    writer.Add("unknown", {}, 1);
+    writer.Declare("rows", "counter", "declared again");
+    ASSERT_EQ(
+        "# HELP rows the rows\n"
+        "# TYPE rows gauge\n"
+        "rows{tid=\"1\",pid=\"0\"} 10\n"
+        "rows{tid=\"2\",pid=\"0\"} 0.5\n"
+        "# HELP gc_total the gc rounds\n"
+        "# TYPE gc_total counter\n"
+        "gc_total 3\n",
+        writer.Dump());
+}
+
+TEST_F(PrometheusWriterTest, Histogram) {
+    PrometheusWriter writer;
+    writer.Declare("latency_seconds", "histogram", "the latency");
+    writer.AddHistogram("latency_seconds", {{"deploy", "db.d1"}}, {{0.001, 1}, {0.01, 3}}, 0.025, 4);
+    ASSERT_EQ(
+        "# HELP latency_seconds the latency\n"
+        "# TYPE latency_seconds histogram\n"
+        "latency_seconds_bucket{deploy=\"db.d1\",le=\"0.001\"} 1\n"
+        "latency_seconds_bucket{deploy=\"db.d1\",le=\"0.01\"} 3\n"
+        "latency_seconds_bucket{deploy=\"db.d1\",le=\"+Inf\"} 4\n"
+        "latency_seconds_sum{deploy=\"db.d1\"} 0.025000000000000001\n"
+        "latency_seconds_count{deploy=\"db.d1\"} 4\n",
+        writer.Dump());
+}
+
+TEST_F(PrometheusWriterTest, Format) {
+    ASSERT_EQ("a\\\\b\\\"c\\nd", PrometheusWriter::EscapeLabelValue("a\\b\"c\nd"));
+    ASSERT_EQ("1099511627776", PrometheusWriter::FormatValue(1099511627776.0));
+    ASSERT_EQ("-3", PrometheusWriter::FormatValue(-3));
+    ASSERT_EQ("+Inf", PrometheusWriter::FormatValue(std::numeric_limits<double>::infinity()));
+    ASSERT_EQ("NaN", PrometheusWriter::FormatValue(std::numeric_limits<double>::quiet_NaN()));
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_SHARDED_LRU_CACHE_H_
+#define SRC_BASE_SHARDED_LRU_CACHE_H_
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+namespace openmldb::base {
+
+// ShardedLRUCache is a thread safe lru cache. The keys are spread over the shards by hash and every shard
+// has its own lock, list and capacity, so the lookups of different keys rarely wait for each other. The
+// capacity is the total charge of the items, an item charges 1 unless given.
+//
+// Every shard has a version which is increased by Remove. A filler takes the version before reading the
+// source of an item and inserts with UpsertIfVersion, so the item is dropped if the key may be removed
+// meanwhile.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ShardedLRUCache {
+ public:
+    static constexpr uint32_t kDefaultShardNum = 16;
+
+    // there are no more shards than capacity
+    explicit ShardedLRUCache(uint64_t capacity, uint32_t shard_num = kDefaultShardNum) : hash_(), shards_() {
+        shard_num = std::max<uint64_t>(1, std::min<uint64_t>(shard_num, capacity));
+        uint64_t shard_capacity = std::max<uint64_t>(1, (capacity + shard_num - 1) / shard_num);
+        for (uint32_t i = 0; i < shard_num; i++) {
+            shards_.emplace_back(new Shard(shard_capacity));
+        }
+    }
+
+    ShardedLRUCache(const ShardedLRUCache&) = delete;
+    ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+    boost::optional<Value> Get(const Key& key) {
+        Shard* shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard->mu);
+        auto iter = shard->map.find(key);
+        if (iter == shard->map.end()) {
+            shard->miss_cnt++;
+            return boost::none;
+        }
+        shard->hit_cnt++;
+        shard->list.splice(shard->list.begin(), shard->list, iter->second);
+        return iter->second->value;
+    }
+
+    bool Contains(const Key& key) {
+        Shard* shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard->mu);
+        return shard->map.find(key) != shard->map.end();
+    }
+
+    void Upsert(const Key& key, const Value& value, uint64_t charge = 1) {
+        Shard* shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard->mu);
+        UpsertLocked(shard, key, value, charge);
+    }
+
+    // return false and insert nothing if the version of the shard of key is not version any more
+    bool UpsertIfVersion(const Key& key, const Value& value, uint64_t version, uint64_t charge = 1) {
+        Shard* shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard->mu);
+        if (shard->version != version) {
+            return false;
+        }
+        UpsertLocked(shard, key, value, charge);
+        return true;
+    }
+
+    uint64_t GetVersion(const Key& key) {
+        Shard* shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard->mu);
+        return shard->version;
+    }
+
+    void Remove(const Key& key) {
+        Shard* shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard->mu);
+        shard->version++;
+        auto iter = shard->map.find(key);
+        if (iter != shard->map.end()) {
+            shard->charge -= iter->second->charge;
+            shard->list.erase(iter->second);
+            shard->map.erase(iter);
+        }
+    }
+
+    void Clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mu);
+            shard->version++;
+            shard->map.clear();
+            shard->list.clear();
+            shard->charge = 0;
+        }
+    }
+
+    uint64_t GetSize() const { return Sum([](const Shard& shard) -> uint64_t { return shard.map.size(); }); }
+    uint64_t GetCharge() const { return Sum([](const Shard& shard) { return shard.charge; }); }
+    uint64_t GetCapacity() const { return shards_.size() * shards_.front()->capacity; }
+    uint64_t GetHitCnt() const { return Sum([](const Shard& shard) { return shard.hit_cnt; }); }
+    uint64_t GetMissCnt() const { return Sum([](const Shard& shard) { return shard.miss_cnt; }); }
+    uint64_t GetEvictCnt() const { return Sum([](const Shard& shard) { return shard.evict_cnt; }); }
+
+ private:
+    struct Node {
+        Key key;
+        Value value;
+        uint64_t charge;
+    };
+
+    struct Shard {
+        explicit Shard(uint64_t c) : capacity(c) {}
+        mutable std::mutex mu;
+        const uint64_t capacity;
+        // the most recently used first
+        std::list<Node> list;
+        std::unordered_map<Key, typename std::list<Node>::iterator, Hash> map;
+        uint64_t charge = 0;
+        uint64_t version = 0;
+        // the counters are kept by shard, so the lookups of different shards share no cache line
+        uint64_t hit_cnt = 0;
+        uint64_t miss_cnt = 0;
+        uint64_t evict_cnt = 0;
+    };
+
+    Shard* GetShard(const Key& key) {
+        size_t hash = hash_(key);
+        // the low bits also pick the bucket of the map in the shard
+        return shards_[(hash ^ (hash >> 32)) % shards_.size()].get();
+    }
+
+    // the item of key is kept even if its charge is over the capacity of the shard
+    void UpsertLocked(Shard* shard, const Key& key, const Value& value, uint64_t charge) {
+        auto iter = shard->map.find(key);
+        if (iter != shard->map.end()) {
+            shard->charge -= iter->second->charge;
+            iter->second->value = value;
+            iter->second->charge = charge;
+            shard->list.splice(shard->list.begin(), shard->list, iter->second);
+        } else {
+            shard->list.push_front(Node{key, value, charge});
+            shard->map.emplace(key, shard->list.begin());
+        }
+        shard->charge += charge;
+        while (shard->charge > shard->capacity && shard->list.size() > 1) {
+            Node& victim = shard->list.back();
+            shard->charge -= victim.charge;
+            shard->map.erase(victim.key);
+            shard->list.pop_back();
+            shard->evict_cnt++;
+        }
+    }
+
+    template <class Getter>
+    uint64_t Sum(Getter getter) const {
+        uint64_t sum = 0;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mu);
+            sum += getter(*shard);
+        }
+        return sum;
+    }
+
+    Hash hash_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace openmldb::base
+
+#endif  // SRC_BASE_SHARDED_LRU_CACHE_H_
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/sharded_lru_cache.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb::base {
+
+class ShardedLRUCacheTest : public ::testing::Test {
+ public:
+    ShardedLRUCacheTest() {}
+    ~ShardedLRUCacheTest() {}
+};
+
+TEST_F(ShardedLRUCacheTest, Lru) {
+    ShardedLRUCache<int, std::string> cache(3, 1);
+    cache.Upsert(1, "a");
+    cache.Upsert(2, "b");
+    cache.Upsert(3, "c");
+    ASSERT_EQ("a", *cache.Get(1));
+    // 2 is the least recently used
+    cache.Upsert(4, "d");
+    ASSERT_FALSE(cache.Get(2));
+    ASSERT_TRUE(cache.Contains(1));
+    ASSERT_TRUE(cache.Contains(3));
+    ASSERT_TRUE(cache.Contains(4));
+    cache.Upsert(3, "cc");
+    ASSERT_EQ("cc", *cache.Get(3));
+    ASSERT_EQ(3u, cache.GetSize());
+    ASSERT_EQ(2u, cache.GetHitCnt());
+    ASSERT_EQ(1u, cache.GetMissCnt());
+    ASSERT_EQ(1u, cache.GetEvictCnt());
+    cache.Remove(3);
+    ASSERT_FALSE(cache.Contains(3));
+    cache.Clear();
+    ASSERT_EQ(0u, cache.GetSize());
+}
+
+TEST_F(ShardedLRUCacheTest, Charge) {
+    ShardedLRUCache<int, int> cache(10, 1);
+    cache.Upsert(1, 1, 4);
+    cache.Upsert(2, 2, 4);
+    ASSERT_EQ(8u, cache.GetCharge());
+    cache.Upsert(3, 3, 4);
+    ASSERT_FALSE(cache.Contains(1));
+    ASSERT_EQ(8u, cache.GetCharge());
+    // the charge of an updated item is replaced
+    cache.Upsert(2, 2, 1);
+    ASSERT_EQ(5u, cache.GetCharge());
+    // an item over the capacity is kept alone
+    cache.Upsert(4, 4, 20);
+    ASSERT_EQ(1u, cache.GetSize());
+    ASSERT_EQ(4, *cache.Get(4));
+}
+
+TEST_F(ShardedLRUCacheTest, Version) {
+    ShardedLRUCache<std::string, int> cache(16);
+    uint64_t version = cache.GetVersion("k");
+    ASSERT_TRUE(cache.UpsertIfVersion("k", 1, version));
+    version = cache.GetVersion("k");
+    // the key is removed after the version is taken
+    cache.Remove("k");
+    ASSERT_FALSE(cache.UpsertIfVersion("k", 2, version));
+    ASSERT_FALSE(cache.Get("k"));
+}
+
+TEST_F(ShardedLRUCacheTest, Shard) {
+    ShardedLRUCache<int, int> cache(1000, 8);
+    ASSERT_EQ(1000u, cache.GetCapacity());
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&cache, i] {
+            for (int j = 0; j < 10000; j++) {
+                int key = (i * 10000 + j) % 2000;
+                if (!cache.Get(key)) {
+                    cache.Upsert(key, key);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_LE(cache.GetSize(), cache.GetCapacity());
+    ASSERT_EQ(40000u, cache.GetHitCnt() + cache.GetMissCnt());
+    // fewer shards than capacity
+    ShardedLRUCache<int, int> small(2);
+    ASSERT_EQ(2u, small.GetCapacity());
+}
+
+}  // namespace openmldb::base
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
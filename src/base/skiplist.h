@@ -293,10 +293,16 @@ class Skiplist {
 
     // Need external synchronized
     bool AddToFirst(const K& key, V& value) {  // NOLINT
+        return PushFront(key, value) > 0;
+    }
+
+    // add the key which is not after the first node to the head without searching, return the height of the new
+    // node, or 0 if the key is after the first node. Need external synchronized
+    uint8_t PushFront(const K& key, V& value) {  // NOLINT
         {
             Node<K, V>* node = head_->GetNext(0);
             if (node != NULL && compare_(key, node->GetKey()) > 0) {
-                return false;
+                return 0;
             }
         }
         uint8_t height = RandomHeight();
@@ -315,7 +321,7 @@ class Skiplist {
             node->SetNextNoBarrier(i, pre[i]->GetNextNoBarrier(i));
             pre[i]->SetNext(i, node);
         }
-        return true;
+        return height;
     }
 
     class Iterator {
@@ -340,6 +346,11 @@ class Skiplist {
             return node_->GetValue();
         }
 
+        uint8_t GetHeight() const {
+            assert(Valid());
+            return node_->Height();
+        }
+
         void Seek(const K& k) {
             node_ = list_->FindLessThan(k);
             Next();
@@ -362,6 +373,9 @@ class Skiplist {
     // delete the iterator after it's used
     Iterator* NewIterator() { return new Iterator(this); }
 
+    // the height limit given on construction, the nodes are never higher
+    uint8_t GetHeightLimit() const { return MaxHeight; }
+
  private:
     Node<K, V>* NewNode(const K& key, V& value, uint8_t height) {  // NOLINT
         Node<K, V>* node = new Node<K, V>(key, value, height);
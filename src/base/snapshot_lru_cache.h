@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SRC_BASE_SNAPSHOT_LRU_CACHE_H_
+#define SRC_BASE_SNAPSHOT_LRU_CACHE_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include <boost/optional.hpp>
+#include <boost/optional/optional_io.hpp>
+
+namespace openmldb::base {
+
+// a lru cache for the read mostly workloads. the readers look up an immutable snapshot of the map
+// and never wait for the writers, the writers copy the map under a mutex and publish the new one.
+// the recency is kept by a tick of each item, all the items read between two writes have the same
+// tick, so the eviction among them is arbitrary
+template <class Key, class Value>
+class snapshot_lru_cache {
+ public:
+    typedef Key key_type;
+    typedef Value value_type;
+
+    explicit snapshot_lru_cache(size_t capacity)
+        : m_mu(), m_clock(0), m_map(std::make_shared<const map_type>()), m_capacity(capacity) {}
+
+    ~snapshot_lru_cache() = default;
+
+    size_t size() const { return snapshot()->size(); }
+
+    size_t capacity() const { return m_capacity; }
+
+    bool empty() const { return snapshot()->empty(); }
+
+    bool contains(const key_type &key) const { return snapshot()->count(key) > 0; }
+
+    boost::optional<value_type> get(const key_type &key) const {
+        auto map = snapshot();
+        auto i = map->find(key);
+        if (i == map->end()) {
+            return boost::none;
+        }
+        // only the first read after a write stores the tick, the others just load it
+        uint64_t clock = m_clock.load(std::memory_order_relaxed);
+        if (i->second->tick.load(std::memory_order_relaxed) < clock) {
+            i->second->tick.store(clock, std::memory_order_relaxed);
+        }
+        return i->second->value;
+    }
+
+    void upsert(const key_type &key, const value_type &value) {
+        std::lock_guard<std::mutex> lock(m_mu);
+        auto map = std::make_shared<map_type>(*snapshot());
+        if (map->find(key) == map->end() && !map->empty() && map->size() >= m_capacity) {
+            evict(map.get());
+        }
+        // the new item is newer than all the items read before, and older than the items read after
+        uint64_t clock = m_clock.load(std::memory_order_relaxed);
+        (*map)[key] = std::make_shared<item_type>(value, clock + 1);
+        m_clock.store(clock + 2, std::memory_order_relaxed);
+        std::atomic_store_explicit(&m_map, std::shared_ptr<const map_type>(std::move(map)),
+                                   std::memory_order_release);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mu);
+        std::atomic_store_explicit(&m_map, std::make_shared<const map_type>(), std::memory_order_release);
+    }
+
+ private:
+    struct item_type {
+        item_type(const value_type &v, uint64_t t) : value(v), tick(t) {}
+        value_type value;
+        mutable std::atomic<uint64_t> tick;
+    };
+    typedef std::map<key_type, std::shared_ptr<item_type>> map_type;
+
+    std::shared_ptr<const map_type> snapshot() const {
+        return std::atomic_load_explicit(&m_map, std::memory_order_acquire);
+    }
+
+    static void evict(map_type *map) {
+        auto victim = map->begin();
+        uint64_t min_tick = victim->second->tick.load(std::memory_order_relaxed);
+        for (auto i = map->begin(); i != map->end(); ++i) {
+            uint64_t tick = i->second->tick.load(std::memory_order_relaxed);
+            if (tick < min_tick) {
+                victim = i;
+                min_tick = tick;
+            }
+        }
+        map->erase(victim);
+    }
+
+ private:
+    std::mutex m_mu;
+    std::atomic<uint64_t> m_clock;
+    std::shared_ptr<const map_type> m_map;
+    size_t m_capacity;
+};
+
+}  // namespace openmldb::base
+
+#endif  // SRC_BASE_SNAPSHOT_LRU_CACHE_H_
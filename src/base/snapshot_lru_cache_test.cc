@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "base/snapshot_lru_cache.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb::base {
+
+class SnapshotLRUCacheTest : public ::testing::Test {};
+
+TEST_F(SnapshotLRUCacheTest, Evict) {
+    snapshot_lru_cache<int, int> cache(2);
+    cache.upsert(0, 0);
+    cache.upsert(1, 1);
+    // 0 is read after 1 is inserted, so 1 is evicted
+    ASSERT_EQ(cache.get(0), 0);
+    cache.upsert(2, 2);
+    ASSERT_EQ(2u, cache.size());
+    ASSERT_FALSE(cache.contains(1));
+    ASSERT_TRUE(cache.contains(0));
+    cache.upsert(3, 3);
+    ASSERT_FALSE(cache.contains(0));
+    ASSERT_EQ(cache.get(2), 2);
+    ASSERT_EQ(cache.get(3), 3);
+    ASSERT_EQ(cache.get(0), boost::none);
+}
+
+TEST_F(SnapshotLRUCacheTest, Upsert) {
+    snapshot_lru_cache<int, int> cache(2);
+    cache.upsert(0, 0);
+    cache.upsert(1, 1);
+    // update key 0, it becomes the newest
+    cache.upsert(0, -1);
+    cache.upsert(2, 2);
+    ASSERT_FALSE(cache.contains(1));
+    ASSERT_EQ(cache.get(0), -1);
+    ASSERT_EQ(cache.get(2), 2);
+    cache.clear();
+    ASSERT_TRUE(cache.empty());
+}
+
+TEST_F(SnapshotLRUCacheTest, Concurrent) {
+    snapshot_lru_cache<std::string, int> cache(16);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < 1000; i++) {
+                std::string key = std::to_string((t * 1000 + i) % 32);
+                auto value = cache.get(key);
+                if (value) {
+                    ASSERT_EQ(std::to_string(*value), key);
+                } else {
+                    cache.upsert(key, std::stoi(key));
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(16u, cache.size());
+}
+
+}  // namespace openmldb::base
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -86,6 +86,15 @@ enum ReturnCode {
     kProcedureAlreadyExists = 157,
     kProcedureNotFound = 158,
     kCreateFunctionFailed = 159,
+    kQueryRejected = 160,
+    kQueryDeadlineExceeded = 161,
+    kFollowerLagBehind = 162,
+    // the put is rejected for the memory of the tablet or the lag of the followers and is to be retried later
+    kWriteThrottled = 163,
+    kStatementNotFound = 164,
+    kQueryResultNotFound = 165,
+    // the intermediate tables of the query pass the memory limit of the query or the tablet
+    kQueryMemoryLimitExceeded = 166,
     kNameserverIsNotLeader = 300,
     kAutoFailoverIsEnabled = 301,
     kEndpointIsNotExist = 302,
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_TASK_SCHEDULER_H_
+#define SRC_BASE_TASK_SCHEDULER_H_
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace openmldb {
+namespace base {
+
+// TaskScheduler runs the tasks of several classes on one set of workers, so a busy class takes the threads the
+// others leave idle. The smaller class has the higher priority, and a class runs at most its cap of tasks at once,
+// 0 for no cap. Every worker has its own queues, the tasks added by a worker go to its queues and an idle worker
+// steals the tasks of the others.
+class TaskScheduler {
+ public:
+    using Task = std::function<void()>;
+
+    TaskScheduler(uint32_t thread_num, const std::vector<uint32_t>& class_caps)
+        : caps_(class_caps), running_(class_caps.size()), workers_(thread_num == 0 ? 1 : thread_num) {
+        for (auto& worker : workers_) {
+            worker.reset(new Worker(class_caps.size()));
+        }
+        for (auto& running : running_) {
+            running.store(0, std::memory_order_relaxed);
+        }
+        for (uint32_t i = 0; i < workers_.size(); i++) {
+            threads_.emplace_back(&TaskScheduler::WorkerProc, this, i);
+        }
+        timer_thread_ = std::thread(&TaskScheduler::TimerProc, this);
+    }
+
+    ~TaskScheduler() { Stop(true); }
+
+    void AddTask(uint32_t cls, Task task) {
+        if (cls >= caps_.size() || stop_.load(std::memory_order_acquire)) {
+            return;
+        }
+        uint32_t idx = (t_scheduler == this) ? t_worker_idx : next_worker_.fetch_add(1) % workers_.size();
+        {
+            std::lock_guard<std::mutex> lock(workers_[idx]->mu);
+            workers_[idx]->queues[cls].push_back(std::move(task));
+        }
+        pending_.fetch_add(1, std::memory_order_acq_rel);
+        Wakeup();
+    }
+
+    void DelayTask(uint32_t cls, int64_t delay_ms, Task task) {
+        auto due = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
+        std::lock_guard<std::mutex> lock(timer_mu_);
+        if (timer_stop_) {
+            return;
+        }
+        delayed_.emplace(due, std::make_pair(cls, std::move(task)));
+        timer_cv_.notify_one();
+    }
+
+    // the delayed tasks are dropped, the queued ones are run before the workers exit if wait is true
+    void Stop(bool wait) {
+        {
+            std::lock_guard<std::mutex> lock(timer_mu_);
+            if (timer_stop_) {
+                return;
+            }
+            timer_stop_ = true;
+            delayed_.clear();
+            timer_cv_.notify_all();
+        }
+        timer_thread_.join();
+        if (!wait) {
+            for (auto& worker : workers_) {
+                std::lock_guard<std::mutex> lock(worker->mu);
+                for (auto& queue : worker->queues) {
+                    pending_.fetch_sub(queue.size(), std::memory_order_acq_rel);
+                    queue.clear();
+                }
+            }
+        }
+        stop_.store(true, std::memory_order_release);
+        Wakeup(true);
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+    }
+
+    uint64_t PendingNum() const { return pending_.load(std::memory_order_acquire); }
+
+    uint32_t RunningNum(uint32_t cls) const {
+        return cls < running_.size() ? running_[cls].load(std::memory_order_acquire) : 0;
+    }
+
+ private:
+    struct Worker {
+        explicit Worker(size_t class_num) : queues(class_num) {}
+        std::mutex mu;
+        std::vector<std::deque<Task>> queues;
+    };
+
+    void Wakeup(bool all = false) {
+        std::lock_guard<std::mutex> lock(mu_);
+        version_++;
+        if (all) {
+            cv_.notify_all();
+        } else {
+            cv_.notify_one();
+        }
+    }
+
+    bool TryAcquire(uint32_t cls) {
+        uint32_t running = running_[cls].load(std::memory_order_acquire);
+        do {
+            if (caps_[cls] > 0 && running >= caps_[cls]) {
+                return false;
+            }
+        } while (!running_[cls].compare_exchange_weak(running, running + 1, std::memory_order_acq_rel));
+        return true;
+    }
+
+    // the own queue is taken from the front and the others from the back
+    bool PopTask(uint32_t idx, uint32_t cls, Task* task) {
+        for (uint32_t i = 0; i < workers_.size(); i++) {
+            auto& worker = workers_[(idx + i) % workers_.size()];
+            std::lock_guard<std::mutex> lock(worker->mu);
+            auto& queue = worker->queues[cls];
+            if (queue.empty()) {
+                continue;
+            }
+            if (i == 0) {
+                *task = std::move(queue.front());
+                queue.pop_front();
+            } else {
+                *task = std::move(queue.back());
+                queue.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool RunOne(uint32_t idx) {
+        for (uint32_t cls = 0; cls < caps_.size(); cls++) {
+            if (!TryAcquire(cls)) {
+                continue;
+            }
+            Task task;
+            if (!PopTask(idx, cls, &task)) {
+                running_[cls].fetch_sub(1, std::memory_order_acq_rel);
+                continue;
+            }
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+            task();
+            running_[cls].fetch_sub(1, std::memory_order_acq_rel);
+            // the task of a class at its cap may be runnable now, and the workers waiting for it exit once stopped
+            if (caps_[cls] > 0) {
+                bool stopped = stop_.load(std::memory_order_acquire);
+                if (stopped || pending_.load(std::memory_order_acquire) > 0) {
+                    Wakeup(stopped);
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void WorkerProc(uint32_t idx) {
+        t_scheduler = this;
+        t_worker_idx = idx;
+        while (true) {
+            uint64_t version = 0;
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                version = version_;
+            }
+            if (RunOne(idx)) {
+                continue;
+            }
+            if (stop_.load(std::memory_order_acquire) && pending_.load(std::memory_order_acquire) == 0) {
+                break;
+            }
+            std::unique_lock<std::mutex> lock(mu_);
+            cv_.wait(lock, [this, version] { return version_ != version; });
+        }
+        t_scheduler = nullptr;
+    }
+
+    void TimerProc() {
+        std::unique_lock<std::mutex> lock(timer_mu_);
+        while (!timer_stop_) {
+            if (delayed_.empty()) {
+                timer_cv_.wait(lock);
+                continue;
+            }
+            auto iter = delayed_.begin();
+            if (iter->first > std::chrono::steady_clock::now()) {
+                timer_cv_.wait_until(lock, iter->first);
+                continue;
+            }
+            auto item = std::move(iter->second);
+            delayed_.erase(iter);
+            lock.unlock();
+            AddTask(item.first, std::move(item.second));
+            lock.lock();
+        }
+    }
+
+    // the scheduler and the worker of the current thread
+    static inline thread_local TaskScheduler* t_scheduler = nullptr;
+    static inline thread_local uint32_t t_worker_idx = 0;
+
+    std::vector<uint32_t> caps_;
+    std::vector<std::atomic<uint32_t>> running_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<uint64_t> pending_{0};
+    std::atomic<uint32_t> next_worker_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex mu_;
+    std::condition_variable cv_;
+    uint64_t version_ = 0;
+
+    std::mutex timer_mu_;
+    std::condition_variable timer_cv_;
+    bool timer_stop_ = false;
+    std::multimap<std::chrono::steady_clock::time_point, std::pair<uint32_t, Task>> delayed_;
+    std::thread timer_thread_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_TASK_SCHEDULER_H_
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/task_scheduler.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class TaskSchedulerTest : public ::testing::Test {
+ public:
+    TaskSchedulerTest() {}
+    ~TaskSchedulerTest() {}
+};
+
+TEST_F(TaskSchedulerTest, RunAll) {
+    std::atomic<int> cnt{0};
+    TaskScheduler scheduler(4, {0, 0});
+    for (int i = 0; i < 1000; i++) {
+        scheduler.AddTask(i % 2, [&cnt] { cnt++; });
+    }
+    scheduler.Stop(true);
+    ASSERT_EQ(1000, cnt.load());
+    ASSERT_EQ(0u, scheduler.PendingNum());
+    // the tasks added after stop are dropped
+    scheduler.AddTask(0, [&cnt] { cnt++; });
+    ASSERT_EQ(1000, cnt.load());
+}
+
+TEST_F(TaskSchedulerTest, Cap) {
+    std::atomic<uint32_t> running{0};
+    std::atomic<uint32_t> max_running{0};
+    TaskScheduler scheduler(4, {1, 0});
+    for (int i = 0; i < 20; i++) {
+        scheduler.AddTask(0, [&running, &max_running] {
+            uint32_t cur = ++running;
+            uint32_t max = max_running.load();
+            while (cur > max && !max_running.compare_exchange_weak(max, cur)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            running--;
+        });
+    }
+    scheduler.Stop(true);
+    ASSERT_EQ(1u, max_running.load());
+}
+
+TEST_F(TaskSchedulerTest, Priority) {
+    std::vector<int> order;
+    std::atomic<bool> blocked{true};
+    TaskScheduler scheduler(1, {0, 0});
+    // keep the only worker busy until both classes are queued
+    scheduler.AddTask(1, [&blocked] {
+        while (blocked.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    while (scheduler.RunningNum(1) == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (int i = 0; i < 3; i++) {
+        scheduler.AddTask(1, [&order] { order.push_back(1); });
+        scheduler.AddTask(0, [&order] { order.push_back(0); });
+    }
+    blocked = false;
+    scheduler.Stop(true);
+    ASSERT_EQ(std::vector<int>({0, 0, 0, 1, 1, 1}), order);
+}
+
+TEST_F(TaskSchedulerTest, Steal) {
+    std::atomic<int> cnt{0};
+    std::atomic<bool> blocked{true};
+    TaskScheduler scheduler(2, {0});
+    // the tasks added by a worker go to its own queue and are stolen by the idle worker
+    scheduler.AddTask(0, [&scheduler, &cnt, &blocked] {
+        for (int i = 0; i < 10; i++) {
+            scheduler.AddTask(0, [&cnt] { cnt++; });
+        }
+        while (blocked.load() && cnt.load() < 10) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    for (int i = 0; i < 1000 && cnt.load() < 10; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(10, cnt.load());
+    blocked = false;
+    scheduler.Stop(true);
+}
+
+TEST_F(TaskSchedulerTest, DelayTask) {
+    std::atomic<int> cnt{0};
+    TaskScheduler scheduler(2, {0});
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int64_t> cost{0};
+    scheduler.DelayTask(0, 50, [&cnt, &cost, start] {
+        cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                   .count();
+        cnt++;
+    });
+    scheduler.DelayTask(0, 100000, [&cnt] { cnt++; });
+    for (int i = 0; i < 1000 && cnt.load() == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(1, cnt.load());
+    ASSERT_GE(cost.load(), 50);
+    // the delayed task not due is dropped
+    scheduler.Stop(true);
+    ASSERT_EQ(1, cnt.load());
+}
+
+TEST_F(TaskSchedulerTest, StopNoWait) {
+    std::atomic<int> cnt{0};
+    std::atomic<bool> blocked{true};
+    TaskScheduler scheduler(1, {0});
+    scheduler.AddTask(0, [&blocked] {
+        while (blocked.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    while (scheduler.RunningNum(0) == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (int i = 0; i < 10; i++) {
+        scheduler.AddTask(0, [&cnt] { cnt++; });
+    }
+    std::thread stop_thread([&scheduler] { scheduler.Stop(false); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    blocked = false;
+    stop_thread.join();
+    ASSERT_EQ(0, cnt.load());
+    ASSERT_EQ(0u, scheduler.PendingNum());
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
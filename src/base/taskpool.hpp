@@ -19,6 +19,7 @@
 
 #include <vector>
 #include <boost/function.hpp>
+#include "base/numa.h"
 #include "base/ringqueue.h"
 
 namespace openmldb {
@@ -30,6 +31,13 @@ class TaskPool {
         Start();
     }
 
+    // the threads are bound to the cpus, e.g. the cpus of one numa node, so the memory
+    // they touch first is allocated on the node
+    TaskPool(uint32_t thread_num, uint32_t qsize, const std::vector<uint32_t>& cpus)
+        : stop_(false), threads_num_(thread_num), queue_(qsize), cpus_(cpus) {
+        Start();
+    }
+
     ~TaskPool() { Stop(); }
     typedef boost::function<void()> Task;
 
@@ -69,12 +77,31 @@ class TaskPool {
         work_cv_.notify_one();
     }
 
+    // add the task without waiting, false if the queue is full or the pool is stopped
+    bool TryAddTask(const Task& task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.full() || stop_) {
+            return false;
+        }
+        queue_.put(task);
+        work_cv_.notify_one();
+        return true;
+    }
+
+    uint32_t GetQueueSize() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
  private:
     static void* ThreadWrapper(void* arg) {
         reinterpret_cast<TaskPool*>(arg)->ThreadProc();
         return NULL;
     }
     void ThreadProc() {
+        if (!cpus_.empty()) {
+            BindThreadToCpus(cpus_);
+        }
         while (true) {
             Task task;
             {
@@ -97,6 +124,7 @@ class TaskPool {
     uint32_t threads_num_;
     ::openmldb::base::RingQueue<Task> queue_;
     std::vector<pthread_t> tids_;
+    std::vector<uint32_t> cpus_;
     std::condition_variable work_cv_, queue_cv_;
     std::mutex mutex_;
 };
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_TOKEN_BUCKET_H_
+#define SRC_BASE_TOKEN_BUCKET_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+
+namespace openmldb {
+namespace base {
+
+// A token bucket to shape the total bandwidth of the concurrent senders, the
+// tokens are bytes and the bucket holds at most one second of them. A sender
+// may take more tokens than left and waits for the debt, so the later senders
+// wait behind it in order.
+class TokenBucket {
+ public:
+    TokenBucket() : rate_(0), tokens_(0), last_us_(0), mu_() {}
+    ~TokenBucket() {}
+    TokenBucket(const TokenBucket&) = delete;
+    TokenBucket& operator=(const TokenBucket&) = delete;
+
+    // rate is bytes per second and 0 means no limit
+    void SetRate(uint64_t rate) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (rate != rate_) {
+            rate_ = rate;
+            tokens_ = static_cast<int64_t>(rate);
+            last_us_ = 0;
+        }
+    }
+
+    // take bytes from the bucket at now_us and return the microseconds to wait
+    // before sending them
+    uint64_t Acquire(uint64_t bytes, uint64_t now_us) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (rate_ == 0) {
+            return 0;
+        }
+        RefillLocked(now_us);
+        tokens_ -= static_cast<int64_t>(bytes);
+        if (tokens_ >= 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(-tokens_) * 1000000 / rate_;
+    }
+
+    // take bytes from the bucket at now_us only if it holds them, the ones refused take no tokens
+    bool TryAcquire(uint64_t bytes, uint64_t now_us) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (rate_ == 0) {
+            return true;
+        }
+        RefillLocked(now_us);
+        if (tokens_ < static_cast<int64_t>(bytes)) {
+            return false;
+        }
+        tokens_ -= static_cast<int64_t>(bytes);
+        return true;
+    }
+
+ private:
+    void RefillLocked(uint64_t now_us) {
+        if (last_us_ == 0) {
+            last_us_ = now_us;
+        } else if (now_us > last_us_) {
+            uint64_t elapsed_us = std::min(now_us - last_us_, static_cast<uint64_t>(1000000));
+            tokens_ = std::min(tokens_ + static_cast<int64_t>(elapsed_us * rate_ / 1000000),
+                               static_cast<int64_t>(rate_));
+            last_us_ = now_us;
+        }
+    }
+
+    uint64_t rate_;
+    int64_t tokens_;
+    uint64_t last_us_;
+    std::mutex mu_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_TOKEN_BUCKET_H_
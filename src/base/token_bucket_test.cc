@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/token_bucket.h"
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class TokenBucketTest : public ::testing::Test {
+ public:
+    TokenBucketTest() {}
+    ~TokenBucketTest() {}
+};
+
+TEST_F(TokenBucketTest, NoLimit) {
+    TokenBucket bucket;
+    ASSERT_EQ(0u, bucket.Acquire(1 << 30, 1));
+    bucket.SetRate(1000);
+    bucket.SetRate(0);
+    ASSERT_EQ(0u, bucket.Acquire(1 << 30, 2));
+}
+
+TEST_F(TokenBucketTest, Acquire) {
+    TokenBucket bucket;
+    bucket.SetRate(1000);
+    // the bucket starts full
+    ASSERT_EQ(0u, bucket.Acquire(1000, 1000000));
+    // the debt of 500 bytes takes 0.5s
+    ASSERT_EQ(500000u, bucket.Acquire(500, 1000000));
+    // the next sender waits behind the debt
+    ASSERT_EQ(600000u, bucket.Acquire(100, 1000000));
+    // 0.6s refills the debt
+    ASSERT_EQ(0u, bucket.Acquire(0, 1600000));
+    // an idle bucket holds at most one second of tokens
+    ASSERT_EQ(0u, bucket.Acquire(1000, 100000000));
+    ASSERT_EQ(1000u, bucket.Acquire(1, 100000000));
+}
+
+TEST_F(TokenBucketTest, SharedRate) {
+    TokenBucket bucket;
+    bucket.SetRate(1000);
+    uint64_t now = 1000000;
+    ASSERT_EQ(0u, bucket.Acquire(1000, now));
+    // the concurrent senders of 100 bytes are queued at 1000 bytes per second in total
+    for (uint64_t i = 1; i <= 20; i++) {
+        ASSERT_EQ(i * 100000, bucket.Acquire(100, now));
+    }
+}
+
+TEST_F(TokenBucketTest, TryAcquire) {
+    TokenBucket bucket;
+    ASSERT_TRUE(bucket.TryAcquire(1 << 30, 1));
+    bucket.SetRate(1000);
+    ASSERT_TRUE(bucket.TryAcquire(800, 1000000));
+    // the refused take no tokens
+    ASSERT_FALSE(bucket.TryAcquire(300, 1000000));
+    ASSERT_TRUE(bucket.TryAcquire(200, 1000000));
+    ASSERT_FALSE(bucket.TryAcquire(1, 1000000));
+    // 0.1s refills 100 bytes
+    ASSERT_TRUE(bucket.TryAcquire(100, 1100000));
+    ASSERT_FALSE(bucket.TryAcquire(1, 1100000));
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
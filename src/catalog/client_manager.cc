@@ -16,12 +16,15 @@
 
 #include "catalog/client_manager.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "codec/fe_schema_codec.h"
 #include "codec/sql_rpc_row_codec.h"
 
 DECLARE_int32(request_timeout_ms);
+DECLARE_uint32(sub_query_conn_cnt);
+DECLARE_uint32(sub_query_max_in_flight);
 
 namespace openmldb {
 namespace catalog {
@@ -34,12 +37,41 @@ TabletRowHandler::TabletRowHandler(const std::string& db, openmldb::RpcCallback<
 TabletRowHandler::TabletRowHandler(::hybridse::base::Status status)
     : db_(), name_(), status_(status), row_(), callback_(nullptr) {}
 
+// the remote tablet is not told of the cancel, it aborts the sub query once the timeout sent with it passes
+template <typename Response>
+static void CancelRpc(openmldb::RpcCallback<Response>* callback) {
+    if (!callback->IsDone()) {
+        brpc::StartCancel(callback->GetController()->call_id());
+    }
+}
+
 TabletRowHandler::~TabletRowHandler() {
     if (callback_ != nullptr) {
+        if (status_.isRunning()) {
+            CancelRpc(callback_);
+        }
         callback_->UnRef();
     }
 }
 
+// decode the row answered by the sub query
+static ::hybridse::base::Status DecodeSubQueryRow(brpc::Controller* cntl,
+                                                  const openmldb::api::QueryResponse& response,
+                                                  ::hybridse::codec::Row* row) {
+    if (cntl->Failed()) {
+        return ::hybridse::base::Status(::hybridse::common::kRpcError, "request error. " + cntl->ErrorText());
+    }
+    if (cntl->response_attachment().size() <= codec::HEADER_LENGTH) {
+        return ::hybridse::base::Status(::hybridse::common::kSchemaCodecError, "response content decode fail");
+    }
+    *row = hybridse::codec::Row();
+    if (0 != response.byte_size() &&
+        !codec::DecodeRpcRow(cntl->response_attachment(), 0, response.byte_size(), response.row_slices(), row)) {
+        return ::hybridse::base::Status(::hybridse::common::kRpcError, "response content decode fail");
+    }
+    return ::hybridse::base::Status::OK();
+}
+
 const ::hybridse::codec::Row& TabletRowHandler::GetValue() {
     if (!status_.isRunning() || !callback_) {
         return row_;
@@ -52,23 +84,63 @@ const ::hybridse::codec::Row& TabletRowHandler::GetValue() {
     }
     DLOG(INFO) << "TabletRowHandler get value by brpc join";
     brpc::Join(cntl->call_id());
-    if (cntl->Failed()) {
-        status_ = ::hybridse::base::Status(::hybridse::common::kRpcError, "request error. " + cntl->ErrorText());
-        return row_;
+    status_ = DecodeSubQueryRow(cntl.get(), *response, &row_);
+    return row_;
+}
+
+HedgedRowHandler::HedgedRowHandler(const std::string& db, const ::openmldb::api::QueryRequest& request,
+                                   const butil::IOBuf& request_row, uint64_t timeout_ms,
+                                   const std::shared_ptr<::openmldb::client::TabletClient>& leader,
+                                   const std::shared_ptr<::openmldb::client::TabletClient>& follower,
+                                   const ::openmldb::api::FollowerRead& follower_read, uint64_t delay_us,
+                                   const std::shared_ptr<::openmldb::base::LatencyTracker>& tracker)
+    : db_(db),
+      name_(),
+      status_(::hybridse::base::Status::Running()),
+      row_(),
+      request_(request),
+      request_row_(request_row),
+      timeout_ms_(timeout_ms),
+      follower_(follower),
+      follower_read_(follower_read),
+      delay_us_(delay_us),
+      tracker_(tracker),
+      call_() {
+    if (!Send(Call::kPrimary, leader)) {
+        status_ = ::hybridse::base::Status(::hybridse::common::kRpcError, "send request failed");
     }
-    if (cntl->response_attachment().size() <= codec::HEADER_LENGTH) {
-        status_.code = hybridse::common::kSchemaCodecError;
-        status_.msg = "response content decode fail";
-        return row_;
+}
+
+bool HedgedRowHandler::Send(int idx, const std::shared_ptr<::openmldb::client::TabletClient>& client) {
+    auto callback = call_.NewCallback(idx);
+    callback->GetController()->request_attachment() = request_row_;
+    callback->GetController()->set_timeout_ms(timeout_ms_);
+    if (!client->SubQuery(request_, callback)) {
+        call_.SetSendFailed(idx);
+        return false;
     }
-    row_ = hybridse::codec::Row();
-    if (0 != response->byte_size() &&
-        !codec::DecodeRpcRow(cntl->response_attachment(), 0, response->byte_size(), response->row_slices(), &row_)) {
-        status_.code = hybridse::common::kRpcError;
-        status_.msg = "response content decode fail";
+    return true;
+}
+
+const ::hybridse::codec::Row& HedgedRowHandler::GetValue() {
+    if (!status_.isRunning()) {
         return row_;
     }
-    status_.code = ::hybridse::common::kOk;
+    // the delay counts from the sub query sent, the runner may read the row much later
+    if (!call_.WaitUntil(Call::kPrimary, delay_us_)) {
+        uint64_t elapsed_ms = call_.GetElapsed() / 1000;
+        if (elapsed_ms < timeout_ms_) {
+            DLOG(INFO) << "hedge the sub query to " << follower_->GetEndpoint();
+            // the request of the leader is serialized once sent, so it is reused
+            timeout_ms_ -= elapsed_ms;
+            request_.set_timeout_ms(timeout_ms_);
+            request_.mutable_follower_read()->CopyFrom(follower_read_);
+            Send(Call::kBackup, follower_);
+        }
+    }
+    int taken = call_.Wait();
+    tracker_->Add(call_.GetElapsed());
+    status_ = DecodeSubQueryRow(call_.GetController(taken).get(), *call_.GetResponse(taken), &row_);
     return row_;
 }
 
@@ -81,6 +153,15 @@ AsyncTableHandler::AsyncTableHandler(openmldb::RpcCallback<openmldb::api::SQLBat
     callback_->Ref();
 }
 
+AsyncTableHandler::~AsyncTableHandler() {
+    if (nullptr != callback_) {
+        if (status_.isRunning()) {
+            CancelRpc(callback_);
+        }
+        callback_->UnRef();
+    }
+}
+
 std::unique_ptr<hybridse::vm::RowIterator> AsyncTableHandler::GetIterator() {
     if (status_.isRunning()) {
         SyncRpcResponse();
@@ -210,58 +291,183 @@ bool AsyncTablesHandler::SyncAllTableHandlers() {
     return true;
 }
 
+// build the sub query of the row, the row is encoded to `request_row`
+static bool BuildSubQueryRequest(uint32_t task_id, const std::string& db, const std::string& sql,
+                                 const ::hybridse::codec::Row& row, const bool is_procedure, const bool is_debug,
+                                 const uint64_t timeout_ms, ::openmldb::api::QueryRequest* request,
+                                 butil::IOBuf* request_row) {
+    if (is_procedure) {
+        request->set_sp_name(sql);
+    } else {
+        request->set_sql(sql);
+    }
+    request->set_db(db);
+    request->set_is_batch(false);
+    request->set_task_id(task_id);
+    request->set_is_debug(is_debug);
+    request->set_is_procedure(is_procedure);
+    request->set_timeout_ms(timeout_ms);
+    if (!row.empty()) {
+        size_t row_size;
+        if (!codec::EncodeRpcRow(row, request_row, &row_size)) {
+            return false;
+        }
+        request->set_row_size(row_size);
+        request->set_row_slices(row.GetRowPtrCnt());
+    }
+    return true;
+}
+
+TabletClientPool::TabletClientPool(std::vector<std::shared_ptr<::openmldb::client::TabletClient>> clients)
+    : clients_(std::move(clients)),
+      in_flight_(new std::atomic<uint32_t>[clients_.size()]),
+      total_in_flight_(0),
+      turn_(0) {
+    for (uint32_t i = 0; i < clients_.size(); i++) {
+        in_flight_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::shared_ptr<TabletClientPool> TabletClientPool::Create(
+    const std::string& name, const std::shared_ptr<::openmldb::client::TabletClient>& client, uint32_t conn_cnt) {
+    std::vector<std::shared_ptr<::openmldb::client::TabletClient>> clients = {client};
+    for (uint32_t i = 1; i < conn_cnt; i++) {
+        auto extra = std::make_shared<::openmldb::client::TabletClient>(name, client->GetRealEndpoint());
+        extra->SetConnectionGroup("sub_query_" + std::to_string(i));
+        if (extra->Init() != 0) {
+            LOG(WARNING) << "open client failed. name " << name << ", endpoint " << client->GetRealEndpoint();
+            break;
+        }
+        clients.push_back(extra);
+    }
+    return std::make_shared<TabletClientPool>(std::move(clients));
+}
+
+uint32_t TabletClientPool::Pick() const {
+    uint32_t size = clients_.size();
+    if (size == 1) {
+        return 0;
+    }
+    // start from the next client in turn, so the idle clients are taken evenly
+    uint32_t start = turn_.fetch_add(1, std::memory_order_relaxed) % size;
+    uint32_t best = start;
+    uint32_t min = in_flight_[start].load(std::memory_order_relaxed);
+    for (uint32_t i = 1; i < size && min > 0; i++) {
+        uint32_t idx = (start + i) % size;
+        uint32_t cnt = in_flight_[idx].load(std::memory_order_relaxed);
+        if (cnt < min) {
+            min = cnt;
+            best = idx;
+        }
+    }
+    return best;
+}
+
+std::shared_ptr<::openmldb::client::TabletClient> TabletClientPool::Acquire(uint32_t max_in_flight, uint32_t* idx) {
+    if (total_in_flight_.fetch_add(1, std::memory_order_relaxed) >= max_in_flight && max_in_flight > 0) {
+        total_in_flight_.fetch_sub(1, std::memory_order_relaxed);
+        return std::shared_ptr<::openmldb::client::TabletClient>();
+    }
+    *idx = Pick();
+    in_flight_[*idx].fetch_add(1, std::memory_order_relaxed);
+    return clients_[*idx];
+}
+
+void TabletClientPool::Release(uint32_t idx) {
+    in_flight_[idx].fetch_sub(1, std::memory_order_relaxed);
+    total_in_flight_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+TabletAccessor::TabletAccessor(const std::string& name,
+                               const std::shared_ptr<::openmldb::client::TabletClient>& client)
+    : name_(name), pool_(TabletClientPool::Create(name, client, FLAGS_sub_query_conn_cnt)) {}
+
+bool TabletAccessor::UpdateClient(const std::string& endpoint) {
+    auto client = std::make_shared<::openmldb::client::TabletClient>(name_, endpoint);
+    if (client->Init() != 0) {
+        return false;
+    }
+    std::atomic_store_explicit(&pool_, TabletClientPool::Create(name_, client, FLAGS_sub_query_conn_cnt),
+                               std::memory_order_relaxed);
+    return true;
+}
+
+bool TabletAccessor::UpdateClient(const std::shared_ptr<::openmldb::client::TabletClient>& client) {
+    std::atomic_store_explicit(&pool_, TabletClientPool::Create(name_, client, FLAGS_sub_query_conn_cnt),
+                               std::memory_order_relaxed);
+    return true;
+}
+
 std::shared_ptr<::hybridse::vm::RowHandler> TabletAccessor::SubQuery(uint32_t task_id, const std::string& db,
                                                                      const std::string& sql,
                                                                      const ::hybridse::codec::Row& row,
-                                                                     const bool is_procedure, const bool is_debug) {
+                                                                     const bool is_procedure, const bool is_debug,
+                                                                     const uint64_t timeout_ms) {
     DLOG(INFO) << "SubQuery taskid: " << task_id << " is_procedure=" << is_procedure;
-    auto client = GetClient();
-    if (!client) {
+    auto pool = GetClientPool();
+    if (!pool) {
         return std::make_shared<TabletRowHandler>(
             ::hybridse::base::Status(::hybridse::common::kRpcError, "get client failed"));
     }
     ::openmldb::api::QueryRequest request;
-    if (is_procedure) {
-        request.set_sp_name(sql);
-    } else {
-        request.set_sql(sql);
-    }
-    request.set_db(db);
-    request.set_is_batch(false);
-    request.set_task_id(task_id);
-    request.set_is_debug(is_debug);
-    request.set_is_procedure(is_procedure);
     auto cntl = std::make_shared<brpc::Controller>();
-    if (!row.empty()) {
-        auto& io_buf = cntl->request_attachment();
-        size_t row_size;
-        if (!codec::EncodeRpcRow(row, &io_buf, &row_size)) {
-            return std::make_shared<TabletRowHandler>(
-                ::hybridse::base::Status(::hybridse::common::kRpcError, "encode row failed"));
-        }
-        request.set_row_size(row_size);
-        request.set_row_slices(row.GetRowPtrCnt());
+    if (!BuildSubQueryRequest(task_id, db, sql, row, is_procedure, is_debug, timeout_ms, &request,
+                              &cntl->request_attachment())) {
+        return std::make_shared<TabletRowHandler>(
+            ::hybridse::base::Status(::hybridse::common::kRpcError, "encode row failed"));
+    }
+    uint32_t idx = 0;
+    auto client = pool->Acquire(FLAGS_sub_query_max_in_flight, &idx);
+    if (!client) {
+        return std::make_shared<TabletRowHandler>(::hybridse::base::Status(
+            ::hybridse::common::kRpcError, "too many sub queries in flight to tablet " + name_));
     }
     auto response = std::make_shared<::openmldb::api::QueryResponse>();
-    cntl->set_timeout_ms(FLAGS_request_timeout_ms);
+    cntl->set_timeout_ms(timeout_ms > 0 ? timeout_ms : FLAGS_request_timeout_ms);
     auto callback = new openmldb::RpcCallback<openmldb::api::QueryResponse>(response, cntl);
+    callback->SetOnDone([pool, idx]() { pool->Release(idx); });
     auto row_handler = std::make_shared<TabletRowHandler>(db, callback);
     if (!client->SubQuery(request, callback)) {
+        pool->Release(idx);
         return std::make_shared<TabletRowHandler>(
             ::hybridse::base::Status(::hybridse::common::kRpcError, "send request failed"));
     }
     return row_handler;
 }
 
+std::shared_ptr<::hybridse::vm::RowHandler> HedgedTabletAccessor::SubQuery(uint32_t task_id, const std::string& db,
+                                                                           const std::string& sql,
+                                                                           const ::hybridse::codec::Row& row,
+                                                                           const bool is_procedure,
+                                                                           const bool is_debug,
+                                                                           const uint64_t timeout_ms) {
+    auto leader = leader_->GetClient();
+    auto follower = follower_->GetClient();
+    if (!leader || !follower) {
+        return leader_->SubQuery(task_id, db, sql, row, is_procedure, is_debug, timeout_ms);
+    }
+    ::openmldb::api::QueryRequest request;
+    butil::IOBuf request_row;
+    if (!BuildSubQueryRequest(task_id, db, sql, row, is_procedure, is_debug, timeout_ms, &request, &request_row)) {
+        return std::make_shared<TabletRowHandler>(
+            ::hybridse::base::Status(::hybridse::common::kRpcError, "encode row failed"));
+    }
+    uint64_t delay_us = std::max(tracker_->Get(), min_delay_us_);
+    return std::make_shared<HedgedRowHandler>(db, request, request_row,
+                                              timeout_ms > 0 ? timeout_ms : FLAGS_request_timeout_ms, leader, follower,
+                                              follower_read_, delay_us, tracker_);
+}
+
 std::shared_ptr<::hybridse::vm::TableHandler> TabletAccessor::SubQuery(uint32_t task_id, const std::string& db,
                                                                        const std::string& sql,
                                                                        const std::set<size_t>& common_column_indices,
                                                                        const std::vector<::hybridse::codec::Row>& rows,
                                                                        const bool request_is_common,
-                                                                       const bool is_procedure, const bool is_debug) {
+                                                                       const bool is_procedure, const bool is_debug,
+                                                                       const uint64_t timeout_ms) {
     DLOG(INFO) << "SubQuery batch request, taskid=" << task_id << ", is_procedure=" << is_procedure;
-    auto client = GetClient();
-    if (!client) {
+    auto pool = GetClientPool();
+    if (!pool) {
         return std::make_shared<hybridse::vm::ErrorTableHandler>(::hybridse::common::kRpcError, "get client failed");
     }
     auto cntl = std::make_shared<brpc::Controller>();
@@ -277,6 +483,7 @@ std::shared_ptr<::hybridse::vm::TableHandler> TabletAccessor::SubQuery(uint32_t
     request.set_db(db);
     request.set_task_id(task_id);
     request.set_is_debug(is_debug);
+    request.set_timeout_ms(timeout_ms);
     for (size_t idx : common_column_indices) {
         request.add_common_column_indices(idx);
     }
@@ -313,11 +520,19 @@ std::shared_ptr<::hybridse::vm::TableHandler> TabletAccessor::SubQuery(uint32_t
             request.set_non_common_slices(row.GetRowPtrCnt());
         }
     }
+    uint32_t idx = 0;
+    auto client = pool->Acquire(FLAGS_sub_query_max_in_flight, &idx);
+    if (!client) {
+        return std::make_shared<::hybridse::vm::ErrorTableHandler>(
+            ::hybridse::common::kRpcError, "too many sub queries in flight to tablet " + name_);
+    }
     auto response = std::make_shared<::openmldb::api::SQLBatchRequestQueryResponse>();
-    cntl->set_timeout_ms(FLAGS_request_timeout_ms);
+    cntl->set_timeout_ms(timeout_ms > 0 ? timeout_ms : FLAGS_request_timeout_ms);
     auto callback = new openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>(response, cntl);
+    callback->SetOnDone([pool, idx]() { pool->Release(idx); });
     auto async_table_handler = std::make_shared<AsyncTableHandler>(callback, request_is_common);
     if (!client->SubBatchRequestQuery(request, callback)) {
+        pool->Release(idx);
         LOG(WARNING) << "fail to query tablet";
         return std::make_shared<::hybridse::vm::ErrorTableHandler>(::hybridse::common::kRpcError,
                                                                    "fail to batch request query");
@@ -327,7 +542,8 @@ std::shared_ptr<::hybridse::vm::TableHandler> TabletAccessor::SubQuery(uint32_t
 std::shared_ptr<hybridse::vm::RowHandler> TabletsAccessor::SubQuery(uint32_t task_id, const std::string& db,
                                                                     const std::string& sql,
                                                                     const hybridse::codec::Row& row,
-                                                                    const bool is_procedure, const bool is_debug) {
+                                                                    const bool is_procedure, const bool is_debug,
+                                                                    const uint64_t timeout_ms) {
     return std::make_shared<::hybridse::vm::ErrorRowHandler>(::hybridse::common::kRpcError,
                                                              "TabletsAccessor Unsupport SubQuery with request");
 }
@@ -336,7 +552,8 @@ std::shared_ptr<hybridse::vm::TableHandler> TabletsAccessor::SubQuery(uint32_t t
                                                                       const std::set<size_t>& common_column_indices,
                                                                       const std::vector<hybridse::codec::Row>& rows,
                                                                       const bool request_is_common,
-                                                                      const bool is_procedure, const bool is_debug) {
+                                                                      const bool is_procedure, const bool is_debug,
+                                                                      const uint64_t timeout_ms) {
     auto tables_handler = std::make_shared<AsyncTablesHandler>();
     std::vector<std::vector<hybridse::vm::Row>> accessors_rows(accessors_.size());
     for (size_t idx = 0; idx < rows.size(); idx++) {
@@ -345,7 +562,7 @@ std::shared_ptr<hybridse::vm::TableHandler> TabletsAccessor::SubQuery(uint32_t t
     for (size_t idx = 0; idx < accessors_.size(); idx++) {
         tables_handler->AddAsyncRpcHandler(
             accessors_[idx]->SubQuery(task_id, db, sql, common_column_indices, accessors_rows[idx], request_is_common,
-                                      is_procedure, is_debug),
+                                      is_procedure, is_debug, timeout_ms),
             posinfos_[idx]);
     }
     return tables_handler;
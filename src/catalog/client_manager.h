@@ -17,6 +17,7 @@
 #ifndef SRC_CATALOG_CLIENT_MANAGER_H_
 #define SRC_CATALOG_CLIENT_MANAGER_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <set>
@@ -25,9 +26,11 @@
 #include <utility>
 #include <vector>
 
+#include "base/latency_tracker.h"
 #include "base/random.h"
 #include "base/spinlock.h"
 #include "client/tablet_client.h"
+#include "rpc/hedged_call.h"
 #include "storage/schema.h"
 #include "vm/catalog.h"
 #include "vm/mem_catalog.h"
@@ -60,11 +63,8 @@ class AsyncTableHandler : public ::hybridse::vm::MemTableHandler {
  public:
     explicit AsyncTableHandler(openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>* callback,
                                const bool is_common);
-    ~AsyncTableHandler() {
-        if (nullptr != callback_) {
-            callback_->UnRef();
-        }
-    }
+    // the rpc is cancelled if the rows are never read, e.g. the query is aborted
+    ~AsyncTableHandler();
     const uint64_t GetCount() override {
         if (status_.isRunning()) {
             SyncRpcResponse();
@@ -128,47 +128,146 @@ class AsyncTablesHandler : public ::hybridse::vm::MemTableHandler {
     std::vector<std::shared_ptr<TableHandler>> handlers_;
 };
 
+// TabletClientPool keeps the clients of one tablet, each but the first on its own connection group, so the
+// requests to the tablet don't queue on one socket. A request takes the client with the fewest requests in
+// flight, and the ties are taken in turn
+class TabletClientPool {
+ public:
+    explicit TabletClientPool(std::vector<std::shared_ptr<::openmldb::client::TabletClient>> clients);
+
+    // the first client is the one given, the others are opened to its endpoint. a client failing to open is left
+    // out of the pool
+    static std::shared_ptr<TabletClientPool> Create(const std::string& name,
+                                                    const std::shared_ptr<::openmldb::client::TabletClient>& client,
+                                                    uint32_t conn_cnt);
+
+    // the client with the fewest requests in flight
+    std::shared_ptr<::openmldb::client::TabletClient> Get() const { return clients_[Pick()]; }
+
+    // take the client with the fewest requests in flight and count one more request on it, NULL if there are
+    // max_in_flight requests in flight to the tablet already. 0 means no limit. Release idx once it is done
+    std::shared_ptr<::openmldb::client::TabletClient> Acquire(uint32_t max_in_flight, uint32_t* idx);
+    void Release(uint32_t idx);
+
+    uint32_t GetInFlight() const { return total_in_flight_.load(std::memory_order_relaxed); }
+    uint32_t GetSize() const { return clients_.size(); }
+
+ private:
+    uint32_t Pick() const;
+
+    std::vector<std::shared_ptr<::openmldb::client::TabletClient>> clients_;
+    std::unique_ptr<std::atomic<uint32_t>[]> in_flight_;
+    std::atomic<uint32_t> total_in_flight_;
+    mutable std::atomic<uint32_t> turn_;
+};
+
 class TabletAccessor : public ::hybridse::vm::Tablet {
  public:
-    explicit TabletAccessor(const std::string& name) : name_(name), tablet_client_() {}
+    explicit TabletAccessor(const std::string& name) : name_(name), pool_() {}
 
-    TabletAccessor(const std::string& name, const std::shared_ptr<::openmldb::client::TabletClient>& client)
-        : name_(name), tablet_client_(client) {}
+    TabletAccessor(const std::string& name, const std::shared_ptr<::openmldb::client::TabletClient>& client);
 
+    // the least loaded client of the pool
     std::shared_ptr<::openmldb::client::TabletClient> GetClient() {
-        return std::atomic_load_explicit(&tablet_client_, std::memory_order_relaxed);
+        auto pool = std::atomic_load_explicit(&pool_, std::memory_order_relaxed);
+        return pool ? pool->Get() : std::shared_ptr<::openmldb::client::TabletClient>();
     }
 
-    bool UpdateClient(const std::string& endpoint) {
-        auto client = std::make_shared<::openmldb::client::TabletClient>(name_, endpoint);
-        if (client->Init() != 0) {
-            return false;
-        }
-        std::atomic_store_explicit(&tablet_client_, client, std::memory_order_relaxed);
-        return true;
+    std::shared_ptr<TabletClientPool> GetClientPool() {
+        return std::atomic_load_explicit(&pool_, std::memory_order_relaxed);
     }
 
-    bool UpdateClient(const std::shared_ptr<::openmldb::client::TabletClient>& client) {
-        std::atomic_store_explicit(&tablet_client_, client, std::memory_order_relaxed);
-        return true;
-    }
+    bool UpdateClient(const std::string& endpoint);
+
+    bool UpdateClient(const std::shared_ptr<::openmldb::client::TabletClient>& client);
 
     std::shared_ptr<::hybridse::vm::RowHandler> SubQuery(uint32_t task_id, const std::string& db,
                                                          const std::string& sql, const ::hybridse::codec::Row& row,
-                                                         const bool is_procedure, const bool is_debug) override;
+                                                         const bool is_procedure, const bool is_debug,
+                                                         const uint64_t timeout_ms) override;
 
     std::shared_ptr<::hybridse::vm::TableHandler> SubQuery(uint32_t task_id, const std::string& db,
                                                            const std::string& sql,
                                                            const std::set<size_t>& common_column_indices,
                                                            const std::vector<::hybridse::codec::Row>& row,
                                                            const bool request_is_common, const bool is_procedure,
-                                                           const bool is_debug) override;
+                                                           const bool is_debug, const uint64_t timeout_ms) override;
     const std::string& GetName() const { return name_; }
 
  private:
     std::string name_;
-    std::shared_ptr<::openmldb::client::TabletClient> tablet_client_;
+    std::shared_ptr<TabletClientPool> pool_;
 };
+// HedgedRowHandler waits for the sub query of a row on the leader and, if it does not answer in the delay, sends
+// it to the follower, then takes the first successful answer
+class HedgedRowHandler : public ::hybridse::vm::RowHandler {
+ public:
+    HedgedRowHandler(const std::string& db, const ::openmldb::api::QueryRequest& request,
+                     const butil::IOBuf& request_row, uint64_t timeout_ms,
+                     const std::shared_ptr<::openmldb::client::TabletClient>& leader,
+                     const std::shared_ptr<::openmldb::client::TabletClient>& follower,
+                     const ::openmldb::api::FollowerRead& follower_read, uint64_t delay_us,
+                     const std::shared_ptr<::openmldb::base::LatencyTracker>& tracker);
+    const ::hybridse::vm::Schema* GetSchema() override { return nullptr; }
+    const std::string& GetName() override { return name_; }
+    const std::string& GetDatabase() override { return db_; }
+
+    ::hybridse::base::Status GetStatus() override { return status_; }
+    const ::hybridse::codec::Row& GetValue() override;
+
+ private:
+    using Call = ::openmldb::HedgedCall<::openmldb::api::QueryResponse>;
+    bool Send(int idx, const std::shared_ptr<::openmldb::client::TabletClient>& client);
+
+    std::string db_;
+    std::string name_;
+    ::hybridse::base::Status status_;
+    ::hybridse::codec::Row row_;
+    ::openmldb::api::QueryRequest request_;
+    butil::IOBuf request_row_;
+    uint64_t timeout_ms_;
+    std::shared_ptr<::openmldb::client::TabletClient> follower_;
+    ::openmldb::api::FollowerRead follower_read_;
+    uint64_t delay_us_;
+    std::shared_ptr<::openmldb::base::LatencyTracker> tracker_;
+    Call call_;
+};
+
+// HedgedTabletAccessor hedges the sub queries of a row on the leader of a partition to its follower, the batch
+// sub queries are sent to the leader only
+class HedgedTabletAccessor : public ::hybridse::vm::Tablet {
+ public:
+    HedgedTabletAccessor(const std::shared_ptr<TabletAccessor>& leader, const std::shared_ptr<TabletAccessor>& follower,
+                         const ::openmldb::api::FollowerRead& follower_read, uint64_t min_delay_us,
+                         const std::shared_ptr<::openmldb::base::LatencyTracker>& tracker)
+        : leader_(leader), follower_(follower), follower_read_(follower_read), min_delay_us_(min_delay_us),
+          tracker_(tracker) {}
+
+    const std::string& GetName() const { return leader_->GetName(); }
+
+    std::shared_ptr<::hybridse::vm::RowHandler> SubQuery(uint32_t task_id, const std::string& db,
+                                                         const std::string& sql, const ::hybridse::codec::Row& row,
+                                                         const bool is_procedure, const bool is_debug,
+                                                         const uint64_t timeout_ms) override;
+
+    std::shared_ptr<::hybridse::vm::TableHandler> SubQuery(uint32_t task_id, const std::string& db,
+                                                           const std::string& sql,
+                                                           const std::set<size_t>& common_column_indices,
+                                                           const std::vector<::hybridse::codec::Row>& rows,
+                                                           const bool request_is_common, const bool is_procedure,
+                                                           const bool is_debug, const uint64_t timeout_ms) override {
+        return leader_->SubQuery(task_id, db, sql, common_column_indices, rows, request_is_common, is_procedure,
+                                 is_debug, timeout_ms);
+    }
+
+ private:
+    std::shared_ptr<TabletAccessor> leader_;
+    std::shared_ptr<TabletAccessor> follower_;
+    ::openmldb::api::FollowerRead follower_read_;
+    uint64_t min_delay_us_;
+    std::shared_ptr<::openmldb::base::LatencyTracker> tracker_;
+};
+
 class TabletsAccessor : public ::hybridse::vm::Tablet {
  public:
     TabletsAccessor() : name_("TabletsAccessor"), rows_cnt_(0) {}
@@ -193,13 +292,13 @@ class TabletsAccessor : public ::hybridse::vm::Tablet {
     }
     std::shared_ptr<hybridse::vm::RowHandler> SubQuery(uint32_t task_id, const std::string& db, const std::string& sql,
                                                        const hybridse::codec::Row& row, const bool is_procedure,
-                                                       const bool is_debug) override;
+                                                       const bool is_debug, const uint64_t timeout_ms) override;
     std::shared_ptr<hybridse::vm::TableHandler> SubQuery(uint32_t task_id, const std::string& db,
                                                          const std::string& sql,
                                                          const std::set<size_t>& common_column_indices,
                                                          const std::vector<hybridse::codec::Row>& rows,
                                                          const bool request_is_common, const bool is_procedure,
-                                                         const bool is_debug);
+                                                         const bool is_debug, const uint64_t timeout_ms);
 
  private:
     const std::string name_;
@@ -218,6 +317,8 @@ class PartitionClientManager {
 
     std::shared_ptr<TabletAccessor> GetFollower();
 
+    inline const std::vector<std::shared_ptr<TabletAccessor>>& GetFollowers() const { return followers_; }
+
  private:
     uint32_t pid_;
     std::shared_ptr<TabletAccessor> leader_;
@@ -265,6 +366,21 @@ class TableClientManager {
         }
         return std::shared_ptr<TabletAccessor>();
     }
+    // a random follower of the partition, nullptr if it has none
+    std::shared_ptr<TabletAccessor> GetFollower(uint32_t pid) const {
+        auto partition_manager = GetPartitionClientManager(pid);
+        if (partition_manager) {
+            return partition_manager->GetFollower();
+        }
+        return std::shared_ptr<TabletAccessor>();
+    }
+    std::vector<std::shared_ptr<TabletAccessor>> GetFollowers(uint32_t pid) const {
+        auto partition_manager = GetPartitionClientManager(pid);
+        if (partition_manager) {
+            return partition_manager->GetFollowers();
+        }
+        return {};
+    }
     std::shared_ptr<TabletsAccessor> GetTablet(std::vector<uint32_t> pids) const {
         std::shared_ptr<TabletsAccessor> tablets_accessor = std::shared_ptr<TabletsAccessor>(new TabletsAccessor());
         for (size_t idx = 0; idx < pids.size(); idx++) {
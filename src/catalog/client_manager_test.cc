@@ -16,6 +16,8 @@
 
 #include "catalog/client_manager.h"
 
+#include <algorithm>
+
 #include "gtest/gtest.h"
 
 namespace openmldb {
@@ -72,6 +74,37 @@ TEST_F(ClientManagerTest, client_manager_test) {
               table_client_manager.GetPartitionClientManager(0)->GetLeader()->GetClient()->GetRealEndpoint());
 }
 
+TEST_F(ClientManagerTest, client_pool_test) {
+    std::vector<std::shared_ptr<::openmldb::client::TabletClient>> clients;
+    for (int i = 0; i < 3; i++) {
+        clients.push_back(std::make_shared<::openmldb::client::TabletClient>("name0", "endpoint0"));
+    }
+    TabletClientPool pool(clients);
+    ASSERT_EQ(3u, pool.GetSize());
+    // the requests in flight are spread over the clients
+    std::vector<uint32_t> idxs;
+    for (int i = 0; i < 3; i++) {
+        uint32_t idx = 0;
+        ASSERT_TRUE(pool.Acquire(4, &idx));
+        idxs.push_back(idx);
+    }
+    std::sort(idxs.begin(), idxs.end());
+    ASSERT_EQ(std::vector<uint32_t>({0, 1, 2}), idxs);
+    // the client released is the least loaded one
+    pool.Release(1);
+    ASSERT_EQ(clients[1], pool.Get());
+    uint32_t idx = 0;
+    ASSERT_EQ(clients[1], pool.Acquire(4, &idx));
+    ASSERT_EQ(1u, idx);
+    ASSERT_TRUE(pool.Acquire(4, &idx));
+    ASSERT_EQ(4u, pool.GetInFlight());
+    // the limit is reached
+    ASSERT_FALSE(pool.Acquire(4, &idx));
+    ASSERT_EQ(4u, pool.GetInFlight());
+    pool.Release(idx);
+    ASSERT_TRUE(pool.Acquire(4, &idx));
+}
+
 }  // namespace catalog
 }  // namespace openmldb
 
@@ -24,10 +24,22 @@ namespace catalog {
 
 constexpr uint32_t INVALID_PID = UINT32_MAX;
 
+static std::shared_ptr<RemotePage> TraversePage(std::shared_ptr<::openmldb::client::TabletClient> client,
+        uint32_t tid, uint32_t pid, const std::string& idx_name, const std::string& pk, uint64_t ts) {
+    auto page = std::make_shared<RemotePage>();
+    uint32_t count = 0;
+    DLOG(INFO) << "pid " << pid << " last pk " << pk << " key " << ts;
+    page->kv_it.reset(client->Traverse(tid, pid, idx_name, pk, ts, FLAGS_traverse_cnt_limit, false, count));
+    if (page->kv_it) {
+        page->response = page->kv_it->ShareResponse();
+    }
+    return page;
+}
+
 FullTableIterator::FullTableIterator(uint32_t tid, std::shared_ptr<Tables> tables,
         const std::map<uint32_t, std::shared_ptr<::openmldb::client::TabletClient>>& tablet_clients)
     : tid_(tid), tables_(tables), tablet_clients_(tablet_clients), in_local_(true), cur_pid_(INVALID_PID),
-    it_(), kv_it_(), key_(0), last_ts_(0), last_pk_(), value_() {
+    it_(), kv_it_(), key_(0), value_(), response_vec_(), prefetch_(), filter_() {
 }
 
 void FullTableIterator::SeekToFirst() {
@@ -49,10 +61,19 @@ void FullTableIterator::Next() {
 void FullTableIterator::Reset() {
     it_.reset();
     kv_it_.reset();
+    prefetch_.clear();
     cur_pid_ = INVALID_PID;
     in_local_ = true;
 }
 
+void FullTableIterator::Prefetch(uint32_t pid, const std::string& pk, uint64_t ts) {
+    auto iter = tablet_clients_.find(pid);
+    if (iter == tablet_clients_.end()) {
+        return;
+    }
+    prefetch_[pid] = std::async(std::launch::async, TraversePage, iter->second, tid_, pid, "", pk, ts);
+}
+
 void FullTableIterator::EndLocal() {
     in_local_ = false;
     cur_pid_ = INVALID_PID;
@@ -65,6 +86,7 @@ bool FullTableIterator::NextFromLocal() {
     }
     if (it_) {
         it_->Next();
+        SkipUnmatched();
         if (it_->Valid()) {
             key_ = it_->GetKey();
             return true;
@@ -90,6 +112,7 @@ bool FullTableIterator::NextFromLocal() {
         cur_pid_ = iter->first;
         it_.reset(iter->second->NewTraverseIterator(0));
         it_->SeekToFirst();
+        SkipUnmatched();
         if (it_->Valid()) {
             break;
         }
@@ -103,6 +126,19 @@ bool FullTableIterator::NextFromLocal() {
     return false;
 }
 
+void FullTableIterator::SkipUnmatched() {
+    if (!filter_) {
+        return;
+    }
+    while (it_->Valid()) {
+        const auto& value = it_->GetValue();
+        if (filter_->Match(reinterpret_cast<const int8_t*>(value.data()), value.size())) {
+            return;
+        }
+        it_->Next();
+    }
+}
+
 bool FullTableIterator::NextFromRemote() {
     if (tablet_clients_.empty()) {
         return false;
@@ -114,44 +150,35 @@ bool FullTableIterator::NextFromRemote() {
             return true;
         }
     }
-    auto iter = tablet_clients_.begin();
     if (cur_pid_ == INVALID_PID) {
-        cur_pid_ = iter->first;
-    } else {
-        iter = tablet_clients_.find(cur_pid_);
-    }
-    do {
-        if (iter == tablet_clients_.end()) {
-            return false;
+        // traverse all partitions at once, so the first pages take about one round trip
+        for (const auto& kv : tablet_clients_) {
+            Prefetch(kv.first, "", 0);
         }
+        cur_pid_ = tablet_clients_.begin()->first;
+    }
+    auto iter = tablet_clients_.find(cur_pid_);
+    while (iter != tablet_clients_.end()) {
         cur_pid_ = iter->first;
-        uint32_t count = 0;
-        if (kv_it_) {
-            if (!kv_it_->IsFinish()) {
-                DLOG(INFO) << "pid " << cur_pid_ << " last pk " << last_pk_ <<
-                    " key " << last_ts_ << " count " << count;
-                kv_it_.reset(iter->second->Traverse(tid_, cur_pid_, "", last_pk_, last_ts_,
-                            FLAGS_traverse_cnt_limit, false, count));
-            } else {
-                iter++;
-                kv_it_.reset();
-                continue;
-            }
-        } else {
-            kv_it_.reset(iter->second->Traverse(tid_, cur_pid_, "", "", 0, FLAGS_traverse_cnt_limit, false, count));
-            DLOG(INFO) << "count " << count;
+        auto page_iter = prefetch_.find(cur_pid_);
+        if (page_iter == prefetch_.end()) {
+            kv_it_.reset();
+            iter++;
+            continue;
+        }
+        std::shared_ptr<RemotePage> page = page_iter->second.get();
+        prefetch_.erase(page_iter);
+        kv_it_ = std::move(page->kv_it);
+        if (kv_it_ && !kv_it_->IsFinish()) {
+            Prefetch(cur_pid_, kv_it_->GetLastPK(), kv_it_->GetLastTS());
         }
         if (kv_it_ && kv_it_->Valid()) {
-            last_pk_ = kv_it_->GetLastPK();
-            last_ts_ = kv_it_->GetLastTS();
-            response_vec_.emplace_back(kv_it_->GetResponse());
+            response_vec_.emplace_back(page->response);
             key_ = kv_it_->GetKey();
-            break;
+            return true;
         }
-        iter++;
-        kv_it_.reset();
-    } while (true);
-    return true;
+    }
+    return false;
 }
 
 const ::hybridse::codec::Row& FullTableIterator::GetValue() {
@@ -168,9 +195,11 @@ const ::hybridse::codec::Row& FullTableIterator::GetValue() {
 
 DistributeWindowIterator::DistributeWindowIterator(uint32_t tid, uint32_t pid_num, std::shared_ptr<Tables> tables,
         uint32_t index, const std::string& index_name,
-        const std::map<uint32_t, std::shared_ptr<::openmldb::client::TabletClient>>& tablet_clients)
-    : tid_(tid), pid_num_(pid_num), tables_(tables), tablet_clients_(tablet_clients),
-    index_(index), index_name_(index_name),
+        const std::map<uint32_t, std::shared_ptr<::openmldb::client::TabletClient>>& tablet_clients,
+        std::shared_ptr<const ::openmldb::base::PartitionRouter> router)
+    : tid_(tid), pid_num_(pid_num),
+    router_(router ? std::move(router) : std::make_shared<::openmldb::base::PartitionRouter>(pid_num)),
+    tables_(tables), tablet_clients_(tablet_clients), index_(index), index_name_(index_name),
     cur_pid_(0), it_(), kv_it_() {}
 
 void DistributeWindowIterator::Reset() {
@@ -179,18 +208,40 @@ void DistributeWindowIterator::Reset() {
     cur_pid_ = INVALID_PID;
 }
 
+uint32_t DistributeWindowIterator::GetPid(const std::string& key) const {
+    if (pid_num_ > 0) {
+        return router_->GetPid(key);
+    }
+    return INVALID_PID;
+}
+
+void DistributeWindowIterator::Prefetch(const std::string& key) {
+    if (!tables_) {
+        return;
+    }
+    uint32_t pid = GetPid(key);
+    if (tables_->find(pid) != tables_->end()) {
+        return;
+    }
+    auto client_iter = tablet_clients_.find(pid);
+    if (client_iter == tablet_clients_.end()) {
+        return;
+    }
+    DLOG(INFO) << "prefetch key " << key << " from remote. pid " << pid;
+    prefetch_key_ = key;
+    prefetch_ = std::async(std::launch::async, TraversePage, client_iter->second, tid_, pid, index_name_, key, 0);
+}
+
 void DistributeWindowIterator::Seek(const std::string& key) {
     DLOG(INFO) << "seek to key " << key;
     Reset();
     if (!tables_) {
         return;
     }
-    if (pid_num_ > 0) {
-        cur_pid_ = (uint32_t)(::openmldb::base::hash64(key) % pid_num_);
-    }
+    cur_pid_ = GetPid(key);
     auto iter = tables_->find(cur_pid_);
     if (iter != tables_->end()) {
-        it_.reset(iter->second->NewWindowIterator(index_));
+        it_.reset(iter->second->NewPrunedWindowIterator(index_, hint_));
         it_->Seek(key);
         if (it_->Valid()) {
             return;
@@ -198,12 +249,19 @@ void DistributeWindowIterator::Seek(const std::string& key) {
     }
     DLOG(INFO) << "seek to key " << key << " from remote. " << " cur_pid " << cur_pid_;
     auto client_iter = tablet_clients_.find(cur_pid_);
-    if (client_iter != tablet_clients_.end()) {
+    if (prefetch_.valid() && prefetch_key_ == key) {
+        std::shared_ptr<RemotePage> page = prefetch_.get();
+        kv_it_ = std::move(page->kv_it);
+        if (kv_it_ && kv_it_->Valid()) {
+            response_vec_.emplace_back(page->response);
+            return;
+        }
+    } else if (client_iter != tablet_clients_.end()) {
         uint32_t count = 0;
         kv_it_.reset(client_iter->second->Traverse(tid_, cur_pid_, index_name_, key, 0,
                     FLAGS_traverse_cnt_limit, false, count));
         if (kv_it_ && kv_it_->Valid()) {
-            response_vec_.emplace_back(kv_it_->GetResponse());
+            response_vec_.emplace_back(kv_it_->ShareResponse());
             return;
         }
     }
@@ -211,7 +269,7 @@ void DistributeWindowIterator::Seek(const std::string& key) {
         if (kv.first <= cur_pid_) {
             continue;
         }
-        it_.reset(kv.second->NewWindowIterator(index_));
+        it_.reset(kv.second->NewPrunedWindowIterator(index_, hint_));
         it_->SeekToFirst();
         if (it_->Valid()) {
             cur_pid_ = kv.first;
@@ -227,7 +285,7 @@ void DistributeWindowIterator::SeekToFirst() {
         return;
     }
     for (const auto& kv : *tables_) {
-        it_.reset(kv.second->NewWindowIterator(index_));
+        it_.reset(kv.second->NewPrunedWindowIterator(index_, hint_));
         it_->SeekToFirst();
         if (it_->Valid()) {
             cur_pid_ = kv.first;
@@ -239,7 +297,7 @@ void DistributeWindowIterator::SeekToFirst() {
         cur_pid_ = kv.first;
         kv_it_.reset(kv.second->Traverse(tid_, cur_pid_, index_name_, "", 0, FLAGS_traverse_cnt_limit, false, count));
         if (kv_it_ && kv_it_->Valid()) {
-            response_vec_.emplace_back(kv_it_->GetResponse());
+            response_vec_.emplace_back(kv_it_->ShareResponse());
             return;
         }
     }
@@ -255,7 +313,7 @@ void DistributeWindowIterator::Next() {
                 return;
             }
             for (iter++; iter != tables_->end(); iter++) {
-                it_.reset(iter->second->NewWindowIterator(index_));
+                it_.reset(iter->second->NewPrunedWindowIterator(index_, hint_));
                 it_->SeekToFirst();
                 if (it_->Valid()) {
                     cur_pid_ = iter->first;
@@ -17,13 +17,15 @@
 #ifndef SRC_CATALOG_DISTRIBUTE_ITERATOR_H_
 #define SRC_CATALOG_DISTRIBUTE_ITERATOR_H_
 
+#include <future>  // NOLINT
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include "base/hash.h"
 #include "base/kv_iterator.h"
+#include "base/partition_router.h"
 #include "client/tablet_client.h"
 #include "storage/table.h"
 #include "vm/catalog.h"
@@ -33,6 +35,13 @@ namespace catalog {
 
 using Tables = std::map<uint32_t, std::shared_ptr<::openmldb::storage::Table>>;
 
+// one traverse page of a remote partition, the rows refer to the response and the attachment kept with it, so
+// the response is kept by the iterator
+struct RemotePage {
+    std::shared_ptr<::google::protobuf::Message> response;
+    std::unique_ptr<::openmldb::base::KvIterator> kv_it;
+};
+
 class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hybridse::codec::Row> {
  public:
     FullTableIterator(uint32_t tid, std::shared_ptr<Tables> tables,
@@ -46,11 +55,18 @@ class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hy
     // the key maybe the row num
     const uint64_t& GetKey() const override { return key_; }
 
+    // the local rows unmatched by `filter` are skipped. the remote rows are all returned
+    void SetFilter(std::shared_ptr<const ::openmldb::storage::RowFilter> filter) { filter_ = std::move(filter); }
+
  private:
     bool NextFromLocal();
+    // move it_ to the first matched row from the current one
+    void SkipUnmatched();
     bool NextFromRemote();
     void Reset();
     void EndLocal();
+    // traverse the page after pk and ts of the partition in background
+    void Prefetch(uint32_t pid, const std::string& pk, uint64_t ts);
 
  private:
     uint32_t tid_;
@@ -61,10 +77,12 @@ class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hy
     std::unique_ptr<::openmldb::storage::TableIterator> it_;
     std::unique_ptr<::openmldb::base::KvIterator> kv_it_;
     uint64_t key_;
-    uint64_t last_ts_;
-    std::string last_pk_;
     ::hybridse::codec::Row value_;
     std::vector<std::shared_ptr<::google::protobuf::Message>> response_vec_;
+    // the first pages of all remote partitions are requested at once, and then at most one page ahead of
+    // the consumed one is prefetched for each partition
+    std::map<uint32_t, std::future<std::shared_ptr<RemotePage>>> prefetch_;
+    std::shared_ptr<const ::openmldb::storage::RowFilter> filter_;
 };
 
 class RemoteWindowIterator : public ::hybridse::vm::RowIterator {
@@ -113,9 +131,12 @@ class RemoteWindowIterator : public ::hybridse::vm::RowIterator {
 
 class DistributeWindowIterator : public ::hybridse::codec::WindowIterator {
  public:
+    // the keys are routed to the partitions by router, which tells the splits of the table, or by hash % pid_num
+    // if it is not set
     DistributeWindowIterator(uint32_t tid, uint32_t pid_num, std::shared_ptr<Tables> tables,
             uint32_t index, const std::string& index_name,
-            const std::map<uint32_t, std::shared_ptr<::openmldb::client::TabletClient>>& tablet_clients);
+            const std::map<uint32_t, std::shared_ptr<::openmldb::client::TabletClient>>& tablet_clients,
+            std::shared_ptr<const ::openmldb::base::PartitionRouter> router = {});
     void Seek(const std::string& key) override;
     void SeekToFirst() override;
     void Next() override;
@@ -124,12 +145,21 @@ class DistributeWindowIterator : public ::hybridse::codec::WindowIterator {
     ::hybridse::codec::RowIterator* GetRawValue() override;
     const ::hybridse::codec::Row GetKey() override;
 
+    // start the traverse of a key in a remote partition in the background, the next Seek of
+    // the same key waits for it instead of sending the request
+    void Prefetch(const std::string& key);
+
+    // the local rows are read as `hint` tells. the remote rows are all returned as they are
+    void SetHint(::openmldb::storage::ScanHint hint) { hint_ = std::move(hint); }
+
  private:
     void Reset();
+    uint32_t GetPid(const std::string& key) const;
 
  private:
     uint32_t tid_;
     uint32_t pid_num_;
+    std::shared_ptr<const ::openmldb::base::PartitionRouter> router_;
     std::shared_ptr<Tables> tables_;
     std::map<uint32_t, std::shared_ptr<openmldb::client::TabletClient>> tablet_clients_;
     uint32_t index_;
@@ -138,6 +168,9 @@ class DistributeWindowIterator : public ::hybridse::codec::WindowIterator {
     std::unique_ptr<::hybridse::codec::WindowIterator> it_;
     std::shared_ptr<::openmldb::base::KvIterator> kv_it_;
     std::vector<std::shared_ptr<::google::protobuf::Message>> response_vec_;
+    std::string prefetch_key_;
+    std::future<std::shared_ptr<RemotePage>> prefetch_;
+    ::openmldb::storage::ScanHint hint_;
 };
 
 }  // namespace catalog
@@ -294,6 +294,61 @@ TEST_F(DistributeIteratorTest, TraverseLimit) {
     FLAGS_traverse_cnt_limit = old_limit;
 }
 
+TEST_F(DistributeIteratorTest, RemotePrefetchPages) {
+    uint32_t old_limit = FLAGS_traverse_cnt_limit;
+    // the pages end in the middle of the keys, so each partition is read in several prefetched pages
+    FLAGS_traverse_cnt_limit = 7;
+    uint32_t tid = 3;
+    FLAGS_db_root_path = "/tmp/" + ::openmldb::test::GenRand();
+    std::vector<std::string> endpoints = {"127.0.0.1:9230", "127.0.0.1:9231"};
+    brpc::Server tablet1;
+    ASSERT_TRUE(::openmldb::test::StartTablet(endpoints[0], &tablet1));
+    brpc::Server tablet2;
+    ASSERT_TRUE(::openmldb::test::StartTablet(endpoints[1], &tablet2));
+    auto client1 = std::make_shared<openmldb::client::TabletClient>(endpoints[0], endpoints[0]);
+    ASSERT_EQ(client1->Init(), 0);
+    auto client2 = std::make_shared<openmldb::client::TabletClient>(endpoints[1], endpoints[1]);
+    ASSERT_EQ(client2->Init(), 0);
+    std::vector<::openmldb::api::TableMeta> metas = {CreateTableMeta(tid, 1), CreateTableMeta(tid, 4)};
+    ASSERT_TRUE(client1->CreateTable(metas[0]));
+    ASSERT_TRUE(client2->CreateTable(metas[1]));
+    std::map<uint32_t, std::shared_ptr<openmldb::client::TabletClient>> tablet_clients = {{1, client1}, {4, client2}};
+    for (int i = 0; i < 5; i++) {
+        PutKey("first" + std::to_string(i), metas[0], client1);
+        PutKey("second" + std::to_string(i), metas[1], client2);
+    }
+    codec::SDKCodec codec(metas[0]);
+    FullTableIterator it(tid, {}, tablet_clients);
+    // stop in the middle of a partition while its next page is in flight, and start over
+    it.SeekToFirst();
+    for (int i = 0; i < 13; i++) {
+        ASSERT_TRUE(it.Valid());
+        it.Next();
+    }
+    it.SeekToFirst();
+    std::map<std::string, int> key_cnt;
+    bool in_second = false;
+    int count = 0;
+    while (it.Valid()) {
+        const auto& value = it.GetValue();
+        std::vector<std::string> row;
+        ASSERT_EQ(0, codec.DecodeRow(std::string(reinterpret_cast<const char*>(value.buf()), value.size()), &row));
+        // the rows are still streamed partition by partition
+        bool second = row[0].rfind("second", 0) == 0;
+        ASSERT_TRUE(second || !in_second) << row[0];
+        in_second = second;
+        key_cnt[row[0]]++;
+        count++;
+        it.Next();
+    }
+    ASSERT_EQ(count, 100);
+    ASSERT_EQ(key_cnt.size(), 10u);
+    for (const auto& kv : key_cnt) {
+        ASSERT_EQ(kv.second, 10) << kv.first;
+    }
+    FLAGS_traverse_cnt_limit = old_limit;
+}
+
 TEST_F(DistributeIteratorTest, WindowIterator) {
     uint32_t tid = 3;
     FLAGS_db_root_path = "/tmp/" + ::openmldb::test::GenRand();
@@ -342,6 +397,66 @@ TEST_F(DistributeIteratorTest, WindowIterator) {
     }
 }
 
+TEST_F(DistributeIteratorTest, WindowIteratorPrefetch) {
+    uint32_t tid = 3;
+    FLAGS_db_root_path = "/tmp/" + ::openmldb::test::GenRand();
+    auto tables = std::make_shared<Tables>();
+    tables->emplace(0, CreateTable(tid, 0));
+    tables->emplace(2, CreateTable(tid, 2));
+    std::vector<std::string> endpoints = {"127.0.0.1:9230", "127.0.0.1:9231"};
+    brpc::Server tablet1;
+    ASSERT_TRUE(::openmldb::test::StartTablet(endpoints[0], &tablet1));
+    brpc::Server tablet2;
+    ASSERT_TRUE(::openmldb::test::StartTablet(endpoints[1], &tablet2));
+    auto client1 = std::make_shared<openmldb::client::TabletClient>(endpoints[0], endpoints[0]);
+    ASSERT_EQ(client1->Init(), 0);
+    auto client2 = std::make_shared<openmldb::client::TabletClient>(endpoints[1], endpoints[1]);
+    ASSERT_EQ(client2->Init(), 0);
+    std::vector<::openmldb::api::TableMeta> metas = {CreateTableMeta(tid, 1), CreateTableMeta(tid, 3)};
+    ASSERT_TRUE(client1->CreateTable(metas[0]));
+    ASSERT_TRUE(client2->CreateTable(metas[1]));
+    std::map<uint32_t, std::shared_ptr<openmldb::client::TabletClient>> tablet_clients = {{1, client1}, {3, client2}};
+    std::vector<std::string> remote_keys;
+    for (int i = 0; i < 20; i++) {
+        std::string key = "card" + std::to_string(i);
+        uint32_t pid = (uint32_t)(::openmldb::base::hash64(key)) % 4;
+        if (pid % 2 == 0) {
+            PutKey(key, (*tables)[pid]);
+        } else {
+            PutKey(key, metas[pid == 1 ? 0 : 1], tablet_clients[pid]);
+            remote_keys.push_back(key);
+        }
+    }
+    ASSERT_LE(2u, remote_keys.size());
+    auto count_rows = [](DistributeWindowIterator* w_it, const std::string& key) {
+        w_it->Seek(key);
+        if (!w_it->Valid() || w_it->GetKey().ToString() != key) {
+            return -1;
+        }
+        std::unique_ptr<::hybridse::codec::RowIterator> it(w_it->GetRawValue());
+        it->SeekToFirst();
+        int count = 0;
+        while (it->Valid()) {
+            count++;
+            it->Next();
+        }
+        return count;
+    };
+    // the seek of the prefetched key takes the page fetched in the background, a local key is not prefetched
+    for (int i = 0; i < 20; i++) {
+        std::string key = "card" + std::to_string(i);
+        DistributeWindowIterator w_it(tid, 4, tables, 0, "card", tablet_clients);
+        w_it.Prefetch(key);
+        ASSERT_EQ(count_rows(&w_it, key), 10) << key;
+    }
+    // the seek of another key sends its own traverse, and the prefetched one is still used by its own seek
+    DistributeWindowIterator w_it(tid, 4, tables, 0, "card", tablet_clients);
+    w_it.Prefetch(remote_keys[0]);
+    ASSERT_EQ(count_rows(&w_it, remote_keys[1]), 10);
+    ASSERT_EQ(count_rows(&w_it, remote_keys[0]), 10);
+    ASSERT_EQ(count_rows(&w_it, remote_keys[0]), 10);
+}
+
 }  // namespace catalog
 }  // namespace openmldb
 
@@ -16,7 +16,6 @@
 
 #include "catalog/sdk_catalog.h"
 
-#include "base/hash.h"
 #include "glog/logging.h"
 #include "schema/index_util.h"
 #include "schema/schema_adapter.h"
@@ -29,6 +28,7 @@ SDKTableHandler::SDKTableHandler(const ::openmldb::nameserver::TableInfo& meta,
       schema_(),
       name_(meta.name()),
       db_(meta.db()),
+      router_(meta.table_partition_size(), meta.partition_split()),
       table_client_manager_(std::make_shared<TableClientManager>(meta.table_partition(), client_manager)) {}
 
 bool SDKTableHandler::Init() {
@@ -93,12 +93,7 @@ std::shared_ptr<::hybridse::vm::Tablet> SDKTableHandler::GetTablet(const std::st
     if (index_name.empty() || pk.empty()) {
         return std::shared_ptr<::hybridse::vm::Tablet>();
     }
-    uint32_t pid = 0;
-    uint32_t pid_num = meta_.table_partition_size();
-    if (pid_num > 0) {
-        pid = (uint32_t)(::openmldb::base::hash64(pk) % pid_num);
-    }
-    return table_client_manager_->GetTablet(pid);
+    return table_client_manager_->GetTablet(GetPid(pk));
 }
 
 std::shared_ptr<TabletAccessor> SDKTableHandler::GetTablet(uint32_t pid) {
@@ -141,6 +136,24 @@ bool SDKCatalog::Init(const std::vector<::openmldb::nameserver::TableInfo>& tabl
     return true;
 }
 
+bool SDKCatalog::Init(const SDKCatalog& base, const std::set<uint32_t>& changed_tids,
+                      const std::vector<::openmldb::nameserver::TableInfo>& tables, const Procedures& db_sp_map) {
+    for (const auto& db_kv : base.tables_) {
+        for (const auto& table_kv : db_kv.second) {
+            if (changed_tids.count(table_kv.second->GetTid()) == 0) {
+                tables_[db_kv.first].emplace(table_kv.first, table_kv.second);
+            }
+        }
+    }
+    for (const auto& table_meta : tables) {
+        auto db_it = tables_.find(table_meta.db());
+        if (db_it != tables_.end()) {
+            db_it->second.erase(table_meta.name());
+        }
+    }
+    return Init(tables, db_sp_map);
+}
+
 std::shared_ptr<::hybridse::vm::TableHandler> SDKCatalog::GetTable(const std::string& db,
                                                                    const std::string& table_name) {
     auto db_it = tables_.find(db);
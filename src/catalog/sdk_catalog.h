@@ -19,11 +19,13 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <mutex> // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "base/partition_router.h"
 #include "base/spinlock.h"
 #include "catalog/base.h"
 #include "catalog/client_manager.h"
@@ -74,12 +76,23 @@ class SDKTableHandler : public ::hybridse::vm::TableHandler {
 
     std::shared_ptr<TabletAccessor> GetTablet(uint32_t pid);
 
+    std::shared_ptr<TabletAccessor> GetFollower(uint32_t pid) { return table_client_manager_->GetFollower(pid); }
+
+    std::vector<std::shared_ptr<TabletAccessor>> GetFollowers(uint32_t pid) {
+        return table_client_manager_->GetFollowers(pid);
+    }
+
     bool GetTablet(std::vector<std::shared_ptr<TabletAccessor>>* tablets);
 
     inline uint32_t GetTid() const { return meta_.tid(); }
 
     inline uint32_t GetPartitionNum() const { return meta_.table_partition_size(); }
 
+    // the partition of the key by the splits of the table
+    inline uint32_t GetPid(const std::string& key) const { return router_.GetPid(key); }
+
+    inline const ::openmldb::base::PartitionRouter& GetRouter() const { return router_; }
+
     inline int32_t GetColumnIndex(const std::string& column) {
         auto it = types_.find(column);
         if (it != types_.end()) {
@@ -97,6 +110,7 @@ class SDKTableHandler : public ::hybridse::vm::TableHandler {
     ::hybridse::vm::IndexList index_list_;
     ::hybridse::vm::IndexHint index_hint_;
     uint64_t cnt_;
+    ::openmldb::base::PartitionRouter router_;
     std::shared_ptr<TableClientManager> table_client_manager_;
 };
 
@@ -113,6 +127,10 @@ class SDKCatalog : public ::hybridse::vm::Catalog {
 
     bool Init(const std::vector<::openmldb::nameserver::TableInfo>& tables, const Procedures& db_sp_map);
 
+    // share the table handlers of base except the changed ones, and create the handlers of tables
+    bool Init(const SDKCatalog& base, const std::set<uint32_t>& changed_tids,
+              const std::vector<::openmldb::nameserver::TableInfo>& tables, const Procedures& db_sp_map);
+
     std::shared_ptr<::hybridse::type::Database> GetDatabase(const std::string& db) override {
         return std::shared_ptr<::hybridse::type::Database>();
     }
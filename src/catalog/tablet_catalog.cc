@@ -16,12 +16,14 @@
 
 #include "catalog/tablet_catalog.h"
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
 #include <utility>
 
+#include "bthread/bthread.h"
 #include "catalog/distribute_iterator.h"
 #include "codec/list_iterator_codec.h"
 #include "glog/logging.h"
@@ -29,32 +31,71 @@
 #include "schema/schema_adapter.h"
 
 DECLARE_bool(enable_localtablet);
+DECLARE_uint32(sub_query_hedge_min_delay_ms);
+DECLARE_uint64(sub_query_hedge_max_lag);
 namespace openmldb {
 namespace catalog {
 
+static bthread_key_t CreateFollowerReadKey() {
+    bthread_key_t key;
+    bthread_key_create(&key, nullptr);
+    return key;
+}
+
+static bthread_key_t GetFollowerReadKey() {
+    static bthread_key_t key = CreateFollowerReadKey();
+    return key;
+}
+
+FollowerReadScope::FollowerReadScope(bool enabled) : enabled_(enabled), prev_(nullptr) {
+    if (enabled_) {
+        prev_ = bthread_getspecific(GetFollowerReadKey());
+        // any non null value marks the scope
+        bthread_setspecific(GetFollowerReadKey(), this);
+    }
+}
+
+FollowerReadScope::~FollowerReadScope() {
+    if (enabled_) {
+        bthread_setspecific(GetFollowerReadKey(), prev_);
+    }
+}
+
+bool FollowerReadScope::IsActive() { return bthread_getspecific(GetFollowerReadKey()) != nullptr; }
+
 TabletTableHandler::TabletTableHandler(const ::openmldb::api::TableMeta& meta,
                                        std::shared_ptr<hybridse::vm::Tablet> local_tablet)
     : partition_num_(meta.table_partition_size()),
       schema_(),
       table_st_(meta),
+      mu_(),
       tables_(std::make_shared<Tables>()),
+      follower_tables_(),
+      read_tables_(std::make_shared<Tables>()),
+      broadcast_(meta.broadcast()),
       types_(),
       index_list_(),
       index_hint_(),
       table_client_manager_(),
-      local_tablet_(local_tablet) {}
+      local_tablet_(local_tablet),
+      sub_query_latency_(std::make_shared<::openmldb::base::LatencyTracker>(95)) {}
 
 TabletTableHandler::TabletTableHandler(const ::openmldb::nameserver::TableInfo& meta,
                                        std::shared_ptr<hybridse::vm::Tablet> local_tablet)
     : partition_num_(meta.partition_num()),
       schema_(),
       table_st_(meta),
+      mu_(),
       tables_(std::make_shared<Tables>()),
+      follower_tables_(),
+      read_tables_(std::make_shared<Tables>()),
+      broadcast_(meta.broadcast()),
       types_(),
       index_list_(),
       index_hint_(),
       table_client_manager_(),
-      local_tablet_(local_tablet) {}
+      local_tablet_(local_tablet),
+      sub_query_latency_(std::make_shared<::openmldb::base::LatencyTracker>(95)) {}
 
 bool TabletTableHandler::Init(const ClientManager& client_manager) {
     bool ok = schema::SchemaAdapter::ConvertSchema(table_st_.GetColumns(), &schema_);
@@ -122,14 +163,52 @@ std::unique_ptr<::hybridse::codec::RowIterator> TabletTableHandler::GetIterator(
     return std::unique_ptr<::hybridse::codec::RowIterator>(GetRawIterator());
 }
 
+std::unique_ptr<::hybridse::vm::WindowIterator> TabletPartitionHandler::GetWindowIterator() {
+    DLOG(INFO) << "get window it with name " << index_name_;
+    if (columns_) {
+        auto tablet_handler = dynamic_cast<TabletTableHandler*>(table_handler_.get());
+        if (tablet_handler != nullptr) {
+            return tablet_handler->GetPrunedWindowIterator(index_name_, {columns_, {}});
+        }
+    }
+    return table_handler_->GetWindowIterator(index_name_);
+}
+
+std::unique_ptr<::hybridse::vm::WindowIterator> TabletPartitionHandler::GetFilteredWindowIterator(
+    const std::vector<::hybridse::vm::ColumnPredicate>& predicates) {
+    auto tablet_handler = dynamic_cast<TabletTableHandler*>(table_handler_.get());
+    if (tablet_handler == nullptr) {
+        return GetWindowIterator();
+    }
+    ::openmldb::storage::ScanHint hint{columns_, tablet_handler->CreateRowFilter(predicates)};
+    if (!hint.filter) {
+        return GetWindowIterator();
+    }
+    if (columns_) {
+        // the columns checked by the filter are decoded too
+        auto columns = std::make_shared<std::vector<bool>>(*columns_);
+        const auto& filter_columns = hint.filter->GetColumns();
+        for (size_t i = 0; i < filter_columns.size() && i < columns->size(); i++) {
+            (*columns)[i] = (*columns)[i] || filter_columns[i];
+        }
+        hint.columns = std::move(columns);
+    }
+    return tablet_handler->GetPrunedWindowIterator(index_name_, hint);
+}
+
 std::unique_ptr<::hybridse::codec::WindowIterator> TabletTableHandler::GetWindowIterator(const std::string& idx_name) {
+    return GetPrunedWindowIterator(idx_name, {});
+}
+
+std::unique_ptr<::hybridse::codec::WindowIterator> TabletTableHandler::GetPrunedWindowIterator(
+    const std::string& idx_name, const ::openmldb::storage::ScanHint& hint) {
     auto iter = index_hint_.find(idx_name);
     if (iter == index_hint_.end()) {
         LOG(WARNING) << "index name " << idx_name << " not exist";
         return std::unique_ptr<::hybridse::codec::WindowIterator>();
     }
     DLOG(INFO) << "get window it with index " << idx_name;
-    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    auto tables = GetReadTables();
     if (!tables) {
         LOG(WARNING) << " tables is null";
         return {};
@@ -144,8 +223,18 @@ std::unique_ptr<::hybridse::codec::WindowIterator> TabletTableHandler::GetWindow
         }
     }
     DLOG(INFO) << "table size " << tables->size() << " tablet_clients size " << tablet_clients.size();
-    return std::make_unique<DistributeWindowIterator>(GetTid(), partition_num_, tables,
-            iter->second.index, idx_name, tablet_clients);
+    // the usage of the index is counted once per query here, the remote partitions count it on traverse
+    if (!tables->empty()) {
+        auto& table = tables->begin()->second;
+        auto index_def = table->GetIndex(idx_name);
+        if (index_def) {
+            table->AddIndexQueryCnt(index_def->GetId());
+        }
+    }
+    auto window_it = std::make_unique<DistributeWindowIterator>(GetTid(), partition_num_, tables,
+            iter->second.index, idx_name, tablet_clients, table_st_.GetRouter());
+    window_it->SetHint(hint);
+    return window_it;
 }
 
 // TODO(chenjing): optimize Get(int pos) base segment
@@ -158,7 +247,7 @@ const ::hybridse::codec::Row TabletTableHandler::Get(int32_t pos) {
 }
 
 ::hybridse::codec::RowIterator* TabletTableHandler::GetRawIterator() {
-    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    auto tables = GetReadTables();
     std::map<uint32_t, std::shared_ptr<openmldb::client::TabletClient>> tablet_clients;
     for (uint32_t pid = 0; pid < partition_num_; pid++) {
         if (tables->count(pid) == 0) {
@@ -172,6 +261,60 @@ const ::hybridse::codec::Row TabletTableHandler::Get(int32_t pos) {
     return new catalog::FullTableIterator(GetTid(), tables, tablet_clients);
 }
 
+std::unique_ptr<::hybridse::codec::RowIterator> TabletTableHandler::GetFilteredIterator(
+    const std::vector<::hybridse::vm::ColumnPredicate>& predicates) {
+    auto filter = CreateRowFilter(predicates);
+    if (!filter) {
+        return GetIterator();
+    }
+    std::unique_ptr<::hybridse::codec::RowIterator> iter(GetRawIterator());
+    auto full_it = dynamic_cast<catalog::FullTableIterator*>(iter.get());
+    if (full_it != nullptr) {
+        full_it->SetFilter(std::move(filter));
+    }
+    return iter;
+}
+
+bool TabletTableHandler::GetIndexStatistics(const std::string& index_name, ::hybridse::vm::IndexStatistics* stats) {
+    auto tables = GetReadTables();
+    if (!tables || stats == nullptr) {
+        return false;
+    }
+    bool found = false;
+    ::hybridse::vm::IndexStatistics result;
+    for (const auto& kv : *tables) {
+        auto index_def = kv.second->GetIndex(index_name);
+        ::openmldb::storage::IndexStat stat;
+        if (!index_def || !kv.second->GetIndexStat(index_def->GetId(), &stat)) {
+            continue;
+        }
+        result.key_count += stat.key_cnt;
+        result.row_count += stat.record_cnt;
+        if (stat.max_ts > 0) {
+            auto min_ts = static_cast<int64_t>(stat.min_ts);
+            auto max_ts = static_cast<int64_t>(stat.max_ts);
+            bool has_ts = result.max_ts > 0;
+            result.min_ts = has_ts ? std::min(result.min_ts, min_ts) : min_ts;
+            result.max_ts = has_ts ? std::max(result.max_ts, max_ts) : max_ts;
+        }
+        found = true;
+    }
+    if (found) {
+        *stats = result;
+    }
+    return found;
+}
+
+std::shared_ptr<const ::openmldb::storage::RowFilter> TabletTableHandler::CreateRowFilter(
+    const std::vector<::hybridse::vm::ColumnPredicate>& predicates) {
+    auto tables = GetReadTables();
+    if (predicates.empty() || !tables || tables->empty()) {
+        return {};
+    }
+    // all the partitions share the schema versions
+    return ::openmldb::storage::RowFilter::Create(tables->begin()->second->GetAllVersionSchema(), predicates);
+}
+
 const uint64_t TabletTableHandler::GetCount() {
     auto iter = GetIterator();
     uint64_t cnt = 0;
@@ -198,32 +341,73 @@ std::shared_ptr<::hybridse::vm::PartitionHandler> TabletTableHandler::GetPartiti
     return std::make_shared<TabletPartitionHandler>(shared_from_this(), index_name);
 }
 
+std::shared_ptr<::hybridse::vm::PartitionHandler> TabletTableHandler::GetPrunedPartition(
+    const std::string& index_name, const std::vector<size_t>& columns) {
+    if (index_hint_.find(index_name) == index_hint_.cend()) {
+        LOG(WARNING) << "fail to get partition for tablet table handler, index name " << index_name;
+        return std::shared_ptr<::hybridse::vm::PartitionHandler>();
+    }
+    auto mask = std::make_shared<std::vector<bool>>(schema_.size(), false);
+    for (size_t idx : columns) {
+        if (idx >= mask->size()) {
+            return GetPartition(index_name);
+        }
+        (*mask)[idx] = true;
+    }
+    return std::make_shared<TabletPartitionHandler>(shared_from_this(), index_name, std::move(mask));
+}
+
+void TabletTableHandler::StoreTablesLocked(const std::shared_ptr<Tables>& tables) {
+    auto read_tables = std::make_shared<Tables>(*tables);
+    read_tables->insert(follower_tables_.begin(), follower_tables_.end());
+    std::atomic_store_explicit(&tables_, tables, std::memory_order_release);
+    std::atomic_store_explicit(&read_tables_, read_tables, std::memory_order_release);
+}
+
 void TabletTableHandler::AddTable(std::shared_ptr<::openmldb::storage::Table> table) {
-    std::shared_ptr<Tables> old_tables;
-    std::shared_ptr<Tables> new_tables;
-    do {
-        old_tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
-        new_tables = std::make_shared<Tables>(*old_tables);
-        new_tables->emplace(table->GetPid(), table);
-    } while (!atomic_compare_exchange_weak(&tables_, &old_tables, new_tables));
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto new_tables = std::make_shared<Tables>(*std::atomic_load_explicit(&tables_, std::memory_order_acquire));
+    new_tables->emplace(table->GetPid(), table);
+    follower_tables_.erase(table->GetPid());
+    StoreTablesLocked(new_tables);
+}
+
+void TabletTableHandler::AddFollowerTable(std::shared_ptr<::openmldb::storage::Table> table) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto new_tables = std::make_shared<Tables>(*std::atomic_load_explicit(&tables_, std::memory_order_acquire));
+    new_tables->erase(table->GetPid());
+    follower_tables_[table->GetPid()] = table;
+    StoreTablesLocked(new_tables);
+}
+
+void TabletTableHandler::CopyTables(TabletTableHandler* handler) {
+    std::shared_ptr<Tables> tables;
+    Tables follower_tables;
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(handler->mu_);
+        tables = std::atomic_load_explicit(&handler->tables_, std::memory_order_acquire);
+        follower_tables = handler->follower_tables_;
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    follower_tables_.swap(follower_tables);
+    StoreTablesLocked(std::make_shared<Tables>(*tables));
 }
 
 bool TabletTableHandler::HasLocalTable() {
-    return !std::atomic_load_explicit(&tables_, std::memory_order_acquire)->empty();
+    return !std::atomic_load_explicit(&read_tables_, std::memory_order_acquire)->empty();
 }
 
 int TabletTableHandler::DeleteTable(uint32_t pid) {
-    std::shared_ptr<Tables> old_tables;
-    std::shared_ptr<Tables> new_tables;
-    do {
-        old_tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
-        new_tables = std::make_shared<Tables>(*old_tables);
-        new_tables->erase(pid);
-    } while (!atomic_compare_exchange_weak(&tables_, &old_tables, new_tables));
-    return new_tables->size();
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto new_tables = std::make_shared<Tables>(*std::atomic_load_explicit(&tables_, std::memory_order_acquire));
+    new_tables->erase(pid);
+    follower_tables_.erase(pid);
+    StoreTablesLocked(new_tables);
+    return new_tables->size() + follower_tables_.size();
 }
 
 void TabletTableHandler::Update(const ::openmldb::nameserver::TableInfo& meta, const ClientManager& client_manager) {
+    broadcast_.store(meta.broadcast(), std::memory_order_relaxed);
     ::openmldb::storage::TableSt new_table_st(meta);
     for (const auto& partition_st : *(new_table_st.GetPartitions())) {
         uint32_t pid = partition_st.GetPid();
@@ -240,19 +424,28 @@ void TabletTableHandler::Update(const ::openmldb::nameserver::TableInfo& meta, c
 
 std::shared_ptr<::hybridse::vm::Tablet> TabletTableHandler::GetTablet(const std::string& index_name,
                                                                       const std::string& pk) {
-    uint32_t pid_num = table_st_.GetPartitionNum();
-    uint32_t pid = 0;
-    if (pid_num > 0) {
-        pid = (uint32_t)(::openmldb::base::hash64(pk) % pid_num);
-    }
-    DLOG(INFO) << "pid num " << pid_num << " get tablet with pid = " << pid;
-    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_relaxed);
+    uint32_t pid = table_st_.GetPid(pk);
+    DLOG(INFO) << "pid num " << table_st_.GetPartitionNum() << " get tablet with pid = " << pid;
+    auto tables = GetReadTables();
     // return local tablet only when --enable_localtablet==true
     if (FLAGS_enable_localtablet && tables->find(pid) != tables->end()) {
         DLOG(INFO) << "get tablet index_name " << index_name << ", pk " << pk << ", local_tablet_";
         return local_tablet_;
     }
     auto client_tablet = table_client_manager_->GetTablet(pid);
+    // the sub queries of a follower read are not hedged again
+    if (client_tablet && FLAGS_sub_query_hedge_min_delay_ms > 0 && !FollowerReadScope::IsActive()) {
+        auto follower = table_client_manager_->GetFollower(pid);
+        if (follower && follower->GetName() != client_tablet->GetName()) {
+            ::openmldb::api::FollowerRead follower_read;
+            follower_read.set_tid(GetTid());
+            follower_read.set_pid(pid);
+            follower_read.set_max_lag(FLAGS_sub_query_hedge_max_lag);
+            return std::make_shared<HedgedTabletAccessor>(client_tablet, follower, follower_read,
+                                                          FLAGS_sub_query_hedge_min_delay_ms * 1000ull,
+                                                          sub_query_latency_);
+        }
+    }
     if (!client_tablet) {
         DLOG(INFO) << "get tablet index_name " << index_name << ", pk " << pk << ", tablet nullptr";
     } else {
@@ -314,15 +507,8 @@ std::shared_ptr<::hybridse::vm::TableHandler> TabletCatalog::GetTable(const std:
     return it->second;
 }
 
-bool TabletCatalog::AddTable(const ::openmldb::api::TableMeta& meta,
-                             std::shared_ptr<::openmldb::storage::Table> table) {
-    if (!table) {
-        LOG(WARNING) << "input table is null";
-        return false;
-    }
+std::shared_ptr<TabletTableHandler> TabletCatalog::GetOrCreateHandlerLocked(const ::openmldb::api::TableMeta& meta) {
     const std::string& db_name = meta.db();
-    std::shared_ptr<TabletTableHandler> handler;
-    std::lock_guard<::openmldb::base::SpinMutex> spin_lock(mu_);
     auto db_it = tables_.find(db_name);
     if (db_it == tables_.end()) {
         auto result = tables_.emplace(db_name, std::map<std::string, std::shared_ptr<TabletTableHandler>>());
@@ -330,20 +516,48 @@ bool TabletCatalog::AddTable(const ::openmldb::api::TableMeta& meta,
     }
     const std::string& table_name = meta.name();
     auto it = db_it->second.find(table_name);
-    if (it == db_it->second.end()) {
-        handler = std::make_shared<TabletTableHandler>(meta, local_tablet_);
-        if (!handler->Init(client_manager_)) {
-            LOG(WARNING) << "tablet handler init failed";
-            return false;
-        }
-        db_it->second.emplace(table_name, handler);
-    } else {
-        handler = it->second;
+    if (it != db_it->second.end()) {
+        return it->second;
+    }
+    auto handler = std::make_shared<TabletTableHandler>(meta, local_tablet_);
+    if (!handler->Init(client_manager_)) {
+        LOG(WARNING) << "tablet handler init failed";
+        return {};
+    }
+    db_it->second.emplace(table_name, handler);
+    return handler;
+}
+
+bool TabletCatalog::AddTable(const ::openmldb::api::TableMeta& meta,
+                             std::shared_ptr<::openmldb::storage::Table> table) {
+    if (!table) {
+        LOG(WARNING) << "input table is null";
+        return false;
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> spin_lock(mu_);
+    auto handler = GetOrCreateHandlerLocked(meta);
+    if (!handler) {
+        return false;
     }
     handler->AddTable(table);
     return true;
 }
 
+bool TabletCatalog::AddFollowerTable(const ::openmldb::api::TableMeta& meta,
+                                     std::shared_ptr<::openmldb::storage::Table> table) {
+    if (!table) {
+        LOG(WARNING) << "input table is null";
+        return false;
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> spin_lock(mu_);
+    auto handler = GetOrCreateHandlerLocked(meta);
+    if (!handler) {
+        return false;
+    }
+    handler->AddFollowerTable(table);
+    return true;
+}
+
 bool TabletCatalog::AddDB(const ::hybridse::type::Database& db) {
     std::lock_guard<::openmldb::base::SpinMutex> spin_lock(mu_);
     TabletDB::iterator it = db_.find(db.name());
@@ -449,6 +663,17 @@ bool TabletCatalog::UpdateTableInfo(const ::openmldb::nameserver::TableInfo& tab
             }
             db_it->second.emplace(table_name, handler);
             LOG(INFO) << "add table " << table_name << " db " << db_name;
+        } else if (it->second->GetPartitionNum() != static_cast<uint32_t>(table_info.table_partition_size())) {
+            // a partition is split, the handler routing by the new partitions takes over the local ones
+            handler = std::make_shared<TabletTableHandler>(table_info, local_tablet_);
+            if (!handler->Init(client_manager_)) {
+                LOG(WARNING) << "tablet handler init failed";
+                return false;
+            }
+            handler->CopyTables(it->second.get());
+            it->second = handler;
+            LOG(INFO) << "update the partitions of table " << table_name << " db " << db_name << " to "
+                      << table_info.table_partition_size();
         } else {
             handler = it->second;
         }
@@ -501,6 +726,40 @@ void TabletCatalog::Refresh(const std::vector<::openmldb::nameserver::TableInfo>
     LOG(INFO) << "refresh catalog. version " << version;
 }
 
+void TabletCatalog::Refresh(const std::vector<::openmldb::nameserver::TableInfo>& changed_tables,
+                            const std::set<uint32_t>& deleted_tids, uint64_t version, const Procedures& db_sp_map) {
+    for (const auto& table_info : changed_tables) {
+        if (table_info.db().empty()) {
+            continue;
+        }
+        UpdateTableInfo(table_info);
+    }
+
+    std::lock_guard<::openmldb::base::SpinMutex> spin_lock(mu_);
+    if (!deleted_tids.empty()) {
+        for (auto db_it = tables_.begin(); db_it != tables_.end();) {
+            for (auto table_it = db_it->second.begin(); table_it != db_it->second.end();) {
+                if (deleted_tids.count(table_it->second->GetTid()) > 0 && !table_it->second->HasLocalTable()) {
+                    LOG(INFO) << "delete table from catalog. db: " << db_it->first << ", table: " << table_it->first;
+                    table_it = db_it->second.erase(table_it);
+                    continue;
+                }
+                ++table_it;
+            }
+            if (db_it->second.empty()) {
+                LOG(INFO) << "delete db from catalog. db: " << db_it->first;
+                db_it = tables_.erase(db_it);
+                continue;
+            }
+            ++db_it;
+        }
+    }
+    db_sp_map_ = db_sp_map;
+    version_.store(version, std::memory_order_relaxed);
+    LOG(INFO) << "refresh catalog. version " << version << ", changed table num " << changed_tables.size()
+              << ", deleted table num " << deleted_tids.size();
+}
+
 bool TabletCatalog::UpdateClient(const std::map<std::string, std::string>& real_ep_map) {
     return client_manager_.UpdateClient(real_ep_map);
 }
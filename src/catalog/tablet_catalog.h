@@ -17,8 +17,10 @@
 #ifndef SRC_CATALOG_TABLET_CATALOG_H_
 #define SRC_CATALOG_TABLET_CATALOG_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -40,10 +42,35 @@ class TabletPartitionHandler;
 class TabletTableHandler;
 class TabletSegmentHandler;
 
+// FollowerReadScope lets the query in the scope read the local follower partitions as if they were the leaders,
+// the hedged requests are served by the followers in it. The scope is bthread local, so it follows the query
+// switched to another worker, but not the work the query hands over to the other threads.
+class FollowerReadScope {
+ public:
+    explicit FollowerReadScope(bool enabled);
+    ~FollowerReadScope();
+    FollowerReadScope(const FollowerReadScope &) = delete;
+    FollowerReadScope &operator=(const FollowerReadScope &) = delete;
+
+    static bool IsActive();
+
+ private:
+    bool enabled_;
+    void *prev_;
+};
+
 class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
  public:
     TabletSegmentHandler(std::shared_ptr<::hybridse::vm::PartitionHandler> partition_handler, const std::string &key)
-        : TableHandler(), partition_handler_(partition_handler), key_(key) {}
+        : TableHandler(), partition_handler_(partition_handler), key_(key), window_it_() {
+        // the segment is created once the key is known, so issue the traverse of a remote key here.
+        // the windows of one request are fetched in parallel before the runner reads any of them
+        window_it_ = partition_handler_->GetWindowIterator();
+        auto dist_it = dynamic_cast<DistributeWindowIterator*>(window_it_.get());
+        if (dist_it) {
+            dist_it->Prefetch(key_);
+        }
+    }
 
     ~TabletSegmentHandler() {}
 
@@ -60,7 +87,7 @@ class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
     const ::hybridse::vm::OrderType GetOrderType() const override { return partition_handler_->GetOrderType(); }
 
     std::unique_ptr<::hybridse::vm::RowIterator> GetIterator() override {
-        auto iter = partition_handler_->GetWindowIterator();
+        auto iter = GetSeekIterator();
         if (iter) {
             DLOG(INFO) << "seek to pk " << key_;
             iter->Seek(key_);
@@ -74,7 +101,7 @@ class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
     }
 
     ::hybridse::vm::RowIterator *GetRawIterator() override {
-        auto iter = partition_handler_->GetWindowIterator();
+        auto iter = GetSeekIterator();
         if (iter) {
             DLOG(INFO) << "seek to pk " << key_;
             iter->Seek(key_);
@@ -91,6 +118,15 @@ class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
         return std::unique_ptr<::hybridse::vm::WindowIterator>();
     }
 
+    std::unique_ptr<::hybridse::vm::RowIterator> GetFilteredIterator(
+        const std::vector<::hybridse::vm::ColumnPredicate> &predicates) override {
+        // a prefetched iterator is not filtered, which is fine as the engine checks the rows anyway
+        if (!window_it_) {
+            window_it_ = partition_handler_->GetFilteredWindowIterator(predicates);
+        }
+        return GetIterator();
+    }
+
     const uint64_t GetCount() override {
         auto iter = GetIterator();
         if (!iter) return 0;
@@ -112,16 +148,27 @@ class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
     }
     const std::string GetHandlerTypeName() override { return "TabletSegmentHandler"; }
 
+ private:
+    // the prefetched iterator is used by the first seek only
+    std::unique_ptr<::hybridse::vm::WindowIterator> GetSeekIterator() {
+        if (window_it_) {
+            return std::move(window_it_);
+        }
+        return partition_handler_->GetWindowIterator();
+    }
+
  private:
     std::shared_ptr<::hybridse::vm::PartitionHandler> partition_handler_;
     std::string key_;
+    std::unique_ptr<::hybridse::vm::WindowIterator> window_it_;
 };
 
 class TabletPartitionHandler : public ::hybridse::vm::PartitionHandler,
                                public std::enable_shared_from_this<hybridse::vm::PartitionHandler> {
  public:
-    TabletPartitionHandler(std::shared_ptr<::hybridse::vm::TableHandler> table_hander, const std::string &index_name)
-        : PartitionHandler(), table_handler_(table_hander), index_name_(index_name) {}
+    TabletPartitionHandler(std::shared_ptr<::hybridse::vm::TableHandler> table_hander, const std::string &index_name,
+                           std::shared_ptr<const std::vector<bool>> columns = {})
+        : PartitionHandler(), table_handler_(table_hander), index_name_(index_name), columns_(std::move(columns)) {}
 
     ~TabletPartitionHandler() {}
 
@@ -137,10 +184,10 @@ class TabletPartitionHandler : public ::hybridse::vm::PartitionHandler,
 
     const ::hybridse::vm::IndexHint &GetIndex() override { return table_handler_->GetIndex(); }
 
-    std::unique_ptr<::hybridse::vm::WindowIterator> GetWindowIterator() override {
-        DLOG(INFO) << "get window it with name " << index_name_;
-        return table_handler_->GetWindowIterator(index_name_);
-    }
+    std::unique_ptr<::hybridse::vm::WindowIterator> GetWindowIterator() override;
+
+    std::unique_ptr<::hybridse::vm::WindowIterator> GetFilteredWindowIterator(
+        const std::vector<::hybridse::vm::ColumnPredicate> &predicates) override;
 
     const uint64_t GetCount() override {
         auto iter = GetWindowIterator();
@@ -162,6 +209,8 @@ class TabletPartitionHandler : public ::hybridse::vm::PartitionHandler,
  private:
     std::shared_ptr<::hybridse::vm::TableHandler> table_handler_;
     std::string index_name_;
+    // the columns read by the query, the local rows are decoded with them only if it is not null
+    std::shared_ptr<const std::vector<bool>> columns_;
 };
 
 class TabletTableHandler : public ::hybridse::vm::TableHandler,
@@ -188,6 +237,9 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
 
     const ::hybridse::vm::IndexHint &GetIndex() override { return index_hint_; }
 
+    // the statistics of the local partitions, which are collected on gc and snapshot
+    bool GetIndexStatistics(const std::string &index_name, ::hybridse::vm::IndexStatistics *stats) override;
+
     const ::hybridse::codec::Row Get(int32_t pos);
 
     std::unique_ptr<::hybridse::codec::RowIterator> GetIterator() override;
@@ -196,11 +248,24 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
 
     std::unique_ptr<::hybridse::codec::WindowIterator> GetWindowIterator(const std::string &idx_name) override;
 
+    // the local rows are read as `hint` tells
+    std::unique_ptr<::hybridse::codec::WindowIterator> GetPrunedWindowIterator(
+        const std::string &idx_name, const ::openmldb::storage::ScanHint &hint);
+
+    std::unique_ptr<::hybridse::codec::RowIterator> GetFilteredIterator(
+        const std::vector<::hybridse::vm::ColumnPredicate> &predicates) override;
+
+    // the filter of the predicates on the rows of the local partitions, nullptr if none of them can be checked
+    std::shared_ptr<const ::openmldb::storage::RowFilter> CreateRowFilter(
+        const std::vector<::hybridse::vm::ColumnPredicate> &predicates);
+
     const uint64_t GetCount() override;
 
     ::hybridse::codec::Row At(uint64_t pos) override;
 
     std::shared_ptr<::hybridse::vm::PartitionHandler> GetPartition(const std::string &index_name) override;
+    std::shared_ptr<::hybridse::vm::PartitionHandler> GetPrunedPartition(const std::string &index_name,
+                                                                         const std::vector<size_t> &columns) override;
     const std::string GetHandlerTypeName() override { return "TabletTableHandler"; }
 
     std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name, const std::string &pk) override;
@@ -209,10 +274,19 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
 
     inline int32_t GetTid() { return table_st_.GetTid(); }
 
+    inline uint32_t GetPartitionNum() const { return table_st_.GetPartitionNum(); }
+
     void AddTable(std::shared_ptr<::openmldb::storage::Table> table);
 
+    // the local follower partition is only read in FollowerReadScope, it replaces the leader of pid if any
+    void AddFollowerTable(std::shared_ptr<::openmldb::storage::Table> table);
+
+    // take the local leader and follower partitions of handler
+    void CopyTables(TabletTableHandler *handler);
+
     bool HasLocalTable();
 
+    // delete the local leader or follower partition, return the local partitions left
     int DeleteTable(uint32_t pid);
 
     void Update(const ::openmldb::nameserver::TableInfo &meta, const ClientManager &client_manager);
@@ -226,16 +300,35 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
         return -1;
     }
 
+    // the local partitions the query reads, the followers are included in FollowerReadScope or if the table is
+    // broadcast
+    std::shared_ptr<Tables> GetReadTables() {
+        return FollowerReadScope::IsActive() || broadcast_.load(std::memory_order_relaxed)
+                   ? std::atomic_load_explicit(&read_tables_, std::memory_order_acquire)
+                   : std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    }
+
+    void StoreTablesLocked(const std::shared_ptr<Tables> &tables);
+
  private:
     uint32_t partition_num_;
     ::hybridse::vm::Schema schema_;
     ::openmldb::storage::TableSt table_st_;
+    // the writers of the partitions are serialized by mu_, the readers load the snapshots
+    ::openmldb::base::SpinMutex mu_;
     std::shared_ptr<Tables> tables_;
+    Tables follower_tables_;
+    // the leaders and the followers
+    std::shared_ptr<Tables> read_tables_;
+    // every tablet keeps a replica, the local one is read even if it is a follower
+    std::atomic<bool> broadcast_;
     ::hybridse::vm::Types types_;
     ::hybridse::vm::IndexList index_list_;
     ::hybridse::vm::IndexHint index_hint_;
     std::shared_ptr<TableClientManager> table_client_manager_;
     std::shared_ptr<hybridse::vm::Tablet> local_tablet_;
+    // the latencies of the sub queries sent to the leaders to hedge them after
+    std::shared_ptr<::openmldb::base::LatencyTracker> sub_query_latency_;
 };
 
 typedef std::map<std::string, std::map<std::string, std::shared_ptr<TabletTableHandler>>> TabletTables;
@@ -265,6 +358,9 @@ class TabletCatalog : public ::hybridse::vm::Catalog {
 
     bool IndexSupport() override;
 
+    // add the local follower partition, which is read by the hedged requests only
+    bool AddFollowerTable(const ::openmldb::api::TableMeta &meta, std::shared_ptr<::openmldb::storage::Table> table);
+
     bool DeleteTable(const std::string &db, const std::string &table_name, uint32_t pid);
 
     bool DeleteDB(const std::string &db);
@@ -272,6 +368,10 @@ class TabletCatalog : public ::hybridse::vm::Catalog {
     void Refresh(const std::vector<::openmldb::nameserver::TableInfo> &table_info_vec, uint64_t version,
                  const Procedures &db_sp_map);
 
+    // update the changed tables and delete the dropped ones, the other tables are not touched
+    void Refresh(const std::vector<::openmldb::nameserver::TableInfo> &changed_tables,
+                 const std::set<uint32_t> &deleted_tids, uint64_t version, const Procedures &db_sp_map);
+
     bool AddProcedure(const std::string &db, const std::string &sp_name,
                       const std::shared_ptr<hybridse::sdk::ProcedureInfo> &sp_info);
 
@@ -302,6 +402,8 @@ class TabletCatalog : public ::hybridse::vm::Catalog {
     void RefreshAggrTables(const std::vector<::hybridse::vm::AggrTableInfo>& entries);
 
  private:
+    std::shared_ptr<TabletTableHandler> GetOrCreateHandlerLocked(const ::openmldb::api::TableMeta &meta);
+
     struct AggrTableKey {
         std::string base_db;
         std::string base_table;
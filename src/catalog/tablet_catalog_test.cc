@@ -688,6 +688,38 @@ TEST_F(TabletCatalogTest, get_tablet) {
     ASSERT_TRUE(real_tablet == nullptr);
 }
 
+TEST_F(TabletCatalogTest, follower_table) {
+    auto local_tablet =
+        std::make_shared<hybridse::vm::LocalTablet>(nullptr, std::shared_ptr<hybridse::vm::CompileInfoCache>());
+    uint32_t pid_num = 8;
+    TestArgs args = PrepareMultiPartitionTable("t1", pid_num);
+    auto handler = std::make_shared<TabletTableHandler>(args.meta[0], local_tablet);
+    ClientManager client_manager;
+    ASSERT_TRUE(handler->Init(client_manager));
+    handler->AddTable(args.tables[0]);
+    // key1 is in pid 6
+    handler->AddFollowerTable(args.tables[6]);
+    ASSERT_TRUE(std::dynamic_pointer_cast<hybridse::vm::LocalTablet>(handler->GetTablet("", "key1")) == nullptr);
+    {
+        FollowerReadScope scope(true);
+        ASSERT_TRUE(FollowerReadScope::IsActive());
+        ASSERT_TRUE(std::dynamic_pointer_cast<hybridse::vm::LocalTablet>(handler->GetTablet("", "key1")) != nullptr);
+        {
+            FollowerReadScope disabled(false);
+            ASSERT_TRUE(FollowerReadScope::IsActive());
+        }
+    }
+    ASSERT_FALSE(FollowerReadScope::IsActive());
+    // the follower changed to leader
+    handler->AddTable(args.tables[6]);
+    ASSERT_TRUE(std::dynamic_pointer_cast<hybridse::vm::LocalTablet>(handler->GetTablet("", "key1")) != nullptr);
+    handler->AddFollowerTable(args.tables[6]);
+    ASSERT_EQ(1, handler->DeleteTable(0));
+    ASSERT_TRUE(handler->HasLocalTable());
+    ASSERT_EQ(0, handler->DeleteTable(6));
+    ASSERT_FALSE(handler->HasLocalTable());
+}
+
 TEST_F(TabletCatalogTest, aggr_table_test) {
     std::shared_ptr<TabletCatalog> catalog(new TabletCatalog());
     ASSERT_TRUE(catalog->Init());
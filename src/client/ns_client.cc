@@ -484,6 +484,18 @@ bool NsClient::Migrate(const std::string& src_endpoint, const std::string& name,
     return false;
 }
 
+bool NsClient::SplitPartition(const std::string& name, uint32_t pid, std::string* msg) {
+    ::openmldb::nameserver::SplitPartitionRequest request;
+    ::openmldb::nameserver::GeneralResponse response;
+    request.set_name(name);
+    request.set_pid(pid);
+    request.set_db(GetDb());
+    bool ok = client_.SendRequest(&::openmldb::nameserver::NameServer_Stub::SplitPartition, &request, &response,
+                                  FLAGS_request_timeout_ms, 1);
+    *msg = response.msg();
+    return ok && response.code() == 0;
+}
+
 bool NsClient::RecoverEndpoint(const std::string& endpoint, bool need_restore, uint32_t concurrency, std::string& msg) {
     ::openmldb::nameserver::RecoverEndpointRequest request;
     ::openmldb::nameserver::GeneralResponse response;
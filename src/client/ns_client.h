@@ -164,6 +164,8 @@ class NsClient : public Client {
     bool Migrate(const std::string& src_endpoint, const std::string& name, const std::set<uint32_t>& pid_set,
                  const std::string& des_endpoint, std::string& msg);  // NOLINT
 
+    bool SplitPartition(const std::string& name, uint32_t pid, std::string* msg);
+
     bool RecoverEndpoint(const std::string& endpoint, bool need_restore, uint32_t concurrency,
                          std::string& msg);  // NOLINT
 
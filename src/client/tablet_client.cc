@@ -32,6 +32,7 @@ DECLARE_int32(request_timeout_ms);
 DECLARE_uint32(latest_ttl_max);
 DECLARE_uint32(absolute_ttl_max);
 DECLARE_bool(enable_show_tp);
+DECLARE_uint32(batch_request_compress_threshold);
 
 namespace openmldb {
 namespace client {
@@ -72,13 +73,21 @@ bool TabletClient::Query(const std::string& db, const std::string& sql, const st
 bool TabletClient::Query(const std::string& db, const std::string& sql,
                          const std::vector<openmldb::type::DataType>& parameter_types,
                          const std::string& parameter_row,
-                         brpc::Controller* cntl, ::openmldb::api::QueryResponse* response, const bool is_debug) {
+                         brpc::Controller* cntl, ::openmldb::api::QueryResponse* response, const bool is_debug,
+                         const bool is_profile, uint32_t chunk_bytes, bool snapshot_read) {
     if (cntl == NULL || response == NULL) return false;
     ::openmldb::api::QueryRequest request;
     request.set_sql(sql);
     request.set_db(db);
     request.set_is_batch(true);
     request.set_is_debug(is_debug);
+    request.set_is_profile(is_profile);
+    if (chunk_bytes > 0) {
+        request.set_chunk_bytes(chunk_bytes);
+    }
+    if (snapshot_read) {
+        request.set_snapshot_read(true);
+    }
     request.set_parameter_row_size(parameter_row.size());
     request.set_parameter_row_slices(1);
     for (auto& type : parameter_types) {
@@ -98,6 +107,54 @@ bool TabletClient::Query(const std::string& db, const std::string& sql,
     return true;
 }
 
+bool TabletClient::FetchQueryResult(uint64_t result_id, uint32_t chunk_bytes, brpc::Controller* cntl,
+                                    ::openmldb::api::QueryResponse* response) {
+    if (cntl == NULL || response == NULL) return false;
+    ::openmldb::api::QueryRequest request;
+    request.set_result_id(result_id);
+    request.set_chunk_bytes(chunk_bytes);
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::Query, cntl, &request, response);
+    if (!ok || response->code() != 0) {
+        LOG(WARNING) << "fail to fetch query result " << result_id << " from tablet";
+        return false;
+    }
+    return true;
+}
+
+bool TabletClient::PreparedQuery(const std::string& db, const std::string& sql, uint64_t statement_id,
+                                 const std::vector<openmldb::type::DataType>& parameter_types,
+                                 const std::string& parameter_row, brpc::Controller* cntl,
+                                 ::openmldb::api::QueryResponse* response) {
+    if (cntl == NULL || response == NULL) return false;
+    ::openmldb::api::QueryRequest request;
+    request.set_db(db);
+    request.set_is_batch(true);
+    if (statement_id != 0) {
+        request.set_statement_id(statement_id);
+    } else {
+        request.set_sql(sql);
+        request.set_prepare(true);
+        for (auto& type : parameter_types) {
+            request.add_parameter_types(type);
+        }
+    }
+    request.set_parameter_row_size(parameter_row.size());
+    request.set_parameter_row_slices(1);
+    auto& io_buf = cntl->request_attachment();
+    if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(parameter_row.data()), parameter_row.size(), &io_buf)) {
+        LOG(WARNING) << "Encode parameter buffer failed";
+        return false;
+    }
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::Query, cntl, &request, response);
+    if (!ok || response->code() != 0) {
+        if (response->code() != ::openmldb::base::kStatementNotFound) {
+            LOG(WARNING) << "fail to query tablet";
+        }
+        return false;
+    }
+    return true;
+}
+
 /**
  * Utility function to encode row batch data into rpc attachment buffer
  */
@@ -124,6 +181,13 @@ static bool EncodeRowBatch(std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch>
         request->add_row_sizes(non_common_slice->size());
         request->set_non_common_slices(1);
     }
+    if (FLAGS_batch_request_compress_threshold > 0 && io_buf->size() >= FLAGS_batch_request_compress_threshold) {
+        if (!codec::CompressRpcRows(io_buf)) {
+            LOG(WARNING) << "compress row batch failed";
+            return false;
+        }
+        request->set_compress_type(::openmldb::type::CompressType::kSnappy);
+    }
     return true;
 }
 
@@ -247,6 +311,17 @@ bool TabletClient::Put(uint32_t tid, uint32_t pid, uint64_t time, const std::str
 
 bool TabletClient::Put(uint32_t tid, uint32_t pid, uint64_t time, const std::string& value,
                        const std::vector<std::pair<std::string, uint32_t>>& dimensions, uint32_t format_version) {
+    auto status = PutRow(tid, pid, time, value, dimensions, format_version);
+    if (status.OK()) {
+        return true;
+    }
+    LOG(WARNING) << "fail to send write request for " << status.msg << " and error code " << status.code;
+    return false;
+}
+
+base::Status TabletClient::PutRow(uint32_t tid, uint32_t pid, uint64_t time, const std::string& value,
+                                  const std::vector<std::pair<std::string, uint32_t>>& dimensions,
+                                  uint32_t format_version) {
     ::openmldb::api::PutRequest request;
     request.set_time(time);
     request.set_value(value);
@@ -261,11 +336,10 @@ bool TabletClient::Put(uint32_t tid, uint32_t pid, uint64_t time, const std::str
     ::openmldb::api::PutResponse response;
     bool ok =
         client_.SendRequest(&::openmldb::api::TabletServer_Stub::Put, &request, &response, FLAGS_request_timeout_ms, 1);
-    if (ok && response.code() == 0) {
-        return true;
+    if (!ok) {
+        return {base::ReturnCode::kError, "fail to send put request"};
     }
-    LOG(WARNING) << "fail to send write request for " << response.msg() << " and error code " << response.code();
-    return false;
+    return {response.code(), response.msg()};
 }
 
 bool TabletClient::Put(uint32_t tid, uint32_t pid, const char* pk, uint64_t time, const char* value, uint32_t size,
@@ -568,6 +642,13 @@ bool TabletClient::GetTableStatus(::openmldb::api::GetTableStatusResponse& respo
     return false;
 }
 
+bool TabletClient::GetTableStatus(uint32_t tid, ::openmldb::api::GetTableStatusResponse& response) {
+    ::openmldb::api::GetTableStatusRequest request;
+    request.set_tid(tid);
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::GetTableStatus, &request, &response,
+                               FLAGS_request_timeout_ms, 1);
+}
+
 bool TabletClient::GetTableStatus(uint32_t tid, uint32_t pid, ::openmldb::api::TableStatus& table_status) {
     return GetTableStatus(tid, pid, false, table_status);
 }
@@ -932,6 +1013,41 @@ bool TabletClient::Get(uint32_t tid, uint32_t pid, const std::string& pk, uint64
     return true;
 }
 
+bool TabletClient::BatchGet(const ::openmldb::api::BatchGetRequest& request,
+                            ::openmldb::api::BatchGetResponse* response) {
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::BatchGet, &request, response,
+                                  FLAGS_request_timeout_ms, 1);
+    return ok && response->code() == 0;
+}
+
+bool TabletClient::AsyncBatchGet(const ::openmldb::api::BatchGetRequest& request,
+                                 openmldb::RpcCallback<openmldb::api::BatchGetResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::BatchGet, callback->GetController().get(),
+                               &request, callback->GetResponse().get(), callback);
+}
+
+bool TabletClient::AsyncHeartbeat(uint32_t lease_timeout,
+                                  openmldb::RpcCallback<openmldb::api::GeneralResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    ::openmldb::api::HeartbeatRequest request;
+    request.set_lease_timeout(lease_timeout);
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::Heartbeat, callback->GetController().get(),
+                               &request, callback->GetResponse().get(), callback);
+}
+
+bool TabletClient::AsyncBatchPut(const ::openmldb::api::BatchPutRequest& request, brpc::Controller* cntl,
+                                 ::openmldb::api::BatchPutResponse* response, google::protobuf::Closure* done) {
+    if (cntl == nullptr || response == nullptr || done == nullptr) {
+        return false;
+    }
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::BatchPut, cntl, &request, response, done);
+}
+
 bool TabletClient::Delete(uint32_t tid, uint32_t pid, const std::string& pk, const std::string& idx_name,
                           std::string& msg) {
     ::openmldb::api::DeleteRequest request;
@@ -953,6 +1069,30 @@ bool TabletClient::Delete(uint32_t tid, uint32_t pid, const std::string& pk, con
     return true;
 }
 
+bool TabletClient::DeleteBatch(uint32_t tid, uint32_t pid, const std::vector<std::string>& keys,
+                               const std::string& idx_name, uint32_t* deleted_cnt, std::string* msg) {
+    ::openmldb::api::DeleteBatchRequest request;
+    ::openmldb::api::GeneralResponse response;
+    request.set_tid(tid);
+    request.set_pid(pid);
+    for (const auto& key : keys) {
+        request.add_keys(key);
+    }
+    if (!idx_name.empty()) {
+        request.set_idx_name(idx_name);
+    }
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::DeleteBatch, &request, &response,
+                                  FLAGS_request_timeout_ms, 1);
+    if (response.has_msg()) {
+        msg->assign(response.msg());
+    }
+    if (!ok || response.code() != 0) {
+        return false;
+    }
+    *deleted_cnt = response.count();
+    return true;
+}
+
 bool TabletClient::ConnectZK() {
     ::openmldb::api::ConnectZKRequest request;
     ::openmldb::api::GeneralResponse response;
@@ -992,6 +1132,12 @@ bool TabletClient::DeleteBinlog(uint32_t tid, uint32_t pid, openmldb::common::St
 ::openmldb::base::KvIterator* TabletClient::Traverse(uint32_t tid, uint32_t pid, const std::string& idx_name,
                                                      const std::string& pk, uint64_t ts, uint32_t limit,
                                                      bool need_clean, uint32_t& count) {
+    return Traverse(tid, pid, idx_name, pk, ts, limit, need_clean, nullptr, count);
+}
+
+::openmldb::base::KvIterator* TabletClient::Traverse(uint32_t tid, uint32_t pid, const std::string& idx_name,
+                                                     const std::string& pk, uint64_t ts, uint32_t limit,
+                                                     bool need_clean, uint64_t* cursor_id, uint32_t& count) {
     ::openmldb::api::TraverseRequest request;
     ::openmldb::api::TraverseResponse* response = new ::openmldb::api::TraverseResponse();
     request.set_tid(tid);
@@ -1004,12 +1150,30 @@ bool TabletClient::DeleteBinlog(uint32_t tid, uint32_t pid, openmldb::common::St
         request.set_pk(pk);
         request.set_ts(ts);
     }
-    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::Traverse, &request, response,
-                                  FLAGS_request_timeout_ms, FLAGS_request_max_retry);
+    request.set_use_attachment(true);
+    if (cursor_id != nullptr) {
+        request.set_use_cursor(true);
+        if (*cursor_id > 0) {
+            request.set_cursor_id(*cursor_id);
+        }
+    }
+    butil::IOBuf attachment;
+    bool ok = client_.SendRequestGetAttachment(&::openmldb::api::TabletServer_Stub::Traverse, &request, response,
+                                               FLAGS_request_timeout_ms, FLAGS_request_max_retry, &attachment);
     if (!ok || response->code() != 0) {
+        delete response;
         return NULL;
     }
-    ::openmldb::base::KvIterator* kv_it = new ::openmldb::base::KvIterator(response, need_clean);
+    if (cursor_id != nullptr) {
+        *cursor_id = response->cursor_id();
+    }
+    ::openmldb::base::KvIterator* kv_it = nullptr;
+    // the tablets not knowing use_attachment still put the pairs in the response
+    if (response->has_buf_size()) {
+        kv_it = new ::openmldb::base::KvIterator(response, &attachment, need_clean);
+    } else {
+        kv_it = new ::openmldb::base::KvIterator(response, need_clean);
+    }
     count = response->count();
     return kv_it;
 }
@@ -1020,6 +1184,30 @@ bool TabletClient::DeleteBinlog(uint32_t tid, uint32_t pid, openmldb::common::St
     return Traverse(tid, pid, idx_name, pk, ts, limit, true, count);
 }
 
+bool TabletClient::GetBulkLoadInfo(uint32_t tid, uint32_t pid, ::openmldb::api::BulkLoadInfoResponse* response) {
+    ::openmldb::api::BulkLoadInfoRequest request;
+    request.set_tid(tid);
+    request.set_pid(pid);
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::GetBulkLoadInfo, &request, response,
+                                  FLAGS_request_timeout_ms, FLAGS_request_max_retry);
+    if (!ok || response->code() != 0) {
+        return false;
+    }
+    return true;
+}
+
+base::Status TabletClient::BulkLoad(const ::openmldb::api::BulkLoadRequest& request, const std::string& attachment) {
+    brpc::Controller cntl;
+    cntl.set_timeout_ms(FLAGS_request_timeout_ms);
+    cntl.request_attachment().append(attachment);
+    ::openmldb::api::GeneralResponse response;
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::BulkLoad, &cntl, &request, &response);
+    if (!ok) {
+        return {base::ReturnCode::kError, "fail to send bulk load request, " + cntl.ErrorText()};
+    }
+    return {response.code(), response.msg()};
+}
+
 bool TabletClient::SetMode(bool mode) {
     ::openmldb::api::SetModeRequest request;
     ::openmldb::api::GeneralResponse response;
@@ -1130,6 +1318,49 @@ bool TabletClient::DumpIndexData(uint32_t tid, uint32_t pid, uint32_t partition_
     return true;
 }
 
+bool TabletClient::SplitTable(
+    uint32_t tid, uint32_t pid, uint32_t child_pid, uint32_t partition_num,
+    const ::google::protobuf::RepeatedPtrField<::openmldb::common::PartitionSplit>& partition_split,
+    std::shared_ptr<TaskInfo> task_info) {
+    ::openmldb::api::SplitTableRequest request;
+    ::openmldb::api::GeneralResponse response;
+    request.set_tid(tid);
+    request.set_pid(pid);
+    request.set_child_pid(child_pid);
+    request.set_partition_num(partition_num);
+    request.mutable_partition_split()->CopyFrom(partition_split);
+    if (task_info) {
+        request.mutable_task_info()->CopyFrom(*task_info);
+    }
+    bool ok = client_.SendRequest(&openmldb::api::TabletServer_Stub::SplitTable, &request, &response,
+                                  FLAGS_request_timeout_ms, 1);
+    if (!ok || response.code() != 0) {
+        return false;
+    }
+    return true;
+}
+
+bool TabletClient::DeleteSplitData(
+    uint32_t tid, uint32_t pid, uint32_t partition_num,
+    const ::google::protobuf::RepeatedPtrField<::openmldb::common::PartitionSplit>& partition_split,
+    std::shared_ptr<TaskInfo> task_info) {
+    ::openmldb::api::DeleteSplitDataRequest request;
+    ::openmldb::api::GeneralResponse response;
+    request.set_tid(tid);
+    request.set_pid(pid);
+    request.set_partition_num(partition_num);
+    request.mutable_partition_split()->CopyFrom(partition_split);
+    if (task_info) {
+        request.mutable_task_info()->CopyFrom(*task_info);
+    }
+    bool ok = client_.SendRequest(&openmldb::api::TabletServer_Stub::DeleteSplitData, &request, &response,
+                                  FLAGS_request_timeout_ms, 1);
+    if (!ok || response.code() != 0) {
+        return false;
+    }
+    return true;
+}
+
 bool TabletClient::SendIndexData(uint32_t tid, uint32_t pid, const std::map<uint32_t, std::string>& pid_endpoint_map,
                                  std::shared_ptr<TaskInfo> task_info) {
     ::openmldb::api::SendIndexDataRequest request;
@@ -1286,7 +1517,7 @@ bool TabletClient::Scan(const ::openmldb::api::ScanRequest& request, brpc::Contr
 
 bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row,
                                  brpc::Controller* cntl, openmldb::api::QueryResponse* response, bool is_debug,
-                                 uint64_t timeout_ms) {
+                                 uint64_t timeout_ms, const ::openmldb::api::FollowerRead* follower_read) {
     if (cntl == NULL || response == NULL) return false;
     ::openmldb::api::QueryRequest request;
     request.set_sp_name(sp_name);
@@ -1296,6 +1527,10 @@ bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_na
     request.set_is_procedure(true);
     request.set_row_size(row.size());
     request.set_row_slices(1);
+    request.set_timeout_ms(timeout_ms);
+    if (follower_read != nullptr) {
+        request.mutable_follower_read()->CopyFrom(*follower_read);
+    }
     cntl->set_timeout_ms(timeout_ms);
     auto& io_buf = cntl->request_attachment();
     if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(row.data()), row.size(), &io_buf)) {
@@ -1340,6 +1575,7 @@ bool TabletClient::CallSQLBatchRequestProcedure(const std::string& db, const std
     request.set_is_procedure(true);
     request.set_db(db);
     request.set_is_debug(is_debug);
+    request.set_timeout_ms(timeout_ms);
     cntl->set_timeout_ms(timeout_ms);
 
     auto& io_buf = cntl->request_attachment();
@@ -1371,6 +1607,19 @@ bool TabletClient::DropProcedure(const std::string& db_name, const std::string&
 bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row,
                                  uint64_t timeout_ms, bool is_debug,
                                  openmldb::RpcCallback<openmldb::api::QueryResponse>* callback) {
+    return CallProcedure(db, sp_name, row, timeout_ms, is_debug, nullptr, callback);
+}
+
+bool TabletClient::CallProcedureOnFollower(const std::string& db, const std::string& sp_name, const std::string& row,
+                                           uint64_t timeout_ms, bool is_debug,
+                                           const ::openmldb::api::FollowerRead& follower_read,
+                                           openmldb::RpcCallback<openmldb::api::QueryResponse>* callback) {
+    return CallProcedure(db, sp_name, row, timeout_ms, is_debug, &follower_read, callback);
+}
+
+bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row,
+                                 uint64_t timeout_ms, bool is_debug, const ::openmldb::api::FollowerRead* follower_read,
+                                 openmldb::RpcCallback<openmldb::api::QueryResponse>* callback) {
     if (callback == nullptr) {
         return false;
     }
@@ -1382,6 +1631,10 @@ bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_na
     request.set_is_procedure(true);
     request.set_row_size(row.size());
     request.set_row_slices(1);
+    request.set_timeout_ms(timeout_ms);
+    if (follower_read != nullptr) {
+        request.mutable_follower_read()->CopyFrom(*follower_read);
+    }
     auto& io_buf = callback->GetController()->request_attachment();
     if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(row.data()), row.size(), &io_buf)) {
         LOG(WARNING) << "Encode row buf failed";
@@ -1403,6 +1656,7 @@ bool TabletClient::CallSQLBatchRequestProcedure(
     request.set_is_procedure(true);
     request.set_db(db);
     request.set_is_debug(is_debug);
+    request.set_timeout_ms(timeout_ms);
 
     auto& io_buf = callback->GetController()->request_attachment();
     if (!EncodeRowBatch(row_batch, &request, &io_buf)) {
@@ -1414,6 +1668,25 @@ bool TabletClient::CallSQLBatchRequestProcedure(
                                callback->GetController().get(), &request, callback->GetResponse().get(), callback);
 }
 
+bool TabletClient::AsyncCallSQLBatchRequestProcedure(const std::string& db, const std::string& sp_name,
+                                                     std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch> row_batch,
+                                                     brpc::Controller* cntl,
+                                                     openmldb::api::SQLBatchRequestQueryResponse* response,
+                                                     google::protobuf::Closure* done) {
+    if (cntl == nullptr || response == nullptr || done == nullptr || !row_batch) {
+        return false;
+    }
+    ::openmldb::api::SQLBatchRequestQueryRequest request;
+    request.set_sp_name(sp_name);
+    request.set_is_procedure(true);
+    request.set_db(db);
+    if (!EncodeRowBatch(row_batch, &request, &cntl->request_attachment())) {
+        return false;
+    }
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::SQLBatchRequestQuery, cntl, &request, response,
+                               done);
+}
+
 bool TabletClient::CreateFunction(const ::openmldb::common::ExternalFun& fun, std::string* msg) {
     if (msg == nullptr) {
         return false;
@@ -1475,5 +1748,13 @@ bool TabletClient::GetAndFlushDeployStats(::openmldb::api::DeployStatsResponse*
     return ok && res->code() == 0;
 }
 
+bool TabletClient::GetDeployProfile(const std::string& db, ::openmldb::api::DeployProfileResponse* res) {
+    ::openmldb::api::DeployProfileRequest req;
+    req.set_db(db);
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::GetDeployProfile, &req, res,
+                                  FLAGS_request_timeout_ms, FLAGS_request_max_retry);
+    return ok && res->code() == 0;
+}
+
 }  // namespace client
 }  // namespace openmldb
@@ -57,6 +57,9 @@ class TabletClient : public Client {
 
     int Init() override;
 
+    // the clients of the same endpoint in different groups don't share the connection, set before Init
+    void SetConnectionGroup(const std::string& group) { client_.SetConnectionGroup(group); }
+
     bool CreateTable(const std::string& name, uint32_t tid, uint32_t pid, uint64_t abs_ttl, uint64_t lat_ttl,
                      bool leader, const std::vector<std::string>& endpoints, const ::openmldb::type::TTLType& type,
                      uint32_t seg_cnt, uint64_t term, const ::openmldb::type::CompressType compress_type);
@@ -67,13 +70,26 @@ class TabletClient : public Client {
                                     const openmldb::common::VersionPair& pair,
                                     std::string& msg);  // NOLINT
 
+    // the rows beyond chunk_bytes are kept on the tablet if chunk_bytes is not 0, and fetched by FetchQueryResult
+    // with the result id of the response. with snapshot_read the rows put while the query runs are not read
     bool Query(const std::string& db, const std::string& sql,
                const std::vector<openmldb::type::DataType>& parameter_types, const std::string& parameter_row,
-               brpc::Controller* cntl, ::openmldb::api::QueryResponse* response, const bool is_debug = false);
+               brpc::Controller* cntl, ::openmldb::api::QueryResponse* response, const bool is_debug = false,
+               const bool is_profile = false, uint32_t chunk_bytes = 0, bool snapshot_read = false);
+
+    bool FetchQueryResult(uint64_t result_id, uint32_t chunk_bytes, brpc::Controller* cntl,
+                          ::openmldb::api::QueryResponse* response);
 
     bool Query(const std::string& db, const std::string& sql, const std::string& row, brpc::Controller* cntl,
                ::openmldb::api::QueryResponse* response, const bool is_debug = false);
 
+    // run the batch query prepared on the tablet if statement_id is not 0, otherwise send the sql to prepare it,
+    // the id of the prepared query is returned in the response
+    bool PreparedQuery(const std::string& db, const std::string& sql, uint64_t statement_id,
+                       const std::vector<openmldb::type::DataType>& parameter_types,
+                       const std::string& parameter_row, brpc::Controller* cntl,
+                       ::openmldb::api::QueryResponse* response);
+
     bool SQLBatchRequestQuery(const std::string& db, const std::string& sql,
                               std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch>, brpc::Controller* cntl,
                               ::openmldb::api::SQLBatchRequestQueryResponse* response, const bool is_debug = false);
@@ -90,6 +106,10 @@ class TabletClient : public Client {
     bool Put(uint32_t tid, uint32_t pid, uint64_t time, const std::string& value,
              const std::vector<std::pair<std::string, uint32_t>>& dimensions, uint32_t format_version);
 
+    // the code of the tablet is returned in the status, the puts of kWriteThrottled are to be retried later
+    base::Status PutRow(uint32_t tid, uint32_t pid, uint64_t time, const std::string& value,
+                        const std::vector<std::pair<std::string, uint32_t>>& dimensions, uint32_t format_version);
+
 
 
     bool Get(uint32_t tid, uint32_t pid, const std::string& pk, uint64_t time, std::string& value,  // NOLINT
@@ -104,9 +124,26 @@ class TabletClient : public Client {
     bool Get(uint32_t tid, uint32_t pid, const std::string& pk, uint64_t time, const std::string& idx_name,
              const std::string& ts_name, std::string& value, uint64_t& ts, std::string& msg);  // NOLINT
 
+    bool BatchGet(const ::openmldb::api::BatchGetRequest& request, ::openmldb::api::BatchGetResponse* response);
+
+    bool AsyncBatchGet(const ::openmldb::api::BatchGetRequest& request,
+                       openmldb::RpcCallback<openmldb::api::BatchGetResponse>* callback);
+
+    // the timeout of the heartbeat is the one of the controller of callback, the tablet takes no writes as leader
+    // if it gets no heartbeat in lease_timeout ms
+    bool AsyncHeartbeat(uint32_t lease_timeout, openmldb::RpcCallback<openmldb::api::GeneralResponse>* callback);
+
+    // done is run when the response arrives or the rpc fails, the controller and the response must outlive it
+    bool AsyncBatchPut(const ::openmldb::api::BatchPutRequest& request, brpc::Controller* cntl,
+                       ::openmldb::api::BatchPutResponse* response, google::protobuf::Closure* done);
+
     bool Delete(uint32_t tid, uint32_t pid, const std::string& pk, const std::string& idx_name,
                 std::string& msg);  // NOLINT
 
+    // delete the keys of the index in one request, deleted_cnt is the keys found
+    bool DeleteBatch(uint32_t tid, uint32_t pid, const std::vector<std::string>& keys, const std::string& idx_name,
+                     uint32_t* deleted_cnt, std::string* msg);
+
     bool Count(uint32_t tid, uint32_t pid, const std::string& pk, const std::string& idx_name, bool filter_expired_data,
                uint64_t& value, std::string& msg);  // NOLINT
 
@@ -194,6 +231,8 @@ class TabletClient : public Client {
                      ::openmldb::api::Manifest& manifest);  // NOLINT
 
     bool GetTableStatus(::openmldb::api::GetTableStatusResponse& response);  // NOLINT
+    // the status of all partitions of tid on the tablet
+    bool GetTableStatus(uint32_t tid, ::openmldb::api::GetTableStatusResponse& response);  // NOLINT
     bool GetTableStatus(uint32_t tid, uint32_t pid,
                         ::openmldb::api::TableStatus& table_status);  // NOLINT
     bool GetTableStatus(uint32_t tid, uint32_t pid, bool need_schema,
@@ -217,12 +256,23 @@ class TabletClient : public Client {
                                            const std::string& pk, uint64_t ts, uint32_t limit,
                                            bool need_clean, uint32_t& count);  // NOLINT
 
+    // go on from *cursor_id if it is not 0, and set it to the cursor of the next page, 0 if the tablet keeps no
+    // iterator. pk and ts of the last page are still passed as the cursor may time out
+    ::openmldb::base::KvIterator* Traverse(uint32_t tid, uint32_t pid, const std::string& idx_name,
+                                           const std::string& pk, uint64_t ts, uint32_t limit,
+                                           bool need_clean, uint64_t* cursor_id, uint32_t& count);  // NOLINT
+
     ::openmldb::base::KvIterator* Traverse(uint32_t tid, uint32_t pid, const std::string& idx_name,
                                            const std::string& pk, uint64_t ts, uint32_t limit,
                                            uint32_t& count);  // NOLINT
 
     void ShowTp();
 
+    bool GetBulkLoadInfo(uint32_t tid, uint32_t pid, ::openmldb::api::BulkLoadInfoResponse* response);
+
+    // the data region of the request is sent as the attachment
+    base::Status BulkLoad(const ::openmldb::api::BulkLoadRequest& request, const std::string& attachment);
+
     bool SetMode(bool mode);
 
     bool DeleteIndex(uint32_t tid, uint32_t pid, const std::string& idx_name, std::string* msg);
@@ -238,6 +288,16 @@ class TabletClient : public Client {
                        const ::openmldb::common::ColumnKey& column_key, uint32_t idx,
                        std::shared_ptr<TaskInfo> task_info);
 
+    // split pid into child_pid by the splits of the table after the split
+    bool SplitTable(uint32_t tid, uint32_t pid, uint32_t child_pid, uint32_t partition_num,
+                    const ::google::protobuf::RepeatedPtrField<::openmldb::common::PartitionSplit>& partition_split,
+                    std::shared_ptr<TaskInfo> task_info);
+
+    bool DeleteSplitData(
+        uint32_t tid, uint32_t pid, uint32_t partition_num,
+        const ::google::protobuf::RepeatedPtrField<::openmldb::common::PartitionSplit>& partition_split,
+        std::shared_ptr<TaskInfo> task_info);
+
     bool GetCatalog(uint64_t* version);
 
     bool SendIndexData(uint32_t tid, uint32_t pid, const std::map<uint32_t, std::string>& pid_endpoint_map,
@@ -259,9 +319,10 @@ class TabletClient : public Client {
     bool CreateProcedure(const openmldb::api::CreateProcedureRequest& sp_request,
                          std::string& msg);  // NOLINT
 
+    // the follower of the partition in follower_read rejects the call if it lags behind the leader
     bool CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row,
                        brpc::Controller* cntl, openmldb::api::QueryResponse* response, bool is_debug,
-                       uint64_t timeout_ms);
+                       uint64_t timeout_ms, const ::openmldb::api::FollowerRead* follower_read = nullptr);
 
     bool CallSQLBatchRequestProcedure(const std::string& db, const std::string& sp_name,
                                       std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch>, brpc::Controller* cntl,
@@ -285,18 +346,36 @@ class TabletClient : public Client {
     bool CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row, uint64_t timeout_ms,
                        bool is_debug, openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
 
+    // call the procedure on the follower of the partition, which rejects it if it lags behind the leader
+    bool CallProcedureOnFollower(const std::string& db, const std::string& sp_name, const std::string& row,
+                                 uint64_t timeout_ms, bool is_debug, const ::openmldb::api::FollowerRead& follower_read,
+                                 openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
+
     bool CallSQLBatchRequestProcedure(const std::string& db, const std::string& sp_name,
                                       std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch> row_batch, bool is_debug,
                                       uint64_t timeout_ms,
                                       openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>* callback);
 
+    // `done` is run once the response is received, the timeout is taken from `cntl`
+    bool AsyncCallSQLBatchRequestProcedure(const std::string& db, const std::string& sp_name,
+                                           std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch> row_batch,
+                                           brpc::Controller* cntl,
+                                           openmldb::api::SQLBatchRequestQueryResponse* response,
+                                           google::protobuf::Closure* done);
+
     bool CreateAggregator(const ::openmldb::api::TableMeta& base_table_meta,
                           uint32_t aggr_tid, uint32_t aggr_pid, uint32_t index_pos,
                           const ::openmldb::base::LongWindowInfo& window_info);
 
     bool GetAndFlushDeployStats(::openmldb::api::DeployStatsResponse* res);
 
+    bool GetDeployProfile(const std::string& db, ::openmldb::api::DeployProfileResponse* res);
+
  private:
+    bool CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row, uint64_t timeout_ms,
+                       bool is_debug, const ::openmldb::api::FollowerRead* follower_read,
+                       openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
+
     ::openmldb::RpcClient<::openmldb::api::TabletServer_Stub> client_;
     std::vector<uint64_t> percentile_;
 };
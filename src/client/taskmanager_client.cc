@@ -114,6 +114,47 @@ namespace openmldb::client {
     }
 }
 
+::openmldb::base::Status TaskManagerClient::RunBatchSqlToResult(const std::string& sql,
+                                                                const std::map<std::string, std::string>& config,
+                                                                const std::string& default_db,
+                                                                const std::string& format, std::string* result_path) {
+    ::openmldb::taskmanager::RunBatchSqlRequest request;
+    ::openmldb::taskmanager::RunBatchSqlResponse response;
+
+    request.set_sql(sql);
+    request.set_default_db(default_db);
+    request.set_result_format(format);
+    for (auto it = config.begin(); it != config.end(); ++it) {
+        (*request.mutable_conf())[it->first] = it->second;
+    }
+
+    bool ok = client_.SendRequest(&::openmldb::taskmanager::TaskManagerServer_Stub::RunBatchSql, &request,
+                                  &response, FLAGS_request_timeout_ms, 1);
+    if (!ok) {
+        return ::openmldb::base::Status(-1, "Fail to request TaskManager server");
+    }
+    if (response.code() == 0) {
+        *result_path = response.result_path();
+    }
+    return ::openmldb::base::Status(response.code(), response.msg());
+}
+
+::openmldb::base::Status TaskManagerClient::GetJobResult(const std::string& result_path, uint64_t offset,
+                                                         uint32_t limit,
+                                                         ::openmldb::taskmanager::GetJobResultResponse* response) {
+    ::openmldb::taskmanager::GetJobResultRequest request;
+    request.set_result_path(result_path);
+    request.set_offset(offset);
+    request.set_limit(limit);
+
+    bool ok = client_.SendRequest(&::openmldb::taskmanager::TaskManagerServer_Stub::GetJobResult, &request,
+                                  response, request_timeout_ms_, 1);
+    if (!ok) {
+        return ::openmldb::base::Status(-1, "Fail to request TaskManager server");
+    }
+    return ::openmldb::base::Status(response->code(), response->msg());
+}
+
 ::openmldb::base::Status TaskManagerClient::RunBatchAndShow(const std::string& sql,
                                                             const std::map<std::string, std::string>& config,
                                                             const std::string& default_db, bool sync_job,
@@ -54,6 +54,16 @@ class TaskManagerClient : public Client {
     ::openmldb::base::Status RunBatchSql(const std::string& sql, const std::map<std::string, std::string>& config,
                                              const std::string& default_db, std::string& output); // NOLINT
 
+    // run the sql and write its result to the files of the format, csv or parquet, read by GetJobResult
+    ::openmldb::base::Status RunBatchSqlToResult(const std::string& sql,
+                                                 const std::map<std::string, std::string>& config,
+                                                 const std::string& default_db, const std::string& format,
+                                                 std::string* result_path);
+
+    // read the rows in [offset, offset + limit) of the result written by RunBatchSqlToResult
+    ::openmldb::base::Status GetJobResult(const std::string& result_path, uint64_t offset, uint32_t limit,
+                                          ::openmldb::taskmanager::GetJobResultResponse* response);
+
     ::openmldb::base::Status RunBatchAndShow(const std::string& sql, const std::map<std::string, std::string>& config,
                                              const std::string& default_db, bool sync_job,
                                              ::openmldb::taskmanager::JobInfo& job_info);  // NOLINT
@@ -28,6 +28,7 @@
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
 #include "base/hash.h"
+#include "base/partition_router.h"
 #include "base/ip.h"
 #include "base/linenoise.h"
 #include "base/kv_iterator.h"
@@ -340,7 +341,7 @@ int PutData(uint32_t tid, const std::map<uint32_t, std::vector<std::pair<std::st
         if (codec.CombinePartitionKey(input_value, &key) < 0) {
             return ::openmldb::base::Status(-1, "combine partition key error");
         }
-        uint32_t pid = (uint32_t)(::openmldb::base::hash64(key) % part_size);
+        uint32_t pid = ::openmldb::base::PartitionRouter(part_size, table_info.partition_split()).GetPid(key);
         if (pid != 0) {
             auto pair = dimensions.emplace(pid, ::openmldb::codec::Dimension());
             dimensions[0].swap(pair.first->second);
@@ -982,6 +983,24 @@ void HandleNSClientMigrate(const std::vector<std::string>& parts, ::openmldb::cl
     std::cout << "partition migrate ok" << std::endl;
 }
 
+void HandleNSClientSplitPartition(const std::vector<std::string>& parts, ::openmldb::client::NsClient* client) {
+    if (parts.size() < 3) {
+        std::cout << "Bad format. eg, splitpartition table1 1" << std::endl;
+        return;
+    }
+    try {
+        uint32_t pid = boost::lexical_cast<uint32_t>(parts[2]);
+        std::string msg;
+        if (!client->SplitPartition(parts[1], pid, &msg)) {
+            std::cout << "failed to split partition. error msg: " << msg << std::endl;
+            return;
+        }
+        std::cout << "partition split ok" << std::endl;
+    } catch (std::exception const& e) {
+        std::cout << "Invalid args. pid should be uint32_t" << std::endl;
+    }
+}
+
 void HandleNSClientRecoverEndpoint(const std::vector<std::string>& parts, ::openmldb::client::NsClient* client) {
     if (parts.size() < 2) {
         std::cout << "Bad format" << std::endl;
@@ -1122,7 +1141,8 @@ void HandleNSDelete(const std::vector<std::string>& parts, ::openmldb::client::N
         }
         uint32_t tid = tables[0].tid();
         std::string key = parts[2];
-        uint32_t pid = (uint32_t)(::openmldb::base::hash64(key) % tables[0].table_partition_size());
+        ::openmldb::base::PartitionRouter router(tables[0].table_partition_size(), tables[0].partition_split());
+        uint32_t pid = router.GetPid(key);
         std::shared_ptr<::openmldb::client::TabletClient> tablet_client = GetTabletClient(tables[0], pid, msg);
         if (!tablet_client) {
             std::cout << "failed to delete. error msg: " << msg << std::endl;
@@ -1446,7 +1466,8 @@ void HandleNSGet(const std::vector<std::string>& parts, ::openmldb::client::NsCl
         return;
     }
     uint32_t tid = tables[0].tid();
-    uint32_t pid = (uint32_t)(::openmldb::base::hash64(key) % tables[0].table_partition_size());
+    uint32_t pid =
+        ::openmldb::base::PartitionRouter(tables[0].table_partition_size(), tables[0].partition_split()).GetPid(key);
     std::shared_ptr<TabletClient> tb_client = GetTabletClient(tables[0], pid, msg);
     if (!tb_client) {
         std::cout << "failed to get. error msg: " << msg << std::endl;
@@ -1626,7 +1647,8 @@ void HandleNSScan(const std::vector<std::string>& parts, ::openmldb::client::NsC
         return;
     }
     uint32_t tid = tables[0].tid();
-    uint32_t pid = (uint32_t)(::openmldb::base::hash64(key) % tables[0].table_partition_size());
+    uint32_t pid =
+        ::openmldb::base::PartitionRouter(tables[0].table_partition_size(), tables[0].partition_split()).GetPid(key);
     std::shared_ptr<TabletClient> tb_client = GetTabletClient(tables[0], pid, msg);
     if (!tb_client) {
         std::cout << "failed to scan. error msg: " << msg << std::endl;
@@ -1807,7 +1829,8 @@ void HandleNSCount(const std::vector<std::string>& parts, ::openmldb::client::Ns
         return;
     }
     uint32_t tid = tables[0].tid();
-    uint32_t pid = (uint32_t)(::openmldb::base::hash64(key) % tables[0].table_partition_size());
+    uint32_t pid =
+        ::openmldb::base::PartitionRouter(tables[0].table_partition_size(), tables[0].partition_split()).GetPid(key);
     std::shared_ptr<::openmldb::client::TabletClient> tablet_client = GetTabletClient(tables[0], pid, msg);
     if (!tablet_client) {
         std::cout << "failed to count. cannot not found tablet client, pid is " << pid << std::endl;
@@ -2375,6 +2398,7 @@ void HandleNSClientHelp(const std::vector<std::string>& parts, ::openmldb::clien
         printf("showopstatus - show op info\n");
         printf("settablepartition - update partition info\n");
         printf("setttl - set table ttl\n");
+        printf("splitpartition - split a partition into two online\n");
         printf("updatetablealive - update table alive status\n");
         printf("info - show information of the table\n");
         printf("addrepcluster - add remote replica cluster\n");
@@ -2534,6 +2558,10 @@ void HandleNSClientHelp(const std::vector<std::string>& parts, ::openmldb::clien
             printf("ex: migrate 172.27.2.52:9991 table1 1 172.27.2.52:9992\n");
             printf("ex: migrate 172.27.2.52:9991 table1 1,3,5 172.27.2.52:9992\n");
             printf("ex: migrate 172.27.2.52:9991 table1 1-5 172.27.2.52:9992\n");
+        } else if (parts[1] == "splitpartition") {
+            printf("desc: split a partition into itself and a new partition, which takes half of its keys\n");
+            printf("usage: splitpartition table_name pid\n");
+            printf("ex: splitpartition table1 1\n");
         } else if (parts[1] == "gettablepartition") {
             printf("desc: get partition info\n");
             printf("usage: gettablepartition table_name pid\n");
@@ -4132,6 +4160,8 @@ void StartNsClient() {
             HandleNSClientOfflineEndpoint(parts, &client);
         } else if (parts[0] == "migrate") {
             HandleNSClientMigrate(parts, &client);
+        } else if (parts[0] == "splitpartition") {
+            HandleNSClientSplitPartition(parts, &client);
         } else if (parts[0] == "recoverendpoint") {
             HandleNSClientRecoverEndpoint(parts, &client);
         } else if (parts[0] == "recovertable") {
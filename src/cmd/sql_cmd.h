@@ -63,6 +63,10 @@ const std::string VERSION = std::to_string(OPENMLDB_VERSION_MAJOR) + "." +  // N
 ::openmldb::sdk::DBSDK* cs = nullptr;
 ::openmldb::sdk::SQLClusterRouter* sr = nullptr;
 
+// a large result is printed in tables of the rows, so the output begins once the first chunk of rows comes and the
+// rows printed are not kept
+constexpr int32_t DISPLAY_BATCH_ROWS = 1000;
+
 void HandleSQL(const std::string& sql) {
     hybridse::sdk::Status status;
     auto result_set = sr->ExecuteSQL(sql, &status);
@@ -76,20 +80,30 @@ void HandleSQL(const std::string& sql) {
                     std::cout << val;
                 }
             } else {
-                ::hybridse::base::TextTable t('-', ' ', ' ');
-                for (int idx = 0; idx < schema->GetColumnCnt(); idx++) {
-                    t.add(schema->GetColumnName(idx));
-                }
-                t.end_of_row();
+                auto new_table = [schema]() {
+                    std::unique_ptr<::hybridse::base::TextTable> t(new ::hybridse::base::TextTable('-', ' ', ' '));
+                    for (int idx = 0; idx < schema->GetColumnCnt(); idx++) {
+                        t->add(schema->GetColumnName(idx));
+                    }
+                    t->end_of_row();
+                    return t;
+                };
+                auto t = new_table();
+                int32_t row_cnt = 0;
                 while (result_set->Next()) {
+                    if (row_cnt > 0 && row_cnt % DISPLAY_BATCH_ROWS == 0) {
+                        std::cout << *t << std::flush;
+                        t = new_table();
+                    }
                     for (int idx = 0; idx < schema->GetColumnCnt(); idx++) {
                         std::string val;
                         result_set->GetAsString(idx, val);
-                        t.add(val);
+                        t->add(val);
                     }
-                    t.end_of_row();
+                    t->end_of_row();
+                    row_cnt++;
                 }
-                std::cout << t;
+                std::cout << *t;
                 std::cout << std::endl << result_set->Size() << " rows in set" << std::endl;
             }
         } else {
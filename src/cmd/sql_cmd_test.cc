@@ -28,6 +28,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "config.h"  // NOLINT
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "sdk/mini_cluster.h"
@@ -35,6 +36,12 @@
 #include "test/util.h"
 #include "vm/catalog.h"
 
+#ifdef ARROW_ENABLE
+#include "arrow/api.h"
+#include "arrow/io/file.h"
+#include "parquet/arrow/writer.h"
+#endif
+
 DECLARE_bool(interactive);
 DEFINE_string(cmd, "", "Set cmd");
 DECLARE_string(host);
@@ -371,6 +378,152 @@ TEST_F(SqlCmdTest, LoadData) {
     unlink(file_name.c_str());
 }
 
+TEST_F(SqlCmdTest, LoadDataParallel) {
+    sr = standalone_cli.sr;
+    cs = standalone_cli.cs;
+    HandleSQL("create database test1;");
+    HandleSQL("use test1;");
+    HandleSQL("create table trans (c1 string, c2 int, index(key=c1, ts=c2)) options(partitionnum=4);");
+    std::string file_name = "./myfile_parallel.csv";
+    std::ofstream ofile;
+    ofile.open(file_name);
+    ofile << "c1,c2" << std::endl;
+    int cnt = 400;
+    for (int i = 0; i < cnt; i++) {
+        ofile << "key" << i % 100 << "," << i << std::endl;
+    }
+    ofile.close();
+    hybridse::sdk::Status status;
+    sr->ExecuteSQL("LOAD DATA INFILE '" + file_name + "' INTO TABLE trans OPTIONS(thread=4);", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    auto result = sr->ExecuteSQL("select * from trans;", &status);
+    ASSERT_TRUE(status.IsOK());
+    ASSERT_EQ(cnt, result->Size());
+    // the error tells the line
+    ofile.open(file_name);
+    ofile << "c1,c2" << std::endl << "key1,1" << std::endl << "key2,a" << std::endl;
+    ofile.close();
+    sr->ExecuteSQL("LOAD DATA INFILE '" + file_name + "' INTO TABLE trans OPTIONS(thread=2);", &status);
+    ASSERT_FALSE(status.IsOK());
+    ASSERT_NE(std::string::npos, status.msg.find("line 3")) << status.msg;
+    HandleSQL("drop table trans;");
+    HandleSQL("drop database test1;");
+    unlink(file_name.c_str());
+}
+
+TEST_F(SqlCmdTest, LoadDataColumnar) {
+    sr = standalone_cli.sr;
+    cs = standalone_cli.cs;
+    HandleSQL("create database test1;");
+    HandleSQL("use test1;");
+    HandleSQL("create table trans (c1 string, c2 int, index(key=c1, ts=c2)) options(partitionnum=4);");
+    std::string file_name = "./myfile_columnar.parquet";
+    hybridse::sdk::Status status;
+#ifdef ARROW_ENABLE
+    // the columns are found by name, so they are written out of the table order with one more column
+    int cnt = 100;
+    ::arrow::Int32Builder c2_builder;
+    ::arrow::StringBuilder c1_builder;
+    ::arrow::DoubleBuilder c9_builder;
+    for (int i = 0; i < cnt; i++) {
+        ASSERT_TRUE(c2_builder.Append(i).ok());
+        ASSERT_TRUE(c1_builder.Append("key" + std::to_string(i % 10)).ok());
+        ASSERT_TRUE(c9_builder.Append(i * 0.5).ok());
+    }
+    std::shared_ptr<::arrow::Array> c2_array, c1_array, c9_array;
+    ASSERT_TRUE(c2_builder.Finish(&c2_array).ok());
+    ASSERT_TRUE(c1_builder.Finish(&c1_array).ok());
+    ASSERT_TRUE(c9_builder.Finish(&c9_array).ok());
+    auto schema = ::arrow::schema({::arrow::field("c2", ::arrow::int32()), ::arrow::field("c1", ::arrow::utf8()),
+                                   ::arrow::field("c9", ::arrow::float64())});
+    auto table = ::arrow::Table::Make(schema, {c2_array, c1_array, c9_array});
+    auto output = ::arrow::io::FileOutputStream::Open(file_name);
+    ASSERT_TRUE(output.ok()) << output.status().ToString();
+    // 10 row groups, read by the 4 threads
+    ASSERT_TRUE(::parquet::arrow::WriteTable(*table, ::arrow::default_memory_pool(), *output, 10).ok());
+    ASSERT_TRUE((*output)->Close().ok());
+
+    sr->ExecuteSQL("LOAD DATA INFILE '" + file_name + "' INTO TABLE trans OPTIONS(format='parquet', thread=4);",
+                   &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    auto result = sr->ExecuteSQL("select * from trans;", &status);
+    ASSERT_TRUE(status.IsOK());
+    ASSERT_EQ(cnt, result->Size());
+    result = sr->ExecuteSQL("select c2 from trans where c1 = 'key3';", &status);
+    ASSERT_TRUE(status.IsOK());
+    ASSERT_EQ(cnt / 10, result->Size());
+    while (result->Next()) {
+        ASSERT_EQ(3, result->GetInt32Unsafe(0) % 10);
+    }
+#else
+    std::ofstream ofile(file_name);
+    ofile << "not a parquet file" << std::endl;
+    ofile.close();
+    sr->ExecuteSQL("LOAD DATA INFILE '" + file_name + "' INTO TABLE trans OPTIONS(format='parquet');", &status);
+    ASSERT_FALSE(status.IsOK());
+    ASSERT_NE(std::string::npos, status.msg.find("ARROW_ENABLE")) << status.msg;
+#endif
+    sr->ExecuteSQL("LOAD DATA INFILE '" + file_name + "' INTO TABLE trans OPTIONS(format='avro');", &status);
+    ASSERT_FALSE(status.IsOK());
+    HandleSQL("drop table trans;");
+    HandleSQL("drop database test1;");
+    unlink(file_name.c_str());
+}
+
+TEST_F(SqlCmdTest, SelectIntoParallel) {
+    sr = standalone_cli.sr;
+    cs = standalone_cli.cs;
+    HandleSQL("create database test1;");
+    HandleSQL("use test1;");
+    HandleSQL("create table trans (c1 string, c2 int, c3 date, index(key=c1, ts=c2)) options(partitionnum=4);");
+    int cnt = 400;
+    hybridse::sdk::Status status;
+    for (int i = 0; i < cnt; i++) {
+        sr->ExecuteSQL("insert into trans values ('key" + std::to_string(i % 100) + "', " + std::to_string(i) +
+                           ", '2022-01-02');",
+                       &status);
+        ASSERT_TRUE(status.IsOK()) << status.msg;
+    }
+    auto count_lines = [](const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        int lines = 0;
+        while (std::getline(file, line)) {
+            if (lines > 0) {
+                EXPECT_NE(std::string::npos, line.find(",2022-01-02")) << line;
+            }
+            lines++;
+        }
+        return lines;
+    };
+    // the partitions are merged into one file
+    std::string file_name = "./myfile_select_into_parallel.csv";
+    sr->ExecuteSQL("select * from trans into outfile '" + file_name + "' options (mode='overwrite', thread=4);",
+                   &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_EQ(cnt + 1, count_lines(file_name));
+    // one file per partition
+    std::string dir_name = "./myfile_select_into_parallel";
+    sr->ExecuteSQL("select * from trans into outfile '" + dir_name +
+                       "' options (mode='overwrite', thread=2, single_file=false);",
+                   &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    int lines = 0;
+    int files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir_name)) {
+        lines += count_lines(entry.path().string()) - 1;
+        files++;
+    }
+    ASSERT_EQ(cnt, lines);
+    ASSERT_GT(files, 0);
+    sr->ExecuteSQL("select * from trans into outfile '" + dir_name + "' options (single_file=false);", &status);
+    ASSERT_FALSE(status.IsOK());
+    HandleSQL("drop table trans;");
+    HandleSQL("drop database test1;");
+    unlink(file_name.c_str());
+    std::filesystem::remove_all(dir_name);
+}
+
 TEST_P(DBSDKTest, Deploy) {
     auto cli = GetParam();
     cs = cli->cs;
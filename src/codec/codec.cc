@@ -503,7 +503,9 @@ RowView::RowView(const Schema& schema)
       size_(0),
       row_(NULL),
       schema_(schema),
-      offset_vec_() {
+      offset_vec_(),
+      version_(0),
+      old_layouts_() {
     Init();
 }
 
@@ -515,7 +517,9 @@ RowView::RowView(const Schema& schema, const int8_t* row, uint32_t size)
       size_(size),
       row_(row),
       schema_(schema),
-      offset_vec_() {
+      offset_vec_(),
+      version_(0),
+      old_layouts_() {
     if (schema_.size() == 0) {
         is_valid_ = false;
         return;
@@ -547,6 +551,46 @@ bool RowView::Init() {
     return true;
 }
 
+bool RowView::SetVersions(const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema) {
+    if (!is_valid_ || vers_schema.empty() || vers_schema.rbegin()->first <= 0 ||
+        vers_schema.rbegin()->first > UINT8_MAX || vers_schema.rbegin()->second->size() != schema_.size()) {
+        return false;
+    }
+    std::vector<VersionLayout> layouts(vers_schema.rbegin()->first + 1);
+    for (const auto& kv : vers_schema) {
+        const Schema& schema = *kv.second;
+        if (kv.first <= 0 || schema.size() == 0 || schema.size() > schema_.size()) {
+            return false;
+        }
+        for (int idx = 0; idx < schema.size(); idx++) {
+            if (schema.Get(idx).data_type() != schema_.Get(idx).data_type()) {
+                return false;
+            }
+        }
+        if (kv.first == vers_schema.rbegin()->first) {
+            continue;
+        }
+        // the same field offsets as Init
+        VersionLayout& layout = layouts[kv.first];
+        layout.col_cnt = schema.size();
+        uint32_t offset = HEADER_LENGTH + BitMapSize(schema.size());
+        for (int idx = 0; idx < schema.size(); idx++) {
+            ::openmldb::type::DataType cur_type = schema.Get(idx).data_type();
+            if (cur_type == ::openmldb::type::kVarchar || cur_type == ::openmldb::type::kString) {
+                layout.offset_vec.push_back(layout.string_field_cnt);
+                layout.string_field_cnt++;
+            } else {
+                layout.offset_vec.push_back(offset);
+                offset += TYPE_SIZE_ARRAY[cur_type];
+            }
+        }
+        layout.str_field_start_offset = offset;
+    }
+    version_ = vers_schema.rbegin()->first;
+    old_layouts_.swap(layouts);
+    return true;
+}
+
 bool RowView::Reset(const int8_t* row, uint32_t size) {
     if (schema_.size() == 0 || row == NULL || size <= HEADER_LENGTH ||
         *(reinterpret_cast<const uint32_t*>(row + VERSION_LENGTH)) != size) {
@@ -598,7 +642,7 @@ int32_t RowView::GetBool(uint32_t idx, bool* val) const {
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row_, idx);
     int8_t v = v1::GetBoolField(row_, offset);
     if (v == 1) {
         *val = true;
@@ -618,7 +662,7 @@ int32_t RowView::GetDate(uint32_t idx, uint32_t* year, uint32_t* month, uint32_t
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row_, idx);
     int32_t date = static_cast<int32_t>(v1::GetInt32Field(row_, offset));
     *day = date & 0x0000000FF;
     date = date >> 8;
@@ -637,7 +681,7 @@ int32_t RowView::GetDate(uint32_t idx, int32_t* val) const {
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row_, idx);
     *val = static_cast<int32_t>(v1::GetInt32Field(row_, offset));
     return 0;
 }
@@ -652,7 +696,7 @@ int32_t RowView::GetInt32(uint32_t idx, int32_t* val) const {
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row_, idx);
     *val = v1::GetInt32Field(row_, offset);
     return 0;
 }
@@ -667,7 +711,7 @@ int32_t RowView::GetTimestamp(uint32_t idx, int64_t* val) const {
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row_, idx);
     *val = v1::GetInt64Field(row_, offset);
     return 0;
 }
@@ -682,7 +726,7 @@ int32_t RowView::GetInt64(uint32_t idx, int64_t* val) const {
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row_, idx);
     *val = v1::GetInt64Field(row_, offset);
     return 0;
 }
@@ -697,7 +741,7 @@ int32_t RowView::GetInt16(uint32_t idx, int16_t* val) const {
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row_, idx);
     *val = v1::GetInt16Field(row_, offset);
     return 0;
 }
@@ -712,7 +756,7 @@ int32_t RowView::GetFloat(uint32_t idx, float* val) const {
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row_, idx);
     *val = v1::GetFloatField(row_, offset);
     return 0;
 }
@@ -727,7 +771,7 @@ int32_t RowView::GetDouble(uint32_t idx, double* val) const {
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row_, idx);
     *val = v1::GetDoubleField(row_, offset);
     return 0;
 }
@@ -777,7 +821,7 @@ int32_t RowView::GetValue(const int8_t* row, uint32_t idx, ::openmldb::type::Dat
     if (IsNULL(row, idx)) {
         return 1;
     }
-    uint32_t offset = offset_vec_.at(idx);
+    uint32_t offset = GetOffset(row, idx);
     switch (type) {
         case ::openmldb::type::kBool: {
             int8_t v = v1::GetBoolField(row, offset);
@@ -831,12 +875,15 @@ int32_t RowView::GetValue(const int8_t* row, uint32_t idx, char** val, uint32_t*
     if (IsNULL(row, idx)) {
         return 1;
     }
-    uint32_t field_offset = offset_vec_.at(idx);
+    const VersionLayout* layout = GetOldLayout(row);
+    uint32_t field_offset = layout == nullptr ? offset_vec_.at(idx) : layout->offset_vec.at(idx);
+    uint32_t string_field_cnt = layout == nullptr ? string_field_cnt_ : layout->string_field_cnt;
+    uint32_t str_field_start_offset = layout == nullptr ? str_field_start_offset_ : layout->str_field_start_offset;
     uint32_t next_str_field_offset = 0;
-    if (offset_vec_.at(idx) < string_field_cnt_ - 1) {
+    if (field_offset < string_field_cnt - 1) {
         next_str_field_offset = field_offset + 1;
     }
-    return v1::GetStrField(row, field_offset, next_str_field_offset, str_field_start_offset_, GetAddrLength(size),
+    return v1::GetStrField(row, field_offset, next_str_field_offset, str_field_start_offset, GetAddrLength(size),
                            reinterpret_cast<int8_t**>(val), length);
 }
 
@@ -851,15 +898,106 @@ int32_t RowView::GetString(uint32_t idx, char** val, uint32_t* length) const {
     if (IsNULL(row_, idx)) {
         return 1;
     }
-    uint32_t field_offset = offset_vec_.at(idx);
+    const VersionLayout* layout = GetOldLayout(row_);
+    uint32_t field_offset = layout == nullptr ? offset_vec_.at(idx) : layout->offset_vec.at(idx);
+    uint32_t string_field_cnt = layout == nullptr ? string_field_cnt_ : layout->string_field_cnt;
+    uint32_t str_field_start_offset = layout == nullptr ? str_field_start_offset_ : layout->str_field_start_offset;
     uint32_t next_str_field_offset = 0;
-    if (offset_vec_.at(idx) < string_field_cnt_ - 1) {
+    if (field_offset < string_field_cnt - 1) {
         next_str_field_offset = field_offset + 1;
     }
-    return v1::GetStrField(row_, field_offset, next_str_field_offset, str_field_start_offset_, str_addr_length_,
+    return v1::GetStrField(row_, field_offset, next_str_field_offset, str_field_start_offset, str_addr_length_,
                            reinterpret_cast<int8_t**>(val), length);
 }
 
+// the loop has no branch and the value is loaded by a fixed offset, so that the
+// compiler can vectorize it with gather for the wide types
+template <typename T>
+static void GatherColumn(const int8_t* const* rows, uint32_t row_cnt, uint32_t offset, uint32_t null_byte,
+                         uint8_t null_mask, T* values, uint8_t* nulls) {
+    for (uint32_t i = 0; i < row_cnt; i++) {
+        const int8_t* row = rows[i];
+        uint8_t is_null = (*(reinterpret_cast<const uint8_t*>(row + null_byte)) & null_mask) != 0;
+        T val;
+        memcpy(&val, row + offset, sizeof(T));
+        values[i] = is_null ? T() : val;
+        nulls[i] = is_null;
+    }
+}
+
+// the rows of the older schema versions are read one by one, as the offset differs by the version
+template <typename T>
+static void CopyColumn(const RowView& view, const int8_t* const* rows, uint32_t row_cnt, uint32_t idx,
+                       ::openmldb::type::DataType type, T* values, uint8_t* nulls) {
+    for (uint32_t i = 0; i < row_cnt; i++) {
+        values[i] = T();
+        nulls[i] = view.GetValue(rows[i], idx, type, &values[i]) != 0;
+    }
+}
+
+int32_t RowView::GetColumn(const int8_t* const* rows, uint32_t row_cnt, uint32_t idx, void* values,
+                           uint8_t* nulls) const {
+    if (rows == NULL || values == NULL || nulls == NULL || !is_valid_) {
+        return -1;
+    }
+    if ((int32_t)idx >= schema_.size()) {
+        return -1;
+    }
+    ::openmldb::type::DataType type = schema_.Get(idx).data_type();
+    if (type == ::openmldb::type::kVarchar || type == ::openmldb::type::kString) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < row_cnt && !old_layouts_.empty(); i++) {
+        if (GetOldLayout(rows[i]) == nullptr) {
+            continue;
+        }
+        switch (type) {
+            case ::openmldb::type::kBool:
+                CopyColumn(*this, rows, row_cnt, idx, type, reinterpret_cast<bool*>(values), nulls);
+                return 0;
+            case ::openmldb::type::kSmallInt:
+                CopyColumn(*this, rows, row_cnt, idx, type, reinterpret_cast<int16_t*>(values), nulls);
+                return 0;
+            case ::openmldb::type::kInt:
+            case ::openmldb::type::kDate:
+                CopyColumn(*this, rows, row_cnt, idx, type, reinterpret_cast<int32_t*>(values), nulls);
+                return 0;
+            case ::openmldb::type::kBigInt:
+            case ::openmldb::type::kTimestamp:
+                CopyColumn(*this, rows, row_cnt, idx, type, reinterpret_cast<int64_t*>(values), nulls);
+                return 0;
+            case ::openmldb::type::kFloat:
+                CopyColumn(*this, rows, row_cnt, idx, type, reinterpret_cast<float*>(values), nulls);
+                return 0;
+            case ::openmldb::type::kDouble:
+                CopyColumn(*this, rows, row_cnt, idx, type, reinterpret_cast<double*>(values), nulls);
+                return 0;
+            default:
+                return -1;
+        }
+    }
+    uint32_t offset = offset_vec_.at(idx);
+    uint32_t null_byte = HEADER_LENGTH + (idx >> 3);
+    uint8_t null_mask = 1 << (idx & 0x07);
+    switch (TYPE_SIZE_ARRAY[type]) {
+        case 1:
+            GatherColumn(rows, row_cnt, offset, null_byte, null_mask, reinterpret_cast<uint8_t*>(values), nulls);
+            break;
+        case 2:
+            GatherColumn(rows, row_cnt, offset, null_byte, null_mask, reinterpret_cast<uint16_t*>(values), nulls);
+            break;
+        case 4:
+            GatherColumn(rows, row_cnt, offset, null_byte, null_mask, reinterpret_cast<uint32_t*>(values), nulls);
+            break;
+        case 8:
+            GatherColumn(rows, row_cnt, offset, null_byte, null_mask, reinterpret_cast<uint64_t*>(values), nulls);
+            break;
+        default:
+            return -1;
+    }
+    return 0;
+}
+
 int32_t RowView::GetStrValue(uint32_t idx, std::string* val) const { return GetStrValue(row_, idx, val); }
 
 int32_t RowView::GetStrValue(const int8_t* row, uint32_t idx, std::string* val) const {
@@ -996,162 +1134,265 @@ int32_t GetStrField(const int8_t* row, uint32_t field_offset, uint32_t next_str_
 
 }  // namespace v1
 
-RowProject::RowProject(const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, const ProjectList& plist)
-    : plist_(plist),
-      output_schema_(),
-      row_builder_(NULL),
-      cur_rv_(nullptr),
-      max_idx_(0),
-      vers_views_(),
-      vers_schema_(vers_schema),
-      cur_ver_(1) {}
+static inline uint32_t GetStrOffset(const int8_t* ptr, uint8_t addr_length) {
+    if (addr_length == 1) {
+        return *(reinterpret_cast<const uint8_t*>(ptr));
+    } else if (addr_length == 2) {
+        return *(reinterpret_cast<const uint16_t*>(ptr));
+    } else if (addr_length == 3) {
+        uint32_t offset = *(reinterpret_cast<const uint8_t*>(ptr));
+        offset = (offset << 8) + *(reinterpret_cast<const uint8_t*>(ptr + 1));
+        return (offset << 8) + *(reinterpret_cast<const uint8_t*>(ptr + 2));
+    }
+    return *(reinterpret_cast<const uint32_t*>(ptr));
+}
 
-RowProject::~RowProject() { delete row_builder_; }
+static inline void SetStrOffset(int8_t* ptr, uint8_t addr_length, uint32_t offset) {
+    if (addr_length == 1) {
+        *(reinterpret_cast<uint8_t*>(ptr)) = (uint8_t)offset;
+    } else if (addr_length == 2) {
+        *(reinterpret_cast<uint16_t*>(ptr)) = (uint16_t)offset;
+    } else if (addr_length == 3) {
+        *(reinterpret_cast<uint8_t*>(ptr)) = offset >> 16;
+        *(reinterpret_cast<uint8_t*>(ptr + 1)) = (offset & 0xFF00) >> 8;
+        *(reinterpret_cast<uint8_t*>(ptr + 2)) = offset & 0x00FF;
+    } else {
+        *(reinterpret_cast<uint32_t*>(ptr)) = offset;
+    }
+}
+
+static inline bool IsFieldNULL(const int8_t* row, uint32_t idx) {
+    return *(reinterpret_cast<const uint8_t*>(row + HEADER_LENGTH + (idx >> 3))) & (1 << (idx & 0x07));
+}
 
-bool RowProject::Init() {
-    if (plist_.size() <= 0) {
+static inline bool IsStringType(::openmldb::type::DataType type) {
+    return type == ::openmldb::type::kVarchar || type == ::openmldb::type::kString;
+}
+
+RowProjectPlan::RowProjectPlan(const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema,
+                               const ProjectList& plist)
+    : plist_(plist.begin(), plist.end()),
+      vers_schema_(vers_schema),
+      output_schema_(),
+      max_idx_(0),
+      types_(),
+      dst_offsets_(),
+      dst_str_field_start_offset_(0),
+      dst_str_field_cnt_(0),
+      layouts_() {}
+
+bool RowProjectPlan::Init() {
+    if (plist_.empty()) {
         LOG(WARNING) << "projection list is empty";
         return false;
     }
-    for (int32_t i = 0; i < plist_.size(); i++) {
-        uint32_t idx = plist_.Get(i);
+    for (uint32_t idx : plist_) {
         if (idx >= max_idx_) {
             max_idx_ = idx;
         }
     }
-    for (const auto& sch : vers_schema_) {
-        if (max_idx_ >= static_cast<uint32_t>(sch.second->size())) {
-            continue;
-        }
-        std::shared_ptr<RowView> rv = std::make_shared<RowView>(*sch.second);
-        vers_views_.insert(std::make_pair(sch.first, rv));
-    }
-    if (vers_views_.empty()) {
-        LOG(WARNING) << "empty row views";
+    if (vers_schema_.empty() || vers_schema_.rbegin()->first <= 0 || vers_schema_.rbegin()->first > UINT8_MAX) {
+        LOG(WARNING) << "invalid schema versions";
         return false;
     }
-    const auto it = vers_views_.begin();
-    cur_schema_ = vers_schema_.find(it->first)->second;
-    cur_rv_ = it->second;
-    for (int32_t i = 0; i < plist_.size(); i++) {
-        uint32_t idx = plist_.Get(i);
-        const ::openmldb::common::ColumnDesc& column = cur_schema_->Get(idx);
-        output_schema_.Add()->CopyFrom(column);
+    // the columns are only appended on schema change, so the latest version has all of them
+    const Schema& latest_schema = *vers_schema_.rbegin()->second;
+    if (max_idx_ >= static_cast<uint32_t>(latest_schema.size())) {
+        LOG(WARNING) << "projected column " << max_idx_ << " is not in schema";
+        return false;
     }
-    row_builder_ = new RowBuilder(output_schema_);
-    return true;
-}
-
-bool RowProject::Project(const int8_t* row_ptr, uint32_t size, int8_t** output_ptr, uint32_t* out_size) {
-    if (row_ptr == NULL || output_ptr == NULL || out_size == NULL) return false;
-    uint8_t version = openmldb::codec::RowView::GetSchemaVersion(row_ptr);
-    if (version != cur_ver_) {
-        auto it = vers_views_.find(version);
-        if (it == vers_views_.end()) {
-            LOG(WARNING) << "not found valid row view for ver " << unsigned(version);
-            return false;
+    layouts_.resize(vers_schema_.rbegin()->first + 1);
+    for (const auto& sch : vers_schema_) {
+        const Schema& schema = *sch.second;
+        if (sch.first <= 0 || schema.size() == 0) {
+            continue;
         }
-        cur_rv_ = it->second;
-        cur_ver_ = version;
-        cur_schema_ = vers_schema_.find(version)->second;
-    }
-    bool ok = cur_rv_->Reset(row_ptr, size);
-    if (!ok) return false;
-    uint32_t str_size = 0;
-    for (int32_t i = 0; i < plist_.size(); i++) {
-        uint32_t idx = plist_.Get(i);
-        const ::openmldb::common::ColumnDesc& column = cur_schema_->Get(idx);
-        if (column.data_type() == ::openmldb::type::kVarchar || column.data_type() == ::openmldb::type::kString) {
-            if (cur_rv_->IsNULL(idx)) continue;
-            uint32_t length = 0;
-            char* content = nullptr;
-            int32_t ret = cur_rv_->GetString(idx, &content, &length);
-            if (ret != 0) {
+        // the same field offsets as RowView::Init
+        std::vector<uint32_t> field_offsets;
+        uint32_t offset = HEADER_LENGTH + BitMapSize(schema.size());
+        uint32_t str_field_cnt = 0;
+        for (int idx = 0; idx < schema.size(); idx++) {
+            ::openmldb::type::DataType cur_type = schema.Get(idx).data_type();
+            if (IsStringType(cur_type)) {
+                field_offsets.push_back(str_field_cnt);
+                str_field_cnt++;
+            } else if (cur_type < TYPE_SIZE_ARRAY.size() && cur_type > 0) {
+                field_offsets.push_back(offset);
+                offset += TYPE_SIZE_ARRAY[cur_type];
+            } else {
+                PDLOG(WARNING, "type %s is not supported in schema version %d",
+                      ::openmldb::type::DataType_Name(cur_type).c_str(), sch.first);
                 return false;
             }
-            str_size += length;
-        }
-    }
-    uint32_t total_size = row_builder_->CalTotalLength(str_size);
-    char* ptr = new char[total_size];
-    row_builder_->SetBuffer(reinterpret_cast<int8_t*>(ptr), total_size);
-    for (int32_t i = 0; i < plist_.size(); i++) {
-        uint32_t idx = plist_.Get(i);
-        const ::openmldb::common::ColumnDesc& column = cur_schema_->Get(idx);
-        int32_t ret = 0;
-        if (cur_rv_->IsNULL(idx)) {
-            row_builder_->AppendNULL();
-            continue;
         }
-        switch (column.data_type()) {
-            case ::openmldb::type::kBool: {
-                bool val = false;
-                ret = cur_rv_->GetBool(idx, &val);
-                if (ret == 0) row_builder_->AppendBool(val);
-                break;
-            }
-            case ::openmldb::type::kSmallInt: {
-                int16_t val = 0;
-                ret = cur_rv_->GetInt16(idx, &val);
-                if (ret == 0) row_builder_->AppendInt16(val);
-                break;
+        SourceLayout& layout = layouts_[sch.first];
+        layout.col_cnt = schema.size();
+        layout.str_field_start_offset = offset;
+        layout.str_field_cnt = str_field_cnt;
+        for (uint32_t idx : plist_) {
+            if (idx >= layout.col_cnt) {
+                layout.offsets.push_back(0);
+                continue;
             }
-            case ::openmldb::type::kInt: {
-                int32_t val = 0;
-                ret = cur_rv_->GetInt32(idx, &val);
-                if (ret == 0) row_builder_->AppendInt32(val);
-                break;
+            if (schema.Get(idx).data_type() != latest_schema.Get(idx).data_type()) {
+                PDLOG(WARNING, "type of column %u mismatch in schema version %d", idx, sch.first);
+                return false;
             }
-            case ::openmldb::type::kDate: {
-                int32_t val = 0;
-                ret = cur_rv_->GetDate(idx, &val);
-                if (ret == 0) row_builder_->AppendDate(val);
-                break;
+            layout.offsets.push_back(field_offsets[idx]);
+        }
+    }
+    for (uint32_t idx : plist_) {
+        output_schema_.Add()->CopyFrom(latest_schema.Get(idx));
+    }
+    // the same field offsets as RowBuilder
+    dst_str_field_start_offset_ = HEADER_LENGTH + BitMapSize(output_schema_.size());
+    for (int i = 0; i < output_schema_.size(); i++) {
+        ::openmldb::type::DataType cur_type = output_schema_.Get(i).data_type();
+        types_.push_back(cur_type);
+        if (IsStringType(cur_type)) {
+            dst_offsets_.push_back(dst_str_field_cnt_);
+            dst_str_field_cnt_++;
+        } else {
+            dst_offsets_.push_back(dst_str_field_start_offset_);
+            dst_str_field_start_offset_ += TYPE_SIZE_ARRAY[cur_type];
+        }
+    }
+    return true;
+}
+
+const RowProjectPlan::SourceLayout* RowProjectPlan::GetLayout(const int8_t* row_ptr, uint32_t row_size) const {
+    if (row_size <= HEADER_LENGTH || RowView::GetSize(row_ptr) != row_size) {
+        PDLOG(WARNING, "invalid row size %u", row_size);
+        return nullptr;
+    }
+    uint8_t version = RowView::GetSchemaVersion(row_ptr);
+    if (version >= layouts_.size() || layouts_[version].col_cnt == 0) {
+        LOG(WARNING) << "not found valid row view for ver " << unsigned(version);
+        return nullptr;
+    }
+    return &layouts_[version];
+}
+
+uint32_t RowProjectPlan::CalcOutputSize(const SourceLayout& layout, const int8_t* row_ptr, uint32_t row_size) const {
+    uint32_t total_length = dst_str_field_start_offset_;
+    if (dst_str_field_cnt_ > 0) {
+        uint8_t addr_length = GetAddrLength(row_size);
+        const int8_t* addr_ptr = row_ptr + layout.str_field_start_offset;
+        for (uint32_t i = 0; i < types_.size(); i++) {
+            if (!IsStringType(types_[i]) || plist_[i] >= layout.col_cnt || IsFieldNULL(row_ptr, plist_[i])) {
+                continue;
             }
-            case ::openmldb::type::kBigInt: {
-                int64_t val = 0;
-                ret = cur_rv_->GetInt64(idx, &val);
-                if (ret == 0) row_builder_->AppendInt64(val);
-                break;
+            uint32_t pos = layout.offsets[i];
+            uint32_t str_offset = GetStrOffset(addr_ptr + pos * addr_length, addr_length);
+            uint32_t next_offset = row_size;
+            if (pos + 1 < layout.str_field_cnt) {
+                next_offset = GetStrOffset(addr_ptr + (pos + 1) * addr_length, addr_length);
             }
-            case ::openmldb::type::kTimestamp: {
-                int64_t val = 0;
-                ret = cur_rv_->GetTimestamp(idx, &val);
-                if (ret == 0) row_builder_->AppendTimestamp(val);
-                break;
+            if (str_offset > next_offset || next_offset > row_size) {
+                return 0;
             }
-            case ::openmldb::type::kFloat: {
-                float val = 0;
-                ret = cur_rv_->GetFloat(idx, &val);
-                if (ret == 0) row_builder_->AppendFloat(val);
-                break;
+            total_length += next_offset - str_offset;
+        }
+    }
+    // the same as RowBuilder::CalTotalLength
+    if (total_length + dst_str_field_cnt_ <= UINT8_MAX) {
+        return total_length + dst_str_field_cnt_;
+    } else if (total_length + dst_str_field_cnt_ * 2 <= UINT16_MAX) {
+        return total_length + dst_str_field_cnt_ * 2;
+    } else if (total_length + dst_str_field_cnt_ * 3 <= UINT24_MAX) {
+        return total_length + dst_str_field_cnt_ * 3;
+    } else if (static_cast<uint64_t>(total_length) + dst_str_field_cnt_ * 4 <= UINT32_MAX) {
+        return total_length + dst_str_field_cnt_ * 4;
+    }
+    return 0;
+}
+
+void RowProjectPlan::Fill(const SourceLayout& layout, const int8_t* row_ptr, uint32_t row_size, int8_t* buf,
+                          uint32_t size) const {
+    *(buf) = 1;  // FVersion
+    *(buf + 1) = 1;  // SVersion
+    *(reinterpret_cast<uint32_t*>(buf + VERSION_LENGTH)) = size;
+    memset(buf + HEADER_LENGTH, 0xFF, BitMapSize(types_.size()));
+    uint8_t src_addr_length = GetAddrLength(row_size);
+    const int8_t* src_addr_ptr = row_ptr + layout.str_field_start_offset;
+    uint8_t dst_addr_length = GetAddrLength(size);
+    int8_t* dst_addr_ptr = buf + dst_str_field_start_offset_;
+    uint32_t dst_str_offset = dst_str_field_start_offset_ + dst_addr_length * dst_str_field_cnt_;
+    for (uint32_t i = 0; i < types_.size(); i++) {
+        bool is_null = plist_[i] >= layout.col_cnt || IsFieldNULL(row_ptr, plist_[i]);
+        if (!is_null) {
+            buf[HEADER_LENGTH + (i >> 3)] &= ~(1 << (i & 0x07));
+        }
+        if (!IsStringType(types_[i])) {
+            uint32_t field_size = TYPE_SIZE_ARRAY[types_[i]];
+            if (is_null) {
+                memset(buf + dst_offsets_[i], 0, field_size);
+            } else {
+                memcpy(buf + dst_offsets_[i], row_ptr + layout.offsets[i], field_size);
             }
-            case ::openmldb::type::kDouble: {
-                double val = 0;
-                ret = cur_rv_->GetDouble(idx, &val);
-                if (ret == 0) row_builder_->AppendDouble(val);
-                break;
+            continue;
+        }
+        uint32_t dst_pos = dst_offsets_[i];
+        if (dst_pos == 0) {
+            SetStrOffset(dst_addr_ptr, dst_addr_length, dst_str_offset);
+        }
+        if (!is_null) {
+            uint32_t pos = layout.offsets[i];
+            uint32_t str_offset = GetStrOffset(src_addr_ptr + pos * src_addr_length, src_addr_length);
+            uint32_t next_offset = row_size;
+            if (pos + 1 < layout.str_field_cnt) {
+                next_offset = GetStrOffset(src_addr_ptr + (pos + 1) * src_addr_length, src_addr_length);
             }
-            case ::openmldb::type::kString:
-            case ::openmldb::type::kVarchar: {
-                char* val = NULL;
-                uint32_t size = 0;
-                ret = cur_rv_->GetString(idx, &val, &size);
-                if (ret == 0) row_builder_->AppendString(val, size);
-                break;
+            uint32_t length = next_offset - str_offset;
+            if (length > 0) {
+                memcpy(buf + dst_str_offset, row_ptr + str_offset, length);
             }
-            default: { PDLOG(WARNING, "not supported type"); }
+            dst_str_offset += length;
         }
-        if (ret != 0) {
-            delete[] ptr;
-            PDLOG(WARNING, "fail to project column %s with idx %u", column.name().c_str(), idx);
-            return false;
+        if (dst_pos + 1 < dst_str_field_cnt_) {
+            SetStrOffset(dst_addr_ptr + (dst_pos + 1) * dst_addr_length, dst_addr_length, dst_str_offset);
         }
     }
-    *output_ptr = reinterpret_cast<int8_t*>(ptr);
+}
+
+bool RowProjectPlan::Project(const int8_t* row_ptr, uint32_t row_size, int8_t** out_ptr, uint32_t* out_size) const {
+    if (row_ptr == NULL || out_ptr == NULL || out_size == NULL) return false;
+    const SourceLayout* layout = GetLayout(row_ptr, row_size);
+    if (layout == nullptr) return false;
+    uint32_t total_size = CalcOutputSize(*layout, row_ptr, row_size);
+    if (total_size == 0) {
+        PDLOG(WARNING, "invalid string field in row");
+        return false;
+    }
+    int8_t* ptr = new int8_t[total_size];
+    Fill(*layout, row_ptr, row_size, ptr, total_size);
+    *out_ptr = ptr;
     *out_size = total_size;
     return true;
 }
 
+bool RowProjectPlan::Project(const int8_t* row_ptr, uint32_t row_size, std::string* out) const {
+    if (row_ptr == NULL || out == NULL) return false;
+    const SourceLayout* layout = GetLayout(row_ptr, row_size);
+    if (layout == nullptr) return false;
+    uint32_t total_size = CalcOutputSize(*layout, row_ptr, row_size);
+    if (total_size == 0) {
+        PDLOG(WARNING, "invalid string field in row");
+        return false;
+    }
+    out->resize(total_size);
+    Fill(*layout, row_ptr, row_size, reinterpret_cast<int8_t*>(&(*out)[0]), total_size);
+    return true;
+}
+
+RowProject::RowProject(const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, const ProjectList& plist)
+    : plan_(vers_schema, plist) {}
+
+bool RowProject::Init() { return plan_.Init(); }
+
+bool RowProject::Project(const int8_t* row_ptr, uint32_t size, int8_t** output_ptr, uint32_t* out_size) {
+    return plan_.Project(row_ptr, size, output_ptr, out_size);
+}
+
 }  // namespace codec
 }  // namespace openmldb
@@ -45,33 +45,74 @@ struct RowContext;
 class RowBuilder;
 class RowView;
 class RowProject;
+class RowProjectPlan;
 
 // TODO(wangtaize) share the row codec context
 struct RowContext {};
 
+// The compiled layout of a projection. It is immutable after Init, so one plan
+// can be shared by all the requests on the same projection list. Project copies
+// the fixed fields and the string bytes from the row into the output buffer
+// directly by the offsets computed in Init, without decoding the values.
+class RowProjectPlan {
+ public:
+    RowProjectPlan(const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, const ProjectList& plist);
+
+    bool Init();
+
+    // the output is allocated with new[] and owned by the caller
+    bool Project(const int8_t* row_ptr, uint32_t row_size, int8_t** out_ptr, uint32_t* out_size) const;
+
+    bool Project(const int8_t* row_ptr, uint32_t row_size, std::string* out) const;
+
+    uint32_t GetMaxIdx() const { return max_idx_; }
+
+    const Schema& GetOutputSchema() const { return output_schema_; }
+
+ private:
+    // the offset of every projected column in the rows of one schema version. it is
+    // the field offset for fixed columns and the position in string fields for strings.
+    // the columns added after the version are not in the rows and projected as null
+    struct SourceLayout {
+        std::vector<uint32_t> offsets;
+        uint32_t col_cnt = 0;
+        uint32_t str_field_start_offset = 0;
+        uint32_t str_field_cnt = 0;
+    };
+
+    const SourceLayout* GetLayout(const int8_t* row_ptr, uint32_t row_size) const;
+    uint32_t CalcOutputSize(const SourceLayout& layout, const int8_t* row_ptr, uint32_t row_size) const;
+    void Fill(const SourceLayout& layout, const int8_t* row_ptr, uint32_t row_size, int8_t* buf,
+              uint32_t size) const;
+
+ private:
+    std::vector<uint32_t> plist_;
+    std::map<int32_t, std::shared_ptr<Schema>> vers_schema_;
+    Schema output_schema_;
+    uint32_t max_idx_;
+    std::vector<::openmldb::type::DataType> types_;
+    // the field offset of fixed columns or the position of string columns in output
+    std::vector<uint32_t> dst_offsets_;
+    uint32_t dst_str_field_start_offset_;
+    uint32_t dst_str_field_cnt_;
+    // indexed by the schema version, col_cnt is 0 for the unknown versions
+    std::vector<SourceLayout> layouts_;
+};
+
 class RowProject {
  public:
     RowProject(const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, const ProjectList& plist);
 
-    ~RowProject();
+    ~RowProject() = default;
 
     bool Init();
 
     bool Project(const int8_t* row_ptr, uint32_t row_size, int8_t** out_ptr, uint32_t* out_size);
 
-    uint32_t GetMaxIdx() { return max_idx_; }
+    uint32_t GetMaxIdx() { return plan_.GetMaxIdx(); }
 
  private:
-    const ProjectList& plist_;
-    Schema output_schema_;
-    // TODO(wangtaize) share the init overhead
-    RowBuilder* row_builder_;
-    std::shared_ptr<Schema> cur_schema_;
-    std::shared_ptr<RowView> cur_rv_;
-    uint32_t max_idx_;
-    std::map<int32_t, std::shared_ptr<RowView>> vers_views_;
-    std::map<int32_t, std::shared_ptr<Schema>> vers_schema_;
-    uint32_t cur_ver_;
+    RowProjectPlan plan_;
 };
 
 class RowBuilder {
@@ -154,6 +195,12 @@ class RowView {
 
     static uint8_t GetSchemaVersion(const int8_t* row) { return *(reinterpret_cast<const uint8_t*>(row + 1)); }
 
+    // Read the rows written under the older schema versions in vers_schema as well. The schema of the view
+    // is the latest version, as the columns are only appended on schema change. The columns added after
+    // the version of a row answer as null without re-encoding the row, and the rows of the latest version
+    // cost one more compare of the version byte. return false if a version is not a prefix of the schema
+    bool SetVersions(const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema);
+
     int32_t GetBool(uint32_t idx, bool* val) const;
     int32_t GetInt32(uint32_t idx, int32_t* val) const;
     int32_t GetInt64(uint32_t idx, int64_t* val) const;
@@ -166,6 +213,10 @@ class RowView {
     int32_t GetDate(uint32_t idx, int32_t* date) const;
     bool IsNULL(uint32_t idx) const { return IsNULL(row_, idx); }
     inline bool IsNULL(const int8_t* row, uint32_t idx) const {
+        const VersionLayout* layout = GetOldLayout(row);
+        if (layout != nullptr && idx >= layout->col_cnt) {
+            return true;
+        }
         const int8_t* ptr = row + HEADER_LENGTH + (idx >> 3);
         return *(reinterpret_cast<const uint8_t*>(ptr)) & (1 << (idx & 0x07));
     }
@@ -184,10 +235,42 @@ class RowView {
     int32_t GetStrValue(const int8_t* row, uint32_t idx, std::string* val) const;
     int32_t GetStrValue(uint32_t idx, std::string* val) const;
 
+    // decode the fixed width column idx of row_cnt rows of this schema into values,
+    // which holds row_cnt values of the column type. nulls[i] is set to 1 if the
+    // column of rows[i] is null, and values[i] is zero then
+    int32_t GetColumn(const int8_t* const* rows, uint32_t row_cnt, uint32_t idx, void* values,
+                      uint8_t* nulls) const;
+
  private:
+    // the layout of the rows of an older schema version, which have the first col_cnt columns of the view
+    struct VersionLayout {
+        uint32_t col_cnt = 0;
+        uint32_t string_field_cnt = 0;
+        uint32_t str_field_start_offset = 0;
+        std::vector<uint32_t> offset_vec;
+    };
+
     bool Init();
     bool CheckValid(uint32_t idx, ::openmldb::type::DataType type) const;
 
+    // nullptr for the rows of the latest version or of an unknown version, which use the layout of the view
+    inline const VersionLayout* GetOldLayout(const int8_t* row) const {
+        if (old_layouts_.empty()) {
+            return nullptr;
+        }
+        uint8_t version = GetSchemaVersion(row);
+        if (version == version_ || version >= old_layouts_.size() || old_layouts_[version].col_cnt == 0) {
+            return nullptr;
+        }
+        return &old_layouts_[version];
+    }
+
+    // the field offset of a fixed column or the position of a string column in the row
+    inline uint32_t GetOffset(const int8_t* row, uint32_t idx) const {
+        const VersionLayout* layout = GetOldLayout(row);
+        return layout == nullptr ? offset_vec_.at(idx) : layout->offset_vec.at(idx);
+    }
+
  private:
     uint8_t str_addr_length_;
     bool is_valid_;
@@ -197,6 +280,9 @@ class RowView {
     const int8_t* row_;
     const Schema& schema_;
     std::vector<uint32_t> offset_vec_;
+    uint8_t version_;
+    // indexed by the schema version, col_cnt is 0 for the versions not set
+    std::vector<VersionLayout> old_layouts_;
 };
 
 namespace v1 {
@@ -14,7 +14,10 @@
  * limitations under the License.
  */
 
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/glog_wapper.h"
@@ -398,6 +401,160 @@ TEST_P(ProjectCodecTest, common_case) {
     CompareRow(&left, &right, args->output_schema);
 }
 
+TEST_F(ProjectCodecTest, project_plan_multi_version) {
+    Schema schema;
+    auto add_column = [](Schema* schema, const std::string& name, type::DataType data_type) {
+        common::ColumnDesc* column = schema->Add();
+        column->set_name(name);
+        column->set_data_type(data_type);
+    };
+    add_column(&schema, "col1", type::kString);
+    add_column(&schema, "col2", type::kBigInt);
+    add_column(&schema, "col3", type::kString);
+    add_column(&schema, "col4", type::kDouble);
+    Schema schema_v2(schema);
+    add_column(&schema_v2, "col5", type::kString);
+    std::map<int32_t, std::shared_ptr<Schema>> vers_schema;
+    vers_schema.insert(std::make_pair(1, std::make_shared<Schema>(schema)));
+    vers_schema.insert(std::make_pair(2, std::make_shared<Schema>(schema_v2)));
+    ProjectList plist;
+    for (uint32_t idx : {3, 2, 0, 1}) {
+        plist.Add(idx);
+    }
+    RowProjectPlan plan(vers_schema, plist);
+    ASSERT_TRUE(plan.Init());
+    ASSERT_EQ(3u, plan.GetMaxIdx());
+    Schema output_schema;
+    add_column(&output_schema, "col4", type::kDouble);
+    add_column(&output_schema, "col3", type::kString);
+    add_column(&output_schema, "col1", type::kString);
+    add_column(&output_schema, "col2", type::kBigInt);
+    ASSERT_EQ(4, plan.GetOutputSchema().size());
+
+    // the long string makes the rows use two bytes string address
+    std::string long_str(300, 'x');
+    for (int32_t ver : {1, 2}) {
+        for (bool has_null : {false, true}) {
+            const Schema& cur_schema = ver == 1 ? schema : schema_v2;
+            std::string col1 = has_null ? "" : "hello";
+            std::string col5 = "world";
+            RowBuilder input_rb(cur_schema);
+            input_rb.SetSchemaVersion(ver);
+            uint32_t str_size = col1.size() + long_str.size() + (ver == 2 ? col5.size() : 0);
+            uint32_t input_size = input_rb.CalTotalLength(str_size);
+            std::string input(input_size, '\0');
+            input_rb.SetBuffer(reinterpret_cast<int8_t*>(&input[0]), input_size);
+            if (has_null) {
+                input_rb.AppendNULL();
+                input_rb.AppendInt64(10);
+                input_rb.AppendString(long_str.c_str(), long_str.size());
+                input_rb.AppendNULL();
+            } else {
+                input_rb.AppendString(col1.c_str(), col1.size());
+                input_rb.AppendInt64(10);
+                input_rb.AppendString(long_str.c_str(), long_str.size());
+                input_rb.AppendDouble(1.5);
+            }
+            if (ver == 2) {
+                input_rb.AppendString(col5.c_str(), col5.size());
+            }
+
+            RowBuilder output_rb(output_schema);
+            uint32_t output_size = output_rb.CalTotalLength(col1.size() + long_str.size());
+            std::string expect(output_size, '\0');
+            output_rb.SetBuffer(reinterpret_cast<int8_t*>(&expect[0]), output_size);
+            if (has_null) {
+                output_rb.AppendNULL();
+                output_rb.AppendString(long_str.c_str(), long_str.size());
+                output_rb.AppendNULL();
+            } else {
+                output_rb.AppendDouble(1.5);
+                output_rb.AppendString(long_str.c_str(), long_str.size());
+                output_rb.AppendString(col1.c_str(), col1.size());
+            }
+            output_rb.AppendInt64(10);
+
+            int8_t* output = NULL;
+            uint32_t size = 0;
+            ASSERT_TRUE(plan.Project(reinterpret_cast<const int8_t*>(input.data()), input.size(), &output, &size));
+            ASSERT_EQ(output_size, size);
+            RowView left(output_schema);
+            ASSERT_TRUE(left.Reset(output, size));
+            RowView right(output_schema);
+            ASSERT_TRUE(right.Reset(reinterpret_cast<const int8_t*>(expect.data()), expect.size()));
+            CompareRow(&left, &right, output_schema);
+
+            std::string str_output;
+            ASSERT_TRUE(plan.Project(reinterpret_cast<const int8_t*>(input.data()), input.size(), &str_output));
+            ASSERT_EQ(std::string(reinterpret_cast<char*>(output), size), str_output);
+            delete[] output;
+        }
+    }
+    // the size in row header mismatch
+    std::string invalid(32, '\0');
+    std::string str_output;
+    ASSERT_FALSE(plan.Project(reinterpret_cast<const int8_t*>(invalid.data()), invalid.size(), &str_output));
+}
+
+TEST_F(ProjectCodecTest, project_plan_added_column) {
+    Schema schema;
+    auto add_column = [](Schema* schema, const std::string& name, type::DataType data_type) {
+        common::ColumnDesc* column = schema->Add();
+        column->set_name(name);
+        column->set_data_type(data_type);
+    };
+    add_column(&schema, "col1", type::kString);
+    add_column(&schema, "col2", type::kBigInt);
+    Schema schema_v2(schema);
+    add_column(&schema_v2, "col3", type::kString);
+    add_column(&schema_v2, "col4", type::kInt);
+    std::map<int32_t, std::shared_ptr<Schema>> vers_schema;
+    vers_schema.insert(std::make_pair(1, std::make_shared<Schema>(schema)));
+    vers_schema.insert(std::make_pair(2, std::make_shared<Schema>(schema_v2)));
+    ProjectList plist;
+    for (uint32_t idx : {3, 0, 2}) {
+        plist.Add(idx);
+    }
+    RowProjectPlan plan(vers_schema, plist);
+    ASSERT_TRUE(plan.Init());
+
+    RowBuilder input_rb(schema);
+    std::string col1 = "hello";
+    uint32_t input_size = input_rb.CalTotalLength(col1.size());
+    std::string input(input_size, '\0');
+    input_rb.SetBuffer(reinterpret_cast<int8_t*>(&input[0]), input_size);
+    input_rb.AppendString(col1.c_str(), col1.size());
+    input_rb.AppendInt64(10);
+
+    // the columns added after the version of the row are projected as null
+    std::string output;
+    ASSERT_TRUE(plan.Project(reinterpret_cast<const int8_t*>(input.data()), input.size(), &output));
+    RowView view(plan.GetOutputSchema());
+    ASSERT_TRUE(view.Reset(reinterpret_cast<const int8_t*>(output.data()), output.size()));
+    ASSERT_TRUE(view.IsNULL(0));
+    char* ch = NULL;
+    uint32_t length = 0;
+    ASSERT_EQ(0, view.GetString(1, &ch, &length));
+    ASSERT_EQ(col1, std::string(ch, length));
+    ASSERT_TRUE(view.IsNULL(2));
+}
+
+TEST_F(ProjectCodecTest, project_plan_invalid) {
+    Schema schema;
+    common::ColumnDesc* column = schema.Add();
+    column->set_name("col1");
+    column->set_data_type(type::kInt);
+    std::map<int32_t, std::shared_ptr<Schema>> vers_schema;
+    vers_schema.insert(std::make_pair(1, std::make_shared<Schema>(schema)));
+    ProjectList empty_plist;
+    RowProjectPlan empty_plan(vers_schema, empty_plist);
+    ASSERT_FALSE(empty_plan.Init());
+    ProjectList plist;
+    plist.Add(1);
+    RowProjectPlan plan(vers_schema, plist);
+    ASSERT_FALSE(plan.Init());
+}
+
 INSTANTIATE_TEST_SUITE_P(ProjectCodecTestPrefix, ProjectCodecTest, testing::ValuesIn(GenCommonCase()));
 
 }  // namespace codec
@@ -544,6 +544,166 @@ TEST_F(CodecTest, RowBuilderSet) {
     ASSERT_EQ(ret, st);
 }
 
+TEST_F(CodecTest, GetColumn) {
+    Schema schema;
+    ::openmldb::common::ColumnDesc* col = schema.Add();
+    col->set_name("col1");
+    col->set_data_type(::openmldb::type::kVarchar);
+    col = schema.Add();
+    col->set_name("col2");
+    col->set_data_type(::openmldb::type::kBool);
+    col = schema.Add();
+    col->set_name("col3");
+    col->set_data_type(::openmldb::type::kBigInt);
+    col = schema.Add();
+    col->set_name("col4");
+    col->set_data_type(::openmldb::type::kDouble);
+    col = schema.Add();
+    col->set_name("col5");
+    col->set_data_type(::openmldb::type::kSmallInt);
+    const uint32_t row_cnt = 100;
+    std::vector<std::string> rows(row_cnt);
+    std::vector<const int8_t*> row_ptrs;
+    RowBuilder builder(schema);
+    for (uint32_t i = 0; i < row_cnt; i++) {
+        std::string str = "value" + std::to_string(i);
+        uint32_t size = builder.CalTotalLength(str.size());
+        rows[i].resize(size);
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&(rows[i][0])), size);
+        ASSERT_TRUE(builder.AppendString(str.c_str(), str.size()));
+        ASSERT_TRUE(builder.AppendBool(i % 2 == 0));
+        if (i % 3 == 0) {
+            ASSERT_TRUE(builder.AppendNULL());
+        } else {
+            ASSERT_TRUE(builder.AppendInt64(i * 1000));
+        }
+        ASSERT_TRUE(builder.AppendDouble(i + 0.5));
+        if (i % 7 == 0) {
+            ASSERT_TRUE(builder.AppendNULL());
+        } else {
+            ASSERT_TRUE(builder.AppendInt16(i));
+        }
+        row_ptrs.push_back(reinterpret_cast<const int8_t*>(rows[i].data()));
+    }
+    RowView view(schema);
+    std::vector<uint8_t> nulls(row_cnt);
+    std::vector<int64_t> int64_values(row_cnt);
+    ASSERT_EQ(0, view.GetColumn(row_ptrs.data(), row_cnt, 2, int64_values.data(), nulls.data()));
+    for (uint32_t i = 0; i < row_cnt; i++) {
+        ASSERT_EQ(i % 3 == 0, nulls[i] == 1);
+        ASSERT_EQ(i % 3 == 0 ? 0 : i * 1000, int64_values[i]);
+    }
+    std::vector<double> double_values(row_cnt);
+    ASSERT_EQ(0, view.GetColumn(row_ptrs.data(), row_cnt, 3, double_values.data(), nulls.data()));
+    for (uint32_t i = 0; i < row_cnt; i++) {
+        ASSERT_EQ(0, nulls[i]);
+        ASSERT_DOUBLE_EQ(i + 0.5, double_values[i]);
+    }
+    std::vector<int16_t> int16_values(row_cnt);
+    ASSERT_EQ(0, view.GetColumn(row_ptrs.data(), row_cnt, 4, int16_values.data(), nulls.data()));
+    for (uint32_t i = 0; i < row_cnt; i++) {
+        ASSERT_EQ(i % 7 == 0, nulls[i] == 1);
+        ASSERT_EQ(i % 7 == 0 ? 0 : static_cast<int16_t>(i), int16_values[i]);
+    }
+    bool bool_values[row_cnt];
+    ASSERT_EQ(0, view.GetColumn(row_ptrs.data(), row_cnt, 1, bool_values, nulls.data()));
+    for (uint32_t i = 0; i < row_cnt; i++) {
+        ASSERT_EQ(i % 2 == 0, bool_values[i]);
+    }
+    // string column and invalid index
+    ASSERT_EQ(-1, view.GetColumn(row_ptrs.data(), row_cnt, 0, int64_values.data(), nulls.data()));
+    ASSERT_EQ(-1, view.GetColumn(row_ptrs.data(), row_cnt, 5, int64_values.data(), nulls.data()));
+}
+
+TEST_F(CodecTest, SchemaVersions) {
+    auto add_column = [](Schema* schema, const std::string& name, ::openmldb::type::DataType data_type) {
+        ::openmldb::common::ColumnDesc* col = schema->Add();
+        col->set_name(name);
+        col->set_data_type(data_type);
+    };
+    auto schema = std::make_shared<Schema>();
+    add_column(schema.get(), "col0", ::openmldb::type::kVarchar);
+    add_column(schema.get(), "col1", ::openmldb::type::kBigInt);
+    for (int i = 2; i < 8; i++) {
+        add_column(schema.get(), "col" + std::to_string(i), ::openmldb::type::kInt);
+    }
+    // the added columns make the bitmap one byte longer
+    auto schema_v2 = std::make_shared<Schema>(*schema);
+    add_column(schema_v2.get(), "col8", ::openmldb::type::kDouble);
+    add_column(schema_v2.get(), "col9", ::openmldb::type::kString);
+
+    std::vector<std::string> rows;
+    for (int32_t ver : {1, 2}) {
+        RowBuilder builder(ver == 1 ? *schema : *schema_v2);
+        builder.SetSchemaVersion(ver);
+        std::string str = "hello" + std::to_string(ver);
+        uint32_t size = builder.CalTotalLength(ver == 1 ? str.size() : str.size() * 2);
+        std::string row(size, '\0');
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), size);
+        ASSERT_TRUE(builder.AppendString(str.c_str(), str.size()));
+        ASSERT_TRUE(builder.AppendInt64(ver * 100));
+        for (int i = 2; i < 8; i++) {
+            ASSERT_TRUE(builder.AppendInt32(i));
+        }
+        if (ver == 2) {
+            ASSERT_TRUE(builder.AppendDouble(1.5));
+            ASSERT_TRUE(builder.AppendString(str.c_str(), str.size()));
+        }
+        rows.push_back(row);
+    }
+
+    RowView view(*schema_v2);
+    Schema mismatch(*schema);
+    mismatch.Mutable(1)->set_data_type(::openmldb::type::kInt);
+    ASSERT_FALSE(view.SetVersions({{1, std::make_shared<Schema>(mismatch)}, {2, schema_v2}}));
+    ASSERT_FALSE(view.SetVersions({{1, schema}}));
+    ASSERT_TRUE(view.SetVersions({{1, schema}, {2, schema_v2}}));
+    for (int32_t ver : {1, 2}) {
+        const int8_t* row = reinterpret_cast<const int8_t*>(rows[ver - 1].data());
+        std::string expect = "hello" + std::to_string(ver);
+        char* ch = nullptr;
+        uint32_t length = 0;
+        ASSERT_EQ(0, view.GetValue(row, 0, &ch, &length));
+        ASSERT_EQ(expect, std::string(ch, length));
+        int64_t val = 0;
+        ASSERT_EQ(0, view.GetValue(row, 1, ::openmldb::type::kBigInt, &val));
+        ASSERT_EQ(ver * 100, val);
+        int32_t int_val = 0;
+        ASSERT_EQ(0, view.GetValue(row, 7, ::openmldb::type::kInt, &int_val));
+        ASSERT_EQ(7, int_val);
+        // the columns added after version 1 are null in its rows
+        ASSERT_EQ(ver == 1, view.IsNULL(row, 8));
+        ASSERT_EQ(ver == 1, view.IsNULL(row, 9));
+        double double_val = 0;
+        ASSERT_EQ(ver == 1 ? 1 : 0, view.GetValue(row, 8, ::openmldb::type::kDouble, &double_val));
+        ASSERT_EQ(ver == 1 ? 1 : 0, view.GetValue(row, 9, &ch, &length));
+        std::string str_val;
+        view.GetStrValue(row, 9, &str_val);
+        ASSERT_EQ(ver == 1 ? "null" : expect, str_val);
+
+        ASSERT_TRUE(view.Reset(row, rows[ver - 1].size()));
+        ASSERT_EQ(0, view.GetInt64(1, &val));
+        ASSERT_EQ(ver * 100, val);
+        ASSERT_EQ(0, view.GetString(0, &ch, &length));
+        ASSERT_EQ(expect, std::string(ch, length));
+        ASSERT_EQ(ver == 1 ? 1 : 0, view.GetDouble(8, &double_val));
+    }
+
+    std::vector<const int8_t*> row_ptrs;
+    for (const auto& row : rows) {
+        row_ptrs.push_back(reinterpret_cast<const int8_t*>(row.data()));
+    }
+    std::vector<uint8_t> nulls(rows.size());
+    std::vector<int64_t> int64_values(rows.size());
+    ASSERT_EQ(0, view.GetColumn(row_ptrs.data(), row_ptrs.size(), 1, int64_values.data(), nulls.data()));
+    ASSERT_EQ(std::vector<int64_t>({100, 200}), int64_values);
+    ASSERT_EQ(std::vector<uint8_t>({0, 0}), nulls);
+    std::vector<double> double_values(rows.size());
+    ASSERT_EQ(0, view.GetColumn(row_ptrs.data(), row_ptrs.size(), 8, double_values.data(), nulls.data()));
+    ASSERT_EQ(std::vector<double>({0, 1.5}), double_values);
+    ASSERT_EQ(std::vector<uint8_t>({1, 0}), nulls);
+}
+
 }  // namespace codec
 }  // namespace openmldb
 
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec/cold_row_codec.h"
+
+#include <string.h>
+#include <zlib.h>
+
+#include <memory>
+
+namespace openmldb {
+namespace codec {
+
+// FVersion and the deflated length
+static constexpr uint32_t COLD_HEADER_LENGTH = 5;
+// raw deflate without the zlib header and checksum, which a row is too short to afford
+static constexpr int COLD_WINDOW_BITS = -15;
+
+void ColdRowCodec::Train(const std::string& samples) {
+    if (samples.size() > kMaxDictSize) {
+        dict_ = samples.substr(samples.size() - kMaxDictSize);
+    } else {
+        dict_ = samples;
+    }
+}
+
+char* ColdRowCodec::Encode(const char* row, uint32_t size, uint32_t* cold_size) const {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, COLD_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nullptr;
+    }
+    if (!dict_.empty() &&
+        deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dict_.data()), dict_.size()) != Z_OK) {
+        deflateEnd(&stream);
+        return nullptr;
+    }
+    uLong bound = deflateBound(&stream, size);
+    std::unique_ptr<char[]> buf(new char[bound]);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(row));
+    stream.avail_in = size;
+    stream.next_out = reinterpret_cast<Bytef*>(buf.get());
+    stream.avail_out = bound;
+    int ret = deflate(&stream, Z_FINISH);
+    uint32_t len = bound - stream.avail_out;
+    deflateEnd(&stream);
+    if (ret != Z_STREAM_END || COLD_HEADER_LENGTH + len >= size) {
+        return nullptr;
+    }
+    char* cold = new char[COLD_HEADER_LENGTH + len];
+    cold[0] = static_cast<char>(COLD_FVERSION);
+    memcpy(cold + 1, &len, sizeof(len));
+    memcpy(cold + COLD_HEADER_LENGTH, buf.get(), len);
+    *cold_size = COLD_HEADER_LENGTH + len;
+    return cold;
+}
+
+bool ColdRowCodec::Decode(const char* data, uint32_t raw_size, std::string* out) const {
+    if (static_cast<uint8_t>(data[0]) != COLD_FVERSION) {
+        return false;
+    }
+    uint32_t len = 0;
+    memcpy(&len, data + 1, sizeof(len));
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, COLD_WINDOW_BITS) != Z_OK) {
+        return false;
+    }
+    if (!dict_.empty() &&
+        inflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dict_.data()), dict_.size()) != Z_OK) {
+        inflateEnd(&stream);
+        return false;
+    }
+    size_t offset = out->size();
+    out->resize(offset + raw_size);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + COLD_HEADER_LENGTH));
+    stream.avail_in = len;
+    stream.next_out = reinterpret_cast<Bytef*>(&(*out)[offset]);
+    stream.avail_out = raw_size;
+    int ret = inflate(&stream, Z_FINISH);
+    bool ok = ret == Z_STREAM_END && stream.avail_out == 0;
+    inflateEnd(&stream);
+    if (!ok) {
+        out->resize(offset);
+    }
+    return ok;
+}
+
+}  // namespace codec
+}  // namespace openmldb
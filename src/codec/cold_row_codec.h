@@ -0,0 +1,63 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_CODEC_COLD_ROW_CODEC_H_
+#define SRC_CODEC_COLD_ROW_CODEC_H_
+
+#include <stdint.h>
+
+#include <string>
+
+namespace openmldb {
+namespace codec {
+
+// the first byte of a cold row, see COMPACT_FVERSION for the others. a raw row may start with the same byte, so
+// the storage tells a cold row by its block, see storage::IsColdData, and Decode only checks the byte
+static constexpr uint8_t COLD_FVERSION = 0x82;
+
+// ColdRowCodec deflates the rows rarely read any more, as the rows of a table
+// share most of their bytes with each other. A cold row is
+//   FVersion(0x82) | deflated length(4 bytes) | deflated bytes
+// and the bytes are deflated with the preset dictionary of the codec, which is
+// trained once from the sample rows before the first row is encoded. A short
+// row gains little from deflating on its own, the dictionary lets it refer to
+// the bytes of the sample rows instead. The size of the row before deflating is
+// kept by the caller. Encode and Decode are thread safe after Train.
+class ColdRowCodec {
+ public:
+    // the most bytes of the dictionary deflate can refer to
+    static constexpr uint32_t kMaxDictSize = 32 * 1024;
+
+    ColdRowCodec() = default;
+
+    // set the dictionary from the sample rows, the last kMaxDictSize bytes are kept. it is called only once
+    void Train(const std::string& samples);
+    bool IsTrained() const { return !dict_.empty(); }
+
+    // the cold row allocated with new[], nullptr if deflating fails or it is not smaller than the row
+    char* Encode(const char* row, uint32_t size, uint32_t* cold_size) const;
+
+    // inflate the cold row of raw_size bytes into `out`, false if it is not a cold row or is corrupted
+    bool Decode(const char* data, uint32_t raw_size, std::string* out) const;
+
+ private:
+    std::string dict_;
+};
+
+}  // namespace codec
+}  // namespace openmldb
+
+#endif  // SRC_CODEC_COLD_ROW_CODEC_H_
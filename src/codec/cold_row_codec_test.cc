@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec/cold_row_codec.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace codec {
+
+class ColdRowCodecTest : public ::testing::Test {};
+
+static std::string MakeRow(int i) {
+    return std::string(1, 1) + "card" + std::to_string(i % 10) + "|merchant_name_of_the_shop|city_" +
+           std::to_string(i % 3) + "|" + std::to_string(1000000 + i);
+}
+
+TEST_F(ColdRowCodecTest, EncodeDecode) {
+    ColdRowCodec codec;
+    ASSERT_FALSE(codec.IsTrained());
+    std::string samples;
+    for (int i = 0; i < 100; i++) {
+        samples += MakeRow(i);
+    }
+    codec.Train(samples);
+    ASSERT_TRUE(codec.IsTrained());
+    for (int i = 100; i < 110; i++) {
+        std::string row = MakeRow(i);
+        uint32_t cold_size = 0;
+        std::unique_ptr<char[]> cold(codec.Encode(row.data(), row.size(), &cold_size));
+        ASSERT_TRUE(cold != nullptr);
+        // the row is mostly found in the dictionary
+        ASSERT_LT(cold_size * 2, row.size());
+        ASSERT_EQ(COLD_FVERSION, static_cast<uint8_t>(cold[0]));
+        std::string decoded = "prefix";
+        // a raw row is not decoded
+        ASSERT_FALSE(codec.Decode(row.data(), row.size(), &decoded));
+        ASSERT_TRUE(codec.Decode(cold.get(), row.size(), &decoded));
+        ASSERT_EQ("prefix" + row, decoded);
+    }
+}
+
+TEST_F(ColdRowCodecTest, NotSmaller) {
+    ColdRowCodec codec;
+    codec.Train("abc");
+    // a short row without anything in common with the dictionary is kept as it is
+    std::string row = "\x01xyz";
+    uint32_t cold_size = 0;
+    ASSERT_TRUE(codec.Encode(row.data(), row.size(), &cold_size) == nullptr);
+}
+
+TEST_F(ColdRowCodecTest, TrainKeepsTail) {
+    std::string samples(ColdRowCodec::kMaxDictSize, 'a');
+    samples += MakeRow(1);
+    ColdRowCodec codec;
+    codec.Train(samples);
+    std::string row = MakeRow(1);
+    uint32_t cold_size = 0;
+    std::unique_ptr<char[]> cold(codec.Encode(row.data(), row.size(), &cold_size));
+    ASSERT_TRUE(cold != nullptr);
+    std::string decoded;
+    ASSERT_TRUE(codec.Decode(cold.get(), row.size(), &decoded));
+    ASSERT_EQ(row, decoded);
+    // decoding with another dictionary fails or gives another row
+    ColdRowCodec other;
+    other.Train("other dictionary");
+    decoded.clear();
+    ASSERT_FALSE(other.Decode(cold.get(), row.size(), &decoded) && decoded == row);
+}
+
+}  // namespace codec
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
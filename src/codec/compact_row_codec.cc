@@ -0,0 +1,421 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "codec/compact_row_codec.h"
+
+#include <cstring>
+#include <utility>
+
+namespace openmldb {
+namespace codec {
+
+static void PutVarint(std::string* out, uint64_t val) {
+    while (val >= 0x80) {
+        out->push_back(static_cast<char>(val | 0x80));
+        val >>= 7;
+    }
+    out->push_back(static_cast<char>(val));
+}
+
+static bool GetVarint(const char* data, uint32_t size, uint32_t* pos, uint64_t* val) {
+    uint64_t result = 0;
+    for (uint32_t shift = 0; shift <= 63 && *pos < size; shift += 7) {
+        uint64_t byte = static_cast<uint8_t>(data[(*pos)++]);
+        result |= (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *val = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint64_t ZigZag(int64_t val) { return (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63); }
+
+static inline int64_t UnZigZag(uint64_t val) { return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1); }
+
+static inline bool IsString(::openmldb::type::DataType type) {
+    return type == ::openmldb::type::kVarchar || type == ::openmldb::type::kString;
+}
+
+CompactRowCodec::CompactRowCodec(uint32_t max_dict_size, uint32_t max_dict_value_len)
+    : max_dict_size_(max_dict_size),
+      max_dict_value_len_(max_dict_value_len),
+      mu_(),
+      versions_(std::make_shared<VersionMap>()),
+      dicts_(std::make_shared<DictVec>()) {}
+
+void CompactRowCodec::SetVersionSchema(const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto versions = std::make_shared<VersionMap>();
+    auto dicts = std::make_shared<DictVec>(*std::atomic_load_explicit(&dicts_, std::memory_order_acquire));
+    for (const auto& kv : vers_schema) {
+        versions->emplace(kv.first, std::make_shared<Version>(kv.second));
+        const auto& schema = *kv.second;
+        if (dicts->size() < static_cast<size_t>(schema.size())) {
+            dicts->resize(schema.size());
+        }
+        for (int i = 0; i < schema.size(); i++) {
+            if (max_dict_size_ > 0 && !(*dicts)[i] && IsString(schema.Get(i).data_type())) {
+                (*dicts)[i] = std::make_shared<Dict>(max_dict_size_);
+            }
+        }
+    }
+    std::atomic_store_explicit(&dicts_, dicts, std::memory_order_release);
+    std::atomic_store_explicit(&versions_, versions, std::memory_order_release);
+}
+
+int64_t CompactRowCodec::GetDictId(Dict* dict, const char* val, uint32_t len) {
+    if (dict == nullptr || len > max_dict_value_len_) {
+        return -1;
+    }
+    std::string key(val, len);
+    std::lock_guard<std::mutex> lock(dict->mu);
+    auto it = dict->ids.find(key);
+    if (it != dict->ids.end()) {
+        return it->second;
+    }
+    uint32_t id = dict->size.load(std::memory_order_relaxed);
+    if (id >= max_dict_size_) {
+        return -1;
+    }
+    dict->values[id] = key;
+    dict->ids.emplace(std::move(key), id);
+    dict->size.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+std::map<uint32_t, std::vector<std::string>> CompactRowCodec::GetDict() const {
+    std::map<uint32_t, std::vector<std::string>> result;
+    auto dicts = std::atomic_load_explicit(&dicts_, std::memory_order_acquire);
+    for (uint32_t i = 0; i < dicts->size(); i++) {
+        const Dict* dict = (*dicts)[i].get();
+        uint32_t size = dict == nullptr ? 0 : dict->size.load(std::memory_order_acquire);
+        if (size > 0) {
+            result.emplace(i, std::vector<std::string>(dict->values.get(), dict->values.get() + size));
+        }
+    }
+    return result;
+}
+
+bool CompactRowCodec::SetDict(uint32_t idx, const std::vector<std::string>& values) {
+    auto dicts = std::atomic_load_explicit(&dicts_, std::memory_order_acquire);
+    Dict* dict = idx < dicts->size() ? (*dicts)[idx].get() : nullptr;
+    if (dict == nullptr) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(dict->mu);
+    uint32_t size = dict->size.load(std::memory_order_relaxed);
+    if (size > 0) {
+        return false;
+    }
+    for (const auto& value : values) {
+        if (size >= max_dict_size_) {
+            break;
+        }
+        if (value.size() > max_dict_value_len_ || !dict->ids.emplace(value, size).second) {
+            continue;
+        }
+        dict->values[size++] = value;
+    }
+    dict->size.store(size, std::memory_order_release);
+    return true;
+}
+
+bool CompactRowCodec::Encode(const char* row, uint32_t size, std::string* out) {
+    const int8_t* row_ptr = reinterpret_cast<const int8_t*>(row);
+    if (row == nullptr || size <= HEADER_LENGTH || *row_ptr != 1 || RowView::GetSize(row_ptr) != size) {
+        return false;
+    }
+    uint8_t ver = RowView::GetSchemaVersion(row_ptr);
+    auto versions = std::atomic_load_explicit(&versions_, std::memory_order_acquire);
+    auto dicts = std::atomic_load_explicit(&dicts_, std::memory_order_acquire);
+    auto it = versions->find(ver);
+    if (it == versions->end()) {
+        return false;
+    }
+    const auto& schema = *it->second->schema;
+    const auto& view = it->second->view;
+    out->clear();
+    out->push_back(static_cast<char>(COMPACT_FVERSION));
+    out->push_back(static_cast<char>(ver));
+    int32_t prev = -1;
+    for (int32_t i = 0; i < schema.size(); i++) {
+        if (view.IsNULL(row_ptr, i)) {
+            continue;
+        }
+        auto type = schema.Get(i).data_type();
+        PutVarint(out, i - prev - 1);
+        prev = i;
+        switch (type) {
+            case ::openmldb::type::kBool: {
+                bool val = false;
+                view.GetValue(row_ptr, i, type, &val);
+                out->push_back(val ? 1 : 0);
+                break;
+            }
+            case ::openmldb::type::kSmallInt: {
+                int16_t val = 0;
+                view.GetValue(row_ptr, i, type, &val);
+                PutVarint(out, ZigZag(val));
+                break;
+            }
+            case ::openmldb::type::kInt:
+            case ::openmldb::type::kDate: {
+                int32_t val = 0;
+                view.GetValue(row_ptr, i, type, &val);
+                PutVarint(out, ZigZag(val));
+                break;
+            }
+            case ::openmldb::type::kBigInt:
+            case ::openmldb::type::kTimestamp: {
+                int64_t val = 0;
+                view.GetValue(row_ptr, i, type, &val);
+                PutVarint(out, ZigZag(val));
+                break;
+            }
+            case ::openmldb::type::kFloat: {
+                float val = 0;
+                view.GetValue(row_ptr, i, type, &val);
+                out->append(reinterpret_cast<const char*>(&val), sizeof(float));
+                break;
+            }
+            case ::openmldb::type::kDouble: {
+                double val = 0;
+                view.GetValue(row_ptr, i, type, &val);
+                out->append(reinterpret_cast<const char*>(&val), sizeof(double));
+                break;
+            }
+            case ::openmldb::type::kString:
+            case ::openmldb::type::kVarchar: {
+                char* val = nullptr;
+                uint32_t len = 0;
+                if (view.GetValue(row_ptr, i, &val, &len) != 0) {
+                    return false;
+                }
+                int64_t id = GetDictId(static_cast<size_t>(i) < dicts->size() ? (*dicts)[i].get() : nullptr, val, len);
+                if (id >= 0) {
+                    PutVarint(out, static_cast<uint64_t>(id) << 1 | 1);
+                } else {
+                    PutVarint(out, static_cast<uint64_t>(len) << 1);
+                    out->append(val, len);
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool CompactRowCodec::Parse(const Version& version, const DictVec& dicts, const char* data, uint32_t size,
+                            const std::vector<bool>* columns, RowBuilder* builder, uint32_t* str_len) const {
+    const auto& schema = *version.schema;
+    *str_len = 0;
+    uint32_t pos = VERSION_LENGTH;
+    int64_t prev = -1;
+    uint64_t val = 0;
+    while (pos < size) {
+        if (!GetVarint(data, size, &pos, &val)) {
+            return false;
+        }
+        int64_t idx = prev + 1 + static_cast<int64_t>(val);
+        if (idx >= schema.size()) {
+            return false;
+        }
+        if (builder != nullptr) {
+            for (int64_t i = prev + 1; i < idx; i++) {
+                if (!builder->AppendNULL()) {
+                    return false;
+                }
+            }
+        }
+        prev = idx;
+        // the values of the columns out of `columns` are skipped and decoded as null
+        bool keep = columns == nullptr || (static_cast<size_t>(idx) < columns->size() && (*columns)[idx]);
+        if (!keep && builder != nullptr && !builder->AppendNULL()) {
+            return false;
+        }
+        RowBuilder* col_builder = keep ? builder : nullptr;
+        bool ok = true;
+        switch (schema.Get(idx).data_type()) {
+            case ::openmldb::type::kBool: {
+                if (pos >= size) {
+                    return false;
+                }
+                bool v = data[pos++] != 0;
+                ok = col_builder == nullptr || col_builder->AppendBool(v);
+                break;
+            }
+            case ::openmldb::type::kSmallInt:
+                if (!GetVarint(data, size, &pos, &val)) {
+                    return false;
+                }
+                ok = col_builder == nullptr || col_builder->AppendInt16(static_cast<int16_t>(UnZigZag(val)));
+                break;
+            case ::openmldb::type::kInt:
+                if (!GetVarint(data, size, &pos, &val)) {
+                    return false;
+                }
+                ok = col_builder == nullptr || col_builder->AppendInt32(static_cast<int32_t>(UnZigZag(val)));
+                break;
+            case ::openmldb::type::kDate:
+                if (!GetVarint(data, size, &pos, &val)) {
+                    return false;
+                }
+                ok = col_builder == nullptr || col_builder->AppendDate(static_cast<int32_t>(UnZigZag(val)));
+                break;
+            case ::openmldb::type::kBigInt:
+                if (!GetVarint(data, size, &pos, &val)) {
+                    return false;
+                }
+                ok = col_builder == nullptr || col_builder->AppendInt64(UnZigZag(val));
+                break;
+            case ::openmldb::type::kTimestamp:
+                if (!GetVarint(data, size, &pos, &val)) {
+                    return false;
+                }
+                ok = col_builder == nullptr || col_builder->AppendTimestamp(UnZigZag(val));
+                break;
+            case ::openmldb::type::kFloat: {
+                if (pos + sizeof(float) > size) {
+                    return false;
+                }
+                float v = 0;
+                memcpy(&v, data + pos, sizeof(float));
+                pos += sizeof(float);
+                ok = col_builder == nullptr || col_builder->AppendFloat(v);
+                break;
+            }
+            case ::openmldb::type::kDouble: {
+                if (pos + sizeof(double) > size) {
+                    return false;
+                }
+                double v = 0;
+                memcpy(&v, data + pos, sizeof(double));
+                pos += sizeof(double);
+                ok = col_builder == nullptr || col_builder->AppendDouble(v);
+                break;
+            }
+            case ::openmldb::type::kString:
+            case ::openmldb::type::kVarchar: {
+                if (!GetVarint(data, size, &pos, &val)) {
+                    return false;
+                }
+                const char* str = nullptr;
+                uint32_t len = 0;
+                if (val & 1) {
+                    uint64_t id = val >> 1;
+                    const Dict* dict = static_cast<size_t>(idx) < dicts.size() ? dicts[idx].get() : nullptr;
+                    if (dict == nullptr || id >= dict->size.load(std::memory_order_acquire)) {
+                        return false;
+                    }
+                    str = dict->values[id].data();
+                    len = dict->values[id].size();
+                } else {
+                    len = static_cast<uint32_t>(val >> 1);
+                    if (pos + len > size) {
+                        return false;
+                    }
+                    str = data + pos;
+                    pos += len;
+                }
+                if (keep) {
+                    *str_len += len;
+                }
+                ok = col_builder == nullptr || col_builder->AppendString(str, len);
+                break;
+            }
+            default:
+                return false;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    if (builder != nullptr) {
+        for (int64_t i = prev + 1; i < schema.size(); i++) {
+            if (!builder->AppendNULL()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Alloc>
+int8_t* CompactRowCodec::DecodeTo(const char* data, uint32_t size, const std::vector<bool>* columns,
+                                  uint32_t* row_size, Alloc alloc) const {
+    if (!IsCompact(data, size) || size < VERSION_LENGTH) {
+        return nullptr;
+    }
+    auto versions = std::atomic_load_explicit(&versions_, std::memory_order_acquire);
+    auto dicts = std::atomic_load_explicit(&dicts_, std::memory_order_acquire);
+    auto it = versions->find(static_cast<uint8_t>(data[1]));
+    if (it == versions->end()) {
+        return nullptr;
+    }
+    const Version& version = *it->second;
+    uint32_t str_len = 0;
+    if (!Parse(version, *dicts, data, size, columns, nullptr, &str_len)) {
+        return nullptr;
+    }
+    RowBuilder builder(*version.schema);
+    uint32_t total = builder.CalTotalLength(str_len);
+    if (total == 0) {
+        return nullptr;
+    }
+    int8_t* buf = alloc(total);
+    memset(buf, 0, total);
+    builder.SetSchemaVersion(static_cast<uint8_t>(data[1]));
+    if (!builder.SetBuffer(buf, total) || !Parse(version, *dicts, data, size, columns, &builder, &str_len)) {
+        return nullptr;
+    }
+    *row_size = total;
+    return buf;
+}
+
+bool CompactRowCodec::Decode(const char* data, uint32_t size, std::string* out) const {
+    size_t offset = out->size();
+    uint32_t row_size = 0;
+    int8_t* buf = DecodeTo(data, size, nullptr, &row_size, [out, offset](uint32_t total) {
+        out->resize(offset + total);
+        return reinterpret_cast<int8_t*>(&(*out)[offset]);
+    });
+    if (buf == nullptr) {
+        out->resize(offset);
+        return false;
+    }
+    return true;
+}
+
+int8_t* CompactRowCodec::Decode(const char* data, uint32_t size, uint32_t* row_size,
+                                const std::vector<bool>* columns) const {
+    int8_t* allocated = nullptr;
+    int8_t* buf = DecodeTo(data, size, columns, row_size, [&allocated](uint32_t total) {
+        allocated = reinterpret_cast<int8_t*>(malloc(total));
+        return allocated;
+    });
+    if (buf == nullptr) {
+        free(allocated);
+    }
+    return buf;
+}
+
+}  // namespace codec
+}  // namespace openmldb
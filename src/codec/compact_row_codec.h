@@ -0,0 +1,119 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_CODEC_COMPACT_ROW_CODEC_H_
+#define SRC_CODEC_COMPACT_ROW_CODEC_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "codec/codec.h"
+
+namespace openmldb {
+namespace codec {
+
+// the first byte of a compact row, the rows built by RowBuilder start with 1
+static constexpr uint8_t COMPACT_FVERSION = 0x81;
+
+// CompactRowCodec turns the rows built by RowBuilder into a compact format for
+// keeping in memory, and turns them back on read. A compact row is
+//   FVersion(0x81) | SVersion | column...
+// and only the non-null columns are kept, each of them as the varint gap to the
+// previous non-null column followed by the value:
+//   bool:             one byte
+//   int16/int32/int64/timestamp/date: zigzag varint
+//   float/double:     the raw 4 or 8 bytes
+//   string:           varint (id << 1 | 1) of the dictionary entry of the column,
+//                     or varint (length << 1) followed by the bytes
+// The dictionary of a string column keeps the first max_dict_size distinct values
+// no longer than max_dict_value_len, the later values are kept inline. The entries
+// are never removed, so a row refers to its entries as long as the codec lives.
+// Encode and Decode are thread safe.
+class CompactRowCodec {
+ public:
+    CompactRowCodec(uint32_t max_dict_size, uint32_t max_dict_value_len);
+
+    // update the schemas on schema change, the dictionaries of the existing columns are kept
+    void SetVersionSchema(const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema);
+
+    static bool IsCompact(const char* data, uint32_t size) {
+        return size > 0 && static_cast<uint8_t>(data[0]) == COMPACT_FVERSION;
+    }
+
+    // return false if the row is invalid or the schema version is unknown
+    bool Encode(const char* row, uint32_t size, std::string* out);
+
+    // the row built by RowBuilder is appended to `out`
+    bool Decode(const char* data, uint32_t size, std::string* out) const;
+
+    // the row is allocated with malloc and owned by the caller, nullptr if fails.
+    // only the columns set in `columns` are decoded if it is not null, the others are null in the row
+    int8_t* Decode(const char* data, uint32_t size, uint32_t* row_size,
+                   const std::vector<bool>* columns = nullptr) const;
+
+    // the values in the dictionaries keyed by the column index, the position of a value is its id
+    std::map<uint32_t, std::vector<std::string>> GetDict() const;
+
+    // restore the dictionary of a column saved by GetDict before any row is encoded, so the ids stay the
+    // same across restarts. return false if the dictionary of the column is missing or in use
+    bool SetDict(uint32_t idx, const std::vector<std::string>& values);
+
+ private:
+    struct Version {
+        explicit Version(const std::shared_ptr<Schema>& s) : schema(s), view(*s) {}
+        std::shared_ptr<Schema> schema;
+        RowView view;
+    };
+
+    struct Dict {
+        explicit Dict(uint32_t capacity) : values(new std::string[capacity]), size(0) {}
+        std::mutex mu;
+        std::unordered_map<std::string, uint32_t> ids;
+        // the values below size are immutable, size is published after the value is set
+        std::unique_ptr<std::string[]> values;
+        std::atomic<uint32_t> size;
+    };
+
+    using VersionMap = std::map<int32_t, std::shared_ptr<Version>>;
+    using DictVec = std::vector<std::shared_ptr<Dict>>;
+
+    // walk the columns of the compact row, the total length of strings is set in str_len.
+    // the columns are appended to builder if it is not null, the ones out of `columns` as null
+    bool Parse(const Version& version, const DictVec& dicts, const char* data, uint32_t size,
+               const std::vector<bool>* columns, RowBuilder* builder, uint32_t* str_len) const;
+    // return the decoded row in the buffer allocated by alloc
+    template <typename Alloc>
+    int8_t* DecodeTo(const char* data, uint32_t size, const std::vector<bool>* columns, uint32_t* row_size,
+                     Alloc alloc) const;
+    // return -1 if the dictionary is full or the value is too long
+    int64_t GetDictId(Dict* dict, const char* val, uint32_t len);
+
+    uint32_t max_dict_size_;
+    uint32_t max_dict_value_len_;
+    std::mutex mu_;
+    std::shared_ptr<VersionMap> versions_;
+    std::shared_ptr<DictVec> dicts_;
+};
+
+}  // namespace codec
+}  // namespace openmldb
+
+#endif  // SRC_CODEC_COMPACT_ROW_CODEC_H_
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "codec/compact_row_codec.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace codec {
+
+class CompactRowCodecTest : public ::testing::Test {};
+
+static void AddColumn(Schema* schema, const std::string& name, ::openmldb::type::DataType type) {
+    auto* col = schema->Add();
+    col->set_name(name);
+    col->set_data_type(type);
+}
+
+// c0 bigint, c1 string, c2 double, c3 date, c4 timestamp, c5 bool, c6 smallint, c7..c19 string
+static std::shared_ptr<Schema> MakeSchema() {
+    auto schema = std::make_shared<Schema>();
+    AddColumn(schema.get(), "c0", ::openmldb::type::kBigInt);
+    AddColumn(schema.get(), "c1", ::openmldb::type::kString);
+    AddColumn(schema.get(), "c2", ::openmldb::type::kDouble);
+    AddColumn(schema.get(), "c3", ::openmldb::type::kDate);
+    AddColumn(schema.get(), "c4", ::openmldb::type::kTimestamp);
+    AddColumn(schema.get(), "c5", ::openmldb::type::kBool);
+    AddColumn(schema.get(), "c6", ::openmldb::type::kSmallInt);
+    for (int i = 7; i < 20; i++) {
+        AddColumn(schema.get(), "c" + std::to_string(i), ::openmldb::type::kString);
+    }
+    return schema;
+}
+
+static std::string BuildRow(const Schema& schema, int64_t val, const std::string& str) {
+    RowBuilder builder(schema);
+    uint32_t size = builder.CalTotalLength(str.size() + 3);
+    std::string row(size, 0);
+    builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), size);
+    builder.AppendInt64(val);
+    builder.AppendString(str.data(), str.size());
+    builder.AppendDouble(1.5);
+    builder.AppendDate(2022, 1, 1);
+    builder.AppendTimestamp(1650000000000L + val);
+    builder.AppendBool(true);
+    builder.AppendInt16(-3);
+    for (int i = 7; i < 19; i++) {
+        builder.AppendNULL();
+    }
+    builder.AppendString("abc", 3);
+    return row;
+}
+
+TEST_F(CompactRowCodecTest, EncodeDecode) {
+    auto schema = MakeSchema();
+    CompactRowCodec codec(4, 16);
+    codec.SetVersionSchema({{1, schema}});
+    std::string row = BuildRow(*schema, 10, "hello");
+    std::string compact;
+    ASSERT_TRUE(codec.Encode(row.data(), row.size(), &compact));
+    ASSERT_TRUE(CompactRowCodec::IsCompact(compact.data(), compact.size()));
+    ASSERT_FALSE(CompactRowCodec::IsCompact(row.data(), row.size()));
+    ASSERT_LT(compact.size(), row.size());
+
+    std::string decoded;
+    ASSERT_TRUE(codec.Decode(compact.data(), compact.size(), &decoded));
+    ASSERT_EQ(row, decoded);
+    uint32_t size = 0;
+    int8_t* buf = codec.Decode(compact.data(), compact.size(), &size);
+    ASSERT_TRUE(buf != nullptr);
+    ASSERT_EQ(row, std::string(reinterpret_cast<char*>(buf), size));
+    free(buf);
+
+    RowView view(*schema, reinterpret_cast<const int8_t*>(decoded.data()), decoded.size());
+    int16_t small = 0;
+    ASSERT_EQ(0, view.GetInt16(6, &small));
+    ASSERT_EQ(-3, small);
+    ASSERT_TRUE(view.IsNULL(10));
+    std::string str;
+    ASSERT_EQ(0, view.GetStrValue(19, &str));
+    ASSERT_EQ("abc", str);
+
+    ASSERT_FALSE(codec.Decode(compact.data(), compact.size() - 1, &decoded));
+    ASSERT_FALSE(codec.Encode(compact.data(), compact.size(), &decoded));
+}
+
+TEST_F(CompactRowCodecTest, DecodeColumns) {
+    auto schema = MakeSchema();
+    CompactRowCodec codec(4, 16);
+    codec.SetVersionSchema({{1, schema}});
+    std::string row = BuildRow(*schema, 10, "a long string not in the dict");
+    std::string compact;
+    ASSERT_TRUE(codec.Encode(row.data(), row.size(), &compact));
+
+    // c0, c4 and c19 only, the columns beyond the mask are skipped too
+    std::vector<bool> columns(20, false);
+    columns[0] = true;
+    columns[4] = true;
+    columns[19] = true;
+    uint32_t size = 0;
+    int8_t* buf = codec.Decode(compact.data(), compact.size(), &size, &columns);
+    ASSERT_TRUE(buf != nullptr);
+    ASSERT_LT(size, row.size());
+    RowView view(*schema, buf, size);
+    int64_t val = 0;
+    ASSERT_EQ(0, view.GetInt64(0, &val));
+    ASSERT_EQ(10, val);
+    ASSERT_EQ(0, view.GetTimestamp(4, &val));
+    ASSERT_EQ(1650000000010L, val);
+    std::string str;
+    ASSERT_EQ(0, view.GetStrValue(19, &str));
+    ASSERT_EQ("abc", str);
+    for (uint32_t i : {1, 2, 3, 5, 6}) {
+        ASSERT_TRUE(view.IsNULL(i)) << i;
+    }
+    free(buf);
+
+    columns.resize(2);
+    buf = codec.Decode(compact.data(), compact.size(), &size, &columns);
+    ASSERT_TRUE(buf != nullptr);
+    RowView short_view(*schema, buf, size);
+    ASSERT_EQ(0, short_view.GetInt64(0, &val));
+    ASSERT_TRUE(short_view.IsNULL(19));
+    free(buf);
+}
+
+TEST_F(CompactRowCodecTest, Dict) {
+    auto schema = MakeSchema();
+    CompactRowCodec codec(2, 16);
+    codec.SetVersionSchema({{1, schema}});
+    std::string first, second;
+    ASSERT_TRUE(codec.Encode(BuildRow(*schema, 1, "k1").data(), BuildRow(*schema, 1, "k1").size(), &first));
+    // the dictionary of c1 is full after k2
+    std::string row = BuildRow(*schema, 1, "k2");
+    ASSERT_TRUE(codec.Encode(row.data(), row.size(), &second));
+    ASSERT_EQ(first.size(), second.size());
+    ASSERT_EQ(std::string::npos, second.find("k2"));
+    row = BuildRow(*schema, 1, "k3");
+    ASSERT_TRUE(codec.Encode(row.data(), row.size(), &second));
+    ASSERT_NE(std::string::npos, second.find("k3"));
+    std::string decoded;
+    ASSERT_TRUE(codec.Decode(second.data(), second.size(), &decoded));
+    ASSERT_EQ(row, decoded);
+    // the long value is kept inline
+    row = BuildRow(*schema, 1, std::string(20, 'x'));
+    ASSERT_TRUE(codec.Encode(row.data(), row.size(), &second));
+    decoded.clear();
+    ASSERT_TRUE(codec.Decode(second.data(), second.size(), &decoded));
+    ASSERT_EQ(row, decoded);
+}
+
+TEST_F(CompactRowCodecTest, SetDict) {
+    auto schema = MakeSchema();
+    CompactRowCodec codec(4, 16);
+    codec.SetVersionSchema({{1, schema}});
+    std::string row = BuildRow(*schema, 1, "k1");
+    std::string compact;
+    ASSERT_TRUE(codec.Encode(row.data(), row.size(), &compact));
+    auto dict = codec.GetDict();
+    ASSERT_EQ(2u, dict.size());
+    ASSERT_EQ(std::vector<std::string>({"k1"}), dict[1]);
+    ASSERT_EQ(std::vector<std::string>({"abc"}), dict[19]);
+    // the dictionary in use can not be replaced
+    ASSERT_FALSE(codec.SetDict(1, {"k2"}));
+    // only the string columns have dictionaries
+    ASSERT_FALSE(codec.SetDict(0, {"k2"}));
+
+    CompactRowCodec new_codec(4, 16);
+    new_codec.SetVersionSchema({{1, schema}});
+    for (const auto& kv : dict) {
+        ASSERT_TRUE(new_codec.SetDict(kv.first, kv.second));
+    }
+    // the restored ids are the same, so the old compact rows are decoded by the new codec
+    std::string decoded;
+    ASSERT_TRUE(new_codec.Decode(compact.data(), compact.size(), &decoded));
+    ASSERT_EQ(row, decoded);
+    std::string new_compact;
+    ASSERT_TRUE(new_codec.Encode(row.data(), row.size(), &new_compact));
+    ASSERT_EQ(compact, new_compact);
+    ASSERT_TRUE(new_codec.SetDict(7, {"a", "a", std::string(20, 'x'), "b", "c", "d", "e"}));
+    ASSERT_EQ(std::vector<std::string>({"a", "b", "c", "d"}), new_codec.GetDict()[7]);
+}
+
+TEST_F(CompactRowCodecTest, SchemaVersion) {
+    auto schema = MakeSchema();
+    CompactRowCodec codec(4, 16);
+    codec.SetVersionSchema({{1, schema}});
+    std::string row = BuildRow(*schema, 7, "v1");
+    std::string compact_v1;
+    ASSERT_TRUE(codec.Encode(row.data(), row.size(), &compact_v1));
+
+    auto schema_v2 = std::make_shared<Schema>(*schema);
+    AddColumn(schema_v2.get(), "c20", ::openmldb::type::kInt);
+    std::map<int32_t, std::shared_ptr<Schema>> versions = {{1, schema}, {2, schema_v2}};
+    codec.SetVersionSchema(versions);
+    RowBuilder builder(*schema_v2);
+    builder.SetSchemaVersion(2);
+    uint32_t size = builder.CalTotalLength(2);
+    std::string row_v2(size, 0);
+    builder.SetBuffer(reinterpret_cast<int8_t*>(&row_v2[0]), size);
+    builder.AppendInt64(8);
+    builder.AppendString("v1", 2);
+    for (int i = 2; i < 20; i++) {
+        builder.AppendNULL();
+    }
+    builder.AppendInt32(-100);
+    std::string compact_v2;
+    ASSERT_TRUE(codec.Encode(row_v2.data(), row_v2.size(), &compact_v2));
+
+    std::string decoded;
+    ASSERT_TRUE(codec.Decode(compact_v1.data(), compact_v1.size(), &decoded));
+    ASSERT_EQ(row, decoded);
+    decoded.clear();
+    ASSERT_TRUE(codec.Decode(compact_v2.data(), compact_v2.size(), &decoded));
+    ASSERT_EQ(row_v2, decoded);
+}
+
+}  // namespace codec
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
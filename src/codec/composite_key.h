@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SRC_CODEC_COMPOSITE_KEY_H_
+#define SRC_CODEC_COMPOSITE_KEY_H_
+
+#include <string>
+
+#include "base/hash.h"
+
+namespace openmldb {
+namespace codec {
+
+// CompositeKeyBuilder builds the key of a multi-column index, the values of the columns joined by '|', in a buffer
+// kept across the keys, so building and hashing the keys of the indexes of a row allocates nothing once the buffer
+// is large enough. The pid of the key is hashed over the buffer too. The key is handed over without a copy, by
+// Release, which moves the buffer out, or by ReleaseTo, which swaps it with the string of the caller so the buffers
+// of both are reused.
+//
+// The layout is the one the tablets store and the sql engine looks up by. As it always was, no separator follows
+// the leading empty values, e.g. the values "", "a" make the key "a".
+class CompositeKeyBuilder {
+ public:
+    CompositeKeyBuilder() : key_() {}
+
+    void Reset() { key_.clear(); }
+
+    void Append(const char* data, size_t size) {
+        if (!key_.empty()) {
+            key_.push_back('|');
+        }
+        key_.append(data, size);
+    }
+    void Append(const std::string& value) { Append(value.data(), value.size()); }
+
+    bool Empty() const { return key_.empty(); }
+    const std::string& Key() const { return key_; }
+
+    // move the buffer out as the key, the next key starts a new buffer
+    std::string Release() {
+        std::string key;
+        key.swap(key_);
+        return key;
+    }
+
+    // swap the key into *key, the buffer of *key is cleared and reused by the next key
+    void ReleaseTo(std::string* key) {
+        key->swap(key_);
+        key_.clear();
+    }
+
+    // the same as ::openmldb::base::hash64(Key())
+    int64_t Hash64() const { return ::openmldb::base::hash64(key_.data(), key_.size()); }
+
+    uint32_t GetPid(uint32_t pid_num) const {
+        return pid_num == 0 ? 0 : static_cast<uint32_t>(Hash64() % pid_num);
+    }
+
+ private:
+    std::string key_;
+};
+
+}  // namespace codec
+}  // namespace openmldb
+#endif  // SRC_CODEC_COMPOSITE_KEY_H_
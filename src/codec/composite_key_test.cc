@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "codec/composite_key.h"
+
+#include <string>
+#include <vector>
+
+#include "base/hash.h"
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace codec {
+
+class CompositeKeyTest : public ::testing::Test {};
+
+TEST_F(CompositeKeyTest, BuildKey) {
+    CompositeKeyBuilder builder;
+    ASSERT_TRUE(builder.Empty());
+    builder.Append("card");
+    builder.Append(std::string("mcc"));
+    builder.Append("1", 1);
+    ASSERT_EQ("card|mcc|1", builder.Key());
+    ASSERT_EQ(::openmldb::base::hash64(std::string("card|mcc|1")), builder.Hash64());
+    ASSERT_EQ(static_cast<uint32_t>(::openmldb::base::hash64(std::string("card|mcc|1")) % 8), builder.GetPid(8));
+    ASSERT_EQ(0u, builder.GetPid(0));
+
+    // the buffer is moved out without a copy, the values are longer than the short strings kept inline
+    builder.Reset();
+    builder.Append("card_0123456789");
+    builder.Append("mcc_0123456789");
+    const char* buf = builder.Key().data();
+    std::string key = builder.Release();
+    ASSERT_EQ("card_0123456789|mcc_0123456789", key);
+    ASSERT_EQ(buf, key.data());
+    ASSERT_TRUE(builder.Empty());
+
+    // the buffers are swapped, so the one of the caller is reused by the next key
+    builder.Append("key_0123456789abcdef");
+    buf = builder.Key().data();
+    std::string out(64, 'x');
+    const char* out_buf = out.data();
+    builder.ReleaseTo(&out);
+    ASSERT_EQ("key_0123456789abcdef", out);
+    ASSERT_EQ(buf, out.data());
+    ASSERT_TRUE(builder.Empty());
+    builder.Append("next_0123456789");
+    ASSERT_EQ("next_0123456789", builder.Key());
+    ASSERT_EQ(out_buf, builder.Key().data());
+
+    // no separator follows the leading empty values, as the keys stored before
+    builder.Reset();
+    builder.Append("");
+    builder.Append("");
+    builder.Append("a");
+    builder.Append("");
+    ASSERT_EQ("a|", builder.Key());
+}
+
+TEST_F(CompositeKeyTest, SameAsJoinedKey) {
+    std::vector<std::vector<std::string>> cases = {
+        {"a"}, {"a", "b"}, {"1234567", "89"}, {"abcdefgh", "ijklmnop", "q"}, {"!@#", "NULL", "empty_key"}};
+    CompositeKeyBuilder builder;
+    for (const auto& values : cases) {
+        std::string joined;
+        builder.Reset();
+        for (const auto& value : values) {
+            if (!joined.empty()) {
+                joined += "|";
+            }
+            joined += value;
+            builder.Append(value);
+        }
+        ASSERT_EQ(joined, builder.Key());
+        ASSERT_EQ(::openmldb::base::hash64(joined), builder.Hash64());
+    }
+}
+
+}  // namespace codec
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -280,10 +280,10 @@ static inline int32_t EncodeRows(const boost::container::deque<std::pair<uint64_
 }
 
 // encode pk, ts and value
-static inline void EncodeFull(const std::string& pk, uint64_t time, const char* data, const size_t size, char* buffer,
-                              uint32_t offset) {
-    buffer += offset;
-    uint32_t pk_size = pk.length();
+// the head of the pair encoded by EncodeFull, it is followed by the pk and the data
+constexpr uint32_t FULL_HEAD_SIZE = 16;
+
+static inline void EncodeFullHead(uint32_t pk_size, uint64_t time, const size_t size, char* buffer) {
     uint32_t total_size = 8 + pk_size + size;
     DEBUGLOG("encode total size %u pk size %u", total_size, pk_size);
     memcpy(buffer, static_cast<const void*>(&total_size), 4);
@@ -294,7 +294,14 @@ static inline void EncodeFull(const std::string& pk, uint64_t time, const char*
     buffer += 4;
     memcpy(buffer, static_cast<const void*>(&time), 8);
     memrev64ifbe(buffer);
-    buffer += 8;
+}
+
+static inline void EncodeFull(const std::string& pk, uint64_t time, const char* data, const size_t size, char* buffer,
+                              uint32_t offset) {
+    buffer += offset;
+    uint32_t pk_size = pk.length();
+    EncodeFullHead(pk_size, time, size, buffer);
+    buffer += FULL_HEAD_SIZE;
     memcpy(buffer, static_cast<const void*>(pk.c_str()), pk_size);
     buffer += pk_size;
     memcpy(buffer, static_cast<const void*>(data), size);
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec/row_ref_appender.h"
+
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace openmldb {
+namespace codec {
+
+// the owners, followed by the copy of the last row in the same allocation
+struct RowRefAppender::Holder {
+    std::vector<std::shared_ptr<void>> owners;
+};
+
+RowRefAppender::RowRefAppender(butil::IOBuf* buf, size_t min_ref_size)
+    : buf_(buf),
+      min_ref_size_(min_ref_size),
+      owners_(),
+      pending_(nullptr),
+      pending_size_(0),
+      ref_cnt_(0),
+      finished_(false) {}
+
+RowRefAppender::~RowRefAppender() { Finish(); }
+
+void RowRefAppender::Hold(std::shared_ptr<void> owner) { owners_.push_back(std::move(owner)); }
+
+bool RowRefAppender::AppendPending() {
+    if (pending_ == nullptr) {
+        return true;
+    }
+    int code = 0;
+    if (min_ref_size_ > 0 && pending_size_ >= min_ref_size_) {
+        code = buf_->append_user_data(const_cast<char*>(pending_), pending_size_, ReleaseNothing);
+        ref_cnt_ += code == 0 ? 1 : 0;
+    } else {
+        code = buf_->append(pending_, pending_size_);
+    }
+    pending_ = nullptr;
+    pending_size_ = 0;
+    return code == 0;
+}
+
+bool RowRefAppender::Append(const char* data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    bool ok = AppendPending();
+    pending_ = data;
+    pending_size_ = size;
+    return ok;
+}
+
+void RowRefAppender::ReleaseHolder(void* tail) {
+    auto* holder = reinterpret_cast<Holder*>(static_cast<char*>(tail) - sizeof(Holder));
+    holder->~Holder();
+    ::operator delete(holder);
+}
+
+bool RowRefAppender::Finish() {
+    if (finished_) {
+        return true;
+    }
+    finished_ = true;
+    if (ref_cnt_ == 0) {
+        bool ok = AppendPending();
+        owners_.clear();
+        return ok;
+    }
+    // a row is referred to, so there is a row after it
+    char* mem = static_cast<char*>(::operator new(sizeof(Holder) + pending_size_));
+    new (mem) Holder{std::move(owners_)};
+    char* tail = mem + sizeof(Holder);
+    memcpy(tail, pending_, pending_size_);
+    if (buf_->append_user_data(tail, pending_size_, ReleaseHolder) != 0) {
+        // the owners are leaked rather than free the rows referred to
+        LOG(WARNING) << "fail to append the tail of " << pending_size_ << " bytes, leak the owners of "
+                     << ref_cnt_ << " rows";
+        return false;
+    }
+    pending_ = nullptr;
+    pending_size_ = 0;
+    return true;
+}
+
+}  // namespace codec
+}  // namespace openmldb
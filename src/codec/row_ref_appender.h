@@ -0,0 +1,75 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_CODEC_ROW_REF_APPENDER_H_
+#define SRC_CODEC_ROW_REF_APPENDER_H_
+
+#include <memory>
+#include <vector>
+
+#include "butil/iobuf.h"
+
+namespace openmldb {
+namespace codec {
+
+// RowRefAppender appends the rows to an IOBuf by reference instead of copying them, for the rows which stay valid
+// as long as their owners, like the rows of a memory table pinned by the tickets of a scan.
+//
+// The owners are released with the last row, which is copied into the block holding them. The blocks of an IOBuf
+// are released from the front, both when the buf is cleared and when it is written to the socket, so the rows
+// referred to are released before the owners. Nothing may be appended to the buf after Finish.
+class RowRefAppender {
+ public:
+    // the rows smaller than min_ref_size are copied, as referring to them costs more than copying
+    RowRefAppender(butil::IOBuf* buf, size_t min_ref_size);
+    ~RowRefAppender();
+    RowRefAppender(const RowRefAppender&) = delete;
+    RowRefAppender& operator=(const RowRefAppender&) = delete;
+
+    // keep the owner alive until the rows appended are released
+    void Hold(std::shared_ptr<void> owner);
+
+    // the row must stay valid until the owners are released
+    bool Append(const char* data, size_t size);
+
+    // append the last row and hand the owners over to the buf, it is called by the destructor if not yet
+    bool Finish();
+
+    // the count of the rows appended by reference
+    size_t GetRefCnt() const { return ref_cnt_; }
+
+ private:
+    struct Holder;
+
+    static void ReleaseHolder(void* tail);
+    static void ReleaseNothing(void*) {}
+
+    bool AppendPending();
+
+    butil::IOBuf* buf_;
+    const size_t min_ref_size_;
+    std::vector<std::shared_ptr<void>> owners_;
+    // the row appended last, which is held back as it may be the tail
+    const char* pending_;
+    size_t pending_size_;
+    size_t ref_cnt_;
+    bool finished_;
+};
+
+}  // namespace codec
+}  // namespace openmldb
+
+#endif  // SRC_CODEC_ROW_REF_APPENDER_H_
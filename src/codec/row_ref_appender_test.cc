@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec/row_ref_appender.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace codec {
+
+class RowRefAppenderTest : public ::testing::Test {};
+
+TEST_F(RowRefAppenderTest, Append) {
+    auto rows = std::make_shared<std::vector<std::string>>();
+    rows->push_back(std::string(100, 'a'));
+    rows->push_back(std::string(10, 'b'));
+    rows->push_back(std::string(200, 'c'));
+    rows->push_back(std::string(300, 'd'));
+    std::weak_ptr<std::vector<std::string>> weak_rows = rows;
+    std::string expect;
+    {
+        butil::IOBuf buf;
+        {
+            RowRefAppender appender(&buf, 100);
+            appender.Hold(rows);
+            for (const auto& row : *rows) {
+                ASSERT_TRUE(appender.Append(row.data(), row.size()));
+                expect += row;
+            }
+            ASSERT_TRUE(appender.Finish());
+            // the last one is copied
+            ASSERT_EQ(2u, appender.GetRefCnt());
+        }
+        rows.reset();
+        // held by the buf
+        ASSERT_FALSE(weak_rows.expired());
+        ASSERT_EQ(expect, buf.to_string());
+    }
+    ASSERT_TRUE(weak_rows.expired());
+}
+
+TEST_F(RowRefAppenderTest, CopyAll) {
+    auto rows = std::make_shared<std::vector<std::string>>(3, std::string(10, 'a'));
+    std::weak_ptr<std::vector<std::string>> weak_rows = rows;
+    butil::IOBuf buf;
+    {
+        RowRefAppender appender(&buf, 100);
+        appender.Hold(rows);
+        for (const auto& row : *rows) {
+            ASSERT_TRUE(appender.Append(row.data(), row.size()));
+        }
+        // finished by the destructor
+    }
+    rows.reset();
+    // nothing referred to, the owners are released at once
+    ASSERT_TRUE(weak_rows.expired());
+    ASSERT_EQ(std::string(30, 'a'), buf.to_string());
+
+    // 0 disables the references
+    buf.clear();
+    std::string row(1000, 'b');
+    RowRefAppender appender(&buf, 0);
+    ASSERT_TRUE(appender.Append(row.data(), row.size()));
+    ASSERT_TRUE(appender.Append(row.data(), row.size()));
+    ASSERT_TRUE(appender.Finish());
+    ASSERT_EQ(0u, appender.GetRefCnt());
+    ASSERT_EQ(row + row, buf.to_string());
+}
+
+}  // namespace codec
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
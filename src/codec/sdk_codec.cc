@@ -31,7 +31,8 @@ SDKCodec::SDKCodec(const ::openmldb::nameserver::TableInfo& table_info)
       base_schema_size_(0),
       modify_times_(0),
       version_schema_(),
-      last_ver_(1) {
+      last_ver_(1),
+      router_(table_info.table_partition_size(), table_info.partition_split()) {
     if (table_info.column_desc_size() > 0) {
         ParseColumnDesc(table_info.column_desc());
     }
@@ -52,7 +53,11 @@ SDKCodec::SDKCodec(const ::openmldb::nameserver::TableInfo& table_info)
 }
 
 SDKCodec::SDKCodec(const ::openmldb::api::TableMeta& table_info)
-    : format_version_(table_info.format_version()), base_schema_size_(0), modify_times_(0), last_ver_(1) {
+    : format_version_(table_info.format_version()),
+      base_schema_size_(0),
+      modify_times_(0),
+      last_ver_(1),
+      router_(table_info.table_partition_size()) {
     if (table_info.column_desc_size() > 0) {
         ParseColumnDesc(table_info.column_desc());
     }
@@ -129,39 +134,55 @@ void SDKCodec::ParseSchemaVer(const VerSchema& ver_schema, const Schema& add_sch
     }
 }
 
+uint32_t SDKCodec::GetPid(const std::string& key, uint32_t pid_num) const {
+    if (pid_num == 0) {
+        return 0;
+    }
+    // the splits are known for the partitions of the table info
+    if (router_.GetPartitionNum() == pid_num) {
+        return router_.GetPid(key);
+    }
+    return (uint32_t)(::openmldb::base::hash64(key) % pid_num);
+}
+
+uint32_t SDKCodec::GetPid(const CompositeKeyBuilder& key_builder, uint32_t pid_num) const {
+    if (pid_num == 0) {
+        return 0;
+    }
+    if (router_.GetPartitionNum() == pid_num) {
+        return router_.GetPid(key_builder.Key());
+    }
+    return key_builder.GetPid(pid_num);
+}
+
 int SDKCodec::EncodeDimension(const std::map<std::string, std::string>& raw_data, uint32_t pid_num,
                               std::map<uint32_t, Dimension>* dimensions) {
     uint32_t dimension_idx = 0;
+    CompositeKeyBuilder key_builder;
     for (const auto& column_key : index_) {
         if (column_key.flag() != 0) {
             dimension_idx++;
             continue;
         }
-        std::string key;
+        key_builder.Reset();
         for (const auto& name : column_key.col_name()) {
             auto pos = raw_data.find(name);
             if (pos == raw_data.end()) {
                 return -1;
             }
-            if (!key.empty()) {
-                key += "|";
-            }
-            key += pos->second;
+            key_builder.Append(pos->second);
         }
-        if (key.empty()) {
+        if (key_builder.Empty()) {
             const std::string& index_name = column_key.index_name();
             auto pos = raw_data.find(index_name);
             if (pos == raw_data.end()) {
                 return -1;
             }
-            key = pos->second;
-        }
-        uint32_t pid = 0;
-        if (pid_num > 0) {
-            pid = (uint32_t)(::openmldb::base::hash64(key) % pid_num);
+            key_builder.Append(pos->second);
         }
+        uint32_t pid = GetPid(key_builder, pid_num);
         auto pair = dimensions->emplace(pid, Dimension());
-        pair.first->second.emplace_back(std::move(key), dimension_idx);
+        pair.first->second.emplace_back(key_builder.Release(), dimension_idx);
         dimension_idx++;
     }
     return 0;
@@ -170,36 +191,31 @@ int SDKCodec::EncodeDimension(const std::map<std::string, std::string>& raw_data
 int SDKCodec::EncodeDimension(const std::vector<std::string>& raw_data, uint32_t pid_num,
                               std::map<uint32_t, Dimension>* dimensions) {
     uint32_t dimension_idx = 0;
+    CompositeKeyBuilder key_builder;
     for (const auto& column_key : index_) {
         if (column_key.flag() != 0) {
             dimension_idx++;
             continue;
         }
-        std::string key;
+        key_builder.Reset();
         for (const auto& name : column_key.col_name()) {
             auto iter = schema_idx_map_.find(name);
             if (iter == schema_idx_map_.end() || iter->second >= raw_data.size()) {
                 return -1;
             }
-            if (!key.empty()) {
-                key += "|";
-            }
-            key += raw_data[iter->second];
+            key_builder.Append(raw_data[iter->second]);
         }
-        if (key.empty()) {
+        if (key_builder.Empty()) {
             const std::string& name = column_key.index_name();
             auto iter = schema_idx_map_.find(name);
             if (iter == schema_idx_map_.end() || iter->second >= raw_data.size()) {
                 return -1;
             }
-            key = raw_data[iter->second];
-        }
-        uint32_t pid = 0;
-        if (pid_num > 0) {
-            pid = (uint32_t)(::openmldb::base::hash64(key) % pid_num);
+            key_builder.Append(raw_data[iter->second]);
         }
+        uint32_t pid = GetPid(key_builder, pid_num);
         auto pair = dimensions->emplace(pid, Dimension());
-        pair.first->second.emplace_back(std::move(key), dimension_idx);
+        pair.first->second.emplace_back(key_builder.Release(), dimension_idx);
         dimension_idx++;
     }
     return 0;
@@ -238,14 +254,14 @@ int SDKCodec::CombinePartitionKey(const std::vector<std::string>& raw_data, std:
     if (partition_col_idx_.empty()) {
         return -1;
     }
-    key->clear();
+    CompositeKeyBuilder key_builder;
     for (auto idx : partition_col_idx_) {
         if (idx >= raw_data.size()) {
             return -1;
         }
-        if (!key->empty()) key->append("|");
-        key->append(raw_data[idx]);
+        key_builder.Append(raw_data[idx]);
     }
+    key_builder.ReleaseTo(key);
     return 0;
 }
 
@@ -22,6 +22,8 @@
 #include <utility>
 #include <vector>
 
+#include "base/partition_router.h"
+#include "codec/composite_key.h"
 #include "codec/schema_codec.h"
 #include "proto/common.pb.h"
 #include "proto/tablet.pb.h"
@@ -63,6 +65,8 @@ class SDKCodec {
     void ParseAddedColumnDesc(const Schema& column_desc);
     void ParseSchemaVer(const VerSchema& ver_schema, const Schema& add_schema);
     void ParseTsCol();
+    uint32_t GetPid(const std::string& key, uint32_t pid_num) const;
+    uint32_t GetPid(const CompositeKeyBuilder& key_builder, uint32_t pid_num) const;
 
  private:
     Schema schema_;
@@ -75,6 +79,7 @@ class SDKCodec {
     int modify_times_;
     std::map<int32_t, std::shared_ptr<Schema>> version_schema_;
     int32_t last_ver_;
+    ::openmldb::base::PartitionRouter router_;
 };
 
 }  // namespace codec
@@ -16,6 +16,8 @@
 
 #include "codec/sql_rpc_row_codec.h"
 
+#include <snappy.h>
+
 namespace openmldb {
 namespace codec {
 
@@ -105,5 +107,38 @@ bool EncodeRpcRow(const int8_t* buf, size_t size, butil::IOBuf* io_buf) {
     return true;
 }
 
+bool CompressRpcRows(butil::IOBuf* buf) {
+    if (buf == nullptr) {
+        return false;
+    }
+    std::string raw = buf->to_string();
+    std::string compressed;
+    ::snappy::Compress(raw.data(), raw.size(), &compressed);
+    buf->clear();
+    if (buf->append(compressed) != 0) {
+        LOG(WARNING) << "Append compressed rows of size " << compressed.size() << " failed";
+        return false;
+    }
+    return true;
+}
+
+bool UncompressRpcRows(const butil::IOBuf& buf, butil::IOBuf* uncompressed) {
+    if (uncompressed == nullptr) {
+        return false;
+    }
+    std::string compressed = buf.to_string();
+    std::string raw;
+    if (!::snappy::Uncompress(compressed.data(), compressed.size(), &raw)) {
+        LOG(WARNING) << "Uncompress rows of size " << compressed.size() << " failed";
+        return false;
+    }
+    uncompressed->clear();
+    if (uncompressed->append(raw) != 0) {
+        LOG(WARNING) << "Append uncompressed rows of size " << raw.size() << " failed";
+        return false;
+    }
+    return true;
+}
+
 }  // namespace codec
 }  // namespace openmldb
@@ -37,6 +37,12 @@ bool EncodeRpcRow(const hybridse::codec::Row& row, butil::IOBuf* buf, size_t* to
 
 bool EncodeRpcRow(const int8_t* buf, size_t size, butil::IOBuf* io_buf);
 
+// compress the encoded rows of `buf` with snappy in place, the rows of a batch
+// share most of their values, so they compress well as a whole
+bool CompressRpcRows(butil::IOBuf* buf);
+
+bool UncompressRpcRows(const butil::IOBuf& buf, butil::IOBuf* uncompressed);
+
 }  // namespace codec
 }  // namespace openmldb
 #endif  // SRC_CODEC_SQL_RPC_ROW_CODEC_H_
@@ -123,6 +123,36 @@ TEST_F(SqlRpcRowCodecTest, TestMultiSlice) {
     ASSERT_EQ(0, decoded.size(3));
 }
 
+TEST_F(SqlRpcRowCodecTest, TestCompressRows) {
+    hybridse::codec::Schema schema;
+    InitSchema(&schema);
+    hybridse::codec::RowBuilder builder(schema);
+    size_t buf_size = builder.CalTotalLength(5);
+
+    butil::IOBuf iobuf;
+    for (int i = 0; i < 100; i++) {
+        std::string buf(buf_size, '\0');
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&buf[0]), buf_size);
+        builder.AppendInt32(i);
+        builder.AppendFloat(3.14);
+        builder.AppendString("hello", 5);
+        ASSERT_TRUE(EncodeRpcRow(reinterpret_cast<const int8_t*>(buf.data()), buf_size, &iobuf));
+    }
+    size_t raw_size = iobuf.size();
+    ASSERT_TRUE(CompressRpcRows(&iobuf));
+    ASSERT_LT(iobuf.size(), raw_size);
+
+    butil::IOBuf uncompressed;
+    ASSERT_TRUE(UncompressRpcRows(iobuf, &uncompressed));
+    ASSERT_EQ(raw_size, uncompressed.size());
+    hybridse::codec::Row decoded;
+    ASSERT_TRUE(DecodeRpcRow(uncompressed, 50 * buf_size, buf_size, 1, &decoded));
+    hybridse::codec::RowView row_view(schema);
+    row_view.Reset(decoded.buf(0), decoded.size(0));
+    ASSERT_EQ(50, row_view.GetInt32Unsafe(0));
+    ASSERT_EQ("hello", row_view.GetStringUnsafe(2));
+}
+
 }  // namespace codec
 }  // namespace openmldb
 
@@ -21,11 +21,23 @@ DEFINE_string(openmldb_log_dir, "./logs", "config the log dir");
 DEFINE_int32(zk_session_timeout, 2000, "config the session timeout of tablet or nameserver");
 DEFINE_uint32(tablet_heartbeat_timeout, 5 * 60 * 1000, "config the heartbeat of tablet offline");
 DEFINE_uint32(tablet_offline_check_interval, 1000, "config the check interval of tablet offline");
+DEFINE_uint32(tablet_lease_timeout, 0,
+              "config the lease in ms of the heartbeats of nameserver to tablets, a tablet takes no writes as leader "
+              "if it gets no heartbeat in the time, and the tablet offline in zookeeper is failed over before "
+              "tablet_heartbeat_timeout if it answers no heartbeat in twice the time. 0 to disable the heartbeats");
+DEFINE_uint32(tablet_lease_heartbeat_interval, 200,
+              "config the interval in ms of the heartbeats of nameserver to tablets, less than tablet_lease_timeout");
+DEFINE_bool(enable_ns_warm_standby, false,
+            "config whether the standby nameserver keeps the table info in memory up to date from zookeeper, so it "
+            "takes over the leadership without reading all tables");
+DEFINE_uint32(ns_standby_sync_interval, 1000, "config the interval in ms of the sync of the standby nameserver");
 DEFINE_string(zk_cluster, "", "config the zookeeper cluster eg ip:2181,ip2:2181,ip3:2181");
 DEFINE_string(zk_root_path, "/openmldb", "config the root path of zookeeper");
 DEFINE_string(tablet, "", "config the endpoint of tablet");
 DEFINE_string(nameserver, "", "config the endpoint of nameserver");
 DEFINE_int32(zk_keep_alive_check_interval, 15000, "config the interval of keep alive check");
+DEFINE_uint32(zk_notify_coalesce_ms, 100,
+              "the table changed notifies within the time are merged into one refresh of table info");
 DEFINE_string(host, "", "used in stand-alone mode, config the name server ip");
 DEFINE_int32(port, 0, "used in stand-alone mode, config the name server port");
 DEFINE_int32(get_task_status_interval, 2000, "config the interval of get task status");
@@ -37,49 +49,154 @@ DEFINE_uint32(name_server_task_concurrency_for_replica_cluster, 2,
               "config the concurrency of name_server_task for replica cluster");
 DEFINE_uint32(name_server_task_max_concurrency, 8, "config the max concurrency of name_server_task");
 DEFINE_int32(name_server_task_wait_time, 1000, "config the time of task wait");
+DEFINE_uint32(name_server_task_concurrency_per_endpoint, 0,
+              "config the max num of running ops that have tasks on one tablet, 0 means no limit");
 DEFINE_uint32(name_server_op_execute_timeout, 2 * 60 * 60 * 1000, "config the timeout of nameserver op");
 DEFINE_bool(auto_failover, false, "enable or disable auto failover");
 DEFINE_int32(max_op_num, 10000, "config the max op num");
+DEFINE_bool(enable_load_balance, false, "enable or disable the load aware placement and rebalancing of partitions");
+DEFINE_uint32(load_balance_interval, 60000, "config the interval of checking the load balance of tablets");
+DEFINE_uint32(load_balance_max_op_num, 2, "config the max op num of one round of load balance");
+DEFINE_double(load_balance_threshold, 0.2,
+              "config the max load gap between tablets as a ratio of the mean load, larger gap is rebalanced");
+DEFINE_bool(enable_leader_balance, false, "enable or disable moving the leaders evenly across tablets");
+DEFINE_uint32(leader_balance_max_op_num, 2, "config the max changeleader op num of one round of leader balance");
 DEFINE_uint32(partition_num, 8, "config the default partition_num");
 DEFINE_uint32(replica_num, 3,
               "config the default replica_num. if set 3, there is one leader and two followers");
 DEFINE_uint32(system_table_replica_num, 1, "config the default replica_num of system table.");
 DEFINE_int32(gc_interval, 120, "the gc interval of tablet every two hour");
 DEFINE_int32(disk_gc_interval, 120, "the rocksdb gc interval of tablet");
-DEFINE_int32(gc_pool_size, 2, "the size of tablet gc thread pool");
+DEFINE_int32(gc_pool_size, 2, "the max count of the gc tasks running at once in the tablet background pool");
 DEFINE_int32(gc_safe_offset, 1, "the safe offset of tablet gc in minute");
 DEFINE_uint64(gc_on_table_recover_count, 10000000, "make a gc on recover count");
 DEFINE_uint32(gc_deleted_pk_version_delta, 2, "config the gc version delta");
+DEFINE_bool(gc_enable_epoch_reclaim, false,
+            "free the deleted pk once no reader can see it instead of after gc version delta");
+DEFINE_uint32(gc_slice_budget_ms, 0, "the max time of one gc slice of segment in millisecond, 0 means no limit");
+DEFINE_uint32(gc_slice_interval_ms, 10, "the sleep time between two gc slices of a segment in millisecond");
 DEFINE_double(mem_release_rate, 5, "specify memory release rate, which should be in 0 ~ 10");
 DEFINE_int32(task_pool_size, 3, "the size of tablet task thread pool");
 DEFINE_int32(io_pool_size, 2, "the size of tablet io task thread pool");
+DEFINE_int32(background_pool_size, 6,
+             "the size of tablet background thread pool, which runs the gc, snapshot, binlog deleting, index building "
+             "and file sending tasks");
 DEFINE_bool(use_name, false, "enable or disable use server name");
 DEFINE_string(data_dir, "./data", "the path of data dir");
 DEFINE_bool(enable_distsql, false, "enable or disable distribute sql");
+DEFINE_string(jit_object_cache_dir, "", "the dir to persist the compiled objects of sql, empty to disable");
+DEFINE_uint32(jit_compile_parallelism, 1, "the count of threads to optimize and compile one sql with");
+DEFINE_string(jit_target_cpu, "",
+              "the cpu to generate the code of sql for, native for the host cpu with all its features, or a llvm cpu "
+              "name, empty to keep the default of llvm");
+DEFINE_bool(jit_enable_fast_math, false,
+            "compile sql with fast math, which can be overridden by the fast_math option of a deployment");
+DEFINE_bool(enable_deploy_profile, false, "record the time and rows of every runner of the deployments");
+DEFINE_uint32(batch_query_parallelism, 1, "the count of threads to run one batch mode query with");
+DEFINE_uint64(batch_query_sort_memory_limit, 0,
+              "the bytes of rows a batch mode sort holds in memory before spilling sorted runs, 0 for no limit");
+DEFINE_string(batch_query_spill_dir, "/tmp", "the dir the batch mode sorts spill their sorted runs to");
+DEFINE_uint64(query_memory_limit, 0, "the bytes the intermediate tables of one query may hold, 0 for no limit");
+DEFINE_uint64(total_query_memory_limit, 0,
+              "the bytes the intermediate tables of all the queries running on the tablet may hold, 0 for no limit");
+DEFINE_uint32(request_query_parallelism, 0,
+              "the count of threads shared by the request queries to evaluate their independent windows, "
+              "0 to evaluate them in the calling thread");
+DEFINE_uint32(request_window_cache_capacity, 0,
+              "the max count of the request windows shared among the deployments on one table, 0 to disable it");
+DEFINE_uint32(request_window_cache_ttl_ms, 1000, "the milliseconds a shared request window is kept");
+DEFINE_uint32(tiered_compile_threshold, 0,
+              "the run count after which a query compiled without optimization is recompiled with full "
+              "optimization in background, 0 to always compile with full optimization");
+DEFINE_bool(enable_literal_normalization, false,
+            "turn the literals compared in the where clause of a batch query into parameters, so that the queries "
+            "only differing in them share one compiled plan");
+DEFINE_uint64(sql_cache_max_bytes, 0,
+              "the max estimated bytes of the compiled queries cached per db, 0 to bound the cache by count only");
+DEFINE_bool(enable_lazy_batch_request_compile, true,
+            "compile a deployment in batch request mode on the first batch request call instead of on deploy");
+DEFINE_bool(hot_standby, false,
+            "keep the deployments ready to serve at full speed before any call, so a tablet leading no partition "
+            "serves as fast as the leader once promoted: both modes are compiled on deploy, and the ones "
+            "compiled quickly by tiered_compile_threshold are optimized in background at once");
+DEFINE_bool(enable_shared_jit, false,
+            "share the jitted functions among the queries whose ir is identical, e.g. a deployment compiled in "
+            "request and batch request mode");
+DEFINE_uint64(jit_memory_budget_bytes, 0,
+              "the max bytes of the code and data jitted for the cached queries, the cold queries are evicted "
+              "beyond it, 0 for no bound");
+DEFINE_bool(enable_block_project, false,
+            "project a block of rows in one call of the jitted function for the table projects of batch queries");
 DEFINE_bool(enable_localtablet, true, "enable or disable local tablet opt when distribute sql circumstance");
 DEFINE_string(bucket_size, "1d", "the default bucket size in pre-aggr table");
+DEFINE_int32(aggr_update_pool_size, 0,
+             "the count of threads to update the pre-aggr tables in the background, 0 to update them in put");
+DEFINE_uint32(numa_worker_thread_num, 0,
+              "the count of threads per numa node to handle the put, get and scan of the partitions bound to the "
+              "node, 0 to handle them in rpc workers");
+DEFINE_uint32(query_worker_thread_num, 0,
+              "the count of threads to run the request and batch request queries off the rpc workers, 0 to run "
+              "them in rpc workers");
+DEFINE_string(query_worker_cpus, "", "the cpus the query workers are bound to, e.g. 8-15, empty for no binding");
+DEFINE_uint32(query_worker_queue_size, 1024, "the queries waiting for the query workers, the others are rejected");
 
 // scan configuration
 DEFINE_uint32(scan_max_bytes_size, 2 * 1024 * 1024, "config the max size of scan bytes size");
 DEFINE_uint32(scan_reserve_size, 1024, "config the size of vec reserve");
+DEFINE_uint32(scan_ref_row_min_size, 1024,
+              "the rows of memory tables no smaller than it are sent by reference rather than copied in scan, 0 to "
+              "copy all the rows");
 DEFINE_uint32(preview_limit_max_num, 1000, "config the max num of preview limit");
 DEFINE_uint32(preview_default_limit, 100, "config the default limit of preview");
 // binlog configuration
 DEFINE_int32(binlog_single_file_max_size, 1024 * 4, "the max size of single binlog file");
 DEFINE_int32(binlog_sync_batch_size, 32, "the batch size of sync binlog");
+DEFINE_uint32(binlog_sync_batch_bytes, 0, "the max bytes of entries in one batch of sync binlog, 0 means no limit");
+DEFINE_uint32(binlog_sync_inflight_cnt, 1, "the max count of in-flight batches of sync binlog to one follower");
+DEFINE_string(binlog_sync_compression, "off",
+              "Type of compression of sync binlog to follower, can be off, snappy, zlib");
+DEFINE_uint32(binlog_remote_channel_conn_cnt, 0,
+              "the count of connections to a tablet of a replica cluster, which carry the binlog of all the partitions "
+              "replicated to the tablet in batches, 0 means every partition sends its own binlog alone");
+DEFINE_uint32(binlog_index_interval, 0,
+              "index the position of every this count of entries of a binlog file, so a follower catching up or a "
+              "recovery seeks close to its offset instead of reading the file from the start. 0 means disabled");
+DEFINE_uint32(binlog_remote_channel_batch_bytes, 4 * 1024 * 1024,
+              "the max bytes of the binlog of the partitions sent to a tablet of a replica cluster in one request");
+DEFINE_int32(binlog_remote_sync_batch_size, 256,
+             "the batch size of sync binlog of a partition to a replica cluster by binlog_remote_channel_conn_cnt");
+DEFINE_string(binlog_remote_channel_compression, "snappy",
+              "Type of compression of sync binlog to replica cluster by binlog_remote_channel_conn_cnt, can be off, "
+              "snappy, zlib");
 DEFINE_bool(binlog_notify_on_put, false, "config the sync log to follower strategy");
-DEFINE_bool(binlog_enable_crc, false, "enable crc");
+DEFINE_bool(binlog_enable_crc, true, "enable crc");
 DEFINE_int32(binlog_coffee_time, 1000, "config the coffee time");
 DEFINE_int32(binlog_sync_wait_time, 100, "config the sync log wait time");
 DEFINE_int32(binlog_sync_to_disk_interval, 20000, "config the interval of sync binlog to disk time");
+DEFINE_bool(binlog_group_commit, false,
+            "enable group commit of binlog, the puts are acked only after their binlog is synced to disk");
+DEFINE_uint32(binlog_group_commit_max_cnt, 256, "config the max count of entries in one group commit of binlog");
 DEFINE_int32(binlog_delete_interval, 60000, "config the interval of delete binlog");
 DEFINE_int32(binlog_match_logoffset_interval, 1000, "config the interval of match log offset ");
 DEFINE_int32(binlog_name_length, 8, "binlog name length");
 DEFINE_uint32(check_binlog_sync_progress_delta, 100000, "config the delta of check binlog sync progress");
+DEFINE_uint64(catch_up_snapshot_lag_cnt, 10000000,
+              "a recovered follower more binlog entries behind the leader than it is rebuilt from the snapshot of the "
+              "leader instead of replaying the binlog, 0 to disable");
+DEFINE_uint64(catch_up_snapshot_lag_mb, 10240,
+              "a recovered follower more MB of binlog behind the leader than it is rebuilt from the snapshot of the "
+              "leader instead of replaying the binlog, 0 to disable");
 DEFINE_uint32(go_back_max_try_cnt, 10, "config max try time of go back");
 
 DEFINE_uint32(put_slow_log_threshold, 50000, "config the threshold of put slow log");
 DEFINE_uint32(query_slow_log_threshold, 50000, "config the threshold of query slow log");
+DEFINE_uint32(slow_trace_capacity, 128,
+              "the count of the latest slow puts and queries whose stages are kept, 0 to disable");
+DEFINE_uint32(workload_profile_hz, 0,
+              "the frequency to sample the cpu stacks for the workload profile, 0 to disable. "
+              "the cpu profiler of brpc must not be used if it is enabled");
+DEFINE_uint64(workload_profile_heap_sample_bytes, 0,
+              "sample the allocation stack every the bytes for the workload profile, 0 to disable");
 
 // local db config
 DEFINE_string(db_root_path, "/tmp/", "the root path of db");
@@ -89,12 +206,44 @@ DEFINE_int32(scan_concurrency_limit, 8, "the limit of scan concurrency");
 DEFINE_int32(put_concurrency_limit, 8, "the limit of put concurrency");
 DEFINE_int32(thread_pool_size, 16, "the size of thread pool for other api");
 DEFINE_int32(get_concurrency_limit, 8, "the limit of get concurrency");
+DEFINE_uint32(query_admission_max_concurrency, 0,
+              "the max request and batch request queries running at once in a tablet, 0 means no limit");
+DEFINE_uint32(query_admission_reserved_concurrency, 0,
+              "the slots of query_admission_max_concurrency only taken by the high priority queries");
+DEFINE_string(query_admission_quotas, "",
+              "the quotas of the deployments and dbs, e.g. db1.deploy1:concurrency=4,cpu_ms=500,priority=high;"
+              "db2:priority=low. cpu_ms is the cpu time per second and priority is high, normal or low");
+DEFINE_uint32(sub_query_hedge_min_delay_ms, 0,
+              "duplicate the remote sub query of a row to a follower of the partition if the leader does not answer "
+              "in the p95 latency and no less than it, 0 disables it");
+DEFINE_uint64(sub_query_hedge_max_lag, 1000,
+              "the max log entries a follower lags behind the leader to serve the duplicate sub query");
+DEFINE_uint64(write_throttle_max_memory_mb, 0,
+              "reject the puts once the memory of the tablet reaches it and slow them down from "
+              "write_throttle_low_ratio of it, 0 means no limit");
+DEFINE_uint64(write_throttle_max_lag, 0,
+              "reject the puts of a leader partition once its slowest follower lags behind by the log entries and slow "
+              "them down from write_throttle_low_ratio of it, 0 means no limit");
+DEFINE_double(write_throttle_low_ratio, 0.8, "the ratio of the write throttle limits the puts are slowed down from");
+DEFINE_uint32(write_throttle_check_interval_ms, 1000, "the interval to check the memory and the follower lag");
 DEFINE_int32(request_max_retry, 3, "max retry time when request error");
 DEFINE_int32(request_timeout_ms, 20000, "request timeout");
+DEFINE_uint32(sub_query_conn_cnt, 1,
+              "the count of connections to a tablet, over which the sub queries forwarded to the tablet and the "
+              "queries of the sdk are spread by the requests in flight");
+DEFINE_uint32(sub_query_max_in_flight, 0,
+              "the max sub queries in flight to a tablet, the ones beyond it fail at once. 0 means no limit");
+DEFINE_uint32(batch_request_compress_threshold, 0,
+              "compress the rows of a batch request by snappy if their size is not less than it, 0 is disabled");
 DEFINE_int32(request_sleep_time, 1000, "the sleep time when request error");
 
 DEFINE_uint32(max_traverse_cnt, 50000, "max traverse iter loop cnt");
 DEFINE_uint32(traverse_cnt_limit, 1000, "limit traverse cnt");
+DEFINE_uint32(traverse_cursor_capacity, 1024,
+              "the max count of the traverse iterators of memory tables kept between the pages, 0 to disable cursors");
+DEFINE_uint32(traverse_cursor_timeout_ms, 10000,
+              "the time in milliseconds an idle traverse cursor is kept, it holds back the reclaim of the memory gc "
+              "removed");
 DEFINE_string(ssd_root_path, "", "the root ssd path of db");
 DEFINE_string(hdd_root_path, "", "the root hdd path of db");
 
@@ -104,7 +253,8 @@ DEFINE_int32(send_file_max_try, 3, "the max retry time when send file failed");
 DEFINE_int32(retry_send_file_wait_time_ms, 3000, "conf the wait time when retry send file");
 DEFINE_int32(stream_close_wait_time_ms, 1000, "the wait time before close stream");
 DEFINE_uint32(stream_block_size, 1 * 1204 * 1024, "config the write/read block size in streaming");
-DEFINE_int32(stream_bandwidth_limit, 10 * 1204 * 1024, "the limit bandwidth. Byte/Second");
+DEFINE_int32(stream_bandwidth_limit, 10 * 1204 * 1024, "the limit bandwidth of all streams of the tablet. Byte/Second");
+DEFINE_uint32(stream_send_dir_thread_num, 4, "the count of threads to send the files of a directory in parallel");
 
 // if set 23, the task will execute 23:00 every day
 DEFINE_int32(make_snapshot_time, 23, "config the time to make snapshot");
@@ -115,7 +265,24 @@ DEFINE_uint32(make_snapshot_offline_interval, 60 * 60 * 24,
               "config tablet self makesnapshot when how long time do not "
               "makesnapshot from ns. unit is second");
 DEFINE_string(snapshot_compression, "off", "Type of snapshot compression, can be off, snappy, zlib");
-DEFINE_int32(snapshot_pool_size, 1, "the size of tablet thread pool for making snapshot");
+DEFINE_bool(snapshot_enable_crc, true, "enable crc check of the records when reading snapshot");
+DEFINE_bool(snapshot_direct_io, false,
+            "read the snapshot files with O_DIRECT to bypass the page cache on loading and sending them, only works "
+            "with the uring file_io_backend");
+DEFINE_string(file_io_backend, "posix",
+              "the io backend of the binlog, the snapshot and the file sending, posix or uring. uring falls back to "
+              "posix if io_uring is not supported by the kernel");
+DEFINE_uint32(file_read_ahead_kb, 0,
+              "advise the kernel to read ahead this many KB of the binlog and snapshot files read sequentially with "
+              "the posix file_io_backend, 0 means the default read ahead of the kernel");
+DEFINE_int32(snapshot_pool_size, 1,
+             "the max count of the snapshot tasks running at once in the tablet background pool");
+DEFINE_uint32(snapshot_part_num, 0,
+              "split the snapshot of memory table into the part files of this count, which are written and loaded "
+              "in parallel. 0 or 1 means one snapshot file");
+DEFINE_uint32(snapshot_max_delta_num, 0,
+              "make the snapshot of memory table from the binlog after the last one only, and merge them into a "
+              "full snapshot once there are this count of incremental ones. 0 means a full snapshot every time");
 
 DEFINE_uint32(load_index_max_wait_time, 120 * 60 * 1000, "config the max wait time of load index");
 
@@ -129,8 +296,28 @@ DEFINE_uint32(latest_ttl_max, 1000, "the max ttl of latest");
 DEFINE_uint32(absolute_ttl_max, 60 * 24 * 365 * 30, "the max ttl of absolute time");
 DEFINE_uint32(skiplist_max_height, 12, "the max height of skiplist");
 DEFINE_uint32(key_entry_max_height, 8, "the max height of key entry");
+DEFINE_bool(key_entry_adaptive_height, false,
+            "adapt the max height of the time entries of new keys to the rows per key of each index on gc and "
+            "snapshot");
 DEFINE_uint32(latest_default_skiplist_height, 1, "the default height of skiplist for latest table");
 DEFINE_uint32(absolute_default_skiplist_height, 4, "the default height of skiplist for absolute table");
+DEFINE_bool(enable_data_block_pool, false, "enable the slab pool for the data block of memory table");
+DEFINE_bool(enable_latest_entries, false, "store the rows of latest-only index in ring instead of skiplist");
+DEFINE_uint32(latest_entries_init_capacity, 8, "the init capacity of the ring of latest-only index");
+DEFINE_bool(enable_key_hash_index, false, "look up the keys of memory table by hash index besides skiplist");
+DEFINE_uint32(key_hash_index_init_bucket_cnt, 256, "the init bucket count of the key hash index of one segment");
+DEFINE_uint32(compact_row_dict_size, 256,
+              "the max count of distinct values in the dictionary of one string column of the compact row table");
+DEFINE_uint32(compact_row_dict_value_len, 32, "the max length of the string values kept in the dictionary");
+DEFINE_uint32(cold_row_age_min, 0,
+              "the rows of memory table older than it in minute are deflated on gc and inflated on read. "
+              "0 means disabled");
+DEFINE_uint32(segment_key_lock_cnt, 16, "the count of striped locks guarding the rows of keys in one segment");
+DEFINE_uint32(count_bucket_width, 0,
+              "the time width in millisecond of the per key count buckets of memory table, which count the "
+              "unexpired rows of a key without scan. 0 means disabled");
+DEFINE_uint32(index_stat_sample_key_cnt, 256,
+              "the count of keys sampled for the ts range of each index of memory table on gc and snapshot");
 DEFINE_bool(enable_show_tp, false, "enable show tp");
 DEFINE_uint32(max_col_display_length, 256, "config the max length of column display");
 
@@ -143,14 +330,67 @@ DEFINE_uint32(block_cache_mb, 4096,
 DEFINE_uint32(write_buffer_mb, 128, "Memtable size");
 DEFINE_uint32(block_cache_shardbits, 8, "Divide block cache into 2^8 shards to avoid cache contention");
 DEFINE_bool(verify_compression, false, "For debug");
+DEFINE_string(disk_table_filter_type, "bloom",
+              "the filter of the key prefixes in the sst files of disk tables, can be none, bloom, ribbon");
+DEFINE_uint32(disk_table_filter_bits_per_key, 10,
+              "the bits per key of the sst filter of disk tables, 0 to disable, "
+              "it can be set per table by filter_bits_per_key in table meta");
+DEFINE_bool(disk_table_whole_key_filtering, false,
+            "add the whole keys besides the key prefixes into the sst filter of disk tables");
+DEFINE_uint32(disk_table_write_buffer_manager_mb, 0,
+              "the max memory in MB of the memtables of all disk tables, charged to the block cache, 0 for no limit");
+DEFINE_uint32(disk_table_compaction_rate_limit_mb, 0,
+              "the max bytes in MB per second written by the flushes and compactions of one disk table, 0 for no "
+              "limit, it can be set per table by compaction_rate_limit_mb in table meta");
+DEFINE_uint32(disk_table_row_cache_keys, 0,
+              "the count of the recently read keys per disk table of which the most recent rows are cached in memory "
+              "for the windows of disk tables, 0 to disable the cache");
+DEFINE_uint32(disk_table_row_cache_rows, 64, "the max count of the rows cached per key of disk tables");
+DEFINE_bool(disk_table_bytewise_key, false,
+            "encode the keys of the new disk tables to sort bytewise and rewrite the others at their next snapshot");
 
 // load table resouce control
 DEFINE_uint32(load_table_batch, 30, "set laod table batch size");
 DEFINE_uint32(load_table_thread_num, 3, "set load tabale thread pool size");
 DEFINE_uint32(load_table_queue_size, 1000, "set load tabale queue size");
+DEFINE_uint32(recover_table_thread_num, 3, "the count of the partitions the tablet loads concurrently");
+DEFINE_uint64(recover_memory_budget_mb, 0,
+              "the max total size of the snapshot and binlog of the partitions loading concurrently, in MB. A "
+              "partition larger than it loads alone. 0 means no limit");
+DEFINE_uint32(recover_disk_concurrency, 2,
+              "the max count of the partitions loading concurrently from one db root path, 0 means no limit");
+DEFINE_string(recover_priority_tables, "",
+              "the tables loaded before the others on recovery, as db.table separated by comma, the former first");
+DEFINE_uint32(drop_table_reclaim_key_cnt, 10000,
+              "the count of the keys of a dropped memory table freed at a time in the background, 0 to free the table "
+              "in the drop");
+DEFINE_uint32(drop_table_reclaim_interval_ms, 10, "the pause between freeing the keys of a dropped memory table");
+DEFINE_uint32(load_table_put_thread_num, 0,
+              "the thread num to put the rows partitioned by key on loading table, 0 to put in decode threads");
+DEFINE_bool(load_table_mmap, false,
+            "map the uncompressed snapshots of memory tables and refer the rows in place on loading table");
+DEFINE_uint32(extract_index_thread_num, 4, "the thread num to extract the new indexes from snapshot on adding index");
+DEFINE_uint32(extract_index_batch, 1024, "the count of snapshot rows extracted by the threads in one round");
+DEFINE_uint32(split_table_wait_ms, 1000, "the time to wait for the puts with the old route before splitting a table");
 
 // multiple data center
 DEFINE_uint32(get_replica_status_interval, 10000, "config the interval to sync replica cluster status time");
 
 DEFINE_uint32(sync_deploy_stats_timeout, 10000,
               "time interval in milliseconds to sync deploy response time stats into table");
+DEFINE_uint32(deploy_result_cache_capacity, 0,
+              "the max count of cached results per deployment in request mode, 0 to disable the cache");
+DEFINE_uint32(deploy_result_cache_ttl_ms, 1000, "the time in milliseconds a cached deployment result lives");
+DEFINE_uint32(prepared_statement_capacity, 1024,
+              "the max count of the batch queries prepared by the sdk kept in tablet, 0 to disable preparing");
+DEFINE_uint32(query_result_cursor_capacity, 64,
+              "the max count of the batch queries whose output rows are kept for the sdk to fetch in chunks, 0 to "
+              "send all rows in one response");
+DEFINE_uint32(query_result_cursor_timeout_ms, 30000,
+              "the time in milliseconds the output rows not fetched by the sdk are kept");
+
+// apiserver
+DEFINE_uint32(apiserver_batch_window_ms, 0,
+              "the time in milliseconds the single row calls of one deployment are merged into one batch request "
+              "in apiserver, 0 to call every request on its own");
+DEFINE_uint32(apiserver_batch_max_rows, 64, "the max count of calls merged into one batch request in apiserver");
@@ -35,6 +35,14 @@ extern uint32_t Extend(uint32_t init_crc, const char* data, size_t n);
 // Return the crc32c of data[0,n-1]
 inline uint32_t Value(const char* data, size_t n) { return Extend(0, data, n); }
 
+// The table driven implementation of Extend(), which is used when the cpu has
+// no crc32c instruction.
+extern uint32_t ExtendPortable(uint32_t init_crc, const char* data, size_t n);
+
+// Return true if Extend() uses the crc32c instruction of the cpu, which is
+// SSE4.2 on x86_64 and the CRC extension on ARMv8.
+extern bool IsHardwareAccelerated();
+
 static const uint32_t kMaskDelta = 0xa282ead8ul;
 
 // Return a masked representation of crc.
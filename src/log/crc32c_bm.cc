@@ -0,0 +1,63 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "log/crc32c.h"
+
+namespace openmldb {
+namespace log {
+
+static std::string GenData(size_t size) {
+    std::string data(size, '\0');
+    uint32_t seed = 9527;
+    for (auto& c : data) {
+        seed = seed * 1103515245 + 12345;
+        c = static_cast<char>(seed >> 16);
+    }
+    return data;
+}
+
+// range(0) is the bytes of one checksum, 4089 is the max payload of a binlog block
+static void BM_Crc32cPortable(benchmark::State& state) {  // NOLINT
+    std::string data = GenData(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ExtendPortable(0, data.data(), data.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+static void BM_Crc32c(benchmark::State& state) {  // NOLINT
+    std::string data = GenData(state.range(0));
+    state.SetLabel(IsHardwareAccelerated() ? "hardware" : "portable");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Extend(0, data.data(), data.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_Crc32cPortable)->Arg(64)->Arg(512)->Arg(4089)->Arg(1024 * 1024);
+BENCHMARK(BM_Crc32c)->Arg(64)->Arg(512)->Arg(4089)->Arg(1024 * 1024);
+
+}  // namespace log
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log/crc32c.h"
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <string>
+
+namespace openmldb {
+namespace log {
+
+class CRCTest : public ::testing::Test {
+ public:
+    CRCTest() {}
+    ~CRCTest() {}
+};
+
+TEST_F(CRCTest, StandardResults) {
+    // From rfc3720 section B.4.
+    char buf[32];
+
+    memset(buf, 0, sizeof(buf));
+    ASSERT_EQ(0x8a9136aau, Value(buf, sizeof(buf)));
+
+    memset(buf, 0xff, sizeof(buf));
+    ASSERT_EQ(0x62a8ab43u, Value(buf, sizeof(buf)));
+
+    for (int i = 0; i < 32; i++) {
+        buf[i] = i;
+    }
+    ASSERT_EQ(0x46dd794eu, Value(buf, sizeof(buf)));
+
+    for (int i = 0; i < 32; i++) {
+        buf[i] = 31 - i;
+    }
+    ASSERT_EQ(0x113fdb5cu, Value(buf, sizeof(buf)));
+}
+
+TEST_F(CRCTest, Extend) {
+    ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
+}
+
+TEST_F(CRCTest, Mask) {
+    uint32_t crc = Value("foo", 3);
+    ASSERT_NE(crc, Mask(crc));
+    ASSERT_NE(crc, Mask(Mask(crc)));
+    ASSERT_EQ(crc, Unmask(Mask(crc)));
+    ASSERT_EQ(crc, Unmask(Unmask(Mask(Mask(crc)))));
+}
+
+TEST_F(CRCTest, SameAsPortable) {
+    std::string data(16 * 1024 + 64, '\0');
+    uint32_t seed = 9527;
+    for (auto& c : data) {
+        seed = seed * 1103515245 + 12345;
+        c = static_cast<char>(seed >> 16);
+    }
+    // cover the unaligned heads, the interleaved streams and the tails
+    for (size_t offset = 0; offset < 9; offset++) {
+        for (size_t len : {0, 1, 7, 8, 63, 767, 768, 769, 1536, 4089, 16 * 1024}) {
+            ASSERT_EQ(ExtendPortable(0, data.data() + offset, len), Extend(0, data.data() + offset, len))
+                << "offset " << offset << " len " << len;
+            ASSERT_EQ(ExtendPortable(0x12345678, data.data() + offset, len),
+                      Extend(0x12345678, data.data() + offset, len))
+                << "offset " << offset << " len " << len;
+        }
+    }
+}
+
+}  // namespace log
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log/log_index.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "base/file_util.h"
+#include "base/glog_wapper.h"
+
+namespace openmldb {
+namespace log {
+
+static constexpr uint32_t LOG_INDEX_ENTRY_SIZE = 16;
+
+LogIndexWriter::LogIndexWriter(uint32_t interval, uint32_t block_size)
+    : fd_(NULL), interval_(interval), block_size_(block_size), cnt_(0) {}
+
+LogIndexWriter::~LogIndexWriter() {
+    if (fd_ != NULL) {
+        fclose(fd_);
+    }
+}
+
+bool LogIndexWriter::Open(const std::string& path) {
+    size_t pos = path.rfind('/');
+    if (pos != std::string::npos && !::openmldb::base::MkdirRecur(path.substr(0, pos + 1))) {
+        PDLOG(WARNING, "fail to create the dir of log index %s", path.c_str());
+        return false;
+    }
+    fd_ = fopen(path.c_str(), "wb");
+    if (fd_ == NULL) {
+        PDLOG(WARNING, "fail to create log index %s for %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void LogIndexWriter::Add(uint64_t log_index, uint64_t file_size) {
+    if (fd_ == NULL || cnt_++ % interval_ != 0) {
+        return;
+    }
+    char buf[LOG_INDEX_ENTRY_SIZE];
+    uint64_t position = file_size - file_size % block_size_;
+    memcpy(buf, &log_index, sizeof(log_index));
+    memcpy(buf + sizeof(log_index), &position, sizeof(position));
+    // flushed at once so the readers opening the binlog file meanwhile see it
+    if (fwrite(buf, 1, LOG_INDEX_ENTRY_SIZE, fd_) != LOG_INDEX_ENTRY_SIZE || fflush(fd_) != 0) {
+        PDLOG(WARNING, "fail to write log index for %s, stop indexing the file", strerror(errno));
+        fclose(fd_);
+        fd_ = NULL;
+    }
+}
+
+std::string GetLogIndexPath(const std::string& log_path, const std::string& log_name) {
+    std::string name = log_name;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".log") == 0) {
+        name.resize(name.size() - 4);
+    }
+    return log_path + "/index/" + name + ".idx";
+}
+
+static bool ReadLogIndexEntry(FILE* fd, uint64_t idx, uint64_t* log_index, uint64_t* position) {
+    char buf[LOG_INDEX_ENTRY_SIZE];
+    if (fseek(fd, idx * LOG_INDEX_ENTRY_SIZE, SEEK_SET) != 0 ||
+        fread(buf, 1, LOG_INDEX_ENTRY_SIZE, fd) != LOG_INDEX_ENTRY_SIZE) {
+        return false;
+    }
+    memcpy(log_index, buf, sizeof(*log_index));
+    memcpy(position, buf + sizeof(*log_index), sizeof(*position));
+    return true;
+}
+
+uint64_t SeekLogIndex(const std::string& index_path, uint64_t log_index, uint64_t file_size) {
+    FILE* fd = fopen(index_path.c_str(), "rb");
+    if (fd == NULL) {
+        return 0;
+    }
+    if (fseek(fd, 0, SEEK_END) != 0) {
+        fclose(fd);
+        return 0;
+    }
+    // a partial entry at the end is being written
+    uint64_t cnt = ftell(fd) / LOG_INDEX_ENTRY_SIZE;
+    // the entries are in asc order of both the log index and the position, find the last one no greater than both
+    uint64_t result = 0;
+    uint64_t low = 0;
+    uint64_t high = cnt;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        uint64_t cur_index = 0;
+        uint64_t position = 0;
+        if (!ReadLogIndexEntry(fd, mid, &cur_index, &position)) {
+            break;
+        }
+        if (cur_index <= log_index && position <= file_size) {
+            result = position;
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    fclose(fd);
+    return result;
+}
+
+}  // namespace log
+}  // namespace openmldb
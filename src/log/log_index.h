@@ -0,0 +1,65 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_LOG_LOG_INDEX_H_
+#define SRC_LOG_LOG_INDEX_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+
+namespace openmldb {
+namespace log {
+
+// The sparse index of a binlog file, which lets a reader start close to a log offset instead of reading the file
+// from the start. Every interval entries the writer appends
+//   log index(8 bytes) | position(8 bytes)
+// to the index file, where the position is the start of the block the entry begins in. A reader started at the
+// block skips the fragments of the record before it, then reads the entries from a few before the one indexed.
+// The index files are in the index dir of the binlog dir, so the binlog files listed in it are left as they are.
+class LogIndexWriter {
+ public:
+    LogIndexWriter(uint32_t interval, uint32_t block_size);
+    ~LogIndexWriter();
+    LogIndexWriter(const LogIndexWriter&) = delete;
+    LogIndexWriter& operator=(const LogIndexWriter&) = delete;
+
+    // create the index file, the one left by a former binlog file of the same name is truncated
+    bool Open(const std::string& path);
+
+    // called before the entry of log_index is written to the binlog file of file_size bytes
+    void Add(uint64_t log_index, uint64_t file_size);
+
+ private:
+    FILE* fd_;
+    uint32_t interval_;
+    uint32_t block_size_;
+    uint64_t cnt_;
+};
+
+// the index file of the binlog file log_name, e.g. 00000001.log in log_path
+std::string GetLogIndexPath(const std::string& log_path, const std::string& log_name);
+
+// the position to read the entries from log_index on in the binlog file of file_size bytes, 0 if the index file
+// is missing or has no entry before it. The positions past file_size are left by a crash before the binlog file
+// is flushed and are skipped
+uint64_t SeekLogIndex(const std::string& index_path, uint64_t log_index, uint64_t file_size);
+
+}  // namespace log
+}  // namespace openmldb
+
+#endif  // SRC_LOG_LOG_INDEX_H_
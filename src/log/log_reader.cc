@@ -27,11 +27,13 @@
 #include <zlib.h>
 
 #include "base/endianconv.h"
+#include "base/file_util.h"
 #include "base/glog_wapper.h"  // NOLINT
 #include "base/strings.h"
 #include "log/coding.h"
 #include "log/crc32c.h"
 #include "log/log_format.h"
+#include "log/log_index.h"
 #include "log/status.h"
 
 DECLARE_bool(binlog_enable_crc);
@@ -87,10 +89,14 @@ bool Reader::SkipToInitialBlock() {
     }
 
     end_of_buffer_offset_ = block_start_location;
+    // it is called again if no record is read after it, e.g. the reader waits at the end of the file, so seek
+    // instead of skipping from where the last call left the file
+    buffer_.clear();
+    resyncing_ = true;
 
     // Skip to start of first block that can contain the initial record
     if (block_start_location > 0) {
-        Status skip_status = file_->Skip(block_start_location);
+        Status skip_status = file_->Seek(block_start_location);
         if (!skip_status.ok()) {
             ReportDrop(block_start_location, skip_status);
             return false;
@@ -551,14 +557,26 @@ int LogReader::RollRLogFile() {
     delete it;
     if (index >= 0) {
         // open a new log part file
-        std::string full_path =
-            log_path_ + "/" + ::openmldb::base::FormatToString(index, FLAGS_binlog_name_length) + ".log";
+        std::string name = ::openmldb::base::FormatToString(index, FLAGS_binlog_name_length) + ".log";
+        std::string full_path = log_path_ + "/" + name;
         if (OpenSeqFile(full_path) != 0) {
             return -1;
         }
+        uint64_t initial_offset = 0;
+        if (log_part_index_ < 0 && !compressed_) {
+            // start from the block of the first entry to read if the file is indexed
+            uint64_t file_size = 0;
+            if (::openmldb::base::GetFileSize(full_path, file_size)) {
+                initial_offset = SeekLogIndex(GetLogIndexPath(log_path_, name), start_offset_ + 1, file_size);
+            }
+        }
         delete reader_;
         // roll a new log part file, reset status
-        reader_ = new Reader(sf_, NULL, FLAGS_binlog_enable_crc, 0, compressed_);
+        reader_ = new Reader(sf_, NULL, FLAGS_binlog_enable_crc, initial_offset, compressed_);
+        if (initial_offset > 0) {
+            PDLOG(INFO, "seek log file %s to %lu by the log index for offset %lu", full_path.c_str(), initial_offset,
+                  start_offset_);
+        }
         PDLOG(INFO, "roll log file from index[%d] to index[%d]", log_part_index_, index);
         log_part_index_ = index;
         return 0;
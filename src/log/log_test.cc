@@ -29,14 +29,17 @@
 #include "config.h"  // NOLINT
 #include "log/coding.h"
 #include "log/crc32c.h"
+#include "log/log_index.h"
 #include "log/log_reader.h"
 #include "log/log_writer.h"
+#include "log/uring.h"
 #include "proto/tablet.pb.h"
 
 using ::openmldb::base::Slice;
 using ::openmldb::log::Status;
 
 DECLARE_string(snapshot_compression);
+DECLARE_string(file_io_backend);
 bool compressed_ = true;
 uint32_t block_size_ = 1024 * 4;
 uint32_t header_size_ = 7;
@@ -410,6 +413,110 @@ TEST_F(LogWRTest, TestInit) {
     ASSERT_EQ(compressed_, reader.GetCompressed());
 }
 
+TEST_F(LogWRTest, TestUringFile) {
+    if (!Uring::Supported()) {
+        std::cout << "io_uring is not supported, skip" << std::endl;
+        return;
+    }
+    FLAGS_file_io_backend = "uring";
+    std::string log_dir = "/tmp/" + GenRand() + "/";
+    ::openmldb::base::MkdirRecur(log_dir);
+    for (bool buffered : {false, true}) {
+        std::string fname = std::to_string(buffered) + "test.log";
+        std::string full_path = GetWritePath(log_dir + "/" + fname);
+        std::vector<std::string> values;
+        {
+            FILE* fd_w = fopen(full_path.c_str(), "ab+");
+            ASSERT_TRUE(fd_w != NULL);
+            WriteHandle wh(FLAGS_snapshot_compression, fname, fd_w, 0, buffered);
+            // the records cross the buffers of the file
+            for (int i = 0; i < 1000; i++) {
+                values.push_back(std::string(rand() % 8192 + 1, 'a' + i % 26));  // NOLINT
+                ASSERT_TRUE(wh.Write(Slice(values.back())).ok());
+            }
+            wh.EndLog();
+            ASSERT_TRUE(wh.Sync().ok());
+        }
+        for (bool direct_io : {false, true}) {
+            FILE* fd_r = fopen(full_path.c_str(), "rb");
+            ASSERT_TRUE(fd_r != NULL);
+            SequentialFile* rf = NewSeqFile(fname, fd_r, direct_io);
+            Reader reader(rf, NULL, true, 0, compressed_);
+            std::string scratch;
+            Slice value;
+            for (const auto& expect : values) {
+                ASSERT_TRUE(reader.ReadRecord(&value, &scratch).ok());
+                ASSERT_EQ(expect, value.ToString());
+            }
+            ASSERT_TRUE(reader.ReadRecord(&value, &scratch).IsEof());
+            delete rf;
+        }
+    }
+    FLAGS_file_io_backend = "posix";
+}
+
+TEST_F(LogWRTest, TestLogIndex) {
+    if (FLAGS_snapshot_compression != "off") {
+        return;
+    }
+    std::string log_dir = "/tmp/" + GenRand();
+    ::openmldb::base::MkdirRecur(log_dir);
+    std::string fname = "00000000.log";
+    std::string full_path = log_dir + "/" + fname;
+    std::string index_path = GetLogIndexPath(log_dir, fname);
+    ASSERT_EQ(log_dir + "/index/00000000.idx", index_path);
+    {
+        FILE* fd_w = fopen(full_path.c_str(), "ab+");
+        ASSERT_TRUE(fd_w != NULL);
+        WriteHandle wh("off", fname, fd_w);
+        LogIndexWriter index_writer(10, kBlockSize);
+        ASSERT_TRUE(index_writer.Open(index_path));
+        for (uint64_t i = 1; i <= 1000; i++) {
+            ::openmldb::api::LogEntry entry;
+            entry.set_log_index(i);
+            entry.set_pk("key" + std::to_string(i));
+            entry.set_value(std::string(rand() % 1024 + 1, 'a'));  // NOLINT
+            std::string val;
+            ASSERT_TRUE(entry.SerializeToString(&val));
+            index_writer.Add(i, wh.GetSize());
+            ASSERT_TRUE(wh.Write(Slice(val)).ok());
+        }
+        wh.EndLog();
+        ASSERT_TRUE(wh.Sync().ok());
+    }
+    uint64_t file_size = 0;
+    ASSERT_TRUE(::openmldb::base::GetFileSize(full_path, file_size));
+    ASSERT_EQ(0u, SeekLogIndex(index_path, 1, file_size));
+    ASSERT_EQ(0u, SeekLogIndex(log_dir + "/index/missing.idx", 500, file_size));
+    // the positions past the size of the file are skipped
+    ASSERT_EQ(0u, SeekLogIndex(index_path, 1000, 0));
+    for (uint64_t target : {50u, 500u, 777u, 1000u}) {
+        uint64_t pos = SeekLogIndex(index_path, target, file_size);
+        ASSERT_GT(pos, 0u);
+        ASSERT_EQ(0u, pos % kBlockSize);
+        FILE* fd_r = fopen(full_path.c_str(), "rb");
+        ASSERT_TRUE(fd_r != NULL);
+        SequentialFile* rf = NewSeqFile(fname, fd_r);
+        Reader reader(rf, NULL, true, pos, false);
+        std::string scratch;
+        Slice value;
+        ::openmldb::api::LogEntry entry;
+        ASSERT_TRUE(reader.ReadRecord(&value, &scratch).ok());
+        ASSERT_TRUE(entry.ParseFromString(value.ToString()));
+        // the reader starts at most an interval and a block before the target
+        uint64_t first = entry.log_index();
+        ASSERT_LE(first, target);
+        uint64_t expect = first + 1;
+        while (reader.ReadRecord(&value, &scratch).ok()) {
+            ASSERT_TRUE(entry.ParseFromString(value.ToString()));
+            ASSERT_EQ(expect, entry.log_index());
+            expect++;
+        }
+        ASSERT_EQ(1001u, expect);
+        delete rf;
+    }
+}
+
 }  // namespace log
 }  // namespace openmldb
 
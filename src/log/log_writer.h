@@ -90,9 +90,11 @@ struct WriteHandle {
     FILE* fd_;
     WritableFile* wf_;
     Writer* lw_;
-    WriteHandle(const std::string& compress_type, const std::string& fname, FILE* fd, uint64_t dest_length = 0)
+    // buffered is passed to NewWritableFile
+    WriteHandle(const std::string& compress_type, const std::string& fname, FILE* fd, uint64_t dest_length = 0,
+                bool buffered = false)
         : fd_(fd), wf_(NULL), lw_(NULL) {
-        wf_ = ::openmldb::log::NewWritableFile(fname, fd);
+        wf_ = ::openmldb::log::NewWritableFile(fname, fd, buffered);
         lw_ = new Writer(compress_type, wf_, dest_length);
     }
 
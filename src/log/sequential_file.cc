@@ -21,11 +21,17 @@
 #include "log/sequential_file.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 
 #include "base/glog_wapper.h"  // NOLINT
 #include "base/slice.h"
+#include "gflags/gflags.h"
 #include "log/status.h"
+#include "log/uring_file.h"
+
+DECLARE_string(file_io_backend);
+DECLARE_uint32(file_read_ahead_kb);
 
 using ::openmldb::base::Slice;
 using ::openmldb::log::Status;
@@ -37,9 +43,31 @@ class PosixSequentialFile : public SequentialFile {
  private:
     std::string filename_;
     FILE* file_;
+    uint64_t pos_;
+    // the end of the range advised to the kernel last time
+    uint64_t read_ahead_end_;
+
+    // ask the kernel to load the next window of the file into the page cache ahead of the reads, so a long
+    // sequential read does not wait for the disk on every block. a new window is advised once half of the last
+    // one is read
+    void ReadAhead() {
+        uint64_t window = static_cast<uint64_t>(FLAGS_file_read_ahead_kb) * 1024;
+        if (window == 0 || pos_ + window / 2 < read_ahead_end_) {
+            return;
+        }
+#if __linux__
+        posix_fadvise(fileno(file_), pos_, window, POSIX_FADV_WILLNEED);
+#endif
+        read_ahead_end_ = pos_ + window;
+    }
 
  public:
-    PosixSequentialFile(const std::string& fname, FILE* f) : filename_(fname), file_(f) {}
+    PosixSequentialFile(const std::string& fname, FILE* f) : filename_(fname), file_(f), pos_(0), read_ahead_end_(0) {
+        int64_t ret = ftell(file_);
+        if (ret > 0) {
+            pos_ = ret;
+        }
+    }
 
     virtual ~PosixSequentialFile() { fclose(file_); }
 
@@ -51,6 +79,8 @@ class PosixSequentialFile : public SequentialFile {
         size_t r = fread(scratch, 1, n, file_);
 #endif
         *result = Slice(scratch, r);
+        pos_ += r;
+        ReadAhead();
         if (r < n) {
             if (feof(file_)) {
                 // We leave status as ok if we hit the end of the file
@@ -66,6 +96,7 @@ class PosixSequentialFile : public SequentialFile {
         if (fseek(file_, n, SEEK_CUR)) {
             return Status::IOError(filename_, strerror(errno));
         }
+        pos_ += n;
         return Status::OK();
     }
 
@@ -85,13 +116,24 @@ class PosixSequentialFile : public SequentialFile {
     virtual Status Seek(uint64_t pos) {
         int32_t ret = fseek(file_, pos, SEEK_SET);
         if (ret == 0) {
+            pos_ = pos;
+            // the window advised before may be far from pos
+            read_ahead_end_ = 0;
             return Status::OK();
         }
         return Status::IOError("fail to seek", strerror(errno));
     }
 };
 
-SequentialFile* NewSeqFile(const std::string& fname, FILE* f) { return new PosixSequentialFile(fname, f); }
+SequentialFile* NewSeqFile(const std::string& fname, FILE* f, bool direct_io) {
+    if (FLAGS_file_io_backend == "uring") {
+        SequentialFile* file = NewUringSeqFile(fname, f, direct_io);
+        if (file != NULL) {
+            return file;
+        }
+    }
+    return new PosixSequentialFile(fname, f);
+}
 
 }  // namespace log
 }  // namespace openmldb
@@ -64,7 +64,9 @@ class SequentialFile {
     void operator=(const SequentialFile&);
 };
 
-SequentialFile* NewSeqFile(const std::string& fname, FILE* f);
+// the file is on the backend of file_io_backend. direct_io reads it with O_DIRECT to bypass the page cache, which
+// needs the aligned reads of the uring backend and is ignored by the posix one
+SequentialFile* NewSeqFile(const std::string& fname, FILE* f, bool direct_io = false);
 
 }  // namespace log
 }  // namespace openmldb
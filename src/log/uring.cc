@@ -0,0 +1,268 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log/uring.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#ifdef OPENMLDB_HAS_URING
+#include <linux/io_uring.h>
+#endif
+
+namespace openmldb {
+namespace log {
+
+Uring::Uring()
+    : ring_fd_(-1),
+      entries_(0),
+      to_submit_(0),
+      inflight_(0),
+      buffers_registered_(false),
+      sq_ptr_(nullptr),
+      sq_size_(0),
+      cq_ptr_(nullptr),
+      cq_size_(0),
+      sqes_(nullptr),
+      sqes_size_(0),
+      sq_head_(nullptr),
+      sq_tail_(nullptr),
+      sq_mask_(nullptr),
+      sq_array_(nullptr),
+      cq_head_(nullptr),
+      cq_tail_(nullptr),
+      cq_mask_(nullptr),
+      cqes_(nullptr) {}
+
+#ifdef OPENMLDB_HAS_URING
+
+Uring::~Uring() {
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+        munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != nullptr) {
+        munmap(sq_ptr_, sq_size_);
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+    }
+}
+
+bool Uring::Init(uint32_t entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring_fd_ < 0) {
+        return false;
+    }
+    entries_ = params.sq_entries;
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+    sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+        sq_ptr_ = nullptr;
+        return false;
+    }
+    if (single_mmap) {
+        cq_ptr_ = sq_ptr_;
+    } else {
+        cq_ptr_ =
+            mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) {
+            cq_ptr_ = nullptr;
+            return false;
+        }
+    }
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes =
+        mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return false;
+    }
+    sqes_ = reinterpret_cast<io_uring_sqe*>(sqes);
+    char* sq = reinterpret_cast<char*>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = reinterpret_cast<char*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+    return true;
+}
+
+bool Uring::Supported() {
+    static const bool supported = [] {
+        Uring ring;
+        return ring.Init(2);
+    }();
+    return supported;
+}
+
+bool Uring::RegisterBuffers(const struct iovec* iovs, uint32_t num) {
+    if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS, iovs, num) != 0) {
+        return false;
+    }
+    buffers_registered_ = true;
+    return true;
+}
+
+io_uring_sqe* Uring::GetSqe() {
+    unsigned tail = *sq_tail_;
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    // the inflight requests are bounded too, so the completion queue never overflows
+    if (tail - head >= entries_ || inflight_ + to_submit_ >= entries_) {
+        return nullptr;
+    }
+    unsigned idx = tail & *sq_mask_;
+    io_uring_sqe* sqe = &sqes_[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[idx] = idx;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    to_submit_++;
+    return sqe;
+}
+
+bool Uring::PrepRead(int fd, char* buf, uint32_t len, uint64_t offset, int buf_index, uint64_t user_data) {
+    io_uring_sqe* sqe = GetSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = (buf_index >= 0 && buffers_registered_) ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    if (sqe->opcode == IORING_OP_READ_FIXED) {
+        sqe->buf_index = buf_index;
+    }
+    sqe->addr = reinterpret_cast<uint64_t>(buf);
+    sqe->len = len;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool Uring::PrepWrite(int fd, const char* buf, uint32_t len, uint64_t offset, int buf_index, uint64_t user_data) {
+    io_uring_sqe* sqe = GetSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = (buf_index >= 0 && buffers_registered_) ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    if (sqe->opcode == IORING_OP_WRITE_FIXED) {
+        sqe->buf_index = buf_index;
+    }
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buf);
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool Uring::PrepFsync(int fd, bool datasync, uint64_t user_data) {
+    io_uring_sqe* sqe = GetSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->fd = fd;
+    sqe->fsync_flags = datasync ? IORING_FSYNC_DATASYNC : 0;
+    sqe->flags = IOSQE_IO_DRAIN;
+    sqe->user_data = user_data;
+    return true;
+}
+
+int Uring::Submit(uint32_t wait_nr) {
+    while (to_submit_ > 0 || wait_nr > 0) {
+        int ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit_, wait_nr, wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0,
+                          nullptr, 0);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        to_submit_ -= ret;
+        inflight_ += ret;
+        // the wait is done once the requests are submitted
+        if (to_submit_ == 0) {
+            break;
+        }
+    }
+    return 0;
+}
+
+bool Uring::PopCompletion(uint64_t* user_data, int32_t* res) {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return false;
+    }
+    auto cqe = reinterpret_cast<struct io_uring_cqe*>(cqes_) + (head & *cq_mask_);
+    *user_data = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    inflight_--;
+    return true;
+}
+
+int Uring::WaitCompletion(uint64_t* user_data, int32_t* res) {
+    while (!PopCompletion(user_data, res)) {
+        if (inflight_ == 0 && to_submit_ == 0) {
+            return EINVAL;
+        }
+        int ret = Submit(1);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+#else
+
+Uring::~Uring() {}
+bool Uring::Init(uint32_t entries) { return false; }
+bool Uring::Supported() { return false; }
+bool Uring::RegisterBuffers(const struct iovec* iovs, uint32_t num) { return false; }
+io_uring_sqe* Uring::GetSqe() { return nullptr; }
+bool Uring::PrepRead(int fd, char* buf, uint32_t len, uint64_t offset, int buf_index, uint64_t user_data) {
+    return false;
+}
+bool Uring::PrepWrite(int fd, const char* buf, uint32_t len, uint64_t offset, int buf_index, uint64_t user_data) {
+    return false;
+}
+bool Uring::PrepFsync(int fd, bool datasync, uint64_t user_data) { return false; }
+int Uring::Submit(uint32_t wait_nr) { return ENOSYS; }
+bool Uring::PopCompletion(uint64_t* user_data, int32_t* res) { return false; }
+int Uring::WaitCompletion(uint64_t* user_data, int32_t* res) { return ENOSYS; }
+
+#endif
+
+}  // namespace log
+}  // namespace openmldb
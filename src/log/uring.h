@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_LOG_URING_H_
+#define SRC_LOG_URING_H_
+
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <string>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define OPENMLDB_HAS_URING 1
+#endif
+
+struct io_uring_sqe;
+
+namespace openmldb {
+namespace log {
+
+// Uring is a minimal io_uring ring on the raw syscalls, as liburing is not a dependency. The requests are prepared
+// into the submission queue and sent to the kernel in one syscall by Submit, and a ring is used by one thread.
+class Uring {
+ public:
+    Uring();
+    ~Uring();
+
+    // false if io_uring is not available, e.g. an old kernel or blocked by seccomp
+    bool Init(uint32_t entries);
+
+    // io_uring_setup is tried once per process
+    static bool Supported();
+
+    // the buffers are pinned once, so the fixed reads and writes on them skip mapping the pages of every request
+    bool RegisterBuffers(const struct iovec* iovs, uint32_t num);
+
+    // buf_index is the registered buffer holding buf, -1 if it is not registered. Return false if the submission
+    // queue is full
+    bool PrepRead(int fd, char* buf, uint32_t len, uint64_t offset, int buf_index, uint64_t user_data);
+    bool PrepWrite(int fd, const char* buf, uint32_t len, uint64_t offset, int buf_index, uint64_t user_data);
+    // the fsync starts after the requests submitted before it complete
+    bool PrepFsync(int fd, bool datasync, uint64_t user_data);
+
+    // submit the prepared requests and wait until wait_nr of them complete, return the errno on failure
+    int Submit(uint32_t wait_nr);
+
+    // res is the result of the request, the bytes transferred or -errno
+    bool PopCompletion(uint64_t* user_data, int32_t* res);
+    int WaitCompletion(uint64_t* user_data, int32_t* res);
+
+    uint32_t Inflight() const { return inflight_; }
+
+ private:
+    io_uring_sqe* GetSqe();
+
+    int ring_fd_;
+    uint32_t entries_;
+    uint32_t to_submit_;
+    uint32_t inflight_;
+    bool buffers_registered_;
+    void* sq_ptr_;
+    size_t sq_size_;
+    void* cq_ptr_;
+    size_t cq_size_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_mask_;
+    unsigned* sq_array_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned* cq_mask_;
+    void* cqes_;
+
+    // No copying allowed
+    Uring(const Uring&);
+    void operator=(const Uring&);
+};
+
+}  // namespace log
+}  // namespace openmldb
+
+#endif  // SRC_LOG_URING_H_
@@ -0,0 +1,453 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log/uring_file.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/glog_wapper.h"
+#include "base/slice.h"
+#include "log/status.h"
+#include "log/uring.h"
+
+using ::openmldb::base::Slice;
+
+namespace openmldb {
+namespace log {
+
+// the buffers are aligned for O_DIRECT
+static const size_t kAlignment = 4096;
+static const size_t kBufferSize = 1024 * 1024;
+static const uint32_t kBufferNum = 2;
+static const uint32_t kRingEntries = 8;
+static const uint64_t kFsyncTag = UINT64_MAX;
+
+namespace {
+
+struct Buffer {
+    char* data = nullptr;
+    uint64_t offset = 0;
+    size_t len = 0;
+    bool inflight = false;
+};
+
+bool InitBuffers(Uring* ring, Buffer* buffers) {
+    struct iovec iovs[kBufferNum];
+    for (uint32_t i = 0; i < kBufferNum; i++) {
+        void* data = nullptr;
+        if (posix_memalign(&data, kAlignment, kBufferSize) != 0) {
+            return false;
+        }
+        buffers[i].data = reinterpret_cast<char*>(data);
+        iovs[i].iov_base = data;
+        iovs[i].iov_len = kBufferSize;
+    }
+    // the pinned pages count in RLIMIT_MEMLOCK, the buffers are used without registering if it is too low
+    if (!ring->RegisterBuffers(iovs, kBufferNum)) {
+        DEBUGLOG("fail to register the buffers of io_uring, errno %d", errno);
+    }
+    return true;
+}
+
+}  // namespace
+
+class UringWritableFile : public WritableFile {
+ public:
+    UringWritableFile(const std::string& fname, FILE* f, bool buffered)
+        : filename_(fname), file_(f), fd_(fileno(f)), buffered_(buffered), offset_(0), cur_(0), ring_(), status_() {}
+
+    ~UringWritableFile() {
+        if (file_ != NULL) {
+            // Ignoring any potential errors
+            Close();
+        }
+        for (uint32_t i = 0; i < kBufferNum; i++) {
+            free(buffers_[i].data);
+        }
+    }
+
+    bool Init() {
+        if (!ring_.Init(kRingEntries) || !InitBuffers(&ring_, buffers_)) {
+            return false;
+        }
+        off_t offset = lseek(fd_, 0, SEEK_END);
+        if (offset < 0) {
+            return false;
+        }
+        offset_ = offset;
+        // the writes carry their offsets, which O_APPEND ignores
+        int flags = fcntl(fd_, F_GETFL);
+        return flags >= 0 && (!(flags & O_APPEND) || fcntl(fd_, F_SETFL, flags & ~O_APPEND) == 0);
+    }
+
+    // give f back without closing it
+    void Release() { file_ = NULL; }
+
+    virtual Status Append(const Slice& data) {
+        if (!status_.ok()) {
+            return status_;
+        }
+        const char* ptr = data.data();
+        size_t left = data.size();
+        while (left > 0) {
+            WaitBuffer(cur_);
+            if (!status_.ok()) {
+                return status_;
+            }
+            Buffer& buffer = buffers_[cur_];
+            size_t n = std::min(left, kBufferSize - buffer.len);
+            memcpy(buffer.data + buffer.len, ptr, n);
+            buffer.len += n;
+            ptr += n;
+            left -= n;
+            if (buffer.len == kBufferSize) {
+                SubmitCurrent();
+            }
+        }
+        wsize_ += data.size();
+        return Status::OK();
+    }
+
+    virtual Status Close() {
+        WaitAll();
+        Status result = status_;
+        if (fclose(file_) != 0 && result.ok()) {
+            result = Status::IOError(filename_, strerror(errno));
+        }
+        file_ = NULL;
+        return result;
+    }
+
+    virtual Status Flush() {
+        if (buffered_) {
+            return status_;
+        }
+        return WaitAll();
+    }
+
+    virtual Status Sync() {
+        SubmitCurrent(false);
+        if (status_.ok()) {
+            // the fsync is drained after the writes, both are sent in one syscall
+            if (!ring_.PrepFsync(fd_, true, kFsyncTag)) {
+                WaitAll();
+                ring_.PrepFsync(fd_, true, kFsyncTag);
+            }
+        }
+        return WaitAll();
+    }
+
+ private:
+    // send the current buffer and switch to the next one
+    void SubmitCurrent(bool submit = true) {
+        Buffer& buffer = buffers_[cur_];
+        if (buffer.len == 0 || buffer.inflight || !status_.ok()) {
+            return;
+        }
+        buffer.offset = offset_;
+        buffer.inflight = true;
+        ring_.PrepWrite(fd_, buffer.data, buffer.len, buffer.offset, cur_, cur_);
+        offset_ += buffer.len;
+        cur_ = (cur_ + 1) % kBufferNum;
+        if (submit) {
+            int ret = ring_.Submit(0);
+            if (ret != 0) {
+                status_ = Status::IOError(filename_, strerror(ret));
+            }
+        }
+    }
+
+    void Reap() {
+        uint64_t user_data = 0;
+        int32_t res = 0;
+        int ret = ring_.WaitCompletion(&user_data, &res);
+        if (ret != 0) {
+            status_ = Status::IOError(filename_, strerror(ret));
+            for (uint32_t i = 0; i < kBufferNum; i++) {
+                buffers_[i].inflight = false;
+            }
+            return;
+        }
+        if (res < 0 && status_.ok()) {
+            status_ = Status::IOError(filename_, strerror(-res));
+        }
+        if (user_data == kFsyncTag) {
+            return;
+        }
+        Buffer& buffer = buffers_[user_data];
+        // a short write is rare on the local files, the rest is written in place
+        size_t done = res < 0 ? buffer.len : res;
+        while (done < buffer.len && status_.ok()) {
+            ssize_t n = pwrite(fd_, buffer.data + done, buffer.len - done, buffer.offset + done);
+            if (n < 0 && errno != EINTR) {
+                status_ = Status::IOError(filename_, strerror(errno));
+            } else if (n > 0) {
+                done += n;
+            }
+        }
+        buffer.inflight = false;
+        buffer.len = 0;
+    }
+
+    void WaitBuffer(uint32_t idx) {
+        while (buffers_[idx].inflight) {
+            Reap();
+        }
+    }
+
+    Status WaitAll() {
+        SubmitCurrent();
+        int ret = ring_.Submit(0);
+        if (ret != 0 && status_.ok()) {
+            status_ = Status::IOError(filename_, strerror(ret));
+        }
+        while (ring_.Inflight() > 0 && status_.ok()) {
+            Reap();
+        }
+        return status_;
+    }
+
+    std::string filename_;
+    FILE* file_;
+    int fd_;
+    bool buffered_;
+    uint64_t offset_;
+    uint32_t cur_;
+    Uring ring_;
+    Buffer buffers_[kBufferNum];
+    // the first error, the file is not written after it
+    Status status_;
+};
+
+class UringSequentialFile : public SequentialFile {
+ public:
+    UringSequentialFile(const std::string& fname, FILE* f, int direct_fd)
+        : filename_(fname),
+          file_(f),
+          fd_(direct_fd >= 0 ? direct_fd : fileno(f)),
+          direct_fd_(direct_fd),
+          pos_(0),
+          ring_(),
+          status_() {}
+
+    ~UringSequentialFile() {
+        // the buffers are released after the reads on them
+        uint64_t user_data = 0;
+        int32_t res = 0;
+        while (ring_.Inflight() > 0 && ring_.WaitCompletion(&user_data, &res) == 0) {
+        }
+        for (uint32_t i = 0; i < kBufferNum; i++) {
+            free(buffers_[i].data);
+        }
+        if (direct_fd_ >= 0) {
+            close(direct_fd_);
+        }
+        if (file_ != NULL) {
+            fclose(file_);
+        }
+    }
+
+    bool Init() {
+        if (!ring_.Init(kRingEntries) || !InitBuffers(&ring_, buffers_)) {
+            return false;
+        }
+        int64_t pos = ftell(file_);
+        pos_ = pos < 0 ? 0 : pos;
+        return true;
+    }
+
+    // give f back without closing it
+    void Release() { file_ = NULL; }
+
+    virtual Status Read(size_t n, Slice* result, char* scratch) {
+        size_t copied = 0;
+        while (copied < n) {
+            Buffer* buffer = Locate(pos_);
+            if (buffer == nullptr) {
+                break;
+            }
+            size_t len = std::min(static_cast<size_t>(buffer->offset + buffer->len - pos_), n - copied);
+            memcpy(scratch + copied, buffer->data + (pos_ - buffer->offset), len);
+            copied += len;
+            pos_ += len;
+        }
+        *result = Slice(scratch, copied);
+        return status_;
+    }
+
+    virtual Status Skip(uint64_t n) {
+        pos_ += n;
+        return Status::OK();
+    }
+
+    virtual Status Tell(uint64_t* pos) {
+        if (pos == NULL) {
+            return Status::InvalidArgument("invalid pos arg");
+        }
+        *pos = pos_;
+        return Status::OK();
+    }
+
+    virtual Status Seek(uint64_t pos) {
+        pos_ = pos;
+        return Status::OK();
+    }
+
+ private:
+    void Issue(uint32_t idx, uint64_t offset) {
+        Buffer& buffer = buffers_[idx];
+        buffer.offset = offset;
+        buffer.len = 0;
+        buffer.inflight = true;
+        ring_.PrepRead(fd_, buffer.data, kBufferSize, offset, idx, idx);
+        int ret = ring_.Submit(0);
+        if (ret != 0) {
+            status_ = Status::IOError(filename_, strerror(ret));
+            buffer.inflight = false;
+        }
+    }
+
+    void WaitBuffer(uint32_t idx) {
+        while (buffers_[idx].inflight) {
+            uint64_t user_data = 0;
+            int32_t res = 0;
+            int ret = ring_.WaitCompletion(&user_data, &res);
+            if (ret != 0) {
+                status_ = Status::IOError(filename_, strerror(ret));
+                buffers_[idx].inflight = false;
+                return;
+            }
+            Buffer& buffer = buffers_[user_data];
+            buffer.inflight = false;
+            if (res < 0) {
+                status_ = Status::IOError(filename_, strerror(-res));
+            } else {
+                buffer.len = res;
+            }
+        }
+    }
+
+    // the buffer holding the data at pos, null at the end of file or on error. The file may grow, e.g. the binlog
+    // being written, so the end is read again every time
+    Buffer* Locate(uint64_t pos) {
+        if (!status_.ok()) {
+            return nullptr;
+        }
+        for (uint32_t i = 0; i < kBufferNum; i++) {
+            Buffer& buffer = buffers_[i];
+            if (buffer.inflight && pos >= buffer.offset && pos < buffer.offset + kBufferSize) {
+                WaitBuffer(i);
+            }
+            if (!buffer.inflight && pos >= buffer.offset && pos < buffer.offset + buffer.len) {
+                Prefetch(i);
+                return &buffer;
+            }
+        }
+        uint32_t idx = 0;
+        while (idx < kBufferNum && buffers_[idx].inflight) {
+            idx++;
+        }
+        if (idx == kBufferNum) {
+            idx = 0;
+            WaitBuffer(idx);
+        }
+        Issue(idx, pos & ~(kAlignment - 1));
+        WaitBuffer(idx);
+        Buffer& buffer = buffers_[idx];
+        if (!status_.ok() || pos >= buffer.offset + buffer.len) {
+            return nullptr;
+        }
+        Prefetch(idx);
+        return &buffer;
+    }
+
+    // read the buffer after the one at idx ahead
+    void Prefetch(uint32_t idx) {
+        const Buffer& buffer = buffers_[idx];
+        if (buffer.len < kBufferSize) {
+            return;
+        }
+        uint64_t next = buffer.offset + kBufferSize;
+        for (uint32_t i = 0; i < kBufferNum; i++) {
+            if (i == idx) {
+                continue;
+            }
+            if (buffers_[i].inflight || buffers_[i].offset == next) {
+                return;
+            }
+            Issue(i, next);
+            return;
+        }
+    }
+
+    std::string filename_;
+    FILE* file_;
+    int fd_;
+    int direct_fd_;
+    uint64_t pos_;
+    Uring ring_;
+    Buffer buffers_[kBufferNum];
+    Status status_;
+};
+
+WritableFile* NewUringWritableFile(const std::string& fname, FILE* f, bool buffered) {
+    if (!Uring::Supported() || fflush(f) != 0) {
+        return nullptr;
+    }
+    auto file = new UringWritableFile(fname, f, buffered);
+    if (!file->Init()) {
+        PDLOG(WARNING, "fail to init io_uring for %s, use posix io", fname.c_str());
+        // f is closed by the posix file instead
+        file->Release();
+        delete file;
+        return nullptr;
+    }
+    return file;
+}
+
+SequentialFile* NewUringSeqFile(const std::string& fname, FILE* f, bool direct_io) {
+    if (!Uring::Supported()) {
+        return nullptr;
+    }
+    int direct_fd = -1;
+#ifdef O_DIRECT
+    if (direct_io) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", fileno(f));
+        direct_fd = open(path, O_RDONLY | O_DIRECT);
+        if (direct_fd < 0) {
+            DEBUGLOG("fail to open %s with O_DIRECT, errno %d", fname.c_str(), errno);
+        }
+    }
+#endif
+    auto file = new UringSequentialFile(fname, f, direct_fd);
+    if (!file->Init()) {
+        PDLOG(WARNING, "fail to init io_uring for %s, use posix io", fname.c_str());
+        file->Release();
+        delete file;
+        return nullptr;
+    }
+    return file;
+}
+
+}  // namespace log
+}  // namespace openmldb
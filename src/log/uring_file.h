@@ -0,0 +1,44 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_LOG_URING_FILE_H_
+#define SRC_LOG_URING_FILE_H_
+
+#include <stdio.h>
+
+#include <string>
+
+#include "log/sequential_file.h"
+#include "log/writable_file.h"
+
+namespace openmldb {
+namespace log {
+
+// The files on io_uring, null if io_uring is not supported. They take the ownership of f as the posix ones.
+//
+// The writable file copies the appended data into the registered buffers and writes a full buffer without
+// waiting for it, and Sync sends the pending write and the fdatasync in one syscall. Flush waits for the write
+// unless buffered is true, in which case the data may be invisible to the readers until Sync or Close.
+WritableFile* NewUringWritableFile(const std::string& fname, FILE* f, bool buffered);
+
+// The sequential file reads the next buffer ahead while the current one is consumed. The file is reopened with
+// O_DIRECT if direct_io is true, and read as usual if the file system rejects it.
+SequentialFile* NewUringSeqFile(const std::string& fname, FILE* f, bool direct_io);
+
+}  // namespace log
+}  // namespace openmldb
+
+#endif  // SRC_LOG_URING_FILE_H_
@@ -26,7 +26,11 @@
 #include <unistd.h>
 
 #include "base/slice.h"
+#include "gflags/gflags.h"
 #include "log/status.h"
+#include "log/uring_file.h"
+
+DECLARE_string(file_io_backend);
 
 using ::openmldb::base::Slice;
 
@@ -103,7 +107,15 @@ class PosixWritableFile : public WritableFile {
     FILE* file_;
 };
 
-WritableFile* NewWritableFile(const std::string& fname, FILE* f) { return new PosixWritableFile(fname, f); }
+WritableFile* NewWritableFile(const std::string& fname, FILE* f, bool buffered) {
+    if (FLAGS_file_io_backend == "uring") {
+        WritableFile* file = NewUringWritableFile(fname, f, buffered);
+        if (file != NULL) {
+            return file;
+        }
+    }
+    return new PosixWritableFile(fname, f);
+}
 
 }  // namespace log
 }  // namespace openmldb
@@ -48,7 +48,9 @@ class WritableFile {
     void operator=(const WritableFile&);
 };
 
-WritableFile* NewWritableFile(const std::string& fname, FILE* f);
+// the file is on the backend of file_io_backend. Flush may not write the data out if buffered is true, which
+// suits the files not read before they are closed, e.g. the snapshot
+WritableFile* NewWritableFile(const std::string& fname, FILE* f, bool buffered = false);
 
 }  // namespace log
 }  // namespace openmldb
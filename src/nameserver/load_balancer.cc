@@ -0,0 +1,323 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "nameserver/load_balancer.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+namespace openmldb {
+namespace nameserver {
+
+void LoadBalancer::Update(const ReplicaLoad& load, uint64_t offset, uint64_t query_cnt, uint64_t time_ms) {
+    std::string key = std::to_string(load.tid) + "_" + std::to_string(load.pid) + "_" + load.endpoint;
+    auto it = samples_.find(key);
+    if (it == samples_.end()) {
+        it = samples_.emplace(key, Sample{load, offset, query_cnt, time_ms}).first;
+        it->second.load.offset = offset;
+        return;
+    }
+    Sample& sample = it->second;
+    double put_qps = sample.load.put_qps;
+    double query_qps = sample.load.query_qps;
+    // the counters restart from 0 once the replica is reloaded
+    if (time_ms > sample.time_ms && offset >= sample.offset && query_cnt >= sample.query_cnt) {
+        double interval = (time_ms - sample.time_ms) / 1000.0;
+        // smooth the qps over the recent samples
+        put_qps = (put_qps + (offset - sample.offset) / interval) / 2;
+        query_qps = (query_qps + (query_cnt - sample.query_cnt) / interval) / 2;
+    }
+    sample.load = load;
+    sample.load.put_qps = put_qps;
+    sample.load.query_qps = query_qps;
+    sample.load.offset = offset;
+    sample.offset = offset;
+    sample.query_cnt = query_cnt;
+    sample.time_ms = time_ms;
+}
+
+void LoadBalancer::Expire(uint64_t time_ms) {
+    for (auto it = samples_.begin(); it != samples_.end();) {
+        if (it->second.time_ms < time_ms) {
+            it = samples_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<ReplicaLoad> LoadBalancer::GetLoads() const {
+    std::vector<ReplicaLoad> loads;
+    loads.reserve(samples_.size());
+    for (const auto& kv : samples_) {
+        loads.push_back(kv.second.load);
+    }
+    return loads;
+}
+
+std::map<std::string, double> LoadBalancer::GetScores(const std::vector<ReplicaLoad>& loads,
+                                                      const std::vector<std::string>& endpoints,
+                                                      std::vector<double>* replica_scores) {
+    std::map<std::string, double> endpoint_scores;
+    for (const auto& endpoint : endpoints) {
+        endpoint_scores.emplace(endpoint, 0.0);
+    }
+    double total_mem = 0.0;
+    double total_put = 0.0;
+    double total_query = 0.0;
+    for (const auto& load : loads) {
+        if (endpoint_scores.find(load.endpoint) == endpoint_scores.end()) {
+            continue;
+        }
+        total_mem += load.mem;
+        total_put += load.put_qps;
+        // only the leader serves the queries
+        if (load.is_leader) {
+            total_query += load.query_qps;
+        }
+    }
+    double cnt = endpoints.empty() ? 1.0 : endpoints.size();
+    double mean_mem = total_mem / cnt;
+    double mean_put = total_put / cnt;
+    double mean_query = total_query / cnt;
+    if (replica_scores != nullptr) {
+        replica_scores->assign(loads.size(), 0.0);
+    }
+    for (size_t i = 0; i < loads.size(); i++) {
+        const auto& load = loads[i];
+        auto it = endpoint_scores.find(load.endpoint);
+        if (it == endpoint_scores.end()) {
+            continue;
+        }
+        double score = 0.0;
+        if (mean_mem > 0) {
+            score += load.mem / mean_mem;
+        }
+        if (mean_put > 0) {
+            score += load.put_qps / mean_put;
+        }
+        if (mean_query > 0 && load.is_leader) {
+            score += load.query_qps / mean_query;
+        }
+        it->second += score;
+        if (replica_scores != nullptr) {
+            (*replica_scores)[i] = score;
+        }
+    }
+    return endpoint_scores;
+}
+
+std::vector<std::vector<std::string>> LoadBalancer::Place(std::map<std::string, double> endpoint_scores,
+                                                          double replica_cost, uint32_t partition_num,
+                                                          uint32_t replica_num) {
+    std::vector<std::vector<std::string>> placement;
+    placement.reserve(partition_num);
+    std::vector<std::pair<double, std::string>> candidates;
+    candidates.reserve(endpoint_scores.size());
+    for (uint32_t pid = 0; pid < partition_num; pid++) {
+        candidates.clear();
+        for (const auto& kv : endpoint_scores) {
+            candidates.emplace_back(kv.second, kv.first);
+        }
+        uint32_t num = std::min(replica_num, (uint32_t)candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + num, candidates.end());
+        std::vector<std::string> endpoints;
+        for (uint32_t idx = 0; idx < num; idx++) {
+            endpoints.push_back(candidates[idx].second);
+            endpoint_scores[candidates[idx].second] += replica_cost;
+        }
+        placement.push_back(std::move(endpoints));
+    }
+    return placement;
+}
+
+std::vector<BalanceOP> LoadBalancer::Plan(const std::vector<ReplicaLoad>& loads,
+                                          const std::vector<std::string>& endpoints, double threshold,
+                                          uint32_t max_op_num) {
+    std::vector<BalanceOP> ops;
+    if (endpoints.size() < 2) {
+        return ops;
+    }
+    std::vector<ReplicaLoad> replicas = loads;
+    std::vector<double> replica_scores;
+    std::map<std::string, double> endpoint_scores = GetScores(replicas, endpoints, &replica_scores);
+    double total = 0.0;
+    for (const auto& kv : endpoint_scores) {
+        total += kv.second;
+    }
+    double mean = total / endpoints.size();
+    if (mean <= 0) {
+        return ops;
+    }
+    auto partition_key = [](const ReplicaLoad& load) {
+        return load.db + "." + load.name + "." + std::to_string(load.pid);
+    };
+    std::map<std::string, std::set<std::string>> partition_endpoints;
+    for (const auto& load : replicas) {
+        partition_endpoints[partition_key(load)].insert(load.endpoint);
+    }
+    std::set<std::string> moved;
+    while (ops.size() < max_op_num) {
+        auto hot = endpoint_scores.begin();
+        auto cold = endpoint_scores.begin();
+        for (auto it = endpoint_scores.begin(); it != endpoint_scores.end(); ++it) {
+            if (it->second > hot->second) {
+                hot = it;
+            }
+            if (it->second < cold->second) {
+                cold = it;
+            }
+        }
+        double gap = hot->second - cold->second;
+        if (gap <= threshold * mean) {
+            break;
+        }
+        // the replica that makes the two endpoints closest to each other
+        int best = -1;
+        double best_gain = 0.0;
+        for (size_t i = 0; i < replicas.size(); i++) {
+            const auto& load = replicas[i];
+            if (load.endpoint != hot->first || load.is_leader) {
+                continue;
+            }
+            std::string key = partition_key(load);
+            if (moved.count(key) > 0 || partition_endpoints[key].count(cold->first) > 0) {
+                continue;
+            }
+            double gain = std::min(replica_scores[i], gap - replica_scores[i]);
+            if (gain > best_gain) {
+                best_gain = gain;
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        auto& load = replicas[best];
+        std::string key = partition_key(load);
+        ops.push_back(BalanceOP{BalanceOPType::kMigrate, load.name, load.db, load.pid, hot->first, cold->first});
+        hot->second -= replica_scores[best];
+        cold->second += replica_scores[best];
+        partition_endpoints[key].erase(hot->first);
+        partition_endpoints[key].insert(cold->first);
+        load.endpoint = cold->first;
+        moved.insert(key);
+    }
+    return ops;
+}
+
+std::vector<BalanceOP> LoadBalancer::PlanLeaders(const std::vector<ReplicaLoad>& loads,
+                                                 const std::vector<std::string>& endpoints,
+                                                 uint64_t max_offset_delta, uint32_t max_op_num) {
+    std::vector<BalanceOP> ops;
+    if (endpoints.size() < 2) {
+        return ops;
+    }
+    std::map<std::string, double> endpoint_weights;
+    for (const auto& endpoint : endpoints) {
+        endpoint_weights.emplace(endpoint, 0.0);
+    }
+    auto partition_key = [](const ReplicaLoad& load) {
+        return load.db + "." + load.name + "." + std::to_string(load.pid);
+    };
+    // the leader and the followers of each partition on the endpoints
+    std::map<std::string, std::pair<int, std::vector<int>>> partitions;
+    double total_traffic = 0.0;
+    uint32_t leader_cnt = 0;
+    for (size_t i = 0; i < loads.size(); i++) {
+        const auto& load = loads[i];
+        if (endpoint_weights.find(load.endpoint) == endpoint_weights.end()) {
+            continue;
+        }
+        auto it = partitions.emplace(partition_key(load), std::make_pair(-1, std::vector<int>())).first;
+        if (load.is_leader) {
+            it->second.first = i;
+            total_traffic += load.put_qps + load.query_qps;
+            leader_cnt++;
+        } else {
+            it->second.second.push_back(i);
+        }
+    }
+    if (leader_cnt == 0) {
+        return ops;
+    }
+    double mean_traffic = total_traffic / leader_cnt;
+    std::vector<double> weights(loads.size(), 0.0);
+    for (const auto& kv : partitions) {
+        int leader = kv.second.first;
+        if (leader < 0) {
+            continue;
+        }
+        const auto& load = loads[leader];
+        weights[leader] = 1.0;
+        if (mean_traffic > 0) {
+            weights[leader] += (load.put_qps + load.query_qps) / mean_traffic;
+        }
+        endpoint_weights[load.endpoint] += weights[leader];
+    }
+    std::set<std::string> moved;
+    while (ops.size() < max_op_num) {
+        auto hot = endpoint_weights.begin();
+        for (auto it = endpoint_weights.begin(); it != endpoint_weights.end(); ++it) {
+            if (it->second > hot->second) {
+                hot = it;
+            }
+        }
+        // the move that makes the two endpoints closest to each other
+        std::string best_key;
+        int best_follower = -1;
+        double best_gain = 0.0;
+        for (const auto& kv : partitions) {
+            int leader = kv.second.first;
+            if (leader < 0 || loads[leader].endpoint != hot->first || moved.count(kv.first) > 0) {
+                continue;
+            }
+            for (int follower : kv.second.second) {
+                const auto& load = loads[follower];
+                if (load.offset + max_offset_delta < loads[leader].offset) {
+                    continue;
+                }
+                double gap = hot->second - endpoint_weights[load.endpoint];
+                double gain = std::min(weights[leader], gap - weights[leader]);
+                // prefer the endpoint with fewer leaders for the same gain
+                if (gain > best_gain || (gain > 0 && gain == best_gain && best_follower >= 0 &&
+                                         endpoint_weights[load.endpoint] <
+                                             endpoint_weights[loads[best_follower].endpoint])) {
+                    best_gain = gain;
+                    best_key = kv.first;
+                    best_follower = follower;
+                }
+            }
+        }
+        if (best_follower < 0) {
+            break;
+        }
+        int leader = partitions[best_key].first;
+        const auto& load = loads[leader];
+        const std::string& des_endpoint = loads[best_follower].endpoint;
+        ops.push_back(BalanceOP{BalanceOPType::kChangeLeader, load.name, load.db, load.pid, load.endpoint,
+                                des_endpoint});
+        hot->second -= weights[leader];
+        endpoint_weights[des_endpoint] += weights[leader];
+        moved.insert(best_key);
+    }
+    return ops;
+}
+
+}  // namespace nameserver
+}  // namespace openmldb
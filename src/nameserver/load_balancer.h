@@ -0,0 +1,112 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SRC_NAMESERVER_LOAD_BALANCER_H_
+#define SRC_NAMESERVER_LOAD_BALANCER_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace openmldb {
+namespace nameserver {
+
+// The load of one replica of a partition. The put qps is derived from the offset
+// and the query qps from the query count reported by the tablet.
+struct ReplicaLoad {
+    std::string name;
+    std::string db;
+    uint32_t tid = 0;
+    uint32_t pid = 0;
+    std::string endpoint;
+    bool is_leader = false;
+    uint64_t mem = 0;
+    uint64_t offset = 0;
+    double put_qps = 0.0;
+    double query_qps = 0.0;
+};
+
+enum class BalanceOPType { kMigrate, kChangeLeader };
+
+struct BalanceOP {
+    BalanceOPType type;
+    std::string name;
+    std::string db;
+    uint32_t pid;
+    std::string src_endpoint;
+    std::string des_endpoint;
+};
+
+// LoadBalancer keeps the latest load sample of each replica and computes the
+// placement of new partitions and the ops to even out the load of tablets.
+// The load of an endpoint is the sum of the memory, put qps and query qps of its
+// replicas, each normalized by the mean of all endpoints. It is not thread safe.
+class LoadBalancer {
+ public:
+    // update the sample of one replica, the qps is computed against the previous
+    // sample of the same replica
+    void Update(const ReplicaLoad& load, uint64_t offset, uint64_t query_cnt, uint64_t time_ms);
+
+    // remove the samples not updated since time_ms, e.g. the dropped tables
+    void Expire(uint64_t time_ms);
+
+    bool Empty() const { return samples_.empty(); }
+
+    std::vector<ReplicaLoad> GetLoads() const;
+
+    // the load score of each endpoint and each replica that is on these endpoints
+    static std::map<std::string, double> GetScores(const std::vector<ReplicaLoad>& loads,
+                                                   const std::vector<std::string>& endpoints,
+                                                   std::vector<double>* replica_scores);
+
+    // select replica_num endpoints for each partition, the least loaded endpoints are
+    // preferred and every replica placed adds replica_cost to its endpoint
+    static std::vector<std::vector<std::string>> Place(std::map<std::string, double> endpoint_scores,
+                                                       double replica_cost, uint32_t partition_num,
+                                                       uint32_t replica_num);
+
+    // the ops that move the load from the hottest endpoint to the coldest one until
+    // their gap is no more than threshold times the mean load or max_op_num is reached.
+    // every partition is moved at most once in a plan
+    static std::vector<BalanceOP> Plan(const std::vector<ReplicaLoad>& loads, const std::vector<std::string>& endpoints,
+                                       double threshold, uint32_t max_op_num);
+
+    // the ops that move the leaders from the endpoint with the most leaders to the ones
+    // with the least. a leader weighs 1 plus its traffic normalized by the mean traffic of
+    // leaders, and it only moves to a follower that is behind by no more than max_offset_delta
+    static std::vector<BalanceOP> PlanLeaders(const std::vector<ReplicaLoad>& loads,
+                                              const std::vector<std::string>& endpoints, uint64_t max_offset_delta,
+                                              uint32_t max_op_num);
+
+ private:
+    struct Sample {
+        ReplicaLoad load;
+        uint64_t offset;
+        uint64_t query_cnt;
+        uint64_t time_ms;
+    };
+
+    // key is tid_pid_endpoint
+    std::map<std::string, Sample> samples_;
+};
+
+}  // namespace nameserver
+}  // namespace openmldb
+
+#endif  // SRC_NAMESERVER_LOAD_BALANCER_H_
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "nameserver/load_balancer.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace nameserver {
+
+class LoadBalancerTest : public ::testing::Test {
+ public:
+    LoadBalancerTest() {}
+    ~LoadBalancerTest() {}
+};
+
+static ReplicaLoad NewLoad(const std::string& name, uint32_t pid, const std::string& endpoint, bool is_leader,
+                           uint64_t mem) {
+    ReplicaLoad load;
+    load.name = name;
+    load.db = "db";
+    load.tid = 1;
+    load.pid = pid;
+    load.endpoint = endpoint;
+    load.is_leader = is_leader;
+    load.mem = mem;
+    return load;
+}
+
+TEST_F(LoadBalancerTest, UpdateQps) {
+    LoadBalancer balancer;
+    ReplicaLoad load = NewLoad("t1", 0, "ep1", true, 100);
+    balancer.Update(load, 0, 0, 1000);
+    balancer.Update(load, 200, 100, 2000);
+    auto loads = balancer.GetLoads();
+    ASSERT_EQ(1u, loads.size());
+    ASSERT_DOUBLE_EQ(100.0, loads[0].put_qps);
+    ASSERT_DOUBLE_EQ(50.0, loads[0].query_qps);
+    // the counters restart after the replica is reloaded
+    balancer.Update(load, 10, 0, 3000);
+    loads = balancer.GetLoads();
+    ASSERT_DOUBLE_EQ(100.0, loads[0].put_qps);
+    balancer.Expire(3001);
+    ASSERT_TRUE(balancer.Empty());
+}
+
+TEST_F(LoadBalancerTest, Place) {
+    std::map<std::string, double> scores = {{"ep1", 3.0}, {"ep2", 0.0}, {"ep3", 0.0}};
+    auto placement = LoadBalancer::Place(scores, 1.0, 3, 2);
+    ASSERT_EQ(3u, placement.size());
+    uint32_t ep1_cnt = 0;
+    for (const auto& endpoints : placement) {
+        ASSERT_EQ(2u, endpoints.size());
+        ASSERT_NE(endpoints[0], endpoints[1]);
+        for (const auto& endpoint : endpoints) {
+            if (endpoint == "ep1") {
+                ep1_cnt++;
+            }
+        }
+    }
+    // ep1 is chosen only after the others catch up with it
+    ASSERT_EQ(0u, ep1_cnt);
+}
+
+TEST_F(LoadBalancerTest, Plan) {
+    std::vector<std::string> endpoints = {"ep1", "ep2", "ep3"};
+    std::vector<ReplicaLoad> loads;
+    for (uint32_t pid = 0; pid < 4; pid++) {
+        loads.push_back(NewLoad("t1", pid, "ep1", true, 100));
+        loads.push_back(NewLoad("t1", pid, "ep2", false, 100));
+        loads.push_back(NewLoad("t2", pid, "ep1", false, 100));
+        loads.push_back(NewLoad("t2", pid, "ep2", true, 100));
+    }
+    auto ops = LoadBalancer::Plan(loads, endpoints, 0.2, 10);
+    ASSERT_FALSE(ops.empty());
+    for (const auto& op : ops) {
+        ASSERT_EQ(BalanceOPType::kMigrate, op.type);
+        ASSERT_EQ("ep3", op.des_endpoint);
+    }
+    // the moved replicas are followers
+    for (const auto& op : ops) {
+        for (const auto& load : loads) {
+            if (load.name == op.name && load.pid == op.pid && load.endpoint == op.src_endpoint) {
+                ASSERT_FALSE(load.is_leader);
+            }
+        }
+    }
+    ASSERT_TRUE(LoadBalancer::Plan(loads, endpoints, 0.2, 1).size() == 1);
+
+    // balanced already
+    std::vector<ReplicaLoad> balanced;
+    balanced.push_back(NewLoad("t1", 0, "ep1", true, 100));
+    balanced.push_back(NewLoad("t1", 1, "ep2", true, 100));
+    balanced.push_back(NewLoad("t1", 2, "ep3", true, 100));
+    ASSERT_TRUE(LoadBalancer::Plan(balanced, endpoints, 0.2, 10).empty());
+}
+
+TEST_F(LoadBalancerTest, PlanLeaders) {
+    std::vector<std::string> endpoints = {"ep1", "ep2", "ep3"};
+    std::vector<ReplicaLoad> loads;
+    // all leaders are on ep1 after the restarts of ep2 and ep3
+    for (uint32_t pid = 0; pid < 6; pid++) {
+        loads.push_back(NewLoad("t1", pid, "ep1", true, 100));
+        loads.back().offset = 100;
+        loads.push_back(NewLoad("t1", pid, "ep2", false, 100));
+        loads.back().offset = pid == 0 ? 10 : 100;
+        loads.push_back(NewLoad("t1", pid, "ep3", false, 100));
+        loads.back().offset = pid == 0 ? 10 : 100;
+    }
+    auto ops = LoadBalancer::PlanLeaders(loads, endpoints, 20, 10);
+    ASSERT_EQ(4u, ops.size());
+    uint32_t ep2_cnt = 0;
+    for (const auto& op : ops) {
+        ASSERT_EQ(BalanceOPType::kChangeLeader, op.type);
+        ASSERT_EQ("ep1", op.src_endpoint);
+        // the follower of pid 0 isn't caught up
+        ASSERT_NE(0u, op.pid);
+        if (op.des_endpoint == "ep2") {
+            ep2_cnt++;
+        }
+    }
+    ASSERT_EQ(2u, ep2_cnt);
+    ASSERT_EQ(2u, LoadBalancer::PlanLeaders(loads, endpoints, 20, 2).size());
+
+    // a hot leader weighs more than the others
+    std::vector<ReplicaLoad> hot_loads;
+    hot_loads.push_back(NewLoad("t1", 0, "ep1", true, 100));
+    hot_loads.back().put_qps = 1000;
+    hot_loads.push_back(NewLoad("t1", 0, "ep2", false, 100));
+    hot_loads.push_back(NewLoad("t1", 1, "ep2", true, 100));
+    hot_loads.push_back(NewLoad("t1", 1, "ep1", false, 100));
+    ASSERT_TRUE(LoadBalancer::PlanLeaders(hot_loads, {"ep1", "ep2"}, 20, 10).empty());
+}
+
+}  // namespace nameserver
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
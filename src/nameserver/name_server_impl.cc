@@ -33,6 +33,8 @@
 #include <utility>
 
 #include "base/glog_wapper.h"
+#include "base/partition_router.h"
+#include "base/prometheus_writer.h"
 #include "base/proto_util.h"
 #include "base/status.h"
 #include "base/strings.h"
@@ -58,6 +60,10 @@ DECLARE_uint32(replica_num);
 DECLARE_bool(auto_failover);
 DECLARE_uint32(tablet_heartbeat_timeout);
 DECLARE_uint32(tablet_offline_check_interval);
+DECLARE_uint32(tablet_lease_timeout);
+DECLARE_uint32(tablet_lease_heartbeat_interval);
+DECLARE_bool(enable_ns_warm_standby);
+DECLARE_uint32(ns_standby_sync_interval);
 DECLARE_uint32(get_table_status_interval);
 DECLARE_uint32(name_server_task_max_concurrency);
 DECLARE_uint32(check_binlog_sync_progress_delta);
@@ -68,6 +74,15 @@ DECLARE_int32(make_snapshot_check_interval);
 DECLARE_bool(use_name);
 DECLARE_bool(enable_distsql);
 DECLARE_uint32(sync_deploy_stats_timeout);
+DECLARE_bool(enable_load_balance);
+DECLARE_uint32(load_balance_interval);
+DECLARE_uint32(load_balance_max_op_num);
+DECLARE_double(load_balance_threshold);
+DECLARE_bool(enable_leader_balance);
+DECLARE_uint32(name_server_task_concurrency_per_endpoint);
+DECLARE_uint32(leader_balance_max_op_num);
+DECLARE_uint64(catch_up_snapshot_lag_cnt);
+DECLARE_uint64(catch_up_snapshot_lag_mb);
 
 using ::openmldb::api::OPType::kAddIndexOP;
 using ::openmldb::base::ReturnCode;
@@ -522,6 +537,9 @@ NameServerImpl::~NameServerImpl() {
     running_.store(false, std::memory_order_release);
     thread_pool_.Stop(true);
     task_thread_pool_.Stop(true);
+    for (auto& kv : heartbeats_) {
+        kv.second.second->UnRef();
+    }
     if (dist_lock_ != NULL) {
         dist_lock_->Stop();
         delete dist_lock_;
@@ -540,6 +558,8 @@ bool NameServerImpl::Recover() {
         PDLOG(WARNING, "get endpoints node failed!");
         return false;
     }
+    // the warm standby only reads the tables changed since its last sync
+    bool table_synced = FLAGS_enable_ns_warm_standby && SyncTableInfo();
     {
         std::lock_guard<std::mutex> lock(mu_);
 
@@ -612,11 +632,12 @@ bool NameServerImpl::Recover() {
                             : auto_failover_.store(false, std::memory_order_release);
             PDLOG(INFO, "get zk_auto_failover_node[%s]", value.c_str());
         }
-        if (!RecoverDb()) {
+        if (table_synced) {
+            PDLOG(INFO, "table info is synced to version %lu by the standby", synced_table_version_);
+        } else if (!RecoverDb()) {
             PDLOG(WARNING, "recover db failed!");
             return false;
-        }
-        if (!RecoverTableInfo()) {
+        } else if (!RecoverTableInfo()) {
             PDLOG(WARNING, "recover table info failed!");
             return false;
         }
@@ -807,6 +828,129 @@ bool NameServerImpl::RecoverTableInfo() {
     return true;
 }
 
+bool NameServerImpl::SyncTableInfo() {
+    std::lock_guard<std::mutex> sync_lock(sync_mu_);
+    uint64_t synced_version = 0;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        synced_version = synced_table_version_;
+    }
+    // the table nodes are written before the notify node is incremented, so all the changes up to the version
+    // are in zk when it is read
+    std::string value;
+    uint64_t version = 0;
+    if (!zk_client_->GetNodeValue(zk_path_.table_changed_notify_node_, value) || !absl::SimpleAtoi(value, &version) ||
+        version == 0) {
+        PDLOG(WARNING, "fail to get the version of table info from %s", zk_path_.table_changed_notify_node_.c_str());
+        return false;
+    }
+    // the databases are created without a new version, they are read every time
+    std::vector<std::string> db_vec;
+    if (!zk_client_->GetChildren(zk_path_.db_path_, db_vec) && zk_client_->IsExistNode(zk_path_.db_path_) <= 0) {
+        PDLOG(WARNING, "get db failed!");
+        return false;
+    }
+    std::set<std::string> changed_nodes;
+    ::openmldb::zk::TableChangeLog change_log(zk_client_, zk_path_.table_change_log_path_);
+    bool is_delta = synced_version > 0 && version >= synced_version &&
+                    (version == synced_version || change_log.GetChanges(synced_version, version, &changed_nodes));
+    std::vector<std::string> table_nodes;
+    if (is_delta) {
+        table_nodes.assign(changed_nodes.begin(), changed_nodes.end());
+    } else if (!zk_client_->GetChildren(zk_path_.db_table_data_path_, table_nodes) &&
+               zk_client_->IsExistNode(zk_path_.db_table_data_path_) <= 0) {
+        PDLOG(WARNING, "get db table id failed!");
+        return false;
+    }
+    auto read_table = [this](const std::string& node, std::shared_ptr<TableInfo>* table_info) {
+        std::string value;
+        if (!zk_client_->GetNodeValue(node, value)) {
+            // null if the table is dropped
+            return zk_client_->IsExistNode(node) > 0;
+        }
+        auto info = std::make_shared<TableInfo>();
+        if (!info->ParseFromString(value)) {
+            PDLOG(WARNING, "parse table info failed! table node[%s]", node.c_str());
+            return false;
+        }
+        *table_info = info;
+        return true;
+    };
+    // tid -> the table, null if it is dropped
+    std::map<uint32_t, std::shared_ptr<TableInfo>> db_tables;
+    for (const auto& node : table_nodes) {
+        uint32_t tid = 0;
+        if (!absl::SimpleAtoi(node, &tid)) {
+            continue;
+        }
+        if (!read_table(zk_path_.db_table_data_path_ + "/" + node, &db_tables[tid])) {
+            return false;
+        }
+    }
+    // the changes of the tables without db are not in the change log, they are few and read every time
+    ::openmldb::nameserver::TableInfos default_tables;
+    std::vector<std::string> default_nodes;
+    if (!zk_client_->GetChildren(zk_path_.table_data_path_, default_nodes) &&
+        zk_client_->IsExistNode(zk_path_.table_data_path_) <= 0) {
+        PDLOG(WARNING, "get table name failed!");
+        return false;
+    }
+    for (const auto& name : default_nodes) {
+        std::shared_ptr<TableInfo> table_info;
+        if (!read_table(zk_path_.table_data_path_ + "/" + name, &table_info)) {
+            return false;
+        }
+        if (table_info) {
+            default_tables.emplace(name, table_info);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (running_.load(std::memory_order_acquire)) {
+        // the leader keeps the table info by itself
+        return true;
+    }
+    databases_.clear();
+    databases_.insert(db_vec.begin(), db_vec.end());
+    table_info_.swap(default_tables);
+    if (!is_delta) {
+        db_table_info_.clear();
+    }
+    for (auto db_iter = db_table_info_.begin(); db_iter != db_table_info_.end();) {
+        if (databases_.count(db_iter->first) == 0) {
+            db_iter = db_table_info_.erase(db_iter);
+            continue;
+        }
+        auto& tables = db_iter->second;
+        for (auto iter = tables.begin(); iter != tables.end();) {
+            if (db_tables.count(iter->second->tid()) > 0) {
+                iter = tables.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+        ++db_iter;
+    }
+    for (const auto& kv : db_tables) {
+        if (kv.second && databases_.count(kv.second->db()) > 0) {
+            db_table_info_[kv.second->db()][kv.second->name()] = kv.second;
+        }
+    }
+    if (synced_table_version_ != version) {
+        PDLOG(INFO, "sync table info to version %lu, %s table num %lu", version, is_delta ? "changed" : "total",
+              db_tables.size());
+        synced_table_version_ = version;
+    }
+    return true;
+}
+
+void NameServerImpl::SyncStandby() {
+    if (!running_.load(std::memory_order_acquire) && !SyncTableInfo()) {
+        PDLOG(WARNING, "fail to sync table info of the standby name server");
+    }
+    task_thread_pool_.DelayTask(FLAGS_ns_standby_sync_interval, boost::bind(&NameServerImpl::SyncStandby, this));
+}
+
 bool NameServerImpl::RecoverOPTask() {
     for (auto& op_list : task_vec_) {
         op_list.clear();
@@ -957,6 +1101,12 @@ bool NameServerImpl::RecoverOPTask() {
                     continue;
                 }
                 break;
+            case ::openmldb::api::OPType::kSplitPartitionOP:
+                if (CreateSplitPartitionOPTask(op_data) < 0) {
+                    PDLOG(WARNING, "recover op[%s] failed. op_id[%lu]", op_type_str.c_str(), op_id);
+                    continue;
+                }
+                break;
             default:
                 PDLOG(WARNING, "unsupport recover op[%s]! op_id[%lu]", op_type_str.c_str(), op_id);
                 continue;
@@ -1138,9 +1288,16 @@ void NameServerImpl::UpdateTablets(const std::vector<std::string>& endpoints) {
                 continue;
             }
             tablet->ctime_ = ::baidu::common::timer::get_micros() / 1000;
+            tablet->lease_time_ = tablet->ctime_;
+            if (running_.load(std::memory_order_acquire)) {
+                ResetTabletLease(tablet);
+            }
             tablets_.insert(std::make_pair(*it, tablet));
             PDLOG(INFO, "add tablet client. endpoint[%s]", it->c_str());
             NotifyTableChanged(::openmldb::type::NotifyType::kTable);
+            if (running_.load(std::memory_order_acquire)) {
+                thread_pool_.AddTask(boost::bind(&NameServerImpl::AddBroadcastReplica, this, *it));
+            }
         } else {
             if (tit->second->state_ != ::openmldb::type::EndpointState::kHealthy) {
                 if (FLAGS_use_name) {
@@ -1159,6 +1316,10 @@ void NameServerImpl::UpdateTablets(const std::vector<std::string>& endpoints) {
                 }
                 tit->second->state_ = ::openmldb::type::EndpointState::kHealthy;
                 tit->second->ctime_ = ::baidu::common::timer::get_micros() / 1000;
+                tit->second->lease_time_ = tit->second->ctime_;
+                if (running_.load(std::memory_order_acquire)) {
+                    ResetTabletLease(tit->second);
+                }
                 PDLOG(INFO, "tablet is online. endpoint[%s]", tit->first.c_str());
                 thread_pool_.AddTask(boost::bind(&NameServerImpl::OnTabletOnline, this, tit->first));
             }
@@ -1214,9 +1375,20 @@ void NameServerImpl::OnTabletOffline(const std::string& endpoint, bool startup_f
         }
         uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
         if (!startup_flag && cur_time < iter->second + FLAGS_tablet_heartbeat_timeout) {
-            thread_pool_.DelayTask(FLAGS_tablet_offline_check_interval,
-                                   boost::bind(&NameServerImpl::OnTabletOffline, this, endpoint, false));
-            return;
+            // the zk node may be gone with a flap of the zk session, so the tablet is failed over early only if
+            // it answers no heartbeat either
+            if (!IsLeaseExpiredLocked(*tit->second, cur_time)) {
+                uint32_t interval = FLAGS_tablet_offline_check_interval;
+                if (FLAGS_tablet_lease_timeout > 0) {
+                    interval = std::min(interval, FLAGS_tablet_lease_heartbeat_interval);
+                }
+                thread_pool_.DelayTask(interval,
+                                       boost::bind(&NameServerImpl::OnTabletOffline, this, endpoint, false));
+                return;
+            }
+            PDLOG(INFO, "the lease of endpoint %s expired. lease time %lu cur time %lu", endpoint.c_str(),
+                  tit->second->lease_time_, cur_time);
+            tit->second->lease_expired_ = true;
         }
     }
     if (auto_failover_.load(std::memory_order_acquire)) {
@@ -1234,6 +1406,10 @@ void NameServerImpl::OnTabletOnline(const std::string& endpoint) {
     if (!auto_failover_.load(std::memory_order_acquire)) {
         std::lock_guard<std::mutex> lock(mu_);
         offline_endpoint_map_.erase(endpoint);
+        auto tit = tablets_.find(endpoint);
+        if (tit != tablets_.end()) {
+            tit->second->lease_expired_ = false;
+        }
         return;
     }
     std::string value;
@@ -1257,7 +1433,14 @@ void NameServerImpl::OnTabletOnline(const std::string& endpoint) {
             offline_endpoint_map_.erase(iter);
             return;
         }
-        if (!boost::starts_with(value, "startup_")) {
+        bool lease_expired = false;
+        auto tit = tablets_.find(endpoint);
+        if (tit != tablets_.end()) {
+            // it was failed over early, so it is recovered however soon it comes back
+            lease_expired = tit->second->lease_expired_;
+            tit->second->lease_expired_ = false;
+        }
+        if (!boost::starts_with(value, "startup_") && !lease_expired) {
             uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
             if (cur_time < iter->second + FLAGS_tablet_heartbeat_timeout) {
                 PDLOG(INFO,
@@ -1281,6 +1464,118 @@ void NameServerImpl::OnTabletOnline(const std::string& endpoint) {
     }
 }
 
+bool NameServerImpl::IsLeaseExpiredLocked(const TabletInfo& tablet, uint64_t cur_time) const {
+    // the tablet got the last heartbeat answered within half the lease after it was sent and takes no writes as
+    // leader a lease after it got it, so it is fenced before twice the lease passed
+    return FLAGS_tablet_lease_timeout > 0 && cur_time >= tablet.lease_time_ + 2 * FLAGS_tablet_lease_timeout;
+}
+
+void NameServerImpl::ResetTabletLease(const std::shared_ptr<TabletInfo>& tablet) {
+    if (FLAGS_tablet_lease_timeout > 0) {
+        return;
+    }
+    // a tablet still holding the lease of a name server with the heartbeats on would be fenced forever
+    auto callback = new openmldb::RpcCallback<::openmldb::api::GeneralResponse>(
+        std::make_shared<::openmldb::api::GeneralResponse>(), std::make_shared<brpc::Controller>());
+    if (!tablet->client_->AsyncHeartbeat(0, callback)) {
+        callback->UnRef();
+    }
+}
+
+void NameServerImpl::CheckTabletLease() {
+    if (running_.load(std::memory_order_acquire)) {
+        uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+        std::lock_guard<std::mutex> lock(mu_);
+        for (const auto& kv : tablets_) {
+            if (kv.second->lease_expired_) {
+                // failed over already, so it stays fenced until it is recovered
+                continue;
+            }
+            auto hit = heartbeats_.find(kv.first);
+            if (hit != heartbeats_.end()) {
+                auto callback = hit->second.second;
+                if (!callback->IsDone()) {
+                    // the last one is in flight, it times out in half the lease at most
+                    continue;
+                }
+                if (!callback->GetController()->Failed() && callback->GetResponse()->code() == 0) {
+                    kv.second->lease_time_ = std::max(kv.second->lease_time_, hit->second.first);
+                }
+                callback->UnRef();
+                heartbeats_.erase(hit);
+            }
+            auto callback = new openmldb::RpcCallback<::openmldb::api::GeneralResponse>(
+                std::make_shared<::openmldb::api::GeneralResponse>(), std::make_shared<brpc::Controller>());
+            callback->GetController()->set_timeout_ms(std::max(1u, FLAGS_tablet_lease_timeout / 2));
+            // one ref is released when the rpc is done, the other one when the response is read
+            callback->Ref();
+            if (!kv.second->client_->AsyncHeartbeat(FLAGS_tablet_lease_timeout, callback)) {
+                callback->UnRef();
+                callback->UnRef();
+                continue;
+            }
+            heartbeats_.emplace(kv.first, std::make_pair(cur_time, callback));
+        }
+    }
+    thread_pool_.DelayTask(FLAGS_tablet_lease_heartbeat_interval,
+                           boost::bind(&NameServerImpl::CheckTabletLease, this));
+}
+
+void NameServerImpl::AddBroadcastReplica(const std::string& endpoint) {
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    auto tablet_it = tablets_.find(endpoint);
+    if (tablet_it == tablets_.end() || tablet_it->second->state_ != ::openmldb::type::EndpointState::kHealthy) {
+        return;
+    }
+    std::vector<std::shared_ptr<TableInfo>> broadcast_tables;
+    for (const auto& kv : table_info_) {
+        if (kv.second->broadcast()) {
+            broadcast_tables.push_back(kv.second);
+        }
+    }
+    for (const auto& db_kv : db_table_info_) {
+        for (const auto& kv : db_kv.second) {
+            if (kv.second->broadcast()) {
+                broadcast_tables.push_back(kv.second);
+            }
+        }
+    }
+    for (const auto& table_info : broadcast_tables) {
+        for (const auto& partition : table_info->table_partition()) {
+            bool exist = false;
+            for (const auto& meta : partition.partition_meta()) {
+                if (meta.endpoint() == endpoint) {
+                    exist = true;
+                    break;
+                }
+            }
+            if (exist) {
+                continue;
+            }
+            AddReplicaNSRequest request;
+            request.set_name(table_info->name());
+            request.set_db(table_info->db());
+            request.set_pid(partition.pid());
+            request.set_endpoint(endpoint);
+            std::string value;
+            request.SerializeToString(&value);
+            std::shared_ptr<OPData> op_data;
+            if (CreateOPData(::openmldb::api::OPType::kAddReplicaOP, value, op_data, table_info->name(),
+                             table_info->db(), partition.pid()) < 0 ||
+                CreateAddReplicaOPTask(op_data) < 0 || AddOPData(op_data, 1) < 0) {
+                PDLOG(WARNING, "add the broadcast replica failed. table[%s] pid[%u] endpoint[%s]",
+                      table_info->name().c_str(), partition.pid(), endpoint.c_str());
+                continue;
+            }
+            PDLOG(INFO, "add the broadcast replica. op_id[%lu] table[%s] pid[%u] endpoint[%s]",
+                  op_data->op_info_.op_id(), table_info->name().c_str(), partition.pid(), endpoint.c_str());
+        }
+    }
+}
+
 void NameServerImpl::RecoverEndpointDBInternal(
     const std::string& endpoint, bool need_restore, uint32_t concurrency,
     const std::map<std::string, std::shared_ptr<::openmldb::nameserver::TableInfo>>& table_info) {
@@ -1380,6 +1675,7 @@ bool NameServerImpl::Init(const std::string& zk_cluster, const std::string& zk_p
         return false;
     }
     endpoint_ = endpoint;
+    real_endpoint_ = real_endpoint.empty() ? endpoint : real_endpoint;
     running_.store(false, std::memory_order_release);
     if (!zk_cluster.empty()) {
         startup_mode_ = ::openmldb::type::StartupMode::kCluster;
@@ -1402,6 +1698,7 @@ bool NameServerImpl::Init(const std::string& zk_cluster, const std::string& zk_p
         zk_path_.zone_data_path_ = zk_path + "/cluster";
         zk_path_.auto_failover_node_ = zk_config_path + "/auto_failover";
         zk_path_.table_changed_notify_node_ = zk_table_path + "/notify";
+        zk_path_.table_change_log_path_ = zk_table_path + "/change_log";
         zk_path_.globalvar_changed_notify_node_ = zk_path + "/notify/global_variable";
         zk_path_.external_function_path_ = zk_path + "/data/function";
         zone_info_.set_mode(kNORMAL);
@@ -1436,6 +1733,13 @@ bool NameServerImpl::Init(const std::string& zk_cluster, const std::string& zk_p
         session_term_ = zk_client_->GetSessionTerm();
 
         thread_pool_.DelayTask(FLAGS_zk_keep_alive_check_interval, boost::bind(&NameServerImpl::CheckZkClient, this));
+        if (FLAGS_tablet_lease_timeout > 0) {
+            thread_pool_.DelayTask(FLAGS_tablet_lease_heartbeat_interval,
+                                   boost::bind(&NameServerImpl::CheckTabletLease, this));
+        }
+        if (FLAGS_enable_ns_warm_standby) {
+            task_thread_pool_.AddTask(boost::bind(&NameServerImpl::SyncStandby, this));
+        }
         dist_lock_ = new DistLock(zk_path + "/leader", zk_client_, boost::bind(&NameServerImpl::OnLocked, this),
                                   boost::bind(&NameServerImpl::OnLostLock, this), endpoint);
         dist_lock_->Lock();
@@ -1457,6 +1761,7 @@ bool NameServerImpl::Init(const std::string& zk_cluster, const std::string& zk_p
     mode_.store(kNORMAL, std::memory_order_release);
     auto_failover_.store(FLAGS_auto_failover, std::memory_order_release);
     task_rpc_version_.store(0, std::memory_order_relaxed);
+    task_status_notified_.store(false, std::memory_order_relaxed);
     if (FLAGS_use_name) {
         auto n_it = real_ep_map_.find(FLAGS_endpoint);
         if (n_it == real_ep_map_.end()) {
@@ -1497,6 +1802,34 @@ void NameServerImpl::CheckZkClient() {
 }
 
 int NameServerImpl::UpdateTaskStatus(bool is_recover_op) {
+    SyncTaskStatus(is_recover_op);
+    if (running_.load(std::memory_order_acquire)) {
+        task_thread_pool_.DelayTask(FLAGS_get_task_status_interval,
+                                    boost::bind(&NameServerImpl::UpdateTaskStatus, this, false));
+    }
+    return 0;
+}
+
+void NameServerImpl::NotifyTaskStatus(RpcController* controller, const NotifyTaskStatusRequest* request,
+                                      GeneralResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    if (!running_.load(std::memory_order_acquire)) {
+        response->set_code(::openmldb::base::ReturnCode::kNameserverIsNotLeader);
+        response->set_msg("nameserver is not leader");
+        return;
+    }
+    DEBUGLOG("task status is notified by %s", request->endpoint().c_str());
+    // the notifies before the sync runs are merged into one sync
+    if (!task_status_notified_.exchange(true, std::memory_order_acq_rel)) {
+        task_thread_pool_.AddTask(boost::bind(&NameServerImpl::SyncTaskStatus, this, false));
+    }
+    response->set_code(::openmldb::base::ReturnCode::kOk);
+    response->set_msg("ok");
+}
+
+void NameServerImpl::SyncTaskStatus(bool is_recover_op) {
+    // the notifies from now on need another sync
+    task_status_notified_.store(false, std::memory_order_release);
     std::map<std::string, std::shared_ptr<TabletClient>> client_map;
     {
         std::lock_guard<std::mutex> lock(mu_);
@@ -1557,11 +1890,6 @@ int NameServerImpl::UpdateTaskStatus(bool is_recover_op) {
         }
     }
     UpdateTaskStatusRemote(is_recover_op);
-    if (running_.load(std::memory_order_acquire)) {
-        task_thread_pool_.DelayTask(FLAGS_get_task_status_interval,
-                                    boost::bind(&NameServerImpl::UpdateTaskStatus, this, false));
-    }
-    return 0;
 }
 
 int NameServerImpl::UpdateTaskStatusRemote(bool is_recover_op) {
@@ -1974,6 +2302,17 @@ void NameServerImpl::ProcessTask() {
                 }
             }
 
+            // the count of running ops on each tablet
+            std::map<std::string, uint32_t> endpoint_op_cnt;
+            if (FLAGS_name_server_task_concurrency_per_endpoint > 0) {
+                for (const auto& op_list : task_vec_) {
+                    if (!op_list.empty() && op_list.front()->op_info_.task_status() == ::openmldb::api::kDoing) {
+                        for (const auto& endpoint : GetOPEndpoints(op_list.front())) {
+                            endpoint_op_cnt[endpoint]++;
+                        }
+                    }
+                }
+            }
             for (const auto& op_list : task_vec_) {
                 if (op_list.empty()) {
                     continue;
@@ -1984,6 +2323,23 @@ void NameServerImpl::ProcessTask() {
                     continue;
                 }
                 if (op_data->op_info_.task_status() == ::openmldb::api::kInited) {
+                    if (FLAGS_name_server_task_concurrency_per_endpoint > 0) {
+                        // wait until the tablets of the op are not busy with the other ops
+                        std::set<std::string> endpoints = GetOPEndpoints(op_data);
+                        bool is_busy = false;
+                        for (const auto& endpoint : endpoints) {
+                            if (endpoint_op_cnt[endpoint] >= FLAGS_name_server_task_concurrency_per_endpoint) {
+                                is_busy = true;
+                                break;
+                            }
+                        }
+                        if (is_busy) {
+                            continue;
+                        }
+                        for (const auto& endpoint : endpoints) {
+                            endpoint_op_cnt[endpoint]++;
+                        }
+                    }
                     op_data->op_info_.set_start_time(::baidu::common::timer::now_time());
                     op_data->op_info_.set_task_status(::openmldb::api::kDoing);
                     std::string value;
@@ -2005,6 +2361,11 @@ void NameServerImpl::ProcessTask() {
                     DEBUGLOG("run task. opid[%lu] op_type[%s] task_type[%s]", task->task_info_->op_id(),
                              ::openmldb::api::OPType_Name(task->task_info_->op_type()).c_str(),
                              ::openmldb::api::TaskType_Name(task->task_info_->task_type()).c_str());
+                    // the tablet notifies the nameserver once the task is finished
+                    task->task_info_->set_notify_endpoint(real_endpoint_);
+                    for (auto& sub_task : task->sub_task_) {
+                        sub_task->task_info_->set_notify_endpoint(real_endpoint_);
+                    }
                     task_thread_pool_.AddTask(task->fun_);
                     task->task_info_->set_status(::openmldb::api::kDoing);
                 } else if (task->task_info_->status() == ::openmldb::api::kDoing) {
@@ -2028,6 +2389,21 @@ void NameServerImpl::ProcessTask() {
     }
 }
 
+std::set<std::string> NameServerImpl::GetOPEndpoints(const std::shared_ptr<OPData>& op_data) {
+    std::set<std::string> endpoints;
+    for (const auto& task : op_data->task_list_) {
+        if (task->task_info_->has_endpoint()) {
+            endpoints.insert(task->task_info_->endpoint());
+        }
+        for (const auto& sub_task : task->sub_task_) {
+            if (sub_task->task_info_->has_endpoint()) {
+                endpoints.insert(sub_task->task_info_->endpoint());
+            }
+        }
+    }
+    return endpoints;
+}
+
 void NameServerImpl::ConnectZK(RpcController* controller, const ConnectZKRequest* request, GeneralResponse* response,
                                Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -2216,6 +2592,12 @@ int NameServerImpl::SetPartitionInfo(TableInfo& table_info) {
     }
     endpoint_vec.reserve(endpoint_pid_bucked.size());
     uint32_t replica_num = std::min(FLAGS_replica_num, (uint32_t)endpoint_pid_bucked.size());
+    if (table_info.broadcast()) {
+        // one partition with a replica on every healthy tablet
+        partition_num = 1;
+        table_info.set_partition_num(partition_num);
+        table_info.set_replica_num(endpoint_pid_bucked.size());
+    }
     if (table_info.has_replica_num() && table_info.replica_num() > 0) {
         replica_num = table_info.replica_num();
     } else {
@@ -2268,6 +2650,22 @@ int NameServerImpl::SetPartitionInfo(TableInfo& table_info) {
         }
         index++;
     }
+    // place the replicas on the least loaded tablets once the load is collected
+    std::vector<std::vector<std::string>> placement;
+    if (FLAGS_enable_load_balance) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!load_balancer_.Empty()) {
+            std::vector<double> replica_scores;
+            auto scores = LoadBalancer::GetScores(load_balancer_.GetLoads(), endpoint_vec, &replica_scores);
+            // a new replica is assumed to cost as much as an average one
+            double cost = 0.0;
+            for (double score : replica_scores) {
+                cost += score;
+            }
+            cost = cost > 0 ? cost / replica_scores.size() : 1.0;
+            placement = LoadBalancer::Place(scores, cost, partition_num, replica_num);
+        }
+    }
     for (uint32_t pid = 0; pid < partition_num; pid++) {
         TablePartition* table_partition = table_info.add_table_partition();
         table_partition->set_pid(pid);
@@ -2275,7 +2673,7 @@ int NameServerImpl::SetPartitionInfo(TableInfo& table_info) {
         PartitionMeta* leader_partition_meta = NULL;
         for (uint32_t idx = 0; idx < replica_num; idx++) {
             PartitionMeta* partition_meta = table_partition->add_partition_meta();
-            std::string endpoint = endpoint_vec[pos % endpoint_vec.size()];
+            std::string endpoint = placement.empty() ? endpoint_vec[pos % endpoint_vec.size()] : placement[pid][idx];
             partition_meta->set_endpoint(endpoint);
             partition_meta->set_is_leader(false);
             if (endpoint_leader[endpoint] < min_leader_num) {
@@ -2309,6 +2707,27 @@ int NameServerImpl::CreateTableOnTablet(const std::shared_ptr<::openmldb::namese
     table_meta.set_compress_type(compress_type);
     table_meta.set_format_version(table_info->format_version());
     table_meta.set_storage_mode(table_info->storage_mode());
+    if (table_info->storage_mode() != ::openmldb::common::kMemory && table_info->hot_ttl() > 0) {
+        table_meta.set_hot_ttl(table_info->hot_ttl());
+    }
+    if (table_info->has_filter_bits_per_key()) {
+        table_meta.set_filter_bits_per_key(table_info->filter_bits_per_key());
+    }
+    if (table_info->block_cache_mb() > 0) {
+        table_meta.set_block_cache_mb(table_info->block_cache_mb());
+    }
+    if (table_info->has_compaction_rate_limit_mb()) {
+        table_meta.set_compaction_rate_limit_mb(table_info->compaction_rate_limit_mb());
+    }
+    if (table_info->compact_row()) {
+        table_meta.set_compact_row(true);
+    }
+    if (table_info->broadcast()) {
+        table_meta.set_broadcast(true);
+    }
+    if (table_info->storage_mode() != ::openmldb::common::kMemory && table_info->single_row_store()) {
+        table_meta.set_single_row_store(true);
+    }
     if (table_info->has_key_entry_max_height()) {
         table_meta.set_key_entry_max_height(table_info->key_entry_max_height());
     }
@@ -2884,6 +3303,95 @@ void NameServerImpl::ShowOPStatus(RpcController* controller, const ShowOPStatusR
     response->set_msg("ok");
 }
 
+void NameServerImpl::Metrics(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                             ::openmldb::api::HttpResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    using ::openmldb::base::PrometheusWriter;
+    PrometheusWriter writer;
+    bool is_leader = running_.load(std::memory_order_acquire);
+    writer.Declare("openmldb_nameserver_leader", "gauge", "Whether the nameserver is the leader.");
+    writer.Add("openmldb_nameserver_leader", {}, is_leader ? 1 : 0);
+    cntl->http_response().set_content_type("text/plain; version=0.0.4");
+    if (!is_leader) {
+        cntl->response_attachment().append(writer.Dump());
+        return;
+    }
+    writer.Declare("openmldb_nameserver_tablets", "gauge", "The tablets by the state.");
+    writer.Declare("openmldb_nameserver_table_rows", "gauge", "The rows of the table reported by the leaders.");
+    writer.Declare("openmldb_nameserver_table_bytes", "gauge", "The bytes of the table reported by the leaders.");
+    writer.Declare("openmldb_nameserver_unalive_replicas", "gauge", "The replicas of the table not alive.");
+    writer.Declare("openmldb_nameserver_replica_lag_entries", "gauge",
+                   "The binlog entries of the follower behind the leader, as of the latest table status.");
+    writer.Declare("openmldb_nameserver_ops", "gauge", "The ops not deleted yet by the type and the status.");
+    std::lock_guard<std::mutex> lock(mu_);
+    std::map<std::string, uint64_t> tablet_cnt = {{"kHealthy", 0}, {"kOffline", 0}};
+    for (const auto& kv : tablets_) {
+        tablet_cnt[::openmldb::type::EndpointState_Name(kv.second->state_)]++;
+    }
+    for (const auto& kv : tablet_cnt) {
+        writer.Add("openmldb_nameserver_tablets", {{"state", kv.first}}, kv.second);
+    }
+    auto add_table = [&writer](const std::string& db, const ::openmldb::nameserver::TableInfo& table_info) {
+        uint64_t record_cnt = 0;
+        uint64_t record_byte_size = 0;
+        uint64_t unalive_cnt = 0;
+        PrometheusWriter::Labels labels = {{"db", db}, {"table", table_info.name()}, {"pid", ""}, {"follower", ""}};
+        for (const auto& partition : table_info.table_partition()) {
+            record_cnt += partition.record_cnt();
+            record_byte_size += partition.record_byte_size();
+            const PartitionMeta* leader = nullptr;
+            for (const auto& meta : partition.partition_meta()) {
+                if (!meta.is_alive()) {
+                    unalive_cnt++;
+                } else if (meta.is_leader()) {
+                    leader = &meta;
+                }
+            }
+            if (leader == nullptr) {
+                continue;
+            }
+            labels[2].second = std::to_string(partition.pid());
+            for (const auto& meta : partition.partition_meta()) {
+                if (meta.is_alive() && !meta.is_leader()) {
+                    labels[3].second = meta.endpoint();
+                    writer.Add("openmldb_nameserver_replica_lag_entries", labels,
+                               leader->offset() > meta.offset() ? leader->offset() - meta.offset() : 0);
+                }
+            }
+        }
+        labels.resize(2);
+        writer.Add("openmldb_nameserver_table_rows", labels, record_cnt);
+        writer.Add("openmldb_nameserver_table_bytes", labels, record_byte_size);
+        writer.Add("openmldb_nameserver_unalive_replicas", labels, unalive_cnt);
+    };
+    for (const auto& kv : table_info_) {
+        add_table("", *kv.second);
+    }
+    for (const auto& db_kv : db_table_info_) {
+        for (const auto& kv : db_kv.second) {
+            add_table(db_kv.first, *kv.second);
+        }
+    }
+    std::map<std::pair<std::string, std::string>, uint64_t> op_cnt;
+    auto count_op = [&op_cnt](const std::shared_ptr<OPData>& op_data) {
+        op_cnt[{::openmldb::api::OPType_Name(op_data->op_info_.op_type()),
+                ::openmldb::api::TaskStatus_Name(op_data->op_info_.task_status())}]++;
+    };
+    for (const auto& op_data : done_op_list_) {
+        count_op(op_data);
+    }
+    for (const auto& op_list : task_vec_) {
+        for (const auto& op_data : op_list) {
+            count_op(op_data);
+        }
+    }
+    for (const auto& kv : op_cnt) {
+        writer.Add("openmldb_nameserver_ops", {{"type", kv.first.first}, {"status", kv.first.second}}, kv.second);
+    }
+    cntl->response_attachment().append(writer.Dump());
+}
+
 void NameServerImpl::ShowDbTable(const std::map<std::string, std::shared_ptr<TableInfo>>& table_infos,
                                  const ShowTableRequest* request, ShowTableResponse* response) {
     for (const auto& kv : table_infos) {
@@ -3138,7 +3646,11 @@ void NameServerImpl::DropTableInternel(const DropTableRequest& request, GeneralR
         }
     }
     if (IsClusterMode()) {
-        NotifyTableChanged(::openmldb::type::NotifyType::kTable);
+        std::vector<std::string> table_nodes;
+        if (!request.db().empty()) {
+            table_nodes.push_back(std::to_string(tid));
+        }
+        NotifyTableChanged(table_nodes);
     }
 }
 
@@ -3657,7 +4169,7 @@ bool NameServerImpl::SetTableInfo(std::shared_ptr<::openmldb::nameserver::TableI
         {
             std::lock_guard<std::mutex> lock(mu_);
             db_table_info_[table_info->db()].insert(std::make_pair(table_info->name(), table_info));
-            NotifyTableChanged(::openmldb::type::NotifyType::kTable);
+            NotifyTableChanged(std::vector<std::string>{std::to_string(table_info->tid())});
         }
     } else {
         if (!zk_client_->CreateNode(zk_path_.table_data_path_ + "/" + table_info->name(), table_value)) {
@@ -4741,6 +5253,265 @@ int NameServerImpl::CreateMigrateTask(std::shared_ptr<OPData> op_data) {
     return 0;
 }
 
+void NameServerImpl::SplitPartition(RpcController* controller, const SplitPartitionRequest* request,
+                                    GeneralResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    if (!running_.load(std::memory_order_acquire)) {
+        response->set_code(::openmldb::base::ReturnCode::kNameserverIsNotLeader);
+        response->set_msg("nameserver is not leader");
+        PDLOG(WARNING, "cur nameserver is not leader");
+        return;
+    }
+    if (auto_failover_.load(std::memory_order_acquire)) {
+        response->set_code(::openmldb::base::ReturnCode::kAutoFailoverIsEnabled);
+        response->set_msg("auto_failover is enabled");
+        PDLOG(WARNING, "auto_failover is enabled");
+        return;
+    }
+    const std::string& name = request->name();
+    const std::string& db = request->db();
+    uint32_t pid = request->pid();
+    if (db == INTERNAL_DB || db == INFORMATION_SCHEMA_DB || db == PRE_AGG_DB) {
+        response->set_code(::openmldb::base::ReturnCode::kOperatorNotSupport);
+        response->set_msg("cannot split the system table");
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    std::shared_ptr<::openmldb::nameserver::TableInfo> table_info;
+    if (!GetTableInfoUnlock(name, db, &table_info)) {
+        response->set_code(::openmldb::base::ReturnCode::kTableIsNotExist);
+        response->set_msg("table is not exist");
+        PDLOG(WARNING, "table[%s] is not exist", name.c_str());
+        return;
+    }
+    if (table_info->storage_mode() != ::openmldb::common::kMemory || table_info->partition_key_size() > 0) {
+        response->set_code(::openmldb::base::ReturnCode::kOperatorNotSupport);
+        response->set_msg("only the memory table partitioned by the index keys can be split");
+        return;
+    }
+    if (pid >= static_cast<uint32_t>(table_info->table_partition_size())) {
+        response->set_code(::openmldb::base::ReturnCode::kPidIsNotExist);
+        response->set_msg("pid is not exist");
+        return;
+    }
+    std::string leader_endpoint;
+    if (GetLeader(table_info, pid, leader_endpoint) < 0 || leader_endpoint.empty()) {
+        response->set_code(::openmldb::base::ReturnCode::kTableHasNoAliveLeaderPartition);
+        response->set_msg("the partition has no alive leader");
+        PDLOG(WARNING, "get leader failed. table[%s] pid[%u]", name.c_str(), pid);
+        return;
+    }
+    ::openmldb::base::PartitionRouter router(table_info->table_partition_size(), table_info->partition_split());
+    if (router.GetDepth(pid) >= ::openmldb::base::PartitionRouter::kMaxSplitDepth) {
+        response->set_code(::openmldb::base::ReturnCode::kInvalidParameter);
+        response->set_msg("the partition cannot be split any more");
+        return;
+    }
+    // the child pid is taken by the order of the splits, so the splits of a table are done one by one
+    for (const auto& ops : task_vec_) {
+        for (const auto& op : ops) {
+            if (op->op_info_.op_type() == ::openmldb::api::OPType::kSplitPartitionOP &&
+                op->op_info_.name() == name && op->op_info_.db() == db) {
+                response->set_code(::openmldb::base::ReturnCode::kOperatorNotSupport);
+                response->set_msg("the table is being split");
+                return;
+            }
+        }
+    }
+    SplitPartitionMeta split_meta;
+    split_meta.set_name(name);
+    split_meta.set_db(db);
+    split_meta.set_pid(pid);
+    split_meta.set_child_pid(router.GetNextChild());
+    std::string value;
+    split_meta.SerializeToString(&value);
+    std::shared_ptr<OPData> op_data;
+    if (CreateOPData(::openmldb::api::OPType::kSplitPartitionOP, value, op_data, name, db, pid) < 0) {
+        PDLOG(WARNING, "create SplitPartitionOP data failed. table[%s] pid[%u]", name.c_str(), pid);
+        response->set_code(::openmldb::base::ReturnCode::kSetZkFailed);
+        response->set_msg("set zk failed");
+        return;
+    }
+    if (CreateSplitPartitionOPTask(op_data) < 0) {
+        PDLOG(WARNING, "create SplitPartitionOP task failed. table[%s] pid[%u]", name.c_str(), pid);
+        response->set_code(::openmldb::base::ReturnCode::kCreateOpFailed);
+        response->set_msg("create op failed");
+        return;
+    }
+    if (AddOPData(op_data, FLAGS_name_server_task_max_concurrency) < 0) {
+        PDLOG(WARNING, "add op data failed. table[%s] pid[%u]", name.c_str(), pid);
+        response->set_code(::openmldb::base::ReturnCode::kAddOpDataFailed);
+        response->set_msg("add op data failed");
+        return;
+    }
+    PDLOG(INFO, "add split partition op ok. op_id[%lu] table[%s] pid[%u] child_pid[%u]", op_data->op_info_.op_id(),
+          name.c_str(), pid, split_meta.child_pid());
+    response->set_code(::openmldb::base::ReturnCode::kOk);
+    response->set_msg("ok");
+}
+
+int NameServerImpl::CreateSplitPartitionOPTask(std::shared_ptr<OPData> op_data) {
+    SplitPartitionMeta split_meta;
+    if (!split_meta.ParseFromString(op_data->op_info_.data())) {
+        PDLOG(WARNING, "parse SplitPartitionMeta failed. data[%s]", op_data->op_info_.data().c_str());
+        return -1;
+    }
+    const std::string& name = split_meta.name();
+    const std::string& db = split_meta.db();
+    uint32_t pid = split_meta.pid();
+    uint32_t child_pid = split_meta.child_pid();
+    std::shared_ptr<::openmldb::nameserver::TableInfo> table_info;
+    if (!GetTableInfoUnlock(name, db, &table_info)) {
+        PDLOG(WARNING, "get table info failed! name[%s]", name.c_str());
+        return -1;
+    }
+    uint32_t tid = table_info->tid();
+    std::string leader_endpoint;
+    if (GetLeader(table_info, pid, leader_endpoint) < 0 || leader_endpoint.empty()) {
+        PDLOG(WARNING, "get leader failed. table[%s] pid[%u]", name.c_str(), pid);
+        return -1;
+    }
+    auto tablet = GetHealthTabletInfoNoLock(leader_endpoint);
+    if (!tablet) {
+        PDLOG(WARNING, "leader[%s] is not online", leader_endpoint.c_str());
+        return -1;
+    }
+    // the splits after this one, which may be in the table info already if the op is recovered
+    ::google::protobuf::RepeatedPtrField<::openmldb::common::PartitionSplit> splits(table_info->partition_split());
+    bool has_split = false;
+    for (const auto& split : splits) {
+        has_split = has_split || split.child_pid() == child_pid;
+    }
+    if (!has_split) {
+        auto split = splits.Add();
+        split->set_pid(pid);
+        split->set_child_pid(child_pid);
+    }
+    uint32_t partition_num = std::max(static_cast<uint32_t>(table_info->table_partition_size()), child_pid + 1);
+    uint64_t op_index = op_data->op_info_.op_id();
+    auto op_type = ::openmldb::api::OPType::kSplitPartitionOP;
+    auto new_task = [&](::openmldb::api::TaskType task_type) {
+        std::shared_ptr<Task> task =
+            std::make_shared<Task>(leader_endpoint, std::make_shared<::openmldb::api::TaskInfo>());
+        task->task_info_->set_op_id(op_index);
+        task->task_info_->set_op_type(op_type);
+        task->task_info_->set_task_type(task_type);
+        task->task_info_->set_status(::openmldb::api::TaskStatus::kInited);
+        task->task_info_->set_endpoint(leader_endpoint);
+        op_data->task_list_.push_back(task);
+        return task;
+    };
+    // copy the rows routed to the child to it on the leader, which forwards the puts of the child meanwhile
+    auto task = new_task(::openmldb::api::TaskType::kSplitTable);
+    boost::function<bool()> fun = boost::bind(&TabletClient::SplitTable, tablet->client_, tid, pid, child_pid,
+                                              partition_num, splits, task->task_info_);
+    task->fun_ = boost::bind(&NameServerImpl::WrapTaskFun, this, fun, task->task_info_);
+    task = new_task(::openmldb::api::TaskType::kAddSplitPartition);
+    task->fun_ = boost::bind(&NameServerImpl::AddSplitPartition, this, name, db, pid, child_pid, task->task_info_);
+    task = new_task(::openmldb::api::TaskType::kDeleteSplitData);
+    fun = boost::bind(&TabletClient::DeleteSplitData, tablet->client_, tid, pid, partition_num, splits,
+                      task->task_info_);
+    task->fun_ = boost::bind(&NameServerImpl::WrapTaskFun, this, fun, task->task_info_);
+    task = new_task(::openmldb::api::TaskType::kAddSplitReplica);
+    task->fun_ = boost::bind(&NameServerImpl::AddSplitReplica, this, name, db, pid, child_pid, task->task_info_);
+    PDLOG(INFO, "create SplitPartitionOP task ok. table[%s] pid[%u] child_pid[%u]", name.c_str(), pid, child_pid);
+    return 0;
+}
+
+void NameServerImpl::AddSplitPartition(const std::string& name, const std::string& db, uint32_t pid,
+                                       uint32_t child_pid, std::shared_ptr<::openmldb::api::TaskInfo> task_info) {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::shared_ptr<::openmldb::nameserver::TableInfo> table_info;
+    if (!GetTableInfoUnlock(name, db, &table_info)) {
+        PDLOG(WARNING, "not found table[%s] in table_info map. op_id[%lu]", name.c_str(), task_info->op_id());
+        task_info->set_status(::openmldb::api::TaskStatus::kFailed);
+        return;
+    }
+    if (child_pid < static_cast<uint32_t>(table_info->table_partition_size())) {
+        PDLOG(INFO, "partition %u of table[%s] is added already. op_id[%lu]", child_pid, name.c_str(),
+              task_info->op_id());
+        task_info->set_status(::openmldb::api::TaskStatus::kDone);
+        return;
+    }
+    if (child_pid != static_cast<uint32_t>(table_info->table_partition_size())) {
+        PDLOG(WARNING, "child pid %u is not the next partition of table[%s]. op_id[%lu]", child_pid, name.c_str(),
+              task_info->op_id());
+        task_info->set_status(::openmldb::api::TaskStatus::kFailed);
+        return;
+    }
+    std::string leader_endpoint;
+    if (GetLeader(table_info, pid, leader_endpoint) < 0 || leader_endpoint.empty()) {
+        PDLOG(WARNING, "get leader failed. table[%s] pid[%u] op_id[%lu]", name.c_str(), pid, task_info->op_id());
+        task_info->set_status(::openmldb::api::TaskStatus::kFailed);
+        return;
+    }
+    std::shared_ptr<::openmldb::nameserver::TableInfo> cur_table_info(table_info->New());
+    cur_table_info->CopyFrom(*table_info);
+    const auto& parent = cur_table_info->table_partition(pid);
+    ::openmldb::nameserver::TablePartition* table_partition = cur_table_info->add_table_partition();
+    table_partition->set_pid(child_pid);
+    if (parent.term_offset_size() > 0) {
+        auto term_pair = table_partition->add_term_offset();
+        term_pair->set_term(parent.term_offset(parent.term_offset_size() - 1).term());
+        term_pair->set_offset(0);
+    }
+    ::openmldb::nameserver::PartitionMeta* partition_meta = table_partition->add_partition_meta();
+    partition_meta->set_endpoint(leader_endpoint);
+    partition_meta->set_is_leader(true);
+    partition_meta->set_is_alive(true);
+    auto split = cur_table_info->add_partition_split();
+    split->set_pid(pid);
+    split->set_child_pid(child_pid);
+    cur_table_info->set_partition_num(cur_table_info->table_partition_size());
+    if (!UpdateZkTableNode(cur_table_info)) {
+        task_info->set_status(::openmldb::api::TaskStatus::kFailed);
+        return;
+    }
+    table_info->CopyFrom(*cur_table_info);
+    task_info->set_status(::openmldb::api::TaskStatus::kDone);
+    PDLOG(INFO, "add split partition %u of pid %u to table[%s]. op_id[%lu]", child_pid, pid, name.c_str(),
+          task_info->op_id());
+}
+
+void NameServerImpl::AddSplitReplica(const std::string& name, const std::string& db, uint32_t pid,
+                                     uint32_t child_pid, std::shared_ptr<::openmldb::api::TaskInfo> task_info) {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::shared_ptr<::openmldb::nameserver::TableInfo> table_info;
+    if (!GetTableInfoUnlock(name, db, &table_info) ||
+        child_pid >= static_cast<uint32_t>(table_info->table_partition_size())) {
+        PDLOG(WARNING, "not found partition %u of table[%s]. op_id[%lu]", child_pid, name.c_str(), task_info->op_id());
+        task_info->set_status(::openmldb::api::TaskStatus::kFailed);
+        return;
+    }
+    std::set<std::string> child_endpoints;
+    for (const auto& meta : table_info->table_partition(child_pid).partition_meta()) {
+        child_endpoints.insert(meta.endpoint());
+    }
+    for (const auto& meta : table_info->table_partition(pid).partition_meta()) {
+        if (meta.is_leader() || !meta.is_alive() || child_endpoints.count(meta.endpoint()) > 0) {
+            continue;
+        }
+        AddReplicaNSRequest request;
+        request.set_name(name);
+        request.set_db(db);
+        request.set_pid(child_pid);
+        request.set_endpoint(meta.endpoint());
+        std::string value;
+        request.SerializeToString(&value);
+        std::shared_ptr<OPData> op_data;
+        // a follower failed to add is left to be added by addreplica
+        if (CreateOPData(::openmldb::api::OPType::kAddReplicaOP, value, op_data, name, db, child_pid) < 0 ||
+            CreateAddReplicaOPTask(op_data) < 0 || AddOPData(op_data, 1) < 0) {
+            PDLOG(WARNING, "fail to add replica of partition %u of table[%s] on %s. op_id[%lu]", child_pid,
+                  name.c_str(), meta.endpoint().c_str(), task_info->op_id());
+            continue;
+        }
+        PDLOG(INFO, "add addreplica op ok. op_id[%lu] table[%s] pid[%u] endpoint[%s]", op_data->op_info_.op_id(),
+              name.c_str(), child_pid, meta.endpoint().c_str());
+    }
+    task_info->set_status(::openmldb::api::TaskStatus::kDone);
+}
+
 void NameServerImpl::DelReplicaNS(RpcController* controller, const DelReplicaNSRequest* request,
                                   GeneralResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -4930,9 +5701,15 @@ int NameServerImpl::AddOPData(const std::shared_ptr<OPData>& op_data, uint32_t c
             idx = FLAGS_name_server_task_max_concurrency + (rand_.Next() % concurrency);
         }
     } else {
-        idx = op_data->op_info_.pid() % task_vec_.size();
+        // the ops of one partition run in order in the same list, and the ops of
+        // different tables are spread across the lists
+        uint64_t hash = op_data->op_info_.pid();
+        if (op_data->op_info_.pid() != INVALID_PID) {
+            hash += ::openmldb::base::hash64(op_data->op_info_.db() + "." + op_data->op_info_.name());
+        }
+        idx = hash % task_vec_.size();
         if (concurrency < task_vec_.size() && concurrency > 0) {
-            idx = op_data->op_info_.pid() % concurrency;
+            idx = hash % concurrency;
         }
     }
     op_data->op_info_.set_vec_idx(idx);
@@ -5172,6 +5949,12 @@ void NameServerImpl::UpdateTableStatus() {
             UpdateTableStatusFun(kv.second, pos_response);
         }
     }
+    if (FLAGS_enable_load_balance || FLAGS_enable_leader_balance) {
+        // the replicas not reported in several rounds are dropped or moved
+        uint64_t expire_time = ::baidu::common::timer::get_micros() / 1000 - 5 * FLAGS_get_table_status_interval;
+        std::lock_guard<std::mutex> lock(mu_);
+        load_balancer_.Expire(expire_time);
+    }
     if (running_.load(std::memory_order_acquire)) {
         task_thread_pool_.DelayTask(FLAGS_get_table_status_interval,
                                     boost::bind(&NameServerImpl::UpdateTableStatus, this));
@@ -5181,6 +5964,7 @@ void NameServerImpl::UpdateTableStatus() {
 void NameServerImpl::UpdateTableStatusFun(
     const std::map<std::string, std::shared_ptr<TableInfo>>& table_info_map,
     const std::unordered_map<std::string, ::openmldb::api::TableStatus>& pos_response) {
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
     std::lock_guard<std::mutex> lock(mu_);
     for (const auto& kv : table_info_map) {
         uint32_t tid = kv.second->tid();
@@ -5219,6 +6003,17 @@ void NameServerImpl::UpdateTableStatusFun(
                     }
                     partition_meta->set_record_cnt(record_cnt);
                     partition_meta->set_diskused(table_status.diskused());
+                    if ((FLAGS_enable_load_balance || FLAGS_enable_leader_balance) && partition_meta->is_alive()) {
+                        ReplicaLoad load;
+                        load.name = kv.second->name();
+                        load.db = kv.second->db();
+                        load.tid = tid;
+                        load.pid = pid;
+                        load.endpoint = endpoint;
+                        load.is_leader = partition_meta->is_leader();
+                        load.mem = table_status.record_byte_size() + table_status.record_idx_byte_size();
+                        load_balancer_.Update(load, table_status.offset(), table_status.query_cnt(), cur_time);
+                    }
                     if (kv.second->table_partition(idx).partition_meta(meta_idx).is_alive() &&
                         kv.second->table_partition(idx).partition_meta(meta_idx).is_leader()) {
                         table_partition->set_record_cnt(record_cnt);
@@ -5234,6 +6029,63 @@ void NameServerImpl::UpdateTableStatusFun(
     }
 }
 
+void NameServerImpl::BalanceLoad() {
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (mode_.load(std::memory_order_acquire) != kFOLLOWER) {
+        std::lock_guard<std::mutex> lock(mu_);
+        // wait for the ops of the last round or the others before a new round
+        bool has_op = false;
+        for (const auto& op_list : task_vec_) {
+            if (!op_list.empty()) {
+                has_op = true;
+                break;
+            }
+        }
+        if (!has_op) {
+            std::vector<std::string> endpoints;
+            for (const auto& kv : tablets_) {
+                if (kv.second->state_ == ::openmldb::type::EndpointState::kHealthy) {
+                    endpoints.push_back(kv.first);
+                }
+            }
+            std::vector<BalanceOP> ops;
+            if (FLAGS_enable_leader_balance) {
+                ops = LoadBalancer::PlanLeaders(load_balancer_.GetLoads(), endpoints,
+                                                FLAGS_check_binlog_sync_progress_delta,
+                                                FLAGS_leader_balance_max_op_num);
+            }
+            for (const auto& op : ops) {
+                // the old leader is recovered as a follower after the leader is changed
+                PDLOG(INFO, "balance leader. change leader of name[%s] db[%s] pid[%u] from %s to %s",
+                      op.name.c_str(), op.db.c_str(), op.pid, op.src_endpoint.c_str(), op.des_endpoint.c_str());
+                if (CreateChangeLeaderOP(op.name, op.db, op.pid, op.des_endpoint, false) < 0) {
+                    continue;
+                }
+                CreateRecoverTableOP(op.name, op.db, op.pid, op.src_endpoint, true,
+                                     FLAGS_check_binlog_sync_progress_delta, FLAGS_name_server_task_concurrency);
+            }
+            // move the followers once the leaders are balanced
+            if (ops.empty() && FLAGS_enable_load_balance) {
+                ops = LoadBalancer::Plan(load_balancer_.GetLoads(), endpoints, FLAGS_load_balance_threshold,
+                                         FLAGS_load_balance_max_op_num);
+            }
+            for (const auto& op : ops) {
+                if (op.type != BalanceOPType::kMigrate) {
+                    continue;
+                }
+                PDLOG(INFO, "balance load. migrate name[%s] db[%s] pid[%u] from %s to %s", op.name.c_str(),
+                      op.db.c_str(), op.pid, op.src_endpoint.c_str(), op.des_endpoint.c_str());
+                CreateMigrateOP(op.src_endpoint, op.name, op.db, op.pid, op.des_endpoint);
+            }
+        }
+    }
+    if (running_.load(std::memory_order_acquire)) {
+        task_thread_pool_.DelayTask(FLAGS_load_balance_interval, boost::bind(&NameServerImpl::BalanceLoad, this));
+    }
+}
+
 int NameServerImpl::CreateDelReplicaOP(const std::string& name, const std::string& db, uint32_t pid,
                                        const std::string& endpoint) {
     std::string value = endpoint;
@@ -5570,6 +6422,15 @@ void NameServerImpl::OnLocked() {
         CreateSystemTableOrExit(SystemTableType::kDeployResponseTime);
     }
 
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        // no heartbeat is sent by a standby name server, so the leases start from now
+        uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+        for (const auto& kv : tablets_) {
+            kv.second->lease_time_ = cur_time;
+            ResetTabletLease(kv.second);
+        }
+    }
     running_.store(true, std::memory_order_release);
     task_thread_pool_.DelayTask(FLAGS_get_task_status_interval,
                                 boost::bind(&NameServerImpl::UpdateTaskStatus, this, false));
@@ -5580,11 +6441,17 @@ void NameServerImpl::OnLocked() {
                                 boost::bind(&NameServerImpl::CheckClusterInfo, this));
     task_thread_pool_.DelayTask(FLAGS_make_snapshot_check_interval,
                                 boost::bind(&NameServerImpl::SchedMakeSnapshot, this));
+    if (FLAGS_enable_load_balance || FLAGS_enable_leader_balance) {
+        task_thread_pool_.DelayTask(FLAGS_load_balance_interval, boost::bind(&NameServerImpl::BalanceLoad, this));
+    }
 }
 
 void NameServerImpl::OnLostLock() {
     PDLOG(INFO, "become the stand by name sever");
     running_.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mu_);
+    // the table info changed as the leader is synced again from all tables
+    synced_table_version_ = 0;
 }
 
 int NameServerImpl::CreateRecoverTableOP(const std::string& name, const std::string& db, uint32_t pid,
@@ -5684,6 +6551,17 @@ std::shared_ptr<Task> NameServerImpl::CreateRecoverTableTask(uint64_t op_index,
     return task;
 }
 
+bool NameServerImpl::IsFarBehind(uint64_t offset, uint64_t leader_offset, uint64_t entry_bytes) {
+    if (leader_offset <= offset) {
+        return false;
+    }
+    uint64_t lag = leader_offset - offset;
+    if (FLAGS_catch_up_snapshot_lag_cnt > 0 && lag > FLAGS_catch_up_snapshot_lag_cnt) {
+        return true;
+    }
+    return FLAGS_catch_up_snapshot_lag_mb > 0 && lag * entry_bytes > FLAGS_catch_up_snapshot_lag_mb * 1024 * 1024;
+}
+
 void NameServerImpl::RecoverEndpointTable(const std::string& name, const std::string& db, uint32_t pid,
                                           std::string& endpoint, uint64_t offset_delta, uint32_t concurrency,
                                           std::shared_ptr<::openmldb::api::TaskInfo> task_info) {
@@ -5840,20 +6718,34 @@ void NameServerImpl::RecoverEndpointTable(const std::string& name, const std::st
         task_info->set_status(::openmldb::api::TaskStatus::kFailed);
         return;
     }
+    // the binlog is replayed from offset unless the follower is too far behind the leader, in which case a snapshot
+    // of the leader is sent and only the binlog after it is replayed
+    ::openmldb::api::TableStatus leader_status;
+    bool far_behind = false;
+    bool make_snapshot = false;
+    if (leader_tablet_ptr->client_->GetTableStatus(tid, pid, leader_status)) {
+        uint64_t entry_bytes =
+            leader_status.record_cnt() > 0 ? leader_status.record_byte_size() / leader_status.record_cnt() : 0;
+        far_behind = IsFarBehind(offset, leader_status.offset(), entry_bytes);
+        // the snapshot of the leader is stale too, so a new one is made before sending
+        make_snapshot = far_behind && IsFarBehind(manifest.offset(), leader_status.offset(), entry_bytes);
+    }
     std::lock_guard<std::mutex> lock(mu_);
-    PDLOG(INFO, "offset[%lu] manifest offset[%lu]. name[%s] tid[%u] pid[%u]", offset, manifest.offset(), name.c_str(),
-          tid, pid);
+    PDLOG(INFO, "offset[%lu] manifest offset[%lu] leader offset[%lu]. name[%s] tid[%u] pid[%u]", offset,
+          manifest.offset(), leader_status.offset(), name.c_str(), tid, pid);
     if (has_table) {
-        if (ret_code == 0 && offset >= manifest.offset()) {
+        if (ret_code == 0 && offset >= manifest.offset() && !far_behind) {
             CreateReAddReplicaSimplifyOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency);
         } else {
-            CreateReAddReplicaWithDropOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency);
+            CreateReAddReplicaWithDropOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency,
+                                         make_snapshot);
         }
     } else {
-        if (ret_code == 0 && offset >= manifest.offset()) {
+        if (ret_code == 0 && offset >= manifest.offset() && !far_behind) {
             CreateReAddReplicaNoSendOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency);
         } else {
-            CreateReAddReplicaOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency);
+            CreateReAddReplicaOP(name, db, pid, endpoint, offset_delta, task_info->op_id(), concurrency,
+                                 make_snapshot);
         }
     }
     task_info->set_status(::openmldb::api::TaskStatus::kDone);
@@ -5864,7 +6756,7 @@ void NameServerImpl::RecoverEndpointTable(const std::string& name, const std::st
 
 int NameServerImpl::CreateReAddReplicaOP(const std::string& name, const std::string& db, uint32_t pid,
                                          const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
-                                         uint32_t concurrency) {
+                                         uint32_t concurrency, bool make_snapshot) {
     auto it = tablets_.find(endpoint);
     if (it == tablets_.end() || it->second->state_ != ::openmldb::type::EndpointState::kHealthy) {
         PDLOG(WARNING, "tablet[%s] is not online", endpoint.c_str());
@@ -5874,6 +6766,7 @@ int NameServerImpl::CreateReAddReplicaOP(const std::string& name, const std::str
     RecoverTableData recover_table_data;
     recover_table_data.set_endpoint(endpoint);
     recover_table_data.set_offset_delta(offset_delta);
+    recover_table_data.set_make_snapshot(make_snapshot);
     std::string value;
     recover_table_data.SerializeToString(&value);
     if (CreateOPData(::openmldb::api::OPType::kReAddReplicaOP, value, op_data, name, db, pid, parent_id) < 0) {
@@ -5920,8 +6813,16 @@ int NameServerImpl::CreateReAddReplicaTask(std::shared_ptr<OPData> op_data) {
         return -1;
     }
     uint64_t op_index = op_data->op_info_.op_id();
-    std::shared_ptr<Task> task =
-        CreatePauseSnapshotTask(leader_endpoint, op_index, ::openmldb::api::OPType::kReAddReplicaOP, tid, pid);
+    std::shared_ptr<Task> task;
+    if (recover_table_data.make_snapshot()) {
+        task = CreateMakeSnapshotTask(leader_endpoint, op_index, ::openmldb::api::OPType::kReAddReplicaOP, tid, pid, 0);
+        if (!task) {
+            PDLOG(WARNING, "create makesnapshot task failed. tid[%u] pid[%u]", tid, pid);
+            return -1;
+        }
+        op_data->task_list_.push_back(task);
+    }
+    task = CreatePauseSnapshotTask(leader_endpoint, op_index, ::openmldb::api::OPType::kReAddReplicaOP, tid, pid);
     if (!task) {
         PDLOG(WARNING, "create pausesnapshot task failed. tid[%u] pid[%u]", tid, pid);
         return -1;
@@ -5977,11 +6878,12 @@ int NameServerImpl::CreateReAddReplicaTask(std::shared_ptr<OPData> op_data) {
 
 int NameServerImpl::CreateReAddReplicaWithDropOP(const std::string& name, const std::string& db, uint32_t pid,
                                                  const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
-                                                 uint32_t concurrency) {
+                                                 uint32_t concurrency, bool make_snapshot) {
     std::shared_ptr<OPData> op_data;
     RecoverTableData recover_table_data;
     recover_table_data.set_endpoint(endpoint);
     recover_table_data.set_offset_delta(offset_delta);
+    recover_table_data.set_make_snapshot(make_snapshot);
     std::string value;
     recover_table_data.SerializeToString(&value);
     if (CreateOPData(::openmldb::api::OPType::kReAddReplicaWithDropOP, value, op_data, name, db, pid, parent_id) < 0) {
@@ -6038,8 +6940,18 @@ int NameServerImpl::CreateReAddReplicaWithDropTask(std::shared_ptr<OPData> op_da
         return -1;
     }
     uint64_t op_index = op_data->op_info_.op_id();
-    std::shared_ptr<Task> task =
-        CreatePauseSnapshotTask(leader_endpoint, op_index, ::openmldb::api::OPType::kReAddReplicaWithDropOP, tid, pid);
+    std::shared_ptr<Task> task;
+    if (recover_table_data.make_snapshot()) {
+        task = CreateMakeSnapshotTask(leader_endpoint, op_index, ::openmldb::api::OPType::kReAddReplicaWithDropOP, tid,
+                                      pid, 0);
+        if (!task) {
+            PDLOG(WARNING, "create makesnapshot task failed. tid[%u] pid[%u]", tid, pid);
+            return -1;
+        }
+        op_data->task_list_.push_back(task);
+    }
+    task = CreatePauseSnapshotTask(leader_endpoint, op_index, ::openmldb::api::OPType::kReAddReplicaWithDropOP, tid,
+                                   pid);
     if (!task) {
         PDLOG(WARNING, "create pausesnapshot task failed. tid[%u] pid[%u]", tid, pid);
         return -1;
@@ -7020,6 +7932,8 @@ void NameServerImpl::AddTableInfo(const std::string& name, const std::string& db
         task_info->set_status(::openmldb::api::TaskStatus::kFailed);
         return;
     }
+    // the change is logged for the warm standby name servers
+    NotifyTableChanged(std::vector<std::string>{std::to_string(cur_table_info->tid())});
     table_info->CopyFrom(*cur_table_info);
     task_info->set_status(::openmldb::api::TaskStatus::kDone);
     PDLOG(INFO, "update task status from[kDoing] to[kDone]. op_id[%lu], task_type[%s]", task_info->op_id(),
@@ -7069,6 +7983,7 @@ void NameServerImpl::AddTableInfo(const std::string& alias, const std::string& e
         task_info->set_status(::openmldb::api::TaskStatus::kFailed);
         return;
     }
+    NotifyTableChanged(std::vector<std::string>{std::to_string(table_info->tid())});
     task_info->set_status(::openmldb::api::TaskStatus::kDone);
     PDLOG(INFO, "update task status from[kDoing] to[kDone]. op_id[%lu], task_type[%s]", task_info->op_id(),
           ::openmldb::api::TaskType_Name(task_info->task_type()).c_str());
@@ -7497,8 +8412,8 @@ void NameServerImpl::UpdateTableAliveStatus(RpcController* controller, const Upd
     }
 }
 
-int NameServerImpl::UpdateEndpointTableAliveHandle(const std::string& endpoint, TableInfos& table_infos,
-                                                   bool is_alive) {  // NOLINT
+void NameServerImpl::UpdateEndpointTableAliveHandle(const std::string& endpoint, TableInfos& table_infos,  // NOLINT
+                                                    bool is_alive, std::vector<::openmldb::zk::ZkOp>* ops) {
     for (const auto& kv : table_infos) {
         ::google::protobuf::RepeatedPtrField<TablePartition>* table_parts = kv.second->mutable_table_partition();
         bool has_update = false;
@@ -7527,16 +8442,11 @@ int NameServerImpl::UpdateEndpointTableAliveHandle(const std::string& endpoint,
             }
         }
         if (has_update) {
-            if (!UpdateZkTableNodeWithoutNotify(kv.second.get())) {
-                LOG(WARNING) << "update fail. table[" << kv.first << "] endpoint[" << endpoint << "] is_alive["
-                             << is_alive << "]";
-                return -1;
-            }
-            LOG(INFO) << "update success. table[" << kv.first << "] endpoint[" << endpoint << "] is_alive[" << is_alive
-                      << "]";
+            std::string table_value;
+            kv.second->SerializeToString(&table_value);
+            ops->push_back({::openmldb::zk::ZkOpType::kSet, GetZkTableNode(*kv.second), std::move(table_value)});
         }
     }
-    return 0;
 }
 
 int NameServerImpl::UpdateEndpointTableAlive(const std::string& endpoint, bool is_alive) {
@@ -7545,17 +8455,30 @@ int NameServerImpl::UpdateEndpointTableAlive(const std::string& endpoint, bool i
         return 0;
     }
     std::lock_guard<std::mutex> lock(mu_);
-    int ret = UpdateEndpointTableAliveHandle(endpoint, table_info_, is_alive);
-    if (ret != 0) {
-        return ret;
-    }
+    // write all the updated table nodes in batches and notify the change once
+    std::vector<::openmldb::zk::ZkOp> ops;
+    UpdateEndpointTableAliveHandle(endpoint, table_info_, is_alive, &ops);
     for (auto& kv : db_table_info_) {
-        ret = UpdateEndpointTableAliveHandle(endpoint, kv.second, is_alive);
-        if (ret != 0) {
-            return ret;
+        UpdateEndpointTableAliveHandle(endpoint, kv.second, is_alive, &ops);
+    }
+    if (ops.empty() || !IsClusterMode()) {
+        return 0;
+    }
+    if (!zk_client_->Multi(ops)) {
+        LOG(WARNING) << "update fail. endpoint[" << endpoint << "] is_alive[" << is_alive << "] table num["
+                     << ops.size() << "]";
+        return -1;
+    }
+    LOG(INFO) << "update success. endpoint[" << endpoint << "] is_alive[" << is_alive << "] table num["
+              << ops.size() << "]";
+    std::vector<std::string> table_nodes;
+    std::string db_table_prefix = zk_path_.db_table_data_path_ + "/";
+    for (const auto& op : ops) {
+        if (op.node.compare(0, db_table_prefix.size(), db_table_prefix) == 0) {
+            table_nodes.push_back(op.node.substr(db_table_prefix.size()));
         }
     }
-    NotifyTableChanged(::openmldb::type::NotifyType::kTable);
+    NotifyTableChanged(table_nodes);
     return 0;
 }
 
@@ -7838,6 +8761,7 @@ void NameServerImpl::UpdateTTL(RpcController* controller, const ::openmldb::name
         response->set_msg("set zk failed");
         return;
     }
+    NotifyTableChanged(std::vector<std::string>{std::to_string(table_info.tid())});
     {
         std::lock_guard<std::mutex> lock(mu_);
         table->CopyFrom(table_info);
@@ -7943,6 +8867,19 @@ void NameServerImpl::NotifyTableChanged(::openmldb::type::NotifyType type) {
     }
 }
 
+void NameServerImpl::NotifyTableChanged(const std::vector<std::string>& table_nodes) {
+    if (!IsClusterMode()) {
+        return;
+    }
+    ::openmldb::zk::TableChangeLog change_log(zk_client_, zk_path_.table_change_log_path_);
+    if (!change_log.Increment(zk_path_.table_changed_notify_node_, table_nodes)) {
+        PDLOG(WARNING, "fail to write table change log, notify without it");
+        NotifyTableChanged(::openmldb::type::NotifyType::kTable);
+        return;
+    }
+    PDLOG(INFO, "notify table changed ok. table num %lu", table_nodes.size());
+}
+
 bool NameServerImpl::GetTableInfo(const std::string& table_name, const std::string& db_name,
                                   std::shared_ptr<TableInfo>* table_info) {
     std::lock_guard<std::mutex> lock(mu_);
@@ -8918,7 +9855,11 @@ void NameServerImpl::DeleteIndex(RpcController* controller, const DeleteIndexReq
 
 bool NameServerImpl::UpdateZkTableNode(const std::shared_ptr<::openmldb::nameserver::TableInfo>& table_info) {
     if (IsClusterMode() && UpdateZkTableNodeWithoutNotify(table_info.get())) {
-        NotifyTableChanged(::openmldb::type::NotifyType::kTable);
+        std::vector<std::string> table_nodes;
+        if (!table_info->db().empty()) {
+            table_nodes.push_back(std::to_string(table_info->tid()));
+        }
+        NotifyTableChanged(table_nodes);
         if (table_info->db() == INFORMATION_SCHEMA_DB && table_info->name() == GLOBAL_VARIABLES) {
             NotifyTableChanged(::openmldb::type::NotifyType::kGlobalVar);
         }
@@ -8933,12 +9874,7 @@ bool NameServerImpl::UpdateZkTableNodeWithoutNotify(const TableInfo* table_info)
     }
     std::string table_value;
     table_info->SerializeToString(&table_value);
-    std::string temp_path;
-    if (table_info->db().empty()) {
-        temp_path = zk_path_.table_data_path_ + "/" + table_info->name();
-    } else {
-        temp_path = zk_path_.db_table_data_path_ + "/" + std::to_string(table_info->tid());
-    }
+    std::string temp_path = GetZkTableNode(*table_info);
     if (!zk_client_->SetNodeValue(temp_path, table_value)) {
         LOG(WARNING) << "update table node[" << temp_path << "] failed!";
         return false;
@@ -8947,6 +9883,13 @@ bool NameServerImpl::UpdateZkTableNodeWithoutNotify(const TableInfo* table_info)
     return true;
 }
 
+std::string NameServerImpl::GetZkTableNode(const TableInfo& table_info) {
+    if (table_info.db().empty()) {
+        return zk_path_.table_data_path_ + "/" + table_info.name();
+    }
+    return zk_path_.db_table_data_path_ + "/" + std::to_string(table_info.tid());
+}
+
 base::Status NameServerImpl::AddMultiIndexs(const std::string& db, const std::string& name,
         std::shared_ptr<TableInfo> table_info,
         const ::google::protobuf::RepeatedPtrField<openmldb::common::ColumnKey>& column_keys) {
@@ -9141,6 +10084,7 @@ void NameServerImpl::AddIndex(RpcController* controller, const AddIndexRequest*
             LOG(WARNING) << "set zk failed! table " << name << " db " << db;
             return;
         }
+        NotifyTableChanged(std::vector<std::string>{std::to_string(table_info_zk->tid())});
         std::lock_guard<std::mutex> lock(mu_);
         for (const auto& col : add_cols) {
             openmldb::common::ColumnDesc* new_col = table_info->add_added_column_desc();
@@ -9214,6 +10158,11 @@ int NameServerImpl::CreateAddIndexOP(const std::string& name, const std::string&
         PDLOG(WARNING, "table[%s] is not exist!", name.c_str());
         return -1;
     }
+    if (new_cols.empty() && table_info->partition_split_size() > 0) {
+        // the index data is dumped to the partitions by hash % partition_num, which is not the route of the splits
+        PDLOG(WARNING, "cannot add index with data to the split table[%s]", name.c_str());
+        return -1;
+    }
     // zk_op_sync_node only need to create once, so implement that through pid == 0
     if (pid == 0) {
         std::string partition_num_value = std::to_string(table_info->table_partition_size());
@@ -9997,7 +10946,8 @@ void NameServerImpl::CreateProcedure(RpcController* controller, const api::Creat
             }
             db_sp_info_map_[sp_db_name][sp_name] = sp_info;
         }
-        NotifyTableChanged(::openmldb::type::NotifyType::kTable);
+        // the procedures are always read in full
+        NotifyTableChanged(std::vector<std::string>());
         PDLOG(INFO, "create db store procedure success! db_name [%s] sp_name [%s] sql [%s]", sp_db_name.c_str(),
               sp_name.c_str(), sp_info->sql().c_str());
         response->set_code(::openmldb::base::ReturnCode::kOk);
@@ -10181,7 +11131,8 @@ void NameServerImpl::DropProcedure(RpcController* controller, const api::DropPro
         if (db_sp_info_map_[db_name].empty()) {
             db_sp_info_map_.erase(db_name);
         }
-        NotifyTableChanged(::openmldb::type::NotifyType::kTable);
+        // the procedures are always read in full
+        NotifyTableChanged(std::vector<std::string>());
     }
     response->set_code(::openmldb::base::ReturnCode::kOk);
     response->set_msg("ok");
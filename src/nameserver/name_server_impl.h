@@ -35,11 +35,13 @@
 #include "client/tablet_client.h"
 #include "codec/schema_codec.h"
 #include "nameserver/cluster_info.h"
+#include "nameserver/load_balancer.h"
 #include "nameserver/system_table.h"
 #include "proto/name_server.pb.h"
 #include "proto/tablet.pb.h"
 #include "sdk/sql_cluster_router.h"
 #include "zk/dist_lock.h"
+#include "zk/table_change_log.h"
 #include "zk/zk_client.h"
 
 DECLARE_uint32(name_server_task_concurrency);
@@ -74,6 +76,10 @@ struct TabletInfo {
     // tablet rpc handle
     std::shared_ptr<TabletClient> client_;
     uint64_t ctime_;
+    // the send time in ms of the last heartbeat the tablet answered, see CheckTabletLease
+    uint64_t lease_time_ = 0;
+    // the tablet is failed over before tablet_heartbeat_timeout as its lease expired
+    bool lease_expired_ = false;
 
     bool Health() const { return state_ == ::openmldb::type::EndpointState::kHealthy; }
 };
@@ -111,6 +117,7 @@ struct ZkPath {
     std::string db_sp_data_path_;
     std::string auto_failover_node_;
     std::string table_changed_notify_node_;
+    std::string table_change_log_path_;
     std::string offline_endpoint_lock_node_;
     std::string zone_data_path_;
     std::string op_index_node_;
@@ -149,6 +156,10 @@ class NameServerImpl : public NameServer {
     void GetTaskStatus(RpcController* controller, const ::openmldb::api::TaskStatusRequest* request,
                        ::openmldb::api::TaskStatusResponse* response, Closure* done);
 
+    // a tablet finished a task, sync the task status at once instead of waiting for the next poll
+    void NotifyTaskStatus(RpcController* controller, const NotifyTaskStatusRequest* request,
+                          GeneralResponse* response, Closure* done);
+
     void LoadTable(RpcController* controller, const LoadTableRequest* request, GeneralResponse* response,
                    Closure* done);
 
@@ -225,6 +236,10 @@ class NameServerImpl : public NameServer {
     void ShowOPStatus(RpcController* controller, const ShowOPStatusRequest* request, ShowOPStatusResponse* response,
                       Closure* done);
 
+    // the tablets, tables and ops in the text format of prometheus, only the leader flag if not the leader
+    void Metrics(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                 ::openmldb::api::HttpResponse* response, Closure* done);
+
     void ShowCatalog(RpcController* controller, const ShowCatalogRequest* request, ShowCatalogResponse* response,
                      Closure* done);
 
@@ -247,6 +262,9 @@ class NameServerImpl : public NameServer {
 
     void Migrate(RpcController* controller, const MigrateRequest* request, GeneralResponse* response, Closure* done);
 
+    void SplitPartition(RpcController* controller, const SplitPartitionRequest* request, GeneralResponse* response,
+                        Closure* done);
+
     void RecoverEndpoint(RpcController* controller, const RecoverEndpointRequest* request, GeneralResponse* response,
                          Closure* done);
 
@@ -337,6 +355,12 @@ class NameServerImpl : public NameServer {
 
     int UpdateTaskStatus(bool is_recover_op);
 
+    // get the task status from all tablets and replica clusters once
+    void SyncTaskStatus(bool is_recover_op);
+
+    // the endpoints that the tasks of op run on
+    std::set<std::string> GetOPEndpoints(const std::shared_ptr<OPData>& op_data);
+
     int DeleteTaskRemote(const std::vector<uint64_t>& done_task_vec,
                          bool& has_failed);  // NOLINT
 
@@ -386,6 +410,13 @@ class NameServerImpl : public NameServer {
 
     bool RecoverTableInfo();
 
+    // read the databases and the tables changed since the last sync by the table change log, or all of them if the
+    // log does not cover it, and apply them unless this is the leader
+    bool SyncTableInfo();
+
+    // keep the table info of the standby up to date, scheduled if enable_ns_warm_standby
+    void SyncStandby();
+
     void RecoverClusterInfo();
 
     bool RecoverOPTask();
@@ -410,6 +441,8 @@ class NameServerImpl : public NameServer {
 
     int CreateMigrateTask(std::shared_ptr<OPData> op_data);
 
+    int CreateSplitPartitionOPTask(std::shared_ptr<OPData> op_data);
+
     int CreateRecoverTableOPTask(std::shared_ptr<OPData> op_data);
 
     int CreateDelReplicaRemoteOPTask(std::shared_ptr<OPData> op_data);
@@ -446,10 +479,22 @@ class NameServerImpl : public NameServer {
 
     void OnTabletOffline(const std::string& endpoint, bool startup_flag);
 
+    // send the heartbeats to tablets and renew the leases of the ones answered
+    void CheckTabletLease();
+
+    // the tablet answered no heartbeat in twice tablet_lease_timeout, mu_ should be held
+    bool IsLeaseExpiredLocked(const TabletInfo& tablet, uint64_t cur_time) const;
+
+    // drop the lease a tablet got before if the heartbeats are off
+    void ResetTabletLease(const std::shared_ptr<TabletInfo>& tablet);
+
     void RecoverOfflineTablet();
 
     void OnTabletOnline(const std::string& endpoint);
 
+    // add the replicas of the broadcast tables to the new tablet of endpoint
+    void AddBroadcastReplica(const std::string& endpoint);
+
     void OfflineEndpointInternal(const std::string& endpoint, uint32_t concurrency);
 
     void RecoverEndpointInternal(const std::string& endpoint, bool need_restore, uint32_t concurrency);
@@ -466,7 +511,9 @@ class NameServerImpl : public NameServer {
                                uint32_t pid, bool is_leader, bool is_alive,
                                std::shared_ptr<::openmldb::api::TaskInfo> task_info);
 
-    int UpdateEndpointTableAliveHandle(const std::string& endpoint, TableInfos& table_infos, bool is_alive);  // NOLINT
+    // update the alive status in table_infos and append the writes of the updated table nodes to ops
+    void UpdateEndpointTableAliveHandle(const std::string& endpoint, TableInfos& table_infos,  // NOLINT
+                                        bool is_alive, std::vector<::openmldb::zk::ZkOp>* ops);
 
     int UpdateEndpointTableAlive(const std::string& endpoint, bool is_alive);
 
@@ -521,6 +568,14 @@ class NameServerImpl : public NameServer {
     void AddTableInfo(const std::string& name, const std::string& db, const std::string& endpoint, uint32_t pid,
                       std::shared_ptr<::openmldb::api::TaskInfo> task_info);
 
+    // add child_pid split out of pid to the table info, led by the leader of pid
+    void AddSplitPartition(const std::string& name, const std::string& db, uint32_t pid, uint32_t child_pid,
+                           std::shared_ptr<::openmldb::api::TaskInfo> task_info);
+
+    // add the replicas of child_pid on the followers of pid
+    void AddSplitReplica(const std::string& name, const std::string& db, uint32_t pid, uint32_t child_pid,
+                         std::shared_ptr<::openmldb::api::TaskInfo> task_info);
+
     std::shared_ptr<Task> CreateDelReplicaTask(const std::string& endpoint, uint64_t op_index,
                                                ::openmldb::api::OPType op_type, uint32_t tid, uint32_t pid,
                                                const std::string& follower_endpoint);
@@ -638,18 +693,21 @@ class NameServerImpl : public NameServer {
                               std::string& endpoint,  // NOLINT
                               uint64_t offset_delta, uint32_t concurrency,
                               std::shared_ptr<::openmldb::api::TaskInfo> task_info);
+    // whether replaying the binlog from offset to leader_offset costs more than sending a snapshot
+    static bool IsFarBehind(uint64_t offset, uint64_t leader_offset, uint64_t entry_bytes);
     int GetLeader(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info, uint32_t pid,
                   std::string& leader_endpoint);  // NOLINT
     int MatchTermOffset(const std::string& name, const std::string& db, uint32_t pid, bool has_table, uint64_t term,
                         uint64_t offset);
     int CreateReAddReplicaOP(const std::string& name, const std::string& db, uint32_t pid, const std::string& endpoint,
-                             uint64_t offset_delta, uint64_t parent_id, uint32_t concurrency);
+                             uint64_t offset_delta, uint64_t parent_id, uint32_t concurrency,
+                             bool make_snapshot = false);
     int CreateReAddReplicaSimplifyOP(const std::string& name, const std::string& db, uint32_t pid,
                                      const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
                                      uint32_t concurrency);
     int CreateReAddReplicaWithDropOP(const std::string& name, const std::string& db, uint32_t pid,
                                      const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
-                                     uint32_t concurrency);
+                                     uint32_t concurrency, bool make_snapshot = false);
     int CreateReAddReplicaNoSendOP(const std::string& name, const std::string& db, uint32_t pid,
                                    const std::string& endpoint, uint64_t offset_delta, uint64_t parent_id,
                                    uint32_t concurrency);
@@ -679,8 +737,15 @@ class NameServerImpl : public NameServer {
                           uint32_t concurrency = FLAGS_name_server_task_concurrency_for_replica_cluster);
     // kTable for normal table and kGlobalVar for global var table
     void NotifyTableChanged(::openmldb::type::NotifyType type);
+    // notify the change of the table nodes in db_table_data and record them in the
+    // table change log, so the tablets and sdks only read the changed tables
+    void NotifyTableChanged(const std::vector<std::string>& table_nodes);
     void DeleteDoneOP();
     void UpdateTableStatus();
+
+    // even out the leaders and migrate the hot followers to the idle tablets by the load
+    // collected in UpdateTableStatus
+    void BalanceLoad();
     int DropTableOnTablet(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info);
 
     void CheckBinlogSyncProgress(const std::string& name, const std::string& db, uint32_t pid,
@@ -751,6 +816,8 @@ class NameServerImpl : public NameServer {
 
     bool UpdateZkTableNodeWithoutNotify(const TableInfo* table_info);
 
+    std::string GetZkTableNode(const TableInfo& table_info);
+
     void ShowDbTable(const std::map<std::string, std::shared_ptr<TableInfo>>& table_infos,
                      const ShowTableRequest* request, ShowTableResponse* response);
 
@@ -806,16 +873,28 @@ class NameServerImpl : public NameServer {
     std::atomic<bool> running_;  // whether the current ns is the master
     std::list<std::shared_ptr<OPData>> done_op_list_;
     std::vector<std::list<std::shared_ptr<OPData>>> task_vec_;
+    LoadBalancer load_balancer_;
+    // whether a sync of task status is triggered by the notify of tablets and not run yet
+    std::atomic<bool> task_status_notified_;
     std::condition_variable cv_;
     std::atomic<bool> auto_failover_;
     std::atomic<uint32_t> mode_;
     std::map<std::string, uint64_t> offline_endpoint_map_;
+    // the heartbeats in flight and their send time by endpoint, only accessed by CheckTabletLease
+    std::map<std::string, std::pair<uint64_t, openmldb::RpcCallback<::openmldb::api::GeneralResponse>*>>
+        heartbeats_;
     ::openmldb::base::Random rand_;
     uint64_t session_term_;
     std::atomic<uint64_t> task_rpc_version_;
     std::map<uint64_t, std::list<std::shared_ptr<::openmldb::api::TaskInfo>>> task_map_;
     std::set<std::string> databases_;
+    // serializes the syncs of the table info
+    std::mutex sync_mu_;
+    // the version of the table changed notify node that the table info is synced to, 0 if it is not synced
+    uint64_t synced_table_version_ = 0;
     std::string endpoint_;
+    // the address that the rpc server listens on, the tablets notify it
+    std::string real_endpoint_;
     std::map<std::string, std::string> real_ep_map_;
     std::map<std::string, std::string> remote_real_ep_map_;
     std::map<std::string, std::string> sdk_endpoint_map_;
@@ -19,6 +19,9 @@
 #include <sched.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <set>
+
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
 #include "client/ns_client.h"
@@ -45,6 +48,11 @@ DECLARE_int32(make_snapshot_threshold_offset);
 DECLARE_uint32(name_server_task_max_concurrency);
 DECLARE_uint32(system_table_replica_num);
 DECLARE_bool(auto_failover);
+DECLARE_uint32(tablet_lease_timeout);
+DECLARE_bool(enable_ns_warm_standby);
+DECLARE_uint32(ns_standby_sync_interval);
+DECLARE_uint64(catch_up_snapshot_lag_cnt);
+DECLARE_uint64(catch_up_snapshot_lag_mb);
 
 using brpc::Server;
 using openmldb::tablet::TabletImpl;
@@ -76,6 +84,26 @@ class NameServerImplTest : public ::testing::TestWithParam<::openmldb::common::S
         NameServerImpl* nameserver) {
         return nameserver->table_info_;
     }
+    std::map<std::string, ::openmldb::nameserver::TableInfos>& GetDbTableInfo(NameServerImpl* nameserver) {
+        return nameserver->db_table_info_;
+    }
+    Tablets& GetTablets(NameServerImpl* nameserver) { return nameserver->tablets_; }
+    void SetRunning(NameServerImpl* nameserver, bool running) { nameserver->running_ = running; }
+    int AddOPData(NameServerImpl* nameserver, const std::shared_ptr<OPData>& op_data, uint32_t concurrency) {
+        return nameserver->AddOPData(op_data, concurrency);
+    }
+    std::set<std::string> GetOPEndpoints(NameServerImpl* nameserver, const std::shared_ptr<OPData>& op_data) {
+        return nameserver->GetOPEndpoints(op_data);
+    }
+    bool IsFarBehind(uint64_t offset, uint64_t leader_offset, uint64_t entry_bytes) {
+        return NameServerImpl::IsFarBehind(offset, leader_offset, entry_bytes);
+    }
+    int CreateReAddReplicaTask(NameServerImpl* nameserver, std::shared_ptr<OPData> op_data) {
+        if (op_data->op_info_.op_type() == ::openmldb::api::OPType::kReAddReplicaWithDropOP) {
+            return nameserver->CreateReAddReplicaWithDropTask(op_data);
+        }
+        return nameserver->CreateReAddReplicaTask(op_data);
+    }
 };
 
 bool StartNS(const std::string& endpoint, brpc::Server* server, brpc::ServerOptions* options) {
@@ -770,6 +798,164 @@ TEST_F(NameServerImplTest, CancelOP) {
     delete nameserver;
 }
 
+TEST_F(NameServerImplTest, ReAddFarBehindReplica) {
+    uint64_t old_lag_cnt = FLAGS_catch_up_snapshot_lag_cnt;
+    uint64_t old_lag_mb = FLAGS_catch_up_snapshot_lag_mb;
+    FLAGS_catch_up_snapshot_lag_cnt = 100;
+    FLAGS_catch_up_snapshot_lag_mb = 1;
+    // the follower is ahead of the leader
+    ASSERT_FALSE(IsFarBehind(200, 100, 10));
+    // by the count of entries
+    ASSERT_FALSE(IsFarBehind(100, 200, 10));
+    ASSERT_TRUE(IsFarBehind(100, 201, 10));
+    // by the size of the binlog
+    ASSERT_FALSE(IsFarBehind(100, 150, 1024));
+    ASSERT_TRUE(IsFarBehind(100, 150, 32 * 1024));
+    // both thresholds are disabled
+    FLAGS_catch_up_snapshot_lag_cnt = 0;
+    FLAGS_catch_up_snapshot_lag_mb = 0;
+    ASSERT_FALSE(IsFarBehind(0, 100000000, 32 * 1024));
+    FLAGS_catch_up_snapshot_lag_cnt = old_lag_cnt;
+    FLAGS_catch_up_snapshot_lag_mb = old_lag_mb;
+
+    NameServerImpl nameserver;
+    std::string leader = "127.0.0.1:9530";
+    std::string follower = "127.0.0.1:9531";
+    for (const auto& endpoint : {leader, follower}) {
+        auto tablet = std::make_shared<TabletInfo>();
+        tablet->state_ = ::openmldb::type::EndpointState::kHealthy;
+        tablet->client_ = std::make_shared<::openmldb::client::TabletClient>(endpoint, endpoint);
+        GetTablets(&nameserver).emplace(endpoint, tablet);
+    }
+    auto table_info = std::make_shared<TableInfo>();
+    table_info->set_name("t1");
+    table_info->set_tid(1);
+    table_info->set_seg_cnt(8);
+    auto partition = table_info->add_table_partition();
+    partition->set_pid(0);
+    auto meta = partition->add_partition_meta();
+    meta->set_endpoint(leader);
+    meta->set_is_leader(true);
+    meta = partition->add_partition_meta();
+    meta->set_endpoint(follower);
+    meta->set_is_leader(false);
+    GetTableInfo(&nameserver).emplace("t1", table_info);
+
+    uint64_t op_id = 1;
+    for (auto op_type : {::openmldb::api::OPType::kReAddReplicaOP, ::openmldb::api::OPType::kReAddReplicaWithDropOP}) {
+        for (bool make_snapshot : {false, true}) {
+            RecoverTableData recover_table_data;
+            recover_table_data.set_endpoint(follower);
+            recover_table_data.set_offset_delta(0);
+            recover_table_data.set_make_snapshot(make_snapshot);
+            auto op_data = std::make_shared<OPData>();
+            op_data->op_info_.set_op_id(op_id++);
+            op_data->op_info_.set_op_type(op_type);
+            op_data->op_info_.set_name("t1");
+            op_data->op_info_.set_pid(0);
+            op_data->op_info_.set_data(recover_table_data.SerializeAsString());
+            ASSERT_EQ(0, CreateReAddReplicaTask(&nameserver, op_data));
+
+            // the new snapshot is made on the leader before it is paused and sent
+            auto task_iter = op_data->task_list_.begin();
+            ASSERT_TRUE(task_iter != op_data->task_list_.end());
+            if (make_snapshot) {
+                ASSERT_EQ(::openmldb::api::TaskType::kMakeSnapshot, (*task_iter)->task_info_->task_type());
+                ASSERT_EQ(leader, (*task_iter)->task_info_->endpoint());
+                task_iter++;
+            }
+            ASSERT_EQ(::openmldb::api::TaskType::kPauseSnapshot, (*task_iter)->task_info_->task_type());
+            ASSERT_EQ(leader, (*task_iter)->task_info_->endpoint());
+            uint32_t make_snapshot_cnt = 0;
+            for (const auto& task : op_data->task_list_) {
+                if (task->task_info_->task_type() == ::openmldb::api::TaskType::kMakeSnapshot) {
+                    make_snapshot_cnt++;
+                }
+            }
+            ASSERT_EQ(make_snapshot ? 1u : 0u, make_snapshot_cnt);
+        }
+    }
+}
+
+TEST_F(NameServerImplTest, TaskNotifyAndOPSpread) {
+    FLAGS_zk_cluster = "127.0.0.1:6181";
+    FLAGS_zk_root_path = "/rtidb3" + ::openmldb::test::GenRand();
+    FLAGS_endpoint = "127.0.0.1:9638";
+    NameServerImpl* nameserver = new NameServerImpl();
+    ASSERT_TRUE(nameserver->Init(""));
+    sleep(4);
+    MockClosure closure;
+
+    // the notify of a tablet is only taken by the leader
+    NotifyTaskStatusRequest notify_request;
+    notify_request.set_endpoint("127.0.0.1:9530");
+    GeneralResponse response;
+    Start(nameserver);
+    nameserver->NotifyTaskStatus(NULL, &notify_request, &response, &closure);
+    ASSERT_EQ(0, response.code());
+    SetRunning(nameserver, false);
+    response.Clear();
+    nameserver->NotifyTaskStatus(NULL, &notify_request, &response, &closure);
+    ASSERT_EQ(::openmldb::base::ReturnCode::kNameserverIsNotLeader, response.code());
+    // the task thread has stopped with running_, so the ops below stay in their lists
+    sleep(2);
+
+    std::vector<std::list<std::shared_ptr<OPData>>>& task_vec = GetTaskVec(nameserver);
+    if (task_vec.size() < FLAGS_name_server_task_max_concurrency) {
+        task_vec.resize(FLAGS_name_server_task_max_concurrency);
+    }
+    uint32_t concurrency = FLAGS_name_server_task_max_concurrency;
+    uint64_t op_id = 100;
+    auto make_op = [&op_id](const std::string& name, uint32_t pid) {
+        auto op_data = std::make_shared<OPData>();
+        op_data->op_info_.set_op_id(op_id++);
+        op_data->op_info_.set_op_type(::openmldb::api::OPType::kDelReplicaOP);
+        op_data->op_info_.set_task_index(0);
+        op_data->op_info_.set_data("");
+        op_data->op_info_.set_task_status(::openmldb::api::kInited);
+        op_data->op_info_.set_db("db_test");
+        op_data->op_info_.set_name(name);
+        op_data->op_info_.set_pid(pid);
+        op_data->op_info_.set_parent_id(INVALID_PARENT_ID);
+        return op_data;
+    };
+    // the ops of the same partition of different tables are spread across the lists
+    std::set<uint32_t> vec_idxs;
+    for (int i = 0; i < 8; i++) {
+        auto op_data = make_op("t" + std::to_string(i), 0);
+        ASSERT_EQ(0, AddOPData(nameserver, op_data, concurrency));
+        vec_idxs.insert(op_data->op_info_.vec_idx());
+    }
+    ASSERT_GT(vec_idxs.size(), 1u);
+    // the ops of one partition stay in one list in order
+    auto first_op = make_op("t0", 3);
+    auto second_op = make_op("t0", 3);
+    ASSERT_EQ(0, AddOPData(nameserver, first_op, concurrency));
+    ASSERT_EQ(0, AddOPData(nameserver, second_op, concurrency));
+    ASSERT_EQ(first_op->op_info_.vec_idx(), second_op->op_info_.vec_idx());
+    const auto& op_list = task_vec[first_op->op_info_.vec_idx()];
+    auto first_iter = std::find(op_list.begin(), op_list.end(), first_op);
+    auto second_iter = std::find(op_list.begin(), op_list.end(), second_op);
+    ASSERT_TRUE(first_iter != op_list.end());
+    ASSERT_TRUE(second_iter != op_list.end());
+    ASSERT_EQ(std::next(first_iter), second_iter);
+
+    // the tablets of the op are the endpoints of its tasks and sub tasks
+    auto op_data = make_op("t0", 1);
+    auto task_info = std::make_shared<::openmldb::api::TaskInfo>();
+    task_info->set_endpoint("127.0.0.1:9530");
+    auto task = std::make_shared<Task>("127.0.0.1:9530", task_info);
+    auto sub_task_info = std::make_shared<::openmldb::api::TaskInfo>();
+    sub_task_info->set_endpoint("127.0.0.1:9531");
+    task->sub_task_.push_back(std::make_shared<Task>("127.0.0.1:9531", sub_task_info));
+    op_data->task_list_.push_back(task);
+    // a task without an endpoint runs on the nameserver only
+    op_data->task_list_.push_back(std::make_shared<Task>("", std::make_shared<::openmldb::api::TaskInfo>()));
+    std::set<std::string> endpoints = GetOPEndpoints(nameserver, op_data);
+    ASSERT_EQ(std::set<std::string>({"127.0.0.1:9530", "127.0.0.1:9531"}), endpoints);
+    delete nameserver;
+}
+
 bool InitRpc(Server* server, google::protobuf::Service* general_svr) {
     brpc::ServerOptions options;
     if (server->AddService(general_svr, brpc::SERVER_DOESNT_OWN_SERVICE) != 0) {
@@ -1616,6 +1802,167 @@ TEST_P(NameServerImplTest, ShowCatalogVersion) {
     ::openmldb::base::RemoveDirRecursive(FLAGS_hdd_root_path + "/2_1");
 }
 
+// the alive and leader flags of the replicas of the partition 0 of the first table
+static bool GetPartitionState(::openmldb::RpcClient<::openmldb::nameserver::NameServer_Stub>& client,  // NOLINT
+                              std::map<std::string, std::pair<bool, bool>>* state) {
+    ::openmldb::nameserver::ShowTableRequest request;
+    ::openmldb::nameserver::ShowTableResponse response;
+    request.set_show_all(true);
+    if (!client.SendRequest(&::openmldb::nameserver::NameServer_Stub::ShowTable, &request, &response,
+                            FLAGS_request_timeout_ms, 1) ||
+        response.code() != 0 || response.table_info_size() == 0) {
+        return false;
+    }
+    state->clear();
+    for (const auto& meta : response.table_info(0).table_partition(0).partition_meta()) {
+        state->emplace(meta.endpoint(), std::make_pair(meta.is_alive(), meta.is_leader()));
+    }
+    return true;
+}
+
+TEST_P(NameServerImplTest, LeaseFailover) {
+    openmldb::common::StorageMode storage_mode = GetParam();
+
+    FLAGS_zk_cluster = "127.0.0.1:6181";
+    FLAGS_zk_root_path = "/rtidb3" + ::openmldb::test::GenRand();
+    FLAGS_auto_failover = true;
+    uint32_t old_lease_timeout = FLAGS_tablet_lease_timeout;
+    FLAGS_tablet_lease_timeout = 1000;
+
+    brpc::ServerOptions options;
+    brpc::Server server;
+    ASSERT_TRUE(StartNS("127.0.0.1:9635", &server, &options));
+    ::openmldb::RpcClient<::openmldb::nameserver::NameServer_Stub> name_server_client("127.0.0.1:9635", "");
+    name_server_client.Init();
+
+    brpc::ServerOptions options1;
+    brpc::Server server1;
+    ASSERT_TRUE(StartTablet("127.0.0.1:9537", &server1, &options1));
+    ::openmldb::client::TabletClient tablet_client1("127.0.0.1:9537", "");
+    ASSERT_EQ(0, tablet_client1.Init());
+
+    brpc::ServerOptions options2;
+    brpc::Server server2;
+    ASSERT_TRUE(StartTablet("127.0.0.1:9538", &server2, &options2));
+    ::openmldb::client::TabletClient tablet_client2("127.0.0.1:9538", "");
+    ASSERT_EQ(0, tablet_client2.Init());
+
+    CreateTableRequest request;
+    GeneralResponse response;
+    TableInfo* table_info = request.mutable_table_info();
+    table_info->set_name("test" + ::openmldb::test::GenRand());
+    table_info->set_storage_mode(storage_mode);
+    ::openmldb::test::AddDefaultSchema(0, 0, ::openmldb::type::kAbsoluteTime, table_info);
+    TablePartition* partion = table_info->add_table_partition();
+    partion->set_pid(0);
+    PartitionMeta* meta = partion->add_partition_meta();
+    meta->set_endpoint("127.0.0.1:9538");
+    meta->set_is_leader(true);
+    meta = partion->add_partition_meta();
+    meta->set_endpoint("127.0.0.1:9537");
+    meta->set_is_leader(false);
+    bool ok = name_server_client.SendRequest(&::openmldb::nameserver::NameServer_Stub::CreateTable, &request, &response,
+                                             FLAGS_request_timeout_ms, 1);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(0, response.code());
+    sleep(2);
+
+    std::map<std::string, std::pair<bool, bool>> state;
+    // the zk node of tablet1 is gone, but it still answers the heartbeats
+    ASSERT_TRUE(tablet_client1.DisConnectZK());
+    sleep(3);
+    ASSERT_TRUE(GetPartitionState(name_server_client, &state));
+    ASSERT_TRUE(state["127.0.0.1:9537"].first);
+    ASSERT_TRUE(state["127.0.0.1:9538"].second);
+    ASSERT_TRUE(tablet_client1.ConnectZK());
+    sleep(2);
+
+    // tablet2 is gone, it is failed over long before tablet_heartbeat_timeout
+    ASSERT_TRUE(tablet_client2.DisConnectZK());
+    server2.Stop(0);
+    server2.Join();
+    sleep(6);
+    ASSERT_TRUE(GetPartitionState(name_server_client, &state));
+    ASSERT_FALSE(state["127.0.0.1:9538"].first);
+    ASSERT_TRUE(state["127.0.0.1:9537"].first);
+    ASSERT_TRUE(state["127.0.0.1:9537"].second);
+
+    FLAGS_tablet_lease_timeout = old_lease_timeout;
+    ::openmldb::base::RemoveDirRecursive(FLAGS_ssd_root_path + "/2_0");
+    ::openmldb::base::RemoveDirRecursive(FLAGS_hdd_root_path + "/2_0");
+}
+
+TEST_P(NameServerImplTest, WarmStandby) {
+    openmldb::common::StorageMode storage_mode = GetParam();
+
+    FLAGS_zk_cluster = "127.0.0.1:6181";
+    FLAGS_zk_root_path = "/rtidb3" + ::openmldb::test::GenRand();
+    FLAGS_enable_ns_warm_standby = true;
+    FLAGS_ns_standby_sync_interval = 200;
+
+    brpc::ServerOptions options;
+    brpc::Server server;
+    ASSERT_TRUE(StartNS("127.0.0.1:9636", &server, &options));
+    ::openmldb::client::NsClient ns_client("127.0.0.1:9636", "");
+    ASSERT_EQ(0, ns_client.Init());
+
+    FLAGS_endpoint = "127.0.0.1:9637";
+    NameServerImpl* standby = new NameServerImpl();
+    ASSERT_TRUE(standby->Init(""));
+    brpc::ServerOptions options1;
+    brpc::Server server1;
+    ASSERT_EQ(0, server1.AddService(standby, brpc::SERVER_OWNS_SERVICE));
+    ASSERT_EQ(0, server1.Start(FLAGS_endpoint.c_str(), &options1));
+
+    brpc::ServerOptions options2;
+    brpc::Server server2;
+    ASSERT_TRUE(StartTablet("127.0.0.1:9539", &server2, &options2));
+
+    std::string msg;
+    std::string db = "db" + ::openmldb::test::GenRand();
+    ASSERT_TRUE(ns_client.CreateDatabase(db, msg));
+    auto create_table = [&](const std::string& name) {
+        TableInfo table_info;
+        table_info.set_db(db);
+        table_info.set_name(name);
+        table_info.set_storage_mode(storage_mode);
+        ::openmldb::test::AddDefaultSchema(0, 0, ::openmldb::type::kAbsoluteTime, &table_info);
+        TablePartition* partion = table_info.add_table_partition();
+        partion->set_pid(0);
+        PartitionMeta* meta = partion->add_partition_meta();
+        meta->set_endpoint("127.0.0.1:9539");
+        meta->set_is_leader(true);
+        return ns_client.CreateTable(table_info, false, msg);
+    };
+    ASSERT_TRUE(create_table("t1"));
+    ASSERT_TRUE(create_table("t2"));
+    sleep(2);
+    ASSERT_EQ(2u, GetDbTableInfo(standby)[db].size());
+
+    // the standby follows the changes by the table change log
+    ASSERT_TRUE(ns_client.DropTable(db, "t1", msg));
+    ASSERT_TRUE(create_table("t3"));
+    sleep(2);
+    ASSERT_EQ(2u, GetDbTableInfo(standby)[db].size());
+    ASSERT_EQ(0u, GetDbTableInfo(standby)[db].count("t1"));
+    ASSERT_EQ(1u, GetDbTableInfo(standby)[db].count("t3"));
+
+    // the standby takes over the leadership
+    ASSERT_TRUE(ns_client.DisConnectZK(msg));
+    sleep(4);
+    ::openmldb::client::NsClient standby_client("127.0.0.1:9637", "");
+    ASSERT_EQ(0, standby_client.Init());
+    std::vector<TableInfo> tables;
+    ASSERT_TRUE(standby_client.ShowDBTable(db, &tables).OK());
+    ASSERT_EQ(2u, tables.size());
+    ASSERT_TRUE(standby_client.DropTable(db, "t2", msg));
+    ASSERT_TRUE(standby_client.DropTable(db, "t3", msg));
+
+    FLAGS_enable_ns_warm_standby = false;
+    ::openmldb::base::RemoveDirRecursive(FLAGS_ssd_root_path + "/2_0");
+    ::openmldb::base::RemoveDirRecursive(FLAGS_hdd_root_path + "/2_0");
+}
+
 INSTANTIATE_TEST_CASE_P(TabletMemAndHDD, NameServerImplTest,
                         ::testing::Values(::openmldb::common::kMemory, ::openmldb::common::kSSD,
                                           ::openmldb::common::kHDD));
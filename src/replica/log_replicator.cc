@@ -25,6 +25,7 @@
 #include <algorithm>
 #include <chrono>  // NOLINT
 #include <cstring>
+#include <deque>
 #include <utility>
 
 #include "base/file_util.h"
@@ -35,13 +36,24 @@
 
 DECLARE_int32(binlog_single_file_max_size);
 DECLARE_int32(binlog_name_length);
+DECLARE_bool(binlog_group_commit);
+DECLARE_uint32(binlog_group_commit_max_cnt);
 DECLARE_string(zk_cluster);
+DECLARE_uint32(binlog_index_interval);
 
 namespace openmldb {
 namespace replica {
 
 static const ::openmldb::base::DefaultComparator scmp;
 
+struct LogReplicator::BinlogWriter {
+    explicit BinlogWriter(LogEntry* e) : entry(e), ok(false), done(false), cv() {}
+    LogEntry* entry;
+    bool ok;
+    bool done;
+    bthread::ConditionVariable cv;
+};
+
 LogReplicator::LogReplicator(uint32_t tid, uint32_t pid, const std::string& path,
                              const std::map<std::string, std::string>& real_ep_map,
                              const ReplicatorRole& role)
@@ -64,6 +76,7 @@ LogReplicator::LogReplicator(uint32_t tid, uint32_t pid, const std::string& path
     snapshot_log_part_index_.store(-1, std::memory_order_relaxed);
     snapshot_last_offset_.store(0, std::memory_order_relaxed);
     follower_offset_.store(0);
+    leader_log_offset_.store(0, std::memory_order_relaxed);
 }
 
 LogReplicator::~LogReplicator() {
@@ -270,8 +283,10 @@ void LogReplicator::DeleteBinlog(bool* deleted) {
     while (node) {
         ::openmldb::base::Node<uint32_t, uint64_t>* tmp_node = node;
         node = node->GetNextNoBarrier(0);
-        std::string full_path =
-            log_path_ + "/" + ::openmldb::base::FormatToString(tmp_node->GetKey(), FLAGS_binlog_name_length) + ".log";
+        std::string name = ::openmldb::base::FormatToString(tmp_node->GetKey(), FLAGS_binlog_name_length) + ".log";
+        std::string full_path = log_path_ + "/" + name;
+        // the index may be missing, as the file is written with binlog_index_interval 0 or by a former version
+        unlink(::openmldb::log::GetLogIndexPath(log_path_, name).c_str());
         if (unlink(full_path.c_str()) < 0) {
             PDLOG(WARNING, "delete binlog[%s] failed! errno[%d] errinfo[%s]", full_path.c_str(), errno,
                   strerror(errno));
@@ -303,9 +318,11 @@ bool LogReplicator::ApplyEntry(const LogEntry& entry) {
                 entry.log_index(), last_log_offset, tid_, pid_);
         return true;
     }
-    std::string buffer;
-    entry.SerializeToString(&buffer);
-    ::openmldb::base::Slice slice(buffer.c_str(), buffer.size());
+    entry.SerializeToString(&write_buf_);
+    ::openmldb::base::Slice slice(write_buf_.c_str(), write_buf_.size());
+    if (index_writer_) {
+        index_writer_->Add(entry.log_index(), wh_->GetSize());
+    }
     ::openmldb::log::Status status = wh_->Write(slice);
     if (!status.ok()) {
         PDLOG(WARNING, "fail to write replication log in dir %s for %s", path_.c_str(), status.ToString().c_str());
@@ -434,7 +451,31 @@ bool LogReplicator::DelAllReplicateNode() {
 }
 
 bool LogReplicator::AppendEntry(LogEntry& entry) {
+    if (FLAGS_binlog_group_commit) {
+        return GroupCommit(entry);
+    }
     std::lock_guard<std::mutex> lock(wmu_);
+    return WriteEntry(entry);
+}
+
+bool LogReplicator::AppendEntries(std::vector<LogEntry>* entries) {
+    std::lock_guard<std::mutex> lock(wmu_);
+    for (auto& entry : *entries) {
+        if (!WriteEntry(entry)) {
+            return false;
+        }
+    }
+    if (FLAGS_binlog_group_commit && wh_ != NULL) {
+        ::openmldb::log::Status status = wh_->Sync();
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to sync data for path %s", path_.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LogReplicator::WriteEntry(LogEntry& entry) {
     if (wh_ == NULL || wh_->GetSize() / (1024 * 1024) > (uint32_t)FLAGS_binlog_single_file_max_size) {
         bool ok = RollWLogFile();
         if (!ok) {
@@ -443,9 +484,11 @@ bool LogReplicator::AppendEntry(LogEntry& entry) {
     }
     uint64_t cur_offset = log_offset_.load(std::memory_order_relaxed);
     entry.set_log_index(1 + cur_offset);
-    std::string buffer;
-    entry.SerializeToString(&buffer);
-    ::openmldb::base::Slice slice(buffer);
+    entry.SerializeToString(&write_buf_);
+    ::openmldb::base::Slice slice(write_buf_);
+    if (index_writer_) {
+        index_writer_->Add(entry.log_index(), wh_->GetSize());
+    }
     ::openmldb::log::Status status = wh_->Write(slice);
     if (!status.ok()) {
         PDLOG(WARNING, "fail to write replication log in dir %s for %s", path_.c_str(), status.ToString().c_str());
@@ -459,9 +502,58 @@ bool LogReplicator::AppendEntry(LogEntry& entry) {
     return true;
 }
 
+bool LogReplicator::GroupCommit(LogEntry& entry) {
+    BinlogWriter w(&entry);
+    std::unique_lock<bthread::Mutex> lock(gmu_);
+    writers_.push_back(&w);
+    while (!w.done && &w != writers_.front()) {
+        w.cv.wait(lock);
+    }
+    if (w.done) {
+        return w.ok;
+    }
+    // the waiters enqueued from now on are left to the next group
+    uint32_t cnt = std::min((uint32_t)writers_.size(), std::max(FLAGS_binlog_group_commit_max_cnt, 1u));
+    std::vector<BinlogWriter*> group(writers_.begin(), writers_.begin() + cnt);
+    lock.unlock();
+    {
+        std::lock_guard<std::mutex> wlock(wmu_);
+        // the entries after a failed one are failed too, so that the log index keeps continuous
+        bool ok = true;
+        for (BinlogWriter* cur : group) {
+            ok = ok && WriteEntry(*cur->entry);
+            cur->ok = ok;
+        }
+        if (wh_ != NULL) {
+            ::openmldb::log::Status status = wh_->Sync();
+            if (!status.ok()) {
+                PDLOG(WARNING, "fail to sync data for path %s", path_.c_str());
+                for (BinlogWriter* cur : group) {
+                    cur->ok = false;
+                }
+            }
+        }
+    }
+    lock.lock();
+    for (BinlogWriter* cur : group) {
+        writers_.pop_front();
+        cur->done = true;
+        if (cur != &w) {
+            cur->cv.notify_one();
+        }
+    }
+    if (!writers_.empty()) {
+        writers_.front()->cv.notify_one();
+    }
+    return w.ok;
+}
+
 bool LogReplicator::RollWLogFile() {
     if (wh_ != NULL) {
         wh_->EndLog();
+        if (FLAGS_binlog_group_commit) {
+            wh_->Sync();
+        }
         delete wh_;
         wh_ = NULL;
     }
@@ -479,6 +571,15 @@ bool LogReplicator::RollWLogFile() {
     binlog_index_.fetch_add(1, std::memory_order_relaxed);
     PDLOG(INFO, "roll write log for name %s and start offset %lld", name.c_str(), offset);
     wh_ = new WriteHandle("off", name, fd);
+    index_writer_.reset();
+    if (FLAGS_binlog_index_interval > 0) {
+        index_writer_.reset(
+            new ::openmldb::log::LogIndexWriter(FLAGS_binlog_index_interval, ::openmldb::log::kBlockSize));
+        // the binlog file is still read from the start without the index
+        if (!index_writer_->Open(::openmldb::log::GetLogIndexPath(log_path_, name))) {
+            index_writer_.reset();
+        }
+    }
     return true;
 }
 
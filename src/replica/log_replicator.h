@@ -19,6 +19,7 @@
 
 #include <atomic>
 #include <condition_variable>  // NOLINT
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -29,6 +30,7 @@
 #include "bthread/bthread.h"
 #include "bthread/condition_variable.h"
 #include "common/thread_pool.h"
+#include "log/log_index.h"
 #include "log/log_reader.h"
 #include "log/log_writer.h"
 #include "log/sequential_file.h"
@@ -66,6 +68,10 @@ class LogReplicator {
     // the master node append entry
     bool AppendEntry(::openmldb::api::LogEntry& entry);  // NOLINT
 
+    // append the entries in one write lock and sync them once with group commit, the entries after a failed one
+    // are not written
+    bool AppendEntries(std::vector<::openmldb::api::LogEntry>* entries);
+
     //  data to slave nodes
     void Notify();
     // recover logs meta
@@ -97,6 +103,21 @@ class LogReplicator {
     LogParts* GetLogPart();
 
     inline uint64_t GetLogOffset() { return log_offset_.load(std::memory_order_relaxed); }
+
+    // the follower records the log offset of the leader told by the replication
+    void UpdateLeaderLogOffset(uint64_t offset) {
+        uint64_t cur = leader_log_offset_.load(std::memory_order_relaxed);
+        while (offset > cur && !leader_log_offset_.compare_exchange_weak(cur, offset, std::memory_order_relaxed)) {
+        }
+    }
+
+    // the log entries the follower lags behind the leader as of the last replication, the writes of the leader
+    // not replicated yet are unknown to it
+    uint64_t GetLagBehindLeader() {
+        uint64_t leader_offset = leader_log_offset_.load(std::memory_order_relaxed);
+        uint64_t offset = log_offset_.load(std::memory_order_relaxed);
+        return leader_offset > offset ? leader_offset - offset : 0;
+    }
     void SetRole(const ReplicatorRole& role);
 
     uint64_t GetLeaderTerm();
@@ -111,8 +132,16 @@ class LogReplicator {
     const std::string& GetLogPath() {return log_path_;}
 
  private:
+    struct BinlogWriter;
+
     bool OpenSeqFile(const std::string& path, SequentialFile** sf);
 
+    // write one entry to the binlog with wmu_ held
+    bool WriteEntry(::openmldb::api::LogEntry& entry);  // NOLINT
+
+    // the first waiting writer writes the entries of all waiters and syncs them once
+    bool GroupCommit(::openmldb::api::LogEntry& entry);  // NOLINT
+
  private:
     // the replicator root data path
     uint32_t tid_;
@@ -122,9 +151,14 @@ class LogReplicator {
     // the term for leader judgement
     std::atomic<uint64_t> log_offset_;
     std::atomic<uint64_t> follower_offset_;
+    std::atomic<uint64_t> leader_log_offset_;
     std::atomic<uint32_t> binlog_index_;
     LogParts* logs_;
     WriteHandle* wh_;
+    // the sparse index of the binlog file of wh_, NULL if binlog_index_interval is 0. guarded by wmu_ as wh_
+    std::unique_ptr<::openmldb::log::LogIndexWriter> index_writer_;
+    // the entry serialized to be written to wh_, reused so its capacity is kept. guarded by wmu_
+    std::string write_buf_;
     ReplicatorRole role_;
     std::map<std::string, std::string> real_ep_map_;
     std::vector<std::shared_ptr<ReplicateNode> > nodes_;
@@ -139,6 +173,10 @@ class LogReplicator {
     std::atomic<uint64_t> snapshot_last_offset_;
 
     std::mutex wmu_;
+
+    // the writers waiting for group commit, the front one is writing
+    bthread::Mutex gmu_;
+    std::deque<BinlogWriter*> writers_;
 };
 
 }  // namespace replica
@@ -17,6 +17,7 @@
 #include "replica/log_replicator.h"
 
 #include <brpc/server.h>
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 #include <sched.h>
 #include <stdio.h>
@@ -24,7 +25,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <thread>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "base/glog_wapper.h"
 #include "base/status.h"
@@ -37,6 +40,13 @@
 #include "storage/ticket.h"
 #include "test/util.h"
 
+DECLARE_bool(binlog_group_commit);
+DECLARE_int32(binlog_sync_batch_size);
+DECLARE_uint32(binlog_sync_batch_bytes);
+DECLARE_uint32(binlog_sync_inflight_cnt);
+DECLARE_string(binlog_sync_compression);
+DECLARE_uint32(binlog_remote_channel_conn_cnt);
+
 using ::baidu::common::ThreadPool;
 using ::google::protobuf::Closure;
 using ::google::protobuf::RpcController;
@@ -82,7 +92,17 @@ class MockTabletImpl : public ::openmldb::api::TabletServer {
 
     void AppendEntries(RpcController* controller, const ::openmldb::api::AppendEntriesRequest* request,
                        ::openmldb::api::AppendEntriesResponse* response, Closure* done) {
+        append_cnt_.fetch_add(1, std::memory_order_relaxed);
+        if (static_cast<brpc::Controller*>(controller)->request_compress_type() != brpc::COMPRESS_TYPE_NONE) {
+            compressed_cnt_.fetch_add(1, std::memory_order_relaxed);
+        }
         uint64_t last_log_offset = replicator_.GetOffset();
+        if (request->check_pre_log_index() && request->pre_log_index() > last_log_offset) {
+            response->set_code(::openmldb::base::ReturnCode::kFailToAppendEntriesToReplicator);
+            response->set_log_offset(last_log_offset);
+            done->Run();
+            return;
+        }
         for (int32_t i = 0; i < request->entries_size(); i++) {
             if (request->entries(i).log_index() <= last_log_offset) {
                 continue;
@@ -100,6 +120,21 @@ class MockTabletImpl : public ::openmldb::api::TabletServer {
         replicator_.Notify();
     }
 
+    void AppendEntriesBatch(RpcController* controller, const ::openmldb::api::AppendEntriesBatchRequest* request,
+                            ::openmldb::api::AppendEntriesBatchResponse* response, Closure* done) {
+        brpc::ClosureGuard done_guard(done);
+        batch_cnt_.fetch_add(1, std::memory_order_relaxed);
+        for (const auto& append_request : request->requests()) {
+            AppendEntries(controller, &append_request, response->add_responses(), brpc::DoNothing());
+        }
+    }
+
+    uint64_t GetBatchCnt() { return batch_cnt_.load(std::memory_order_relaxed); }
+
+    uint64_t GetAppendCnt() { return append_cnt_.load(std::memory_order_relaxed); }
+
+    uint64_t GetCompressedCnt() { return compressed_cnt_.load(std::memory_order_relaxed); }
+
     void SetMode(bool follower) { follower_.store(follower); }
 
     bool GetMode() { return follower_.load(std::memory_order_relaxed); }
@@ -111,6 +146,9 @@ class MockTabletImpl : public ::openmldb::api::TabletServer {
     std::map<std::string, std::string> real_ep_map_;
     LogReplicator replicator_;
     std::atomic<bool> follower_;
+    std::atomic<uint64_t> batch_cnt_{0};
+    std::atomic<uint64_t> append_cnt_{0};
+    std::atomic<uint64_t> compressed_cnt_{0};
 };
 
 bool ReceiveEntry(const ::openmldb::api::LogEntry& entry) { return true; }
@@ -147,6 +185,50 @@ TEST_F(LogReplicatorTest, BenchMark) {
     ASSERT_TRUE(ok);
 }
 
+TEST_F(LogReplicatorTest, GroupCommit) {
+    FLAGS_binlog_group_commit = true;
+    std::map<std::string, std::string> map;
+    std::string folder = "/tmp/" + GenRand() + "/";
+    LogReplicator replicator(1, 1, folder, map, kLeaderNode);
+    ASSERT_TRUE(replicator.Init());
+    uint32_t thread_cnt = 8;
+    uint32_t put_cnt = 100;
+    std::vector<std::vector<uint64_t>> offsets(thread_cnt);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < thread_cnt; i++) {
+        threads.emplace_back([&replicator, &offsets, i, put_cnt] {
+            for (uint32_t j = 0; j < put_cnt; j++) {
+                ::openmldb::api::LogEntry entry;
+                entry.set_term(1);
+                entry.set_pk("key" + std::to_string(i));
+                entry.set_value("value" + std::to_string(j));
+                entry.set_ts(9527 + j);
+                if (replicator.AppendEntry(entry)) {
+                    offsets[i].push_back(entry.log_index());
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    FLAGS_binlog_group_commit = false;
+    ASSERT_EQ(thread_cnt * put_cnt, replicator.GetOffset());
+    std::vector<bool> seen(thread_cnt * put_cnt + 1, false);
+    for (const auto& thread_offsets : offsets) {
+        ASSERT_EQ(put_cnt, thread_offsets.size());
+        for (uint32_t j = 0; j < thread_offsets.size(); j++) {
+            uint64_t offset = thread_offsets[j];
+            ASSERT_TRUE(offset >= 1 && offset <= thread_cnt * put_cnt);
+            ASSERT_FALSE(seen[offset]);
+            seen[offset] = true;
+            if (j > 0) {
+                ASSERT_GT(offset, thread_offsets[j - 1]);
+            }
+        }
+    }
+}
+
 TEST_F(LogReplicatorTest, LeaderAndFollowerMulti) {
     brpc::ServerOptions options;
     brpc::Server server0;
@@ -300,6 +382,188 @@ TEST_F(LogReplicatorTest, LeaderAndFollowerMulti) {
     }
 }
 
+TEST_F(LogReplicatorTest, PipelineSync) {
+    FLAGS_binlog_sync_inflight_cnt = 4;
+    FLAGS_binlog_sync_batch_size = 8;
+    FLAGS_binlog_sync_batch_bytes = 128;
+    FLAGS_binlog_sync_compression = "snappy";
+    brpc::ServerOptions options;
+    brpc::Server server;
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx", 0));
+    std::shared_ptr<MemTable> table =
+        std::make_shared<MemTable>("test", 1, 1, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    std::string follower_addr = "127.0.0.1:17529";
+    MockTabletImpl* follower = nullptr;
+    {
+        std::string folder = "/tmp/" + GenRand() + "/";
+        follower = new MockTabletImpl(kFollowerNode, folder, g_endpoints, table);
+        ASSERT_TRUE(follower->Init());
+        ASSERT_EQ(0, server.AddService(follower, brpc::SERVER_OWNS_SERVICE));
+        ASSERT_EQ(0, server.Start(follower_addr.c_str(), &options));
+    }
+    std::string folder = "/tmp/" + GenRand() + "/";
+    LogReplicator leader(1, 1, folder, g_endpoints, kLeaderNode);
+    ASSERT_TRUE(leader.Init());
+    uint32_t entry_cnt = 100;
+    for (uint32_t i = 0; i < entry_cnt; i++) {
+        ::openmldb::api::LogEntry entry;
+        ::openmldb::test::AddDimension(0, "test_pk", &entry);
+        entry.set_value(::openmldb::test::EncodeKV("test_pk", "value" + std::to_string(i)));
+        entry.set_ts(9527 + i);
+        ASSERT_TRUE(leader.AppendEntry(entry));
+    }
+    std::map<std::string, std::string> map;
+    map.insert(std::make_pair(follower_addr, ""));
+    ASSERT_EQ(0, leader.AddReplicateNode(map));
+    leader.Notify();
+    std::map<std::string, uint64_t> info_map;
+    for (int i = 0; i < 100; i++) {
+        info_map.clear();
+        leader.GetReplicateInfo(info_map);
+        if (info_map[follower_addr] == entry_cnt) {
+            break;
+        }
+        usleep(100 * 1000);
+    }
+    leader.DelAllReplicateNode();
+    FLAGS_binlog_sync_inflight_cnt = 1;
+    FLAGS_binlog_sync_batch_size = 32;
+    FLAGS_binlog_sync_batch_bytes = 0;
+    FLAGS_binlog_sync_compression = "off";
+    ASSERT_EQ(entry_cnt, info_map[follower_addr]);
+    ASSERT_EQ(entry_cnt, table->GetRecordCnt());
+    // every batch arrives snappy compressed
+    ASSERT_GT(follower->GetAppendCnt(), 0u);
+    ASSERT_EQ(follower->GetAppendCnt(), follower->GetCompressedCnt());
+    Ticket ticket;
+    TableIterator* it = table->NewIterator("test_pk", ticket);
+    it->SeekToFirst();
+    for (uint32_t i = 0; i < entry_cnt; i++) {
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ(9527 + entry_cnt - 1 - i, it->GetKey());
+        it->Next();
+    }
+    ASSERT_FALSE(it->Valid());
+    delete it;
+}
+
+TEST_F(LogReplicatorTest, RemoteChannelSync) {
+    FLAGS_binlog_remote_channel_conn_cnt = 2;
+    brpc::ServerOptions options;
+    brpc::Server server;
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx", 0));
+    std::shared_ptr<MemTable> table =
+        std::make_shared<MemTable>("test", 2, 1, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    std::string follower_addr = "127.0.0.1:17530";
+    MockTabletImpl* follower = nullptr;
+    {
+        std::string folder = "/tmp/" + GenRand() + "/";
+        follower = new MockTabletImpl(kFollowerNode, folder, g_endpoints, table);
+        ASSERT_TRUE(follower->Init());
+        ASSERT_EQ(0, server.AddService(follower, brpc::SERVER_OWNS_SERVICE));
+        ASSERT_EQ(0, server.Start(follower_addr.c_str(), &options));
+    }
+    std::string folder = "/tmp/" + GenRand() + "/";
+    // no local follower, so the leader syncs to the replica cluster directly
+    LogReplicator leader(1, 1, folder, g_endpoints, kLeaderNode);
+    ASSERT_TRUE(leader.Init());
+    uint32_t entry_cnt = 100;
+    for (uint32_t i = 0; i < entry_cnt; i++) {
+        ::openmldb::api::LogEntry entry;
+        ::openmldb::test::AddDimension(0, "test_pk", &entry);
+        entry.set_value(::openmldb::test::EncodeKV("test_pk", "value" + std::to_string(i)));
+        entry.set_ts(9527 + i);
+        ASSERT_TRUE(leader.AppendEntry(entry));
+    }
+    std::map<std::string, std::string> map;
+    map.insert(std::make_pair(follower_addr, ""));
+    ASSERT_EQ(0, leader.AddReplicateNode(map, 2));
+    leader.Notify();
+    std::map<std::string, uint64_t> info_map;
+    for (int i = 0; i < 100; i++) {
+        info_map.clear();
+        leader.GetReplicateInfo(info_map);
+        if (info_map[follower_addr] == entry_cnt) {
+            break;
+        }
+        usleep(100 * 1000);
+    }
+    leader.DelAllReplicateNode();
+    FLAGS_binlog_remote_channel_conn_cnt = 0;
+    ASSERT_EQ(entry_cnt, info_map[follower_addr]);
+    ASSERT_EQ(entry_cnt, table->GetRecordCnt());
+    ASSERT_GT(follower->GetBatchCnt(), 0u);
+}
+
+TEST_F(LogReplicatorTest, SyncFromCacheAfterFailure) {
+    FLAGS_binlog_sync_inflight_cnt = 4;
+    FLAGS_binlog_sync_batch_size = 8;
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx", 0));
+    std::shared_ptr<MemTable> table =
+        std::make_shared<MemTable>("test", 3, 1, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    std::string follower_addr = "127.0.0.1:17531";
+    std::string folder = "/tmp/" + GenRand() + "/";
+    LogReplicator leader(1, 1, folder, g_endpoints, kLeaderNode);
+    ASSERT_TRUE(leader.Init());
+    uint32_t entry_cnt = 100;
+    for (uint32_t i = 0; i < entry_cnt; i++) {
+        ::openmldb::api::LogEntry entry;
+        ::openmldb::test::AddDimension(0, "test_pk", &entry);
+        entry.set_value(::openmldb::test::EncodeKV("test_pk", "value" + std::to_string(i)));
+        entry.set_ts(9527 + i);
+        ASSERT_TRUE(leader.AppendEntry(entry));
+    }
+    // the follower is not up yet, so the batches built on the arena of a round fail and are copied to the cache
+    std::map<std::string, std::string> map;
+    map.insert(std::make_pair(follower_addr, ""));
+    ASSERT_EQ(0, leader.AddReplicateNode(map));
+    leader.Notify();
+    sleep(1);
+    brpc::ServerOptions options;
+    brpc::Server server;
+    {
+        std::string follower_folder = "/tmp/" + GenRand() + "/";
+        auto follower = new MockTabletImpl(kFollowerNode, follower_folder, g_endpoints, table);
+        ASSERT_TRUE(follower->Init());
+        ASSERT_EQ(0, server.AddService(follower, brpc::SERVER_OWNS_SERVICE));
+        ASSERT_EQ(0, server.Start(follower_addr.c_str(), &options));
+    }
+    leader.Notify();
+    std::map<std::string, uint64_t> info_map;
+    for (int i = 0; i < 100; i++) {
+        info_map.clear();
+        leader.GetReplicateInfo(info_map);
+        if (info_map[follower_addr] == entry_cnt) {
+            break;
+        }
+        usleep(100 * 1000);
+    }
+    leader.DelAllReplicateNode();
+    FLAGS_binlog_sync_inflight_cnt = 1;
+    FLAGS_binlog_sync_batch_size = 32;
+    ASSERT_EQ(entry_cnt, info_map[follower_addr]);
+    ASSERT_EQ(entry_cnt, table->GetRecordCnt());
+    Ticket ticket;
+    TableIterator* it = table->NewIterator("test_pk", ticket);
+    it->SeekToFirst();
+    for (uint32_t i = 0; i < entry_cnt; i++) {
+        ASSERT_TRUE(it->Valid());
+        uint64_t ts = 9527 + entry_cnt - 1 - i;
+        ASSERT_EQ(ts, it->GetKey());
+        ASSERT_EQ(::openmldb::test::EncodeKV("test_pk", "value" + std::to_string(ts - 9527)),
+                  it->GetValue().ToString());
+        it->Next();
+    }
+    ASSERT_FALSE(it->Valid());
+    delete it;
+}
+
 TEST_F(LogReplicatorTest, LeaderAndFollower) {
     brpc::ServerOptions options;
     brpc::Server server0;
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "replica/remote_channel.h"
+
+#include <gflags/gflags.h>
+
+#include <utility>
+
+#include "base/glog_wapper.h"  // NOLINT
+#include "bthread/countdown_event.h"
+
+DECLARE_uint32(binlog_remote_channel_conn_cnt);
+DECLARE_uint32(binlog_remote_channel_batch_bytes);
+DECLARE_string(binlog_remote_channel_compression);
+DECLARE_int32(binlog_sync_wait_time);
+DECLARE_int32(request_max_retry);
+DECLARE_int32(request_timeout_ms);
+
+namespace openmldb {
+namespace replica {
+
+struct RemoteChannel::Task {
+    ::openmldb::api::AppendEntriesRequest* request;
+    ::openmldb::api::AppendEntriesResponse* response;
+    bool ok = false;
+    bthread::CountdownEvent done{1};
+};
+
+namespace {
+struct SenderArgs {
+    RemoteChannel* channel;
+    uint32_t conn_idx;
+};
+}  // namespace
+
+RemoteChannel::RemoteChannel(const std::string& endpoint, uint32_t conn_cnt)
+    : endpoint_(endpoint), clients_(), senders_(), is_running_(false), mu_(), cv_(), tasks_() {
+    for (uint32_t i = 0; i < conn_cnt; i++) {
+        clients_.emplace_back(new ::openmldb::RpcClient<::openmldb::api::TabletServer_Stub>(endpoint));
+        clients_.back()->SetConnectionGroup("remote_channel_" + std::to_string(i));
+    }
+}
+
+RemoteChannel::~RemoteChannel() { Stop(); }
+
+std::shared_ptr<RemoteChannel> RemoteChannel::GetChannel(const std::string& endpoint) {
+    // the channels live as long as the process
+    static std::mutex mu;
+    static auto* channels = new std::map<std::string, std::shared_ptr<RemoteChannel>>();
+    std::lock_guard<std::mutex> lock(mu);
+    auto iter = channels->find(endpoint);
+    if (iter != channels->end()) {
+        return iter->second;
+    }
+    auto channel = std::make_shared<RemoteChannel>(endpoint, FLAGS_binlog_remote_channel_conn_cnt);
+    if (channel->Init() != 0) {
+        return nullptr;
+    }
+    channels->emplace(endpoint, channel);
+    return channel;
+}
+
+int RemoteChannel::Init() {
+    for (auto& client : clients_) {
+        int ok = client->Init();
+        if (ok != 0) {
+            PDLOG(WARNING, "fail to open rpc client for endpoint %s with errno %d", endpoint_.c_str(), ok);
+            return ok;
+        }
+    }
+    is_running_.store(true, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < clients_.size(); i++) {
+        bthread_t sender;
+        int ok = bthread_start_background(&sender, NULL, RunSender, new SenderArgs{this, i});
+        if (ok != 0) {
+            PDLOG(WARNING, "fail to start bthread with errno %d", ok);
+            Stop();
+            return ok;
+        }
+        senders_.push_back(sender);
+    }
+    PDLOG(INFO, "open remote channel for endpoint %s with %u connections done", endpoint_.c_str(),
+          static_cast<uint32_t>(clients_.size()));
+    return 0;
+}
+
+void* RemoteChannel::RunSender(void* args) {
+    std::unique_ptr<SenderArgs> sender_args(static_cast<SenderArgs*>(args));
+    sender_args->channel->SendBatches(sender_args->conn_idx);
+    return NULL;
+}
+
+bool RemoteChannel::Send(::openmldb::api::AppendEntriesRequest* request,
+                         ::openmldb::api::AppendEntriesResponse* response) {
+    Task task;
+    task.request = request;
+    task.response = response;
+    {
+        std::lock_guard<bthread::Mutex> lock(mu_);
+        if (!is_running_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        tasks_.push_back(&task);
+    }
+    cv_.notify_one();
+    task.done.wait();
+    return task.ok;
+}
+
+void RemoteChannel::SendBatches(uint32_t conn_idx) {
+    auto& client = clients_[conn_idx];
+    while (true) {
+        std::vector<Task*> batch;
+        {
+            std::unique_lock<bthread::Mutex> lock(mu_);
+            while (tasks_.empty()) {
+                if (!is_running_.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                cv_.wait_for(lock, FLAGS_binlog_sync_wait_time * 1000);
+            }
+            uint64_t batch_bytes = 0;
+            while (!tasks_.empty() && batch_bytes < FLAGS_binlog_remote_channel_batch_bytes) {
+                batch_bytes += tasks_.front()->request->ByteSizeLong();
+                batch.push_back(tasks_.front());
+                tasks_.pop_front();
+            }
+        }
+        // the requests are lent to the batch instead of swapped in, as a swap copies them if they are allocated on
+        // the arena of the sender
+        ::openmldb::api::AppendEntriesBatchRequest request;
+        for (auto task : batch) {
+            request.mutable_requests()->UnsafeArenaAddAllocated(task->request);
+        }
+        ::openmldb::api::AppendEntriesBatchResponse response;
+        brpc::Controller cntl;
+        cntl.set_timeout_ms(FLAGS_request_timeout_ms);
+        cntl.set_max_retry(FLAGS_request_max_retry);
+        if (FLAGS_binlog_remote_channel_compression == "snappy") {
+            cntl.set_request_compress_type(brpc::COMPRESS_TYPE_SNAPPY);
+        } else if (FLAGS_binlog_remote_channel_compression == "zlib") {
+            cntl.set_request_compress_type(brpc::COMPRESS_TYPE_ZLIB);
+        }
+        bool ok = client->SendRequest(&::openmldb::api::TabletServer_Stub::AppendEntriesBatch, &cntl, &request,
+                                      &response);
+        if (ok && response.responses_size() != request.requests_size()) {
+            PDLOG(WARNING, "got %d responses of %d requests from endpoint %s", response.responses_size(),
+                  request.requests_size(), endpoint_.c_str());
+            ok = false;
+        }
+        DEBUGLOG("send %u requests to endpoint %s in a batch", static_cast<uint32_t>(batch.size()), endpoint_.c_str());
+        for (uint32_t i = 0; i < batch.size(); i++) {
+            request.mutable_requests()->UnsafeArenaReleaseLast();
+        }
+        for (uint32_t i = 0; i < batch.size(); i++) {
+            if (ok) {
+                batch[i]->response->Swap(response.mutable_responses(i));
+            }
+            batch[i]->ok = ok;
+            batch[i]->done.signal();
+        }
+    }
+}
+
+void RemoteChannel::Stop() {
+    {
+        std::lock_guard<bthread::Mutex> lock(mu_);
+        is_running_.store(false, std::memory_order_relaxed);
+    }
+    cv_.notify_all();
+    for (auto sender : senders_) {
+        bthread_join(sender, NULL);
+    }
+    senders_.clear();
+    std::lock_guard<bthread::Mutex> lock(mu_);
+    for (auto task : tasks_) {
+        task->done.signal();
+    }
+    tasks_.clear();
+}
+
+}  // namespace replica
+}  // namespace openmldb
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_REPLICA_REMOTE_CHANNEL_H_
+#define SRC_REPLICA_REMOTE_CHANNEL_H_
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "bthread/bthread.h"
+#include "bthread/condition_variable.h"
+#include "proto/tablet.pb.h"
+#include "rpc/rpc_client.h"
+
+namespace openmldb {
+namespace replica {
+
+// RemoteChannel carries the binlog of all the partitions replicated to one tablet of a replica cluster.
+//
+// The request of a partition waits in the queue of the channel, and every connection of the channel sends
+// the requests queued meanwhile in one compressed AppendEntriesBatch, so the partitions share the round trips
+// over the wan instead of paying one each. A partition has one request in the channel at most, as Send blocks
+// until its response is back, so its binlog is still applied in order and its offset moves as before.
+class RemoteChannel {
+ public:
+    RemoteChannel(const std::string& endpoint, uint32_t conn_cnt);
+    ~RemoteChannel();
+
+    // the channel shared by the partitions replicated to endpoint, null if it fails to connect
+    static std::shared_ptr<RemoteChannel> GetChannel(const std::string& endpoint);
+
+    int Init();
+
+    // send the request with the ones of the other partitions and wait for the response. The request is left as
+    // it was after the call
+    bool Send(::openmldb::api::AppendEntriesRequest* request, ::openmldb::api::AppendEntriesResponse* response);
+
+    void Stop();
+
+    RemoteChannel(const RemoteChannel&) = delete;
+    RemoteChannel& operator=(const RemoteChannel&) = delete;
+
+ private:
+    struct Task;
+
+    static void* RunSender(void* args);
+
+    void SendBatches(uint32_t conn_idx);
+
+    std::string endpoint_;
+    std::vector<std::unique_ptr<::openmldb::RpcClient<::openmldb::api::TabletServer_Stub>>> clients_;
+    std::vector<bthread_t> senders_;
+    std::atomic<bool> is_running_;
+    bthread::Mutex mu_;
+    bthread::ConditionVariable cv_;
+    std::deque<Task*> tasks_;
+};
+
+}  // namespace replica
+}  // namespace openmldb
+
+#endif  // SRC_REPLICA_REMOTE_CHANNEL_H_
@@ -17,13 +17,21 @@
 #include "replica/replicate_node.h"
 
 #include <gflags/gflags.h>
+#include <google/protobuf/arena.h>
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 #include "base/glog_wapper.h"  // NOLINT
 #include "base/strings.h"
 
 DECLARE_int32(binlog_sync_batch_size);
+DECLARE_uint32(binlog_sync_batch_bytes);
+DECLARE_uint32(binlog_sync_inflight_cnt);
+DECLARE_string(binlog_sync_compression);
+DECLARE_uint32(binlog_remote_channel_conn_cnt);
+DECLARE_int32(binlog_remote_sync_batch_size);
 DECLARE_int32(binlog_sync_wait_time);
 DECLARE_int32(binlog_coffee_time);
 DECLARE_int32(binlog_match_logoffset_interval);
@@ -53,6 +61,7 @@ ReplicateNode::ReplicateNode(const std::string& point, LogParts* logs, const std
     : log_reader_(logs, log_path, false),
       cache_(),
       endpoint_(point),
+      real_endpoint_(real_point.empty() ? point : real_point),
       last_sync_offset_(0),
       log_matched_(false),
       tid_(tid),
@@ -66,7 +75,8 @@ ReplicateNode::ReplicateNode(const std::string& point, LogParts* logs, const std
       cv_(cv),
       go_back_cnt_(0),
       rep_node_(rep_follower),
-      follower_offset_(follower_offset) {
+      follower_offset_(follower_offset),
+      remote_channel_() {
     if (!real_point.empty()) {
         rpc_client_ = openmldb::RpcClient<::openmldb::api::TabletServer_Stub>(real_point);
     }
@@ -77,6 +87,13 @@ int ReplicateNode::Init() {
     if (ok != 0) {
         PDLOG(WARNING, "fail to open rpc client with errno %d", ok);
     }
+    if (ok == 0 && rep_node_.load(std::memory_order_relaxed) && FLAGS_binlog_remote_channel_conn_cnt > 0) {
+        remote_channel_ = RemoteChannel::GetChannel(real_endpoint_);
+        if (!remote_channel_) {
+            PDLOG(WARNING, "fail to get remote channel for endpoint %s", real_endpoint_.c_str());
+            return -1;
+        }
+    }
     PDLOG(INFO, "open rpc client for endpoint %s done", endpoint_.c_str());
     return ok;
 }
@@ -178,79 +195,154 @@ int ReplicateNode::SyncData(uint64_t log_offset) {
         PDLOG(WARNING, "log offset [%lu] le last sync offset [%lu], do nothing", log_offset, last_sync_offset_);
         return 1;
     }
-    ::openmldb::api::AppendEntriesRequest request;
+    // the remote channel batches the partitions instead
+    if (cache_.empty() && FLAGS_binlog_sync_inflight_cnt > 1 && !remote_channel_) {
+        return PipelineSyncData(log_offset);
+    }
+    // the entries of a batch are allocated on the arena and freed at once
+    ::google::protobuf::Arena arena;
+    auto request = ::google::protobuf::Arena::CreateMessage<::openmldb::api::AppendEntriesRequest>(&arena);
     ::openmldb::api::AppendEntriesResponse response;
     uint64_t sync_log_offset = last_sync_offset_;
     bool request_from_cache = false;
     bool need_wait = false;
     if (cache_.size() > 0) {
         request_from_cache = true;
-        request = cache_[0];
-        if (request.entries_size() <= 0) {
+        request->CopyFrom(cache_[0]);
+        if (request->entries_size() <= 0) {
             cache_.clear();
             PDLOG(WARNING, "empty append entry request from node %s cache", endpoint_.c_str());
             return -1;
         }
-        const ::openmldb::api::LogEntry& entry = request.entries(request.entries_size() - 1);
+        const ::openmldb::api::LogEntry& entry = request->entries(request->entries_size() - 1);
         if (entry.log_index() <= last_sync_offset_) {
             DEBUGLOG("duplicate log index from node %s cache", endpoint_.c_str());
-            cache_.clear();
+            cache_.erase(cache_.begin());
             return -1;
         }
         PDLOG(INFO, "use cached request to send last index %lu. tid %u pid %u", entry.log_index(), tid_, pid_);
         sync_log_offset = entry.log_index();
     } else {
-        request.set_tid(tid_);
-        request.set_pid(pid_);
-        request.set_pre_log_index(last_sync_offset_);
-        if (!FLAGS_zk_cluster.empty()) {
-            request.set_term(term_->load(std::memory_order_relaxed));
+        need_wait = ReadBatch(log_offset, &sync_log_offset, request);
+    }
+    if (request->entries_size() > 0) {
+        bool ret = SendAppendEntries(request, &response);
+        if (ret && response.code() == 0) {
+            DEBUGLOG("sync log to node[%s] to offset %lld", endpoint_.c_str(), sync_log_offset);
+            UpdateSyncOffset(sync_log_offset);
+            if (request_from_cache) {
+                cache_.erase(cache_.begin());
+            }
+        } else {
+            if (!request_from_cache) {
+                cache_.push_back(*request);
+            }
+            need_wait = true;
+            PDLOG(WARNING, "fail to sync log to node %s. tid %u pid %u", endpoint_.c_str(), tid_, pid_);
         }
-        uint32_t batchSize = log_offset - last_sync_offset_;
-        batchSize = std::min(batchSize, (uint32_t)FLAGS_binlog_sync_batch_size);
-        for (uint64_t i = 0; i < batchSize;) {
-            std::string buffer;
-            ::openmldb::base::Slice record;
-            ::openmldb::log::Status status = log_reader_.ReadNextRecord(&record, &buffer);
-            if (status.ok()) {
-                ::openmldb::api::LogEntry* entry = request.add_entries();
-                if (!entry->ParseFromString(record.ToString())) {
-                    PDLOG(WARNING, "bad protobuf format %s size %ld. tid %u pid %u",
-                          ::openmldb::base::DebugString(record.ToString()).c_str(), record.ToString().size(), tid_,
-                          pid_);
-                    request.mutable_entries()->RemoveLast();
-                    break;
-                }
-                DEBUGLOG("entry val %s log index %lld", entry->value().c_str(), entry->log_index());
-                if (entry->log_index() <= sync_log_offset) {
-                    DEBUGLOG("skip duplicate log offset %lld", entry->log_index());
-                    request.mutable_entries()->RemoveLast();
-                    continue;
-                }
-                // the log index should incr by 1
-                if ((sync_log_offset + 1) != entry->log_index()) {
-                    PDLOG(WARNING, "log missing expect offset %lu but %ld. tid %u pid %u", sync_log_offset + 1,
-                          entry->log_index(), tid_, pid_);
-                    request.mutable_entries()->RemoveLast();
-                    if (go_back_cnt_ > FLAGS_go_back_max_try_cnt) {
-                        log_reader_.GoBackToStart();
-                        go_back_cnt_ = 0;
-                        PDLOG(WARNING, "go back to start. tid %u pid %u endpoint %s", tid_, pid_, endpoint_.c_str());
-                    } else {
-                        log_reader_.GoBackToLastBlock();
-                        go_back_cnt_++;
-                    }
-                    need_wait = true;
-                    break;
-                }
-                sync_log_offset = entry->log_index();
-            } else if (status.IsWaitRecord()) {
-                DEBUGLOG("got a coffee time for[%s]", endpoint_.c_str());
-                need_wait = true;
+    }
+    if (need_wait) {
+        return 1;
+    }
+    return 0;
+}
+
+int ReplicateNode::PipelineSyncData(uint64_t log_offset) {
+    uint32_t inflight_cnt = FLAGS_binlog_sync_inflight_cnt;
+    ::google::protobuf::Arena arena;
+    std::vector<::openmldb::api::AppendEntriesRequest*> requests;
+    std::vector<uint64_t> offsets;
+    requests.reserve(inflight_cnt);
+    uint64_t sync_log_offset = last_sync_offset_;
+    bool need_wait = false;
+    while (requests.size() < inflight_cnt && sync_log_offset < log_offset && !need_wait) {
+        auto request = ::google::protobuf::Arena::CreateMessage<::openmldb::api::AppendEntriesRequest>(&arena);
+        need_wait = ReadBatch(log_offset, &sync_log_offset, request);
+        if (request->entries_size() <= 0) {
+            break;
+        }
+        // the batches may be handled out of order by the follower, so it must not skip over a missing batch
+        request->set_check_pre_log_index(true);
+        requests.push_back(request);
+        offsets.push_back(sync_log_offset);
+    }
+    if (requests.empty()) {
+        return need_wait ? 1 : 0;
+    }
+    std::vector<brpc::Controller> cntls(requests.size());
+    std::vector<::openmldb::api::AppendEntriesResponse> responses(requests.size());
+    std::vector<bool> sent(requests.size(), false);
+    for (uint32_t i = 0; i < requests.size(); i++) {
+        InitController(&cntls[i]);
+        sent[i] = rpc_client_.SendRequest(&::openmldb::api::TabletServer_Stub::AppendEntries, &cntls[i],
+                                          requests[i], &responses[i], brpc::DoNothing());
+    }
+    // the offset only moves forward with the successive acks from the first batch, the batches after
+    // a failed one are cached and resent one by one
+    bool failed = false;
+    for (uint32_t i = 0; i < requests.size(); i++) {
+        if (sent[i]) {
+            brpc::Join(cntls[i].call_id());
+        }
+        if (!failed && sent[i] && !cntls[i].Failed() && responses[i].code() == 0) {
+            DEBUGLOG("sync log to node[%s] to offset %lld", endpoint_.c_str(), offsets[i]);
+            UpdateSyncOffset(offsets[i]);
+            continue;
+        }
+        if (!failed) {
+            PDLOG(WARNING, "fail to sync log to node %s. tid %u pid %u error %s code %d", endpoint_.c_str(), tid_,
+                  pid_, cntls[i].ErrorText().c_str(), responses[i].code());
+            failed = true;
+        }
+        cache_.push_back(*requests[i]);
+    }
+    if (failed || need_wait) {
+        return 1;
+    }
+    return 0;
+}
+
+bool ReplicateNode::ReadBatch(uint64_t log_offset, uint64_t* sync_log_offset,
+                              ::openmldb::api::AppendEntriesRequest* request) {
+    request->set_tid(tid_);
+    request->set_pid(pid_);
+    request->set_pre_log_index(*sync_log_offset);
+    request->set_leader_log_offset(log_offset);
+    if (!FLAGS_zk_cluster.empty()) {
+        request->set_term(term_->load(std::memory_order_relaxed));
+    }
+    bool need_wait = false;
+    uint64_t batch_bytes = 0;
+    uint32_t batchSize = log_offset - *sync_log_offset;
+    batchSize = std::min(batchSize, remote_channel_ ? (uint32_t)FLAGS_binlog_remote_sync_batch_size
+                                                    : (uint32_t)FLAGS_binlog_sync_batch_size);
+    for (uint64_t i = 0; i < batchSize;) {
+        if (FLAGS_binlog_sync_batch_bytes > 0 && batch_bytes >= FLAGS_binlog_sync_batch_bytes) {
+            break;
+        }
+        std::string buffer;
+        ::openmldb::base::Slice record;
+        ::openmldb::log::Status status = log_reader_.ReadNextRecord(&record, &buffer);
+        if (status.ok()) {
+            ::openmldb::api::LogEntry* entry = request->add_entries();
+            if (!entry->ParseFromString(record.ToString())) {
+                PDLOG(WARNING, "bad protobuf format %s size %ld. tid %u pid %u",
+                      ::openmldb::base::DebugString(record.ToString()).c_str(), record.ToString().size(), tid_,
+                      pid_);
+                request->mutable_entries()->RemoveLast();
                 break;
-            } else if (status.IsInvalidRecord()) {
-                DEBUGLOG("fail to get record. %s. tid %u pid %u", status.ToString().c_str(), tid_, pid_);
-                need_wait = true;
+            }
+            DEBUGLOG("entry val %s log index %lld", entry->value().c_str(), entry->log_index());
+            if (entry->log_index() <= *sync_log_offset) {
+                DEBUGLOG("skip duplicate log offset %lld", entry->log_index());
+                request->mutable_entries()->RemoveLast();
+                continue;
+            }
+            // the log index should incr by 1
+            if ((*sync_log_offset + 1) != entry->log_index()) {
+                PDLOG(WARNING, "log missing expect offset %lu but %ld. tid %u pid %u", *sync_log_offset + 1,
+                      entry->log_index(), tid_, pid_);
+                request->mutable_entries()->RemoveLast();
                 if (go_back_cnt_ > FLAGS_go_back_max_try_cnt) {
                     log_reader_.GoBackToStart();
                     go_back_cnt_ = 0;
@@ -259,41 +351,67 @@ int ReplicateNode::SyncData(uint64_t log_offset) {
                     log_reader_.GoBackToLastBlock();
                     go_back_cnt_++;
                 }
-                break;
-            } else {
-                PDLOG(WARNING, "fail to get record: %s. tid %u pid %u", status.ToString().c_str(), tid_, pid_);
                 need_wait = true;
                 break;
             }
-            i++;
-            go_back_cnt_ = 0;
-        }
-    }
-    if (request.entries_size() > 0) {
-        bool ret = rpc_client_.SendRequest(&::openmldb::api::TabletServer_Stub::AppendEntries, &request, &response,
-                                           FLAGS_request_timeout_ms, FLAGS_request_max_retry);
-        if (ret && response.code() == 0) {
-            DEBUGLOG("sync log to node[%s] to offset %lld", endpoint_.c_str(), sync_log_offset);
-            last_sync_offset_ = sync_log_offset;
-            if (!rep_node_.load(std::memory_order_relaxed) &&
-                (last_sync_offset_ > follower_offset_->load(std::memory_order_relaxed))) {
-                follower_offset_->store(last_sync_offset_, std::memory_order_relaxed);
-            }
-            if (request_from_cache) {
-                cache_.clear();
+            *sync_log_offset = entry->log_index();
+            batch_bytes += record.size();
+        } else if (status.IsWaitRecord()) {
+            DEBUGLOG("got a coffee time for[%s]", endpoint_.c_str());
+            need_wait = true;
+            break;
+        } else if (status.IsInvalidRecord()) {
+            DEBUGLOG("fail to get record. %s. tid %u pid %u", status.ToString().c_str(), tid_, pid_);
+            need_wait = true;
+            if (go_back_cnt_ > FLAGS_go_back_max_try_cnt) {
+                log_reader_.GoBackToStart();
+                go_back_cnt_ = 0;
+                PDLOG(WARNING, "go back to start. tid %u pid %u endpoint %s", tid_, pid_, endpoint_.c_str());
+            } else {
+                log_reader_.GoBackToLastBlock();
+                go_back_cnt_++;
             }
+            break;
         } else {
-            if (!request_from_cache) {
-                cache_.push_back(request);
-            }
+            PDLOG(WARNING, "fail to get record: %s. tid %u pid %u", status.ToString().c_str(), tid_, pid_);
             need_wait = true;
-            PDLOG(WARNING, "fail to sync log to node %s. tid %u pid %u", endpoint_.c_str(), tid_, pid_);
+            break;
         }
+        i++;
+        go_back_cnt_ = 0;
     }
-    if (need_wait) {
-        return 1;
+    return need_wait;
+}
+
+void ReplicateNode::UpdateSyncOffset(uint64_t offset) {
+    last_sync_offset_ = offset;
+    if (!rep_node_.load(std::memory_order_relaxed) &&
+        (last_sync_offset_ > follower_offset_->load(std::memory_order_relaxed))) {
+        follower_offset_->store(last_sync_offset_, std::memory_order_relaxed);
     }
-    return 0;
+}
+
+void ReplicateNode::InitController(brpc::Controller* cntl) {
+    cntl->set_timeout_ms(FLAGS_request_timeout_ms);
+    cntl->set_max_retry(FLAGS_request_max_retry);
+    // brpc compresses the request once per call and the retries of the call resend the compressed buffer. Every
+    // follower reads its own batches from its own offset, so each batch is compressed for one follower only and
+    // again when it is resent from cache_. The follower decompresses the batch transparently
+    if (FLAGS_binlog_sync_compression == "snappy") {
+        cntl->set_request_compress_type(brpc::COMPRESS_TYPE_SNAPPY);
+    } else if (FLAGS_binlog_sync_compression == "zlib") {
+        cntl->set_request_compress_type(brpc::COMPRESS_TYPE_ZLIB);
+    }
+}
+
+bool ReplicateNode::SendAppendEntries(::openmldb::api::AppendEntriesRequest* request,
+                                      ::openmldb::api::AppendEntriesResponse* response) {
+    if (remote_channel_) {
+        return remote_channel_->Send(request, response);
+    }
+    brpc::Controller cntl;
+    InitController(&cntl);
+    return rpc_client_.SendRequest(&::openmldb::api::TabletServer_Stub::AppendEntries, &cntl, request, response);
 }
 
 void ReplicateNode::Stop() {
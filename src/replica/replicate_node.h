@@ -18,6 +18,7 @@
 #define SRC_REPLICA_REPLICATE_NODE_H_
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,7 @@
 #include "log/log_writer.h"
 #include "log/sequential_file.h"
 #include "proto/tablet.pb.h"
+#include "replica/remote_channel.h"
 #include "rpc/rpc_client.h"
 
 namespace openmldb {
@@ -72,10 +74,27 @@ class ReplicateNode {
  private:
     int MatchLogOffsetFromNode();
 
+    // send up to binlog_sync_inflight_cnt batches without waiting and ack them in order
+    int PipelineSyncData(uint64_t log_offset);
+
+    // read the entries after sync_log_offset into request and return true if it should wait for new entries
+    bool ReadBatch(uint64_t log_offset, uint64_t* sync_log_offset,
+                   ::openmldb::api::AppendEntriesRequest* request);
+
+    void UpdateSyncOffset(uint64_t offset);
+
+    void InitController(brpc::Controller* cntl);
+
+    // send by the remote channel if it is a node of a replica cluster and binlog_remote_channel_conn_cnt is set
+    bool SendAppendEntries(::openmldb::api::AppendEntriesRequest* request,
+                           ::openmldb::api::AppendEntriesResponse* response);
+
  private:
     LogReader log_reader_;
     std::vector<::openmldb::api::AppendEntriesRequest> cache_;
     std::string endpoint_;
+    // the endpoint really connected
+    std::string real_endpoint_;
     uint64_t last_sync_offset_;
     bool log_matched_;
     uint32_t tid_;
@@ -90,6 +109,7 @@ class ReplicateNode {
     uint32_t go_back_cnt_;
     std::atomic<bool> rep_node_;
     std::atomic<uint64_t>* follower_offset_;  // max local cluster follower offset
+    std::shared_ptr<RemoteChannel> remote_channel_;
 };
 
 }  // namespace replica
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_RPC_HEDGED_CALL_H_
+#define SRC_RPC_HEDGED_CALL_H_
+
+#include <memory>
+#include <mutex>  // NOLINT
+
+#include "bthread/condition_variable.h"
+#include "bthread/mutex.h"
+#include "common/timer.h"
+#include "rpc/rpc_client.h"
+
+namespace openmldb {
+
+// HedgedCall sends a request to the primary and, if it is not answered in a delay, the same request to the
+// backup, then takes the first successful answer. The call not taken is cancelled, its callback is released
+// once brpc finishes it. A HedgedCall is used by one thread.
+template <class Response>
+class HedgedCall {
+ public:
+    static constexpr int kPrimary = 0;
+    static constexpr int kBackup = 1;
+
+    HedgedCall()
+        : state_(std::make_shared<State>()),
+          callbacks_{nullptr, nullptr},
+          start_us_(::baidu::common::timer::get_micros()) {}
+
+    ~HedgedCall() {
+        for (int idx = 0; idx < kCallCnt; idx++) {
+            if (callbacks_[idx] != nullptr) {
+                Cancel(idx);
+                callbacks_[idx]->UnRef();
+            }
+        }
+    }
+
+    HedgedCall(const HedgedCall&) = delete;
+    HedgedCall& operator=(const HedgedCall&) = delete;
+
+    // the callback of the call idx to send the request with, set the timeout to its controller
+    RpcCallback<Response>* NewCallback(int idx) {
+        auto callback = new Callback(state_, idx, std::make_shared<Response>(), std::make_shared<brpc::Controller>());
+        // one reference is released by brpc and the other by the HedgedCall
+        callback->Ref();
+        callbacks_[idx] = callback;
+        return callback;
+    }
+
+    // the request of the call idx is not sent, so its callback is never run
+    void SetSendFailed(int idx) {
+        {
+            std::lock_guard<bthread::Mutex> lock(state_->mu);
+            state_->done[idx] = true;
+        }
+        failed_[idx] = true;
+        callbacks_[idx]->UnRef();
+    }
+
+    bool IsSent(int idx) const { return callbacks_[idx] != nullptr && !failed_[idx]; }
+
+    // wait until the call idx is done or the time since the start reaches delay_us, return true if it is done
+    bool WaitUntil(int idx, uint64_t delay_us) {
+        uint64_t deadline_us = start_us_ + delay_us;
+        std::unique_lock<bthread::Mutex> lock(state_->mu);
+        while (!state_->done[idx]) {
+            uint64_t now_us = ::baidu::common::timer::get_micros();
+            if (now_us >= deadline_us) {
+                return false;
+            }
+            state_->cv.wait_for(lock, deadline_us - now_us);
+        }
+        return true;
+    }
+
+    // wait until a call sent succeeds or all of them fail, return the call taken or the primary if all fail.
+    // the other call is cancelled
+    int Wait() {
+        int taken = -1;
+        {
+            std::unique_lock<bthread::Mutex> lock(state_->mu);
+            while (true) {
+                bool all_done = true;
+                for (int idx = 0; idx < kCallCnt; idx++) {
+                    if (!IsSent(idx)) {
+                        continue;
+                    }
+                    if (!state_->done[idx]) {
+                        all_done = false;
+                    } else if (IsSucceeded(idx)) {
+                        taken = idx;
+                        break;
+                    }
+                }
+                if (taken >= 0 || all_done) {
+                    break;
+                }
+                state_->cv.wait(lock);
+            }
+        }
+        if (taken < 0) {
+            return kPrimary;
+        }
+        Cancel(kCallCnt - 1 - taken);
+        return taken;
+    }
+
+    const std::shared_ptr<brpc::Controller>& GetController(int idx) const {
+        return callbacks_[idx]->GetController();
+    }
+    const std::shared_ptr<Response>& GetResponse(int idx) const { return callbacks_[idx]->GetResponse(); }
+
+    // the microseconds since the HedgedCall is created
+    uint64_t GetElapsed() const { return ::baidu::common::timer::get_micros() - start_us_; }
+
+ private:
+    static constexpr int kCallCnt = 2;
+
+    struct State {
+        bthread::Mutex mu;
+        bthread::ConditionVariable cv;
+        bool done[kCallCnt] = {false, false};
+    };
+
+    class Callback : public RpcCallback<Response> {
+     public:
+        Callback(const std::shared_ptr<State>& state, int idx, const std::shared_ptr<Response>& response,
+                 const std::shared_ptr<brpc::Controller>& cntl)
+            : RpcCallback<Response>(response, cntl), state_(state), idx_(idx) {}
+
+        void Run() override {
+            {
+                std::lock_guard<bthread::Mutex> lock(state_->mu);
+                state_->done[idx_] = true;
+                state_->cv.notify_all();
+            }
+            RpcCallback<Response>::Run();
+        }
+
+     private:
+        std::shared_ptr<State> state_;
+        int idx_;
+    };
+
+    // with state_->mu held, the call is done
+    bool IsSucceeded(int idx) const {
+        return !GetController(idx)->Failed() && GetResponse(idx)->code() == 0;
+    }
+
+    void Cancel(int idx) {
+        if (IsSent(idx) && !callbacks_[idx]->IsDone()) {
+            brpc::StartCancel(callbacks_[idx]->GetController()->call_id());
+        }
+    }
+
+    std::shared_ptr<State> state_;
+    RpcCallback<Response>* callbacks_[kCallCnt];
+    bool failed_[kCallCnt] = {false, false};
+    uint64_t start_us_;
+};
+
+}  // namespace openmldb
+
+#endif  // SRC_RPC_HEDGED_CALL_H_
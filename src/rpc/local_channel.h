@@ -0,0 +1,109 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_RPC_LOCAL_CHANNEL_H_
+#define SRC_RPC_LOCAL_CHANNEL_H_
+
+#include <google/protobuf/service.h>
+
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "bthread/condition_variable.h"
+#include "bthread/mutex.h"
+
+namespace openmldb {
+
+// LocalServiceRegistry holds the services embedded in this process by endpoint. The rpc clients of a registered
+// endpoint call the service directly rather than through brpc.
+class LocalServiceRegistry {
+ public:
+    static LocalServiceRegistry* GetInstance() {
+        static LocalServiceRegistry registry;
+        return &registry;
+    }
+
+    // the service should outlive the clients created after the registration
+    void Register(const std::string& endpoint, google::protobuf::Service* service) {
+        std::lock_guard<std::mutex> lock(mu_);
+        services_[endpoint] = service;
+    }
+
+    void Unregister(const std::string& endpoint) {
+        std::lock_guard<std::mutex> lock(mu_);
+        services_.erase(endpoint);
+    }
+
+    google::protobuf::Service* Get(const std::string& endpoint) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto iter = services_.find(endpoint);
+        return iter == services_.end() ? nullptr : iter->second;
+    }
+
+ private:
+    std::mutex mu_;
+    std::map<std::string, google::protobuf::Service*> services_;
+};
+
+// LocalChannel runs the method of the service in the calling thread. The request and the response are passed
+// without serialization and the attachments of the controller are shared with the service, so a call costs a
+// function call. The timeout and the retry of the controller are not applied.
+class LocalChannel : public google::protobuf::RpcChannel {
+ public:
+    explicit LocalChannel(google::protobuf::Service* service) : service_(service) {}
+
+    void CallMethod(const google::protobuf::MethodDescriptor* method, google::protobuf::RpcController* controller,
+                    const google::protobuf::Message* request, google::protobuf::Message* response,
+                    google::protobuf::Closure* done) override {
+        if (done != nullptr) {
+            service_->CallMethod(method, controller, request, response, done);
+            return;
+        }
+        // a synchronous call returns once the service runs done, which may be in another thread
+        SyncClosure sync;
+        service_->CallMethod(method, controller, request, response, &sync);
+        sync.Wait();
+    }
+
+ private:
+    class SyncClosure : public google::protobuf::Closure {
+     public:
+        void Run() override {
+            std::lock_guard<bthread::Mutex> lock(mu_);
+            done_ = true;
+            cv_.notify_all();
+        }
+
+        void Wait() {
+            std::unique_lock<bthread::Mutex> lock(mu_);
+            while (!done_) {
+                cv_.wait(lock);
+            }
+        }
+
+     private:
+        bthread::Mutex mu_;
+        bthread::ConditionVariable cv_;
+        bool done_ = false;
+    };
+
+    google::protobuf::Service* service_;
+};
+
+}  // namespace openmldb
+
+#endif  // SRC_RPC_LOCAL_CHANNEL_H_
@@ -37,6 +37,7 @@
 #include <brpc/retry_policy.h>
 #include <gflags/gflags.h>
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT
@@ -44,6 +45,7 @@
 
 #include "base/glog_wapper.h"  // NOLINT
 #include "proto/tablet.pb.h"
+#include "rpc/local_channel.h"
 
 DECLARE_int32(request_sleep_time);
 
@@ -83,13 +85,25 @@ class RpcClient {
         delete stub_;
     }
 
+    // the clients of the same endpoint in different groups don't share the connection, set before Init
+    void SetConnectionGroup(const std::string& group) { connection_group_ = group; }
+
     int Init() {
-        channel_ = new brpc::Channel();
+        // the service embedded in this process is called directly
+        auto service = LocalServiceRegistry::GetInstance()->Get(endpoint_);
+        if (service != nullptr && service->GetDescriptor() == T::descriptor()) {
+            channel_ = new LocalChannel(service);
+            stub_ = new T(channel_);
+            return 0;
+        }
+        auto channel = new brpc::Channel();
+        channel_ = channel;
         brpc::ChannelOptions options;
         if (use_sleep_policy_) {
             options.retry_policy = &sleep_retry_policy;
         }
-        if (channel_->Init(endpoint_.c_str(), "", &options) != 0) {
+        options.connection_group = connection_group_;
+        if (channel->Init(endpoint_.c_str(), "", &options) != 0) {
             return -1;
         }
         stub_ = new T(channel_);
@@ -186,9 +200,10 @@ class RpcClient {
  private:
     std::string endpoint_;
     bool use_sleep_policy_;
+    std::string connection_group_;
     uint64_t log_id_;
     T* stub_;
-    brpc::Channel* channel_;
+    google::protobuf::RpcChannel* channel_;
 };
 
 template <class Response>
@@ -200,10 +215,16 @@ class RpcCallback : public google::protobuf::Closure {
     ~RpcCallback() {}
 
     void Run() override {
+        if (on_done_) {
+            on_done_();
+        }
         is_done_.store(true, std::memory_order_release);
         UnRef();
     }
 
+    // called once the response is back, before IsDone turns true. set it before the request is sent
+    void SetOnDone(std::function<void()> on_done) { on_done_ = std::move(on_done); }
+
     inline const std::shared_ptr<Response>& GetResponse() const { return response_; }
 
     inline const std::shared_ptr<brpc::Controller>& GetController() const { return cntl_; }
@@ -223,6 +244,7 @@ class RpcCallback : public google::protobuf::Closure {
     std::shared_ptr<brpc::Controller> cntl_;
     std::atomic<bool> is_done_;
     std::atomic<uint32_t> ref_count_;
+    std::function<void()> on_done_;
 };
 
 }  // namespace openmldb
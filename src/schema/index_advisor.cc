@@ -0,0 +1,178 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "schema/index_advisor.h"
+
+#include <algorithm>
+
+#include "schema/index_util.h"
+
+namespace openmldb {
+namespace schema {
+
+namespace {
+
+// the rows kept by a ttl are those within abs_ttl or within the latest lat_ttl, a bound is unset if it keeps
+// nothing by itself. 0 is unbounded as in TTLSt
+struct TTLBound {
+    bool has_abs = false;
+    uint64_t abs_ttl = 0;
+    bool has_lat = false;
+    uint64_t lat_ttl = 0;
+};
+
+TTLBound ToBound(const ::openmldb::common::TTLSt& ttl) {
+    TTLBound bound;
+    switch (ttl.ttl_type()) {
+        case ::openmldb::type::TTLType::kAbsoluteTime:
+            bound.has_abs = true;
+            bound.abs_ttl = ttl.abs_ttl();
+            break;
+        case ::openmldb::type::TTLType::kLatestTime:
+            bound.has_lat = true;
+            bound.lat_ttl = ttl.lat_ttl();
+            break;
+        case ::openmldb::type::TTLType::kAbsAndLat:
+            bound.has_abs = true;
+            bound.abs_ttl = ttl.abs_ttl();
+            bound.has_lat = true;
+            bound.lat_ttl = ttl.lat_ttl();
+            break;
+        case ::openmldb::type::TTLType::kAbsOrLat:
+            // the rows within both bounds are kept, the bounded one of them covers the rows
+            if (ttl.abs_ttl() == 0) {
+                bound.has_lat = true;
+                bound.lat_ttl = ttl.lat_ttl();
+            } else {
+                bound.has_abs = true;
+                bound.abs_ttl = ttl.abs_ttl();
+            }
+            break;
+        default:
+            break;
+    }
+    return bound;
+}
+
+uint64_t MergeTTLValue(uint64_t a, uint64_t b) { return a == 0 || b == 0 ? 0 : std::max(a, b); }
+
+bool IsSameTTL(const ::openmldb::common::TTLSt& a, const ::openmldb::common::TTLSt& b) {
+    return a.ttl_type() == b.ttl_type() && a.abs_ttl() == b.abs_ttl() && a.lat_ttl() == b.lat_ttl();
+}
+
+}  // namespace
+
+::openmldb::common::TTLSt IndexAdvisor::MergeTTL(const ::openmldb::common::TTLSt& a,
+                                                 const ::openmldb::common::TTLSt& b) {
+    ::openmldb::common::TTLSt ttl;
+    if (a.ttl_type() == b.ttl_type()) {
+        ttl.set_ttl_type(a.ttl_type());
+        ttl.set_abs_ttl(MergeTTLValue(a.abs_ttl(), b.abs_ttl()));
+        ttl.set_lat_ttl(MergeTTLValue(a.lat_ttl(), b.lat_ttl()));
+        return ttl;
+    }
+    TTLBound bound_a = ToBound(a);
+    TTLBound bound_b = ToBound(b);
+    TTLBound bound;
+    bound.has_abs = bound_a.has_abs || bound_b.has_abs;
+    if (bound_a.has_abs && bound_b.has_abs) {
+        bound.abs_ttl = MergeTTLValue(bound_a.abs_ttl, bound_b.abs_ttl);
+    } else {
+        bound.abs_ttl = bound_a.has_abs ? bound_a.abs_ttl : bound_b.abs_ttl;
+    }
+    bound.has_lat = bound_a.has_lat || bound_b.has_lat;
+    if (bound_a.has_lat && bound_b.has_lat) {
+        bound.lat_ttl = MergeTTLValue(bound_a.lat_ttl, bound_b.lat_ttl);
+    } else {
+        bound.lat_ttl = bound_a.has_lat ? bound_a.lat_ttl : bound_b.lat_ttl;
+    }
+    if (bound.has_abs && bound.has_lat) {
+        // the row is expired only if it is out of both bounds
+        ttl.set_ttl_type(::openmldb::type::TTLType::kAbsAndLat);
+    } else if (bound.has_lat) {
+        ttl.set_ttl_type(::openmldb::type::TTLType::kLatestTime);
+    } else {
+        ttl.set_ttl_type(::openmldb::type::TTLType::kAbsoluteTime);
+    }
+    ttl.set_abs_ttl(bound.abs_ttl);
+    ttl.set_lat_ttl(bound.lat_ttl);
+    return ttl;
+}
+
+void IndexAdvisor::AddRequired(const std::string& table,
+                               const std::vector<::openmldb::common::ColumnKey>& column_keys) {
+    auto& indexes = required_[table];
+    for (const auto& column_key : column_keys) {
+        std::string id = IndexUtil::GetIDStr(column_key);
+        auto it = indexes.find(id);
+        if (it == indexes.end()) {
+            auto& index = indexes[id];
+            index.CopyFrom(column_key);
+            index.clear_index_name();
+        } else {
+            it->second.mutable_ttl()->CopyFrom(MergeTTL(it->second.ttl(), column_key.ttl()));
+        }
+    }
+}
+
+void IndexAdvisor::AddQueryCnt(const std::string& table, const std::string& index_name, uint64_t cnt) {
+    query_cnts_[table][index_name] += cnt;
+}
+
+IndexAdvice IndexAdvisor::Advise(const ::openmldb::nameserver::TableInfo& table) const {
+    IndexAdvice advice;
+    static const std::map<std::string, ::openmldb::common::ColumnKey> empty_required;
+    static const std::map<std::string, uint64_t> empty_query_cnts;
+    auto required_it = required_.find(table.name());
+    const auto& required = required_it != required_.end() ? required_it->second : empty_required;
+    bool usage_known = unknown_tables_.count(table.name()) == 0;
+    auto cnt_it = query_cnts_.find(table.name());
+    const auto& query_cnts = cnt_it != query_cnts_.end() ? cnt_it->second : empty_query_cnts;
+    // the required indexes already served by a kept index
+    std::set<std::string> served_ids;
+    for (int i = 0; i < table.column_key_size(); i++) {
+        const auto& column_key = table.column_key(i);
+        if (column_key.flag() != 0) {
+            continue;
+        }
+        std::string id = IndexUtil::GetIDStr(column_key);
+        auto iter = required.find(id);
+        // the duplicates of a served index are not required any more
+        bool serving = iter != required.end() && served_ids.insert(id).second;
+        if (serving) {
+            if (!IsSameTTL(column_key.ttl(), iter->second.ttl())) {
+                advice.update_indexes.push_back(column_key);
+                advice.update_indexes.back().mutable_ttl()->CopyFrom(iter->second.ttl());
+            }
+            continue;
+        }
+        auto cnt_iter = query_cnts.find(column_key.index_name());
+        bool read = cnt_iter != query_cnts.end() && cnt_iter->second > 0;
+        if (i == 0 || read || !usage_known) {
+            continue;
+        }
+        advice.drop_indexes.push_back(column_key.index_name());
+    }
+    for (const auto& kv : required) {
+        if (served_ids.count(kv.first) == 0) {
+            advice.add_indexes.push_back(kv.second);
+        }
+    }
+    return advice;
+}
+
+}  // namespace schema
+}  // namespace openmldb
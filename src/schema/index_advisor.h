@@ -0,0 +1,75 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SCHEMA_INDEX_ADVISOR_H_
+#define SRC_SCHEMA_INDEX_ADVISOR_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "proto/common.pb.h"
+#include "proto/name_server.pb.h"
+
+namespace openmldb {
+namespace schema {
+
+// the changes of the indexes of one table proposed by IndexAdvisor
+struct IndexAdvice {
+    // the indexes required but missing, with no index name
+    std::vector<::openmldb::common::ColumnKey> add_indexes;
+    // the existing indexes with the ttl changed to the one required
+    std::vector<::openmldb::common::ColumnKey> update_indexes;
+    std::vector<std::string> drop_indexes;
+
+    bool IsEmpty() const { return add_indexes.empty() && update_indexes.empty() && drop_indexes.empty(); }
+};
+
+// IndexAdvisor proposes the smallest index set of the tables covering the indexes required by the deployments.
+// The indexes of the same keys and ts column are merged into one whose ttl keeps the rows kept by any of them.
+// An existing index is dropped only if no deployment requires it and it is never read on any tablet, as the
+// requests and queries not from the deployments may read it too.
+class IndexAdvisor {
+ public:
+    // the ttl keeping the rows kept by either a or b
+    static ::openmldb::common::TTLSt MergeTTL(const ::openmldb::common::TTLSt& a,
+                                              const ::openmldb::common::TTLSt& b);
+
+    // add the indexes of table required by one deployment
+    void AddRequired(const std::string& table, const std::vector<::openmldb::common::ColumnKey>& column_keys);
+
+    // add the read count of the index of table on one tablet
+    void AddQueryCnt(const std::string& table, const std::string& index_name, uint64_t cnt);
+
+    // the usage of the indexes of table is not fully known, e.g. a tablet is not reached or the indexes of a
+    // deployment are not extracted, no index of it is dropped then
+    void SetUsageUnknown(const std::string& table) { unknown_tables_.insert(table); }
+
+    // the first index is always kept as it is the pk index of the table
+    IndexAdvice Advise(const ::openmldb::nameserver::TableInfo& table) const;
+
+ private:
+    // table -> index id -> the merged index
+    std::map<std::string, std::map<std::string, ::openmldb::common::ColumnKey>> required_;
+    // table -> index name -> read count
+    std::map<std::string, std::map<std::string, uint64_t>> query_cnts_;
+    std::set<std::string> unknown_tables_;
+};
+
+}  // namespace schema
+}  // namespace openmldb
+#endif  // SRC_SCHEMA_INDEX_ADVISOR_H_
@@ -14,7 +14,11 @@
  * limitations under the License.
  */
 
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "schema/index_advisor.h"
 #include "schema/index_util.h"
 
 namespace openmldb {
@@ -41,6 +45,71 @@ TEST_F(IndexTest, CheckUnique) {
     ASSERT_FALSE(IndexUtil::CheckUnique(indexs).OK());
 }
 
+static ::openmldb::common::TTLSt MakeTTL(::openmldb::type::TTLType type, uint64_t abs_ttl, uint64_t lat_ttl) {
+    ::openmldb::common::TTLSt ttl;
+    ttl.set_ttl_type(type);
+    ttl.set_abs_ttl(abs_ttl);
+    ttl.set_lat_ttl(lat_ttl);
+    return ttl;
+}
+
+static ::openmldb::common::ColumnKey MakeIndex(const std::string& name, const std::string& col,
+                                               const std::string& ts, const ::openmldb::common::TTLSt& ttl) {
+    ::openmldb::common::ColumnKey index;
+    index.set_index_name(name);
+    index.add_col_name(col);
+    index.set_ts_name(ts);
+    index.mutable_ttl()->CopyFrom(ttl);
+    return index;
+}
+
+TEST_F(IndexTest, MergeTTL) {
+    using ::openmldb::type::TTLType;
+    auto ttl = IndexAdvisor::MergeTTL(MakeTTL(TTLType::kAbsoluteTime, 10, 0), MakeTTL(TTLType::kAbsoluteTime, 20, 0));
+    ASSERT_EQ(TTLType::kAbsoluteTime, ttl.ttl_type());
+    ASSERT_EQ(20u, ttl.abs_ttl());
+    // 0 is unbounded
+    ttl = IndexAdvisor::MergeTTL(MakeTTL(TTLType::kLatestTime, 0, 0), MakeTTL(TTLType::kLatestTime, 0, 5));
+    ASSERT_EQ(0u, ttl.lat_ttl());
+    ttl = IndexAdvisor::MergeTTL(MakeTTL(TTLType::kAbsoluteTime, 10, 0), MakeTTL(TTLType::kLatestTime, 0, 5));
+    ASSERT_EQ(TTLType::kAbsAndLat, ttl.ttl_type());
+    ASSERT_EQ(10u, ttl.abs_ttl());
+    ASSERT_EQ(5u, ttl.lat_ttl());
+    ttl = IndexAdvisor::MergeTTL(MakeTTL(TTLType::kAbsOrLat, 10, 3), MakeTTL(TTLType::kAbsoluteTime, 5, 0));
+    ASSERT_EQ(TTLType::kAbsoluteTime, ttl.ttl_type());
+    ASSERT_EQ(10u, ttl.abs_ttl());
+}
+
+TEST_F(IndexTest, IndexAdvisor) {
+    using ::openmldb::type::TTLType;
+    ::openmldb::nameserver::TableInfo table;
+    table.set_name("t1");
+    table.add_column_key()->CopyFrom(MakeIndex("pk", "c1", "ts", MakeTTL(TTLType::kAbsoluteTime, 0, 0)));
+    table.add_column_key()->CopyFrom(MakeIndex("i1", "c2", "ts", MakeTTL(TTLType::kAbsoluteTime, 100, 0)));
+    // the duplicate of i1
+    table.add_column_key()->CopyFrom(MakeIndex("i2", "c2", "ts", MakeTTL(TTLType::kAbsoluteTime, 100, 0)));
+    table.add_column_key()->CopyFrom(MakeIndex("i3", "c3", "ts", MakeTTL(TTLType::kLatestTime, 0, 1)));
+    table.add_column_key()->CopyFrom(MakeIndex("i4", "c4", "ts", MakeTTL(TTLType::kLatestTime, 0, 1)));
+    IndexAdvisor advisor;
+    advisor.AddRequired("t1", {MakeIndex("", "c2", "ts", MakeTTL(TTLType::kAbsoluteTime, 30, 0)),
+                               MakeIndex("", "c5", "ts", MakeTTL(TTLType::kLatestTime, 0, 2))});
+    advisor.AddRequired("t1", {MakeIndex("", "c2", "ts", MakeTTL(TTLType::kAbsoluteTime, 60, 0))});
+    advisor.AddQueryCnt("t1", "i4", 3);
+    auto advice = advisor.Advise(table);
+    ASSERT_EQ(1u, advice.add_indexes.size());
+    ASSERT_EQ("c5", advice.add_indexes[0].col_name(0));
+    ASSERT_TRUE(advice.add_indexes[0].index_name().empty());
+    ASSERT_EQ(1u, advice.update_indexes.size());
+    ASSERT_EQ("i1", advice.update_indexes[0].index_name());
+    ASSERT_EQ(60u, advice.update_indexes[0].ttl().abs_ttl());
+    // pk is the first index and i4 is read
+    ASSERT_EQ(std::vector<std::string>({"i2", "i3"}), advice.drop_indexes);
+    advisor.SetUsageUnknown("t1");
+    advice = advisor.Advise(table);
+    ASSERT_TRUE(advice.drop_indexes.empty());
+    ASSERT_EQ(1u, advice.add_indexes.size());
+}
+
 }  // namespace schema
 }  // namespace openmldb
 
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/async_inserter.h"
+
+#include <utility>
+
+#include "base/status.h"
+#include "brpc/channel.h"
+#include "client/tablet_client.h"
+#include "common/timer.h"
+#include "glog/logging.h"
+
+namespace openmldb {
+namespace sdk {
+
+class AsyncInserter::BatchPutClosure : public google::protobuf::Closure {
+ public:
+    BatchPutClosure(AsyncInserter* inserter, const std::string& name, std::unique_ptr<Batch> batch)
+        : inserter_(inserter), name_(name), batch_(std::move(batch)), cntl_(), response_() {}
+
+    void Run() override {
+        inserter_->OnBatchDone(name_, std::move(batch_), cntl_, response_);
+        delete this;
+    }
+
+    brpc::Controller* GetController() { return &cntl_; }
+    ::openmldb::api::BatchPutResponse* GetResponse() { return &response_; }
+    const Batch& GetBatch() const { return *batch_; }
+
+ private:
+    AsyncInserter* inserter_;
+    std::string name_;
+    std::unique_ptr<Batch> batch_;
+    brpc::Controller cntl_;
+    ::openmldb::api::BatchPutResponse response_;
+};
+
+AsyncInserter::AsyncInserter(DBSDK* cluster_sdk, std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
+                             const AsyncInsertOptions& options)
+    : cluster_sdk_(cluster_sdk),
+      table_info_(table_info),
+      options_(options),
+      mu_(),
+      cv_(),
+      queues_(),
+      total_inflight_(0),
+      running_(false),
+      pool_(1) {}
+
+AsyncInserter::~AsyncInserter() {
+    running_.store(false, std::memory_order_release);
+    pool_.Stop(true);
+    WaitAll();
+}
+
+bool AsyncInserter::Init() {
+    if (cluster_sdk_ == nullptr || !table_info_) {
+        return false;
+    }
+    if (options_.max_batch_rows == 0) {
+        options_.max_batch_rows = 1;
+    }
+    if (options_.max_inflight_per_tablet == 0) {
+        options_.max_inflight_per_tablet = 1;
+    }
+    running_.store(true, std::memory_order_release);
+    if (options_.flush_interval_ms > 0) {
+        pool_.DelayTask(options_.flush_interval_ms, [this] { FlushExpired(); });
+    }
+    return true;
+}
+
+std::future<hybridse::sdk::Status> AsyncInserter::Insert(const std::shared_ptr<SQLInsertRow>& row) {
+    return Insert(std::vector<std::shared_ptr<SQLInsertRow>>{row});
+}
+
+std::future<hybridse::sdk::Status> AsyncInserter::Insert(const std::shared_ptr<SQLInsertRows>& rows) {
+    std::vector<std::shared_ptr<SQLInsertRow>> row_vec;
+    if (rows) {
+        for (uint32_t i = 0; i < rows->GetCnt(); i++) {
+            row_vec.push_back(rows->GetRow(i));
+        }
+    }
+    return Insert(row_vec);
+}
+
+std::future<hybridse::sdk::Status> AsyncInserter::Insert(const std::vector<std::shared_ptr<SQLInsertRow>>& rows) {
+    auto tracker = std::make_shared<InsertTracker>();
+    auto future = tracker->promise.get_future();
+    if (!running_.load(std::memory_order_acquire)) {
+        tracker->promise.set_value(hybridse::sdk::Status(-1, "async inserter is not running"));
+        return future;
+    }
+    uint32_t part_cnt = 0;
+    for (const auto& row : rows) {
+        if (!row || !row->IsComplete()) {
+            tracker->promise.set_value(hybridse::sdk::Status(-1, "row is not complete"));
+            return future;
+        }
+        part_cnt += row->GetDimensions().size();
+    }
+    if (part_cnt == 0) {
+        tracker->promise.set_value(hybridse::sdk::Status());
+        return future;
+    }
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets;
+    if (!cluster_sdk_->GetTablet(table_info_->db(), table_info_->name(), &tablets) || tablets.empty()) {
+        tracker->promise.set_value(
+            hybridse::sdk::Status(-1, "fail to get table " + table_info_->name() + " tablet"));
+        return future;
+    }
+    tracker->remain_cnt.store(part_cnt, std::memory_order_relaxed);
+    uint64_t cur_ts = ::baidu::common::timer::get_micros() / 1000;
+    std::vector<std::pair<std::string, std::unique_ptr<Batch>>> to_send;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (const auto& row : rows) {
+            for (const auto& kv : row->GetDimensions()) {
+                uint32_t pid = kv.first;
+                std::shared_ptr<::openmldb::client::TabletClient> client;
+                if (pid < tablets.size() && tablets[pid]) {
+                    client = tablets[pid]->GetClient();
+                }
+                if (!client) {
+                    FinishPart(tracker, -1, "fail to get tablet client. pid " + std::to_string(pid));
+                    continue;
+                }
+                const std::string& name = tablets[pid]->GetName();
+                auto& queue = queues_[name];
+                queue.client = client;
+                if (!queue.building) {
+                    queue.building.reset(new Batch());
+                    queue.building->create_time = cur_ts;
+                }
+                Batch* batch = queue.building.get();
+                auto request = batch->request.add_requests();
+                request->set_tid(table_info_->tid());
+                request->set_pid(pid);
+                request->set_time(cur_ts);
+                request->set_value(row->GetRow());
+                request->set_format_version(1);
+                batch->bytes += row->GetRow().size();
+                for (const auto& dim : kv.second) {
+                    auto d = request->add_dimensions();
+                    d->set_key(dim.first);
+                    d->set_idx(dim.second);
+                    batch->bytes += dim.first.size();
+                }
+                batch->trackers.push_back(tracker);
+                if (batch->request.requests_size() >= static_cast<int>(options_.max_batch_rows) ||
+                    batch->bytes >= options_.max_batch_bytes) {
+                    SealBatch(&queue);
+                    TakeSendable(name, &queue, &to_send);
+                }
+            }
+        }
+        // without the flush interval the rows of one insert are sent at once
+        if (options_.flush_interval_ms == 0) {
+            for (auto& kv : queues_) {
+                SealBatch(&kv.second);
+                TakeSendable(kv.first, &kv.second, &to_send);
+            }
+        }
+    }
+    SendBatches(&to_send);
+    return future;
+}
+
+void AsyncInserter::Flush() {
+    std::vector<std::pair<std::string, std::unique_ptr<Batch>>> to_send;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (auto& kv : queues_) {
+            SealBatch(&kv.second);
+            TakeSendable(kv.first, &kv.second, &to_send);
+        }
+    }
+    SendBatches(&to_send);
+}
+
+void AsyncInserter::WaitAll() {
+    Flush();
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this] {
+        if (total_inflight_ > 0) {
+            return false;
+        }
+        for (const auto& kv : queues_) {
+            if (!kv.second.ready.empty()) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+void AsyncInserter::FlushExpired() {
+    uint64_t cur_ts = ::baidu::common::timer::get_micros() / 1000;
+    std::vector<std::pair<std::string, std::unique_ptr<Batch>>> to_send;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (auto& kv : queues_) {
+            auto& queue = kv.second;
+            if (queue.building && queue.building->create_time + options_.flush_interval_ms <= cur_ts) {
+                SealBatch(&queue);
+            }
+            TakeSendable(kv.first, &queue, &to_send);
+        }
+    }
+    SendBatches(&to_send);
+    if (running_.load(std::memory_order_acquire)) {
+        pool_.DelayTask(options_.flush_interval_ms, [this] { FlushExpired(); });
+    }
+}
+
+void AsyncInserter::SealBatch(TabletQueue* queue) {
+    if (queue->building) {
+        queue->ready.push_back(std::move(queue->building));
+    }
+}
+
+void AsyncInserter::TakeSendable(const std::string& name, TabletQueue* queue,
+                                 std::vector<std::pair<std::string, std::unique_ptr<Batch>>>* to_send) {
+    while (queue->inflight < options_.max_inflight_per_tablet && !queue->ready.empty()) {
+        auto batch = std::move(queue->ready.front());
+        queue->ready.pop_front();
+        batch->client = queue->client;
+        queue->inflight++;
+        total_inflight_++;
+        to_send->emplace_back(name, std::move(batch));
+    }
+}
+
+void AsyncInserter::SendBatches(std::vector<std::pair<std::string, std::unique_ptr<Batch>>>* to_send) {
+    for (auto& kv : *to_send) {
+        auto client = kv.second->client;
+        auto closure = new BatchPutClosure(this, kv.first, std::move(kv.second));
+        closure->GetController()->set_timeout_ms(options_.request_timeout_ms);
+        if (!client->AsyncBatchPut(closure->GetBatch().request, closure->GetController(), closure->GetResponse(),
+                                   closure)) {
+            closure->GetController()->SetFailed("fail to send batch put request");
+            closure->Run();
+        }
+    }
+    to_send->clear();
+}
+
+void AsyncInserter::OnBatchDone(const std::string& name, std::unique_ptr<Batch> batch, const brpc::Controller& cntl,
+                                const ::openmldb::api::BatchPutResponse& response) {
+    for (size_t i = 0; i < batch->trackers.size(); i++) {
+        if (cntl.Failed()) {
+            FinishPart(batch->trackers[i], hybridse::common::kRpcError,
+                       "request " + name + " error, " + cntl.ErrorText());
+        } else if (response.code() != ::openmldb::base::kOk) {
+            FinishPart(batch->trackers[i], response.code(), "request " + name + " error, " + response.msg());
+        } else if (i >= static_cast<size_t>(response.responses_size())) {
+            FinishPart(batch->trackers[i], hybridse::common::kRpcError, "request " + name + " error, no response");
+        } else {
+            const auto& put_response = response.responses(i);
+            FinishPart(batch->trackers[i], put_response.code(), put_response.msg());
+        }
+    }
+    if (cntl.Failed()) {
+        LOG(WARNING) << "fail to batch put " << batch->trackers.size() << " rows to " << name << ", "
+                     << cntl.ErrorText();
+    }
+    std::vector<std::pair<std::string, std::unique_ptr<Batch>>> to_send;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto& queue = queues_[name];
+        queue.inflight--;
+        total_inflight_--;
+        TakeSendable(name, &queue, &to_send);
+        cv_.notify_all();
+    }
+    SendBatches(&to_send);
+}
+
+void AsyncInserter::FinishPart(const std::shared_ptr<InsertTracker>& tracker, int code, const std::string& msg) {
+    if (code != ::openmldb::base::kOk) {
+        std::lock_guard<std::mutex> lock(tracker->mu);
+        if (tracker->status.IsOK()) {
+            tracker->status = hybridse::sdk::Status(code, msg);
+        }
+    }
+    if (tracker->remain_cnt.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(tracker->mu);
+        tracker->promise.set_value(tracker->status);
+    }
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_ASYNC_INSERTER_H_
+#define SRC_SDK_ASYNC_INSERTER_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/thread_pool.h"
+#include "proto/name_server.pb.h"
+#include "proto/tablet.pb.h"
+#include "sdk/base.h"
+#include "sdk/db_sdk.h"
+#include "sdk/sql_insert_row.h"
+
+namespace openmldb {
+namespace sdk {
+
+struct AsyncInsertOptions {
+    // a batch of one tablet is sent once it has max_batch_rows rows or max_batch_bytes bytes
+    uint32_t max_batch_rows = 256;
+    uint32_t max_batch_bytes = 1024 * 1024;
+    // the rows waited longer than it are sent even if the batch is not full
+    uint32_t flush_interval_ms = 5;
+    // the count of batch requests on the fly for one tablet, the full batches beyond it wait in queue
+    uint32_t max_inflight_per_tablet = 4;
+    int64_t request_timeout_ms = 10000;
+};
+
+// AsyncInserter groups the rows of one table by the leader tablet of their partitions and writes them with
+// pipelined BatchPut requests. Every Insert returns a future which is set once all partitions of its rows
+// are acked or any of them fails.
+class AsyncInserter {
+ public:
+    AsyncInserter(DBSDK* cluster_sdk, std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
+                  const AsyncInsertOptions& options);
+
+    // the pending rows are sent and the requests on the fly are waited
+    ~AsyncInserter();
+
+    bool Init();
+
+    std::future<hybridse::sdk::Status> Insert(const std::shared_ptr<SQLInsertRow>& row);
+
+    std::future<hybridse::sdk::Status> Insert(const std::shared_ptr<SQLInsertRows>& rows);
+
+    // send the pending rows of all tablets without waiting for the flush interval
+    void Flush();
+
+    // flush and wait until no request is on the fly
+    void WaitAll();
+
+ private:
+    struct InsertTracker {
+        std::promise<hybridse::sdk::Status> promise;
+        std::atomic<uint32_t> remain_cnt{0};
+        std::mutex mu;
+        hybridse::sdk::Status status;
+    };
+
+    struct Batch {
+        ::openmldb::api::BatchPutRequest request;
+        // the tracker of each put request
+        std::vector<std::shared_ptr<InsertTracker>> trackers;
+        std::shared_ptr<::openmldb::client::TabletClient> client;
+        uint64_t bytes = 0;
+        uint64_t create_time = 0;
+    };
+
+    struct TabletQueue {
+        std::shared_ptr<::openmldb::client::TabletClient> client;
+        std::unique_ptr<Batch> building;
+        std::deque<std::unique_ptr<Batch>> ready;
+        uint32_t inflight = 0;
+    };
+
+    class BatchPutClosure;
+
+    std::future<hybridse::sdk::Status> Insert(const std::vector<std::shared_ptr<SQLInsertRow>>& rows);
+
+    // mu_ should be held
+    void SealBatch(TabletQueue* queue);
+    // mu_ should be held, the batches to send are moved out and sent without the lock
+    void TakeSendable(const std::string& name, TabletQueue* queue,
+                      std::vector<std::pair<std::string, std::unique_ptr<Batch>>>* to_send);
+    void SendBatches(std::vector<std::pair<std::string, std::unique_ptr<Batch>>>* to_send);
+    void OnBatchDone(const std::string& name, std::unique_ptr<Batch> batch, const brpc::Controller& cntl,
+                     const ::openmldb::api::BatchPutResponse& response);
+    void FlushExpired();
+
+    static void FinishPart(const std::shared_ptr<InsertTracker>& tracker, int code, const std::string& msg);
+
+    DBSDK* cluster_sdk_;
+    std::shared_ptr<::openmldb::nameserver::TableInfo> table_info_;
+    AsyncInsertOptions options_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    // tablet name -> the batches of the tablet
+    std::map<std::string, TabletQueue> queues_;
+    uint32_t total_inflight_;
+    std::atomic<bool> running_;
+    ::baidu::common::ThreadPool pool_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_ASYNC_INSERTER_H_
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/async_procedure_caller.h"
+
+#include <utility>
+
+#include "base/status.h"
+#include "brpc/channel.h"
+#include "client/tablet_client.h"
+#include "codec/fe_schema_codec.h"
+#include "common/timer.h"
+#include "glog/logging.h"
+#include "sdk/batch_request_result_set_sql.h"
+#include "sdk/result_set_sql.h"
+
+namespace openmldb {
+namespace sdk {
+
+class AsyncProcedureCaller::BatchCallClosure : public google::protobuf::Closure {
+ public:
+    BatchCallClosure(AsyncProcedureCaller* caller, std::unique_ptr<Batch> batch)
+        : caller_(caller),
+          batch_(std::move(batch)),
+          cntl_(std::make_shared<brpc::Controller>()),
+          response_(std::make_shared<::openmldb::api::SQLBatchRequestQueryResponse>()) {}
+
+    void Run() override {
+        caller_->OnBatchDone(std::move(batch_), cntl_, response_);
+        delete this;
+    }
+
+    brpc::Controller* GetController() { return cntl_.get(); }
+    ::openmldb::api::SQLBatchRequestQueryResponse* GetResponse() { return response_.get(); }
+    const Batch& GetBatch() const { return *batch_; }
+
+ private:
+    AsyncProcedureCaller* caller_;
+    std::unique_ptr<Batch> batch_;
+    // the result sets given to the callbacks refer to the response attachment
+    std::shared_ptr<brpc::Controller> cntl_;
+    std::shared_ptr<::openmldb::api::SQLBatchRequestQueryResponse> response_;
+};
+
+AsyncProcedureCaller::AsyncProcedureCaller(DBSDK* cluster_sdk, std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info,
+                                           const AsyncCallOptions& options)
+    : cluster_sdk_(cluster_sdk),
+      sp_info_(sp_info),
+      options_(options),
+      input_schema_(),
+      common_column_indices_(),
+      mu_(),
+      cv_(),
+      building_(),
+      ready_(),
+      inflight_(0),
+      running_(false),
+      pool_(1) {}
+
+AsyncProcedureCaller::~AsyncProcedureCaller() {
+    running_.store(false, std::memory_order_release);
+    pool_.Stop(true);
+    WaitAll();
+}
+
+bool AsyncProcedureCaller::Init() {
+    if (cluster_sdk_ == nullptr || !sp_info_) {
+        return false;
+    }
+    // the input schema is owned by sp_info_
+    input_schema_ = std::shared_ptr<hybridse::sdk::Schema>(
+        sp_info_, const_cast<hybridse::sdk::Schema*>(&sp_info_->GetInputSchema()));
+    common_column_indices_ = std::make_shared<ColumnIndicesSet>(input_schema_);
+    for (int32_t i = 0; i < input_schema_->GetColumnCnt(); i++) {
+        if (input_schema_->IsConstant(i)) {
+            common_column_indices_->AddCommonColumnIdx(i);
+        }
+    }
+    if (!common_column_indices_->Empty() || options_.max_batch_rows == 0) {
+        options_.max_batch_rows = 1;
+    }
+    if (options_.max_inflight == 0) {
+        options_.max_inflight = 1;
+    }
+    running_.store(true, std::memory_order_release);
+    if (options_.flush_interval_ms > 0 && options_.max_batch_rows > 1) {
+        pool_.DelayTask(options_.flush_interval_ms, [this] { FlushExpired(); });
+    }
+    return true;
+}
+
+void AsyncProcedureCaller::Call(const std::shared_ptr<SQLRequestRow>& row, ProcedureCallback callback) {
+    if (!running_.load(std::memory_order_acquire)) {
+        callback(hybridse::sdk::Status(-1, "async procedure caller is not running"), {});
+        return;
+    }
+    if (!row || !row->OK()) {
+        callback(hybridse::sdk::Status(-1, "make sure the request row is built before execute sql"), {});
+        return;
+    }
+    bool failed = false;
+    std::vector<std::unique_ptr<Batch>> to_send;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!building_) {
+            building_.reset(new Batch());
+            building_->rows = std::make_shared<SQLRequestRowBatch>(input_schema_, common_column_indices_);
+            building_->create_time = ::baidu::common::timer::get_micros() / 1000;
+        }
+        if (!building_->rows->AddRow(row)) {
+            failed = true;
+        } else {
+            building_->callbacks.push_back(std::move(callback));
+        }
+        if (building_->callbacks.size() >= options_.max_batch_rows || options_.flush_interval_ms == 0) {
+            SealBatch();
+            TakeSendable(&to_send);
+        }
+    }
+    if (failed) {
+        callback(hybridse::sdk::Status(-1, "fail to add the request row"), {});
+    }
+    SendBatches(&to_send);
+}
+
+void AsyncProcedureCaller::Flush() {
+    std::vector<std::unique_ptr<Batch>> to_send;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        SealBatch();
+        TakeSendable(&to_send);
+    }
+    SendBatches(&to_send);
+}
+
+void AsyncProcedureCaller::WaitAll() {
+    Flush();
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this] { return inflight_ == 0 && ready_.empty(); });
+}
+
+void AsyncProcedureCaller::FlushExpired() {
+    uint64_t cur_ts = ::baidu::common::timer::get_micros() / 1000;
+    std::vector<std::unique_ptr<Batch>> to_send;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (building_ && building_->create_time + options_.flush_interval_ms <= cur_ts) {
+            SealBatch();
+        }
+        TakeSendable(&to_send);
+    }
+    SendBatches(&to_send);
+    if (running_.load(std::memory_order_acquire)) {
+        pool_.DelayTask(options_.flush_interval_ms, [this] { FlushExpired(); });
+    }
+}
+
+void AsyncProcedureCaller::SealBatch() {
+    if (building_) {
+        ready_.push_back(std::move(building_));
+    }
+}
+
+void AsyncProcedureCaller::TakeSendable(std::vector<std::unique_ptr<Batch>>* to_send) {
+    size_t pos = 0;
+    while (inflight_ < options_.max_inflight && pos < ready_.size()) {
+        inflight_++;
+        to_send->push_back(std::move(ready_[pos++]));
+    }
+    ready_.erase(ready_.begin(), ready_.begin() + pos);
+}
+
+void AsyncProcedureCaller::SendBatches(std::vector<std::unique_ptr<Batch>>* to_send) {
+    if (to_send->empty()) {
+        // the caller may be destroyed once the last batch is done
+        return;
+    }
+    const std::string& db = sp_info_->GetDbName();
+    const std::string& db_name = sp_info_->GetMainDb().empty() ? db : sp_info_->GetMainDb();
+    for (auto& batch : *to_send) {
+        auto closure = new BatchCallClosure(this, std::move(batch));
+        // the tablet is resolved for every batch as the leader may change
+        auto tablet = cluster_sdk_->GetTablet(db_name, sp_info_->GetMainTable());
+        auto client = tablet ? tablet->GetClient() : std::shared_ptr<::openmldb::client::TabletClient>();
+        closure->GetController()->set_timeout_ms(options_.request_timeout_ms);
+        if (!client) {
+            closure->GetController()->SetFailed("fail to get tablet, table " + db_name + "." +
+                                                sp_info_->GetMainTable());
+            closure->Run();
+        } else if (!client->AsyncCallSQLBatchRequestProcedure(db, sp_info_->GetSpName(), closure->GetBatch().rows,
+                                                              closure->GetController(), closure->GetResponse(),
+                                                              closure)) {
+            closure->GetController()->SetFailed("fail to send batch request");
+            closure->Run();
+        }
+    }
+    to_send->clear();
+}
+
+void AsyncProcedureCaller::FailBatch(const Batch& batch, const hybridse::sdk::Status& status) {
+    for (const auto& callback : batch.callbacks) {
+        callback(status, {});
+    }
+}
+
+void AsyncProcedureCaller::OnBatchDone(
+    std::unique_ptr<Batch> batch, const std::shared_ptr<brpc::Controller>& cntl,
+    const std::shared_ptr<::openmldb::api::SQLBatchRequestQueryResponse>& response) {
+    if (cntl->Failed()) {
+        LOG(WARNING) << "fail to call " << sp_info_->GetSpName() << " with " << batch->callbacks.size()
+                     << " rows, " << cntl->ErrorText();
+        FailBatch(*batch, hybridse::sdk::Status(hybridse::common::kRpcError, cntl->ErrorText()));
+    } else if (response->code() != ::openmldb::base::kOk) {
+        FailBatch(*batch, hybridse::sdk::Status(response->code(), response->msg()));
+    } else if (response->count() != batch->callbacks.size()) {
+        FailBatch(*batch, hybridse::sdk::Status(hybridse::common::kRpcError, "the count of output rows mismatch"));
+    } else if (batch->callbacks.size() == 1 || response->common_column_indices_size() > 0) {
+        // a batch of one call is answered as it is
+        auto rs = std::make_shared<SQLBatchRequestResultSet>(response, cntl);
+        if (!rs->Init()) {
+            FailBatch(*batch, hybridse::sdk::Status(-1, "fail to init batch request result set"));
+        } else {
+            batch->callbacks[0](hybridse::sdk::Status(), rs);
+        }
+    } else {
+        // every output row is referred by its own result set without copying
+        ::hybridse::vm::Schema schema;
+        ::hybridse::codec::SchemaCodec::Decode(response->schema(), &schema);
+        const butil::IOBuf& buf = cntl->response_attachment();
+        size_t offset = 0;
+        for (size_t i = 0; i < batch->callbacks.size(); i++) {
+            uint32_t row_size = 0;
+            if (offset + 6 <= buf.size()) {
+                buf.copy_to(&row_size, 4, offset + 2);
+            }
+            if (row_size == 0 || offset + row_size > buf.size()) {
+                batch->callbacks[i](hybridse::sdk::Status(-1, "fail to decode the output row"), {});
+                continue;
+            }
+            auto row_buf = std::make_shared<butil::IOBuf>();
+            buf.append_to(row_buf.get(), row_size, offset);
+            offset += row_size;
+            auto rs = std::make_shared<ResultSetSQL>(schema, 1, row_buf);
+            if (!rs->Init()) {
+                batch->callbacks[i](hybridse::sdk::Status(-1, "fail to init result set"), {});
+            } else {
+                batch->callbacks[i](hybridse::sdk::Status(), rs);
+            }
+        }
+    }
+    std::vector<std::unique_ptr<Batch>> to_send;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        inflight_--;
+        TakeSendable(&to_send);
+        cv_.notify_all();
+    }
+    SendBatches(&to_send);
+}
+
+}  // namespace sdk
+}  // namespace openmldb
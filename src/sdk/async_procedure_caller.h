@@ -0,0 +1,113 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_ASYNC_PROCEDURE_CALLER_H_
+#define SRC_SDK_ASYNC_PROCEDURE_CALLER_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/thread_pool.h"
+#include "proto/tablet.pb.h"
+#include "sdk/base.h"
+#include "sdk/db_sdk.h"
+#include "sdk/result_set.h"
+#include "sdk/sql_request_row.h"
+
+namespace openmldb {
+namespace sdk {
+
+struct AsyncCallOptions {
+    // the calls are sent as one batch request once there are max_batch_rows of them
+    uint32_t max_batch_rows = 64;
+    // the latency budget, the calls waited longer than it are sent even if the batch is not full
+    uint32_t flush_interval_ms = 2;
+    // the count of batch requests on the fly, the full batches beyond it wait in queue
+    uint32_t max_inflight = 16;
+    int64_t request_timeout_ms = 10000;
+};
+
+// the result set holds the output row of the request row if the status is ok
+using ProcedureCallback =
+    std::function<void(const hybridse::sdk::Status& status, std::shared_ptr<hybridse::sdk::ResultSet> rs)>;
+
+// AsyncProcedureCaller calls one deployment without blocking the calling thread. The concurrent calls are
+// coalesced into SQLBatchRequestQuery requests and the callback of every call runs on the brpc thread once
+// its batch is answered, so a few application threads can keep many requests on the fly.
+// The calls are not coalesced if the deployment has common columns, as the rows of different calls may
+// differ in them.
+class AsyncProcedureCaller {
+ public:
+    AsyncProcedureCaller(DBSDK* cluster_sdk, std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info,
+                         const AsyncCallOptions& options);
+
+    // the pending calls are sent and the requests on the fly are waited
+    ~AsyncProcedureCaller();
+
+    bool Init();
+
+    // `callback` is run with an error status if the call fails or the caller is not running
+    void Call(const std::shared_ptr<SQLRequestRow>& row, ProcedureCallback callback);
+
+    // send the pending calls without waiting for the flush interval
+    void Flush();
+
+    // flush and wait until no request is on the fly
+    void WaitAll();
+
+ private:
+    struct Batch {
+        std::shared_ptr<SQLRequestRowBatch> rows;
+        std::vector<ProcedureCallback> callbacks;
+        uint64_t create_time = 0;
+    };
+
+    class BatchCallClosure;
+
+    // mu_ should be held
+    void SealBatch();
+    // mu_ should be held, the batches to send are moved out and sent without the lock
+    void TakeSendable(std::vector<std::unique_ptr<Batch>>* to_send);
+    void SendBatches(std::vector<std::unique_ptr<Batch>>* to_send);
+    void OnBatchDone(std::unique_ptr<Batch> batch, const std::shared_ptr<brpc::Controller>& cntl,
+                     const std::shared_ptr<::openmldb::api::SQLBatchRequestQueryResponse>& response);
+    void FlushExpired();
+
+    static void FailBatch(const Batch& batch, const hybridse::sdk::Status& status);
+
+    DBSDK* cluster_sdk_;
+    std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info_;
+    AsyncCallOptions options_;
+    std::shared_ptr<hybridse::sdk::Schema> input_schema_;
+    std::shared_ptr<ColumnIndicesSet> common_column_indices_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::unique_ptr<Batch> building_;
+    std::vector<std::unique_ptr<Batch>> ready_;
+    uint32_t inflight_;
+    std::atomic<bool> running_;
+    ::baidu::common::ThreadPool pool_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_ASYNC_PROCEDURE_CALLER_H_
@@ -0,0 +1,431 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "sdk/bulk_load_builder.h"
+
+#include <algorithm>
+
+#include "base/hash.h"
+#include "common/timer.h"
+#include "glog/logging.h"
+
+namespace openmldb {
+namespace sdk {
+
+// the same seed as MemTable, so the keys go into the same segments
+static constexpr uint32_t SEED = 0xe17a1465;
+// the auto generated ts column has no column id, its ts_idx is -1 in BulkLoadInfoResponse
+static constexpr uint32_t AUTO_GEN_TS_COL = UINT32_MAX;
+// the bytes of a time entry and of a key entry besides the key, to estimate the size of the index parts
+static constexpr uint64_t TIME_ENTRY_SIZE = 16;
+static constexpr uint64_t KEY_ENTRY_SIZE = 8;
+
+BulkLoadBuilder::BulkLoadBuilder(uint32_t tid, uint32_t pid, const ::openmldb::codec::Schema& schema,
+                                 const ::openmldb::api::BulkLoadInfoResponse& info)
+    : tid_(tid),
+      pid_(pid),
+      schema_(schema),
+      row_view_(schema_),
+      seg_cnt_(info.seg_cnt() > 0 ? info.seg_cnt() : 1),
+      inner_index_pos_(info.inner_index_pos().begin(), info.inner_index_pos().end()),
+      inner_index_(),
+      regions_(),
+      part_id_(0),
+      block_id_(0),
+      rows_(),
+      binlogs_(),
+      ref_cnts_(),
+      data_size_(0),
+      inner_cursor_(0),
+      seg_cursor_(0),
+      index_done_(false) {
+    for (const auto& inner_index : info.inner_index()) {
+        std::vector<IndexDef> defs;
+        for (const auto& index_def : inner_index.index_def()) {
+            defs.push_back({static_cast<uint32_t>(index_def.ts_idx()), index_def.is_ready()});
+        }
+        inner_index_.push_back(std::move(defs));
+    }
+    for (const auto& inner_segments : info.inner_segments()) {
+        std::vector<SegmentRegion> segments(inner_segments.segment_size());
+        for (int i = 0; i < inner_segments.segment_size(); i++) {
+            const auto& segment = inner_segments.segment(i);
+            segments[i].ts_cnt = segment.ts_cnt();
+            for (const auto& entry : segment.ts_idx_map()) {
+                segments[i].ts_idx_map.emplace(entry.key(), entry.value());
+            }
+        }
+        regions_.push_back(std::move(segments));
+    }
+}
+
+::openmldb::base::Status BulkLoadBuilder::AddRow(const std::string& row,
+                                                 const std::vector<std::pair<std::string, uint32_t>>& dimensions,
+                                                 uint64_t time) {
+    if (index_done_) {
+        return {::openmldb::base::kError, "the index region has been built"};
+    }
+    if (dimensions.empty() || row.size() < ::openmldb::codec::HEADER_LENGTH) {
+        return {::openmldb::base::kError, "invalid row"};
+    }
+    std::map<int32_t, std::string> inner_index_key_map;
+    for (const auto& dim : dimensions) {
+        int32_t inner_pos = dim.second < inner_index_pos_.size() ? inner_index_pos_[dim.second] : -1;
+        if (inner_pos < 0 || static_cast<size_t>(inner_pos) >= inner_index_.size() ||
+            static_cast<size_t>(inner_pos) >= regions_.size()) {
+            return {::openmldb::base::kError, "invalid dimension idx " + std::to_string(dim.second)};
+        }
+        inner_index_key_map.emplace(inner_pos, dim.first);
+    }
+    const int8_t* data = reinterpret_cast<const int8_t*>(row.data());
+    std::map<uint32_t, uint64_t> ts_map;
+    uint32_t ref_cnt = 0;
+    std::vector<std::pair<SegmentRegion*, const std::string*>> puts;
+    for (const auto& kv : inner_index_key_map) {
+        bool need_put = false;
+        for (const auto& index_def : inner_index_[kv.first]) {
+            int64_t ts = 0;
+            if (index_def.ts_col == AUTO_GEN_TS_COL) {
+                ts = time;
+            } else if (index_def.ts_col >= static_cast<uint32_t>(schema_.size()) ||
+                       row_view_.GetInteger(data, index_def.ts_col, schema_.Get(index_def.ts_col).data_type(),
+                                            &ts) != 0) {
+                return {::openmldb::base::kError, "fail to get ts of column " + std::to_string(index_def.ts_col)};
+            }
+            ts_map.emplace(index_def.ts_col, ts);
+            if (index_def.is_ready) {
+                ref_cnt++;
+                need_put = true;
+            }
+        }
+        if (!need_put) {
+            continue;
+        }
+        uint32_t seg_idx = 0;
+        if (seg_cnt_ > 1) {
+            seg_idx = ::openmldb::base::hash(kv.second.data(), kv.second.size(), SEED) % seg_cnt_;
+        }
+        if (seg_idx >= regions_[kv.first].size()) {
+            return {::openmldb::base::kError, "invalid segment " + std::to_string(seg_idx)};
+        }
+        puts.emplace_back(&regions_[kv.first][seg_idx], &kv.second);
+    }
+    if (ts_map.empty()) {
+        return {::openmldb::base::kError, "no ts of the row"};
+    }
+    uint32_t block_id = block_id_++;
+    for (const auto& put : puts) {
+        SegmentRegion* region = put.first;
+        auto& entries = region->keys[*put.second];
+        if (region->ts_cnt <= 1) {
+            auto iter = region->ts_idx_map.empty() ? ts_map.begin() : ts_map.find(region->ts_idx_map.begin()->first);
+            if (iter == ts_map.end()) {
+                continue;
+            }
+            entries.resize(1);
+            entries[0].emplace_back(iter->second, block_id);
+        } else {
+            entries.resize(region->ts_cnt);
+            for (const auto& ts : ts_map) {
+                auto pos = region->ts_idx_map.find(ts.first);
+                if (pos == region->ts_idx_map.end() || pos->second >= region->ts_cnt) {
+                    continue;
+                }
+                entries[pos->second].emplace_back(ts.second, block_id);
+            }
+        }
+    }
+    ::openmldb::api::BinlogInfo binlog;
+    for (const auto& dim : dimensions) {
+        auto* dimension = binlog.add_dimensions();
+        dimension->set_key(dim.first);
+        dimension->set_idx(dim.second);
+    }
+    binlog.set_time(time);
+    binlog.set_block_id(block_id);
+    binlogs_.push_back(std::move(binlog));
+    ref_cnts_.push_back(ref_cnt);
+    rows_.push_back(row);
+    data_size_ += row.size();
+    return {};
+}
+
+bool BulkLoadBuilder::BuildDataRequest(::openmldb::api::BulkLoadRequest* request, std::string* attachment) {
+    if (rows_.empty()) {
+        return false;
+    }
+    request->set_tid(tid_);
+    request->set_pid(pid_);
+    request->set_part_id(part_id_++);
+    attachment->clear();
+    attachment->reserve(data_size_);
+    for (size_t i = 0; i < rows_.size(); i++) {
+        auto* info = request->add_block_info();
+        info->set_ref_cnt(ref_cnts_[i]);
+        info->set_offset(attachment->size());
+        info->set_length(rows_[i].size());
+        attachment->append(rows_[i]);
+        request->add_binlog_info()->Swap(&binlogs_[i]);
+    }
+    rows_.clear();
+    binlogs_.clear();
+    ref_cnts_.clear();
+    data_size_ = 0;
+    return true;
+}
+
+bool BulkLoadBuilder::BuildIndexRequest(uint64_t size_limit, ::openmldb::api::BulkLoadRequest* request) {
+    if (index_done_) {
+        return false;
+    }
+    request->set_tid(tid_);
+    request->set_pid(pid_);
+    request->set_part_id(part_id_++);
+    uint64_t size = 0;
+    ::openmldb::api::BulkLoadIndex* index = nullptr;
+    ::openmldb::api::Segment* segment = nullptr;
+    while (inner_cursor_ < regions_.size()) {
+        auto& segments = regions_[inner_cursor_];
+        if (seg_cursor_ >= segments.size()) {
+            inner_cursor_++;
+            seg_cursor_ = 0;
+            index = nullptr;
+            segment = nullptr;
+            continue;
+        }
+        auto& keys = segments[seg_cursor_].keys;
+        if (keys.empty()) {
+            seg_cursor_++;
+            segment = nullptr;
+            continue;
+        }
+        if (size > 0 && size >= size_limit) {
+            return true;
+        }
+        if (index == nullptr) {
+            index = request->add_index_region();
+            index->set_inner_index_id(inner_cursor_);
+        }
+        if (segment == nullptr) {
+            segment = index->add_segment();
+            segment->set_id(seg_cursor_);
+        }
+        auto iter = keys.begin();
+        auto* key_entries = segment->add_key_entries();
+        key_entries->set_key(iter->first);
+        size += iter->first.size() + KEY_ENTRY_SIZE;
+        for (size_t i = 0; i < iter->second.size(); i++) {
+            auto& time_entries = iter->second[i];
+            if (time_entries.empty()) {
+                continue;
+            }
+            // ascending, the rows of the same time keep the order they are added
+            std::stable_sort(time_entries.begin(), time_entries.end(),
+                             [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) {
+                                 return a.first < b.first;
+                             });
+            auto* key_entry = key_entries->add_key_entry();
+            key_entry->set_key_entry_id(i);
+            for (const auto& time_entry : time_entries) {
+                auto* entry = key_entry->add_time_entry();
+                entry->set_time(time_entry.first);
+                entry->set_block_id(time_entry.second);
+            }
+            size += time_entries.size() * TIME_ENTRY_SIZE + KEY_ENTRY_SIZE;
+        }
+        keys.erase(iter);
+    }
+    request->set_eof(true);
+    index_done_ = true;
+    return true;
+}
+
+BulkLoaderImpl::BulkLoaderImpl(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
+                               const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                               uint64_t rpc_size_limit)
+    : table_info_(table_info),
+      tablets_(tablets),
+      rpc_size_limit_(rpc_size_limit),
+      is_memory_(table_info->storage_mode() == ::openmldb::common::kMemory),
+      builders_(),
+      disk_requests_(tablets.size()),
+      disk_sizes_(tablets.size(), 0),
+      finished_(false) {
+    builders_.resize(tablets.size());
+}
+
+std::shared_ptr<::openmldb::client::TabletClient> BulkLoaderImpl::GetClient(uint32_t pid,
+                                                                            hybridse::sdk::Status* status) {
+    std::shared_ptr<::openmldb::client::TabletClient> client;
+    if (pid < tablets_.size() && tablets_[pid]) {
+        client = tablets_[pid]->GetClient();
+    }
+    if (!client) {
+        *status = {::openmldb::base::kSQLCmdRunError, "fail to get tablet client. pid " + std::to_string(pid)};
+        LOG(WARNING) << status->msg;
+    }
+    return client;
+}
+
+bool BulkLoaderImpl::Append(std::shared_ptr<SQLInsertRow> row, hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return false;
+    }
+    if (finished_) {
+        *status = {::openmldb::base::kSQLCmdRunError, "bulk loader has been finished"};
+        return false;
+    }
+    if (!row || !row->IsComplete()) {
+        *status = {::openmldb::base::kSQLCmdRunError, "row is not complete"};
+        return false;
+    }
+    uint64_t cur_ts = ::baidu::common::timer::get_micros() / 1000;
+    for (const auto& kv : row->GetDimensions()) {
+        uint32_t pid = kv.first;
+        auto client = GetClient(pid, status);
+        if (!client) {
+            return false;
+        }
+        if (!is_memory_) {
+            auto& request = disk_requests_[pid];
+            auto* put = request.add_rows();
+            put->set_tid(table_info_->tid());
+            put->set_pid(pid);
+            put->set_time(cur_ts);
+            put->set_value(row->GetRow());
+            for (const auto& dim : kv.second) {
+                auto* dimension = put->add_dimensions();
+                dimension->set_key(dim.first);
+                dimension->set_idx(dim.second);
+            }
+            disk_sizes_[pid] += row->GetRow().size();
+            if (disk_sizes_[pid] >= rpc_size_limit_ && !SendRows(pid, false, status)) {
+                return false;
+            }
+            continue;
+        }
+        if (!builders_[pid]) {
+            ::openmldb::api::BulkLoadInfoResponse info;
+            if (!client->GetBulkLoadInfo(table_info_->tid(), pid, &info)) {
+                *status = {::openmldb::base::kSQLCmdRunError,
+                           "fail to get bulk load info. pid " + std::to_string(pid) + ", " + info.msg()};
+                LOG(WARNING) << status->msg;
+                return false;
+            }
+            builders_[pid].reset(new BulkLoadBuilder(table_info_->tid(), pid, table_info_->column_desc(), info));
+        }
+        auto ret = builders_[pid]->AddRow(row->GetRow(), kv.second, cur_ts);
+        if (!ret.OK()) {
+            *status = {::openmldb::base::kSQLCmdRunError, ret.msg};
+            return false;
+        }
+        if (builders_[pid]->DataSize() >= rpc_size_limit_ && !SendData(pid, status)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BulkLoaderImpl::SendData(uint32_t pid, hybridse::sdk::Status* status) {
+    ::openmldb::api::BulkLoadRequest request;
+    std::string attachment;
+    if (!builders_[pid]->BuildDataRequest(&request, &attachment)) {
+        return true;
+    }
+    auto client = GetClient(pid, status);
+    if (!client) {
+        return false;
+    }
+    auto ret = client->BulkLoad(request, attachment);
+    if (!ret.OK()) {
+        *status = {::openmldb::base::kSQLCmdRunError, "fail to send the data region. pid " + std::to_string(pid) +
+                                                          ", part " + std::to_string(request.part_id()) + ", " +
+                                                          ret.msg};
+        LOG(WARNING) << status->msg;
+        return false;
+    }
+    return true;
+}
+
+bool BulkLoaderImpl::SendRows(uint32_t pid, bool eof, hybridse::sdk::Status* status) {
+    auto& request = disk_requests_[pid];
+    if (request.rows_size() == 0 && !eof) {
+        return true;
+    }
+    auto client = GetClient(pid, status);
+    if (!client) {
+        return false;
+    }
+    request.set_tid(table_info_->tid());
+    request.set_pid(pid);
+    request.set_eof(eof);
+    auto ret = client->BulkLoad(request, "");
+    request.Clear();
+    disk_sizes_[pid] = 0;
+    if (!ret.OK()) {
+        *status = {::openmldb::base::kSQLCmdRunError,
+                   "fail to send the rows. pid " + std::to_string(pid) + ", " + ret.msg};
+        LOG(WARNING) << status->msg;
+        return false;
+    }
+    return true;
+}
+
+bool BulkLoaderImpl::Finish(hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return false;
+    }
+    if (finished_) {
+        return true;
+    }
+    finished_ = true;
+    for (uint32_t pid = 0; pid < tablets_.size(); pid++) {
+        if (!is_memory_) {
+            if (disk_sizes_[pid] > 0 && !SendRows(pid, true, status)) {
+                return false;
+            }
+            continue;
+        }
+        if (!builders_[pid]) {
+            continue;
+        }
+        if (!SendData(pid, status)) {
+            return false;
+        }
+        auto client = GetClient(pid, status);
+        if (!client) {
+            return false;
+        }
+        ::openmldb::api::BulkLoadRequest request;
+        while (builders_[pid]->BuildIndexRequest(rpc_size_limit_, &request)) {
+            auto ret = client->BulkLoad(request, "");
+            if (!ret.OK()) {
+                *status = {::openmldb::base::kSQLCmdRunError, "fail to send the index region. pid " +
+                                                                  std::to_string(pid) + ", part " +
+                                                                  std::to_string(request.part_id()) + ", " + ret.msg};
+                LOG(WARNING) << status->msg;
+                return false;
+            }
+            request.Clear();
+        }
+        builders_[pid].reset();
+    }
+    return true;
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SRC_SDK_BULK_LOAD_BUILDER_H_
+#define SRC_SDK_BULK_LOAD_BUILDER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/status.h"
+#include "catalog/client_manager.h"
+#include "codec/codec.h"
+#include "proto/name_server.pb.h"
+#include "proto/tablet.pb.h"
+#include "sdk/bulk_loader.h"
+
+namespace openmldb {
+namespace sdk {
+
+// BulkLoadBuilder builds the bulk load requests of one partition of a memory table from its BulkLoadInfoResponse.
+// The rows go into the data region in the order they are added, a block id for each row. Their index entries are
+// grouped by inner index, segment and key in the same way as MemTable::Put, and the time entries of a key entry are
+// sent in ascending order, so the tablet attaches them to the head of the time skiplist one by one in
+// Segment::BulkLoadPut. The data parts go first, the index parts follow and the last one sets eof.
+class BulkLoadBuilder {
+ public:
+    BulkLoadBuilder(uint32_t tid, uint32_t pid, const ::openmldb::codec::Schema& schema,
+                    const ::openmldb::api::BulkLoadInfoResponse& info);
+
+    // dimensions are the pairs of index key and index id, time is the ts of the auto generated ts column
+    ::openmldb::base::Status AddRow(const std::string& row,
+                                    const std::vector<std::pair<std::string, uint32_t>>& dimensions, uint64_t time);
+
+    // the bytes of the rows which are not built into the data parts yet
+    uint64_t DataSize() const { return data_size_; }
+
+    // move the rows added into the next data part, return false if there is no row to build
+    bool BuildDataRequest(::openmldb::api::BulkLoadRequest* request, std::string* attachment);
+
+    // build the next index part of about size_limit bytes, the index entries of one key are never split. Return false
+    // once the part with eof is built
+    bool BuildIndexRequest(uint64_t size_limit, ::openmldb::api::BulkLoadRequest* request);
+
+ private:
+    struct SegmentRegion {
+        uint32_t ts_cnt = 1;
+        std::map<uint32_t, uint32_t> ts_idx_map;
+        // the time entries of each key entry of a key, pairs of time and block id
+        std::map<std::string, std::vector<std::vector<std::pair<uint64_t, uint32_t>>>> keys;
+    };
+
+    struct IndexDef {
+        uint32_t ts_col;
+        bool is_ready;
+    };
+
+    uint32_t tid_;
+    uint32_t pid_;
+    ::openmldb::codec::Schema schema_;
+    ::openmldb::codec::RowView row_view_;
+    uint32_t seg_cnt_;
+    std::vector<int32_t> inner_index_pos_;
+    std::vector<std::vector<IndexDef>> inner_index_;
+    std::vector<std::vector<SegmentRegion>> regions_;
+    int32_t part_id_;
+    uint32_t block_id_;
+    std::vector<std::string> rows_;
+    std::vector<::openmldb::api::BinlogInfo> binlogs_;
+    std::vector<uint32_t> ref_cnts_;
+    uint64_t data_size_;
+    uint32_t inner_cursor_;
+    uint32_t seg_cursor_;
+    bool index_done_;
+};
+
+class BulkLoaderImpl : public BulkLoader {
+ public:
+    BulkLoaderImpl(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
+                   const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                   uint64_t rpc_size_limit = 32 * 1024 * 1024);
+    ~BulkLoaderImpl() {}
+
+    bool Append(std::shared_ptr<SQLInsertRow> row, hybridse::sdk::Status* status) override;
+
+    bool Finish(hybridse::sdk::Status* status) override;
+
+ private:
+    std::shared_ptr<::openmldb::client::TabletClient> GetClient(uint32_t pid, hybridse::sdk::Status* status);
+    bool SendData(uint32_t pid, hybridse::sdk::Status* status);
+    bool SendRows(uint32_t pid, bool eof, hybridse::sdk::Status* status);
+
+    std::shared_ptr<::openmldb::nameserver::TableInfo> table_info_;
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets_;
+    uint64_t rpc_size_limit_;
+    bool is_memory_;
+    // the builders of a memory table, created once the partition gets its first row
+    std::vector<std::unique_ptr<BulkLoadBuilder>> builders_;
+    // the rows of a disk table are sent as they are, the tablet writes them into sst files
+    std::vector<::openmldb::api::BulkLoadRequest> disk_requests_;
+    std::vector<uint64_t> disk_sizes_;
+    bool finished_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_BULK_LOAD_BUILDER_H_
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SRC_SDK_BULK_LOADER_H_
+#define SRC_SDK_BULK_LOADER_H_
+
+#include <memory>
+
+#include "sdk/base.h"
+#include "sdk/sql_insert_row.h"
+
+namespace openmldb {
+namespace sdk {
+
+// BulkLoader loads the rows into an empty online table without replaying them one by one on the tablets.
+// The rows are built by SQLRouter::GetInsertRow and routed to the partitions by their index keys. The index
+// entries of a memory table are prebuilt on the client, sorted by key and time, so the tablet attaches them to
+// the skiplists in batches. A loader is used by one thread.
+class BulkLoader {
+ public:
+    BulkLoader() {}
+    virtual ~BulkLoader() {}
+
+    // the rows of a partition are sent once they grow to the rpc size limit
+    virtual bool Append(std::shared_ptr<SQLInsertRow> row, hybridse::sdk::Status* status) = 0;
+
+    // send the rest rows and the index regions of all the partitions, no row can be appended after it
+    virtual bool Finish(hybridse::sdk::Status* status) = 0;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_BULK_LOADER_H_
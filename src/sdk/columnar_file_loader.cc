@@ -0,0 +1,384 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/columnar_file_loader.h"
+
+#include <algorithm>
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "config.h"  // NOLINT
+#include "glog/logging.h"
+
+#ifdef ARROW_ENABLE
+#include "absl/time/civil_time.h"
+#include "arrow/adapters/orc/adapter.h"
+#include "arrow/api.h"
+#include "arrow/io/file.h"
+#include "parquet/arrow/reader.h"
+#endif
+
+namespace openmldb {
+namespace sdk {
+
+ColumnarFileLoader::ColumnarFileLoader(const std::string& format, const std::string& file_path,
+                                       std::shared_ptr<hybridse::sdk::Schema> schema, uint32_t thread_num)
+    : format_(format), file_path_(file_path), schema_(schema), thread_num_(thread_num > 0 ? thread_num : 1) {}
+
+#ifndef ARROW_ENABLE
+
+bool ColumnarFileLoader::IsSupported() { return false; }
+
+hybridse::sdk::Status ColumnarFileLoader::Load(const RowsFactory& factory, AsyncInserter* inserter,
+                                               std::atomic<uint64_t>* loaded_rows) {
+    return {::hybridse::common::StatusCode::kCmdError, "format " + format_ + " needs the build with ARROW_ENABLE"};
+}
+
+#else
+
+namespace {
+
+// the units of a file are the row groups of parquet or the stripes of orc
+class ColumnarReader {
+ public:
+    virtual ~ColumnarReader() {}
+    virtual ::arrow::Status Open(const std::string& path) = 0;
+    virtual int GetUnitNum() = 0;
+    virtual std::shared_ptr<::arrow::Schema> GetSchema() = 0;
+    // read the columns of the unit, the indices are of the top level fields
+    virtual ::arrow::Status ReadUnit(int unit, const std::vector<int>& columns,
+                                     std::shared_ptr<::arrow::Table>* out) = 0;
+};
+
+class ParquetReader : public ColumnarReader {
+ public:
+    ::arrow::Status Open(const std::string& path) override {
+        ARROW_ASSIGN_OR_RAISE(auto input, ::arrow::io::ReadableFile::Open(path));
+        ARROW_RETURN_NOT_OK(::parquet::arrow::OpenFile(input, ::arrow::default_memory_pool(), &reader_));
+        return reader_->GetSchema(&schema_);
+    }
+    int GetUnitNum() override { return reader_->num_row_groups(); }
+    std::shared_ptr<::arrow::Schema> GetSchema() override { return schema_; }
+    ::arrow::Status ReadUnit(int unit, const std::vector<int>& columns,
+                             std::shared_ptr<::arrow::Table>* out) override {
+        // the leaf columns are the top level fields as the columns of a table are not nested
+        return reader_->ReadRowGroup(unit, columns, out);
+    }
+
+ private:
+    std::unique_ptr<::parquet::arrow::FileReader> reader_;
+    std::shared_ptr<::arrow::Schema> schema_;
+};
+
+class OrcReader : public ColumnarReader {
+ public:
+    ::arrow::Status Open(const std::string& path) override {
+        ARROW_ASSIGN_OR_RAISE(auto input, ::arrow::io::ReadableFile::Open(path));
+        ARROW_ASSIGN_OR_RAISE(reader_,
+                              ::arrow::adapters::orc::ORCFileReader::Open(input, ::arrow::default_memory_pool()));
+        ARROW_ASSIGN_OR_RAISE(schema_, reader_->ReadSchema());
+        return ::arrow::Status::OK();
+    }
+    int GetUnitNum() override { return reader_->NumberOfStripes(); }
+    std::shared_ptr<::arrow::Schema> GetSchema() override { return schema_; }
+    ::arrow::Status ReadUnit(int unit, const std::vector<int>& columns,
+                             std::shared_ptr<::arrow::Table>* out) override {
+        ARROW_ASSIGN_OR_RAISE(auto batch, reader_->ReadStripe(unit, columns));
+        return ::arrow::Table::FromRecordBatches({batch}).Value(out);
+    }
+
+ private:
+    std::unique_ptr<::arrow::adapters::orc::ORCFileReader> reader_;
+    std::shared_ptr<::arrow::Schema> schema_;
+};
+
+std::unique_ptr<ColumnarReader> NewReader(const std::string& format) {
+    if (format == "orc") {
+        return std::make_unique<OrcReader>();
+    }
+    return std::make_unique<ParquetReader>();
+}
+
+// the value of the integer, timestamp and date arrays, the timestamps are in milliseconds
+bool GetInteger(const ::arrow::Array& array, int64_t i, int64_t* val) {
+    switch (array.type_id()) {
+        case ::arrow::Type::INT8:
+            *val = static_cast<const ::arrow::Int8Array&>(array).Value(i);
+            return true;
+        case ::arrow::Type::INT16:
+            *val = static_cast<const ::arrow::Int16Array&>(array).Value(i);
+            return true;
+        case ::arrow::Type::INT32:
+            *val = static_cast<const ::arrow::Int32Array&>(array).Value(i);
+            return true;
+        case ::arrow::Type::INT64:
+            *val = static_cast<const ::arrow::Int64Array&>(array).Value(i);
+            return true;
+        case ::arrow::Type::UINT8:
+            *val = static_cast<const ::arrow::UInt8Array&>(array).Value(i);
+            return true;
+        case ::arrow::Type::UINT16:
+            *val = static_cast<const ::arrow::UInt16Array&>(array).Value(i);
+            return true;
+        case ::arrow::Type::UINT32:
+            *val = static_cast<const ::arrow::UInt32Array&>(array).Value(i);
+            return true;
+        case ::arrow::Type::DATE64:
+            *val = static_cast<const ::arrow::Date64Array&>(array).Value(i);
+            return true;
+        case ::arrow::Type::TIMESTAMP: {
+            int64_t ts = static_cast<const ::arrow::TimestampArray&>(array).Value(i);
+            switch (static_cast<const ::arrow::TimestampType&>(*array.type()).unit()) {
+                case ::arrow::TimeUnit::SECOND:
+                    *val = ts * 1000;
+                    break;
+                case ::arrow::TimeUnit::MILLI:
+                    *val = ts;
+                    break;
+                case ::arrow::TimeUnit::MICRO:
+                    *val = ts / 1000;
+                    break;
+                case ::arrow::TimeUnit::NANO:
+                    *val = ts / 1000000;
+                    break;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool GetDouble(const ::arrow::Array& array, int64_t i, double* val) {
+    switch (array.type_id()) {
+        case ::arrow::Type::FLOAT:
+            *val = static_cast<const ::arrow::FloatArray&>(array).Value(i);
+            return true;
+        case ::arrow::Type::DOUBLE:
+            *val = static_cast<const ::arrow::DoubleArray&>(array).Value(i);
+            return true;
+        default: {
+            int64_t int_val = 0;
+            if (!GetInteger(array, i, &int_val)) {
+                return false;
+            }
+            *val = static_cast<double>(int_val);
+            return true;
+        }
+    }
+}
+
+bool GetString(const ::arrow::Array& array, int64_t i, std::string* val) {
+    switch (array.type_id()) {
+        case ::arrow::Type::STRING:
+        case ::arrow::Type::BINARY:
+            *val = static_cast<const ::arrow::BinaryArray&>(array).GetString(i);
+            return true;
+        case ::arrow::Type::LARGE_STRING:
+        case ::arrow::Type::LARGE_BINARY:
+            *val = static_cast<const ::arrow::LargeBinaryArray&>(array).GetString(i);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool AppendValue(const ::arrow::Array& array, int64_t i, hybridse::sdk::DataType type, const std::string& str,
+                 SQLInsertRow* row) {
+    if (array.IsNull(i)) {
+        return row->AppendNULL();
+    }
+    int64_t int_val = 0;
+    double double_val = 0;
+    switch (type) {
+        case hybridse::sdk::kTypeBool:
+            if (array.type_id() == ::arrow::Type::BOOL) {
+                return row->AppendBool(static_cast<const ::arrow::BooleanArray&>(array).Value(i));
+            }
+            return GetInteger(array, i, &int_val) && row->AppendBool(int_val != 0);
+        case hybridse::sdk::kTypeInt16:
+            return GetInteger(array, i, &int_val) && row->AppendInt16(static_cast<int16_t>(int_val));
+        case hybridse::sdk::kTypeInt32:
+            return GetInteger(array, i, &int_val) && row->AppendInt32(static_cast<int32_t>(int_val));
+        case hybridse::sdk::kTypeInt64:
+            return GetInteger(array, i, &int_val) && row->AppendInt64(int_val);
+        case hybridse::sdk::kTypeTimestamp:
+            return GetInteger(array, i, &int_val) && row->AppendTimestamp(int_val);
+        case hybridse::sdk::kTypeFloat:
+            return GetDouble(array, i, &double_val) && row->AppendFloat(static_cast<float>(double_val));
+        case hybridse::sdk::kTypeDouble:
+            return GetDouble(array, i, &double_val) && row->AppendDouble(double_val);
+        case hybridse::sdk::kTypeDate: {
+            int64_t days = 0;
+            if (array.type_id() == ::arrow::Type::DATE32) {
+                days = static_cast<const ::arrow::Date32Array&>(array).Value(i);
+            } else if (array.type_id() == ::arrow::Type::DATE64) {
+                days = static_cast<const ::arrow::Date64Array&>(array).Value(i) / 86400000;
+            } else {
+                return false;
+            }
+            absl::CivilDay day = absl::CivilDay(1970, 1, 1) + days;
+            return row->AppendDate(day.year(), day.month(), day.day());
+        }
+        case hybridse::sdk::kTypeString:
+            return row->AppendString(str);
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+bool ColumnarFileLoader::IsSupported() { return true; }
+
+hybridse::sdk::Status ColumnarFileLoader::Load(const RowsFactory& factory, AsyncInserter* inserter,
+                                               std::atomic<uint64_t>* loaded_rows) {
+    auto reader = NewReader(format_);
+    auto arrow_status = reader->Open(file_path_);
+    if (!arrow_status.ok()) {
+        return {::hybridse::common::StatusCode::kCmdError, "open " + format_ + " file failed, " +
+                                                             arrow_status.ToString()};
+    }
+    // project the columns of the table only
+    std::vector<int> columns;
+    for (int i = 0; i < schema_->GetColumnCnt(); i++) {
+        int idx = reader->GetSchema()->GetFieldIndex(schema_->GetColumnName(i));
+        if (idx < 0) {
+            return {::hybridse::common::StatusCode::kCmdError,
+                    "column " + schema_->GetColumnName(i) + " is not found in the file"};
+        }
+        columns.push_back(idx);
+    }
+    int unit_num = reader->GetUnitNum();
+    std::atomic<int> next_unit{0};
+    std::mutex mu;
+    bool failed = false;
+    std::string error;
+    auto set_error = [&](const std::string& msg) {
+        std::lock_guard<std::mutex> lock(mu);
+        if (!failed) {
+            failed = true;
+            error = msg;
+        }
+    };
+    auto is_failed = [&]() {
+        std::lock_guard<std::mutex> lock(mu);
+        return failed;
+    };
+    auto load = [&](std::unique_ptr<ColumnarReader> unit_reader) {
+        std::deque<std::pair<uint64_t, std::future<hybridse::sdk::Status>>> pending;
+        auto wait_one = [&]() {
+            auto ret = pending.front().second.get();
+            if (ret.IsOK()) {
+                loaded_rows->fetch_add(pending.front().first, std::memory_order_relaxed);
+            } else {
+                set_error("insert failed, " + ret.msg);
+            }
+            pending.pop_front();
+        };
+        if (!unit_reader) {
+            unit_reader = NewReader(format_);
+            auto st = unit_reader->Open(file_path_);
+            if (!st.ok()) {
+                set_error("open " + format_ + " file failed, " + st.ToString());
+                return;
+            }
+        }
+        std::vector<std::string> strs(schema_->GetColumnCnt());
+        while (!is_failed()) {
+            int unit = next_unit.fetch_add(1, std::memory_order_relaxed);
+            if (unit >= unit_num) {
+                break;
+            }
+            std::shared_ptr<::arrow::Table> table;
+            auto st = unit_reader->ReadUnit(unit, columns, &table);
+            if (!st.ok()) {
+                set_error("read unit " + std::to_string(unit) + " failed, " + st.ToString());
+                break;
+            }
+            ::arrow::TableBatchReader batch_reader(*table);
+            std::shared_ptr<::arrow::RecordBatch> batch;
+            while (!is_failed() && batch_reader.ReadNext(&batch).ok() && batch) {
+                std::vector<std::shared_ptr<::arrow::Array>> arrays;
+                for (int i = 0; i < schema_->GetColumnCnt(); i++) {
+                    arrays.push_back(batch->GetColumnByName(schema_->GetColumnName(i)));
+                    if (!arrays.back()) {
+                        set_error("column " + schema_->GetColumnName(i) + " is not read");
+                        break;
+                    }
+                }
+                hybridse::sdk::Status ret;
+                auto rows = factory(&ret);
+                if (!rows) {
+                    set_error(ret.msg);
+                    break;
+                }
+                for (int64_t r = 0; r < batch->num_rows() && !is_failed(); r++) {
+                    auto row = rows->NewRow();
+                    uint32_t str_len = 0;
+                    for (int i = 0; i < schema_->GetColumnCnt(); i++) {
+                        strs[i].clear();
+                        if (schema_->GetColumnType(i) == hybridse::sdk::kTypeString && !arrays[i]->IsNull(r)) {
+                            GetString(*arrays[i], r, &strs[i]);
+                            str_len += strs[i].size();
+                        }
+                    }
+                    row->Init(str_len);
+                    for (int i = 0; i < schema_->GetColumnCnt(); i++) {
+                        if (!AppendValue(*arrays[i], r, schema_->GetColumnType(i), strs[i], row.get())) {
+                            set_error("unit " + std::to_string(unit) + " row " + std::to_string(r) + " column " +
+                                      schema_->GetColumnName(i) + " of " + arrays[i]->type()->ToString() +
+                                      " translate failed");
+                            break;
+                        }
+                    }
+                }
+                if (is_failed()) {
+                    break;
+                }
+                pending.emplace_back(rows->GetCnt(), inserter->Insert(rows));
+                while (pending.size() > 2) {
+                    wait_one();
+                }
+            }
+        }
+        while (!pending.empty()) {
+            wait_one();
+        }
+    };
+    uint32_t thread_num = std::min<uint32_t>(thread_num_, std::max(unit_num, 1));
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < thread_num; i++) {
+        threads.emplace_back(load, nullptr);
+    }
+    load(std::move(reader));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failed) {
+        return {::hybridse::common::StatusCode::kCmdError, error};
+    }
+    return {};
+}
+
+#endif
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_COLUMNAR_FILE_LOADER_H_
+#define SRC_SDK_COLUMNAR_FILE_LOADER_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "sdk/async_inserter.h"
+#include "sdk/base.h"
+#include "sdk/sql_insert_row.h"
+
+namespace openmldb {
+namespace sdk {
+
+// ColumnarFileLoader loads a parquet or an orc file into a table with arrow. The row groups of parquet or the
+// stripes of orc are the units read in parallel by thread_num threads, each opens the file of its own. Only the
+// columns of the table are read, they are found by name, and the column batches are encoded into the rows by the
+// column types of the table, which are written through the inserter.
+// It is built with ARROW_ENABLE, otherwise Load fails.
+class ColumnarFileLoader {
+ public:
+    // create the rows of the insert sql of the table
+    using RowsFactory = std::function<std::shared_ptr<SQLInsertRows>(hybridse::sdk::Status*)>;
+
+    // format is "parquet" or "orc"
+    ColumnarFileLoader(const std::string& format, const std::string& file_path,
+                       std::shared_ptr<hybridse::sdk::Schema> schema, uint32_t thread_num);
+
+    static bool IsSupported();
+
+    // loaded_rows counts the rows acked, so it can be read for the progress on the way
+    hybridse::sdk::Status Load(const RowsFactory& factory, AsyncInserter* inserter,
+                               std::atomic<uint64_t>* loaded_rows);
+
+ private:
+    std::string format_;
+    std::string file_path_;
+    std::shared_ptr<hybridse::sdk::Schema> schema_;
+    uint32_t thread_num_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_COLUMNAR_FILE_LOADER_H_
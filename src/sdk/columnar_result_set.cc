@@ -0,0 +1,145 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/columnar_result_set.h"
+
+namespace openmldb {
+namespace sdk {
+
+template <typename T>
+static void AppendValue(std::string* buf, T val) {
+    buf->append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+// set the bit `pos` of the bitmap, the bitmap grows by bytes
+static void SetBit(std::string* bitmap, int32_t pos, bool val) {
+    uint32_t byte = static_cast<uint32_t>(pos) / 8;
+    if (bitmap->size() <= byte) {
+        bitmap->resize(byte + 1, 0);
+    }
+    if (val) {
+        (*bitmap)[byte] = static_cast<char>((*bitmap)[byte] | (1 << (pos % 8)));
+    }
+}
+
+// the days since 1970-01-01 of the proleptic gregorian date
+static int32_t DaysFromCivil(int32_t year, int32_t month, int32_t day) {
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    int32_t yoe = year - era * 400;
+    int32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+std::shared_ptr<ColumnarResultSet> ColumnarResultSet::Build(const std::shared_ptr<hybridse::sdk::ResultSet>& rs,
+                                                            hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return {};
+    }
+    if (!rs || rs->GetSchema() == nullptr) {
+        status->code = -1;
+        status->msg = "result set is null";
+        return {};
+    }
+    std::shared_ptr<ColumnarResultSet> columnar(new ColumnarResultSet());
+    const auto* schema = rs->GetSchema();
+    columnar->columns_.resize(schema->GetColumnCnt());
+    for (int32_t i = 0; i < schema->GetColumnCnt(); i++) {
+        auto& column = columnar->columns_[i];
+        column.name = schema->GetColumnName(i);
+        column.type = schema->GetColumnType(i);
+        if (column.type == hybridse::sdk::kTypeString) {
+            AppendValue<int32_t>(&column.offsets, 0);
+        }
+    }
+    if (rs->Size() > 0) {
+        for (auto& column : columnar->columns_) {
+            column.validity.reserve((rs->Size() + 7) / 8);
+            column.values.reserve(static_cast<uint64_t>(rs->Size()) * 8);
+        }
+    }
+    rs->Reset();
+    while (rs->Next()) {
+        if (!columnar->AppendRow(rs.get(), status)) {
+            return {};
+        }
+    }
+    status->code = 0;
+    return columnar;
+}
+
+bool ColumnarResultSet::AppendRow(hybridse::sdk::ResultSet* rs, hybridse::sdk::Status* status) {
+    for (uint32_t i = 0; i < columns_.size(); i++) {
+        auto& column = columns_[i];
+        bool is_null = rs->IsNULL(i);
+        SetBit(&column.validity, row_cnt_, !is_null);
+        if (is_null) {
+            column.null_cnt++;
+        }
+        switch (column.type) {
+            case hybridse::sdk::kTypeBool:
+                SetBit(&column.values, row_cnt_, is_null ? false : rs->GetBoolUnsafe(i));
+                break;
+            case hybridse::sdk::kTypeInt16:
+                AppendValue<int16_t>(&column.values, is_null ? 0 : rs->GetInt16Unsafe(i));
+                break;
+            case hybridse::sdk::kTypeInt32:
+                AppendValue<int32_t>(&column.values, is_null ? 0 : rs->GetInt32Unsafe(i));
+                break;
+            case hybridse::sdk::kTypeInt64:
+                AppendValue<int64_t>(&column.values, is_null ? 0 : rs->GetInt64Unsafe(i));
+                break;
+            case hybridse::sdk::kTypeFloat:
+                AppendValue<float>(&column.values, is_null ? 0 : rs->GetFloatUnsafe(i));
+                break;
+            case hybridse::sdk::kTypeDouble:
+                AppendValue<double>(&column.values, is_null ? 0 : rs->GetDoubleUnsafe(i));
+                break;
+            case hybridse::sdk::kTypeTimestamp:
+                AppendValue<int64_t>(&column.values, is_null ? 0 : rs->GetTimeUnsafe(i));
+                break;
+            case hybridse::sdk::kTypeDate: {
+                int32_t days = 0;
+                int32_t year = 0, month = 0, day = 0;
+                if (!is_null && rs->GetDate(i, &year, &month, &day)) {
+                    days = DaysFromCivil(year, month, day);
+                }
+                AppendValue<int32_t>(&column.values, days);
+                break;
+            }
+            case hybridse::sdk::kTypeString: {
+                if (!is_null) {
+                    std::string val;
+                    rs->GetString(i, &val);
+                    column.values.append(val);
+                }
+                AppendValue<int32_t>(&column.offsets, static_cast<int32_t>(column.values.size()));
+                break;
+            }
+            default: {
+                status->code = -1;
+                status->msg = "unsupported column type of " + column.name;
+                return false;
+            }
+        }
+    }
+    row_cnt_++;
+    return true;
+}
+
+}  // namespace sdk
+}  // namespace openmldb
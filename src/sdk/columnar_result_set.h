@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_COLUMNAR_RESULT_SET_H_
+#define SRC_SDK_COLUMNAR_RESULT_SET_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sdk/base.h"
+#include "sdk/result_set.h"
+
+namespace openmldb {
+namespace sdk {
+
+// a read-only view of a buffer owned by ColumnarResultSet
+struct ColumnBuffer {
+    const char* data = nullptr;
+    uint64_t size = 0;
+};
+
+// ColumnarResultSet transposes a whole ResultSet into one set of contiguous
+// buffers per column, in the layout of the Arrow columnar format:
+//   validity: a bitmap with the least significant bit first, 1 is non-null
+//   offsets:  string only, row_cnt + 1 int32 offsets into values
+//   values:   little-endian fixed-width values, bit-packed for bool, the
+//             bytes of all rows for string, the days since epoch as int32
+//             for date and the milliseconds as int64 for timestamp
+// The language bindings hand the buffers out without copying, so a client
+// reads a column with one call instead of one call per cell.
+class ColumnarResultSet {
+ public:
+    // consume `rs` from the first row, `rs` is left at the end
+    static std::shared_ptr<ColumnarResultSet> Build(const std::shared_ptr<hybridse::sdk::ResultSet>& rs,
+                                                    hybridse::sdk::Status* status);
+
+    int32_t GetRowCnt() const { return row_cnt_; }
+
+    int32_t GetColumnCnt() const { return static_cast<int32_t>(columns_.size()); }
+
+    const std::string& GetColumnName(uint32_t idx) const { return columns_[idx].name; }
+
+    hybridse::sdk::DataType GetColumnType(uint32_t idx) const { return columns_[idx].type; }
+
+    int32_t GetNullCnt(uint32_t idx) const { return columns_[idx].null_cnt; }
+
+    ColumnBuffer GetValidity(uint32_t idx) const { return ToBuffer(columns_[idx].validity); }
+
+    ColumnBuffer GetOffsets(uint32_t idx) const { return ToBuffer(columns_[idx].offsets); }
+
+    ColumnBuffer GetValues(uint32_t idx) const { return ToBuffer(columns_[idx].values); }
+
+ private:
+    struct Column {
+        std::string name;
+        hybridse::sdk::DataType type;
+        int32_t null_cnt = 0;
+        std::string validity;
+        std::string offsets;
+        std::string values;
+    };
+
+    ColumnarResultSet() : row_cnt_(0) {}
+
+    static ColumnBuffer ToBuffer(const std::string& buf) {
+        ColumnBuffer buffer;
+        buffer.data = buf.data();
+        buffer.size = buf.size();
+        return buffer;
+    }
+
+    bool AppendRow(hybridse::sdk::ResultSet* rs, hybridse::sdk::Status* status);
+
+    int32_t row_cnt_;
+    std::vector<Column> columns_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_COLUMNAR_RESULT_SET_H_
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/columnar_result_set.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace sdk {
+
+class ColumnarResultSetTest : public ::testing::Test {};
+
+class TestSchema : public hybridse::sdk::Schema {
+ public:
+    int32_t GetColumnCnt() const override { return 4; }
+    const std::string& GetColumnName(uint32_t index) const override { return names_[index]; }
+    const hybridse::sdk::DataType GetColumnType(uint32_t index) const override { return types_[index]; }
+
+ private:
+    std::vector<std::string> names_ = {"c_int64", "c_str", "c_bool", "c_date"};
+    std::vector<hybridse::sdk::DataType> types_ = {hybridse::sdk::kTypeInt64, hybridse::sdk::kTypeString,
+                                                   hybridse::sdk::kTypeBool, hybridse::sdk::kTypeDate};
+};
+
+struct TestRow {
+    bool is_null;
+    int64_t val;
+    std::string str;
+};
+
+// the values of every column are derived from one TestRow, a null row is null in all columns
+class TestResultSet : public hybridse::sdk::ResultSet {
+ public:
+    explicit TestResultSet(std::vector<TestRow> rows) : rows_(std::move(rows)), pos_(-1) {}
+    bool Reset() override {
+        pos_ = -1;
+        return true;
+    }
+    bool Next() override { return ++pos_ < static_cast<int32_t>(rows_.size()); }
+    bool GetString(uint32_t index, std::string* val) override {
+        *val = rows_[pos_].str;
+        return true;
+    }
+    bool GetBool(uint32_t index, bool* result) override {
+        *result = rows_[pos_].val % 2 == 1;
+        return true;
+    }
+    bool GetChar(uint32_t index, char* result) override { return false; }
+    bool GetInt16(uint32_t index, int16_t* result) override { return false; }
+    bool GetInt32(uint32_t index, int32_t* result) override { return false; }
+    bool GetInt64(uint32_t index, int64_t* result) override {
+        *result = rows_[pos_].val;
+        return true;
+    }
+    bool GetFloat(uint32_t index, float* result) override { return false; }
+    bool GetDouble(uint32_t index, double* result) override { return false; }
+    bool GetDate(uint32_t index, int32_t* year, int32_t* month, int32_t* day) override {
+        *year = 1970;
+        *month = 1;
+        *day = static_cast<int32_t>(rows_[pos_].val);
+        return true;
+    }
+    bool GetDate(uint32_t index, int32_t* days) override { return false; }
+    bool GetTime(uint32_t index, int64_t* mills) override { return false; }
+    const hybridse::sdk::Schema* GetSchema() override { return &schema_; }
+    bool IsNULL(int index) override { return rows_[pos_].is_null; }
+    int32_t Size() override { return rows_.size(); }
+
+ private:
+    TestSchema schema_;
+    std::vector<TestRow> rows_;
+    int32_t pos_;
+};
+
+template <typename T>
+static T ValueAt(const ColumnBuffer& buffer, int32_t idx) {
+    T val;
+    memcpy(&val, buffer.data + idx * sizeof(T), sizeof(T));
+    return val;
+}
+
+static bool BitAt(const ColumnBuffer& buffer, int32_t idx) {
+    return (static_cast<uint8_t>(buffer.data[idx / 8]) >> (idx % 8)) & 1;
+}
+
+TEST_F(ColumnarResultSetTest, Build) {
+    std::vector<TestRow> rows;
+    for (int i = 0; i < 10; i++) {
+        rows.push_back({i == 3, i + 1, "s" + std::to_string(i)});
+    }
+    auto rs = std::make_shared<TestResultSet>(rows);
+    // the rows read before are included
+    ASSERT_TRUE(rs->Next());
+    hybridse::sdk::Status status;
+    auto columnar = ColumnarResultSet::Build(rs, &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_EQ(10, columnar->GetRowCnt());
+    ASSERT_EQ(4, columnar->GetColumnCnt());
+    ASSERT_EQ("c_str", columnar->GetColumnName(1));
+    ASSERT_EQ(hybridse::sdk::kTypeBool, columnar->GetColumnType(2));
+
+    for (int col = 0; col < 4; col++) {
+        ASSERT_EQ(1, columnar->GetNullCnt(col));
+        auto validity = columnar->GetValidity(col);
+        ASSERT_EQ(2u, validity.size);
+        for (int i = 0; i < 10; i++) {
+            ASSERT_EQ(i != 3, BitAt(validity, i));
+        }
+    }
+
+    auto int_values = columnar->GetValues(0);
+    ASSERT_EQ(10 * sizeof(int64_t), int_values.size);
+    ASSERT_EQ(1, ValueAt<int64_t>(int_values, 0));
+    ASSERT_EQ(0, ValueAt<int64_t>(int_values, 3));
+    ASSERT_EQ(10, ValueAt<int64_t>(int_values, 9));
+
+    auto offsets = columnar->GetOffsets(1);
+    auto str_values = columnar->GetValues(1);
+    ASSERT_EQ(11 * sizeof(int32_t), offsets.size);
+    ASSERT_EQ(0, ValueAt<int32_t>(offsets, 0));
+    // the null row is empty
+    ASSERT_EQ(ValueAt<int32_t>(offsets, 3), ValueAt<int32_t>(offsets, 4));
+    int32_t start = ValueAt<int32_t>(offsets, 9);
+    ASSERT_EQ("s9", std::string(str_values.data + start, ValueAt<int32_t>(offsets, 10) - start));
+    ASSERT_EQ(18u, str_values.size);
+
+    auto bool_values = columnar->GetValues(2);
+    ASSERT_EQ(2u, bool_values.size);
+    ASSERT_TRUE(BitAt(bool_values, 0));
+    ASSERT_FALSE(BitAt(bool_values, 1));
+    ASSERT_FALSE(BitAt(bool_values, 3));
+
+    auto date_values = columnar->GetValues(3);
+    // the days since 1970-01-01
+    ASSERT_EQ(0, ValueAt<int32_t>(date_values, 0));
+    ASSERT_EQ(8, ValueAt<int32_t>(date_values, 8));
+}
+
+TEST_F(ColumnarResultSetTest, Empty) {
+    hybridse::sdk::Status status;
+    auto columnar = ColumnarResultSet::Build(std::make_shared<TestResultSet>(std::vector<TestRow>()), &status);
+    ASSERT_TRUE(status.IsOK());
+    ASSERT_EQ(0, columnar->GetRowCnt());
+    ASSERT_EQ(0u, columnar->GetValues(0).size);
+    ASSERT_EQ(sizeof(int32_t), columnar->GetOffsets(1).size);
+
+    ASSERT_FALSE(ColumnarResultSet::Build(std::shared_ptr<hybridse::sdk::ResultSet>(), &status));
+    ASSERT_FALSE(status.IsOK());
+}
+
+}  // namespace sdk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -29,13 +29,17 @@
 #include <utility>
 #include <vector>
 
-#include "base/hash.h"
+#include "absl/strings/numbers.h"
 #include "base/strings.h"
 #include "glog/logging.h"
 #include "schema/schema_adapter.h"
+#include "zk/table_change_log.h"
 
 namespace openmldb::sdk {
 
+// the table changed notifies within the time trigger only one refresh
+static const uint32_t NOTIFY_COALESCE_MS = 100;
+
 std::shared_ptr<::openmldb::client::NsClient> DBSDK::GetNsClient() {
     auto ns_client = std::atomic_load_explicit(&ns_client_, std::memory_order_relaxed);
     if (ns_client) return ns_client;
@@ -178,8 +182,11 @@ ClusterSDK::ClusterSDK(const ClusterOptions& options)
       table_root_path_(options.zk_path + "/table/db_table_data"),
       sp_root_path_(options.zk_path + "/store_procedure/db_sp_data"),
       notify_path_(options.zk_path + "/table/notify"),
+      table_change_log_path_(options.zk_path + "/table/change_log"),
       globalvar_changed_notify_path_(options.zk_path + "/notify/global_variable"),
       zk_client_(nullptr),
+      refresh_pending_(false),
+      table_version_(0),
       pool_(1) {}
 
 ClusterSDK::~ClusterSDK() {
@@ -230,11 +237,20 @@ void ClusterSDK::WatchNotify() {
     LOG(INFO) << "start to watch table notify";
     session_id_ = zk_client_->GetSessionTerm();
     zk_client_->CancelWatchItem(notify_path_);
-    zk_client_->WatchItem(notify_path_, [this] { Refresh(); });
+    zk_client_->WatchItem(notify_path_, [this] { ScheduleRefresh(); });
     zk_client_->WatchChildren(options_.zk_path + "/data/function",
             std::bind(&ClusterSDK::RefreshExternalFun, this, std::placeholders::_1));
 }
 
+void ClusterSDK::ScheduleRefresh() {
+    if (!refresh_pending_.exchange(true, std::memory_order_acq_rel)) {
+        pool_.DelayTask(NOTIFY_COALESCE_MS, [this] {
+            refresh_pending_.store(false, std::memory_order_release);
+            Refresh();
+        });
+    }
+}
+
 void ClusterSDK::RefreshExternalFun(const std::vector<std::string>& funs) {
     InitExternalFun();
 }
@@ -287,10 +303,23 @@ bool ClusterSDK::GetTaskManagerAddress(std::string* endpoint, std::string* real_
 }
 
 // TODO(hw): refactor
-bool ClusterSDK::UpdateCatalog(const std::vector<std::string>& table_datas, const std::vector<std::string>& sp_datas) {
+bool ClusterSDK::UpdateCatalog(const std::vector<std::string>& table_datas, const std::vector<std::string>& sp_datas,
+                               const std::set<uint32_t>* changed_tids) {
     std::vector<::openmldb::nameserver::TableInfo> tables;
     std::map<std::string, std::map<std::string, std::shared_ptr<::openmldb::nameserver::TableInfo>>> mapping;
     auto new_catalog = std::make_shared<::openmldb::catalog::SDKCatalog>(client_manager_);
+    std::shared_ptr<::openmldb::catalog::SDKCatalog> old_catalog;
+    if (changed_tids != nullptr) {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+        old_catalog = catalog_;
+        for (const auto& db_kv : table_to_tablets_) {
+            for (const auto& table_kv : db_kv.second) {
+                if (changed_tids->count(table_kv.second->tid()) == 0) {
+                    mapping[db_kv.first].emplace(table_kv.first, table_kv.second);
+                }
+            }
+        }
+    }
     for (const auto& table_data : table_datas) {
         if (table_data.empty()) continue;
         std::string value;
@@ -316,7 +345,7 @@ bool ClusterSDK::UpdateCatalog(const std::vector<std::string>& table_datas, cons
             table_in_db.insert(std::make_pair(table_info->name(), table_info));
             mapping.insert(std::make_pair(table_info->db(), table_in_db));
         } else {
-            it->second.insert(std::make_pair(table_info->name(), table_info));
+            it->second[table_info->name()] = table_info;
         }
         DLOG(INFO) << "load table info with name " << table_info->name() << " in db " << table_info->db();
     }
@@ -355,7 +384,9 @@ bool ClusterSDK::UpdateCatalog(const std::vector<std::string>& table_datas, cons
         }
         DLOG(INFO) << "load procedure info with sp name " << sp_info->GetSpName() << " in db " << sp_info->GetDbName();
     }
-    if (!new_catalog->Init(tables, db_sp_map)) {
+    bool ok = old_catalog ? new_catalog->Init(*old_catalog, *changed_tids, tables, db_sp_map)
+                          : new_catalog->Init(tables, db_sp_map);
+    if (!ok) {
         LOG(WARNING) << "fail to init catalog";
         return false;
     }
@@ -390,18 +421,47 @@ bool ClusterSDK::InitTabletClient() {
 }
 
 bool ClusterSDK::BuildCatalog() {
+    std::lock_guard<std::mutex> refresh_lock(refresh_mu_);
     if (!InitTabletClient()) {
         return false;
     }
 
+    uint64_t version = 0;
+    std::string value;
+    if (!zk_client_->GetNodeValue(notify_path_, value) || !::absl::SimpleAtoi(value, &version)) {
+        LOG(WARNING) << "fail to get table notify version from " << notify_path_;
+        version = 0;
+    }
+    // read the changed tables only if the change log covers all versions since the last refresh
+    std::set<std::string> changed_tables;
+    ::openmldb::zk::TableChangeLog change_log(zk_client_, table_change_log_path_);
+    bool is_delta = table_version_ > 0 && version >= table_version_ &&
+                    change_log.GetChanges(table_version_, version, &changed_tables);
     std::vector<std::string> table_datas;
-    if (zk_client_->IsExistNode(table_root_path_) == 0) {
+    std::set<uint32_t> changed_tids;
+    if (is_delta) {
+        for (const auto& node : changed_tables) {
+            uint32_t tid = 0;
+            if (!::absl::SimpleAtoi(node, &tid)) {
+                is_delta = false;
+                break;
+            }
+            changed_tids.insert(tid);
+            table_datas.push_back(node);
+        }
+    }
+    if (is_delta) {
+        DLOG(INFO) << "refresh changed tables from version " << table_version_ << " to " << version;
+    } else if (zk_client_->IsExistNode(table_root_path_) == 0) {
+        table_datas.clear();
+        changed_tids.clear();
         bool ok = zk_client_->GetChildren(table_root_path_, table_datas);
         if (!ok) {
             LOG(WARNING) << "fail to get table list with path " << table_root_path_;
             return false;
         }
     } else {
+        table_datas.clear();
         LOG(INFO) << "no tables in db";
     }
     std::vector<std::string> sp_datas;
@@ -414,7 +474,11 @@ bool ClusterSDK::BuildCatalog() {
     } else {
         DLOG(INFO) << "no procedures in db";
     }
-    return UpdateCatalog(table_datas, sp_datas);
+    if (!UpdateCatalog(table_datas, sp_datas, is_delta ? &changed_tids : nullptr)) {
+        return false;
+    }
+    table_version_ = version;
+    return true;
 }
 
 uint32_t DBSDK::GetTableId(const std::string& db, const std::string& tname) {
@@ -553,12 +617,19 @@ std::shared_ptr<::openmldb::catalog::TabletAccessor> DBSDK::GetTablet(const std:
     if (table_handler) {
         auto sdk_table_handler = dynamic_cast<::openmldb::catalog::SDKTableHandler*>(table_handler.get());
         if (sdk_table_handler) {
-            uint32_t pid_num = sdk_table_handler->GetPartitionNum();
-            uint32_t pid = 0;
-            if (pid_num > 0) {
-                pid = ::openmldb::base::hash64(pk) % pid_num;
-            }
-            return sdk_table_handler->GetTablet(pid);
+            return sdk_table_handler->GetTablet(sdk_table_handler->GetPid(pk));
+        }
+    }
+    return {};
+}
+
+std::shared_ptr<::openmldb::catalog::TabletAccessor> DBSDK::GetFollower(const std::string& db, const std::string& name,
+                                                                        uint32_t pid) {
+    auto table_handler = GetCatalog()->GetTable(db, name);
+    if (table_handler) {
+        auto* sdk_table_handler = dynamic_cast<::openmldb::catalog::SDKTableHandler*>(table_handler.get());
+        if (sdk_table_handler) {
+            return sdk_table_handler->GetFollower(pid);
         }
     }
     return {};
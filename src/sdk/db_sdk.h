@@ -19,6 +19,8 @@
 
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -82,6 +84,9 @@ class DBSDK {
                                                                    uint32_t pid);
     std::shared_ptr<::openmldb::catalog::TabletAccessor> GetTablet(const std::string& db, const std::string& name,
                                                                    const std::string& pk);
+    // a random follower of the partition
+    std::shared_ptr<::openmldb::catalog::TabletAccessor> GetFollower(const std::string& db, const std::string& name,
+                                                                     uint32_t pid);
 
     std::shared_ptr<hybridse::sdk::ProcedureInfo> GetProcedureInfo(const std::string& db, const std::string& sp_name,
                                                                    std::string* msg);
@@ -143,10 +148,15 @@ class ClusterSDK : public DBSDK {
 
  private:
     bool GetRealEndpointFromZk(const std::string& endpoint, std::string* real_endpoint);
-    bool UpdateCatalog(const std::vector<std::string>& table_datas, const std::vector<std::string>& sp_datas);
+    // changed_tids is null if table_datas are all the tables, or the tables not in it are
+    // kept from the current catalog
+    bool UpdateCatalog(const std::vector<std::string>& table_datas, const std::vector<std::string>& sp_datas,
+                       const std::set<uint32_t>* changed_tids);
     bool InitTabletClient();
     void WatchNotify();
     void CheckZk();
+    // merge the table changed notifies in a short time into one refresh
+    void ScheduleRefresh();
 
  private:
     ClusterOptions options_;
@@ -154,8 +164,13 @@ class ClusterSDK : public DBSDK {
     std::string table_root_path_;
     std::string sp_root_path_;
     std::string notify_path_;
+    std::string table_change_log_path_;
     std::string globalvar_changed_notify_path_;
     ::openmldb::zk::ZkClient* zk_client_;
+    std::atomic<bool> refresh_pending_;
+    std::mutex refresh_mu_;
+    // the table notify version of the last refresh, guarded by refresh_mu_
+    uint64_t table_version_;
     ::baidu::common::ThreadPool pool_;
 };
 
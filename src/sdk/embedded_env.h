@@ -0,0 +1,110 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_EMBEDDED_ENV_H_
+#define SRC_SDK_EMBEDDED_ENV_H_
+
+#include <memory>
+#include <string>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "nameserver/name_server_impl.h"
+#include "rpc/local_channel.h"
+#include "sdk/db_sdk.h"
+#include "sdk/sql_cluster_router.h"
+#include "tablet/tablet_impl.h"
+
+DECLARE_string(tablet);
+DECLARE_string(db_root_path);
+
+namespace openmldb {
+namespace sdk {
+
+struct EmbeddedOptions {
+    std::string db_root_path;
+    // the endpoints only name the services in this process, nothing listens on them
+    std::string tablet_endpoint = "127.0.0.1:10921";
+    std::string ns_host = "127.0.0.1";
+    uint32_t ns_port = 6527;
+};
+
+// EmbeddedEnv runs the nameserver and the tablet of the standalone mode in this process without a brpc server.
+// The services are registered to LocalServiceRegistry, so the rpc clients of their endpoints, including the
+// ones of the routers created by NewRouter, call them directly, e.g. CallProcedure and ExecuteInsert pass the
+// rows to the tablet as function calls.
+// The link of the application should include the tablet and the nameserver libraries.
+class EmbeddedEnv {
+ public:
+    EmbeddedEnv() : options_(), tablet_(), nameserver_() {}
+    ~EmbeddedEnv() { Close(); }
+
+    bool SetUp(const EmbeddedOptions& options) {
+        options_ = options;
+        if (!options_.db_root_path.empty()) {
+            FLAGS_db_root_path = options_.db_root_path;
+        }
+        tablet_ = std::make_unique<::openmldb::tablet::TabletImpl>();
+        // registered before init, as the nameserver connects to the tablet in init
+        LocalServiceRegistry::GetInstance()->Register(options_.tablet_endpoint, tablet_.get());
+        if (!tablet_->Init("", "", options_.tablet_endpoint, "")) {
+            LOG(WARNING) << "fail to init embedded tablet " << options_.tablet_endpoint;
+            Close();
+            return false;
+        }
+        FLAGS_tablet = options_.tablet_endpoint;
+        nameserver_ = std::make_unique<::openmldb::nameserver::NameServerImpl>();
+        LocalServiceRegistry::GetInstance()->Register(GetNsEndpoint(), nameserver_.get());
+        if (!nameserver_->Init("", "", GetNsEndpoint(), "")) {
+            LOG(WARNING) << "fail to init embedded nameserver " << GetNsEndpoint();
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    // the router should be released before the env
+    std::shared_ptr<SQLClusterRouter> NewRouter() {
+        if (!nameserver_) {
+            return {};
+        }
+        auto router = std::make_shared<SQLClusterRouter>(new StandAloneSDK(options_.ns_host, options_.ns_port));
+        if (!router->Init()) {
+            LOG(WARNING) << "fail to init router of the embedded env";
+            return {};
+        }
+        return router;
+    }
+
+    void Close() {
+        LocalServiceRegistry::GetInstance()->Unregister(GetNsEndpoint());
+        LocalServiceRegistry::GetInstance()->Unregister(options_.tablet_endpoint);
+        nameserver_.reset();
+        tablet_.reset();
+    }
+
+    std::string GetNsEndpoint() const { return options_.ns_host + ":" + std::to_string(options_.ns_port); }
+
+ private:
+    EmbeddedOptions options_;
+    std::unique_ptr<::openmldb::tablet::TabletImpl> tablet_;
+    std::unique_ptr<::openmldb::nameserver::NameServerImpl> nameserver_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_EMBEDDED_ENV_H_
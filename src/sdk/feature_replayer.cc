@@ -0,0 +1,279 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/feature_replayer.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "base/status.h"
+#include "brpc/channel.h"
+#include "client/tablet_client.h"
+#include "glog/logging.h"
+#include "sdk/batch_request_result_set_sql.h"
+
+namespace openmldb {
+namespace sdk {
+
+struct FeatureReplayer::ReplayState {
+    std::mutex mu;
+    std::condition_variable cv;
+    uint32_t inflight = 0;
+    hybridse::sdk::Status status;
+};
+
+class FeatureReplayer::ReplayClosure : public google::protobuf::Closure {
+ public:
+    ReplayClosure(ReplayState* state, std::vector<size_t> indices, const ReplayCallback& callback)
+        : state_(state),
+          indices_(std::move(indices)),
+          callback_(callback),
+          cntl_(std::make_shared<brpc::Controller>()),
+          response_(std::make_shared<::openmldb::api::SQLBatchRequestQueryResponse>()) {}
+
+    void Run() override {
+        hybridse::sdk::Status status;
+        std::shared_ptr<SQLBatchRequestResultSet> rs;
+        if (cntl_->Failed()) {
+            status = hybridse::sdk::Status(hybridse::common::kRpcError, cntl_->ErrorText());
+        } else if (response_->code() != ::openmldb::base::kOk) {
+            status = hybridse::sdk::Status(response_->code(), response_->msg());
+        } else if (response_->count() != indices_.size()) {
+            status = hybridse::sdk::Status(hybridse::common::kRpcError, "the count of output rows mismatch");
+        } else {
+            rs = std::make_shared<SQLBatchRequestResultSet>(response_, cntl_);
+            if (!rs->Init()) {
+                rs.reset();
+                status = hybridse::sdk::Status(-1, "fail to init batch request result set");
+            }
+        }
+        if (!status.IsOK()) {
+            LOG(WARNING) << "fail to replay " << indices_.size() << " rows, " << status.msg;
+        }
+        callback_(indices_, status, rs);
+        {
+            std::lock_guard<std::mutex> lock(state_->mu);
+            if (!status.IsOK() && state_->status.IsOK()) {
+                state_->status = status;
+            }
+            state_->inflight--;
+            state_->cv.notify_all();
+        }
+        delete this;
+    }
+
+    brpc::Controller* GetController() { return cntl_.get(); }
+    ::openmldb::api::SQLBatchRequestQueryResponse* GetResponse() { return response_.get(); }
+
+ private:
+    ReplayState* state_;
+    std::vector<size_t> indices_;
+    const ReplayCallback& callback_;
+    // the result set given to the callback refers to the response attachment
+    std::shared_ptr<brpc::Controller> cntl_;
+    std::shared_ptr<::openmldb::api::SQLBatchRequestQueryResponse> response_;
+};
+
+FeatureReplayer::FeatureReplayer(DBSDK* cluster_sdk, std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info,
+                                 const ReplayOptions& options)
+    : cluster_sdk_(cluster_sdk),
+      sp_info_(sp_info),
+      options_(options),
+      input_schema_(),
+      common_column_indices_(),
+      request_schema_(),
+      key_idxs_(),
+      common_idxs_(),
+      ts_idx_(-1) {}
+
+bool FeatureReplayer::Init(hybridse::sdk::Status* status) {
+    if (cluster_sdk_ == nullptr || !sp_info_) {
+        status->code = -1;
+        status->msg = "procedure info is null";
+        return false;
+    }
+    // the input schema is owned by sp_info_
+    input_schema_ = std::shared_ptr<hybridse::sdk::Schema>(
+        sp_info_, const_cast<hybridse::sdk::Schema*>(&sp_info_->GetInputSchema()));
+    common_column_indices_ = std::make_shared<ColumnIndicesSet>(input_schema_);
+    for (int32_t i = 0; i < input_schema_->GetColumnCnt(); i++) {
+        auto col = request_schema_.Add();
+        col->set_name(input_schema_->GetColumnName(i));
+        col->set_type(ProtoTypeFromDataType(input_schema_->GetColumnType(i)));
+        if (input_schema_->IsConstant(i)) {
+            common_column_indices_->AddCommonColumnIdx(i);
+            common_idxs_.push_back(i);
+        }
+    }
+    auto find_column = [this](const std::string& name) -> int32_t {
+        for (int32_t i = 0; i < input_schema_->GetColumnCnt(); i++) {
+            if (input_schema_->GetColumnName(i) == name) {
+                return i;
+            }
+        }
+        return -1;
+    };
+    // the common columns are sorted first, as a batch request shares one common slice
+    key_idxs_ = common_idxs_;
+    for (const auto& name : options_.key_columns) {
+        int32_t idx = find_column(name);
+        if (idx < 0) {
+            status->code = -1;
+            status->msg = "key column " + name + " not found in the input schema";
+            return false;
+        }
+        key_idxs_.push_back(idx);
+    }
+    if (!options_.ts_column.empty()) {
+        ts_idx_ = find_column(options_.ts_column);
+        if (ts_idx_ < 0) {
+            status->code = -1;
+            status->msg = "ts column " + options_.ts_column + " not found in the input schema";
+            return false;
+        }
+        auto type = request_schema_.Get(ts_idx_).type();
+        if (type != ::hybridse::type::kInt16 && type != ::hybridse::type::kInt32 &&
+            type != ::hybridse::type::kInt64 && type != ::hybridse::type::kTimestamp &&
+            type != ::hybridse::type::kDate) {
+            status->code = -1;
+            status->msg = "ts column " + options_.ts_column + " should be an integer or timestamp";
+            return false;
+        }
+    }
+    if (options_.batch_rows == 0) {
+        options_.batch_rows = 1;
+    }
+    if (options_.max_inflight == 0) {
+        options_.max_inflight = 1;
+    }
+    status->code = 0;
+    return true;
+}
+
+std::string FeatureReplayer::GetValues(::hybridse::codec::RowView* view, const std::vector<uint32_t>& indices) {
+    std::string values;
+    for (auto idx : indices) {
+        if (!values.empty()) {
+            values.append("|");
+        }
+        values.append(view->GetAsString(idx));
+    }
+    return values;
+}
+
+hybridse::sdk::Status FeatureReplayer::Replay(const std::vector<std::shared_ptr<SQLRequestRow>>& rows,
+                                              ReplayCallback callback) {
+    struct SortEntry {
+        std::string key;
+        int64_t ts;
+        size_t idx;
+    };
+    std::vector<SortEntry> entries(rows.size());
+    ::hybridse::codec::RowView view(request_schema_);
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (!rows[i] || !rows[i]->OK()) {
+            return hybridse::sdk::Status(-1, "make sure the request row " + std::to_string(i) + " is built");
+        }
+        auto& entry = entries[i];
+        entry.idx = i;
+        entry.ts = 0;
+        if (key_idxs_.empty() && ts_idx_ < 0) {
+            continue;
+        }
+        const std::string& row = rows[i]->GetRow();
+        auto buf = reinterpret_cast<const int8_t*>(row.data());
+        view.Reset(buf, row.size());
+        entry.key = GetValues(&view, key_idxs_);
+        if (ts_idx_ >= 0 && !view.IsNULL(ts_idx_)) {
+            view.GetInteger(buf, ts_idx_, request_schema_.Get(ts_idx_).type(), &entry.ts);
+        }
+    }
+    if (!key_idxs_.empty() || ts_idx_ >= 0) {
+        std::stable_sort(entries.begin(), entries.end(), [](const SortEntry& l, const SortEntry& r) {
+            return l.key < r.key || (l.key == r.key && l.ts < r.ts);
+        });
+    }
+
+    ReplayState state;
+    std::shared_ptr<SQLRequestRowBatch> batch;
+    std::vector<size_t> indices;
+    std::string common_values;
+    for (const auto& entry : entries) {
+        const auto& row = rows[entry.idx];
+        std::string values;
+        if (!common_idxs_.empty()) {
+            const std::string& row_str = row->GetRow();
+            view.Reset(reinterpret_cast<const int8_t*>(row_str.data()), row_str.size());
+            values = GetValues(&view, common_idxs_);
+        }
+        // the rows of one batch request share the common columns
+        if (batch && (indices.size() >= options_.batch_rows || values != common_values)) {
+            SendBatch(&state, batch, std::move(indices), callback);
+            batch.reset();
+            indices.clear();
+        }
+        if (!batch) {
+            batch = std::make_shared<SQLRequestRowBatch>(input_schema_, common_column_indices_);
+            common_values = values;
+        }
+        if (!batch->AddRow(row)) {
+            std::lock_guard<std::mutex> lock(state.mu);
+            state.status = hybridse::sdk::Status(-1, "fail to add the request row " + std::to_string(entry.idx));
+            break;
+        }
+        indices.push_back(entry.idx);
+    }
+    bool failed = false;
+    {
+        std::lock_guard<std::mutex> lock(state.mu);
+        failed = !state.status.IsOK();
+    }
+    if (batch && !failed) {
+        SendBatch(&state, batch, std::move(indices), callback);
+    }
+    std::unique_lock<std::mutex> lock(state.mu);
+    state.cv.wait(lock, [&state] { return state.inflight == 0; });
+    return state.status;
+}
+
+void FeatureReplayer::SendBatch(ReplayState* state, std::shared_ptr<SQLRequestRowBatch> batch,
+                                std::vector<size_t> indices, const ReplayCallback& callback) {
+    {
+        std::unique_lock<std::mutex> lock(state->mu);
+        state->cv.wait(lock, [this, state] { return state->inflight < options_.max_inflight; });
+        state->inflight++;
+    }
+    const std::string& db = sp_info_->GetDbName();
+    const std::string& db_name = sp_info_->GetMainDb().empty() ? db : sp_info_->GetMainDb();
+    auto closure = new ReplayClosure(state, std::move(indices), callback);
+    closure->GetController()->set_timeout_ms(options_.request_timeout_ms);
+    // the tablet is resolved for every batch as the leader may change
+    auto tablet = cluster_sdk_->GetTablet(db_name, sp_info_->GetMainTable());
+    auto client = tablet ? tablet->GetClient() : std::shared_ptr<::openmldb::client::TabletClient>();
+    if (!client) {
+        closure->GetController()->SetFailed("fail to get tablet, table " + db_name + "." + sp_info_->GetMainTable());
+        closure->Run();
+    } else if (!client->AsyncCallSQLBatchRequestProcedure(db, sp_info_->GetSpName(), batch, closure->GetController(),
+                                                          closure->GetResponse(), closure)) {
+        closure->GetController()->SetFailed("fail to send batch request");
+        closure->Run();
+    }
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_FEATURE_REPLAYER_H_
+#define SRC_SDK_FEATURE_REPLAYER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sdk/base.h"
+#include "sdk/db_sdk.h"
+#include "sdk/result_set.h"
+#include "sdk/sql_request_row.h"
+
+namespace openmldb {
+namespace sdk {
+
+struct ReplayOptions {
+    // the request rows sent in one batch request
+    uint32_t batch_rows = 1024;
+    // the count of batch requests on the fly
+    uint32_t max_inflight = 4;
+    int64_t request_timeout_ms = 60000;
+    // the request rows are sorted by the key columns and then the ts column, so the requests of one key are
+    // adjacent in the batches. The rows are sent in the given order if both are empty
+    std::vector<std::string> key_columns;
+    std::string ts_column;
+};
+
+// the output rows of `rs` answer the request rows at `indices` in turn, the indices are the positions in the
+// replayed rows
+using ReplayCallback = std::function<void(const std::vector<size_t>& indices, const hybridse::sdk::Status& status,
+                                          std::shared_ptr<hybridse::sdk::ResultSet> rs)>;
+
+// FeatureReplayer runs a deployment over the historical request rows in request mode, e.g. to backfill the
+// features of model retraining with the online semantic. The rows are sent as large SQLBatchRequestQuery
+// requests in pipeline rather than one call per row.
+class FeatureReplayer {
+ public:
+    FeatureReplayer(DBSDK* cluster_sdk, std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info,
+                    const ReplayOptions& options);
+
+    bool Init(hybridse::sdk::Status* status);
+
+    // block until every batch is answered, the first failure is returned. `callback` runs on the brpc threads
+    // once a batch is answered, so it may run concurrently for different batches
+    hybridse::sdk::Status Replay(const std::vector<std::shared_ptr<SQLRequestRow>>& rows, ReplayCallback callback);
+
+ private:
+    struct ReplayState;
+    class ReplayClosure;
+
+    // the rows are grouped by the values of `indices`
+    std::string GetValues(::hybridse::codec::RowView* view, const std::vector<uint32_t>& indices);
+    void SendBatch(ReplayState* state, std::shared_ptr<SQLRequestRowBatch> batch, std::vector<size_t> indices,
+                   const ReplayCallback& callback);
+
+    DBSDK* cluster_sdk_;
+    std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info_;
+    ReplayOptions options_;
+    std::shared_ptr<hybridse::sdk::Schema> input_schema_;
+    std::shared_ptr<ColumnIndicesSet> common_column_indices_;
+    ::hybridse::codec::Schema request_schema_;
+    std::vector<uint32_t> key_idxs_;
+    std::vector<uint32_t> common_idxs_;
+    int32_t ts_idx_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_FEATURE_REPLAYER_H_
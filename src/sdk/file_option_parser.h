@@ -19,6 +19,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 
@@ -70,6 +71,8 @@ class FileOptionsParser {
              std::pair<std::function<bool(const hybridse::node::ConstNode* node)>, hybridse::node::DataType>>
         check_map_;
     char quote_;
+    // the formats supported
+    std::set<std::string> formats_ = {"csv"};
 
  private:
     // default options
@@ -98,10 +101,8 @@ class FileOptionsParser {
     std::function<bool(const hybridse::node::ConstNode* node)> CheckFormat() {
         return [this](const hybridse::node::ConstNode* node) {
             format_ = node->GetAsString();
-            if (format_ != "csv") {
-                return false;
-            }
-            return true;
+            boost::to_lower(format_);
+            return formats_.count(format_) > 0;
         };
     }
     std::function<bool(const hybridse::node::ConstNode* node)> CheckDelimiter() {
@@ -145,19 +146,74 @@ class FileOptionsParser {
 
 class ReadFileOptionsParser : public FileOptionsParser {
  public:
-    ReadFileOptionsParser() { quote_ = '\0'; }
+    ReadFileOptionsParser() {
+        quote_ = '\0';
+        formats_.insert({"parquet", "orc"});
+        check_map_.emplace("thread", std::make_pair(CheckThread(), hybridse::node::kInt32));
+        check_map_.emplace("load_mode", std::make_pair(CheckLoadMode(), hybridse::node::kVarchar));
+    }
+    // the threads parsing the lines into rows
+    uint32_t GetThread() const { return thread_; }
+    // "local" loads the file by the client in the cluster mode rather than by a job of the task manager
+    const std::string& GetLoadMode() const { return load_mode_; }
+
+ private:
+    uint32_t thread_ = 1;
+    std::string load_mode_ = "cluster";
+    std::function<bool(const hybridse::node::ConstNode* node)> CheckLoadMode() {
+        return [this](const hybridse::node::ConstNode* node) {
+            load_mode_ = node->GetAsString();
+            boost::to_lower(load_mode_);
+            return load_mode_ == "cluster" || load_mode_ == "local";
+        };
+    }
+    std::function<bool(const hybridse::node::ConstNode* node)> CheckThread() {
+        return [this](const hybridse::node::ConstNode* node) {
+            int thread = node->GetInt();
+            if (thread <= 0) {
+                return false;
+            }
+            thread_ = thread;
+            return true;
+        };
+    }
 };
 
 class WriteFileOptionsParser : public FileOptionsParser {
  public:
     WriteFileOptionsParser() {
         quote_ = '\0';
+        formats_.insert("parquet");
         check_map_.emplace("mode", std::make_pair(CheckMode(), hybridse::node::kVarchar));
+        check_map_.emplace("thread", std::make_pair(CheckThread(), hybridse::node::kInt32));
+        check_map_.emplace("single_file", std::make_pair(CheckSingleFile(), hybridse::node::kBool));
     }
     const std::string& GetMode() const { return mode_; }
+    // the threads exporting the partitions of a table
+    uint32_t GetThread() const { return thread_; }
+    // false writes the rows of a partition into part-<pid>.<format> under the output directory
+    bool GetSingleFile() const { return single_file_; }
 
  private:
     std::string mode_ = "error_if_exists";
+    uint32_t thread_ = 1;
+    bool single_file_ = true;
+    std::function<bool(const hybridse::node::ConstNode* node)> CheckThread() {
+        return [this](const hybridse::node::ConstNode* node) {
+            int thread = node->GetInt();
+            if (thread <= 0) {
+                return false;
+            }
+            thread_ = thread;
+            return true;
+        };
+    }
+    std::function<bool(const hybridse::node::ConstNode* node)> CheckSingleFile() {
+        return [this](const hybridse::node::ConstNode* node) {
+            single_file_ = node->GetBool();
+            return true;
+        };
+    }
     std::function<bool(const hybridse::node::ConstNode* node)> CheckMode() {
         return [this](const hybridse::node::ConstNode* node) {
             mode_ = node->GetAsString();
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/line_chunk_reader.h"
+
+#include <algorithm>
+
+namespace openmldb {
+namespace sdk {
+
+bool LineChunkReader::Next(std::string* chunk, uint64_t* first_line) {
+    chunk->clear();
+    chunk->swap(remain_);
+    size_t pos = chunk->rfind('\n');
+    // read up to chunk_bytes, then on until a line ends
+    while (in_->good() && (chunk->size() < chunk_bytes_ || pos == std::string::npos)) {
+        size_t old_size = chunk->size();
+        size_t want = chunk->size() < chunk_bytes_ ? chunk_bytes_ - chunk->size() : chunk_bytes_;
+        chunk->resize(old_size + want);
+        in_->read(&(*chunk)[old_size], want);
+        size_t got = in_->gcount();
+        chunk->resize(old_size + got);
+        read_bytes_ += got;
+        size_t new_pos = chunk->rfind('\n');
+        if (new_pos != std::string::npos && (pos == std::string::npos || new_pos > pos)) {
+            pos = new_pos;
+        }
+    }
+    if (chunk->empty()) {
+        return false;
+    }
+    // the partial line is left to the next chunk unless the stream ends
+    if (in_->good() && pos != std::string::npos && pos + 1 < chunk->size()) {
+        remain_.assign(*chunk, pos + 1, std::string::npos);
+        chunk->resize(pos + 1);
+    }
+    *first_line = line_cnt_;
+    line_cnt_ += std::count(chunk->begin(), chunk->end(), '\n');
+    if (chunk->back() != '\n') {
+        line_cnt_++;
+    }
+    return true;
+}
+
+void SplitChunkLines(const std::string& chunk, std::vector<std::string>* lines) {
+    size_t start = 0;
+    while (start < chunk.size()) {
+        size_t end = chunk.find('\n', start);
+        if (end == std::string::npos) {
+            end = chunk.size();
+        }
+        lines->emplace_back(chunk, start, end - start);
+        start = end + 1;
+    }
+}
+
+}  // namespace sdk
+}  // namespace openmldb
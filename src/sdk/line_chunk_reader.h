@@ -0,0 +1,57 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_LINE_CHUNK_READER_H_
+#define SRC_SDK_LINE_CHUNK_READER_H_
+
+#include <stdint.h>
+
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace openmldb {
+namespace sdk {
+
+// LineChunkReader reads a stream in chunks of about chunk_bytes which end at a line boundary, so the lines of
+// a chunk can be parsed apart from the others. A line longer than chunk_bytes makes a chunk of its own.
+class LineChunkReader {
+ public:
+    LineChunkReader(std::istream* in, uint64_t chunk_bytes)
+        : in_(in), chunk_bytes_(chunk_bytes > 0 ? chunk_bytes : 1), read_bytes_(0), line_cnt_(0) {}
+
+    // take the next chunk with the lines joined by '\n' and the 0-based number of its first line in the lines
+    // read, return false at the end of the stream
+    bool Next(std::string* chunk, uint64_t* first_line);
+
+    uint64_t GetReadBytes() const { return read_bytes_; }
+
+ private:
+    std::istream* in_;
+    uint64_t chunk_bytes_;
+    // the partial line at the end of the last read
+    std::string remain_;
+    uint64_t read_bytes_;
+    uint64_t line_cnt_;
+};
+
+// split the chunk into its lines, the empty tail after the last '\n' is not a line
+void SplitChunkLines(const std::string& chunk, std::vector<std::string>* lines);
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_LINE_CHUNK_READER_H_
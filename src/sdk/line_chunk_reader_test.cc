@@ -0,0 +1,84 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/line_chunk_reader.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace sdk {
+
+class LineChunkReaderTest : public ::testing::Test {
+ public:
+    LineChunkReaderTest() {}
+    ~LineChunkReaderTest() {}
+};
+
+void ReadAll(const std::string& content, uint64_t chunk_bytes, std::vector<std::string>* lines,
+             std::vector<uint64_t>* first_lines) {
+    std::istringstream in(content);
+    LineChunkReader reader(&in, chunk_bytes);
+    std::string chunk;
+    uint64_t first_line = 0;
+    while (reader.Next(&chunk, &first_line)) {
+        ASSERT_EQ(lines->size(), first_line);
+        first_lines->push_back(first_line);
+        SplitChunkLines(chunk, lines);
+    }
+    ASSERT_EQ(content.size(), reader.GetReadBytes());
+}
+
+TEST_F(LineChunkReaderTest, Chunks) {
+    std::string content;
+    std::vector<std::string> expect;
+    for (int i = 0; i < 1000; i++) {
+        expect.push_back("line" + std::to_string(i) + ",a,b");
+        content += expect.back() + "\n";
+    }
+    for (uint64_t chunk_bytes : {1, 7, 64, 1000, 1 << 20}) {
+        std::vector<std::string> lines;
+        std::vector<uint64_t> first_lines;
+        ReadAll(content, chunk_bytes, &lines, &first_lines);
+        ASSERT_EQ(expect, lines);
+        if (chunk_bytes == (1 << 20)) {
+            ASSERT_EQ(1u, first_lines.size());
+        }
+    }
+}
+
+TEST_F(LineChunkReaderTest, NoTailNewLine) {
+    std::vector<std::string> lines;
+    std::vector<uint64_t> first_lines;
+    ReadAll("a,1\nbbbbbbbbbbbbbbbb,2\n\nc,3", 4, &lines, &first_lines);
+    std::vector<std::string> expect = {"a,1", "bbbbbbbbbbbbbbbb,2", "", "c,3"};
+    ASSERT_EQ(expect, lines);
+    lines.clear();
+    first_lines.clear();
+    ReadAll("", 4, &lines, &first_lines);
+    ASSERT_TRUE(lines.empty());
+}
+
+}  // namespace sdk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,546 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The benchmarks of the feature sql workloads on the mini cluster. The rows are generated from a fixed seed with
+// the keys in zipf distribution, so the runs are reproducible. The results are reported by google benchmark, run
+// with --benchmark_format=json or --benchmark_out=<file> --benchmark_out_format=json to get them machine readable.
+// The snapshot, recovery and replication catch-up cases report the time of the operation only.
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "codec/codec.h"
+#include "codec/schema_codec.h"
+#include "sdk/mini_cluster.h"
+#include "sdk/sql_router.h"
+#include "tablet/tablet_impl.h"
+
+DECLARE_bool(enable_distsql);
+DECLARE_bool(enable_localtablet);
+DEFINE_uint64(workload_seed, 1024, "the seed of the generated rows");
+DEFINE_double(workload_zipf_theta, 0.99, "the skew of the keys, 0 means uniform");
+DEFINE_uint32(workload_key_cnt, 1000, "the count of distinct keys");
+DEFINE_uint32(workload_preload_rows, 20000, "the rows put before the queries");
+DEFINE_uint32(workload_feature_cols, 20, "the count of double columns the features are computed on");
+
+namespace openmldb {
+namespace sdk {
+
+static ::openmldb::sdk::MiniCluster* mc = nullptr;
+static const char* WORKLOAD_DB = "workload_bm";
+
+// sample the ranks in [0, n) with probability proportional to 1 / (rank + 1)^theta
+class ZipfGenerator {
+ public:
+    ZipfGenerator(uint32_t n, double theta, uint64_t seed) : cdf_(n), rng_(seed), uniform_(0.0, 1.0) {
+        double sum = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            sum += 1.0 / std::pow(i + 1, theta);
+            cdf_[i] = sum;
+        }
+        for (auto& v : cdf_) {
+            v /= sum;
+        }
+    }
+
+    uint32_t Next() {
+        auto it = std::lower_bound(cdf_.begin(), cdf_.end(), uniform_(rng_));
+        return it == cdf_.end() ? cdf_.size() - 1 : it - cdf_.begin();
+    }
+
+    std::mt19937_64& GetRng() { return rng_; }
+
+ private:
+    std::vector<double> cdf_;
+    std::mt19937_64 rng_;
+    std::uniform_real_distribution<double> uniform_;
+};
+
+// the table of a workload is (key string, ts timestamp, c0 double, ...) with one index on key and ts, and the
+// features are the window aggregations over it. every feature is a distinct expression
+class Workload {
+ public:
+    Workload(const std::string& table, uint32_t feature_cnt)
+        : table_(table),
+          feature_cnt_(feature_cnt),
+          keys_(FLAGS_workload_key_cnt, FLAGS_workload_zipf_theta, FLAGS_workload_seed),
+          ts_(1650000000000L) {}
+
+    ~Workload() {
+        if (router_) {
+            hybridse::sdk::Status status;
+            router_->ExecuteDDL(WORKLOAD_DB, "drop table " + table_ + ";", &status);
+        }
+    }
+
+    bool Init(uint32_t replica_num, benchmark::State* state) {
+        SQLRouterOptions sql_opt;
+        sql_opt.zk_cluster = mc->GetZkCluster();
+        sql_opt.zk_path = mc->GetZkPath();
+        router_ = NewClusterSQLRouter(sql_opt);
+        if (!router_) {
+            state->SkipWithError("fail to init sql cluster router");
+            return false;
+        }
+        hybridse::sdk::Status status;
+        router_->CreateDB(WORKLOAD_DB, &status);
+        std::string ddl = "create table " + table_ + " (key string, ts timestamp";
+        for (uint32_t i = 0; i < FLAGS_workload_feature_cols; i++) {
+            ddl += ", c" + std::to_string(i) + " double";
+        }
+        ddl += ", index(key=key, ts=ts, ttl=0m, ttl_type=absolute)) options(partitionnum=4, replicanum=" +
+               std::to_string(replica_num) + ");";
+        if (!router_->ExecuteDDL(WORKLOAD_DB, ddl, &status)) {
+            state->SkipWithError(("fail to create table: " + status.msg).c_str());
+            return false;
+        }
+        router_->RefreshCatalog();
+        insert_sql_ = "insert into " + table_ + " values (?, ?";
+        for (uint32_t i = 0; i < FLAGS_workload_feature_cols; i++) {
+            insert_sql_ += ", ?";
+        }
+        insert_sql_ += ");";
+        query_sql_ = BuildQuery();
+        return true;
+    }
+
+    // put the rows in batches of 100
+    bool Preload(uint32_t rows, benchmark::State* state) {
+        hybridse::sdk::Status status;
+        for (uint32_t i = 0; i < rows; i += 100) {
+            auto batch = router_->GetInsertRows(WORKLOAD_DB, insert_sql_, &status);
+            if (!batch) {
+                state->SkipWithError(("fail to get insert rows: " + status.msg).c_str());
+                return false;
+            }
+            for (uint32_t j = i; j < std::min(rows, i + 100); j++) {
+                auto row = batch->NewRow();
+                std::string key = NextKey();
+                row->Init(key.size());
+                FillRow(key, row.get());
+            }
+            if (!router_->ExecuteInsert(WORKLOAD_DB, insert_sql_, batch, &status)) {
+                state->SkipWithError(("fail to put rows: " + status.msg).c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Put() {
+        hybridse::sdk::Status status;
+        auto row = router_->GetInsertRow(WORKLOAD_DB, insert_sql_, &status);
+        if (!row) {
+            return false;
+        }
+        std::string key = NextKey();
+        row->Init(key.size());
+        FillRow(key, row.get());
+        return router_->ExecuteInsert(WORKLOAD_DB, insert_sql_, row, &status);
+    }
+
+    std::shared_ptr<SQLRequestRow> NewRequestRow() {
+        hybridse::sdk::Status status;
+        auto row = router_->GetRequestRow(WORKLOAD_DB, query_sql_, &status);
+        if (!row) {
+            return {};
+        }
+        std::string key = NextKey();
+        row->Init(key.size());
+        FillRow(key, row.get());
+        return row;
+    }
+
+    std::shared_ptr<hybridse::sdk::ResultSet> Request(const std::shared_ptr<SQLRequestRow>& row) {
+        hybridse::sdk::Status status;
+        return router_->ExecuteSQLRequest(WORKLOAD_DB, query_sql_, row, &status);
+    }
+
+    std::shared_ptr<hybridse::sdk::ResultSet> BatchRequest(uint32_t batch_size) {
+        hybridse::sdk::Status status;
+        auto first = NewRequestRow();
+        if (!first) {
+            return {};
+        }
+        auto batch = std::make_shared<SQLRequestRowBatch>(first->GetSchema(),
+                                                          std::make_shared<ColumnIndicesSet>(first->GetSchema()));
+        batch->AddRow(first);
+        for (uint32_t i = 1; i < batch_size; i++) {
+            batch->AddRow(NewRequestRow());
+        }
+        return router_->ExecuteSQLBatchRequest(WORKLOAD_DB, query_sql_, batch, &status);
+    }
+
+    std::mt19937_64& GetRng() { return keys_.GetRng(); }
+    SQLRouter* GetRouter() { return router_.get(); }
+    const std::string& GetTable() const { return table_; }
+
+ private:
+    std::string NextKey() { return "key" + std::to_string(keys_.Next()); }
+
+    template <typename Row>
+    void FillRow(const std::string& key, Row* row) {
+        row->AppendString(key);
+        row->AppendTimestamp(ts_++);
+        std::uniform_real_distribution<double> value(0, 100);
+        for (uint32_t i = 0; i < FLAGS_workload_feature_cols; i++) {
+            row->AppendDouble(value(keys_.GetRng()));
+        }
+        row->Build();
+    }
+
+    // the features cycle over the aggregations, the columns and ten windows of different sizes
+    std::string BuildQuery() const {
+        static const char* AGGS[] = {"sum", "avg", "max", "min", "count"};
+        const uint32_t window_cnt = 10;
+        std::string sql = "select key, ts";
+        for (uint32_t i = 0; i < feature_cnt_; i++) {
+            uint32_t agg = i % 5;
+            uint32_t col = (i / 5) % FLAGS_workload_feature_cols;
+            uint32_t window = (i / (5 * FLAGS_workload_feature_cols)) % window_cnt;
+            sql += ", " + std::string(AGGS[agg]) + "(c" + std::to_string(col) + ") over w" + std::to_string(window) +
+                   " as f" + std::to_string(i);
+        }
+        sql += " from " + table_ + " window ";
+        for (uint32_t w = 0; w < window_cnt; w++) {
+            if (w > 0) {
+                sql += ", ";
+            }
+            sql += "w" + std::to_string(w) + " as (partition by key order by ts rows between " +
+                   std::to_string(10 * (w + 1)) + " preceding and current row)";
+        }
+        return sql + ";";
+    }
+
+    std::string table_;
+    uint32_t feature_cnt_;
+    ZipfGenerator keys_;
+    int64_t ts_;
+    std::shared_ptr<SQLRouter> router_;
+    std::string insert_sql_;
+    std::string query_sql_;
+};
+
+static std::string TableName(const std::string& prefix, const benchmark::State& state) {
+    return prefix + "_" + std::to_string(state.range(0));
+}
+
+static void BM_WorkloadPut(benchmark::State& state) {  // NOLINT
+    Workload workload(TableName("t_put", state), 0);
+    if (!workload.Init(state.range(0), &state)) {
+        return;
+    }
+    for (auto _ : state) {
+        if (!workload.Put()) {
+            state.SkipWithError("fail to put");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WorkloadPut)->ArgNames({"replica"})->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+static void BM_WorkloadRequest(benchmark::State& state) {  // NOLINT
+    Workload workload(TableName("t_request", state), state.range(0));
+    if (!workload.Init(1, &state) || !workload.Preload(FLAGS_workload_preload_rows, &state)) {
+        return;
+    }
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto row = workload.NewRequestRow();
+        state.ResumeTiming();
+        if (!row || !workload.Request(row)) {
+            state.SkipWithError("fail to execute request");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WorkloadRequest)->ArgNames({"features"})->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+static void BM_WorkloadBatchRequest(benchmark::State& state) {  // NOLINT
+    Workload workload(TableName("t_batch_request", state), state.range(0));
+    const uint32_t batch_size = state.range(1);
+    if (!workload.Init(1, &state) || !workload.Preload(FLAGS_workload_preload_rows, &state)) {
+        return;
+    }
+    for (auto _ : state) {
+        if (!workload.BatchRequest(batch_size)) {
+            state.SkipWithError("fail to execute batch request");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_WorkloadBatchRequest)
+    ->ArgNames({"features", "batch"})
+    ->Args({100, 16})
+    ->Args({1000, 16})
+    ->Unit(benchmark::kMicrosecond);
+
+// every iteration is a put in `put_percent` percent, or a request
+static void BM_WorkloadMixed(benchmark::State& state) {  // NOLINT
+    Workload workload(TableName("t_mixed", state), 100);
+    const int64_t put_percent = state.range(0);
+    if (!workload.Init(1, &state) || !workload.Preload(FLAGS_workload_preload_rows, &state)) {
+        return;
+    }
+    std::uniform_int_distribution<int64_t> percent(0, 99);
+    int64_t puts = 0;
+    for (auto _ : state) {
+        bool ok = false;
+        if (percent(workload.GetRng()) < put_percent) {
+            ok = workload.Put();
+            puts++;
+        } else {
+            auto row = workload.NewRequestRow();
+            ok = row && workload.Request(row);
+        }
+        if (!ok) {
+            state.SkipWithError("fail to execute mixed workload");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["puts"] = puts;
+}
+BENCHMARK(BM_WorkloadMixed)->ArgNames({"put_percent"})->Arg(10)->Arg(50)->Unit(benchmark::kMicrosecond);
+
+static bool GetTableStatus(const std::string& endpoint, uint32_t tid, uint32_t pid,
+                           ::openmldb::api::TableStatus* status) {
+    auto* client = mc->GetTabletClient(endpoint);
+    return client != nullptr && client->GetTableStatus(tid, pid, *status);
+}
+
+// the time to make the snapshot of a partition of `rows` rows
+static void BM_WorkloadSnapshot(benchmark::State& state) {  // NOLINT
+    Workload workload(TableName("t_snapshot", state), 0);
+    if (!workload.Init(1, &state)) {
+        return;
+    }
+    for (auto _ : state) {
+        if (!workload.Preload(state.range(0), &state)) {
+            break;
+        }
+        auto table_info = workload.GetRouter()->GetTableInfo(WORKLOAD_DB, workload.GetTable());
+        uint32_t tid = table_info.tid();
+        std::string leader;
+        for (const auto& meta : table_info.table_partition(0).partition_meta()) {
+            if (meta.is_leader()) {
+                leader = meta.endpoint();
+            }
+        }
+        ::openmldb::api::TableStatus status;
+        if (leader.empty() || !GetTableStatus(leader, tid, 0, &status)) {
+            state.SkipWithError("fail to get the leader of partition 0");
+            break;
+        }
+        auto* client = mc->GetTabletClient(leader);
+        auto start = std::chrono::steady_clock::now();
+        if (!client->MakeSnapshot(tid, 0, 0)) {
+            state.SkipWithError("fail to make snapshot");
+            break;
+        }
+        ::openmldb::api::Manifest manifest;
+        while (!client->GetManifest(tid, 0, ::openmldb::common::kMemory, manifest) ||
+               manifest.offset() < status.offset()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+BENCHMARK(BM_WorkloadSnapshot)->ArgNames({"rows"})->Arg(100000)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+// the time for the follower to catch up with the leader after a burst of `rows` rows
+static void BM_WorkloadReplicationCatchUp(benchmark::State& state) {  // NOLINT
+    Workload workload(TableName("t_replication", state), 0);
+    if (mc->GetTbEndpoint().size() < 2) {
+        state.SkipWithError("two tablets are required");
+        return;
+    }
+    if (!workload.Init(2, &state)) {
+        return;
+    }
+    auto table_info = workload.GetRouter()->GetTableInfo(WORKLOAD_DB, workload.GetTable());
+    uint32_t tid = table_info.tid();
+    for (auto _ : state) {
+        if (!workload.Preload(state.range(0), &state)) {
+            break;
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& partition : table_info.table_partition()) {
+            uint32_t pid = partition.pid();
+            ::openmldb::api::TableStatus leader_status;
+            for (const auto& meta : partition.partition_meta()) {
+                if (meta.is_leader()) {
+                    GetTableStatus(meta.endpoint(), tid, pid, &leader_status);
+                }
+            }
+            for (const auto& meta : partition.partition_meta()) {
+                ::openmldb::api::TableStatus status;
+                while (!meta.is_leader() && GetTableStatus(meta.endpoint(), tid, pid, &status) &&
+                       status.offset() < leader_status.offset()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+        state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+BENCHMARK(BM_WorkloadReplicationCatchUp)
+    ->ArgNames({"rows"})
+    ->Arg(10000)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+class NoopClosure : public ::google::protobuf::Closure {
+ public:
+    void Run() override {}
+};
+
+// the time to load a partition from the snapshot of `rows` rows and as many rows in binlog, on a tablet out of
+// the mini cluster as it can't restart its tablets
+static void BM_WorkloadRecovery(benchmark::State& state) {  // NOLINT
+    const uint32_t tid = 900000;
+    NoopClosure closure;
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_db(WORKLOAD_DB);
+    table_meta.set_name("t_recovery");
+    table_meta.set_tid(tid);
+    table_meta.set_pid(0);
+    table_meta.set_mode(::openmldb::api::TableMode::kTableLeader);
+    ::openmldb::codec::SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "key", ::openmldb::type::kString);
+    ::openmldb::codec::SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts", ::openmldb::type::kTimestamp);
+    for (uint32_t i = 0; i < FLAGS_workload_feature_cols; i++) {
+        ::openmldb::codec::SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "c" + std::to_string(i),
+                                                      ::openmldb::type::kDouble);
+    }
+    ::openmldb::codec::SchemaCodec::SetIndex(table_meta.add_column_key(), "key", "key", "ts",
+                                             ::openmldb::type::kAbsoluteTime, 0, 0);
+    ZipfGenerator keys(FLAGS_workload_key_cnt, FLAGS_workload_zipf_theta, FLAGS_workload_seed);
+    auto put_rows = [&](::openmldb::tablet::TabletImpl* tablet, int64_t rows, int64_t* ts) {
+        ::openmldb::codec::RowBuilder builder(table_meta.column_desc());
+        std::uniform_real_distribution<double> value(0, 100);
+        for (int64_t i = 0; i < rows; i++) {
+            std::string key = "key" + std::to_string(keys.Next());
+            std::string row(builder.CalTotalLength(key.size()), 0);
+            builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), row.size());
+            builder.AppendString(key.data(), key.size());
+            builder.AppendTimestamp((*ts)++);
+            for (uint32_t j = 0; j < FLAGS_workload_feature_cols; j++) {
+                builder.AppendDouble(value(keys.GetRng()));
+            }
+            ::openmldb::api::PutRequest request;
+            request.set_tid(tid);
+            request.set_pid(0);
+            request.set_value(row);
+            auto* dim = request.add_dimensions();
+            dim->set_key(key);
+            dim->set_idx(0);
+            ::openmldb::api::PutResponse response;
+            tablet->Put(nullptr, &request, &response, &closure);
+        }
+    };
+    int64_t ts = 1650000000000L;
+    {
+        ::openmldb::tablet::TabletImpl tablet;
+        tablet.Init("");
+        ::openmldb::api::CreateTableRequest request;
+        request.mutable_table_meta()->CopyFrom(table_meta);
+        ::openmldb::api::CreateTableResponse response;
+        tablet.CreateTable(nullptr, &request, &response, &closure);
+        if (response.code() != 0) {
+            state.SkipWithError(("fail to create table: " + response.msg()).c_str());
+            return;
+        }
+        put_rows(&tablet, state.range(0), &ts);
+        ::openmldb::api::GeneralRequest snapshot_request;
+        snapshot_request.set_tid(tid);
+        snapshot_request.set_pid(0);
+        ::openmldb::api::GeneralResponse snapshot_response;
+        tablet.MakeSnapshot(nullptr, &snapshot_request, &snapshot_response, &closure);
+        // wait for the snapshot made in background
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+        put_rows(&tablet, state.range(0), &ts);
+    }
+    for (auto _ : state) {
+        ::openmldb::tablet::TabletImpl tablet;
+        tablet.Init("");
+        ::openmldb::api::LoadTableRequest request;
+        request.mutable_table_meta()->CopyFrom(table_meta);
+        ::openmldb::api::GeneralResponse response;
+        auto start = std::chrono::steady_clock::now();
+        tablet.LoadTable(nullptr, &request, &response, &closure);
+        if (response.code() != 0) {
+            state.SkipWithError(("fail to load table: " + response.msg()).c_str());
+            break;
+        }
+        ::openmldb::api::GetTableStatusRequest status_request;
+        status_request.set_tid(tid);
+        status_request.set_pid(0);
+        while (true) {
+            ::openmldb::api::GetTableStatusResponse status_response;
+            tablet.GetTableStatus(nullptr, &status_request, &status_response, &closure);
+            if (status_response.all_table_status_size() > 0 &&
+                status_response.all_table_status(0).state() == ::openmldb::api::kTableNormal) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        state.counters["rows"] = 2 * state.range(0);
+    }
+    ::openmldb::tablet::TabletImpl tablet;
+    tablet.Init("");
+    ::openmldb::api::DropTableRequest drop_request;
+    drop_request.set_tid(tid);
+    drop_request.set_pid(0);
+    ::openmldb::api::LoadTableRequest load_request;
+    load_request.mutable_table_meta()->CopyFrom(table_meta);
+    ::openmldb::api::GeneralResponse load_response;
+    tablet.LoadTable(nullptr, &load_request, &load_response, &closure);
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    ::openmldb::api::DropTableResponse drop_response;
+    tablet.DropTable(nullptr, &drop_request, &drop_response, &closure);
+}
+BENCHMARK(BM_WorkloadRecovery)->ArgNames({"rows"})->Arg(100000)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+}  // namespace sdk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::hybridse::vm::Engine::InitializeGlobalLLVM();
+    FLAGS_enable_distsql = true;
+    FLAGS_enable_localtablet = true;
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    ::google::ParseCommandLineFlags(&argc, &argv, true);
+    ::openmldb::sdk::MiniCluster mini_cluster(6181);
+    ::openmldb::sdk::mc = &mini_cluster;
+    mini_cluster.SetUp(2);
+    sleep(2);
+    ::benchmark::RunSpecifiedBenchmarks();
+    mini_cluster.Close();
+}
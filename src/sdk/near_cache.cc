@@ -0,0 +1,152 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/near_cache.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+
+namespace openmldb {
+namespace sdk {
+
+NearTableCache::NearTableCache(uint32_t tid, uint32_t partition_num, uint64_t max_keys, uint64_t ttl_ms)
+    : tid_(tid),
+      partition_num_(std::max<uint32_t>(1, partition_num)),
+      ttl_ms_(ttl_ms),
+      mu_(),
+      partitions_(partition_num_),
+      caches_() {
+    uint64_t capacity = std::max<uint64_t>(1, max_keys / partition_num_);
+    for (uint32_t i = 0; i < partition_num_; i++) {
+        caches_.emplace_back(new Cache(capacity));
+    }
+}
+
+bool NearTableCache::NeedCheck(uint32_t pid, uint64_t now_ms) {
+    if (pid >= partition_num_) {
+        return false;
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto& partition = partitions_[pid];
+    if (partition.checking || (partition.valid && now_ms < partition.check_ms + ttl_ms_)) {
+        return false;
+    }
+    partition.checking = true;
+    return true;
+}
+
+void NearTableCache::UpdateOffset(uint32_t pid, bool ok, uint64_t offset, uint64_t now_ms) {
+    if (pid >= partition_num_) {
+        return;
+    }
+    bool clear = true;
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+        auto& partition = partitions_[pid];
+        clear = !ok || !partition.valid || partition.offset != offset;
+        // not trusted until the rows are dropped
+        partition.valid = partition.valid && !clear;
+    }
+    if (clear) {
+        // the rows being got meanwhile are not kept as the versions are bumped
+        caches_[pid]->Clear();
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto& partition = partitions_[pid];
+    partition.offset = offset;
+    partition.check_ms = now_ms;
+    partition.checking = false;
+    partition.valid = ok;
+}
+
+bool NearTableCache::IsFresh(uint32_t pid, uint64_t now_ms) const {
+    if (pid >= partition_num_) {
+        return false;
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    const auto& partition = partitions_[pid];
+    return partition.valid && now_ms < partition.check_ms + ttl_ms_;
+}
+
+boost::optional<std::string> NearTableCache::Get(uint32_t pid, const std::string& idx_name, const std::string& key) {
+    if (pid >= partition_num_) {
+        return boost::none;
+    }
+    return caches_[pid]->Get(CacheKey(idx_name, key));
+}
+
+uint64_t NearTableCache::GetVersion(uint32_t pid, const std::string& idx_name, const std::string& key) {
+    if (pid >= partition_num_) {
+        return 0;
+    }
+    return caches_[pid]->GetVersion(CacheKey(idx_name, key));
+}
+
+void NearTableCache::Put(uint32_t pid, const std::string& idx_name, const std::string& key, const std::string& value,
+                         uint64_t version) {
+    if (pid >= partition_num_) {
+        return;
+    }
+    caches_[pid]->UpsertIfVersion(CacheKey(idx_name, key), value, version);
+}
+
+uint64_t NearTableCache::GetHitCnt() const {
+    uint64_t cnt = 0;
+    for (const auto& cache : caches_) {
+        cnt += cache->GetHitCnt();
+    }
+    return cnt;
+}
+
+uint64_t NearTableCache::GetMissCnt() const {
+    uint64_t cnt = 0;
+    for (const auto& cache : caches_) {
+        cnt += cache->GetMissCnt();
+    }
+    return cnt;
+}
+
+void NearCache::Enable(const std::string& db, const std::string& table, uint64_t max_keys, uint64_t ttl_ms) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto& entry = tables_[std::make_pair(db, table)];
+    if (entry.max_keys != max_keys || entry.ttl_ms != ttl_ms) {
+        entry.max_keys = max_keys;
+        entry.ttl_ms = ttl_ms;
+        entry.cache.reset();
+    }
+}
+
+void NearCache::Disable(const std::string& db, const std::string& table) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    tables_.erase(std::make_pair(db, table));
+}
+
+std::shared_ptr<NearTableCache> NearCache::GetTable(const std::string& db, const std::string& table, uint32_t tid,
+                                                    uint32_t partition_num) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto iter = tables_.find(std::make_pair(db, table));
+    if (iter == tables_.end()) {
+        return {};
+    }
+    auto& entry = iter->second;
+    if (!entry.cache || entry.cache->GetTid() != tid || entry.cache->GetPartitionNum() != partition_num) {
+        entry.cache = std::make_shared<NearTableCache>(tid, partition_num, entry.max_keys, entry.ttl_ms);
+    }
+    return entry.cache;
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_NEAR_CACHE_H_
+#define SRC_SDK_NEAR_CACHE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/sharded_lru_cache.h"
+#include "base/spinlock.h"
+#include "boost/optional.hpp"
+
+namespace openmldb {
+namespace sdk {
+
+// NearTableCache keeps the latest rows of the keys got from a table written rarely, e.g. a dimension table, so the
+// batch gets of hot keys are answered without a rpc. A partition is trusted for ttl_ms after its log offset on the
+// leader is checked, then the next get checks the offset again and drops the rows of the partition if it moved,
+// so a row is at most ttl_ms stale. The gets of a partition not trusted go to the leader meanwhile.
+class NearTableCache {
+ public:
+    NearTableCache(uint32_t tid, uint32_t partition_num, uint64_t max_keys, uint64_t ttl_ms);
+    NearTableCache(const NearTableCache&) = delete;
+    NearTableCache& operator=(const NearTableCache&) = delete;
+
+    uint32_t GetTid() const { return tid_; }
+    uint32_t GetPartitionNum() const { return partition_num_; }
+
+    // true if the offset of the partition is to be checked, only one caller is told so until it updates the offset
+    bool NeedCheck(uint32_t pid, uint64_t now_ms);
+    // the offset of the partition on its leader, ok is false if it could not be got and the rows are dropped
+    void UpdateOffset(uint32_t pid, bool ok, uint64_t offset, uint64_t now_ms);
+    // the rows of the partition may be read if its offset is checked within ttl_ms
+    bool IsFresh(uint32_t pid, uint64_t now_ms) const;
+
+    // a key not found is kept as an empty value
+    boost::optional<std::string> Get(uint32_t pid, const std::string& idx_name, const std::string& key);
+    // taken before the row is got from the tablet, the row is not kept if the partition is dropped meanwhile
+    uint64_t GetVersion(uint32_t pid, const std::string& idx_name, const std::string& key);
+    void Put(uint32_t pid, const std::string& idx_name, const std::string& key, const std::string& value,
+             uint64_t version);
+
+    uint64_t GetHitCnt() const;
+    uint64_t GetMissCnt() const;
+
+ private:
+    using Cache = ::openmldb::base::ShardedLRUCache<std::string, std::string>;
+
+    struct Partition {
+        uint64_t offset = 0;
+        uint64_t check_ms = 0;
+        bool checking = false;
+        // false until the offset is got once
+        bool valid = false;
+    };
+
+    static std::string CacheKey(const std::string& idx_name, const std::string& key) {
+        return idx_name + '\0' + key;
+    }
+
+    const uint32_t tid_;
+    const uint32_t partition_num_;
+    const uint64_t ttl_ms_;
+    mutable ::openmldb::base::SpinMutex mu_;
+    std::vector<Partition> partitions_;
+    std::vector<std::unique_ptr<Cache>> caches_;
+};
+
+// the near caches of the tables of a router, opted in per table
+class NearCache {
+ public:
+    NearCache() : mu_(), tables_() {}
+    NearCache(const NearCache&) = delete;
+    NearCache& operator=(const NearCache&) = delete;
+
+    // max_keys is the number of keys kept of the table, the least recently used are evicted
+    void Enable(const std::string& db, const std::string& table, uint64_t max_keys, uint64_t ttl_ms);
+    void Disable(const std::string& db, const std::string& table);
+
+    // null if the table is not cached. the rows kept are dropped if the table is created again
+    std::shared_ptr<NearTableCache> GetTable(const std::string& db, const std::string& table, uint32_t tid,
+                                             uint32_t partition_num);
+
+ private:
+    struct TableEntry {
+        uint64_t max_keys = 0;
+        uint64_t ttl_ms = 0;
+        std::shared_ptr<NearTableCache> cache;
+    };
+
+    ::openmldb::base::SpinMutex mu_;
+    std::map<std::pair<std::string, std::string>, TableEntry> tables_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_NEAR_CACHE_H_
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/near_cache.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace sdk {
+
+class NearCacheTest : public ::testing::Test {};
+
+TEST_F(NearCacheTest, Offset) {
+    NearTableCache cache(1, 2, 100, 10);
+    // not trusted until the offset is checked
+    ASSERT_FALSE(cache.IsFresh(0, 0));
+    ASSERT_TRUE(cache.NeedCheck(0, 0));
+    ASSERT_FALSE(cache.NeedCheck(0, 0));
+    cache.UpdateOffset(0, true, 5, 0);
+    ASSERT_TRUE(cache.IsFresh(0, 9));
+    ASSERT_FALSE(cache.IsFresh(1, 9));
+    ASSERT_FALSE(cache.NeedCheck(0, 9));
+
+    cache.Put(0, "", "k1", "v1", cache.GetVersion(0, "", "k1"));
+    cache.Put(0, "", "k2", "", cache.GetVersion(0, "", "k2"));
+    ASSERT_EQ("v1", *cache.Get(0, "", "k1"));
+    ASSERT_EQ("", *cache.Get(0, "", "k2"));
+    // the keys of the indexes are kept apart
+    ASSERT_FALSE(cache.Get(0, "idx1", "k1"));
+
+    // the same offset keeps the rows
+    ASSERT_FALSE(cache.IsFresh(0, 10));
+    ASSERT_TRUE(cache.NeedCheck(0, 10));
+    cache.UpdateOffset(0, true, 5, 10);
+    ASSERT_TRUE(cache.IsFresh(0, 10));
+    ASSERT_EQ("v1", *cache.Get(0, "", "k1"));
+
+    // the offset moved
+    ASSERT_TRUE(cache.NeedCheck(0, 20));
+    cache.UpdateOffset(0, true, 6, 20);
+    ASSERT_TRUE(cache.IsFresh(0, 20));
+    ASSERT_FALSE(cache.Get(0, "", "k1"));
+
+    // the offset failed to be got
+    cache.Put(0, "", "k1", "v2", cache.GetVersion(0, "", "k1"));
+    ASSERT_TRUE(cache.NeedCheck(0, 30));
+    cache.UpdateOffset(0, false, 0, 30);
+    ASSERT_FALSE(cache.IsFresh(0, 30));
+    ASSERT_FALSE(cache.Get(0, "", "k1"));
+    ASSERT_TRUE(cache.NeedCheck(0, 30));
+}
+
+TEST_F(NearCacheTest, Version) {
+    NearTableCache cache(1, 1, 100, 10);
+    ASSERT_TRUE(cache.NeedCheck(0, 0));
+    cache.UpdateOffset(0, true, 5, 0);
+    uint64_t version = cache.GetVersion(0, "", "k1");
+    // the partition is dropped while the row is got
+    ASSERT_TRUE(cache.NeedCheck(0, 10));
+    cache.UpdateOffset(0, true, 6, 10);
+    cache.Put(0, "", "k1", "v1", version);
+    ASSERT_FALSE(cache.Get(0, "", "k1"));
+    cache.Put(0, "", "k1", "v1", cache.GetVersion(0, "", "k1"));
+    ASSERT_EQ("v1", *cache.Get(0, "", "k1"));
+    ASSERT_FALSE(cache.Get(1, "", "k1"));
+}
+
+TEST_F(NearCacheTest, Tables) {
+    NearCache near_cache;
+    ASSERT_FALSE(near_cache.GetTable("db1", "t1", 1, 2));
+    near_cache.Enable("db1", "t1", 100, 10);
+    auto cache = near_cache.GetTable("db1", "t1", 1, 2);
+    ASSERT_TRUE(cache);
+    ASSERT_EQ(cache, near_cache.GetTable("db1", "t1", 1, 2));
+    ASSERT_FALSE(near_cache.GetTable("db1", "t2", 2, 2));
+    // the same options keep the rows
+    near_cache.Enable("db1", "t1", 100, 10);
+    ASSERT_EQ(cache, near_cache.GetTable("db1", "t1", 1, 2));
+    // the table is created again
+    auto recreated = near_cache.GetTable("db1", "t1", 3, 2);
+    ASSERT_NE(cache, recreated);
+    ASSERT_EQ(3u, recreated->GetTid());
+    near_cache.Enable("db1", "t1", 10, 10);
+    ASSERT_NE(recreated, near_cache.GetTable("db1", "t1", 3, 2));
+    near_cache.Disable("db1", "t1");
+    ASSERT_FALSE(near_cache.GetTable("db1", "t1", 3, 2));
+}
+
+}  // namespace sdk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -47,6 +47,7 @@ bool NodeAdapter::TransformToTableDef(::hybridse::node::CreatePlanNode* create_n
     hybridse::node::NodePointVector distribution_list;
 
     hybridse::node::StorageMode storage_mode = hybridse::node::kMemory;
+    bool broadcast = false;
     // different default value for cluster and standalone mode
     int replica_num = 1;
     int partition_num = 1;
@@ -71,6 +72,10 @@ bool NodeAdapter::TransformToTableDef(::hybridse::node::CreatePlanNode* create_n
                     storage_mode = dynamic_cast<hybridse::node::StorageModeNode *>(table_option)->GetStorageMode();
                     break;
                 }
+                case hybridse::node::kBroadcast: {
+                    broadcast = dynamic_cast<hybridse::node::BroadcastNode*>(table_option)->GetBroadcast();
+                    break;
+                }
                 case hybridse::node::kDistributions: {
                     auto d_list = dynamic_cast<hybridse::node::DistributionsNode*>(table_option)->GetDistributionList();
                     if (d_list != nullptr) {
@@ -100,6 +105,16 @@ bool NodeAdapter::TransformToTableDef(::hybridse::node::CreatePlanNode* create_n
             return false;
         }
     }
+    if (broadcast && is_cluster_mode) {
+        if (!distribution_list.empty()) {
+            status->msg = "Fail to create table with the distribution configuration for a broadcast table";
+            status->code = hybridse::common::kUnsupportSql;
+            return false;
+        }
+        // the nameserver puts a replica of the only partition on every tablet
+        partition_num = 1;
+        table->set_broadcast(true);
+    }
     table->set_replica_num(replica_num);
     table->set_partition_num(partition_num);
 
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/prepared_statement.h"
+
+#include <string>
+
+#include "base/status.h"
+#include "brpc/channel.h"
+#include "glog/logging.h"
+#include "sdk/result_set_sql.h"
+
+namespace openmldb {
+namespace sdk {
+
+PreparedStatement::PreparedStatement(DBSDK* cluster_sdk, const std::string& db, const std::string& sql,
+                                     std::shared_ptr<hybridse::sdk::Schema> parameter_schema,
+                                     const std::vector<openmldb::type::DataType>& parameter_types,
+                                     const std::string& main_db, const std::string& main_table,
+                                     int64_t request_timeout_ms)
+    : cluster_sdk_(cluster_sdk),
+      db_(db),
+      sql_(sql),
+      parameter_schema_(parameter_schema),
+      parameter_types_(parameter_types),
+      main_db_(main_db),
+      main_table_(main_table),
+      request_timeout_ms_(request_timeout_ms),
+      mu_(),
+      statement_ids_() {}
+
+std::shared_ptr<::openmldb::client::TabletClient> PreparedStatement::GetTabletClient() {
+    auto tablet_accessor =
+        main_table_.empty() ? cluster_sdk_->GetTablet() : cluster_sdk_->GetTablet(main_db_, main_table_);
+    if (!tablet_accessor) {
+        return {};
+    }
+    return tablet_accessor->GetClient();
+}
+
+uint64_t PreparedStatement::GetStatementId(const std::string& endpoint) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto iter = statement_ids_.find(endpoint);
+    return iter == statement_ids_.end() ? 0 : iter->second;
+}
+
+void PreparedStatement::SetStatementId(const std::string& endpoint, uint64_t id) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (id == 0) {
+        statement_ids_.erase(endpoint);
+    } else {
+        statement_ids_[endpoint] = id;
+    }
+}
+
+std::shared_ptr<hybridse::sdk::ResultSet> PreparedStatement::Execute(const std::shared_ptr<SQLRequestRow>& parameter,
+                                                                     hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return {};
+    }
+    if (!parameter_types_.empty() &&
+        (!parameter || parameter->GetSchema()->GetColumnCnt() != static_cast<int>(parameter_types_.size()))) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "the parameter row does not match the prepared schema"};
+        return {};
+    }
+    auto client = GetTabletClient();
+    if (!client) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "no tablet available for sql"};
+        return {};
+    }
+    const std::string& endpoint = client->GetEndpoint();
+    uint64_t statement_id = GetStatementId(endpoint);
+    const std::string& parameter_row = parameter ? parameter->GetRow() : "";
+    while (true) {
+        auto cntl = std::make_shared<::brpc::Controller>();
+        cntl->set_timeout_ms(request_timeout_ms_);
+        auto response = std::make_shared<::openmldb::api::QueryResponse>();
+        if (client->PreparedQuery(db_, sql_, statement_id, parameter_types_, parameter_row, cntl.get(),
+                                  response.get())) {
+            if (statement_id == 0) {
+                SetStatementId(endpoint, response->statement_id());
+            }
+            *status = {};
+            return ResultSetSQL::MakeResultSet(response, cntl, status);
+        }
+        if (statement_id != 0 && response->code() == ::openmldb::base::kStatementNotFound) {
+            // prepare it again with the sql
+            DLOG(INFO) << "statement " << statement_id << " is not found on " << endpoint;
+            SetStatementId(endpoint, 0);
+            statement_id = 0;
+            continue;
+        }
+        *status = {::hybridse::common::StatusCode::kCmdError,
+                   response->msg().empty() ? cntl->ErrorText() : response->msg()};
+        return {};
+    }
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_PREPARED_STATEMENT_H_
+#define SRC_SDK_PREPARED_STATEMENT_H_
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "client/tablet_client.h"
+#include "sdk/base.h"
+#include "sdk/db_sdk.h"
+#include "sdk/result_set.h"
+#include "sdk/sql_request_row.h"
+
+namespace openmldb {
+namespace sdk {
+
+// PreparedStatement runs one online batch query with different parameters. The query is parsed and routed
+// once when it is prepared, and compiled once on every tablet it runs on: the first execution on a tablet
+// sends the sql and the tablet returns the id of the compiled query it keeps, the later ones send only the
+// id and the parameter row. The sql is sent again if the tablet has evicted the query or dropped it as the
+// tables of the db changed.
+class PreparedStatement {
+ public:
+    PreparedStatement(DBSDK* cluster_sdk, const std::string& db, const std::string& sql,
+                      std::shared_ptr<hybridse::sdk::Schema> parameter_schema,
+                      const std::vector<openmldb::type::DataType>& parameter_types, const std::string& main_db,
+                      const std::string& main_table, int64_t request_timeout_ms);
+
+    // the schema the parameter rows should be built with, null if the query has no parameter
+    const std::shared_ptr<hybridse::sdk::Schema>& GetParameterSchema() const { return parameter_schema_; }
+
+    std::shared_ptr<hybridse::sdk::ResultSet> Execute(const std::shared_ptr<SQLRequestRow>& parameter,
+                                                      hybridse::sdk::Status* status);
+
+ private:
+    std::shared_ptr<::openmldb::client::TabletClient> GetTabletClient();
+    uint64_t GetStatementId(const std::string& endpoint);
+    void SetStatementId(const std::string& endpoint, uint64_t id);
+
+    DBSDK* cluster_sdk_;
+    std::string db_;
+    std::string sql_;
+    std::shared_ptr<hybridse::sdk::Schema> parameter_schema_;
+    std::vector<openmldb::type::DataType> parameter_types_;
+    std::string main_db_;
+    std::string main_table_;
+    int64_t request_timeout_ms_;
+    std::mutex mu_;
+    // tablet endpoint -> the id of the query prepared on it
+    std::map<std::string, uint64_t> statement_ids_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_PREPARED_STATEMENT_H_
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/replica_selector.h"
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/timer.h"
+#include "glog/logging.h"
+
+namespace openmldb {
+namespace sdk {
+
+bool ReplicaSelector::GetOffset(const std::shared_ptr<::openmldb::catalog::TabletAccessor>& tablet, uint32_t tid,
+                                uint32_t pid, uint64_t* offset) {
+    uint64_t now_ms = ::baidu::common::timer::get_micros() / 1000;
+    std::shared_ptr<TableOffsets> table_offsets;
+    bool refresh = false;
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+        auto& entry = offsets_[std::make_pair(tablet->GetName(), tid)];
+        if (!entry) {
+            entry = std::make_shared<TableOffsets>();
+        }
+        table_offsets = entry;
+        if (!table_offsets->refreshing && now_ms >= table_offsets->update_ms + refresh_ms_) {
+            table_offsets->refreshing = true;
+            refresh = true;
+        }
+    }
+    if (refresh) {
+        std::map<uint32_t, uint64_t> offsets;
+        ::openmldb::api::GetTableStatusResponse response;
+        auto client = tablet->GetClient();
+        if (client && client->GetTableStatus(tid, response)) {
+            for (const auto& status : response.all_table_status()) {
+                if (status.tid() == tid && status.has_offset() &&
+                    status.state() == ::openmldb::api::TableState::kTableNormal) {
+                    offsets.emplace(status.pid(), status.offset());
+                }
+            }
+        } else {
+            LOG(WARNING) << "fail to get the offsets of table " << tid << " on " << tablet->GetName();
+        }
+        std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+        table_offsets->offsets.swap(offsets);
+        table_offsets->update_ms = now_ms;
+        table_offsets->refreshing = false;
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto it = table_offsets->offsets.find(pid);
+    if (it == table_offsets->offsets.end()) {
+        return false;
+    }
+    *offset = it->second;
+    return true;
+}
+
+std::shared_ptr<::openmldb::catalog::TabletAccessor> ReplicaSelector::Select(
+    ::openmldb::catalog::SDKTableHandler* handler, uint32_t pid, uint64_t max_lag,
+    ::openmldb::api::FollowerRead* follower_read) {
+    auto leader = handler->GetTablet(pid);
+    if (!leader) {
+        return leader;
+    }
+    auto followers = handler->GetFollowers(pid);
+    uint64_t leader_offset = 0;
+    if (followers.empty() || !GetOffset(leader, handler->GetTid(), pid, &leader_offset)) {
+        return leader;
+    }
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> replicas = {leader};
+    for (const auto& follower : followers) {
+        uint64_t offset = 0;
+        if (follower->GetName() != leader->GetName() && GetOffset(follower, handler->GetTid(), pid, &offset) &&
+            offset + max_lag >= leader_offset) {
+            replicas.push_back(follower);
+        }
+    }
+    size_t idx = counter_.fetch_add(1, std::memory_order_relaxed) % replicas.size();
+    if (idx > 0) {
+        follower_read->set_tid(handler->GetTid());
+        follower_read->set_pid(pid);
+        follower_read->set_max_lag(max_lag);
+    }
+    return replicas[idx];
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_REPLICA_SELECTOR_H_
+#define SRC_SDK_REPLICA_SELECTOR_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/spinlock.h"
+#include "catalog/sdk_catalog.h"
+#include "proto/tablet.pb.h"
+
+namespace openmldb {
+namespace sdk {
+
+// ReplicaSelector spreads the reads of a partition over its leader and the followers caught up with it, a
+// follower is caught up if its offset lags the one of the leader by no more than max_lag. The offsets are taken
+// from GetTableStatus of the tablets and refreshed by the reader finding them older than refresh_ms, the others
+// use the old ones meanwhile. A replica of unknown offset is not selected.
+class ReplicaSelector {
+ public:
+    explicit ReplicaSelector(uint32_t refresh_ms) : refresh_ms_(refresh_ms), counter_(0), mu_(), offsets_() {}
+    ReplicaSelector(const ReplicaSelector&) = delete;
+    ReplicaSelector& operator=(const ReplicaSelector&) = delete;
+
+    // select a replica of pid of the table in turn, follower_read is set for the tablet to check the lag again
+    // if a follower is selected. the leader is returned if no follower is caught up
+    std::shared_ptr<::openmldb::catalog::TabletAccessor> Select(::openmldb::catalog::SDKTableHandler* handler,
+                                                                uint32_t pid, uint64_t max_lag,
+                                                                ::openmldb::api::FollowerRead* follower_read);
+
+ private:
+    struct TableOffsets {
+        uint64_t update_ms = 0;
+        bool refreshing = false;
+        // pid -> the log offset of the partitions of the table on the tablet
+        std::map<uint32_t, uint64_t> offsets;
+    };
+
+    // the offset of the partition is unknown if the tablet cannot be reached or does not have it
+    bool GetOffset(const std::shared_ptr<::openmldb::catalog::TabletAccessor>& tablet, uint32_t tid, uint32_t pid,
+                   uint64_t* offset);
+
+    const uint64_t refresh_ms_;
+    std::atomic<uint64_t> counter_;
+    ::openmldb::base::SpinMutex mu_;
+    // (tablet name, tid) -> the offsets
+    std::map<std::pair<std::string, uint32_t>, std::shared_ptr<TableOffsets>> offsets_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_REPLICA_SELECTOR_H_
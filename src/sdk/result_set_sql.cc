@@ -155,5 +155,74 @@ std::shared_ptr<::hybridse::sdk::ResultSet> ResultSetSQL::MakeResultSet(
     return {};
 }
 
+ChunkedResultSetSQL::ChunkedResultSetSQL(const ::hybridse::vm::Schema& schema, uint32_t total_cnt,
+                                         const FetchFunc& fetch)
+    : schema_(schema), total_cnt_(total_cnt), fetch_(fetch), chunk_(), result_id_(0), first_chunk_(true) {}
+
+std::shared_ptr<::hybridse::sdk::ResultSet> ChunkedResultSetSQL::MakeResultSet(
+    const std::shared_ptr<::openmldb::api::QueryResponse>& response, const std::shared_ptr<brpc::Controller>& cntl,
+    const FetchFunc& fetch, ::hybridse::sdk::Status* status) {
+    if (!status || !response || !cntl) {
+        return std::shared_ptr<ResultSet>();
+    }
+    if (response->result_id() == 0 || !fetch) {
+        return ResultSetSQL::MakeResultSet(response, cntl, status);
+    }
+    ::hybridse::vm::Schema schema;
+    if (!::hybridse::codec::SchemaCodec::Decode(response->schema(), &schema)) {
+        status->code = -1;
+        status->msg = "request error, fail to decodec schema";
+        return std::shared_ptr<ResultSet>();
+    }
+    auto rs = std::make_shared<ChunkedResultSetSQL>(schema, response->total_count(), fetch);
+    if (!rs->SetChunk(response, cntl)) {
+        status->code = -1;
+        status->msg = "request error, ResultSetSQL init failed";
+        return std::shared_ptr<ResultSet>();
+    }
+    return rs;
+}
+
+bool ChunkedResultSetSQL::SetChunk(const std::shared_ptr<::openmldb::api::QueryResponse>& response,
+                                   const std::shared_ptr<brpc::Controller>& cntl) {
+    auto chunk = std::make_shared<ResultSetSQL>(schema_, response->count(), response->byte_size(), cntl);
+    if (!chunk->Init()) {
+        return false;
+    }
+    chunk_ = chunk;
+    result_id_ = response->result_id();
+    return true;
+}
+
+bool ChunkedResultSetSQL::Reset() {
+    if (!first_chunk_) {
+        return false;
+    }
+    return chunk_->Reset();
+}
+
+bool ChunkedResultSetSQL::Next() {
+    while (!chunk_->Next()) {
+        if (result_id_ == 0) {
+            return false;
+        }
+        auto cntl = std::make_shared<brpc::Controller>();
+        auto response = std::make_shared<::openmldb::api::QueryResponse>();
+        uint64_t result_id = result_id_;
+        // the rows not fetched yet are lost if the fetch fails, as the rows beyond the max bytes were truncated
+        result_id_ = 0;
+        if (!fetch_(result_id, cntl.get(), response.get())) {
+            LOG(WARNING) << "fail to fetch the rows of query result " << result_id << ": " << response->msg();
+            return false;
+        }
+        if (!SetChunk(response, cntl)) {
+            LOG(WARNING) << "fail to init the rows of query result " << result_id;
+            return false;
+        }
+        first_chunk_ = false;
+    }
+    return true;
+}
+
 }  // namespace sdk
 }  // namespace openmldb
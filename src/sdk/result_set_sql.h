@@ -17,6 +17,7 @@
 #ifndef SRC_SDK_RESULT_SET_SQL_H_
 #define SRC_SDK_RESULT_SET_SQL_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -100,6 +101,70 @@ class ResultSetSQL : public ::hybridse::sdk::ResultSet {
     std::shared_ptr<butil::IOBuf> io_buf_;
 };
 
+// The rows of a batch query sent by the tablet in chunks. The next chunk is fetched once the rows of the last one are
+// read, so the rows are never all in the memory of the client, and Size is the count of all rows
+class ChunkedResultSetSQL : public ::hybridse::sdk::ResultSet {
+ public:
+    // fetch the next chunk of the rows kept under the result id
+    using FetchFunc =
+        std::function<bool(uint64_t result_id, brpc::Controller* cntl, ::openmldb::api::QueryResponse* response)>;
+
+    ChunkedResultSetSQL(const ::hybridse::vm::Schema& schema, uint32_t total_cnt, const FetchFunc& fetch);
+
+    // return a ResultSetSQL if all rows are in the response
+    static std::shared_ptr<::hybridse::sdk::ResultSet> MakeResultSet(
+        const std::shared_ptr<::openmldb::api::QueryResponse>& response, const std::shared_ptr<brpc::Controller>& cntl,
+        const FetchFunc& fetch, ::hybridse::sdk::Status* status);
+
+    // only the rows of the first chunk can be read again
+    bool Reset() override;
+
+    bool Next() override;
+
+    bool IsNULL(int index) override { return chunk_->IsNULL(index); }
+
+    bool GetString(uint32_t index, std::string* str) override { return chunk_->GetString(index, str); }
+
+    bool GetBool(uint32_t index, bool* result) override { return chunk_->GetBool(index, result); }
+
+    bool GetChar(uint32_t index, char* result) override { return chunk_->GetChar(index, result); }
+
+    bool GetInt16(uint32_t index, int16_t* result) override { return chunk_->GetInt16(index, result); }
+
+    bool GetInt32(uint32_t index, int32_t* result) override { return chunk_->GetInt32(index, result); }
+
+    bool GetInt64(uint32_t index, int64_t* result) override { return chunk_->GetInt64(index, result); }
+
+    bool GetFloat(uint32_t index, float* result) override { return chunk_->GetFloat(index, result); }
+
+    bool GetDouble(uint32_t index, double* result) override { return chunk_->GetDouble(index, result); }
+
+    bool GetDate(uint32_t index, int32_t* date) override { return chunk_->GetDate(index, date); }
+
+    bool GetDate(uint32_t index, int32_t* year, int32_t* month, int32_t* day) override {
+        return chunk_->GetDate(index, year, month, day);
+    }
+
+    bool GetTime(uint32_t index, int64_t* mills) override { return chunk_->GetTime(index, mills); }
+
+    const ::hybridse::sdk::Schema* GetSchema() override { return chunk_->GetSchema(); }
+
+    int32_t Size() override { return total_cnt_; }
+
+ private:
+    bool SetChunk(const std::shared_ptr<::openmldb::api::QueryResponse>& response,
+                  const std::shared_ptr<brpc::Controller>& cntl);
+
+ private:
+    ::hybridse::vm::Schema schema_;
+    uint32_t total_cnt_;
+    FetchFunc fetch_;
+    std::shared_ptr<ResultSetSQL> chunk_;
+    // 0 if the chunk is the last one
+    uint64_t result_id_;
+    bool first_chunk_;
+};
+
 class MultipleResultSetSQL : public ::hybridse::sdk::ResultSet {
  public:
     explicit MultipleResultSetSQL(const std::vector<std::shared_ptr<ResultSetSQL>>& result_set_list,
@@ -17,36 +17,52 @@
 #include "sdk/sql_cluster_router.h"
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <fstream>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <utility>
 
 #include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/strip.h"
 #include "base/ddl_parser.h"
 #include "base/file_util.h"
+#include "base/hash.h"
+#include "base/partition_router.h"
 #include "boost/none.hpp"
 #include "boost/property_tree/ini_parser.hpp"
 #include "boost/property_tree/ptree.hpp"
 #include "brpc/channel.h"
+#include "bthread/bthread.h"
 #include "cmd/display.h"
+#include "codec/fe_row_codec.h"
+#include "codec/schema_codec.h"
 #include "common/timer.h"
 #include "glog/logging.h"
 #include "nameserver/system_table.h"
 #include "plan/plan_api.h"
 #include "proto/tablet.pb.h"
+#include "rpc/hedged_call.h"
 #include "rpc/rpc_client.h"
 #include "schema/schema_adapter.h"
 #include "sdk/base.h"
 #include "sdk/base_impl.h"
 #include "sdk/batch_request_result_set_sql.h"
+#include "sdk/bulk_load_builder.h"
+#include "sdk/columnar_file_loader.h"
 #include "sdk/file_option_parser.h"
+#include "sdk/line_chunk_reader.h"
 #include "sdk/node_adapter.h"
 #include "sdk/result_set_sql.h"
 #include "sdk/split.h"
+#include "sdk/table_exporter.h"
 
 DECLARE_int32(request_timeout_ms);
 DECLARE_string(bucket_size);
@@ -58,6 +74,26 @@ namespace sdk {
 
 using hybridse::plan::PlanAPI;
 
+// the deployment option and the session variable of the max lag of the followers to read from
+constexpr const char* FOLLOWER_READ_MAX_LAG = "follower_read_max_lag";
+// load data infile reads the file in chunks of the size and reports the progress at the interval
+constexpr uint64_t kLoadChunkBytes = 4 * 1024 * 1024;
+constexpr uint64_t kLoadReportIntervalMs = 10000;
+
+// the online load data infile with load_mode 'local' is done by the client instead of the task manager
+static bool IsLocalLoad(const std::shared_ptr<hybridse::node::OptionsMap>& options) {
+    if (!options) {
+        return false;
+    }
+    for (const auto& kv : *options) {
+        if (absl::EqualsIgnoreCase(kv.first, "load_mode") && kv.second != nullptr &&
+            absl::EqualsIgnoreCase(kv.second->GetAsString(), "local")) {
+            return true;
+        }
+    }
+    return false;
+}
+
 class ExplainInfoImpl : public ExplainInfo {
  public:
     ExplainInfoImpl(const ::hybridse::sdk::SchemaImpl& input_schema, const ::hybridse::sdk::SchemaImpl& output_schema,
@@ -194,6 +230,8 @@ SQLClusterRouter::SQLClusterRouter(const SQLRouterOptions& options)
       is_cluster_mode_(true),
       interactive_(false),
       cluster_sdk_(nullptr),
+      input_lru_cache_(std::make_shared<const SQLCacheMap>()),
+      cache_mu_(),
       mu_(),
       rand_(::baidu::common::timer::now_time()) {}
 
@@ -202,6 +240,8 @@ SQLClusterRouter::SQLClusterRouter(const StandaloneOptions& options)
       is_cluster_mode_(false),
       interactive_(false),
       cluster_sdk_(nullptr),
+      input_lru_cache_(std::make_shared<const SQLCacheMap>()),
+      cache_mu_(),
       mu_(),
       rand_(::baidu::common::timer::now_time()) {}
 
@@ -210,6 +250,8 @@ SQLClusterRouter::SQLClusterRouter(DBSDK* sdk)
       is_cluster_mode_(sdk->IsClusterMode()),
       interactive_(false),
       cluster_sdk_(sdk),
+      input_lru_cache_(std::make_shared<const SQLCacheMap>()),
+      cache_mu_(),
       mu_(),
       rand_(::baidu::common::timer::now_time()) {}
 
@@ -258,6 +300,8 @@ bool SQLClusterRouter::Init() {
             }
         }
     }
+    replica_selector_ = std::make_shared<ReplicaSelector>(options_.replica_offset_refresh_ms);
+    near_cache_ = std::make_shared<NearCache>();
     std::string db = openmldb::nameserver::INFORMATION_SCHEMA_DB;
     std::string table = openmldb::nameserver::GLOBAL_VARIABLES;
     std::string sql = "select * from " + table;
@@ -597,15 +641,15 @@ DefaultValueMap SQLClusterRouter::GetDefaultMap(std::shared_ptr<::openmldb::name
 // Get Cache with given db, sql and engine mode
 std::shared_ptr<SQLCache> SQLClusterRouter::GetCache(const std::string& db, const std::string& sql,
                                                      const hybridse::vm::EngineMode engine_mode) {
-    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
-    auto mode_cache_it = input_lru_cache_.find(db);
-    if (mode_cache_it == input_lru_cache_.end()) {
+    auto caches = std::atomic_load_explicit(&input_lru_cache_, std::memory_order_acquire);
+    auto mode_cache_it = caches->find(db);
+    if (mode_cache_it == caches->end()) {
         return {};
     }
 
     auto it = mode_cache_it->second.find(engine_mode);
     if (it != mode_cache_it->second.end()) {
-        auto value = it->second.get(sql);
+        auto value = it->second->get(sql);
         if (value != boost::none) {
             // Check cache validation, the name is the same, but the tid may be different.
             // Notice that we won't check it when table_info is disabled and router is enabled.
@@ -627,21 +671,27 @@ std::shared_ptr<SQLCache> SQLClusterRouter::GetCache(const std::string& db, cons
 void SQLClusterRouter::SetCache(const std::string& db, const std::string& sql,
                                 const hybridse::vm::EngineMode engine_mode,
                                 const std::shared_ptr<SQLCache>& router_cache) {
-    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
-    auto it = input_lru_cache_.find(db);
-    if (it == input_lru_cache_.end()) {
-        decltype(input_lru_cache_)::mapped_type db_value;
-        input_lru_cache_.insert(std::make_pair(db, db_value));
-        it = input_lru_cache_.find(db);
-    }
-
-    auto cache_it = it->second.find(engine_mode);
-    if (cache_it == it->second.end()) {
-        decltype(it->second)::mapped_type value(options_.max_sql_cache_size);
-        it->second.insert(std::make_pair(engine_mode, value));
-        cache_it = it->second.find(engine_mode);
+    std::shared_ptr<SQLLRUCache> cache;
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(cache_mu_);
+        auto caches = std::atomic_load_explicit(&input_lru_cache_, std::memory_order_acquire);
+        auto it = caches->find(db);
+        if (it != caches->end()) {
+            auto cache_it = it->second.find(engine_mode);
+            if (cache_it != it->second.end()) {
+                cache = cache_it->second;
+            }
+        }
+        if (!cache) {
+            // a new db or engine mode is rare, so the whole map is copied
+            auto new_caches = std::make_shared<SQLCacheMap>(*caches);
+            cache = std::make_shared<SQLLRUCache>(options_.max_sql_cache_size);
+            (*new_caches)[db][engine_mode] = cache;
+            std::atomic_store_explicit(&input_lru_cache_, std::shared_ptr<const SQLCacheMap>(new_caches),
+                                       std::memory_order_release);
+        }
     }
-    cache_it->second.upsert(sql, router_cache);
+    cache->upsert(sql, router_cache);
 }
 
 std::shared_ptr<SQLInsertRows> SQLClusterRouter::GetInsertRows(const std::string& db, const std::string& sql,
@@ -858,7 +908,7 @@ std::shared_ptr<SQLCache> SQLClusterRouter::GetSQLCache(const std::string& db, c
     }
     auto cache = GetCache(db, sql, engine_mode);
     auto parameter_schema = std::make_shared<::hybridse::sdk::SchemaImpl>(parameter_schema_raw);
-    if (cache && cache->IsCompatibleCache(parameter_schema)) {
+    if (cache && !cache->IsCompatibleCache(parameter_schema)) {
         cache.reset();
     }
     if (!cache) {
@@ -964,12 +1014,143 @@ std::shared_ptr<::openmldb::client::TabletClient> SQLClusterRouter::GetTabletCli
 }
 
 std::shared_ptr<TableReader> SQLClusterRouter::GetTableReader() {
-    return std::make_shared<TableReaderImpl>(cluster_sdk_);
+    uint64_t max_lag = 0;
+    if (GetFollowerReadMaxLag({}, &max_lag)) {
+        return std::make_shared<TableReaderImpl>(cluster_sdk_, replica_selector_, max_lag, near_cache_);
+    }
+    return std::make_shared<TableReaderImpl>(cluster_sdk_, near_cache_);
+}
+
+std::shared_ptr<BulkLoader> SQLClusterRouter::GetBulkLoader(const std::string& db, const std::string& table,
+                                                            hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return {};
+    }
+    auto table_info = cluster_sdk_->GetTableInfo(db, table);
+    if (!table_info) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "table " + table + " in db " + db + " does not exist"};
+        return {};
+    }
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets;
+    if (!cluster_sdk_->GetTablet(db, table, &tablets) || tablets.empty()) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "fail to get the tablets of table " + table};
+        return {};
+    }
+    return std::make_shared<BulkLoaderImpl>(table_info, tablets);
+}
+
+std::shared_ptr<AsyncInserter> SQLClusterRouter::CreateAsyncInserter(const std::string& db, const std::string& sql,
+                                                                     const AsyncInsertOptions& options,
+                                                                     hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return {};
+    }
+    if (!GetInsertRows(db, sql, status) || status->code != 0) {
+        return {};
+    }
+    std::shared_ptr<SQLCache> cache = GetCache(db, sql, hybridse::vm::kBatchMode);
+    if (!cache) {
+        status->code = -1;
+        status->msg = "fail to prepare insert sql " + sql;
+        return {};
+    }
+    auto inserter = std::make_shared<AsyncInserter>(cluster_sdk_, cache->table_info, options);
+    if (!inserter->Init()) {
+        status->code = -1;
+        status->msg = "fail to init async inserter";
+        return {};
+    }
+    status->code = 0;
+    return inserter;
+}
+
+std::shared_ptr<AsyncProcedureCaller> SQLClusterRouter::CreateAsyncProcedureCaller(const std::string& db,
+                                                                                   const std::string& sp_name,
+                                                                                   const AsyncCallOptions& options,
+                                                                                   hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return {};
+    }
+    std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info = cluster_sdk_->GetProcedureInfo(db, sp_name, &status->msg);
+    if (!sp_info) {
+        status->code = -1;
+        status->msg = "procedure not found, msg: " + status->msg;
+        LOG(WARNING) << status->msg;
+        return {};
+    }
+    auto caller = std::make_shared<AsyncProcedureCaller>(cluster_sdk_, sp_info, options);
+    if (!caller->Init()) {
+        status->code = -1;
+        status->msg = "fail to init async procedure caller";
+        return {};
+    }
+    status->code = 0;
+    return caller;
+}
+
+std::shared_ptr<PreparedStatement> SQLClusterRouter::Prepare(
+    const std::string& db, const std::string& sql, const std::shared_ptr<hybridse::sdk::Schema>& parameter_schema,
+    hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return {};
+    }
+    std::vector<openmldb::type::DataType> parameter_types;
+    std::shared_ptr<SQLRequestRow> parameter;
+    if (parameter_schema) {
+        if (!ExtractDBTypes(parameter_schema, parameter_types)) {
+            *status = {::hybridse::common::StatusCode::kCmdError, "convert parameter types error"};
+            return {};
+        }
+        // only the schema of the parameter row is used for routing
+        parameter = std::make_shared<SQLRequestRow>(parameter_schema, std::set<std::string>());
+    }
+    auto cache = GetSQLCache(db, sql, hybridse::vm::kBatchMode, parameter, *status);
+    if (!status->IsOK()) {
+        return {};
+    }
+    if (!cache) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "fail to get the route of sql"};
+        return {};
+    }
+    const std::string& main_table = cache->router.GetMainTable();
+    const std::string main_db = cache->router.GetMainDb().empty() ? db : cache->router.GetMainDb();
+    *status = {};
+    return std::make_shared<PreparedStatement>(cluster_sdk_, db, sql, parameter_schema, parameter_types, main_db,
+                                               main_table, options_.request_timeout);
+}
+
+std::shared_ptr<FeatureReplayer> SQLClusterRouter::CreateFeatureReplayer(const std::string& db,
+                                                                         const std::string& sp_name,
+                                                                         const ReplayOptions& options,
+                                                                         hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return {};
+    }
+    std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info = cluster_sdk_->GetProcedureInfo(db, sp_name, &status->msg);
+    if (!sp_info) {
+        status->code = -1;
+        status->msg = "procedure not found, msg: " + status->msg;
+        LOG(WARNING) << status->msg;
+        return {};
+    }
+    auto replayer = std::make_shared<FeatureReplayer>(cluster_sdk_, sp_info, options);
+    if (!replayer->Init(status)) {
+        LOG(WARNING) << "fail to init feature replayer, " << status->msg;
+        return {};
+    }
+    return replayer;
 }
 
 std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetTablet(const std::string& db,
                                                                             const std::string& sp_name,
                                                                             hybridse::sdk::Status* status) {
+    return GetTablet(db, sp_name, std::shared_ptr<SQLRequestRow>(), status);
+}
+
+std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetTablet(const std::string& db,
+                                                                            const std::string& sp_name,
+                                                                            const std::shared_ptr<SQLRequestRow>& row,
+                                                                            hybridse::sdk::Status* status) {
     if (status == nullptr) return nullptr;
     std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info = cluster_sdk_->GetProcedureInfo(db, sp_name, &status->msg);
     if (!sp_info) {
@@ -980,7 +1161,20 @@ std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetTablet(cons
     }
     const std::string& table = sp_info->GetMainTable();
     const std::string& db_name = sp_info->GetMainDb().empty() ? db : sp_info->GetMainDb();
-    auto tablet = cluster_sdk_->GetTablet(db_name, table);
+    std::shared_ptr<::openmldb::catalog::TabletAccessor> tablet;
+    if (row) {
+        // go to the leader of the partition of the request row, so the tablet does not forward it
+        hybridse::sdk::Status cache_status;
+        auto cache = GetSQLCache(db, sp_info->GetSql(), hybridse::vm::kRequestMode, {}, cache_status);
+        std::string val;
+        if (cache && !cache->router.GetRouterCol().empty() &&
+            row->GetRecordVal(cache->router.GetRouterCol(), &val)) {
+            tablet = cluster_sdk_->GetTablet(db_name, table, val);
+        }
+    }
+    if (!tablet) {
+        tablet = cluster_sdk_->GetTablet(db_name, table);
+    }
     if (!tablet) {
         status->code = -1;
         status->msg = "fail to get tablet, table " + db_name + "." + table;
@@ -1078,13 +1272,102 @@ std::shared_ptr<::hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQLParamete
     cntl->set_timeout_ms(options_.request_timeout);
     DLOG(INFO) << " send query to tablet " << client->GetEndpoint();
     auto response = std::make_shared<::openmldb::api::QueryResponse>();
+    uint32_t chunk_bytes = options_.query_chunk_bytes;
     if (!client->Query(db, sql, parameter_types, parameter ? parameter->GetRow() : "", cntl.get(), response.get(),
-                       options_.enable_debug)) {
+                       options_.enable_debug, false, chunk_bytes, options_.snapshot_read)) {
         status->msg = response->msg();
         status->code = -1;
         return {};
     }
-    return ResultSetSQL::MakeResultSet(response, cntl, status);
+    uint32_t timeout = options_.request_timeout;
+    auto fetch = [client, chunk_bytes, timeout](uint64_t result_id, brpc::Controller* cntl,
+                                                ::openmldb::api::QueryResponse* response) {
+        cntl->set_timeout_ms(timeout);
+        return client->FetchQueryResult(result_id, chunk_bytes, cntl, response);
+    };
+    return ChunkedResultSetSQL::MakeResultSet(response, cntl, fetch, status);
+}
+
+static std::vector<std::string> RunnerStatToRow(const ::openmldb::api::RunnerStat& stat) {
+    return {std::to_string(stat.id()),       stat.type(),
+            std::to_string(stat.run_cnt()),  std::to_string(stat.time_us()),
+            std::to_string(stat.rows_in()),  std::to_string(stat.rows_out()),
+            std::to_string(stat.bytes_out())};
+}
+
+static const std::vector<std::string> RUNNER_STAT_COLUMNS = {"RunnerId", "Runner",  "Count",   "Time(us)",
+                                                             "RowsIn",   "RowsOut", "BytesOut"};
+
+std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExplainAnalyze(const std::string& db,
+                                                                           const std::string& sql,
+                                                                           ::hybridse::sdk::Status* status) {
+    auto client = GetTabletClientForBatchQuery(db, sql, std::shared_ptr<openmldb::sdk::SQLRequestRow>(), status);
+    if (!status->IsOK() || !client) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "no tablet available for sql"};
+        return {};
+    }
+    brpc::Controller cntl;
+    cntl.set_timeout_ms(options_.request_timeout);
+    ::openmldb::api::QueryResponse response;
+    if (!client->Query(db, sql, {}, "", &cntl, &response, false, true)) {
+        *status = {::hybridse::common::StatusCode::kCmdError, response.msg()};
+        return {};
+    }
+    // the runners of the sub queries on the other tablets are not included
+    std::vector<std::vector<std::string>> lines;
+    for (const auto& stat : response.runner_stats()) {
+        lines.push_back(RunnerStatToRow(stat));
+    }
+    return ResultSetSQL::MakeResultSet(RUNNER_STAT_COLUMNS, lines, status);
+}
+
+std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ShowDeploymentStats(const std::string& db,
+                                                                                ::hybridse::sdk::Status* status) {
+    if (db.empty()) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "please enter database first"};
+        return {};
+    }
+    // deployment -> runner id -> stat
+    std::map<std::string, std::map<int64_t, ::openmldb::api::RunnerStat>> deploy_stats;
+    // deployment -> the most bytes a call held on any tablet
+    std::map<std::string, uint64_t> deploy_peaks;
+    for (const auto& tablet : cluster_sdk_->GetAllTablet()) {
+        auto client = tablet->GetClient();
+        ::openmldb::api::DeployProfileResponse response;
+        if (!client || !client->GetDeployProfile(db, &response)) {
+            LOG(WARNING) << "fail to get deploy profile from " << (client ? client->GetEndpoint() : "null");
+            continue;
+        }
+        for (const auto& profile : response.profiles()) {
+            auto& peak = deploy_peaks[profile.deploy_name()];
+            peak = std::max(peak, profile.peak_memory());
+            auto& runner_stats = deploy_stats[profile.deploy_name()];
+            for (const auto& stat : profile.runner_stats()) {
+                auto& sum = runner_stats[stat.id()];
+                sum.set_id(stat.id());
+                sum.set_type(stat.type());
+                sum.set_run_cnt(sum.run_cnt() + stat.run_cnt());
+                sum.set_time_us(sum.time_us() + stat.time_us());
+                sum.set_rows_in(sum.rows_in() + stat.rows_in());
+                sum.set_rows_out(sum.rows_out() + stat.rows_out());
+                sum.set_bytes_out(sum.bytes_out() + stat.bytes_out());
+            }
+        }
+    }
+    std::vector<std::string> columns = {"Deployment"};
+    columns.insert(columns.end(), RUNNER_STAT_COLUMNS.begin(), RUNNER_STAT_COLUMNS.end());
+    columns.push_back("PeakMemory");
+    std::vector<std::vector<std::string>> lines;
+    for (const auto& deploy : deploy_stats) {
+        for (const auto& kv : deploy.second) {
+            std::vector<std::string> line = {deploy.first};
+            auto row = RunnerStatToRow(kv.second);
+            line.insert(line.end(), row.begin(), row.end());
+            line.push_back(std::to_string(deploy_peaks[deploy.first]));
+            lines.push_back(std::move(line));
+        }
+    }
+    return ResultSetSQL::MakeResultSet(columns, lines, status);
 }
 
 std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQLBatchRequest(
@@ -1183,6 +1466,7 @@ bool SQLClusterRouter::PutRow(uint32_t tid, const std::shared_ptr<SQLInsertRow>&
     }
     const auto& dimensions = row->GetDimensions();
     uint64_t cur_ts = ::baidu::common::timer::get_micros() / 1000;
+    uint64_t retry_ms = is_cluster_mode_ ? options_.put_throttle_retry_ms : standalone_options_.put_throttle_retry_ms;
     for (const auto& kv : dimensions) {
         uint32_t pid = kv.first;
         if (pid < tablets.size()) {
@@ -1192,9 +1476,21 @@ bool SQLClusterRouter::PutRow(uint32_t tid, const std::shared_ptr<SQLInsertRow>&
                 if (client) {
                     DLOG(INFO) << "put data to endpoint " << client->GetEndpoint() << " with dimensions size "
                                << kv.second.size();
-                    bool ret = client->Put(tid, pid, cur_ts, row->GetRow(), kv.second, 1);
-                    if (!ret) {
-                        status->msg = "fail to make a put request to table. tid " + std::to_string(tid);
+                    auto ret = client->PutRow(tid, pid, cur_ts, row->GetRow(), kv.second, 1);
+                    uint64_t start_ms = ::baidu::common::timer::get_micros() / 1000;
+                    uint64_t backoff_ms = 10;
+                    while (ret.code == ::openmldb::base::ReturnCode::kWriteThrottled &&
+                           ::baidu::common::timer::get_micros() / 1000 < start_ms + retry_ms) {
+                        bthread_usleep(backoff_ms * 1000);
+                        backoff_ms = std::min<uint64_t>(backoff_ms * 2, 1000);
+                        ret = client->PutRow(tid, pid, cur_ts, row->GetRow(), kv.second, 1);
+                    }
+                    if (!ret.OK()) {
+                        status->msg = "fail to make a put request to table. tid " + std::to_string(tid) + ", " +
+                                      ret.msg;
+                        if (ret.code == ::openmldb::base::ReturnCode::kWriteThrottled) {
+                            status->code = ret.code;
+                        }
                         LOG(WARNING) << status->msg;
                         return false;
                     }
@@ -1237,6 +1533,28 @@ bool SQLClusterRouter::ExecuteInsert(const std::string& db, const std::string& s
     }
 }
 
+bool SQLClusterRouter::ExecuteInsertBatch(const std::string& db, const std::string& sql,
+                                          std::shared_ptr<SQLInsertRows> rows, hybridse::sdk::Status* status) {
+    if (!rows || !status) {
+        LOG(WARNING) << "input is invalid";
+        return false;
+    }
+    AsyncInsertOptions options;
+    options.request_timeout_ms = options_.request_timeout;
+    auto inserter = CreateAsyncInserter(db, sql, options, status);
+    if (!inserter) {
+        return false;
+    }
+    auto future = inserter->Insert(rows);
+    inserter->Flush();
+    *status = future.get();
+    if (status->code != 0) {
+        LOG(WARNING) << "fail to insert " << rows->GetCnt() << " rows: " << status->msg;
+        return false;
+    }
+    return true;
+}
+
 bool SQLClusterRouter::ExecuteInsert(const std::string& db, const std::string& sql, std::shared_ptr<SQLInsertRow> row,
                                      hybridse::sdk::Status* status) {
     if (!row || !status) {
@@ -1311,15 +1629,49 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallProcedure(const
         LOG(WARNING) << "make sure the request row is built before execute sql";
         return nullptr;
     }
-    auto tablet = GetTablet(db, sp_name, status);
+    auto tablet = GetTablet(db, sp_name, row, status);
     if (!tablet) {
         return nullptr;
     }
 
     auto cntl = std::make_shared<::brpc::Controller>();
     auto response = std::make_shared<::openmldb::api::QueryResponse>();
-    bool ok = tablet->CallProcedure(db, sp_name, row->GetRow(), cntl.get(), response.get(), options_.enable_debug,
-                                    options_.request_timeout);
+    bool ok = false;
+    if (options_.enable_hedged_request) {
+        ok = HedgedCallProcedure(tablet, db, sp_name, row, &cntl, &response);
+    } else {
+        ::openmldb::api::FollowerRead follower_read;
+        auto replica = GetReplica(db, sp_name, row, &follower_read);
+        if (replica && follower_read.has_tid()) {
+            ok = replica->CallProcedure(db, sp_name, row->GetRow(), cntl.get(), response.get(),
+                                        options_.enable_debug, options_.request_timeout, &follower_read);
+            if (!ok && !cntl->Failed() && response->code() == ::openmldb::base::kFollowerLagBehind) {
+                // the follower falls behind since its offset is taken, go to the leader
+                DLOG(INFO) << "follower " << replica->GetEndpoint() << " lags behind, " << response->msg();
+                cntl = std::make_shared<::brpc::Controller>();
+                response = std::make_shared<::openmldb::api::QueryResponse>();
+            } else {
+                tablet.reset();
+            }
+        }
+        if (tablet) {
+            ok = tablet->CallProcedure(db, sp_name, row->GetRow(), cntl.get(), response.get(),
+                                       options_.enable_debug, options_.request_timeout);
+        }
+    }
+    if (!ok && cntl->Failed()) {
+        // the cached leader of the partition may be out of date, retry once with the refreshed catalog
+        LOG(WARNING) << "fail to call procedure " << sp_name << ", " << cntl->ErrorText() << ", refresh catalog";
+        RefreshCatalog();
+        tablet = GetTablet(db, sp_name, row, status);
+        if (!tablet) {
+            return nullptr;
+        }
+        cntl = std::make_shared<::brpc::Controller>();
+        response = std::make_shared<::openmldb::api::QueryResponse>();
+        ok = tablet->CallProcedure(db, sp_name, row->GetRow(), cntl.get(), response.get(), options_.enable_debug,
+                                   options_.request_timeout);
+    }
     if (!ok) {
         status->code = -1;
         status->msg = "request server error" + response->msg();
@@ -1336,6 +1688,114 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallProcedure(const
     return rs;
 }
 
+bool SQLClusterRouter::HedgedCallProcedure(const std::shared_ptr<openmldb::client::TabletClient>& tablet,
+                                           const std::string& db, const std::string& sp_name,
+                                           const std::shared_ptr<SQLRequestRow>& row,
+                                           std::shared_ptr<::brpc::Controller>* cntl,
+                                           std::shared_ptr<::openmldb::api::QueryResponse>* response) {
+    using Call = ::openmldb::HedgedCall<::openmldb::api::QueryResponse>;
+    auto tracker = GetLatencyTracker(db, sp_name);
+    Call call;
+    if (!tablet->CallProcedure(db, sp_name, row->GetRow(), options_.request_timeout, options_.enable_debug,
+                               call.NewCallback(Call::kPrimary))) {
+        call.SetSendFailed(Call::kPrimary);
+        *cntl = call.GetController(Call::kPrimary);
+        *response = call.GetResponse(Call::kPrimary);
+        return false;
+    }
+    uint64_t delay_us = std::max(tracker->Get(), static_cast<uint64_t>(options_.hedge_min_delay_ms) * 1000);
+    if (!call.WaitUntil(Call::kPrimary, delay_us)) {
+        ::openmldb::api::FollowerRead follower_read;
+        auto follower = GetFollower(db, sp_name, row, &follower_read);
+        uint64_t elapsed_ms = call.GetElapsed() / 1000;
+        if (follower && follower->GetEndpoint() != tablet->GetEndpoint() && elapsed_ms < options_.request_timeout) {
+            DLOG(INFO) << "hedge the call of " << db << "." << sp_name << " to " << follower->GetEndpoint();
+            if (!follower->CallProcedureOnFollower(db, sp_name, row->GetRow(), options_.request_timeout - elapsed_ms,
+                                                   options_.enable_debug, follower_read,
+                                                   call.NewCallback(Call::kBackup))) {
+                call.SetSendFailed(Call::kBackup);
+            }
+        }
+    }
+    int taken = call.Wait();
+    tracker->Add(call.GetElapsed());
+    *cntl = call.GetController(taken);
+    *response = call.GetResponse(taken);
+    return !(*cntl)->Failed() && (*response)->code() == ::openmldb::base::kOk;
+}
+
+std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetFollower(
+    const std::string& db, const std::string& sp_name, const std::shared_ptr<SQLRequestRow>& row,
+    ::openmldb::api::FollowerRead* follower_read) {
+    std::string msg;
+    auto sp_info = cluster_sdk_->GetProcedureInfo(db, sp_name, &msg);
+    std::shared_ptr<::openmldb::catalog::SDKTableHandler> handler;
+    uint32_t pid = 0;
+    if (!sp_info || !GetRowPartition(db, sp_info, row, &handler, &pid)) {
+        return {};
+    }
+    auto follower = handler->GetFollower(pid);
+    if (!follower) {
+        return {};
+    }
+    follower_read->set_tid(handler->GetTid());
+    follower_read->set_pid(pid);
+    follower_read->set_max_lag(options_.hedge_max_lag);
+    return follower->GetClient();
+}
+
+std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetReplica(
+    const std::string& db, const std::string& sp_name, const std::shared_ptr<SQLRequestRow>& row,
+    ::openmldb::api::FollowerRead* follower_read) {
+    std::string msg;
+    auto sp_info = cluster_sdk_->GetProcedureInfo(db, sp_name, &msg);
+    uint64_t max_lag = 0;
+    std::shared_ptr<::openmldb::catalog::SDKTableHandler> handler;
+    uint32_t pid = 0;
+    if (!sp_info || !replica_selector_ || !GetFollowerReadMaxLag(sp_info, &max_lag) ||
+        !GetRowPartition(db, sp_info, row, &handler, &pid)) {
+        return {};
+    }
+    auto replica = replica_selector_->Select(handler.get(), pid, max_lag, follower_read);
+    if (!replica) {
+        return {};
+    }
+    return replica->GetClient();
+}
+
+bool SQLClusterRouter::GetRowPartition(const std::string& db,
+                                       const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info,
+                                       const std::shared_ptr<SQLRequestRow>& row,
+                                       std::shared_ptr<::openmldb::catalog::SDKTableHandler>* handler,
+                                       uint32_t* pid) {
+    const std::string& table = sp_info->GetMainTable();
+    const std::string& db_name = sp_info->GetMainDb().empty() ? db : sp_info->GetMainDb();
+    hybridse::sdk::Status cache_status;
+    auto cache = GetSQLCache(db, sp_info->GetSql(), hybridse::vm::kRequestMode, {}, cache_status);
+    std::string val;
+    if (!cache || cache->router.GetRouterCol().empty() || !row->GetRecordVal(cache->router.GetRouterCol(), &val)) {
+        return false;
+    }
+    *handler = std::dynamic_pointer_cast<::openmldb::catalog::SDKTableHandler>(
+        cluster_sdk_->GetCatalog()->GetTable(db_name, table));
+    if (!*handler || (*handler)->GetPartitionNum() == 0) {
+        return false;
+    }
+    *pid = (*handler)->GetPid(val);
+    return true;
+}
+
+std::shared_ptr<base::LatencyTracker> SQLClusterRouter::GetLatencyTracker(const std::string& db,
+                                                                          const std::string& sp_name) {
+    std::string key = absl::StrCat(db, ".", sp_name);
+    std::lock_guard<::openmldb::base::SpinMutex> lock(tracker_mu_);
+    auto it = latency_trackers_.find(key);
+    if (it == latency_trackers_.end()) {
+        it = latency_trackers_.emplace(key, std::make_shared<base::LatencyTracker>(95)).first;
+    }
+    return it->second;
+}
+
 std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallSQLBatchRequestProcedure(
     const std::string& db, const std::string& sp_name, std::shared_ptr<SQLRequestRowBatch> row_batch,
     hybridse::sdk::Status* status) {
@@ -1496,6 +1956,9 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::HandleSQLCmd(const h
             }
             return {};
         }
+        case hybridse::node::kCmdShowDeploymentStats: {
+            return ShowDeploymentStats(db, status);
+        }
         case hybridse::node::kCmdShowFunctions: {
             std::vector<::openmldb::common::ExternalFun> funs;
             base::Status st = ns_ptr->ShowFunction("", &funs);
@@ -1980,7 +2443,7 @@ std::shared_ptr<openmldb::sdk::QueryFuture> SQLClusterRouter::CallProcedure(cons
         LOG(WARNING) << "make sure the request row is built before execute sql";
         return std::shared_ptr<openmldb::sdk::QueryFuture>();
     }
-    auto tablet = GetTablet(db, sp_name, status);
+    auto tablet = GetTablet(db, sp_name, row, status);
     if (!tablet) {
         return std::shared_ptr<openmldb::sdk::QueryFuture>();
     }
@@ -2115,6 +2578,51 @@ bool SQLClusterRouter::UpdateOfflineTableInfo(const ::openmldb::nameserver::Tabl
     return taskmanager_client_ptr->RunBatchSql(sql, config, default_db, output);
 }
 
+::openmldb::base::Status SQLClusterRouter::ExecuteOfflineQueryToResult(const std::string& sql,
+                                                                       const std::map<std::string, std::string>& config,
+                                                                       const std::string& default_db,
+                                                                       const std::string& format,
+                                                                       std::string* result_path) {
+    auto taskmanager_client_ptr = cluster_sdk_->GetTaskManagerClient();
+    if (!taskmanager_client_ptr) {
+        return {-1, "Fail to get TaskManager client"};
+    }
+    return taskmanager_client_ptr->RunBatchSqlToResult(sql, config, default_db, format, result_path);
+}
+
+std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::FetchOfflineResult(const std::string& result_path,
+                                                                               uint64_t offset, uint32_t limit,
+                                                                               uint64_t* total_rows,
+                                                                               hybridse::sdk::Status* status) {
+    auto taskmanager_client_ptr = cluster_sdk_->GetTaskManagerClient();
+    if (!taskmanager_client_ptr) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "Fail to get TaskManager client"};
+        return {};
+    }
+    ::openmldb::taskmanager::GetJobResultResponse response;
+    auto base_status = taskmanager_client_ptr->GetJobResult(result_path, offset, limit, &response);
+    if (!base_status.OK()) {
+        *status = {::hybridse::common::StatusCode::kCmdError, base_status.msg};
+        return {};
+    }
+    if (total_rows != nullptr) {
+        *total_rows = response.total_rows();
+    }
+    std::vector<std::string> fields(response.column_names().begin(), response.column_names().end());
+    std::vector<std::vector<std::string>> records;
+    records.reserve(response.rows_size());
+    for (const auto& row : response.rows()) {
+        records.emplace_back(row.values().begin(), row.values().end());
+        // the null values are encoded by the token of null
+        for (auto idx : row.null_idx()) {
+            if (idx < records.back().size()) {
+                records.back()[idx] = ::openmldb::codec::NONETOKEN;
+            }
+        }
+    }
+    return ResultSetSQL::MakeResultSet(fields, records, status);
+}
+
 ::openmldb::base::Status SQLClusterRouter::ImportOnlineData(const std::string& sql,
                                                             const std::map<std::string, std::string>& config,
                                                             const std::string& default_db, bool sync_job,
@@ -2221,6 +2729,39 @@ std::string SQLClusterRouter::GetJobLog(const int id, hybridse::sdk::Status* sta
 
 bool SQLClusterRouter::NotifyTableChange() { return cluster_sdk_->TriggerNotify(::openmldb::type::NotifyType::kTable); }
 
+// the table of `select * from table` without any filter, limit or window
+static bool GetSelectAllTable(const hybridse::node::PlanNode* query, std::string* db, std::string* table) {
+    if (query == nullptr) {
+        return false;
+    }
+    if (query->GetType() == hybridse::node::kPlanTypeQuery) {
+        query = query->GetChildren()[0];
+    }
+    if (query->GetType() != hybridse::node::kPlanTypeProject) {
+        return false;
+    }
+    auto* project_plan = dynamic_cast<const hybridse::node::ProjectPlanNode*>(query);
+    if (project_plan->project_list_vec_.size() != 1 ||
+        project_plan->GetChildren()[0]->GetType() != hybridse::node::kPlanTypeTable) {
+        return false;
+    }
+    auto* project_list = dynamic_cast<const hybridse::node::ProjectListNode*>(project_plan->project_list_vec_[0]);
+    if (project_list == nullptr || project_list->IsWindowProject() || project_list->GetHavingCondition() != nullptr ||
+        project_list->GetProjects().size() != 1) {
+        return false;
+    }
+    auto* project = dynamic_cast<const hybridse::node::ProjectNode*>(project_list->GetProjects()[0]);
+    if (project == nullptr || project->GetExpression()->GetExprType() != hybridse::node::kExprAll) {
+        return false;
+    }
+    auto* table_plan = dynamic_cast<const hybridse::node::TablePlanNode*>(project_plan->GetChildren()[0]);
+    if (!table_plan->db_.empty()) {
+        *db = table_plan->db_;
+    }
+    *table = table_plan->table_;
+    return true;
+}
+
 std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQL(const std::string& sql,
                                                                        hybridse::sdk::Status* status) {
     std::string db = GetDatabase();
@@ -2255,6 +2796,10 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQL(const std
             std::string empty;
             std::string mu_script = sql;
             mu_script.replace(0u, 7u, empty);
+            auto explain_node = dynamic_cast<hybridse::node::ExplainPlanNode*>(node)->GetExplainNode();
+            if (explain_node->explain_type_ == hybridse::node::kExplainAnalyze) {
+                return ExplainAnalyze(db, mu_script, status);
+            }
             auto info = Explain(db, mu_script, status);
             if (!info) {
                 return {};
@@ -2384,6 +2929,14 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQL(const std
         case hybridse::node::kPlanTypeSelectInto: {
             if (!cluster_sdk_->IsClusterMode() || IsOnlineMode()) {
                 auto* select_into_plan_node = dynamic_cast<hybridse::node::SelectIntoPlanNode*>(node);
+                std::string export_db = db;
+                std::string export_table;
+                if (GetSelectAllTable(select_into_plan_node->Query(), &export_db, &export_table)) {
+                    // stream the partitions of the table into the file rather than the whole result set
+                    *status = HandleExportTable(export_db, export_table, select_into_plan_node->OutFile(),
+                                                select_into_plan_node->Options());
+                    return {};
+                }
                 const std::string& query_sql = select_into_plan_node->QueryStr();
                 auto rs =
                     ExecuteSQLParameterized(db, query_sql, std::shared_ptr<openmldb::sdk::SQLRequestRow>(), status);
@@ -2428,7 +2981,7 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQL(const std
                 *status = {::hybridse::common::StatusCode::kCmdError, " no db in sql and no default db"};
                 return {};
             }
-            if (cluster_sdk_->IsClusterMode()) {
+            if (cluster_sdk_->IsClusterMode() && !(IsOnlineMode() && IsLocalLoad(plan->Options()))) {
                 // Handle in cluster mode
                 ::openmldb::taskmanager::JobInfo job_info;
                 std::map<std::string, std::string> config;
@@ -2452,7 +3005,7 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQL(const std
                     *status = {::hybridse::common::StatusCode::kCmdError, base_status.msg};
                 }
             } else {
-                // Handle in standalone mode
+                // Handle in standalone mode or by the client with load_mode 'local'
                 *status = HandleLoadDataInfile(database, plan->Table(), plan->File(), plan->Options());
             }
             return {};
@@ -2462,7 +3015,12 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQL(const std
             return {};
         }
         case hybridse::node::kPlanTypeDelete: {
-            *status = {::hybridse::common::StatusCode::kCmdError, "delete is not supported yet"};
+            auto plan = dynamic_cast<hybridse::node::DeletePlanNode*>(node);
+            if (plan->GetTarget() == hybridse::node::DeleteTarget::TABLE) {
+                *status = HandleDeleteTable(db, plan);
+            } else {
+                *status = {::hybridse::common::StatusCode::kCmdError, "delete is not supported yet"};
+            }
             return {};
         }
         default: {
@@ -2497,6 +3055,27 @@ bool SQLClusterRouter::IsSyncJob() {
     return false;
 }
 
+bool SQLClusterRouter::GetFollowerReadMaxLag(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info,
+                                             uint64_t* max_lag) {
+    if (sp_info) {
+        auto option = sp_info->GetOption(FOLLOWER_READ_MAX_LAG);
+        if (option != nullptr && absl::SimpleAtoi(*option, max_lag)) {
+            return true;
+        }
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto it = session_variables_.find("follower_read");
+    bool enabled = it != session_variables_.end() ? it->second == "true" : options_.enable_follower_read;
+    if (!enabled) {
+        return false;
+    }
+    it = session_variables_.find(FOLLOWER_READ_MAX_LAG);
+    if (it == session_variables_.end() || !absl::SimpleAtoi(it->second, max_lag)) {
+        *max_lag = options_.follower_read_max_lag;
+    }
+    return true;
+}
+
 ::hybridse::sdk::Status SQLClusterRouter::SetVariable(hybridse::node::SetPlanNode* node) {
     std::string key = node->Key();
     std::transform(key.begin(), key.end(), key.begin(), ::tolower);
@@ -2521,7 +3100,7 @@ bool SQLClusterRouter::IsSyncJob() {
         if (value != "online" && value != "offline") {
             return {::hybridse::common::StatusCode::kCmdError, "the value of execute_mode must be online|offline"};
         }
-    } else if (key == "enable_trace" || key == "sync_job") {
+    } else if (key == "enable_trace" || key == "sync_job" || key == "follower_read") {
         if (value != "true" && value != "false") {
             return {::hybridse::common::StatusCode::kCmdError, "the value of " + key + " must be true|false"};
         }
@@ -2537,6 +3116,11 @@ bool SQLClusterRouter::IsSyncJob() {
         }
         // TODO(hw): is it better to set request timeout before every offline call?
         taskmanager_client_ptr->SetRequestTimeout(new_timeout);
+    } else if (key == FOLLOWER_READ_MAX_LAG) {
+        uint64_t max_lag = 0;
+        if (!absl::SimpleAtoi(value, &max_lag)) {
+            return {::hybridse::common::StatusCode::kCmdError, "the value of " + key + " must be an unsigned integer"};
+        }
     } else {
         return {};
     }
@@ -2620,6 +3204,10 @@ void SQLClusterRouter::SetInteractive(bool value) { interactive_ = value; }
     if (!fstream.is_open()) {
         return {openmldb::base::kSQLCmdRunError, "Failed to open file, please check file path"};
     }
+    if (options_parse.GetFormat() != "csv") {
+        return {openmldb::base::kSQLCmdRunError,
+                "format " + options_parse.GetFormat() + " is only supported by exporting a whole table"};
+    }
     // Write data
     if (options_parse.GetFormat() == "csv") {
         auto* schema = result_set->GetSchema();
@@ -2671,6 +3259,237 @@ void SQLClusterRouter::SetInteractive(bool value) { interactive_ = value; }
     return {};
 }
 
+hybridse::sdk::Status SQLClusterRouter::HandleExportTable(const std::string& database, const std::string& table,
+                                                          const std::string& file_path,
+                                                          const std::shared_ptr<hybridse::node::OptionsMap>& options) {
+    WriteFileOptionsParser options_parse;
+    auto st = options_parse.Parse(options);
+    if (!st.OK()) {
+        return {::hybridse::common::StatusCode::kCmdError, st.msg};
+    }
+    auto table_info = cluster_sdk_->GetTableInfo(database, table);
+    if (!table_info) {
+        return {::hybridse::common::StatusCode::kCmdError, "table " + table + " is not exist"};
+    }
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets;
+    if (!cluster_sdk_->GetTablet(database, table, &tablets) || tablets.empty()) {
+        return {::hybridse::common::StatusCode::kCmdError, "fail to get the tablets of table " + table};
+    }
+    uint64_t start_time = ::baidu::common::timer::get_micros();
+    std::atomic<uint64_t> exported_rows{0};
+    TableExporter exporter(table_info, tablets, options_parse, file_path);
+    auto ret = exporter.Export(&exported_rows);
+    uint64_t used_ms = (::baidu::common::timer::get_micros() - start_time) / 1000;
+    LOG(INFO) << "export " << database << "." << table << " to " << file_path << " with "
+              << options_parse.GetThread() << " threads, exported " << exported_rows.load() << " rows in " << used_ms
+              << " ms" << (ret.IsOK() ? "" : ", failed: " + ret.msg);
+    return ret;
+}
+
+// the column and the constant keys of `col = key` or `col IN (keys)`
+static hybridse::sdk::Status GetDeleteKeys(const hybridse::node::ExprNode* condition, std::string* col_name,
+                                           std::vector<const hybridse::node::ConstNode*>* values) {
+    const hybridse::node::ExprNode* col = nullptr;
+    std::vector<const hybridse::node::ExprNode*> exprs;
+    if (condition->GetExprType() == hybridse::node::kExprBinary &&
+        dynamic_cast<const hybridse::node::BinaryExpr*>(condition)->GetOp() == hybridse::node::kFnOpEq) {
+        col = condition->GetChild(0);
+        exprs.push_back(condition->GetChild(1));
+    } else if (condition->GetExprType() == hybridse::node::kExprIn &&
+               !dynamic_cast<const hybridse::node::InExpr*>(condition)->IsNot()) {
+        auto in_expr = dynamic_cast<const hybridse::node::InExpr*>(condition);
+        col = in_expr->GetLhs();
+        auto in_list = in_expr->GetInList();
+        if (in_list == nullptr || in_list->GetExprType() != hybridse::node::kExprList) {
+            return {::hybridse::common::StatusCode::kCmdError, "delete only supports IN with a list of keys"};
+        }
+        for (uint32_t i = 0; i < in_list->GetChildNum(); i++) {
+            exprs.push_back(in_list->GetChild(i));
+        }
+    } else {
+        return {::hybridse::common::StatusCode::kCmdError,
+                "delete only supports the condition of col = key or col IN (keys)"};
+    }
+    if (col == nullptr || col->GetExprType() != hybridse::node::kExprColumnRef) {
+        return {::hybridse::common::StatusCode::kCmdError, "the left of the delete condition must be a column"};
+    }
+    *col_name = dynamic_cast<const hybridse::node::ColumnRefNode*>(col)->GetColumnName();
+    for (auto expr : exprs) {
+        if (expr == nullptr || expr->GetExprType() != hybridse::node::kExprPrimary) {
+            return {::hybridse::common::StatusCode::kCmdError, "the keys to delete must be constants"};
+        }
+        values->push_back(dynamic_cast<const hybridse::node::ConstNode*>(expr));
+    }
+    return {};
+}
+
+// the key of the value in the index, the same as the one the row is put with
+static hybridse::sdk::Status GetDeleteKey(const hybridse::node::ConstNode* value, ::openmldb::type::DataType type,
+                                          std::string* key) {
+    if (value->IsNull()) {
+        *key = ::hybridse::codec::NONETOKEN;
+        return {};
+    }
+    switch (type) {
+        case ::openmldb::type::kString:
+        case ::openmldb::type::kVarchar:
+            if (value->GetDataType() == hybridse::node::kVarchar) {
+                *key = value->GetAsString();
+                if (key->empty()) {
+                    *key = ::hybridse::codec::EMPTY_STRING;
+                }
+                return {};
+            }
+            break;
+        case ::openmldb::type::kSmallInt:
+        case ::openmldb::type::kInt:
+        case ::openmldb::type::kBigInt:
+        case ::openmldb::type::kTimestamp:
+            if (value->GetDataType() == hybridse::node::kInt16 || value->GetDataType() == hybridse::node::kInt32 ||
+                value->GetDataType() == hybridse::node::kInt64) {
+                *key = std::to_string(value->GetAsInt64());
+                return {};
+            }
+            break;
+        case ::openmldb::type::kBool:
+            if (value->GetDataType() == hybridse::node::kBool) {
+                *key = value->GetBool() ? "true" : "false";
+                return {};
+            }
+            break;
+        default:
+            break;
+    }
+    return {::hybridse::common::StatusCode::kCmdError,
+            "unsupported key " + value->GetExprString() + " of type " + ::openmldb::type::DataType_Name(type)};
+}
+
+hybridse::sdk::Status SQLClusterRouter::HandleDeleteTable(const std::string& db,
+                                                          const hybridse::node::DeletePlanNode* plan) {
+    std::string database = plan->GetDbName().empty() ? db : plan->GetDbName();
+    if (database.empty()) {
+        return {::hybridse::common::StatusCode::kCmdError, "no db in sql and no default db"};
+    }
+    const std::string& table = plan->GetTableName();
+    auto table_info = cluster_sdk_->GetTableInfo(database, table);
+    if (!table_info) {
+        return {::hybridse::common::StatusCode::kCmdError, "table " + table + " is not exist"};
+    }
+    std::string col_name;
+    std::vector<const hybridse::node::ConstNode*> values;
+    auto status = GetDeleteKeys(plan->GetCondition(), &col_name, &values);
+    if (!status.IsOK()) {
+        return status;
+    }
+    // the rows are deleted by the key of the index on the column alone
+    std::string idx_name;
+    for (const auto& column_key : table_info->column_key()) {
+        if (column_key.flag() == 0 && column_key.col_name_size() == 1 && column_key.col_name(0) == col_name) {
+            idx_name = column_key.index_name();
+            break;
+        }
+    }
+    if (idx_name.empty()) {
+        return {::hybridse::common::StatusCode::kCmdError, "column " + col_name + " is not the key of any index"};
+    }
+    ::openmldb::type::DataType col_type = ::openmldb::type::kString;
+    for (const auto& column : table_info->column_desc()) {
+        if (column.name() == col_name) {
+            col_type = column.data_type();
+            break;
+        }
+    }
+    uint32_t pid_num = table_info->table_partition_size();
+    std::unique_ptr<::openmldb::base::PartitionRouter> router;
+    if (table_info->partition_split_size() > 0) {
+        router = std::make_unique<::openmldb::base::PartitionRouter>(pid_num, table_info->partition_split());
+    }
+    std::map<uint32_t, std::vector<std::string>> pid_keys;
+    for (auto value : values) {
+        std::string key;
+        status = GetDeleteKey(value, col_type, &key);
+        if (!status.IsOK()) {
+            return status;
+        }
+        uint32_t pid = 0;
+        if (router) {
+            pid = router->GetPid(key);
+        } else if (pid_num > 0) {
+            pid = static_cast<uint32_t>(::openmldb::base::hash64(key) % pid_num);
+        }
+        pid_keys[pid].push_back(std::move(key));
+    }
+    uint32_t deleted_cnt = 0;
+    for (const auto& kv : pid_keys) {
+        auto tablet = cluster_sdk_->GetTablet(database, table, kv.first);
+        if (!tablet || !tablet->GetClient()) {
+            return {::hybridse::common::StatusCode::kCmdError,
+                    "fail to get the tablet of partition " + std::to_string(kv.first)};
+        }
+        uint32_t cnt = 0;
+        std::string msg;
+        if (!tablet->GetClient()->DeleteBatch(table_info->tid(), kv.first, kv.second, idx_name, &cnt, &msg)) {
+            return {::hybridse::common::StatusCode::kCmdError,
+                    "fail to delete the keys of partition " + std::to_string(kv.first) + ": " + msg};
+        }
+        deleted_cnt += cnt;
+    }
+    return {0, "Delete " + std::to_string(deleted_cnt) + " keys"};
+}
+
+static std::string GetInsertPlaceholder(const std::string& table, const hybridse::sdk::Schema& schema) {
+    std::string holders;
+    for (auto i = 0; i < schema.GetColumnCnt(); ++i) {
+        holders += ((i == 0) ? "?" : ",?");
+    }
+    return "insert into " + table + " values(" + holders + ");";
+}
+
+// the result of load data infile with the throughput
+static hybridse::sdk::Status MakeLoadStatus(const std::string& file_path, const std::string& database,
+                                            const std::string& table, uint32_t thread_num, uint64_t rows,
+                                            uint64_t start_time, const hybridse::sdk::Status& status) {
+    uint64_t used_ms = (::baidu::common::timer::get_micros() - start_time) / 1000;
+    LOG(INFO) << "load " << file_path << " to " << database << "." << table << " with " << thread_num
+              << " threads, loaded " << rows << " rows in " << used_ms << " ms"
+              << (status.IsOK() ? "" : ", failed: " + status.msg);
+    if (!status.IsOK()) {
+        return {::hybridse::common::StatusCode::kCmdError, status.msg + ", " + std::to_string(rows) + " rows loaded"};
+    }
+    return {0, "Load " + std::to_string(rows) + " rows in " + std::to_string(used_ms) + " ms, " +
+                   std::to_string(rows * 1000 / (used_ms + 1)) + " rows/s"};
+}
+
+// encode the columns of a line into the row
+static hybridse::sdk::Status EncodeInsertRow(const std::vector<int>& str_col_idx, const std::string& null_value,
+                                             const std::vector<std::string>& cols,
+                                             const std::shared_ptr<SQLInsertRow>& row) {
+    if (!row) {
+        return {::hybridse::common::StatusCode::kCmdError, "fail to create insert row"};
+    }
+    auto& schema = row->GetSchema();
+    auto cnt = schema->GetColumnCnt();
+    if (cnt != static_cast<int>(cols.size())) {
+        return {::hybridse::common::StatusCode::kCmdError, "col size mismatch"};
+    }
+    // scan all strings , calc the sum, to init SQLInsertRow's string length
+    std::string::size_type str_len_sum = 0;
+    for (auto idx : str_col_idx) {
+        if (cols[idx] != null_value) {
+            str_len_sum += cols[idx].length();
+        }
+    }
+    row->Init(static_cast<int>(str_len_sum));
+
+    for (int i = 0; i < cnt; ++i) {
+        if (!::openmldb::codec::AppendColumnValue(cols[i], schema->GetColumnType(i), schema->IsColumnNotNull(i),
+                                                  null_value, row)) {
+            return {::hybridse::common::StatusCode::kCmdError, "translate to insert row failed"};
+        }
+    }
+    return {};
+}
+
 // Only csv format
 hybridse::sdk::Status SQLClusterRouter::HandleLoadDataInfile(
     const std::string& database, const std::string& table, const std::string& file_path,
@@ -2683,18 +3502,19 @@ hybridse::sdk::Status SQLClusterRouter::HandleLoadDataInfile(
     if (!st.OK()) {
         return {::hybridse::common::StatusCode::kCmdError, st.msg};
     }
-    /*std::cout << "Load " << file_path << " to " << real_db << "-" << table << ", options: delimiter ["
-              << options_parse.GetDelimiter() << "], has header[" << (options_parse.GetHeader() ? "true" : "false")
-              << "], null_value[" << options_parse.GetNullValue() << "], format[" << options_parse.GetFormat()
-              << "], quote[" << options_parse.GetQuote() << "]" << std::endl;*/
-    // read csv
     if (!base::IsExists(file_path)) {
         return {::hybridse::common::StatusCode::kCmdError, "file not exist"};
     }
+    if (options_parse.GetFormat() != "csv") {
+        return HandleLoadColumnarFile(database, table, file_path, options_parse);
+    }
+    // read csv
     std::ifstream file(file_path);
     if (!file.is_open()) {
         return {::hybridse::common::StatusCode::kCmdError, "open file failed"};
     }
+    uint64_t file_size = 0;
+    base::GetFileSize(file_path, file_size);
 
     std::string line;
     if (!std::getline(file, line)) {
@@ -2711,6 +3531,7 @@ hybridse::sdk::Status SQLClusterRouter::HandleLoadDataInfile(
         return {::hybridse::common::StatusCode::kCmdError, "mismatch column size"};
     }
 
+    uint64_t data_pos = 0;
     if (options_parse.GetHeader()) {
         // the first line is the column names, check if equal with table schema
         for (int i = 0; i < schema->GetColumnCnt(); ++i) {
@@ -2718,77 +3539,173 @@ hybridse::sdk::Status SQLClusterRouter::HandleLoadDataInfile(
                 return {::hybridse::common::StatusCode::kCmdError, "mismatch column name"};
             }
         }
-        // then read the first row of data
-        std::getline(file, line);
+        // then read from the first row of data
+        data_pos = file.eof() ? file_size : static_cast<uint64_t>(file.tellg());
     }
+    file.clear();
+    file.seekg(data_pos);
 
-    // build placeholder
-    std::string holders;
-    for (auto i = 0; i < schema->GetColumnCnt(); ++i) {
-        holders += ((i == 0) ? "?" : ",?");
-    }
     hybridse::sdk::Status status;
-    std::string insert_placeholder = "insert into " + table + " values(" + holders + ");";
+    std::string insert_placeholder = GetInsertPlaceholder(table, *schema);
     std::vector<int> str_cols_idx;
     for (int i = 0; i < schema->GetColumnCnt(); ++i) {
         if (schema->GetColumnType(i) == hybridse::sdk::kTypeString) {
             str_cols_idx.emplace_back(i);
         }
     }
-    uint64_t i = 0;
-    do {
-        cols.clear();
-        std::string error;
-        ::openmldb::sdk::SplitLineWithDelimiterForStrings(line, options_parse.GetDelimiter(), &cols,
-                                                          options_parse.GetQuote());
-        auto ret = InsertOneRow(database, insert_placeholder, str_cols_idx, options_parse.GetNullValue(), cols);
-        if (!ret.IsOK()) {
-            return {::hybridse::common::StatusCode::kCmdError, "line [" + line + "] insert failed, " + ret.msg};
+    // the rows are grouped by the tablets of their partitions and written in pipelined BatchPut requests
+    AsyncInsertOptions insert_options;
+    insert_options.request_timeout_ms = options_.request_timeout;
+    auto inserter = CreateAsyncInserter(database, insert_placeholder, insert_options, &status);
+    if (!inserter) {
+        return {::hybridse::common::StatusCode::kCmdError, status.msg};
+    }
+
+    // the reader splits the file into chunks at the line boundaries and the parsers encode the lines of a chunk
+    // into rows. the queued chunks and the inserts on the fly of each parser are bounded to limit the memory
+    struct Chunk {
+        std::string data;
+        uint64_t first_line = 0;
+    };
+    uint32_t thread_num = options_parse.GetThread();
+    size_t max_queued_chunks = 2 * thread_num;
+    std::mutex mu;
+    std::condition_variable cv;
+    std::deque<Chunk> chunks;
+    bool read_done = false;
+    bool failed = false;
+    std::string error;
+    std::atomic<uint64_t> loaded_rows{0};
+    // the line number of the data lines counts the header in
+    uint64_t line_base = options_parse.GetHeader() ? 2 : 1;
+    auto set_error = [&](const std::string& msg) {
+        std::lock_guard<std::mutex> lock(mu);
+        if (!failed) {
+            failed = true;
+            error = msg;
+        }
+        cv.notify_all();
+    };
+    auto parse = [&]() {
+        std::deque<std::pair<uint64_t, std::future<hybridse::sdk::Status>>> pending;
+        auto wait_one = [&]() {
+            auto ret = pending.front().second.get();
+            if (ret.IsOK()) {
+                loaded_rows.fetch_add(pending.front().first, std::memory_order_relaxed);
+            } else {
+                set_error("insert failed, " + ret.msg);
+            }
+            pending.pop_front();
+        };
+        std::vector<std::string> lines;
+        std::vector<std::string> cols;
+        while (true) {
+            Chunk chunk;
+            {
+                std::unique_lock<std::mutex> lock(mu);
+                cv.wait(lock, [&] { return failed || read_done || !chunks.empty(); });
+                if (failed || chunks.empty()) {
+                    break;
+                }
+                chunk = std::move(chunks.front());
+                chunks.pop_front();
+            }
+            cv.notify_all();
+            lines.clear();
+            ::openmldb::sdk::SplitChunkLines(chunk.data, &lines);
+            hybridse::sdk::Status ret;
+            auto rows = GetInsertRows(database, insert_placeholder, &ret);
+            if (!rows) {
+                set_error(ret.msg);
+                break;
+            }
+            for (size_t i = 0; i < lines.size() && ret.IsOK(); i++) {
+                cols.clear();
+                ::openmldb::sdk::SplitLineWithDelimiterForStrings(lines[i], options_parse.GetDelimiter(), &cols,
+                                                                  options_parse.GetQuote());
+                ret = EncodeInsertRow(str_cols_idx, options_parse.GetNullValue(), cols, rows->NewRow());
+                if (!ret.IsOK()) {
+                    set_error("line " + std::to_string(line_base + chunk.first_line + i) + " [" + lines[i] +
+                              "] insert failed, " + ret.msg);
+                }
+            }
+            if (!ret.IsOK()) {
+                break;
+            }
+            pending.emplace_back(rows->GetCnt(), inserter->Insert(rows));
+            while (pending.size() > 2) {
+                wait_one();
+            }
+        }
+        while (!pending.empty()) {
+            wait_one();
+        }
+    };
+    std::vector<std::thread> parsers;
+    for (uint32_t i = 0; i < thread_num; i++) {
+        parsers.emplace_back(parse);
+    }
+    uint64_t start_time = ::baidu::common::timer::get_micros();
+    uint64_t report_time = start_time;
+    LineChunkReader reader(&file, kLoadChunkBytes);
+    while (true) {
+        Chunk chunk;
+        bool has_chunk = reader.Next(&chunk.data, &chunk.first_line);
+        std::unique_lock<std::mutex> lock(mu);
+        if (!has_chunk || failed) {
+            read_done = true;
+            break;
         }
-        ++i;
-    } while (std::getline(file, line));
-    return {0, "Load " + std::to_string(i) + " rows"};
+        cv.wait(lock, [&] { return failed || chunks.size() < max_queued_chunks; });
+        chunks.push_back(std::move(chunk));
+        cv.notify_all();
+        lock.unlock();
+        uint64_t now = ::baidu::common::timer::get_micros();
+        if (now >= report_time + kLoadReportIntervalMs * 1000) {
+            report_time = now;
+            uint64_t rows = loaded_rows.load(std::memory_order_relaxed);
+            LOG(INFO) << "loading " << file_path << ", read " << reader.GetReadBytes() + data_pos << "/" << file_size
+                      << " bytes, loaded " << rows << " rows, " << rows * 1000000 / (now - start_time + 1)
+                      << " rows/s";
+        }
+    }
+    cv.notify_all();
+    for (auto& parser : parsers) {
+        parser.join();
+    }
+    inserter->WaitAll();
+    return MakeLoadStatus(file_path, database, table, thread_num, loaded_rows.load(std::memory_order_relaxed),
+                          start_time, failed ? hybridse::sdk::Status(-1, error) : hybridse::sdk::Status());
 }
 
-hybridse::sdk::Status SQLClusterRouter::InsertOneRow(const std::string& database, const std::string& insert_placeholder,
-                                                     const std::vector<int>& str_col_idx, const std::string& null_value,
-                                                     const std::vector<std::string>& cols) {
-    if (cols.empty()) {
-        return {::hybridse::common::StatusCode::kCmdError, "cols is empty"};
+hybridse::sdk::Status SQLClusterRouter::HandleLoadColumnarFile(const std::string& database, const std::string& table,
+                                                               const std::string& file_path,
+                                                               const ReadFileOptionsParser& options_parse) {
+    if (!ColumnarFileLoader::IsSupported()) {
+        return {::hybridse::common::StatusCode::kCmdError,
+                "format " + options_parse.GetFormat() + " needs the build with ARROW_ENABLE"};
     }
-    if (database.empty()) {
-        return {::hybridse::common::StatusCode::kCmdError, "database is empty"};
+    auto schema = GetTableSchema(database, table);
+    if (!schema) {
+        return {::hybridse::common::StatusCode::kCmdError, "table is not exist"};
     }
     hybridse::sdk::Status status;
-    auto row = GetInsertRow(database, insert_placeholder, &status);
-    if (!row) {
-        return status;
-    }
-    // build row from cols
-    auto& schema = row->GetSchema();
-    auto cnt = schema->GetColumnCnt();
-    if (cnt != static_cast<int>(cols.size())) {
-        return {::hybridse::common::StatusCode::kCmdError, "col size mismatch"};
-    }
-    // scan all strings , calc the sum, to init SQLInsertRow's string length
-    std::string::size_type str_len_sum = 0;
-    for (auto idx : str_col_idx) {
-        if (cols[idx] != null_value) {
-            str_len_sum += cols[idx].length();
-        }
-    }
-    row->Init(static_cast<int>(str_len_sum));
-
-    for (int i = 0; i < cnt; ++i) {
-        if (!::openmldb::codec::AppendColumnValue(cols[i], schema->GetColumnType(i), schema->IsColumnNotNull(i),
-                                                  null_value, row)) {
-            return {::hybridse::common::StatusCode::kCmdError, "translate to insert row failed"};
-        }
-    }
-    if (!ExecuteInsert(database, insert_placeholder, row, &status)) {
-        return {::hybridse::common::StatusCode::kCmdError, "insert row failed"};
+    std::string insert_placeholder = GetInsertPlaceholder(table, *schema);
+    AsyncInsertOptions insert_options;
+    insert_options.request_timeout_ms = options_.request_timeout;
+    auto inserter = CreateAsyncInserter(database, insert_placeholder, insert_options, &status);
+    if (!inserter) {
+        return {::hybridse::common::StatusCode::kCmdError, status.msg};
     }
-    return {};
+    uint64_t start_time = ::baidu::common::timer::get_micros();
+    std::atomic<uint64_t> loaded_rows{0};
+    ColumnarFileLoader loader(options_parse.GetFormat(), file_path, schema, options_parse.GetThread());
+    auto ret = loader.Load(
+        [&](hybridse::sdk::Status* st) { return GetInsertRows(database, insert_placeholder, st); }, inserter.get(),
+        &loaded_rows);
+    inserter->WaitAll();
+    return MakeLoadStatus(file_path, database, table, options_parse.GetThread(),
+                          loaded_rows.load(std::memory_order_relaxed), start_time, ret);
 }
 
 hybridse::sdk::Status SQLClusterRouter::HandleCreateFunction(const hybridse::node::CreateFunctionPlanNode* node) {
@@ -3142,6 +4059,127 @@ hybridse::sdk::Status SQLClusterRouter::AddNewIndex(
     return {};
 }
 
+hybridse::sdk::Status SQLClusterRouter::AdviseIndex(
+    bool apply, std::map<std::string, ::openmldb::schema::IndexAdvice>* advices) {
+    std::string db = GetDatabase();
+    if (db.empty()) {
+        return {::hybridse::common::StatusCode::kCmdError, "please enter database first"};
+    }
+    auto ns = cluster_sdk_->GetNsClient();
+    std::vector<::openmldb::nameserver::TableInfo> tables;
+    auto ret = ns->ShowDBTable(db, &tables);
+    if (!ret.OK()) {
+        return {::hybridse::common::StatusCode::kCmdError, "get table failed " + ret.msg};
+    }
+    std::map<std::string, ::google::protobuf::RepeatedPtrField<::openmldb::common::ColumnDesc>> table_schema_map;
+    std::map<uint32_t, std::string> tid_map;
+    for (const auto& table : tables) {
+        table_schema_map.emplace(table.name(), table.column_desc());
+        tid_map.emplace(table.tid(), table.name());
+    }
+    std::vector<api::ProcedureInfo> sps;
+    std::string msg;
+    if (!ns->ShowProcedure(db, "", &sps, &msg)) {
+        return {::hybridse::common::StatusCode::kCmdError, "get deployments failed " + msg};
+    }
+    ::openmldb::schema::IndexAdvisor advisor;
+    for (const auto& sp_info : sps) {
+        if (sp_info.type() != type::kReqDeployment) {
+            continue;
+        }
+        // the select is kept by deploy as "... BEGIN select END;"
+        const std::string& sql = sp_info.sql();
+        std::string::size_type begin = sql.find(" BEGIN ");
+        std::string::size_type end = sql.rfind(" END;");
+        ::openmldb::base::IndexMap index_map;
+        if (begin != std::string::npos && end != std::string::npos && end > begin) {
+            index_map = base::DDLParser::ExtractIndexes(sql.substr(begin + 7, end - begin - 7), table_schema_map);
+        }
+        if (index_map.empty()) {
+            // the deployment may read the tables without index or out of db, keep what it may read
+            LOG(WARNING) << "no index extracted from deployment " << sp_info.sp_name();
+            for (const auto& table : sp_info.tables()) {
+                advisor.SetUsageUnknown(table.table_name());
+            }
+            continue;
+        }
+        for (const auto& kv : index_map) {
+            advisor.AddRequired(kv.first, kv.second);
+        }
+    }
+    for (const auto& tablet : cluster_sdk_->GetAllTablet()) {
+        auto client = tablet->GetClient();
+        ::openmldb::api::GetTableStatusResponse response;
+        if (!client || !client->GetTableStatus(response)) {
+            LOG(WARNING) << "fail to get table status from " << (client ? client->GetEndpoint() : "null");
+            for (const auto& table : tables) {
+                advisor.SetUsageUnknown(table.name());
+            }
+            continue;
+        }
+        for (const auto& status : response.all_table_status()) {
+            auto it = tid_map.find(status.tid());
+            if (it == tid_map.end()) {
+                continue;
+            }
+            for (const auto& idx_status : status.ts_idx_status()) {
+                advisor.AddQueryCnt(it->second, idx_status.idx_name(), idx_status.query_cnt());
+            }
+        }
+    }
+    std::map<std::string, ::openmldb::nameserver::TableInfo> table_map;
+    for (const auto& table : tables) {
+        // the reads of the indexes of disk tables are not counted
+        if (table.storage_mode() != ::openmldb::common::kMemory) {
+            advisor.SetUsageUnknown(table.name());
+        }
+        auto advice = advisor.Advise(table);
+        if (!advice.IsEmpty()) {
+            table_map.emplace(table.name(), table);
+            advices->emplace(table.name(), std::move(advice));
+        }
+    }
+    if (!apply) {
+        return {};
+    }
+    for (auto& kv : *advices) {
+        const auto& table = table_map[kv.first];
+        int index_num = table.column_key_size();
+        for (auto& column_key : kv.second.add_indexes) {
+            column_key.set_index_name("INDEX_" + std::to_string(index_num++) + "_" +
+                                      std::to_string(::baidu::common::timer::now_time()));
+            std::vector<::openmldb::common::ColumnDesc> cols;
+            for (const auto& col_name : column_key.col_name()) {
+                for (const auto& col : table.column_desc()) {
+                    if (col.name() == col_name) {
+                        cols.push_back(col);
+                        break;
+                    }
+                }
+            }
+            if (!ns->AddIndex(kv.first, column_key, &cols, msg)) {
+                return {::hybridse::common::StatusCode::kCmdError,
+                        "table " + kv.first + " add index failed. " + msg};
+            }
+        }
+        for (const auto& column_key : kv.second.update_indexes) {
+            const auto& ttl = column_key.ttl();
+            if (!ns->UpdateTTL(kv.first, ttl.ttl_type(), ttl.abs_ttl(), ttl.lat_ttl(), column_key.index_name(), msg)) {
+                return {::hybridse::common::StatusCode::kCmdError,
+                        "table " + kv.first + " update ttl of " + column_key.index_name() + " failed. " + msg};
+            }
+        }
+        for (const auto& index_name : kv.second.drop_indexes) {
+            if (!ns->DeleteIndex(db, kv.first, index_name, msg)) {
+                return {::hybridse::common::StatusCode::kCmdError,
+                        "table " + kv.first + " delete index " + index_name + " failed. " + msg};
+            }
+        }
+    }
+    RefreshCatalog();
+    return {};
+}
+
 hybridse::sdk::Status SQLClusterRouter::HandleLongWindows(
     const hybridse::node::DeployPlanNode* deploy_node,
     const std::set<std::pair<std::string, std::string>>& table_pair,
@@ -3187,6 +4225,27 @@ hybridse::sdk::Status SQLClusterRouter::HandleLongWindows(
         if (distinct_long_window.size() != long_window_map.size()) {
             return {base::ReturnCode::kError, "long_windows option doesn't match window in sql"};
         }
+        // the bucket size like `1h|1d` creates a pre-aggr table for every level, the runner reads the coarsest
+        // buckets which fit in the window and the finer ones for the rest
+        openmldb::base::LongWindowInfos level_infos;
+        std::set<std::string> multi_level_windows;
+        for (const auto& info : long_window_infos) {
+            std::vector<std::string> buckets;
+            boost::split(buckets, info.bucket_size_, boost::is_any_of("|"));
+            if (buckets.size() > 1) {
+                multi_level_windows.insert(info.window_name_);
+            }
+            for (auto& bucket : buckets) {
+                boost::trim(bucket);
+                if (bucket.empty()) {
+                    return {base::ReturnCode::kError, "illegal long window bucket size " + info.bucket_size_};
+                }
+                auto level_info = info;
+                level_info.bucket_size_ = bucket;
+                level_infos.push_back(level_info);
+            }
+        }
+        long_window_infos.swap(level_infos);
         auto ns_client = cluster_sdk_->GetNsClient();
         std::vector<::openmldb::nameserver::TableInfo> tables;
         std::string msg;
@@ -3206,8 +4265,13 @@ hybridse::sdk::Status SQLClusterRouter::HandleLongWindows(
             }
             // insert pre-aggr meta info to meta table
             std::string aggr_col = lw.aggr_col_ == "*" ? "" : lw.aggr_col_;
+            // the aggr col of the *_where functions is `col,filter_col`
+            std::replace(aggr_col.begin(), aggr_col.end(), ',', '_');
             auto aggr_table =
                 absl::StrCat("pre_", deploy_node->Name(), "_", lw.window_name_, "_", lw.aggr_func_, "_", aggr_col);
+            if (multi_level_windows.count(lw.window_name_)) {
+                absl::StrAppend(&aggr_table, "_", lw.bucket_size_);
+            }
             ::hybridse::sdk::Status status;
             std::string insert_sql =
                 absl::StrCat("insert into ", meta_db, ".", meta_table, " values('" + aggr_table, "', '", aggr_db,
@@ -26,14 +26,23 @@
 #include <unordered_set>
 
 #include "base/ddl_parser.h"
+#include "base/latency_tracker.h"
 #include "base/random.h"
 #include "base/spinlock.h"
-#include "base/lru_cache.h"
+#include "base/snapshot_lru_cache.h"
 #include "client/tablet_client.h"
+#include "sdk/async_inserter.h"
+#include "sdk/async_procedure_caller.h"
 #include "sdk/db_sdk.h"
+#include "sdk/feature_replayer.h"
+#include "sdk/file_option_parser.h"
+#include "sdk/near_cache.h"
+#include "sdk/prepared_statement.h"
+#include "sdk/replica_selector.h"
 #include "sdk/sql_router.h"
 #include "sdk/table_reader_impl.h"
 #include "nameserver/system_table.h"
+#include "schema/index_advisor.h"
 
 namespace openmldb {
 namespace sdk {
@@ -137,8 +146,36 @@ class SQLClusterRouter : public SQLRouter {
     bool ExecuteInsert(const std::string& db, const std::string& sql, std::shared_ptr<SQLInsertRows> rows,
                        hybridse::sdk::Status* status) override;
 
+    bool ExecuteInsertBatch(const std::string& db, const std::string& sql, std::shared_ptr<SQLInsertRows> rows,
+                            hybridse::sdk::Status* status) override;
+
     std::shared_ptr<TableReader> GetTableReader() override;
 
+    std::shared_ptr<BulkLoader> GetBulkLoader(const std::string& db, const std::string& table,
+                                              hybridse::sdk::Status* status) override;
+
+    // write the rows built by GetInsertRow(s) with the same sql in pipelined batches, the sql is prepared if
+    // it is not in cache
+    std::shared_ptr<AsyncInserter> CreateAsyncInserter(const std::string& db, const std::string& sql,
+                                                       const AsyncInsertOptions& options,
+                                                       hybridse::sdk::Status* status);
+
+    // call the deployment `sp_name` without blocking, the concurrent calls are coalesced into batch requests
+    std::shared_ptr<AsyncProcedureCaller> CreateAsyncProcedureCaller(const std::string& db, const std::string& sp_name,
+                                                                     const AsyncCallOptions& options,
+                                                                     hybridse::sdk::Status* status);
+
+    // prepare the online batch query `sql` to execute many times with the parameter rows of parameter_schema, null
+    // if it has no parameter. The query is compiled once on every tablet it runs on and only its id is sent after
+    std::shared_ptr<PreparedStatement> Prepare(const std::string& db, const std::string& sql,
+                                               const std::shared_ptr<hybridse::sdk::Schema>& parameter_schema,
+                                               hybridse::sdk::Status* status);
+
+    // run the deployment `sp_name` over the historical request rows in large pipelined batch requests
+    std::shared_ptr<FeatureReplayer> CreateFeatureReplayer(const std::string& db, const std::string& sp_name,
+                                                           const ReplayOptions& options,
+                                                           hybridse::sdk::Status* status);
+
     std::shared_ptr<ExplainInfo> Explain(const std::string& db, const std::string& sql,
                                          ::hybridse::sdk::Status* status) override;
 
@@ -238,6 +275,14 @@ class SQLClusterRouter : public SQLRouter {
     std::shared_ptr<hybridse::sdk::ResultSet> HandleSQLCmd(const hybridse::node::CmdPlanNode* cmd_node,
                                         const std::string& db, ::hybridse::sdk::Status* status);
 
+    // run the query once with the runners profiled and return the statistics of every runner
+    std::shared_ptr<hybridse::sdk::ResultSet> ExplainAnalyze(const std::string& db, const std::string& sql,
+                                                             ::hybridse::sdk::Status* status);
+
+    // the runner statistics of the deployments in db summed over all tablets
+    std::shared_ptr<hybridse::sdk::ResultSet> ShowDeploymentStats(const std::string& db,
+                                                                  ::hybridse::sdk::Status* status);
+
     std::vector<std::string> GetTableNames(const std::string& db) override;
 
     ::openmldb::nameserver::TableInfo GetTableInfo(const std::string& db, const std::string& table) override;
@@ -261,6 +306,15 @@ class SQLClusterRouter : public SQLRouter {
                                                           const std::string& default_db,
                                                           std::string& output); // NOLINT
 
+    ::openmldb::base::Status ExecuteOfflineQueryToResult(const std::string& sql,
+                                                         const std::map<std::string, std::string>& config,
+                                                         const std::string& default_db, const std::string& format,
+                                                         std::string* result_path) override;
+
+    std::shared_ptr<hybridse::sdk::ResultSet> FetchOfflineResult(const std::string& result_path, uint64_t offset,
+                                                                 uint32_t limit, uint64_t* total_rows,
+                                                                 hybridse::sdk::Status* status) override;
+
     ::openmldb::base::Status ImportOnlineData(const std::string& sql,
                                               const std::map<std::string, std::string>& config,
                                               const std::string& default_db, bool sync_job,
@@ -282,6 +336,11 @@ class SQLClusterRouter : public SQLRouter {
                                                 const ::openmldb::nameserver::TableInfo& base_table_info,
                                                 std::shared_ptr<::openmldb::client::NsClient> ns_ptr);
 
+    // propose the indexes of the tables in the current database from the indexes required by its deployments
+    // and the reads of the indexes counted on the tablets since they start. with apply, the missing indexes are
+    // added, the ttls updated and the unused indexes deleted online
+    hybridse::sdk::Status AdviseIndex(bool apply, std::map<std::string, ::openmldb::schema::IndexAdvice>* advices);
+
     std::string GetJobLog(const int id, hybridse::sdk::Status* status) override;
 
     bool NotifyTableChange() override;
@@ -289,6 +348,8 @@ class SQLClusterRouter : public SQLRouter {
     bool IsOnlineMode() override;
     bool IsEnableTrace();
     bool IsSyncJob();
+    // the max lag of the followers to read from, false if the follower read is disabled for the deployment
+    bool GetFollowerReadMaxLag(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info, uint64_t* max_lag);
 
     std::string GetDatabase();
     void SetDatabase(const std::string& db);
@@ -329,6 +390,30 @@ class SQLClusterRouter : public SQLRouter {
 
     std::shared_ptr<openmldb::client::TabletClient> GetTablet(const std::string& db, const std::string& sp_name,
                                                               hybridse::sdk::Status* status);
+    // the leader of the partition `row` belongs to if the router column of the procedure is known
+    std::shared_ptr<openmldb::client::TabletClient> GetTablet(const std::string& db, const std::string& sp_name,
+                                                              const std::shared_ptr<SQLRequestRow>& row,
+                                                              hybridse::sdk::Status* status);
+    // call the procedure on the leader and, if it does not answer in the p95 latency of the deployment, on a
+    // follower caught up, the first successful answer is taken
+    bool HedgedCallProcedure(const std::shared_ptr<openmldb::client::TabletClient>& tablet, const std::string& db,
+                             const std::string& sp_name, const std::shared_ptr<SQLRequestRow>& row,
+                             std::shared_ptr<::brpc::Controller>* cntl,
+                             std::shared_ptr<::openmldb::api::QueryResponse>* response);
+    // the follower of the partition `row` belongs to, nullptr if the partition is unknown or has no follower
+    std::shared_ptr<openmldb::client::TabletClient> GetFollower(const std::string& db, const std::string& sp_name,
+                                                                const std::shared_ptr<SQLRequestRow>& row,
+                                                                ::openmldb::api::FollowerRead* follower_read);
+    // a replica caught up of the partition `row` belongs to, follower_read is set if it is a follower. nullptr if
+    // the follower read is disabled or the partition is unknown
+    std::shared_ptr<openmldb::client::TabletClient> GetReplica(const std::string& db, const std::string& sp_name,
+                                                               const std::shared_ptr<SQLRequestRow>& row,
+                                                               ::openmldb::api::FollowerRead* follower_read);
+    // the main table of the procedure and the partition of `row` in it
+    bool GetRowPartition(const std::string& db, const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info,
+                         const std::shared_ptr<SQLRequestRow>& row,
+                         std::shared_ptr<::openmldb::catalog::SDKTableHandler>* handler, uint32_t* pid);
+    std::shared_ptr<base::LatencyTracker> GetLatencyTracker(const std::string& db, const std::string& sp_name);
     bool ExtractDBTypes(std::shared_ptr<hybridse::sdk::Schema> schema,
                         std::vector<openmldb::type::DataType>& parameter_types);  // NOLINT
 
@@ -344,13 +429,20 @@ class SQLClusterRouter : public SQLRouter {
             const std::shared_ptr<hybridse::node::OptionsMap>& options_map,
             ::hybridse::sdk::ResultSet* result_set);
 
+    // export all the rows of the table by traversing its partitions in parallel
+    hybridse::sdk::Status HandleExportTable(const std::string& database, const std::string& table,
+            const std::string& file_path, const std::shared_ptr<hybridse::node::OptionsMap>& options);
+
     hybridse::sdk::Status HandleLoadDataInfile(const std::string& database,
             const std::string& table, const std::string& file_path,
             const std::shared_ptr<hybridse::node::OptionsMap>& options);
 
-    hybridse::sdk::Status InsertOneRow(const std::string& database,
-            const std::string& insert_placeholder, const std::vector<int>& str_col_idx,
-            const std::string& null_value, const std::vector<std::string>& cols);
+    // delete the keys of the index on the column in the condition, a batch for each partition
+    hybridse::sdk::Status HandleDeleteTable(const std::string& db, const hybridse::node::DeletePlanNode* plan);
+
+    // load the parquet or orc file
+    hybridse::sdk::Status HandleLoadColumnarFile(const std::string& database, const std::string& table,
+            const std::string& file_path, const ReadFileOptionsParser& options_parse);
 
     hybridse::sdk::Status HandleDeploy(const hybridse::node::DeployPlanNode* deploy_node);
 
@@ -398,11 +490,19 @@ class SQLClusterRouter : public SQLRouter {
     bool is_cluster_mode_;
     bool interactive_;
     DBSDK* cluster_sdk_;
-    std::map<std::string,
-             std::map<hybridse::vm::EngineMode,
-                      base::lru_cache<std::string, std::shared_ptr<SQLCache>>>> input_lru_cache_;
+    using SQLLRUCache = base::snapshot_lru_cache<std::string, std::shared_ptr<SQLCache>>;
+    using SQLCacheMap = std::map<std::string, std::map<hybridse::vm::EngineMode, std::shared_ptr<SQLLRUCache>>>;
+    // copy on write, the lookups load the snapshot without lock and cache_mu_ serializes the writers
+    std::shared_ptr<const SQLCacheMap> input_lru_cache_;
+    ::openmldb::base::SpinMutex cache_mu_;
     ::openmldb::base::SpinMutex mu_;
     ::openmldb::base::Random rand_;
+    // the latencies of the deployments to hedge the calls after
+    ::openmldb::base::SpinMutex tracker_mu_;
+    std::map<std::string, std::shared_ptr<base::LatencyTracker>> latency_trackers_;
+    std::shared_ptr<ReplicaSelector> replica_selector_;
+    // the tables cached by the readers got from the router
+    std::shared_ptr<NearCache> near_cache_;
 };
 
 }  // namespace sdk
@@ -34,6 +34,8 @@
 #include "sdk/sql_sdk_test.h"
 #include "vm/catalog.h"
 
+DECLARE_bool(enable_deploy_profile);
+
 namespace openmldb {
 namespace sdk {
 
@@ -1001,6 +1003,191 @@ TEST_F(SQLClusterTest, ClusterSelect) {
     ASSERT_TRUE(ok);
 }
 
+TEST_F(SQLClusterTest, FollowerReadScan) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    sql_opt.replica_offset_refresh_ms = 0;
+    auto router = NewClusterSQLRouter(sql_opt);
+    ASSERT_TRUE(router != nullptr);
+    SetOnlineMode(router);
+    ::hybridse::sdk::Status status;
+    router->ExecuteSQL("SET @@follower_read='yes';", &status);
+    ASSERT_FALSE(status.IsOK());
+    router->ExecuteSQL("SET @@follower_read_max_lag='-1';", &status);
+    ASSERT_FALSE(status.IsOK());
+    router->ExecuteSQL("SET @@follower_read='true';", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    router->ExecuteSQL("SET @@follower_read_max_lag='0';", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    std::string table = "test" + GenRand();
+    std::string db = "db" + GenRand();
+    ASSERT_TRUE(router->CreateDB(db, &status));
+    std::string ddl = "create table " + table +
+                      "("
+                      "col1 string, col2 bigint,"
+                      "index(key=col1, ts=col2)) options(partitionnum=1, replicanum=3);";
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status));
+    ASSERT_TRUE(router->RefreshCatalog());
+    ASSERT_TRUE(router->ExecuteInsert(db, "insert into " + table + " values('key1', 1024);", &status));
+    // wait for the followers to catch up
+    sleep(2);
+    auto reader = router->GetTableReader();
+    ScanOption so;
+    for (int i = 0; i < 9; i++) {
+        auto rs = reader->Scan(db, table, "key1", 2000, 0, so, &status);
+        ASSERT_TRUE(rs) << status.msg;
+        ASSERT_EQ(1, rs->Size());
+    }
+    std::vector<::openmldb::nameserver::TableInfo> tables;
+    ASSERT_TRUE(mc_->GetNsClient()->ShowDBTable(db, &tables).OK());
+    ASSERT_EQ(1u, tables.size());
+    // the scans are spread over the leader and the followers
+    uint32_t replica_cnt = 0;
+    for (const auto& endpoint : mc_->GetTbEndpoint()) {
+        ::openmldb::api::GetTableStatusRequest request;
+        ::openmldb::api::GetTableStatusResponse response;
+        request.set_tid(tables[0].tid());
+        MockClosure closure;
+        mc_->GetTablet(endpoint)->GetTableStatus(NULL, &request, &response, &closure);
+        for (const auto& table_status : response.all_table_status()) {
+            if (table_status.query_cnt() > 0) {
+                replica_cnt++;
+            }
+        }
+    }
+    ASSERT_EQ(3u, replica_cnt);
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table " + table + ";", &status));
+    ASSERT_TRUE(router->DropDB(db, &status));
+}
+
+TEST_F(SQLClusterTest, DeploymentStatsAndExplainAnalyze) {
+    FLAGS_enable_deploy_profile = true;
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    auto router = NewClusterSQLRouter(sql_opt);
+    ASSERT_TRUE(router != nullptr);
+    SetOnlineMode(router);
+    ::hybridse::sdk::Status status;
+    std::string table = "test" + GenRand();
+    std::string db = "db" + GenRand();
+    ASSERT_TRUE(router->CreateDB(db, &status));
+    router->ExecuteSQL("use " + db + ";", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    std::string ddl = "create table " + table + "(c1 string, c2 bigint, index(key=c1, ts=c2)) options(partitionnum=1);";
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status)) << status.msg;
+    ASSERT_TRUE(router->RefreshCatalog());
+    ASSERT_TRUE(router->ExecuteInsert(db, "insert into " + table + " values('key1', 1000);", &status));
+    // a deployment named stats is still shown by SHOW DEPLOYMENT
+    std::string sql = "select c1, sum(c2) over w1 as s from " + table +
+                      " window w1 as (partition by c1 order by c2 rows between 2 preceding and current row);";
+    router->ExecuteSQL("deploy stats " + sql, &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    auto rs = router->ExecuteSQL("show deployment stats;", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_TRUE(rs && rs->Size() > 0);
+
+    auto request_row = router->GetRequestRowByProcedure(db, "stats", &status);
+    ASSERT_TRUE(request_row) << status.msg;
+    request_row->Init(4);
+    ASSERT_TRUE(request_row->AppendString("key1"));
+    ASSERT_TRUE(request_row->AppendInt64(2000));
+    ASSERT_TRUE(request_row->Build());
+    rs = router->CallProcedure(db, "stats", request_row, &status);
+    ASSERT_TRUE(rs) << status.msg;
+    ASSERT_TRUE(rs->Next());
+    ASSERT_EQ(3000, rs->GetInt64Unsafe(1));
+
+    rs = router->ExecuteSQL("show deployment_stats;", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_TRUE(rs && rs->Size() > 0);
+    ASSERT_EQ(8, rs->GetSchema()->GetColumnCnt());
+    while (rs->Next()) {
+        ASSERT_EQ("stats", rs->GetStringUnsafe(0));
+        // the deployment is called once
+        ASSERT_EQ("1", rs->GetStringUnsafe(3));
+    }
+
+    rs = router->ExecuteSQL("explain select c1, c2 + 1 from " + table + " CONFIG (analyze = true);", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_TRUE(rs && rs->Size() > 0);
+    ASSERT_EQ(7, rs->GetSchema()->GetColumnCnt());
+    ASSERT_EQ("RunnerId", rs->GetSchema()->GetColumnName(0));
+    // the plain explain is left as it is
+    rs = router->ExecuteSQL("explain select c1, c2 + 1 from " + table + ";", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_EQ(1, rs->GetSchema()->GetColumnCnt());
+
+    router->ExecuteSQL("drop deployment stats;", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table " + table + ";", &status));
+    ASSERT_TRUE(router->DropDB(db, &status));
+    FLAGS_enable_deploy_profile = false;
+}
+
+TEST_F(SQLClusterTest, CallProcedureOnPartitionLeader) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    auto router = NewClusterSQLRouter(sql_opt);
+    ASSERT_TRUE(router != nullptr);
+    SetOnlineMode(router);
+    auto sql_cluster_router = std::dynamic_pointer_cast<SQLClusterRouter>(router);
+    ASSERT_TRUE(sql_cluster_router);
+    ::hybridse::sdk::Status status;
+    std::string table = "test" + GenRand();
+    std::string db = "db" + GenRand();
+    ASSERT_TRUE(router->CreateDB(db, &status));
+    std::string ddl = "create table " + table +
+                      "(c1 string, c2 bigint, index(key=c1, ts=c2)) options(partitionnum=8, replicanum=1);";
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status)) << status.msg;
+    ASSERT_TRUE(router->RefreshCatalog());
+    // the keys are spread over the partitions, so over all the tablets
+    for (int i = 0; i < 20; i++) {
+        std::string key = "key" + std::to_string(i);
+        for (int j = 1; j <= 3; j++) {
+            std::string insert = absl::StrCat("insert into ", table, " values('", key, "', ", j * 1000, ");");
+            ASSERT_TRUE(router->ExecuteInsert(db, insert, &status)) << status.msg;
+        }
+    }
+    std::string sp_name = "sp" + GenRand();
+    std::string sql = "select c1, sum(c2) over w1 as s from " + table +
+                      " window w1 as (partition by c1 order by c2 rows between 3 preceding and current row);";
+    router->ExecuteSQL(db, "deploy " + sp_name + " " + sql, &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+
+    for (int i = 0; i < 20; i++) {
+        std::string key = "key" + std::to_string(i);
+        auto request_row = router->GetRequestRowByProcedure(db, sp_name, &status);
+        ASSERT_TRUE(request_row) << status.msg;
+        request_row->Init(key.size());
+        ASSERT_TRUE(request_row->AppendString(key));
+        ASSERT_TRUE(request_row->AppendInt64(4000));
+        ASSERT_TRUE(request_row->Build());
+        // the window is only found on the tablet holding the partition of the key
+        auto rs = router->CallProcedure(db, sp_name, request_row, &status);
+        ASSERT_TRUE(rs) << status.msg;
+        ASSERT_EQ(1, rs->Size());
+        ASSERT_TRUE(rs->Next());
+        ASSERT_EQ(key, rs->GetStringUnsafe(0));
+        ASSERT_EQ(10000, rs->GetInt64Unsafe(1));
+
+        auto future = sql_cluster_router->CallProcedure(db, sp_name, 1000, request_row, &status);
+        ASSERT_TRUE(future) << status.msg;
+        rs = future->GetResultSet(&status);
+        ASSERT_TRUE(rs) << status.msg;
+        ASSERT_TRUE(rs->Next());
+        ASSERT_EQ(key, rs->GetStringUnsafe(0));
+        ASSERT_EQ(10000, rs->GetInt64Unsafe(1));
+    }
+
+    router->ExecuteSQL(db, "drop deployment " + sp_name + ";", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table " + table + ";", &status));
+    ASSERT_TRUE(router->DropDB(db, &status));
+}
+
 }  // namespace sdk
 }  // namespace openmldb
 
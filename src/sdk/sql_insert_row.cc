@@ -18,8 +18,10 @@
 
 #include <stdint.h>
 
+#include <memory>
 #include <string>
 
+#include "codec/composite_key.h"
 #include "glog/logging.h"
 
 namespace openmldb {
@@ -92,27 +94,46 @@ const std::map<uint32_t, std::vector<std::pair<std::string, uint32_t>>>& SQLInse
     }
     uint32_t pid_num = table_info_->table_partition_size();
     uint32_t pid = 0;
+    std::unique_ptr<::openmldb::base::PartitionRouter> router;
+    if (table_info_->partition_split_size() > 0) {
+        router = std::make_unique<::openmldb::base::PartitionRouter>(pid_num, table_info_->partition_split());
+    }
+    ::openmldb::codec::CompositeKeyBuilder key_builder;
     for (const auto& kv : index_map_) {
-        std::string key;
+        key_builder.Reset();
         for (uint32_t idx : kv.second) {
-            if (!key.empty()) {
-                key += "|";
-            }
-            key += raw_dimensions_[idx];
+            key_builder.Append(raw_dimensions_[idx]);
         }
-        if (pid_num > 0) {
-            pid = (uint32_t)(::openmldb::base::hash64(key) % pid_num);
+        if (router) {
+            pid = router->GetPid(key_builder.Key());
+        } else if (pid_num > 0) {
+            pid = key_builder.GetPid(pid_num);
         }
         auto iter = dimensions_.find(pid);
         if (iter == dimensions_.end()) {
             auto result = dimensions_.emplace(pid, std::vector<std::pair<std::string, uint32_t>>());
             iter = result.first;
         }
-        iter->second.push_back(std::make_pair(key, kv.first));
+        iter->second.emplace_back(key_builder.Release(), kv.first);
     }
     return dimensions_;
 }
 
+uint32_t SQLInsertRow::GetPartitionId() {
+    if (index_map_.empty()) {
+        return 0;
+    }
+    uint32_t first_idx = index_map_.begin()->first;
+    for (const auto& kv : GetDimensions()) {
+        for (const auto& dim : kv.second) {
+            if (dim.second == first_idx) {
+                return kv.first;
+            }
+        }
+    }
+    return 0;
+}
+
 bool SQLInsertRow::MakeDefault() {
     auto it = default_map_->find(rb_.GetAppendPos());
     if (it != default_map_->end()) {
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "base/hash.h"
+#include "base/partition_router.h"
 #include "codec/codec.h"
 #include "codec/fe_row_codec.h"
 #include "node/sql_node.h"
@@ -81,6 +82,9 @@ class SQLInsertRow {
     bool IsComplete();
     bool Build();
     const std::map<uint32_t, std::vector<std::pair<std::string, uint32_t>>>& GetDimensions();
+    // the partition of the key of the first index of the complete row, the keys of the other indexes may be put to
+    // other partitions
+    uint32_t GetPartitionId();
     inline const std::string& GetRow() { return val_; }
     inline const std::shared_ptr<hybridse::sdk::Schema> GetSchema() { return schema_; }
 
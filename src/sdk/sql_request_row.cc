@@ -19,6 +19,7 @@
 #include <stdint.h>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
 #include "glog/logging.h"
 #include "schema/schema_adapter.h"
@@ -338,6 +339,94 @@ bool SQLRequestRow::Build() {
     return true;
 }
 
+static inline uint32_t SDKGetStrOffset(const char* ptr, uint8_t addr_length) {
+    const uint8_t* addr = reinterpret_cast<const uint8_t*>(ptr);
+    if (addr_length == 1) {
+        return addr[0];
+    } else if (addr_length == 2) {
+        return *(reinterpret_cast<const uint16_t*>(addr));
+    } else if (addr_length == 3) {
+        return (addr[0] << 16) | (addr[1] << 8) | addr[2];
+    }
+    return *(reinterpret_cast<const uint32_t*>(addr));
+}
+
+bool SQLRequestRow::SetRow(const char* direct_buffer, uint32_t length) {
+    is_ok_ = false;
+    record_value_.clear();
+    if (direct_buffer == nullptr || length < str_field_start_offset_) {
+        LOG(WARNING) << "the row is too short, size " << length;
+        return false;
+    }
+    uint32_t size = *(reinterpret_cast<const uint32_t*>(direct_buffer + SDK_VERSION_LENGTH));
+    uint8_t str_addr_length = SDKGetAddrLength(size);
+    if (size != length || str_field_start_offset_ + str_addr_length * str_field_cnt_ > size) {
+        LOG(WARNING) << "the size " << size << " in the row mismatches the buffer size " << length;
+        return false;
+    }
+    for (int32_t idx = 0; idx < schema_->GetColumnCnt(); idx++) {
+        if (direct_buffer[SDK_HEADER_LENGTH + (idx >> 3)] & (1 << (idx & 0x07))) {
+            if (schema_->IsColumnNotNull(idx)) {
+                LOG(WARNING) << "column " << schema_->GetColumnName(idx) << " is not null";
+                return false;
+            }
+            continue;
+        }
+        if (record_cols_.find(idx) == record_cols_.end()) {
+            continue;
+        }
+        // the values of the record columns are kept as the Append functions do
+        const char* ptr = direct_buffer + offset_vec_[idx];
+        std::string val;
+        switch (schema_->GetColumnType(idx)) {
+            case ::hybridse::sdk::kTypeBool:
+                val = *(reinterpret_cast<const bool*>(ptr)) ? "0" : "1";
+                break;
+            case ::hybridse::sdk::kTypeInt16:
+                val = std::to_string(*(reinterpret_cast<const int16_t*>(ptr)));
+                break;
+            case ::hybridse::sdk::kTypeInt32:
+            case ::hybridse::sdk::kTypeDate:
+                val = std::to_string(*(reinterpret_cast<const int32_t*>(ptr)));
+                break;
+            case ::hybridse::sdk::kTypeInt64:
+            case ::hybridse::sdk::kTypeTimestamp:
+                val = std::to_string(*(reinterpret_cast<const int64_t*>(ptr)));
+                break;
+            case ::hybridse::sdk::kTypeFloat:
+                val = std::to_string(*(reinterpret_cast<const float*>(ptr)));
+                break;
+            case ::hybridse::sdk::kTypeDouble:
+                val = std::to_string(*(reinterpret_cast<const double*>(ptr)));
+                break;
+            case ::hybridse::sdk::kTypeString: {
+                ptr = direct_buffer + str_field_start_offset_ + str_addr_length * offset_vec_[idx];
+                uint32_t start = SDKGetStrOffset(ptr, str_addr_length);
+                uint32_t end = offset_vec_[idx] + 1 < str_field_cnt_ ? SDKGetStrOffset(ptr + str_addr_length,
+                                                                                       str_addr_length)
+                                                                     : size;
+                if (start > end || end > size) {
+                    LOG(WARNING) << "invalid string offset of column " << schema_->GetColumnName(idx);
+                    return false;
+                }
+                val.assign(direct_buffer + start, end - start);
+                break;
+            }
+            default:
+                LOG(WARNING) << hybridse::sdk::DataTypeName(schema_->GetColumnType(idx)) << " is not supported";
+                return false;
+        }
+        record_value_.emplace(schema_->GetColumnName(idx), std::move(val));
+    }
+    val_.assign(direct_buffer, length);
+    buf_ = reinterpret_cast<int8_t*>(&(val_[0]));
+    size_ = length;
+    cnt_ = schema_->GetColumnCnt();
+    has_error_ = false;
+    is_ok_ = true;
+    return true;
+}
+
 bool SQLRequestRow::GetRecordVal(const std::string& col, std::string* val) {
     if (val == nullptr) {
         return false;
@@ -49,6 +49,9 @@ class SQLRequestRow {
     bool AppendString(const char* string_buffer_var_name, uint32_t length);
     bool AppendNULL();
     bool Build();
+    // take a row encoded by the caller as a whole instead of appending the columns one by one, so a binding
+    // builds the row with one call. The row is in the layout Build makes, it replaces the appended columns
+    bool SetRow(const char* direct_buffer, uint32_t length);
     inline bool OK() { return is_ok_; }
     inline const std::string& GetRow() { return val_; }
     inline const std::shared_ptr<hybridse::sdk::Schema> GetSchema() { return schema_; }
@@ -79,6 +82,8 @@ class SQLRequestRow {
     std::map<std::string, std::string> record_value_;
 };
 
+::hybridse::type::Type ProtoTypeFromDataType(::hybridse::sdk::DataType type);
+
 class ColumnIndicesSet;
 
 /**
@@ -111,6 +111,41 @@ TEST_F(SQLRequestRowTest, normal_test) {
     ASSERT_EQ(32, i32);
 }
 
+TEST_F(SQLRequestRowTest, SetRow) {
+    ::hybridse::vm::Schema schema;
+    InitSimpleSchema(&schema);
+    std::shared_ptr<::hybridse::sdk::Schema> schema_shared(new ::hybridse::sdk::SchemaImpl(schema));
+    SQLRequestRow appended(schema_shared, std::set<std::string>());
+    ASSERT_TRUE(appended.Init(5));
+    ASSERT_TRUE(appended.AppendInt32(32));
+    ASSERT_TRUE(appended.AppendString("hello"));
+    ASSERT_TRUE(appended.AppendInt64(64));
+    ASSERT_TRUE(appended.Build());
+    const std::string& row = appended.GetRow();
+
+    SQLRequestRow rr(schema_shared, {"col1", "col2"});
+    ASSERT_FALSE(rr.SetRow(row.data(), row.size() - 1));
+    ASSERT_FALSE(rr.OK());
+    ASSERT_TRUE(rr.SetRow(row.data(), row.size()));
+    ASSERT_TRUE(rr.OK());
+    ASSERT_EQ(row, rr.GetRow());
+    std::string val;
+    ASSERT_TRUE(rr.GetRecordVal("col1", &val));
+    ASSERT_EQ("hello", val);
+    ASSERT_TRUE(rr.GetRecordVal("col2", &val));
+    ASSERT_EQ("64", val);
+    ASSERT_FALSE(rr.GetRecordVal("col0", &val));
+
+    // the null columns are not recorded
+    SQLRequestRow null_appended(schema_shared, std::set<std::string>());
+    ASSERT_TRUE(null_appended.Init(0));
+    ASSERT_TRUE(null_appended.AppendInt32(32));
+    ASSERT_TRUE(null_appended.Build());
+    const std::string& null_row = null_appended.GetRow();
+    ASSERT_TRUE(rr.SetRow(null_row.data(), null_row.size()));
+    ASSERT_FALSE(rr.GetRecordVal("col1", &val));
+}
+
 TEST_F(SQLRequestRowTest, GetRecordVal) {
     ::hybridse::vm::Schema schema;
     {
@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "sdk/base.h"
+#include "sdk/bulk_loader.h"
 #include "sdk/result_set.h"
 #include "sdk/sql_insert_row.h"
 #include "sdk/sql_request_row.h"
@@ -41,11 +42,34 @@ struct BasicRouterOptions {
     uint32_t session_timeout = 2000;
     uint32_t max_sql_cache_size = 10;
     uint32_t request_timeout = 60000;
+    // the puts throttled by the tablets are retried in the time, with the backoff doubled from 10ms up to 1s.
+    // 0 fails them at once
+    uint32_t put_throttle_retry_ms = 60000;
+    // the rows of a batch query are fetched from the tablet in chunks of about the bytes as they are read, 0 to
+    // get them in one response, which is truncated at the scan_max_bytes_size of the tablet
+    uint32_t query_chunk_bytes = 1024 * 1024;
+    // read the tables of a batch query as of its start on the tablet, the rows put while it runs are skipped. the
+    // tablets must be built with SNAPSHOT_READ_ENABLE
+    bool snapshot_read = false;
 };
 
 struct SQLRouterOptions : BasicRouterOptions {
     std::string zk_cluster;
     std::string zk_path;
+    // duplicate a procedure call to a follower of the partition if the leader does not answer in the p95
+    // latency of the deployment, and take the first answer
+    bool enable_hedged_request = false;
+    // the delay is no less than it, it is taken until enough latencies are collected
+    uint32_t hedge_min_delay_ms = 10;
+    // the max log entries the follower lags behind the leader to serve the duplicate
+    uint64_t hedge_max_lag = 1000;
+    // spread the procedure calls and the scans of the table readers over the leader and the followers lagging
+    // behind it by no more than follower_read_max_lag log entries. the session variables follower_read and
+    // follower_read_max_lag override them, and the deployment option follower_read_max_lag overrides both
+    bool enable_follower_read = false;
+    uint64_t follower_read_max_lag = 1000;
+    // the offsets of the replicas to select the followers by are refreshed at the interval
+    uint32_t replica_offset_refresh_ms = 1000;
 };
 
 struct StandaloneOptions : BasicRouterOptions {
@@ -98,8 +122,18 @@ class SQLRouter {
     virtual bool ExecuteInsert(const std::string& db, const std::string& sql,
                                std::shared_ptr<openmldb::sdk::SQLInsertRows> row, hybridse::sdk::Status* status) = 0;
 
+    // put the rows with BatchPut requests grouped by the tablets of their partitions rather than a Put per row and
+    // partition, it returns once all of them are acked or any of them fails
+    virtual bool ExecuteInsertBatch(const std::string& db, const std::string& sql,
+                                    std::shared_ptr<openmldb::sdk::SQLInsertRows> rows,
+                                    hybridse::sdk::Status* status) = 0;
+
     virtual std::shared_ptr<openmldb::sdk::TableReader> GetTableReader() = 0;
 
+    // the loader of an empty online table, the rows are loaded in bulk rather than put one by one
+    virtual std::shared_ptr<openmldb::sdk::BulkLoader> GetBulkLoader(const std::string& db, const std::string& table,
+                                                                     hybridse::sdk::Status* status) = 0;
+
     virtual std::shared_ptr<ExplainInfo> Explain(const std::string& db, const std::string& sql,
                                                  ::hybridse::sdk::Status* status) = 0;
 
@@ -179,6 +213,20 @@ class SQLRouter {
                                                          const std::string& default_db, bool sync_job,
                                                          ::openmldb::taskmanager::JobInfo& job_info) = 0; // NOLINT
 
+    // run the offline query until it is done and write its result to the files of the format, csv or parquet,
+    // which are read by pages by FetchOfflineResult
+    virtual ::openmldb::base::Status ExecuteOfflineQueryToResult(const std::string& sql,
+                                                                 const std::map<std::string, std::string>& config,
+                                                                 const std::string& default_db,
+                                                                 const std::string& format,
+                                                                 std::string* result_path) = 0;
+
+    // the rows in [offset, offset + limit) of the result of an offline query, all the columns are strings
+    virtual std::shared_ptr<hybridse::sdk::ResultSet> FetchOfflineResult(const std::string& result_path,
+                                                                         uint64_t offset, uint32_t limit,
+                                                                         uint64_t* total_rows,
+                                                                         hybridse::sdk::Status* status) = 0;
+
     virtual ::openmldb::base::Status ImportOnlineData(const std::string& sql,
                                                       const std::map<std::string, std::string>& config,
                                                       const std::string& default_db, bool sync_job,
@@ -28,6 +28,38 @@
 // Enable protobuf interfaces
 %include "swig_library/java/protobuf.i"
 %protobuf(openmldb::nameserver::TableInfo, com._4paradigm.openmldb.proto.NS.TableInfo);
+
+// the column buffers are read as a direct ByteBuffer without copying
+%typemap(jni) openmldb::sdk::ColumnBuffer "jobject"
+%typemap(jtype) openmldb::sdk::ColumnBuffer "java.nio.ByteBuffer"
+%typemap(jstype) openmldb::sdk::ColumnBuffer "java.nio.ByteBuffer"
+%typemap(out) openmldb::sdk::ColumnBuffer %{
+    $result = jenv->NewDirectByteBuffer(const_cast<char*>($1.data), static_cast<jlong>($1.size));
+%}
+%typemap(javaout) openmldb::sdk::ColumnBuffer {
+    return $jnicall.order(java.nio.ByteOrder.LITTLE_ENDIAN);
+  }
+
+// the rows encoded in java are passed as a direct ByteBuffer without copying
+%typemap(jni) const char* direct_buffer "jobject"
+%typemap(jtype) const char* direct_buffer "java.nio.ByteBuffer"
+%typemap(jstype) const char* direct_buffer "java.nio.ByteBuffer"
+%typemap(javain) const char* direct_buffer "$javainput"
+%typemap(in) const char* direct_buffer %{
+    $1 = static_cast<const char*>(jenv->GetDirectBufferAddress($input));
+    if ($1 == nullptr) {
+        SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "the buffer is not direct");
+        return $null;
+    }
+%}
+%typemap(freearg) const char* direct_buffer ""
+#endif
+
+#ifdef SWIGPYTHON
+// the column buffers are read as a memoryview without copying
+%typemap(out) openmldb::sdk::ColumnBuffer %{
+    $result = PyMemoryView_FromMemory(const_cast<char*>($1.data), static_cast<Py_ssize_t>($1.size), PyBUF_READ);
+%}
 #endif
 
 %shared_ptr(hybridse::sdk::ResultSet);
@@ -43,6 +75,8 @@
 %shared_ptr(hybridse::sdk::ProcedureInfo);
 %shared_ptr(openmldb::sdk::QueryFuture);
 %shared_ptr(openmldb::sdk::TableReader);
+%shared_ptr(openmldb::sdk::BulkLoader);
+%shared_ptr(openmldb::sdk::ColumnarResultSet);
 %template(VectorUint32) std::vector<uint32_t>;
 %template(VectorString) std::vector<std::string>;
 
@@ -53,6 +87,8 @@
 #include "sdk/sql_request_row.h"
 #include "sdk/sql_insert_row.h"
 #include "sdk/table_reader.h"
+#include "sdk/bulk_loader.h"
+#include "sdk/columnar_result_set.h"
 
 using hybridse::sdk::Schema;
 using hybridse::sdk::ColumnTypes;
@@ -68,6 +104,8 @@ using openmldb::sdk::ExplainInfo;
 using hybridse::sdk::ProcedureInfo;
 using openmldb::sdk::QueryFuture;
 using openmldb::sdk::TableReader;
+using openmldb::sdk::BulkLoader;
+using openmldb::sdk::ColumnarResultSet;
 %}
 
 %include "sdk/sql_router.h"
@@ -76,6 +114,8 @@ using openmldb::sdk::TableReader;
 %include "sdk/sql_request_row.h"
 %include "sdk/sql_insert_row.h"
 %include "sdk/table_reader.h"
+%include "sdk/bulk_loader.h"
+%include "sdk/columnar_result_set.h"
 
 %template(ColumnDescPair) std::pair<std::string, hybridse::sdk::DataType>;
 %template(ColumnDescVector) std::vector<std::pair<std::string, hybridse::sdk::DataType>>;
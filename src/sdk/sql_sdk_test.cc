@@ -19,7 +19,9 @@
 #include <sched.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <vector>
 
@@ -29,6 +31,7 @@
 #include "common/timer.h"
 #include "gflags/gflags.h"
 #include "sdk/mini_cluster.h"
+#include "sdk/sql_cluster_router.h"
 #include "sdk/sql_router.h"
 #include "test/base_test.h"
 #include "vm/catalog.h"
@@ -561,6 +564,185 @@ TEST_F(SQLSDKQueryTest, RequestProcedureTest) {
     ASSERT_TRUE(router->ExecuteDDL(db, "drop table trans;", &status));
 }
 
+TEST_F(SQLSDKQueryTest, AsyncCallProcedureTest) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    sql_opt.session_timeout = 30000;
+    auto router = std::dynamic_pointer_cast<SQLClusterRouter>(NewClusterSQLRouter(sql_opt));
+    ASSERT_TRUE(router);
+    SetOnlineMode(router);
+    std::string db = "async_call_db";
+    hybridse::sdk::Status status;
+    router->CreateDB(db, &status);
+    ASSERT_TRUE(router->ExecuteDDL(db, "create table t1(c1 string, c4 bigint, c7 timestamp, index(key=c1, ts=c7));",
+                                   &status));
+    ASSERT_TRUE(router->RefreshCatalog());
+    ASSERT_TRUE(router->ExecuteInsert(db, "insert into t1 values(\"bb\", 10, 1590738994000);", &status));
+    std::string sql =
+        "SELECT c1, sum(c4) OVER w1 as w1_c4_sum FROM t1 WINDOW w1 AS"
+        " (PARTITION BY t1.c1 ORDER BY t1.c7 ROWS BETWEEN 2 PRECEDING AND CURRENT ROW);";
+    ASSERT_TRUE(router->ExecuteDDL(db, "create procedure sp1 (c1 string, c4 bigint, c7 timestamp) begin " + sql +
+                                           " end;", &status));
+    ASSERT_TRUE(router->RefreshCatalog());
+
+    AsyncCallOptions options;
+    options.max_batch_rows = 8;
+    options.flush_interval_ms = 5;
+    auto caller = router->CreateAsyncProcedureCaller(db, "sp1", options, &status);
+    ASSERT_TRUE(caller) << status.msg;
+    const int call_cnt = 20;
+    std::atomic<int> ok_cnt{0};
+    std::atomic<int64_t> sum{0};
+    for (int i = 0; i < call_cnt; i++) {
+        auto request_row = router->GetRequestRow(db, sql, &status);
+        ASSERT_TRUE(request_row);
+        request_row->Init(2);
+        ASSERT_TRUE(request_row->AppendString("bb"));
+        ASSERT_TRUE(request_row->AppendInt64(i));
+        ASSERT_TRUE(request_row->AppendTimestamp(1590738995000));
+        ASSERT_TRUE(request_row->Build());
+        caller->Call(request_row, [&](const hybridse::sdk::Status& st, std::shared_ptr<hybridse::sdk::ResultSet> rs) {
+            if (st.IsOK() && rs && rs->Next() && rs->GetStringUnsafe(0) == "bb") {
+                sum.fetch_add(rs->GetInt64Unsafe(1));
+                ok_cnt.fetch_add(1);
+            }
+        });
+    }
+    caller->WaitAll();
+    ASSERT_EQ(call_cnt, ok_cnt.load());
+    // every call sums its own row and the inserted row
+    ASSERT_EQ(call_cnt * 10 + (call_cnt - 1) * call_cnt / 2, sum.load());
+    caller.reset();
+
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop procedure sp1;", &status));
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table t1;", &status));
+}
+
+TEST_F(SQLSDKQueryTest, PreparedStatementTest) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    sql_opt.session_timeout = 30000;
+    auto router = std::dynamic_pointer_cast<SQLClusterRouter>(NewClusterSQLRouter(sql_opt));
+    ASSERT_TRUE(router);
+    SetOnlineMode(router);
+    std::string db = "prepared_statement_db";
+    hybridse::sdk::Status status;
+    router->CreateDB(db, &status);
+    std::string ddl = "create table t1(c1 string, c4 bigint, c7 timestamp, index(key=c1, ts=c7));";
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status));
+    ASSERT_TRUE(router->RefreshCatalog());
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(router->ExecuteInsert(
+            db, "insert into t1 values(\"bb\", " + std::to_string(i) + ", " + std::to_string(1590738994000 + i) + ");",
+            &status));
+    }
+
+    auto parameter_types = std::make_shared<hybridse::sdk::ColumnTypes>();
+    parameter_types->AddColumnType(::hybridse::sdk::kTypeString);
+    parameter_types->AddColumnType(::hybridse::sdk::kTypeInt64);
+    auto parameter_row = SQLRequestRow::CreateSQLRequestRowFromColumnTypes(parameter_types);
+    auto statement =
+        router->Prepare(db, "select c1, c4 from t1 where c1 = ? and c4 >= ?;", parameter_row->GetSchema(), &status);
+    ASSERT_TRUE(statement) << status.msg;
+    auto execute = [&](const std::string& key, int64_t min_value) -> int32_t {
+        parameter_row->Init(key.size());
+        parameter_row->AppendString(key);
+        parameter_row->AppendInt64(min_value);
+        parameter_row->Build();
+        auto rs = statement->Execute(parameter_row, &status);
+        return rs ? rs->Size() : -1;
+    };
+    // the first execution prepares the query on the tablet and the later ones send its id
+    for (int k = 0; k < 3; k++) {
+        ASSERT_EQ(5, execute("bb", 0)) << status.msg;
+        ASSERT_EQ(2, execute("bb", 3)) << status.msg;
+        ASSERT_EQ(0, execute("aa", 0)) << status.msg;
+    }
+    ASSERT_FALSE(statement->Execute({}, &status));
+
+    // the prepared query is dropped on the tablet with the table, and prepared again
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table t1;", &status));
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status));
+    ASSERT_TRUE(router->RefreshCatalog());
+    ASSERT_TRUE(router->ExecuteInsert(db, "insert into t1 values(\"bb\", 7, 1590738994000);", &status));
+    ASSERT_EQ(1, execute("bb", 0)) << status.msg;
+    ASSERT_EQ(1, execute("bb", 7)) << status.msg;
+
+    ASSERT_FALSE(router->Prepare(db, "select c1 from t2 where c1 = ?;", parameter_row->GetSchema(), &status));
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table t1;", &status));
+}
+
+
+TEST_F(SQLSDKQueryTest, ReplayProcedureTest) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    sql_opt.session_timeout = 30000;
+    auto router = std::dynamic_pointer_cast<SQLClusterRouter>(NewClusterSQLRouter(sql_opt));
+    ASSERT_TRUE(router);
+    SetOnlineMode(router);
+    std::string db = "replay_db";
+    hybridse::sdk::Status status;
+    router->CreateDB(db, &status);
+    ASSERT_TRUE(router->ExecuteDDL(db, "create table t1(c1 string, c4 bigint, c7 timestamp, index(key=c1, ts=c7));",
+                                   &status));
+    ASSERT_TRUE(router->RefreshCatalog());
+    ASSERT_TRUE(router->ExecuteInsert(db, "insert into t1 values(\"bb\", 10, 1590738994000);", &status));
+    std::string sql =
+        "SELECT c1, c4, sum(c4) OVER w1 as w1_c4_sum FROM t1 WINDOW w1 AS"
+        " (PARTITION BY t1.c1 ORDER BY t1.c7 ROWS BETWEEN 2 PRECEDING AND CURRENT ROW);";
+    ASSERT_TRUE(router->ExecuteDDL(db, "create procedure sp1 (c1 string, c4 bigint, c7 timestamp) begin " + sql +
+                                           " end;", &status));
+    ASSERT_TRUE(router->RefreshCatalog());
+
+    ReplayOptions options;
+    options.batch_rows = 4;
+    options.key_columns = {"c1"};
+    options.ts_column = "c7";
+    auto replayer = router->CreateFeatureReplayer(db, "sp1", options, &status);
+    ASSERT_TRUE(replayer) << status.msg;
+    options.ts_column = "c8";
+    ASSERT_FALSE(router->CreateFeatureReplayer(db, "sp1", options, &status));
+
+    const int row_cnt = 20;
+    std::vector<std::shared_ptr<SQLRequestRow>> rows;
+    for (int i = 0; i < row_cnt; i++) {
+        auto request_row = router->GetRequestRow(db, sql, &status);
+        ASSERT_TRUE(request_row);
+        request_row->Init(2);
+        ASSERT_TRUE(request_row->AppendString(i % 2 == 0 ? "aa" : "bb"));
+        ASSERT_TRUE(request_row->AppendInt64(i));
+        ASSERT_TRUE(request_row->AppendTimestamp(1590738995000 + row_cnt - i));
+        ASSERT_TRUE(request_row->Build());
+        rows.push_back(request_row);
+    }
+    std::mutex mu;
+    std::vector<int64_t> sums(row_cnt, -1);
+    status = replayer->Replay(rows, [&](const std::vector<size_t>& indices, const hybridse::sdk::Status& st,
+                                        std::shared_ptr<hybridse::sdk::ResultSet> rs) {
+        if (!st.IsOK()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mu);
+        for (auto idx : indices) {
+            if (rs->Next() && rs->GetInt64Unsafe(1) == static_cast<int64_t>(idx)) {
+                sums[idx] = rs->GetInt64Unsafe(2);
+            }
+        }
+    });
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    // every request row only sums itself and the rows of the table
+    for (int i = 0; i < row_cnt; i++) {
+        ASSERT_EQ(i % 2 == 0 ? i : i + 10, sums[i]) << "row " << i;
+    }
+    replayer.reset();
+
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop procedure sp1;", &status));
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table t1;", &status));
+}
+
 
 TEST_F(SQLSDKQueryTest, DropTableWithProcedureTest) {
     // create table trans
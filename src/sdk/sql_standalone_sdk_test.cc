@@ -32,6 +32,7 @@
 #include "sdk/sql_router.h"
 #include "sdk/sql_cluster_router.h"
 #include "sdk/db_sdk.h"
+#include "sdk/embedded_env.h"
 #include "test/base_test.h"
 #include "vm/catalog.h"
 
@@ -873,6 +874,40 @@ TEST_F(SQLSDKTest, CreatePreAggrTable) {
 }  // namespace sdk
 }  // namespace openmldb
 
+TEST_F(SQLSDKTest, EmbeddedEnvTest) {
+    // the embedded env runs beside the standalone env of the tests, so the flags are restored after set up
+    std::string db_root_path = FLAGS_db_root_path;
+    std::string tablet = FLAGS_tablet;
+    EmbeddedOptions options;
+    options.db_root_path = "/tmp/embedded_env" + std::to_string(rand() % 1000 + 10000);  // NOLINT
+    options.tablet_endpoint = "127.0.0.1:" + std::to_string(rand() % 1000 + 20000);  // NOLINT
+    options.ns_port = rand() % 1000 + 21000;  // NOLINT
+    EmbeddedEnv env;
+    bool ok = env.SetUp(options);
+    FLAGS_db_root_path = db_root_path;
+    FLAGS_tablet = tablet;
+    ASSERT_TRUE(ok);
+    {
+        auto router = env.NewRouter();
+        ASSERT_TRUE(router);
+        hybridse::sdk::Status status;
+        router->ExecuteSQL("SET @@execute_mode='online';", &status);
+        std::string db = "embedded_db";
+        ASSERT_TRUE(router->CreateDB(db, &status)) << status.msg;
+        ASSERT_TRUE(router->ExecuteDDL(db, "create table t1(c1 string, c2 bigint, index(key=c1, ts=c2));", &status));
+        ASSERT_TRUE(router->RefreshCatalog());
+        ASSERT_TRUE(router->ExecuteInsert(db, "insert into t1 values('a', 1);", &status)) << status.msg;
+        ASSERT_TRUE(router->ExecuteInsert(db, "insert into t1 values('a', 2);", &status)) << status.msg;
+        auto rs = router->ExecuteSQL(db, "select c1, c2 from t1 where c1 = 'a';", &status);
+        ASSERT_TRUE(rs) << status.msg;
+        ASSERT_EQ(2, rs->Size());
+        ASSERT_TRUE(router->ExecuteDDL(db, "drop table t1;", &status));
+        ASSERT_TRUE(router->DropDB(db, &status));
+    }
+    env.Close();
+    base::RemoveDirRecursive(options.db_root_path);
+}
+
 int main(int argc, char** argv) {
     ::hybridse::vm::Engine::InitializeGlobalLLVM();
     ::testing::InitGoogleTest(&argc, argv);
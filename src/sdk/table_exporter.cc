@@ -0,0 +1,617 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/table_exporter.h"
+
+#include <snappy.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "base/file_util.h"
+#include "base/kv_iterator.h"
+#include "codec/codec.h"
+#include "config.h"  // NOLINT
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+#ifdef ARROW_ENABLE
+#include "arrow/api.h"
+#include "arrow/io/file.h"
+#include "parquet/arrow/writer.h"
+#endif
+
+DECLARE_uint32(traverse_cnt_limit);
+
+namespace openmldb {
+namespace sdk {
+
+namespace {
+
+using ::openmldb::base::Status;
+
+// the rows converted by a thread, which are written into the file as a whole
+class RowBlock {
+ public:
+    virtual ~RowBlock() {}
+    virtual bool Append(const ::openmldb::codec::RowView& row_view) = 0;
+    virtual uint64_t GetRowCnt() const = 0;
+    virtual uint64_t GetByteSize() const = 0;
+};
+
+class BlockFile {
+ public:
+    virtual ~BlockFile() {}
+    virtual Status Open(const std::string& path) = 0;
+    virtual std::unique_ptr<RowBlock> NewBlock() = 0;
+    // the block is consumed
+    virtual Status Write(RowBlock* block) = 0;
+    virtual Status Close() = 0;
+};
+
+Status CheckMode(const std::string& path, const std::string& mode) {
+    if (mode == "error_if_exists" && access(path.c_str(), 0) == 0) {
+        return {::openmldb::base::kSQLCmdRunError, "File already exists"};
+    }
+    return {};
+}
+
+class CsvBlock : public RowBlock {
+ public:
+    CsvBlock(const ::openmldb::codec::Schema& schema, const WriteFileOptionsParser& options)
+        : schema_(schema), options_(options), row_cnt_(0) {}
+
+    bool Append(const ::openmldb::codec::RowView& row_view) override {
+        if (row_cnt_ > 0) {
+            buf_.append("\n");
+        }
+        std::string val;
+        for (int i = 0; i < schema_.size(); i++) {
+            if (i > 0) {
+                buf_.append(options_.GetDelimiter());
+            }
+            if (row_view.IsNULL(i)) {
+                buf_.append(options_.GetNullValue());
+                continue;
+            }
+            auto type = schema_.Get(i).data_type();
+            if (type == ::openmldb::type::kDate) {
+                // the same as the date string of the result set
+                uint32_t year = 0;
+                uint32_t month = 0;
+                uint32_t day = 0;
+                if (row_view.GetDate(i, &year, &month, &day) != 0) {
+                    return false;
+                }
+                char date[11];
+                snprintf(date, sizeof(date), "%4d-%.2d-%.2d", static_cast<int>(year), static_cast<int>(month),
+                         static_cast<int>(day));
+                buf_.append(date);
+                continue;
+            }
+            if (row_view.GetStrValue(i, &val) < 0) {
+                return false;
+            }
+            if (options_.GetQuote() != '\0' &&
+                (type == ::openmldb::type::kString || type == ::openmldb::type::kVarchar)) {
+                buf_.push_back(options_.GetQuote());
+                buf_.append(val);
+                buf_.push_back(options_.GetQuote());
+            } else {
+                buf_.append(val);
+            }
+        }
+        row_cnt_++;
+        return true;
+    }
+    uint64_t GetRowCnt() const override { return row_cnt_; }
+    uint64_t GetByteSize() const override { return buf_.size(); }
+    const std::string& GetBuf() const { return buf_; }
+    void Clear() {
+        buf_.clear();
+        row_cnt_ = 0;
+    }
+
+ private:
+    const ::openmldb::codec::Schema& schema_;
+    const WriteFileOptionsParser& options_;
+    std::string buf_;
+    uint64_t row_cnt_;
+};
+
+// the rows are separated by '\n' without one at the end, as SaveResultSet writes them
+class CsvFile : public BlockFile {
+ public:
+    CsvFile(const ::openmldb::codec::Schema& schema, const WriteFileOptionsParser& options)
+        : schema_(schema), options_(options), has_row_(false) {}
+
+    Status Open(const std::string& path) override {
+        auto st = CheckMode(path, options_.GetMode());
+        if (!st.OK()) {
+            return st;
+        }
+        if (options_.GetMode() == "append") {
+            out_.open(path, std::ios::app);
+            out_ << std::endl;
+            if (options_.GetHeader()) {
+                LOG(WARNING) << "In the middle of output file will have header";
+            }
+        } else {
+            out_.open(path, std::ios::out);
+        }
+        if (!out_.is_open()) {
+            return {::openmldb::base::kSQLCmdRunError, "Failed to open file, please check file path"};
+        }
+        if (options_.GetHeader()) {
+            for (int i = 0; i < schema_.size(); i++) {
+                if (i > 0) {
+                    out_ << options_.GetDelimiter();
+                }
+                out_ << schema_.Get(i).name();
+            }
+            out_ << std::endl;
+        }
+        return {};
+    }
+    std::unique_ptr<RowBlock> NewBlock() override { return std::make_unique<CsvBlock>(schema_, options_); }
+    Status Write(RowBlock* block) override {
+        auto* csv_block = dynamic_cast<CsvBlock*>(block);
+        if (csv_block->GetRowCnt() == 0) {
+            return {};
+        }
+        if (has_row_) {
+            out_ << "\n";
+        }
+        out_ << csv_block->GetBuf();
+        has_row_ = true;
+        csv_block->Clear();
+        if (!out_.good()) {
+            return {::openmldb::base::kSQLCmdRunError, "Failed to write file"};
+        }
+        return {};
+    }
+    Status Close() override {
+        out_.close();
+        return {};
+    }
+
+ private:
+    const ::openmldb::codec::Schema& schema_;
+    const WriteFileOptionsParser& options_;
+    std::ofstream out_;
+    bool has_row_;
+};
+
+#ifdef ARROW_ENABLE
+
+std::shared_ptr<::arrow::DataType> GetArrowType(::openmldb::type::DataType type) {
+    switch (type) {
+        case ::openmldb::type::kBool:
+            return ::arrow::boolean();
+        case ::openmldb::type::kSmallInt:
+            return ::arrow::int16();
+        case ::openmldb::type::kInt:
+            return ::arrow::int32();
+        case ::openmldb::type::kBigInt:
+            return ::arrow::int64();
+        case ::openmldb::type::kFloat:
+            return ::arrow::float32();
+        case ::openmldb::type::kDouble:
+            return ::arrow::float64();
+        case ::openmldb::type::kTimestamp:
+            return ::arrow::timestamp(::arrow::TimeUnit::MILLI);
+        case ::openmldb::type::kDate:
+            return ::arrow::date32();
+        default:
+            return ::arrow::utf8();
+    }
+}
+
+// the days since the epoch of the date encoded as (year - 1900) << 16 | (month - 1) << 8 | day
+int32_t DateToDays(int32_t date) {
+    int32_t day = date & 0xFF;
+    int32_t month = 1 + ((date >> 8) & 0xFF);
+    int32_t year = 1900 + (date >> 16);
+    // days from civil, see http://howardhinnant.github.io/date_algorithms.html
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    int32_t yoe = year - era * 400;
+    int32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+class ParquetBlock : public RowBlock {
+ public:
+    ParquetBlock(const ::openmldb::codec::Schema& schema, std::shared_ptr<::arrow::Schema> arrow_schema)
+        : schema_(schema), arrow_schema_(arrow_schema), row_cnt_(0), byte_size_(0) {
+        for (const auto& field : arrow_schema_->fields()) {
+            std::unique_ptr<::arrow::ArrayBuilder> builder;
+            auto st = ::arrow::MakeBuilder(::arrow::default_memory_pool(), field->type(), &builder);
+            DCHECK(st.ok());
+            builders_.emplace_back(std::move(builder));
+        }
+    }
+
+    bool Append(const ::openmldb::codec::RowView& row_view) override {
+        for (int i = 0; i < schema_.size(); i++) {
+            auto* builder = builders_[i].get();
+            if (row_view.IsNULL(i)) {
+                if (!builder->AppendNull().ok()) {
+                    return false;
+                }
+                continue;
+            }
+            ::arrow::Status st;
+            switch (schema_.Get(i).data_type()) {
+                case ::openmldb::type::kBool: {
+                    bool val = false;
+                    row_view.GetBool(i, &val);
+                    st = static_cast<::arrow::BooleanBuilder*>(builder)->Append(val);
+                    byte_size_ += 1;
+                    break;
+                }
+                case ::openmldb::type::kSmallInt: {
+                    int16_t val = 0;
+                    row_view.GetInt16(i, &val);
+                    st = static_cast<::arrow::Int16Builder*>(builder)->Append(val);
+                    byte_size_ += 2;
+                    break;
+                }
+                case ::openmldb::type::kInt: {
+                    int32_t val = 0;
+                    row_view.GetInt32(i, &val);
+                    st = static_cast<::arrow::Int32Builder*>(builder)->Append(val);
+                    byte_size_ += 4;
+                    break;
+                }
+                case ::openmldb::type::kBigInt: {
+                    int64_t val = 0;
+                    row_view.GetInt64(i, &val);
+                    st = static_cast<::arrow::Int64Builder*>(builder)->Append(val);
+                    byte_size_ += 8;
+                    break;
+                }
+                case ::openmldb::type::kFloat: {
+                    float val = 0;
+                    row_view.GetFloat(i, &val);
+                    st = static_cast<::arrow::FloatBuilder*>(builder)->Append(val);
+                    byte_size_ += 4;
+                    break;
+                }
+                case ::openmldb::type::kDouble: {
+                    double val = 0;
+                    row_view.GetDouble(i, &val);
+                    st = static_cast<::arrow::DoubleBuilder*>(builder)->Append(val);
+                    byte_size_ += 8;
+                    break;
+                }
+                case ::openmldb::type::kTimestamp: {
+                    int64_t val = 0;
+                    row_view.GetTimestamp(i, &val);
+                    st = static_cast<::arrow::TimestampBuilder*>(builder)->Append(val);
+                    byte_size_ += 8;
+                    break;
+                }
+                case ::openmldb::type::kDate: {
+                    int32_t val = 0;
+                    row_view.GetDate(i, &val);
+                    st = static_cast<::arrow::Date32Builder*>(builder)->Append(DateToDays(val));
+                    byte_size_ += 4;
+                    break;
+                }
+                default: {
+                    char* val = nullptr;
+                    uint32_t length = 0;
+                    row_view.GetString(i, &val, &length);
+                    st = static_cast<::arrow::StringBuilder*>(builder)->Append(val, length);
+                    byte_size_ += length;
+                    break;
+                }
+            }
+            if (!st.ok()) {
+                return false;
+            }
+        }
+        row_cnt_++;
+        return true;
+    }
+    uint64_t GetRowCnt() const override { return row_cnt_; }
+    uint64_t GetByteSize() const override { return byte_size_; }
+    // finish the builders into a table, the builders are reset for the next rows
+    ::arrow::Status Finish(std::shared_ptr<::arrow::Table>* table) {
+        std::vector<std::shared_ptr<::arrow::Array>> arrays;
+        for (auto& builder : builders_) {
+            std::shared_ptr<::arrow::Array> array;
+            ARROW_RETURN_NOT_OK(builder->Finish(&array));
+            arrays.emplace_back(std::move(array));
+        }
+        *table = ::arrow::Table::Make(arrow_schema_, arrays, row_cnt_);
+        row_cnt_ = 0;
+        byte_size_ = 0;
+        return ::arrow::Status::OK();
+    }
+
+ private:
+    const ::openmldb::codec::Schema& schema_;
+    std::shared_ptr<::arrow::Schema> arrow_schema_;
+    std::vector<std::unique_ptr<::arrow::ArrayBuilder>> builders_;
+    uint64_t row_cnt_;
+    uint64_t byte_size_;
+};
+
+// a block is written as a row group
+class ParquetFile : public BlockFile {
+ public:
+    ParquetFile(const ::openmldb::codec::Schema& schema, const WriteFileOptionsParser& options)
+        : schema_(schema), options_(options) {
+        ::arrow::FieldVector fields;
+        for (const auto& column : schema_) {
+            fields.push_back(::arrow::field(column.name(), GetArrowType(column.data_type())));
+        }
+        arrow_schema_ = ::arrow::schema(fields);
+    }
+
+    Status Open(const std::string& path) override {
+        if (options_.GetMode() == "append") {
+            return {::openmldb::base::kSQLCmdRunError, "mode append is not supported by format parquet"};
+        }
+        auto st = CheckMode(path, options_.GetMode());
+        if (!st.OK()) {
+            return st;
+        }
+        auto out = ::arrow::io::FileOutputStream::Open(path);
+        if (!out.ok()) {
+            return {::openmldb::base::kSQLCmdRunError, "Failed to open file, " + out.status().ToString()};
+        }
+        auto arrow_status = ::parquet::arrow::FileWriter::Open(*arrow_schema_, ::arrow::default_memory_pool(),
+                                                               *out, ::parquet::default_writer_properties(),
+                                                               &writer_);
+        if (!arrow_status.ok()) {
+            return {::openmldb::base::kSQLCmdRunError, "Failed to open file, " + arrow_status.ToString()};
+        }
+        return {};
+    }
+    std::unique_ptr<RowBlock> NewBlock() override { return std::make_unique<ParquetBlock>(schema_, arrow_schema_); }
+    Status Write(RowBlock* block) override {
+        auto* parquet_block = dynamic_cast<ParquetBlock*>(block);
+        int64_t row_cnt = parquet_block->GetRowCnt();
+        if (row_cnt == 0) {
+            return {};
+        }
+        std::shared_ptr<::arrow::Table> table;
+        auto arrow_status = parquet_block->Finish(&table);
+        if (arrow_status.ok()) {
+            arrow_status = writer_->WriteTable(*table, row_cnt);
+        }
+        if (!arrow_status.ok()) {
+            return {::openmldb::base::kSQLCmdRunError, "Failed to write file, " + arrow_status.ToString()};
+        }
+        return {};
+    }
+    Status Close() override {
+        if (writer_) {
+            auto arrow_status = writer_->Close();
+            if (!arrow_status.ok()) {
+                return {::openmldb::base::kSQLCmdRunError, "Failed to close file, " + arrow_status.ToString()};
+            }
+        }
+        return {};
+    }
+
+ private:
+    const ::openmldb::codec::Schema& schema_;
+    const WriteFileOptionsParser& options_;
+    std::shared_ptr<::arrow::Schema> arrow_schema_;
+    std::unique_ptr<::parquet::arrow::FileWriter> writer_;
+};
+
+#endif
+
+std::unique_ptr<BlockFile> NewBlockFile(const ::openmldb::codec::Schema& schema,
+                                        const WriteFileOptionsParser& options) {
+#ifdef ARROW_ENABLE
+    if (options.GetFormat() == "parquet") {
+        return std::make_unique<ParquetFile>(schema, options);
+    }
+#endif
+    return std::make_unique<CsvFile>(schema, options);
+}
+
+}  // namespace
+
+TableExporter::TableExporter(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
+                             const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                             const WriteFileOptionsParser& options, const std::string& file_path,
+                             uint64_t block_bytes)
+    : table_info_(table_info),
+      tablets_(tablets),
+      options_(options),
+      file_path_(file_path),
+      block_bytes_(block_bytes > 0 ? block_bytes : 1) {}
+
+bool TableExporter::IsSupported(const std::string& format) {
+#ifdef ARROW_ENABLE
+    return format == "csv" || format == "parquet";
+#else
+    return format == "csv";
+#endif
+}
+
+hybridse::sdk::Status TableExporter::Export(std::atomic<uint64_t>* exported_rows) {
+    if (!IsSupported(options_.GetFormat())) {
+        return {::hybridse::common::StatusCode::kCmdError,
+                "format " + options_.GetFormat() + " needs the build with ARROW_ENABLE"};
+    }
+    const auto& schema = table_info_->column_desc();
+    uint32_t tid = table_info_->tid();
+    bool is_snappy = table_info_->compress_type() == ::openmldb::type::CompressType::kSnappy;
+    std::mutex mu;
+    std::unique_ptr<BlockFile> merged_file;
+    if (options_.GetSingleFile()) {
+        merged_file = NewBlockFile(schema, options_);
+        auto st = merged_file->Open(file_path_);
+        if (!st.OK()) {
+            return {::hybridse::common::StatusCode::kCmdError, st.msg};
+        }
+    } else {
+        if (options_.GetMode() == "error_if_exists" && ::openmldb::base::IsExists(file_path_)) {
+            return {::hybridse::common::StatusCode::kCmdError, "File already exists"};
+        }
+        if (!::openmldb::base::MkdirRecur(file_path_)) {
+            return {::hybridse::common::StatusCode::kCmdError, "Failed to create directory " + file_path_};
+        }
+    }
+    std::atomic<uint32_t> next_pid{0};
+    bool failed = false;
+    std::string error;
+    auto set_error = [&](const std::string& msg) {
+        std::lock_guard<std::mutex> lock(mu);
+        if (!failed) {
+            failed = true;
+            error = msg;
+        }
+    };
+    auto is_failed = [&]() {
+        std::lock_guard<std::mutex> lock(mu);
+        return failed;
+    };
+    auto export_partition = [&](uint32_t pid, BlockFile* file, RowBlock* block) -> Status {
+        auto client = tablets_[pid] ? tablets_[pid]->GetClient() : nullptr;
+        if (!client) {
+            return {::openmldb::base::kSQLCmdRunError, "fail to get the tablet of partition " + std::to_string(pid)};
+        }
+        auto write = [&]() -> Status {
+            uint64_t row_cnt = block->GetRowCnt();
+            Status st;
+            if (merged_file) {
+                std::lock_guard<std::mutex> lock(mu);
+                st = file->Write(block);
+            } else {
+                st = file->Write(block);
+            }
+            if (st.OK()) {
+                exported_rows->fetch_add(row_cnt, std::memory_order_relaxed);
+            }
+            return st;
+        };
+        ::openmldb::codec::RowView row_view(schema);
+        std::string last_pk;
+        uint64_t last_ts = 0;
+        // the tablet goes on from the iterator of the last page rather than seeking last_pk again
+        uint64_t cursor_id = 0;
+        std::string uncompressed;
+        while (!is_failed()) {
+            uint32_t count = 0;
+            std::unique_ptr<::openmldb::base::KvIterator> it(
+                client->Traverse(tid, pid, "", last_pk, last_ts, FLAGS_traverse_cnt_limit, true, &cursor_id, count));
+            if (!it) {
+                return {::openmldb::base::kSQLCmdRunError, "fail to traverse partition " + std::to_string(pid)};
+            }
+            for (; it->Valid(); it->Next()) {
+                auto value = it->GetValue();
+                const int8_t* data = reinterpret_cast<const int8_t*>(value.data());
+                uint32_t size = value.size();
+                if (is_snappy) {
+                    uncompressed.clear();
+                    ::snappy::Uncompress(value.data(), value.size(), &uncompressed);
+                    data = reinterpret_cast<const int8_t*>(uncompressed.data());
+                    size = uncompressed.size();
+                }
+                if (!row_view.Reset(data, size) || !block->Append(row_view)) {
+                    return {::openmldb::base::kSQLCmdRunError,
+                            "fail to decode a row of partition " + std::to_string(pid)};
+                }
+                if (block->GetByteSize() >= block_bytes_) {
+                    auto st = write();
+                    if (!st.OK()) {
+                        return st;
+                    }
+                }
+            }
+            if (it->IsFinish()) {
+                break;
+            }
+            last_pk = it->GetLastPK();
+            last_ts = it->GetLastTS();
+        }
+        return write();
+    };
+    auto run = [&]() {
+        std::unique_ptr<BlockFile> partition_file;
+        std::unique_ptr<RowBlock> block;
+        if (merged_file) {
+            block = merged_file->NewBlock();
+        }
+        while (!is_failed()) {
+            uint32_t pid = next_pid.fetch_add(1, std::memory_order_relaxed);
+            if (pid >= tablets_.size()) {
+                break;
+            }
+            BlockFile* file = merged_file.get();
+            if (!merged_file) {
+                partition_file = NewBlockFile(schema, options_);
+                auto st = partition_file->Open(file_path_ + "/part-" + std::to_string(pid) + "." +
+                                               options_.GetFormat());
+                if (!st.OK()) {
+                    set_error(st.msg);
+                    break;
+                }
+                file = partition_file.get();
+                block = partition_file->NewBlock();
+            }
+            auto st = export_partition(pid, file, block.get());
+            if (partition_file) {
+                auto close_st = partition_file->Close();
+                if (st.OK()) {
+                    st = close_st;
+                }
+                partition_file.reset();
+            }
+            if (!st.OK()) {
+                set_error(st.msg);
+                break;
+            }
+        }
+    };
+    uint32_t thread_num = std::min<uint32_t>(options_.GetThread(), tablets_.size());
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < thread_num; i++) {
+        threads.emplace_back(run);
+    }
+    run();
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (merged_file) {
+        auto st = merged_file->Close();
+        if (!st.OK() && !failed) {
+            failed = true;
+            error = st.msg;
+        }
+    }
+    if (failed) {
+        return {::hybridse::common::StatusCode::kCmdError, error};
+    }
+    return {};
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_TABLE_EXPORTER_H_
+#define SRC_SDK_TABLE_EXPORTER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catalog/client_manager.h"
+#include "proto/name_server.pb.h"
+#include "sdk/base.h"
+#include "sdk/file_option_parser.h"
+
+namespace openmldb {
+namespace sdk {
+
+// TableExporter exports all the rows of an online table into csv or parquet files. The partitions are traversed
+// in parallel by `thread` threads, page by page from the leaders, and the rows of a page are converted into a
+// block which is written out once it grows to block_bytes. So the memory is bounded by the threads rather than by
+// the table. With single_file the blocks of all the threads are appended into the one file, otherwise the rows of
+// a partition go into part-<pid>.<format> under the output directory.
+// parquet is built with ARROW_ENABLE.
+class TableExporter {
+ public:
+    TableExporter(std::shared_ptr<::openmldb::nameserver::TableInfo> table_info,
+                  const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                  const WriteFileOptionsParser& options, const std::string& file_path,
+                  uint64_t block_bytes = 4 * 1024 * 1024);
+
+    static bool IsSupported(const std::string& format);
+
+    // exported_rows counts the rows written, so it can be read for the progress on the way
+    hybridse::sdk::Status Export(std::atomic<uint64_t>* exported_rows);
+
+ private:
+    std::shared_ptr<::openmldb::nameserver::TableInfo> table_info_;
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets_;
+    const WriteFileOptionsParser& options_;
+    std::string file_path_;
+    uint64_t block_bytes_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+
+#endif  // SRC_SDK_TABLE_EXPORTER_H_
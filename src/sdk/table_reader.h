@@ -55,6 +55,21 @@ class TableReader {
                                                                  const std::string& key, int64_t st, int64_t et,
                                                                  const ScanOption& so, int64_t timeout_ms,
                                                                  hybridse::sdk::Status* status) = 0;
+
+    // get the latest row of every key, the keys of one tablet are sent in one request and the
+    // tablets are requested concurrently. the values are in the order of the keys and a key not
+    // found gets an empty value
+    virtual bool BatchGet(const std::string& db, const std::string& table, const std::vector<std::string>& keys,
+                          const std::string& idx_name, int64_t timeout_ms, std::vector<std::string>* values,
+                          hybridse::sdk::Status* status) = 0;
+
+    // keep the rows got by BatchGet of the table in the client, for a table written rarely. the rows of a
+    // partition are dropped once its offset is found moved, which is checked every ttl_ms, so a value got is at
+    // most ttl_ms stale. at most max_keys keys are kept, the least recently used are evicted
+    virtual bool EnableNearCache(const std::string& db, const std::string& table, uint64_t max_keys, uint64_t ttl_ms,
+                                 hybridse::sdk::Status* status) = 0;
+
+    virtual void DisableNearCache(const std::string& db, const std::string& table) = 0;
 };
 
 }  // namespace sdk
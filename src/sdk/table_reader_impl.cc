@@ -16,12 +16,15 @@
 
 #include "sdk/table_reader_impl.h"
 
+#include <map>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
-#include "base/hash.h"
 #include "brpc/channel.h"
 #include "client/tablet_client.h"
+#include "common/timer.h"
 #include "proto/tablet.pb.h"
 #include "sdk/result_set_sql.h"
 
@@ -85,7 +88,88 @@ class ScanFutureImpl : public ScanFuture {
     std::shared_ptr<::hybridse::vm::TableHandler> table_handler_;
 };
 
-TableReaderImpl::TableReaderImpl(DBSDK* cluster_sdk) : cluster_sdk_(cluster_sdk) {}
+TableReaderImpl::TableReaderImpl(DBSDK* cluster_sdk, std::shared_ptr<NearCache> near_cache)
+    : cluster_sdk_(cluster_sdk),
+      selector_(),
+      max_lag_(0),
+      near_cache_(near_cache ? near_cache : std::make_shared<NearCache>()) {}
+
+TableReaderImpl::TableReaderImpl(DBSDK* cluster_sdk, std::shared_ptr<ReplicaSelector> selector, uint64_t max_lag,
+                                 std::shared_ptr<NearCache> near_cache)
+    : cluster_sdk_(cluster_sdk),
+      selector_(selector),
+      max_lag_(max_lag),
+      near_cache_(near_cache ? near_cache : std::make_shared<NearCache>()) {}
+
+std::shared_ptr<::openmldb::catalog::TabletAccessor> TableReaderImpl::GetTablet(
+    ::openmldb::catalog::SDKTableHandler* handler, uint32_t pid, ::openmldb::api::FollowerRead* follower_read) {
+    if (selector_) {
+        return selector_->Select(handler, pid, max_lag_, follower_read);
+    }
+    return handler->GetTablet(pid);
+}
+
+void TableReaderImpl::CheckNearCache(::openmldb::catalog::SDKTableHandler* handler, NearTableCache* cache) {
+    uint64_t now_ms = ::baidu::common::timer::get_micros() / 1000;
+    // the tablet name -> the leader and the partitions it leads to check
+    std::map<std::string, std::pair<std::shared_ptr<::openmldb::catalog::TabletAccessor>, std::vector<uint32_t>>>
+        checks;
+    for (uint32_t pid = 0; pid < cache->GetPartitionNum(); pid++) {
+        if (!cache->NeedCheck(pid, now_ms)) {
+            continue;
+        }
+        auto leader = handler->GetTablet(pid);
+        if (!leader) {
+            cache->UpdateOffset(pid, false, 0, now_ms);
+            continue;
+        }
+        auto& check = checks[leader->GetName()];
+        check.first = leader;
+        check.second.push_back(pid);
+    }
+    for (auto& kv : checks) {
+        std::map<uint32_t, uint64_t> offsets;
+        ::openmldb::api::GetTableStatusResponse response;
+        auto client = kv.second.first->GetClient();
+        if (client && client->GetTableStatus(cache->GetTid(), response)) {
+            for (const auto& status : response.all_table_status()) {
+                if (status.tid() == cache->GetTid() && status.has_offset() &&
+                    status.state() == ::openmldb::api::TableState::kTableNormal) {
+                    offsets.emplace(status.pid(), status.offset());
+                }
+            }
+        } else {
+            LOG(WARNING) << "fail to get the offsets of table " << cache->GetTid() << " on " << kv.first;
+        }
+        for (auto pid : kv.second.second) {
+            auto iter = offsets.find(pid);
+            cache->UpdateOffset(pid, iter != offsets.end(), iter != offsets.end() ? iter->second : 0, now_ms);
+        }
+    }
+}
+
+bool TableReaderImpl::EnableNearCache(const std::string& db, const std::string& table, uint64_t max_keys,
+                                      uint64_t ttl_ms, ::hybridse::sdk::Status* status) {
+    if (status == nullptr) {
+        return false;
+    }
+    if (max_keys == 0 || ttl_ms == 0) {
+        status->code = hybridse::common::kCmdError;
+        status->msg = "max_keys and ttl_ms of the near cache should be greater than 0";
+        return false;
+    }
+    if (!cluster_sdk_->GetCatalog()->GetTable(db, table)) {
+        status->code = hybridse::common::kTableNotFound;
+        status->msg = "fail to get table " + table + " desc from catalog";
+        return false;
+    }
+    near_cache_->Enable(db, table, max_keys, ttl_ms);
+    return true;
+}
+
+void TableReaderImpl::DisableNearCache(const std::string& db, const std::string& table) {
+    near_cache_->Disable(db, table);
+}
 
 std::shared_ptr<openmldb::sdk::ScanFuture> TableReaderImpl::AsyncScan(const std::string& db, const std::string& table,
                                                                       const std::string& key, int64_t st, int64_t et,
@@ -98,12 +182,9 @@ std::shared_ptr<openmldb::sdk::ScanFuture> TableReaderImpl::AsyncScan(const std:
     }
 
     auto sdk_table_handler = dynamic_cast<::openmldb::catalog::SDKTableHandler*>(table_handler.get());
-    uint32_t pid_num = sdk_table_handler->GetPartitionNum();
-    uint32_t pid = 0;
-    if (pid_num > 0) {
-        pid = ::openmldb::base::hash64(key) % pid_num;
-    }
-    auto accessor = sdk_table_handler->GetTablet(pid);
+    uint32_t pid = sdk_table_handler->GetPid(key);
+    ::openmldb::api::FollowerRead follower_read;
+    auto accessor = GetTablet(sdk_table_handler, pid, &follower_read);
     if (!accessor) {
         LOG(WARNING) << "fail to get tablet for db " << db << " table " << table;
         return std::shared_ptr<openmldb::sdk::ScanFuture>();
@@ -140,6 +221,9 @@ std::shared_ptr<openmldb::sdk::ScanFuture> TableReaderImpl::AsyncScan(const std:
     if (so.at_least > 0) {
         request.set_atleast(so.at_least);
     }
+    if (follower_read.has_tid()) {
+        request.mutable_follower_read()->CopyFrom(follower_read);
+    }
     auto scan_future = std::make_shared<ScanFutureImpl>(callback, request.projection(), table_handler);
     client->AsyncScan(request, callback);
     return scan_future;
@@ -155,12 +239,9 @@ std::shared_ptr<hybridse::sdk::ResultSet> TableReaderImpl::Scan(const std::strin
     }
 
     auto sdk_table_handler = dynamic_cast<::openmldb::catalog::SDKTableHandler*>(table_handler.get());
-    uint32_t pid_num = sdk_table_handler->GetPartitionNum();
-    uint32_t pid = 0;
-    if (pid_num > 0) {
-        pid = ::openmldb::base::hash64(key) % pid_num;
-    }
-    auto accessor = sdk_table_handler->GetTablet(pid);
+    uint32_t pid = sdk_table_handler->GetPid(key);
+    ::openmldb::api::FollowerRead follower_read;
+    auto accessor = GetTablet(sdk_table_handler, pid, &follower_read);
     if (!accessor) {
         LOG(WARNING) << "fail to get tablet for db " << db << " table " << table;
         return std::shared_ptr<hybridse::sdk::ResultSet>();
@@ -191,9 +272,24 @@ std::shared_ptr<hybridse::sdk::ResultSet> TableReaderImpl::Scan(const std::strin
     if (so.at_least > 0) {
         request.set_atleast(so.at_least);
     }
+    if (follower_read.has_tid()) {
+        request.mutable_follower_read()->CopyFrom(follower_read);
+    }
     auto response = std::make_shared<::openmldb::api::ScanResponse>();
     auto cntl = std::make_shared<::brpc::Controller>();
     client->Scan(request, cntl.get(), response.get());
+    if (response->code() == ::openmldb::base::kFollowerLagBehind) {
+        // the follower falls behind since its offset is taken, go to the leader
+        accessor = sdk_table_handler->GetTablet(pid);
+        if (!accessor) {
+            LOG(WARNING) << "fail to get tablet for db " << db << " table " << table;
+            return std::shared_ptr<hybridse::sdk::ResultSet>();
+        }
+        request.clear_follower_read();
+        response = std::make_shared<::openmldb::api::ScanResponse>();
+        cntl = std::make_shared<::brpc::Controller>();
+        accessor->GetClient()->Scan(request, cntl.get(), response.get());
+    }
     if (response->code() != 0) {
         status->code = response->code();
         status->msg = response->msg();
@@ -203,5 +299,124 @@ std::shared_ptr<hybridse::sdk::ResultSet> TableReaderImpl::Scan(const std::strin
     return rs;
 }
 
+bool TableReaderImpl::BatchGet(const std::string& db, const std::string& table, const std::vector<std::string>& keys,
+                               const std::string& idx_name, int64_t timeout_ms, std::vector<std::string>* values,
+                               ::hybridse::sdk::Status* status) {
+    if (values == nullptr || status == nullptr) {
+        return false;
+    }
+    auto table_handler = cluster_sdk_->GetCatalog()->GetTable(db, table);
+    if (!table_handler) {
+        status->code = hybridse::common::kTableNotFound;
+        status->msg = "fail to get table " + table + " desc from catalog";
+        return false;
+    }
+    auto sdk_table_handler = dynamic_cast<::openmldb::catalog::SDKTableHandler*>(table_handler.get());
+    auto cache = near_cache_->GetTable(db, table, sdk_table_handler->GetTid(), sdk_table_handler->GetPartitionNum());
+    uint64_t now_ms = 0;
+    if (cache) {
+        CheckNearCache(sdk_table_handler, cache.get());
+        now_ms = ::baidu::common::timer::get_micros() / 1000;
+    }
+    values->clear();
+    values->resize(keys.size());
+    struct TabletBatch {
+        std::shared_ptr<::openmldb::client::TabletClient> client;
+        ::openmldb::api::BatchGetRequest request;
+        // the position in keys of each request
+        std::vector<size_t> positions;
+        // the versions of the near cache taken before the requests
+        std::vector<uint64_t> versions;
+        openmldb::RpcCallback<openmldb::api::BatchGetResponse>* callback = nullptr;
+    };
+    // the tablet name -> the keys of all its partitions
+    std::map<std::string, TabletBatch> batches;
+    for (size_t i = 0; i < keys.size(); i++) {
+        uint32_t pid = sdk_table_handler->GetPid(keys[i]);
+        uint64_t version = 0;
+        std::shared_ptr<::openmldb::catalog::TabletAccessor> accessor;
+        if (cache) {
+            if (cache->IsFresh(pid, now_ms)) {
+                auto value = cache->Get(pid, idx_name, keys[i]);
+                if (value) {
+                    values->at(i) = std::move(*value);
+                    continue;
+                }
+            }
+            // the rows kept are read from the leader, a follower may be behind the offset checked
+            version = cache->GetVersion(pid, idx_name, keys[i]);
+            accessor = sdk_table_handler->GetTablet(pid);
+        } else {
+            ::openmldb::api::FollowerRead follower_read;
+            accessor = GetTablet(sdk_table_handler, pid, &follower_read);
+        }
+        if (!accessor) {
+            status->code = hybridse::common::kRpcError;
+            status->msg = "fail to get tablet of pid " + std::to_string(pid) + " for table " + table;
+            return false;
+        }
+        auto& batch = batches[accessor->GetName()];
+        if (!batch.client) {
+            batch.client = accessor->GetClient();
+        }
+        auto request = batch.request.add_requests();
+        request->set_tid(sdk_table_handler->GetTid());
+        request->set_pid(pid);
+        request->set_key(keys[i]);
+        request->set_ts(0);
+        if (!idx_name.empty()) {
+            request->set_idx_name(idx_name);
+        }
+        batch.positions.push_back(i);
+        batch.versions.push_back(version);
+    }
+    for (auto& kv : batches) {
+        auto& batch = kv.second;
+        auto cntl = std::make_shared<brpc::Controller>();
+        cntl->set_timeout_ms(timeout_ms);
+        batch.callback = new openmldb::RpcCallback<openmldb::api::BatchGetResponse>(
+            std::make_shared<openmldb::api::BatchGetResponse>(), cntl);
+        // keep the callback alive after it is run
+        batch.callback->Ref();
+        batch.client->AsyncBatchGet(batch.request, batch.callback);
+    }
+    bool ok = true;
+    for (auto& kv : batches) {
+        auto& batch = kv.second;
+        brpc::Join(batch.callback->GetController()->call_id());
+        auto& response = batch.callback->GetResponse();
+        if (ok && batch.callback->GetController()->Failed()) {
+            status->code = hybridse::common::kRpcError;
+            status->msg = "request " + kv.first + " error, " + batch.callback->GetController()->ErrorText();
+            ok = false;
+        } else if (ok && (response->code() != ::openmldb::base::kOk ||
+                          response->responses_size() != static_cast<int>(batch.positions.size()))) {
+            status->code = hybridse::common::kRpcError;
+            status->msg = "request " + kv.first + " error, " + response->msg();
+            ok = false;
+        }
+        if (ok) {
+            for (int i = 0; i < response->responses_size(); i++) {
+                auto get_response = response->mutable_responses(i);
+                size_t pos = batch.positions[i];
+                if (get_response->code() == ::openmldb::base::kOk) {
+                    values->at(pos).swap(*get_response->mutable_value());
+                } else if (get_response->code() != ::openmldb::base::kKeyNotFound) {
+                    status->code = get_response->code();
+                    status->msg = "get " + keys[pos] + " failed, " + get_response->msg();
+                    ok = false;
+                    break;
+                }
+                if (cache) {
+                    cache->Put(batch.request.requests(i).pid(), idx_name, keys[pos], values->at(pos),
+                               batch.versions[i]);
+                }
+            }
+        }
+        batch.callback->UnRef();
+    }
+    return ok;
+}
+
 }  // namespace sdk
 }  // namespace openmldb
@@ -19,8 +19,11 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "sdk/db_sdk.h"
+#include "sdk/near_cache.h"
+#include "sdk/replica_selector.h"
 #include "sdk/table_reader.h"
 
 namespace openmldb {
@@ -29,7 +32,13 @@ namespace sdk {
 class TableReader;
 class TableReaderImpl : public TableReader {
  public:
-    explicit TableReaderImpl(DBSDK* cluster_sdk);
+    // the near cache is shared by the readers of a router, a reader gets its own if it is null
+    explicit TableReaderImpl(DBSDK* cluster_sdk, std::shared_ptr<NearCache> near_cache = {});
+    // the reads are spread over the replicas caught up by the selector. the scans are checked again by the
+    // followers and retried on the leader if it falls behind, the async scans fail with kFollowerLagBehind and
+    // the batch gets trust the selector
+    TableReaderImpl(DBSDK* cluster_sdk, std::shared_ptr<ReplicaSelector> selector, uint64_t max_lag,
+                    std::shared_ptr<NearCache> near_cache = {});
     ~TableReaderImpl() {}
 
     std::shared_ptr<hybridse::sdk::ResultSet> Scan(const std::string& db, const std::string& table,
@@ -41,8 +50,27 @@ class TableReaderImpl : public TableReader {
                                                          const ScanOption& so, int64_t timeout_ms,
                                                          ::hybridse::sdk::Status* status);
 
+    bool BatchGet(const std::string& db, const std::string& table, const std::vector<std::string>& keys,
+                  const std::string& idx_name, int64_t timeout_ms, std::vector<std::string>* values,
+                  ::hybridse::sdk::Status* status);
+
+    bool EnableNearCache(const std::string& db, const std::string& table, uint64_t max_keys, uint64_t ttl_ms,
+                         ::hybridse::sdk::Status* status);
+
+    void DisableNearCache(const std::string& db, const std::string& table);
+
  private:
+    std::shared_ptr<::openmldb::catalog::TabletAccessor> GetTablet(::openmldb::catalog::SDKTableHandler* handler,
+                                                                   uint32_t pid,
+                                                                   ::openmldb::api::FollowerRead* follower_read);
+
+    // check the offsets of the partitions of the cached table not checked within the ttl on their leaders
+    void CheckNearCache(::openmldb::catalog::SDKTableHandler* handler, NearTableCache* cache);
+
     DBSDK* cluster_sdk_;
+    std::shared_ptr<ReplicaSelector> selector_;
+    uint64_t max_lag_;
+    std::shared_ptr<NearCache> near_cache_;
 };
 
 }  // namespace sdk
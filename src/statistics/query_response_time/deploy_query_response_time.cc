@@ -45,9 +45,11 @@ void DeployResponseTimeRowReducer::Reduce(const std::string &dp_name, TIME time,
 }
 
 absl::Status DeployQueryTimeCollector::Collect(const std::string& deploy_name, absl::Duration time) {
-    absl::ReaderMutexLock lock(&mutex_);
-    auto it = collectors_.find(deploy_name);
-    if (it == collectors_.end()) {
+    // the lock of the shard is only taken by the threads of the shard, except the rare updates
+    auto& shard = shards_[TimeCollector::GetThreadShard()];
+    absl::MutexLock lock(&shard.mutex);
+    auto it = shard.collectors.find(deploy_name);
+    if (it == shard.collectors.end()) {
         return absl::NotFoundError(absl::StrCat("deploy name ", deploy_name, " not found"));
     }
 
@@ -60,7 +62,12 @@ absl::Status DeployQueryTimeCollector::AddDeploy(const std::string& deploy_name)
     if (collectors_.find(deploy_name) != collectors_.end()) {
         return absl::AlreadyExistsError(absl::StrCat("deploy name ", deploy_name, " already exists"));
     }
-    collectors_.emplace(deploy_name, std::make_shared<TimeCollector>());
+    auto collector = std::make_shared<TimeCollector>();
+    collectors_.emplace(deploy_name, collector);
+    for (auto& shard : shards_) {
+        absl::MutexLock shard_lock(&shard.mutex);
+        shard.collectors.emplace(deploy_name, collector);
+    }
     return absl::OkStatus();
 }
 
@@ -72,6 +79,10 @@ absl::Status DeployQueryTimeCollector::DeleteDeploy(const std::string& deploy_na
     }
 
     collectors_.erase(it);
+    for (auto& shard : shards_) {
+        absl::MutexLock shard_lock(&shard.mutex);
+        shard.collectors.erase(deploy_name);
+    }
     return absl::OkStatus();
 }
 
@@ -74,6 +74,9 @@ class DeployResponseTimeRowReducer {
     std::map<std::string, std::map<TIME, std::shared_ptr<DeployResponseTimeRow>>> cache_;
 };
 
+// The time collectors of the deployments. Collect only looks up the replica of the collectors in the shard of the
+// thread, and the collectors shard their counters too, so the deployment calls collect without contention. The
+// replicas are updated with the collectors on the rare adds and deletes of deployments
 class DeployQueryTimeCollector {
  public:
     DeployQueryTimeCollector() {}
@@ -82,7 +85,7 @@ class DeployQueryTimeCollector {
 
     ~DeployQueryTimeCollector() {}
 
-    absl::Status Collect(const std::string& deploy_name, absl::Duration time) LOCKS_EXCLUDED(mutex_);
+    absl::Status Collect(const std::string& deploy_name, absl::Duration time);
 
     absl::Status AddDeploy(const std::string& deploy_name) LOCKS_EXCLUDED(mutex_);
 
@@ -99,8 +102,17 @@ class DeployQueryTimeCollector {
     uint32_t GetRecordsCnt() const SHARED_LOCKS_REQUIRED(mutex_);
 
  private:
-    std::unordered_map<std::string, std::shared_ptr<TimeCollector>> collectors_ GUARDED_BY(mutex_);
-    mutable absl::Mutex mutex_;  // protects collectors_
+    using CollectorMap = std::unordered_map<std::string, std::shared_ptr<TimeCollector>>;
+
+    struct alignas(64) Shard {
+        absl::Mutex mutex;
+        CollectorMap collectors GUARDED_BY(mutex);
+    };
+
+    CollectorMap collectors_ GUARDED_BY(mutex_);
+    mutable absl::Mutex mutex_;  // protects collectors_, and is held by the updates of the replicas
+    // the replicas of collectors_ for Collect
+    Shard shards_[TIME_COLLECTOR_SHARD_COUNT];
 };
 
 }  // namespace statistics
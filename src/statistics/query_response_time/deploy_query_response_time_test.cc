@@ -18,6 +18,7 @@
 
 #include <functional>
 #include <thread>
+#include <vector>
 
 #include "absl/random/bit_gen_ref.h"
 #include "absl/random/random.h"
@@ -227,6 +228,44 @@ TEST_F(DeployTimeCollectorTest, FailConditions) {
     ASSERT_TRUE(absl::IsNotFound(col.GetRows(dp1).status()));
 }
 
+TEST_F(DeployTimeCollectorTest, ReplicasFollowDeploys) {
+    DeployQueryTimeCollector col;
+    std::string dp1 = "dp1";
+    ASSERT_TRUE(col.AddDeploy(dp1).ok());
+
+    // the threads land on different shards, each of them collects through its own replica
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < TIME_COLLECTOR_SHARD_COUNT * 2; i++) {
+        threads.emplace_back([&col, &dp1]() { ASSERT_TRUE(col.Collect(dp1, absl::Seconds(1)).ok()); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto rs = col.GetRows(dp1);
+    ASSERT_TRUE(rs.ok());
+    uint64_t cnt = 0;
+    for (auto& row : rs.value()) {
+        cnt += row.count_;
+    }
+    ASSERT_EQ(2u * TIME_COLLECTOR_SHARD_COUNT, cnt);
+
+    // a deleted deploy is gone from all the replicas, and a re-added one starts over
+    ASSERT_TRUE(col.DeleteDeploy(dp1).ok());
+    threads.clear();
+    for (auto i = 0; i < TIME_COLLECTOR_SHARD_COUNT * 2; i++) {
+        threads.emplace_back([&col, &dp1]() { ASSERT_TRUE(absl::IsNotFound(col.Collect(dp1, absl::Seconds(1)))); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_TRUE(col.AddDeploy(dp1).ok());
+    rs = col.GetRows(dp1);
+    ASSERT_TRUE(rs.ok());
+    for (auto& row : rs.value()) {
+        ASSERT_EQ(0u, row.count_);
+    }
+}
+
 TEST_F(DeployTimeCollectorTest, FlushTest) {
     DeployQueryTimeCollector col;
     std::string dp1 = "dp1";
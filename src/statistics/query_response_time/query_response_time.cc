@@ -32,23 +32,31 @@ TimeCollector::TimeCollector()
 
 // TimeCollector(std::initializer_list<std::initializer_list<ResponseTimeRow>> data) {}
 
+uint32_t TimeCollector::GetThreadShard() {
+    static std::atomic<uint32_t> next_shard{0};
+    thread_local uint32_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % TIME_COLLECTOR_SHARD_COUNT;
+    return shard;
+}
+
 void TimeCollector::Collect(absl::Duration time) {
-    for (size_t idx = 0; idx < helper_.BucketCount(); ++idx) {
-        if (time <= helper_.UpperBound(idx).value()) {
-            count_[idx].fetch_add(1, std::memory_order_relaxed);
-            total_[idx].fetch_add(absl::ToInt64Microseconds(time), std::memory_order_relaxed);
-            break;
-        }
-    }
+    size_t idx = GetBucketIdx(time);
+    // the shard is rarely shared by the threads, the adds do not contend
+    Shard& shard = shards_[GetThreadShard()];
+    shard.count_[idx].fetch_add(1, std::memory_order_relaxed);
+    shard.total_[idx].fetch_add(absl::ToInt64Microseconds(time), std::memory_order_relaxed);
 }
 
 std::vector<ResponseTimeRow> TimeCollector::Flush() {
     std::vector<ResponseTimeRow> rows;
     rows.reserve(BucketCount());
     for (size_t idx = 0; idx < helper_.BucketCount(); ++idx) {
-        auto cnt = count_[idx].exchange(0, std::memory_order_relaxed);
-        auto total = total_[idx].exchange(0, std::memory_order_relaxed);
-        rows.emplace_back(helper_.UpperBound(idx).value(), cnt, absl::Microseconds(total));
+        uint32_t cnt = 0;
+        uint64_t total = 0;
+        for (auto& shard : shards_) {
+            cnt += shard.count_[idx].exchange(0, std::memory_order_relaxed);
+            total += shard.total_[idx].exchange(0, std::memory_order_relaxed);
+        }
+        rows.emplace_back(helper_.UpperBoundUnsafe(idx), cnt, absl::Microseconds(total));
     }
     return rows;
 }
@@ -56,8 +64,7 @@ std::vector<ResponseTimeRow> TimeCollector::Flush() {
 size_t TimeCollector::GetBucketIdx(absl::Duration time) {
     size_t idx = 0;
     while (idx < helper_.BucketCount()) {
-        // do not check the status from UpperBound since we assume it is always ok
-        if (time <= helper_.UpperBound(idx).value()) {
+        if (time <= helper_.UpperBoundUnsafe(idx)) {
             return idx;
         }
         idx++;
@@ -71,9 +78,11 @@ absl::StatusOr<absl::Duration> TimeCollector::GetUpperBound(size_t idx) const {
 uint32_t TimeCollector::BucketCount() const { return helper_.BucketCount(); }
 
 void TimeCollector::Setup() {
-    for (size_t idx = 0; idx < helper_.BucketCount(); ++idx) {
-        count_[idx] = 0;
-        total_[idx] = 0;
+    for (auto& shard : shards_) {
+        for (size_t idx = 0; idx < helper_.BucketCount(); ++idx) {
+            shard.count_[idx] = 0;
+            shard.total_[idx] = 0;
+        }
     }
 }
 
@@ -85,9 +94,21 @@ absl::StatusOr<ResponseTimeRow> TimeCollector::GetRow(size_t idx) const {
     return ResponseTimeRow{bound.value(), GetCount(idx), GetTotalUnited(idx)};
 }
 
-uint32_t TimeCollector::GetCount(size_t idx) const { return count_[idx].load(std::memory_order_relaxed); }
+uint32_t TimeCollector::GetCount(size_t idx) const {
+    uint32_t cnt = 0;
+    for (auto& shard : shards_) {
+        cnt += shard.count_[idx].load(std::memory_order_relaxed);
+    }
+    return cnt;
+}
 
-uint64_t TimeCollector::GetTotal(size_t idx) const { return total_[idx].load(std::memory_order_relaxed); }
+uint64_t TimeCollector::GetTotal(size_t idx) const {
+    uint64_t total = 0;
+    for (auto& shard : shards_) {
+        total += shard.total_[idx].load(std::memory_order_relaxed);
+    }
+    return total;
+}
 
 absl::StatusOr<absl::Duration> TimeDistributionHelper::UpperBound(size_t idx) const {
     if (IndexOutOfBound(idx)) {
@@ -59,6 +59,10 @@ namespace statistics {
 
 #define MAX_STRING "inf"
 
+// the counters of a collector are sharded by thread and merged on read, so the threads collecting do not contend
+// on the same cache lines
+#define TIME_COLLECTOR_SHARD_COUNT 16
+
 enum class TimeUnit {
     SECOND,
     MILLI_SECOND,
@@ -151,6 +155,9 @@ class TimeDistributionHelper {
     /// \brief return number of time intervals in the whole distribution
     uint32_t BucketCount() const { return bucket_count_; }
 
+    /// \brief unchecked UpperBound, idx must be less than BucketCount
+    absl::Duration UpperBoundUnsafe(size_t idx) const { return upper_bounds_[idx]; }
+
  private:
     void Setup();
 
@@ -163,7 +170,8 @@ class TimeDistributionHelper {
 };
 
 /// Thread safe wrapper for QUERY TIME DISTRIBUTION counters
-/// all methods provided meant atomic
+/// all methods provided meant atomic. Every thread collects into its own shard of the counters, which are summed
+/// up by the reads
 class TimeCollector {
  public:
     // construct from fresh data
@@ -190,6 +198,9 @@ class TimeCollector {
 
     absl::StatusOr<ResponseTimeRow> GetRow(size_t idx) const;
 
+    /// \brief the shard the calling thread collects into, the threads are spread over the shards round robin
+    static uint32_t GetThreadShard();
+
  private:
     // unsafe methods
 
@@ -202,9 +213,13 @@ class TimeCollector {
     void Setup();
 
  private:
+    struct alignas(64) Shard {
+        std::atomic<uint32_t> count_[TIME_DISTRIBUTION_BUCKET_COUNT];
+        std::atomic<uint64_t> total_[TIME_DISTRIBUTION_BUCKET_COUNT];
+    };
+
     TimeDistributionHelper helper_;
-    std::atomic<uint32_t> count_[TIME_DISTRIBUTION_BUCKET_COUNT];
-    std::atomic<uint64_t> total_[TIME_DISTRIBUTION_BUCKET_COUNT];
+    Shard shards_[TIME_COLLECTOR_SHARD_COUNT];
 };
 
 }  // namespace statistics
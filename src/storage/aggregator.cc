@@ -14,8 +14,14 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <functional>
 #include <utility>
+#include <vector>
 #include "boost/algorithm/string.hpp"
 
 #include "base/file_util.h"
@@ -66,11 +72,15 @@ Aggregator::Aggregator(const ::openmldb::api::TableMeta& base_meta, const ::open
       ts_col_(ts_col),
       aggr_col_idx_(-1),
       ts_col_idx_(-1),
+      filter_col_(),
+      filter_col_idx_(-1),
       window_type_(window_tpye),
       window_size_(window_size),
       base_row_view_(base_table_schema_),
       aggr_row_view_(aggr_table_schema_),
-      row_builder_(aggr_table_schema_) {
+      row_builder_(aggr_table_schema_),
+      pending_(kPendingQueueSize),
+      consume_scheduled_(false) {
     for (int i = 0; i < base_meta.column_desc().size(); i++) {
         if (base_meta.column_desc(i).name() == aggr_col_) {
             aggr_col_idx_ = i;
@@ -88,18 +98,66 @@ Aggregator::Aggregator(const ::openmldb::api::TableMeta& base_meta, const ::open
     if (ts_col_idx_ == -1) {
         PDLOG(ERROR, "ts_col not found in base table");
     }
-    auto dimension = dimensions_.Add();
-    dimension->set_idx(0);
 }
 
 Aggregator::~Aggregator() {}
 
+bool Aggregator::AsyncUpdate(const std::string& key, const std::string& row, uint64_t offset) {
+    PendingUpdate update{key, row, offset};
+    while (!pending_.TryPush(std::move(update))) {
+        // the consumer falls behind, so the producer helps to apply the pending updates
+        ApplyPendingUpdates();
+    }
+    if (consume_scheduled_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    return !consume_scheduled_.exchange(true, std::memory_order_acq_rel);
+}
+
+bool Aggregator::ApplyPendingUpdates() {
+    std::lock_guard<std::mutex> lock(consume_mu_);
+    std::vector<PendingUpdate> updates;
+    // the updates pushed meanwhile are left to the next round, so one round takes a queue of updates at most
+    while (updates.size() < kPendingQueueSize && pending_.PopBatch(&updates, kPopBatchSize) > 0) {
+    }
+    // the puts of different threads may be pushed out of the binlog order
+    std::stable_sort(updates.begin(), updates.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.offset < rhs.offset; });
+    bool ok = true;
+    for (const auto& update : updates) {
+        if (!Update(update.key, update.row, update.offset)) {
+            PDLOG(WARNING, "apply the pending aggr update failed. key %s offset %lu", update.key.c_str(),
+                  update.offset);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool Aggregator::ConsumeUpdates() {
+    bool ok = true;
+    while (true) {
+        ok = ApplyPendingUpdates() && ok;
+        consume_scheduled_.store(false, std::memory_order_release);
+        // the updates pushed after the queue was drained and before the flag was reset have no consumer
+        if (pending_.Empty() || consume_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+            return ok;
+        }
+    }
+}
+
 bool Aggregator::Update(const std::string& key, const std::string& row, const uint64_t& offset, bool recover) {
     if (!recover && GetStat() != AggrStat::kInited) {
         PDLOG(WARNING, "Aggregator status is not kInited");
         return false;
     }
     int8_t* row_ptr = reinterpret_cast<int8_t*>(const_cast<char*>(row.c_str()));
+    if (filter_col_idx_ != -1) {
+        bool cond = false;
+        if (base_row_view_.GetValue(row_ptr, filter_col_idx_, DataType::kBool, &cond) != 0 || !cond) {
+            return true;
+        }
+    }
     int64_t cur_ts;
     switch (ts_col_type_) {
         case DataType::kBigInt: {
@@ -116,18 +174,7 @@ bool Aggregator::Update(const std::string& key, const std::string& row, const ui
         }
     }
 
-    AggrBufferLocked* aggr_buffer_lock;
-    {
-        std::lock_guard<std::mutex> lock(mu_);
-        auto it = aggr_buffer_map_.find(key);
-        if (it == aggr_buffer_map_.end()) {
-            auto insert_pair = aggr_buffer_map_.emplace(key, AggrBufferLocked{});
-            aggr_buffer_lock = &insert_pair.first->second;
-        } else {
-            aggr_buffer_lock = &it->second;
-        }
-    }
-
+    AggrBufferLocked* aggr_buffer_lock = GetOrCreateBuffer(key);
     std::unique_lock<std::mutex> lock(*aggr_buffer_lock->mu_);
     AggrBuffer& aggr_buffer = aggr_buffer_lock->buffer_;
 
@@ -192,17 +239,17 @@ bool Aggregator::Update(const std::string& key, const std::string& row, const ui
 }
 
 bool Aggregator::FlushAll() {
+    ApplyPendingUpdates();
     // TODO(nauta): optimize the flush process
-    std::unique_lock<std::mutex> lock(mu_);
     std::unordered_map<std::string, AggrBuffer> flushed_buffer_map;
-    for (auto& it : aggr_buffer_map_) {
-        auto& aggr_buffer = it.second.buffer_;
+    for (const auto& kv : GetAllBuffers()) {
+        std::lock_guard<std::mutex> lock(*kv.second->mu_);
+        auto& aggr_buffer = kv.second->buffer_;
         if (aggr_buffer.aggr_cnt_ == 0) {
             continue;
         }
-        flushed_buffer_map.emplace(it.first, aggr_buffer);
+        flushed_buffer_map.emplace(kv.first, aggr_buffer);
     }
-    lock.unlock();
     for (auto& it : flushed_buffer_map) {
         if (!FlushAggrBuffer(it.first, it.second)) {
             return false;
@@ -234,8 +281,7 @@ bool Aggregator::Init(std::shared_ptr<LogReplicator> base_replicator) {
     uint64_t recovery_offset = UINT64_MAX;
     uint64_t aggr_latest_offset = 0;
     while (it->Valid()) {
-        auto buf_it = aggr_buffer_map_.emplace(it->GetPK(), AggrBufferLocked{});
-        auto& buffer = buf_it.first->second.buffer_;
+        auto& buffer = GetOrCreateBuffer(it->GetPK())->buffer_;
         auto val = it->GetValue();
         int8_t* aggr_row_ptr = reinterpret_cast<int8_t*>(const_cast<char*>(val.data()));
         bool ok = GetAggrBufferFromRowView(aggr_row_view_, aggr_row_ptr, &buffer);
@@ -259,6 +305,12 @@ bool Aggregator::Init(std::shared_ptr<LogReplicator> base_replicator) {
     if (aggr_table_->GetRecordCnt() == 0) {
         recovery_offset = 0;
     }
+    // the binlog offsets the buffers of the checkpoint have applied
+    std::unordered_map<std::string, uint64_t> checkpoint_offsets;
+    uint64_t checkpoint_offset = 0;
+    if (LoadCheckpoint(&checkpoint_offsets, &checkpoint_offset)) {
+        recovery_offset = checkpoint_offset;
+    }
 
     ::openmldb::log::LogReader log_reader(log_parts, base_replicator->GetLogPath(), false);
     log_reader.SetOffset(recovery_offset);
@@ -309,7 +361,10 @@ bool Aggregator::Init(std::shared_ptr<LogReplicator> base_replicator) {
         for (int i = 0; i < entry.dimensions_size(); i++) {
             const auto& dimension = entry.dimensions(i);
             if (dimension.idx() == index_pos_) {
-                Update(dimension.key(), entry.value(), entry.log_index(), true);
+                auto offset_it = checkpoint_offsets.find(dimension.key());
+                if (offset_it == checkpoint_offsets.end() || entry.log_index() > offset_it->second) {
+                    Update(dimension.key(), entry.value(), entry.log_index(), true);
+                }
                 break;
             }
         }
@@ -325,16 +380,152 @@ bool Aggregator::Init(std::shared_ptr<LogReplicator> base_replicator) {
     return true;
 }
 
+bool Aggregator::Checkpoint(uint64_t offset) {
+    if (checkpoint_path_.empty() || GetStat() != AggrStat::kInited) {
+        return false;
+    }
+    ApplyPendingUpdates();
+    auto buffers = GetAllBuffers();
+    ::openmldb::api::AggrCheckpoint checkpoint;
+    checkpoint.set_offset(offset);
+    // row_builder_ is used by the flushes
+    codec::RowBuilder row_builder(aggr_table_schema_);
+    for (const auto& kv : buffers) {
+        std::lock_guard<std::mutex> lock(*kv.second->mu_);
+        const auto& buffer = kv.second->buffer_;
+        if (buffer.ts_begin_ == -1) {
+            continue;
+        }
+        auto checkpoint_buffer = checkpoint.add_buffers();
+        if (!EncodeAggrRow(kv.first, buffer, &row_builder, checkpoint_buffer->mutable_row())) {
+            PDLOG(WARNING, "encode aggr buffer failed. key %s", kv.first.c_str());
+            return false;
+        }
+        checkpoint_buffer->set_non_null_cnt(buffer.non_null_cnt);
+    }
+    std::string tmp_file = checkpoint_path_ + ".tmp";
+    FILE* fd_write = fopen(tmp_file.c_str(), "w");
+    if (fd_write == NULL) {
+        PDLOG(WARNING, "fail to open file %s", tmp_file.c_str());
+        return false;
+    }
+    std::string buf;
+    checkpoint.SerializeToString(&buf);
+    bool io_error = fwrite(buf.data(), 1, buf.size(), fd_write) != buf.size() || fflush(fd_write) == EOF ||
+                    fsync(fileno(fd_write)) == -1;
+    fclose(fd_write);
+    if (io_error || rename(tmp_file.c_str(), checkpoint_path_.c_str()) != 0) {
+        PDLOG(WARNING, "fail to save aggr checkpoint. path[%s]", checkpoint_path_.c_str());
+        unlink(tmp_file.c_str());
+        return false;
+    }
+    PDLOG(INFO, "save aggr checkpoint of %d buffers at offset %lu. path[%s]", checkpoint.buffers_size(), offset,
+          checkpoint_path_.c_str());
+    return true;
+}
+
+bool Aggregator::LoadCheckpoint(std::unordered_map<std::string, uint64_t>* key_offsets, uint64_t* offset) {
+    if (checkpoint_path_.empty()) {
+        return false;
+    }
+    int fd = open(checkpoint_path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    ::openmldb::api::AggrCheckpoint checkpoint;
+    google::protobuf::io::FileInputStream file_input(fd);
+    file_input.SetCloseOnDelete(true);
+    if (!checkpoint.ParseFromZeroCopyStream(&file_input)) {
+        PDLOG(WARNING, "fail to parse aggr checkpoint. path[%s]", checkpoint_path_.c_str());
+        return false;
+    }
+    for (const auto& checkpoint_buffer : checkpoint.buffers()) {
+        const int8_t* row_ptr = reinterpret_cast<const int8_t*>(checkpoint_buffer.row().data());
+        char* ch = nullptr;
+        uint32_t ch_length = 0;
+        if (aggr_row_view_.GetValue(row_ptr, 0, &ch, &ch_length) != 0) {
+            PDLOG(WARNING, "fail to decode the key of aggr checkpoint. path[%s]", checkpoint_path_.c_str());
+            return false;
+        }
+        std::string key(ch, ch_length);
+        AggrBuffer loaded;
+        if (!GetAggrBufferFromRowView(aggr_row_view_, row_ptr, &loaded)) {
+            PDLOG(WARNING, "fail to decode aggr checkpoint. path[%s]", checkpoint_path_.c_str());
+            return false;
+        }
+        // binlog_offset_ is the next one to apply if the buffer is empty
+        uint64_t applied = loaded.aggr_cnt_ > 0 || loaded.binlog_offset_ == 0 ? loaded.binlog_offset_
+                                                                              : loaded.binlog_offset_ - 1;
+        auto& buffer = GetOrCreateBuffer(key)->buffer_;
+        if (buffer.ts_begin_ != -1 && buffer.binlog_offset_ > applied + 1) {
+            // the buffer has been flushed after the checkpoint
+            continue;
+        }
+        buffer.clear();
+        GetAggrBufferFromRowView(aggr_row_view_, row_ptr, &buffer);
+        buffer.non_null_cnt = checkpoint_buffer.non_null_cnt();
+        (*key_offsets)[key] = applied;
+    }
+    *offset = checkpoint.offset();
+    PDLOG(INFO, "load aggr checkpoint of %d buffers at offset %lu. path[%s]", checkpoint.buffers_size(),
+          checkpoint.offset(), checkpoint_path_.c_str());
+    return true;
+}
+
+bool Aggregator::SetFilterCol(const std::string& filter_col) {
+    for (int i = 0; i < base_table_schema_.size(); i++) {
+        if (base_table_schema_.Get(i).name() == filter_col) {
+            if (base_table_schema_.Get(i).data_type() != DataType::kBool) {
+                PDLOG(ERROR, "filter col %s is not bool", filter_col.c_str());
+                return false;
+            }
+            filter_col_ = filter_col;
+            filter_col_idx_ = i;
+            return true;
+        }
+    }
+    PDLOG(ERROR, "filter col %s not found in base table", filter_col.c_str());
+    return false;
+}
+
 bool Aggregator::GetAggrBuffer(const std::string& key, AggrBuffer** buffer) {
-    std::lock_guard<std::mutex> lock(mu_);
-    auto it = aggr_buffer_map_.find(key);
-    if (it == aggr_buffer_map_.end()) {
+    auto& shard = GetBufferShard(key);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) {
         return false;
     }
-    *buffer = &aggr_buffer_map_.at(key).buffer_;
+    *buffer = &it->second.buffer_;
     return true;
 }
 
+Aggregator::BufferShard& Aggregator::GetBufferShard(const std::string& key) {
+    size_t hash = std::hash<std::string>()(key);
+    // the low bits also pick the bucket of the map in the shard
+    return buffer_shards_[(hash ^ (hash >> 32)) % kBufferShardNum];
+}
+
+AggrBufferLocked* Aggregator::GetOrCreateBuffer(const std::string& key) {
+    auto& shard = GetBufferShard(key);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) {
+        it = shard.map.emplace(key, AggrBufferLocked{}).first;
+    }
+    return &it->second;
+}
+
+std::vector<std::pair<std::string, AggrBufferLocked*>> Aggregator::GetAllBuffers() {
+    std::vector<std::pair<std::string, AggrBufferLocked*>> buffers;
+    for (auto& shard : buffer_shards_) {
+        std::lock_guard<std::mutex> lock(shard.mu);
+        for (auto& kv : shard.map) {
+            buffers.emplace_back(kv.first, &kv.second);
+        }
+    }
+    return buffers;
+}
+
 bool Aggregator::GetAggrBufferFromRowView(const codec::RowView& row_view, const int8_t* row_ptr, AggrBuffer* buffer) {
     if (buffer == nullptr) {
         return false;
@@ -350,32 +541,44 @@ bool Aggregator::GetAggrBufferFromRowView(const codec::RowView& row_view, const
     return true;
 }
 
-bool Aggregator::FlushAggrBuffer(const std::string& key, const AggrBuffer& buffer) {
-    std::string encoded_row;
+bool Aggregator::EncodeAggrRow(const std::string& key, const AggrBuffer& buffer, codec::RowBuilder* row_builder,
+                               std::string* row) {
     std::string aggr_val;
     if (!EncodeAggrVal(buffer, &aggr_val)) {
         PDLOG(ERROR, "Enocde aggr value to row failed");
         return false;
     }
     int str_length = key.size() + aggr_val.size();
-    uint32_t row_size = row_builder_.CalTotalLength(str_length);
-    encoded_row.resize(row_size);
-    int8_t* row_ptr = reinterpret_cast<int8_t*>(&(encoded_row[0]));
-    row_builder_.InitBuffer(row_ptr, row_size, true);
-    row_builder_.SetString(row_ptr, row_size, 0, key.c_str(), key.size());
-    row_builder_.SetTimestamp(row_ptr, 1, buffer.ts_begin_);
-    row_builder_.SetTimestamp(row_ptr, 2, buffer.ts_end_);
+    uint32_t row_size = row_builder->CalTotalLength(str_length);
+    row->resize(row_size);
+    int8_t* row_ptr = reinterpret_cast<int8_t*>(&((*row)[0]));
+    row_builder->InitBuffer(row_ptr, row_size, true);
+    row_builder->SetString(row_ptr, row_size, 0, key.c_str(), key.size());
+    row_builder->SetTimestamp(row_ptr, 1, buffer.ts_begin_);
+    row_builder->SetTimestamp(row_ptr, 2, buffer.ts_end_);
     if ((aggr_type_ == AggrType::kMax || aggr_type_ == AggrType::kMin) && buffer.AggrValEmpty()) {
-        row_builder_.SetNULL(row_ptr, row_size, 4);
+        row_builder->SetNULL(row_ptr, row_size, 4);
     } else {
-        row_builder_.SetString(row_ptr, row_size, 4, aggr_val.c_str(), aggr_val.size());
+        row_builder->SetString(row_ptr, row_size, 4, aggr_val.c_str(), aggr_val.size());
+    }
+    row_builder->SetInt32(row_ptr, 3, buffer.aggr_cnt_);
+    row_builder->SetInt64(row_ptr, 5, buffer.binlog_offset_);
+    return true;
+}
+
+bool Aggregator::FlushAggrBuffer(const std::string& key, const AggrBuffer& buffer) {
+    std::string encoded_row;
+    if (!EncodeAggrRow(key, buffer, &row_builder_, &encoded_row)) {
+        return false;
     }
-    row_builder_.SetInt32(row_ptr, 3, buffer.aggr_cnt_);
-    row_builder_.SetInt64(row_ptr, 5, buffer.binlog_offset_);
 
     int64_t time = ::baidu::common::timer::get_micros() / 1000;
-    dimensions_.Mutable(0)->set_key(key);
-    bool ok = aggr_table_->Put(time, encoded_row, dimensions_);
+    // the buffers of different keys are flushed concurrently
+    Dimensions dimensions;
+    auto dimension = dimensions.Add();
+    dimension->set_idx(0);
+    dimension->set_key(key);
+    bool ok = aggr_table_->Put(time, encoded_row, dimensions);
     if (!ok) {
         PDLOG(ERROR, "Aggregator put failed");
         return false;
@@ -385,7 +588,7 @@ bool Aggregator::FlushAggrBuffer(const std::string& key, const AggrBuffer& buffe
     entry.set_ts(time);
     entry.set_value(encoded_row);
     entry.set_term(aggr_replicator_->GetLeaderTerm());
-    entry.mutable_dimensions()->CopyFrom(dimensions_);
+    entry.mutable_dimensions()->CopyFrom(dimensions);
     aggr_replicator_->AppendEntry(entry);
     if (FLAGS_binlog_notify_on_put) {
         aggr_replicator_->Notify();
@@ -938,6 +1141,20 @@ std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& b
                                              const std::string& aggr_col, const std::string& aggr_func,
                                              const std::string& ts_col, const std::string& bucket_size) {
     std::string aggr_type = boost::to_lower_copy(aggr_func);
+    std::string base_aggr_col = aggr_col;
+    std::string filter_col;
+    // the *_where functions aggregate the rows of which the filter col is true, aggr_col is `col,filter_col`
+    if (boost::ends_with(aggr_type, "_where")) {
+        aggr_type = aggr_type.substr(0, aggr_type.size() - std::string("_where").size());
+        std::vector<std::string> cols;
+        boost::split(cols, aggr_col, boost::is_any_of(","));
+        if (cols.size() != 2) {
+            PDLOG(ERROR, "invalid aggr col %s of %s", aggr_col.c_str(), aggr_func.c_str());
+            return std::shared_ptr<Aggregator>();
+        }
+        base_aggr_col = boost::trim_copy(cols[0]);
+        filter_col = boost::trim_copy(cols[1]);
+    }
     WindowType window_type;
     uint32_t window_size;
     if (::openmldb::base::IsNumber(bucket_size)) {
@@ -976,26 +1193,31 @@ std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& b
         }
     }
 
+    std::shared_ptr<Aggregator> aggregator;
     if (aggr_type == "sum") {
-        return std::make_shared<SumAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
-                                               AggrType::kSum, ts_col, window_type, window_size);
+        aggregator = std::make_shared<SumAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos,
+                                                     base_aggr_col, AggrType::kSum, ts_col, window_type, window_size);
     } else if (aggr_type == "min") {
-        return std::make_shared<MinAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
-                                               AggrType::kMin, ts_col, window_type, window_size);
+        aggregator = std::make_shared<MinAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos,
+                                                     base_aggr_col, AggrType::kMin, ts_col, window_type, window_size);
     } else if (aggr_type == "max") {
-        return std::make_shared<MaxAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
-                                               AggrType::kMax, ts_col, window_type, window_size);
+        aggregator = std::make_shared<MaxAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos,
+                                                     base_aggr_col, AggrType::kMax, ts_col, window_type, window_size);
     } else if (aggr_type == "count") {
-        return std::make_shared<CountAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
-                                                 AggrType::kCount, ts_col, window_type, window_size);
+        aggregator = std::make_shared<CountAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos,
+                                                       base_aggr_col, AggrType::kCount, ts_col, window_type,
+                                                       window_size);
     } else if (aggr_type == "avg") {
-        return std::make_shared<AvgAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
-                                               AggrType::kAvg, ts_col, window_type, window_size);
+        aggregator = std::make_shared<AvgAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos,
+                                                     base_aggr_col, AggrType::kAvg, ts_col, window_type, window_size);
     } else {
         PDLOG(ERROR, "Unsupported aggregate function type");
         return std::shared_ptr<Aggregator>();
     }
-    return std::shared_ptr<Aggregator>();
+    if (!filter_col.empty() && !aggregator->SetFilterCol(filter_col)) {
+        return std::shared_ptr<Aggregator>();
+    }
+    return aggregator;
 }
 
 }  // namespace storage
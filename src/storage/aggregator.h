@@ -17,12 +17,15 @@
 #ifndef SRC_STORAGE_AGGREGATOR_H_
 #define SRC_STORAGE_AGGREGATOR_H_
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "base/mpmc_queue.h"
 #include "codec/codec.h"
 #include "proto/tablet.pb.h"
 #include "proto/type.pb.h"
@@ -125,10 +128,25 @@ class Aggregator {
 
     bool Update(const std::string& key, const std::string& row, const uint64_t& offset, bool recover = false);
 
+    // push the update to the lock-free pending queue instead of applying it, the pending updates are applied by
+    // the caller if the queue is full. Return true if no consumer is scheduled, then the caller should run
+    // ConsumeUpdates in the background
+    bool AsyncUpdate(const std::string& key, const std::string& row, uint64_t offset);
+
+    // apply the pending updates in the order of binlog offset until the list is empty
+    bool ConsumeUpdates();
+
     bool FlushAll();
 
     bool Init(std::shared_ptr<LogReplicator> base_replicator);
 
+    // the file the buffers are checkpointed to. Init loads the buffers from it, so only the binlog after the
+    // checkpoint is replayed
+    void SetCheckpointPath(const std::string& path) { checkpoint_path_ = path; }
+
+    // save the buffers, all the updates of the base table up to offset must have been pushed
+    bool Checkpoint(uint64_t offset);
+
     uint32_t GetIndexPos() const { return index_pos_; }
 
     AggrType GetAggrType() const { return aggr_type_; }
@@ -143,11 +161,24 @@ class Aggregator {
 
     bool GetAggrBuffer(const std::string& key, AggrBuffer** buffer);
 
+    // only aggregate the rows whose bool column `filter_col` is true, for the *_where functions
+    bool SetFilterCol(const std::string& filter_col);
+
+    const std::string& GetFilterCol() const { return filter_col_; }
+
  protected:
     codec::Schema base_table_schema_;
     codec::Schema aggr_table_schema_;
 
-    std::unordered_map<std::string, AggrBufferLocked> aggr_buffer_map_;
+    // the buffers are spread over the shards by the hash of key, so the updates of different keys rarely wait
+    // for the same lock. The buffers are never erased, so the pointers to them are kept out of the lock
+    struct BufferShard {
+        std::mutex mu;
+        std::unordered_map<std::string, AggrBufferLocked> map;
+    };
+    static constexpr uint32_t kBufferShardNum = 16;
+    BufferShard buffer_shards_[kBufferShardNum];
+    // serializes the init
     std::mutex mu_;
     DataType aggr_col_type_;
     DataType ts_col_type_;
@@ -155,10 +186,18 @@ class Aggregator {
     std::shared_ptr<Table> aggr_table_;
     std::shared_ptr<LogReplicator> aggr_replicator_;
     std::atomic<AggrStat> status_;
-    Dimensions dimensions_;
 
+    BufferShard& GetBufferShard(const std::string& key);
+    AggrBufferLocked* GetOrCreateBuffer(const std::string& key);
+    // the buffers and their keys at the moment
+    std::vector<std::pair<std::string, AggrBufferLocked*>> GetAllBuffers();
     bool GetAggrBufferFromRowView(const codec::RowView& row_view, const int8_t* row_ptr, AggrBuffer* buffer);
+    bool ApplyPendingUpdates();
     bool FlushAggrBuffer(const std::string& key, const AggrBuffer& aggr_buffer);
+    bool EncodeAggrRow(const std::string& key, const AggrBuffer& buffer, codec::RowBuilder* row_builder,
+                       std::string* row);
+    // load the buffers newer than the flushed ones, and the binlog offset of the base table to replay from
+    bool LoadCheckpoint(std::unordered_map<std::string, uint64_t>* key_offsets, uint64_t* offset);
     bool UpdateFlushedBuffer(const std::string& key, const int8_t* base_row_ptr, int64_t cur_ts, uint64_t offset);
     bool CheckBufferFilled(int64_t cur_ts, int64_t buffer_end, int32_t buffer_cnt);
 
@@ -171,10 +210,13 @@ class Aggregator {
     std::string aggr_col_;
     AggrType aggr_type_;
     std::string ts_col_;
+    std::string checkpoint_path_;
 
  protected:
     int aggr_col_idx_;
     int ts_col_idx_;
+    std::string filter_col_;
+    int filter_col_idx_;
     WindowType window_type_;
 
     // for kRowsNum, window_size_ is the rows num in mini window
@@ -184,6 +226,20 @@ class Aggregator {
     codec::RowView base_row_view_;
     codec::RowView aggr_row_view_;
     codec::RowBuilder row_builder_;
+
+ private:
+    struct PendingUpdate {
+        std::string key;
+        std::string row;
+        uint64_t offset = 0;
+    };
+    static constexpr uint32_t kPendingQueueSize = 4096;
+    static constexpr uint32_t kPopBatchSize = 256;
+    // the updates pushed by AsyncUpdate
+    ::openmldb::base::MPMCQueue<PendingUpdate> pending_;
+    std::atomic<bool> consume_scheduled_;
+    // only one consumer applies the pending updates at a time to keep the binlog offset order
+    std::mutex consume_mu_;
 };
 
 class SumAggregator : public Aggregator {
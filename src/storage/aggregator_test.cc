@@ -15,7 +15,9 @@
  */
 
 #include <map>
+#include <thread>  // NOLINT
 #include <utility>
+#include <vector>
 #include "gtest/gtest.h"
 
 #include "base/file_util.h"
@@ -51,6 +53,7 @@ void AddDefaultAggregatorBaseSchema(::openmldb::api::TableMeta* table_meta) {
     SchemaCodec::SetColumnDesc(table_meta->add_column_desc(), "col8", openmldb::type::DataType::kDate);
     SchemaCodec::SetColumnDesc(table_meta->add_column_desc(), "col9", openmldb::type::DataType::kString);
     SchemaCodec::SetColumnDesc(table_meta->add_column_desc(), "col_null", openmldb::type::DataType::kInt);
+    SchemaCodec::SetColumnDesc(table_meta->add_column_desc(), "col_bool", openmldb::type::DataType::kBool);
 
     SchemaCodec::SetIndex(table_meta->add_column_key(), "idx", "id1|id2", "ts_col", ::openmldb::type::kAbsoluteTime, 0,
                           0);
@@ -72,7 +75,8 @@ void AddDefaultAggregatorSchema(::openmldb::api::TableMeta* table_meta) {
                           0);
 }
 
-bool UpdateAggr(std::shared_ptr<Aggregator> aggr, codec::RowBuilder* row_builder) {
+bool UpdateAggr(std::shared_ptr<Aggregator> aggr, codec::RowBuilder* row_builder, bool async = false,
+                const std::string& key = "id1|id2") {
     std::string encoded_row;
     auto window_size = aggr->GetWindowSize();
     std::string str1("abc");
@@ -93,7 +97,15 @@ bool UpdateAggr(std::shared_ptr<Aggregator> aggr, codec::RowBuilder* row_builder
         row_builder->AppendDate(i);
         row_builder->AppendString(str.c_str(), str.size());
         row_builder->AppendNULL();
-        bool ok = aggr->Update("id1|id2", encoded_row, i);
+        row_builder->AppendBool(i % 2 == 0);
+        if (async) {
+            // only the first update schedules the consumer
+            if (aggr->AsyncUpdate(key, encoded_row, i) != (i == 0)) {
+                return false;
+            }
+            continue;
+        }
+        bool ok = aggr->Update(key, encoded_row, i);
         if (!ok) {
             return false;
         }
@@ -652,6 +664,50 @@ TEST_F(AggregatorTest, AvgAggregatorUpdate) {
     ASSERT_EQ(last_buffer->non_null_cnt, static_cast<int64_t>(0));
 }
 
+TEST_F(AggregatorTest, WhereAggregatorUpdate) {
+    std::shared_ptr<Aggregator> aggregator;
+    AggrBuffer* last_buffer;
+    std::shared_ptr<Table> aggr_table;
+    // only the even rows are aggregated as col_bool is true
+    ASSERT_TRUE(GetUpdatedResult(counter, "col3,col_bool", "count_where", "1s", aggregator, aggr_table, &last_buffer));
+    ASSERT_EQ(aggregator->GetAggrType(), AggrType::kCount);
+    ASSERT_EQ(aggregator->GetFilterCol(), "col_bool");
+    CheckCountAggrResult(aggr_table, DataType::kInt, 1);
+    ASSERT_EQ(last_buffer->non_null_cnt, 1);
+    counter += 2;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col5, col_bool", "sum_where", "1s", aggregator, aggr_table, &last_buffer));
+    ASSERT_EQ(aggr_table->GetRecordCnt(), 50);
+    auto it = aggr_table->NewTraverseIterator(0);
+    it->SeekToFirst();
+    for (int i = 50 - 1; i >= 0; --i) {
+        ASSERT_TRUE(it->Valid());
+        std::string origin_data = it->GetValue().ToString();
+        codec::RowView origin_row_view(aggr_table->GetTableMeta()->column_desc(),
+                                       reinterpret_cast<int8_t*>(const_cast<char*>(origin_data.c_str())),
+                                       origin_data.size());
+        char* ch = NULL;
+        uint32_t ch_length = 0;
+        origin_row_view.GetString(4, &ch, &ch_length);
+        ASSERT_EQ(*reinterpret_cast<int64_t*>(ch), static_cast<int64_t>(i * 2));
+        it->Next();
+    }
+    ASSERT_EQ(last_buffer->aggr_val_.vlong, 100);
+    counter += 2;
+
+    // the filter col must be an existing bool col
+    ::openmldb::api::TableMeta base_table_meta;
+    base_table_meta.set_tid(counter++);
+    AddDefaultAggregatorBaseSchema(&base_table_meta);
+    ::openmldb::api::TableMeta aggr_table_meta;
+    aggr_table_meta.set_tid(counter++);
+    AddDefaultAggregatorSchema(&aggr_table_meta);
+    for (const std::string aggr_col : {"col3", "col3,col4", "col3,col_not_exist"}) {
+        auto aggr = CreateAggregator(base_table_meta, aggr_table_meta, std::shared_ptr<Table>(),
+                                     std::shared_ptr<LogReplicator>(), 0, aggr_col, "count_where", "ts_col", "1s");
+        ASSERT_FALSE(aggr);
+    }
+}
+
 TEST_F(AggregatorTest, OutOfOrder) {
     std::map<std::string, std::string> map;
     std::string folder = "/tmp/" + GenRand() + "/";
@@ -694,6 +750,7 @@ TEST_F(AggregatorTest, OutOfOrder) {
     row_builder.AppendDate(100);
     row_builder.AppendString("abc", 3);
     row_builder.AppendNULL();
+    row_builder.AppendBool(true);
     bool ok = aggr->Update(key, encoded_row, 101);
     ASSERT_TRUE(ok);
     ASSERT_EQ(aggr_table->GetRecordCnt(), 51);
@@ -728,6 +785,138 @@ TEST_F(AggregatorTest, FlushAll) {
     ASSERT_EQ(last_buffer->aggr_cnt_, 1);
 }
 
+TEST_F(AggregatorTest, AsyncUpdate) {
+    std::map<std::string, std::string> map;
+    std::string folder = "/tmp/" + GenRand() + "/";
+    uint32_t id = counter++;
+    ::openmldb::api::TableMeta base_table_meta;
+    base_table_meta.set_tid(id);
+    AddDefaultAggregatorBaseSchema(&base_table_meta);
+    id = counter++;
+    ::openmldb::api::TableMeta aggr_table_meta;
+    aggr_table_meta.set_tid(id);
+    AddDefaultAggregatorSchema(&aggr_table_meta);
+    std::shared_ptr<Table> aggr_table = std::make_shared<MemTable>(aggr_table_meta);
+    aggr_table->Init();
+    std::shared_ptr<LogReplicator> replicator = std::make_shared<LogReplicator>(
+        aggr_table->GetId(), aggr_table->GetPid(), folder, map, ::openmldb::replica::kLeaderNode);
+    replicator->Init();
+    auto aggr =
+        CreateAggregator(base_table_meta, aggr_table_meta, aggr_table, replicator, 0, "col3", "sum", "ts_col", "1s");
+    std::shared_ptr<LogReplicator> base_replicator = std::make_shared<LogReplicator>(
+        base_table_meta.tid(), base_table_meta.pid(), folder, map, ::openmldb::replica::kLeaderNode);
+    base_replicator->Init();
+    aggr->Init(base_replicator);
+    codec::RowBuilder row_builder(base_table_meta.column_desc());
+    ASSERT_TRUE(UpdateAggr(aggr, &row_builder, true));
+    // nothing is applied before consuming
+    ASSERT_EQ(aggr_table->GetRecordCnt(), 0);
+    ASSERT_TRUE(aggr->ConsumeUpdates());
+    CheckSumAggrResult<int64_t>(aggr_table, DataType::kInt);
+    AggrBuffer* last_buffer;
+    ASSERT_TRUE(aggr->GetAggrBuffer("id1|id2", &last_buffer));
+    ASSERT_EQ(last_buffer->aggr_val_.vlong, 100);
+    ASSERT_EQ(last_buffer->binlog_offset_, 100);
+
+    // the consumer is scheduled again for the new updates
+    ASSERT_TRUE(UpdateAggr(aggr, &row_builder, true));
+    ::openmldb::base::RemoveDir(folder);
+}
+
+TEST_F(AggregatorTest, ConcurrentKeys) {
+    std::map<std::string, std::string> map;
+    std::string folder = "/tmp/" + GenRand() + "/";
+    uint32_t id = counter++;
+    ::openmldb::api::TableMeta base_table_meta;
+    base_table_meta.set_tid(id);
+    AddDefaultAggregatorBaseSchema(&base_table_meta);
+    id = counter++;
+    ::openmldb::api::TableMeta aggr_table_meta;
+    aggr_table_meta.set_tid(id);
+    AddDefaultAggregatorSchema(&aggr_table_meta);
+    std::shared_ptr<Table> aggr_table = std::make_shared<MemTable>(aggr_table_meta);
+    aggr_table->Init();
+    std::shared_ptr<LogReplicator> replicator = std::make_shared<LogReplicator>(
+        aggr_table->GetId(), aggr_table->GetPid(), folder, map, ::openmldb::replica::kLeaderNode);
+    replicator->Init();
+    auto aggr =
+        CreateAggregator(base_table_meta, aggr_table_meta, aggr_table, replicator, 0, "col3", "sum", "ts_col", "1s");
+    std::shared_ptr<LogReplicator> base_replicator = std::make_shared<LogReplicator>(
+        base_table_meta.tid(), base_table_meta.pid(), folder, map, ::openmldb::replica::kLeaderNode);
+    base_replicator->Init();
+    aggr->Init(base_replicator);
+    // the keys are spread over the shards of the buffers and flushed concurrently
+    int key_num = 8;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < key_num; i++) {
+        threads.emplace_back([&aggr, &base_table_meta, i]() {
+            codec::RowBuilder row_builder(base_table_meta.column_desc());
+            ASSERT_TRUE(UpdateAggr(aggr, &row_builder, false, "key" + std::to_string(i)));
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(aggr_table->GetRecordCnt(), 50u * key_num);
+    for (int i = 0; i < key_num; i++) {
+        AggrBuffer* buffer;
+        ASSERT_TRUE(aggr->GetAggrBuffer("key" + std::to_string(i), &buffer));
+        ASSERT_EQ(buffer->aggr_cnt_, 1);
+        ASSERT_EQ(buffer->aggr_val_.vlong, 100);
+    }
+    ::openmldb::base::RemoveDir(folder);
+}
+
+TEST_F(AggregatorTest, Checkpoint) {
+    std::map<std::string, std::string> map;
+    std::string folder = "/tmp/" + GenRand() + "/";
+    ASSERT_TRUE(::openmldb::base::MkdirRecur(folder));
+    uint32_t id = counter++;
+    ::openmldb::api::TableMeta base_table_meta;
+    base_table_meta.set_tid(id);
+    AddDefaultAggregatorBaseSchema(&base_table_meta);
+    id = counter++;
+    ::openmldb::api::TableMeta aggr_table_meta;
+    aggr_table_meta.set_tid(id);
+    AddDefaultAggregatorSchema(&aggr_table_meta);
+    std::shared_ptr<Table> aggr_table = std::make_shared<MemTable>(aggr_table_meta);
+    aggr_table->Init();
+    std::shared_ptr<LogReplicator> replicator = std::make_shared<LogReplicator>(
+        aggr_table->GetId(), aggr_table->GetPid(), folder, map, ::openmldb::replica::kLeaderNode);
+    replicator->Init();
+    std::shared_ptr<LogReplicator> base_replicator = std::make_shared<LogReplicator>(
+        base_table_meta.tid(), base_table_meta.pid(), folder, map, ::openmldb::replica::kLeaderNode);
+    base_replicator->Init();
+    std::string checkpoint_path = folder + "aggr_checkpoint";
+    auto aggr =
+        CreateAggregator(base_table_meta, aggr_table_meta, aggr_table, replicator, 0, "col3", "sum", "ts_col", "1s");
+    aggr->SetCheckpointPath(checkpoint_path);
+    aggr->Init(base_replicator);
+    codec::RowBuilder row_builder(base_table_meta.column_desc());
+    ASSERT_TRUE(UpdateAggr(aggr, &row_builder));
+    ASSERT_TRUE(aggr->Checkpoint(100));
+    ASSERT_TRUE(::openmldb::base::IsExists(checkpoint_path));
+
+    // the buffer not flushed is lost without the checkpoint, as the binlog is not kept in this test
+    auto recovered =
+        CreateAggregator(base_table_meta, aggr_table_meta, aggr_table, replicator, 0, "col3", "sum", "ts_col", "1s");
+    recovered->Init(base_replicator);
+    AggrBuffer* buffer;
+    ASSERT_TRUE(recovered->GetAggrBuffer("id1|id2", &buffer));
+    ASSERT_EQ(buffer->aggr_cnt_, 0);
+
+    recovered =
+        CreateAggregator(base_table_meta, aggr_table_meta, aggr_table, replicator, 0, "col3", "sum", "ts_col", "1s");
+    recovered->SetCheckpointPath(checkpoint_path);
+    ASSERT_TRUE(recovered->Init(base_replicator));
+    ASSERT_TRUE(recovered->GetAggrBuffer("id1|id2", &buffer));
+    ASSERT_EQ(buffer->aggr_cnt_, 1);
+    ASSERT_EQ(buffer->aggr_val_.vlong, 100);
+    ASSERT_EQ(buffer->binlog_offset_, 100);
+    ASSERT_EQ(buffer->ts_begin_, 50000);
+    ::openmldb::base::RemoveDir(folder);
+}
+
 }  // namespace storage
 }  // namespace openmldb
 
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/data_block_pool.h"
+
+namespace openmldb {
+namespace storage {
+
+DataBlockPool::DataBlockPool()
+    : classes_(new SizeClass[kClassCnt]), slab_mu_(), slabs_(), slab_byte_size_(0), used_byte_size_(0), slab_cnt_(0) {}
+
+DataBlockPool::~DataBlockPool() {
+    std::lock_guard<std::mutex> lock(slab_mu_);
+    for (char* slab : slabs_) {
+        delete[] slab;
+    }
+    slabs_.clear();
+}
+
+char* DataBlockPool::NewSlab() {
+    char* slab = new char[kSlabSize];
+    {
+        std::lock_guard<std::mutex> lock(slab_mu_);
+        slabs_.push_back(slab);
+    }
+    slab_cnt_.fetch_add(1, std::memory_order_relaxed);
+    slab_byte_size_.fetch_add(kSlabSize, std::memory_order_relaxed);
+    return slab;
+}
+
+char* DataBlockPool::Alloc(uint32_t size) {
+    if (!IsPoolable(size)) {
+        return NULL;
+    }
+    uint32_t idx = GetClassIdx(size);
+    uint32_t chunk_size = GetChunkSize(idx);
+    SizeClass& sc = classes_[idx];
+    char* ptr = NULL;
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(sc.mu);
+        if (sc.free_list != nullptr) {
+            ptr = reinterpret_cast<char*>(sc.free_list);
+            sc.free_list = sc.free_list->next;
+        } else {
+            if (sc.cur == nullptr || sc.cur + chunk_size > sc.end) {
+                // the tail of the old slab which is less than one chunk is dropped
+                sc.cur = NewSlab();
+                sc.end = sc.cur + kSlabSize;
+            }
+            ptr = sc.cur;
+            sc.cur += chunk_size;
+        }
+    }
+    used_byte_size_.fetch_add(chunk_size, std::memory_order_relaxed);
+    return ptr;
+}
+
+void DataBlockPool::Free(char* ptr, uint32_t size) {
+    if (ptr == NULL || !IsPoolable(size)) {
+        return;
+    }
+    uint32_t idx = GetClassIdx(size);
+    SizeClass& sc = classes_[idx];
+    FreeNode* node = reinterpret_cast<FreeNode*>(ptr);
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(sc.mu);
+        node->next = sc.free_list;
+        sc.free_list = node;
+    }
+    used_byte_size_.fetch_sub(GetChunkSize(idx), std::memory_order_relaxed);
+}
+
+}  // namespace storage
+}  // namespace openmldb
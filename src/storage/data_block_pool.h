@@ -0,0 +1,96 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_DATA_BLOCK_POOL_H_
+#define SRC_STORAGE_DATA_BLOCK_POOL_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "base/spinlock.h"
+
+namespace openmldb {
+namespace storage {
+
+// A slab pool for the payload of DataBlock. Payloads are rounded up to
+// kAlignSize and served from per size class free lists, the slabs are only
+// returned to the system when the pool is destroyed. It is shared by all
+// segments of one table, so the chunks freed by gc are reused by later puts
+// instead of fragmenting the heap.
+class DataBlockPool {
+ public:
+    static constexpr uint32_t kAlignShift = 4;
+    static constexpr uint32_t kAlignSize = 1 << kAlignShift;
+    static constexpr uint32_t kMaxPooledSize = 4096;
+    static constexpr uint32_t kClassCnt = kMaxPooledSize >> kAlignShift;
+    static constexpr uint32_t kSlabSize = 64 * 1024;
+
+    DataBlockPool();
+    ~DataBlockPool();
+    DataBlockPool(const DataBlockPool&) = delete;
+    DataBlockPool& operator=(const DataBlockPool&) = delete;
+
+    // return NULL if size is zero or larger than kMaxPooledSize
+    char* Alloc(uint32_t size);
+
+    // size must be the same as the one passed to Alloc
+    void Free(char* ptr, uint32_t size);
+
+    // the bytes reserved from the system
+    uint64_t GetSlabByteSize() const { return slab_byte_size_.load(std::memory_order_relaxed); }
+    // the bytes of chunks in use
+    uint64_t GetUsedByteSize() const { return used_byte_size_.load(std::memory_order_relaxed); }
+    uint64_t GetSlabCnt() const { return slab_cnt_.load(std::memory_order_relaxed); }
+
+    static inline bool IsPoolable(uint32_t size) { return size > 0 && size <= kMaxPooledSize; }
+
+    // the bytes taken from the slab by Alloc(size)
+    static inline uint32_t GetAllocByteSize(uint32_t size) { return GetChunkSize(GetClassIdx(size)); }
+
+ private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    struct SizeClass {
+        ::openmldb::base::SpinMutex mu;
+        FreeNode* free_list = nullptr;
+        char* cur = nullptr;
+        char* end = nullptr;
+    };
+
+    static inline uint32_t GetClassIdx(uint32_t size) { return (size - 1) >> kAlignShift; }
+    static inline uint32_t GetChunkSize(uint32_t class_idx) { return (class_idx + 1) << kAlignShift; }
+
+    char* NewSlab();
+
+ private:
+    std::unique_ptr<SizeClass[]> classes_;
+    std::mutex slab_mu_;
+    std::vector<char*> slabs_;
+    std::atomic<uint64_t> slab_byte_size_;
+    std::atomic<uint64_t> used_byte_size_;
+    std::atomic<uint64_t> slab_cnt_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_DATA_BLOCK_POOL_H_
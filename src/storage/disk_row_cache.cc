@@ -0,0 +1,52 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/disk_row_cache.h"
+
+namespace openmldb {
+namespace storage {
+
+DiskRowCache::DiskRowCache(uint32_t capacity, uint32_t max_rows) : max_rows_(max_rows), cache_(capacity) {}
+
+std::string DiskRowCache::MakeKey(uint32_t cf, const rocksdb::Slice& prefix) {
+    std::string key;
+    key.reserve(sizeof(cf) + prefix.size());
+    key.append(reinterpret_cast<const char*>(&cf), sizeof(cf));
+    key.append(prefix.data(), prefix.size());
+    return key;
+}
+
+std::shared_ptr<const DiskRowCache::Entry> DiskRowCache::Get(uint32_t cf, const rocksdb::Slice& prefix) {
+    auto value = cache_.Get(MakeKey(cf, prefix));
+    if (!value) {
+        return {};
+    }
+    return *value;
+}
+
+uint64_t DiskRowCache::GetGeneration(uint32_t cf, const rocksdb::Slice& prefix) {
+    return cache_.GetVersion(MakeKey(cf, prefix));
+}
+
+void DiskRowCache::Insert(uint32_t cf, const rocksdb::Slice& prefix, std::shared_ptr<const Entry> entry,
+                          uint64_t generation) {
+    cache_.UpsertIfVersion(MakeKey(cf, prefix), entry, generation);
+}
+
+void DiskRowCache::Invalidate(uint32_t cf, const rocksdb::Slice& prefix) { cache_.Remove(MakeKey(cf, prefix)); }
+
+}  // namespace storage
+}  // namespace openmldb
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_DISK_ROW_CACHE_H_
+#define SRC_STORAGE_DISK_ROW_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/sharded_lru_cache.h"
+#include "rocksdb/slice.h"
+
+namespace openmldb {
+namespace storage {
+
+// DiskRowCache keeps the most recent rows of the recently read keys of a disk table, so the request mode
+// windows of the hot keys are served without a rocksdb iterator. A key is the column family and the prefix
+// of the combined keys, the pk and the ts column id. An entry is invalid once its key is put or deleted.
+class DiskRowCache {
+ public:
+    struct Entry {
+        // the ts and the encoded row, in the descending order of ts
+        std::vector<std::pair<uint64_t, std::string>> rows;
+        // all the rows of the key are cached, otherwise the older rows are read from disk
+        bool complete = false;
+    };
+
+    DiskRowCache(uint32_t capacity, uint32_t max_rows);
+
+    uint32_t GetMaxRows() const { return max_rows_; }
+
+    std::shared_ptr<const Entry> Get(uint32_t cf, const rocksdb::Slice& prefix);
+
+    // the generation must be taken before reading the rows of the entry, the entry is not inserted if the
+    // key may be invalidated since then
+    uint64_t GetGeneration(uint32_t cf, const rocksdb::Slice& prefix);
+
+    void Insert(uint32_t cf, const rocksdb::Slice& prefix, std::shared_ptr<const Entry> entry, uint64_t generation);
+
+    void Invalidate(uint32_t cf, const rocksdb::Slice& prefix);
+
+ private:
+    static std::string MakeKey(uint32_t cf, const rocksdb::Slice& prefix);
+
+    uint32_t max_rows_;
+    // the version of a shard is increased on every invalidation of the keys in it
+    ::openmldb::base::ShardedLRUCache<std::string, std::shared_ptr<const Entry>> cache_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_DISK_ROW_CACHE_H_
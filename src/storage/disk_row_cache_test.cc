@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/disk_row_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace storage {
+
+class DiskRowCacheTest : public ::testing::Test {};
+
+static std::shared_ptr<const DiskRowCache::Entry> MakeEntry(uint64_t ts) {
+    auto entry = std::make_shared<DiskRowCache::Entry>();
+    entry->rows.emplace_back(ts, "row" + std::to_string(ts));
+    entry->complete = true;
+    return entry;
+}
+
+TEST_F(DiskRowCacheTest, Invalidate) {
+    DiskRowCache cache(16, 4);
+    ASSERT_EQ(4u, cache.GetMaxRows());
+    ASSERT_FALSE(cache.Get(1, "key1"));
+    uint64_t generation = cache.GetGeneration(1, "key1");
+    cache.Insert(1, "key1", MakeEntry(10), generation);
+    auto entry = cache.Get(1, "key1");
+    ASSERT_TRUE(entry);
+    ASSERT_EQ(10u, entry->rows[0].first);
+    // the same prefix in another column family is another key
+    ASSERT_FALSE(cache.Get(2, "key1"));
+
+    cache.Invalidate(1, "key1");
+    ASSERT_FALSE(cache.Get(1, "key1"));
+    // the entry read before the invalidation is stale
+    cache.Insert(1, "key1", MakeEntry(10), generation);
+    ASSERT_FALSE(cache.Get(1, "key1"));
+    cache.Insert(1, "key1", MakeEntry(11), cache.GetGeneration(1, "key1"));
+    ASSERT_EQ(11u, cache.Get(1, "key1")->rows[0].first);
+}
+
+TEST_F(DiskRowCacheTest, Evict) {
+    DiskRowCache cache(16, 4);
+    for (uint64_t i = 0; i < 1000; i++) {
+        std::string key = "key" + std::to_string(i);
+        cache.Insert(1, key, MakeEntry(i), cache.GetGeneration(1, key));
+    }
+    int cnt = 0;
+    for (uint64_t i = 0; i < 1000; i++) {
+        if (cache.Get(1, "key" + std::to_string(i))) {
+            cnt++;
+        }
+    }
+    ASSERT_GT(cnt, 0);
+    ASSERT_LE(cnt, 16);
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
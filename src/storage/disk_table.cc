@@ -15,6 +15,10 @@
  */
 
 #include "storage/disk_table.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
 #include <utility>
 #include "base/file_util.h"
 #include "base/glog_wapper.h"  // NOLINT
@@ -29,13 +33,104 @@ DECLARE_uint32(block_cache_mb);
 DECLARE_uint32(write_buffer_mb);
 DECLARE_uint32(block_cache_shardbits);
 DECLARE_bool(verify_compression);
+DECLARE_string(disk_table_filter_type);
+DECLARE_uint32(disk_table_filter_bits_per_key);
+DECLARE_bool(disk_table_whole_key_filtering);
+DECLARE_uint32(disk_table_write_buffer_manager_mb);
+DECLARE_uint32(disk_table_compaction_rate_limit_mb);
+DECLARE_uint32(disk_table_row_cache_keys);
+DECLARE_uint32(disk_table_row_cache_rows);
+DECLARE_bool(disk_table_bytewise_key);
 
 namespace openmldb {
 namespace storage {
 
 static rocksdb::Options ssd_option_template;
 static rocksdb::Options hdd_option_template;
+static rocksdb::BlockBasedTableOptions table_option_template;
+// the memtables of all disk tables are limited by it and charged to the shared block cache
+static std::shared_ptr<rocksdb::WriteBufferManager> write_buffer_manager;
 static bool options_template_initialized = false;
+// the column family of the rows of the table with the single_row_store option
+static const char ROW_STORE_CF_NAME[] = "__row_store";
+// the references resolved by one MultiGet when the rows of a window are read from the row store
+static const uint32_t ROW_STORE_BATCH_SIZE = 64;
+// the bytes of the entries written in one batch when a checkpoint is rewritten
+static const size_t REWRITE_BATCH_BYTES = 4 << 20;
+
+// mark the db in dir as of KeyFormat::kBytewise
+static bool WriteKeyFormatFile(const std::string& dir) {
+    std::string file = dir + "/" + KEY_FORMAT_FILE;
+    FILE* fd = fopen(file.c_str(), "w");
+    if (fd == NULL) {
+        PDLOG(WARNING, "fail to create %s. err %s", file.c_str(), strerror(errno));
+        return false;
+    }
+    bool ok = fputs("bytewise\n", fd) >= 0;
+    ok = fclose(fd) == 0 && ok;
+    if (!ok) {
+        PDLOG(WARNING, "fail to write %s", file.c_str());
+    }
+    return ok;
+}
+
+// read the rows of pk from the position of it into entry, up to max_rows. The entries of the row store layout
+// hold the references of the rows, they are resolved by one MultiGet and the rows expired in the row store are
+// skipped
+static bool ReadRows(rocksdb::DB* db, rocksdb::Iterator* it, rocksdb::ColumnFamilyHandle* row_handle,
+                     const rocksdb::Snapshot* snapshot, KeyFormat key_format, const std::string& pk, bool has_ts_idx,
+                     uint32_t ts_idx, uint32_t max_rows, DiskRowCache::Entry* entry) {
+    std::vector<std::pair<uint64_t, std::string>> rows;
+    entry->complete = true;
+    for (; it->Valid(); it->Next()) {
+        std::string cur_pk;
+        uint64_t cur_ts = 0;
+        uint32_t cur_ts_idx = UINT32_MAX;
+        ParseKeyAndTs(key_format, has_ts_idx, it->key(), cur_pk, cur_ts, cur_ts_idx);
+        if (cur_pk != pk || (has_ts_idx && cur_ts_idx != ts_idx)) {
+            break;
+        }
+        if (rows.size() >= max_rows) {
+            entry->complete = false;
+            break;
+        }
+        rows.emplace_back(cur_ts, it->value().ToString());
+    }
+    if (!it->status().ok()) {
+        return false;
+    }
+    if (row_handle == nullptr) {
+        entry->rows = std::move(rows);
+        return true;
+    }
+    std::vector<rocksdb::Slice> refs;
+    refs.reserve(rows.size());
+    for (const auto& row : rows) {
+        refs.emplace_back(row.second);
+    }
+    rocksdb::ReadOptions ro;
+    ro.snapshot = snapshot;
+    std::vector<std::string> values;
+    std::vector<rocksdb::Status> status =
+        db->MultiGet(ro, std::vector<rocksdb::ColumnFamilyHandle*>(refs.size(), row_handle), refs, &values);
+    entry->rows.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (status[i].ok()) {
+            entry->rows.emplace_back(rows[i].first, std::move(values[i]));
+        } else if (!status[i].IsNotFound()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// read the row of the reference ref from the row store, return false if it is expired
+static bool GetRow(rocksdb::DB* db, rocksdb::ColumnFamilyHandle* row_handle, const rocksdb::Snapshot* snapshot,
+                   const rocksdb::Slice& ref, std::string* row) {
+    rocksdb::ReadOptions ro;
+    ro.snapshot = snapshot;
+    return db->Get(ro, row_handle, ref, row).ok();
+}
 
 DiskTable::DiskTable(const std::string& name, uint32_t id, uint32_t pid, const std::map<std::string, uint32_t>& mapping,
                      uint64_t ttl, ::openmldb::type::TTLType ttl_type, ::openmldb::common::StorageMode storage_mode,
@@ -44,7 +139,11 @@ DiskTable::DiskTable(const std::string& name, uint32_t id, uint32_t pid, const s
             ::openmldb::type::CompressType::kNoCompress),
       write_opts_(),
       offset_(0),
-      table_path_(table_path) {
+      key_format_(KeyFormat::kKeyTs),
+      table_path_(table_path),
+      sst_file_id_(0),
+      row_handle_(nullptr),
+      row_id_(0) {
     if (!options_template_initialized) {
         initOptionTemplate();
     }
@@ -58,7 +157,11 @@ DiskTable::DiskTable(const ::openmldb::api::TableMeta& table_meta, const std::st
             ::openmldb::type::CompressType::kNoCompress),
       write_opts_(),
       offset_(0),
-      table_path_(table_path) {
+      key_format_(KeyFormat::kKeyTs),
+      table_path_(table_path),
+      sst_file_id_(0),
+      row_handle_(nullptr),
+      row_id_(0) {
     if (!options_template_initialized) {
         initOptionTemplate();
     }
@@ -101,8 +204,7 @@ void DiskTable::initOptionTemplate() {
     // table_options.cache_index_and_filter_blocks = true;
     // table_options.pin_l0_filter_and_index_blocks_in_cache = true;
     table_options.block_cache = cache;
-    // table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10,
-    // false));
+    // the filter policy is set per column family, see InitColumnFamilyDescriptor
     table_options.whole_key_filtering = false;
     table_options.block_size = 256 << 10;
     table_options.use_delta_encoding = false;
@@ -142,6 +244,11 @@ void DiskTable::initOptionTemplate() {
     hdd_option_template.target_file_size_base = 256 << 20;
     hdd_option_template.max_bytes_for_level_base = 1024 << 20;
     hdd_option_template.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+    table_option_template = table_options;
+    if (FLAGS_disk_table_write_buffer_manager_mb > 0) {
+        write_buffer_manager = std::make_shared<rocksdb::WriteBufferManager>(
+            static_cast<size_t>(FLAGS_disk_table_write_buffer_manager_mb) << 20, cache);
+    }
 
     options_template_initialized = true;
 }
@@ -150,6 +257,13 @@ bool DiskTable::InitColumnFamilyDescriptor() {
     cf_ds_.clear();
     cf_ds_.push_back(
         rocksdb::ColumnFamilyDescriptor(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions()));
+    // the table with a block cache quota has its own cache shared by its column families, so it neither
+    // evicts nor is evicted by the blocks of the other tables
+    std::shared_ptr<rocksdb::Cache> block_cache;
+    if (table_meta_ && table_meta_->block_cache_mb() > 0) {
+        block_cache = rocksdb::NewLRUCache(static_cast<size_t>(table_meta_->block_cache_mb()) << 20,
+                                           FLAGS_block_cache_shardbits);
+    }
     auto inner_indexs = table_index_.GetAllInnerIndex();
     for (const auto& inner_index : *inner_indexs) {
         rocksdb::ColumnFamilyOptions cfo;
@@ -160,25 +274,104 @@ bool DiskTable::InitColumnFamilyDescriptor() {
             cfo = rocksdb::ColumnFamilyOptions(hdd_option_template);
             options_ = hdd_option_template;
         }
-        cfo.comparator = &cmp_;
+        if (key_format_ == KeyFormat::kBytewise) {
+            cfo.comparator = rocksdb::BytewiseComparator();
+        } else {
+            cfo.comparator = &cmp_;
+        }
         cfo.prefix_extractor.reset(new KeyTsPrefixTransform());
+        // the key prefixes, that is the pk of the rows, are added into the sst filter and the memtable bloom,
+        // so the point reads of the absent keys are answered without reading the data blocks
+        uint32_t bits_per_key = FLAGS_disk_table_filter_bits_per_key;
+        if (table_meta_ && table_meta_->has_filter_bits_per_key()) {
+            bits_per_key = table_meta_->filter_bits_per_key();
+        }
+        bool has_filter = bits_per_key > 0 && FLAGS_disk_table_filter_type != "none";
+        if (has_filter || block_cache) {
+            rocksdb::BlockBasedTableOptions table_options = table_option_template;
+            if (has_filter) {
+                if (FLAGS_disk_table_filter_type == "ribbon") {
+                    table_options.filter_policy.reset(rocksdb::NewRibbonFilterPolicy(bits_per_key));
+                } else {
+                    table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(bits_per_key, false));
+                }
+                table_options.whole_key_filtering = FLAGS_disk_table_whole_key_filtering;
+            }
+            if (block_cache) {
+                table_options.block_cache = block_cache;
+            }
+            cfo.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+        }
         const auto& indexs = inner_index->GetIndex();
         auto index_def = indexs.front();
-        if (index_def->GetTTLType() == ::openmldb::storage::TTLType::kAbsoluteTime ||
-            index_def->GetTTLType() == ::openmldb::storage::TTLType::kAbsOrLat) {
-            cfo.compaction_filter_factory = std::make_shared<AbsoluteTTLFilterFactory>(inner_index);
-        }
+        // the ttl of every type is applied in compaction
+        cfo.compaction_filter_factory = std::make_shared<TTLFilterFactory>(inner_index, key_format_);
         cf_ds_.push_back(rocksdb::ColumnFamilyDescriptor(index_def->GetName(), cfo));
         DEBUGLOG("add cf_name %s. tid %u pid %u", index_def->GetName().c_str(), id_, pid_);
     }
+    if (table_meta_ && table_meta_->single_row_store()) {
+        // the rows expire by the latest expire time of their entries, so the row store is only created if the ttl
+        // of every index bounds the lifetime of its entries. An existing one is opened anyway
+        std::vector<std::string> cf_names;
+        rocksdb::DB::ListColumnFamilies(options_, table_path_ + "/data", &cf_names);
+        bool use_row_store =
+            std::find(cf_names.begin(), cf_names.end(), ROW_STORE_CF_NAME) != cf_names.end();
+        if (!use_row_store) {
+            use_row_store = true;
+            for (const auto& index_def : table_index_.GetAllIndex()) {
+                uint64_t expire_time = 0;
+                if (!GetExpireTime(*index_def->GetTTL(), 0, &expire_time)) {
+                    use_row_store = false;
+                    PDLOG(WARNING, "the ttl of index %s is not bounded by time, the rows are kept per index. "
+                          "tid %u pid %u", index_def->GetName().c_str(), id_, pid_);
+                    break;
+                }
+            }
+        }
+        if (use_row_store) {
+            rocksdb::ColumnFamilyOptions cfo(options_);
+            // the rows are only read by the point lookups of their whole keys
+            rocksdb::BlockBasedTableOptions table_options = table_option_template;
+            table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+            table_options.whole_key_filtering = true;
+            if (block_cache) {
+                table_options.block_cache = block_cache;
+            }
+            cfo.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+            cfo.compaction_filter_factory = std::make_shared<RowStoreFilterFactory>();
+            cf_ds_.push_back(rocksdb::ColumnFamilyDescriptor(ROW_STORE_CF_NAME, cfo));
+        }
+    }
     return true;
 }
 
+bool DiskTable::GetExpireTime(const TTLSt& ttl, uint64_t ts, uint64_t* expire_time) {
+    *expire_time = UINT64_MAX;
+    switch (ttl.ttl_type) {
+        case TTLType::kAbsoluteTime:
+            if (ttl.abs_ttl > 0) {
+                *expire_time = ts + ttl.abs_ttl;
+            }
+            return true;
+        case TTLType::kLatestTime:
+            return ttl.lat_ttl == 0;
+        case TTLType::kAbsAndLat:
+            return ttl.abs_ttl == 0 || ttl.lat_ttl == 0;
+        case TTLType::kAbsOrLat:
+            if (ttl.abs_ttl > 0) {
+                *expire_time = ts + ttl.abs_ttl;
+                return true;
+            }
+            return ttl.lat_ttl == 0;
+        default:
+            return false;
+    }
+}
+
 bool DiskTable::Init() {
     if (!InitFromMeta()) {
         return false;
     }
-    InitColumnFamilyDescriptor();
     std::string path = table_path_ + "/data";
     if (!openmldb::base::IsExists(path)) {
         PDLOG(INFO, "Create new disk table with path %s", path);
@@ -188,25 +381,72 @@ bool DiskTable::Init() {
         PDLOG(WARNING, "fail to create path %s", path.c_str());
         return false;
     }
+    // the format of an existing db is kept, a new one takes the format of the flag
+    std::string key_format_file = path + "/" + KEY_FORMAT_FILE;
+    if (::openmldb::base::IsExists(key_format_file)) {
+        key_format_ = KeyFormat::kBytewise;
+    } else if (FLAGS_disk_table_bytewise_key && !::openmldb::base::IsExists(path + "/CURRENT")) {
+        if (!WriteKeyFormatFile(path)) {
+            return false;
+        }
+        key_format_ = KeyFormat::kBytewise;
+    }
+    InitColumnFamilyDescriptor();
     options_.create_if_missing = true;
     options_.error_if_exists = false;
     options_.create_missing_column_families = true;
+    options_.write_buffer_manager = write_buffer_manager;
+    // the flushes and compactions of the table are limited, so a bulk loaded table doesn't take all the disk
+    // bandwidth from the others. The limiter is auto tuned, it keeps low while the table writes little
+    uint32_t rate_limit_mb = FLAGS_disk_table_compaction_rate_limit_mb;
+    if (table_meta_ && table_meta_->has_compaction_rate_limit_mb()) {
+        rate_limit_mb = table_meta_->compaction_rate_limit_mb();
+    }
+    if (rate_limit_mb > 0) {
+        options_.rate_limiter.reset(rocksdb::NewGenericRateLimiter(static_cast<int64_t>(rate_limit_mb) << 20,
+                                                                   100 * 1000, 10,
+                                                                   rocksdb::RateLimiter::Mode::kWritesOnly, true));
+    }
     rocksdb::Status s = rocksdb::DB::Open(options_, path, cf_ds_, &cf_hs_, &db_);
     if (!s.ok()) {
         PDLOG(WARNING, "rocksdb open failed. tid %u pid %u error %s", id_, pid_, s.ToString().c_str());
         return false;
     }
-    PDLOG(INFO, "Open DB. tid %u pid %u ColumnFamilyHandle size %u with data path %s", id_, pid_, GetIdxCnt(),
-          path.c_str());
+    PDLOG(INFO, "Open DB. tid %u pid %u ColumnFamilyHandle size %u with data path %s, %s keys", id_, pid_,
+          GetIdxCnt(), path.c_str(), key_format_ == KeyFormat::kBytewise ? "bytewise" : "legacy");
+    if (cf_ds_.back().name == ROW_STORE_CF_NAME) {
+        row_handle_ = cf_hs_.back();
+        // the ids of a restarted table start after the ones before as long as it writes less than 4096 rows per
+        // microsecond
+        row_id_.store(::baidu::common::timer::get_micros() << 12, std::memory_order_relaxed);
+        PDLOG(INFO, "the rows are kept in the row store. tid %u pid %u", id_, pid_);
+    }
+    if (FLAGS_disk_table_row_cache_keys > 0 && FLAGS_disk_table_row_cache_rows > 0) {
+        row_cache_ = std::make_shared<DiskRowCache>(FLAGS_disk_table_row_cache_keys, FLAGS_disk_table_row_cache_rows);
+    }
     return true;
 }
 
 bool DiskTable::Put(const std::string& pk, uint64_t time, const char* data, uint32_t size) {
     rocksdb::Status s;
-    std::string combine_key = CombineKeyTs(pk, time);
+    std::string combine_key = CombineKeyTs(key_format_, pk, time);
     rocksdb::Slice spk = rocksdb::Slice(combine_key);
-    s = db_->Put(write_opts_, cf_hs_[1], spk, rocksdb::Slice(data, size));
+    if (row_handle_ != nullptr) {
+        uint64_t expire_time = UINT64_MAX;
+        auto index_def = table_index_.GetIndex(0);
+        if (index_def) {
+            GetExpireTime(*index_def->GetTTL(), time, &expire_time);
+        }
+        std::string row_ref = NewRowRef(expire_time);
+        rocksdb::WriteBatch batch;
+        batch.Put(row_handle_, rocksdb::Slice(row_ref), rocksdb::Slice(data, size));
+        batch.Put(cf_hs_[1], spk, rocksdb::Slice(row_ref));
+        s = db_->Write(write_opts_, &batch);
+    } else {
+        s = db_->Put(write_opts_, cf_hs_[1], spk, rocksdb::Slice(data, size));
+    }
     if (s.ok()) {
+        InvalidateRowCache(1, combine_key);
         offset_.fetch_add(1, std::memory_order_relaxed);
         return true;
     } else {
@@ -215,18 +455,17 @@ bool DiskTable::Put(const std::string& pk, uint64_t time, const char* data, uint
     }
 }
 
-bool DiskTable::Put(uint64_t time, const std::string& value, const Dimensions& dimensions) {
-    rocksdb::WriteBatch batch;
-    rocksdb::Status s;
+bool DiskTable::GetCombineKeys(uint64_t time, const std::string& value, const Dimensions& dimensions,
+                               std::vector<std::pair<uint32_t, std::string>>* cf_keys, uint64_t* expire_time) {
+    const int8_t* data = reinterpret_cast<const int8_t*>(value.data());
+    uint8_t version = codec::RowView::GetSchemaVersion(data);
+    auto decoder = GetVersionDecoder(version);
+    if (decoder == nullptr) {
+        PDLOG(WARNING, "invalid schema version %u, tid %u pid %u", version, id_, pid_);
+        return false;
+    }
     Dimensions::const_iterator it = dimensions.begin();
     for (; it != dimensions.end(); ++it) {
-        const int8_t* data = reinterpret_cast<const int8_t*>(value.data());
-        uint8_t version = codec::RowView::GetSchemaVersion(data);
-        auto decoder = GetVersionDecoder(version);
-        if (decoder == nullptr) {
-            PDLOG(WARNING, "invalid schema version %u, tid %u pid %u", version, id_, pid_);
-            return false;
-        }
         int32_t inner_pos = table_index_.GetInnerIndexPos(it->idx());
         auto inner_index = table_index_.GetInnerIndex(inner_pos);
 
@@ -237,7 +476,6 @@ bool DiskTable::Put(uint64_t time, const std::string& value, const Dimensions& d
                 return false;
             }
             auto ts_col = index_def->GetTsColumn();
-            std::string combine_key;
             if (ts_col) {
                 int64_t ts = 0;
                 if (ts_col->IsAutoGenTs()) {
@@ -247,17 +485,46 @@ bool DiskTable::Put(uint64_t time, const std::string& value, const Dimensions& d
                     return false;
                 }
                 if (inner_index->GetIndex().size() > 1) {
-                    combine_key = CombineKeyTs(it->key(), ts, ts_col->GetId());
+                    cf_keys->emplace_back(inner_pos + 1, CombineKeyTs(key_format_, it->key(), ts, ts_col->GetId()));
                 } else {
-                    combine_key = CombineKeyTs(it->key(), ts);
+                    cf_keys->emplace_back(inner_pos + 1, CombineKeyTs(key_format_, it->key(), ts));
+                }
+                if (expire_time != nullptr) {
+                    // the row outlives all of its entries, it is kept if the ttl doesn't bound the entry
+                    uint64_t entry_expire_time = UINT64_MAX;
+                    GetExpireTime(*index_def->GetTTL(), ts, &entry_expire_time);
+                    *expire_time = std::max(*expire_time, entry_expire_time);
                 }
-                rocksdb::Slice spk = rocksdb::Slice(combine_key);
-                batch.Put(cf_hs_[inner_pos + 1], spk, value);
             }
         }
     }
-    s = db_->Write(write_opts_, &batch);
+    return true;
+}
+
+bool DiskTable::Put(uint64_t time, const std::string& value, const Dimensions& dimensions) {
+    std::vector<std::pair<uint32_t, std::string>> cf_keys;
+    uint64_t expire_time = 0;
+    if (!GetCombineKeys(time, value, dimensions, &cf_keys, row_handle_ != nullptr ? &expire_time : nullptr)) {
+        return false;
+    }
+    rocksdb::WriteBatch batch;
+    if (row_handle_ != nullptr) {
+        // the row is written once and the entries of the indexes refer to it
+        std::string row_ref = NewRowRef(expire_time);
+        batch.Put(row_handle_, rocksdb::Slice(row_ref), value);
+        for (const auto& kv : cf_keys) {
+            batch.Put(cf_hs_[kv.first], rocksdb::Slice(kv.second), rocksdb::Slice(row_ref));
+        }
+    } else {
+        for (const auto& kv : cf_keys) {
+            batch.Put(cf_hs_[kv.first], rocksdb::Slice(kv.second), value);
+        }
+    }
+    rocksdb::Status s = db_->Write(write_opts_, &batch);
     if (s.ok()) {
+        for (const auto& kv : cf_keys) {
+            InvalidateRowCache(kv.first, kv.second);
+        }
         offset_.fetch_add(1, std::memory_order_relaxed);
         return true;
     } else {
@@ -266,8 +533,89 @@ bool DiskTable::Put(uint64_t time, const std::string& value, const Dimensions& d
     }
 }
 
+bool DiskTable::BulkLoad(const std::vector<const ::openmldb::api::PutRequest*>& rows) {
+    // column family -> the combined key and the row of its entries
+    std::vector<std::vector<std::pair<std::string, uint32_t>>> cf_entries(cf_hs_.size());
+    // the keys of the rows in the row store, the entries of the indexes hold them as the values
+    std::vector<std::string> row_refs;
+    uint32_t row_cf = cf_hs_.size() - 1;
+    for (uint32_t i = 0; i < rows.size(); i++) {
+        std::vector<std::pair<uint32_t, std::string>> cf_keys;
+        uint64_t expire_time = 0;
+        if (!GetCombineKeys(rows[i]->time(), rows[i]->value(), rows[i]->dimensions(), &cf_keys,
+                            row_handle_ != nullptr ? &expire_time : nullptr)) {
+            return false;
+        }
+        for (auto& kv : cf_keys) {
+            cf_entries[kv.first].emplace_back(std::move(kv.second), i);
+        }
+        if (row_handle_ != nullptr) {
+            row_refs.push_back(NewRowRef(expire_time));
+            cf_entries[row_cf].emplace_back(row_refs.back(), i);
+        }
+    }
+    std::string sst_path = table_path_ + "/bulk_load";
+    if (!::openmldb::base::MkdirRecur(sst_path)) {
+        PDLOG(WARNING, "fail to create path %s", sst_path.c_str());
+        return false;
+    }
+    for (uint32_t n = 0; n < cf_entries.size(); n++) {
+        // the rows are ingested before the entries referring to them
+        uint32_t cf = row_handle_ != nullptr ? (n + row_cf) % cf_entries.size() : n;
+        auto& entries = cf_entries[cf];
+        if (entries.empty()) {
+            continue;
+        }
+        bool is_row_cf = row_handle_ != nullptr && cf == row_cf;
+        const rocksdb::Comparator* cmp =
+            is_row_cf || key_format_ == KeyFormat::kBytewise ? rocksdb::BytewiseComparator() : &cmp_;
+        std::stable_sort(entries.begin(), entries.end(),
+                         [cmp](const std::pair<std::string, uint32_t>& a, const std::pair<std::string, uint32_t>& b) {
+                             return cmp->Compare(a.first, b.first) < 0;
+                         });
+        std::string file = sst_path + "/" + std::to_string(cf) + "_" +
+                           std::to_string(sst_file_id_.fetch_add(1, std::memory_order_relaxed)) + ".sst";
+        rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), rocksdb::Options(options_, cf_ds_[cf].options));
+        rocksdb::Status s = writer.Open(file);
+        for (size_t i = 0; s.ok() && i < entries.size(); i++) {
+            // the keys in sst must be strictly increasing, only the last row of the same key is kept
+            if (i + 1 < entries.size() && cmp->Compare(entries[i].first, entries[i + 1].first) == 0) {
+                continue;
+            }
+            uint32_t row_idx = entries[i].second;
+            if (row_handle_ != nullptr && !is_row_cf) {
+                s = writer.Put(entries[i].first, row_refs[row_idx]);
+            } else {
+                s = writer.Put(entries[i].first, rows[row_idx]->value());
+            }
+        }
+        if (s.ok()) {
+            s = writer.Finish();
+        }
+        if (s.ok()) {
+            rocksdb::IngestExternalFileOptions ingest_opts;
+            ingest_opts.move_files = true;
+            s = db_->IngestExternalFile(cf_hs_[cf], {file}, ingest_opts);
+        }
+        for (const auto& entry : entries) {
+            if (!is_row_cf) {
+                InvalidateRowCache(cf, entry.first);
+            }
+        }
+        if (!s.ok()) {
+            PDLOG(WARNING, "bulk load sst %s failed. tid %u pid %u msg %s", file.c_str(), id_, pid_,
+                  s.ToString().c_str());
+            unlink(file.c_str());
+            return false;
+        }
+    }
+    offset_.fetch_add(rows.size(), std::memory_order_relaxed);
+    return true;
+}
+
 bool DiskTable::Delete(const std::string& pk, uint32_t idx) {
     rocksdb::WriteBatch batch;
+    std::vector<std::string> deleted_keys;
     std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(idx);
     if (!index_def) {
         return false;
@@ -280,17 +628,22 @@ bool DiskTable::Delete(const std::string& pk, uint32_t idx) {
             if (!ts_col) {
                 return false;
             }
-            std::string combine_key1 = CombineKeyTs(pk, UINT64_MAX, ts_col->GetId());
-            std::string combine_key2 = CombineKeyTs(pk, 0, ts_col->GetId());
+            std::string combine_key1 = CombineKeyTs(key_format_, pk, UINT64_MAX, ts_col->GetId());
+            std::string combine_key2 = CombineKeyTs(key_format_, pk, 0, ts_col->GetId());
             batch.DeleteRange(cf_hs_[idx + 1], rocksdb::Slice(combine_key1), rocksdb::Slice(combine_key2));
+            deleted_keys.push_back(combine_key1);
         }
     } else {
-        std::string combine_key1 = CombineKeyTs(pk, UINT64_MAX);
-        std::string combine_key2 = CombineKeyTs(pk, 0);
+        std::string combine_key1 = CombineKeyTs(key_format_, pk, UINT64_MAX);
+        std::string combine_key2 = CombineKeyTs(key_format_, pk, 0);
         batch.DeleteRange(cf_hs_[idx + 1], rocksdb::Slice(combine_key1), rocksdb::Slice(combine_key2));
+        deleted_keys.push_back(combine_key1);
     }
     rocksdb::Status s = db_->Write(write_opts_, &batch);
     if (s.ok()) {
+        for (const auto& key : deleted_keys) {
+            InvalidateRowCache(idx + 1, key);
+        }
         offset_.fetch_add(1, std::memory_order_relaxed);
         return true;
     } else {
@@ -316,7 +669,7 @@ bool DiskTable::Get(uint32_t idx, const std::string& pk, uint64_t ts, std::strin
 bool DiskTable::Get(const std::string& pk, uint64_t ts, std::string& value) { return Get(0, pk, ts, value); }
 
 void DiskTable::SchedGc() {
-    GcHead();
+    // the expired rows are dropped in compaction by TTLCompactionFilter
     UpdateTTL();
 }
 
@@ -328,6 +681,8 @@ void DiskTable::GcHead() {
         rocksdb::ReadOptions ro = rocksdb::ReadOptions();
         const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
         ro.snapshot = snapshot;
+        // seek across the keys, the prefix filters can't be used
+        ro.total_order_seek = true;
         // ro.prefix_same_as_start = true;
         ro.pin_data = true;
         rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[idx + 1]);
@@ -356,7 +711,7 @@ void DiskTable::GcHead() {
                 std::string cur_pk;
                 uint64_t ts = 0;
                 uint32_t ts_idx = 0;
-                ParseKeyAndTs(true, it->key(), cur_pk, ts, ts_idx);
+                ParseKeyAndTs(key_format_, true, it->key(), cur_pk, ts, ts_idx);
                 if (!last_pk.empty() && cur_pk == last_pk) {
                     auto ttl_iter = ttl_map.find(ts_idx);
                     if (ttl_iter != ttl_map.end() && ttl_iter->second > 0) {
@@ -373,8 +728,8 @@ void DiskTable::GcHead() {
                     }
                 } else {
                     for (const auto& kv : delete_key_map) {
-                        std::string combine_key1 = CombineKeyTs(last_pk, kv.second, kv.first);
-                        std::string combine_key2 = CombineKeyTs(last_pk, 0, kv.first);
+                        std::string combine_key1 = CombineKeyTs(key_format_, last_pk, kv.second, kv.first);
+                        std::string combine_key2 = CombineKeyTs(key_format_, last_pk, 0, kv.first);
                         rocksdb::Status s = db_->DeleteRange(write_opts_, cf_hs_[idx + 1], rocksdb::Slice(combine_key1),
                                                              rocksdb::Slice(combine_key2));
                         if (!s.ok()) {
@@ -389,8 +744,8 @@ void DiskTable::GcHead() {
                 it->Next();
             }
             for (const auto& kv : delete_key_map) {
-                std::string combine_key1 = CombineKeyTs(last_pk, kv.second, kv.first);
-                std::string combine_key2 = CombineKeyTs(last_pk, 0, kv.first);
+                std::string combine_key1 = CombineKeyTs(key_format_, last_pk, kv.second, kv.first);
+                std::string combine_key2 = CombineKeyTs(key_format_, last_pk, 0, kv.first);
                 rocksdb::Status s = db_->DeleteRange(write_opts_, cf_hs_[idx + 1], rocksdb::Slice(combine_key1),
                                                      rocksdb::Slice(combine_key2));
                 if (!s.ok()) {
@@ -408,15 +763,15 @@ void DiskTable::GcHead() {
             while (it->Valid()) {
                 std::string cur_pk;
                 uint64_t ts = 0;
-                ParseKeyAndTs(it->key(), cur_pk, ts);
+                ParseKeyAndTs(key_format_, it->key(), cur_pk, ts);
                 if (!last_pk.empty() && cur_pk == last_pk) {
                     if (ts == 0 || count < ttl_num) {
                         it->Next();
                         count++;
                         continue;
                     } else {
-                        std::string combine_key1 = CombineKeyTs(cur_pk, ts);
-                        std::string combine_key2 = CombineKeyTs(cur_pk, 0);
+                        std::string combine_key1 = CombineKeyTs(key_format_, cur_pk, ts);
+                        std::string combine_key2 = CombineKeyTs(key_format_, cur_pk, 0);
                         rocksdb::Status s = db_->DeleteRange(write_opts_, cf_hs_[idx + 1], rocksdb::Slice(combine_key1),
                                                              rocksdb::Slice(combine_key2));
                         if (!s.ok()) {
@@ -438,10 +793,6 @@ void DiskTable::GcHead() {
     PDLOG(INFO, "Gc used %lu second. tid %u pid %u", time_used / 1000, id_, pid_);
 }
 
-void DiskTable::GcTTLOrHead() {}
-
-void DiskTable::GcTTLAndHead() {}
-
 // ttl as ms
 uint64_t DiskTable::GetExpireTime(const TTLSt& ttl_st) {
     if (ttl_st.abs_ttl == 0 || ttl_st.ttl_type == ::openmldb::storage::TTLType::kLatestTime) {
@@ -469,9 +820,103 @@ int DiskTable::CreateCheckPoint(const std::string& checkpoint_dir) {
         PDLOG(WARNING, "CreateCheckpoint failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
         return -1;
     }
+    if (key_format_ == KeyFormat::kBytewise && !WriteKeyFormatFile(checkpoint_dir)) {
+        return -1;
+    }
     return 0;
 }
 
+bool DiskTable::RewriteCheckPoint(const std::string& src_dir, const std::string& dest_dir) {
+    if (key_format_ != KeyFormat::kKeyTs) {
+        return false;
+    }
+    // the checkpoint is opened with the options of the table, and the new db with the same options except the
+    // comparator and the compaction filters of the index column families
+    rocksdb::DB* src_db = nullptr;
+    std::vector<rocksdb::ColumnFamilyHandle*> src_hs;
+    rocksdb::Status s = rocksdb::DB::OpenForReadOnly(options_, src_dir, cf_ds_, &src_hs, &src_db);
+    if (!s.ok()) {
+        PDLOG(WARNING, "fail to open checkpoint %s. tid %u pid %u msg %s", src_dir.c_str(), id_, pid_,
+              s.ToString().c_str());
+        return false;
+    }
+    std::vector<rocksdb::ColumnFamilyDescriptor> dest_ds = cf_ds_;
+    auto inner_indexs = table_index_.GetAllInnerIndex();
+    for (uint32_t i = 0; i < inner_indexs->size(); i++) {
+        dest_ds[i + 1].options.comparator = rocksdb::BytewiseComparator();
+        dest_ds[i + 1].options.compaction_filter_factory =
+            std::make_shared<TTLFilterFactory>(inner_indexs->at(i), KeyFormat::kBytewise);
+    }
+    rocksdb::DBOptions dest_options(options_);
+    dest_options.create_if_missing = true;
+    dest_options.create_missing_column_families = true;
+    rocksdb::DB* dest_db = nullptr;
+    std::vector<rocksdb::ColumnFamilyHandle*> dest_hs;
+    if (::openmldb::base::IsExists(dest_dir)) {
+        ::openmldb::base::RemoveDir(dest_dir);
+    }
+    if (::openmldb::base::MkdirRecur(dest_dir) && WriteKeyFormatFile(dest_dir)) {
+        s = rocksdb::DB::Open(dest_options, dest_dir, dest_ds, &dest_hs, &dest_db);
+    } else {
+        s = rocksdb::Status::IOError("fail to create " + dest_dir);
+    }
+    rocksdb::WriteOptions wo;
+    // the db is flushed at the end instead
+    wo.disableWAL = true;
+    for (uint32_t cf = 0; s.ok() && cf < src_hs.size(); cf++) {
+        bool is_index_cf = cf > 0 && cf <= inner_indexs->size();
+        bool has_ts_idx = is_index_cf && inner_indexs->at(cf - 1)->GetIndex().size() > 1;
+        std::unique_ptr<rocksdb::Iterator> it(src_db->NewIterator(rocksdb::ReadOptions(), src_hs[cf]));
+        rocksdb::WriteBatch batch;
+        for (it->SeekToFirst(); s.ok() && it->Valid(); it->Next()) {
+            if (!is_index_cf) {
+                batch.Put(dest_hs[cf], it->key(), it->value());
+            } else {
+                std::string pk;
+                uint64_t ts = 0;
+                uint32_t ts_idx = 0;
+                if (ParseKeyAndTs(KeyFormat::kKeyTs, has_ts_idx, it->key(), pk, ts, ts_idx) < 0) {
+                    s = rocksdb::Status::Corruption("invalid key in checkpoint");
+                    break;
+                }
+                std::string key = has_ts_idx ? CombineKeyTs(KeyFormat::kBytewise, pk, ts, ts_idx)
+                                             : CombineKeyTs(KeyFormat::kBytewise, pk, ts);
+                batch.Put(dest_hs[cf], key, it->value());
+            }
+            if (batch.GetDataSize() >= REWRITE_BATCH_BYTES) {
+                s = dest_db->Write(wo, &batch);
+                batch.Clear();
+            }
+        }
+        if (s.ok()) {
+            s = it->status();
+        }
+        if (s.ok() && batch.Count() > 0) {
+            s = dest_db->Write(wo, &batch);
+        }
+    }
+    if (s.ok()) {
+        s = dest_db->Flush(rocksdb::FlushOptions(), dest_hs);
+    }
+    for (auto handle : src_hs) {
+        delete handle;
+    }
+    delete src_db;
+    for (auto handle : dest_hs) {
+        delete handle;
+    }
+    delete dest_db;
+    if (!s.ok()) {
+        PDLOG(WARNING, "fail to rewrite checkpoint %s to %s. tid %u pid %u msg %s", src_dir.c_str(),
+              dest_dir.c_str(), id_, pid_, s.ToString().c_str());
+        ::openmldb::base::RemoveDir(dest_dir);
+        return false;
+    }
+    PDLOG(INFO, "rewrite checkpoint %s to %s with bytewise keys. tid %u pid %u", src_dir.c_str(), dest_dir.c_str(),
+          id_, pid_);
+    return true;
+}
+
 TableIterator* DiskTable::NewIterator(const std::string& pk, Ticket& ticket) {
     return DiskTable::NewIterator(0, pk, ticket);
 }
@@ -490,13 +935,16 @@ TableIterator* DiskTable::NewIterator(uint32_t idx, const std::string& pk, Ticke
     ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
-    if (inner_index && inner_index->GetIndex().size() > 1) {
-        auto ts_col = index_def->GetTsColumn();
-        if (ts_col) {
-            return new DiskTableIterator(db_, it, snapshot, pk, ts_col->GetId());
-        }
+    DiskTableIterator* table_it = nullptr;
+    auto ts_col = index_def->GetTsColumn();
+    if (inner_index && inner_index->GetIndex().size() > 1 && ts_col) {
+        table_it = new DiskTableIterator(db_, it, snapshot, pk, ts_col->GetId());
+    } else {
+        table_it = new DiskTableIterator(db_, it, snapshot, pk);
     }
-    return new DiskTableIterator(db_, it, snapshot, pk);
+    table_it->SetRowStore(row_handle_);
+    table_it->SetKeyFormat(key_format_);
+    return table_it;
 }
 
 TraverseIterator* DiskTable::NewTraverseIterator(uint32_t index) {
@@ -512,17 +960,22 @@ TraverseIterator* DiskTable::NewTraverseIterator(uint32_t index) {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
+    // seek across the keys, the prefix filters can't be used
+    ro.total_order_seek = true;
     // ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
-    if (inner_index && inner_index->GetIndex().size() > 1) {
-        auto ts_col = index_def->GetTsColumn();
-        if (ts_col) {
-            return new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
-                                                 ts_col->GetId());
-        }
+    DiskTableTraverseIterator* traverse_it = nullptr;
+    auto ts_col = index_def->GetTsColumn();
+    if (inner_index && inner_index->GetIndex().size() > 1 && ts_col) {
+        traverse_it =
+            new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, ts_col->GetId());
+    } else {
+        traverse_it = new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt);
     }
-    return new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt);
+    traverse_it->SetRowStore(row_handle_);
+    traverse_it->SetKeyFormat(key_format_);
+    return traverse_it;
 }
 
 DiskTableIterator::DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
@@ -541,18 +994,37 @@ DiskTableIterator::~DiskTableIterator() {
 }
 
 bool DiskTableIterator::Valid() {
-    if (it_ == NULL || !it_->Valid()) {
+    if (it_ == NULL) {
         return false;
     }
-    std::string cur_pk;
-    uint32_t cur_ts_idx = UINT32_MAX;
-    ParseKeyAndTs(has_ts_idx_, it_->key(), cur_pk, ts_, cur_ts_idx);
-    return has_ts_idx_ ? cur_pk == pk_ && cur_ts_idx == ts_idx_ : cur_pk == pk_;
+    for (; it_->Valid(); it_->Next()) {
+        std::string cur_pk;
+        uint32_t cur_ts_idx = UINT32_MAX;
+        ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), cur_pk, ts_, cur_ts_idx);
+        if (has_ts_idx_ ? cur_pk != pk_ || cur_ts_idx != ts_idx_ : cur_pk != pk_) {
+            return false;
+        }
+        if (row_handle_ == nullptr || row_valid_) {
+            return true;
+        }
+        // the entries of the rows expired in the row store are skipped
+        row_valid_ = GetRow(db_, row_handle_, snapshot_, it_->value(), &row_);
+        if (row_valid_) {
+            return true;
+        }
+    }
+    return false;
 }
 
-void DiskTableIterator::Next() { return it_->Next(); }
+void DiskTableIterator::Next() {
+    row_valid_ = false;
+    return it_->Next();
+}
 
 openmldb::base::Slice DiskTableIterator::GetValue() const {
+    if (row_handle_ != nullptr) {
+        return openmldb::base::Slice(row_.data(), row_.size());
+    }
     rocksdb::Slice value = it_->value();
     return openmldb::base::Slice(value.data(), value.size());
 }
@@ -562,21 +1034,23 @@ std::string DiskTableIterator::GetPK() const { return pk_; }
 uint64_t DiskTableIterator::GetKey() const { return ts_; }
 
 void DiskTableIterator::SeekToFirst() {
+    row_valid_ = false;
     if (has_ts_idx_) {
-        std::string combine_key = CombineKeyTs(pk_, UINT64_MAX, ts_idx_);
+        std::string combine_key = CombineKeyTs(key_format_, pk_, UINT64_MAX, ts_idx_);
         it_->Seek(rocksdb::Slice(combine_key));
     } else {
-        std::string combine_key = CombineKeyTs(pk_, UINT64_MAX);
+        std::string combine_key = CombineKeyTs(key_format_, pk_, UINT64_MAX);
         it_->Seek(rocksdb::Slice(combine_key));
     }
 }
 
 void DiskTableIterator::Seek(const uint64_t ts) {
+    row_valid_ = false;
     if (has_ts_idx_) {
-        std::string combine_key = CombineKeyTs(pk_, ts, ts_idx_);
+        std::string combine_key = CombineKeyTs(key_format_, pk_, ts, ts_idx_);
         it_->Seek(rocksdb::Slice(combine_key));
     } else {
-        std::string combine_key = CombineKeyTs(pk_, ts);
+        std::string combine_key = CombineKeyTs(key_format_, pk_, ts);
         it_->Seek(rocksdb::Slice(combine_key));
     }
 }
@@ -615,18 +1089,27 @@ DiskTableTraverseIterator::~DiskTableTraverseIterator() {
 uint64_t DiskTableTraverseIterator::GetCount() const { return traverse_cnt_; }
 
 bool DiskTableTraverseIterator::Valid() {
-    if (traverse_cnt_ >= FLAGS_max_traverse_cnt) {
-        return false;
+    while (traverse_cnt_ < FLAGS_max_traverse_cnt && it_->Valid()) {
+        if (row_handle_ == nullptr || row_valid_) {
+            return true;
+        }
+        // the entries of the rows expired in the row store are skipped
+        row_valid_ = GetRow(db_, row_handle_, snapshot_, it_->value(), &row_);
+        if (row_valid_) {
+            return true;
+        }
+        Next();
     }
-    return it_->Valid();
+    return false;
 }
 
 void DiskTableTraverseIterator::Next() {
+    row_valid_ = false;
     for (it_->Next(); it_->Valid(); it_->Next()) {
         std::string last_pk = pk_;
         uint32_t cur_ts_idx = UINT32_MAX;
         traverse_cnt_++;
-        ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+        ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
         if (last_pk == pk_) {
             if (has_ts_idx_ && (cur_ts_idx != ts_idx_)) {
                 traverse_cnt_--;
@@ -645,7 +1128,7 @@ void DiskTableTraverseIterator::Next() {
             if (has_ts_idx_) {
                 uint64_t ts = 0;
                 std::string tmp_pk;
-                ParseKeyAndTs(has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
+                ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
                 if (tmp_pk == pk_ && cur_ts_idx < ts_idx_) {
                     ts_ = UINT64_MAX;
                 }
@@ -660,6 +1143,9 @@ void DiskTableTraverseIterator::Next() {
 }
 
 openmldb::base::Slice DiskTableTraverseIterator::GetValue() const {
+    if (row_handle_ != nullptr) {
+        return openmldb::base::Slice(row_.data(), row_.size());
+    }
     rocksdb::Slice value = it_->value();
     return openmldb::base::Slice(value.data(), value.size());
 }
@@ -669,6 +1155,7 @@ std::string DiskTableTraverseIterator::GetPK() const { return pk_; }
 uint64_t DiskTableTraverseIterator::GetKey() const { return ts_; }
 
 void DiskTableTraverseIterator::SeekToFirst() {
+    row_valid_ = false;
     it_->SeekToFirst();
     record_idx_ = 1;
     for (; it_->Valid(); it_->Next()) {
@@ -678,14 +1165,14 @@ void DiskTableTraverseIterator::SeekToFirst() {
             if (has_ts_idx_) {
                 uint64_t ts = 0;
                 std::string tmp_pk;
-                ParseKeyAndTs(has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
+                ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
                 if (tmp_pk == pk_ && cur_ts_idx < ts_idx_) {
                     ts_ = UINT64_MAX;
                 }
             }
             break;
         }
-        ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+        ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
         if (has_ts_idx_ && cur_ts_idx != ts_idx_) {
             continue;
         }
@@ -697,11 +1184,12 @@ void DiskTableTraverseIterator::SeekToFirst() {
 }
 
 void DiskTableTraverseIterator::Seek(const std::string& pk, uint64_t time) {
+    row_valid_ = false;
     std::string combine;
     if (has_ts_idx_) {
-        combine = CombineKeyTs(pk, time, ts_idx_);
+        combine = CombineKeyTs(key_format_, pk, time, ts_idx_);
     } else {
-        combine = CombineKeyTs(pk, time);
+        combine = CombineKeyTs(key_format_, pk, time);
     }
     it_->Seek(rocksdb::Slice(combine));
     if (expire_value_.ttl_type == ::openmldb::storage::TTLType::kLatestTime) {
@@ -713,14 +1201,14 @@ void DiskTableTraverseIterator::Seek(const std::string& pk, uint64_t time) {
                 if (has_ts_idx_) {
                     std::string tmp_pk;
                     uint64_t ts = 0;
-                    ParseKeyAndTs(has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
+                    ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
                     if (tmp_pk == pk_ && cur_ts_idx < ts_idx_) {
                         ts_ = UINT64_MAX;
                     }
                 }
                 break;
             }
-            ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+            ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
             if (pk_ == pk) {
                 if (has_ts_idx_ && (cur_ts_idx != ts_idx_)) {
                     continue;
@@ -749,14 +1237,14 @@ void DiskTableTraverseIterator::Seek(const std::string& pk, uint64_t time) {
                 if (has_ts_idx_) {
                     std::string tmp_pk;
                     uint64_t ts = 0;
-                    ParseKeyAndTs(has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
+                    ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
                     if (tmp_pk == pk_ && cur_ts_idx < ts_idx_) {
                         ts_ = UINT64_MAX;
                     }
                 }
                 break;
             }
-            ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+            ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
             if (pk_ == pk) {
                 if (has_ts_idx_ && (cur_ts_idx != ts_idx_)) {
                     continue;
@@ -786,10 +1274,10 @@ void DiskTableTraverseIterator::NextPK() {
     std::string last_pk = pk_;
     std::string combine;
     if (has_ts_idx_) {
-        std::string combine_key = CombineKeyTs(last_pk, 0, ts_idx_);
+        std::string combine_key = CombineKeyTs(key_format_, last_pk, 0, ts_idx_);
         it_->Seek(rocksdb::Slice(combine_key));
     } else {
-        std::string combine_key = CombineKeyTs(last_pk, 0);
+        std::string combine_key = CombineKeyTs(key_format_, last_pk, 0);
         it_->Seek(rocksdb::Slice(combine_key));
     }
     record_idx_ = 1;
@@ -800,14 +1288,14 @@ void DiskTableTraverseIterator::NextPK() {
             if (has_ts_idx_) {
                 std::string tmp_pk;
                 uint64_t ts = 0;
-                ParseKeyAndTs(has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
+                ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), tmp_pk, ts, cur_ts_idx);
                 if (tmp_pk == pk_ && cur_ts_idx < ts_idx_) {
                     ts_ = UINT64_MAX;
                 }
             }
             break;
         }
-        ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+        ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
         if (pk_ != last_pk) {
             if (has_ts_idx_ && (cur_ts_idx != ts_idx_)) {
                 it_->Next();
@@ -819,10 +1307,10 @@ void DiskTableTraverseIterator::NextPK() {
                 last_pk = pk_;
                 std::string combine;
                 if (has_ts_idx_) {
-                    std::string combine_key = CombineKeyTs(last_pk, 0, ts_idx_);
+                    std::string combine_key = CombineKeyTs(key_format_, last_pk, 0, ts_idx_);
                     it_->Seek(rocksdb::Slice(combine_key));
                 } else {
-                    std::string combine_key = CombineKeyTs(last_pk, 0);
+                    std::string combine_key = CombineKeyTs(key_format_, last_pk, 0);
                     it_->Seek(rocksdb::Slice(combine_key));
                 }
                 record_idx_ = 1;
@@ -846,17 +1334,28 @@ void DiskTableTraverseIterator::NextPK() {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
+    // seek across the keys, the prefix filters can't be used
+    ro.total_order_seek = true;
     // ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
     if (inner_index && inner_index->GetIndex().size() > 1) {
         auto ts_col = index_def->GetTsColumn();
         if (ts_col) {
-            return new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
-                                                 ts_col->GetId(), cf_hs_[inner_pos + 1]);
+            auto key_it = new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
+                                                   ts_col->GetId(), cf_hs_[inner_pos + 1]);
+            key_it->SetRowCache(row_cache_, inner_pos + 1);
+            key_it->SetRowStore(row_handle_);
+            key_it->SetKeyFormat(key_format_);
+            return key_it;
         }
     }
-    return new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, cf_hs_[inner_pos + 1]);
+    auto key_it =
+        new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, cf_hs_[inner_pos + 1]);
+    key_it->SetRowCache(row_cache_, inner_pos + 1);
+    key_it->SetRowStore(row_handle_);
+    key_it->SetKeyFormat(key_format_);
+    return key_it;
 }
 
 DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it,
@@ -871,7 +1370,9 @@ DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* i
       expire_cnt_(expire_cnt),
       has_ts_idx_(false),
       ts_idx_(0),
-      column_handle_(column_handle) {}
+      column_handle_(column_handle),
+      row_cache_(),
+      cf_(0) {}
 
 DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it,
                                            const rocksdb::Snapshot* snapshot, ::openmldb::storage::TTLType ttl_type,
@@ -885,7 +1386,9 @@ DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* i
       expire_cnt_(expire_cnt),
       has_ts_idx_(true),
       ts_idx_(ts_idx),
-      column_handle_(column_handle) {}
+      column_handle_(column_handle),
+      row_cache_(),
+      cf_(0) {}
 
 DiskTableKeyIterator::~DiskTableKeyIterator() {
     delete it_;
@@ -895,21 +1398,21 @@ DiskTableKeyIterator::~DiskTableKeyIterator() {
 void DiskTableKeyIterator::SeekToFirst() {
     it_->SeekToFirst();
     uint32_t cur_ts_idx = UINT32_MAX;
-    ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+    ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
 }
 
 void DiskTableKeyIterator::NextPK() {
     std::string last_pk = pk_;
     std::string combine_key;
     if (has_ts_idx_) {
-        combine_key = CombineKeyTs(last_pk, 0, ts_idx_);
+        combine_key = CombineKeyTs(key_format_, last_pk, 0, ts_idx_);
     } else {
-        combine_key = CombineKeyTs(last_pk, 0);
+        combine_key = CombineKeyTs(key_format_, last_pk, 0);
     }
     it_->Seek(rocksdb::Slice(combine_key));
     while (it_->Valid()) {
         uint32_t cur_ts_idx = UINT32_MAX;
-        ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+        ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
         if (pk_ != last_pk) {
             if (has_ts_idx_ && (cur_ts_idx != ts_idx_)) {
                 it_->Next();
@@ -928,14 +1431,14 @@ void DiskTableKeyIterator::Seek(const std::string& pk) {
     std::string combine;
     uint64_t tmp_ts = UINT64_MAX;
     if (has_ts_idx_) {
-        combine = CombineKeyTs(pk, tmp_ts, ts_idx_);
+        combine = CombineKeyTs(key_format_, pk, tmp_ts, ts_idx_);
     } else {
-        combine = CombineKeyTs(pk, tmp_ts);
+        combine = CombineKeyTs(key_format_, pk, tmp_ts);
     }
     it_->Seek(rocksdb::Slice(combine));
     for (; it_->Valid(); it_->Next()) {
         uint32_t cur_ts_idx = UINT32_MAX;
-        ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+        ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
         if (pk_ == pk) {
             if (has_ts_idx_ && (cur_ts_idx != ts_idx_)) {
                 continue;
@@ -956,26 +1459,54 @@ const hybridse::codec::Row DiskTableKeyIterator::GetKey() {
 }
 
 std::unique_ptr<::hybridse::vm::RowIterator> DiskTableKeyIterator::GetValue() {
-    rocksdb::ReadOptions ro = rocksdb::ReadOptions();
-    const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
-    ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
-    ro.pin_data = true;
-    rocksdb::Iterator* it = db_->NewIterator(ro, column_handle_);
-    std::unique_ptr<DiskTableRowIterator> wit(new DiskTableRowIterator(db_, it, snapshot, ttl_type_, expire_time_,
-                                                                       expire_cnt_, pk_, ts_, has_ts_idx_, ts_idx_));
-    return wit;
+    return std::unique_ptr<::hybridse::vm::RowIterator>(GetRawValue());
 }
 
 ::hybridse::vm::RowIterator* DiskTableKeyIterator::GetRawValue() {
+    if (row_cache_) {
+        auto cached = GetCachedRows();
+        if (cached) {
+            auto row_it = new DiskTableRowIterator(db_, column_handle_, cached, ttl_type_, expire_time_, expire_cnt_,
+                                                   pk_, has_ts_idx_, ts_idx_);
+            row_it->SetRowStore(row_handle_);
+            row_it->SetKeyFormat(key_format_);
+            return row_it;
+        }
+    }
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
     // ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, column_handle_);
-    return new DiskTableRowIterator(db_, it, snapshot, ttl_type_, expire_time_, expire_cnt_, pk_, ts_, has_ts_idx_,
-                                    ts_idx_);
+    auto row_it = new DiskTableRowIterator(db_, it, snapshot, ttl_type_, expire_time_, expire_cnt_, pk_, ts_,
+                                           has_ts_idx_, ts_idx_);
+    row_it->SetRowStore(row_handle_);
+    row_it->SetKeyFormat(key_format_);
+    return row_it;
+}
+
+std::shared_ptr<const DiskRowCache::Entry> DiskTableKeyIterator::GetCachedRows() {
+    std::string start_key = has_ts_idx_ ? CombineKeyTs(key_format_, pk_, UINT64_MAX, ts_idx_)
+                                        : CombineKeyTs(key_format_, pk_, UINT64_MAX);
+    rocksdb::Slice prefix(start_key.data(), start_key.size() - TS_LEN);
+    auto cached = row_cache_->Get(cf_, prefix);
+    if (cached) {
+        return cached;
+    }
+    // read the most recent rows of the key, one more row tells whether all rows are read
+    uint64_t generation = row_cache_->GetGeneration(cf_, prefix);
+    auto entry = std::make_shared<DiskRowCache::Entry>();
+    rocksdb::ReadOptions ro = rocksdb::ReadOptions();
+    ro.prefix_same_as_start = true;
+    std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(ro, column_handle_));
+    it->Seek(rocksdb::Slice(start_key));
+    if (!ReadRows(db_, it.get(), row_handle_, nullptr, key_format_, pk_, has_ts_idx_, ts_idx_, row_cache_->GetMaxRows(),
+                  entry.get())) {
+        return {};
+    }
+    row_cache_->Insert(cf_, prefix, entry, generation);
+    return entry;
 }
 
 DiskTableRowIterator::DiskTableRowIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
@@ -983,6 +1514,12 @@ DiskTableRowIterator::DiskTableRowIterator(rocksdb::DB* db, rocksdb::Iterator* i
                                            uint64_t expire_cnt, std::string pk, uint64_t ts, bool has_ts_idx,
                                            uint32_t ts_idx)
     : db_(db),
+      column_handle_(nullptr),
+      row_handle_(nullptr),
+      cached_(),
+      cached_from_(UINT64_MAX),
+      cached_pos_(0),
+      in_cache_(false),
       it_(it),
       snapshot_(snapshot),
       record_idx_(1),
@@ -992,25 +1529,72 @@ DiskTableRowIterator::DiskTableRowIterator(rocksdb::DB* db, rocksdb::Iterator* i
       ts_(ts),
       has_ts_idx_(has_ts_idx),
       ts_idx_(ts_idx),
-      row_() {}
+      row_(),
+      pk_valid_(false) {}
+
+DiskTableRowIterator::DiskTableRowIterator(rocksdb::DB* db, rocksdb::ColumnFamilyHandle* column_handle,
+                                           std::shared_ptr<const DiskRowCache::Entry> cached,
+                                           ::openmldb::storage::TTLType ttl_type, uint64_t expire_time,
+                                           uint64_t expire_cnt, std::string pk, bool has_ts_idx, uint32_t ts_idx)
+    : db_(db),
+      column_handle_(column_handle),
+      row_handle_(nullptr),
+      cached_(cached),
+      cached_from_(UINT64_MAX),
+      cached_pos_(0),
+      in_cache_(false),
+      it_(nullptr),
+      snapshot_(nullptr),
+      record_idx_(1),
+      expire_value_(expire_time, expire_cnt, ttl_type),
+      pk_(pk),
+      row_pk_(pk),
+      ts_(0),
+      has_ts_idx_(has_ts_idx),
+      ts_idx_(ts_idx),
+      row_(),
+      pk_valid_(false) {}
 
 DiskTableRowIterator::~DiskTableRowIterator() {
     delete it_;
-    db_->ReleaseSnapshot(snapshot_);
+    if (snapshot_ != nullptr) {
+        db_->ReleaseSnapshot(snapshot_);
+    }
 }
 
 bool DiskTableRowIterator::Valid() const {
+    if (in_cache_) {
+        return !expire_value_.IsExpired(ts_, record_idx_);
+    }
     if (!pk_valid_) return false;
-    if (!it_->Valid() || expire_value_.IsExpired(ts_, record_idx_)) {
+    if (it_ == nullptr || !it_->Valid() || expire_value_.IsExpired(ts_, record_idx_)) {
         return false;
     }
     return true;
 }
 
 void DiskTableRowIterator::Next() {
+    if (in_cache_) {
+        record_idx_++;
+        if (++cached_pos_ < cached_->rows.size()) {
+            ts_ = cached_->rows[cached_pos_].first;
+            return;
+        }
+        in_cache_ = false;
+        pk_valid_ = false;
+        // continue with the rows older than the cached ones
+        if (!cached_->complete && ts_ > 0) {
+            SeekDisk(ts_ - 1);
+        }
+        return;
+    }
+    // the rows of the row store are only served from the cached batches
+    if (it_ == nullptr || row_handle_ != nullptr) {
+        return;
+    }
     for (it_->Next(); it_->Valid(); it_->Next()) {
         uint32_t cur_ts_idx = UINT32_MAX;
-        ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+        ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
         if (row_pk_ == pk_) {
             if (has_ts_idx_ && (cur_ts_idx != ts_idx_)) {
                 // combineKey is (pk, ts_col, ts). So if cur_ts_idx != ts_idx,
@@ -1030,23 +1614,62 @@ void DiskTableRowIterator::Next() {
 inline const uint64_t& DiskTableRowIterator::GetKey() const { return ts_; }
 
 const ::hybridse::codec::Row& DiskTableRowIterator::GetValue() {
+    if (in_cache_) {
+        const auto& value = cached_->rows[cached_pos_].second;
+        row_.Reset(reinterpret_cast<const int8_t*>(value.data()), value.size());
+        return row_;
+    }
     rocksdb::Slice value = it_->value();
     row_.Reset(reinterpret_cast<const int8_t*>(value.data()), value.size());
     return row_;
 }
 
 void DiskTableRowIterator::Seek(const uint64_t& key) {
+    // the cached rows hold no row newer than the ts they are read from
+    if (cached_ && key <= cached_from_) {
+        const auto& rows = cached_->rows;
+        auto iter = std::lower_bound(rows.begin(), rows.end(), key,
+                                     [](const std::pair<uint64_t, std::string>& row, uint64_t ts) {
+                                         return row.first > ts;
+                                     });
+        if (iter != rows.end()) {
+            in_cache_ = true;
+            cached_pos_ = static_cast<uint32_t>(iter - rows.begin());
+            ts_ = iter->first;
+            return;
+        }
+        in_cache_ = false;
+        if (cached_->complete) {
+            pk_valid_ = false;
+            return;
+        }
+    }
+    SeekDisk(key);
+}
+
+void DiskTableRowIterator::SeekDisk(uint64_t key) {
+    if (it_ == nullptr) {
+        snapshot_ = db_->GetSnapshot();
+        rocksdb::ReadOptions ro = rocksdb::ReadOptions();
+        ro.snapshot = snapshot_;
+        ro.pin_data = true;
+        it_ = db_->NewIterator(ro, column_handle_);
+    }
+    if (row_handle_ != nullptr) {
+        LoadRows(key);
+        return;
+    }
     std::string combine;
     uint64_t tmp_ts = key;
     if (has_ts_idx_) {
-        combine = CombineKeyTs(row_pk_, tmp_ts, ts_idx_);
+        combine = CombineKeyTs(key_format_, row_pk_, tmp_ts, ts_idx_);
     } else {
-        combine = CombineKeyTs(row_pk_, tmp_ts);
+        combine = CombineKeyTs(key_format_, row_pk_, tmp_ts);
     }
     it_->Seek(rocksdb::Slice(combine));
     for (; it_->Valid(); it_->Next()) {
         uint32_t cur_ts_idx = UINT32_MAX;
-        ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
+        ParseKeyAndTs(key_format_, has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
         if (pk_ == row_pk_) {
             if (has_ts_idx_ && (cur_ts_idx != ts_idx_)) {
                 // combineKey is (pk, ts_col, ts). So if cur_ts_idx != ts_idx,
@@ -1062,32 +1685,50 @@ void DiskTableRowIterator::Seek(const uint64_t& key) {
     }
 }
 
+void DiskTableRowIterator::LoadRows(uint64_t key) {
+    std::string combine = has_ts_idx_ ? CombineKeyTs(key_format_, row_pk_, key, ts_idx_)
+                                      : CombineKeyTs(key_format_, row_pk_, key);
+    it_->Seek(rocksdb::Slice(combine));
+    in_cache_ = false;
+    pk_valid_ = false;
+    while (true) {
+        auto entry = std::make_shared<DiskRowCache::Entry>();
+        if (!ReadRows(db_, it_, row_handle_, snapshot_, key_format_, row_pk_, has_ts_idx_, ts_idx_,
+                      ROW_STORE_BATCH_SIZE, entry.get())) {
+            cached_.reset();
+            return;
+        }
+        cached_ = entry;
+        cached_from_ = key;
+        if (!entry->rows.empty()) {
+            in_cache_ = true;
+            cached_pos_ = 0;
+            ts_ = entry->rows[0].first;
+            return;
+        }
+        if (entry->complete) {
+            return;
+        }
+        // all the rows of the batch are expired in the row store, it_ is at the next entry
+    }
+}
+
 void DiskTableRowIterator::SeekToFirst() {
     record_idx_ = 1;
-    std::string combine;
-    uint64_t tmp_ts = UINT64_MAX;
-    if (has_ts_idx_) {
-        combine = CombineKeyTs(row_pk_, tmp_ts, ts_idx_);
-    } else {
-        combine = CombineKeyTs(row_pk_, tmp_ts);
-    }
-    it_->Seek(rocksdb::Slice(combine));
-    for (; it_->Valid(); it_->Next()) {
-        uint32_t cur_ts_idx = UINT32_MAX;
-        ParseKeyAndTs(has_ts_idx_, it_->key(), pk_, ts_, cur_ts_idx);
-        if (pk_ == row_pk_) {
-            if (has_ts_idx_ && (cur_ts_idx != ts_idx_)) {
-                // combineKey is (pk, ts_col, ts). So if cur_ts_idx != ts_idx,
-                // iterator will never get to (pk, ts_idx_) again. Can break here.
-                pk_valid_ = false;
-                break;
-            }
-            pk_valid_ = true;
-        } else {
+    if (cached_ && cached_from_ == UINT64_MAX) {
+        if (!cached_->rows.empty()) {
+            in_cache_ = true;
+            cached_pos_ = 0;
+            ts_ = cached_->rows[0].first;
+            return;
+        }
+        in_cache_ = false;
+        if (cached_->complete) {
             pk_valid_ = false;
+            return;
         }
-        break;
     }
+    SeekDisk(UINT64_MAX);
 }
 inline bool DiskTableRowIterator::IsSeekable() const { return true; }
 
@@ -1142,9 +1783,9 @@ int DiskTable::GetCount(uint32_t index, const std::string& pk, uint64_t& count)
     std::string combine;
     uint64_t tmp_ts = UINT64_MAX;
     if (has_ts_idx) {
-        combine = CombineKeyTs(pk, tmp_ts, ts_idx);
+        combine = CombineKeyTs(key_format_, pk, tmp_ts, ts_idx);
     } else {
-        combine = CombineKeyTs(pk, tmp_ts);
+        combine = CombineKeyTs(key_format_, pk, tmp_ts);
     }
     it->Seek(rocksdb::Slice(combine));
 
@@ -1154,7 +1795,7 @@ int DiskTable::GetCount(uint32_t index, const std::string& pk, uint64_t& count)
         std::string cur_pk;
         uint64_t cur_ts;
 
-        ParseKeyAndTs(has_ts_idx, it->key(), cur_pk, cur_ts, cur_ts_idx);
+        ParseKeyAndTs(key_format_, has_ts_idx, it->key(), cur_pk, cur_ts, cur_ts_idx);
         if (cur_pk == pk) {
             if (has_ts_idx && (cur_ts_idx != ts_idx)) {
                 break;
@@ -20,6 +20,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "base/endianconv.h"
 #include "base/slice.h"
@@ -32,11 +33,15 @@
 #include "rocksdb/db.h"
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/options.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/sst_file_writer.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
 #include "rocksdb/utilities/checkpoint.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "storage/disk_row_cache.h"
 #include "storage/iterator.h"
 #include "storage/table.h"
 
@@ -45,8 +50,52 @@ namespace storage {
 
 static const uint32_t TS_LEN = sizeof(uint64_t);
 static const uint32_t TS_POS_LEN = sizeof(uint32_t);
+// the key of a row in the row store, the expire time and the row id
+static const uint32_t ROW_REF_LEN = 2 * sizeof(uint64_t);
+
+// the length of the size of pk in the keys of KeyFormat::kBytewise
+static const uint32_t KEY_SIZE_LEN = sizeof(uint32_t);
+// the file in the data dir of a disk table whose index keys are of KeyFormat::kBytewise
+static const char KEY_FORMAT_FILE[] = "KEY_FORMAT";
+
+// the layout of the keys of the index column families
+//   kKeyTs:    pk | [ts index(4 bytes)] | ts(8 bytes, little endian), ordered by KeyTSComparator
+//   kBytewise: pk size(4 bytes, big endian) | pk | [ts index(4 bytes)] | ~ts(8 bytes, big endian)
+// The keys of kBytewise are ordered as kKeyTs by the default bytewise comparator: the size goes first so no pk is
+// the prefix of another, and the inverted ts puts the latest row of a key first. The ts is the last 8 bytes of
+// both, so the prefix without ts of a key is taken the same way
+enum class KeyFormat { kKeyTs, kBytewise };
+
+static inline void EncodeKeyTs(KeyFormat format, uint64_t ts, char* buf) {
+    if (format == KeyFormat::kBytewise) {
+        ts = ~ts;
+        for (int i = TS_LEN - 1; i >= 0; i--) {
+            buf[i] = static_cast<char>(ts & 0xff);
+            ts >>= 8;
+        }
+        return;
+    }
+    memrev64ifbe(static_cast<void*>(&ts));
+    memcpy(buf, static_cast<void*>(&ts), TS_LEN);
+}
 
-__attribute__((unused)) static int ParseKeyAndTs(bool has_ts_idx, const rocksdb::Slice& s,
+static inline uint64_t DecodeKeyTs(KeyFormat format, const char* buf) {
+    uint64_t ts = 0;
+    if (format == KeyFormat::kBytewise) {
+        for (uint32_t i = 0; i < TS_LEN; i++) {
+            ts = (ts << 8) | static_cast<uint8_t>(buf[i]);
+        }
+        return ~ts;
+    }
+    memcpy(static_cast<void*>(&ts), buf, TS_LEN);
+    memrev64ifbe(static_cast<void*>(&ts));
+    return ts;
+}
+
+// the bytes before the pk in a key
+static inline uint32_t KeyPkOffset(KeyFormat format) { return format == KeyFormat::kBytewise ? KEY_SIZE_LEN : 0; }
+
+__attribute__((unused)) static int ParseKeyAndTs(KeyFormat format, bool has_ts_idx, const rocksdb::Slice& s,
                                                  std::string& key,   // NOLINT
                                                  uint64_t& ts,       // NOLINT
                                                  uint32_t& ts_idx) {  // NOLINT
@@ -54,73 +103,100 @@ __attribute__((unused)) static int ParseKeyAndTs(bool has_ts_idx, const rocksdb:
     if (has_ts_idx) {
         len += TS_POS_LEN;
     }
+    uint32_t offset = KeyPkOffset(format);
     key.clear();
-    if (s.size() < len) {
+    if (s.size() < len + offset) {
         return -1;
-    } else if (s.size() > len) {
-        key.assign(s.data(), s.size() - len);
+    } else if (s.size() > len + offset) {
+        key.assign(s.data() + offset, s.size() - len - offset);
     }
     if (has_ts_idx) {
         memcpy(static_cast<void*>(&ts_idx), s.data() + s.size() - len, TS_POS_LEN);
     }
-    memcpy(static_cast<void*>(&ts), s.data() + s.size() - TS_LEN, TS_LEN);
-    memrev64ifbe(static_cast<void*>(&ts));
+    ts = DecodeKeyTs(format, s.data() + s.size() - TS_LEN);
     return 0;
 }
 
-static int ParseKeyAndTs(const rocksdb::Slice& s, std::string& key,  // NOLINT
-                         uint64_t& ts) {                             // NOLINT
+// the key is the pk with the ts index if any
+static int ParseKeyAndTs(KeyFormat format, const rocksdb::Slice& s, std::string& key,  // NOLINT
+                         uint64_t& ts) {                                              // NOLINT
+    uint32_t offset = KeyPkOffset(format);
     key.clear();
-    if (s.size() < TS_LEN) {
+    if (s.size() < TS_LEN + offset) {
         return -1;
-    } else if (s.size() > TS_LEN) {
-        key.assign(s.data(), s.size() - TS_LEN);
+    } else if (s.size() > TS_LEN + offset) {
+        key.assign(s.data() + offset, s.size() - TS_LEN - offset);
     }
-    memcpy(static_cast<void*>(&ts), s.data() + s.size() - TS_LEN, TS_LEN);
-    memrev64ifbe(static_cast<void*>(&ts));
+    ts = DecodeKeyTs(format, s.data() + s.size() - TS_LEN);
     return 0;
 }
 
-static inline std::string CombineKeyTs(const std::string& key, uint64_t ts) {
+static inline std::string CombineKeyTs(KeyFormat format, const std::string& key, uint64_t ts) {
+    uint32_t offset = KeyPkOffset(format);
     std::string result;
-    result.resize(key.size() + TS_LEN);
+    result.resize(offset + key.size() + TS_LEN);
     char* buf = reinterpret_cast<char*>(&(result[0]));
-    memrev64ifbe(static_cast<void*>(&ts));
-    memcpy(buf, key.c_str(), key.size());
-    memcpy(buf + key.size(), static_cast<void*>(&ts), TS_LEN);
+    if (format == KeyFormat::kBytewise) {
+        uint32_t size = key.size();
+        for (int i = KEY_SIZE_LEN - 1; i >= 0; i--) {
+            buf[i] = static_cast<char>(size & 0xff);
+            size >>= 8;
+        }
+    }
+    memcpy(buf + offset, key.c_str(), key.size());
+    EncodeKeyTs(format, ts, buf + offset + key.size());
     return result;
 }
 
-static inline std::string CombineKeyTs(const std::string& key, uint64_t ts, uint32_t ts_pos) {
+static inline std::string CombineKeyTs(KeyFormat format, const std::string& key, uint64_t ts, uint32_t ts_pos) {
+    uint32_t offset = KeyPkOffset(format);
     std::string result;
-    result.resize(key.size() + TS_LEN + TS_POS_LEN);
+    result.resize(offset + key.size() + TS_LEN + TS_POS_LEN);
     char* buf = reinterpret_cast<char*>(&(result[0]));
-    memrev64ifbe(static_cast<void*>(&ts));
-    memcpy(buf, key.c_str(), key.size());
-    memcpy(buf + key.size(), static_cast<void*>(&ts_pos), TS_POS_LEN);
-    memcpy(buf + key.size() + TS_POS_LEN, static_cast<void*>(&ts), TS_LEN);
+    if (format == KeyFormat::kBytewise) {
+        uint32_t size = key.size();
+        for (int i = KEY_SIZE_LEN - 1; i >= 0; i--) {
+            buf[i] = static_cast<char>(size & 0xff);
+            size >>= 8;
+        }
+    }
+    memcpy(buf + offset, key.c_str(), key.size());
+    memcpy(buf + offset + key.size(), static_cast<void*>(&ts_pos), TS_POS_LEN);
+    EncodeKeyTs(format, ts, buf + offset + key.size() + TS_POS_LEN);
+    return result;
+}
+
+// the expire time goes first, the row of UINT64_MAX never expires
+static inline std::string CombineRowRef(uint64_t expire_time, uint64_t row_id) {
+    std::string result;
+    result.resize(ROW_REF_LEN);
+    char* buf = reinterpret_cast<char*>(&(result[0]));
+    memrev64ifbe(static_cast<void*>(&expire_time));
+    memrev64ifbe(static_cast<void*>(&row_id));
+    memcpy(buf, static_cast<void*>(&expire_time), sizeof(uint64_t));
+    memcpy(buf + sizeof(uint64_t), static_cast<void*>(&row_id), sizeof(uint64_t));
     return result;
 }
 
+// the comparator of the keys of KeyFormat::kKeyTs, the keys of kBytewise use the default bytewise one
 class KeyTSComparator : public rocksdb::Comparator {
  public:
     KeyTSComparator() {}
     const char* Name() const override { return "KeyTSComparator"; }
 
     int Compare(const rocksdb::Slice& a, const rocksdb::Slice& b) const override {
-        std::string key1, key2;
-        uint64_t ts1 = 0, ts2 = 0;
-        ParseKeyAndTs(a, key1, ts1);
-        ParseKeyAndTs(b, key2, ts2);
-
+        // the keys are compared in place instead of being parsed into strings
+        rocksdb::Slice key1(a.data(), a.size() >= TS_LEN ? a.size() - TS_LEN : 0);
+        rocksdb::Slice key2(b.data(), b.size() >= TS_LEN ? b.size() - TS_LEN : 0);
         int ret = key1.compare(key2);
         if (ret != 0) {
             return ret;
-        } else {
-            if (ts1 > ts2) return -1;
-            if (ts1 < ts2) return 1;
-            return 0;
         }
+        uint64_t ts1 = a.size() >= TS_LEN ? DecodeKeyTs(KeyFormat::kKeyTs, a.data() + a.size() - TS_LEN) : 0;
+        uint64_t ts2 = b.size() >= TS_LEN ? DecodeKeyTs(KeyFormat::kKeyTs, b.data() + b.size() - TS_LEN) : 0;
+        if (ts1 > ts2) return -1;
+        if (ts1 < ts2) return 1;
+        return 0;
     }
     void FindShortestSeparator(std::string* /*start*/, const rocksdb::Slice& /*limit*/) const override {}
     void FindShortSuccessor(std::string* /*key*/) const override {}
@@ -145,17 +221,36 @@ class KeyTsPrefixTransform : public rocksdb::SliceTransform {
 
 class AbsoluteTTLCompactionFilter : public rocksdb::CompactionFilter {
  public:
-    explicit AbsoluteTTLCompactionFilter(std::shared_ptr<InnerIndexSt> inner_index) : inner_index_(inner_index) {}
+    AbsoluteTTLCompactionFilter(std::shared_ptr<InnerIndexSt> inner_index, KeyFormat key_format)
+        : inner_index_(inner_index), key_format_(key_format) {}
     virtual ~AbsoluteTTLCompactionFilter() {}
 
     const char* Name() const override { return "AbsoluteTTLCompactionFilter"; }
 
     bool Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& /*existing_value*/,
                 std::string* /*new_value*/, bool* /*value_changed*/) const override {
+        TTLSt ttl;
+        if (!GetTTL(key, &ttl)) {
+            return false;
+        }
+        uint64_t real_ttl = ttl.abs_ttl;
+        if (real_ttl < 1) {
+            return false;
+        }
+        uint64_t ts = GetTs(key);
+        uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+        if (ts < cur_time - real_ttl) {
+            return true;
+        }
+        return false;
+    }
+
+ protected:
+    // the ttl of the index which the key belongs to
+    bool GetTTL(const rocksdb::Slice& key, TTLSt* ttl) const {
         if (key.size() < TS_LEN) {
             return false;
         }
-        uint64_t real_ttl = 0;
         const auto& indexs = inner_index_->GetIndex();
         if (indexs.size() > 1) {
             if (key.size() < TS_LEN + TS_POS_LEN) {
@@ -163,52 +258,123 @@ class AbsoluteTTLCompactionFilter : public rocksdb::CompactionFilter {
             }
             uint32_t ts_idx = *((uint32_t*)(key.data() + key.size() - TS_LEN -  // NOLINT
                                           TS_POS_LEN));
-            bool has_found = false;
             for (const auto index : indexs) {
                 auto ts_col = index->GetTsColumn();
                 if (!ts_col) {
                     return false;
                 }
                 if (ts_col->GetId() == ts_idx) {
-                    real_ttl = index->GetTTL()->abs_ttl;
-                    has_found = true;
-                    break;
+                    *ttl = *index->GetTTL();
+                    return true;
                 }
             }
-            if (!has_found) {
-                return false;
-            }
-        } else {
-            real_ttl = indexs.front()->GetTTL()->abs_ttl;
+            return false;
         }
-        if (real_ttl < 1) {
+        *ttl = *indexs.front()->GetTTL();
+        return true;
+    }
+
+    uint64_t GetTs(const rocksdb::Slice& key) const {
+        return DecodeKeyTs(key_format_, key.data() + key.size() - TS_LEN);
+    }
+
+ private:
+    std::shared_ptr<InnerIndexSt> inner_index_;
+    KeyFormat key_format_;
+};
+
+// TTLCompactionFilter drops the rows expired by any ttl type inside the compaction, so the disk table needs no
+// scan to gc. The rows come in the order of KeyTSComparator, i.e. the rows of one key and ts index are adjacent
+// and the latest first, so the rows beyond the latest N are found by counting the rows of the current key.
+// Only the rows in the compaction are counted, a key keeps more than N rows until its rows are compacted together.
+// A filter is created for every compaction, which runs it in one thread.
+class TTLCompactionFilter : public AbsoluteTTLCompactionFilter {
+ public:
+    TTLCompactionFilter(std::shared_ptr<InnerIndexSt> inner_index, KeyFormat key_format)
+        : AbsoluteTTLCompactionFilter(inner_index, key_format),
+          cur_time_(::baidu::common::timer::get_micros() / 1000) {}
+
+    const char* Name() const override { return "TTLCompactionFilter"; }
+
+    bool Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& /*existing_value*/,
+                std::string* /*new_value*/, bool* /*value_changed*/) const override {
+        TTLSt ttl;
+        if (!GetTTL(key, &ttl) || !ttl.NeedGc()) {
             return false;
         }
-        uint64_t ts = 0;
-        memcpy(static_cast<void*>(&ts), key.data() + key.size() - TS_LEN, TS_LEN);
-        memrev64ifbe(static_cast<void*>(&ts));
-        uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
-        if (ts < cur_time - real_ttl) {
-            return true;
+        // the key without ts, including the ts index if any
+        rocksdb::Slice prefix(key.data(), key.size() - TS_LEN);
+        if (prefix != rocksdb::Slice(last_prefix_)) {
+            last_prefix_.assign(prefix.data(), prefix.size());
+            record_idx_ = 0;
         }
-        return false;
+        uint64_t ts = GetTs(key);
+        // the rows of ts 0 are not counted as DiskTable::GcHead does
+        uint32_t record_idx = 0;
+        if (ts != 0) {
+            record_idx = ++record_idx_;
+        }
+        uint64_t expire_time = 0;
+        if (ttl.abs_ttl > 0 && ttl.ttl_type != TTLType::kLatestTime && cur_time_ > ttl.abs_ttl) {
+            expire_time = cur_time_ - ttl.abs_ttl;
+        }
+        TTLSt expire_value(expire_time, ttl.lat_ttl, ttl.ttl_type);
+        // the rows before the expire time are expired, the one at the expire time is kept
+        return expire_value.IsExpired(ts + 1, record_idx);
     }
 
  private:
-    std::shared_ptr<InnerIndexSt> inner_index_;
+    uint64_t cur_time_;
+    mutable std::string last_prefix_;
+    mutable uint32_t record_idx_ = 0;
 };
 
-class AbsoluteTTLFilterFactory : public rocksdb::CompactionFilterFactory {
+class TTLFilterFactory : public rocksdb::CompactionFilterFactory {
  public:
-    explicit AbsoluteTTLFilterFactory(const std::shared_ptr<InnerIndexSt>& inner_index) : inner_index_(inner_index) {}
+    TTLFilterFactory(const std::shared_ptr<InnerIndexSt>& inner_index, KeyFormat key_format)
+        : inner_index_(inner_index), key_format_(key_format) {}
     std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
         const rocksdb::CompactionFilter::Context& context) override {
-        return std::unique_ptr<rocksdb::CompactionFilter>(new AbsoluteTTLCompactionFilter(inner_index_));
+        return std::unique_ptr<rocksdb::CompactionFilter>(new TTLCompactionFilter(inner_index_, key_format_));
     }
-    const char* Name() const override { return "AbsoluteTTLFilterFactory"; }
+    const char* Name() const override { return "TTLFilterFactory"; }
 
  private:
     std::shared_ptr<InnerIndexSt> inner_index_;
+    KeyFormat key_format_;
+};
+
+// RowStoreCompactionFilter drops the rows of the row store by the expire time in their keys, which is the latest
+// one of the index entries referring to the row
+class RowStoreCompactionFilter : public rocksdb::CompactionFilter {
+ public:
+    explicit RowStoreCompactionFilter(uint64_t cur_time) : cur_time_(cur_time) {}
+
+    const char* Name() const override { return "RowStoreCompactionFilter"; }
+
+    bool Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& /*existing_value*/,
+                std::string* /*new_value*/, bool* /*value_changed*/) const override {
+        if (key.size() < ROW_REF_LEN) {
+            return false;
+        }
+        uint64_t expire_time = 0;
+        memcpy(static_cast<void*>(&expire_time), key.data(), sizeof(uint64_t));
+        memrev64ifbe(static_cast<void*>(&expire_time));
+        return expire_time < cur_time_;
+    }
+
+ private:
+    uint64_t cur_time_;
+};
+
+class RowStoreFilterFactory : public rocksdb::CompactionFilterFactory {
+ public:
+    std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
+        const rocksdb::CompactionFilter::Context& context) override {
+        return std::unique_ptr<rocksdb::CompactionFilter>(
+            new RowStoreCompactionFilter(::baidu::common::timer::get_micros() / 1000));
+    }
+    const char* Name() const override { return "RowStoreFilterFactory"; }
 };
 
 class DiskTableIterator : public TableIterator {
@@ -225,6 +391,10 @@ class DiskTableIterator : public TableIterator {
     void SeekToFirst() override;
     void Seek(uint64_t time) override;
 
+    // the entries hold the references of the rows in row_handle
+    void SetRowStore(rocksdb::ColumnFamilyHandle* row_handle) { row_handle_ = row_handle; }
+    void SetKeyFormat(KeyFormat key_format) { key_format_ = key_format; }
+
  private:
     rocksdb::DB* db_;
     rocksdb::Iterator* it_;
@@ -233,6 +403,11 @@ class DiskTableIterator : public TableIterator {
     uint64_t ts_;
     uint32_t ts_idx_;
     bool has_ts_idx_ = false;
+    KeyFormat key_format_ = KeyFormat::kKeyTs;
+    rocksdb::ColumnFamilyHandle* row_handle_ = nullptr;
+    // the row of the current entry read from the row store
+    std::string row_;
+    bool row_valid_ = false;
 };
 
 class DiskTableTraverseIterator : public TraverseIterator {
@@ -254,6 +429,10 @@ class DiskTableTraverseIterator : public TraverseIterator {
     void Seek(const std::string& pk, uint64_t time) override;
     uint64_t GetCount() const override;
 
+    // the entries hold the references of the rows in row_handle
+    void SetRowStore(rocksdb::ColumnFamilyHandle* row_handle) { row_handle_ = row_handle; }
+    void SetKeyFormat(KeyFormat key_format) { key_format_ = key_format; }
+
  private:
     bool IsExpired();
 
@@ -268,6 +447,11 @@ class DiskTableTraverseIterator : public TraverseIterator {
     bool has_ts_idx_;
     uint32_t ts_idx_;
     uint64_t traverse_cnt_;
+    KeyFormat key_format_ = KeyFormat::kKeyTs;
+    rocksdb::ColumnFamilyHandle* row_handle_ = nullptr;
+    // the row of the current entry read from the row store
+    std::string row_;
+    bool row_valid_ = false;
 };
 
 class DiskTableRowIterator : public ::hybridse::vm::RowIterator {
@@ -276,6 +460,13 @@ class DiskTableRowIterator : public ::hybridse::vm::RowIterator {
                          ::openmldb::storage::TTLType ttl_type, uint64_t expire_time, uint64_t expire_cnt,
                          std::string pk, uint64_t ts, bool has_ts_idx, uint32_t ts_idx);
 
+    // serve the rows from the cached entry first, the rows older than the entry are read from disk by an
+    // iterator created on demand
+    DiskTableRowIterator(rocksdb::DB* db, rocksdb::ColumnFamilyHandle* column_handle,
+                         std::shared_ptr<const DiskRowCache::Entry> cached, ::openmldb::storage::TTLType ttl_type,
+                         uint64_t expire_time, uint64_t expire_cnt, std::string pk, bool has_ts_idx,
+                         uint32_t ts_idx);
+
     ~DiskTableRowIterator();
 
     bool Valid() const override;
@@ -290,8 +481,26 @@ class DiskTableRowIterator : public ::hybridse::vm::RowIterator {
     void SeekToFirst() override;
     inline bool IsSeekable() const override;
 
+    // the entries hold the references of the rows in row_handle, the rows are read from disk in batches
+    void SetRowStore(rocksdb::ColumnFamilyHandle* row_handle) { row_handle_ = row_handle; }
+    void SetKeyFormat(KeyFormat key_format) { key_format_ = key_format; }
+
+ private:
+    void SeekDisk(uint64_t key);
+
+    // read the batch of rows from key on into cached_ by one MultiGet on the row store
+    void LoadRows(uint64_t key);
+
  private:
     rocksdb::DB* db_;
+    rocksdb::ColumnFamilyHandle* column_handle_;
+    rocksdb::ColumnFamilyHandle* row_handle_;
+    std::shared_ptr<const DiskRowCache::Entry> cached_;
+    // the ts the cached rows are read from, UINT64_MAX if they are the most recent rows
+    uint64_t cached_from_;
+    // the position in the cached rows, the rows are read from it_ once it reaches the end
+    uint32_t cached_pos_;
+    bool in_cache_;
     rocksdb::Iterator* it_;
     const rocksdb::Snapshot* snapshot_;
     uint32_t record_idx_;
@@ -303,6 +512,7 @@ class DiskTableRowIterator : public ::hybridse::vm::RowIterator {
     uint32_t ts_idx_;
     ::hybridse::codec::Row row_;
     bool pk_valid_;
+    KeyFormat key_format_ = KeyFormat::kKeyTs;
 };
 
 class DiskTableKeyIterator : public ::hybridse::vm::WindowIterator {
@@ -330,8 +540,19 @@ class DiskTableKeyIterator : public ::hybridse::vm::WindowIterator {
 
     const hybridse::codec::Row GetKey() override;
 
+    // the rows of the keys are served from `row_cache` and filled into it on miss
+    void SetRowCache(std::shared_ptr<DiskRowCache> row_cache, uint32_t cf) {
+        row_cache_ = row_cache;
+        cf_ = cf;
+    }
+
+    // the entries hold the references of the rows in row_handle
+    void SetRowStore(rocksdb::ColumnFamilyHandle* row_handle) { row_handle_ = row_handle; }
+    void SetKeyFormat(KeyFormat key_format) { key_format_ = key_format; }
+
  private:
     void NextPK();
+    std::shared_ptr<const DiskRowCache::Entry> GetCachedRows();
 
  private:
     rocksdb::DB* db_;
@@ -345,6 +566,10 @@ class DiskTableKeyIterator : public ::hybridse::vm::WindowIterator {
     uint64_t ts_;
     uint32_t ts_idx_;
     rocksdb::ColumnFamilyHandle* column_handle_;
+    std::shared_ptr<DiskRowCache> row_cache_;
+    uint32_t cf_;
+    rocksdb::ColumnFamilyHandle* row_handle_ = nullptr;
+    KeyFormat key_format_ = KeyFormat::kKeyTs;
 };
 
 class DiskTable : public Table {
@@ -369,6 +594,10 @@ class DiskTable : public Table {
 
     bool Put(uint64_t time, const std::string& value, const Dimensions& dimensions) override;
 
+    // load the rows without going through the memtable of rocksdb. the entries of every column family are sorted
+    // by KeyTSComparator, written to a sst file and ingested into the db. the later row of the same key and ts wins
+    virtual bool BulkLoad(const std::vector<const ::openmldb::api::PutRequest*>& rows);
+
     bool Get(uint32_t idx, const std::string& pk, uint64_t ts,
              std::string& value);  // NOLINT
 
@@ -403,8 +632,6 @@ class DiskTable : public Table {
     void SchedGc() override;
 
     void GcHead();
-    void GcTTLAndHead();
-    void GcTTLOrHead();
 
     bool IsExpire(const ::openmldb::api::LogEntry& entry) override;
 
@@ -425,15 +652,52 @@ class DiskTable : public Table {
 
     int GetCount(uint32_t index, const std::string& pk, uint64_t& count) override; // NOLINT
 
+    // the rows are kept once in the row store instead of once per index
+    bool HasRowStore() const { return row_handle_ != nullptr; }
+
+    KeyFormat GetKeyFormat() const { return key_format_; }
+
+    // copy the checkpoint of the table in src_dir to dest_dir with the keys of the indexes rewritten to
+    // KeyFormat::kBytewise, so the table is loaded in the new format from a snapshot made of dest_dir
+    bool RewriteCheckPoint(const std::string& src_dir, const std::string& dest_dir);
+
  private:
+    // get the column family and the combined key of each entry of the row, and raise expire_time to the latest
+    // expire time of the entries if it is not nullptr
+    bool GetCombineKeys(uint64_t time, const std::string& value, const Dimensions& dimensions,
+                        std::vector<std::pair<uint32_t, std::string>>* cf_keys, uint64_t* expire_time = nullptr);
+
+    // the time the entry of ts expires at by ttl, UINT64_MAX if never. Return false if the entry may outlive
+    // any time, i.e. it is expired by the count of the latest rows only
+    static bool GetExpireTime(const TTLSt& ttl, uint64_t ts, uint64_t* expire_time);
+
+    // a new key of the row store
+    std::string NewRowRef(uint64_t expire_time) {
+        return CombineRowRef(expire_time, row_id_.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    // invalidate the cached rows of the key of `combine_key` in the column family `cf`
+    void InvalidateRowCache(uint32_t cf, const std::string& combine_key) {
+        if (row_cache_ && combine_key.size() >= TS_LEN) {
+            row_cache_->Invalidate(cf, rocksdb::Slice(combine_key.data(), combine_key.size() - TS_LEN));
+        }
+    }
+
     rocksdb::DB* db_;
     rocksdb::WriteOptions write_opts_;
     std::vector<rocksdb::ColumnFamilyDescriptor> cf_ds_;
     std::vector<rocksdb::ColumnFamilyHandle*> cf_hs_;
     rocksdb::Options options_;
     KeyTSComparator cmp_;
+    // the format of the keys of the index column families, kept in KEY_FORMAT_FILE of the data dir
+    KeyFormat key_format_;
     std::atomic<uint64_t> offset_;
     std::string table_path_;
+    std::atomic<uint64_t> sst_file_id_;
+    std::shared_ptr<DiskRowCache> row_cache_;
+    // the column family of the rows if the table has the single_row_store option, the last one of cf_hs_
+    rocksdb::ColumnFamilyHandle* row_handle_;
+    std::atomic<uint64_t> row_id_;
 };
 
 }  // namespace storage
@@ -25,6 +25,8 @@
 #include "base/glog_wapper.h"  // NOLINT
 #include "base/strings.h"
 
+DECLARE_bool(disk_table_bytewise_key);
+
 namespace openmldb {
 namespace storage {
 
@@ -86,6 +88,21 @@ int DiskTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_
             PDLOG(WARNING, "create checkpoint failed. checkpoint dir[%s]", snapshot_dir_tmp.c_str());
             break;
         }
+        if (FLAGS_disk_table_bytewise_key && disk_table->GetKeyFormat() == KeyFormat::kKeyTs) {
+            // the table loads the rewritten keys from the snapshot at its next load
+            std::string rewrite_dir = snapshot_dir_tmp + ".rewrite";
+            if (disk_table->RewriteCheckPoint(snapshot_dir_tmp, rewrite_dir)) {
+                if (!::openmldb::base::RemoveDir(snapshot_dir_tmp) ||
+                    !::openmldb::base::Rename(rewrite_dir, snapshot_dir_tmp)) {
+                    PDLOG(WARNING, "replace checkpoint with the rewritten one failed. checkpoint dir[%s]",
+                          snapshot_dir_tmp.c_str());
+                    break;
+                }
+            } else {
+                PDLOG(WARNING, "rewrite checkpoint failed, keep the legacy keys. checkpoint dir[%s]",
+                      snapshot_dir_tmp.c_str());
+            }
+        }
         if (::openmldb::base::IsExists(snapshot_dir)) {
             std::string snapshot_dir_bak = snapshot_dir + ".bak";
             if (::openmldb::base::IsExists(snapshot_dir_bak)) {
@@ -33,6 +33,9 @@ DECLARE_string(ssd_root_path);
 DECLARE_string(hdd_root_path);
 DECLARE_uint32(max_traverse_cnt);
 DECLARE_int32(gc_safe_offset);
+DECLARE_string(disk_table_filter_type);
+DECLARE_uint32(disk_table_row_cache_keys);
+DECLARE_uint32(disk_table_row_cache_rows);
 
 namespace openmldb {
 namespace storage {
@@ -56,27 +59,56 @@ class DiskTableTest : public ::testing::Test {
 };
 
 TEST_F(DiskTableTest, ParseKeyAndTs) {
-    std::string combined_key = CombineKeyTs("abcdexxx11", 1552619498000);
+    std::string combined_key = CombineKeyTs(KeyFormat::kKeyTs, "abcdexxx11", 1552619498000);
     std::string key;
     uint64_t ts;
-    ASSERT_EQ(0, ParseKeyAndTs(combined_key, key, ts));
+    ASSERT_EQ(0, ParseKeyAndTs(KeyFormat::kKeyTs, combined_key, key, ts));
     ASSERT_EQ("abcdexxx11", key);
     ASSERT_EQ(1552619498000, (int64_t)ts);
-    combined_key = CombineKeyTs("abcdexxx11", 1);
-    ASSERT_EQ(0, ParseKeyAndTs(combined_key, key, ts));
+    combined_key = CombineKeyTs(KeyFormat::kKeyTs, "abcdexxx11", 1);
+    ASSERT_EQ(0, ParseKeyAndTs(KeyFormat::kKeyTs, combined_key, key, ts));
     ASSERT_EQ("abcdexxx11", key);
     ASSERT_EQ(1, (int64_t)ts);
-    combined_key = CombineKeyTs("0", 0);
-    ASSERT_EQ(0, ParseKeyAndTs(combined_key, key, ts));
+    combined_key = CombineKeyTs(KeyFormat::kKeyTs, "0", 0);
+    ASSERT_EQ(0, ParseKeyAndTs(KeyFormat::kKeyTs, combined_key, key, ts));
     ASSERT_EQ("0", key);
     ASSERT_EQ(0, (int64_t)ts);
-    ASSERT_EQ(-1, ParseKeyAndTs("abc", key, ts));
-    combined_key = CombineKeyTs("", 1122);
-    ASSERT_EQ(0, ParseKeyAndTs(combined_key, key, ts));
+    ASSERT_EQ(-1, ParseKeyAndTs(KeyFormat::kKeyTs, "abc", key, ts));
+    combined_key = CombineKeyTs(KeyFormat::kKeyTs, "", 1122);
+    ASSERT_EQ(0, ParseKeyAndTs(KeyFormat::kKeyTs, combined_key, key, ts));
     ASSERT_TRUE(key.empty());
     ASSERT_EQ(1122, (int64_t)ts);
 }
 
+TEST_F(DiskTableTest, BytewiseKey) {
+    std::string key;
+    uint64_t ts = 0;
+    uint32_t ts_idx = 0;
+    std::string combined_key = CombineKeyTs(KeyFormat::kBytewise, "abcdexxx11", 1552619498000);
+    ASSERT_EQ(0, ParseKeyAndTs(KeyFormat::kBytewise, combined_key, key, ts));
+    ASSERT_EQ("abcdexxx11", key);
+    ASSERT_EQ(1552619498000, (int64_t)ts);
+    combined_key = CombineKeyTs(KeyFormat::kBytewise, "", 0, 3);
+    ASSERT_EQ(0, ParseKeyAndTs(KeyFormat::kBytewise, true, combined_key, key, ts, ts_idx));
+    ASSERT_TRUE(key.empty());
+    ASSERT_EQ(0, (int64_t)ts);
+    ASSERT_EQ(3u, ts_idx);
+    ASSERT_EQ(-1, ParseKeyAndTs(KeyFormat::kBytewise, "abc", key, ts));
+
+    // the keys sort bytewise as the custom comparator sorts the legacy keys, a larger ts of a key goes first and
+    // the keys of "a" and "ab" do not interleave
+    const rocksdb::Comparator* cmp = rocksdb::BytewiseComparator();
+    ASSERT_LT(cmp->Compare(CombineKeyTs(KeyFormat::kBytewise, "a", 10), CombineKeyTs(KeyFormat::kBytewise, "a", 9)),
+              0);
+    ASSERT_LT(cmp->Compare(CombineKeyTs(KeyFormat::kBytewise, "a", 1), CombineKeyTs(KeyFormat::kBytewise, "ab", 10)),
+              0);
+    ASSERT_LT(cmp->Compare(CombineKeyTs(KeyFormat::kBytewise, "ab", 1), CombineKeyTs(KeyFormat::kBytewise, "b", 10)),
+              0);
+    ASSERT_LT(cmp->Compare(CombineKeyTs(KeyFormat::kBytewise, "a", 1, 1),
+                           CombineKeyTs(KeyFormat::kBytewise, "a", 10, 2)),
+              0);
+}
+
 TEST_F(DiskTableTest, Put) {
     std::map<std::string, uint32_t> mapping;
     mapping.insert(std::make_pair("idx0", 0));
@@ -277,6 +309,75 @@ TEST_F(DiskTableTest, MultiDimensionPut) {
     RemoveData(table_path);
 }
 
+TEST_F(DiskTableTest, BulkLoad) {
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    mapping.insert(std::make_pair("idx1", 1));
+    std::string table_path = FLAGS_hdd_root_path + "/30_1";
+    DiskTable* table = new DiskTable("bulk_load", 30, 1, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime,
+                                     ::openmldb::common::StorageMode::kHDD, table_path);
+    ASSERT_TRUE(table->Init());
+    auto meta = ::openmldb::test::GetTableMeta({"idx0", "idx1"});
+    ::openmldb::codec::SDKCodec sdk_codec(meta);
+    // an existing row is kept after the sst is ingested
+    Dimensions dimensions;
+    auto dim = dimensions.Add();
+    dim->set_key("key0");
+    dim->set_idx(0);
+    std::string value;
+    ASSERT_EQ(0, sdk_codec.EncodeRow({"key0", "old"}, &value));
+    ASSERT_TRUE(table->Put(100, value, dimensions));
+
+    // the rows are not sorted, and the last row of the same key and ts wins
+    std::vector<::openmldb::api::PutRequest> requests(10);
+    std::vector<const ::openmldb::api::PutRequest*> rows;
+    for (uint32_t i = 0; i < requests.size(); i++) {
+        auto& request = requests[i];
+        std::string key = "key" + std::to_string(i % 2);
+        std::string col1 = "value" + std::to_string(i);
+        auto d0 = request.add_dimensions();
+        d0->set_key(key);
+        d0->set_idx(0);
+        auto d1 = request.add_dimensions();
+        d1->set_key(col1);
+        d1->set_idx(1);
+        ASSERT_EQ(0, sdk_codec.EncodeRow({key, col1}, request.mutable_value()));
+        request.set_time(i < 8 ? 10 - i : 10);
+        rows.push_back(&request);
+    }
+    ASSERT_TRUE(table->BulkLoad(rows));
+
+    Ticket ticket;
+    TableIterator* it = table->NewIterator(0, "key0", ticket);
+    it->SeekToFirst();
+    std::vector<uint64_t> ts_vec;
+    std::vector<std::string> col_vec;
+    while (it->Valid()) {
+        ts_vec.push_back(it->GetKey());
+        std::string row_value = it->GetValue().ToString();
+        std::string col;
+        auto decoder = table->GetVersionDecoder(codec::RowView::GetSchemaVersion(
+            reinterpret_cast<const int8_t*>(row_value.data())));
+        decoder->GetStrValue(reinterpret_cast<const int8_t*>(row_value.data()), 1, &col);
+        col_vec.push_back(col);
+        it->Next();
+    }
+    delete it;
+    ASSERT_EQ(std::vector<uint64_t>({100, 10, 8, 6, 4}), ts_vec);
+    ASSERT_EQ(std::vector<std::string>({"old", "value8", "value2", "value4", "value6"}), col_vec);
+
+    it = table->NewIterator(1, "value9", ticket);
+    it->SeekToFirst();
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ(10, (int64_t)it->GetKey());
+    it->Next();
+    ASSERT_FALSE(it->Valid());
+    delete it;
+
+    delete table;
+    RemoveData(table_path);
+}
+
 TEST_F(DiskTableTest, LongPut) {
     std::map<std::string, uint32_t> mapping;
     mapping.insert(std::make_pair("idx0", 0));
@@ -387,6 +488,52 @@ TEST_F(DiskTableTest, Delete) {
     RemoveData(table_path);
 }
 
+TEST_F(DiskTableTest, PrefixFilter) {
+    std::string old_filter_type = FLAGS_disk_table_filter_type;
+    for (const std::string filter_type : {"bloom", "ribbon"}) {
+        FLAGS_disk_table_filter_type = filter_type;
+        std::map<std::string, uint32_t> mapping;
+        mapping.insert(std::make_pair("idx0", 0));
+        std::string table_path = FLAGS_ssd_root_path + "/31_1";
+        DiskTable* table = new DiskTable("t1", 31, 1, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime,
+                                         ::openmldb::common::StorageMode::kSSD, table_path);
+        ASSERT_TRUE(table->Init());
+        for (int idx = 0; idx < 100; idx += 2) {
+            std::string key = "test" + std::to_string(idx);
+            for (int k = 0; k < 10; k++) {
+                ASSERT_TRUE(table->Put(key, 9537 + k, "value", 5));
+            }
+        }
+        // the rows are in the sst files with filters
+        table->CompactDB();
+        Ticket ticket;
+        for (int idx = 0; idx < 100; idx++) {
+            TableIterator* it = table->NewIterator("test" + std::to_string(idx), ticket);
+            it->SeekToFirst();
+            int count = 0;
+            while (it->Valid()) {
+                count++;
+                it->Next();
+            }
+            ASSERT_EQ(idx % 2 == 0 ? 10 : 0, count) << filter_type << " " << idx;
+            delete it;
+        }
+        // the seeks across the keys are not filtered
+        TableIterator* it = table->NewTraverseIterator(0);
+        it->Seek("test1", 9540);
+        int count = 0;
+        while (it->Valid()) {
+            count++;
+            it->Next();
+        }
+        ASSERT_EQ(490, count) << filter_type;
+        delete it;
+        delete table;
+        RemoveData(table_path);
+    }
+    FLAGS_disk_table_filter_type = old_filter_type;
+}
+
 TEST_F(DiskTableTest, TraverseIterator) {
     std::map<std::string, uint32_t> mapping;
     mapping.insert(std::make_pair("idx0", 0));
@@ -784,6 +931,123 @@ TEST_F(DiskTableTest, CompactFilter) {
     RemoveData(table_path);
 }
 
+TEST_F(DiskTableTest, ResourceQuota) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(32);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kSSD);
+    table_meta.set_format_version(1);
+    table_meta.set_block_cache_mb(16);
+    table_meta.set_compaction_rate_limit_mb(64);
+    table_meta.set_filter_bits_per_key(0);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+
+    std::string table_path = FLAGS_ssd_root_path + "/32_1";
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+    for (int idx = 0; idx < 100; idx++) {
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card" + std::to_string(idx));
+        dim->set_idx(0);
+        for (int i = 0; i < 10; i++) {
+            std::vector<std::string> row = {"card" + std::to_string(idx), std::to_string(1000 + i)};
+            std::string value;
+            ASSERT_EQ(0, codec.EncodeRow(row, &value));
+            ASSERT_TRUE(table->Put(1000 + i, value, dims));
+        }
+    }
+    table->CompactDB();
+    Ticket ticket;
+    TableIterator* iter = table->NewIterator(0, "card50", ticket);
+    iter->SeekToFirst();
+    int count = 0;
+    while (iter->Valid()) {
+        count++;
+        iter->Next();
+    }
+    ASSERT_EQ(10, count);
+    delete iter;
+    delete table;
+    RemoveData(table_path);
+}
+
+TEST_F(DiskTableTest, RowCache) {
+    uint32_t old_cache_keys = FLAGS_disk_table_row_cache_keys;
+    uint32_t old_cache_rows = FLAGS_disk_table_row_cache_rows;
+    FLAGS_disk_table_row_cache_keys = 16;
+    FLAGS_disk_table_row_cache_rows = 4;
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(33);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kSSD);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+
+    std::string table_path = FLAGS_ssd_root_path + "/33_1";
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+    auto put = [&](const std::string& key, uint64_t ts) {
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key(key);
+        dim->set_idx(0);
+        std::vector<std::string> row = {key, std::to_string(ts)};
+        std::string value;
+        ASSERT_EQ(0, codec.EncodeRow(row, &value));
+        ASSERT_TRUE(table->Put(ts, value, dims));
+    };
+    for (int i = 0; i < 10; i++) {
+        put("card0", 1000 + i);
+        put("card1", 1000 + i);
+    }
+    // the first rows are served from cache and the older ones from disk
+    auto check_window = [&](const std::string& key, uint64_t max_ts, int cnt) {
+        std::unique_ptr<::hybridse::vm::WindowIterator> it(table->NewWindowIterator(0));
+        it->Seek(key);
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ(key, it->GetKey().ToString());
+        auto row_it = it->GetValue();
+        row_it->SeekToFirst();
+        int count = 0;
+        while (row_it->Valid()) {
+            ASSERT_EQ(max_ts - count, row_it->GetKey());
+            codec::RowView view(table_meta.column_desc());
+            ASSERT_TRUE(view.Reset(reinterpret_cast<const int8_t*>(row_it->GetValue().buf()),
+                                   row_it->GetValue().size()));
+            int64_t ts = 0;
+            ASSERT_EQ(0, view.GetInt64(1, &ts));
+            ASSERT_EQ(max_ts - count, static_cast<uint64_t>(ts));
+            count++;
+            row_it->Next();
+        }
+        ASSERT_EQ(cnt, count);
+        row_it->Seek(1007);
+        ASSERT_TRUE(row_it->Valid());
+        ASSERT_EQ(1007u, row_it->GetKey());
+        row_it->Seek(1001);
+        ASSERT_TRUE(row_it->Valid());
+        ASSERT_EQ(1001u, row_it->GetKey());
+    };
+    for (int round = 0; round < 2; round++) {
+        check_window("card0", 1009, 10);
+    }
+    // the cached rows of the key put are invalid
+    put("card0", 1010);
+    check_window("card0", 1010, 11);
+    check_window("card1", 1009, 10);
+    delete table;
+    RemoveData(table_path);
+    FLAGS_disk_table_row_cache_keys = old_cache_keys;
+    FLAGS_disk_table_row_cache_rows = old_cache_rows;
+}
+
 TEST_F(DiskTableTest, CompactFilterMulTs) {
     ::openmldb::api::TableMeta table_meta;
     table_meta.set_tid(11);
@@ -1025,6 +1289,7 @@ TEST_F(DiskTableTest, GcHeadMulTs) {
         }
     }
     table->SchedGc();
+    table->CompactDB();
     iter = table->NewIterator(0, "card0", ticket);
     iter->SeekToFirst();
     while (iter->Valid()) {
@@ -1072,6 +1337,59 @@ TEST_F(DiskTableTest, GcHeadMulTs) {
     RemoveData(table_path);
 }
 
+TEST_F(DiskTableTest, CompactionFilterAbsAndLat) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(16);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsOrLat, 10, 3);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts1", ::openmldb::type::kAbsAndLat, 10, 3);
+
+    std::string table_path = FLAGS_hdd_root_path + "/16_1";
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+
+    // 5 rows in the absolute ttl and 3 rows expired by it
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    std::vector<uint64_t> ts_vec;
+    for (int i = 0; i < 8; i++) {
+        ts_vec.push_back(i < 5 ? cur_time - i : cur_time - 20 * 60 * 1000 - i);
+    }
+    for (int idx = 0; idx < 10; idx++) {
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card" + std::to_string(idx));
+        dim->set_idx(0);
+        ::openmldb::api::Dimension* dim1 = dims.Add();
+        dim1->set_key("mcc" + std::to_string(idx));
+        dim1->set_idx(1);
+        for (auto ts : ts_vec) {
+            std::vector<std::string> row = {"card" + std::to_string(idx), "mcc" + std::to_string(idx),
+                                            std::to_string(ts)};
+            std::string value;
+            ASSERT_EQ(0, codec.EncodeRow(row, &value));
+            ASSERT_TRUE(table->Put(ts, value, dims));
+        }
+    }
+    table->SchedGc();
+    table->CompactDB();
+    for (int idx = 0; idx < 10; idx++) {
+        for (size_t i = 0; i < ts_vec.size(); i++) {
+            std::string value;
+            // abs or lat keeps the latest 3 rows, abs and lat keeps the rows in the absolute ttl too
+            ASSERT_EQ(i < 3, table->Get(0, "card" + std::to_string(idx), ts_vec[i], value));
+            ASSERT_EQ(i < 5, table->Get(1, "mcc" + std::to_string(idx), ts_vec[i], value));
+        }
+    }
+    delete table;
+    RemoveData(table_path);
+}
+
 TEST_F(DiskTableTest, GcHead) {
     std::map<std::string, uint32_t> mapping;
     mapping.insert(std::make_pair("idx0", 0));
@@ -1198,6 +1516,106 @@ TEST_F(DiskTableTest, CheckPoint) {
     RemoveData(table_path);
 }
 
+TEST_F(DiskTableTest, SingleRowStore) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(34);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kSSD);
+    table_meta.set_format_version(1);
+    table_meta.set_single_row_store(true);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+
+    std::string table_path = FLAGS_ssd_root_path + "/34_1";
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    ASSERT_TRUE(table->HasRowStore());
+    codec::SDKCodec codec(table_meta);
+    auto put = [&](const std::string& card, const std::string& mcc, uint64_t ts) {
+        Dimensions dims;
+        auto dim = dims.Add();
+        dim->set_key(card);
+        dim->set_idx(0);
+        dim = dims.Add();
+        dim->set_key(mcc);
+        dim->set_idx(1);
+        std::string value;
+        ASSERT_EQ(0, codec.EncodeRow({card, mcc, std::to_string(ts)}, &value));
+        ASSERT_TRUE(table->Put(ts, value, dims));
+    };
+    // more rows than a batch of the window
+    for (int i = 0; i < 150; i++) {
+        put("card0", "mcc" + std::to_string(i % 3), 1000 + i);
+    }
+    auto get_ts = [&](const void* data, uint32_t size) {
+        codec::RowView view(table_meta.column_desc());
+        EXPECT_TRUE(view.Reset(reinterpret_cast<const int8_t*>(data), size));
+        int64_t ts = 0;
+        view.GetInt64(2, &ts);
+        return static_cast<uint64_t>(ts);
+    };
+    // the entries of both indexes refer to the rows
+    Ticket ticket;
+    TableIterator* it = table->NewIterator(1, "mcc1", ticket);
+    it->SeekToFirst();
+    int count = 0;
+    while (it->Valid()) {
+        ASSERT_EQ(1000 + 148 - 3 * count, static_cast<int64_t>(it->GetKey()));
+        ASSERT_EQ(it->GetKey(), get_ts(it->GetValue().data(), it->GetValue().size()));
+        count++;
+        it->Next();
+    }
+    ASSERT_EQ(50, count);
+    delete it;
+
+    std::unique_ptr<::hybridse::vm::WindowIterator> window_it(table->NewWindowIterator(0));
+    window_it->Seek("card0");
+    ASSERT_TRUE(window_it->Valid());
+    auto row_it = window_it->GetValue();
+    row_it->SeekToFirst();
+    count = 0;
+    while (row_it->Valid()) {
+        ASSERT_EQ(1149u - count, row_it->GetKey());
+        ASSERT_EQ(1149u - count, get_ts(row_it->GetValue().buf(), row_it->GetValue().size()));
+        count++;
+        row_it->Next();
+    }
+    ASSERT_EQ(150, count);
+    row_it->Seek(1010);
+    ASSERT_TRUE(row_it->Valid());
+    ASSERT_EQ(1010u, get_ts(row_it->GetValue().buf(), row_it->GetValue().size()));
+    row_it->Seek(1120);
+    ASSERT_TRUE(row_it->Valid());
+    ASSERT_EQ(1120u, get_ts(row_it->GetValue().buf(), row_it->GetValue().size()));
+
+    it = table->NewTraverseIterator(1);
+    it->SeekToFirst();
+    count = 0;
+    while (it->Valid()) {
+        ASSERT_EQ(it->GetKey(), get_ts(it->GetValue().data(), it->GetValue().size()));
+        count++;
+        it->Next();
+    }
+    ASSERT_EQ(150, count);
+    delete it;
+    delete table;
+
+    // the rows are kept per index if the ttl doesn't bound them by time
+    table_meta.mutable_column_key(1)->mutable_ttl()->set_ttl_type(::openmldb::type::kLatestTime);
+    table_meta.mutable_column_key(1)->mutable_ttl()->set_lat_ttl(10);
+    std::string latest_path = FLAGS_ssd_root_path + "/34_2";
+    table_meta.set_pid(2);
+    table = new DiskTable(table_meta, latest_path);
+    ASSERT_TRUE(table->Init());
+    ASSERT_FALSE(table->HasRowStore());
+    delete table;
+    RemoveData(table_path);
+    RemoveData(latest_path);
+}
+
 }  // namespace storage
 }  // namespace openmldb
 
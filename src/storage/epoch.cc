@@ -0,0 +1,73 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/epoch.h"
+
+#include <atomic>
+
+namespace openmldb {
+namespace storage {
+
+// the readers of one slot are counted by the parity of the epoch they pin. only
+// the readers of the current and the previous epoch may exist, so the readers of
+// the parity other than the current epoch are all of the previous one
+struct alignas(64) EpochSlot {
+    std::atomic<uint64_t> readers[2];
+};
+
+static std::atomic<uint64_t> g_epoch(2);
+static EpochSlot g_slots[Epoch::kSlotCnt];
+static std::atomic<uint32_t> g_next_slot(0);
+
+uint64_t Epoch::Current() { return g_epoch.load(std::memory_order_seq_cst); }
+
+bool Epoch::TryAdvance() {
+    uint64_t cur = g_epoch.load(std::memory_order_seq_cst);
+    uint32_t prev = (cur - 1) & 1;
+    for (uint32_t i = 0; i < kSlotCnt; i++) {
+        if (g_slots[i].readers[prev].load(std::memory_order_seq_cst) > 0) {
+            return false;
+        }
+    }
+    return g_epoch.compare_exchange_strong(cur, cur + 1, std::memory_order_seq_cst);
+}
+
+uint64_t Epoch::GetReclaimable() { return Current() - 2; }
+
+uint32_t Epoch::GetSlot() {
+    static thread_local uint32_t slot = g_next_slot.fetch_add(1, std::memory_order_relaxed) % kSlotCnt;
+    return slot;
+}
+
+uint64_t Epoch::Pin(uint32_t slot) {
+    while (true) {
+        uint64_t epoch = g_epoch.load(std::memory_order_seq_cst);
+        g_slots[slot].readers[epoch & 1].fetch_add(1, std::memory_order_seq_cst);
+        // the epoch may be advanced before the reader is counted, then TryAdvance
+        // can't see it and the reader must pin the new epoch
+        if (g_epoch.load(std::memory_order_seq_cst) == epoch) {
+            return epoch;
+        }
+        g_slots[slot].readers[epoch & 1].fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+void Epoch::Unpin(uint32_t slot, uint64_t epoch) {
+    g_slots[slot].readers[epoch & 1].fetch_sub(1, std::memory_order_seq_cst);
+}
+
+}  // namespace storage
+}  // namespace openmldb
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_EPOCH_H_
+#define SRC_STORAGE_EPOCH_H_
+
+#include <stdint.h>
+
+namespace openmldb {
+namespace storage {
+
+// Epoch based reclamation for the memory removed from segments. The readers pin
+// the global epoch with EpochGuard, and the memory retired in epoch e can be
+// freed once the global epoch reaches e + 2, as no reader that may see it is left.
+class Epoch {
+ public:
+    static constexpr uint32_t kSlotCnt = 64;
+
+    static uint64_t Current();
+
+    // advance the global epoch by one if no reader of the previous epoch is left
+    static bool TryAdvance();
+
+    // the memory retired in the epoch no greater than it can be freed
+    static uint64_t GetReclaimable();
+
+ private:
+    friend class EpochGuard;
+
+    static uint32_t GetSlot();
+    static uint64_t Pin(uint32_t slot);
+    static void Unpin(uint32_t slot, uint64_t epoch);
+};
+
+// pin the current epoch for the lifetime of the guard, it can be released on
+// another thread
+class EpochGuard {
+ public:
+    EpochGuard() : slot_(Epoch::GetSlot()), epoch_(Epoch::Pin(slot_)) {}
+    ~EpochGuard() { Epoch::Unpin(slot_, epoch_); }
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+    uint64_t GetEpoch() const { return epoch_; }
+
+ private:
+    uint32_t slot_;
+    uint64_t epoch_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_EPOCH_H_
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/epoch.h"
+
+#include <memory>
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace storage {
+
+class EpochTest : public ::testing::Test {
+ public:
+    EpochTest() {}
+    ~EpochTest() {}
+};
+
+TEST_F(EpochTest, Advance) {
+    uint64_t epoch = Epoch::Current();
+    ASSERT_TRUE(Epoch::TryAdvance());
+    ASSERT_EQ(epoch + 1, Epoch::Current());
+    ASSERT_EQ(epoch - 1, Epoch::GetReclaimable());
+    {
+        EpochGuard guard;
+        ASSERT_EQ(epoch + 1, guard.GetEpoch());
+        // the readers of the current epoch don't block one advance
+        ASSERT_TRUE(Epoch::TryAdvance());
+        ASSERT_FALSE(Epoch::TryAdvance());
+        ASSERT_EQ(epoch + 2, Epoch::Current());
+        // the memory retired in the pinned epoch can't be freed
+        ASSERT_LT(Epoch::GetReclaimable(), guard.GetEpoch());
+    }
+    ASSERT_TRUE(Epoch::TryAdvance());
+    ASSERT_EQ(epoch + 1, Epoch::GetReclaimable());
+}
+
+TEST_F(EpochTest, UnpinOnOtherThread) {
+    std::unique_ptr<EpochGuard> guard(new EpochGuard());
+    ASSERT_TRUE(Epoch::TryAdvance());
+    ASSERT_FALSE(Epoch::TryAdvance());
+    std::thread t([&guard] { guard.reset(); });
+    t.join();
+    ASSERT_TRUE(Epoch::TryAdvance());
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
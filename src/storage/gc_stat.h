@@ -0,0 +1,125 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_GC_STAT_H_
+#define SRC_STORAGE_GC_STAT_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+namespace openmldb {
+namespace storage {
+
+// The progress, pause time and reclaimed memory of the gc of one table. It is written by the gc
+// thread and read by the tablet metrics, so all fields are relaxed atomics.
+// The pause of bucket 0 is less than 1ms and bucket i covers [2^(i-1), 2^i) ms.
+class GcStat {
+ public:
+    static constexpr uint32_t kPauseBucketCnt = 12;
+
+    GcStat()
+        : round_cnt_(0),
+          slice_cnt_(0),
+          done_segment_cnt_(0),
+          total_segment_cnt_(0),
+          max_pause_us_(0),
+          total_pause_us_(0),
+          pause_buckets_(),
+          total_round_us_(0),
+          reclaimed_record_cnt_(0),
+          reclaimed_byte_size_(0),
+          cold_row_cnt_(0),
+          cold_saved_byte_size_(0) {
+        for (auto& bucket : pause_buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void StartRound(uint32_t total_segment_cnt) {
+        total_segment_cnt_.store(total_segment_cnt, std::memory_order_relaxed);
+        done_segment_cnt_.store(0, std::memory_order_relaxed);
+    }
+
+    void FinishSegment() { done_segment_cnt_.fetch_add(1, std::memory_order_relaxed); }
+
+    void FinishRound(uint64_t round_us, uint64_t record_cnt, uint64_t byte_size) {
+        total_round_us_.fetch_add(round_us, std::memory_order_relaxed);
+        reclaimed_record_cnt_.fetch_add(record_cnt, std::memory_order_relaxed);
+        reclaimed_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
+        round_cnt_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void AddColdRows(uint64_t row_cnt, uint64_t saved_byte_size) {
+        cold_row_cnt_.fetch_add(row_cnt, std::memory_order_relaxed);
+        cold_saved_byte_size_.fetch_add(saved_byte_size, std::memory_order_relaxed);
+    }
+
+    void AddPause(uint64_t pause_us) {
+        slice_cnt_.fetch_add(1, std::memory_order_relaxed);
+        total_pause_us_.fetch_add(pause_us, std::memory_order_relaxed);
+        uint64_t max = max_pause_us_.load(std::memory_order_relaxed);
+        while (pause_us > max && !max_pause_us_.compare_exchange_weak(max, pause_us, std::memory_order_relaxed)) {
+        }
+        pause_buckets_[GetBucketIdx(pause_us)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static inline uint32_t GetBucketIdx(uint64_t pause_us) {
+        uint64_t ms = pause_us / 1000;
+        if (ms == 0) {
+            return 0;
+        }
+        uint32_t idx = 64 - __builtin_clzll(ms);
+        return idx < kPauseBucketCnt ? idx : kPauseBucketCnt - 1;
+    }
+
+    uint64_t GetRoundCnt() const { return round_cnt_.load(std::memory_order_relaxed); }
+    uint64_t GetSliceCnt() const { return slice_cnt_.load(std::memory_order_relaxed); }
+    uint32_t GetDoneSegmentCnt() const { return done_segment_cnt_.load(std::memory_order_relaxed); }
+    uint32_t GetTotalSegmentCnt() const { return total_segment_cnt_.load(std::memory_order_relaxed); }
+    uint64_t GetMaxPause() const { return max_pause_us_.load(std::memory_order_relaxed); }
+    uint64_t GetTotalPause() const { return total_pause_us_.load(std::memory_order_relaxed); }
+    uint64_t GetPauseCnt(uint32_t idx) const {
+        return idx < kPauseBucketCnt ? pause_buckets_[idx].load(std::memory_order_relaxed) : 0;
+    }
+    // the sums over all the finished rounds
+    uint64_t GetTotalRoundTime() const { return total_round_us_.load(std::memory_order_relaxed); }
+    uint64_t GetReclaimedRecordCnt() const { return reclaimed_record_cnt_.load(std::memory_order_relaxed); }
+    uint64_t GetReclaimedByteSize() const { return reclaimed_byte_size_.load(std::memory_order_relaxed); }
+    // the rows deflated by the gc and the bytes it saved, see MemTable::CompressColdRows
+    uint64_t GetColdRowCnt() const { return cold_row_cnt_.load(std::memory_order_relaxed); }
+    uint64_t GetColdSavedByteSize() const { return cold_saved_byte_size_.load(std::memory_order_relaxed); }
+
+ private:
+    std::atomic<uint64_t> round_cnt_;
+    std::atomic<uint64_t> slice_cnt_;
+    // the progress of the running round
+    std::atomic<uint32_t> done_segment_cnt_;
+    std::atomic<uint32_t> total_segment_cnt_;
+    std::atomic<uint64_t> max_pause_us_;
+    std::atomic<uint64_t> total_pause_us_;
+    std::atomic<uint64_t> pause_buckets_[kPauseBucketCnt];
+    std::atomic<uint64_t> total_round_us_;
+    std::atomic<uint64_t> reclaimed_record_cnt_;
+    std::atomic<uint64_t> reclaimed_byte_size_;
+    std::atomic<uint64_t> cold_row_cnt_;
+    std::atomic<uint64_t> cold_saved_byte_size_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_GC_STAT_H_
@@ -0,0 +1,458 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/hybrid_table.h"
+
+#include <snappy.h>
+
+#include <utility>
+
+#include "base/glog_wapper.h"
+#include "codec/composite_key.h"
+#include "codec/row_codec.h"
+#include "common/timer.h"
+
+namespace openmldb {
+namespace storage {
+
+static ::openmldb::api::TableMeta GetHotTableMeta(const ::openmldb::api::TableMeta& table_meta) {
+    ::openmldb::api::TableMeta hot_meta(table_meta);
+    hot_meta.set_storage_mode(::openmldb::common::kMemory);
+    // the hot store only keeps the rows in hot_ttl, the ttl of table is checked by the iterators
+    for (auto& column_key : *hot_meta.mutable_column_key()) {
+        auto ttl = column_key.mutable_ttl();
+        uint64_t abs_ttl = table_meta.hot_ttl();
+        if (ttl->ttl_type() == ::openmldb::type::TTLType::kAbsoluteTime && ttl->abs_ttl() > 0 &&
+            ttl->abs_ttl() < abs_ttl) {
+            abs_ttl = ttl->abs_ttl();
+        }
+        ttl->set_ttl_type(::openmldb::type::TTLType::kAbsoluteTime);
+        ttl->set_abs_ttl(abs_ttl);
+        ttl->set_lat_ttl(0);
+    }
+    return hot_meta;
+}
+
+static std::string GetKeyString(const hybridse::codec::Row& row) {
+    return std::string(reinterpret_cast<const char*>(row.buf()), row.size());
+}
+
+HybridTableIterator::HybridTableIterator(TableIterator* hot_it, std::function<TableIterator*()> cold_creator,
+                                         uint64_t boundary)
+    : hot_it_(hot_it), cold_it_(NULL), cur_it_(hot_it), cold_creator_(std::move(cold_creator)), boundary_(boundary) {}
+
+HybridTableIterator::~HybridTableIterator() {
+    delete hot_it_;
+    delete cold_it_;
+}
+
+bool HybridTableIterator::Valid() { return cur_it_ != NULL && cur_it_->Valid(); }
+
+void HybridTableIterator::Next() {
+    cur_it_->Next();
+    if (cur_it_ == hot_it_) {
+        CheckBoundary();
+    }
+}
+
+openmldb::base::Slice HybridTableIterator::GetValue() const { return cur_it_->GetValue(); }
+
+std::string HybridTableIterator::GetPK() const { return cur_it_->GetPK(); }
+
+uint64_t HybridTableIterator::GetKey() const { return cur_it_->GetKey(); }
+
+void HybridTableIterator::SeekToFirst() {
+    hot_it_->SeekToFirst();
+    cur_it_ = hot_it_;
+    CheckBoundary();
+}
+
+void HybridTableIterator::Seek(uint64_t time) {
+    if (time >= boundary_) {
+        hot_it_->Seek(time);
+        cur_it_ = hot_it_;
+        CheckBoundary();
+    } else {
+        SeekCold(time);
+    }
+}
+
+void HybridTableIterator::CheckBoundary() {
+    if ((hot_it_->Valid() && hot_it_->GetKey() >= boundary_) || boundary_ == 0) {
+        return;
+    }
+    SeekCold(boundary_ - 1);
+}
+
+void HybridTableIterator::SeekCold(uint64_t time) {
+    if (cold_it_ == NULL) {
+        cold_it_ = cold_creator_();
+    }
+    cur_it_ = cold_it_;
+    if (cold_it_ != NULL) {
+        cold_it_->Seek(time);
+    }
+}
+
+HybridRowIterator::HybridRowIterator(std::unique_ptr<::hybridse::vm::RowIterator> hot_it,
+                                     std::function<std::unique_ptr<::hybridse::vm::RowIterator>()> cold_creator,
+                                     uint64_t boundary, const TTLSt& expire_value)
+    : hot_it_(std::move(hot_it)),
+      cold_it_(),
+      cur_it_(hot_it_.get()),
+      cold_creator_(std::move(cold_creator)),
+      boundary_(boundary),
+      expire_value_(expire_value),
+      record_idx_(1) {}
+
+bool HybridRowIterator::Valid() const {
+    return cur_it_ != nullptr && cur_it_->Valid() && !expire_value_.IsExpired(cur_it_->GetKey(), record_idx_);
+}
+
+void HybridRowIterator::Next() {
+    cur_it_->Next();
+    record_idx_++;
+    if (cur_it_ == hot_it_.get()) {
+        CheckBoundary();
+    }
+}
+
+const uint64_t& HybridRowIterator::GetKey() const { return cur_it_->GetKey(); }
+
+const ::hybridse::codec::Row& HybridRowIterator::GetValue() { return cur_it_->GetValue(); }
+
+void HybridRowIterator::Seek(const uint64_t& key) {
+    if (expire_value_.ttl_type != TTLType::kAbsoluteTime) {
+        // the rows before key are counted for the latest ttl
+        SeekToFirst();
+        while (Valid() && GetKey() > key) {
+            Next();
+        }
+        return;
+    }
+    record_idx_ = 1;
+    if (key >= boundary_) {
+        cur_it_ = hot_it_.get();
+        if (hot_it_) {
+            hot_it_->Seek(key);
+        }
+        CheckBoundary();
+    } else {
+        SeekCold(key);
+    }
+}
+
+void HybridRowIterator::SeekToFirst() {
+    record_idx_ = 1;
+    cur_it_ = hot_it_.get();
+    if (hot_it_) {
+        hot_it_->SeekToFirst();
+    }
+    CheckBoundary();
+}
+
+void HybridRowIterator::CheckBoundary() {
+    if ((hot_it_ && hot_it_->Valid() && hot_it_->GetKey() >= boundary_) || boundary_ == 0) {
+        return;
+    }
+    SeekCold(boundary_ - 1);
+}
+
+void HybridRowIterator::SeekCold(uint64_t key) {
+    if (!cold_it_) {
+        cold_it_ = cold_creator_();
+    }
+    cur_it_ = cold_it_.get();
+    if (cold_it_) {
+        cold_it_->Seek(key);
+    }
+}
+
+HybridKeyIterator::HybridKeyIterator(::hybridse::vm::WindowIterator* hot_it,
+                                     std::function<::hybridse::vm::WindowIterator*()> cold_creator,
+                                     uint64_t boundary, const TTLSt& expire_value)
+    : hot_it_(hot_it),
+      cold_it_(NULL),
+      cold_creator_(std::move(cold_creator)),
+      boundary_(boundary),
+      expire_value_(expire_value),
+      in_hot_(false),
+      pk_() {}
+
+HybridKeyIterator::~HybridKeyIterator() {
+    delete hot_it_;
+    delete cold_it_;
+}
+
+::hybridse::vm::WindowIterator* HybridKeyIterator::GetColdIterator() {
+    if (cold_it_ == NULL) {
+        cold_it_ = cold_creator_();
+    }
+    return cold_it_;
+}
+
+void HybridKeyIterator::Seek(const std::string& pk) {
+    pk_ = pk;
+    in_hot_ = false;
+    hot_it_->Seek(pk);
+    if (hot_it_->Valid() && GetKeyString(hot_it_->GetKey()) == pk) {
+        in_hot_ = true;
+        return;
+    }
+    auto cold_it = GetColdIterator();
+    if (cold_it != NULL) {
+        cold_it->Seek(pk);
+    }
+}
+
+void HybridKeyIterator::SeekToFirst() {
+    in_hot_ = false;
+    auto cold_it = GetColdIterator();
+    if (cold_it != NULL) {
+        cold_it->SeekToFirst();
+    }
+}
+
+void HybridKeyIterator::Next() {
+    auto cold_it = GetColdIterator();
+    if (cold_it == NULL) {
+        in_hot_ = false;
+        return;
+    }
+    if (in_hot_) {
+        // position the cold iterator at the key sought in the hot store first
+        in_hot_ = false;
+        cold_it->Seek(pk_);
+        if (!cold_it->Valid() || GetKeyString(cold_it->GetKey()) != pk_) {
+            return;
+        }
+    }
+    cold_it->Next();
+}
+
+bool HybridKeyIterator::Valid() {
+    if (in_hot_) {
+        return true;
+    }
+    return cold_it_ != NULL && cold_it_->Valid();
+}
+
+const hybridse::codec::Row HybridKeyIterator::GetKey() {
+    if (in_hot_) {
+        return hybridse::codec::Row(::hybridse::base::RefCountedSlice::Create(pk_.c_str(), pk_.size()));
+    }
+    return cold_it_->GetKey();
+}
+
+std::unique_ptr<::hybridse::vm::RowIterator> HybridKeyIterator::GetValue() {
+    return std::unique_ptr<::hybridse::vm::RowIterator>(GetRawValue());
+}
+
+::hybridse::vm::RowIterator* HybridKeyIterator::GetRawValue() {
+    std::unique_ptr<::hybridse::vm::RowIterator> hot_row_it;
+    std::string pk;
+    if (in_hot_) {
+        pk = pk_;
+        hot_row_it = hot_it_->GetValue();
+    } else {
+        pk = GetKeyString(cold_it_->GetKey());
+        hot_it_->Seek(pk);
+        if (hot_it_->Valid() && GetKeyString(hot_it_->GetKey()) == pk) {
+            hot_row_it = hot_it_->GetValue();
+        }
+    }
+    auto creator = cold_creator_;
+    auto cold_row_creator = [creator, pk]() -> std::unique_ptr<::hybridse::vm::RowIterator> {
+        std::unique_ptr<::hybridse::vm::WindowIterator> it(creator());
+        if (!it) {
+            return nullptr;
+        }
+        it->Seek(pk);
+        if (!it->Valid() || GetKeyString(it->GetKey()) != pk) {
+            return nullptr;
+        }
+        // the row iterator of disk table holds its own rocksdb iterator and snapshot
+        return it->GetValue();
+    };
+    auto row_it = new HybridRowIterator(std::move(hot_row_it), cold_row_creator, boundary_, expire_value_);
+    row_it->SeekToFirst();
+    return row_it;
+}
+
+HybridTable::HybridTable(const ::openmldb::api::TableMeta& table_meta, const std::string& table_path)
+    : DiskTable(table_meta, table_path),
+      hot_ttl_(table_meta.hot_ttl() * 60 * 1000),
+      hot_table_(new MemTable(GetHotTableMeta(table_meta))) {}
+
+bool HybridTable::Init() {
+    if (!DiskTable::Init()) {
+        return false;
+    }
+    if (!hot_table_->Init()) {
+        PDLOG(WARNING, "fail to init hot table. tid %u pid %u", id_, pid_);
+        return false;
+    }
+    return LoadHotRows();
+}
+
+void HybridTable::SetTableMeta(::openmldb::api::TableMeta& table_meta) {
+    Table::SetTableMeta(table_meta);
+    auto hot_meta = GetHotTableMeta(table_meta);
+    hot_table_->SetTableMeta(hot_meta);
+}
+
+uint64_t HybridTable::GetHotBoundary() const {
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    return cur_time > hot_ttl_ ? cur_time - hot_ttl_ : 0;
+}
+
+bool HybridTable::GetDimensions(const std::string& value, Dimensions* dimensions) {
+    std::string buff;
+    const std::string* data = &value;
+    if (GetCompressType() == ::openmldb::type::kSnappy) {
+        snappy::Uncompress(value.data(), value.size(), &buff);
+        data = &buff;
+    }
+    const int8_t* raw = reinterpret_cast<const int8_t*>(data->data());
+    auto schema = GetVersionSchema(::openmldb::codec::RowView::GetSchemaVersion(raw));
+    if (!schema) {
+        return false;
+    }
+    std::vector<std::string> values;
+    if (!::openmldb::codec::RowCodec::DecodeRow(*schema, raw, data->size(), true, 0, schema->size(), values)) {
+        return false;
+    }
+    ::openmldb::codec::CompositeKeyBuilder key_builder;
+    for (const auto& index : GetAllIndex()) {
+        if (!index->IsReady()) {
+            continue;
+        }
+        key_builder.Reset();
+        for (const auto& col : index->GetColumns()) {
+            if (col.GetId() >= values.size()) {
+                return false;
+            }
+            key_builder.Append(values[col.GetId()]);
+        }
+        auto dim = dimensions->Add();
+        dim->set_idx(index->GetId());
+        dim->set_key(key_builder.Key());
+    }
+    return true;
+}
+
+bool HybridTable::LoadHotRows() {
+    // the rows are chosen by the ts of the first index and put with the keys of all indexes
+    std::unique_ptr<::hybridse::vm::WindowIterator> it(DiskTable::NewWindowIterator(0));
+    if (!it) {
+        return true;
+    }
+    uint64_t boundary = GetHotBoundary();
+    uint64_t cnt = 0;
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        auto row_it = it->GetValue();
+        for (row_it->SeekToFirst(); row_it->Valid() && row_it->GetKey() >= boundary; row_it->Next()) {
+            const auto& row = row_it->GetValue();
+            std::string value(reinterpret_cast<const char*>(row.buf()), row.size());
+            Dimensions dimensions;
+            if (!GetDimensions(value, &dimensions)) {
+                PDLOG(WARNING, "fail to get dimensions of row. tid %u pid %u", id_, pid_);
+                continue;
+            }
+            hot_table_->Put(row_it->GetKey(), value, dimensions);
+            cnt++;
+        }
+    }
+    PDLOG(INFO, "load %lu hot rows. tid %u pid %u", cnt, id_, pid_);
+    return true;
+}
+
+bool HybridTable::Put(const std::string& pk, uint64_t time, const char* data, uint32_t size) {
+    if (!DiskTable::Put(pk, time, data, size)) {
+        return false;
+    }
+    hot_table_->Put(pk, time, data, size);
+    return true;
+}
+
+bool HybridTable::Put(uint64_t time, const std::string& value, const Dimensions& dimensions) {
+    if (!DiskTable::Put(time, value, dimensions)) {
+        return false;
+    }
+    hot_table_->Put(time, value, dimensions);
+    return true;
+}
+
+bool HybridTable::BulkLoad(const std::vector<const ::openmldb::api::PutRequest*>& rows) {
+    if (!DiskTable::BulkLoad(rows)) {
+        return false;
+    }
+    for (const auto* row : rows) {
+        hot_table_->Put(row->time(), row->value(), row->dimensions());
+    }
+    return true;
+}
+
+bool HybridTable::Delete(const std::string& pk, uint32_t idx) {
+    bool ok = DiskTable::Delete(pk, idx);
+    hot_table_->Delete(pk, idx);
+    return ok;
+}
+
+TableIterator* HybridTable::NewIterator(const std::string& pk, Ticket& ticket) {
+    return HybridTable::NewIterator(0, pk, ticket);
+}
+
+TableIterator* HybridTable::NewIterator(uint32_t idx, const std::string& pk, Ticket& ticket) {
+    TableIterator* hot_it = hot_table_->NewIterator(idx, pk, ticket);
+    if (hot_it == NULL) {
+        return DiskTable::NewIterator(idx, pk, ticket);
+    }
+    return new HybridTableIterator(
+        hot_it, [this, idx, pk, &ticket]() { return DiskTable::NewIterator(idx, pk, ticket); }, GetHotBoundary());
+}
+
+::hybridse::vm::WindowIterator* HybridTable::NewWindowIterator(uint32_t idx) {
+    std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(idx);
+    if (!index_def) {
+        return NULL;
+    }
+    ::hybridse::vm::WindowIterator* hot_it = hot_table_->NewWindowIterator(idx);
+    if (hot_it == NULL) {
+        return DiskTable::NewWindowIterator(idx);
+    }
+    auto ttl = index_def->GetTTL();
+    TTLSt expire_value(GetExpireTime(*ttl), ttl->lat_ttl, ttl->ttl_type);
+    return new HybridKeyIterator(
+        hot_it, [this, idx]() { return DiskTable::NewWindowIterator(idx); }, GetHotBoundary(), expire_value);
+}
+
+void HybridTable::SchedGc() {
+    DiskTable::SchedGc();
+    uint64_t start_time = ::baidu::common::timer::get_micros() / 1000;
+    hot_table_->SchedGc();
+    PDLOG(INFO, "gc hot rows done. hot byte size %lu, cost %lu ms. tid %u pid %u", hot_table_->GetRecordByteSize(),
+          ::baidu::common::timer::get_micros() / 1000 - start_time, id_, pid_);
+}
+
+bool HybridTable::DeleteIndex(const std::string& idx_name) {
+    bool ok = DiskTable::DeleteIndex(idx_name);
+    hot_table_->DeleteIndex(idx_name);
+    return ok;
+}
+
+}  // namespace storage
+}  // namespace openmldb
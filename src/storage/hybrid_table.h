@@ -0,0 +1,169 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/disk_table.h"
+#include "storage/mem_table.h"
+
+namespace openmldb {
+namespace storage {
+
+// iterate the rows of one key newer than boundary in the hot store and the older ones in the cold store.
+// the cold iterator is created only if the rows in the hot store are not enough
+class HybridTableIterator : public TableIterator {
+ public:
+    HybridTableIterator(TableIterator* hot_it, std::function<TableIterator*()> cold_creator, uint64_t boundary);
+    ~HybridTableIterator() override;
+    bool Valid() override;
+    void Next() override;
+    openmldb::base::Slice GetValue() const override;
+    std::string GetPK() const override;
+    uint64_t GetKey() const override;
+    void SeekToFirst() override;
+    void Seek(uint64_t time) override;
+
+ private:
+    // switch to the cold store once the hot one is exhausted or its row is older than boundary
+    void CheckBoundary();
+    void SeekCold(uint64_t time);
+
+ private:
+    TableIterator* hot_it_;
+    TableIterator* cold_it_;
+    TableIterator* cur_it_;
+    std::function<TableIterator*()> cold_creator_;
+    uint64_t boundary_;
+};
+
+class HybridRowIterator : public ::hybridse::vm::RowIterator {
+ public:
+    // the ttl of the table is checked here as the two stores count the latest rows separately
+    HybridRowIterator(std::unique_ptr<::hybridse::vm::RowIterator> hot_it,
+                      std::function<std::unique_ptr<::hybridse::vm::RowIterator>()> cold_creator, uint64_t boundary,
+                      const TTLSt& expire_value);
+    ~HybridRowIterator() override {}
+    bool Valid() const override;
+    void Next() override;
+    const uint64_t& GetKey() const override;
+    const ::hybridse::codec::Row& GetValue() override;
+    void Seek(const uint64_t& key) override;
+    void SeekToFirst() override;
+    bool IsSeekable() const override { return true; }
+
+ private:
+    void CheckBoundary();
+    void SeekCold(uint64_t key);
+
+ private:
+    std::unique_ptr<::hybridse::vm::RowIterator> hot_it_;
+    std::unique_ptr<::hybridse::vm::RowIterator> cold_it_;
+    ::hybridse::vm::RowIterator* cur_it_;
+    std::function<std::unique_ptr<::hybridse::vm::RowIterator>()> cold_creator_;
+    uint64_t boundary_;
+    TTLSt expire_value_;
+    uint32_t record_idx_;
+};
+
+// the keys are iterated in the cold store as it has all rows. Seek peeks the hot store first, so the
+// request of a key with only recent rows is served without reading the cold one
+class HybridKeyIterator : public ::hybridse::vm::WindowIterator {
+ public:
+    HybridKeyIterator(::hybridse::vm::WindowIterator* hot_it,
+                      std::function<::hybridse::vm::WindowIterator*()> cold_creator, uint64_t boundary,
+                      const TTLSt& expire_value);
+    ~HybridKeyIterator() override;
+    void Seek(const std::string& pk) override;
+    void SeekToFirst() override;
+    void Next() override;
+    bool Valid() override;
+    std::unique_ptr<::hybridse::vm::RowIterator> GetValue() override;
+    ::hybridse::vm::RowIterator* GetRawValue() override;
+    const hybridse::codec::Row GetKey() override;
+
+ private:
+    ::hybridse::vm::WindowIterator* GetColdIterator();
+
+ private:
+    ::hybridse::vm::WindowIterator* hot_it_;
+    ::hybridse::vm::WindowIterator* cold_it_;
+    std::function<::hybridse::vm::WindowIterator*()> cold_creator_;
+    uint64_t boundary_;
+    TTLSt expire_value_;
+    // the key sought in the hot store and the cold iterator is not positioned
+    bool in_hot_;
+    std::string pk_;
+};
+
+// HybridTable is a disk table with the recent rows of every key also kept in a memory table. All rows are
+// written to both stores, and the memory one drops the rows older than hot_ttl on gc, so the queries of
+// recent windows are served from memory and the older part of a window is read from disk.
+class HybridTable : public DiskTable {
+ public:
+    HybridTable(const ::openmldb::api::TableMeta& table_meta, const std::string& table_path);
+    HybridTable(const HybridTable&) = delete;
+    HybridTable& operator=(const HybridTable&) = delete;
+
+    ~HybridTable() override {}
+
+    bool Init() override;
+
+    void SetTableMeta(::openmldb::api::TableMeta& table_meta) override;  // NOLINT
+
+    bool Put(const std::string& pk, uint64_t time, const char* data, uint32_t size) override;
+
+    bool Put(uint64_t time, const std::string& value, const Dimensions& dimensions) override;
+
+    bool BulkLoad(const std::vector<const ::openmldb::api::PutRequest*>& rows) override;
+
+    bool Delete(const std::string& pk, uint32_t idx) override;
+
+    TableIterator* NewIterator(const std::string& pk, Ticket& ticket) override;  // NOLINT
+
+    TableIterator* NewIterator(uint32_t idx, const std::string& pk, Ticket& ticket) override;  // NOLINT
+
+    ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t idx) override;
+
+    void SchedGc() override;
+
+    bool DeleteIndex(const std::string& idx_name) override;
+
+    // the memory used by the hot rows
+    uint64_t GetRecordByteSize() const override { return hot_table_->GetRecordByteSize(); }
+
+    // all rows newer than or equal to the boundary are in the hot store
+    uint64_t GetHotBoundary() const;
+
+    MemTable* GetHotTable() { return hot_table_.get(); }
+
+ private:
+    // put the recent rows on disk to the hot store on loading table
+    bool LoadHotRows();
+
+    bool GetDimensions(const std::string& value, Dimensions* dimensions);
+
+ private:
+    uint64_t hot_ttl_;
+    std::unique_ptr<MemTable> hot_table_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
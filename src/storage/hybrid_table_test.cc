@@ -0,0 +1,192 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/hybrid_table.h"
+
+#include <gflags/gflags.h>
+
+#include <string>
+#include <vector>
+
+#include "base/file_util.h"
+#include "base/glog_wapper.h"  // NOLINT
+#include "codec/schema_codec.h"
+#include "codec/sdk_codec.h"
+#include "common/timer.h"  // NOLINT
+#include "gtest/gtest.h"
+#include "storage/ticket.h"
+
+using ::openmldb::codec::SchemaCodec;
+
+DECLARE_string(ssd_root_path);
+DECLARE_string(hdd_root_path);
+
+namespace openmldb {
+namespace storage {
+
+inline uint32_t GenRand() {
+    srand((unsigned)time(NULL));
+    return rand() % 10000000 + 1;
+}
+
+void RemoveData(const std::string& path) {
+    ::openmldb::base::RemoveDir(path + "/data");
+    ::openmldb::base::RemoveDir(path);
+    ::openmldb::base::RemoveDir(FLAGS_hdd_root_path);
+    ::openmldb::base::RemoveDir(FLAGS_ssd_root_path);
+}
+
+class HybridTableTest : public ::testing::Test {
+ public:
+    HybridTableTest() {}
+    ~HybridTableTest() {}
+};
+
+::openmldb::api::TableMeta GetHybridTableMeta(uint32_t tid) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(tid);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_format_version(1);
+    table_meta.set_hot_ttl(10);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+    return table_meta;
+}
+
+// put 10 rows to every key, the first 5 of them are in the hot store and the others are one hour older
+void PutRows(const ::openmldb::api::TableMeta& table_meta, uint64_t cur_time, HybridTable* table) {
+    codec::SDKCodec codec(table_meta);
+    for (int idx = 0; idx < 10; idx++) {
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card" + std::to_string(idx));
+        dim->set_idx(0);
+        ::openmldb::api::Dimension* dim1 = dims.Add();
+        dim1->set_key("mcc" + std::to_string(idx));
+        dim1->set_idx(1);
+        for (int i = 0; i < 10; i++) {
+            uint64_t ts = i < 5 ? cur_time - i : cur_time - 60 * 60 * 1000 - i;
+            std::vector<std::string> row = {"card" + std::to_string(idx), "mcc" + std::to_string(idx),
+                                            std::to_string(ts)};
+            std::string value;
+            ASSERT_EQ(0, codec.EncodeRow(row, &value));
+            ASSERT_TRUE(table->Put(ts, value, dims));
+        }
+    }
+}
+
+void CheckRows(HybridTable* table, uint32_t idx, const std::string& pk, uint64_t cur_time) {
+    Ticket ticket;
+    TableIterator* it = table->NewIterator(idx, pk, ticket);
+    ASSERT_TRUE(it != NULL);
+    it->SeekToFirst();
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(it->Valid());
+        uint64_t ts = i < 5 ? cur_time - i : cur_time - 60 * 60 * 1000 - i;
+        ASSERT_EQ(ts, it->GetKey());
+        it->Next();
+    }
+    ASSERT_FALSE(it->Valid());
+    // seek to a row in the cold store
+    it->Seek(cur_time - 60 * 60 * 1000 - 7);
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ(cur_time - 60 * 60 * 1000 - 7, it->GetKey());
+    delete it;
+
+    Ticket hot_ticket;
+    it = table->GetHotTable()->NewIterator(idx, pk, hot_ticket);
+    it->SeekToFirst();
+    int count = 0;
+    while (it->Valid()) {
+        ASSERT_GE(it->GetKey(), table->GetHotBoundary());
+        count++;
+        it->Next();
+    }
+    delete it;
+    ASSERT_EQ(5, count);
+}
+
+TEST_F(HybridTableTest, Put) {
+    auto table_meta = GetHybridTableMeta(1);
+    std::string table_path = FLAGS_hdd_root_path + "/1_1";
+    HybridTable* table = new HybridTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    PutRows(table_meta, cur_time, table);
+    table->SchedGc();
+    CheckRows(table, 0, "card3", cur_time);
+    CheckRows(table, 1, "mcc5", cur_time);
+
+    ::hybridse::vm::WindowIterator* key_it = table->NewWindowIterator(0);
+    ASSERT_TRUE(key_it != NULL);
+    key_it->SeekToFirst();
+    int key_cnt = 0;
+    while (key_it->Valid()) {
+        auto row_it = key_it->GetValue();
+        row_it->SeekToFirst();
+        int row_cnt = 0;
+        uint64_t last_ts = UINT64_MAX;
+        while (row_it->Valid()) {
+            ASSERT_LT(row_it->GetKey(), last_ts);
+            last_ts = row_it->GetKey();
+            row_cnt++;
+            row_it->Next();
+        }
+        ASSERT_EQ(10, row_cnt);
+        key_cnt++;
+        key_it->Next();
+    }
+    ASSERT_EQ(10, key_cnt);
+    key_it->Seek("card7");
+    ASSERT_TRUE(key_it->Valid());
+    ASSERT_EQ("card7", key_it->GetKey().ToString());
+    delete key_it;
+    delete table;
+    RemoveData(table_path);
+}
+
+TEST_F(HybridTableTest, Load) {
+    auto table_meta = GetHybridTableMeta(2);
+    std::string table_path = FLAGS_hdd_root_path + "/2_1";
+    HybridTable* table = new HybridTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    PutRows(table_meta, cur_time, table);
+    delete table;
+
+    // the recent rows are put back to the hot store on loading
+    table = new HybridTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    CheckRows(table, 0, "card0", cur_time);
+    CheckRows(table, 1, "mcc9", cur_time);
+    delete table;
+    RemoveData(table_path);
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    ::openmldb::base::SetLogLevel(INFO);
+    FLAGS_hdd_root_path = "/tmp/" + std::to_string(::openmldb::storage::GenRand());
+    FLAGS_ssd_root_path = "/tmp/" + std::to_string(::openmldb::storage::GenRand());
+    return RUN_ALL_TESTS();
+}
@@ -46,6 +46,8 @@ class TraverseIterator : public TableIterator {
     TraverseIterator() {}
     virtual ~TraverseIterator() {}
     virtual void NextPK() = 0;
+    // start counting the traverse of the next page on an iterator kept between the pages
+    virtual void ResetCount() {}
 };
 
 }  // namespace storage
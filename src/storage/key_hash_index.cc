@@ -0,0 +1,160 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "storage/key_hash_index.h"
+
+#include "base/hash.h"
+
+namespace openmldb {
+namespace storage {
+
+static uint32_t RoundUpPowerOfTwo(uint32_t n) {
+    uint32_t cnt = 1;
+    while (cnt < n) {
+        cnt <<= 1;
+    }
+    return cnt;
+}
+
+KeyHashIndex::KeyHashIndex(uint32_t init_bucket_cnt)
+    : buckets_(new Buckets(RoundUpPowerOfTwo(init_bucket_cnt))), size_(0), retired_mu_(), retired_() {}
+
+KeyHashIndex::~KeyHashIndex() {
+    Clear();
+    delete buckets_.load(std::memory_order_relaxed);
+}
+
+uint32_t KeyHashIndex::Hash(const Slice& key) { return ::openmldb::base::hash(key.data(), key.size(), HASH_SEED); }
+
+bool KeyHashIndex::Get(const Slice& key, void** value) const {
+    uint32_t hash = Hash(key);
+    const Buckets* buckets = buckets_.load(std::memory_order_acquire);
+    Node* node = buckets->heads[hash & (buckets->cnt - 1)].load(std::memory_order_acquire);
+    while (node != nullptr) {
+        if (node->hash == hash && node->key.compare(key) == 0) {
+            *value = node->value;
+            return true;
+        }
+        node = node->next.load(std::memory_order_acquire);
+    }
+    return false;
+}
+
+void KeyHashIndex::Insert(const Slice& key, void* value, uint64_t version) {
+    if (size_.load(std::memory_order_relaxed) >= static_cast<uint64_t>(GetBucketCnt()) * MAX_LOAD_FACTOR) {
+        Resize(version);
+    }
+    uint32_t hash = Hash(key);
+    Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+    std::atomic<Node*>& head = buckets->heads[hash & (buckets->cnt - 1)];
+    // the node is published after it is fully built
+    head.store(new Node(key, value, hash, head.load(std::memory_order_relaxed)), std::memory_order_release);
+    size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool KeyHashIndex::Remove(const Slice& key, uint64_t version) {
+    uint32_t hash = Hash(key);
+    Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+    std::atomic<Node*>* pre = &buckets->heads[hash & (buckets->cnt - 1)];
+    Node* node = pre->load(std::memory_order_relaxed);
+    while (node != nullptr) {
+        if (node->hash == hash && node->key.compare(key) == 0) {
+            // the readers on the node still see the rest of the chain
+            pre->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            Retire({version, node, nullptr});
+            return true;
+        }
+        pre = &node->next;
+        node = pre->load(std::memory_order_relaxed);
+    }
+    return false;
+}
+
+void KeyHashIndex::Resize(uint64_t version) {
+    Buckets* old_buckets = buckets_.load(std::memory_order_relaxed);
+    Buckets* buckets = new Buckets(old_buckets->cnt * 2);
+    // the nodes are copied rather than relinked, so the readers on the old buckets are not misled
+    for (uint32_t i = 0; i < old_buckets->cnt; i++) {
+        Node* node = old_buckets->heads[i].load(std::memory_order_relaxed);
+        while (node != nullptr) {
+            std::atomic<Node*>& head = buckets->heads[node->hash & (buckets->cnt - 1)];
+            head.store(new Node(node->key, node->value, node->hash, head.load(std::memory_order_relaxed)),
+                       std::memory_order_relaxed);
+            node = node->next.load(std::memory_order_relaxed);
+        }
+    }
+    buckets_.store(buckets, std::memory_order_release);
+    Retire({version, nullptr, old_buckets});
+}
+
+void KeyHashIndex::Retire(const Retired& retired) {
+    std::lock_guard<std::mutex> lock(retired_mu_);
+    retired_.push_back(retired);
+}
+
+void KeyHashIndex::FreeBuckets(Buckets* buckets) {
+    for (uint32_t i = 0; i < buckets->cnt; i++) {
+        Node* node = buckets->heads[i].load(std::memory_order_relaxed);
+        while (node != nullptr) {
+            Node* tmp = node;
+            node = node->next.load(std::memory_order_relaxed);
+            delete tmp;
+        }
+    }
+    delete buckets;
+}
+
+void KeyHashIndex::Gc(uint64_t version) {
+    std::deque<Retired> to_free;
+    {
+        std::lock_guard<std::mutex> lock(retired_mu_);
+        while (!retired_.empty() && retired_.front().version < version) {
+            to_free.push_back(retired_.front());
+            retired_.pop_front();
+        }
+    }
+    for (const auto& retired : to_free) {
+        if (retired.node != nullptr) {
+            delete retired.node;
+        } else {
+            FreeBuckets(retired.buckets);
+        }
+    }
+}
+
+void KeyHashIndex::Clear() {
+    {
+        std::lock_guard<std::mutex> lock(retired_mu_);
+        for (const auto& retired : retired_) {
+            if (retired.node != nullptr) {
+                delete retired.node;
+            } else {
+                FreeBuckets(retired.buckets);
+            }
+        }
+        retired_.clear();
+    }
+    Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+    uint32_t cnt = buckets->cnt;
+    buckets_.store(new Buckets(cnt), std::memory_order_relaxed);
+    FreeBuckets(buckets);
+    size_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace storage
+}  // namespace openmldb
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_KEY_HASH_INDEX_H_
+#define SRC_STORAGE_KEY_HASH_INDEX_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+
+#include "base/slice.h"
+
+namespace openmldb {
+namespace storage {
+
+using ::openmldb::base::Slice;
+
+// KeyHashIndex maps the keys of a segment to their entries, so that a point lookup does not
+// walk the skiplist. It is a chained hash table whose readers are lock free, and the writers
+// must be serialized by the caller. The nodes removed and the buckets replaced on resize are
+// retired with the version given by the writer, and freed by Gc once no reader may see them.
+class KeyHashIndex {
+ public:
+    explicit KeyHashIndex(uint32_t init_bucket_cnt);
+    ~KeyHashIndex();
+    KeyHashIndex(const KeyHashIndex&) = delete;
+    KeyHashIndex& operator=(const KeyHashIndex&) = delete;
+
+    // return false if the key is not found
+    bool Get(const Slice& key, void** value) const;
+
+    // the key must not exist, and its memory must outlive the node
+    void Insert(const Slice& key, void* value, uint64_t version);
+
+    // return false if the key is not found
+    bool Remove(const Slice& key, uint64_t version);
+
+    // free the memory retired in the versions less than version
+    void Gc(uint64_t version);
+
+    // free all memory at once, there must be no reader or writer
+    void Clear();
+
+    uint64_t GetSize() const { return size_.load(std::memory_order_relaxed); }
+    uint32_t GetBucketCnt() const { return buckets_.load(std::memory_order_acquire)->cnt; }
+
+ private:
+    struct Node {
+        Node(const Slice& k, void* v, uint32_t h, Node* n) : key(k.data(), k.size()), value(v), hash(h), next(n) {}
+        Slice key;
+        void* value;
+        uint32_t hash;
+        std::atomic<Node*> next;
+    };
+
+    struct Buckets {
+        explicit Buckets(uint32_t c) : cnt(c), heads(new std::atomic<Node*>[c]) {
+            for (uint32_t i = 0; i < cnt; i++) {
+                heads[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        uint32_t cnt;
+        std::unique_ptr<std::atomic<Node*>[]> heads;
+    };
+
+    // either a removed node or the buckets replaced with all nodes in them
+    struct Retired {
+        uint64_t version;
+        Node* node;
+        Buckets* buckets;
+    };
+
+    // differ from the seeds of segment selection and key lock
+    static const uint32_t HASH_SEED = 0x9e3779b9;
+
+    static uint32_t Hash(const Slice& key);
+    static void FreeBuckets(Buckets* buckets);
+    // the buckets are doubled once there are MAX_LOAD_FACTOR keys per bucket
+    static const uint32_t MAX_LOAD_FACTOR = 2;
+    void Resize(uint64_t version);
+    void Retire(const Retired& retired);
+
+    std::atomic<Buckets*> buckets_;
+    std::atomic<uint64_t> size_;
+    // the retired memory in the order of version
+    std::mutex retired_mu_;
+    std::deque<Retired> retired_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_KEY_HASH_INDEX_H_
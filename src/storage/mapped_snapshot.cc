@@ -0,0 +1,154 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "storage/mapped_snapshot.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/glog_wapper.h"
+#include "log/coding.h"
+#include "log/crc32c.h"
+#include "log/log_format.h"
+
+namespace openmldb {
+namespace storage {
+
+using ::openmldb::log::kBlockSize;
+using ::openmldb::log::kHeaderSize;
+
+std::shared_ptr<MappedSnapshot> MappedSnapshot::Open(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        PDLOG(WARNING, "fail to open %s for error %s", path.c_str(), strerror(errno));
+        return {};
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        PDLOG(WARNING, "fail to stat %s for error %s", path.c_str(), strerror(errno));
+        close(fd);
+        return {};
+    }
+    uint64_t size = st.st_size;
+    const char* data = nullptr;
+    if (size > 0) {
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            PDLOG(WARNING, "fail to mmap %s for error %s", path.c_str(), strerror(errno));
+            close(fd);
+            return {};
+        }
+        data = static_cast<const char*>(addr);
+    }
+    // the mapping is kept after the fd is closed
+    close(fd);
+    return std::shared_ptr<MappedSnapshot>(new MappedSnapshot(path, data, size));
+}
+
+MappedSnapshot::~MappedSnapshot() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+uint64_t MappedSnapshot::GetBlockCnt() const { return (size_ + kBlockSize - 1) / kBlockSize; }
+
+uint64_t MappedSnapshot::ReadRecords(uint64_t begin_block, uint64_t end_block, bool checksum,
+                                     const RecordHandler& handler) const {
+    uint64_t bad_cnt = 0;
+    uint64_t pos = begin_block * kBlockSize;
+    uint64_t end = std::min(end_block * kBlockSize, size_);
+    std::string scratch;
+    bool in_fragmented_record = false;
+    while (pos < size_ && (pos < end || in_fragmented_record)) {
+        uint64_t leftover = kBlockSize - pos % kBlockSize;
+        if (leftover < kHeaderSize) {
+            // the trailer of the block
+            pos += leftover;
+            continue;
+        }
+        if (pos + kHeaderSize > size_) {
+            break;
+        }
+        const char* header = data_ + pos;
+        const uint32_t a = static_cast<uint32_t>(header[4]) & 0xff;
+        const uint32_t b = static_cast<uint32_t>(header[5]) & 0xff;
+        const uint32_t type = static_cast<uint32_t>(header[6]) & 0xff;
+        const uint32_t length = a | (b << 8);
+        if (pos + kHeaderSize + length > size_) {
+            // the tail written partially
+            break;
+        }
+        if (type == ::openmldb::log::kEofType && length == 0) {
+            break;
+        }
+        bool bad = type == ::openmldb::log::kZeroType || type > ::openmldb::log::kLastType;
+        if (!bad && checksum) {
+            uint32_t expected_crc = ::openmldb::log::Unmask(::openmldb::log::DecodeFixed32(header));
+            bad = ::openmldb::log::Value(header + 6, 1 + length) != expected_crc;
+        }
+        if (bad) {
+            // drop the rest of the block as log::Reader does, since the length may be corrupted
+            if (length > 0) {
+                bad_cnt++;
+            }
+            scratch.clear();
+            in_fragmented_record = false;
+            pos += leftover;
+            continue;
+        }
+        const char* payload = header + kHeaderSize;
+        pos += kHeaderSize + length;
+        switch (type) {
+            case ::openmldb::log::kFullType:
+                scratch.clear();
+                in_fragmented_record = false;
+                handler(payload, length, true);
+                break;
+            case ::openmldb::log::kFirstType:
+                scratch.assign(payload, length);
+                in_fragmented_record = true;
+                break;
+            case ::openmldb::log::kMiddleType:
+                // the fragments without the first one belong to the record of the previous range
+                if (in_fragmented_record) {
+                    scratch.append(payload, length);
+                }
+                break;
+            case ::openmldb::log::kLastType:
+                if (in_fragmented_record) {
+                    scratch.append(payload, length);
+                    handler(scratch.data(), scratch.size(), false);
+                    scratch.clear();
+                    in_fragmented_record = false;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return bad_cnt;
+}
+
+}  // namespace storage
+}  // namespace openmldb
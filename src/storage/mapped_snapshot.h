@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SRC_STORAGE_MAPPED_SNAPSHOT_H_
+#define SRC_STORAGE_MAPPED_SNAPSHOT_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace openmldb {
+namespace storage {
+
+// MappedSnapshot maps an uncompressed snapshot file read only, so that the rows
+// can be referred in place by the data blocks instead of being copied. The pages
+// are clean, the kernel reads them on demand and may drop them under memory pressure.
+// The mapping has to live as long as any data block referring to it.
+class MappedSnapshot {
+ public:
+    // the record is in the mapping if `mapped` is true, otherwise it is assembled
+    // from fragments and only valid in the callback
+    using RecordHandler = std::function<void(const char* data, uint32_t size, bool mapped)>;
+
+    // return NULL if the file fails to be mapped
+    static std::shared_ptr<MappedSnapshot> Open(const std::string& path);
+
+    ~MappedSnapshot();
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    const char* GetData() const { return data_; }
+    uint64_t GetSize() const { return size_; }
+    const std::string& GetPath() const { return path_; }
+
+    // the count of log blocks, records never start in the trailer of a block,
+    // so the blocks can be split into ranges and read in parallel
+    uint64_t GetBlockCnt() const;
+
+    // read the records starting in the blocks [begin_block, end_block), a record
+    // fragmented across end_block is read to its end. return the count of bad records
+    uint64_t ReadRecords(uint64_t begin_block, uint64_t end_block, bool checksum, const RecordHandler& handler) const;
+
+ private:
+    MappedSnapshot(const std::string& path, const char* data, uint64_t size)
+        : path_(path), data_(data), size_(size) {}
+
+    std::string path_;
+    const char* data_;
+    uint64_t size_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_MAPPED_SNAPSHOT_H_
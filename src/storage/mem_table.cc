@@ -17,6 +17,8 @@
 #include "storage/mem_table.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
 
 #include "base/glog_wapper.h"
@@ -24,6 +26,7 @@
 #include "base/slice.h"
 #include "common/timer.h"
 #include "gflags/gflags.h"
+#include "storage/read_snapshot.h"
 #include "storage/record.h"
 
 DECLARE_uint32(skiplist_max_height);
@@ -32,6 +35,18 @@ DECLARE_uint32(key_entry_max_height);
 DECLARE_uint32(absolute_default_skiplist_height);
 DECLARE_uint32(latest_default_skiplist_height);
 DECLARE_uint32(max_traverse_cnt);
+DECLARE_bool(enable_data_block_pool);
+DECLARE_bool(enable_latest_entries);
+DECLARE_bool(enable_key_hash_index);
+DECLARE_uint32(key_hash_index_init_bucket_cnt);
+DECLARE_uint32(latest_entries_init_capacity);
+DECLARE_uint32(compact_row_dict_size);
+DECLARE_uint32(compact_row_dict_value_len);
+DECLARE_uint32(gc_slice_budget_ms);
+DECLARE_uint32(gc_slice_interval_ms);
+DECLARE_bool(key_entry_adaptive_height);
+DECLARE_uint32(index_stat_sample_key_cnt);
+DECLARE_uint32(cold_row_age_min);
 
 namespace openmldb {
 namespace storage {
@@ -47,7 +62,8 @@ MemTable::MemTable(const std::string& name, uint32_t id, uint32_t pid, uint32_t
       enable_gc_(true),
       record_cnt_(0),
       segment_released_(false),
-      record_byte_size_(0) {}
+      record_byte_size_(0),
+      fixed_key_entry_height_(false) {}
 
 MemTable::MemTable(const ::openmldb::api::TableMeta& table_meta)
     : Table(table_meta.storage_mode(), table_meta.name(), table_meta.tid(), table_meta.pid(), 0, true, 60 * 1000,
@@ -59,6 +75,7 @@ MemTable::MemTable(const ::openmldb::api::TableMeta& table_meta)
     record_cnt_ = 0;
     segment_released_ = false;
     record_byte_size_ = 0;
+    fixed_key_entry_height_ = false;
     diskused_ = 0;
     table_meta_ = std::make_shared<::openmldb::api::TableMeta>(table_meta);
 }
@@ -88,10 +105,22 @@ bool MemTable::Init() {
     if (table_meta_->seg_cnt() > 0) {
         seg_cnt_ = table_meta_->seg_cnt();
     }
+    if (FLAGS_enable_data_block_pool) {
+        block_pool_.reset(new DataBlockPool());
+    }
+    if (table_meta_->compact_row() && compress_type_ == ::openmldb::type::kNoCompress) {
+        row_codec_.reset(new codec::CompactRowCodec(FLAGS_compact_row_dict_size, FLAGS_compact_row_dict_value_len));
+        row_codec_->SetVersionSchema(GetAllVersionSchema());
+        PDLOG(INFO, "keep the rows in the compact format. tid %u pid %u", id_, pid_);
+    }
+    if (FLAGS_cold_row_age_min > 0 && compress_type_ == ::openmldb::type::kNoCompress) {
+        cold_codec_.reset(new codec::ColdRowCodec());
+    }
     uint32_t global_key_entry_max_height = 0;
     if (table_meta_->has_key_entry_max_height() && table_meta_->key_entry_max_height() <= FLAGS_skiplist_max_height &&
         table_meta_->key_entry_max_height() > 0) {
         global_key_entry_max_height = table_meta_->key_entry_max_height();
+        fixed_key_entry_height_ = true;
     }
     auto inner_indexs = table_index_.GetAllInnerIndex();
     for (uint32_t i = 0; i < inner_indexs->size(); i++) {
@@ -103,19 +132,38 @@ bool MemTable::Init() {
             cur_key_entry_max_height = inner_indexs->at(i)->GetKeyEntryMaxHeight(FLAGS_absolute_default_skiplist_height,
                                                                                  FLAGS_latest_default_skiplist_height);
         }
+        // the latest-only index with single ts keeps the rows in ring instead of skiplist
+        uint32_t latest_capacity = 0;
+        uint64_t lat_ttl = inner_indexs->at(i)->GetLatestOnlyTTL();
+        if (FLAGS_enable_latest_entries && ts_vec.size() <= 1 && lat_ttl > 0) {
+            latest_capacity = std::min(lat_ttl, static_cast<uint64_t>(FLAGS_latest_entries_init_capacity));
+        }
         Segment** seg_arr = new Segment*[seg_cnt_];
         if (!ts_vec.empty()) {
             for (uint32_t j = 0; j < seg_cnt_; j++) {
                 seg_arr[j] = new Segment(cur_key_entry_max_height, ts_vec);
+                seg_arr[j]->SetDataBlockPool(block_pool_.get());
                 PDLOG(INFO, "init %u, %u segment. height %u, ts col num %u. tid %u pid %u", i, j,
                       cur_key_entry_max_height, ts_vec.size(), id_, pid_);
             }
         } else {
             for (uint32_t j = 0; j < seg_cnt_; j++) {
                 seg_arr[j] = new Segment(cur_key_entry_max_height);
+                seg_arr[j]->SetDataBlockPool(block_pool_.get());
                 PDLOG(INFO, "init %u, %u segment. height %u tid %u pid %u", i, j, cur_key_entry_max_height, id_, pid_);
             }
         }
+        if (latest_capacity > 0) {
+            for (uint32_t j = 0; j < seg_cnt_; j++) {
+                seg_arr[j]->EnableLatestEntries(latest_capacity);
+            }
+            PDLOG(INFO, "index %u uses latest entries. capacity %u tid %u pid %u", i, latest_capacity, id_, pid_);
+        }
+        if (FLAGS_enable_key_hash_index) {
+            for (uint32_t j = 0; j < seg_cnt_; j++) {
+                seg_arr[j]->EnableKeyHashIndex(FLAGS_key_hash_index_init_bucket_cnt);
+            }
+        }
         segments_[i] = seg_arr;
         key_entry_max_height_ = cur_key_entry_max_height;
     }
@@ -141,25 +189,26 @@ bool MemTable::Put(const std::string& pk, uint64_t time, const char* data, uint3
     return true;
 }
 
-bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& dimensions) {
+bool MemTable::PreparePut(uint64_t time, const Slice& value, const Dimensions& dimensions,
+                          std::map<int32_t, Slice>* inner_index_key_map, std::map<int32_t, uint64_t>* ts_map,
+                          uint32_t* real_ref_cnt) {
     if (dimensions.empty()) {
         PDLOG(WARNING, "empty dimension. tid %u pid %u", id_, pid_);
         return false;
     }
-    if (value.length() < codec::HEADER_LENGTH) {
+    if (value.size() < codec::HEADER_LENGTH) {
         PDLOG(WARNING, "invalid value. tid %u pid %u", id_, pid_);
         return false;
     }
-    std::map<int32_t, Slice> inner_index_key_map;
     for (auto iter = dimensions.begin(); iter != dimensions.end(); iter++) {
         int32_t inner_pos = table_index_.GetInnerIndexPos(iter->idx());
         if (inner_pos < 0) {
             PDLOG(WARNING, "invalid dimension. dimension idx %u, tid %u pid %u", iter->idx(), id_, pid_);
             return false;
         }
-        inner_index_key_map.emplace(inner_pos, iter->key());
+        inner_index_key_map->emplace(inner_pos, iter->key());
     }
-    uint32_t real_ref_cnt = 0;
+    *real_ref_cnt = 0;
     const int8_t* data = reinterpret_cast<const int8_t*>(value.data());
     uint8_t version = codec::RowView::GetSchemaVersion(data);
     auto decoder = GetVersionDecoder(version);
@@ -167,8 +216,7 @@ bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& di
         PDLOG(WARNING, "invalid schema version %u, tid %u pid %u", version, id_, pid_);
         return false;
     }
-    std::map<int32_t, uint64_t> ts_map;
-    for (const auto& kv : inner_index_key_map) {
+    for (const auto& kv : *inner_index_key_map) {
         auto inner_index = table_index_.GetInnerIndex(kv.first);
         if (!inner_index) {
             PDLOG(WARNING, "invalid inner index pos %d. tid %u pid %u", kv.first, id_, pid_);
@@ -184,28 +232,90 @@ bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& di
                     PDLOG(WARNING, "get ts failed. tid %u pid %u", id_, pid_);
                     return false;
                 }
-                ts_map.emplace(ts_col->GetId(), ts);
+                ts_map->emplace(ts_col->GetId(), ts);
             }
             if (index_def->IsReady()) {
-                real_ref_cnt++;
+                (*real_ref_cnt)++;
             }
         }
     }
-    if (ts_map.empty()) {
+    return !ts_map->empty();
+}
+
+bool MemTable::NeedPut(int32_t inner_pos) {
+    auto inner_index = table_index_.GetInnerIndex(inner_pos);
+    for (const auto& index_def : inner_index->GetIndex()) {
+        if (index_def->IsReady()) {
+            // TODO(hw): if we don't find this ts(has_found_ts==false), but it's ready, will put too?
+            return true;
+        }
+    }
+    return false;
+}
+
+DataBlock* MemTable::NewDataBlock(uint32_t ref_cnt, const std::string& value) {
+    if (row_codec_) {
+        std::string compact;
+        if (row_codec_->Encode(value.data(), value.size(), &compact) && compact.size() < value.size()) {
+            return new DataBlock(ref_cnt, compact.c_str(), compact.length(), block_pool_.get());
+        }
+    }
+    return new DataBlock(ref_cnt, value.c_str(), value.length(), block_pool_.get());
+}
+
+void MemTable::SetTableMeta(::openmldb::api::TableMeta& table_meta) {  // NOLINT
+    Table::SetTableMeta(table_meta);
+    if (row_codec_) {
+        row_codec_->SetVersionSchema(GetAllVersionSchema());
+    }
+}
+
+bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& dimensions) {
+    std::map<int32_t, Slice> inner_index_key_map;
+    std::map<int32_t, uint64_t> ts_map;
+    uint32_t real_ref_cnt = 0;
+    if (!PreparePut(time, value, dimensions, &inner_index_key_map, &ts_map, &real_ref_cnt)) {
         return false;
     }
-    auto* block = new DataBlock(real_ref_cnt, value.c_str(), value.length());
-    for (const auto& kv : inner_index_key_map) {
-        auto inner_index = table_index_.GetInnerIndex(kv.first);
-        bool need_put = false;
-        for (const auto& index_def : inner_index->GetIndex()) {
-            if (index_def->IsReady()) {
-                // TODO(hw): if we don't find this ts(has_found_ts==false), but it's ready, will put too?
-                need_put = true;
-                break;
-            }
+    PutBlock(inner_index_key_map, ts_map, NewDataBlock(real_ref_cnt, value));
+    return true;
+}
+
+bool MemTable::PutMapped(uint64_t time, const char* data, uint32_t size, const Dimensions& dimensions) {
+    std::map<int32_t, Slice> inner_index_key_map;
+    std::map<int32_t, uint64_t> ts_map;
+    uint32_t real_ref_cnt = 0;
+    Slice value(data, size);
+    if (!PreparePut(time, value, dimensions, &inner_index_key_map, &ts_map, &real_ref_cnt)) {
+        return false;
+    }
+    DataBlock* block = nullptr;
+    if (row_codec_) {
+        std::string compact;
+        if (row_codec_->Encode(data, size, &compact) && compact.size() < size) {
+            block = new DataBlock(real_ref_cnt, compact.c_str(), compact.length(), block_pool_.get());
         }
-        if (need_put) {
+    }
+    if (block == nullptr) {
+        block = DataBlock::Refer(real_ref_cnt, data, size);
+    }
+    PutBlock(inner_index_key_map, ts_map, block);
+    return true;
+}
+
+void MemTable::HoldMappedSnapshot(const std::shared_ptr<MappedSnapshot>& mapped) {
+    std::lock_guard<std::mutex> lock(mapped_mu_);
+    mapped_snapshots_.push_back(mapped);
+}
+
+void MemTable::PutBlock(const std::map<int32_t, Slice>& inner_index_key_map, const std::map<int32_t, uint64_t>& ts_map,
+                        DataBlock* block) {
+#ifdef SNAPSHOT_READ_ENABLE
+    uint32_t slot = 0;
+    block->seq = BeginPutSeq(1, &slot);
+#endif
+    for (const auto& kv : inner_index_key_map) {
+        if (NeedPut(kv.first)) {
             uint32_t seg_idx = 0;
             if (seg_cnt_ > 1) {
                 seg_idx = ::openmldb::base::hash(kv.second.data(), kv.second.size(), SEED) % seg_cnt_;
@@ -215,8 +325,112 @@ bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& di
         }
     }
     record_cnt_.fetch_add(1, std::memory_order_relaxed);
-    record_byte_size_.fetch_add(GetRecordSize(value.length()));
-    return true;
+    record_byte_size_.fetch_add(GetRecordSize(block->size));
+#ifdef SNAPSHOT_READ_ENABLE
+    EndPutSeq(slot);
+#endif
+}
+
+#ifdef SNAPSHOT_READ_ENABLE
+uint64_t MemTable::BeginPutSeq(uint32_t cnt, uint32_t* slot) {
+    // the threads start from different slots, so they rarely race for one
+    static thread_local uint32_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % kPutSlotCnt;
+    // the slot keeps a bound loaded before the seq is taken, so a reader finding no slot below the next seq it loaded
+    // knows the puts below it are all inserted
+    uint64_t bound = put_seq_.load();
+    for (uint32_t i = start;; i = (i + 1) % kPutSlotCnt) {
+        uint64_t free_slot = kFreePutSlot;
+        if (put_slots_[i].seq.compare_exchange_strong(free_slot, bound)) {
+            *slot = i;
+            break;
+        }
+        if ((i + 1) % kPutSlotCnt == start) {
+            // more puts than the slots are running
+            std::this_thread::yield();
+        }
+    }
+    return put_seq_.fetch_add(cnt);
+}
+
+void MemTable::EndPutSeq(uint32_t slot) { put_slots_[slot].seq.store(kFreePutSlot); }
+#endif
+
+uint64_t MemTable::GetReadSeq() const {
+#ifdef SNAPSHOT_READ_ENABLE
+    uint64_t seq = put_seq_.load();
+    for (const auto& slot : put_slots_) {
+        seq = std::min(seq, slot.seq.load());
+    }
+    // a slot may be taken with an older bound after the seq returned before, which is kept as the least read seq
+    uint64_t committed = committed_seq_.load(std::memory_order_relaxed);
+    while (committed < seq && !committed_seq_.compare_exchange_weak(committed, seq, std::memory_order_relaxed)) {
+    }
+    return std::max(committed, seq);
+#else
+    return 0;
+#endif
+}
+
+void MemTable::BatchPut(const std::vector<const ::openmldb::api::PutRequest*>& requests,
+                        std::vector<bool>* results) {
+    struct SegmentPut {
+        int32_t inner_pos;
+        uint32_t seg_idx;
+        uint32_t row;
+        Slice key;
+    };
+    results->assign(requests.size(), false);
+    std::vector<std::map<int32_t, uint64_t>> ts_maps(requests.size());
+    std::vector<DataBlock*> blocks(requests.size(), nullptr);
+    std::vector<SegmentPut> puts;
+    uint64_t byte_size = 0;
+    uint32_t cnt = 0;
+    for (uint32_t i = 0; i < requests.size(); i++) {
+        const auto* request = requests[i];
+        std::map<int32_t, Slice> inner_index_key_map;
+        uint32_t real_ref_cnt = 0;
+        if (!PreparePut(request->time(), request->value(), request->dimensions(), &inner_index_key_map,
+                        &ts_maps[i], &real_ref_cnt)) {
+            continue;
+        }
+        blocks[i] = NewDataBlock(real_ref_cnt, request->value());
+        for (const auto& kv : inner_index_key_map) {
+            if (NeedPut(kv.first)) {
+                uint32_t seg_idx = 0;
+                if (seg_cnt_ > 1) {
+                    seg_idx = ::openmldb::base::hash(kv.second.data(), kv.second.size(), SEED) % seg_cnt_;
+                }
+                puts.push_back({kv.first, seg_idx, i, kv.second});
+            }
+        }
+        (*results)[i] = true;
+        byte_size += GetRecordSize(blocks[i]->size);
+        cnt++;
+    }
+    // the rows of the same segment keep their order, so the later row of one key is still inserted later
+    std::stable_sort(puts.begin(), puts.end(), [](const SegmentPut& a, const SegmentPut& b) {
+        return a.inner_pos < b.inner_pos || (a.inner_pos == b.inner_pos && a.seg_idx < b.seg_idx);
+    });
+#ifdef SNAPSHOT_READ_ENABLE
+    uint32_t slot = 0;
+    uint64_t first_seq = cnt > 0 ? BeginPutSeq(cnt, &slot) : 0;
+    uint64_t seq = first_seq;
+    for (auto* block : blocks) {
+        if (block != nullptr) {
+            block->seq = seq++;
+        }
+    }
+#endif
+    for (const auto& put : puts) {
+        segments_[put.inner_pos][put.seg_idx]->Put(put.key, ts_maps[put.row], blocks[put.row]);
+    }
+    record_cnt_.fetch_add(cnt, std::memory_order_relaxed);
+    record_byte_size_.fetch_add(byte_size);
+#ifdef SNAPSHOT_READ_ENABLE
+    if (cnt > 0) {
+        EndPutSeq(slot);
+    }
+#endif
 }
 
 bool MemTable::Delete(const std::string& pk, uint32_t idx) {
@@ -254,6 +468,28 @@ uint64_t MemTable::Release() {
     return total_cnt;
 }
 
+uint64_t MemTable::ReleaseForDrop(uint32_t yield_key_cnt, const std::function<void()>& yield) {
+    if (segment_released_ || segments_.empty()) {
+        return 0;
+    }
+    uint64_t total_cnt = 0;
+    for (uint32_t i = 0; i < segments_.size(); i++) {
+        if (segments_[i] != NULL) {
+            for (uint32_t j = 0; j < seg_cnt_; j++) {
+                total_cnt += segments_[i][j]->Release(yield_key_cnt, yield, false);
+                delete segments_[i][j];
+            }
+            delete[] segments_[i];
+        }
+    }
+    segment_released_ = true;
+    segments_.clear();
+    // the pooled payloads left by the segments are freed with the slabs
+    block_pool_.reset();
+    PDLOG(INFO, "release memtable for drop. tid %u pid %u released record cnt %lu", id_, pid_, total_cnt);
+    return total_cnt;
+}
+
 void MemTable::SchedGc() {
     uint64_t consumed = ::baidu::common::timer::get_micros();
     PDLOG(INFO, "start making gc for table %s, tid %u, pid %u", name_.c_str(), id_, pid_);
@@ -261,6 +497,7 @@ void MemTable::SchedGc() {
     uint64_t gc_record_cnt = 0;
     uint64_t gc_record_byte_size = 0;
     auto inner_indexs = table_index_.GetAllInnerIndex();
+    gc_stat_.StartRound(inner_indexs->size() * seg_cnt_);
     for (uint32_t i = 0; i < inner_indexs->size(); i++) {
         const std::vector<std::shared_ptr<IndexDef>>& real_index = inner_indexs->at(i)->GetIndex();
         std::map<uint32_t, TTLSt> ttl_st_map;
@@ -299,29 +536,224 @@ void MemTable::SchedGc() {
         if (deleted_num == real_index.size() || ttl_st_map.empty()) {
             continue;
         }
+        uint64_t budget_us = FLAGS_gc_slice_budget_ms * 1000;
         for (uint32_t j = 0; j < seg_cnt_; j++) {
             uint64_t seg_gc_time = ::baidu::common::timer::get_micros() / 1000;
             Segment* segment = segments_[i][j];
             segment->IncrGcVersion();
+            uint64_t slice_time = ::baidu::common::timer::get_micros();
             segment->GcFreeList(gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
-            if (ttl_st_map.size() == 1) {
-                segment->ExecuteGc(ttl_st_map.begin()->second, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
-            } else {
-                segment->ExecuteGc(ttl_st_map, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+            uint32_t slice_cnt = 0;
+            while (true) {
+                bool finished = false;
+                if (ttl_st_map.size() == 1) {
+                    finished = segment->ExecuteGcSlice(ttl_st_map.begin()->second, budget_us, gc_idx_cnt,
+                                                       gc_record_cnt, gc_record_byte_size);
+                } else {
+                    finished =
+                        segment->ExecuteGcSlice(ttl_st_map, budget_us, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+                }
+                gc_stat_.AddPause(::baidu::common::timer::get_micros() - slice_time);
+                slice_cnt++;
+                if (finished || !enable_gc_.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                // yield to the readers and writers between two slices
+                std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_gc_slice_interval_ms));
+                slice_time = ::baidu::common::timer::get_micros();
             }
+            gc_stat_.FinishSegment();
             seg_gc_time = ::baidu::common::timer::get_micros() / 1000 - seg_gc_time;
-            PDLOG(INFO, "gc segment[%u][%u] done consumed %lu for table %s tid %u pid %u", i, j, seg_gc_time,
-                  name_.c_str(), id_, pid_);
+            PDLOG(INFO, "gc segment[%u][%u] done consumed %lu with %u slices for table %s tid %u pid %u", i, j,
+                  seg_gc_time, slice_cnt, name_.c_str(), id_, pid_);
         }
     }
     consumed = ::baidu::common::timer::get_micros() - consumed;
+    gc_stat_.FinishRound(consumed, gc_record_cnt, gc_record_byte_size);
     record_cnt_.fetch_sub(gc_record_cnt, std::memory_order_relaxed);
     record_byte_size_.fetch_sub(gc_record_byte_size, std::memory_order_relaxed);
     PDLOG(INFO,
           "gc finished, gc_idx_cnt %lu, gc_record_cnt %lu consumed %lu ms for "
           "table %s tid %u pid %u",
           gc_idx_cnt, gc_record_cnt, consumed / 1000, name_.c_str(), id_, pid_);
+    if (enable_gc_.load(std::memory_order_relaxed)) {
+        CompressColdRows();
+    }
     UpdateTTL();
+    AdaptKeyEntryHeight();
+    UpdateIndexStats();
+}
+
+void MemTable::CompressColdRows() {
+    if (!cold_codec_) {
+        return;
+    }
+    uint64_t cold_time = ::baidu::common::timer::get_micros() / 1000 - FLAGS_cold_row_age_min * 60 * 1000;
+    auto inner_indexs = table_index_.GetAllInnerIndex();
+    if (!cold_codec_->IsTrained()) {
+        // the dictionary is trained from the first cold rows, the rows put later share most of their bytes
+        std::string samples;
+        for (uint32_t i = 0; i < inner_indexs->size() && samples.size() < codec::ColdRowCodec::kMaxDictSize; i++) {
+            if (!NeedPut(i)) {
+                continue;
+            }
+            for (uint32_t j = 0; j < seg_cnt_ && samples.size() < codec::ColdRowCodec::kMaxDictSize; j++) {
+                segments_[i][j]->SampleColdRows(cold_time, codec::ColdRowCodec::kMaxDictSize, &samples);
+            }
+        }
+        if (samples.empty()) {
+            return;
+        }
+        cold_codec_->Train(samples);
+    }
+    uint64_t row_cnt = 0;
+    uint64_t saved_byte_size = 0;
+    for (uint32_t i = 0; i < inner_indexs->size(); i++) {
+        if (!NeedPut(i)) {
+            continue;
+        }
+        for (uint32_t j = 0; j < seg_cnt_; j++) {
+            segments_[i][j]->CompressColdRows(cold_time, *cold_codec_, &row_cnt, &saved_byte_size);
+        }
+    }
+    gc_stat_.AddColdRows(row_cnt, saved_byte_size);
+    PDLOG(INFO, "compressed %lu cold rows saving %lu bytes for table %s tid %u pid %u", row_cnt, saved_byte_size,
+          name_.c_str(), id_, pid_);
+}
+
+void MemTable::UpdateIndexStats() {
+    std::map<uint32_t, IndexStat> stats;
+    // the sampled keys are spread over the segments
+    uint32_t sample_key_cnt = (FLAGS_index_stat_sample_key_cnt + seg_cnt_ - 1) / seg_cnt_;
+    for (const auto& index_def : table_index_.GetAllIndex()) {
+        if (!index_def || !index_def->IsReady()) {
+            continue;
+        }
+        uint32_t inner_pos = index_def->GetInnerPos();
+        if (inner_pos >= segments_.size() || segments_[inner_pos] == NULL) {
+            continue;
+        }
+        auto ts_col = index_def->GetTsColumn();
+        uint32_t ts_idx = ts_col ? ts_col->GetId() : 0;
+        IndexStat stat;
+        bool sampled = false;
+        for (uint32_t j = 0; j < seg_cnt_; j++) {
+            Segment* segment = segments_[inner_pos][j];
+            stat.key_cnt += segment->GetPkCnt();
+            uint64_t idx_cnt = 0;
+            if (segment->GetTsCnt() > 1) {
+                segment->GetIdxCnt(ts_idx, idx_cnt);
+            } else {
+                idx_cnt = segment->GetIdxCnt();
+            }
+            stat.record_cnt += idx_cnt;
+            uint64_t min_ts = 0;
+            uint64_t max_ts = 0;
+            if (sample_key_cnt > 0 && segment->SampleTsRange(ts_idx, sample_key_cnt, &min_ts, &max_ts)) {
+                stat.min_ts = sampled ? std::min(stat.min_ts, min_ts) : min_ts;
+                stat.max_ts = sampled ? std::max(stat.max_ts, max_ts) : max_ts;
+                sampled = true;
+            }
+        }
+        stats.emplace(index_def->GetId(), stat);
+    }
+    std::lock_guard<std::mutex> lock(index_stat_mu_);
+    index_stats_.swap(stats);
+}
+
+bool MemTable::GetIndexStat(uint32_t idx, IndexStat* stat) {
+    std::lock_guard<std::mutex> lock(index_stat_mu_);
+    auto it = index_stats_.find(idx);
+    if (it == index_stats_.end()) {
+        return false;
+    }
+    *stat = it->second;
+    return true;
+}
+
+bool MemTable::GetIndexMemStat(uint32_t idx, IndexMemStat* stat) {
+    auto index_def = table_index_.GetIndex(idx);
+    if (!index_def || !index_def->IsReady()) {
+        return false;
+    }
+    uint32_t inner_pos = index_def->GetInnerPos();
+    if (inner_pos >= segments_.size() || segments_[inner_pos] == NULL) {
+        return false;
+    }
+    auto ts_col = index_def->GetTsColumn();
+    uint32_t ts_idx = ts_col ? ts_col->GetId() : 0;
+    for (uint32_t j = 0; j < seg_cnt_; j++) {
+        segments_[inner_pos][j]->CollectMemStat(ts_idx, stat);
+    }
+    return true;
+}
+
+// the lowest height whose skiplist of branch 4 fits the rows of a key
+static uint32_t GetAdaptedKeyEntryHeight(uint64_t rows_per_key) {
+    uint32_t height = 1;
+    uint64_t capacity = 1;
+    while (capacity < rows_per_key && height < FLAGS_skiplist_max_height) {
+        capacity *= 4;
+        height++;
+    }
+    return height;
+}
+
+void MemTable::AdaptKeyEntryHeight() {
+    if (!FLAGS_key_entry_adaptive_height || fixed_key_entry_height_) {
+        return;
+    }
+    auto inner_indexs = table_index_.GetAllInnerIndex();
+    for (uint32_t i = 0; i < inner_indexs->size(); i++) {
+        if (segments_[i] == NULL || segments_[i][0]->IsLatestEntries()) {
+            continue;
+        }
+        uint64_t idx_cnt = 0;
+        uint64_t pk_cnt = 0;
+        for (uint32_t j = 0; j < seg_cnt_; j++) {
+            idx_cnt += segments_[i][j]->GetIdxCnt();
+            pk_cnt += segments_[i][j]->GetPkCnt();
+        }
+        if (pk_cnt == 0) {
+            continue;
+        }
+        uint32_t height = GetAdaptedKeyEntryHeight((idx_cnt + pk_cnt - 1) / pk_cnt);
+        if (height == segments_[i][0]->GetKeyEntryMaxHeight()) {
+            continue;
+        }
+        for (uint32_t j = 0; j < seg_cnt_; j++) {
+            segments_[i][j]->SetKeyEntryMaxHeight(height);
+        }
+        PDLOG(INFO, "adapt key entry height of inner index %u to %u with %lu rows of %lu keys. tid %u pid %u", i,
+              height, idx_cnt, pk_cnt, id_, pid_);
+    }
+}
+
+std::vector<uint32_t> MemTable::GetKeyEntryHeights() const {
+    std::vector<uint32_t> heights;
+    auto inner_indexs = table_index_.GetAllInnerIndex();
+    for (uint32_t i = 0; i < inner_indexs->size(); i++) {
+        heights.push_back(segments_[i] == NULL ? 0 : segments_[i][0]->GetKeyEntryMaxHeight());
+    }
+    return heights;
+}
+
+void MemTable::SetKeyEntryHeights(const std::vector<uint32_t>& heights) {
+    if (!FLAGS_key_entry_adaptive_height || fixed_key_entry_height_) {
+        return;
+    }
+    auto inner_indexs = table_index_.GetAllInnerIndex();
+    if (heights.size() != inner_indexs->size()) {
+        return;
+    }
+    for (uint32_t i = 0; i < inner_indexs->size(); i++) {
+        if (segments_[i] == NULL || heights[i] == 0 || heights[i] > FLAGS_skiplist_max_height) {
+            continue;
+        }
+        for (uint32_t j = 0; j < seg_cnt_; j++) {
+            segments_[i][j]->SetKeyEntryMaxHeight(heights[i]);
+        }
+    }
 }
 
 // tll as ms
@@ -442,6 +874,22 @@ int MemTable::GetCount(uint32_t index, const std::string& pk, uint64_t& count) {
     return segment->GetCount(spk, count);
 }
 
+int MemTable::GetUnexpiredCount(uint32_t index, const std::string& pk, uint64_t expire_time, uint64_t expire_cnt,
+                                uint64_t* count) {
+    std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(index);
+    if (!index_def || !index_def->IsReady()) {
+        return -1;
+    }
+    uint32_t seg_idx = 0;
+    if (seg_cnt_ > 1) {
+        seg_idx = ::openmldb::base::hash(pk.c_str(), pk.length(), SEED) % seg_cnt_;
+    }
+    Segment* segment = segments_[index_def->GetInnerPos()][seg_idx];
+    auto ts_col = index_def->GetTsColumn();
+    uint32_t ts_idx = ts_col ? ts_col->GetId() : 0;
+    return segment->GetUnexpiredCount(Slice(pk), ts_idx, expire_time, expire_cnt, index_def->GetTTLType(), count);
+}
+
 TableIterator* MemTable::NewIterator(const std::string& pk, Ticket& ticket) { return NewIterator(0, pk, ticket); }
 
 TableIterator* MemTable::NewIterator(uint32_t index, const std::string& pk, Ticket& ticket) {
@@ -458,10 +906,11 @@ TableIterator* MemTable::NewIterator(uint32_t index, const std::string& pk, Tick
     uint32_t real_idx = index_def->GetInnerPos();
     Segment* segment = segments_[real_idx][seg_idx];
     auto ts_col = index_def->GetTsColumn();
-    if (ts_col) {
-        return segment->NewIterator(spk, ts_col->GetId(), ticket);
-    }
-    return segment->NewIterator(spk, ticket);
+    MemTableIterator* it =
+        ts_col ? segment->NewIterator(spk, ts_col->GetId(), ticket) : segment->NewIterator(spk, ticket);
+    it->SetRowCodec(row_codec_.get());
+    it->SetColdCodec(cold_codec_.get());
+    return it;
 }
 
 uint64_t MemTable::GetRecordIdxByteSize() {
@@ -591,6 +1040,10 @@ bool MemTable::AddIndex(const ::openmldb::common::ColumnKey& column_key) {
         Segment** seg_arr = new Segment*[seg_cnt_];
         for (uint32_t j = 0; j < seg_cnt_; j++) {
             seg_arr[j] = new Segment(FLAGS_absolute_default_skiplist_height, ts_vec);
+            seg_arr[j]->SetDataBlockPool(block_pool_.get());
+            if (FLAGS_enable_key_hash_index) {
+                seg_arr[j]->EnableKeyHashIndex(FLAGS_key_hash_index_init_bucket_cnt);
+            }
             PDLOG(INFO, "init %u, %u segment. height %u, ts col num %u. tid %u pid %u", inner_id, j,
                   FLAGS_absolute_default_skiplist_height, ts_vec.size(), id_, pid_);
         }
@@ -649,6 +1102,10 @@ bool MemTable::DeleteIndex(const std::string& idx_name) {
 }
 
 ::hybridse::vm::WindowIterator* MemTable::NewWindowIterator(uint32_t index) {
+    return NewPrunedWindowIterator(index, {});
+}
+
+::hybridse::vm::WindowIterator* MemTable::NewPrunedWindowIterator(uint32_t index, const ScanHint& hint) {
     std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(index);
     if (!index_def || !index_def->IsReady()) {
         LOG(WARNING) << "index id " << index << "  not found. tid " << id_ << " pid " << pid_;
@@ -667,14 +1124,28 @@ bool MemTable::DeleteIndex(const std::string& idx_name) {
     if (ts_col) {
         ts_idx = ts_col->GetId();
     }
-    return new MemTableKeyIterator(segments_[real_idx], seg_cnt_, ttl->ttl_type, expire_time, expire_cnt, ts_idx);
+    auto* it = new MemTableKeyIterator(segments_[real_idx], seg_cnt_, ttl->ttl_type, expire_time, expire_cnt, ts_idx);
+    it->SetRowCodec(row_codec_.get());
+    it->SetColdCodec(cold_codec_.get());
+    it->SetHint(hint);
+    auto* snapshot = ReadSnapshot::Current();
+    if (snapshot != nullptr) {
+        it->SetReadSeq(snapshot->Pin(id_, pid_, GetReadSeq()));
+    }
+    return it;
 }
 
 TraverseIterator* MemTable::NewTraverseIterator(uint32_t index) {
+    auto its = NewTraverseIterators(index, 1);
+    return its.empty() ? NULL : its[0];
+}
+
+std::vector<TraverseIterator*> MemTable::NewTraverseIterators(uint32_t index, uint32_t part_num) {
+    std::vector<TraverseIterator*> its;
     std::shared_ptr<IndexDef> index_def = GetIndex(index);
     if (!index_def || !index_def->IsReady()) {
         PDLOG(WARNING, "index %u not found. tid %u pid %u", index, id_, pid_);
-        return NULL;
+        return its;
     }
     uint64_t expire_time = 0;
     uint64_t expire_cnt = 0;
@@ -685,11 +1156,22 @@ TraverseIterator* MemTable::NewTraverseIterator(uint32_t index) {
     }
     uint32_t real_idx = index_def->GetInnerPos();
     auto ts_col = index_def->GetTsColumn();
-    if (ts_col) {
-        return new MemTableTraverseIterator(segments_[real_idx], seg_cnt_, ttl->ttl_type, expire_time, expire_cnt,
-                                            ts_col->GetId());
+    auto* snapshot = ReadSnapshot::Current();
+    uint64_t read_seq = snapshot != nullptr ? snapshot->Pin(id_, pid_, GetReadSeq()) : 0;
+    // the expire time is computed once, so all parts see the same rows
+    part_num = std::max(std::min(part_num, seg_cnt_), 1u);
+    for (uint32_t i = 0; i < part_num; i++) {
+        auto* it = new MemTableTraverseIterator(segments_[real_idx], seg_cnt_, ttl->ttl_type, expire_time, expire_cnt,
+                                                ts_col ? ts_col->GetId() : 0);
+        it->SetRowCodec(row_codec_.get());
+        it->SetColdCodec(cold_codec_.get());
+        it->SetReadSeq(read_seq);
+        if (part_num > 1) {
+            it->SetSegmentRange(seg_cnt_ * i / part_num, seg_cnt_ * (i + 1) / part_num);
+        }
+        its.push_back(it);
     }
-    return new MemTableTraverseIterator(segments_[real_idx], seg_cnt_, ttl->ttl_type, expire_time, expire_cnt, 0);
+    return its;
 }
 
 bool MemTable::GetBulkLoadInfo(::openmldb::api::BulkLoadInfoResponse* response) {
@@ -739,6 +1221,7 @@ bool MemTable::GetBulkLoadInfo(::openmldb::api::BulkLoadInfoResponse* response)
 bool MemTable::BulkLoad(const std::vector<DataBlock*>& data_blocks,
                         const ::google::protobuf::RepeatedPtrField<::openmldb::api::BulkLoadIndex>& indexes) {
     // data_block[i] is the block which id == i
+    std::vector<std::pair<uint64_t, DataBlock*>> rows;
     for (int i = 0; i < indexes.size(); ++i) {
         const auto& inner_index = indexes.Get(i);
         auto real_idx = inner_index.inner_index_id();
@@ -752,6 +1235,7 @@ bool MemTable::BulkLoad(const std::vector<DataBlock*>& data_blocks,
                 for (int key_entry_idx = 0; key_entry_idx < key_entries.key_entry_size(); ++key_entry_idx) {
                     const auto& key_entry = key_entries.key_entry(key_entry_idx);
                     auto key_entry_id = key_entry.key_entry_id();
+                    rows.clear();
                     for (int time_idx = 0; time_idx < key_entry.time_entry_size(); ++time_idx) {
                         const auto& time_entry = key_entry.time_entry(time_idx);
                         auto* block =
@@ -766,8 +1250,11 @@ bool MemTable::BulkLoad(const std::vector<DataBlock*>& data_blocks,
                                 << ", time " << time_entry.time() << ", key_entry_id " << key_entry_id << ", block id "
                                 << time_entry.block_id();
                         block->dim_cnt_down++;
-                        segment->BulkLoadPut(key_entry_id, pk, time_entry.time(), block);
+                        rows.emplace_back(time_entry.time(), block);
                     }
+                    // the time entries built by the sdk are in ascending order, so they are attached to the head
+                    // of the skiplist one by one
+                    segment->BulkLoadPut(key_entry_id, pk, rows);
                 }
             }
         }
@@ -838,18 +1325,10 @@ bool MemTableKeyIterator::Valid() {
 void MemTableKeyIterator::Next() { NextPK(); }
 
 ::hybridse::vm::RowIterator* MemTableKeyIterator::GetRawValue() {
-    TimeEntries::Iterator* it = NULL;
-    if (segments_[seg_idx_]->GetTsCnt() > 1) {
-        KeyEntry* entry = ((KeyEntry**)pk_it_->GetValue())[ts_idx_];  // NOLINT
-        it = entry->entries.NewIterator();
-        ticket_.Push(entry);
-    } else {
-        it = ((KeyEntry*)pk_it_->GetValue())  // NOLINT
-                 ->entries.NewIterator();
-        ticket_.Push((KeyEntry*)pk_it_->GetValue());  // NOLINT
-    }
+    TimeEntryIterator* it =
+        segments_[seg_idx_]->NewTimeEntryIterator(pk_it_->GetValue(), ts_idx_, ticket_, read_seq_);
     it->SeekToFirst();
-    return new MemTableWindowIterator(it, ttl_type_, expire_time_, expire_cnt_);
+    return new MemTableWindowIterator(it, ttl_type_, expire_time_, expire_cnt_, row_codec_, hint_, cold_codec_);
 }
 
 std::unique_ptr<::hybridse::vm::RowIterator> MemTableKeyIterator::GetValue() {
@@ -889,6 +1368,8 @@ MemTableTraverseIterator::MemTableTraverseIterator(Segment** segments, uint32_t
                                                    uint64_t expire_cnt, uint32_t ts_index)
     : segments_(segments),
       seg_cnt_(seg_cnt),
+      seg_begin_(0),
+      seg_end_(seg_cnt),
       seg_idx_(0),
       pk_it_(NULL),
       it_(NULL),
@@ -896,7 +1377,12 @@ MemTableTraverseIterator::MemTableTraverseIterator(Segment** segments, uint32_t
       ts_idx_(0),
       expire_value_(expire_time, expire_cnt, ttl_type),
       ticket_(),
-      traverse_cnt_(0) {
+      traverse_cnt_(0),
+      row_codec_(nullptr),
+      cold_codec_(nullptr),
+      buf_(),
+      cold_buf_(),
+      read_seq_(0) {
     uint32_t idx = 0;
     if (segments_[0]->GetTsIdx(ts_index, idx) == 0) {
         ts_idx_ = idx;
@@ -936,7 +1422,7 @@ void MemTableTraverseIterator::NextPK() {
             delete pk_it_;
             pk_it_ = NULL;
             seg_idx_++;
-            if (seg_idx_ < seg_cnt_) {
+            if (seg_idx_ < seg_end_) {
                 pk_it_ = segments_[seg_idx_]->GetKeyEntries()->NewIterator();
                 pk_it_->SeekToFirst();
                 if (!pk_it_->Valid()) {
@@ -950,15 +1436,7 @@ void MemTableTraverseIterator::NextPK() {
             delete it_;
             it_ = NULL;
         }
-        if (segments_[seg_idx_]->GetTsCnt() > 1) {
-            KeyEntry* entry = ((KeyEntry**)pk_it_->GetValue())[0];  // NOLINT
-            it_ = entry->entries.NewIterator();
-            ticket_.Push(entry);
-        } else {
-            it_ = ((KeyEntry*)pk_it_->GetValue())  // NOLINT
-                      ->entries.NewIterator();
-            ticket_.Push((KeyEntry*)pk_it_->GetValue());  // NOLINT
-        }
+        it_ = segments_[seg_idx_]->NewTimeEntryIterator(pk_it_->GetValue(), 0, ticket_, read_seq_);
         it_->SeekToFirst();
         record_idx_ = 1;
         traverse_cnt_++;
@@ -978,22 +1456,19 @@ void MemTableTraverseIterator::Seek(const std::string& key, uint64_t ts) {
         it_ = NULL;
     }
     ticket_.Pop();
+    seg_idx_ = 0;
     if (seg_cnt_ > 1) {
         seg_idx_ = ::openmldb::base::hash(key.c_str(), key.length(), SEED) % seg_cnt_;
     }
+    if (seg_idx_ < seg_begin_ || seg_idx_ >= seg_end_) {
+        // the key belongs to another part
+        return;
+    }
     Slice spk(key);
     pk_it_ = segments_[seg_idx_]->GetKeyEntries()->NewIterator();
     pk_it_->Seek(spk);
     if (pk_it_->Valid()) {
-        if (segments_[seg_idx_]->GetTsCnt() > 1) {
-            KeyEntry* entry = ((KeyEntry**)pk_it_->GetValue())[ts_idx_];  // NOLINT
-            ticket_.Push(entry);
-            it_ = entry->entries.NewIterator();
-        } else {
-            ticket_.Push((KeyEntry*)pk_it_->GetValue());  // NOLINT
-            it_ = ((KeyEntry*)pk_it_->GetValue())         // NOLINT
-                      ->entries.NewIterator();
-        }
+        it_ = segments_[seg_idx_]->NewTimeEntryIterator(pk_it_->GetValue(), ts_idx_, ticket_, read_seq_);
         if (spk.compare(pk_it_->GetKey()) != 0 || ts == 0) {
             it_->SeekToFirst();
             traverse_cnt_++;
@@ -1031,7 +1506,19 @@ void MemTableTraverseIterator::Seek(const std::string& key, uint64_t ts) {
 }
 
 openmldb::base::Slice MemTableTraverseIterator::GetValue() const {
-    return openmldb::base::Slice(it_->GetValue()->data, it_->GetValue()->size);
+    const DataBlock* block = it_->GetValue();
+    const char* data = LoadBlockData(block);
+    if (cold_codec_ != nullptr && IsColdData(data)) {
+        cold_buf_.clear();
+        cold_codec_->Decode(UntagColdData(data), block->size, &cold_buf_);
+        data = cold_buf_.data();
+    }
+    if (row_codec_ != nullptr && codec::CompactRowCodec::IsCompact(data, block->size)) {
+        buf_.clear();
+        row_codec_->Decode(data, block->size, &buf_);
+        return openmldb::base::Slice(buf_.data(), buf_.size());
+    }
+    return openmldb::base::Slice(data, block->size);
 }
 
 uint64_t MemTableTraverseIterator::GetKey() const {
@@ -1058,19 +1545,11 @@ void MemTableTraverseIterator::SeekToFirst() {
         delete it_;
         it_ = NULL;
     }
-    for (seg_idx_ = 0; seg_idx_ < seg_cnt_; seg_idx_++) {
+    for (seg_idx_ = seg_begin_; seg_idx_ < seg_end_; seg_idx_++) {
         pk_it_ = segments_[seg_idx_]->GetKeyEntries()->NewIterator();
         pk_it_->SeekToFirst();
         while (pk_it_->Valid()) {
-            if (segments_[seg_idx_]->GetTsCnt() > 1) {
-                KeyEntry* entry = ((KeyEntry**)pk_it_->GetValue())[ts_idx_];  // NOLINT
-                ticket_.Push(entry);
-                it_ = entry->entries.NewIterator();
-            } else {
-                ticket_.Push((KeyEntry*)pk_it_->GetValue());  // NOLINT
-                it_ = ((KeyEntry*)pk_it_->GetValue())         // NOLINT
-                          ->entries.NewIterator();
-            }
+            it_ = segments_[seg_idx_]->NewTimeEntryIterator(pk_it_->GetValue(), ts_idx_, ticket_, read_seq_);
             it_->SeekToFirst();
             traverse_cnt_++;
             if (it_->Valid() && !expire_value_.IsExpired(it_->GetKey(), record_idx_)) {
@@ -17,14 +17,20 @@
 #ifndef SRC_STORAGE_MEM_TABLE_H_
 #define SRC_STORAGE_MEM_TABLE_H_
 
+#include <algorithm>
 #include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "proto/tablet.pb.h"
+#include "storage/gc_stat.h"
 #include "storage/iterator.h"
+#include "storage/mapped_snapshot.h"
 #include "storage/segment.h"
 #include "storage/table.h"
 #include "storage/ticket.h"
@@ -40,9 +46,19 @@ typedef google::protobuf::RepeatedPtrField<::openmldb::api::Dimension> Dimension
 
 class MemTableWindowIterator : public ::hybridse::vm::RowIterator {
  public:
-    MemTableWindowIterator(TimeEntries::Iterator* it, ::openmldb::storage::TTLType ttl_type, uint64_t expire_time,
-                           uint64_t expire_cnt)
-        : it_(it), record_idx_(1), expire_value_(expire_time, expire_cnt, ttl_type), row_() {}
+    MemTableWindowIterator(TimeEntryIterator* it, ::openmldb::storage::TTLType ttl_type, uint64_t expire_time,
+                           uint64_t expire_cnt, const codec::CompactRowCodec* row_codec = nullptr,
+                           ScanHint hint = {}, const codec::ColdRowCodec* cold_codec = nullptr)
+        : it_(it),
+          record_idx_(1),
+          expire_value_(expire_time, expire_cnt, ttl_type),
+          row_(),
+          row_codec_(row_codec),
+          cold_codec_(cold_codec),
+          hint_(std::move(hint)),
+          row_ready_(false) {
+        SkipUnmatched();
+    }
 
     ~MemTableWindowIterator() { delete it_; }
 
@@ -56,28 +72,102 @@ class MemTableWindowIterator : public ::hybridse::vm::RowIterator {
     void Next() override {
         it_->Next();
         record_idx_++;
+        row_ready_ = false;
+        SkipUnmatched();
     }
 
     const uint64_t& GetKey() const override { return it_->GetKey(); }
 
     // TODO(wangtaize) unify the row object
     const ::hybridse::codec::Row& GetValue() override {
-        row_.Reset(reinterpret_cast<const int8_t*>(it_->GetValue()->data), it_->GetValue()->size);
+        if (!row_ready_) {
+            LoadRow();
+        }
         return row_;
     }
 
-    void Seek(const uint64_t& key) override { it_->Seek(key); }
+    void Seek(const uint64_t& key) override {
+        it_->Seek(key);
+        row_ready_ = false;
+        SkipUnmatched();
+    }
     void SeekToFirst() override {
         record_idx_ = 1;
         it_->SeekToFirst();
+        row_ready_ = false;
+        SkipUnmatched();
     }
     bool IsSeekable() const override { return true; }
 
  private:
-    TimeEntries::Iterator* it_;
+    void LoadRow() {
+        const DataBlock* block = it_->GetValue();
+        const char* data = LoadBlockData(block);
+        if (cold_codec_ != nullptr && IsColdData(data)) {
+            cold_buf_.clear();
+            if (!cold_codec_->Decode(UntagColdData(data), block->size, &cold_buf_)) {
+                row_ = ::hybridse::codec::Row();
+                row_ready_ = true;
+                return;
+            }
+            data = cold_buf_.data();
+            if (row_codec_ == nullptr || !codec::CompactRowCodec::IsCompact(data, block->size)) {
+                // the inflated row is owned by the row as the decoded one below
+                int8_t* buf = reinterpret_cast<int8_t*>(malloc(block->size));
+                memcpy(buf, data, block->size);
+                row_ = ::hybridse::codec::Row(::hybridse::base::RefCountedSlice::CreateManaged(buf, block->size));
+                row_ready_ = true;
+                return;
+            }
+        }
+        if (row_codec_ != nullptr && codec::CompactRowCodec::IsCompact(data, block->size)) {
+            // the decoded row is owned by the row, as the engine may keep it after Next.
+            // only the columns read by the query are decoded if they are known
+            uint32_t size = 0;
+            int8_t* buf = row_codec_->Decode(data, block->size, &size, hint_.columns.get());
+            row_ = buf == nullptr ? ::hybridse::codec::Row()
+                                  : ::hybridse::codec::Row(::hybridse::base::RefCountedSlice::CreateManaged(buf, size));
+        } else {
+            row_.Reset(reinterpret_cast<const int8_t*>(data), block->size);
+        }
+        row_ready_ = true;
+    }
+
+    // the skipped rows are counted in record_idx_ too, as the ttl applies to all the rows
+    void SkipUnmatched() {
+        if (!hint_.filter) {
+            return;
+        }
+        while (Valid()) {
+            const DataBlock* block = it_->GetValue();
+            const char* data = LoadBlockData(block);
+            // the cold data is checked first, as its tagged pointer can not be read
+            if ((cold_codec_ != nullptr && IsColdData(data)) ||
+                (row_codec_ != nullptr && codec::CompactRowCodec::IsCompact(data, block->size))) {
+                // the decoded row is kept for GetValue if it matches
+                LoadRow();
+                if (hint_.filter->Match(row_.buf(), row_.size())) {
+                    return;
+                }
+                row_ready_ = false;
+            } else if (hint_.filter->Match(reinterpret_cast<const int8_t*>(data), block->size)) {
+                return;
+            }
+            it_->Next();
+            record_idx_++;
+        }
+    }
+
+    TimeEntryIterator* it_;
     uint32_t record_idx_;
     TTLSt expire_value_;
     ::hybridse::codec::Row row_;
+    const codec::CompactRowCodec* row_codec_;
+    const codec::ColdRowCodec* cold_codec_;
+    ScanHint hint_;
+    // row_ is loaded from the current entry
+    bool row_ready_;
+    std::string cold_buf_;
 };
 
 class MemTableKeyIterator : public ::hybridse::vm::WindowIterator {
@@ -100,6 +190,13 @@ class MemTableKeyIterator : public ::hybridse::vm::WindowIterator {
 
     const hybridse::codec::Row GetKey() override;
 
+    void SetRowCodec(const codec::CompactRowCodec* codec) { row_codec_ = codec; }
+    void SetColdCodec(const codec::ColdRowCodec* codec) { cold_codec_ = codec; }
+    // the rows of the windows are read as `hint` tells
+    void SetHint(ScanHint hint) { hint_ = std::move(hint); }
+    // the rows put at or after read_seq are skipped, see MemTable::GetReadSeq
+    void SetReadSeq(uint64_t read_seq) { read_seq_ = read_seq; }
+
  private:
     void NextPK();
 
@@ -108,13 +205,17 @@ class MemTableKeyIterator : public ::hybridse::vm::WindowIterator {
     uint32_t const seg_cnt_;
     uint32_t seg_idx_;
     KeyEntries::Iterator* pk_it_;
-    TimeEntries::Iterator* it_;
+    TimeEntryIterator* it_;
     ::openmldb::storage::TTLType ttl_type_;
     uint64_t expire_time_;
     uint64_t expire_cnt_;
     uint32_t ts_index_{};
     Ticket ticket_;
     uint32_t ts_idx_;
+    const codec::CompactRowCodec* row_codec_ = nullptr;
+    const codec::ColdRowCodec* cold_codec_ = nullptr;
+    ScanHint hint_;
+    uint64_t read_seq_ = 0;
 };
 
 class MemTableTraverseIterator : public TraverseIterator {
@@ -126,24 +227,45 @@ class MemTableTraverseIterator : public TraverseIterator {
     void Next() override;
     void NextPK() override;
     void Seek(const std::string& key, uint64_t time) override;
+    // the compact rows are decoded, the value is valid until the next GetValue
     openmldb::base::Slice GetValue() const override;
     std::string GetPK() const override;
     uint64_t GetKey() const override;
     void SeekToFirst() override;
     uint64_t GetCount() const override;
+    void ResetCount() override { traverse_cnt_ = 0; }
+
+    void SetRowCodec(const codec::CompactRowCodec* codec) { row_codec_ = codec; }
+    void SetColdCodec(const codec::ColdRowCodec* codec) { cold_codec_ = codec; }
+
+    // the rows put at or after read_seq are skipped, see MemTable::GetReadSeq
+    void SetReadSeq(uint64_t read_seq) { read_seq_ = read_seq; }
+
+    // only traverse the segments in [begin, end), the keys hashed to the other segments are not found by Seek
+    void SetSegmentRange(uint32_t begin, uint32_t end) {
+        seg_begin_ = begin;
+        seg_end_ = std::min(end, seg_cnt_);
+    }
 
  private:
     Segment** segments_;
     uint32_t const seg_cnt_;
+    uint32_t seg_begin_;
+    uint32_t seg_end_;
     uint32_t seg_idx_;
     KeyEntries::Iterator* pk_it_;
-    TimeEntries::Iterator* it_;
+    TimeEntryIterator* it_;
     uint32_t record_idx_;
     uint32_t ts_idx_;
     // uint64_t expire_value_;
     TTLSt expire_value_;
     Ticket ticket_;
     uint64_t traverse_cnt_;
+    const codec::CompactRowCodec* row_codec_;
+    const codec::ColdRowCodec* cold_codec_;
+    mutable std::string buf_;
+    mutable std::string cold_buf_;
+    uint64_t read_seq_;
 };
 
 class MemTable : public Table {
@@ -160,8 +282,20 @@ class MemTable : public Table {
 
     bool Put(const std::string& pk, uint64_t time, const char* data, uint32_t size) override;
 
+    // the row is kept in the compact format if the table is created with compact_row
     bool Put(uint64_t time, const std::string& value, const Dimensions& dimensions) override;
 
+    // the row is referred in place instead of being copied, unless it is turned into the compact format.
+    // it has to be in a snapshot held by HoldMappedSnapshot
+    bool PutMapped(uint64_t time, const char* data, uint32_t size, const Dimensions& dimensions);
+
+    // keep the mapping alive until the table is dropped, as the rows may refer to it
+    void HoldMappedSnapshot(const std::shared_ptr<MappedSnapshot>& mapped);
+
+    // the index inserts of all rows are grouped by segment, so that each segment is visited once in a row
+    void BatchPut(const std::vector<const ::openmldb::api::PutRequest*>& requests,
+                  std::vector<bool>* results) override;
+
     bool GetBulkLoadInfo(::openmldb::api::BulkLoadInfoResponse* response);
 
     bool BulkLoad(const std::vector<DataBlock*>& data_blocks,
@@ -176,15 +310,27 @@ class MemTable : public Table {
 
     TraverseIterator* NewTraverseIterator(uint32_t index) override;
 
+    // the iterators traverse disjoint ranges of the segments, so there are at most seg_cnt of them
+    std::vector<TraverseIterator*> NewTraverseIterators(uint32_t index, uint32_t part_num) override;
+
     ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index);
 
+    ::hybridse::vm::WindowIterator* NewPrunedWindowIterator(uint32_t index, const ScanHint& hint) override;
+
     // release all memory allocated
     uint64_t Release();
 
+    // release all memory allocated of the dropped table, which no one else refers to. yield is called after every
+    // yield_key_cnt keys released, and the pooled blocks are freed in bulk with the pool instead of one by one
+    uint64_t ReleaseForDrop(uint32_t yield_key_cnt, const std::function<void()>& yield);
+
     void SchedGc() override;
 
     int GetCount(uint32_t index, const std::string& pk, uint64_t& count) override;  // NOLINT
 
+    int GetUnexpiredCount(uint32_t index, const std::string& pk, uint64_t expire_time, uint64_t expire_cnt,
+                          uint64_t* count) override;
+
     uint64_t GetRecordIdxCnt() override;
     bool GetRecordIdxCnt(uint32_t idx, uint64_t** stat, uint32_t* size) override;
     uint64_t GetRecordIdxByteSize() override;
@@ -217,11 +363,61 @@ class MemTable : public Table {
 
     bool AddIndex(const ::openmldb::common::ColumnKey& column_key);
 
+    // the rows stamped with a seq less than this one are all inserted, and the rows not inserted yet are stamped with
+    // this seq or a later one. so the iterators given it as the read seq read the table as of now, the puts running
+    // at the moment are not seen by any of them. 0 without the build of SNAPSHOT_READ_ENABLE, which reads all rows
+    uint64_t GetReadSeq() const;
+
+    // return NULL if the data block pool is disabled
+    DataBlockPool* GetDataBlockPool() const { return block_pool_.get(); }
+
+    const GcStat& GetGcStat() const { return gc_stat_; }
+
+    void SetTableMeta(::openmldb::api::TableMeta& table_meta) override;  // NOLINT
+
+    // return NULL if the rows are kept as they are put
+    codec::CompactRowCodec* GetRowCodec() const { return row_codec_.get(); }
+    // return NULL if the cold rows are kept as they are
+    codec::ColdRowCodec* GetColdCodec() const { return cold_codec_.get(); }
+
+    // with key_entry_adaptive_height, set the height limit of the time entries of new keys in each inner index
+    // from its rows per key. the existing keys keep their heights. it is called on gc and snapshot
+    void AdaptKeyEntryHeight();
+    // the height limits of the inner indexes, restored before the snapshot is loaded so the recovered keys
+    // start with the adapted heights. they are ignored if the inner indexes changed
+    std::vector<uint32_t> GetKeyEntryHeights() const;
+    void SetKeyEntryHeights(const std::vector<uint32_t>& heights);
+
+    // collect the statistics of the ready indexes, it is called on gc and snapshot
+    void UpdateIndexStats();
+    bool GetIndexStat(uint32_t idx, IndexStat* stat) override;
+
+    // walk the rows of index idx segment by segment, return false if the index is not ready
+    bool GetIndexMemStat(uint32_t idx, IndexMemStat* stat);
+
  private:
+    // check the row and get the key of each inner index and the ts of each ts column
+    bool PreparePut(uint64_t time, const Slice& value, const Dimensions& dimensions,
+                    std::map<int32_t, Slice>* inner_index_key_map, std::map<int32_t, uint64_t>* ts_map,
+                    uint32_t* real_ref_cnt);
+
+    // insert the block to the segments of the inner indexes
+    void PutBlock(const std::map<int32_t, Slice>& inner_index_key_map, const std::map<int32_t, uint64_t>& ts_map,
+                  DataBlock* block);
+
+    // an inner index is put only if any of its indexes is ready
+    bool NeedPut(int32_t inner_pos);
+
     bool CheckAbsolute(const TTLSt& ttl, uint64_t ts);
 
     bool CheckLatest(uint32_t index_id, const std::string& key, uint64_t ts);
 
+    // create the data block of the row, in the compact format if it is enabled and smaller
+    DataBlock* NewDataBlock(uint32_t ref_cnt, const std::string& value);
+
+    // deflate the rows older than cold_row_age_min in the ready inner indexes, it is called on gc
+    void CompressColdRows();
+
  private:
     uint32_t seg_cnt_;
     std::vector<Segment**> segments_;
@@ -231,6 +427,37 @@ class MemTable : public Table {
     bool segment_released_;
     std::atomic<uint64_t> record_byte_size_;
     uint32_t key_entry_max_height_;
+    // the height is given by the table meta and not adapted
+    bool fixed_key_entry_height_;
+    std::unique_ptr<DataBlockPool> block_pool_;
+    std::unique_ptr<codec::CompactRowCodec> row_codec_;
+    std::unique_ptr<codec::ColdRowCodec> cold_codec_;
+    GcStat gc_stat_;
+    std::mutex index_stat_mu_;
+    // keyed by the index id
+    std::map<uint32_t, IndexStat> index_stats_;
+    std::mutex mapped_mu_;
+    // destroyed after the segments, which are deleted in the destructor
+    std::vector<std::shared_ptr<MappedSnapshot>> mapped_snapshots_;
+#ifdef SNAPSHOT_READ_ENABLE
+    // stamp cnt blocks with the seqs from the returned one, the put holds `slot` until EndPutSeq once they are
+    // inserted
+    uint64_t BeginPutSeq(uint32_t cnt, uint32_t* slot);
+    void EndPutSeq(uint32_t slot);
+
+    static constexpr uint32_t kPutSlotCnt = 32;
+    static constexpr uint64_t kFreePutSlot = UINT64_MAX;
+    // a slot of the puts being inserted, padded to a cache line as the puts of the threads take different slots
+    struct alignas(64) PutSlot {
+        // no more than the first seq of the put holding it, or kFreePutSlot
+        std::atomic<uint64_t> seq{kFreePutSlot};
+    };
+    // the seq of the next row put, starting from 1 as 0 is the block not stamped
+    std::atomic<uint64_t> put_seq_{1};
+    PutSlot put_slots_[kPutSlotCnt];
+    // a read seq returned once, which stays valid as the puts below it are all inserted
+    mutable std::atomic<uint64_t> committed_seq_{1};
+#endif
 };
 
 }  // namespace storage
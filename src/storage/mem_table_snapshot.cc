@@ -16,14 +16,19 @@
 
 #include "storage/mem_table_snapshot.h"
 
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/wire_format_lite.h>
 #ifdef DISALLOW_COPY_AND_ASSIGN
 #undef DISALLOW_COPY_AND_ASSIGN
 #endif
+#include <fcntl.h>
 #include <snappy.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <set>
+#include <thread>  // NOLINT
 #include <utility>
 
 #include "base/count_down_latch.h"
@@ -35,6 +40,7 @@
 #include "base/strings.h"
 #include "base/taskpool.hpp"
 #include "boost/bind.hpp"
+#include "codec/composite_key.h"
 #include "codec/row_codec.h"
 #include "common/thread_pool.h"
 #include "common/timer.h"
@@ -42,6 +48,8 @@
 #include "log/log_reader.h"
 #include "log/sequential_file.h"
 #include "proto/tablet.pb.h"
+#include "storage/mapped_snapshot.h"
+#include "storage/mem_table.h"
 
 using google::protobuf::RepeatedPtrField;
 using ::openmldb::codec::SchemaCodec;
@@ -52,14 +60,292 @@ DECLARE_uint32(make_snapshot_max_deleted_keys);
 DECLARE_uint32(load_table_batch);
 DECLARE_uint32(load_table_thread_num);
 DECLARE_uint32(load_table_queue_size);
+DECLARE_uint32(load_table_put_thread_num);
+DECLARE_bool(load_table_mmap);
+DECLARE_bool(key_entry_adaptive_height);
+DECLARE_uint32(extract_index_thread_num);
+DECLARE_uint32(extract_index_batch);
+DECLARE_uint32(snapshot_part_num);
+DECLARE_uint32(snapshot_max_delta_num);
 DECLARE_string(snapshot_compression);
+DECLARE_bool(snapshot_enable_crc);
+DECLARE_bool(snapshot_direct_io);
 
 namespace openmldb {
 namespace storage {
 
 const std::string SNAPSHOT_SUBFIX = ".sdb";  // NOLINT
 const uint32_t KEY_NUM_DISPLAY = 1000000;    // NOLINT
+const std::string ROW_DICT = "ROW_DICT";     // NOLINT
 const std::string MANIFEST = "MANIFEST";     // NOLINT
+// the same seed as segments of mem table, so every segment of the first index is put by
+// one thread if the put thread num divides the segment count
+static const uint32_t PUT_PARTITION_SEED = 0xe17a1465;
+
+// the state of one snapshot record on extracting index
+enum ExtractState : uint8_t {
+    kWriteRecord = 0,
+    kExtractRecord = 1,
+    kDeletedRecord = 2,
+    kExpiredRecord = 3,
+    kInvalidRecord = 4,
+};
+
+// the count of records dispatched to a part file at a time
+static const uint32_t SNAPSHOT_PART_BATCH = 1024;
+
+static bool IsCompressedFile(const std::string& path) {
+    return path.find(openmldb::log::ZLIB_COMPRESS_SUFFIX) != std::string::npos ||
+           path.find(openmldb::log::SNAPPY_COMPRESS_SUFFIX) != std::string::npos;
+}
+
+// parse the entry except its value, which is returned in place instead of being copied
+static bool ParseEntryInPlace(const char* data, uint32_t size, ::openmldb::api::LogEntry* entry, const char** value,
+                              uint32_t* value_size) {
+    using ::google::protobuf::internal::WireFormatLite;
+    ::google::protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t*>(data), size);
+    std::string rest;
+    *value = nullptr;
+    *value_size = 0;
+    while (true) {
+        int start = input.CurrentPosition();
+        uint32_t tag = input.ReadTag();
+        if (tag == 0) {
+            break;
+        }
+        if (WireFormatLite::GetTagFieldNumber(tag) == ::openmldb::api::LogEntry::kValueFieldNumber &&
+            WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+            uint32_t len = 0;
+            if (!input.ReadVarint32(&len) || len > size - input.CurrentPosition()) {
+                return false;
+            }
+            *value = data + input.CurrentPosition();
+            *value_size = len;
+            input.Skip(len);
+        } else {
+            if (!WireFormatLite::SkipField(&input, tag)) {
+                return false;
+            }
+            rest.append(data + start, input.CurrentPosition() - start);
+        }
+    }
+    if (static_cast<uint32_t>(input.CurrentPosition()) != size || *value == nullptr) {
+        return false;
+    }
+    return entry->ParseFromString(rest);
+}
+
+SnapshotReader::SnapshotReader(const std::string& path)
+    : paths_({path}), files_(), idx_(0), seq_file_(NULL), reader_() {}
+
+SnapshotReader::SnapshotReader(const std::string& snapshot_path, const ::openmldb::api::Manifest& manifest)
+    : paths_(), files_(), idx_(0), seq_file_(NULL), reader_() {
+    paths_.push_back(snapshot_path + manifest.name());
+    for (const auto& delta_name : manifest.delta_name()) {
+        paths_.push_back(snapshot_path + delta_name);
+    }
+}
+
+SnapshotReader::~SnapshotReader() { CloseFile(); }
+
+std::vector<std::string> SnapshotReader::GetFiles(const std::string& path) {
+    std::vector<std::string> files;
+    if (!::openmldb::base::IsFolder(path)) {
+        files.push_back(path);
+    } else if (::openmldb::base::GetFileName(path, files) == 0) {
+        std::sort(files.begin(), files.end());
+    }
+    return files;
+}
+
+bool SnapshotReader::Init() {
+    for (const auto& path : paths_) {
+        std::vector<std::string> files = GetFiles(path);
+        files_.insert(files_.end(), files.begin(), files.end());
+    }
+    return files_.empty() || OpenFile(0);
+}
+
+bool SnapshotReader::OpenFile(uint32_t idx) {
+    CloseFile();
+    idx_ = idx;
+    FILE* fd = fopen(files_[idx].c_str(), "rb");
+    if (fd == NULL) {
+        PDLOG(WARNING, "fail to open path %s for error %s", files_[idx].c_str(), strerror(errno));
+        return false;
+    }
+    seq_file_ = ::openmldb::log::NewSeqFile(files_[idx], fd, FLAGS_snapshot_direct_io);
+    reader_.reset(new ::openmldb::log::Reader(seq_file_, NULL, FLAGS_snapshot_enable_crc, 0,
+                                              IsCompressedFile(files_[idx])));
+    return true;
+}
+
+void SnapshotReader::CloseFile() {
+    reader_.reset();
+    // will close the fd
+    delete seq_file_;
+    seq_file_ = NULL;
+}
+
+::openmldb::log::Status SnapshotReader::ReadRecord(::openmldb::base::Slice* record, std::string* scratch) {
+    while (reader_) {
+        ::openmldb::log::Status status = reader_->ReadRecord(record, scratch);
+        if (!(status.IsEof() || status.IsWaitRecord()) || idx_ + 1 >= files_.size()) {
+            return status;
+        }
+        if (!OpenFile(idx_ + 1)) {
+            return ::openmldb::log::Status::IOError("fail to open " + files_[idx_]);
+        }
+    }
+    return ::openmldb::log::Status::Eof();
+}
+
+// SnapshotPartWriter writes the records of a new snapshot to the part files in a directory. The records are
+// dispatched to the parts in batches round robin, and every part filters and writes its batches in its own
+// thread, so the parsing, ttl checking and compressing of the records run in parallel
+class MemTableSnapshot::SnapshotPartWriter {
+ public:
+    // return the ExtractState of the record, the record may be rewritten
+    typedef boost::function<uint8_t(std::string*)> Filter;
+
+    SnapshotPartWriter(const std::string& dir, uint32_t part_num)
+        : dir_(dir), part_num_(part_num), parts_(), filter_(), batch_(), next_(0) {}
+
+    ~SnapshotPartWriter() { Close(); }
+
+    bool Open() {
+        // the part files left by the failed making are removed
+        if (::openmldb::base::IsFolder(dir_) && !::openmldb::base::RemoveDirRecursive(dir_)) {
+            PDLOG(WARNING, "fail to remove dir %s", dir_.c_str());
+            return false;
+        }
+        if (!::openmldb::base::MkdirRecur(dir_)) {
+            PDLOG(WARNING, "fail to create dir %s", dir_.c_str());
+            return false;
+        }
+        for (uint32_t i = 0; i < part_num_; i++) {
+            std::string name = std::to_string(i) + SNAPSHOT_SUBFIX;
+            if (FLAGS_snapshot_compression != "off") {
+                name.append("." + FLAGS_snapshot_compression);
+            }
+            std::string path = dir_ + "/" + name;
+            FILE* fd = fopen(path.c_str(), "ab+");
+            if (fd == NULL) {
+                PDLOG(WARNING, "fail to create file %s", path.c_str());
+                return false;
+            }
+            std::unique_ptr<Part> part(new Part());
+            part->wh.reset(new WriteHandle(FLAGS_snapshot_compression, name, fd, 0, true));
+            part->pool.reset(new ::openmldb::base::TaskPool(1, 4));
+            parts_.push_back(std::move(part));
+        }
+        batch_ = std::make_shared<std::vector<std::string>>();
+        return true;
+    }
+
+    // the records written after are filtered by the filter, or written as they are if it is empty
+    void SetFilter(const Filter& filter) {
+        Flush();
+        filter_ = filter;
+    }
+
+    void Write(const ::openmldb::base::Slice& record) {
+        batch_->emplace_back(record.data(), record.size());
+        if (batch_->size() >= SNAPSHOT_PART_BATCH) {
+            Flush();
+        }
+    }
+
+    // wait until the records are written and end the part files, return false if any record fails
+    bool Close() {
+        if (batch_) {
+            Flush();
+            batch_.reset();
+        }
+        bool ok = true;
+        for (auto& part : parts_) {
+            if (part->pool) {
+                part->pool->Stop();
+                part->pool.reset();
+                part->wh->EndLog();
+                part->wh.reset();
+            }
+            ok = ok && !part->has_error;
+        }
+        return ok;
+    }
+
+    // the counts are valid after close
+    uint64_t GetWriteCount() const { return Sum(&Part::write_count); }
+    uint64_t GetExpiredCount() const { return Sum(&Part::expired_key_num); }
+    uint64_t GetDeletedCount() const { return Sum(&Part::deleted_key_num); }
+
+ private:
+    // the fields are accessed by the thread of the part only until it stops
+    struct Part {
+        std::unique_ptr<WriteHandle> wh;
+        std::unique_ptr<::openmldb::base::TaskPool> pool;
+        uint64_t write_count = 0;
+        uint64_t expired_key_num = 0;
+        uint64_t deleted_key_num = 0;
+        bool has_error = false;
+    };
+
+    void Flush() {
+        if (!batch_ || batch_->empty()) {
+            return;
+        }
+        Part* part = parts_[next_++ % parts_.size()].get();
+        part->pool->AddTask(boost::bind(&SnapshotPartWriter::WriteBatch, part, filter_, batch_));
+        batch_ = std::make_shared<std::vector<std::string>>();
+        batch_->reserve(SNAPSHOT_PART_BATCH);
+    }
+
+    static void WriteBatch(Part* part, const Filter& filter, const std::shared_ptr<std::vector<std::string>>& batch) {
+        for (auto& record : *batch) {
+            if (part->has_error) {
+                return;
+            }
+            if (filter) {
+                uint8_t state = filter(&record);
+                if (state == kInvalidRecord) {
+                    PDLOG(WARNING, "fail parse record with value %s",
+                          ::openmldb::base::DebugString(record).c_str());
+                    part->has_error = true;
+                    return;
+                } else if (state == kDeletedRecord) {
+                    part->deleted_key_num++;
+                    continue;
+                } else if (state == kExpiredRecord) {
+                    part->expired_key_num++;
+                    continue;
+                }
+            }
+            ::openmldb::log::Status status = part->wh->Write(::openmldb::base::Slice(record));
+            if (!status.ok()) {
+                PDLOG(WARNING, "fail to write snapshot part. status[%s]", status.ToString().c_str());
+                part->has_error = true;
+                return;
+            }
+            part->write_count++;
+        }
+    }
+
+    uint64_t Sum(uint64_t Part::*field) const {
+        uint64_t sum = 0;
+        for (const auto& part : parts_) {
+            sum += (*part).*field;
+        }
+        return sum;
+    }
+
+    std::string dir_;
+    uint32_t part_num_;
+    std::vector<std::unique_ptr<Part>> parts_;
+    Filter filter_;
+    std::shared_ptr<std::vector<std::string>> batch_;
+    uint64_t next_;
+};
 
 MemTableSnapshot::MemTableSnapshot(uint32_t tid, uint32_t pid, LogParts* log_part, const std::string& db_root_path)
     : Snapshot(tid, pid), log_part_(log_part), db_root_path_(db_root_path) {}
@@ -86,7 +372,13 @@ bool MemTableSnapshot::Recover(std::shared_ptr<Table> table, uint64_t& latest_of
         return false;
     }
     if (ret == 0) {
-        RecoverFromSnapshot(manifest.name(), manifest.count(), table);
+        LoadRowDict(table);
+        auto mem_table = std::dynamic_pointer_cast<MemTable>(table);
+        if (mem_table && manifest.key_entry_height_size() > 0) {
+            mem_table->SetKeyEntryHeights({manifest.key_entry_height().begin(), manifest.key_entry_height().end()});
+        }
+        RecoverFromSnapshot(manifest.name(), manifest.count(), table,
+                            {manifest.delta_name().begin(), manifest.delta_name().end()});
         latest_offset = manifest.offset();
         offset_ = latest_offset;
     }
@@ -94,11 +386,46 @@ bool MemTableSnapshot::Recover(std::shared_ptr<Table> table, uint64_t& latest_of
 }
 
 void MemTableSnapshot::RecoverFromSnapshot(const std::string& snapshot_name, uint64_t expect_cnt,
-                                           std::shared_ptr<Table> table) {
+                                           std::shared_ptr<Table> table, const std::vector<std::string>& delta_names) {
     std::string full_path = snapshot_path_ + "/" + snapshot_name;
     std::atomic<uint64_t> g_succ_cnt(0);
     std::atomic<uint64_t> g_failed_cnt(0);
-    RecoverSingleSnapshot(full_path, table, &g_succ_cnt, &g_failed_cnt);
+    if (FLAGS_load_table_mmap && RecoverMappedSnapshots(full_path, table, delta_names, &g_succ_cnt, &g_failed_cnt)) {
+        PDLOG(INFO, "[Recover] mapped snapshot %s, success count %lu, failed count %lu", snapshot_name.c_str(),
+              g_succ_cnt.load(std::memory_order_relaxed), g_failed_cnt.load(std::memory_order_relaxed));
+        if (g_succ_cnt.load(std::memory_order_relaxed) != expect_cnt) {
+            PDLOG(WARNING, "snapshot %s , expect cnt %lu but succ_cnt %lu", snapshot_name.c_str(), expect_cnt,
+                  g_succ_cnt.load(std::memory_order_relaxed));
+        }
+        return;
+    }
+    // the part files and incremental snapshots are loaded in parallel, each of them by one thread
+    bool is_folder = ::openmldb::base::IsFolder(full_path);
+    std::vector<std::string> files;
+    if (is_folder) {
+        files = SnapshotReader::GetFiles(full_path);
+    }
+    for (const auto& delta_name : delta_names) {
+        std::vector<std::string> delta_files = SnapshotReader::GetFiles(snapshot_path_ + delta_name);
+        files.insert(files.end(), delta_files.begin(), delta_files.end());
+    }
+    uint32_t thread_num = std::min(static_cast<uint32_t>(files.size()), std::max(FLAGS_load_table_thread_num, 1u));
+    std::atomic<uint32_t> next(0);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < thread_num; i++) {
+        threads.emplace_back([this, &files, &next, &table, &g_succ_cnt, &g_failed_cnt] {
+            uint32_t idx = 0;
+            while ((idx = next.fetch_add(1, std::memory_order_relaxed)) < files.size()) {
+                RecoverSnapshotPart(files[idx], table, &g_succ_cnt, &g_failed_cnt);
+            }
+        });
+    }
+    if (!is_folder) {
+        RecoverSingleSnapshot(full_path, table, &g_succ_cnt, &g_failed_cnt);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
     PDLOG(INFO, "[Recover] progress done stat: success count %lu, failed count %lu",
           g_succ_cnt.load(std::memory_order_relaxed), g_failed_cnt.load(std::memory_order_relaxed));
     if (g_succ_cnt.load(std::memory_order_relaxed) != expect_cnt) {
@@ -107,9 +434,77 @@ void MemTableSnapshot::RecoverFromSnapshot(const std::string& snapshot_name, uin
     }
 }
 
+bool MemTableSnapshot::RecoverMappedSnapshots(const std::string& full_path, std::shared_ptr<Table> table,
+                                              const std::vector<std::string>& delta_names,
+                                              std::atomic<uint64_t>* g_succ_cnt, std::atomic<uint64_t>* g_failed_cnt) {
+    auto mem_table = std::dynamic_pointer_cast<MemTable>(table);
+    if (!mem_table) {
+        return false;
+    }
+    std::vector<std::string> files = SnapshotReader::GetFiles(full_path);
+    for (const auto& delta_name : delta_names) {
+        std::vector<std::string> delta_files = SnapshotReader::GetFiles(snapshot_path_ + delta_name);
+        files.insert(files.end(), delta_files.begin(), delta_files.end());
+    }
+    for (const auto& file : files) {
+        if (IsCompressedFile(file)) {
+            PDLOG(INFO, "snapshot %s is compressed and can not be mapped. tid %u pid %u", file.c_str(), tid_, pid_);
+            return false;
+        }
+    }
+    for (const auto& file : files) {
+        auto mapped = MappedSnapshot::Open(file);
+        if (!mapped) {
+            RecoverSnapshotPart(file, table, g_succ_cnt, g_failed_cnt);
+            continue;
+        }
+        mem_table->HoldMappedSnapshot(mapped);
+        // the blocks of the file are split into ranges and read in parallel
+        uint64_t block_cnt = mapped->GetBlockCnt();
+        uint64_t thread_num = std::min(block_cnt, static_cast<uint64_t>(std::max(FLAGS_load_table_thread_num, 1u)));
+        std::vector<std::thread> threads;
+        for (uint64_t i = 0; i < thread_num; i++) {
+            uint64_t begin = block_cnt * i / thread_num;
+            uint64_t end = block_cnt * (i + 1) / thread_num;
+            threads.emplace_back([&mem_table, &mapped, begin, end, g_succ_cnt, g_failed_cnt] {
+                uint64_t succ_cnt = 0;
+                uint64_t failed_cnt = 0;
+                ::openmldb::api::LogEntry entry;
+                auto handler = [&](const char* data, uint32_t size, bool in_place) {
+                    const char* value = nullptr;
+                    uint32_t value_size = 0;
+                    if (!ParseEntryInPlace(data, size, &entry, &value, &value_size)) {
+                        failed_cnt++;
+                        return;
+                    }
+                    if (in_place) {
+                        mem_table->PutMapped(entry.ts(), value, value_size, entry.dimensions());
+                    } else {
+                        mem_table->Put(entry.ts(), std::string(value, value_size), entry.dimensions());
+                    }
+                    succ_cnt++;
+                };
+                failed_cnt += mapped->ReadRecords(begin, end, FLAGS_snapshot_enable_crc, handler);
+                g_succ_cnt->fetch_add(succ_cnt, std::memory_order_relaxed);
+                g_failed_cnt->fetch_add(failed_cnt, std::memory_order_relaxed);
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        PDLOG(INFO, "load mapped path %s for table tid %u pid %u completed", file.c_str(), tid_, pid_);
+    }
+    return true;
+}
+
 void MemTableSnapshot::RecoverSingleSnapshot(const std::string& path, std::shared_ptr<Table> table,
                                              std::atomic<uint64_t>* g_succ_cnt, std::atomic<uint64_t>* g_failed_cnt) {
     ::openmldb::base::TaskPool load_pool_(FLAGS_load_table_thread_num, FLAGS_load_table_batch);
+    // the read, decode and put of rows run as a pipeline if there are put threads
+    std::vector<std::unique_ptr<::openmldb::base::TaskPool>> put_pools;
+    for (uint32_t i = 0; i < FLAGS_load_table_put_thread_num; i++) {
+        put_pools.emplace_back(new ::openmldb::base::TaskPool(1, FLAGS_load_table_queue_size));
+    }
     std::atomic<uint64_t> succ_cnt, failed_cnt;
     succ_cnt = failed_cnt = 0;
 
@@ -124,13 +519,23 @@ void MemTableSnapshot::RecoverSingleSnapshot(const std::string& path, std::share
             break;
         }
         bool compressed = IsCompressed(path);
-        ::openmldb::log::SequentialFile* seq_file = ::openmldb::log::NewSeqFile(path, fd);
-        ::openmldb::log::Reader reader(seq_file, NULL, false, 0, compressed);
+        ::openmldb::log::SequentialFile* seq_file = ::openmldb::log::NewSeqFile(path, fd, FLAGS_snapshot_direct_io);
+        ::openmldb::log::Reader reader(seq_file, NULL, FLAGS_snapshot_enable_crc, 0, compressed);
         std::string buffer;
         // second
         uint64_t consumed = ::baidu::common::timer::now_time();
         std::vector<std::string*> recordPtr;
         recordPtr.reserve(FLAGS_load_table_batch);
+        auto add_task = [&]() {
+            if (put_pools.empty()) {
+                load_pool_.AddTask(
+                    boost::bind(&MemTableSnapshot::Put, this, path, table, recordPtr, &succ_cnt, &failed_cnt));
+            } else {
+                load_pool_.AddTask(boost::bind(&MemTableSnapshot::Dispatch, this, path, recordPtr, &put_pools, table,
+                                               &succ_cnt, &failed_cnt));
+            }
+            recordPtr.clear();
+        };
 
         while (true) {
             buffer.clear();
@@ -138,11 +543,8 @@ void MemTableSnapshot::RecoverSingleSnapshot(const std::string& path, std::share
             ::openmldb::log::Status status = reader.ReadRecord(&record, &buffer);
             if (status.IsWaitRecord() || status.IsEof()) {
                 consumed = ::baidu::common::timer::now_time() - consumed;
-                PDLOG(INFO,
-                      "read path %s for table tid %u pid %u completed, "
-                      "succ_cnt %lu, failed_cnt %lu, consumed %us",
-                      path.c_str(), tid_, pid_, succ_cnt.load(std::memory_order_relaxed),
-                      failed_cnt.load(std::memory_order_relaxed), consumed);
+                PDLOG(INFO, "read path %s for table tid %u pid %u completed, consumed %us", path.c_str(), tid_, pid_,
+                      consumed);
                 break;
             }
 
@@ -155,25 +557,64 @@ void MemTableSnapshot::RecoverSingleSnapshot(const std::string& path, std::share
             std::string* sp = new std::string(record.data(), record.size());
             recordPtr.push_back(sp);
             if (recordPtr.size() >= FLAGS_load_table_batch) {
-                load_pool_.AddTask(
-                    boost::bind(&MemTableSnapshot::Put, this, path, table, recordPtr, &succ_cnt, &failed_cnt));
-                recordPtr.clear();
+                add_task();
             }
         }
         if (recordPtr.size() > 0) {
-            load_pool_.AddTask(
-                boost::bind(&MemTableSnapshot::Put, this, path, table, recordPtr, &succ_cnt, &failed_cnt));
+            add_task();
         }
         // will close the fd atomic
         delete seq_file;
-        if (g_succ_cnt) {
-            g_succ_cnt->fetch_add(succ_cnt, std::memory_order_relaxed);
-        }
-        if (g_failed_cnt) {
-            g_failed_cnt->fetch_add(failed_cnt, std::memory_order_relaxed);
-        }
     } while (false);
+    // the decode tasks dispatch to put pools, so stop them first
     load_pool_.Stop();
+    for (auto& put_pool : put_pools) {
+        put_pool->Stop();
+    }
+    PDLOG(INFO, "load path %s for table tid %u pid %u completed, succ_cnt %lu, failed_cnt %lu", path.c_str(), tid_,
+          pid_, succ_cnt.load(std::memory_order_relaxed), failed_cnt.load(std::memory_order_relaxed));
+    if (g_succ_cnt) {
+        g_succ_cnt->fetch_add(succ_cnt, std::memory_order_relaxed);
+    }
+    if (g_failed_cnt) {
+        g_failed_cnt->fetch_add(failed_cnt, std::memory_order_relaxed);
+    }
+}
+
+void MemTableSnapshot::RecoverSnapshotPart(const std::string& path, std::shared_ptr<Table> table,
+                                           std::atomic<uint64_t>* g_succ_cnt, std::atomic<uint64_t>* g_failed_cnt) {
+    SnapshotReader reader(path);
+    if (!reader.Init()) {
+        return;
+    }
+    uint64_t succ_cnt = 0;
+    uint64_t failed_cnt = 0;
+    ::openmldb::api::LogEntry entry;
+    std::string buffer;
+    while (true) {
+        buffer.clear();
+        ::openmldb::base::Slice record;
+        ::openmldb::log::Status status = reader.ReadRecord(&record, &buffer);
+        if (status.IsWaitRecord() || status.IsEof()) {
+            break;
+        }
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to read record for tid %u, pid %u with error %s", tid_, pid_,
+                  status.ToString().c_str());
+            failed_cnt++;
+            continue;
+        }
+        if (!entry.ParseFromArray(record.data(), record.size())) {
+            failed_cnt++;
+            continue;
+        }
+        table->Put(entry);
+        succ_cnt++;
+    }
+    PDLOG(INFO, "load path %s for table tid %u pid %u completed, succ_cnt %lu, failed_cnt %lu", path.c_str(), tid_,
+          pid_, succ_cnt, failed_cnt);
+    g_succ_cnt->fetch_add(succ_cnt, std::memory_order_relaxed);
+    g_failed_cnt->fetch_add(failed_cnt, std::memory_order_relaxed);
 }
 
 void MemTableSnapshot::Put(std::string& path, std::shared_ptr<Table>& table, std::vector<std::string*> recordPtr,
@@ -196,18 +637,53 @@ void MemTableSnapshot::Put(std::string& path, std::shared_ptr<Table>& table, std
     }
 }
 
+void MemTableSnapshot::Dispatch(std::string& path, std::vector<std::string*> recordPtr,
+                                std::vector<std::unique_ptr<::openmldb::base::TaskPool>>* put_pools,
+                                std::shared_ptr<Table>& table, std::atomic<uint64_t>* succ_cnt,
+                                std::atomic<uint64_t>* failed_cnt) {
+    std::vector<std::vector<::openmldb::api::LogEntry*>> partitions(put_pools->size());
+    for (auto it = recordPtr.cbegin(); it != recordPtr.cend(); it++) {
+        auto* entry = new ::openmldb::api::LogEntry();
+        bool ok = entry->ParseFromString(**it);
+        delete *it;
+        if (!ok) {
+            failed_cnt->fetch_add(1, std::memory_order_relaxed);
+            delete entry;
+            continue;
+        }
+        const std::string& key = entry->dimensions_size() > 0 ? entry->dimensions(0).key() : entry->pk();
+        uint32_t idx = ::openmldb::base::hash(key.c_str(), key.length(), PUT_PARTITION_SEED) % put_pools->size();
+        partitions[idx].push_back(entry);
+    }
+    for (uint32_t idx = 0; idx < partitions.size(); idx++) {
+        if (!partitions[idx].empty()) {
+            (*put_pools)[idx]->AddTask(boost::bind(&MemTableSnapshot::PutEntries, this, path, table,
+                                                   partitions[idx], succ_cnt, failed_cnt));
+        }
+    }
+}
+
+void MemTableSnapshot::PutEntries(std::string& path, std::shared_ptr<Table>& table,
+                                  std::vector<::openmldb::api::LogEntry*> entries, std::atomic<uint64_t>* succ_cnt,
+                                  std::atomic<uint64_t>* failed_cnt) {
+    for (auto* entry : entries) {
+        auto scount = succ_cnt->fetch_add(1, std::memory_order_relaxed);
+        if (scount % 100000 == 0) {
+            PDLOG(INFO, "load snapshot %s with succ_cnt %lu, failed_cnt %lu", path.c_str(), scount,
+                  failed_cnt->load(std::memory_order_relaxed));
+        }
+        table->Put(*entry);
+        delete entry;
+    }
+}
+
 int MemTableSnapshot::TTLSnapshot(std::shared_ptr<Table> table, const ::openmldb::api::Manifest& manifest,
                                   WriteHandle* wh, uint64_t& count, uint64_t& expired_key_num,
                                   uint64_t& deleted_key_num) {
-    std::string full_path = snapshot_path_ + manifest.name();
-    FILE* fd = fopen(full_path.c_str(), "rb");
-    if (fd == NULL) {
-        PDLOG(WARNING, "fail to open path %s for error %s", full_path.c_str(), strerror(errno));
+    SnapshotReader reader(snapshot_path_, manifest);
+    if (!reader.Init()) {
         return -1;
     }
-    bool compressed = IsCompressed(full_path);
-    ::openmldb::log::SequentialFile* seq_file = ::openmldb::log::NewSeqFile(manifest.name(), fd);
-    ::openmldb::log::Reader reader(seq_file, NULL, false, 0, compressed);
 
     std::string buffer;
     std::string tmp_buf;
@@ -259,7 +735,6 @@ int MemTableSnapshot::TTLSnapshot(std::shared_ptr<Table> table, const ::openmldb
         }
         count++;
     }
-    delete seq_file;
     if (expired_key_num + count + deleted_key_num != manifest.count()) {
         PDLOG(WARNING,
               "key num not match! total key num[%lu] load key num[%lu] ttl key "
@@ -274,6 +749,59 @@ int MemTableSnapshot::TTLSnapshot(std::shared_ptr<Table> table, const ::openmldb
     return 0;
 }
 
+int MemTableSnapshot::TTLSnapshot(std::shared_ptr<Table> table, const ::openmldb::api::Manifest& manifest,
+                                  SnapshotPartWriter* writer) {
+    SnapshotReader reader(snapshot_path_, manifest);
+    if (!reader.Init()) {
+        return -1;
+    }
+    auto deleted_index = std::make_shared<std::set<uint32_t>>();
+    for (const auto& it : table->GetAllIndex()) {
+        if (it->GetStatus() != ::openmldb::storage::IndexStatus::kReady) {
+            deleted_index->insert(it->GetId());
+        }
+    }
+    writer->SetFilter([this, table, deleted_index](std::string* record) -> uint8_t {
+        ::openmldb::api::LogEntry entry;
+        if (!entry.ParseFromString(*record)) {
+            return kInvalidRecord;
+        }
+        std::string tmp_buf;
+        int ret = RemoveDeletedKey(entry, *deleted_index, &tmp_buf);
+        if (ret == 1) {
+            return kDeletedRecord;
+        } else if (ret == 2) {
+            record->swap(tmp_buf);
+        }
+        return table->IsExpire(entry) ? kExpiredRecord : kWriteRecord;
+    });
+    std::string buffer;
+    uint64_t read_count = 0;
+    while (true) {
+        ::openmldb::base::Slice record;
+        ::openmldb::log::Status status = reader.ReadRecord(&record, &buffer);
+        if (status.IsEof()) {
+            break;
+        }
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to read record for tid %u, pid %u with error %s", tid_, pid_,
+                  status.ToString().c_str());
+            return -1;
+        }
+        writer->Write(record);
+        if (++read_count % KEY_NUM_DISPLAY == 0) {
+            PDLOG(INFO, "tackled key num[%lu] total[%lu]", read_count, manifest.count());
+        }
+    }
+    // the records after are filtered by the caller
+    writer->SetFilter(SnapshotPartWriter::Filter());
+    if (read_count != manifest.count()) {
+        PDLOG(WARNING, "key num not match! total key num[%lu] read key num[%lu]", manifest.count(), read_count);
+        return -1;
+    }
+    return 0;
+}
+
 uint64_t MemTableSnapshot::CollectDeletedKey(uint64_t end_offset) {
     deleted_keys_.clear();
     ::openmldb::log::LogReader log_reader(log_part_, log_path_, false);
@@ -353,35 +881,76 @@ int MemTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_o
         return -1;
     }
     making_snapshot_.store(true, std::memory_order_release);
+    uint64_t collected_offset = CollectDeletedKey(end_offset);
+    uint64_t start_time = ::baidu::common::timer::now_time();
+    // the adapted heights are kept in the manifest for the keys recovered from the snapshot
+    std::vector<uint32_t> key_entry_heights;
+    auto mem_table = std::dynamic_pointer_cast<MemTable>(table);
+    if (mem_table && FLAGS_key_entry_adaptive_height) {
+        mem_table->AdaptKeyEntryHeight();
+        key_entry_heights = mem_table->GetKeyEntryHeights();
+    }
+    if (mem_table) {
+        mem_table->UpdateIndexStats();
+    }
+    ::openmldb::api::Manifest manifest;
+    int result = GetLocalManifest(snapshot_path_ + MANIFEST, manifest);
+    // an incremental snapshot keeps the records of binlog after the last snapshot only
+    bool make_delta = result == 0 && CanMakeDelta(table, manifest);
     std::string now_time = ::openmldb::base::GetNowTime();
     std::string snapshot_name = now_time.substr(0, now_time.length() - 2) + ".sdb";
     if (FLAGS_snapshot_compression != "off") {
         snapshot_name.append(".");
         snapshot_name.append(FLAGS_snapshot_compression);
     }
+    // the directory of an old snapshot can not be replaced by rename, and the old snapshot is kept on
+    // making an incremental one
+    std::string name = snapshot_name;
+    for (uint32_t i = 1;
+         ::openmldb::base::IsFolder(snapshot_path_ + name) ||
+         ((make_delta || FLAGS_snapshot_part_num > 1) && ::openmldb::base::IsExists(snapshot_path_ + name));
+         i++) {
+        name = snapshot_name + "." + std::to_string(i);
+    }
+    snapshot_name = name;
     std::string snapshot_name_tmp = snapshot_name + ".tmp";
     std::string full_path = snapshot_path_ + snapshot_name;
     std::string tmp_file_path = snapshot_path_ + snapshot_name_tmp;
-    FILE* fd = fopen(tmp_file_path.c_str(), "ab+");
-    if (fd == NULL) {
-        PDLOG(WARNING, "fail to create file %s", tmp_file_path.c_str());
-        making_snapshot_.store(false, std::memory_order_release);
-        return -1;
+    WriteHandle* wh = NULL;
+    std::unique_ptr<SnapshotPartWriter> part_writer;
+    if (!make_delta && FLAGS_snapshot_part_num > 1) {
+        // the snapshot is a directory of part files
+        part_writer.reset(new SnapshotPartWriter(tmp_file_path, FLAGS_snapshot_part_num));
+        if (!part_writer->Open()) {
+            part_writer.reset();
+            ::openmldb::base::RemoveDirRecursive(tmp_file_path);
+            deleted_keys_.clear();
+            making_snapshot_.store(false, std::memory_order_release);
+            return -1;
+        }
+    } else {
+        FILE* fd = fopen(tmp_file_path.c_str(), "ab+");
+        if (fd == NULL) {
+            PDLOG(WARNING, "fail to create file %s", tmp_file_path.c_str());
+            deleted_keys_.clear();
+            making_snapshot_.store(false, std::memory_order_release);
+            return -1;
+        }
+        wh = new WriteHandle(FLAGS_snapshot_compression, snapshot_name_tmp, fd, 0, true);
     }
-    uint64_t collected_offset = CollectDeletedKey(end_offset);
-    uint64_t start_time = ::baidu::common::timer::now_time();
-    WriteHandle* wh = new WriteHandle(FLAGS_snapshot_compression, snapshot_name_tmp, fd);
-    ::openmldb::api::Manifest manifest;
     bool has_error = false;
     uint64_t write_count = 0;
     uint64_t expired_key_num = 0;
     uint64_t deleted_key_num = 0;
     uint64_t last_term = term;
-    int result = GetLocalManifest(snapshot_path_ + MANIFEST, manifest);
     if (result == 0) {
         // filter old snapshot
-        if (TTLSnapshot(table, manifest, wh, write_count, expired_key_num, deleted_key_num) < 0) {
-            has_error = true;
+        if (!make_delta) {
+            int ret = part_writer ? TTLSnapshot(table, manifest, part_writer.get())
+                                  : TTLSnapshot(table, manifest, wh, write_count, expired_key_num, deleted_key_num);
+            if (ret < 0) {
+                has_error = true;
+            }
         }
         last_term = manifest.term();
         DEBUGLOG("old manifest term is %lu", last_term);
@@ -439,12 +1008,16 @@ int MemTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_o
                 expired_key_num++;
                 continue;
             }
-            ::openmldb::log::Status status = wh->Write(record);
-            if (!status.ok()) {
-                PDLOG(WARNING, "fail to write snapshot. path[%s] status[%s]", tmp_file_path.c_str(),
-                      status.ToString().c_str());
-                has_error = true;
-                break;
+            if (part_writer) {
+                part_writer->Write(record);
+            } else {
+                ::openmldb::log::Status status = wh->Write(record);
+                if (!status.ok()) {
+                    PDLOG(WARNING, "fail to write snapshot. path[%s] status[%s]", tmp_file_path.c_str(),
+                          status.ToString().c_str());
+                    has_error = true;
+                    break;
+                }
             }
             write_count++;
             if ((write_count + expired_key_num + deleted_key_num) % KEY_NUM_DISPLAY == 0) {
@@ -477,18 +1050,42 @@ int MemTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_o
         delete wh;
         wh = NULL;
     }
+    if (part_writer) {
+        if (!part_writer->Close()) {
+            has_error = true;
+        }
+        // the records of binlog are counted on dispatching
+        write_count = part_writer->GetWriteCount();
+        expired_key_num += part_writer->GetExpiredCount();
+        deleted_key_num += part_writer->GetDeletedCount();
+        part_writer.reset();
+    }
     int ret = 0;
     if (has_error) {
-        unlink(tmp_file_path.c_str());
+        DeleteSnapshot(snapshot_name_tmp);
         ret = -1;
     } else {
         if (rename(tmp_file_path.c_str(), full_path.c_str()) == 0) {
-            if (GenManifest(snapshot_name, write_count, cur_offset, last_term) == 0) {
+            int manifest_ret = 0;
+            if (make_delta) {
+                std::vector<std::string> delta_names(manifest.delta_name().begin(), manifest.delta_name().end());
+                if (write_count > 0) {
+                    delta_names.push_back(snapshot_name);
+                } else {
+                    DeleteSnapshot(snapshot_name);
+                }
+                manifest_ret = GenManifest(manifest.name(), manifest.count() + write_count, cur_offset, last_term,
+                                           delta_names, key_entry_heights);
+            } else {
+                manifest_ret = GenManifest(snapshot_name, write_count, cur_offset, last_term, {}, key_entry_heights);
+            }
+            if (manifest_ret == 0) {
                 // delete old snapshot
-                if (manifest.has_name() && manifest.name() != snapshot_name) {
+                if (!make_delta && manifest.has_name()) {
                     DEBUGLOG("old snapshot[%s] has deleted", manifest.name().c_str());
-                    unlink((snapshot_path_ + manifest.name()).c_str());
+                    DeleteSnapshot(manifest, snapshot_name);
                 }
+                SaveRowDict(table);
                 uint64_t consumed = ::baidu::common::timer::now_time() - start_time;
                 PDLOG(INFO,
                       "make snapshot[%s] success. update offset from %lu to %lu."
@@ -500,12 +1097,12 @@ int MemTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_o
                 out_offset = cur_offset;
             } else {
                 PDLOG(WARNING, "GenManifest failed. delete snapshot file[%s]", full_path.c_str());
-                unlink(full_path.c_str());
+                DeleteSnapshot(snapshot_name);
                 ret = -1;
             }
         } else {
             PDLOG(WARNING, "rename[%s] failed", snapshot_name.c_str());
-            unlink(tmp_file_path.c_str());
+            DeleteSnapshot(snapshot_name_tmp);
             ret = -1;
         }
     }
@@ -514,6 +1111,103 @@ int MemTableSnapshot::MakeSnapshot(std::shared_ptr<Table> table, uint64_t& out_o
     return ret;
 }
 
+bool MemTableSnapshot::CanMakeDelta(const std::shared_ptr<Table>& table, const ::openmldb::api::Manifest& manifest) {
+    if (FLAGS_snapshot_max_delta_num == 0 ||
+        static_cast<uint32_t>(manifest.delta_name_size()) >= FLAGS_snapshot_max_delta_num) {
+        return false;
+    }
+    // the deleted keys and indexes are removed from the old snapshot by a full one
+    if (!deleted_keys_.empty()) {
+        return false;
+    }
+    for (const auto& index : table->GetAllIndex()) {
+        if (index->GetStatus() != ::openmldb::storage::IndexStatus::kReady) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MemTableSnapshot::DeleteSnapshot(const std::string& snapshot_name) {
+    std::string path = snapshot_path_ + snapshot_name;
+    if (::openmldb::base::IsFolder(path)) {
+        if (!::openmldb::base::RemoveDirRecursive(path)) {
+            PDLOG(WARNING, "fail to remove snapshot dir %s", path.c_str());
+        }
+    } else {
+        unlink(path.c_str());
+    }
+}
+
+void MemTableSnapshot::DeleteSnapshot(const ::openmldb::api::Manifest& manifest, const std::string& keep_name) {
+    if (manifest.name() != keep_name) {
+        DeleteSnapshot(manifest.name());
+    }
+    for (const auto& delta_name : manifest.delta_name()) {
+        if (delta_name != keep_name) {
+            DeleteSnapshot(delta_name);
+        }
+    }
+}
+
+void MemTableSnapshot::SaveRowDict(const std::shared_ptr<Table>& table) {
+    auto mem_table = std::dynamic_pointer_cast<MemTable>(table);
+    if (!mem_table || mem_table->GetRowCodec() == nullptr) {
+        return;
+    }
+    ::openmldb::api::RowDict row_dict;
+    for (const auto& kv : mem_table->GetRowCodec()->GetDict()) {
+        auto* column = row_dict.add_columns();
+        column->set_idx(kv.first);
+        for (const auto& value : kv.second) {
+            column->add_values(value);
+        }
+    }
+    std::string full_path = snapshot_path_ + ROW_DICT;
+    std::string tmp_file = full_path + ".tmp";
+    FILE* fd_write = fopen(tmp_file.c_str(), "w");
+    if (fd_write == NULL) {
+        PDLOG(WARNING, "fail to open file %s", tmp_file.c_str());
+        return;
+    }
+    std::string buf;
+    row_dict.SerializeToString(&buf);
+    bool io_error = fwrite(buf.data(), 1, buf.size(), fd_write) != buf.size() || fflush(fd_write) == EOF ||
+                    fsync(fileno(fd_write)) == -1;
+    fclose(fd_write);
+    if (io_error || rename(tmp_file.c_str(), full_path.c_str()) != 0) {
+        // the dictionaries are rebuilt from the rows if the file is missing
+        PDLOG(WARNING, "fail to save row dict. path[%s]", full_path.c_str());
+        unlink(tmp_file.c_str());
+    }
+}
+
+void MemTableSnapshot::LoadRowDict(const std::shared_ptr<Table>& table) {
+    auto mem_table = std::dynamic_pointer_cast<MemTable>(table);
+    if (!mem_table || mem_table->GetRowCodec() == nullptr) {
+        return;
+    }
+    std::string full_path = snapshot_path_ + ROW_DICT;
+    int fd = open(full_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    ::openmldb::api::RowDict row_dict;
+    google::protobuf::io::FileInputStream file_input(fd);
+    file_input.SetCloseOnDelete(true);
+    if (!row_dict.ParseFromZeroCopyStream(&file_input)) {
+        PDLOG(WARNING, "fail to parse row dict. path[%s]", full_path.c_str());
+        return;
+    }
+    for (const auto& column : row_dict.columns()) {
+        std::vector<std::string> values(column.values().begin(), column.values().end());
+        if (!mem_table->GetRowCodec()->SetDict(column.idx(), values)) {
+            PDLOG(WARNING, "fail to restore the dict of column %u. tid %u pid %u", column.idx(), tid_, pid_);
+        }
+    }
+    PDLOG(INFO, "load the dict of %d columns. tid %u pid %u", row_dict.columns_size(), tid_, pid_);
+}
+
 int MemTableSnapshot::RemoveDeletedKey(const ::openmldb::api::LogEntry& entry, const std::set<uint32_t>& deleted_index,
                                        std::string* buffer) {
     uint64_t cur_offset = entry.log_index();
@@ -628,24 +1322,95 @@ base::Status MemTableSnapshot::GetIndexKey(std::shared_ptr<Table> table,
         return base::Status(base::ReturnCode::kError, "schema version is not exist");
     }
     index_key->clear();
+    ::openmldb::codec::CompositeKeyBuilder key_builder;
+    std::string val;
     for (const auto& col : index->GetColumns()) {
         if ((int32_t)col.GetId() >= schema->size()) {
             return base::Status(base::ReturnCode::kError, "cannot found col");
         }
-        std::string val;
         int ret = it->second.GetStrValue(raw, col.GetId(), &val);
         if (ret < 0) {
             return base::Status(base::ReturnCode::kError, "decode error");
         } else if (ret == 1) {
             val = ::openmldb::codec::NONETOKEN;
         }
-        if (index_key->empty()) {
-            *index_key = std::move(val);
+        key_builder.Append(val);
+    }
+    key_builder.ReleaseTo(index_key);
+    return {};
+}
+
+void MemTableSnapshot::ExtractIndexFromRecords(std::shared_ptr<Table> table,
+        const std::vector<std::shared_ptr<IndexDef>>* index_vec, uint32_t partition_num, uint32_t start,
+        uint32_t end, std::vector<std::string>* records, std::vector<uint8_t>* states,
+        ::openmldb::base::CountDownLatch* latch) {
+    uint32_t pid = table->GetPid();
+    // the decoders are built by every task so that nothing but the table is shared between threads
+    std::map<uint8_t, codec::RowView> decoder_map;
+    bool decoder_ok = GetAllDecoder(table, &decoder_map).OK();
+    ::openmldb::api::LogEntry entry;
+    for (uint32_t i = start; i < end; i++) {
+        std::string& record = (*records)[i];
+        if (!decoder_ok || !entry.ParseFromString(record)) {
+            (*states)[i] = kInvalidRecord;
+            continue;
+        }
+        (*states)[i] = kWriteRecord;
+        if (!deleted_keys_.empty()) {
+            int check_ret = CheckDeleteAndUpdate(table, &entry);
+            if (check_ret == 1) {
+                (*states)[i] = kDeletedRecord;
+                continue;
+            } else if (check_ret == 2) {
+                entry.SerializeToString(&record);
+            }
+        }
+        // delete timeout key
+        if (table->IsExpire(entry)) {
+            (*states)[i] = kExpiredRecord;
+            continue;
+        }
+        if (entry.has_method_type() && entry.method_type() == ::openmldb::api::MethodType::kDelete) {
+            continue;
+        }
+        std::string buff;
+        openmldb::base::Slice data;
+        if (table->GetCompressType() == openmldb::type::kSnappy) {
+            snappy::Uncompress(entry.value().data(), entry.value().size(), &buff);
+            data.reset(buff.data(), buff.size());
         } else {
-            *index_key += "|" + val;
+            data.reset(entry.value().data(), entry.value().size());
+        }
+        std::map<uint32_t, std::string> add_key_idx_map;
+        for (const auto& index : *index_vec) {
+            std::string index_key;
+            auto ret = GetIndexKey(table, index, data, &decoder_map, &index_key);
+            if (ret.OK() && !index_key.empty()) {
+                uint32_t index_pid = ::openmldb::base::hash64(index_key) % partition_num;
+                if (index_pid == pid) {
+                    add_key_idx_map.emplace(index->GetId(), index_key);
+                }
+            }
+        }
+        if (add_key_idx_map.empty()) {
+            continue;
         }
+        for (const auto& kv : add_key_idx_map) {
+            ::openmldb::api::Dimension* dim = entry.add_dimensions();
+            dim->set_idx(kv.first);
+            dim->set_key(kv.second);
+        }
+        entry.SerializeToString(&record);
+        entry.clear_dimensions();
+        for (const auto& kv : add_key_idx_map) {
+            ::openmldb::api::Dimension* dim = entry.add_dimensions();
+            dim->set_idx(kv.first);
+            dim->set_key(kv.second);
+        }
+        table->Put(entry);
+        (*states)[i] = kExtractRecord;
     }
-    return {};
+    latch->CountDown();
 }
 
 base::Status MemTableSnapshot::ExtractIndexFromSnapshot(std::shared_ptr<Table> table,
@@ -670,108 +1435,85 @@ base::Status MemTableSnapshot::ExtractIndexFromSnapshot(std::shared_ptr<Table> t
         }
         index_vec.push_back(index_def);
     }
-    std::string full_path = snapshot_path_ + manifest.name();
-    FILE* fd = fopen(full_path.c_str(), "rb");
-    if (fd == NULL) {
-        PDLOG(WARNING, "fail to open path %s for error %s", full_path.c_str(), strerror(errno));
+    SnapshotReader reader(snapshot_path_, manifest);
+    if (!reader.Init()) {
         return base::Status(base::ReturnCode::kError, "fail to open file");
     }
-    ::openmldb::log::SequentialFile* seq_file = ::openmldb::log::NewSeqFile(manifest.name(), fd);
-    bool compressed = IsCompressed(full_path);
-    ::openmldb::log::Reader reader(seq_file, NULL, false, 0, compressed);
+    // the snapshot is read once, every batch of records is decoded, extracted and put by the threads
+    // and then written to new snapshot in the order of reading
+    uint32_t thread_num = std::max(FLAGS_extract_index_thread_num, 1u);
+    uint32_t batch_size = std::max(FLAGS_extract_index_batch, thread_num);
+    ::openmldb::base::TaskPool extract_pool(thread_num, thread_num);
+    std::vector<std::string> records;
+    records.reserve(batch_size);
+    std::vector<uint8_t> states;
     std::string buffer;
-    ::openmldb::api::LogEntry entry;
     bool has_error = false;
+    bool eof = false;
     uint64_t extract_count = 0;
-    uint64_t write_count = 0;
     DLOG(INFO) << "extract index data from snapshot";
-    while (true) {
-        ::openmldb::base::Slice record;
-        ::openmldb::log::Status status = reader.ReadRecord(&record, &buffer);
-        if (status.IsEof()) {
-            break;
-        }
-        if (!status.ok()) {
-            PDLOG(WARNING, "fail to read record for tid %u, pid %u with error %s",
-                    tid_, pid_, status.ToString().c_str());
-            has_error = true;
-            break;
+    while (!eof && !has_error) {
+        records.clear();
+        while (records.size() < batch_size) {
+            ::openmldb::base::Slice record;
+            ::openmldb::log::Status status = reader.ReadRecord(&record, &buffer);
+            if (status.IsEof()) {
+                eof = true;
+                break;
+            }
+            if (!status.ok()) {
+                PDLOG(WARNING, "fail to read record for tid %u, pid %u with error %s",
+                        tid_, pid_, status.ToString().c_str());
+                has_error = true;
+                break;
+            }
+            records.emplace_back(record.data(), record.size());
         }
-        if (!entry.ParseFromString(record.ToString())) {
-            PDLOG(WARNING, "fail parse record for tid %u, pid %u with value %s",
-                    tid_, pid_, ::openmldb::base::DebugString(record.ToString()).c_str());
-            has_error = true;
+        if (has_error || records.empty()) {
             break;
         }
-        std::string tmp_buf;
-        if (!deleted_keys_.empty()) {
-            int check_ret = CheckDeleteAndUpdate(table, &entry);
-            if (check_ret == 1) {
+        states.assign(records.size(), kInvalidRecord);
+        uint32_t task_num = std::min(thread_num, static_cast<uint32_t>(records.size()));
+        uint32_t step = (records.size() + task_num - 1) / task_num;
+        task_num = (records.size() + step - 1) / step;
+        ::openmldb::base::CountDownLatch latch(task_num);
+        for (uint32_t start = 0; start < records.size(); start += step) {
+            uint32_t end = std::min(start + step, static_cast<uint32_t>(records.size()));
+            extract_pool.AddTask(boost::bind(&MemTableSnapshot::ExtractIndexFromRecords, this, table, &index_vec,
+                                             partition_num, start, end, &records, &states, &latch));
+        }
+        latch.Wait();
+        for (uint32_t i = 0; i < records.size(); i++) {
+            if (states[i] == kInvalidRecord) {
+                PDLOG(WARNING, "fail parse record for tid %u, pid %u with value %s",
+                        tid_, pid_, ::openmldb::base::DebugString(records[i]).c_str());
+                has_error = true;
+                break;
+            } else if (states[i] == kDeletedRecord) {
                 (*deleted_key_num)++;
                 continue;
-            } else if (check_ret == 2) {
-                entry.SerializeToString(&tmp_buf);
-                record.reset(tmp_buf.data(), tmp_buf.size());
+            } else if (states[i] == kExpiredRecord) {
+                (*expired_key_num)++;
+                continue;
+            } else if (states[i] == kExtractRecord) {
+                extract_count++;
             }
-        }
-        // delete timeout key
-        if (table->IsExpire(entry)) {
-            (*expired_key_num)++;
-            continue;
-        }
-        if (!(entry.has_method_type() && entry.method_type() == ::openmldb::api::MethodType::kDelete)) {
-            std::string buff;
-            openmldb::base::Slice data;
-            if (table->GetCompressType() == openmldb::type::kSnappy) {
-                snappy::Uncompress(entry.value().data(), entry.value().size(), &buff);
-                data.reset(buff.data(), buff.size());
-            } else {
-                data.reset(entry.value().data(), entry.value().size());
-            }
-            std::map<uint32_t, std::string> add_key_idx_map;
-            for (const auto& index : index_vec) {
-                std::string index_key;
-                auto ret = GetIndexKey(table, index, data, &decoder_map, &index_key);
-                if (ret.OK() && !index_key.empty()) {
-                    uint32_t index_pid = ::openmldb::base::hash64(index_key) % partition_num;
-                    if (index_pid == pid) {
-                        add_key_idx_map.emplace(index->GetId(), index_key);
-                    }
-                }
+            ::openmldb::log::Status status = wh->Write(::openmldb::base::Slice(records[i]));
+            if (!status.ok()) {
+                PDLOG(WARNING, "fail to extract index from snapshot. status[%s] tid[%u] pid[%u]",
+                      status.ToString().c_str(), tid, pid);
+                has_error = true;
+                break;
             }
-            if (!add_key_idx_map.empty()) {
-                for (const auto& kv : add_key_idx_map) {
-                    ::openmldb::api::Dimension* dim = entry.add_dimensions();
-                    dim->set_idx(kv.first);
-                    dim->set_key(kv.second);
-                }
-                entry.SerializeToString(&tmp_buf);
-                record.reset(tmp_buf.data(), tmp_buf.size());
-                entry.clear_dimensions();
-                for (const auto& kv : add_key_idx_map) {
-                    ::openmldb::api::Dimension* dim = entry.add_dimensions();
-                    dim->set_idx(kv.first);
-                    dim->set_key(kv.second);
-                }
-                table->Put(entry);
-                extract_count++;
+            if ((*count + *expired_key_num + *deleted_key_num) % KEY_NUM_DISPLAY == 0) {
+                PDLOG(INFO, "tackled key num[%lu] total[%lu] tid[%u] pid[%u]",
+                        *count + *expired_key_num, manifest.count(), tid, pid);
             }
+            (*count)++;
         }
-        status = wh->Write(record);
-        if (!status.ok()) {
-            PDLOG(WARNING, "fail to extract index from snapshot. status[%s] tid[%u] pid[%u]",
-                  status.ToString().c_str(), tid, pid);
-            has_error = true;
-            break;
-        }
-        if ((*count + *expired_key_num + *deleted_key_num) % KEY_NUM_DISPLAY == 0) {
-            PDLOG(INFO, "tackled key num[%lu] total[%lu] tid[%u] pid[%u]",
-                    *count + *expired_key_num, manifest.count(), tid, pid);
-        }
-        (*count)++;
     }
-    delete seq_file;
-    if (*expired_key_num + write_count + *deleted_key_num != manifest.count()) {
+    extract_pool.Stop();
+    if (!has_error && *expired_key_num + *count + *deleted_key_num != manifest.count()) {
         PDLOG(WARNING, "key num not match! total key[%lu] load key[%lu] ttl key[%lu] delete key [%lu], tid %u pid %u",
                 manifest.count(), *count, *expired_key_num, *deleted_key_num, tid, pid);
         has_error = true;
@@ -790,15 +1532,10 @@ int MemTableSnapshot::ExtractIndexFromSnapshot(std::shared_ptr<Table> table, con
                                                uint64_t& expired_key_num, uint64_t& deleted_key_num) {
     uint32_t tid = table->GetId();
     uint32_t pid = table->GetPid();
-    std::string full_path = snapshot_path_ + manifest.name();
-    FILE* fd = fopen(full_path.c_str(), "rb");
-    if (fd == NULL) {
-        PDLOG(WARNING, "fail to open path %s for error %s", full_path.c_str(), strerror(errno));
+    SnapshotReader reader(snapshot_path_, manifest);
+    if (!reader.Init()) {
         return -1;
     }
-    ::openmldb::log::SequentialFile* seq_file = ::openmldb::log::NewSeqFile(manifest.name(), fd);
-    bool compressed = IsCompressed(full_path);
-    ::openmldb::log::Reader reader(seq_file, NULL, false, 0, compressed);
     std::string buffer;
     ::openmldb::api::LogEntry entry;
     bool has_error = false;
@@ -879,14 +1616,11 @@ int MemTableSnapshot::ExtractIndexFromSnapshot(std::shared_ptr<Table> table, con
                 other_error_count++;
                 continue;
             }
-            std::string cur_key;
+            ::openmldb::codec::CompositeKeyBuilder key_builder;
             for (uint32_t i : index_cols) {
-                if (cur_key.empty()) {
-                    cur_key = row[i];
-                } else {
-                    cur_key += "|" + row[i];
-                }
+                key_builder.Append(row[i]);
             }
+            std::string cur_key = key_builder.Release();
             if (cur_key.empty()) {
                 other_error_count++;
                 DLOG(INFO) << "skip empty key";
@@ -928,7 +1662,6 @@ int MemTableSnapshot::ExtractIndexFromSnapshot(std::shared_ptr<Table> table, con
         }
         count++;
     }
-    delete seq_file;
     if (expired_key_num + count + deleted_key_num + schame_size_less_count + other_error_count != manifest.count()) {
         LOG(WARNING) << "key num not match ! total key num[" << manifest.count() << "] load key num[" << count
                      << "] ttl key num[" << expired_key_num << "] schema size less num[" << schame_size_less_count
@@ -1117,7 +1850,7 @@ int MemTableSnapshot::ExtractIndexData(std::shared_ptr<Table> table,
     }
     uint64_t collected_offset = CollectDeletedKey(0);
     uint64_t start_time = ::baidu::common::timer::now_time();
-    WriteHandle* wh = new WriteHandle(FLAGS_snapshot_compression, snapshot_name_tmp, fd);
+    WriteHandle* wh = new WriteHandle(FLAGS_snapshot_compression, snapshot_name_tmp, fd, 0, true);
     ::openmldb::api::Manifest manifest;
     bool has_error = false;
     uint64_t write_count = 0;
@@ -1161,9 +1894,9 @@ int MemTableSnapshot::ExtractIndexData(std::shared_ptr<Table> table,
         if (rename(tmp_file_path.c_str(), full_path.c_str()) == 0) {
             if (GenManifest(snapshot_name, write_count, cur_offset, last_term) == 0) {
                 // delete old snapshot
-                if (manifest.has_name() && manifest.name() != snapshot_name) {
+                if (manifest.has_name()) {
                     DEBUGLOG("old snapshot[%s] has deleted", manifest.name().c_str());
-                    unlink((snapshot_path_ + manifest.name()).c_str());
+                    DeleteSnapshot(manifest, snapshot_name);
                 }
                 uint64_t consumed = ::baidu::common::timer::now_time() - start_time;
                 PDLOG(INFO,
@@ -1214,7 +1947,7 @@ int MemTableSnapshot::ExtractIndexData(std::shared_ptr<Table> table, const ::ope
     }
     uint64_t collected_offset = CollectDeletedKey(0);
     uint64_t start_time = ::baidu::common::timer::now_time();
-    WriteHandle* wh = new WriteHandle(FLAGS_snapshot_compression, snapshot_name_tmp, fd);
+    WriteHandle* wh = new WriteHandle(FLAGS_snapshot_compression, snapshot_name_tmp, fd, 0, true);
     ::openmldb::api::Manifest manifest;
     bool has_error = false;
     uint64_t write_count = 0;
@@ -1349,14 +2082,11 @@ int MemTableSnapshot::ExtractIndexData(std::shared_ptr<Table> table, const ::ope
                     DLOG(INFO) << "skip current data";
                     continue;
                 }
-                std::string cur_key;
+                ::openmldb::codec::CompositeKeyBuilder key_builder;
                 for (uint32_t i : index_cols) {
-                    if (cur_key.empty()) {
-                        cur_key = row[i];
-                    } else {
-                        cur_key += "|" + row[i];
-                    }
+                    key_builder.Append(row[i]);
                 }
+                std::string cur_key = key_builder.Release();
                 if (cur_key.empty()) {
                     DLOG(INFO) << "skip empty key";
                     continue;
@@ -1427,9 +2157,9 @@ int MemTableSnapshot::ExtractIndexData(std::shared_ptr<Table> table, const ::ope
         if (rename(tmp_file_path.c_str(), full_path.c_str()) == 0) {
             if (GenManifest(snapshot_name, write_count, cur_offset, last_term) == 0) {
                 // delete old snapshot
-                if (manifest.has_name() && manifest.name() != snapshot_name) {
+                if (manifest.has_name()) {
                     DEBUGLOG("old snapshot[%s] has deleted", manifest.name().c_str());
-                    unlink((snapshot_path_ + manifest.name()).c_str());
+                    DeleteSnapshot(manifest, snapshot_name);
                 }
                 uint64_t consumed = ::baidu::common::timer::now_time() - start_time;
                 PDLOG(INFO,
@@ -1488,34 +2218,31 @@ bool MemTableSnapshot::PackNewIndexEntry(std::shared_ptr<Table> table,
     }
     std::string key;
     std::set<uint32_t> pid_set;
+    ::openmldb::codec::CompositeKeyBuilder key_builder;
     for (uint32_t i = 0; i < index_cols.size(); ++i) {
-        std::string cur_key;
+        key_builder.Reset();
         bool skip_calc = false;
         for (uint32_t j : index_cols[i]) {
             if (j >= row.size()) {
                 skip_calc = true;
                 break;
             }
-            if (cur_key.empty()) {
-                cur_key = row[j];
-            } else {
-                cur_key += "|" + row[j];
-            }
+            key_builder.Append(row[j]);
         }
         if (skip_calc) {
             continue;
         }
-        if (cur_key.empty()) {
+        if (key_builder.Empty()) {
             DLOG(INFO) << "key is emptry";
             continue;
         }
 
-        uint32_t pid = ::openmldb::base::hash64(cur_key) % partition_num;
+        uint32_t pid = key_builder.GetPid(partition_num);
         if (i < index_cols.size() - 1) {
             pid_set.insert(pid);
         } else {
             *index_pid = pid;
-            key = cur_key;
+            key_builder.ReleaseTo(&key);
         }
     }
     DLOG(INFO) << "pack end ";
@@ -1545,17 +2272,17 @@ bool MemTableSnapshot::DumpSnapshotIndexData(std::shared_ptr<Table> table,
         return false;
     }
     *snapshot_offset = manifest.offset();
+    if (ret == 1) {
+        // no snapshot yet
+        return true;
+    }
     std::string path = snapshot_path_ + "/" + manifest.name();
     uint64_t succ_cnt = 0;
     uint64_t failed_cnt = 0;
-    FILE* fd = fopen(path.c_str(), "rb");
-    if (fd == NULL) {
-        PDLOG(WARNING, "fail to open path %s for error %s", path.c_str(), strerror(errno));
+    SnapshotReader reader(snapshot_path_, manifest);
+    if (!reader.Init()) {
         return false;
     }
-    ::openmldb::log::SequentialFile* seq_file = ::openmldb::log::NewSeqFile(path, fd);
-    bool compressed = IsCompressed(path);
-    ::openmldb::log::Reader reader(seq_file, NULL, false, 0, compressed);
     ::openmldb::api::LogEntry entry;
     std::string buffer;
     std::string entry_buff;
@@ -1593,7 +2320,6 @@ bool MemTableSnapshot::DumpSnapshotIndexData(std::shared_ptr<Table> table,
         ::openmldb::base::Slice new_record(entry_str);
         status = whs[index_pid]->Write(new_record);
         if (!status.ok()) {
-            delete seq_file;
             PDLOG(WARNING,
                   "fail to dump index entrylog in snapshot to pid[%u]. tid "
                   "%u pid %u",
@@ -1602,7 +2328,6 @@ bool MemTableSnapshot::DumpSnapshotIndexData(std::shared_ptr<Table> table,
         }
         succ_cnt++;
     }
-    delete seq_file;
     return true;
 }
 
@@ -1788,13 +2513,7 @@ int MemTableSnapshot::DecodeData(std::shared_ptr<Table> table, const openmldb::a
     return 0;
 }
 
-bool MemTableSnapshot::IsCompressed(const std::string& path) {
-    if (path.find(openmldb::log::ZLIB_COMPRESS_SUFFIX) != std::string::npos ||
-        path.find(openmldb::log::SNAPPY_COMPRESS_SUFFIX) != std::string::npos) {
-        return true;
-    }
-    return false;
-}
+bool MemTableSnapshot::IsCompressed(const std::string& path) { return IsCompressedFile(path); }
 
 }  // namespace storage
 }  // namespace openmldb
@@ -33,12 +33,46 @@
 
 using ::openmldb::api::LogEntry;
 namespace openmldb {
+namespace base {
+class TaskPool;
+class CountDownLatch;
+}  // namespace base
+
 namespace storage {
 
 using ::openmldb::log::WriteHandle;
 
 typedef ::openmldb::base::Skiplist<uint32_t, uint64_t, ::openmldb::base::DefaultComparator> LogParts;
 
+// SnapshotReader reads the records of a snapshot, which is one file or a directory of part files.
+// the part files are read in turn
+class SnapshotReader {
+ public:
+    explicit SnapshotReader(const std::string& path);
+    // read the snapshot of the manifest, and then its incremental snapshots in order
+    SnapshotReader(const std::string& snapshot_path, const ::openmldb::api::Manifest& manifest);
+    ~SnapshotReader();
+
+    // return false if the snapshot fails to open
+    bool Init();
+
+    // the status is eof once the records of the last file are read
+    ::openmldb::log::Status ReadRecord(::openmldb::base::Slice* record, std::string* scratch);
+
+    // the part files sorted by name if the snapshot is a directory, or the snapshot itself
+    static std::vector<std::string> GetFiles(const std::string& path);
+
+ private:
+    bool OpenFile(uint32_t idx);
+    void CloseFile();
+
+    std::vector<std::string> paths_;
+    std::vector<std::string> files_;
+    uint32_t idx_;
+    ::openmldb::log::SequentialFile* seq_file_;
+    std::unique_ptr<::openmldb::log::Reader> reader_;
+};
+
 // table snapshot
 class MemTableSnapshot : public Snapshot {
  public:
@@ -50,7 +84,9 @@ class MemTableSnapshot : public Snapshot {
 
     bool Recover(std::shared_ptr<Table> table, uint64_t& latest_offset) override;
 
-    void RecoverFromSnapshot(const std::string& snapshot_name, uint64_t expect_cnt, std::shared_ptr<Table> table);
+    // the incremental snapshots are loaded in parallel with the snapshot
+    void RecoverFromSnapshot(const std::string& snapshot_name, uint64_t expect_cnt, std::shared_ptr<Table> table,
+                             const std::vector<std::string>& delta_names = {});
 
     int MakeSnapshot(std::shared_ptr<Table> table,
                      uint64_t& out_offset,  // NOLINT
@@ -64,6 +100,16 @@ class MemTableSnapshot : public Snapshot {
     void Put(std::string& path, std::shared_ptr<Table>& table,  // NOLINT
              std::vector<std::string*> recordPtr, std::atomic<uint64_t>* succ_cnt, std::atomic<uint64_t>* failed_cnt);
 
+    // decode the records and dispatch the entries to put pools by the key of first dimension, so the
+    // entries of one key are always put by the same thread in order
+    void Dispatch(std::string& path, std::vector<std::string*> recordPtr,  // NOLINT
+                  std::vector<std::unique_ptr<::openmldb::base::TaskPool>>* put_pools, std::shared_ptr<Table>& table,
+                  std::atomic<uint64_t>* succ_cnt, std::atomic<uint64_t>* failed_cnt);
+
+    void PutEntries(std::string& path, std::shared_ptr<Table>& table,  // NOLINT
+                    std::vector<::openmldb::api::LogEntry*> entries, std::atomic<uint64_t>* succ_cnt,
+                    std::atomic<uint64_t>* failed_cnt);
+
     std::string GenSnapshotName();
 
     base::Status GetAllDecoder(std::shared_ptr<Table> table, std::map<uint8_t, codec::RowView>* decoder_map);
@@ -71,6 +117,12 @@ class MemTableSnapshot : public Snapshot {
     base::Status GetIndexKey(std::shared_ptr<Table> table, const std::shared_ptr<IndexDef>& index,
             const base::Slice& data, std::map<uint8_t, codec::RowView>* decoder_map, std::string* index_key);
 
+    // extract the new indexes of records [start, end) and put them to table, the records are updated to be
+    // written to new snapshot and the state of each record is set
+    void ExtractIndexFromRecords(std::shared_ptr<Table> table, const std::vector<std::shared_ptr<IndexDef>>* index_vec,
+            uint32_t partition_num, uint32_t start, uint32_t end, std::vector<std::string>* records,
+            std::vector<uint8_t>* states, ::openmldb::base::CountDownLatch* latch);
+
     base::Status ExtractIndexFromSnapshot(std::shared_ptr<Table> table, const ::openmldb::api::Manifest& manifest,
             WriteHandle* wh, const std::vector<::openmldb::common::ColumnKey>& add_indexs,
             uint32_t partition_num, uint64_t* count, uint64_t* expired_key_num, uint64_t* deleted_key_num);
@@ -116,6 +168,35 @@ class MemTableSnapshot : public Snapshot {
                          std::string* buffer);
 
  private:
+    class SnapshotPartWriter;
+
+    // filter the records of the old snapshot by the threads of the part files
+    int TTLSnapshot(std::shared_ptr<Table> table, const ::openmldb::api::Manifest& manifest,
+                    SnapshotPartWriter* writer);
+
+    // load the part file of a snapshot in the calling thread
+    void RecoverSnapshotPart(const std::string& path, std::shared_ptr<Table> table, std::atomic<uint64_t>* g_succ_cnt,
+                             std::atomic<uint64_t>* g_failed_cnt);
+
+    // the snapshot is a file, or a directory if it is made with snapshot_part_num
+    void DeleteSnapshot(const std::string& snapshot_name);
+    // delete the snapshot of the manifest and its incremental snapshots except `keep_name`
+    void DeleteSnapshot(const ::openmldb::api::Manifest& manifest, const std::string& keep_name);
+
+    // an incremental snapshot is made from the binlog only if no key is deleted and every index is ready
+    bool CanMakeDelta(const std::shared_ptr<Table>& table, const ::openmldb::api::Manifest& manifest);
+
+    // save the dictionaries of the compact rows next to the MANIFEST, and restore them before the
+    // rows are loaded, so the ids of the values stay the same across restarts
+    void SaveRowDict(const std::shared_ptr<Table>& table);
+    void LoadRowDict(const std::shared_ptr<Table>& table);
+
+    // map the uncompressed snapshot files and refer the rows in place, return false if the table
+    // is not a memory table or any file is compressed
+    bool RecoverMappedSnapshots(const std::string& full_path, std::shared_ptr<Table> table,
+                                const std::vector<std::string>& delta_names, std::atomic<uint64_t>* g_succ_cnt,
+                                std::atomic<uint64_t>* g_failed_cnt);
+
     // load single snapshot to table
     void RecoverSingleSnapshot(const std::string& path, std::shared_ptr<Table> table, std::atomic<uint64_t>* g_succ_cnt,
                                std::atomic<uint64_t>* g_failed_cnt);
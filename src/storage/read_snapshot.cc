@@ -0,0 +1,36 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/read_snapshot.h"
+
+namespace openmldb {
+namespace storage {
+
+static thread_local ReadSnapshot* t_snapshot = nullptr;
+
+uint64_t ReadSnapshot::Pin(uint32_t tid, uint32_t pid, uint64_t read_seq) {
+    std::lock_guard<std::mutex> lock(mu_);
+    return seqs_.emplace(static_cast<uint64_t>(tid) << 32 | pid, read_seq).first->second;
+}
+
+ReadSnapshot* ReadSnapshot::Current() { return t_snapshot; }
+
+ReadSnapshot::Scope::Scope(ReadSnapshot* snapshot) : prev_(t_snapshot) { t_snapshot = snapshot; }
+
+ReadSnapshot::Scope::~Scope() { t_snapshot = prev_; }
+
+}  // namespace storage
+}  // namespace openmldb
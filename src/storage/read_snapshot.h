@@ -0,0 +1,65 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_READ_SNAPSHOT_H_
+#define SRC_STORAGE_READ_SNAPSHOT_H_
+
+#include <stdint.h>
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+namespace openmldb {
+namespace storage {
+
+// The read seqs of the partitions pinned by one query, see MemTable::GetReadSeq. The query sets it on its thread
+// with Scope, then the window and traverse iterators of a MemTable created on the thread skip the rows put after
+// the pin of the partition, so every window of the query reads the partition as of the same point. A partition
+// not pinned by the query beforehand is pinned on its first read.
+class ReadSnapshot {
+ public:
+    ReadSnapshot() = default;
+    ReadSnapshot(const ReadSnapshot&) = delete;
+    ReadSnapshot& operator=(const ReadSnapshot&) = delete;
+
+    // pin read_seq for partition tid/pid if it is not pinned yet, return the seq pinned
+    uint64_t Pin(uint32_t tid, uint32_t pid, uint64_t read_seq);
+
+    // the snapshot set on the calling thread, NULL if there is none
+    static ReadSnapshot* Current();
+
+    // set the snapshot on the calling thread until it is destroyed
+    class Scope {
+     public:
+        explicit Scope(ReadSnapshot* snapshot);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+     private:
+        ReadSnapshot* prev_;
+    };
+
+ private:
+    std::mutex mu_;
+    // keyed by tid << 32 | pid
+    std::unordered_map<uint64_t, uint64_t> seqs_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_READ_SNAPSHOT_H_
@@ -27,6 +27,8 @@ static const uint32_t KEY_ENTRY_BYTE_SIZE = sizeof(KeyEntry);
 static const uint32_t ENTRY_NODE_SIZE = sizeof(::openmldb::base::Node<::openmldb::base::Slice, void*>);
 static const uint32_t DATA_NODE_SIZE = sizeof(::openmldb::base::Node<uint64_t, void*>);
 static const uint32_t KEY_ENTRY_PTR_SIZE = sizeof(KeyEntry*);
+static const uint32_t LATEST_KEY_ENTRY_BYTE_SIZE = sizeof(LatestKeyEntry);
+static const uint32_t LATEST_ENTRY_SIZE = sizeof(LatestEntries::Entry);
 
 static inline uint32_t GetRecordSize(uint32_t value_size) { return value_size + DATA_BLOCK_BYTE_SIZE; }
 
@@ -43,6 +45,13 @@ static inline uint32_t GetRecordPkMultiIdxSize(uint8_t height, uint32_t key_size
 
 static inline uint32_t GetRecordTsIdxSize(uint8_t height) { return height * 8 + DATA_NODE_SIZE; }
 
+static inline uint32_t GetRecordPkLatestIdxSize(uint8_t height, uint32_t key_size) {
+    return height * 8 + ENTRY_NODE_SIZE + LATEST_KEY_ENTRY_BYTE_SIZE + key_size;
+}
+
+// the row of latest entries takes one slot of the ring
+static inline uint32_t GetRecordLatestIdxSize() { return LATEST_ENTRY_SIZE; }
+
 }  // namespace storage
 }  // namespace openmldb
 #endif  // SRC_STORAGE_RECORD_H_
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/row_filter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace openmldb {
+namespace storage {
+
+using ::hybridse::vm::ColumnPredicate;
+
+template <typename T>
+static bool Compare(ColumnPredicate::Op op, const T& lhs, const T& rhs) {
+    switch (op) {
+        case ColumnPredicate::kEq:
+            return lhs == rhs;
+        case ColumnPredicate::kNe:
+            return lhs != rhs;
+        case ColumnPredicate::kLt:
+            return lhs < rhs;
+        case ColumnPredicate::kLe:
+            return lhs <= rhs;
+        case ColumnPredicate::kGt:
+            return lhs > rhs;
+        case ColumnPredicate::kGe:
+            return lhs >= rhs;
+    }
+    return true;
+}
+
+// the same order as the string comparison of the engine
+static int CompareString(const char* lhs, uint32_t lhs_len, const std::string& rhs) {
+    int r = memcmp(lhs, rhs.data(), std::min(static_cast<size_t>(lhs_len), rhs.size()));
+    if (r == 0 && lhs_len != rhs.size()) {
+        r = lhs_len < rhs.size() ? -1 : 1;
+    }
+    return r;
+}
+
+static bool IsCheckable(::openmldb::type::DataType type, ColumnPredicate::ValueType value_type) {
+    switch (type) {
+        case ::openmldb::type::kSmallInt:
+        case ::openmldb::type::kInt:
+        case ::openmldb::type::kBigInt:
+            return value_type == ColumnPredicate::kIntValue;
+        case ::openmldb::type::kFloat:
+        case ::openmldb::type::kDouble:
+            return value_type == ColumnPredicate::kDoubleValue;
+        case ::openmldb::type::kString:
+        case ::openmldb::type::kVarchar:
+            return value_type == ColumnPredicate::kStringValue;
+        default:
+            return false;
+    }
+}
+
+std::shared_ptr<const RowFilter> RowFilter::Create(
+    const std::map<int32_t, std::shared_ptr<codec::Schema>>& vers_schema,
+    const std::vector<ColumnPredicate>& predicates) {
+    if (vers_schema.empty() || predicates.empty()) {
+        return {};
+    }
+    std::shared_ptr<RowFilter> filter(new RowFilter());
+    // the columns are only appended on schema change, so the latest version has all of them
+    const auto& latest = *vers_schema.rbegin()->second;
+    for (const auto& pred : predicates) {
+        if (pred.col_idx >= static_cast<size_t>(latest.size()) ||
+            !IsCheckable(latest.Get(pred.col_idx).data_type(), pred.value_type)) {
+            continue;
+        }
+        filter->predicates_.push_back(pred);
+    }
+    if (filter->predicates_.empty()) {
+        return {};
+    }
+    filter->columns_.resize(latest.size(), false);
+    for (const auto& pred : filter->predicates_) {
+        filter->columns_[pred.col_idx] = true;
+    }
+    filter->schema_ = vers_schema.rbegin()->second;
+    filter->view_ = std::make_unique<codec::RowView>(*filter->schema_);
+    if (!filter->view_->SetVersions(vers_schema)) {
+        return {};
+    }
+    filter->versions_.resize(vers_schema.rbegin()->first + 1, false);
+    for (const auto& kv : vers_schema) {
+        filter->versions_[kv.first] = true;
+    }
+    return filter;
+}
+
+bool RowFilter::Match(const int8_t* row, uint32_t size) const {
+    if (row == nullptr || size <= codec::HEADER_LENGTH || codec::RowView::GetSize(row) != size) {
+        return true;
+    }
+    uint8_t version = codec::RowView::GetSchemaVersion(row);
+    if (version >= versions_.size() || !versions_[version]) {
+        return true;
+    }
+    for (const auto& pred : predicates_) {
+        if (!MatchOne(row, pred)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RowFilter::MatchOne(const int8_t* row, const ColumnPredicate& pred) const {
+    const auto& view = *view_;
+    uint32_t idx = static_cast<uint32_t>(pred.col_idx);
+    // the column added after the version of the row is null too
+    if (view.IsNULL(row, idx)) {
+        return false;
+    }
+    switch (schema_->Get(idx).data_type()) {
+        case ::openmldb::type::kSmallInt: {
+            int16_t val = 0;
+            return view.GetValue(row, idx, ::openmldb::type::kSmallInt, &val) != 0 ||
+                   pred.value_type != ColumnPredicate::kIntValue ||
+                   Compare<int64_t>(pred.op, val, pred.int_value);
+        }
+        case ::openmldb::type::kInt: {
+            int32_t val = 0;
+            return view.GetValue(row, idx, ::openmldb::type::kInt, &val) != 0 ||
+                   pred.value_type != ColumnPredicate::kIntValue ||
+                   Compare<int64_t>(pred.op, val, pred.int_value);
+        }
+        case ::openmldb::type::kBigInt: {
+            int64_t val = 0;
+            return view.GetValue(row, idx, ::openmldb::type::kBigInt, &val) != 0 ||
+                   pred.value_type != ColumnPredicate::kIntValue ||
+                   Compare<int64_t>(pred.op, val, pred.int_value);
+        }
+        case ::openmldb::type::kFloat: {
+            float val = 0;
+            return view.GetValue(row, idx, ::openmldb::type::kFloat, &val) != 0 ||
+                   pred.value_type != ColumnPredicate::kDoubleValue ||
+                   Compare<double>(pred.op, val, pred.double_value);
+        }
+        case ::openmldb::type::kDouble: {
+            double val = 0;
+            return view.GetValue(row, idx, ::openmldb::type::kDouble, &val) != 0 ||
+                   pred.value_type != ColumnPredicate::kDoubleValue ||
+                   Compare<double>(pred.op, val, pred.double_value);
+        }
+        case ::openmldb::type::kString:
+        case ::openmldb::type::kVarchar: {
+            char* val = nullptr;
+            uint32_t len = 0;
+            return view.GetValue(row, idx, &val, &len) != 0 || pred.value_type != ColumnPredicate::kStringValue ||
+                   Compare<int>(pred.op, CompareString(val, len, pred.str_value), 0);
+        }
+        default:
+            return true;
+    }
+}
+
+}  // namespace storage
+}  // namespace openmldb
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_ROW_FILTER_H_
+#define SRC_STORAGE_ROW_FILTER_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "codec/codec.h"
+#include "vm/catalog.h"
+
+namespace openmldb {
+namespace storage {
+
+// RowFilter checks the column predicates pushed down by the engine on the rows built by RowBuilder, so the
+// rows out of a filter are skipped before they are handed to the engine. The engine evaluates the whole
+// condition on the rows left anyway, so a row is regarded as matched if it can't be checked, e.g. a row of
+// an unknown schema version. Match is thread safe.
+class RowFilter {
+ public:
+    // return nullptr if none of the predicates can be checked on the rows of the schema versions
+    static std::shared_ptr<const RowFilter> Create(const std::map<int32_t, std::shared_ptr<codec::Schema>>& vers_schema,
+                                                   const std::vector<::hybridse::vm::ColumnPredicate>& predicates);
+
+    bool Match(const int8_t* row, uint32_t size) const;
+
+    // the columns read by the predicates
+    const std::vector<bool>& GetColumns() const { return columns_; }
+
+ private:
+    RowFilter() = default;
+
+    bool MatchOne(const int8_t* row, const ::hybridse::vm::ColumnPredicate& pred) const;
+
+    std::vector<::hybridse::vm::ColumnPredicate> predicates_;
+    // the latest schema, the view reads the rows of all the versions by it
+    std::shared_ptr<codec::Schema> schema_;
+    std::unique_ptr<codec::RowView> view_;
+    // indexed by the schema version
+    std::vector<bool> versions_;
+    std::vector<bool> columns_;
+};
+
+// the hints of the engine on what it reads, so the storage may skip the rest
+struct ScanHint {
+    // the rows only need the columns set in it to be valid, the others may be null
+    std::shared_ptr<const std::vector<bool>> columns;
+    // the rows unmatched by it may be skipped
+    std::shared_ptr<const RowFilter> filter;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_ROW_FILTER_H_
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/row_filter.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace storage {
+
+using ::hybridse::vm::ColumnPredicate;
+
+class RowFilterTest : public ::testing::Test {};
+
+static void AddColumn(codec::Schema* schema, const std::string& name, ::openmldb::type::DataType type) {
+    auto* col = schema->Add();
+    col->set_name(name);
+    col->set_data_type(type);
+}
+
+// c0 int, c1 string, c2 double
+static std::shared_ptr<codec::Schema> MakeSchema() {
+    auto schema = std::make_shared<codec::Schema>();
+    AddColumn(schema.get(), "c0", ::openmldb::type::kInt);
+    AddColumn(schema.get(), "c1", ::openmldb::type::kString);
+    AddColumn(schema.get(), "c2", ::openmldb::type::kDouble);
+    return schema;
+}
+
+static std::string BuildRow(const codec::Schema& schema, int32_t val, const std::string* str, double d,
+                            uint8_t version = 1) {
+    codec::RowBuilder builder(schema);
+    builder.SetSchemaVersion(version);
+    uint32_t size = builder.CalTotalLength(str == nullptr ? 0 : str->size());
+    std::string row(size, 0);
+    builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), size);
+    builder.AppendInt32(val);
+    if (str == nullptr) {
+        builder.AppendNULL();
+    } else {
+        builder.AppendString(str->data(), str->size());
+    }
+    builder.AppendDouble(d);
+    return row;
+}
+
+static ColumnPredicate IntPredicate(size_t idx, ColumnPredicate::Op op, int64_t val) {
+    ColumnPredicate pred;
+    pred.col_idx = idx;
+    pred.op = op;
+    pred.value_type = ColumnPredicate::kIntValue;
+    pred.int_value = val;
+    return pred;
+}
+
+static ColumnPredicate StringPredicate(size_t idx, ColumnPredicate::Op op, const std::string& val) {
+    ColumnPredicate pred;
+    pred.col_idx = idx;
+    pred.op = op;
+    pred.value_type = ColumnPredicate::kStringValue;
+    pred.str_value = val;
+    return pred;
+}
+
+static bool Match(const RowFilter& filter, const std::string& row) {
+    return filter.Match(reinterpret_cast<const int8_t*>(row.data()), row.size());
+}
+
+TEST_F(RowFilterTest, Compare) {
+    auto schema = MakeSchema();
+    ColumnPredicate gt_double;
+    gt_double.col_idx = 2;
+    gt_double.op = ColumnPredicate::kGt;
+    gt_double.value_type = ColumnPredicate::kDoubleValue;
+    gt_double.double_value = 1.5;
+    auto filter = RowFilter::Create({{1, schema}}, {IntPredicate(0, ColumnPredicate::kGe, 10),
+                                                    StringPredicate(1, ColumnPredicate::kLt, "abc"), gt_double});
+    ASSERT_TRUE(filter);
+    ASSERT_EQ(std::vector<bool>({true, true, true}), filter->GetColumns());
+
+    std::string ab = "ab";
+    std::string abc = "abc";
+    std::string abcd = "abcd";
+    ASSERT_TRUE(Match(*filter, BuildRow(*schema, 10, &ab, 2.0)));
+    ASSERT_FALSE(Match(*filter, BuildRow(*schema, 9, &ab, 2.0)));
+    ASSERT_FALSE(Match(*filter, BuildRow(*schema, 10, &abc, 2.0)));
+    ASSERT_FALSE(Match(*filter, BuildRow(*schema, 10, &abcd, 2.0)));
+    ASSERT_FALSE(Match(*filter, BuildRow(*schema, 10, &ab, 1.5)));
+    // null never satisfies a comparison
+    ASSERT_FALSE(Match(*filter, BuildRow(*schema, 10, nullptr, 2.0)));
+}
+
+TEST_F(RowFilterTest, Uncheckable) {
+    auto schema = MakeSchema();
+    // an int value on a string column and a column out of the schema are not checked
+    ASSERT_FALSE(RowFilter::Create({{1, schema}}, {IntPredicate(1, ColumnPredicate::kEq, 1),
+                                                   IntPredicate(3, ColumnPredicate::kEq, 1)}));
+    ASSERT_FALSE(RowFilter::Create({{1, schema}}, {}));
+
+    auto filter = RowFilter::Create({{1, schema}}, {IntPredicate(0, ColumnPredicate::kNe, 1),
+                                                    IntPredicate(1, ColumnPredicate::kEq, 1)});
+    ASSERT_TRUE(filter);
+    ASSERT_EQ(std::vector<bool>({true, false, false}), filter->GetColumns());
+    std::string str = "x";
+    ASSERT_TRUE(Match(*filter, BuildRow(*schema, 2, &str, 0)));
+    ASSERT_FALSE(Match(*filter, BuildRow(*schema, 1, &str, 0)));
+    // the rows of an unknown version and the invalid rows are regarded as matched
+    ASSERT_TRUE(Match(*filter, BuildRow(*schema, 1, &str, 0, 2)));
+    std::string row = BuildRow(*schema, 1, &str, 0);
+    ASSERT_TRUE(filter->Match(reinterpret_cast<const int8_t*>(row.data()), row.size() - 1));
+}
+
+TEST_F(RowFilterTest, SchemaVersion) {
+    auto schema = MakeSchema();
+    auto schema_v2 = std::make_shared<codec::Schema>(*schema);
+    AddColumn(schema_v2.get(), "c3", ::openmldb::type::kBigInt);
+    auto filter = RowFilter::Create({{1, schema}, {2, schema_v2}}, {IntPredicate(3, ColumnPredicate::kEq, 5)});
+    ASSERT_TRUE(filter);
+    std::string str = "x";
+    // the column is not in the rows of version 1, so it is null
+    ASSERT_FALSE(Match(*filter, BuildRow(*schema, 1, &str, 0)));
+
+    codec::RowBuilder builder(*schema_v2);
+    builder.SetSchemaVersion(2);
+    for (int64_t val : {5, 6}) {
+        uint32_t size = builder.CalTotalLength(0);
+        std::string row(size, 0);
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), size);
+        builder.AppendInt32(1);
+        builder.AppendNULL();
+        builder.AppendDouble(0);
+        builder.AppendInt64(val);
+        ASSERT_EQ(val == 5, Match(*filter, row));
+    }
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
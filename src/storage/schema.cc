@@ -129,6 +129,18 @@ uint32_t InnerIndexSt::GetKeyEntryMaxHeight(uint32_t abs_max_height, uint32_t la
     return max_height;
 }
 
+uint64_t InnerIndexSt::GetLatestOnlyTTL() const {
+    uint64_t lat_ttl = 0;
+    for (const auto& cur_index : index_) {
+        auto ttl = cur_index->GetTTL();
+        if (!ttl || ttl->ttl_type != ::openmldb::storage::TTLType::kLatestTime || ttl->lat_ttl == 0) {
+            return 0;
+        }
+        lat_ttl = std::max(lat_ttl, ttl->lat_ttl);
+    }
+    return lat_ttl;
+}
+
 bool ColumnDefSortFunc(const ColumnDef& cd_a, const ColumnDef& cd_b) { return (cd_a.GetId() < cd_b.GetId()); }
 
 TableIndex::TableIndex() {
@@ -483,6 +495,7 @@ TableSt::TableSt(const ::openmldb::nameserver::TableInfo& table_info)
       db_(table_info.db()),
       tid_(table_info.tid()),
       pid_num_(table_info.table_partition_size()),
+      router_(std::make_shared<base::PartitionRouter>(pid_num_, table_info.partition_split())),
       column_desc_(table_info.column_desc()),
       column_key_(table_info.column_key()) {
     partitions_ = std::make_shared<std::vector<PartitionSt>>();
@@ -500,6 +513,7 @@ TableSt::TableSt(const ::openmldb::api::TableMeta& meta)
       db_(meta.db()),
       tid_(meta.tid()),
       pid_num_(meta.table_partition_size()),
+      router_(std::make_shared<base::PartitionRouter>(pid_num_)),
       column_desc_(meta.column_desc()),
       column_key_(meta.column_key()) {
     partitions_ = std::make_shared<std::vector<PartitionSt>>();
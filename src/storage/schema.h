@@ -24,6 +24,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "base/partition_router.h"
 #include "proto/name_server.pb.h"
 #include "proto/tablet.pb.h"
 #include "proto/type.pb.h"
@@ -233,6 +234,8 @@ class InnerIndexSt {
     inline const std::vector<uint32_t>& GetTsIdx() const { return ts_; }
     inline const std::vector<std::shared_ptr<IndexDef>>& GetIndex() const { return index_; }
     uint32_t GetKeyEntryMaxHeight(uint32_t abs_max_height, uint32_t lat_max_height) const;
+    // return the max lat_ttl if all indexes are latest-only, otherwise return 0
+    uint64_t GetLatestOnlyTTL() const;
 
  private:
     const uint32_t id_;
@@ -295,7 +298,8 @@ class PartitionSt {
 
 class TableSt {
  public:
-    TableSt() : name_(), db_(), tid_(0), pid_num_(0), partitions_() {}
+    TableSt()
+        : name_(), db_(), tid_(0), pid_num_(0), router_(std::make_shared<base::PartitionRouter>(0)), partitions_() {}
 
     explicit TableSt(const ::openmldb::nameserver::TableInfo& table_info);
 
@@ -323,6 +327,11 @@ class TableSt {
 
     inline uint32_t GetPartitionNum() const { return pid_num_; }
 
+    // the partition of the key by the splits of the table
+    inline uint32_t GetPid(const std::string& key) const { return router_->GetPid(key); }
+
+    inline const std::shared_ptr<const base::PartitionRouter>& GetRouter() const { return router_; }
+
     inline const ::google::protobuf::RepeatedPtrField<::openmldb::common::ColumnDesc>& GetColumns() const {
         return column_desc_;
     }
@@ -336,6 +345,7 @@ class TableSt {
     std::string db_;
     uint32_t tid_;
     uint32_t pid_num_;
+    std::shared_ptr<const base::PartitionRouter> router_;
     ::google::protobuf::RepeatedPtrField<::openmldb::common::ColumnDesc> column_desc_;
     ::google::protobuf::RepeatedPtrField<::openmldb::common::ColumnKey> column_key_;
     std::shared_ptr<std::vector<PartitionSt>> partitions_;
@@ -16,37 +16,95 @@
 
 #include "storage/segment.h"
 
+#include <algorithm>
+#include <memory>
+
 #include <gflags/gflags.h>
 
 #include "base/glog_wapper.h"
 #include "base/strings.h"
 #include "common/timer.h"
+#include "storage/epoch.h"
 #include "storage/record.h"
 
 DECLARE_int32(gc_safe_offset);
 DECLARE_uint32(skiplist_max_height);
 DECLARE_uint32(gc_deleted_pk_version_delta);
+DECLARE_uint32(segment_key_lock_cnt);
+DECLARE_bool(gc_enable_epoch_reclaim);
+DECLARE_uint32(count_bucket_width);
 
 namespace openmldb {
 namespace storage {
 
 static const SliceComparator scmp;
+void CountBuckets::Add(uint64_t ts, uint64_t cnt) {
+    uint64_t start = ts - ts % width_;
+    // the rows are mostly put in time order
+    if (buckets_.empty() || buckets_.back().first < start) {
+        buckets_.emplace_back(start, cnt);
+        return;
+    }
+    if (buckets_.back().first == start) {
+        buckets_.back().second += cnt;
+        return;
+    }
+    auto it = std::lower_bound(buckets_.begin(), buckets_.end(), std::make_pair(start, static_cast<uint64_t>(0)));
+    if (it != buckets_.end() && it->first == start) {
+        it->second += cnt;
+    } else {
+        buckets_.emplace(it, start, cnt);
+    }
+}
+
+void CountBuckets::RemoveOldest(uint64_t cnt) {
+    auto it = buckets_.begin();
+    for (; it != buckets_.end() && cnt > 0; ++it) {
+        if (it->second > cnt) {
+            it->second -= cnt;
+            break;
+        }
+        cnt -= it->second;
+    }
+    buckets_.erase(buckets_.begin(), it);
+}
+
+uint64_t CountBuckets::CountAfterBucket(uint64_t ts) const {
+    uint64_t start = ts - ts % width_;
+    uint64_t cnt = 0;
+    for (auto it = buckets_.rbegin(); it != buckets_.rend() && it->first > start; ++it) {
+        cnt += it->second;
+    }
+    return cnt;
+}
+
 Segment::Segment()
     : entries_(NULL),
+      key_index_(NULL),
       mu_(),
       idx_cnt_(0),
       idx_byte_size_(0),
       pk_cnt_(0),
       ts_cnt_(1),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      block_pool_(NULL),
+      latest_capacity_(0),
+      key_mu_cnt_(std::max(FLAGS_segment_key_lock_cnt, 1u)),
+      key_mu_(new KeyMutex[key_mu_cnt_]),
+      gc_cursor_(),
+      gc_deadline_(0),
+      gc_slice_key_cnt_(0),
+      use_epoch_(FLAGS_gc_enable_epoch_reclaim),
+      count_bucket_width_(FLAGS_count_bucket_width) {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
-    key_entry_max_height_ = (uint8_t)FLAGS_skiplist_max_height;
+    key_entry_max_height_.store((uint8_t)FLAGS_skiplist_max_height, std::memory_order_relaxed);
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
 }
 
 Segment::Segment(uint8_t height)
     : entries_(NULL),
+      key_index_(NULL),
       mu_(),
       idx_cnt_(0),
       idx_byte_size_(0),
@@ -54,13 +112,23 @@ Segment::Segment(uint8_t height)
       key_entry_max_height_(height),
       ts_cnt_(1),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      block_pool_(NULL),
+      latest_capacity_(0),
+      key_mu_cnt_(std::max(FLAGS_segment_key_lock_cnt, 1u)),
+      key_mu_(new KeyMutex[key_mu_cnt_]),
+      gc_cursor_(),
+      gc_deadline_(0),
+      gc_slice_key_cnt_(0),
+      use_epoch_(FLAGS_gc_enable_epoch_reclaim),
+      count_bucket_width_(FLAGS_count_bucket_width) {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
 }
 
 Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec)
     : entries_(NULL),
+      key_index_(NULL),
       mu_(),
       idx_cnt_(0),
       idx_byte_size_(0),
@@ -68,7 +136,16 @@ Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec)
       key_entry_max_height_(height),
       ts_cnt_(ts_idx_vec.size()),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      block_pool_(NULL),
+      latest_capacity_(0),
+      key_mu_cnt_(std::max(FLAGS_segment_key_lock_cnt, 1u)),
+      key_mu_(new KeyMutex[key_mu_cnt_]),
+      gc_cursor_(),
+      gc_deadline_(0),
+      gc_slice_key_cnt_(0),
+      use_epoch_(FLAGS_gc_enable_epoch_reclaim),
+      count_bucket_width_(FLAGS_count_bucket_width) {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
     for (uint32_t i = 0; i < ts_idx_vec.size(); i++) {
@@ -78,33 +155,48 @@ Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec)
 }
 
 Segment::~Segment() {
+    delete key_index_;
     delete entries_;
     delete entry_free_list_;
 }
 
-uint64_t Segment::Release() {
+uint64_t Segment::Release() { return Release(0, nullptr, true); }
+
+uint64_t Segment::Release(uint32_t yield_key_cnt, const std::function<void()>& yield, bool free_pooled) {
     uint64_t cnt = 0;
+    uint64_t key_cnt = 0;
+    DataBlockPool* pool = free_pooled ? block_pool_ : NULL;
     KeyEntries::Iterator* it = entries_->NewIterator();
     it->SeekToFirst();
     while (it->Valid()) {
         delete[] it->GetKey().data();
         if (it->GetValue() != NULL) {
-            if (ts_cnt_ > 1) {
+            if (latest_capacity_ > 0) {
+                LatestKeyEntry* entry = (LatestKeyEntry*)it->GetValue();  // NOLINT
+                cnt += entry->Release(pool);
+                delete entry;
+            } else if (ts_cnt_ > 1) {
                 KeyEntry** entry_arr = (KeyEntry**)it->GetValue();  // NOLINT
                 for (uint32_t i = 0; i < ts_cnt_; i++) {
-                    cnt += entry_arr[i]->Release();
+                    cnt += entry_arr[i]->Release(pool);
                     delete entry_arr[i];
                 }
                 delete[] entry_arr;
             } else {
                 KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
-                cnt += entry->Release();
+                cnt += entry->Release(pool);
                 delete entry;
             }
         }
         it->Next();
+        if (yield && yield_key_cnt > 0 && ++key_cnt % yield_key_cnt == 0) {
+            yield();
+        }
     }
     entries_->Clear();
+    if (key_index_ != NULL) {
+        key_index_->Clear();
+    }
     delete it;
 
     KeyEntryNodeList::Iterator* f_it = entry_free_list_->NewIterator();
@@ -112,24 +204,38 @@ uint64_t Segment::Release() {
     while (f_it->Valid()) {
         ::openmldb::base::Node<Slice, void*>* node = f_it->GetValue();
         delete[] node->GetKey().data();
-        if (ts_cnt_ > 1) {
+        if (latest_capacity_ > 0) {
+            LatestKeyEntry* entry = (LatestKeyEntry*)node->GetValue();  // NOLINT
+            entry->Release(pool);
+            delete entry;
+        } else if (ts_cnt_ > 1) {
             KeyEntry** entry_arr = (KeyEntry**)node->GetValue();  // NOLINT
             for (uint32_t i = 0; i < ts_cnt_; i++) {
-                entry_arr[i]->Release();
+                entry_arr[i]->Release(pool);
                 delete entry_arr[i];
             }
             delete[] entry_arr;
         } else {
             KeyEntry* entry = (KeyEntry*)node->GetValue();  // NOLINT
-            entry->Release();
+            entry->Release(pool);
             delete entry;
         }
         delete node;
         f_it->Next();
+        if (yield && yield_key_cnt > 0 && ++key_cnt % yield_key_cnt == 0) {
+            yield();
+        }
     }
     delete f_it;
     entry_free_list_->Clear();
     idx_cnt_vec_.clear();
+    {
+        std::lock_guard<std::mutex> lock(gc_mu_);
+        for (const auto& cold_data : cold_free_list_) {
+            FreeColdData(cold_data, pool);
+        }
+        cold_free_list_.clear();
+    }
     return cnt;
 }
 
@@ -140,8 +246,9 @@ void Segment::ReleaseAndCount(uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt, uin
         Slice key = it->GetKey();
         ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
         {
+            std::lock_guard<::openmldb::base::SpinMutex> key_lock(GetKeyMutex(key));
             std::lock_guard<std::mutex> lock(mu_);
-            entry_node = entries_->Remove(key);
+            entry_node = RemoveEntry(key);
         }
         if (entry_node != NULL) {
             FreeEntry(entry_node, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
@@ -150,8 +257,7 @@ void Segment::ReleaseAndCount(uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt, uin
         pk_cnt_.fetch_sub(1, std::memory_order_relaxed);
     }
     delete it;
-    uint64_t cur_version = gc_version_.load(std::memory_order_relaxed);
-    GcEntryFreeList(cur_version, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    GcEntryFreeList(GetFreeListVersion(), gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
     Release();
 }
 
@@ -159,7 +265,7 @@ void Segment::Put(const Slice& key, uint64_t time, const char* data, uint32_t si
     if (ts_cnt_ > 1) {
         return;
     }
-    auto* db = new DataBlock(1, data, size);
+    auto* db = new DataBlock(1, data, size, block_pool_);
     Put(key, time, db);
 }
 
@@ -167,60 +273,118 @@ void Segment::Put(const Slice& key, uint64_t time, DataBlock* row) {
     if (ts_cnt_ > 1) {
         return;
     }
+    uint32_t byte_size = 0;
+    std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
+    void* entry = GetOrCreateEntry(key, &byte_size);
+    idx_cnt_.fetch_add(1, std::memory_order_relaxed);
+    if (latest_capacity_ > 0) {
+        ((LatestKeyEntry*)entry)->entries.Insert(time, row);                          // NOLINT
+        ((LatestKeyEntry*)entry)->count_.fetch_add(1, std::memory_order_relaxed);    // NOLINT
+        byte_size += GetRecordLatestIdxSize();
+    } else {
+        KeyEntry* key_entry = (KeyEntry*)entry;  // NOLINT
+        uint8_t height = key_entry->entries.Insert(time, row);
+        key_entry->count_.fetch_add(1, std::memory_order_relaxed);
+        if (key_entry->buckets_ != NULL) {
+            key_entry->buckets_->Add(time);
+        }
+        byte_size += GetRecordTsIdxSize(height);
+    }
+    idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
+}
+
+void* Segment::GetOrCreateEntry(const Slice& key, uint32_t* byte_size) {
+    void* entry = NULL;
+    if (GetEntry(key, entry) == 0 && entry != NULL) {
+        return entry;
+    }
+    // the caller holds the lock of key, so no one else can create it concurrently
+    char* pk = new char[key.size()];
+    memcpy(pk, key.data(), key.size());
+    // need to delete memory when free node
+    Slice skey(pk, key.size());
     std::lock_guard<std::mutex> lock(mu_);
-    PutUnlock(key, time, row);
+    uint8_t key_entry_height = GetKeyEntryMaxHeight();
+    if (latest_capacity_ > 0) {
+        entry = (void*)new LatestKeyEntry(latest_capacity_);  // NOLINT
+        uint8_t height = entries_->Insert(skey, entry);
+        *byte_size += GetRecordPkLatestIdxSize(height, key.size());
+    } else if (ts_cnt_ > 1) {
+        KeyEntry** entry_arr = new KeyEntry*[ts_cnt_];
+        for (uint32_t i = 0; i < ts_cnt_; i++) {
+            entry_arr[i] = new KeyEntry(key_entry_height, count_bucket_width_);
+        }
+        entry = (void*)entry_arr;  // NOLINT
+        uint8_t height = entries_->Insert(skey, entry);
+        *byte_size += GetRecordPkMultiIdxSize(height, key.size(), key_entry_height, ts_cnt_);
+    } else {
+        entry = (void*)new KeyEntry(key_entry_height, count_bucket_width_);  // NOLINT
+        uint8_t height = entries_->Insert(skey, entry);
+        *byte_size += GetRecordPkIdxSize(height, key.size(), key_entry_height);
+    }
+    if (key_index_ != NULL) {
+        key_index_->Insert(skey, entry, GetFreeListVersion());
+    }
+    pk_cnt_.fetch_add(1, std::memory_order_relaxed);
+    return entry;
 }
 
-void Segment::PutUnlock(const Slice& key, uint64_t time, DataBlock* row) {
-    void* entry = nullptr;
+void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row) {
+    if (ts_cnt_ == 1) {
+        Put(key, time, row);
+        return;
+    }
+    if (key_entry_id >= ts_cnt_) {
+        return;
+    }
     uint32_t byte_size = 0;
-    int ret = entries_->Get(key, entry);
-    if (ret < 0 || entry == NULL) {
-        char* pk = new char[key.size()];
-        memcpy(pk, key.data(), key.size());
-        // need to delete memory when free node
-        Slice skey(pk, key.size());
-        entry = (void*)new KeyEntry(key_entry_max_height_);  // NOLINT
-        uint8_t height = entries_->Insert(skey, entry);
-        byte_size += GetRecordPkIdxSize(height, key.size(), key_entry_max_height_);
-        pk_cnt_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
+    KeyEntry** entry_arr = (KeyEntry**)GetOrCreateEntry(key, &byte_size);  // NOLINT
+    uint8_t height = entry_arr[key_entry_id]->entries.Insert(time, row);
+    entry_arr[key_entry_id]->count_.fetch_add(1, std::memory_order_relaxed);
+    if (entry_arr[key_entry_id]->buckets_ != NULL) {
+        entry_arr[key_entry_id]->buckets_->Add(time);
     }
-    idx_cnt_.fetch_add(1, std::memory_order_relaxed);
-    uint8_t height = ((KeyEntry*)entry)->entries.Insert(time, row);  // NOLINT
-    ((KeyEntry*)entry)                                               // NOLINT
-        ->count_.fetch_add(1, std::memory_order_relaxed);
     byte_size += GetRecordTsIdxSize(height);
     idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
+    idx_cnt_vec_[key_entry_id]->fetch_add(1, std::memory_order_relaxed);
 }
 
-void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row) {
-    void* key_entry_or_list = nullptr;
+void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key,
+                          const std::vector<std::pair<uint64_t, DataBlock*>>& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    if (latest_capacity_ > 0) {
+        for (const auto& row : rows) {
+            Put(key, row.first, row.second);
+        }
+        return;
+    }
+    if (ts_cnt_ > 1 && key_entry_id >= ts_cnt_) {
+        return;
+    }
     uint32_t byte_size = 0;
-    std::lock_guard<std::mutex> lock(mu_);  // TODO(hw): need lock?
-    int ret = entries_->Get(key, key_entry_or_list);
-    if (ts_cnt_ == 1) {
-        PutUnlock(key, time, row);
-    } else {
-        if (ret < 0 || key_entry_or_list == nullptr) {
-            char* pk = new char[key.size()];
-            memcpy(pk, key.data(), key.size());
-            Slice skey(pk, key.size());
-            auto** entry_arr_tmp = new KeyEntry*[ts_cnt_];
-            for (uint32_t i = 0; i < ts_cnt_; i++) {
-                entry_arr_tmp[i] = new KeyEntry(key_entry_max_height_);
-            }
-            auto entry_arr = (void*)entry_arr_tmp;  // NOLINT
-            uint8_t height = entries_->Insert(skey, entry_arr);
-            byte_size += GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
-            pk_cnt_.fetch_add(1, std::memory_order_relaxed);
-        }
-        uint8_t height = ((KeyEntry**)key_entry_or_list)[key_entry_id]->entries.Insert(  // NOLINT
-            time, row);
-        ((KeyEntry**)key_entry_or_list)[key_entry_id]->count_.fetch_add(  // NOLINT
-            1, std::memory_order_relaxed);
+    std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
+    void* entry = GetOrCreateEntry(key, &byte_size);
+    KeyEntry* key_entry = ts_cnt_ > 1 ? ((KeyEntry**)entry)[key_entry_id] : (KeyEntry*)entry;  // NOLINT
+    for (const auto& row : rows) {
+        DataBlock* block = row.second;
+        uint8_t height = key_entry->entries.PushFront(row.first, block);
+        if (height == 0) {
+            height = key_entry->entries.Insert(row.first, block);
+        }
         byte_size += GetRecordTsIdxSize(height);
-        idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
-        idx_cnt_vec_[key_entry_id]->fetch_add(1, std::memory_order_relaxed);
+        if (key_entry->buckets_ != NULL) {
+            key_entry->buckets_->Add(row.first);
+        }
+    }
+    key_entry->count_.fetch_add(rows.size(), std::memory_order_relaxed);
+    idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
+    if (ts_cnt_ > 1) {
+        idx_cnt_vec_[key_entry_id]->fetch_add(rows.size(), std::memory_order_relaxed);
+    } else {
+        idx_cnt_.fetch_add(rows.size(), std::memory_order_relaxed);
     }
 }
 
@@ -237,7 +401,7 @@ void Segment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, D
         return;
     }
     void* entry_arr = NULL;
-    std::lock_guard<std::mutex> lock(mu_);
+    std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
     for (const auto& kv : ts_map) {
         uint32_t byte_size = 0;
         auto pos = ts_idx_map_.find(kv.first);
@@ -245,25 +409,14 @@ void Segment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, D
             continue;
         }
         if (entry_arr == NULL) {
-            int ret = entries_->Get(key, entry_arr);
-            if (ret < 0 || entry_arr == NULL) {
-                char* pk = new char[key.size()];
-                memcpy(pk, key.data(), key.size());
-                Slice skey(pk, key.size());
-                KeyEntry** entry_arr_tmp = new KeyEntry*[ts_cnt_];
-                for (uint32_t i = 0; i < ts_cnt_; i++) {
-                    entry_arr_tmp[i] = new KeyEntry(key_entry_max_height_);
-                }
-                entry_arr = (void*)entry_arr_tmp;  // NOLINT
-                uint8_t height = entries_->Insert(skey, entry_arr);
-                byte_size += GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
-                pk_cnt_.fetch_add(1, std::memory_order_relaxed);
-            }
+            entry_arr = GetOrCreateEntry(key, &byte_size);
+        }
+        KeyEntry* key_entry = ((KeyEntry**)entry_arr)[pos->second];  // NOLINT
+        uint8_t height = key_entry->entries.Insert(kv.second, row);
+        key_entry->count_.fetch_add(1, std::memory_order_relaxed);
+        if (key_entry->buckets_ != NULL) {
+            key_entry->buckets_->Add(kv.second);
         }
-        uint8_t height = ((KeyEntry**)entry_arr)[pos->second]->entries.Insert(  // NOLINT
-            kv.second, row);
-        ((KeyEntry**)entry_arr)[pos->second]->count_.fetch_add(  // NOLINT
-            1, std::memory_order_relaxed);
         byte_size += GetRecordTsIdxSize(height);
         idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
         idx_cnt_vec_[pos->second]->fetch_add(1, std::memory_order_relaxed);
@@ -274,10 +427,15 @@ bool Segment::Get(const Slice& key, const uint64_t time, DataBlock** block) {
     if (block == NULL || ts_cnt_ > 1) {
         return false;
     }
+    EpochGuard guard;
     void* entry = NULL;
-    if (entries_->Get(key, entry) < 0 || entry == NULL) {
+    if (GetEntry(key, entry) < 0 || entry == NULL) {
         return false;
     }
+    if (latest_capacity_ > 0) {
+        *block = ((LatestKeyEntry*)entry)->entries.Get(time);  // NOLINT
+        return true;
+    }
     *block = ((KeyEntry*)entry)->entries.Get(time);  // NOLINT
     return true;
 }
@@ -293,26 +451,36 @@ bool Segment::Get(const Slice& key, uint32_t idx, const uint64_t time, DataBlock
     if (ts_cnt_ == 1) {
         return Get(key, time, block);
     }
+    EpochGuard guard;
     void* entry = NULL;
-    if (entries_->Get(key, entry) < 0 || entry == NULL) {
+    if (GetEntry(key, entry) < 0 || entry == NULL) {
         return false;
     }
     *block = ((KeyEntry**)entry)[pos->second]->entries.Get(time);  // NOLINT
     return true;
 }
 
+::openmldb::base::Node<Slice, void*>* Segment::RemoveEntry(const Slice& key) {
+    ::openmldb::base::Node<Slice, void*>* entry_node = entries_->Remove(key);
+    if (entry_node != NULL && key_index_ != NULL) {
+        key_index_->Remove(key, GetFreeListVersion());
+    }
+    return entry_node;
+}
+
 bool Segment::Delete(const Slice& key) {
     ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
     {
+        std::lock_guard<::openmldb::base::SpinMutex> key_lock(GetKeyMutex(key));
         std::lock_guard<std::mutex> lock(mu_);
-        entry_node = entries_->Remove(key);
+        entry_node = RemoveEntry(key);
         if (entry_node == NULL) {
             return false;
         }
     }
     {
         std::lock_guard<std::mutex> lock(gc_mu_);
-        entry_free_list_->Insert(gc_version_.load(std::memory_order_relaxed), entry_node);
+        entry_free_list_->Insert(GetFreeListVersion(), entry_node);
     }
     return true;
 }
@@ -330,13 +498,29 @@ void Segment::FreeList(::openmldb::base::Node<uint64_t, DataBlock*>* node, uint6
         } else {
             DEBUGLOG("delele data block for key %lu", tmp->GetKey());
             gc_record_byte_size += GetRecordSize(tmp->GetValue()->size);
-            delete tmp->GetValue();
+            DeleteDataBlock(tmp->GetValue(), block_pool_);
             gc_record_cnt++;
         }
         delete tmp;
     }
 }
 
+void Segment::FreeRows(const std::vector<LatestEntries::Entry>& rows, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,
+                       uint64_t& gc_record_byte_size) {
+    for (const auto& row : rows) {
+        gc_idx_cnt++;
+        idx_byte_size_.fetch_sub(GetRecordLatestIdxSize(), std::memory_order_relaxed);
+        DataBlock* block = row.second;
+        if (block->dim_cnt_down > 1) {
+            block->dim_cnt_down--;
+        } else {
+            gc_record_byte_size += GetRecordSize(block->size);
+            DeleteDataBlock(block, block_pool_);
+            gc_record_cnt++;
+        }
+    }
+}
+
 void Segment::FreeEntry(::openmldb::base::Node<Slice, void*>* entry_node, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,
                         uint64_t& gc_record_byte_size) {
     if (entry_node == NULL) {
@@ -346,6 +530,8 @@ void Segment::FreeEntry(::openmldb::base::Node<Slice, void*>* entry_node, uint64
     delete[] entry_node->GetKey().data();
     if (ts_cnt_ > 1) {
         KeyEntry** entry_arr = (KeyEntry**)entry_node->GetValue();  // NOLINT
+        // the height limit may be changed after the key is created
+        uint8_t key_entry_height = entry_arr[0]->entries.GetHeightLimit();
         for (uint32_t i = 0; i < ts_cnt_; i++) {
             uint64_t old = gc_idx_cnt;
             KeyEntry* entry = entry_arr[i];
@@ -362,11 +548,22 @@ void Segment::FreeEntry(::openmldb::base::Node<Slice, void*>* entry_node, uint64
         }
         delete[] entry_arr;
         uint64_t byte_size =
-            GetRecordPkMultiIdxSize(entry_node->Height(), entry_node->GetKey().size(), key_entry_max_height_, ts_cnt_);
+            GetRecordPkMultiIdxSize(entry_node->Height(), entry_node->GetKey().size(), key_entry_height, ts_cnt_);
         idx_byte_size_.fetch_sub(byte_size, std::memory_order_relaxed);
+    } else if (latest_capacity_ > 0) {
+        uint64_t old = gc_idx_cnt;
+        LatestKeyEntry* entry = (LatestKeyEntry*)entry_node->GetValue();  // NOLINT
+        std::vector<LatestEntries::Entry> rows;
+        entry->entries.Clear(&rows);
+        FreeRows(rows, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        delete entry;
+        uint64_t byte_size = GetRecordPkLatestIdxSize(entry_node->Height(), entry_node->GetKey().size());
+        idx_byte_size_.fetch_sub(byte_size, std::memory_order_relaxed);
+        idx_cnt_.fetch_sub(gc_idx_cnt - old, std::memory_order_relaxed);
     } else {
         uint64_t old = gc_idx_cnt;
         KeyEntry* entry = (KeyEntry*)entry_node->GetValue();  // NOLINT
+        uint8_t key_entry_height = entry->entries.GetHeightLimit();
         TimeEntries::Iterator* it = entry->entries.NewIterator();
         it->SeekToFirst();
         if (it->Valid()) {
@@ -376,8 +573,7 @@ void Segment::FreeEntry(::openmldb::base::Node<Slice, void*>* entry_node, uint64
         }
         delete it;
         delete entry;
-        uint64_t byte_size =
-            GetRecordPkIdxSize(entry_node->Height(), entry_node->GetKey().size(), key_entry_max_height_);
+        uint64_t byte_size = GetRecordPkIdxSize(entry_node->Height(), entry_node->GetKey().size(), key_entry_height);
         idx_byte_size_.fetch_sub(byte_size, std::memory_order_relaxed);
         idx_cnt_.fetch_sub(gc_idx_cnt - old, std::memory_order_relaxed);
     }
@@ -390,6 +586,9 @@ void Segment::GcEntryFreeList(uint64_t version, uint64_t& gc_idx_cnt, uint64_t&
         std::lock_guard<std::mutex> lock(gc_mu_);
         node = entry_free_list_->Split(version);
     }
+    if (key_index_ != NULL) {
+        key_index_->Gc(version);
+    }
     while (node != NULL) {
         ::openmldb::base::Node<Slice, void*>* entry_node = node->GetValue();
         FreeEntry(entry_node, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
@@ -401,13 +600,114 @@ void Segment::GcEntryFreeList(uint64_t version, uint64_t& gc_idx_cnt, uint64_t&
     }
 }
 
+uint64_t Segment::GetFreeListVersion() const {
+    return use_epoch_ ? Epoch::Current() : gc_version_.load(std::memory_order_relaxed);
+}
+
 void Segment::GcFreeList(uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt, uint64_t& gc_record_byte_size) {
+    if (use_epoch_) {
+        // advance twice, so the entries removed before this call can be freed at once
+        // if no reader pins them
+        Epoch::TryAdvance();
+        Epoch::TryAdvance();
+        uint64_t reclaimable = Epoch::GetReclaimable();
+        GcEntryFreeList(reclaimable, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        GcColdFreeList(reclaimable);
+        return;
+    }
     uint64_t cur_version = gc_version_.load(std::memory_order_relaxed);
     if (cur_version < FLAGS_gc_deleted_pk_version_delta) {
         return;
     }
     uint64_t free_list_version = cur_version - FLAGS_gc_deleted_pk_version_delta;
     GcEntryFreeList(free_list_version, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    GcColdFreeList(free_list_version);
+}
+
+void Segment::FreeColdData(const ColdFreeData& cold_data, DataBlockPool* pool) {
+    if (cold_data.pooled) {
+        if (pool != NULL) {
+            pool->Free(cold_data.data, cold_data.size);
+        }
+    } else if (!cold_data.referred) {
+        delete[] cold_data.data;
+    }
+}
+
+void Segment::GcColdFreeList(uint64_t version) {
+    std::deque<ColdFreeData> free_list;
+    {
+        std::lock_guard<std::mutex> lock(gc_mu_);
+        // the versions are pushed in asc order
+        while (!cold_free_list_.empty() && cold_free_list_.front().version <= version) {
+            free_list.push_back(cold_free_list_.front());
+            cold_free_list_.pop_front();
+        }
+    }
+    for (const auto& cold_data : free_list) {
+        FreeColdData(cold_data, block_pool_);
+    }
+}
+
+void Segment::CompressColdRows(uint64_t cold_time, const codec::ColdRowCodec& codec, uint64_t* row_cnt,
+                               uint64_t* saved_byte_size) {
+    // the rows of the latest entries are copied out by the readers, which is left as it is
+    if (latest_capacity_ > 0 || cold_time <= cold_time_) {
+        return;
+    }
+    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        for (uint32_t ts_pos = 0; ts_pos < ts_cnt_; ts_pos++) {
+            Ticket ticket;
+            std::unique_ptr<TimeEntryIterator> time_it(NewTimeEntryIterator(it->GetValue(), ts_pos, ticket));
+            for (time_it->Seek(cold_time); time_it->Valid() && time_it->GetKey() > cold_time_; time_it->Next()) {
+                DataBlock* block = time_it->GetValue();
+                // only gc replaces the data, so it is read without the atomic load
+                char* data = block->data;
+                // a row of several indexes is compressed by the first segment visiting it
+                if (IsColdData(data)) {
+                    continue;
+                }
+                uint32_t cold_size = 0;
+                char* cold = codec.Encode(data, block->size, &cold_size);
+                if (cold == nullptr) {
+                    continue;
+                }
+                ColdFreeData cold_data{GetFreeListVersion(), data, block->size, block->pooled, block->referred};
+                __atomic_store_n(&block->data, TagColdData(cold), __ATOMIC_RELEASE);
+                block->pooled = false;
+                block->referred = false;
+                {
+                    std::lock_guard<std::mutex> lock(gc_mu_);
+                    cold_free_list_.push_back(cold_data);
+                }
+                (*row_cnt)++;
+                *saved_byte_size += block->size - cold_size;
+            }
+        }
+    }
+    cold_time_ = cold_time;
+}
+
+void Segment::SampleColdRows(uint64_t cold_time, uint32_t max_size, std::string* samples) {
+    if (latest_capacity_ > 0) {
+        return;
+    }
+    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
+    for (it->SeekToFirst(); it->Valid() && samples->size() < max_size; it->Next()) {
+        Ticket ticket;
+        std::unique_ptr<TimeEntryIterator> time_it(NewTimeEntryIterator(it->GetValue(), 0, ticket));
+        // a few rows of every key, so the samples cover more keys
+        uint32_t cnt = 0;
+        for (time_it->Seek(cold_time); time_it->Valid() && cnt < 4 && samples->size() < max_size;
+             time_it->Next(), cnt++) {
+            const DataBlock* block = time_it->GetValue();
+            if (IsColdData(block->data)) {
+                continue;
+            }
+            samples->append(block->data, block->size);
+        }
+    }
 }
 
 void Segment::ExecuteGc(const TTLSt& ttl_st, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,
@@ -474,20 +774,64 @@ void Segment::ExecuteGc(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
     GcAllType(ttl_st_map, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
 }
 
+bool Segment::ExecuteGcSlice(const TTLSt& ttl_st, uint64_t budget_us, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,
+                             uint64_t& gc_record_byte_size) {
+    gc_deadline_ = budget_us == 0 ? 0 : ::baidu::common::timer::get_micros() + budget_us;
+    ExecuteGc(ttl_st, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    gc_deadline_ = 0;
+    return gc_cursor_.empty();
+}
+
+bool Segment::ExecuteGcSlice(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t budget_us, uint64_t& gc_idx_cnt,
+                             uint64_t& gc_record_cnt, uint64_t& gc_record_byte_size) {
+    gc_deadline_ = budget_us == 0 ? 0 : ::baidu::common::timer::get_micros() + budget_us;
+    ExecuteGc(ttl_st_map, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    gc_deadline_ = 0;
+    return gc_cursor_.empty();
+}
+
+KeyEntries::Iterator* Segment::NewGcIterator() {
+    KeyEntries::Iterator* it = entries_->NewIterator();
+    if (gc_cursor_.empty()) {
+        it->SeekToFirst();
+    } else {
+        // the key at cursor may be deleted, seek to the first key after it
+        it->Seek(Slice(gc_cursor_));
+    }
+    gc_slice_key_cnt_ = 0;
+    return it;
+}
+
+bool Segment::IsGcSliceEnd(KeyEntries::Iterator* it) {
+    if (!it->Valid()) {
+        gc_cursor_.clear();
+        return true;
+    }
+    if (gc_deadline_ > 0 && ++gc_slice_key_cnt_ % GC_SLICE_CHECK_KEY_CNT == 0 &&
+        ::baidu::common::timer::get_micros() >= gc_deadline_) {
+        gc_cursor_.assign(it->GetKey().data(), it->GetKey().size());
+        return true;
+    }
+    return false;
+}
+
 void Segment::Gc4Head(uint64_t keep_cnt, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt, uint64_t& gc_record_byte_size) {
     if (keep_cnt == 0) {
         PDLOG(WARNING, "[Gc4Head] segment gc4head is disabled");
         return;
     }
+    if (latest_capacity_ > 0) {
+        GcLatestEntries(0, keep_cnt, TTLType::kLatestTime, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        return;
+    }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = gc_idx_cnt;
-    KeyEntries::Iterator* it = entries_->NewIterator();
-    it->SeekToFirst();
-    while (it->Valid()) {
+    KeyEntries::Iterator* it = NewGcIterator();
+    while (!IsGcSliceEnd(it)) {
         KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
         ::openmldb::base::Node<uint64_t, DataBlock*>* node = NULL;
         {
-            std::lock_guard<std::mutex> lock(mu_);
+            std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(it->GetKey()));
             if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                 node = entry->entries.SplitByPos(keep_cnt);
             }
@@ -495,6 +839,7 @@ void Segment::Gc4Head(uint64_t keep_cnt, uint64_t& gc_idx_cnt, uint64_t& gc_reco
         uint64_t entry_gc_idx_cnt = 0;
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
+        RemoveOldestCount(it->GetKey(), entry, entry_gc_idx_cnt);
         gc_idx_cnt += entry_gc_idx_cnt;
         it->Next();
     }
@@ -508,9 +853,8 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                         uint64_t& gc_record_byte_size) {
     uint64_t old = gc_idx_cnt;
     uint64_t consumed = ::baidu::common::timer::get_micros();
-    KeyEntries::Iterator* it = entries_->NewIterator();
-    it->SeekToFirst();
-    while (it->Valid()) {
+    KeyEntries::Iterator* it = NewGcIterator();
+    while (!IsGcSliceEnd(it)) {
         KeyEntry** entry_arr = (KeyEntry**)it->GetValue();  // NOLINT
         Slice key = it->GetKey();
         it->Next();
@@ -533,7 +877,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                         continue_flag = true;
                     } else {
                         node = NULL;
-                        std::lock_guard<std::mutex> lock(mu_);
+                        std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
                         SplitList(entry, kv.second.abs_ttl, &node);
                         if (entry->entries.IsEmpty()) {
                             empty_cnt++;
@@ -542,7 +886,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                     break;
                 }
                 case ::openmldb::storage::TTLType::kLatestTime: {
-                    std::lock_guard<std::mutex> lock(mu_);
+                    std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
                     if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                         node = entry->entries.SplitByPos(kv.second.lat_ttl);
                     }
@@ -554,7 +898,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                         continue_flag = true;
                     } else {
                         node = NULL;
-                        std::lock_guard<std::mutex> lock(mu_);
+                        std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
                         if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                             node = entry->entries.SplitByKeyAndPos(kv.second.abs_ttl, kv.second.lat_ttl);
                         }
@@ -567,7 +911,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                         continue_flag = true;
                     } else {
                         node = NULL;
-                        std::lock_guard<std::mutex> lock(mu_);
+                        std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
                         if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                             if (kv.second.abs_ttl == 0) {
                                 node = entry->entries.SplitByPos(kv.second.lat_ttl);
@@ -592,6 +936,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
             uint64_t entry_gc_idx_cnt = 0;
             FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
             entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
+            RemoveOldestCount(key, entry, entry_gc_idx_cnt);
             idx_cnt_vec_[pos->second]->fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
             gc_idx_cnt += entry_gc_idx_cnt;
         }
@@ -599,7 +944,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
             bool is_empty = true;
             ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
             {
-                std::lock_guard<std::mutex> lock(mu_);
+                std::lock_guard<::openmldb::base::SpinMutex> key_lock(GetKeyMutex(key));
                 for (uint32_t i = 0; i < ts_cnt_; i++) {
                     if (!entry_arr[i]->entries.IsEmpty()) {
                         is_empty = false;
@@ -607,12 +952,13 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                     }
                 }
                 if (is_empty) {
-                    entry_node = entries_->Remove(key);
+                    std::lock_guard<std::mutex> lock(mu_);
+                    entry_node = RemoveEntry(key);
                 }
             }
             if (entry_node != NULL) {
                 std::lock_guard<std::mutex> lock(gc_mu_);
-                entry_free_list_->Insert(gc_version_.load(std::memory_order_relaxed), entry_node);
+                entry_free_list_->Insert(GetFreeListVersion(), entry_node);
             }
         }
     }
@@ -631,11 +977,14 @@ void Segment::SplitList(KeyEntry* entry, uint64_t ts, ::openmldb::base::Node<uin
 // fast gc with no global pause
 void Segment::Gc4TTL(const uint64_t time, uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,
                      uint64_t& gc_record_byte_size) {
+    if (latest_capacity_ > 0) {
+        GcLatestEntries(time, 0, TTLType::kAbsoluteTime, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        return;
+    }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = gc_idx_cnt;
-    KeyEntries::Iterator* it = entries_->NewIterator();
-    it->SeekToFirst();
-    while (it->Valid()) {
+    KeyEntries::Iterator* it = NewGcIterator();
+    while (!IsGcSliceEnd(it)) {
         KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
         Slice key = it->GetKey();
         it->Next();
@@ -652,19 +1001,21 @@ void Segment::Gc4TTL(const uint64_t time, uint64_t& gc_idx_cnt, uint64_t& gc_rec
         node = NULL;
         ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
         {
-            std::lock_guard<std::mutex> lock(mu_);
+            std::lock_guard<::openmldb::base::SpinMutex> key_lock(GetKeyMutex(key));
             SplitList(entry, time, &node);
             if (entry->entries.IsEmpty()) {
-                entry_node = entries_->Remove(key);
+                std::lock_guard<std::mutex> lock(mu_);
+                entry_node = RemoveEntry(key);
             }
         }
         if (entry_node != NULL) {
             std::lock_guard<std::mutex> lock(gc_mu_);
-            entry_free_list_->Insert(gc_version_.load(std::memory_order_relaxed), entry_node);
+            entry_free_list_->Insert(GetFreeListVersion(), entry_node);
         }
         uint64_t entry_gc_idx_cnt = 0;
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
+        RemoveOldestCount(key, entry, entry_gc_idx_cnt);
         gc_idx_cnt += entry_gc_idx_cnt;
     }
     DEBUGLOG("[Gc4TTL] segment gc with key %lu ,consumed %lu, count %lu", time,
@@ -679,12 +1030,16 @@ void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, uint64
         PDLOG(INFO, "[Gc4TTLAndHead] segment gc4ttlandhead is disabled");
         return;
     }
+    if (latest_capacity_ > 0) {
+        GcLatestEntries(time, keep_cnt, TTLType::kAbsAndLat, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        return;
+    }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = gc_idx_cnt;
-    KeyEntries::Iterator* it = entries_->NewIterator();
-    it->SeekToFirst();
-    while (it->Valid()) {
+    KeyEntries::Iterator* it = NewGcIterator();
+    while (!IsGcSliceEnd(it)) {
         KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
+        Slice key = it->GetKey();
         ::openmldb::base::Node<uint64_t, DataBlock*>* node = entry->entries.GetLast();
         it->Next();
         if (node == NULL) {
@@ -698,7 +1053,7 @@ void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, uint64
         }
         node = NULL;
         {
-            std::lock_guard<std::mutex> lock(mu_);
+            std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
             if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                 node = entry->entries.SplitByKeyAndPos(time, keep_cnt);
             }
@@ -706,6 +1061,7 @@ void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, uint64
         uint64_t entry_gc_idx_cnt = 0;
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
+        RemoveOldestCount(key, entry, entry_gc_idx_cnt);
         gc_idx_cnt += entry_gc_idx_cnt;
     }
     DEBUGLOG(
@@ -728,11 +1084,14 @@ void Segment::Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, uint64_
         Gc4TTL(time, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         return;
     }
+    if (latest_capacity_ > 0) {
+        GcLatestEntries(time, keep_cnt, TTLType::kAbsOrLat, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        return;
+    }
     uint64_t consumed = ::baidu::common::timer::get_micros();
     uint64_t old = gc_idx_cnt;
-    KeyEntries::Iterator* it = entries_->NewIterator();
-    it->SeekToFirst();
-    while (it->Valid()) {
+    KeyEntries::Iterator* it = NewGcIterator();
+    while (!IsGcSliceEnd(it)) {
         KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
         Slice key = it->GetKey();
         it->Next();
@@ -743,21 +1102,23 @@ void Segment::Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, uint64_
         node = NULL;
         ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
         {
-            std::lock_guard<std::mutex> lock(mu_);
+            std::lock_guard<::openmldb::base::SpinMutex> key_lock(GetKeyMutex(key));
             if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                 node = entry->entries.SplitByKeyOrPos(time, keep_cnt);
             }
             if (entry->entries.IsEmpty()) {
-                entry_node = entries_->Remove(key);
+                std::lock_guard<std::mutex> lock(mu_);
+                entry_node = RemoveEntry(key);
             }
         }
         if (entry_node != NULL) {
             std::lock_guard<std::mutex> lock(gc_mu_);
-            entry_free_list_->Insert(gc_version_.load(std::memory_order_relaxed), entry_node);
+            entry_free_list_->Insert(GetFreeListVersion(), entry_node);
         }
         uint64_t entry_gc_idx_cnt = 0;
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
+        RemoveOldestCount(key, entry, entry_gc_idx_cnt);
         gc_idx_cnt += entry_gc_idx_cnt;
     }
     DEBUGLOG(
@@ -768,14 +1129,56 @@ void Segment::Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, uint64_
     delete it;
 }
 
+void Segment::GcLatestEntries(uint64_t time, uint64_t keep_cnt, TTLType ttl_type, uint64_t& gc_idx_cnt,
+                              uint64_t& gc_record_cnt, uint64_t& gc_record_byte_size) {
+    uint64_t consumed = ::baidu::common::timer::get_micros();
+    uint64_t old = gc_idx_cnt;
+    // keep the same behavior with skiplist, only the gc by time removes the empty key
+    bool remove_empty = ttl_type == TTLType::kAbsoluteTime || ttl_type == TTLType::kAbsOrLat;
+    std::vector<LatestEntries::Entry> rows;
+    KeyEntries::Iterator* it = NewGcIterator();
+    while (!IsGcSliceEnd(it)) {
+        LatestKeyEntry* entry = (LatestKeyEntry*)it->GetValue();  // NOLINT
+        Slice key = it->GetKey();
+        it->Next();
+        rows.clear();
+        ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
+        {
+            std::lock_guard<::openmldb::base::SpinMutex> key_lock(GetKeyMutex(key));
+            entry->entries.Expire(time, keep_cnt, ttl_type, entry->refs_, &rows);
+            if (remove_empty && entry->entries.IsEmpty()) {
+                std::lock_guard<std::mutex> lock(mu_);
+                entry_node = RemoveEntry(key);
+            }
+        }
+        if (entry_node != NULL) {
+            std::lock_guard<std::mutex> lock(gc_mu_);
+            entry_free_list_->Insert(GetFreeListVersion(), entry_node);
+        }
+        uint64_t entry_gc_idx_cnt = 0;
+        FreeRows(rows, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
+        gc_idx_cnt += entry_gc_idx_cnt;
+    }
+    DEBUGLOG("[GcLatestEntries] segment gc time %lu and keep cnt %lu consumed %lu, count %lu", time, keep_cnt,
+             (::baidu::common::timer::get_micros() - consumed) / 1000, gc_idx_cnt - old);
+    idx_cnt_.fetch_sub(gc_idx_cnt - old, std::memory_order_relaxed);
+    delete it;
+}
+
 int Segment::GetCount(const Slice& key, uint64_t& count) {
     if (ts_cnt_ > 1) {
         return -1;
     }
+    EpochGuard guard;
     void* entry = NULL;
-    if (entries_->Get(key, entry) < 0 || entry == NULL) {
+    if (GetEntry(key, entry) < 0 || entry == NULL) {
         return -1;
     }
+    if (latest_capacity_ > 0) {
+        count = ((LatestKeyEntry*)entry)->count_.load(std::memory_order_relaxed);  // NOLINT
+        return 0;
+    }
     count = ((KeyEntry*)entry)->count_.load(std::memory_order_relaxed);  // NOLINT
     return 0;
 }
@@ -788,8 +1191,9 @@ int Segment::GetCount(const Slice& key, uint32_t idx, uint64_t& count) {
     if (ts_cnt_ == 1) {
         return GetCount(key, count);
     }
+    EpochGuard guard;
     void* entry_arr = NULL;
-    if (entries_->Get(key, entry_arr) < 0 || entry_arr == NULL) {
+    if (GetEntry(key, entry_arr) < 0 || entry_arr == NULL) {
         return -1;
     }
     count = ((KeyEntry**)entry_arr)[pos->second]->count_.load(  // NOLINT
@@ -797,17 +1201,93 @@ int Segment::GetCount(const Slice& key, uint32_t idx, uint64_t& count) {
     return 0;
 }
 
+void Segment::RemoveOldestCount(const Slice& key, KeyEntry* entry, uint64_t cnt) {
+    if (entry->buckets_ == NULL || cnt == 0) {
+        return;
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
+    entry->buckets_->RemoveOldest(cnt);
+}
+
+bool Segment::CountAfter(KeyEntry* entry, uint64_t ts, uint64_t* count) {
+    auto last = entry->entries.GetLast();
+    if (last == NULL) {
+        *count = 0;
+        return true;
+    }
+    if (last->GetKey() > ts) {
+        *count = entry->count_.load(std::memory_order_relaxed);
+        return true;
+    }
+    if (entry->buckets_ == NULL) {
+        return false;
+    }
+    // the buckets after the one of ts are summed up and only the rows in it are scanned
+    uint64_t width = entry->buckets_->GetWidth();
+    uint64_t bucket_end = ts - ts % width + width - 1;
+    uint64_t cnt = entry->buckets_->CountAfterBucket(ts);
+    std::unique_ptr<TimeEntries::Iterator> it(entry->entries.NewIterator());
+    for (it->Seek(bucket_end); it->Valid() && it->GetKey() > ts; it->Next()) {
+        cnt++;
+    }
+    *count = cnt;
+    return true;
+}
+
+int Segment::GetUnexpiredCount(const Slice& key, uint32_t idx, uint64_t expire_time, uint64_t expire_cnt,
+                               TTLType ttl_type, uint64_t* count) {
+    if (count == NULL || latest_capacity_ > 0) {
+        return -2;
+    }
+    uint32_t ts_pos = 0;
+    if (ts_cnt_ > 1 && GetTsIdx(idx, ts_pos) < 0) {
+        return -1;
+    }
+    EpochGuard guard;
+    void* entry = NULL;
+    if (GetEntry(key, entry) < 0 || entry == NULL) {
+        return -1;
+    }
+    KeyEntry* key_entry = ts_cnt_ > 1 ? ((KeyEntry**)entry)[ts_pos] : (KeyEntry*)entry;  // NOLINT
+    std::lock_guard<::openmldb::base::SpinMutex> lock(GetKeyMutex(key));
+    // the count stops at the row of ts 0 without et, the same as a scan
+    uint64_t all_cnt = 0;
+    uint64_t live_cnt = 0;
+    if (!CountAfter(key_entry, 0, &all_cnt) || all_cnt != key_entry->count_.load(std::memory_order_relaxed) ||
+        !CountAfter(key_entry, expire_time, &live_cnt)) {
+        return -2;
+    }
+    switch (ttl_type) {
+        case TTLType::kAbsoluteTime:
+            *count = live_cnt;
+            break;
+        case TTLType::kLatestTime:
+        case TTLType::kAbsOrLat:
+            *count = expire_cnt > 0 ? std::min(expire_cnt, live_cnt) : live_cnt;
+            break;
+        case TTLType::kAbsAndLat:
+            if (expire_cnt == 0 || expire_time == 0) {
+                *count = all_cnt;
+            } else {
+                *count = std::max(live_cnt, std::min(expire_cnt, all_cnt));
+            }
+            break;
+        default:
+            return -2;
+    }
+    return 0;
+}
+
 // Iterator
 MemTableIterator* Segment::NewIterator(const Slice& key, Ticket& ticket) {
     if (entries_ == NULL || ts_cnt_ > 1) {
         return new MemTableIterator(NULL);
     }
     void* entry = NULL;
-    if (entries_->Get(key, entry) < 0 || entry == NULL) {
+    if (GetEntry(key, entry) < 0 || entry == NULL) {
         return new MemTableIterator(NULL);
     }
-    ticket.Push((KeyEntry*)entry);                                           // NOLINT
-    return new MemTableIterator(((KeyEntry*)entry)->entries.NewIterator());  // NOLINT
+    return new MemTableIterator(NewTimeEntryIterator(entry, 0, ticket));
 }
 
 MemTableIterator* Segment::NewIterator(const Slice& key, uint32_t idx, Ticket& ticket) {
@@ -819,14 +1299,234 @@ MemTableIterator* Segment::NewIterator(const Slice& key, uint32_t idx, Ticket& t
         return NewIterator(key, ticket);
     }
     void* entry_arr = NULL;
-    if (entries_->Get(key, entry_arr) < 0 || entry_arr == NULL) {
+    if (GetEntry(key, entry_arr) < 0 || entry_arr == NULL) {
         return new MemTableIterator(NULL);
     }
-    ticket.Push(((KeyEntry**)entry_arr)[pos->second]);                                         // NOLINT
-    return new MemTableIterator(((KeyEntry**)entry_arr)[pos->second]->entries.NewIterator());  // NOLINT
+    return new MemTableIterator(NewTimeEntryIterator(entry_arr, pos->second, ticket));
 }
 
-MemTableIterator::MemTableIterator(TimeEntries::Iterator* it) : it_(it) {}
+bool Segment::SampleTsRange(uint32_t ts_idx, uint32_t key_cnt, uint64_t* min_ts, uint64_t* max_ts) {
+    uint32_t ts_pos = 0;
+    if (ts_cnt_ > 1 && GetTsIdx(ts_idx, ts_pos) < 0) {
+        return false;
+    }
+    bool found = false;
+    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
+    it->SeekToFirst();
+    for (uint32_t cnt = 0; it->Valid() && cnt < key_cnt; it->Next(), cnt++) {
+        Ticket ticket;
+        std::unique_ptr<TimeEntryIterator> time_it(NewTimeEntryIterator(it->GetValue(), ts_pos, ticket));
+        // the rows are in desc order of ts
+        time_it->SeekToFirst();
+        if (!time_it->Valid()) {
+            continue;
+        }
+        uint64_t max = time_it->GetKey();
+        time_it->SeekToLast();
+        uint64_t min = time_it->Valid() ? time_it->GetKey() : max;
+        if (!found) {
+            *min_ts = min;
+            *max_ts = max;
+            found = true;
+        } else {
+            *min_ts = std::min(*min_ts, min);
+            *max_ts = std::max(*max_ts, max);
+        }
+    }
+    return found;
+}
+
+void Segment::CollectMemStat(uint32_t ts_idx, IndexMemStat* stat) {
+    uint32_t ts_pos = 0;
+    if (ts_cnt_ > 1 && GetTsIdx(ts_idx, ts_pos) < 0) {
+        return;
+    }
+    // the bytes shared by the ts columns of a key are summed up before splitting
+    uint64_t key_byte_size = 0;
+    uint64_t key_node_byte_size = 0;
+    std::unique_ptr<KeyEntries::Iterator> it(entries_->NewIterator());
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        Ticket ticket;
+        void* entry = it->GetValue();
+        stat->key_cnt++;
+        key_byte_size += it->GetKey().size();
+        key_node_byte_size += it->GetHeight() * 8 + ENTRY_NODE_SIZE;
+        if (latest_capacity_ > 0) {
+            stat->key_node_byte_size += LATEST_KEY_ENTRY_BYTE_SIZE;
+        } else {
+            KeyEntry* key_entry = ts_cnt_ > 1 ? ((KeyEntry**)entry)[ts_pos] : (KeyEntry*)entry;  // NOLINT
+            if (ts_cnt_ > 1) {
+                key_node_byte_size += KEY_ENTRY_PTR_SIZE * ts_cnt_;
+            }
+            stat->key_node_byte_size +=
+                KEY_ENTRY_BYTE_SIZE + key_entry->entries.GetHeightLimit() * 8 + DATA_NODE_SIZE;
+        }
+        std::unique_ptr<TimeEntryIterator> time_it(NewTimeEntryIterator(entry, ts_pos, ticket));
+        for (time_it->SeekToFirst(); time_it->Valid(); time_it->Next()) {
+            DataBlock* block = time_it->GetValue();
+            // the count is decreased by gc concurrently and 0 is never left in a live block
+            uint32_t ref_cnt = std::max<uint32_t>(block->dim_cnt_down, 1);
+            uint64_t payload = GetRecordSize(block->size);
+            stat->record_cnt++;
+            stat->payload_byte_size += payload;
+            stat->shared_payload_byte_size += payload / ref_cnt;
+            if (block->pooled) {
+                stat->fragment_byte_size += (DataBlockPool::GetAllocByteSize(block->size) - block->size) / ref_cnt;
+            }
+            stat->row_node_byte_size +=
+                latest_capacity_ > 0 ? GetRecordLatestIdxSize() : GetRecordTsIdxSize(time_it->GetHeight());
+        }
+    }
+    stat->key_byte_size += key_byte_size / ts_cnt_;
+    stat->key_node_byte_size += key_node_byte_size / ts_cnt_;
+}
+
+TimeEntryIterator* Segment::NewTimeEntryIterator(void* entry, uint32_t ts_pos, Ticket& ticket, uint64_t read_seq) {
+    TimeEntryIterator* it = NULL;
+    if (latest_capacity_ > 0) {
+        LatestKeyEntry* latest_entry = (LatestKeyEntry*)entry;  // NOLINT
+        // ref the entry before taking the copy of rows, so that gc will skip it
+        ticket.Push(latest_entry);
+        it = new TimeEntryIterator(&latest_entry->entries);
+    } else {
+        KeyEntry* key_entry = ts_cnt_ > 1 ? ((KeyEntry**)entry)[ts_pos] : (KeyEntry*)entry;  // NOLINT
+        ticket.Push(key_entry);
+        it = new TimeEntryIterator(key_entry->entries.NewIterator());
+    }
+    it->SetReadSeq(read_seq);
+    return it;
+}
+
+bool Segment::EnableKeyHashIndex(uint32_t init_bucket_cnt) {
+    if (key_index_ != NULL || init_bucket_cnt == 0 || pk_cnt_.load(std::memory_order_relaxed) > 0) {
+        return false;
+    }
+    key_index_ = new KeyHashIndex(init_bucket_cnt);
+    return true;
+}
+
+bool Segment::EnableLatestEntries(uint32_t capacity) {
+    if (ts_cnt_ > 1 || capacity == 0 || pk_cnt_.load(std::memory_order_relaxed) > 0) {
+        return false;
+    }
+    latest_capacity_ = capacity;
+    return true;
+}
+
+LatestEntries::LatestEntries(uint32_t capacity)
+    : mu_(), buf_(NULL), init_capacity_(capacity), capacity_(capacity), head_(0), size_(0) {
+    buf_ = new Entry[capacity_];
+}
+
+LatestEntries::~LatestEntries() { delete[] buf_; }
+
+void LatestEntries::Resize(uint32_t capacity) {
+    Entry* buf = new Entry[capacity];
+    for (uint32_t i = 0; i < size_; i++) {
+        buf[i] = At(i);
+    }
+    delete[] buf_;
+    buf_ = buf;
+    capacity_ = capacity;
+    head_ = 0;
+}
+
+void LatestEntries::Insert(uint64_t ts, DataBlock* block) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    if (size_ == capacity_) {
+        Resize(capacity_ * 2);
+    }
+    // the newer row is inserted before the rows with the same ts, same as skiplist
+    uint32_t pos = 0;
+    while (pos < size_ && At(pos).first > ts) {
+        pos++;
+    }
+    head_ = head_ == 0 ? capacity_ - 1 : head_ - 1;
+    size_++;
+    for (uint32_t i = 0; i < pos; i++) {
+        At(i) = At(i + 1);
+    }
+    At(pos) = std::make_pair(ts, block);
+}
+
+DataBlock* LatestEntries::Get(uint64_t ts) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    for (uint32_t i = 0; i < size_; i++) {
+        const Entry& entry = At(i);
+        if (entry.first == ts) {
+            return entry.second;
+        } else if (entry.first < ts) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+void LatestEntries::SplitByPos(uint32_t pos, std::vector<Entry>* removed) {
+    for (uint32_t i = pos; i < size_; i++) {
+        removed->push_back(At(i));
+    }
+    if (pos < size_) {
+        size_ = pos;
+    }
+    // release the memory after a burst of writes between two gc
+    if (capacity_ > init_capacity_ && size_ * 4 < capacity_) {
+        Resize(std::max(init_capacity_, capacity_ / 2));
+    }
+}
+
+void LatestEntries::Expire(uint64_t time, uint64_t keep_cnt, TTLType ttl_type, const std::atomic<uint64_t>& refs,
+                           std::vector<Entry>* removed) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    if (refs.load(std::memory_order_acquire) > 0) {
+        return;
+    }
+    // the rows are sorted by ts desc, so expired rows are always the tail
+    uint32_t after_cnt = 0;
+    while (after_cnt < size_ && At(after_cnt).first > time) {
+        after_cnt++;
+    }
+    uint32_t cnt = keep_cnt < size_ ? keep_cnt : size_;
+    uint32_t keep = size_;
+    switch (ttl_type) {
+        case TTLType::kAbsoluteTime:
+            keep = after_cnt;
+            break;
+        case TTLType::kLatestTime:
+            keep = cnt;
+            break;
+        case TTLType::kAbsAndLat:
+            keep = std::max(after_cnt, cnt);
+            break;
+        case TTLType::kAbsOrLat:
+            keep = std::min(after_cnt, cnt);
+            break;
+        default:
+            return;
+    }
+    SplitByPos(keep, removed);
+}
+
+void LatestEntries::Clear(std::vector<Entry>* removed) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    SplitByPos(0, removed);
+}
+
+void LatestEntries::CopyTo(std::vector<Entry>* rows) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    rows->reserve(size_);
+    for (uint32_t i = 0; i < size_; i++) {
+        rows->push_back(At(i));
+    }
+}
+
+uint32_t LatestEntries::GetSize() {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    return size_;
+}
+
+MemTableIterator::MemTableIterator(TimeEntryIterator* it)
+    : it_(it), row_codec_(nullptr), cold_codec_(nullptr), buf_(), cold_buf_() {}
 
 MemTableIterator::~MemTableIterator() {
     if (it_ != NULL) {
@@ -856,7 +1556,19 @@ void MemTableIterator::Next() {
 }
 
 ::openmldb::base::Slice MemTableIterator::GetValue() const {
-    return ::openmldb::base::Slice(it_->GetValue()->data, it_->GetValue()->size);
+    const DataBlock* block = it_->GetValue();
+    const char* data = LoadBlockData(block);
+    if (cold_codec_ != nullptr && IsColdData(data)) {
+        cold_buf_.clear();
+        cold_codec_->Decode(UntagColdData(data), block->size, &cold_buf_);
+        data = cold_buf_.data();
+    }
+    if (row_codec_ != nullptr && codec::CompactRowCodec::IsCompact(data, block->size)) {
+        buf_.clear();
+        row_codec_->Decode(data, block->size, &buf_);
+        return ::openmldb::base::Slice(buf_.data(), buf_.size());
+    }
+    return ::openmldb::base::Slice(data, block->size);
 }
 
 uint64_t MemTableIterator::GetKey() const { return it_->GetKey(); }
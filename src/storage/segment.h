@@ -17,16 +17,28 @@
 #ifndef SRC_STORAGE_SEGMENT_H_
 #define SRC_STORAGE_SEGMENT_H_
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "base/hash.h"
 #include "base/skiplist.h"
 #include "base/slice.h"
+#include "base/spinlock.h"
+#include "codec/cold_row_codec.h"
+#include "codec/compact_row_codec.h"
+#include "config.h"  // NOLINT
 #include "proto/tablet.pb.h"
+#include "storage/data_block_pool.h"
 #include "storage/iterator.h"
+#include "storage/key_hash_index.h"
 #include "storage/schema.h"
 #include "storage/ticket.h"
 
@@ -40,19 +52,47 @@ using ::openmldb::base::Slice;
 class Segment;
 class Ticket;
 
+// the data of a cold block is tagged in the top bit of its pointer, which no user space address sets, so a reader
+// knows whether the row is cold from the same load of the pointer, see Segment::CompressColdRows
+static_assert(sizeof(uintptr_t) == 8, "the cold tag needs 64 bit pointers");
+static constexpr uintptr_t COLD_DATA_TAG = static_cast<uintptr_t>(1) << 63;
+
+static inline bool IsColdData(const char* data) { return (reinterpret_cast<uintptr_t>(data) & COLD_DATA_TAG) != 0; }
+
+static inline char* TagColdData(char* cold) {
+    return reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(cold) | COLD_DATA_TAG);
+}
+
+static inline char* UntagColdData(char* data) {
+    return reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(data) & ~COLD_DATA_TAG);
+}
+
+static inline const char* UntagColdData(const char* data) {
+    return reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(data) & ~COLD_DATA_TAG);
+}
+
 struct DataBlock {
     // dimension count down
     uint8_t dim_cnt_down;
+    // the data is allocated from DataBlockPool and has to be returned by the owner
+    bool pooled;
+    // the data refers to the memory owned by others, e.g. a mapped snapshot, and is not freed
+    bool referred;
     uint32_t size;
     char* data;
+#ifdef SNAPSHOT_READ_ENABLE
+    // the put seq of the row in the table, 0 if it is not stamped. see MemTable::GetReadSeq
+    uint64_t seq = 0;
+#endif
 
-    DataBlock(uint8_t dim_cnt, const char* input, uint32_t len) : dim_cnt_down(dim_cnt), size(len), data(NULL) {
+    DataBlock(uint8_t dim_cnt, const char* input, uint32_t len)
+        : dim_cnt_down(dim_cnt), pooled(false), referred(false), size(len), data(NULL) {
         data = new char[len];
         memcpy(data, input, len);
     }
 
     DataBlock(uint8_t dim_cnt, char* input, uint32_t len, bool skip_copy)
-        : dim_cnt_down(dim_cnt), size(len), data(NULL) {
+        : dim_cnt_down(dim_cnt), pooled(false), referred(false), size(len), data(NULL) {
         if (skip_copy) {
             data = input;
         } else {
@@ -61,12 +101,45 @@ struct DataBlock {
         }
     }
 
+    DataBlock(uint8_t dim_cnt, const char* input, uint32_t len, DataBlockPool* pool)
+        : dim_cnt_down(dim_cnt), pooled(false), referred(false), size(len), data(NULL) {
+        if (pool != NULL) {
+            data = pool->Alloc(len);
+        }
+        if (data != NULL) {
+            pooled = true;
+        } else {
+            data = new char[len];
+        }
+        memcpy(data, input, len);
+    }
+
     ~DataBlock() {
-        delete[] data;
+        if (!pooled && !referred) {
+            delete[] UntagColdData(data);
+        }
         data = NULL;
     }
+
+    // refer to the data without copying, the data has to outlive the block
+    static DataBlock* Refer(uint8_t dim_cnt, const char* input, uint32_t len) {
+        auto* block = new DataBlock(dim_cnt, const_cast<char*>(input), len, true);
+        block->referred = true;
+        return block;
+    }
 };
 
+// delete the block and return its payload to the pool if it is pooled
+static inline void DeleteDataBlock(DataBlock* block, DataBlockPool* pool) {
+    if (block->pooled && pool != NULL) {
+        pool->Free(block->data, block->size);
+    }
+    delete block;
+}
+
+// load the data of the block once, as gc may replace it with the cold row, see Segment::CompressColdRows
+static inline char* LoadBlockData(const DataBlock* block) { return __atomic_load_n(&block->data, __ATOMIC_ACQUIRE); }
+
 // the desc time comparator
 struct TimeComparator {
     int operator()(const uint64_t& a, const uint64_t& b) const {
@@ -82,9 +155,150 @@ struct TimeComparator {
 static const TimeComparator tcmp;
 typedef ::openmldb::base::Skiplist<uint64_t, DataBlock*, TimeComparator> TimeEntries;
 
+// The time entries of a latest-only index. The rows are kept in a ring sorted
+// by ts desc, so that reading one key is a sequential scan. Inserting needs
+// external synchronized with other writers, readers take a copy of the rows
+// under mu_ and never block the writers for the lifetime of an iterator.
+class LatestEntries {
+ public:
+    typedef std::pair<uint64_t, DataBlock*> Entry;
+
+    explicit LatestEntries(uint32_t capacity);
+    ~LatestEntries();
+    LatestEntries(const LatestEntries&) = delete;
+    LatestEntries& operator=(const LatestEntries&) = delete;
+
+    void Insert(uint64_t ts, DataBlock* block);
+
+    DataBlock* Get(uint64_t ts);
+
+    // remove the expired rows and append them to removed. the rows whose ts is
+    // less or equal than time are expired by time, and the rows behind keep_cnt
+    // are expired by count. skip it if the entry is referenced by any reader
+    void Expire(uint64_t time, uint64_t keep_cnt, TTLType ttl_type, const std::atomic<uint64_t>& refs,
+                std::vector<Entry>* removed);
+
+    // remove all rows and append them to removed
+    void Clear(std::vector<Entry>* removed);
+
+    void CopyTo(std::vector<Entry>* rows);
+
+    uint32_t GetSize();
+
+    bool IsEmpty() { return GetSize() == 0; }
+
+    uint32_t GetCapacity() const { return capacity_; }
+
+ private:
+    inline const Entry& At(uint32_t pos) const {
+        uint32_t idx = head_ + pos;
+        return buf_[idx >= capacity_ ? idx - capacity_ : idx];
+    }
+    inline Entry& At(uint32_t pos) {
+        uint32_t idx = head_ + pos;
+        return buf_[idx >= capacity_ ? idx - capacity_ : idx];
+    }
+    void Resize(uint32_t capacity);
+    void SplitByPos(uint32_t pos, std::vector<Entry>* removed);
+
+ private:
+    ::openmldb::base::SpinMutex mu_;
+    Entry* buf_;
+    const uint32_t init_capacity_;
+    uint32_t capacity_;
+    uint32_t head_;
+    uint32_t size_;
+};
+
+// Iterate the time entries of one key. The skiplist is iterated in place and
+// the ring of LatestEntries is iterated on a copy taken at construction.
+class TimeEntryIterator {
+ public:
+    explicit TimeEntryIterator(TimeEntries::Iterator* it) : it_(it), rows_(), pos_(0), read_seq_(0) {}
+    explicit TimeEntryIterator(LatestEntries* entries) : it_(NULL), rows_(), pos_(0), read_seq_(0) {
+        entries->CopyTo(&rows_);
+    }
+    ~TimeEntryIterator() { delete it_; }
+    TimeEntryIterator(const TimeEntryIterator&) = delete;
+    TimeEntryIterator& operator=(const TimeEntryIterator&) = delete;
+
+    inline bool Valid() const { return it_ != NULL ? it_->Valid() : pos_ < rows_.size(); }
+
+    inline void Next() {
+        NextRow();
+        SkipInvisible();
+    }
+
+    inline const uint64_t& GetKey() const { return it_ != NULL ? it_->GetKey() : rows_[pos_].first; }
+
+    inline DataBlock* GetValue() const { return it_ != NULL ? it_->GetValue() : rows_[pos_].second; }
+
+    // the height of the skiplist node of the row, 0 in latest entries mode
+    inline uint8_t GetHeight() const { return it_ != NULL ? it_->GetHeight() : 0; }
+
+    // the rows stamped with read_seq or a later seq are skipped by the moves but SeekToLast, 0 reads all the rows
+    void SetReadSeq(uint64_t read_seq) { read_seq_ = read_seq; }
+
+    // seek to the first row whose ts is less or equal than time
+    void Seek(uint64_t time) {
+        if (it_ != NULL) {
+            it_->Seek(time);
+        } else {
+            auto iter = std::lower_bound(rows_.begin(), rows_.end(), time,
+                                         [](const LatestEntries::Entry& row, uint64_t ts) { return row.first > ts; });
+            pos_ = iter - rows_.begin();
+        }
+        SkipInvisible();
+    }
+
+    inline void SeekToFirst() {
+        if (it_ != NULL) {
+            it_->SeekToFirst();
+        } else {
+            pos_ = 0;
+        }
+        SkipInvisible();
+    }
+
+    inline void SeekToLast() {
+        if (it_ != NULL) {
+            it_->SeekToLast();
+        } else {
+            pos_ = rows_.empty() ? 0 : rows_.size() - 1;
+        }
+    }
+
+    inline uint32_t GetSize() { return it_ != NULL ? it_->GetSize() : rows_.size(); }
+
+ private:
+    inline void NextRow() {
+        if (it_ != NULL) {
+            it_->Next();
+        } else {
+            pos_++;
+        }
+    }
+
+    inline void SkipInvisible() {
+#ifdef SNAPSHOT_READ_ENABLE
+        if (read_seq_ == 0) {
+            return;
+        }
+        while (Valid() && GetValue()->seq >= read_seq_) {
+            NextRow();
+        }
+#endif
+    }
+
+    TimeEntries::Iterator* it_;
+    std::vector<LatestEntries::Entry> rows_;
+    uint32_t pos_;
+    uint64_t read_seq_;
+};
+
 class MemTableIterator : public TableIterator {
  public:
-    explicit MemTableIterator(TimeEntries::Iterator* it);
+    explicit MemTableIterator(TimeEntryIterator* it);
     virtual ~MemTableIterator();
     void Seek(const uint64_t time) override;
     bool Valid() override;
@@ -94,18 +308,56 @@ class MemTableIterator : public TableIterator {
     void SeekToFirst() override;
     void SeekToLast() override;
 
+    // decode the compact rows with codec, the value is valid until the next GetValue
+    void SetRowCodec(const codec::CompactRowCodec* codec) { row_codec_ = codec; }
+    // inflate the cold rows with codec
+    void SetColdCodec(const codec::ColdRowCodec* codec) { cold_codec_ = codec; }
+
  private:
-    TimeEntries::Iterator* it_;
+    TimeEntryIterator* it_;
+    const codec::CompactRowCodec* row_codec_;
+    const codec::ColdRowCodec* cold_codec_;
+    mutable std::string buf_;
+    mutable std::string cold_buf_;
+};
+
+// The row counts of a key in the buckets of a fixed time width, in ascending order of time. The gc always
+// removes the oldest rows of a key whatever the ttl type, so the count removed is taken from the oldest
+// buckets. It is guarded by the lock of the key
+class CountBuckets {
+ public:
+    explicit CountBuckets(uint64_t width) : width_(std::max<uint64_t>(width, 1)) {}
+
+    void Add(uint64_t ts, uint64_t cnt = 1);
+
+    void RemoveOldest(uint64_t cnt);
+
+    void Clear() { buckets_.clear(); }
+
+    uint64_t GetWidth() const { return width_; }
+
+    // the count of the rows in the buckets after the one of ts
+    uint64_t CountAfterBucket(uint64_t ts) const;
+
+ private:
+    uint64_t width_;
+    // the start time of the bucket and its count
+    std::vector<std::pair<uint64_t, uint64_t>> buckets_;
 };
 
 class KeyEntry {
  public:
-    KeyEntry() : entries(12, 4, tcmp), refs_(0), count_(0) {}
-    explicit KeyEntry(uint8_t height) : entries(height, 4, tcmp), refs_(0), count_(0) {}
-    ~KeyEntry() {}
+    KeyEntry() : entries(12, 4, tcmp), refs_(0), count_(0), buckets_(NULL) {}
+    explicit KeyEntry(uint8_t height) : entries(height, 4, tcmp), refs_(0), count_(0), buckets_(NULL) {}
+    KeyEntry(uint8_t height, uint64_t bucket_width)
+        : entries(height, 4, tcmp),
+          refs_(0),
+          count_(0),
+          buckets_(bucket_width > 0 ? new CountBuckets(bucket_width) : NULL) {}
+    ~KeyEntry() { delete buckets_; }
 
     // just return the count of datablock
-    uint64_t Release() {
+    uint64_t Release(DataBlockPool* pool = NULL) {
         uint64_t cnt = 0;
         TimeEntries::Iterator* it = entries.NewIterator();
         it->SeekToFirst();
@@ -116,12 +368,15 @@ class KeyEntry {
             if (block->dim_cnt_down > 1) {
                 block->dim_cnt_down--;
             } else {
-                delete block;
+                DeleteDataBlock(block, pool);
             }
             it->Next();
         }
         entries.Clear();
         delete it;
+        if (buckets_ != NULL) {
+            buckets_->Clear();
+        }
         return cnt;
     }
 
@@ -135,6 +390,42 @@ class KeyEntry {
     TimeEntries entries;
     std::atomic<uint64_t> refs_;
     std::atomic<uint64_t> count_;
+    // NULL if the count buckets are disabled
+    CountBuckets* buckets_;
+    friend Segment;
+};
+
+// the key entry of segment in latest entries mode
+class LatestKeyEntry {
+ public:
+    explicit LatestKeyEntry(uint32_t capacity) : entries(capacity), refs_(0), count_(0) {}
+    ~LatestKeyEntry() {}
+
+    // just return the count of datablock
+    uint64_t Release(DataBlockPool* pool = NULL) {
+        std::vector<LatestEntries::Entry> rows;
+        entries.Clear(&rows);
+        for (const auto& row : rows) {
+            // Avoid double free
+            if (row.second->dim_cnt_down > 1) {
+                row.second->dim_cnt_down--;
+            } else {
+                DeleteDataBlock(row.second, pool);
+            }
+        }
+        return rows.size();
+    }
+
+    void Ref() { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+    void UnRef() { refs_.fetch_sub(1, std::memory_order_relaxed); }
+
+    uint64_t GetCount() { return count_.load(std::memory_order_relaxed); }
+
+ public:
+    LatestEntries entries;
+    std::atomic<uint64_t> refs_;
+    std::atomic<uint64_t> count_;
     friend Segment;
 };
 
@@ -145,6 +436,26 @@ struct SliceComparator {
 typedef ::openmldb::base::Skiplist<::openmldb::base::Slice, void*, SliceComparator> KeyEntries;
 typedef ::openmldb::base::Skiplist<uint64_t, ::openmldb::base::Node<Slice, void*>*, TimeComparator> KeyEntryNodeList;
 
+// The memory taken by one index, collected by walking its rows. A row is shared by all the indexes putting it,
+// so its payload is counted in full by each of them and also split over the indexes still referring to it,
+// the shares of all indexes sum up to the payload of the table. The key bytes and nodes shared by the ts
+// columns of one key are split the same way.
+struct IndexMemStat {
+    uint64_t key_cnt = 0;
+    uint64_t record_cnt = 0;
+    // the bytes of the keys
+    uint64_t key_byte_size = 0;
+    // the skiplist nodes and entries of the keys
+    uint64_t key_node_byte_size = 0;
+    // the skiplist nodes or latest entry slots of the rows
+    uint64_t row_node_byte_size = 0;
+    // the rows referred, with DataBlock
+    uint64_t payload_byte_size = 0;
+    uint64_t shared_payload_byte_size = 0;
+    // the share of the bytes wasted by rounding the pooled payloads up to the chunk size
+    uint64_t fragment_byte_size = 0;
+};
+
 class Segment {
  public:
     Segment();
@@ -155,12 +466,17 @@ class Segment {
     // Put time data
     void Put(const Slice& key, uint64_t time, const char* data, uint32_t size);
 
+    // puts on the keys guarded by different key locks never contend, only the
+    // creation of a new key is serialized by mu_
     void Put(const Slice& key, uint64_t time, DataBlock* row);
 
-    void PutUnlock(const Slice& key, uint64_t time, DataBlock* row);
-
     void BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row);
 
+    // put the rows of a key sorted by time in ascending order under one key lock, a row not older than the
+    // latest of the key entry is pushed to the head of its time skiplist without searching
+    void BulkLoadPut(unsigned int key_entry_id, const Slice& key,
+                     const std::vector<std::pair<uint64_t, DataBlock*>>& rows);
+
     void Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* row);
 
     // Get time data
@@ -172,11 +488,23 @@ class Segment {
 
     uint64_t Release();
 
+    // release all the entries and call yield after every yield_key_cnt keys released if it is set. The pooled
+    // payloads are left to the pool if not free_pooled, as dropping the pool with the table frees them at once
+    uint64_t Release(uint32_t yield_key_cnt, const std::function<void()>& yield, bool free_pooled);
+
     void ExecuteGc(const TTLSt& ttl_st, uint64_t& gc_idx_cnt,                          // NOLINT
                    uint64_t& gc_record_cnt, uint64_t& gc_record_byte_size);            // NOLINT
     void ExecuteGc(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& gc_idx_cnt,  // NOLINT
                    uint64_t& gc_record_cnt, uint64_t& gc_record_byte_size);            // NOLINT
 
+    // gc at most budget_us microseconds and the next call resumes from the key where
+    // it stops, return true if all keys have been visited. budget_us 0 means no limit
+    bool ExecuteGcSlice(const TTLSt& ttl_st, uint64_t budget_us, uint64_t& gc_idx_cnt,       // NOLINT
+                        uint64_t& gc_record_cnt, uint64_t& gc_record_byte_size);             // NOLINT
+    bool ExecuteGcSlice(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t budget_us,     // NOLINT
+                        uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt,                       // NOLINT
+                        uint64_t& gc_record_byte_size);                                      // NOLINT
+
     void Gc4TTL(const uint64_t time, uint64_t& gc_idx_cnt,  // NOLINT
                 uint64_t& gc_record_cnt,                    // NOLINT
                 uint64_t& gc_record_byte_size);             // NOLINT
@@ -230,6 +558,10 @@ class Segment {
 
     inline uint64_t GetPkCnt() { return pk_cnt_.load(std::memory_order_relaxed); }
 
+    // the height limit of the time entries of the keys created later, the existing keys keep theirs
+    void SetKeyEntryMaxHeight(uint8_t height) { key_entry_max_height_.store(height, std::memory_order_relaxed); }
+    uint8_t GetKeyEntryMaxHeight() const { return key_entry_max_height_.load(std::memory_order_relaxed); }
+
     void GcFreeList(uint64_t& entry_gc_idx_cnt,      // NOLINT
                     uint64_t& gc_record_cnt,         // NOLINT
                     uint64_t& gc_record_byte_size);  // NOLINT
@@ -239,17 +571,111 @@ class Segment {
     int GetCount(const Slice& key, uint64_t& count);                // NOLINT
     int GetCount(const Slice& key, uint32_t idx, uint64_t& count);  // NOLINT
 
+    // the count of the rows of key not expired by expire_time and expire_cnt, the same as the count of
+    // TabletImpl::CountIndex without st and et. It is looked up in the count buckets and only the bucket
+    // of expire_time is scanned. return -1 if the key is not found, -2 if it can't be counted without scan
+    int GetUnexpiredCount(const Slice& key, uint32_t idx, uint64_t expire_time, uint64_t expire_cnt,
+                          TTLType ttl_type, uint64_t* count);
+
+    // the range of ts of the rows of the first `key_cnt` keys, as a sample of the ts distribution.
+    // return false if no row is found
+    bool SampleTsRange(uint32_t ts_idx, uint32_t key_cnt, uint64_t* min_ts, uint64_t* max_ts);
+
+    // add the memory of the rows of ts_idx to stat. the keys are walked without blocking the puts and gc,
+    // so the stat is not a consistent snapshot if they run meanwhile
+    void CollectMemStat(uint32_t ts_idx, IndexMemStat* stat);
+
     void IncrGcVersion() { gc_version_.fetch_add(1, std::memory_order_relaxed); }
 
+    // store the rows of each key in LatestEntries instead of skiplist. it only
+    // works for the segment with single ts and must be called before any put
+    bool EnableLatestEntries(uint32_t capacity);
+    inline bool IsLatestEntries() const { return latest_capacity_ > 0; }
+
+    // look up the keys by hash index besides the skiplist, which is still kept for the ordered
+    // traversal and gc. it must be called before any put
+    bool EnableKeyHashIndex(uint32_t init_bucket_cnt);
+    inline bool IsKeyHashIndex() const { return key_index_ != NULL; }
+
+    // create the iterator of the value of KeyEntries, ts_pos is the pos of ts in
+    // key entry array and the entry is pushed into ticket
+    // the rows put at or after read_seq are skipped, see TimeEntryIterator::SetReadSeq
+    TimeEntryIterator* NewTimeEntryIterator(void* entry, uint32_t ts_pos, Ticket& ticket,  // NOLINT
+                                            uint64_t read_seq = 0);
+
+    // the pool is owned by the table and shared by all segments of it
+    void SetDataBlockPool(DataBlockPool* pool) { block_pool_ = pool; }
+    DataBlockPool* GetDataBlockPool() const { return block_pool_; }
+
     void ReleaseAndCount(uint64_t& gc_idx_cnt,            // NOLINT
                          uint64_t& gc_record_cnt,         // NOLINT
                          uint64_t& gc_record_byte_size);  // NOLINT
 
+    // replace the data of the rows with ts no greater than cold_time by their cold rows, and free the data
+    // replaced once no reader may see it on a later GcFreeList. only the rows after the cold_time of the last
+    // call are visited, so a row put with an older ts than it stays as it is. it is called by the gc thread
+    void CompressColdRows(uint64_t cold_time, const codec::ColdRowCodec& codec, uint64_t* row_cnt,
+                          uint64_t* saved_byte_size);
+    // append the rows with ts no greater than cold_time to samples until it has max_size bytes
+    void SampleColdRows(uint64_t cold_time, uint32_t max_size, std::string* samples);
+
  private:
+    // the data replaced by a cold row, freed once the free list version reaches version
+    struct ColdFreeData {
+        uint64_t version;
+        char* data;
+        uint32_t size;
+        bool pooled;
+        bool referred;
+    };
+    // the pooled data is returned to pool, or left to the pool freed in bulk if pool is NULL
+    static void FreeColdData(const ColdFreeData& cold_data, DataBlockPool* pool);
+    void GcColdFreeList(uint64_t version);
+
+    // one lock per cache line to avoid false sharing between the writers
+    struct alignas(64) KeyMutex {
+        ::openmldb::base::SpinMutex mu;
+    };
+
+    // the key of the entry removed in entry_free_list_
+    uint64_t GetFreeListVersion() const;
+
+    // differ from the seed of segment selection, or all keys of one segment fall into few locks
+    static const uint32_t KEY_LOCK_SEED = 0x5f3759df;
+
+    // the lock of the rows of key, it must be acquired before mu_
+    inline ::openmldb::base::SpinMutex& GetKeyMutex(const Slice& key) {
+        return key_mu_[::openmldb::base::hash(key.data(), key.size(), KEY_LOCK_SEED) % key_mu_cnt_].mu;
+    }
+    // return the entry of key and create it if not exist, the caller must hold the lock of key
+    void* GetOrCreateEntry(const Slice& key, uint32_t* byte_size);
+    // return -1 if the key is not found
+    inline int GetEntry(const Slice& key, void*& entry) {  // NOLINT
+        if (key_index_ != NULL) {
+            return key_index_->Get(key, &entry) ? 0 : -1;
+        }
+        return entries_->Get(key, entry);
+    }
+    // remove the key from entries_ and key_index_, the caller must hold mu_
+    ::openmldb::base::Node<Slice, void*>* RemoveEntry(const Slice& key);
+
+    // check the deadline every GC_SLICE_CHECK_KEY_CNT keys
+    static const uint32_t GC_SLICE_CHECK_KEY_CNT = 64;
+
+    // the iterator starts from gc_cursor_
+    KeyEntries::Iterator* NewGcIterator();
+    // save the cursor and return true if the deadline of slice is reached or no key left
+    bool IsGcSliceEnd(KeyEntries::Iterator* it);
+
     void FreeList(::openmldb::base::Node<uint64_t, DataBlock*>* node, uint64_t& gc_idx_cnt,  // NOLINT
                   uint64_t& gc_record_cnt,         // NOLINT
                   uint64_t& gc_record_byte_size);  // NOLINT
     void SplitList(KeyEntry* entry, uint64_t ts, ::openmldb::base::Node<uint64_t, DataBlock*>** node);
+    // take the rows freed by gc from the count buckets of entry
+    void RemoveOldestCount(const Slice& key, KeyEntry* entry, uint64_t cnt);
+    // the count of the rows of entry with ts greater than ts, return false if it needs a scan of more than
+    // one bucket. the caller must hold the lock of key
+    bool CountAfter(KeyEntry* entry, uint64_t ts, uint64_t* count);
 
     void GcEntryFreeList(uint64_t version, uint64_t& gc_idx_cnt,  // NOLINT
                          uint64_t& gc_record_cnt,                 // NOLINT
@@ -258,21 +684,48 @@ class Segment {
                    uint64_t& gc_record_cnt,         // NOLINT
                    uint64_t& gc_record_byte_size);  // NOLINT
 
+    void FreeRows(const std::vector<LatestEntries::Entry>& rows, uint64_t& gc_idx_cnt,  // NOLINT
+                  uint64_t& gc_record_cnt,                                          // NOLINT
+                  uint64_t& gc_record_byte_size);                                   // NOLINT
+    void GcLatestEntries(uint64_t time, uint64_t keep_cnt, TTLType ttl_type,
+                         uint64_t& gc_idx_cnt,            // NOLINT
+                         uint64_t& gc_record_cnt,         // NOLINT
+                         uint64_t& gc_record_byte_size);  // NOLINT
+
  private:
     KeyEntries* entries_;
-    // only Put need mutex
+    // the hash index of the keys in entries_, NULL if disabled
+    KeyHashIndex* key_index_;
+    // guard the insert and remove of entries_ and key_index_
     std::mutex mu_;
     std::mutex gc_mu_;
     std::atomic<uint64_t> idx_cnt_;
     std::atomic<uint64_t> idx_byte_size_;
     std::atomic<uint64_t> pk_cnt_;
-    uint8_t key_entry_max_height_;
+    std::atomic<uint8_t> key_entry_max_height_;
     KeyEntryNodeList* entry_free_list_;
     uint32_t ts_cnt_;
     std::atomic<uint64_t> gc_version_;
     std::map<uint32_t, uint32_t> ts_idx_map_;
     std::vector<std::shared_ptr<std::atomic<uint64_t>>> idx_cnt_vec_;
     uint64_t ttl_offset_;
+    DataBlockPool* block_pool_;
+    uint32_t latest_capacity_;
+    // striped locks guarding the time entries of keys
+    uint32_t key_mu_cnt_;
+    std::unique_ptr<KeyMutex[]> key_mu_;
+    // the state of incremental gc, only accessed by the gc thread
+    std::string gc_cursor_;
+    uint64_t gc_deadline_;
+    uint64_t gc_slice_key_cnt_;
+    // the entries in entry_free_list_ are keyed by epoch instead of gc_version_
+    bool use_epoch_;
+    // the time width of the count buckets of the keys, 0 if disabled
+    uint64_t count_bucket_width_;
+    // guarded by gc_mu_
+    std::deque<ColdFreeData> cold_free_list_;
+    // the cold_time of the last CompressColdRows, only accessed by the gc thread
+    uint64_t cold_time_ = 0;
 };
 
 }  // namespace storage
@@ -0,0 +1,328 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The benchmarks of the memory storage. The keys other than the ones of BM_SegmentPut are drawn from a zipf
+// distribution with a fixed seed, so the hot keys hold most of the rows as in the real workloads.
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "base/skiplist.h"
+#include "benchmark/benchmark.h"
+#include "storage/mem_table.h"
+#include "storage/segment.h"
+#include "storage/ticket.h"
+
+DECLARE_uint32(segment_key_lock_cnt);
+DECLARE_uint32(max_traverse_cnt);
+DEFINE_uint64(storage_bm_seed, 1024, "the seed of the generated keys");
+DEFINE_double(storage_bm_zipf_theta, 0.99, "the skew of the keys, 0 means uniform");
+
+namespace openmldb {
+namespace storage {
+
+static const uint32_t PUT_CNT_PER_THREAD = 20000;
+static const uint32_t KEY_CNT_PER_THREAD = 100;
+
+// range(0) is the count of writer threads and range(1) is the count of key locks,
+// one key lock behaves the same as a single put mutex of segment
+static void BM_SegmentPut(benchmark::State& state) {  // NOLINT
+    uint32_t thread_cnt = state.range(0);
+    FLAGS_segment_key_lock_cnt = state.range(1);
+    std::vector<std::vector<std::string>> keys(thread_cnt);
+    for (uint32_t i = 0; i < thread_cnt; i++) {
+        for (uint32_t k = 0; k < KEY_CNT_PER_THREAD; k++) {
+            keys[i].push_back("key" + std::to_string(i) + "_" + std::to_string(k));
+        }
+    }
+    std::string value(128, 'a');
+    for (auto _ : state) {
+        state.PauseTiming();
+        Segment* segment = new Segment(8);
+        state.ResumeTiming();
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < thread_cnt; i++) {
+            threads.emplace_back([segment, &keys, &value, i] {
+                const std::vector<std::string>& thread_keys = keys[i];
+                for (uint32_t j = 0; j < PUT_CNT_PER_THREAD; j++) {
+                    const std::string& key = thread_keys[j % KEY_CNT_PER_THREAD];
+                    segment->Put(Slice(key), j + 1, value.c_str(), value.size());
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        state.PauseTiming();
+        segment->Release();
+        delete segment;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * thread_cnt * PUT_CNT_PER_THREAD);
+}
+
+static void PutArgs(benchmark::internal::Benchmark* b) {
+    for (int64_t lock_cnt : {1, 16}) {
+        for (int64_t thread_cnt = 1; thread_cnt <= 64; thread_cnt *= 2) {
+            b->Args({thread_cnt, lock_cnt});
+        }
+    }
+}
+
+BENCHMARK(BM_SegmentPut)->Apply(PutArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// draw the ranks in [0, n) with probability proportional to 1 / (rank + 1)^theta
+class ZipfGenerator {
+ public:
+    ZipfGenerator(uint32_t n, uint64_t seed) : cdf_(n), rng_(seed), uniform_(0.0, 1.0) {
+        double sum = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            sum += 1.0 / std::pow(i + 1, FLAGS_storage_bm_zipf_theta);
+            cdf_[i] = sum;
+        }
+        for (auto& v : cdf_) {
+            v /= sum;
+        }
+    }
+
+    uint32_t Next() {
+        auto it = std::lower_bound(cdf_.begin(), cdf_.end(), uniform_(rng_));
+        return it == cdf_.end() ? cdf_.size() - 1 : it - cdf_.begin();
+    }
+
+ private:
+    std::vector<double> cdf_;
+    std::mt19937_64 rng_;
+    std::uniform_real_distribution<double> uniform_;
+};
+
+static std::vector<std::string> MakeKeys(uint32_t key_cnt) {
+    std::vector<std::string> keys;
+    keys.reserve(key_cnt);
+    for (uint32_t i = 0; i < key_cnt; i++) {
+        keys.push_back("key" + std::to_string(i));
+    }
+    return keys;
+}
+
+// put `row_cnt` rows on the zipf keys, the ts of the rows are 1, 2, 3...
+static void FillSegment(Segment* segment, const std::vector<std::string>& keys, uint64_t row_cnt,
+                        const std::string& value) {
+    ZipfGenerator gen(keys.size(), FLAGS_storage_bm_seed);
+    for (uint64_t ts = 1; ts <= row_cnt; ts++) {
+        segment->Put(Slice(keys[gen.Next()]), ts, value.c_str(), value.size());
+    }
+}
+
+static const uint32_t ZIPF_KEY_CNT = 10000;
+
+// range(0) is the count of writer threads, every thread draws the keys from its own generator
+static void BM_SegmentPutZipf(benchmark::State& state) {  // NOLINT
+    uint32_t thread_cnt = state.range(0);
+    auto keys = MakeKeys(ZIPF_KEY_CNT);
+    std::vector<std::vector<uint32_t>> ranks(thread_cnt);
+    for (uint32_t i = 0; i < thread_cnt; i++) {
+        ZipfGenerator gen(ZIPF_KEY_CNT, FLAGS_storage_bm_seed + i);
+        for (uint32_t j = 0; j < PUT_CNT_PER_THREAD; j++) {
+            ranks[i].push_back(gen.Next());
+        }
+    }
+    std::string value(128, 'a');
+    for (auto _ : state) {
+        state.PauseTiming();
+        Segment* segment = new Segment(8);
+        state.ResumeTiming();
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < thread_cnt; i++) {
+            threads.emplace_back([segment, &keys, &ranks, &value, i] {
+                for (uint32_t j = 0; j < PUT_CNT_PER_THREAD; j++) {
+                    segment->Put(Slice(keys[ranks[i][j]]), j + 1, value.c_str(), value.size());
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        state.PauseTiming();
+        segment->Release();
+        delete segment;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * thread_cnt * PUT_CNT_PER_THREAD);
+}
+BENCHMARK(BM_SegmentPutZipf)->RangeMultiplier(2)->Range(1, 64)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// NewIterator and Seek to a random ts on a zipf key, range(0) is the average rows per key
+static void BM_SegmentSeek(benchmark::State& state) {  // NOLINT
+    uint64_t rows_per_key = state.range(0);
+    const uint32_t key_cnt = 1000;
+    auto keys = MakeKeys(key_cnt);
+    Segment segment(8);
+    FillSegment(&segment, keys, key_cnt * rows_per_key, std::string(128, 'a'));
+    ZipfGenerator gen(key_cnt, FLAGS_storage_bm_seed + 1);
+    std::mt19937_64 rng(FLAGS_storage_bm_seed);
+    std::uniform_int_distribution<uint64_t> ts(1, key_cnt * rows_per_key);
+    for (auto _ : state) {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator(Slice(keys[gen.Next()]), ticket));
+        it->Seek(ts(rng));
+        benchmark::DoNotOptimize(it->Valid());
+    }
+    state.SetItemsProcessed(state.iterations());
+    segment.Release();
+}
+BENCHMARK(BM_SegmentSeek)->RangeMultiplier(10)->Range(1, 10000)->Unit(benchmark::kNanosecond);
+
+// the gc of the older half of `range(0)` rows, including the free of the removed entries
+static void BM_SegmentGc(benchmark::State& state) {  // NOLINT
+    uint64_t row_cnt = state.range(0);
+    auto keys = MakeKeys(ZIPF_KEY_CNT);
+    std::string value(128, 'a');
+    uint64_t gc_record_cnt = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Segment* segment = new Segment(8);
+        FillSegment(segment, keys, row_cnt, value);
+        uint64_t gc_idx_cnt = 0;
+        uint64_t gc_record_byte_size = 0;
+        gc_record_cnt = 0;
+        state.ResumeTiming();
+        segment->Gc4TTL(row_cnt / 2, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        segment->IncrGcVersion();
+        segment->IncrGcVersion();
+        segment->GcFreeList(gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        state.PauseTiming();
+        segment->Release();
+        delete segment;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * gc_record_cnt);
+}
+BENCHMARK(BM_SegmentGc)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+using TimeSkiplist = ::openmldb::base::Skiplist<uint64_t, uint64_t, ::openmldb::base::DefaultComparator>;
+
+// Insert on the time entries of one key, the ts are shuffled as the out of order puts
+static void BM_SkiplistInsert(benchmark::State& state) {  // NOLINT
+    uint64_t row_cnt = state.range(0);
+    std::vector<uint64_t> ts(row_cnt);
+    for (uint64_t i = 0; i < row_cnt; i++) {
+        ts[i] = i + 1;
+    }
+    std::mt19937_64 rng(FLAGS_storage_bm_seed);
+    std::shuffle(ts.begin(), ts.end(), rng);
+    for (auto _ : state) {
+        TimeSkiplist list(12, 4, ::openmldb::base::DefaultComparator());
+        for (auto& t : ts) {
+            list.Insert(t, t);
+        }
+        state.PauseTiming();
+        list.Clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * row_cnt);
+}
+BENCHMARK(BM_SkiplistInsert)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_SkiplistSeek(benchmark::State& state) {  // NOLINT
+    uint64_t row_cnt = state.range(0);
+    TimeSkiplist list(12, 4, ::openmldb::base::DefaultComparator());
+    for (uint64_t t = 1; t <= row_cnt; t++) {
+        list.Insert(t, t);
+    }
+    std::mt19937_64 rng(FLAGS_storage_bm_seed);
+    std::uniform_int_distribution<uint64_t> ts(1, row_cnt);
+    std::unique_ptr<TimeSkiplist::Iterator> it(list.NewIterator());
+    for (auto _ : state) {
+        it->Seek(ts(rng));
+        benchmark::DoNotOptimize(it->Valid());
+    }
+    state.SetItemsProcessed(state.iterations());
+    list.Clear();
+}
+BENCHMARK(BM_SkiplistSeek)->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kNanosecond);
+
+// a table of one index with `row_cnt` rows on the zipf keys
+static std::unique_ptr<MemTable> MakeTable(uint64_t row_cnt, const std::string& value) {
+    std::map<std::string, uint32_t> mapping = {{"idx0", 0}};
+    std::unique_ptr<MemTable> table(new MemTable("storage_bm", 1, 1, 8, mapping, 0, ::openmldb::type::kAbsoluteTime));
+    table->Init();
+    auto keys = MakeKeys(ZIPF_KEY_CNT);
+    ZipfGenerator gen(ZIPF_KEY_CNT, FLAGS_storage_bm_seed);
+    for (uint64_t ts = 1; ts <= row_cnt; ts++) {
+        table->Put(keys[gen.Next()], ts, value.c_str(), value.size());
+    }
+    return table;
+}
+
+// traverse all the rows of the table
+static void BM_MemTableTraverse(benchmark::State& state) {  // NOLINT
+    uint64_t row_cnt = state.range(0);
+    FLAGS_max_traverse_cnt = std::max<uint64_t>(FLAGS_max_traverse_cnt, row_cnt * 2);
+    auto table = MakeTable(row_cnt, std::string(128, 'a'));
+    for (auto _ : state) {
+        std::unique_ptr<TraverseIterator> it(table->NewTraverseIterator(0));
+        uint64_t cnt = 0;
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            benchmark::DoNotOptimize(it->GetValue());
+            cnt++;
+        }
+        if (cnt != row_cnt) {
+            state.SkipWithError("the count of traversed rows mismatches");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * row_cnt);
+}
+BENCHMARK(BM_MemTableTraverse)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// the bytes of memory counted by the table for each row, range(0) is the size of the value
+static void BM_MemTableBytesPerRow(benchmark::State& state) {  // NOLINT
+    const uint64_t row_cnt = 100000;
+    std::string value(state.range(0), 'a');
+    double record_bytes = 0;
+    double idx_bytes = 0;
+    for (auto _ : state) {
+        auto table = MakeTable(row_cnt, value);
+        state.PauseTiming();
+        record_bytes = static_cast<double>(table->GetRecordByteSize()) / row_cnt;
+        idx_bytes = static_cast<double>(table->GetRecordIdxByteSize()) / row_cnt;
+        table.reset();
+        state.ResumeTiming();
+    }
+    state.counters["record_bytes_per_row"] = record_bytes;
+    state.counters["idx_bytes_per_row"] = idx_bytes;
+    state.SetItemsProcessed(state.iterations() * row_cnt);
+}
+BENCHMARK(BM_MemTableBytesPerRow)->Arg(32)->Arg(128)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::google::ParseCommandLineFlags(&argc, &argv, true);
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    ::benchmark::RunSpecifiedBenchmarks();
+}
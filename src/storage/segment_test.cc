@@ -17,15 +17,22 @@
 #include "storage/segment.h"
 
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "base/glog_wapper.h"  // NOLINT
 #include "base/slice.h"
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "storage/record.h"
 
 using ::openmldb::base::Slice;
 
+DECLARE_bool(gc_enable_epoch_reclaim);
+DECLARE_uint32(count_bucket_width);
+
 namespace openmldb {
 namespace storage {
 
@@ -36,7 +43,11 @@ class SegmentTest : public ::testing::Test {
 };
 
 TEST_F(SegmentTest, Size) {
+#ifdef SNAPSHOT_READ_ENABLE
+    ASSERT_EQ(24, (int64_t)sizeof(DataBlock));
+#else
     ASSERT_EQ(16, (int64_t)sizeof(DataBlock));
+#endif
     ASSERT_EQ(40, (int64_t)sizeof(KeyEntry));
 }
 
@@ -51,6 +62,21 @@ TEST_F(SegmentTest, DataBlock) {
     delete db;
 }
 
+TEST_F(SegmentTest, ColdData) {
+    // a raw row starting with the byte of a cold row is not taken as cold
+    const char raw[] = "\x82raw";
+    DataBlock* db = new DataBlock(1, raw, 4);
+    ASSERT_FALSE(IsColdData(db->data));
+    char* cold = new char[4];
+    memcpy(cold, raw, 4);
+    delete[] db->data;
+    db->data = TagColdData(cold);
+    ASSERT_TRUE(IsColdData(db->data));
+    ASSERT_EQ(cold, UntagColdData(db->data));
+    // the tagged data is freed by the block
+    delete db;
+}
+
 TEST_F(SegmentTest, PutAndGet) {
     Segment segment;
     const char* test = "test";
@@ -125,6 +151,36 @@ TEST_F(SegmentTest, Delete) {
     ASSERT_EQ(84, (int64_t)gc_record_byte_size);
 }
 
+TEST_F(SegmentTest, DeleteWithEpochReclaim) {
+    FLAGS_gc_enable_epoch_reclaim = true;
+    Segment segment;
+    FLAGS_gc_enable_epoch_reclaim = false;
+    Slice pk("test1");
+    std::string value = "test0";
+    segment.Put(pk, 9527, value.c_str(), value.size());
+    segment.Put(pk, 9528, value.c_str(), value.size());
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator(pk, ticket));
+        it->SeekToFirst();
+        ASSERT_TRUE(segment.Delete(pk));
+        // the reader may still see the deleted entry
+        segment.GcFreeList(gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        ASSERT_EQ(0, (int64_t)gc_idx_cnt);
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ(9528, (int64_t)it->GetKey());
+        ASSERT_EQ(1, (int64_t)segment.GetPkCnt());
+    }
+    // no gc version is needed once the reader is gone
+    segment.GcFreeList(gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(2, (int64_t)gc_idx_cnt);
+    ASSERT_EQ(2, (int64_t)gc_record_cnt);
+    ASSERT_EQ(0, (int64_t)segment.GetPkCnt());
+}
+
 TEST_F(SegmentTest, GetCount) {
     Segment segment;
     Slice pk("test1");
@@ -175,6 +231,68 @@ TEST_F(SegmentTest, GetCount) {
     ASSERT_EQ(1, (int64_t)count);
 }
 
+TEST_F(SegmentTest, GetUnexpiredCount) {
+    Slice pk("pk");
+    uint64_t count = 0;
+    Segment no_bucket;
+    for (uint64_t ts = 1; ts <= 100; ts++) {
+        no_bucket.Put(pk, ts, "test", 4);
+    }
+    ASSERT_EQ(0, no_bucket.GetUnexpiredCount(pk, 0, 0, 0, TTLType::kAbsoluteTime, &count));
+    ASSERT_EQ(100u, count);
+    // the expired rows not freed by gc yet need a scan
+    ASSERT_EQ(-2, no_bucket.GetUnexpiredCount(pk, 0, 55, 0, TTLType::kAbsoluteTime, &count));
+
+    FLAGS_count_bucket_width = 10;
+    Segment segment;
+    FLAGS_count_bucket_width = 0;
+    ASSERT_EQ(-1, segment.GetUnexpiredCount(pk, 0, 0, 0, TTLType::kAbsoluteTime, &count));
+    for (uint64_t ts = 1; ts <= 100; ts++) {
+        // some rows are put out of time order
+        segment.Put(pk, ts % 7 == 0 ? 101 - ts : ts, "test", 4);
+    }
+    auto scan_count = [&](uint64_t expire_time) {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator(pk, ticket));
+        uint64_t cnt = 0;
+        for (it->SeekToFirst(); it->Valid() && it->GetKey() > expire_time; it->Next()) {
+            cnt++;
+        }
+        return cnt;
+    };
+    for (uint64_t expire_time = 0; expire_time <= 110; expire_time += 3) {
+        ASSERT_EQ(0, segment.GetUnexpiredCount(pk, 0, expire_time, 0, TTLType::kAbsoluteTime, &count));
+        ASSERT_EQ(scan_count(expire_time), count) << expire_time;
+    }
+    uint64_t live_cnt = scan_count(55);
+    ASSERT_EQ(0, segment.GetUnexpiredCount(pk, 0, 0, 30, TTLType::kLatestTime, &count));
+    ASSERT_EQ(30u, count);
+    ASSERT_EQ(0, segment.GetUnexpiredCount(pk, 0, 55, 30, TTLType::kAbsOrLat, &count));
+    ASSERT_EQ(30u, count);
+    ASSERT_EQ(0, segment.GetUnexpiredCount(pk, 0, 55, 80, TTLType::kAbsOrLat, &count));
+    ASSERT_EQ(live_cnt, count);
+    ASSERT_EQ(0, segment.GetUnexpiredCount(pk, 0, 55, 30, TTLType::kAbsAndLat, &count));
+    ASSERT_EQ(live_cnt, count);
+    ASSERT_EQ(0, segment.GetUnexpiredCount(pk, 0, 55, 80, TTLType::kAbsAndLat, &count));
+    ASSERT_EQ(80u, count);
+
+    // the rows freed by gc are taken from the oldest buckets
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    segment.Gc4TTL(55, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    for (uint64_t expire_time = 0; expire_time <= 110; expire_time += 3) {
+        ASSERT_EQ(0, segment.GetUnexpiredCount(pk, 0, expire_time, 0, TTLType::kAbsoluteTime, &count));
+        ASSERT_EQ(scan_count(expire_time), count) << expire_time;
+    }
+    segment.Gc4Head(10, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    for (uint64_t expire_time = 0; expire_time <= 110; expire_time += 3) {
+        ASSERT_EQ(0, segment.GetUnexpiredCount(pk, 0, expire_time, 0, TTLType::kAbsoluteTime, &count));
+        ASSERT_EQ(scan_count(expire_time), count) << expire_time;
+    }
+    ASSERT_EQ(10u, scan_count(0));
+}
+
 TEST_F(SegmentTest, Iterator) {
     Segment segment;
     Slice pk("test1");
@@ -250,6 +368,229 @@ TEST_F(SegmentTest, TestGc4TTL) {
     ASSERT_EQ(2 * GetRecordSize(5), (int64_t)gc_record_byte_size);
 }
 
+TEST_F(SegmentTest, ExecuteGcSlice) {
+    Segment segment(8);
+    const uint32_t key_cnt = 1000;
+    for (uint32_t i = 0; i < key_cnt; i++) {
+        std::string key = "pk" + std::to_string(i);
+        segment.Put(Slice(key), 9768, "test1", 5);
+        segment.Put(Slice(key), 9769, "test2", 5);
+    }
+    TTLSt ttl_st(0, 1, ::openmldb::storage::TTLType::kLatestTime);
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    uint32_t slice_cnt = 0;
+    bool finished = false;
+    while (!finished) {
+        // the budget always runs out, so each slice stops at the first deadline check
+        finished = segment.ExecuteGcSlice(ttl_st, 1, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        slice_cnt++;
+        ASSERT_LE(slice_cnt, key_cnt);
+    }
+    ASSERT_GT(slice_cnt, 1u);
+    ASSERT_EQ(key_cnt, gc_idx_cnt);
+    ASSERT_EQ(key_cnt, gc_record_cnt);
+    ASSERT_EQ(key_cnt, segment.GetIdxCnt());
+    // the next round starts from the first key again
+    gc_idx_cnt = 0;
+    ASSERT_TRUE(segment.ExecuteGcSlice(ttl_st, 0, gc_idx_cnt, gc_record_cnt, gc_record_byte_size));
+    ASSERT_EQ(0u, gc_idx_cnt);
+}
+
+TEST_F(SegmentTest, ConcurrentPut) {
+    Segment segment(8);
+    const uint32_t thread_cnt = 8;
+    const uint32_t key_cnt = 100;
+    const uint64_t row_cnt = 50;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < thread_cnt; i++) {
+        threads.emplace_back([&segment, i, key_cnt, row_cnt] {
+            for (uint64_t ts = 1; ts <= row_cnt; ts++) {
+                for (uint32_t k = 0; k < key_cnt; k++) {
+                    std::string key = "pk" + std::to_string(k) + "_" + std::to_string(i % 2);
+                    std::string value = "value" + std::to_string(ts);
+                    segment.Put(Slice(key), ts * thread_cnt + i, value.c_str(), value.size());
+                }
+            }
+        });
+    }
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    for (uint32_t i = 0; i < 10; i++) {
+        segment.Gc4Head(row_cnt * thread_cnt, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(0, (int64_t)gc_idx_cnt);
+    ASSERT_EQ(key_cnt * 2, segment.GetPkCnt());
+    ASSERT_EQ(thread_cnt * key_cnt * row_cnt, segment.GetIdxCnt());
+    for (uint32_t k = 0; k < key_cnt; k++) {
+        std::string key = "pk" + std::to_string(k) + "_0";
+        uint64_t count = 0;
+        ASSERT_EQ(0, segment.GetCount(Slice(key), count));
+        ASSERT_EQ(thread_cnt / 2 * row_cnt, count);
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator(Slice(key), ticket));
+        it->SeekToFirst();
+        uint64_t last_ts = UINT64_MAX;
+        uint64_t cnt = 0;
+        while (it->Valid()) {
+            ASSERT_LT(it->GetKey(), last_ts);
+            last_ts = it->GetKey();
+            cnt++;
+            it->Next();
+        }
+        ASSERT_EQ(count, cnt);
+    }
+}
+
+TEST_F(SegmentTest, LatestEntries) {
+    Segment segment(8);
+    ASSERT_TRUE(segment.EnableLatestEntries(2));
+    ASSERT_TRUE(segment.IsLatestEntries());
+    Slice pk("pk");
+    // out of order and duplicate ts
+    segment.Put(pk, 9768, "test1", 5);
+    segment.Put(pk, 9770, "test3", 5);
+    segment.Put(pk, 9769, "test2", 5);
+    segment.Put(pk, 9770, "test4", 5);
+    segment.Put(pk, 9766, "test0", 5);
+    ASSERT_FALSE(segment.EnableLatestEntries(2));
+    ASSERT_EQ(1, (int64_t)segment.GetPkCnt());
+    ASSERT_EQ(5, (int64_t)segment.GetIdxCnt());
+    uint64_t count = 0;
+    ASSERT_EQ(0, segment.GetCount(pk, count));
+    ASSERT_EQ(5, (int64_t)count);
+    DataBlock* db = NULL;
+    ASSERT_TRUE(segment.Get(pk, 9769, &db));
+    ASSERT_EQ("test2", std::string(db->data, db->size));
+    ASSERT_TRUE(segment.Get(pk, 9767, &db));
+    ASSERT_TRUE(db == NULL);
+    Ticket ticket;
+    std::unique_ptr<MemTableIterator> it(segment.NewIterator(pk, ticket));
+    it->SeekToFirst();
+    std::vector<std::string> expect = {"test4", "test3", "test2", "test1", "test0"};
+    std::vector<uint64_t> expect_ts = {9770, 9770, 9769, 9768, 9766};
+    for (size_t i = 0; i < expect.size(); i++) {
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ(expect_ts[i], it->GetKey());
+        ASSERT_EQ(expect[i], it->GetValue().ToString());
+        it->Next();
+    }
+    ASSERT_FALSE(it->Valid());
+    it->Seek(9767);
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ(9766, (int64_t)it->GetKey());
+    it->Seek(9769);
+    ASSERT_EQ("test2", it->GetValue().ToString());
+    it->SeekToLast();
+    ASSERT_EQ(9766, (int64_t)it->GetKey());
+}
+
+TEST_F(SegmentTest, LatestEntriesGc) {
+    Segment segment(8);
+    ASSERT_TRUE(segment.EnableLatestEntries(4));
+    for (int i = 0; i < 20; i++) {
+        segment.Put("PK", 9760 + i, "test1", 5);
+        segment.Put("PK1", 9760 + i, "test2", 5);
+    }
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    {
+        // the entry referenced by reader is skipped
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator("PK", ticket));
+        segment.Gc4Head(3, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        ASSERT_EQ(17, (int64_t)gc_idx_cnt);
+        it->SeekToFirst();
+        int size = 0;
+        while (it->Valid()) {
+            size++;
+            it->Next();
+        }
+        ASSERT_EQ(20, size);
+    }
+    segment.Gc4Head(3, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(34, (int64_t)gc_idx_cnt);
+    ASSERT_EQ(34, (int64_t)gc_record_cnt);
+    ASSERT_EQ(34 * GetRecordSize(5), (int64_t)gc_record_byte_size);
+    ASSERT_EQ(6, (int64_t)segment.GetIdxCnt());
+    // 9777 9778 9779 are left
+    segment.Gc4TTLAndHead(9778, 2, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(36, (int64_t)gc_idx_cnt);
+    segment.Gc4TTLOrHead(9778, 2, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(38, (int64_t)gc_idx_cnt);
+    ASSERT_EQ(2, (int64_t)segment.GetPkCnt());
+    segment.Gc4TTL(9779, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(40, (int64_t)gc_idx_cnt);
+    ASSERT_EQ(0, (int64_t)segment.GetIdxCnt());
+    // the empty key is removed by gc with ttl
+    Ticket ticket;
+    std::unique_ptr<MemTableIterator> it(segment.NewIterator("PK", ticket));
+    it->SeekToFirst();
+    ASSERT_FALSE(it->Valid());
+    segment.IncrGcVersion();
+    segment.IncrGcVersion();
+    segment.IncrGcVersion();
+    segment.GcFreeList(gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(0, (int64_t)segment.GetPkCnt());
+}
+
+TEST_F(SegmentTest, DataBlockPool) {
+    DataBlockPool pool;
+    ASSERT_TRUE(pool.Alloc(0) == NULL);
+    ASSERT_TRUE(pool.Alloc(DataBlockPool::kMaxPooledSize + 1) == NULL);
+    char* first = pool.Alloc(5);
+    ASSERT_TRUE(first != NULL);
+    ASSERT_EQ(DataBlockPool::kAlignSize, pool.GetUsedByteSize());
+    ASSERT_EQ(1u, pool.GetSlabCnt());
+    pool.Free(first, 5);
+    ASSERT_EQ(0u, pool.GetUsedByteSize());
+    // the freed chunk is reused by the same size class
+    ASSERT_EQ(first, pool.Alloc(16));
+    char* large = pool.Alloc(1000);
+    ASSERT_TRUE(large != NULL);
+    ASSERT_NE(first, large);
+    ASSERT_EQ(2u, pool.GetSlabCnt());
+    DataBlock block(1, "test", 4, &pool);
+    ASSERT_TRUE(block.pooled);
+    DataBlock big_block(1, std::string(DataBlockPool::kMaxPooledSize + 1, 'a').c_str(),
+                        DataBlockPool::kMaxPooledSize + 1, &pool);
+    ASSERT_FALSE(big_block.pooled);
+    pool.Free(block.data, block.size);
+}
+
+TEST_F(SegmentTest, Gc4TTLWithDataBlockPool) {
+    DataBlockPool pool;
+    Segment segment;
+    segment.SetDataBlockPool(&pool);
+    for (int i = 0; i < 100; i++) {
+        segment.Put("PK", 9700 + i, "test1", 5);
+        segment.Put("PK1", 9700 + i, "test2", 5);
+    }
+    ASSERT_EQ(200 * DataBlockPool::kAlignSize, pool.GetUsedByteSize());
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    segment.Gc4TTL(9749, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(100, (int64_t)gc_record_cnt);
+    ASSERT_EQ(100 * DataBlockPool::kAlignSize, pool.GetUsedByteSize());
+    uint64_t slab_cnt = pool.GetSlabCnt();
+    for (int i = 0; i < 50; i++) {
+        segment.Put("PK2", 9800 + i, "test3", 5);
+    }
+    // new puts are served by the chunks freed by gc
+    ASSERT_EQ(slab_cnt, pool.GetSlabCnt());
+    segment.Gc4Head(1, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(3 * DataBlockPool::kAlignSize, pool.GetUsedByteSize());
+    segment.Release();
+    ASSERT_EQ(0u, pool.GetUsedByteSize());
+}
+
 TEST_F(SegmentTest, TestGc4TTLAndHead) {
     Segment segment;
     segment.Put("PK1", 9766, "test1", 5);
@@ -369,6 +710,43 @@ TEST_F(SegmentTest, TestStat) {
     ASSERT_EQ(0, (int64_t)segment.GetIdxCnt());
 }
 
+TEST_F(SegmentTest, CollectMemStat) {
+    // two indexes sharing the rows
+    Segment segment1;
+    Segment segment2;
+    for (int i = 0; i < 10; i++) {
+        auto* block = new DataBlock(2, "test12", 6);
+        segment1.Put(Slice("pk" + std::to_string(i % 2)), 9760 + i, block);
+        segment2.Put(Slice("key" + std::to_string(i % 5)), 9760 + i, block);
+    }
+    IndexMemStat stat1;
+    segment1.CollectMemStat(0, &stat1);
+    ASSERT_EQ(2u, stat1.key_cnt);
+    ASSERT_EQ(10u, stat1.record_cnt);
+    ASSERT_EQ(6u, stat1.key_byte_size);
+    ASSERT_EQ(10u * GetRecordSize(6), stat1.payload_byte_size);
+    ASSERT_EQ(5u * GetRecordSize(6), stat1.shared_payload_byte_size);
+    ASSERT_EQ(0u, stat1.fragment_byte_size);
+    ASSERT_EQ(segment1.GetIdxByteSize(),
+              stat1.key_byte_size + stat1.key_node_byte_size + stat1.row_node_byte_size);
+    IndexMemStat stat2;
+    segment2.CollectMemStat(0, &stat2);
+    ASSERT_EQ(5u, stat2.key_cnt);
+    ASSERT_EQ(stat1.payload_byte_size, stat2.payload_byte_size);
+    // the shares of the indexes sum up to the payload of the rows
+    ASSERT_EQ(stat1.payload_byte_size, stat1.shared_payload_byte_size + stat2.shared_payload_byte_size);
+    ASSERT_EQ(segment2.GetIdxByteSize(),
+              stat2.key_byte_size + stat2.key_node_byte_size + stat2.row_node_byte_size);
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    // the rows left only in segment2 are not shared any more
+    segment1.Gc4TTL(9770, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    stat2 = IndexMemStat();
+    segment2.CollectMemStat(0, &stat2);
+    ASSERT_EQ(stat2.payload_byte_size, stat2.shared_payload_byte_size);
+}
+
 TEST_F(SegmentTest, GetTsIdx) {
     std::vector<uint32_t> ts_idx_vec = {1, 3, 5};
     Segment segment(8, ts_idx_vec);
@@ -407,6 +785,83 @@ TEST_F(SegmentTest, PutAndGetTS) {
     ASSERT_EQ(e, t);
 }
 
+TEST_F(SegmentTest, KeyHashIndex) {
+    KeyHashIndex index(4);
+    std::vector<std::string> keys;
+    // the index refers to the memory of keys
+    keys.reserve(100);
+    for (int i = 0; i < 100; i++) {
+        keys.push_back("key" + std::to_string(i));
+        index.Insert(keys.back(), &keys.back(), 1);
+    }
+    ASSERT_EQ(100, (int64_t)index.GetSize());
+    // resized on the load factor
+    ASSERT_EQ(64, (int64_t)index.GetBucketCnt());
+    void* value = NULL;
+    ASSERT_TRUE(index.Get("key42", &value));
+    ASSERT_EQ(&keys[42], value);
+    ASSERT_FALSE(index.Get("key100", &value));
+    ASSERT_TRUE(index.Remove("key42", 2));
+    ASSERT_FALSE(index.Remove("key42", 2));
+    ASSERT_FALSE(index.Get("key42", &value));
+    ASSERT_TRUE(index.Get("key43", &value));
+    ASSERT_EQ(99, (int64_t)index.GetSize());
+    index.Gc(2);
+    index.Gc(3);
+    ASSERT_TRUE(index.Get("key0", &value));
+    index.Clear();
+    ASSERT_EQ(0, (int64_t)index.GetSize());
+    ASSERT_FALSE(index.Get("key0", &value));
+}
+
+TEST_F(SegmentTest, EnableKeyHashIndex) {
+    std::vector<uint32_t> ts_idx_vec = {1, 3};
+    Segment segment(8, ts_idx_vec);
+    ASSERT_TRUE(segment.EnableKeyHashIndex(2));
+    ASSERT_TRUE(segment.IsKeyHashIndex());
+    ASSERT_FALSE(segment.EnableKeyHashIndex(2));
+    std::map<int32_t, uint64_t> ts_map = {{1, 1000}, {3, 2000}};
+    for (int i = 0; i < 50; i++) {
+        std::string pk = "pk" + std::to_string(i);
+        segment.Put(pk, ts_map, new DataBlock(2, "test1", 5));
+    }
+    ASSERT_EQ(50, (int64_t)segment.GetPkCnt());
+    DataBlock* result = NULL;
+    ASSERT_TRUE(segment.Get("pk7", 3, 2000, &result));
+    ASSERT_EQ("test1", std::string(result->data, result->size));
+    ASSERT_FALSE(segment.Get("pk50", 3, 2000, &result));
+    uint64_t count = 0;
+    ASSERT_EQ(0, segment.GetCount("pk7", 1, count));
+    ASSERT_EQ(1, (int64_t)count);
+    {
+        Ticket ticket;
+        std::unique_ptr<MemTableIterator> it(segment.NewIterator("pk9", 1, ticket));
+        it->SeekToFirst();
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ(1000, (int64_t)it->GetKey());
+    }
+    // the keys are removed from the hash index by gc
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    std::map<uint32_t, TTLSt> ttl_st_map;
+    // the abs_ttl is the expire time here
+    ttl_st_map.emplace(1, TTLSt(3000, 0, ::openmldb::storage::kAbsoluteTime));
+    ttl_st_map.emplace(3, TTLSt(3000, 0, ::openmldb::storage::kAbsoluteTime));
+    segment.ExecuteGc(ttl_st_map, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(100, (int64_t)gc_idx_cnt);
+    ASSERT_FALSE(segment.Get("pk7", 3, 2000, &result));
+    ASSERT_EQ(-1, segment.GetCount("pk7", 1, count));
+    segment.Put("pk7", ts_map, new DataBlock(2, "test2", 5));
+    ASSERT_TRUE(segment.Get("pk7", 3, 2000, &result));
+    ASSERT_EQ("test2", std::string(result->data, result->size));
+    segment.IncrGcVersion();
+    segment.IncrGcVersion();
+    segment.IncrGcVersion();
+    segment.GcFreeList(gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(1, (int64_t)segment.GetPkCnt());
+}
+
 }  // namespace storage
 }  // namespace openmldb
 
@@ -0,0 +1,333 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/sliding_aggregator.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/glog_wapper.h"
+#include "boost/algorithm/string.hpp"
+
+namespace openmldb {
+namespace storage {
+
+SlidingAggregator::SlidingAggregator(const ::openmldb::api::TableMeta& base_meta, uint32_t index_pos,
+                                     const std::string& aggr_col, AggrType aggr_type, const std::string& ts_col,
+                                     int64_t window_range)
+    : base_table_schema_(base_meta.column_desc()),
+      base_row_view_(base_table_schema_),
+      index_pos_(index_pos),
+      aggr_col_(aggr_col),
+      aggr_type_(aggr_type),
+      ts_col_(ts_col),
+      window_range_(window_range),
+      aggr_col_idx_(-1),
+      ts_col_idx_(-1),
+      aggr_col_type_(DataType::kBigInt),
+      ts_col_type_(DataType::kBigInt),
+      is_float_(false) {
+    for (int i = 0; i < base_meta.column_desc().size(); i++) {
+        if (base_meta.column_desc(i).name() == aggr_col_) {
+            aggr_col_idx_ = i;
+            aggr_col_type_ = base_meta.column_desc(i).data_type();
+        }
+        if (base_meta.column_desc(i).name() == ts_col_) {
+            ts_col_idx_ = i;
+            ts_col_type_ = base_meta.column_desc(i).data_type();
+        }
+    }
+    is_float_ = aggr_col_type_ == DataType::kFloat || aggr_col_type_ == DataType::kDouble;
+}
+
+bool SlidingAggregator::Init(std::shared_ptr<Table> table) {
+    if (ts_col_idx_ == -1 || (ts_col_type_ != DataType::kBigInt && ts_col_type_ != DataType::kTimestamp)) {
+        PDLOG(WARNING, "ts_col %s is not found or is not bigint/timestamp", ts_col_.c_str());
+        return false;
+    }
+    if (aggr_col_idx_ == -1) {
+        // only count(*) has no aggr col
+        if (aggr_type_ != AggrType::kCount) {
+            PDLOG(WARNING, "aggr_col %s is not found", aggr_col_.c_str());
+            return false;
+        }
+    } else if (aggr_type_ != AggrType::kCount) {
+        switch (aggr_col_type_) {
+            case DataType::kSmallInt:
+            case DataType::kInt:
+            case DataType::kBigInt:
+            case DataType::kTimestamp:
+            case DataType::kFloat:
+            case DataType::kDouble:
+                break;
+            default:
+                PDLOG(WARNING, "unsupported aggr_col type %s", DataType_Name(aggr_col_type_).c_str());
+                return false;
+        }
+    }
+    if (!table) {
+        return true;
+    }
+    // the rows of a key are iterated from the newest, only the last window of them is needed
+    std::unique_ptr<TraverseIterator> it(table->NewTraverseIterator(index_pos_));
+    if (!it) {
+        PDLOG(WARNING, "fail to traverse index %u of table %u", index_pos_, table->GetId());
+        return false;
+    }
+    it->SeekToFirst();
+    std::vector<std::string> rows;
+    while (it->Valid()) {
+        std::string pk = it->GetPK();
+        int64_t bound = static_cast<int64_t>(it->GetKey()) - window_range_;
+        rows.clear();
+        while (it->Valid() && it->GetPK() == pk) {
+            if (static_cast<int64_t>(it->GetKey()) < bound) {
+                it->NextPK();
+                break;
+            }
+            rows.emplace_back(it->GetValue().data(), it->GetValue().size());
+            it->Next();
+        }
+        for (auto rit = rows.rbegin(); rit != rows.rend(); ++rit) {
+            if (!Update(pk, *rit)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool SlidingAggregator::ParseRow(const std::string& row, SlidingValue* value) const {
+    const int8_t* row_ptr = reinterpret_cast<const int8_t*>(row.c_str());
+    if (base_row_view_.IsNULL(row_ptr, ts_col_idx_) ||
+        base_row_view_.GetValue(row_ptr, ts_col_idx_, ts_col_type_, &value->ts) != 0) {
+        PDLOG(WARNING, "fail to get ts of the row");
+        return false;
+    }
+    value->lval = 0;
+    value->dval = 0;
+    if (aggr_col_idx_ == -1) {
+        value->is_null = false;
+        return true;
+    }
+    value->is_null = base_row_view_.IsNULL(row_ptr, aggr_col_idx_);
+    if (value->is_null || aggr_type_ == AggrType::kCount) {
+        return true;
+    }
+    switch (aggr_col_type_) {
+        case DataType::kSmallInt: {
+            int16_t val;
+            base_row_view_.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            value->lval = val;
+            break;
+        }
+        case DataType::kInt: {
+            int32_t val;
+            base_row_view_.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            value->lval = val;
+            break;
+        }
+        case DataType::kTimestamp:
+        case DataType::kBigInt: {
+            base_row_view_.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &value->lval);
+            break;
+        }
+        case DataType::kFloat: {
+            float val;
+            base_row_view_.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            value->dval = val;
+            break;
+        }
+        case DataType::kDouble: {
+            base_row_view_.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &value->dval);
+            break;
+        }
+        default: {
+            PDLOG(WARNING, "unsupported aggr_col type %s", DataType_Name(aggr_col_type_).c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SlidingAggregator::Prefer(const SlidingValue& a, const SlidingValue& b) const {
+    if (aggr_type_ == AggrType::kMin) {
+        return is_float_ ? a.dval <= b.dval : a.lval <= b.lval;
+    }
+    return is_float_ ? a.dval >= b.dval : a.lval >= b.lval;
+}
+
+void SlidingAggregator::PushExtreme(SlidingState* state, const SlidingValue& value) const {
+    if (value.is_null) {
+        return;
+    }
+    // the older values which are not better than the new one never become the result
+    while (!state->extremes.empty() && Prefer(value, state->extremes.back())) {
+        state->extremes.pop_back();
+    }
+    state->extremes.push_back(value);
+}
+
+void SlidingAggregator::AddValue(SlidingState* state, const SlidingValue& value) const {
+    if (!state->values.empty() && value.ts < state->values.back().ts) {
+        // put out of order, the min/max deque is rebuilt
+        auto pos = std::upper_bound(state->values.begin(), state->values.end(), value.ts,
+                                    [](int64_t ts, const SlidingValue& v) { return ts < v.ts; });
+        state->values.insert(pos, value);
+        if (aggr_type_ == AggrType::kMin || aggr_type_ == AggrType::kMax) {
+            state->extremes.clear();
+            for (const auto& v : state->values) {
+                PushExtreme(state, v);
+            }
+        }
+    } else {
+        state->values.push_back(value);
+        if (aggr_type_ == AggrType::kMin || aggr_type_ == AggrType::kMax) {
+            PushExtreme(state, value);
+        }
+    }
+    if (!value.is_null) {
+        state->non_null_cnt++;
+        state->lsum += value.lval;
+        state->dsum += value.dval;
+    }
+}
+
+void SlidingAggregator::Evict(SlidingState* state, int64_t bound) const {
+    if (bound <= state->evict_ts) {
+        return;
+    }
+    state->evict_ts = bound;
+    while (!state->values.empty() && state->values.front().ts < bound) {
+        const auto& value = state->values.front();
+        if (!value.is_null) {
+            state->non_null_cnt--;
+            state->lsum -= value.lval;
+            state->dsum -= value.dval;
+        }
+        state->values.pop_front();
+    }
+    while (!state->extremes.empty() && state->extremes.front().ts < bound) {
+        state->extremes.pop_front();
+    }
+    if (state->values.empty()) {
+        // drop the rounding error of the float sum
+        state->non_null_cnt = 0;
+        state->lsum = 0;
+        state->dsum = 0;
+    }
+}
+
+bool SlidingAggregator::Update(const std::string& key, const std::string& row) {
+    SlidingValue value;
+    if (!ParseRow(row, &value)) {
+        return false;
+    }
+    SlidingState* state;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = states_.find(key);
+        if (it == states_.end()) {
+            it = states_.emplace(key, std::make_unique<SlidingState>()).first;
+        }
+        state = it->second.get();
+    }
+    std::lock_guard<std::mutex> lock(state->mu);
+    if (value.ts < state->evict_ts) {
+        // it is out of every window the state can still answer
+        return true;
+    }
+    AddValue(state, value);
+    Evict(state, state->values.back().ts - window_range_);
+    return true;
+}
+
+bool SlidingAggregator::Get(const std::string& key, int64_t ts, SlidingAggrResult* result) {
+    *result = SlidingAggrResult();
+    SlidingState* state;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = states_.find(key);
+        if (it == states_.end()) {
+            return true;
+        }
+        state = it->second.get();
+    }
+    std::lock_guard<std::mutex> lock(state->mu);
+    int64_t bound = ts - window_range_;
+    if ((!state->values.empty() && ts < state->values.back().ts) || bound < state->evict_ts) {
+        return false;
+    }
+    Evict(state, bound);
+    result->cnt = state->non_null_cnt;
+    switch (aggr_type_) {
+        case AggrType::kSum: {
+            result->lval = state->lsum;
+            result->dval = state->dsum;
+            break;
+        }
+        case AggrType::kCount: {
+            result->lval = state->non_null_cnt;
+            break;
+        }
+        case AggrType::kAvg: {
+            if (state->non_null_cnt > 0) {
+                result->dval = (is_float_ ? state->dsum : static_cast<double>(state->lsum)) / state->non_null_cnt;
+            }
+            break;
+        }
+        case AggrType::kMin:
+        case AggrType::kMax: {
+            if (!state->extremes.empty()) {
+                result->lval = state->extremes.front().lval;
+                result->dval = state->extremes.front().dval;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<SlidingAggregator> CreateSlidingAggregator(const ::openmldb::api::TableMeta& base_meta,
+                                                           uint32_t index_pos, const std::string& aggr_col,
+                                                           const std::string& aggr_func, const std::string& ts_col,
+                                                           int64_t window_range) {
+    std::string aggr_type = boost::to_lower_copy(aggr_func);
+    AggrType type;
+    if (aggr_type == "sum") {
+        type = AggrType::kSum;
+    } else if (aggr_type == "min") {
+        type = AggrType::kMin;
+    } else if (aggr_type == "max") {
+        type = AggrType::kMax;
+    } else if (aggr_type == "count") {
+        type = AggrType::kCount;
+    } else if (aggr_type == "avg") {
+        type = AggrType::kAvg;
+    } else {
+        PDLOG(ERROR, "Unsupported sliding aggregate function %s", aggr_func.c_str());
+        return std::shared_ptr<SlidingAggregator>();
+    }
+    if (window_range <= 0) {
+        PDLOG(ERROR, "invalid window range %ld", window_range);
+        return std::shared_ptr<SlidingAggregator>();
+    }
+    return std::make_shared<SlidingAggregator>(base_meta, index_pos, aggr_col, type, ts_col, window_range);
+}
+
+}  // namespace storage
+}  // namespace openmldb
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_SLIDING_AGGREGATOR_H_
+#define SRC_STORAGE_SLIDING_AGGREGATOR_H_
+
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "codec/codec.h"
+#include "proto/tablet.pb.h"
+#include "storage/aggregator.h"
+#include "storage/table.h"
+
+namespace openmldb {
+namespace storage {
+
+struct SlidingAggrResult {
+    // the number of the non-null values in the window, or all rows for count(*)
+    int64_t cnt = 0;
+    // the result of the integer columns and count
+    int64_t lval = 0;
+    // the result of the float columns and avg
+    double dval = 0;
+};
+
+// SlidingAggregator keeps the exact aggregate of the rows_range window
+// `[ts - window_range, ts]` of every key, updated on put. Unlike the
+// pre-aggregation of Aggregator there is no bucket, sum/count/avg are kept as
+// running values and min/max with a monotonic deque, so the window of a
+// request newer than the rows put is read without scanning it.
+class SlidingAggregator {
+ public:
+    SlidingAggregator(const ::openmldb::api::TableMeta& base_meta, uint32_t index_pos, const std::string& aggr_col,
+                      AggrType aggr_type, const std::string& ts_col, int64_t window_range);
+
+    ~SlidingAggregator() = default;
+
+    // check the columns and load the recent rows of `table` if it is not null
+    bool Init(std::shared_ptr<Table> table);
+
+    bool Update(const std::string& key, const std::string& row);
+
+    // return false if the window of `ts` can not be computed from the state,
+    // e.g. the rows newer than `ts` have been put or the rows of the window have
+    // been evicted by a newer request, the caller should scan the table instead
+    bool Get(const std::string& key, int64_t ts, SlidingAggrResult* result);
+
+    uint32_t GetIndexPos() const { return index_pos_; }
+
+    AggrType GetAggrType() const { return aggr_type_; }
+
+    int64_t GetWindowRange() const { return window_range_; }
+
+ private:
+    struct SlidingValue {
+        int64_t ts;
+        bool is_null;
+        int64_t lval;
+        double dval;
+    };
+
+    struct SlidingState {
+        std::mutex mu;
+        // the values sorted by ts
+        std::deque<SlidingValue> values;
+        // the candidates of min/max, whose values are monotonic from front to back
+        std::deque<SlidingValue> extremes;
+        int64_t non_null_cnt = 0;
+        int64_t lsum = 0;
+        double dsum = 0;
+        // the rows older than evict_ts are dropped
+        int64_t evict_ts = INT64_MIN;
+    };
+
+    bool ParseRow(const std::string& row, SlidingValue* value) const;
+    // return true if `a` should be kept in the min/max deque instead of `b`
+    bool Prefer(const SlidingValue& a, const SlidingValue& b) const;
+    void PushExtreme(SlidingState* state, const SlidingValue& value) const;
+    void Evict(SlidingState* state, int64_t bound) const;
+    void AddValue(SlidingState* state, const SlidingValue& value) const;
+
+    codec::Schema base_table_schema_;
+    codec::RowView base_row_view_;
+    uint32_t index_pos_;
+    std::string aggr_col_;
+    AggrType aggr_type_;
+    std::string ts_col_;
+    int64_t window_range_;
+    int aggr_col_idx_;
+    int ts_col_idx_;
+    DataType aggr_col_type_;
+    DataType ts_col_type_;
+    bool is_float_;
+
+    std::mutex mu_;
+    std::unordered_map<std::string, std::unique_ptr<SlidingState>> states_;
+};
+
+std::shared_ptr<SlidingAggregator> CreateSlidingAggregator(const ::openmldb::api::TableMeta& base_meta,
+                                                           uint32_t index_pos, const std::string& aggr_col,
+                                                           const std::string& aggr_func, const std::string& ts_col,
+                                                           int64_t window_range);
+
+}  // namespace storage
+}  // namespace openmldb
+
+#endif  // SRC_STORAGE_SLIDING_AGGREGATOR_H_
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/sliding_aggregator.h"
+
+#include <string>
+
+#include "codec/schema_codec.h"
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace storage {
+
+using ::openmldb::codec::SchemaCodec;
+
+class SlidingAggregatorTest : public ::testing::Test {
+ public:
+    SlidingAggregatorTest() {}
+    ~SlidingAggregatorTest() {}
+};
+
+void AddSlidingAggregatorSchema(::openmldb::api::TableMeta* table_meta) {
+    table_meta->set_name("t0");
+    table_meta->set_tid(1);
+    table_meta->set_pid(0);
+    SchemaCodec::SetColumnDesc(table_meta->add_column_desc(), "id", openmldb::type::DataType::kString);
+    SchemaCodec::SetColumnDesc(table_meta->add_column_desc(), "ts_col", openmldb::type::DataType::kTimestamp);
+    SchemaCodec::SetColumnDesc(table_meta->add_column_desc(), "col_int", openmldb::type::DataType::kInt);
+    SchemaCodec::SetColumnDesc(table_meta->add_column_desc(), "col_double", openmldb::type::DataType::kDouble);
+    SchemaCodec::SetIndex(table_meta->add_column_key(), "idx", "id", "ts_col", ::openmldb::type::kAbsoluteTime, 0, 0);
+}
+
+std::string EncodeRow(const ::openmldb::api::TableMeta& table_meta, int64_t ts, int32_t val, bool is_null = false) {
+    codec::RowBuilder row_builder(table_meta.column_desc());
+    std::string row;
+    uint32_t row_size = row_builder.CalTotalLength(3);
+    row.resize(row_size);
+    row_builder.SetBuffer(reinterpret_cast<int8_t*>(&(row[0])), row_size);
+    row_builder.AppendString("key", 3);
+    row_builder.AppendTimestamp(ts);
+    if (is_null) {
+        row_builder.AppendNULL();
+        row_builder.AppendNULL();
+    } else {
+        row_builder.AppendInt32(val);
+        row_builder.AppendDouble(static_cast<double>(val) / 2);
+    }
+    return row;
+}
+
+std::shared_ptr<SlidingAggregator> CreateAndInit(const ::openmldb::api::TableMeta& table_meta,
+                                                 const std::string& aggr_col, const std::string& aggr_func) {
+    auto aggr = CreateSlidingAggregator(table_meta, 0, aggr_col, aggr_func, "ts_col", 100);
+    if (aggr && !aggr->Init(std::shared_ptr<Table>())) {
+        return std::shared_ptr<SlidingAggregator>();
+    }
+    return aggr;
+}
+
+TEST_F(SlidingAggregatorTest, Create) {
+    ::openmldb::api::TableMeta table_meta;
+    AddSlidingAggregatorSchema(&table_meta);
+    ASSERT_FALSE(CreateSlidingAggregator(table_meta, 0, "col_int", "distinct_count", "ts_col", 100));
+    ASSERT_FALSE(CreateSlidingAggregator(table_meta, 0, "col_int", "sum", "ts_col", 0));
+    ASSERT_FALSE(CreateAndInit(table_meta, "id", "sum"));
+    ASSERT_FALSE(CreateAndInit(table_meta, "col_not_exist", "sum"));
+    ASSERT_TRUE(CreateAndInit(table_meta, "*", "count"));
+    ASSERT_TRUE(CreateAndInit(table_meta, "id", "count"));
+}
+
+TEST_F(SlidingAggregatorTest, SumCountAvg) {
+    ::openmldb::api::TableMeta table_meta;
+    AddSlidingAggregatorSchema(&table_meta);
+    auto sum_aggr = CreateAndInit(table_meta, "col_int", "sum");
+    auto count_aggr = CreateAndInit(table_meta, "col_int", "count");
+    auto count_all_aggr = CreateAndInit(table_meta, "*", "count");
+    auto avg_aggr = CreateAndInit(table_meta, "col_double", "avg");
+    ASSERT_TRUE(sum_aggr && count_aggr && count_all_aggr && avg_aggr);
+    // the rows of ts 0, 10, ..., 990 with value 0, 1, ..., 99 and null at every 10th row
+    for (int i = 0; i < 100; i++) {
+        std::string row = EncodeRow(table_meta, i * 10, i, i % 10 == 0);
+        for (auto& aggr : {sum_aggr, count_aggr, count_all_aggr, avg_aggr}) {
+            ASSERT_TRUE(aggr->Update("key", row));
+        }
+    }
+    // the window of ts 1000 is [900, 1000], values 90..99 with 90 null
+    SlidingAggrResult result;
+    ASSERT_TRUE(sum_aggr->Get("key", 1000, &result));
+    ASSERT_EQ(945 - 90, result.lval);
+    ASSERT_TRUE(count_aggr->Get("key", 1000, &result));
+    ASSERT_EQ(9, result.lval);
+    ASSERT_TRUE(count_all_aggr->Get("key", 1000, &result));
+    ASSERT_EQ(10, result.lval);
+    ASSERT_TRUE(avg_aggr->Get("key", 1000, &result));
+    ASSERT_DOUBLE_EQ((945 - 90) / 2.0 / 9, result.dval);
+
+    // the window moves without new rows
+    ASSERT_TRUE(sum_aggr->Get("key", 1050, &result));
+    ASSERT_EQ(95 + 96 + 97 + 98 + 99, result.lval);
+    // the rows of the older window have been evicted
+    ASSERT_FALSE(sum_aggr->Get("key", 1000, &result));
+    // the rows newer than the request
+    ASSERT_FALSE(count_aggr->Get("key", 500, &result));
+    // the key without rows
+    ASSERT_TRUE(sum_aggr->Get("other_key", 1000, &result));
+    ASSERT_EQ(0, result.cnt);
+}
+
+TEST_F(SlidingAggregatorTest, MinMax) {
+    ::openmldb::api::TableMeta table_meta;
+    AddSlidingAggregatorSchema(&table_meta);
+    auto min_aggr = CreateAndInit(table_meta, "col_int", "min");
+    auto max_aggr = CreateAndInit(table_meta, "col_double", "max");
+    ASSERT_TRUE(min_aggr && max_aggr);
+    // values go down then up: 50, 49, ..., 1, 0, 1, ..., 49
+    for (int i = 0; i < 100; i++) {
+        std::string row = EncodeRow(table_meta, i * 10, i < 50 ? 50 - i : i - 50);
+        ASSERT_TRUE(min_aggr->Update("key", row));
+        ASSERT_TRUE(max_aggr->Update("key", row));
+    }
+    SlidingAggrResult result;
+    // the window [890, 990] has values 39..49
+    ASSERT_TRUE(min_aggr->Get("key", 990, &result));
+    ASSERT_EQ(39, result.lval);
+    ASSERT_TRUE(max_aggr->Get("key", 990, &result));
+    ASSERT_DOUBLE_EQ(49 / 2.0, result.dval);
+
+    // a row put out of order
+    std::string row = EncodeRow(table_meta, 950, -5);
+    ASSERT_TRUE(min_aggr->Update("key", row));
+    ASSERT_TRUE(min_aggr->Get("key", 990, &result));
+    ASSERT_EQ(-5, result.lval);
+    ASSERT_TRUE(min_aggr->Get("key", 1060, &result));
+    ASSERT_EQ(46, result.lval);
+
+    // a row older than all windows is ignored
+    row = EncodeRow(table_meta, 10, -100);
+    ASSERT_TRUE(min_aggr->Update("key", row));
+    ASSERT_TRUE(min_aggr->Get("key", 1060, &result));
+    ASSERT_EQ(46, result.lval);
+
+    // all rows are out of window
+    ASSERT_TRUE(max_aggr->Get("key", 5000, &result));
+    ASSERT_EQ(0, result.cnt);
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -30,7 +30,9 @@ namespace storage {
 
 const std::string MANIFEST = "MANIFEST";  // NOLINT
 
-int Snapshot::GenManifest(const std::string& snapshot_name, uint64_t key_count, uint64_t offset, uint64_t term) {
+int Snapshot::GenManifest(const std::string& snapshot_name, uint64_t key_count, uint64_t offset, uint64_t term,
+                          const std::vector<std::string>& delta_names,
+                          const std::vector<uint32_t>& key_entry_heights) {
     DEBUGLOG("record offset[%lu]. add snapshot[%s] key_count[%lu]", offset, snapshot_name.c_str(), key_count);
     std::string full_path = snapshot_path_ + MANIFEST;
     std::string tmp_file = snapshot_path_ + MANIFEST + ".tmp";
@@ -40,6 +42,12 @@ int Snapshot::GenManifest(const std::string& snapshot_name, uint64_t key_count,
     manifest.set_name(snapshot_name);
     manifest.set_count(key_count);
     manifest.set_term(term);
+    for (const auto& delta_name : delta_names) {
+        manifest.add_delta_name(delta_name);
+    }
+    for (auto height : key_entry_heights) {
+        manifest.add_key_entry_height(height);
+    }
     manifest_info.clear();
     google::protobuf::TextFormat::PrintToString(manifest, &manifest_info);
     FILE* fd_write = fopen(tmp_file.c_str(), "w");
@@ -27,6 +27,7 @@
 
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
+#include "base/hash.h"
 #include "base/strings.h"
 #include "codec/schema_codec.h"
 #include "common/timer.h"
@@ -42,6 +43,13 @@
 
 DECLARE_string(db_root_path);
 DECLARE_string(snapshot_compression);
+DECLARE_uint32(load_table_put_thread_num);
+DECLARE_uint32(extract_index_thread_num);
+DECLARE_uint32(extract_index_batch);
+DECLARE_uint32(snapshot_part_num);
+DECLARE_uint32(snapshot_max_delta_num);
+DECLARE_bool(load_table_mmap);
+DECLARE_bool(key_entry_adaptive_height);
 
 using ::openmldb::api::LogEntry;
 namespace openmldb {
@@ -1630,6 +1638,418 @@ TEST_F(SnapshotTest, Recover_large_snapshot) {
     delete it;
 }
 
+TEST_F(SnapshotTest, Recover_snapshot_pipeline) {
+    std::string binlog_dir = FLAGS_db_root_path + "/102_0/binlog/";
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    WriteHandle* wh = NULL;
+    RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+    uint32_t key_cnt = 100;
+    uint32_t ts_cnt = 100;
+    for (uint32_t i = 0; i < key_cnt * ts_cnt; i++) {
+        offset++;
+        std::string key = "key" + std::to_string(i % key_cnt);
+        auto entry = ::openmldb::test::PackKVEntry(offset, key, "value" + std::to_string(i), i + 1, 1);
+        std::string buffer;
+        entry.SerializeToString(&buffer);
+        ::openmldb::base::Slice slice(buffer);
+        ::openmldb::log::Status status = wh->Write(slice);
+        ASSERT_TRUE(status.ok());
+    }
+    wh->Sync();
+    MemTableSnapshot snapshot(102, 0, log_part, FLAGS_db_root_path);
+    snapshot.Init();
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    std::shared_ptr<MemTable> table =
+        std::make_shared<MemTable>("test", 102, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    uint64_t offset_value = 0;
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+
+    std::shared_ptr<MemTable> new_table =
+        std::make_shared<MemTable>("test", 102, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    new_table->Init();
+    FLAGS_load_table_put_thread_num = 3;
+    uint64_t snapshot_offset = 0;
+    ASSERT_TRUE(snapshot.Recover(new_table, snapshot_offset));
+    FLAGS_load_table_put_thread_num = 0;
+    ASSERT_EQ(key_cnt * ts_cnt, snapshot_offset);
+    ASSERT_EQ(key_cnt * ts_cnt, new_table->GetRecordCnt());
+    for (uint32_t k = 0; k < key_cnt; k++) {
+        Ticket ticket;
+        TableIterator* it = new_table->NewIterator("key" + std::to_string(k), ticket);
+        it->SeekToFirst();
+        uint32_t num = ts_cnt;
+        while (it->Valid()) {
+            num--;
+            uint64_t i = num * key_cnt + k;
+            ASSERT_EQ(i + 1, it->GetKey());
+            std::string value_str(it->GetValue().data(), it->GetValue().size());
+            ASSERT_EQ("value" + std::to_string(i), ::openmldb::test::DecodeV(value_str));
+            it->Next();
+        }
+        ASSERT_EQ(0u, num);
+        delete it;
+    }
+    RemoveData(FLAGS_db_root_path);
+}
+
+TEST_F(SnapshotTest, RecoverRowDict) {
+    std::string binlog_dir = FLAGS_db_root_path + "/103_0/binlog/";
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    WriteHandle* wh = NULL;
+    RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+    uint32_t key_cnt = 10;
+    uint32_t ts_cnt = 50;
+    for (uint32_t i = 0; i < key_cnt * ts_cnt; i++) {
+        offset++;
+        std::string key = "key" + std::to_string(i % key_cnt);
+        auto entry = ::openmldb::test::PackKVEntry(offset, key, "value" + std::to_string(i % 7), i + 1, 1);
+        std::string buffer;
+        entry.SerializeToString(&buffer);
+        ::openmldb::base::Slice slice(buffer);
+        ASSERT_TRUE(wh->Write(slice).ok());
+    }
+    wh->Sync();
+    auto meta = ::openmldb::test::GetTableMeta({"key", "value"});
+    meta.set_tid(103);
+    meta.set_pid(0);
+    meta.set_compact_row(true);
+    SchemaCodec::SetIndex(meta.add_column_key(), "key1", "key", "", ::openmldb::type::kAbsoluteTime, 0, 0);
+    MemTableSnapshot snapshot(103, 0, log_part, FLAGS_db_root_path);
+    snapshot.Init();
+    auto table = std::make_shared<MemTable>(meta);
+    table->Init();
+    uint64_t offset_value = 0;
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    // the dict of the empty table is saved too
+    ASSERT_TRUE(::openmldb::base::IsExists(FLAGS_db_root_path + "/103_0/snapshot/ROW_DICT"));
+
+    // the values are taken in the order of the rows put before the snapshot
+    auto new_table = std::make_shared<MemTable>(meta);
+    new_table->Init();
+    uint64_t snapshot_offset = 0;
+    ASSERT_TRUE(snapshot.Recover(new_table, snapshot_offset));
+    ASSERT_EQ(key_cnt * ts_cnt, new_table->GetRecordCnt());
+    ASSERT_EQ(0, snapshot.MakeSnapshot(new_table, offset_value, 0));
+    auto dict = new_table->GetRowCodec()->GetDict();
+    ASSERT_EQ(key_cnt, dict[0].size());
+    ASSERT_EQ(7u, dict[1].size());
+
+    auto recovered_table = std::make_shared<MemTable>(meta);
+    recovered_table->Init();
+    ASSERT_TRUE(snapshot.Recover(recovered_table, snapshot_offset));
+    ASSERT_EQ(dict, recovered_table->GetRowCodec()->GetDict());
+    Ticket ticket;
+    std::unique_ptr<TableIterator> it(recovered_table->NewIterator("key3", ticket));
+    it->SeekToFirst();
+    uint32_t num = ts_cnt;
+    while (it->Valid()) {
+        num--;
+        uint64_t i = num * key_cnt + 3;
+        ASSERT_EQ(i + 1, it->GetKey());
+        std::string value_str(it->GetValue().data(), it->GetValue().size());
+        ASSERT_EQ(::openmldb::test::PackKVEntry(0, "key3", "value" + std::to_string(i % 7), 0, 0).value(),
+                  value_str);
+        it->Next();
+    }
+    ASSERT_EQ(0u, num);
+    RemoveData(FLAGS_db_root_path);
+}
+
+TEST_F(SnapshotTest, MakeSnapshotParts) {
+    std::string binlog_dir = FLAGS_db_root_path + "/104_0/binlog/";
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    WriteHandle* wh = NULL;
+    RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+    uint32_t key_cnt = 100;
+    uint32_t ts_cnt = 100;
+    auto write_binlog = [&](uint32_t start, uint32_t end) {
+        for (uint32_t i = start; i < end; i++) {
+            offset++;
+            std::string key = "key" + std::to_string(i % key_cnt);
+            auto entry = ::openmldb::test::PackKVEntry(offset, key, "value" + std::to_string(i), i + 1, 1);
+            std::string buffer;
+            entry.SerializeToString(&buffer);
+            ASSERT_TRUE(wh->Write(::openmldb::base::Slice(buffer)).ok());
+        }
+        wh->Sync();
+    };
+    write_binlog(0, key_cnt * ts_cnt / 2);
+    FLAGS_snapshot_part_num = 3;
+    MemTableSnapshot snapshot(104, 0, log_part, FLAGS_db_root_path);
+    snapshot.Init();
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    std::shared_ptr<MemTable> table =
+        std::make_shared<MemTable>("test", 104, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    uint64_t offset_value = 0;
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    std::string snapshot_path = FLAGS_db_root_path + "/104_0/snapshot/";
+    ::openmldb::api::Manifest manifest;
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(snapshot_path + "MANIFEST", manifest));
+    ASSERT_TRUE(::openmldb::base::IsFolder(snapshot_path + manifest.name()));
+    ASSERT_EQ(3u, SnapshotReader::GetFiles(snapshot_path + manifest.name()).size());
+    ASSERT_EQ(key_cnt * ts_cnt / 2, manifest.count());
+
+    // the records of old part files and binlog are written to the new part files
+    write_binlog(key_cnt * ts_cnt / 2, key_cnt * ts_cnt);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    std::string old_name = manifest.name();
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(snapshot_path + "MANIFEST", manifest));
+    ASSERT_NE(old_name, manifest.name());
+    ASSERT_FALSE(::openmldb::base::IsExists(snapshot_path + old_name));
+    ASSERT_EQ(key_cnt * ts_cnt, manifest.count());
+    ASSERT_EQ(key_cnt * ts_cnt, offset_value);
+
+    std::shared_ptr<MemTable> new_table =
+        std::make_shared<MemTable>("test", 104, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    new_table->Init();
+    uint64_t snapshot_offset = 0;
+    ASSERT_TRUE(snapshot.Recover(new_table, snapshot_offset));
+    ASSERT_EQ(key_cnt * ts_cnt, snapshot_offset);
+    ASSERT_EQ(key_cnt * ts_cnt, new_table->GetRecordCnt());
+    for (uint32_t k = 0; k < key_cnt; k++) {
+        Ticket ticket;
+        std::unique_ptr<TableIterator> it(new_table->NewIterator("key" + std::to_string(k), ticket));
+        it->SeekToFirst();
+        uint32_t num = ts_cnt;
+        while (it->Valid()) {
+            num--;
+            uint64_t i = num * key_cnt + k;
+            ASSERT_EQ(i + 1, it->GetKey());
+            std::string value_str(it->GetValue().data(), it->GetValue().size());
+            ASSERT_EQ("value" + std::to_string(i), ::openmldb::test::DecodeV(value_str));
+            it->Next();
+        }
+        ASSERT_EQ(0u, num);
+    }
+
+    // the part files are merged into one file once snapshot_part_num is unset
+    FLAGS_snapshot_part_num = 0;
+    write_binlog(key_cnt * ts_cnt, key_cnt * ts_cnt + 1);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(snapshot_path + "MANIFEST", manifest));
+    ASSERT_FALSE(::openmldb::base::IsFolder(snapshot_path + manifest.name()));
+    ASSERT_EQ(key_cnt * ts_cnt + 1, manifest.count());
+    RemoveData(FLAGS_db_root_path);
+}
+
+TEST_F(SnapshotTest, MakeSnapshotDelta) {
+    std::string binlog_dir = FLAGS_db_root_path + "/105_0/binlog/";
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    WriteHandle* wh = NULL;
+    RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+    uint32_t key_cnt = 10;
+    auto write_binlog = [&](uint32_t start, uint32_t end) {
+        for (uint32_t i = start; i < end; i++) {
+            offset++;
+            std::string key = "key" + std::to_string(i % key_cnt);
+            auto entry = ::openmldb::test::PackKVEntry(offset, key, "value" + std::to_string(i), i + 1, 1);
+            std::string buffer;
+            entry.SerializeToString(&buffer);
+            ASSERT_TRUE(wh->Write(::openmldb::base::Slice(buffer)).ok());
+        }
+        wh->Sync();
+    };
+    FLAGS_snapshot_max_delta_num = 2;
+    MemTableSnapshot snapshot(105, 0, log_part, FLAGS_db_root_path);
+    snapshot.Init();
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    std::shared_ptr<MemTable> table =
+        std::make_shared<MemTable>("test", 105, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    std::string snapshot_path = FLAGS_db_root_path + "/105_0/snapshot/";
+    ::openmldb::api::Manifest manifest;
+    uint64_t offset_value = 0;
+    write_binlog(0, 100);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(snapshot_path + "MANIFEST", manifest));
+    std::string base_name = manifest.name();
+    ASSERT_EQ(0, manifest.delta_name_size());
+
+    // the records of binlog are written to incremental snapshots, and the old snapshot is kept
+    write_binlog(100, 150);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(snapshot_path + "MANIFEST", manifest));
+    ASSERT_EQ(base_name, manifest.name());
+    ASSERT_EQ(1, manifest.delta_name_size());
+    ASSERT_EQ(150u, manifest.count());
+    // no incremental snapshot without new records
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(snapshot_path + "MANIFEST", manifest));
+    ASSERT_EQ(1, manifest.delta_name_size());
+    write_binlog(150, 200);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(snapshot_path + "MANIFEST", manifest));
+    ASSERT_EQ(2, manifest.delta_name_size());
+    ASSERT_EQ(200u, manifest.count());
+    ASSERT_EQ(200u, offset_value);
+
+    std::shared_ptr<MemTable> new_table =
+        std::make_shared<MemTable>("test", 105, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    new_table->Init();
+    uint64_t snapshot_offset = 0;
+    ASSERT_TRUE(snapshot.Recover(new_table, snapshot_offset));
+    ASSERT_EQ(200u, snapshot_offset);
+    ASSERT_EQ(200u, new_table->GetRecordCnt());
+    for (uint32_t k = 0; k < key_cnt; k++) {
+        Ticket ticket;
+        std::unique_ptr<TableIterator> it(new_table->NewIterator("key" + std::to_string(k), ticket));
+        it->SeekToFirst();
+        uint32_t num = 200 / key_cnt;
+        while (it->Valid()) {
+            num--;
+            uint64_t i = num * key_cnt + k;
+            ASSERT_EQ(i + 1, it->GetKey());
+            std::string value_str(it->GetValue().data(), it->GetValue().size());
+            ASSERT_EQ("value" + std::to_string(i), ::openmldb::test::DecodeV(value_str));
+            it->Next();
+        }
+        ASSERT_EQ(0u, num);
+    }
+
+    // the incremental snapshots are merged into a full one at last
+    auto old_manifest = manifest;
+    write_binlog(200, 250);
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(snapshot_path + "MANIFEST", manifest));
+    ASSERT_EQ(0, manifest.delta_name_size());
+    ASSERT_EQ(250u, manifest.count());
+    for (const auto& delta_name : old_manifest.delta_name()) {
+        ASSERT_FALSE(::openmldb::base::IsExists(snapshot_path + delta_name));
+    }
+    if (old_manifest.name() != manifest.name()) {
+        ASSERT_FALSE(::openmldb::base::IsExists(snapshot_path + old_manifest.name()));
+    }
+    FLAGS_snapshot_max_delta_num = 0;
+    RemoveData(FLAGS_db_root_path);
+}
+
+TEST_F(SnapshotTest, RecoverMapped) {
+    std::string binlog_dir = FLAGS_db_root_path + "/106_0/binlog/";
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    WriteHandle* wh = NULL;
+    RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+    uint32_t key_cnt = 10;
+    // the rows larger than a log block are fragmented and copied on recovery
+    auto get_value = [](uint32_t i) {
+        return i % 7 == 0 ? std::string(5000 + i, 'a' + i % 26) : "value" + std::to_string(i);
+    };
+    for (uint32_t i = 0; i < 1000; i++) {
+        offset++;
+        std::string key = "key" + std::to_string(i % key_cnt);
+        auto entry = ::openmldb::test::PackKVEntry(offset, key, get_value(i), i + 1, 1);
+        std::string buffer;
+        entry.SerializeToString(&buffer);
+        ASSERT_TRUE(wh->Write(::openmldb::base::Slice(buffer)).ok());
+    }
+    wh->Sync();
+    MemTableSnapshot snapshot(106, 0, log_part, FLAGS_db_root_path);
+    snapshot.Init();
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    std::shared_ptr<MemTable> table =
+        std::make_shared<MemTable>("test", 106, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    uint64_t offset_value = 0;
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+
+    FLAGS_load_table_mmap = true;
+    std::shared_ptr<MemTable> new_table =
+        std::make_shared<MemTable>("test", 106, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    new_table->Init();
+    uint64_t snapshot_offset = 0;
+    ASSERT_TRUE(snapshot.Recover(new_table, snapshot_offset));
+    FLAGS_load_table_mmap = false;
+    ASSERT_EQ(1000u, snapshot_offset);
+    ASSERT_EQ(1000u, new_table->GetRecordCnt());
+    for (uint32_t k = 0; k < key_cnt; k++) {
+        Ticket ticket;
+        std::unique_ptr<TableIterator> it(new_table->NewIterator("key" + std::to_string(k), ticket));
+        it->SeekToFirst();
+        uint32_t num = 1000 / key_cnt;
+        while (it->Valid()) {
+            num--;
+            uint64_t i = num * key_cnt + k;
+            ASSERT_EQ(i + 1, it->GetKey());
+            std::string value_str(it->GetValue().data(), it->GetValue().size());
+            ASSERT_EQ(get_value(i), ::openmldb::test::DecodeV(value_str));
+            it->Next();
+        }
+        ASSERT_EQ(0u, num);
+    }
+    // the mapped rows are dropped with the table
+    new_table->SchedGc();
+    new_table.reset();
+    RemoveData(FLAGS_db_root_path);
+}
+
+TEST_F(SnapshotTest, RecoverKeyEntryHeight) {
+    std::string binlog_dir = FLAGS_db_root_path + "/107_0/binlog/";
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    WriteHandle* wh = NULL;
+    RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+    for (uint32_t i = 0; i < 100; i++) {
+        offset++;
+        auto entry = ::openmldb::test::PackKVEntry(offset, "key" + std::to_string(i % 2), "value", i + 1, 1);
+        std::string buffer;
+        entry.SerializeToString(&buffer);
+        ASSERT_TRUE(wh->Write(::openmldb::base::Slice(buffer)).ok());
+    }
+    wh->Sync();
+    FLAGS_key_entry_adaptive_height = true;
+    MemTableSnapshot snapshot(107, 0, log_part, FLAGS_db_root_path);
+    snapshot.Init();
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    std::shared_ptr<MemTable> table =
+        std::make_shared<MemTable>("test", 107, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    uint64_t offset_value = 0;
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    // the empty table is not adapted yet, but the heights are saved
+    ::openmldb::api::Manifest manifest;
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(FLAGS_db_root_path + "/107_0/snapshot/MANIFEST", manifest));
+    ASSERT_EQ(1, manifest.key_entry_height_size());
+
+    std::shared_ptr<MemTable> new_table =
+        std::make_shared<MemTable>("test", 107, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    new_table->Init();
+    uint64_t snapshot_offset = 0;
+    ASSERT_TRUE(snapshot.Recover(new_table, snapshot_offset));
+    ASSERT_EQ(100u, new_table->GetRecordCnt());
+    // 50 rows per key fit in 4 levels
+    new_table->SetKeyEntryHeights({1});
+    ASSERT_EQ(0, snapshot.MakeSnapshot(new_table, offset_value, 0));
+    ASSERT_EQ(0, Snapshot::GetLocalManifest(FLAGS_db_root_path + "/107_0/snapshot/MANIFEST", manifest));
+    ASSERT_EQ(1, manifest.key_entry_height_size());
+    ASSERT_EQ(4u, manifest.key_entry_height(0));
+
+    std::shared_ptr<MemTable> recovered_table =
+        std::make_shared<MemTable>("test", 107, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    recovered_table->Init();
+    recovered_table->SetKeyEntryHeights({1});
+    ASSERT_TRUE(snapshot.Recover(recovered_table, snapshot_offset));
+    ASSERT_EQ(std::vector<uint32_t>({4}), recovered_table->GetKeyEntryHeights());
+    FLAGS_key_entry_adaptive_height = false;
+    RemoveData(FLAGS_db_root_path);
+}
+
 TEST_F(SnapshotTest, Recover_large_snapshot_and_binlog) {
     std::string snapshot_dir = FLAGS_db_root_path + "/101_0/snapshot/";
     std::string binlog_dir = FLAGS_db_root_path + "/101_0/binlog/";
@@ -1707,6 +2127,92 @@ TEST_F(SnapshotTest, Recover_large_snapshot_and_binlog) {
     delete it;
 }
 
+TEST_F(SnapshotTest, ExtractMultiIndexData) {
+    std::string binlog_dir = FLAGS_db_root_path + "/103_0/binlog/";
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    uint64_t offset = 0;
+    uint32_t binlog_index = 0;
+    WriteHandle* wh = NULL;
+    RollWLogFile(&wh, log_part, binlog_dir, binlog_index, offset);
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_name("test");
+    table_meta.set_tid(103);
+    table_meta.set_pid(0);
+    table_meta.set_seg_cnt(8);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "merchant", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "value", ::openmldb::type::kString);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "", ::openmldb::type::kAbsoluteTime, 0, 0);
+    ::openmldb::codec::SDKCodec sdk_codec(table_meta);
+    uint32_t key_cnt = 20;
+    uint32_t row_cnt = 1000;
+    for (uint32_t i = 0; i < row_cnt; i++) {
+        offset++;
+        ::openmldb::api::LogEntry entry;
+        entry.set_log_index(offset);
+        entry.set_ts(i + 1);
+        std::string value;
+        sdk_codec.EncodeRow({"card" + std::to_string(i % key_cnt), "merchant" + std::to_string(i % key_cnt),
+                             "value" + std::to_string(i)}, &value);
+        entry.set_value(value);
+        ::openmldb::test::AddDimension(0, "card" + std::to_string(i % key_cnt), &entry);
+        std::string buffer;
+        entry.SerializeToString(&buffer);
+        ::openmldb::log::Status status = wh->Write(::openmldb::base::Slice(buffer));
+        ASSERT_TRUE(status.ok());
+    }
+    wh->Sync();
+    MemTableSnapshot snapshot(103, 0, log_part, FLAGS_db_root_path);
+    snapshot.Init();
+    std::shared_ptr<MemTable> table = std::make_shared<MemTable>(table_meta);
+    table->Init();
+    uint64_t offset_value = 0;
+    ASSERT_EQ(0, snapshot.MakeSnapshot(table, offset_value, 0));
+    ASSERT_TRUE(snapshot.Recover(table, offset_value));
+
+    ::openmldb::common::ColumnKey column_key;
+    column_key.set_index_name("merchant");
+    column_key.add_col_name("merchant");
+    ASSERT_TRUE(table->AddIndex(column_key));
+    FLAGS_extract_index_thread_num = 3;
+    FLAGS_extract_index_batch = 64;
+    uint32_t partition_num = 2;
+    uint64_t out_offset = 0;
+    ASSERT_EQ(0, snapshot.ExtractIndexData(table, {column_key}, partition_num, &out_offset));
+    FLAGS_extract_index_thread_num = 4;
+    FLAGS_extract_index_batch = 1024;
+    ASSERT_EQ(row_cnt, out_offset);
+    // only the keys of this partition are extracted
+    for (uint32_t k = 0; k < key_cnt; k++) {
+        std::string key = "merchant" + std::to_string(k);
+        Ticket ticket;
+        TableIterator* it = table->NewIterator(1, key, ticket);
+        it->SeekToFirst();
+        uint32_t num = 0;
+        while (it->Valid()) {
+            uint64_t i = row_cnt - key_cnt * (num + 1) + k;
+            ASSERT_EQ(i + 1, it->GetKey());
+            num++;
+            it->Next();
+        }
+        delete it;
+        if (::openmldb::base::hash64(key) % partition_num == 0) {
+            ASSERT_EQ(row_cnt / key_cnt, num);
+        } else {
+            ASSERT_EQ(0u, num);
+        }
+    }
+    // the extracted dimensions are in the new snapshot
+    std::shared_ptr<MemTable> new_table = std::make_shared<MemTable>(*table->GetTableMeta());
+    new_table->Init();
+    uint64_t snapshot_offset = 0;
+    ASSERT_TRUE(snapshot.Recover(new_table, snapshot_offset));
+    ASSERT_EQ(row_cnt, snapshot_offset);
+    ASSERT_EQ(row_cnt, new_table->GetRecordCnt());
+    RemoveData(FLAGS_db_root_path);
+}
+
 }  // namespace storage
 }  // namespace openmldb
 
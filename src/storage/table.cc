@@ -27,6 +27,8 @@
 namespace openmldb {
 namespace storage {
 
+static constexpr uint32_t MAX_PROJECT_PLAN_CNT = 128;
+
 Table::Table() {}
 
 Table::Table(::openmldb::common::StorageMode storage_mode, const std::string& name, uint32_t id, uint32_t pid,
@@ -96,6 +98,28 @@ void Table::AddVersionSchema(const ::openmldb::api::TableMeta& table_meta) {
     std::atomic_store_explicit(&version_decoder_, version_decoder, std::memory_order_relaxed);
 }
 
+std::shared_ptr<codec::RowProjectPlan> Table::GetProjectPlan(const codec::ProjectList& plist) {
+    std::string key(reinterpret_cast<const char*>(plist.data()), plist.size() * sizeof(uint32_t));
+    auto versions = std::atomic_load_explicit(&version_schema_, std::memory_order_relaxed);
+    if (!versions) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(project_mu_);
+    auto it = project_plans_.find(key);
+    if (it != project_plans_.end() && it->second.first == versions) {
+        return it->second.second;
+    }
+    auto plan = std::make_shared<codec::RowProjectPlan>(*versions, plist);
+    if (!plan->Init()) {
+        return nullptr;
+    }
+    if (it == project_plans_.end() && project_plans_.size() >= MAX_PROJECT_PLAN_CNT) {
+        project_plans_.clear();
+    }
+    project_plans_[key] = std::make_pair(versions, plan);
+    return plan;
+}
+
 void Table::SetTableMeta(::openmldb::api::TableMeta& table_meta) {  // NOLINT
     auto cur_table_meta = std::make_shared<::openmldb::api::TableMeta>(table_meta);
     std::atomic_store_explicit(&table_meta_, cur_table_meta, std::memory_order_release);
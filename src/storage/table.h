@@ -19,12 +19,14 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <vector>
 
 #include "codec/codec.h"
 #include "proto/tablet.pb.h"
 #include "storage/iterator.h"
+#include "storage/row_filter.h"
 #include "storage/schema.h"
 #include "storage/ticket.h"
 #include "vm/catalog.h"
@@ -38,6 +40,15 @@ using Schema = google::protobuf::RepeatedPtrField<openmldb::common::ColumnDesc>;
 
 enum TableStat { kUndefined = 0, kNormal, kLoading, kMakingSnapshot, kSnapshotPaused };
 
+// the statistics of an index, which tell the engine how selective the index is
+struct IndexStat {
+    uint64_t key_cnt = 0;
+    uint64_t record_cnt = 0;
+    // the range of ts of the rows of the sampled keys, both are 0 if no row is sampled
+    uint64_t min_ts = 0;
+    uint64_t max_ts = 0;
+};
+
 class Table {
  public:
     Table();
@@ -57,6 +68,15 @@ class Table {
         return Put(entry.ts(), entry.value(), entry.dimensions());
     }
 
+    // put the rows of one partition at once, the result of each row is set in results
+    virtual void BatchPut(const std::vector<const ::openmldb::api::PutRequest*>& requests,
+                          std::vector<bool>* results) {
+        results->resize(requests.size());
+        for (size_t i = 0; i < requests.size(); i++) {
+            (*results)[i] = Put(requests[i]->time(), requests[i]->value(), requests[i]->dimensions());
+        }
+    }
+
     virtual bool Delete(const std::string& pk, uint32_t idx) = 0;
 
     virtual TableIterator* NewIterator(const std::string& pk,
@@ -67,8 +87,24 @@ class Table {
 
     virtual TraverseIterator* NewTraverseIterator(uint32_t index) = 0;
 
+    // split the traversal of the index into at most part_num iterators over disjoint keys, so that they can be
+    // consumed by different threads, each iterator has its own ticket. the iterators are owned by the caller
+    virtual std::vector<TraverseIterator*> NewTraverseIterators(uint32_t index, uint32_t part_num) {
+        std::vector<TraverseIterator*> its;
+        TraverseIterator* it = NewTraverseIterator(index);
+        if (it != nullptr) {
+            its.push_back(it);
+        }
+        return its;
+    }
+
     virtual ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index) = 0;
 
+    // the rows are read as `hint` tells, see ScanHint. all the rows are returned as they are by default
+    virtual ::hybridse::vm::WindowIterator* NewPrunedWindowIterator(uint32_t index, const ScanHint& hint) {
+        return NewWindowIterator(index);
+    }
+
     virtual void SchedGc() = 0;
 
     virtual uint64_t GetRecordCnt() const = 0;
@@ -106,6 +142,22 @@ class Table {
 
     inline void SetDiskused(uint64_t size) { diskused_.store(size, std::memory_order_relaxed); }
 
+    // the count of get, scan, count and traverse requests on the table since it is loaded
+    inline void AddQueryCnt() { query_cnt_.fetch_add(1, std::memory_order_relaxed); }
+
+    inline uint64_t GetQueryCnt() const { return query_cnt_.load(std::memory_order_relaxed); }
+
+    // the count of the requests and online queries reading index idx since the table is loaded
+    inline void AddIndexQueryCnt(uint32_t idx) {
+        if (idx < MAX_INDEX_NUM) {
+            index_query_cnt_[idx].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    inline uint64_t GetIndexQueryCnt(uint32_t idx) const {
+        return idx < MAX_INDEX_NUM ? index_query_cnt_[idx].load(std::memory_order_relaxed) : 0;
+    }
+
     inline const ::openmldb::type::CompressType GetCompressType() { return compress_type_; }
 
     void AddVersionSchema(const ::openmldb::api::TableMeta& table_meta);
@@ -114,7 +166,7 @@ class Table {
         return std::atomic_load_explicit(&table_meta_, std::memory_order_relaxed);
     }
 
-    void SetTableMeta(::openmldb::api::TableMeta& table_meta);  // NOLINT
+    virtual void SetTableMeta(::openmldb::api::TableMeta& table_meta);  // NOLINT
 
     std::shared_ptr<Schema> GetVersionSchema(int32_t ver) {
         auto versions = std::atomic_load_explicit(&version_schema_, std::memory_order_relaxed);
@@ -146,6 +198,10 @@ class Table {
         return *std::atomic_load_explicit(&version_schema_, std::memory_order_relaxed);
     }
 
+    // get the compiled plan of projection list on the current schema versions, the
+    // plans are cached and rebuilt once the schema versions change
+    std::shared_ptr<codec::RowProjectPlan> GetProjectPlan(const codec::ProjectList& plist);
+
     std::vector<std::shared_ptr<IndexDef>> GetAllIndex() { return table_index_.GetAllIndex(); }
 
     std::shared_ptr<IndexDef> GetIndex(const std::string& name) { return table_index_.GetIndex(name); }
@@ -173,11 +229,20 @@ class Table {
     virtual uint64_t GetRecordIdxCnt() = 0;
     virtual bool GetRecordIdxCnt(uint32_t idx, uint64_t** stat, uint32_t* size) = 0;
     virtual uint64_t GetRecordPkCnt() = 0;
+    // the statistics collected on gc and snapshot, return false if they are not collected yet
+    virtual bool GetIndexStat(uint32_t idx, IndexStat* stat) { return false; }
     virtual inline uint64_t GetRecordByteSize() const = 0;
     virtual uint64_t GetRecordIdxByteSize() = 0;
 
     virtual int GetCount(uint32_t index, const std::string& pk, uint64_t& count) = 0; // NOLINT
 
+    // the count of the rows of pk not expired, which is looked up without scan. return -1 if the key is not
+    // found, -2 if it can't be counted without scan
+    virtual int GetUnexpiredCount(uint32_t index, const std::string& pk, uint64_t expire_time, uint64_t expire_cnt,
+                                  uint64_t* count) {
+        return -2;
+    }
+
  protected:
     void UpdateTTL();
     bool InitFromMeta();
@@ -187,6 +252,8 @@ class Table {
     uint32_t id_;
     uint32_t pid_;
     std::atomic<uint64_t> diskused_;
+    std::atomic<uint64_t> query_cnt_{0};
+    std::atomic<uint64_t> index_query_cnt_[MAX_INDEX_NUM] = {};
     bool is_leader_;
     uint64_t ttl_offset_;
     std::atomic<uint32_t> table_status_;
@@ -197,6 +264,11 @@ class Table {
     std::shared_ptr<std::map<int32_t, std::shared_ptr<Schema>>> version_schema_;
     std::shared_ptr<std::map<int32_t, std::shared_ptr<codec::RowView>>> version_decoder_;
     std::shared_ptr<std::vector<::openmldb::storage::UpdateTTLMeta>> update_ttl_;
+    std::mutex project_mu_;
+    // key is the projection list, value is the schema versions that plan compiled on and the plan
+    std::map<std::string, std::pair<std::shared_ptr<std::map<int32_t, std::shared_ptr<Schema>>>,
+                                    std::shared_ptr<codec::RowProjectPlan>>>
+        project_plans_;
 };
 
 }  // namespace storage
@@ -17,6 +17,8 @@
 #include <gflags/gflags.h>
 #include <atomic>
 #include <iostream>
+#include <set>
+#include <thread>  // NOLINT
 #include <utility>
 
 #include "base/glog_wapper.h"
@@ -25,6 +27,7 @@
 #include "common/timer.h"
 #include "gtest/gtest.h"
 #include "storage/mem_table.h"
+#include "storage/read_snapshot.h"
 #include "storage/ticket.h"
 #include "test/util.h"
 #include "storage/table.h"
@@ -38,6 +41,8 @@ DECLARE_string(ssd_root_path);
 DECLARE_string(hdd_root_path);
 DECLARE_uint32(max_traverse_cnt);
 DECLARE_int32(gc_safe_offset);
+DECLARE_bool(key_entry_adaptive_height);
+DECLARE_uint32(cold_row_age_min);
 
 namespace openmldb {
 namespace storage {
@@ -209,6 +214,68 @@ TEST_P(TableTest, MultiDimissionPut0) {
     delete table;
 }
 
+TEST_P(TableTest, BatchPut) {
+    ::openmldb::common::StorageMode storageMode = GetParam();
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    mapping.insert(std::make_pair("idx1", 1));
+    mapping.insert(std::make_pair("idx2", 2));
+    std::string table_path = "";
+    int id = 1;
+    if (storageMode == ::openmldb::common::kHDD) {
+        id = ++counter;
+        table_path = GetDBPath(FLAGS_hdd_root_path, id, 1);
+    }
+    Table* table = CreateTable("tx_log", id, 1, 8, mapping, 10, ::openmldb::type::kAbsoluteTime,
+                                      table_path, storageMode);
+    table->Init();
+    auto meta = ::openmldb::test::GetTableMeta({"idx0", "idx1", "idx2"});
+    ::openmldb::codec::SDKCodec sdk_codec(meta);
+    std::vector<::openmldb::api::PutRequest> requests(10);
+    std::vector<const ::openmldb::api::PutRequest*> request_ptrs;
+    for (uint32_t i = 0; i < requests.size(); i++) {
+        auto& request = requests[i];
+        std::vector<std::string> row = {"d0" + std::to_string(i % 3), "d1" + std::to_string(i), "d2"};
+        for (uint32_t idx = 0; idx < row.size(); idx++) {
+            auto dim = request.add_dimensions();
+            dim->set_key(row[idx]);
+            dim->set_idx(idx);
+        }
+        sdk_codec.EncodeRow(row, request.mutable_value());
+        request.set_time(i + 1);
+        request_ptrs.push_back(&request);
+    }
+    // the invalid row fails alone
+    requests[9].clear_dimensions();
+    std::vector<bool> results;
+    table->BatchPut(request_ptrs, &results);
+    ASSERT_EQ(10u, results.size());
+    for (uint32_t i = 0; i < 9; i++) {
+        ASSERT_TRUE(results[i]);
+    }
+    ASSERT_FALSE(results[9]);
+    ASSERT_EQ(9, (int64_t)table->GetRecordCnt());
+    if (storageMode == ::openmldb::common::StorageMode::kMemory) {
+        ASSERT_EQ(27, (int64_t)table->GetRecordIdxCnt());
+    }
+    // the rows of one key are in order of time
+    Ticket ticket;
+    TableIterator* it = table->NewIterator(0, "d02", ticket);
+    it->SeekToFirst();
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ(9, (int64_t)it->GetKey());
+    it->Next();
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ(6, (int64_t)it->GetKey());
+    it->Next();
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ(3, (int64_t)it->GetKey());
+    it->Next();
+    ASSERT_FALSE(it->Valid());
+    delete it;
+    delete table;
+}
+
 TEST_P(TableTest, IsExpired) {
     ::openmldb::common::StorageMode storageMode = GetParam();
     std::map<std::string, uint32_t> mapping;
@@ -1641,6 +1708,443 @@ TEST_F(TableTest, Release) {
     delete table;
 }
 
+TEST_F(TableTest, TraverseIterators) {
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    MemTable table("tx_log", 1, 1, 8, mapping, 0, ::openmldb::type::kAbsoluteTime);
+    table.Init();
+    for (int i = 0; i < 1000; i++) {
+        std::string key = "key" + std::to_string(i % 100);
+        table.Put(key, 1000 + i, "value", 5);
+    }
+    // no more parts than segments
+    auto its = table.NewTraverseIterators(0, 16);
+    ASSERT_EQ(8u, its.size());
+    std::vector<std::set<std::string>> keys(its.size());
+    std::vector<int> counts(its.size(), 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < its.size(); i++) {
+        threads.emplace_back([&its, &keys, &counts, i] {
+            its[i]->SeekToFirst();
+            while (its[i]->Valid()) {
+                keys[i].insert(its[i]->GetPK());
+                counts[i]++;
+                its[i]->Next();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    std::set<std::string> all_keys;
+    int count = 0;
+    for (size_t i = 0; i < its.size(); i++) {
+        for (const auto& key : keys[i]) {
+            ASSERT_TRUE(all_keys.insert(key).second);
+        }
+        count += counts[i];
+    }
+    ASSERT_EQ(100u, all_keys.size());
+    ASSERT_EQ(1000, count);
+
+    // the key of another part is not found
+    std::string key = *keys[0].begin();
+    its[0]->Seek(key, 0);
+    ASSERT_TRUE(its[0]->Valid());
+    ASSERT_EQ(key, its[0]->GetPK());
+    its[1]->Seek(key, 0);
+    ASSERT_FALSE(its[1]->Valid());
+    for (auto* it : its) {
+        delete it;
+    }
+    its = table.NewTraverseIterators(0, 0);
+    ASSERT_EQ(1u, its.size());
+    delete its[0];
+    ASSERT_TRUE(table.NewTraverseIterators(1, 4).empty());
+}
+
+TEST_F(TableTest, AdaptKeyEntryHeight) {
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    MemTable table("tx_log", 1, 1, 8, mapping, 0, ::openmldb::type::kAbsoluteTime);
+    table.Init();
+    for (int i = 0; i < 1000; i++) {
+        table.Put("key" + std::to_string(i % 2), 1000 + i, "value", 5);
+    }
+    // not adapted without the flag
+    table.SchedGc();
+    ASSERT_EQ(std::vector<uint32_t>({4}), table.GetKeyEntryHeights());
+    FLAGS_key_entry_adaptive_height = true;
+    // 500 rows per key fit in 6 levels
+    table.SchedGc();
+    ASSERT_EQ(std::vector<uint32_t>({6}), table.GetKeyEntryHeights());
+    // the heights of other inner indexes are ignored
+    table.SetKeyEntryHeights({2, 2});
+    ASSERT_EQ(std::vector<uint32_t>({6}), table.GetKeyEntryHeights());
+    table.SetKeyEntryHeights({2});
+    ASSERT_EQ(std::vector<uint32_t>({2}), table.GetKeyEntryHeights());
+    // the keys created with any height are freed
+    ASSERT_EQ(1000u, table.Release());
+
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_name("table1");
+    table_meta.set_tid(1);
+    table_meta.set_pid(1);
+    table_meta.set_seg_cnt(8);
+    table_meta.set_key_entry_max_height(3);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts", ::openmldb::type::kTimestamp);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts", ::openmldb::type::kAbsoluteTime, 0, 0);
+    // the height given by the table is kept
+    MemTable fixed_table(table_meta);
+    ASSERT_TRUE(fixed_table.Init());
+    fixed_table.AdaptKeyEntryHeight();
+    fixed_table.SetKeyEntryHeights({6});
+    ASSERT_EQ(std::vector<uint32_t>({3}), fixed_table.GetKeyEntryHeights());
+    FLAGS_key_entry_adaptive_height = false;
+}
+
+TEST_F(TableTest, IndexStat) {
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    MemTable table("tx_log", 1, 1, 8, mapping, 0, ::openmldb::type::kAbsoluteTime);
+    table.Init();
+    for (int i = 0; i < 1000; i++) {
+        table.Put("key" + std::to_string(i % 2), 1000 + i, "value", 5);
+    }
+    IndexStat stat;
+    // collected on gc
+    ASSERT_FALSE(table.GetIndexStat(0, &stat));
+    table.SchedGc();
+    ASSERT_TRUE(table.GetIndexStat(0, &stat));
+    ASSERT_EQ(2u, stat.key_cnt);
+    ASSERT_EQ(1000u, stat.record_cnt);
+    ASSERT_EQ(1000u, stat.min_ts);
+    ASSERT_EQ(1999u, stat.max_ts);
+    ASSERT_FALSE(table.GetIndexStat(1, &stat));
+}
+
+TEST_F(TableTest, CompactRow) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_name("table1");
+    table_meta.set_tid(1);
+    table_meta.set_pid(1);
+    table_meta.set_seg_cnt(8);
+    table_meta.set_mode(::openmldb::api::TableMode::kTableLeader);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts", ::openmldb::type::kTimestamp);
+    for (int i = 2; i < 100; i++) {
+        SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "c" + std::to_string(i),
+                                   i % 2 == 0 ? ::openmldb::type::kString : ::openmldb::type::kBigInt);
+    }
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts", ::openmldb::type::kAbsoluteTime, 0, 0);
+    MemTable plain_table(table_meta);
+    ASSERT_TRUE(plain_table.Init());
+    ASSERT_TRUE(plain_table.GetRowCodec() == nullptr);
+    table_meta.set_compact_row(true);
+    MemTable table(table_meta);
+    ASSERT_TRUE(table.Init());
+    ASSERT_TRUE(table.GetRowCodec() != nullptr);
+
+    // most columns are null and the strings are of a few values
+    codec::RowBuilder builder(table_meta.column_desc());
+    std::vector<std::string> rows;
+    for (int i = 0; i < 10; i++) {
+        std::string card = "card" + std::to_string(i % 2);
+        std::string city = "city" + std::to_string(i % 3);
+        uint32_t size = builder.CalTotalLength(card.size() + city.size());
+        std::string row(size, 0);
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), size);
+        builder.AppendString(card.data(), card.size());
+        builder.AppendTimestamp(1000 + i);
+        builder.AppendString(city.data(), city.size());
+        builder.AppendInt64(0);
+        for (int j = 4; j < 100; j++) {
+            builder.AppendNULL();
+        }
+        ::openmldb::api::PutRequest request;
+        auto* dim = request.add_dimensions();
+        dim->set_idx(0);
+        dim->set_key(card);
+        ASSERT_TRUE(table.Put(0, row, request.dimensions()));
+        ASSERT_TRUE(plain_table.Put(0, row, request.dimensions()));
+        rows.push_back(row);
+    }
+    ASSERT_EQ(10u, table.GetRecordCnt());
+    ASSERT_LT(table.GetRecordByteSize() * 2, plain_table.GetRecordByteSize());
+
+    Ticket ticket;
+    std::unique_ptr<TableIterator> it(table.NewIterator(0, "card1", ticket));
+    it->SeekToFirst();
+    for (int i = 9; i > 0; i -= 2) {
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ(1000u + i, it->GetKey());
+        ASSERT_EQ(rows[i], it->GetValue().ToString());
+        it->Next();
+    }
+    ASSERT_FALSE(it->Valid());
+
+    std::unique_ptr<TraverseIterator> traverse_it(table.NewTraverseIterator(0));
+    traverse_it->SeekToFirst();
+    int count = 0;
+    while (traverse_it->Valid()) {
+        ASSERT_EQ(rows[traverse_it->GetKey() - 1000], traverse_it->GetValue().ToString());
+        count++;
+        traverse_it->Next();
+    }
+    ASSERT_EQ(10, count);
+
+    std::unique_ptr<::hybridse::vm::WindowIterator> window_it(table.NewWindowIterator(0));
+    window_it->Seek("card0");
+    ASSERT_TRUE(window_it->Valid());
+    auto row_it = window_it->GetValue();
+    row_it->SeekToFirst();
+    std::vector<::hybridse::codec::Row> window;
+    while (row_it->Valid()) {
+        window.push_back(row_it->GetValue());
+        row_it->Next();
+    }
+    // the rows kept by the window are still valid after the iterator moves
+    ASSERT_EQ(5u, window.size());
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(rows[8 - i * 2],
+                  std::string(reinterpret_cast<const char*>(window[i].buf()), window[i].size()));
+    }
+}
+
+#ifdef SNAPSHOT_READ_ENABLE
+TEST_F(TableTest, ReadSnapshot) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_name("table1");
+    table_meta.set_tid(1);
+    table_meta.set_pid(1);
+    table_meta.set_seg_cnt(8);
+    table_meta.set_mode(::openmldb::api::TableMode::kTableLeader);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts", ::openmldb::type::kTimestamp);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts", ::openmldb::type::kAbsoluteTime, 0, 0);
+    MemTable table(table_meta);
+    ASSERT_TRUE(table.Init());
+    codec::RowBuilder builder(table_meta.column_desc());
+    auto put = [&](const std::string& card, int64_t ts) {
+        uint32_t size = builder.CalTotalLength(card.size());
+        std::string row(size, 0);
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), size);
+        builder.AppendString(card.data(), card.size());
+        builder.AppendTimestamp(ts);
+        ::openmldb::api::PutRequest request;
+        auto* dim = request.add_dimensions();
+        dim->set_idx(0);
+        dim->set_key(card);
+        return table.Put(0, row, request.dimensions());
+    };
+    auto count_windows = [&table]() {
+        int count = 0;
+        std::unique_ptr<::hybridse::vm::WindowIterator> window_it(table.NewWindowIterator(0));
+        window_it->SeekToFirst();
+        while (window_it->Valid()) {
+            auto row_it = window_it->GetValue();
+            row_it->SeekToFirst();
+            while (row_it->Valid()) {
+                count++;
+                row_it->Next();
+            }
+            window_it->Next();
+        }
+        return count;
+    };
+    auto count_traverse = [&table]() {
+        int count = 0;
+        std::unique_ptr<TraverseIterator> it(table.NewTraverseIterator(0));
+        it->SeekToFirst();
+        while (it->Valid()) {
+            count++;
+            it->Next();
+        }
+        return count;
+    };
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(put("card0", 1000 + i * 2));
+    }
+    ReadSnapshot snapshot;
+    snapshot.Pin(1, 1, table.GetReadSeq());
+    // the rows put after the pin are in between and before the pinned ones, and of a new key
+    ASSERT_TRUE(put("card0", 1003));
+    ASSERT_TRUE(put("card0", 2000));
+    ASSERT_TRUE(put("card1", 1000));
+    {
+        ReadSnapshot::Scope scope(&snapshot);
+        ASSERT_EQ(5, count_windows());
+        ASSERT_EQ(5, count_traverse());
+    }
+    ASSERT_EQ(8, count_windows());
+    ASSERT_EQ(8, count_traverse());
+
+    // the partition not pinned is pinned on the first read
+    ReadSnapshot lazy_snapshot;
+    ReadSnapshot::Scope scope(&lazy_snapshot);
+    std::unique_ptr<TraverseIterator> it(table.NewTraverseIterator(0));
+    ASSERT_TRUE(put("card2", 1000));
+    it->SeekToFirst();
+    int count = 0;
+    while (it->Valid()) {
+        count++;
+        it->Next();
+    }
+    ASSERT_EQ(8, count);
+    ASSERT_EQ(8, count_windows());
+}
+
+TEST_F(TableTest, ReadSeqConcurrentPut) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_name("table1");
+    table_meta.set_tid(1);
+    table_meta.set_pid(1);
+    table_meta.set_seg_cnt(8);
+    table_meta.set_mode(::openmldb::api::TableMode::kTableLeader);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts", ::openmldb::type::kTimestamp);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts", ::openmldb::type::kAbsoluteTime, 0, 0);
+    MemTable table(table_meta);
+    ASSERT_TRUE(table.Init());
+    std::atomic<bool> stop{false};
+    // the read seq never goes back while the puts of the threads take it forward
+    std::thread reader([&table, &stop]() {
+        uint64_t last = 0;
+        while (!stop.load()) {
+            uint64_t seq = table.GetReadSeq();
+            ASSERT_GE(seq, last);
+            last = seq;
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 8; t++) {
+        writers.emplace_back([&table, &table_meta, t]() {
+            codec::RowBuilder builder(table_meta.column_desc());
+            for (int i = 0; i < 1000; i++) {
+                std::string card = "card" + std::to_string(t * 1000 + i);
+                uint32_t size = builder.CalTotalLength(card.size());
+                std::string row(size, 0);
+                builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), size);
+                builder.AppendString(card.data(), card.size());
+                builder.AppendTimestamp(1000 + i);
+                ::openmldb::api::PutRequest request;
+                auto* dim = request.add_dimensions();
+                dim->set_idx(0);
+                dim->set_key(card);
+                ASSERT_TRUE(table.Put(0, row, request.dimensions()));
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    stop.store(true);
+    reader.join();
+    // the seqs start from 1, and all the puts are inserted
+    ASSERT_EQ(8001u, table.GetReadSeq());
+    std::unique_ptr<TraverseIterator> it(table.NewTraverseIterator(0));
+    it->SeekToFirst();
+    int count = 0;
+    while (it->Valid()) {
+        count++;
+        it->Next();
+    }
+    ASSERT_EQ(8000, count);
+}
+#endif
+
+TEST_F(TableTest, ColdRow) {
+    FLAGS_cold_row_age_min = 1;
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_name("table1");
+    table_meta.set_tid(1);
+    table_meta.set_pid(1);
+    table_meta.set_seg_cnt(8);
+    table_meta.set_mode(::openmldb::api::TableMode::kTableLeader);
+    table_meta.set_format_version(1);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts", ::openmldb::type::kTimestamp);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "merchant", ::openmldb::type::kString);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts", ::openmldb::type::kAbsoluteTime, 0, 0);
+    MemTable table(table_meta);
+    ASSERT_TRUE(table.Init());
+    FLAGS_cold_row_age_min = 0;
+    ASSERT_TRUE(table.GetColdCodec() != nullptr);
+
+    codec::RowBuilder builder(table_meta.column_desc());
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    // the rows of even i are put 10 minutes ago, so they are cold
+    std::map<uint64_t, std::string> rows;
+    for (int i = 0; i < 20; i++) {
+        std::string card = "card" + std::to_string(i % 2);
+        std::string merchant = "the merchant of the card in the city " + std::to_string(i % 3);
+        uint64_t ts = i % 2 == 0 ? now - 10 * 60 * 1000 + i : now + i;
+        uint32_t size = builder.CalTotalLength(card.size() + merchant.size());
+        std::string row(size, 0);
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&row[0]), size);
+        builder.AppendString(card.data(), card.size());
+        builder.AppendTimestamp(ts);
+        builder.AppendString(merchant.data(), merchant.size());
+        ::openmldb::api::PutRequest request;
+        auto* dim = request.add_dimensions();
+        dim->set_idx(0);
+        dim->set_key(card);
+        ASSERT_TRUE(table.Put(0, row, request.dimensions()));
+        rows.emplace(ts, row);
+    }
+    table.SchedGc();
+    ASSERT_EQ(10u, table.GetGcStat().GetColdRowCnt());
+    ASSERT_GT(table.GetGcStat().GetColdSavedByteSize(), 0u);
+    // the rows compressed are not compressed again, and the replaced data is freed
+    table.SchedGc();
+    table.SchedGc();
+    table.SchedGc();
+    ASSERT_EQ(10u, table.GetGcStat().GetColdRowCnt());
+
+    Ticket ticket;
+    std::unique_ptr<TableIterator> it(table.NewIterator(0, "card0", ticket));
+    it->SeekToFirst();
+    int count = 0;
+    while (it->Valid()) {
+        ASSERT_EQ(rows[it->GetKey()], it->GetValue().ToString());
+        count++;
+        it->Next();
+    }
+    ASSERT_EQ(10, count);
+
+    std::unique_ptr<TraverseIterator> traverse_it(table.NewTraverseIterator(0));
+    traverse_it->SeekToFirst();
+    count = 0;
+    while (traverse_it->Valid()) {
+        ASSERT_EQ(rows[traverse_it->GetKey()], traverse_it->GetValue().ToString());
+        count++;
+        traverse_it->Next();
+    }
+    ASSERT_EQ(20, count);
+
+    std::unique_ptr<::hybridse::vm::WindowIterator> window_it(table.NewWindowIterator(0));
+    window_it->Seek("card0");
+    ASSERT_TRUE(window_it->Valid());
+    auto row_it = window_it->GetValue();
+    row_it->SeekToFirst();
+    std::vector<::hybridse::codec::Row> window;
+    std::vector<uint64_t> keys;
+    while (row_it->Valid()) {
+        window.push_back(row_it->GetValue());
+        keys.push_back(row_it->GetKey());
+        row_it->Next();
+    }
+    // the inflated rows kept by the window are still valid after the iterator moves
+    ASSERT_EQ(10u, window.size());
+    for (size_t i = 0; i < window.size(); i++) {
+        ASSERT_EQ(rows[keys[i]], std::string(reinterpret_cast<const char*>(window[i].buf()), window[i].size()));
+    }
+}
+
 TEST_P(TableTest, TSColIDLength) {
     ::openmldb::common::StorageMode storageMode = GetParam();
     ::openmldb::api::TableMeta table_meta;
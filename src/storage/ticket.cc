@@ -22,9 +22,8 @@ namespace storage {
 Ticket::Ticket() {}
 
 Ticket::~Ticket() {
-    std::vector<KeyEntry*>::iterator it = entries_.begin();
-    for (; it != entries_.end(); ++it) {
-        (*it)->UnRef();
+    for (auto ref : refs_) {
+        ref->fetch_sub(1, std::memory_order_relaxed);
     }
 }
 
@@ -33,14 +32,22 @@ void Ticket::Push(KeyEntry* entry) {
         return;
     }
     entry->Ref();
-    entries_.push_back(entry);
+    refs_.push_back(&entry->refs_);
+}
+
+void Ticket::Push(LatestKeyEntry* entry) {
+    if (entry == NULL) {
+        return;
+    }
+    entry->Ref();
+    refs_.push_back(&entry->refs_);
 }
 
 void Ticket::Pop() {
-    if (!entries_.empty()) {
-        KeyEntry* entry = entries_.back();
-        entries_.pop_back();
-        entry->UnRef();
+    if (!refs_.empty()) {
+        auto ref = refs_.back();
+        refs_.pop_back();
+        ref->fetch_sub(1, std::memory_order_relaxed);
     }
 }
 
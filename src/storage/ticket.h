@@ -17,14 +17,17 @@
 #ifndef SRC_STORAGE_TICKET_H_
 #define SRC_STORAGE_TICKET_H_
 
+#include <atomic>
 #include <vector>
 
+#include "storage/epoch.h"
 #include "storage/segment.h"
 
 namespace openmldb {
 namespace storage {
 
 class KeyEntry;
+class LatestKeyEntry;
 
 class Ticket {
  public:
@@ -34,10 +37,14 @@ class Ticket {
     Ticket& operator=(const Ticket& s) = delete;
 
     void Push(KeyEntry* entry);
+    void Push(LatestKeyEntry* entry);
     void Pop();
 
  private:
-    std::vector<KeyEntry*> entries_;
+    // the entries removed from segment are not freed until the ticket is destroyed
+    EpochGuard epoch_guard_;
+    // the refs of the entries pushed
+    std::vector<std::atomic<uint64_t>*> refs_;
 };
 
 }  // namespace storage
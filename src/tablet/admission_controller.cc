@@ -0,0 +1,280 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/admission_controller.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "bthread/bthread.h"
+#include "common/timer.h"
+
+namespace openmldb {
+namespace tablet {
+
+static uint64_t GetThreadCpuMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint64_t UpdateAverage(uint64_t avg, uint64_t value) { return avg == 0 ? value : (avg * 7 + value) / 8; }
+
+void AdmissionController::Ticket::Release() {
+    if (controller_ != nullptr) {
+        controller_->Release(this);
+        controller_ = nullptr;
+    }
+}
+
+void AdmissionController::Ticket::Rebind() {
+    if (controller_ != nullptr) {
+        start_cpu_us_ = GetThreadCpuMicros();
+        thread_ = pthread_self();
+    }
+}
+
+AdmissionController::AdmissionController(uint32_t max_concurrency, uint32_t reserved_concurrency,
+                                         const std::map<std::string, AdmissionQuota>& quotas)
+    : max_concurrency_(max_concurrency),
+      reserved_concurrency_(std::min(reserved_concurrency, max_concurrency)),
+      enabled_(max_concurrency > 0 || !quotas.empty()),
+      states_(),
+      default_state_(std::make_unique<State>("", AdmissionQuota())),
+      mu_(),
+      cv_(),
+      running_(0),
+      avg_us_(0) {
+    for (const auto& kv : quotas) {
+        states_.emplace(kv.first, std::make_unique<State>(kv.first, kv.second));
+    }
+}
+
+bool AdmissionController::ParseQuotas(const std::string& spec, std::map<std::string, AdmissionQuota>* quotas,
+                                      std::string* msg) {
+    for (absl::string_view item : absl::StrSplit(spec, ';', absl::SkipWhitespace())) {
+        item = absl::StripAsciiWhitespace(item);
+        std::vector<absl::string_view> parts = absl::StrSplit(item, absl::MaxSplits(':', 1));
+        if (parts.size() != 2 || parts[0].empty()) {
+            *msg = absl::StrCat("invalid quota ", item);
+            return false;
+        }
+        AdmissionQuota quota;
+        for (absl::string_view option : absl::StrSplit(parts[1], ',', absl::SkipWhitespace())) {
+            option = absl::StripAsciiWhitespace(option);
+            std::pair<absl::string_view, absl::string_view> kv = absl::StrSplit(option, '=');
+            bool ok = true;
+            if (kv.first == "concurrency") {
+                ok = absl::SimpleAtoi(kv.second, &quota.max_concurrency);
+            } else if (kv.first == "cpu_ms") {
+                ok = absl::SimpleAtoi(kv.second, &quota.cpu_ms_per_second);
+            } else if (kv.first == "priority") {
+                if (kv.second == "high") {
+                    quota.priority = QueryPriority::kHigh;
+                } else if (kv.second == "normal") {
+                    quota.priority = QueryPriority::kNormal;
+                } else if (kv.second == "low") {
+                    quota.priority = QueryPriority::kLow;
+                } else {
+                    ok = false;
+                }
+            } else {
+                ok = false;
+            }
+            if (!ok) {
+                *msg = absl::StrCat("invalid option ", option, " of quota ", parts[0]);
+                return false;
+            }
+        }
+        (*quotas)[std::string(parts[0])] = quota;
+    }
+    return true;
+}
+
+AdmissionController::State* AdmissionController::FindState(const std::string& db, const std::string& name) {
+    if (states_.empty()) {
+        return default_state_.get();
+    }
+    if (!name.empty()) {
+        auto it = states_.find(absl::StrCat(db, ".", name));
+        if (it != states_.end()) {
+            return it->second.get();
+        }
+    }
+    auto it = states_.find(db);
+    return it != states_.end() ? it->second.get() : default_state_.get();
+}
+
+uint32_t AdmissionController::GetLimit(QueryPriority priority) const {
+    if (max_concurrency_ == 0 || priority == QueryPriority::kHigh) {
+        return max_concurrency_;
+    }
+    // at least one slot is left to the other priorities
+    return std::max(max_concurrency_ - reserved_concurrency_, 1u);
+}
+
+bool AdmissionController::CanRunLocked(const State* state) const {
+    if (state->quota.max_concurrency > 0 && state->running >= state->quota.max_concurrency) {
+        return false;
+    }
+    uint32_t limit = GetLimit(state->quota.priority);
+    return limit == 0 || running_ < limit;
+}
+
+void AdmissionController::AdmitLocked(State* state, Ticket* ticket) {
+    running_++;
+    state->running++;
+    state->admitted_cnt++;
+    ticket->controller_ = this;
+    ticket->state_ = state;
+}
+
+uint64_t AdmissionController::EstimateQueueTimeLocked(const State* state) const {
+    // the slots are released at the rate of concurrency / average time
+    uint64_t estimated_us = 0;
+    if (state->quota.max_concurrency > 0 && state->running >= state->quota.max_concurrency) {
+        estimated_us = (state->waiting + 1) * state->avg_us / state->quota.max_concurrency;
+    }
+    uint32_t limit = GetLimit(state->quota.priority);
+    if (limit > 0 && running_ >= limit) {
+        uint64_t ahead = 1;
+        for (uint32_t idx = 0; idx <= static_cast<uint32_t>(state->quota.priority); idx++) {
+            ahead += queues_[idx].size();
+        }
+        estimated_us = std::max(estimated_us, ahead * avg_us_ / limit);
+    }
+    return estimated_us;
+}
+
+bool AdmissionController::Admit(const std::string& db, const std::string& name, uint64_t timeout_us,
+                                Ticket* ticket, std::string* msg) {
+    if (!enabled_) {
+        return true;
+    }
+    State* state = FindState(db, name);
+    uint64_t start_us = ::baidu::common::timer::get_micros();
+    uint64_t deadline_us = start_us + timeout_us;
+    if (state->quota.cpu_ms_per_second > 0) {
+        // the quota is overdrawn by the queries done, wait until it is paid off
+        uint64_t wait_us = state->cpu_bucket.Acquire(0, start_us);
+        if (wait_us > 0 && wait_us >= timeout_us) {
+            std::lock_guard<bthread::Mutex> lock(mu_);
+            state->rejected_cnt++;
+            *msg = absl::StrCat("the cpu quota of ", GetKeyName(state), " is overdrawn for ", wait_us, "us");
+            return false;
+        }
+        if (wait_us > 0) {
+            bthread_usleep(wait_us);
+        }
+    }
+    std::unique_lock<bthread::Mutex> lock(mu_);
+    // the waiters are dispatched once the slots are released, so none of them is runnable here
+    if (CanRunLocked(state)) {
+        AdmitLocked(state, ticket);
+    } else {
+        uint64_t now_us = ::baidu::common::timer::get_micros();
+        uint64_t estimated_us = EstimateQueueTimeLocked(state);
+        if (now_us + estimated_us >= deadline_us) {
+            state->rejected_cnt++;
+            *msg = absl::StrCat("the estimated queue time ", estimated_us, "us of ", GetKeyName(state),
+                                " exceeds the timeout");
+            return false;
+        }
+        auto& queue = queues_[static_cast<uint32_t>(state->quota.priority)];
+        Waiter waiter(state, ticket);
+        auto it = queue.insert(queue.end(), &waiter);
+        state->waiting++;
+        while (!waiter.admitted) {
+            now_us = ::baidu::common::timer::get_micros();
+            if (now_us >= deadline_us) {
+                queue.erase(it);
+                state->waiting--;
+                state->rejected_cnt++;
+                *msg = absl::StrCat("timeout after queued for ", now_us - start_us, "us in ", GetKeyName(state));
+                return false;
+            }
+            cv_.wait_for(lock, deadline_us - now_us);
+        }
+    }
+    lock.unlock();
+    ticket->start_us_ = ::baidu::common::timer::get_micros();
+    ticket->start_cpu_us_ = GetThreadCpuMicros();
+    ticket->thread_ = pthread_self();
+    return true;
+}
+
+void AdmissionController::DispatchLocked() {
+    bool admitted = false;
+    for (auto& queue : queues_) {
+        for (auto it = queue.begin(); it != queue.end();) {
+            Waiter* waiter = *it;
+            if (!CanRunLocked(waiter->state)) {
+                ++it;
+                continue;
+            }
+            AdmitLocked(waiter->state, waiter->ticket);
+            waiter->state->waiting--;
+            waiter->admitted = true;
+            admitted = true;
+            it = queue.erase(it);
+        }
+    }
+    if (admitted) {
+        cv_.notify_all();
+    }
+}
+
+void AdmissionController::Release(Ticket* ticket) {
+    State* state = ticket->state_;
+    uint64_t now_us = ::baidu::common::timer::get_micros();
+    uint64_t elapsed_us = now_us - ticket->start_us_;
+    if (state->quota.cpu_ms_per_second > 0) {
+        // the cpu time is unknown if the query is switched to another thread, e.g. waiting for a remote
+        // sub query, the elapsed time is charged instead
+        uint64_t cpu_us = pthread_equal(ticket->thread_, pthread_self()) ? GetThreadCpuMicros() - ticket->start_cpu_us_
+                                                                         : elapsed_us;
+        state->cpu_bucket.Acquire(cpu_us, now_us);
+    }
+    std::lock_guard<bthread::Mutex> lock(mu_);
+    running_--;
+    state->running--;
+    avg_us_ = UpdateAverage(avg_us_, elapsed_us);
+    state->avg_us = UpdateAverage(state->avg_us, elapsed_us);
+    DispatchLocked();
+}
+
+std::vector<AdmissionController::Stat> AdmissionController::GetStats() {
+    std::vector<Stat> stats;
+    std::lock_guard<bthread::Mutex> lock(mu_);
+    auto add_stat = [&stats](const State& state) {
+        stats.push_back({state.key, state.quota.priority, state.running, state.waiting, state.admitted_cnt,
+                         state.rejected_cnt, state.avg_us});
+    };
+    add_stat(*default_state_);
+    for (const auto& kv : states_) {
+        add_stat(*kv.second);
+    }
+    return stats;
+}
+
+}  // namespace tablet
+}  // namespace openmldb
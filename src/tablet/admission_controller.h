@@ -0,0 +1,162 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_ADMISSION_CONTROLLER_H_
+#define SRC_TABLET_ADMISSION_CONTROLLER_H_
+
+#include <pthread.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/token_bucket.h"
+#include "bthread/condition_variable.h"
+#include "bthread/mutex.h"
+
+namespace openmldb {
+namespace tablet {
+
+enum class QueryPriority { kHigh = 0, kNormal = 1, kLow = 2 };
+
+struct AdmissionQuota {
+    // the queries of the key running at once, 0 means no limit
+    uint32_t max_concurrency = 0;
+    // the cpu time of the queries of the key per second, 0 means no limit
+    uint64_t cpu_ms_per_second = 0;
+    QueryPriority priority = QueryPriority::kNormal;
+};
+
+// AdmissionController admits the queries by the quotas of their deployments or dbs. A query waits in the queue
+// of its priority until both the tablet and its key have a free slot, the higher priorities first and FIFO in a
+// priority. It is rejected at once if the estimated queue time exceeds its timeout, and after waiting out the
+// timeout. The key of a query is db.deployment if the deployment has a quota, or else db if the db has one, the
+// queries of the other keys share the default key without limits of its own.
+class AdmissionController {
+ private:
+    struct State;
+
+ public:
+    // a query admitted, the slots are released once it is destroyed
+    class Ticket {
+     public:
+        Ticket() : controller_(nullptr), state_(nullptr), start_us_(0), start_cpu_us_(0), thread_() {}
+        ~Ticket() { Release(); }
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        void Release();
+        // charge the cpu time of the current thread from now on, e.g. after the query is handed to another thread
+        void Rebind();
+
+     private:
+        friend class AdmissionController;
+        AdmissionController* controller_;
+        State* state_;
+        uint64_t start_us_;
+        uint64_t start_cpu_us_;
+        pthread_t thread_;
+    };
+
+    struct Stat {
+        std::string key;
+        QueryPriority priority;
+        uint32_t running;
+        uint32_t waiting;
+        uint64_t admitted_cnt;
+        uint64_t rejected_cnt;
+        uint64_t avg_us;
+    };
+
+    // max_concurrency limits the queries running at once in the tablet and 0 means no limit. the last
+    // reserved_concurrency slots of it are taken by the high priority queries only
+    AdmissionController(uint32_t max_concurrency, uint32_t reserved_concurrency,
+                        const std::map<std::string, AdmissionQuota>& quotas);
+    ~AdmissionController() {}
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // parse the quotas of `key:option=value,...;key:...`, the options are concurrency, cpu_ms and priority,
+    // e.g. db1.deploy1:concurrency=4,cpu_ms=500,priority=high;db2:priority=low
+    static bool ParseQuotas(const std::string& spec, std::map<std::string, AdmissionQuota>* quotas,
+                            std::string* msg);
+
+    bool IsEnabled() const { return enabled_; }
+
+    // admit a query of the deployment `name` of db, or an ad hoc query of db if name is empty. it waits until
+    // admitted or timeout_us passed, return false with the reason if rejected
+    bool Admit(const std::string& db, const std::string& name, uint64_t timeout_us, Ticket* ticket,
+               std::string* msg);
+
+    std::vector<Stat> GetStats();
+
+ private:
+    struct State {
+        explicit State(const std::string& k, const AdmissionQuota& q)
+            : key(k), quota(q), running(0), waiting(0), admitted_cnt(0), rejected_cnt(0), avg_us(0) {
+            cpu_bucket.SetRate(q.cpu_ms_per_second * 1000);
+        }
+        const std::string key;
+        const AdmissionQuota quota;
+        // the tokens are cpu microseconds, taken after the queries are done
+        ::openmldb::base::TokenBucket cpu_bucket;
+        uint32_t running;
+        uint32_t waiting;
+        uint64_t admitted_cnt;
+        uint64_t rejected_cnt;
+        // the moving average of the time of the queries
+        uint64_t avg_us;
+    };
+
+    struct Waiter {
+        Waiter(State* s, Ticket* t) : state(s), ticket(t), admitted(false) {}
+        State* state;
+        Ticket* ticket;
+        bool admitted;
+    };
+
+    static constexpr uint32_t kPriorityCnt = 3;
+
+    State* FindState(const std::string& db, const std::string& name);
+    static std::string GetKeyName(const State* state) { return state->key.empty() ? "default" : state->key; }
+    // the running limit of the tablet for the priority, 0 means no limit
+    uint32_t GetLimit(QueryPriority priority) const;
+    bool CanRunLocked(const State* state) const;
+    void AdmitLocked(State* state, Ticket* ticket);
+    uint64_t EstimateQueueTimeLocked(const State* state) const;
+    // admit the waiters runnable after the slots are released
+    void DispatchLocked();
+    void Release(Ticket* ticket);
+
+    const uint32_t max_concurrency_;
+    const uint32_t reserved_concurrency_;
+    bool enabled_;
+    // the states are created in the constructor and never changed
+    std::map<std::string, std::unique_ptr<State>> states_;
+    std::unique_ptr<State> default_state_;
+
+    bthread::Mutex mu_;
+    bthread::ConditionVariable cv_;
+    std::list<Waiter*> queues_[kPriorityCnt];
+    uint32_t running_;
+    uint64_t avg_us_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_ADMISSION_CONTROLLER_H_
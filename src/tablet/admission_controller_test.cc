@@ -0,0 +1,189 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/admission_controller.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace tablet {
+
+class AdmissionControllerTest : public ::testing::Test {};
+
+static void BurnCpu(uint64_t ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    uint64_t end = ts.tv_sec * 1000 + ts.tv_nsec / 1000000 + ms;
+    volatile uint64_t sum = 0;
+    do {
+        for (int i = 0; i < 10000; i++) {
+            sum += i;
+        }
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    } while (static_cast<uint64_t>(ts.tv_sec * 1000 + ts.tv_nsec / 1000000) < end);
+}
+
+TEST_F(AdmissionControllerTest, ParseQuotas) {
+    std::map<std::string, AdmissionQuota> quotas;
+    std::string msg;
+    ASSERT_TRUE(AdmissionController::ParseQuotas("db1.d1:concurrency=4,cpu_ms=500,priority=high; db2:priority=low;",
+                                                 &quotas, &msg));
+    ASSERT_EQ(2u, quotas.size());
+    ASSERT_EQ(4u, quotas["db1.d1"].max_concurrency);
+    ASSERT_EQ(500u, quotas["db1.d1"].cpu_ms_per_second);
+    ASSERT_EQ(QueryPriority::kHigh, quotas["db1.d1"].priority);
+    ASSERT_EQ(0u, quotas["db2"].max_concurrency);
+    ASSERT_EQ(QueryPriority::kLow, quotas["db2"].priority);
+
+    for (const auto& spec : {"db1", "db1:concurrency=x", "db1:priority=urgent", "db1:timeout=1", ":priority=low"}) {
+        std::map<std::string, AdmissionQuota> invalid;
+        ASSERT_FALSE(AdmissionController::ParseQuotas(spec, &invalid, &msg)) << spec;
+    }
+}
+
+TEST_F(AdmissionControllerTest, Disabled) {
+    AdmissionController controller(0, 0, {});
+    ASSERT_FALSE(controller.IsEnabled());
+    std::vector<AdmissionController::Ticket> tickets(100);
+    std::string msg;
+    for (auto& ticket : tickets) {
+        ASSERT_TRUE(controller.Admit("db", "", 0, &ticket, &msg));
+    }
+}
+
+TEST_F(AdmissionControllerTest, KeyConcurrency) {
+    AdmissionQuota quota;
+    quota.max_concurrency = 1;
+    AdmissionController controller(0, 0, {{"db.d1", quota}});
+    std::string msg;
+    AdmissionController::Ticket t1;
+    ASSERT_TRUE(controller.Admit("db", "d1", 1000000, &t1, &msg));
+    // the other keys are not limited
+    AdmissionController::Ticket t2;
+    ASSERT_TRUE(controller.Admit("db", "d2", 0, &t2, &msg));
+    AdmissionController::Ticket t3;
+    ASSERT_FALSE(controller.Admit("db", "d1", 20000, &t3, &msg));
+    ASSERT_NE(std::string::npos, msg.find("timeout")) << msg;
+
+    AdmissionController::Ticket t4;
+    std::thread waiter([&]() { ASSERT_TRUE(controller.Admit("db", "d1", 10000000, &t4, &msg)); });
+    usleep(20000);
+    t1.Release();
+    waiter.join();
+    for (const auto& stat : controller.GetStats()) {
+        if (stat.key == "db.d1") {
+            ASSERT_EQ(1u, stat.running);
+            ASSERT_EQ(0u, stat.waiting);
+            ASSERT_EQ(2u, stat.admitted_cnt);
+            ASSERT_EQ(1u, stat.rejected_cnt);
+        }
+    }
+}
+
+TEST_F(AdmissionControllerTest, Priority) {
+    AdmissionQuota high;
+    high.priority = QueryPriority::kHigh;
+    AdmissionQuota low;
+    low.priority = QueryPriority::kLow;
+    AdmissionController controller(1, 0, {{"db.high", high}, {"db.low", low}});
+    std::string msg;
+    AdmissionController::Ticket running;
+    ASSERT_TRUE(controller.Admit("db", "normal", 0, &running, &msg));
+
+    std::mutex mu;
+    std::vector<std::string> order;
+    auto run = [&](const std::string& name) {
+        AdmissionController::Ticket ticket;
+        std::string err;
+        ASSERT_TRUE(controller.Admit("db", name, 10000000, &ticket, &err)) << err;
+        std::lock_guard<std::mutex> lock(mu);
+        order.push_back(name);
+    };
+    std::thread low_thread(run, "low");
+    usleep(20000);
+    std::thread high_thread(run, "high");
+    usleep(20000);
+    running.Release();
+    low_thread.join();
+    high_thread.join();
+    ASSERT_EQ(std::vector<std::string>({"high", "low"}), order);
+}
+
+TEST_F(AdmissionControllerTest, Reserved) {
+    AdmissionQuota high;
+    high.priority = QueryPriority::kHigh;
+    AdmissionController controller(2, 1, {{"db.high", high}});
+    std::string msg;
+    AdmissionController::Ticket t1;
+    ASSERT_TRUE(controller.Admit("db", "normal", 0, &t1, &msg));
+    // the last slot is reserved for the high priority
+    AdmissionController::Ticket t2;
+    ASSERT_FALSE(controller.Admit("db", "normal", 10000, &t2, &msg));
+    AdmissionController::Ticket t3;
+    ASSERT_TRUE(controller.Admit("db", "high", 0, &t3, &msg));
+}
+
+TEST_F(AdmissionControllerTest, EstimatedQueueTime) {
+    AdmissionController controller(1, 0, {});
+    std::string msg;
+    {
+        AdmissionController::Ticket ticket;
+        ASSERT_TRUE(controller.Admit("db", "", 0, &ticket, &msg));
+        usleep(50000);
+    }
+    AdmissionController::Ticket running;
+    ASSERT_TRUE(controller.Admit("db", "", 0, &running, &msg));
+    // a query takes 50ms on average, so the one queued behind it is rejected at once
+    AdmissionController::Ticket ticket;
+    ASSERT_FALSE(controller.Admit("db", "", 10000, &ticket, &msg));
+    ASSERT_NE(std::string::npos, msg.find("estimated")) << msg;
+}
+
+TEST_F(AdmissionControllerTest, CpuQuota) {
+    AdmissionQuota quota;
+    quota.cpu_ms_per_second = 100;
+    AdmissionController controller(0, 0, {{"db", quota}});
+    std::string msg;
+    {
+        AdmissionController::Ticket ticket;
+        ASSERT_TRUE(controller.Admit("db", "d1", 0, &ticket, &msg));
+        BurnCpu(150);
+    }
+    // 150ms of cpu overdraws the quota of 100ms per second by 50ms, which is paid off in 500ms. the quota is
+    // shared by the deployments of db
+    AdmissionController::Ticket t1;
+    ASSERT_FALSE(controller.Admit("db", "d2", 100000, &t1, &msg));
+    ASSERT_NE(std::string::npos, msg.find("cpu quota")) << msg;
+    AdmissionController::Ticket t2;
+    ASSERT_TRUE(controller.Admit("db", "d2", 10000000, &t2, &msg)) << msg;
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -32,9 +32,12 @@ CombineIterator::CombineIterator(std::vector<QueryIt> q_its, uint64_t start_time
       ttl_type_(expired_value.ttl_type),
       expire_time_(expired_value.abs_ttl),
       expire_cnt_(expired_value.lat_ttl),
+      heap_(),
       cur_qit_(nullptr) {}
 
 void CombineIterator::SeekToFirst() {
+    heap_.clear();
+    cur_qit_ = nullptr;
     q_its_.erase(
         std::remove_if(q_its_.begin(), q_its_.end(), [](const QueryIt& q_it) { return !q_it.table || !q_it.it; }),
         q_its_.end());
@@ -75,65 +78,83 @@ void CombineIterator::SeekToFirst() {
     SelectIterator();
 }
 
-void CombineIterator::SelectIterator() {
-    uint64_t max_ts = 0;
-    bool need_delete = false;
-    cur_qit_ = nullptr;
-    for (auto iter = q_its_.begin(); iter != q_its_.end(); iter++) {
-        uint64_t cur_ts = 0;
-        if (iter->it && iter->it->Valid()) {
-            cur_ts = iter->it->GetKey();
-            bool is_expire = false;
-            switch (ttl_type_) {
-                case ::openmldb::storage::TTLType::kAbsoluteTime:
-                    if (expire_time_ != 0 && cur_ts <= expire_time_) {
-                        is_expire = true;
-                    }
-                    break;
-                case ::openmldb::storage::TTLType::kLatestTime:
-                    if (expire_cnt_ != 0 && iter->iter_pos >= expire_cnt_) {
-                        is_expire = true;
-                    }
-                    break;
-                case ::openmldb::storage::TTLType::kAbsAndLat:
-                    if ((expire_cnt_ != 0 && iter->iter_pos >= expire_cnt_) &&
-                        (expire_time_ != 0 && cur_ts <= expire_time_)) {
-                        is_expire = true;
-                    }
-                    break;
-                case ::openmldb::storage::TTLType::kAbsOrLat:
-                    if ((expire_cnt_ != 0 && iter->iter_pos >= expire_cnt_) ||
-                        (expire_time_ != 0 && cur_ts <= expire_time_)) {
-                        is_expire = true;
-                    }
-                    break;
-                default:
-                    break;
-            }
-            if (is_expire) {
-                iter->it.reset();
-                need_delete = true;
-                continue;
-            }
+bool CombineIterator::IsExpired(const QueryIt& q_it) const {
+    uint64_t cur_ts = q_it.it->GetKey();
+    switch (ttl_type_) {
+        case ::openmldb::storage::TTLType::kAbsoluteTime:
+            return expire_time_ != 0 && cur_ts <= expire_time_;
+        case ::openmldb::storage::TTLType::kLatestTime:
+            return expire_cnt_ != 0 && q_it.iter_pos >= expire_cnt_;
+        case ::openmldb::storage::TTLType::kAbsAndLat:
+            return (expire_cnt_ != 0 && q_it.iter_pos >= expire_cnt_) &&
+                   (expire_time_ != 0 && cur_ts <= expire_time_);
+        case ::openmldb::storage::TTLType::kAbsOrLat:
+            return (expire_cnt_ != 0 && q_it.iter_pos >= expire_cnt_) ||
+                   (expire_time_ != 0 && cur_ts <= expire_time_);
+        default:
+            return false;
+    }
+}
+
+bool CombineIterator::Before(size_t a, size_t b) const {
+    uint64_t ts_a = q_its_[a].it->GetKey();
+    uint64_t ts_b = q_its_[b].it->GetKey();
+    if (ts_a != ts_b) {
+        return ts_a > ts_b;
+    }
+    return a < b;
+}
+
+void CombineIterator::SiftDown(size_t pos) {
+    size_t size = heap_.size();
+    while (true) {
+        size_t first = pos;
+        size_t left = 2 * pos + 1;
+        size_t right = left + 1;
+        if (left < size && Before(heap_[left], heap_[first])) {
+            first = left;
         }
-        if (cur_ts > max_ts) {
-            max_ts = cur_ts;
-            cur_qit_ = &(*iter);
+        if (right < size && Before(heap_[right], heap_[first])) {
+            first = right;
+        }
+        if (first == pos) {
+            return;
+        }
+        std::swap(heap_[pos], heap_[first]);
+        pos = first;
+    }
+}
+
+void CombineIterator::SelectIterator() {
+    // an iterator leaves the heap once it is exhausted or expired. the rows of ts 0 are never returned, and the
+    // rows after them are of ts 0 too
+    heap_.clear();
+    for (size_t i = 0; i < q_its_.size(); i++) {
+        auto& q_it = q_its_[i];
+        if (q_it.it && q_it.it->Valid() && q_it.it->GetKey() > 0 && !IsExpired(q_it)) {
+            heap_.push_back(i);
         }
     }
-    if (need_delete) {
-        q_its_.erase(std::remove_if(q_its_.begin(), q_its_.end(), [](const QueryIt& q_it) { return !q_it.it; }),
-                     q_its_.end());
+    for (size_t pos = heap_.size() / 2; pos > 0; pos--) {
+        SiftDown(pos - 1);
     }
+    cur_qit_ = heap_.empty() ? nullptr : &q_its_[heap_.front()];
 }
 
 void CombineIterator::Next() {
-    if (cur_qit_ != nullptr) {
-        cur_qit_->it->Next();
-        cur_qit_->iter_pos += 1;
-        cur_qit_ = nullptr;
+    if (cur_qit_ == nullptr) {
+        return;
     }
-    SelectIterator();
+    cur_qit_->it->Next();
+    cur_qit_->iter_pos += 1;
+    if (!cur_qit_->it->Valid() || cur_qit_->it->GetKey() == 0 || IsExpired(*cur_qit_)) {
+        heap_.front() = heap_.back();
+        heap_.pop_back();
+    }
+    if (!heap_.empty()) {
+        SiftDown(0);
+    }
+    cur_qit_ = heap_.empty() ? nullptr : &q_its_[heap_.front()];
 }
 
 bool CombineIterator::Valid() { return cur_qit_ != nullptr; }
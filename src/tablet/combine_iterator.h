@@ -113,6 +113,9 @@ struct QueryIt {
     uint32_t iter_pos = 0;
 };
 
+// merge the rows of the iterators by ts descending. The iterators are kept in a binary heap by their current ts, so
+// a row costs O(log k) comparisons instead of k, and Next stops after one comparison while the same iterator keeps
+// the largest ts. On a tie the iterator earlier in q_its goes first
 class CombineIterator {
  public:
     CombineIterator(std::vector<QueryIt> q_its, uint64_t start_time, ::openmldb::api::GetType st_type,
@@ -126,10 +129,17 @@ class CombineIterator {
     inline ::openmldb::storage::TTLType GetTTLType() const { return ttl_type_; }
 
  private:
+    // whether the iterator is past the ttl at its current row
+    bool IsExpired(const QueryIt& q_it) const;
+    // whether the row of q_its_[a] goes before the one of q_its_[b]
+    bool Before(size_t a, size_t b) const;
+    void SiftDown(size_t pos);
     void SelectIterator();
 
  private:
     std::vector<QueryIt> q_its_;
+    // the indexes of the iterators with a row in q_its_, the front is the one of the current row
+    std::vector<size_t> heap_;
     const uint64_t st_;
     ::openmldb::api::GetType st_type_;
     ::openmldb::storage::TTLType ttl_type_;
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_CURSOR_STORE_H_
+#define SRC_TABLET_CURSOR_STORE_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "common/timer.h"
+
+namespace openmldb {
+namespace tablet {
+
+// The state kept between the requests of a client, keyed by the cursor id returned to it. A request takes the
+// cursor out and puts it back if the client will come again, so a cursor is used by one request at a time. The
+// idle cursors are released after the timeout and the count of them is limited, as they may hold much memory.
+template <typename CursorT>
+class CursorStore {
+ public:
+    using Cursor = CursorT;
+
+    CursorStore(uint32_t capacity, uint64_t timeout_ms)
+        : capacity_(capacity), timeout_ms_(timeout_ms), next_id_(InitCursorId()), mu_(), cursors_() {}
+
+    bool IsEnabled() const { return capacity_ > 0; }
+
+    // keep the cursor under id, or a new id if id is 0. Return the id, 0 if the cursor is not kept as the cursors
+    // are disabled or full
+    uint64_t Put(uint64_t id, std::unique_ptr<Cursor> cursor) {
+        if (!IsEnabled() || !cursor) {
+            return 0;
+        }
+        ClearExpired();
+        if (id == 0) {
+            id = next_id_.fetch_add(1, std::memory_order_relaxed);
+            if (id == 0) {
+                id = next_id_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mu_);
+        if (cursors_.size() >= capacity_ && cursors_.find(id) == cursors_.end()) {
+            // the cursor is released out of the lock with the argument
+            return 0;
+        }
+        auto& entry = cursors_[id];
+        entry.cursor = std::move(cursor);
+        entry.expire_time = NowMs() + timeout_ms_;
+        return id;
+    }
+
+    // take the cursor out, return null if it is not found or timed out
+    std::unique_ptr<Cursor> Take(uint64_t id) {
+        if (!IsEnabled() || id == 0) {
+            return {};
+        }
+        std::unique_ptr<Cursor> cursor;
+        bool expired = false;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            auto iter = cursors_.find(id);
+            if (iter == cursors_.end()) {
+                return {};
+            }
+            cursor = std::move(iter->second.cursor);
+            expired = iter->second.expire_time <= NowMs();
+            cursors_.erase(iter);
+        }
+        if (expired) {
+            cursor.reset();
+        }
+        return cursor;
+    }
+
+    // release the cursors idle for more than the timeout
+    void ClearExpired() {
+        std::vector<std::unique_ptr<Cursor>> expired;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            uint64_t now = NowMs();
+            for (auto iter = cursors_.begin(); iter != cursors_.end();) {
+                if (iter->second.expire_time <= now) {
+                    expired.emplace_back(std::move(iter->second.cursor));
+                    iter = cursors_.erase(iter);
+                } else {
+                    iter++;
+                }
+            }
+        }
+        // the expired cursors are released out of the lock
+    }
+
+    size_t Size() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return cursors_.size();
+    }
+
+ private:
+    struct Entry {
+        std::unique_ptr<Cursor> cursor;
+        uint64_t expire_time;
+    };
+
+    // the high 32 bits are random, so the ids of a restarted tablet do not hit the ones of the last run
+    static uint64_t InitCursorId() {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32) | 1;
+    }
+
+    static uint64_t NowMs() { return ::baidu::common::timer::get_micros() / 1000; }
+
+    uint32_t capacity_;
+    uint64_t timeout_ms_;
+    std::atomic<uint64_t> next_id_;
+    std::mutex mu_;
+    std::map<uint64_t, Entry> cursors_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_CURSOR_STORE_H_
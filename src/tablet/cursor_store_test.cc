@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/cursor_store.h"
+
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace tablet {
+
+class CursorStoreTest : public ::testing::Test {};
+
+struct TestCursor {
+    uint32_t tid = 0;
+};
+
+using TestCursors = CursorStore<TestCursor>;
+
+static std::unique_ptr<TestCursor> NewCursor(uint32_t tid) {
+    std::unique_ptr<TestCursor> cursor(new TestCursor());
+    cursor->tid = tid;
+    return cursor;
+}
+
+TEST_F(CursorStoreTest, Disabled) {
+    TestCursors cursors(0, 10000);
+    ASSERT_FALSE(cursors.IsEnabled());
+    ASSERT_EQ(0u, cursors.Put(0, NewCursor(1)));
+    ASSERT_FALSE(cursors.Take(1));
+}
+
+TEST_F(CursorStoreTest, PutAndTake) {
+    TestCursors cursors(2, 10000);
+    uint64_t id1 = cursors.Put(0, NewCursor(1));
+    uint64_t id2 = cursors.Put(0, NewCursor(2));
+    ASSERT_NE(0u, id1);
+    ASSERT_NE(0u, id2);
+    ASSERT_NE(id1, id2);
+    // full
+    ASSERT_EQ(0u, cursors.Put(0, NewCursor(3)));
+    ASSERT_EQ(2u, cursors.Size());
+
+    auto cursor = cursors.Take(id1);
+    ASSERT_TRUE(cursor);
+    ASSERT_EQ(1u, cursor->tid);
+    // a cursor is taken only once
+    ASSERT_FALSE(cursors.Take(id1));
+    ASSERT_EQ(id1, cursors.Put(id1, std::move(cursor)));
+    ASSERT_EQ(1u, cursors.Take(id1)->tid);
+    ASSERT_EQ(2u, cursors.Take(id2)->tid);
+    ASSERT_FALSE(cursors.Take(0));
+    ASSERT_EQ(0u, cursors.Size());
+}
+
+TEST_F(CursorStoreTest, Timeout) {
+    TestCursors cursors(16, 50);
+    uint64_t id1 = cursors.Put(0, NewCursor(1));
+    uint64_t id2 = cursors.Put(0, NewCursor(2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(cursors.Take(id1));
+    ASSERT_EQ(1u, cursors.Size());
+    cursors.ClearExpired();
+    ASSERT_EQ(0u, cursors.Size());
+    ASSERT_FALSE(cursors.Take(id2));
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
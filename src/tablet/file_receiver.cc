@@ -16,6 +16,9 @@
 
 #include "tablet/file_receiver.h"
 
+#include <errno.h>
+#include <string.h>
+
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
 #include "base/strings.h"
@@ -56,6 +59,12 @@ bool FileReceiver::Init() {
 uint64_t FileReceiver::GetBlockId() { return block_id_; }
 
 int FileReceiver::WriteData(const std::string& data, uint64_t block_id) {
+    butil::IOBuf buf;
+    buf.append(data);
+    return WriteData(buf, block_id);
+}
+
+int FileReceiver::WriteData(const butil::IOBuf& data, uint64_t block_id) {
     if (file_ == NULL) {
         PDLOG(WARNING, "file is NULL");
         return -1;
@@ -64,18 +73,17 @@ int FileReceiver::WriteData(const std::string& data, uint64_t block_id) {
         DEBUGLOG("block id %lu has been received", block_id);
         return 0;
     }
-
-#ifdef __APPLE__
-    size_t r = fwrite(data.c_str(), 1, data.size(), file_);
-#else
-    // linux
-    size_t r = fwrite_unlocked(data.c_str(), 1, data.size(), file_);
-#endif
-    if (r < data.size()) {
-        PDLOG(WARNING, "write error. name %s%s", path_.c_str(), file_name_.c_str());
-        return -1;
+    // all the data is written by fd, so nothing is left in the buffer of file
+    butil::IOBuf buf(data);
+    size_t size = buf.size();
+    while (!buf.empty()) {
+        ssize_t r = buf.cut_into_file_descriptor(fileno(file_));
+        if (r < 0 && errno != EINTR) {
+            PDLOG(WARNING, "write error. name %s%s error %s", path_.c_str(), file_name_.c_str(), strerror(errno));
+            return -1;
+        }
     }
-    size_ += r;
+    size_ += size;
     block_id_ = block_id;
     return 0;
 }
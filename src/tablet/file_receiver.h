@@ -18,6 +18,8 @@
 
 #include <string>
 
+#include "butil/iobuf.h"
+
 namespace openmldb {
 namespace tablet {
 
@@ -29,6 +31,8 @@ class FileReceiver {
     FileReceiver& operator=(const FileReceiver&) = delete;
     bool Init();
     int WriteData(const std::string& data, uint64_t block_id);
+    // write the blocks of data to file without copying them to a user buffer
+    int WriteData(const butil::IOBuf& data, uint64_t block_id);
     void SaveFile();
     uint64_t GetBlockId();
 
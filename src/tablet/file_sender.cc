@@ -16,35 +16,52 @@
 
 #include "tablet/file_sender.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
+#include "base/slice.h"
+#include "base/token_bucket.h"
 #include "boost/algorithm/string/predicate.hpp"
 #include "common/timer.h"
 #include "gflags/gflags.h"
+#include "log/sequential_file.h"
+#include "log/status.h"
 
 DECLARE_int32(send_file_max_try);
 DECLARE_uint32(stream_block_size);
 DECLARE_int32(stream_bandwidth_limit);
-DECLARE_uint32(stream_block_size);
-DECLARE_int32(stream_bandwidth_limit);
+DECLARE_uint32(stream_send_dir_thread_num);
 DECLARE_int32(stream_close_wait_time_ms);
 DECLARE_int32(retry_send_file_wait_time_ms);
 DECLARE_int32(request_max_retry);
 DECLARE_int32(request_timeout_ms);
+DECLARE_string(file_io_backend);
+DECLARE_bool(snapshot_direct_io);
 
 namespace openmldb {
 namespace tablet {
 
+// all the files sent concurrently by the tablet share the bandwidth limit
+static ::openmldb::base::TokenBucket& GetShaper() {
+    static ::openmldb::base::TokenBucket shaper;
+    return shaper;
+}
+
 FileSender::FileSender(uint32_t tid, uint32_t pid, const std::string& endpoint)
     : tid_(tid),
       pid_(pid),
       endpoint_(endpoint),
       cur_try_time_(0),
       max_try_time_(FLAGS_send_file_max_try),
-      limit_time_(0),
       channel_(NULL),
       stub_(NULL) {}
 
@@ -54,12 +71,7 @@ FileSender::~FileSender() {
 }
 
 bool FileSender::Init() {
-    // compute the used time(microseconds) that send a block by limit bandwidth.
-    // limit_time = (FLAGS_stream_block_size / FLAGS_stream_bandwidth_limit) *
-    // 1000 * 1000
-    if (FLAGS_stream_bandwidth_limit > 0) {
-        limit_time_ = (FLAGS_stream_block_size * 1000000) / FLAGS_stream_bandwidth_limit;
-    }
+    GetShaper().SetRate(FLAGS_stream_bandwidth_limit > 0 ? FLAGS_stream_bandwidth_limit : 0);
     channel_ = new brpc::Channel();
     brpc::ChannelOptions options;
     options.timeout_ms = FLAGS_request_timeout_ms;
@@ -78,7 +90,24 @@ int FileSender::WriteData(const std::string& file_name, const std::string& dir_n
     if (buffer == NULL) {
         return -1;
     }
-    uint64_t cur_time = ::baidu::common::timer::get_micros();
+    butil::IOBuf data;
+    if (block_id > 0) {
+        data.append(buffer, len);
+    }
+    return WriteData(file_name, dir_name, &data, block_id);
+}
+
+int FileSender::WriteData(const std::string& file_name, const std::string& dir_name, butil::IOBuf* data,
+                          uint64_t block_id) {
+    if (data == NULL) {
+        return -1;
+    }
+    size_t len = data->size();
+    uint64_t wait_time = GetShaper().Acquire(len, ::baidu::common::timer::get_micros());
+    if (wait_time > 0) {
+        DEBUGLOG("sleep %lu us to send %lu bytes", wait_time, len);
+        std::this_thread::sleep_for(std::chrono::microseconds(wait_time));
+    }
     ::openmldb::api::SendDataRequest request;
     request.set_tid(tid_);
     request.set_pid(pid_);
@@ -89,9 +118,7 @@ int FileSender::WriteData(const std::string& file_name, const std::string& dir_n
     request.set_block_id(block_id);
     request.set_block_size(len);
     brpc::Controller cntl;
-    if (block_id > 0) {
-        cntl.request_attachment().append(buffer, len);
-    }
+    cntl.request_attachment().swap(*data);
     if (len > 0 && len < FLAGS_stream_block_size) {
         request.set_eof(true);
     }
@@ -106,12 +133,6 @@ int FileSender::WriteData(const std::string& file_name, const std::string& dir_n
               response.msg().c_str());
         return -1;
     }
-    uint64_t time_used = ::baidu::common::timer::get_micros() - cur_time;
-    if (limit_time_ > time_used && len > FLAGS_stream_block_size / 2) {
-        uint64_t sleep_time = limit_time_ - time_used;
-        DEBUGLOG("sleep %lu us, limit_time %lu time_used %lu", sleep_time, limit_time_, time_used);
-        std::this_thread::sleep_for(std::chrono::microseconds(sleep_time));
-    }
     return 0;
 }
 
@@ -152,42 +173,78 @@ int FileSender::SendFile(const std::string& file_name, const std::string& dir_na
 
 int FileSender::SendFileInternal(const std::string& file_name, const std::string& dir_name,
                                  const std::string& full_path, uint64_t file_size) {
-    FILE* file = fopen(full_path.c_str(), "rb");
-    if (file == NULL) {
+    int fd = open(full_path.c_str(), O_RDONLY);
+    if (fd < 0) {
         PDLOG(WARNING, "fail to open file %s", full_path.c_str());
         return -1;
     }
-    char buffer[FLAGS_stream_block_size];
-
+    // on the uring backend the next block is read ahead while the current one is sent
+    std::unique_ptr<::openmldb::log::SequentialFile> seq_file;
+    std::string scratch;
+    if (FLAGS_file_io_backend == "uring") {
+        FILE* f = fdopen(fd, "rb");
+        if (f == NULL) {
+            PDLOG(WARNING, "fail to open file %s", full_path.c_str());
+            close(fd);
+            return -1;
+        }
+        seq_file.reset(::openmldb::log::NewSeqFile(full_path, f, FLAGS_snapshot_direct_io));
+        scratch.resize(FLAGS_stream_block_size);
+    }
     uint64_t block_num = file_size / FLAGS_stream_block_size + 1;
     uint64_t report_block_num = block_num / 100;
     int ret = 0;
     uint64_t block_count = 0;
+    off_t offset = 0;
     do {
-        if (block_count == 0 && WriteData(file_name, dir_name, buffer, 0, block_count) < 0) {
-            PDLOG(WARNING, "Init file receiver failed. tid[%u] pid[%u] file %s", tid_, pid_, file_name.c_str());
-            ret = -1;
-            break;
+        if (block_count == 0) {
+            butil::IOBuf empty;
+            if (WriteData(file_name, dir_name, &empty, block_count) < 0) {
+                PDLOG(WARNING, "Init file receiver failed. tid[%u] pid[%u] file %s", tid_, pid_, file_name.c_str());
+                ret = -1;
+                break;
+            }
         }
         block_count++;
-
-#ifdef __APPLE__
-        size_t len = fread(buffer, 1, FLAGS_stream_block_size, file);
-#else
-        size_t len = fread_unlocked(buffer, 1, FLAGS_stream_block_size, file);
-#endif
-        if (len < FLAGS_stream_block_size) {
-            if (feof(file)) {
-                if (len > 0) {
-                    ret = WriteData(file_name, dir_name, buffer, len, block_count);
+        butil::IOPortal data;
+        bool read_error = false;
+        if (seq_file) {
+            ::openmldb::base::Slice block;
+            ::openmldb::log::Status status = seq_file->Read(FLAGS_stream_block_size, &block, &scratch[0]);
+            if (!status.ok()) {
+                PDLOG(WARNING, "read file %s error. %s", file_name.c_str(), status.ToString().c_str());
+                ret = -1;
+                break;
+            }
+            data.append(block.data(), block.size());
+        }
+        // the file is read into the blocks of IOBuf, which are handed to brpc as the attachment without copy
+        while (!seq_file && data.size() < FLAGS_stream_block_size) {
+            ssize_t n = data.pappend_from_file_descriptor(fd, offset, FLAGS_stream_block_size - data.size());
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
                 }
+                read_error = true;
+                break;
+            } else if (n == 0) {
                 break;
             }
+            offset += n;
+        }
+        if (read_error) {
             PDLOG(WARNING, "read file %s error. error message: %s", file_name.c_str(), strerror(errno));
             ret = -1;
             break;
         }
-        if (WriteData(file_name, dir_name, buffer, len, block_count) < 0) {
+        size_t len = data.size();
+        if (len < FLAGS_stream_block_size) {
+            if (len > 0) {
+                ret = WriteData(file_name, dir_name, &data, block_count);
+            }
+            break;
+        }
+        if (WriteData(file_name, dir_name, &data, block_count) < 0) {
             PDLOG(WARNING, "data write failed. tid[%u] pid[%u] file %s", tid_, pid_, file_name.c_str());
             ret = -1;
             break;
@@ -199,7 +256,11 @@ int FileSender::SendFileInternal(const std::string& file_name, const std::string
                   block_count, block_num, tid_, pid_, file_name.c_str(), endpoint_.c_str());
         }
     } while (true);
-    fclose(file);
+    // the file closes fd
+    if (!seq_file) {
+        close(fd);
+    }
+    seq_file.reset();
     std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_stream_close_wait_time_ms));
     return ret;
 }
@@ -232,12 +293,37 @@ int FileSender::CheckFile(const std::string& file_name, const std::string& dir_n
 int FileSender::SendDir(const std::string& dir_name, const std::string& full_path) {
     std::vector<std::string> file_vec;
     ::openmldb::base::GetFileName(full_path, file_vec);
-    for (const std::string& file : file_vec) {
-        if (SendFile(file.substr(file.find_last_of("/") + 1), dir_name, file) < 0) {
-            return -1;
+    uint32_t thread_num = std::min((uint32_t)file_vec.size(), std::max(FLAGS_stream_send_dir_thread_num, 1u));
+    if (thread_num <= 1) {
+        for (const std::string& file : file_vec) {
+            if (SendFile(file.substr(file.find_last_of("/") + 1), dir_name, file) < 0) {
+                return -1;
+            }
         }
+        return 0;
     }
-    return 0;
+    // the files are sent in parallel, and the channel of brpc is thread safe
+    std::atomic<uint32_t> next(0);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < thread_num; i++) {
+        threads.emplace_back([this, &file_vec, &next, &failed, &dir_name] {
+            while (!failed.load(std::memory_order_relaxed)) {
+                uint32_t idx = next.fetch_add(1, std::memory_order_relaxed);
+                if (idx >= file_vec.size()) {
+                    break;
+                }
+                const std::string& file = file_vec[idx];
+                if (SendFile(file.substr(file.find_last_of("/") + 1), dir_name, file) < 0) {
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return failed.load(std::memory_order_relaxed) ? -1 : 0;
 }
 
 }  // namespace tablet
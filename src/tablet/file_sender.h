@@ -18,6 +18,7 @@
 
 #include <brpc/channel.h>
 #include <brpc/controller.h>
+#include <butil/iobuf.h>
 
 #include <string>
 
@@ -38,6 +39,8 @@ class FileSender {
     int SendDir(const std::string& dir_name, const std::string& full_path);
     int WriteData(const std::string& file_name, const std::string& dir_name, const char* buffer, size_t len,
                   uint64_t block_id);
+    // send the blocks of data as the attachment without copy, data is empty after return
+    int WriteData(const std::string& file_name, const std::string& dir_name, butil::IOBuf* data, uint64_t block_id);
     int CheckFile(const std::string& file_name, const std::string& dir_name, uint64_t file_size);
 
  private:
@@ -46,7 +49,6 @@ class FileSender {
     std::string endpoint_;
     uint32_t cur_try_time_;
     uint32_t max_try_time_;
-    uint64_t limit_time_;
     brpc::Channel* channel_;
     ::openmldb::api::TabletServer_Stub* stub_;
 };
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/materialized_view.h"
+
+#include <utility>
+
+#include "base/glog_wapper.h"  // NOLINT
+#include "base/hash.h"
+#include "codec/composite_key.h"
+#include "codec/schema_codec.h"
+
+namespace openmldb {
+namespace tablet {
+
+MaterializedView::MaterializedView(const std::string& db, const std::string& sp_name, const std::string& table_db,
+                                   const std::string& table, const std::string& index_name)
+    : db_(db),
+      sp_name_(sp_name),
+      table_db_(table_db),
+      table_(table),
+      index_name_(index_name),
+      init_mu_(),
+      init_failed_(false),
+      ready_(false),
+      schema_(),
+      key_cols_(),
+      ts_col_(0),
+      shards_(new Shard[kShardCnt]) {}
+
+bool MaterializedView::Init(const ::openmldb::api::TableMeta& table_meta) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(init_mu_);
+    if (IsReady()) {
+        return true;
+    } else if (init_failed_) {
+        return false;
+    }
+    init_failed_ = true;
+    if (table_meta.compress_type() != ::openmldb::type::CompressType::kNoCompress) {
+        PDLOG(WARNING, "table %s.%s compresses its rows, deployment %s.%s is not materialized", table_db_.c_str(),
+              table_.c_str(), db_.c_str(), sp_name_.c_str());
+        return false;
+    }
+    const ::openmldb::common::ColumnKey* column_key = nullptr;
+    for (const auto& cur_key : table_meta.column_key()) {
+        if (cur_key.flag() == 0 && (index_name_.empty() || cur_key.index_name() == index_name_)) {
+            column_key = &cur_key;
+            break;
+        }
+    }
+    if (column_key == nullptr || column_key->ts_name().empty()) {
+        PDLOG(WARNING, "index %s with ts is not found in table %s.%s, deployment %s.%s is not materialized",
+              index_name_.c_str(), table_db_.c_str(), table_.c_str(), db_.c_str(), sp_name_.c_str());
+        return false;
+    }
+    std::map<std::string, uint32_t> col_pos;
+    for (int i = 0; i < table_meta.column_desc_size(); i++) {
+        col_pos.emplace(table_meta.column_desc(i).name(), i);
+    }
+    std::vector<std::string> key_names(column_key->col_name().begin(), column_key->col_name().end());
+    if (key_names.empty()) {
+        key_names.push_back(column_key->index_name());
+    }
+    std::vector<uint32_t> key_cols;
+    for (const auto& name : key_names) {
+        auto iter = col_pos.find(name);
+        if (iter == col_pos.end()) {
+            PDLOG(WARNING, "key column %s is not found in table %s.%s", name.c_str(), table_db_.c_str(),
+                  table_.c_str());
+            return false;
+        }
+        key_cols.push_back(iter->second);
+    }
+    auto ts_iter = col_pos.find(column_key->ts_name());
+    if (ts_iter == col_pos.end()) {
+        PDLOG(WARNING, "ts column %s is not found in table %s.%s", column_key->ts_name().c_str(), table_db_.c_str(),
+              table_.c_str());
+        return false;
+    }
+    schema_ = table_meta.column_desc();
+    key_cols_.swap(key_cols);
+    ts_col_ = ts_iter->second;
+    init_failed_ = false;
+    ready_.store(true, std::memory_order_release);
+    PDLOG(INFO, "deployment %s.%s is materialized by index %s of table %s.%s", db_.c_str(), sp_name_.c_str(),
+          column_key->index_name().c_str(), table_db_.c_str(), table_.c_str());
+    return true;
+}
+
+bool MaterializedView::GetKey(const int8_t* row, uint32_t size, std::string* key, uint64_t* ts) const {
+    if (!IsReady()) {
+        return false;
+    }
+    ::openmldb::codec::RowView view(schema_);
+    if (!view.Reset(row, size)) {
+        return false;
+    }
+    // the same key as the sdk puts the row by
+    ::openmldb::codec::CompositeKeyBuilder key_builder;
+    std::string value;
+    for (auto col : key_cols_) {
+        if (view.IsNULL(col)) {
+            key_builder.Append(::openmldb::codec::NONETOKEN);
+            continue;
+        }
+        value.clear();
+        if (view.GetStrValue(col, &value) != 0) {
+            return false;
+        }
+        key_builder.Append(value.empty() ? ::openmldb::codec::EMPTY_STRING : value);
+    }
+    key_builder.ReleaseTo(key);
+    int64_t ts_value = 0;
+    if (!view.IsNULL(ts_col_) && view.GetInteger(row, ts_col_, schema_.Get(ts_col_).data_type(), &ts_value) != 0) {
+        return false;
+    }
+    *ts = ts_value < 0 ? 0 : static_cast<uint64_t>(ts_value);
+    return true;
+}
+
+MaterializedView::Shard& MaterializedView::GetShard(const std::string& key) const {
+    return shards_[static_cast<uint64_t>(::openmldb::base::hash64(key)) % kShardCnt];
+}
+
+std::unique_lock<std::mutex> MaterializedView::Lock(const std::string& key) {
+    return std::unique_lock<std::mutex>(GetShard(key).put_mu);
+}
+
+void MaterializedView::Put(const std::string& key, const std::shared_ptr<Output>& output) {
+    auto& shard = GetShard(key);
+    std::lock_guard<::openmldb::base::SpinMutex> lock(shard.mu);
+    shard.outputs[key] = output;
+}
+
+std::shared_ptr<MaterializedView::Output> MaterializedView::Get(const std::string& key) const {
+    auto& shard = GetShard(key);
+    std::lock_guard<::openmldb::base::SpinMutex> lock(shard.mu);
+    auto iter = shard.outputs.find(key);
+    if (iter == shard.outputs.end()) {
+        return {};
+    }
+    return iter->second;
+}
+
+void MaterializedView::Erase(const std::string& key) {
+    auto& shard = GetShard(key);
+    std::lock_guard<::openmldb::base::SpinMutex> lock(shard.mu);
+    shard.outputs.erase(key);
+}
+
+void MaterializedView::Clear() {
+    for (uint32_t i = 0; i < kShardCnt; i++) {
+        std::unordered_map<std::string, std::shared_ptr<Output>> outputs;
+        {
+            // the outputs being computed are dropped as well
+            std::lock_guard<std::mutex> put_lock(shards_[i].put_mu);
+            std::lock_guard<::openmldb::base::SpinMutex> lock(shards_[i].mu);
+            outputs.swap(shards_[i].outputs);
+        }
+    }
+}
+
+uint64_t MaterializedView::GetKeyCnt() const {
+    uint64_t cnt = 0;
+    for (uint32_t i = 0; i < kShardCnt; i++) {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(shards_[i].mu);
+        cnt += shards_[i].outputs.size();
+    }
+    return cnt;
+}
+
+void MaterializedViews::PublishUnLock() {
+    std::map<std::string, std::map<std::string, ViewList>> lists;
+    for (const auto& db_kv : views_) {
+        for (const auto& kv : db_kv.second) {
+            lists[kv.second->GetTableDB()][kv.second->GetTable()].push_back(kv.second);
+        }
+    }
+    table_views_.clear();
+    for (auto& db_kv : lists) {
+        for (auto& kv : db_kv.second) {
+            table_views_[db_kv.first][kv.first] = std::make_shared<const ViewList>(std::move(kv.second));
+        }
+    }
+    empty_.store(table_views_.empty(), std::memory_order_relaxed);
+}
+
+void MaterializedViews::AddDeployment(const std::shared_ptr<MaterializedView>& view) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    views_[view->GetDB()][view->GetSpName()] = view;
+    PublishUnLock();
+}
+
+void MaterializedViews::DropDeployment(const std::string& db, const std::string& sp_name) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto iter = views_.find(db);
+    if (iter == views_.end() || iter->second.erase(sp_name) == 0) {
+        return;
+    }
+    if (iter->second.empty()) {
+        views_.erase(iter);
+    }
+    PublishUnLock();
+}
+
+std::shared_ptr<MaterializedView> MaterializedViews::GetView(const std::string& db,
+                                                             const std::string& sp_name) const {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto iter = views_.find(db);
+    if (iter == views_.end()) {
+        return {};
+    }
+    auto sp_iter = iter->second.find(sp_name);
+    if (sp_iter == iter->second.end()) {
+        return {};
+    }
+    return sp_iter->second;
+}
+
+std::shared_ptr<const MaterializedViews::ViewList> MaterializedViews::GetViews(const std::string& table_db,
+                                                                               const std::string& table) const {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto iter = table_views_.find(table_db);
+    if (iter == table_views_.end()) {
+        return {};
+    }
+    auto table_iter = iter->second.find(table);
+    if (table_iter == iter->second.end()) {
+        return {};
+    }
+    return table_iter->second;
+}
+
+void MaterializedViews::Clear(const std::string& table_db, const std::string& table) {
+    auto views = GetViews(table_db, table);
+    if (!views) {
+        return;
+    }
+    for (const auto& view : *views) {
+        view->Clear();
+    }
+}
+
+}  // namespace tablet
+}  // namespace openmldb
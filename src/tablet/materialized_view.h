@@ -0,0 +1,155 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_MATERIALIZED_VIEW_H_
+#define SRC_TABLET_MATERIALIZED_VIEW_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/spinlock.h"
+#include "codec/codec.h"
+#include "proto/tablet.pb.h"
+
+namespace openmldb {
+namespace tablet {
+
+// the deploy option which materializes a request mode deployment, "true" to keep the outputs by the key of the
+// first index of the main table, or the name of the index to keep them by
+inline constexpr const char* MATERIALIZED = "materialized";
+
+// MaterializedView keeps the latest output of a deployment per key of an index of its main table, like a table of
+// latest 1. The output of a key is computed on every put of the key on the leader partition, with the put row as
+// the request row before it is stored, so a request whose ts is 0, that is now, is answered by the output of the
+// last put of its key without running the query.
+//
+// The windows of the deployment are expected to be partitioned by the key, and the tables joined are read as of
+// the last put of the key. The outputs are kept in memory only, a request missing them runs the query as usual.
+class MaterializedView {
+ public:
+    struct Output {
+        // the partition of the main table the output is put on, it is valid only while the partition leads
+        uint32_t tid = 0;
+        uint32_t pid = 0;
+        // the ts of the put row
+        uint64_t ts = 0;
+        ::openmldb::api::QueryResponse response;
+        std::string data;
+    };
+
+    // index_name is empty for the first index of the table
+    MaterializedView(const std::string& db, const std::string& sp_name, const std::string& table_db,
+                     const std::string& table, const std::string& index_name);
+
+    const std::string& GetDB() const { return db_; }
+    const std::string& GetSpName() const { return sp_name_; }
+    const std::string& GetTableDB() const { return table_db_; }
+    const std::string& GetTable() const { return table_; }
+
+    // resolve the columns of the key and the ts by the meta of the main table, on the first put of the table.
+    // it fails for good if the table has no such index or compresses its rows
+    bool Init(const ::openmldb::api::TableMeta& table_meta);
+    bool IsReady() const { return ready_.load(std::memory_order_acquire); }
+
+    // the key and the ts of a row of the main table, false if the row can not be decoded
+    bool GetKey(const int8_t* row, uint32_t size, std::string* key, uint64_t* ts) const;
+
+    // the puts of a key are serialized by the lock from computing the output to keeping it
+    std::unique_lock<std::mutex> Lock(const std::string& key);
+
+    void Put(const std::string& key, const std::shared_ptr<Output>& output);
+    std::shared_ptr<Output> Get(const std::string& key) const;
+    void Erase(const std::string& key);
+    void Clear();
+    uint64_t GetKeyCnt() const;
+
+ private:
+    static constexpr uint32_t kShardCnt = 64;
+
+    struct Shard {
+        // held from computing the output of a put to keeping it
+        std::mutex put_mu;
+        mutable ::openmldb::base::SpinMutex mu;
+        std::unordered_map<std::string, std::shared_ptr<Output>> outputs;
+    };
+
+    Shard& GetShard(const std::string& key) const;
+
+ private:
+    std::string db_;
+    std::string sp_name_;
+    std::string table_db_;
+    std::string table_;
+    std::string index_name_;
+    ::openmldb::base::SpinMutex init_mu_;
+    bool init_failed_;
+    std::atomic<bool> ready_;
+    ::openmldb::codec::Schema schema_;
+    std::vector<uint32_t> key_cols_;
+    uint32_t ts_col_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+// the output of a put computed before the row is stored, the key stays locked until it is kept
+struct MaterializedUpdate {
+    std::shared_ptr<MaterializedView> view;
+    std::unique_lock<std::mutex> lock;
+    std::string key;
+    std::shared_ptr<MaterializedView::Output> output;
+};
+
+// the materialized views of the deployments on this tablet
+class MaterializedViews {
+ public:
+    using ViewList = std::vector<std::shared_ptr<MaterializedView>>;
+
+    MaterializedViews() : mu_(), views_(), table_views_(), empty_(true) {}
+
+    void AddDeployment(const std::shared_ptr<MaterializedView>& view);
+    void DropDeployment(const std::string& db, const std::string& sp_name);
+
+    std::shared_ptr<MaterializedView> GetView(const std::string& db, const std::string& sp_name) const;
+
+    // the views whose main table is the table, null if there is none
+    std::shared_ptr<const ViewList> GetViews(const std::string& table_db, const std::string& table) const;
+
+    // drop the outputs of the views of the table, e.g. after a key of it is deleted
+    void Clear(const std::string& table_db, const std::string& table);
+
+    // checked on every put before looking up the views of the table
+    bool Empty() const { return empty_.load(std::memory_order_relaxed); }
+
+ private:
+    void PublishUnLock();
+
+ private:
+    mutable ::openmldb::base::SpinMutex mu_;
+    // db -> sp_name -> view
+    std::map<std::string, std::map<std::string, std::shared_ptr<MaterializedView>>> views_;
+    // table db -> table -> views, the lists are rebuilt rather than modified, so a put keeps the one it looked up
+    std::map<std::string, std::map<std::string, std::shared_ptr<const ViewList>>> table_views_;
+    std::atomic<bool> empty_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_MATERIALIZED_VIEW_H_
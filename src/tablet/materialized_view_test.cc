@@ -0,0 +1,162 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/materialized_view.h"
+
+#include <string>
+#include <vector>
+
+#include "codec/row_codec.h"
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace tablet {
+
+class MaterializedViewTest : public ::testing::Test {};
+
+static ::openmldb::api::TableMeta MakeTableMeta() {
+    ::openmldb::api::TableMeta meta;
+    meta.set_db("db1");
+    meta.set_name("t1");
+    auto col = meta.add_column_desc();
+    col->set_name("card");
+    col->set_data_type(::openmldb::type::kString);
+    col = meta.add_column_desc();
+    col->set_name("mcc");
+    col->set_data_type(::openmldb::type::kString);
+    col = meta.add_column_desc();
+    col->set_name("ts");
+    col->set_data_type(::openmldb::type::kTimestamp);
+    auto key = meta.add_column_key();
+    key->set_index_name("card_idx");
+    key->add_col_name("card");
+    key->set_ts_name("ts");
+    key = meta.add_column_key();
+    key->set_index_name("card_mcc_idx");
+    key->add_col_name("card");
+    key->add_col_name("mcc");
+    key->set_ts_name("ts");
+    return meta;
+}
+
+static std::string EncodeRow(const ::openmldb::api::TableMeta& meta, const std::vector<std::string>& values) {
+    std::string row;
+    ::openmldb::codec::RowCodec::EncodeRow(values, meta.column_desc(), 1, row);
+    return row;
+}
+
+static std::shared_ptr<MaterializedView::Output> MakeOutput(uint64_t ts, const std::string& data) {
+    auto output = std::make_shared<MaterializedView::Output>();
+    output->ts = ts;
+    output->data = data;
+    return output;
+}
+
+TEST_F(MaterializedViewTest, GetKey) {
+    auto meta = MakeTableMeta();
+    std::string row = EncodeRow(meta, {"c1", "", "1000"});
+    auto data = reinterpret_cast<const int8_t*>(row.data());
+    std::string key;
+    uint64_t ts = 0;
+
+    MaterializedView first_index("db1", "sp1", "db1", "t1", "");
+    ASSERT_FALSE(first_index.GetKey(data, row.size(), &key, &ts));
+    ASSERT_TRUE(first_index.Init(meta));
+    ASSERT_TRUE(first_index.GetKey(data, row.size(), &key, &ts));
+    ASSERT_EQ("c1", key);
+    ASSERT_EQ(1000u, ts);
+
+    MaterializedView named_index("db1", "sp2", "db1", "t1", "card_mcc_idx");
+    ASSERT_TRUE(named_index.Init(meta));
+    ASSERT_TRUE(named_index.GetKey(data, row.size(), &key, &ts));
+    ASSERT_EQ("c1|" + ::openmldb::codec::EMPTY_STRING, key);
+    row = EncodeRow(meta, {"c1", "m1", "0"});
+    ASSERT_TRUE(named_index.GetKey(reinterpret_cast<const int8_t*>(row.data()), row.size(), &key, &ts));
+    ASSERT_EQ("c1|m1", key);
+    ASSERT_EQ(0u, ts);
+    ASSERT_FALSE(named_index.GetKey(reinterpret_cast<const int8_t*>(row.data()), row.size() - 1, &key, &ts));
+
+    MaterializedView missing_index("db1", "sp3", "db1", "t1", "no_idx");
+    ASSERT_FALSE(missing_index.Init(meta));
+    ASSERT_FALSE(missing_index.IsReady());
+    auto snappy_meta = meta;
+    snappy_meta.set_compress_type(::openmldb::type::CompressType::kSnappy);
+    MaterializedView compressed("db1", "sp4", "db1", "t1", "");
+    ASSERT_FALSE(compressed.Init(snappy_meta));
+    // the failure sticks
+    ASSERT_FALSE(compressed.Init(meta));
+}
+
+TEST_F(MaterializedViewTest, Outputs) {
+    MaterializedView view("db1", "sp1", "db1", "t1", "");
+    ASSERT_FALSE(view.Get("k1"));
+    {
+        auto lock = view.Lock("k1");
+        view.Put("k1", MakeOutput(1, "v1"));
+    }
+    view.Put("k2", MakeOutput(2, "v2"));
+    view.Put("k1", MakeOutput(3, "v3"));
+    ASSERT_EQ(2u, view.GetKeyCnt());
+    ASSERT_EQ("v3", view.Get("k1")->data);
+    ASSERT_EQ(3u, view.Get("k1")->ts);
+    view.Erase("k1");
+    ASSERT_FALSE(view.Get("k1"));
+    ASSERT_EQ("v2", view.Get("k2")->data);
+    view.Clear();
+    ASSERT_EQ(0u, view.GetKeyCnt());
+}
+
+TEST_F(MaterializedViewTest, Views) {
+    MaterializedViews views;
+    ASSERT_TRUE(views.Empty());
+    auto view1 = std::make_shared<MaterializedView>("db1", "sp1", "db1", "t1", "");
+    auto view2 = std::make_shared<MaterializedView>("db1", "sp2", "db1", "t1", "card_mcc_idx");
+    auto view3 = std::make_shared<MaterializedView>("db2", "sp1", "db1", "t2", "");
+    views.AddDeployment(view1);
+    views.AddDeployment(view2);
+    views.AddDeployment(view3);
+    ASSERT_FALSE(views.Empty());
+    ASSERT_EQ(view1, views.GetView("db1", "sp1"));
+    ASSERT_EQ(view3, views.GetView("db2", "sp1"));
+    ASSERT_FALSE(views.GetView("db2", "sp2"));
+    auto list = views.GetViews("db1", "t1");
+    ASSERT_TRUE(list);
+    ASSERT_EQ(2u, list->size());
+    ASSERT_FALSE(views.GetViews("db2", "t1"));
+
+    view1->Put("k1", MakeOutput(1, "v1"));
+    view3->Put("k1", MakeOutput(1, "v1"));
+    views.Clear("db1", "t1");
+    ASSERT_FALSE(view1->Get("k1"));
+    ASSERT_TRUE(view3->Get("k1"));
+
+    views.DropDeployment("db1", "sp1");
+    // the list looked up before stays as it was
+    ASSERT_EQ(2u, list->size());
+    ASSERT_EQ(1u, views.GetViews("db1", "t1")->size());
+    views.DropDeployment("db1", "sp2");
+    ASSERT_FALSE(views.GetViews("db1", "t1"));
+    views.DropDeployment("db2", "sp1");
+    ASSERT_TRUE(views.Empty());
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_QUERY_RESULT_CURSOR_H_
+#define SRC_TABLET_QUERY_RESULT_CURSOR_H_
+
+#include <string>
+#include <vector>
+
+#include "codec/row.h"
+#include "tablet/cursor_store.h"
+
+namespace openmldb {
+namespace tablet {
+
+// The output rows of a batch query not sent yet, the client fetches them chunk by chunk
+struct QueryResultCursor {
+    std::string schema;
+    std::vector<::hybridse::codec::Row> rows;
+    // the first row not sent
+    size_t offset = 0;
+};
+
+using QueryResultCursors = CursorStore<QueryResultCursor>;
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_QUERY_RESULT_CURSOR_H_
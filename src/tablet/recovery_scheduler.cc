@@ -0,0 +1,126 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/recovery_scheduler.h"
+
+#include <utility>
+
+#include "base/glog_wapper.h"
+
+namespace openmldb {
+namespace tablet {
+
+RecoveryScheduler::RecoveryScheduler(uint32_t thread_num, uint64_t memory_budget, uint32_t disk_concurrency)
+    : memory_budget_(memory_budget),
+      disk_concurrency_(disk_concurrency),
+      stop_(false),
+      jobs_(),
+      running_cost_(0),
+      running_num_(0),
+      disk_running_(),
+      threads_() {
+    for (uint32_t i = 0; i < (thread_num == 0 ? 1 : thread_num); i++) {
+        threads_.emplace_back(&RecoveryScheduler::Run, this);
+    }
+}
+
+RecoveryScheduler::~RecoveryScheduler() { Stop(); }
+
+void RecoveryScheduler::Add(RecoveryJob job) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (stop_) {
+        return;
+    }
+    auto iter = jobs_.begin();
+    while (iter != jobs_.end() && iter->priority >= job.priority) {
+        iter++;
+    }
+    PDLOG(INFO, "add recovery job tid %u pid %u priority %d cost %lu, %lu jobs pending", job.tid, job.pid,
+          job.priority, job.cost, jobs_.size());
+    jobs_.insert(iter, std::move(job));
+    cv_.notify_all();
+}
+
+void RecoveryScheduler::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (stop_) {
+            return;
+        }
+        stop_ = true;
+        jobs_.clear();
+        cv_.notify_all();
+    }
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+uint32_t RecoveryScheduler::GetPendingNum() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return jobs_.size();
+}
+
+uint32_t RecoveryScheduler::GetRunningNum() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return running_num_;
+}
+
+std::list<RecoveryJob>::iterator RecoveryScheduler::Pick() {
+    for (auto iter = jobs_.begin(); iter != jobs_.end(); iter++) {
+        if (disk_concurrency_ > 0) {
+            auto disk_iter = disk_running_.find(iter->disk);
+            if (disk_iter != disk_running_.end() && disk_iter->second >= disk_concurrency_) {
+                // the jobs of the other disks go ahead
+                continue;
+            }
+        }
+        if (memory_budget_ > 0 && running_num_ > 0 && running_cost_ + iter->cost > memory_budget_) {
+            break;
+        }
+        return iter;
+    }
+    return jobs_.end();
+}
+
+void RecoveryScheduler::Run() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (!stop_) {
+        auto iter = Pick();
+        if (iter == jobs_.end()) {
+            cv_.wait(lock);
+            continue;
+        }
+        RecoveryJob job = std::move(*iter);
+        jobs_.erase(iter);
+        running_cost_ += job.cost;
+        running_num_++;
+        disk_running_[job.disk]++;
+        lock.unlock();
+        PDLOG(INFO, "start recovery job tid %u pid %u priority %d", job.tid, job.pid, job.priority);
+        job.task();
+        lock.lock();
+        running_cost_ -= job.cost;
+        running_num_--;
+        if (--disk_running_[job.disk] == 0) {
+            disk_running_.erase(job.disk);
+        }
+        cv_.notify_all();
+    }
+}
+
+}  // namespace tablet
+}  // namespace openmldb
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_RECOVERY_SCHEDULER_H_
+#define SRC_TABLET_RECOVERY_SCHEDULER_H_
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace openmldb {
+namespace tablet {
+
+struct RecoveryJob {
+    uint32_t tid = 0;
+    uint32_t pid = 0;
+    // the larger one is loaded first
+    int32_t priority = 0;
+    // the bytes of the snapshot and the binlog to load, which the memory taken while loading is in proportion to
+    uint64_t cost = 0;
+    // the db root path the partition is on
+    std::string disk;
+    std::function<void()> task;
+};
+
+// RecoveryScheduler loads the partitions of the tablet concurrently. The jobs are run by priority and then in the
+// order they are added, under a budget of the total cost of the running jobs and a limit of the running jobs of a
+// disk. A job over the budget runs alone. Every partition serves once its own job is done.
+class RecoveryScheduler {
+ public:
+    // memory_budget and disk_concurrency of 0 disable the limit
+    RecoveryScheduler(uint32_t thread_num, uint64_t memory_budget, uint32_t disk_concurrency);
+    ~RecoveryScheduler();
+    RecoveryScheduler(const RecoveryScheduler&) = delete;
+    RecoveryScheduler& operator=(const RecoveryScheduler&) = delete;
+
+    void Add(RecoveryJob job);
+
+    // the pending jobs are dropped, the running ones are waited for
+    void Stop();
+
+    uint32_t GetPendingNum();
+    uint32_t GetRunningNum();
+
+ private:
+    void Run();
+    // the first job to run, jobs_.end() if none. The job at the head waits for the budget rather than be passed by
+    // the smaller ones, so it never starves
+    std::list<RecoveryJob>::iterator Pick();
+
+    const uint64_t memory_budget_;
+    const uint32_t disk_concurrency_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_;
+    // sorted by priority, the order of adding within a priority
+    std::list<RecoveryJob> jobs_;
+    uint64_t running_cost_;
+    uint32_t running_num_;
+    std::map<std::string, uint32_t> disk_running_;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_RECOVERY_SCHEDULER_H_
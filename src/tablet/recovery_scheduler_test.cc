@@ -0,0 +1,159 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/recovery_scheduler.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace tablet {
+
+class RecoverySchedulerTest : public ::testing::Test {
+ public:
+    RecoverySchedulerTest() {}
+    ~RecoverySchedulerTest() {}
+};
+
+static RecoveryJob MakeJob(uint32_t pid, int32_t priority, uint64_t cost, const std::string& disk,
+                           std::function<void()> task) {
+    RecoveryJob job;
+    job.tid = 1;
+    job.pid = pid;
+    job.priority = priority;
+    job.cost = cost;
+    job.disk = disk;
+    job.task = std::move(task);
+    return job;
+}
+
+static void WaitDone(RecoveryScheduler* scheduler) {
+    while (scheduler->GetPendingNum() > 0 || scheduler->GetRunningNum() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_F(RecoverySchedulerTest, Priority) {
+    RecoveryScheduler scheduler(1, 0, 0);
+    std::promise<void> gate;
+    std::shared_future<void> gate_future = gate.get_future().share();
+    scheduler.Add(MakeJob(0, 0, 0, "/a", [gate_future] { gate_future.wait(); }));
+    while (scheduler.GetRunningNum() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::mutex mu;
+    std::vector<uint32_t> order;
+    auto record = [&](uint32_t pid) {
+        std::lock_guard<std::mutex> lock(mu);
+        order.push_back(pid);
+    };
+    scheduler.Add(MakeJob(1, 0, 0, "/a", [&] { record(1); }));
+    scheduler.Add(MakeJob(2, 2, 0, "/a", [&] { record(2); }));
+    scheduler.Add(MakeJob(3, 1, 0, "/a", [&] { record(3); }));
+    scheduler.Add(MakeJob(4, 2, 0, "/a", [&] { record(4); }));
+    scheduler.Add(MakeJob(5, 0, 0, "/a", [&] { record(5); }));
+    ASSERT_EQ(5u, scheduler.GetPendingNum());
+    gate.set_value();
+    WaitDone(&scheduler);
+    ASSERT_EQ(std::vector<uint32_t>({2, 4, 3, 1, 5}), order);
+}
+
+TEST_F(RecoverySchedulerTest, DiskConcurrency) {
+    RecoveryScheduler scheduler(4, 0, 1);
+    std::atomic<int> running_a{0};
+    std::atomic<int> max_a{0};
+    std::atomic<int> running_b{0};
+    std::atomic<int> max_b{0};
+    auto run = [](std::atomic<int>* running, std::atomic<int>* max) {
+        int cur = ++(*running);
+        int old = max->load();
+        while (cur > old && !max->compare_exchange_weak(old, cur)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        (*running)--;
+    };
+    for (uint32_t i = 0; i < 4; i++) {
+        scheduler.Add(MakeJob(i, 0, 0, "/a", [&] { run(&running_a, &max_a); }));
+        scheduler.Add(MakeJob(i, 0, 0, "/b", [&] { run(&running_b, &max_b); }));
+    }
+    WaitDone(&scheduler);
+    ASSERT_EQ(1, max_a.load());
+    ASSERT_EQ(1, max_b.load());
+}
+
+TEST_F(RecoverySchedulerTest, MemoryBudget) {
+    RecoveryScheduler scheduler(4, 100, 0);
+    std::atomic<uint64_t> running_cost{0};
+    std::atomic<uint64_t> max_cost{0};
+    std::atomic<int> done{0};
+    auto run = [&](uint64_t cost) {
+        uint64_t cur = running_cost += cost;
+        uint64_t old = max_cost.load();
+        while (cur > old && !max_cost.compare_exchange_weak(old, cur)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        running_cost -= cost;
+        done++;
+    };
+    scheduler.Add(MakeJob(0, 0, 60, "/a", [&] { run(60); }));
+    scheduler.Add(MakeJob(1, 0, 30, "/a", [&] { run(30); }));
+    // over the budget, it runs alone
+    scheduler.Add(MakeJob(2, 0, 200, "/a", [&] { run(200); }));
+    scheduler.Add(MakeJob(3, 0, 60, "/a", [&] { run(60); }));
+    scheduler.Add(MakeJob(4, 0, 40, "/a", [&] { run(40); }));
+    WaitDone(&scheduler);
+    ASSERT_EQ(5, done.load());
+    ASSERT_EQ(200u, max_cost.load());
+    ASSERT_EQ(0u, running_cost.load());
+}
+
+TEST_F(RecoverySchedulerTest, Stop) {
+    RecoveryScheduler scheduler(1, 0, 0);
+    std::promise<void> gate;
+    std::shared_future<void> gate_future = gate.get_future().share();
+    std::atomic<int> done{0};
+    scheduler.Add(MakeJob(0, 0, 0, "/a", [&] {
+        gate_future.wait();
+        done++;
+    }));
+    scheduler.Add(MakeJob(1, 0, 0, "/a", [&] { done++; }));
+    while (scheduler.GetRunningNum() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto stopped = std::async(std::launch::async, [&] { scheduler.Stop(); });
+    while (scheduler.GetPendingNum() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    gate.set_value();
+    stopped.wait();
+    // the running job is waited for and the pending one is dropped
+    ASSERT_EQ(1, done.load());
+    scheduler.Add(MakeJob(2, 0, 0, "/a", [&] { done++; }));
+    ASSERT_EQ(0u, scheduler.GetPendingNum());
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tablet/result_cache.h"
+
+namespace openmldb {
+namespace tablet {
+
+std::shared_ptr<std::atomic<uint64_t>> ResultCache::GetVersion(const std::string& db, const std::string& table) {
+    auto& version = versions_[db][table];
+    if (!version) {
+        version = std::make_shared<std::atomic<uint64_t>>(0);
+    }
+    return version;
+}
+
+void ResultCache::AddDeployment(const std::string& db, const std::string& sp_name,
+                                const std::vector<std::pair<std::string, std::string>>& tables) {
+    if (!IsEnabled()) {
+        return;
+    }
+    auto deployment = std::make_shared<Deployment>(capacity_);
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    for (const auto& kv : tables) {
+        deployment->versions.push_back(GetVersion(kv.first, kv.second));
+    }
+    deployments_[db][sp_name] = deployment;
+}
+
+void ResultCache::DropDeployment(const std::string& db, const std::string& sp_name) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto iter = deployments_.find(db);
+    if (iter != deployments_.end()) {
+        iter->second.erase(sp_name);
+    }
+}
+
+std::shared_ptr<ResultCache::Deployment> ResultCache::GetDeployment(const std::string& db,
+                                                                    const std::string& sp_name) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto iter = deployments_.find(db);
+    if (iter == deployments_.end()) {
+        return {};
+    }
+    auto sp_iter = iter->second.find(sp_name);
+    if (sp_iter == iter->second.end()) {
+        return {};
+    }
+    return sp_iter->second;
+}
+
+bool ResultCache::Get(const std::string& db, const std::string& sp_name, const std::string& key,
+                      uint64_t cur_time, Result* result, std::vector<uint64_t>* versions) {
+    auto deployment = GetDeployment(db, sp_name);
+    if (!deployment) {
+        return false;
+    }
+    versions->clear();
+    for (const auto& version : deployment->versions) {
+        versions->push_back(version->load(std::memory_order_acquire));
+    }
+    auto value = deployment->cache.Get(key);
+    if (!value) {
+        return false;
+    }
+    const auto& entry = *value;
+    if (entry->expire_time <= cur_time || entry->versions != *versions) {
+        return false;
+    }
+    *result = entry->result;
+    return true;
+}
+
+void ResultCache::Put(const std::string& db, const std::string& sp_name, const std::string& key,
+                      uint64_t cur_time, const Result& result, const std::vector<uint64_t>& versions) {
+    auto deployment = GetDeployment(db, sp_name);
+    if (!deployment || deployment->versions.size() != versions.size()) {
+        return;
+    }
+    auto entry = std::make_shared<Entry>();
+    entry->result = result;
+    entry->expire_time = cur_time + ttl_ms_;
+    entry->versions = versions;
+    deployment->cache.Upsert(key, entry);
+}
+
+void ResultCache::Invalidate(const std::string& db, const std::string& table) {
+    if (!IsEnabled()) {
+        return;
+    }
+    std::shared_ptr<std::atomic<uint64_t>> version;
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+        auto iter = versions_.find(db);
+        if (iter == versions_.end()) {
+            return;
+        }
+        auto table_iter = iter->second.find(table);
+        if (table_iter == iter->second.end()) {
+            return;
+        }
+        version = table_iter->second;
+    }
+    version->fetch_add(1, std::memory_order_acq_rel);
+}
+
+}  // namespace tablet
+}  // namespace openmldb
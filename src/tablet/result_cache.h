@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SRC_TABLET_RESULT_CACHE_H_
+#define SRC_TABLET_RESULT_CACHE_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/sharded_lru_cache.h"
+#include "base/spinlock.h"
+#include "proto/tablet.pb.h"
+
+namespace openmldb {
+namespace tablet {
+
+// The results of request mode deployments keyed by the encoded request row. An entry
+// expires after ttl and is invalid once a table read by the deployment is put on this
+// tablet, the puts to the remote partitions are only bounded by ttl.
+class ResultCache {
+ public:
+    struct Result {
+        ::openmldb::api::QueryResponse response;
+        std::string data;
+    };
+
+    ResultCache(uint32_t capacity, uint64_t ttl_ms) : capacity_(capacity), ttl_ms_(ttl_ms) {}
+
+    bool IsEnabled() const { return capacity_ > 0; }
+
+    // the tables are pairs of db and table name
+    void AddDeployment(const std::string& db, const std::string& sp_name,
+                       const std::vector<std::pair<std::string, std::string>>& tables);
+
+    void DropDeployment(const std::string& db, const std::string& sp_name);
+
+    // the versions of the tables are returned on miss and must be passed to Put, so that a put
+    // during the query makes the result invalid
+    bool Get(const std::string& db, const std::string& sp_name, const std::string& key, uint64_t cur_time,
+             Result* result, std::vector<uint64_t>* versions);
+
+    void Put(const std::string& db, const std::string& sp_name, const std::string& key, uint64_t cur_time,
+             const Result& result, const std::vector<uint64_t>& versions);
+
+    void Invalidate(const std::string& db, const std::string& table);
+
+ private:
+    struct Entry {
+        Result result;
+        uint64_t expire_time;
+        std::vector<uint64_t> versions;
+    };
+
+    struct Deployment {
+        explicit Deployment(uint32_t capacity) : versions(), cache(capacity) {}
+        std::vector<std::shared_ptr<std::atomic<uint64_t>>> versions;
+        ::openmldb::base::ShardedLRUCache<std::string, std::shared_ptr<Entry>> cache;
+    };
+
+    std::shared_ptr<Deployment> GetDeployment(const std::string& db, const std::string& sp_name);
+    std::shared_ptr<std::atomic<uint64_t>> GetVersion(const std::string& db, const std::string& table);
+
+ private:
+    uint32_t capacity_;
+    uint64_t ttl_ms_;
+    ::openmldb::base::SpinMutex mu_;
+    // db -> sp_name -> deployment
+    std::map<std::string, std::map<std::string, std::shared_ptr<Deployment>>> deployments_;
+    // db -> table -> version, the versions are kept after the deployments are dropped
+    std::map<std::string, std::map<std::string, std::shared_ptr<std::atomic<uint64_t>>>> versions_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_RESULT_CACHE_H_
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tablet/result_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace tablet {
+
+class ResultCacheTest : public ::testing::Test {};
+
+static ResultCache::Result MakeResult(const std::string& data) {
+    ResultCache::Result result;
+    result.response.set_code(0);
+    result.response.set_byte_size(data.size());
+    result.response.set_count(1);
+    result.data = data;
+    return result;
+}
+
+TEST_F(ResultCacheTest, Disabled) {
+    ResultCache cache(0, 1000);
+    ASSERT_FALSE(cache.IsEnabled());
+    cache.AddDeployment("db1", "sp1", {{"db1", "t1"}});
+    ResultCache::Result result;
+    std::vector<uint64_t> versions;
+    ASSERT_FALSE(cache.Get("db1", "sp1", "k1", 0, &result, &versions));
+    cache.Put("db1", "sp1", "k1", 0, MakeResult("v1"), versions);
+    ASSERT_FALSE(cache.Get("db1", "sp1", "k1", 0, &result, &versions));
+}
+
+TEST_F(ResultCacheTest, Expire) {
+    ResultCache cache(16, 1000);
+    cache.AddDeployment("db1", "sp1", {{"db1", "t1"}, {"db1", "t2"}});
+    ResultCache::Result result;
+    std::vector<uint64_t> versions;
+    ASSERT_FALSE(cache.Get("db1", "sp1", "k1", 100, &result, &versions));
+    ASSERT_EQ(2u, versions.size());
+    cache.Put("db1", "sp1", "k1", 100, MakeResult("v1"), versions);
+    ASSERT_TRUE(cache.Get("db1", "sp1", "k1", 1099, &result, &versions));
+    ASSERT_EQ("v1", result.data);
+    ASSERT_EQ(2u, result.response.byte_size());
+    ASSERT_FALSE(cache.Get("db1", "sp1", "k2", 1099, &result, &versions));
+    ASSERT_FALSE(cache.Get("db1", "sp2", "k1", 1099, &result, &versions));
+    ASSERT_FALSE(cache.Get("db1", "sp1", "k1", 1100, &result, &versions));
+    cache.DropDeployment("db1", "sp1");
+    ASSERT_FALSE(cache.Get("db1", "sp1", "k1", 100, &result, &versions));
+}
+
+TEST_F(ResultCacheTest, Invalidate) {
+    ResultCache cache(16, 1000);
+    cache.AddDeployment("db1", "sp1", {{"db1", "t1"}});
+    cache.AddDeployment("db1", "sp2", {{"db1", "t2"}});
+    ResultCache::Result result;
+    std::vector<uint64_t> versions1;
+    std::vector<uint64_t> versions2;
+    ASSERT_FALSE(cache.Get("db1", "sp1", "k1", 0, &result, &versions1));
+    ASSERT_FALSE(cache.Get("db1", "sp2", "k1", 0, &result, &versions2));
+    cache.Put("db1", "sp1", "k1", 0, MakeResult("v1"), versions1);
+    // the put during the query makes its result invalid
+    cache.Invalidate("db1", "t2");
+    cache.Put("db1", "sp2", "k1", 0, MakeResult("v2"), versions2);
+    ASSERT_TRUE(cache.Get("db1", "sp1", "k1", 0, &result, &versions1));
+    ASSERT_FALSE(cache.Get("db1", "sp2", "k1", 0, &result, &versions2));
+    cache.Put("db1", "sp2", "k1", 0, MakeResult("v2"), versions2);
+    ASSERT_TRUE(cache.Get("db1", "sp2", "k1", 0, &result, &versions2));
+    ASSERT_EQ("v2", result.data);
+
+    cache.Invalidate("db1", "t1");
+    cache.Invalidate("db2", "t1");
+    ASSERT_FALSE(cache.Get("db1", "sp1", "k1", 0, &result, &versions1));
+    ASSERT_TRUE(cache.Get("db1", "sp2", "k1", 0, &result, &versions2));
+}
+
+TEST_F(ResultCacheTest, Evict) {
+    ResultCache cache(2, 1000);
+    cache.AddDeployment("db1", "sp1", {});
+    ResultCache::Result result;
+    std::vector<uint64_t> versions;
+    for (int i = 0; i < 3; i++) {
+        std::string key = "k" + std::to_string(i);
+        ASSERT_FALSE(cache.Get("db1", "sp1", key, 0, &result, &versions));
+        cache.Put("db1", "sp1", key, 0, MakeResult(key), versions);
+    }
+    ASSERT_FALSE(cache.Get("db1", "sp1", "k0", 0, &result, &versions));
+    ASSERT_TRUE(cache.Get("db1", "sp1", "k1", 0, &result, &versions));
+    ASSERT_TRUE(cache.Get("db1", "sp1", "k2", 0, &result, &versions));
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tablet/slow_trace.h"
+
+#include "common/timer.h"
+
+namespace openmldb {
+namespace tablet {
+
+SlowTrace::SlowTrace() : start_time_(::baidu::common::timer::get_micros()), last_time_(start_time_), stages_() {}
+
+void SlowTrace::Mark(const char* stage) {
+    uint64_t cur_time = ::baidu::common::timer::get_micros();
+    stages_.emplace_back(stage, cur_time - last_time_);
+    last_time_ = cur_time;
+}
+
+uint64_t SlowTrace::GetElapsed() const { return ::baidu::common::timer::get_micros() - start_time_; }
+
+void SlowTraceRing::Add(const std::string& type, const std::string& desc, const SlowTrace& trace) {
+    if (capacity_ == 0) {
+        return;
+    }
+    Record record;
+    record.type = type;
+    record.desc = desc;
+    record.start_time = trace.GetStartTime();
+    record.total_us = trace.GetElapsed();
+    for (const auto& stage : trace.GetStages()) {
+        record.stages.emplace_back(stage.first, stage.second);
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    if (records_.size() < capacity_) {
+        records_.push_back(std::move(record));
+    } else {
+        records_[next_] = std::move(record);
+        next_ = (next_ + 1) % capacity_;
+    }
+}
+
+std::vector<SlowTraceRing::Record> SlowTraceRing::GetRecords() const {
+    std::vector<Record> records;
+    std::lock_guard<std::mutex> lock(mu_);
+    records.reserve(records_.size());
+    // next_ is the oldest one once the ring is full
+    for (uint32_t i = 0; i < records_.size(); i++) {
+        records.push_back(records_[(next_ + records_.size() - 1 - i) % records_.size()]);
+    }
+    return records;
+}
+
+}  // namespace tablet
+}  // namespace openmldb
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SRC_TABLET_SLOW_TRACE_H_
+#define SRC_TABLET_SLOW_TRACE_H_
+
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace openmldb {
+namespace tablet {
+
+// SlowTrace records the time of the stages of one request. A stage takes the time since the
+// previous mark, so the stages add up to the total time. The names must be string literals.
+class SlowTrace {
+ public:
+    SlowTrace();
+
+    void Mark(const char* stage);
+
+    uint64_t GetStartTime() const { return start_time_; }
+    // the time in microseconds since the trace is created
+    uint64_t GetElapsed() const;
+    const std::vector<std::pair<const char*, uint64_t>>& GetStages() const { return stages_; }
+
+ private:
+    uint64_t start_time_;
+    uint64_t last_time_;
+    std::vector<std::pair<const char*, uint64_t>> stages_;
+};
+
+// SlowTraceRing keeps the traces of the latest slow requests, the oldest one is overwritten once full
+class SlowTraceRing {
+ public:
+    struct Record {
+        // put, get, scan or query
+        std::string type;
+        // the partition and key, or the deployment or sql
+        std::string desc;
+        uint64_t start_time = 0;
+        uint64_t total_us = 0;
+        std::vector<std::pair<std::string, uint64_t>> stages;
+    };
+
+    explicit SlowTraceRing(uint32_t capacity) : capacity_(capacity), next_(0) {}
+
+    bool IsEnabled() const { return capacity_ > 0; }
+
+    void Add(const std::string& type, const std::string& desc, const SlowTrace& trace);
+
+    // the latest first
+    std::vector<Record> GetRecords() const;
+
+ private:
+    uint32_t capacity_;
+    mutable std::mutex mu_;
+    std::vector<Record> records_;
+    // the position to add the next record once the ring is full
+    uint32_t next_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_SLOW_TRACE_H_
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tablet/slow_trace.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace tablet {
+
+class SlowTraceTest : public ::testing::Test {};
+
+TEST_F(SlowTraceTest, Mark) {
+    SlowTrace trace;
+    trace.Mark("first");
+    trace.Mark("second");
+    ASSERT_EQ(2u, trace.GetStages().size());
+    ASSERT_EQ(std::string("second"), trace.GetStages()[1].first);
+    uint64_t sum = trace.GetStages()[0].second + trace.GetStages()[1].second;
+    ASSERT_LE(sum, trace.GetElapsed());
+}
+
+TEST_F(SlowTraceTest, Ring) {
+    SlowTraceRing ring(3);
+    ASSERT_TRUE(ring.IsEnabled());
+    SlowTrace trace;
+    trace.Mark("table_put");
+    for (int i = 0; i < 5; i++) {
+        ring.Add("put", std::to_string(i), trace);
+    }
+    auto records = ring.GetRecords();
+    ASSERT_EQ(3u, records.size());
+    // the latest first
+    ASSERT_EQ("4", records[0].desc);
+    ASSERT_EQ("3", records[1].desc);
+    ASSERT_EQ("2", records[2].desc);
+    ASSERT_EQ("put", records[0].type);
+    ASSERT_EQ(1u, records[0].stages.size());
+    ASSERT_EQ("table_put", records[0].stages[0].first);
+
+    SlowTraceRing disabled(0);
+    ASSERT_FALSE(disabled.IsEnabled());
+    disabled.Add("put", "0", trace);
+    ASSERT_TRUE(disabled.GetRecords().empty());
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
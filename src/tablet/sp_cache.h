@@ -17,8 +17,10 @@
 #ifndef SRC_TABLET_SP_CACHE_H_
 #define SRC_TABLET_SP_CACHE_H_
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
 
@@ -30,29 +32,59 @@ namespace tablet {
 
 using ::openmldb::base::SpinMutex;
 
+// the compile info of a procedure which may be compiled on the first use, it is shared by the snapshots of
+// the cache so the procedure is compiled at most once
+class LazyCompileInfo {
+ public:
+    using Compiler = std::function<std::shared_ptr<hybridse::vm::CompileInfo>(hybridse::base::Status*)>;
+
+    explicit LazyCompileInfo(std::shared_ptr<hybridse::vm::CompileInfo> info) : info_(std::move(info)), mu_() {}
+    explicit LazyCompileInfo(Compiler compiler) : compiler_(std::move(compiler)), info_(), mu_() {}
+
+    // compile on the first call, a failed compile is retried by the next call
+    std::shared_ptr<hybridse::vm::CompileInfo> Get(hybridse::base::Status* status) {
+        auto info = std::atomic_load_explicit(&info_, std::memory_order_acquire);
+        if (info || !compiler_) {
+            return info;
+        }
+        std::lock_guard<std::mutex> lock(mu_);
+        info = std::atomic_load_explicit(&info_, std::memory_order_acquire);
+        if (!info) {
+            info = compiler_(status);
+            std::atomic_store_explicit(&info_, info, std::memory_order_release);
+        }
+        return info;
+    }
+
+ private:
+    Compiler compiler_;
+    std::shared_ptr<hybridse::vm::CompileInfo> info_;
+    std::mutex mu_;
+};
+
 // tablet cache entry for sql procedure
 struct SQLProcedureCacheEntry {
     std::shared_ptr<hybridse::sdk::ProcedureInfo> procedure_info;
     std::shared_ptr<hybridse::vm::CompileInfo> request_info;
-    std::shared_ptr<hybridse::vm::CompileInfo> batch_request_info;
+    std::shared_ptr<LazyCompileInfo> batch_request_info;
 
     SQLProcedureCacheEntry(const std::shared_ptr<hybridse::sdk::ProcedureInfo> pinfo,
                            std::shared_ptr<hybridse::vm::CompileInfo> rinfo,
-                           std::shared_ptr<hybridse::vm::CompileInfo> brinfo)
+                           std::shared_ptr<LazyCompileInfo> brinfo)
         : procedure_info(pinfo), request_info(rinfo), batch_request_info(brinfo) {}
 };
 
 class SpCache : public hybridse::vm::CompileInfoCache {
  public:
-    SpCache() : db_sp_map_() {}
+    SpCache() : db_sp_map_(std::make_shared<const DbSpMap>()), spin_mutex_() {}
     ~SpCache() override {}
 
     // find the procedure info for input db + sp_name
     absl::StatusOr<std::shared_ptr<hybridse::sdk::ProcedureInfo>> FindSpProcedureInfo(const std::string& db,
                                                                                      const std::string& sp_name) const {
-        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-        auto sp_map_of_db = db_sp_map_.find(db);
-        if (sp_map_of_db == db_sp_map_.end()) {
+        auto db_sp_map = GetSnapshot();
+        auto sp_map_of_db = db_sp_map->find(db);
+        if (sp_map_of_db == db_sp_map->end()) {
             return absl::NotFoundError(absl::StrCat("db ", db, " not found in cache"));
         }
         auto sp_it = sp_map_of_db->second.find(sp_name);
@@ -66,29 +98,32 @@ class SpCache : public hybridse::vm::CompileInfoCache {
     void InsertSQLProcedureCacheEntry(const std::string& db, const std::string& sp_name,
                                       std::shared_ptr<hybridse::sdk::ProcedureInfo> procedure_info,
                                       std::shared_ptr<hybridse::vm::CompileInfo> request_info,
-                                      std::shared_ptr<hybridse::vm::CompileInfo> batch_request_info) {
+                                      std::shared_ptr<LazyCompileInfo> batch_request_info) {
         std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-        auto& sp_map_of_db = db_sp_map_[db];
+        auto db_sp_map = std::make_shared<DbSpMap>(*GetSnapshot());
+        auto& sp_map_of_db = (*db_sp_map)[db];
         sp_map_of_db.insert(
             std::make_pair(sp_name, SQLProcedureCacheEntry(procedure_info, request_info, batch_request_info)));
+        SetSnapshot(db_sp_map);
     }
 
     void DropSQLProcedureCacheEntry(const std::string& db, const std::string& sp_name) {
         std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-        db_sp_map_[db].erase(sp_name);
+        auto db_sp_map = std::make_shared<DbSpMap>(*GetSnapshot());
+        (*db_sp_map)[db].erase(sp_name);
+        SetSnapshot(db_sp_map);
         return;
     }
     const bool ProcedureExist(const std::string& db, const std::string& sp_name) {
-        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-        auto& sp_map_of_db = db_sp_map_[db];
-        auto sp_it = sp_map_of_db.find(sp_name);
-        return sp_it != sp_map_of_db.end();
+        auto db_sp_map = GetSnapshot();
+        auto db_it = db_sp_map->find(db);
+        return db_it != db_sp_map->end() && db_it->second.count(sp_name) > 0;
     }
     std::shared_ptr<hybridse::vm::CompileInfo> GetRequestInfo(const std::string& db, const std::string& sp_name,
                                                               hybridse::base::Status& status) override {  // NOLINT
-        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-        auto db_it = db_sp_map_.find(db);
-        if (db_it == db_sp_map_.end()) {
+        auto db_sp_map = GetSnapshot();
+        auto db_it = db_sp_map->find(db);
+        if (db_it == db_sp_map->end()) {
             status = hybridse::base::Status(hybridse::common::kProcedureNotFound,
                                             "store procedure[" + sp_name + "] not found in db[" + db + "]");
             return std::shared_ptr<hybridse::vm::CompileInfo>();
@@ -109,9 +144,9 @@ class SpCache : public hybridse::vm::CompileInfoCache {
     }
     std::shared_ptr<hybridse::vm::CompileInfo> GetBatchRequestInfo(const std::string& db, const std::string& sp_name,
                                                                    hybridse::base::Status& status) override {  // NOLINT
-        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-        auto db_it = db_sp_map_.find(db);
-        if (db_it == db_sp_map_.end()) {
+        auto db_sp_map = GetSnapshot();
+        auto db_it = db_sp_map->find(db);
+        if (db_it == db_sp_map->end()) {
             status = hybridse::base::Status(hybridse::common::kProcedureNotFound,
                                             "store procedure[" + sp_name + "] not found in db[" + db + "]");
             return std::shared_ptr<hybridse::vm::CompileInfo>();
@@ -127,11 +162,29 @@ class SpCache : public hybridse::vm::CompileInfoCache {
                                             "store procedure[" + sp_name + "] not found in db[" + db + "]");
             return std::shared_ptr<hybridse::vm::CompileInfo>();
         }
-        return sp_it->second.batch_request_info;
+        auto info = sp_it->second.batch_request_info->Get(&status);
+        if (!info && status.isOK()) {
+            status = hybridse::base::Status(hybridse::common::kProcedureNotFound,
+                                            "store procedure[" + sp_name + "] not found in db[" + db + "]");
+        }
+        return info;
+    }
+
+ private:
+    using DbSpMap = std::map<std::string, std::map<std::string, SQLProcedureCacheEntry>>;
+
+    std::shared_ptr<const DbSpMap> GetSnapshot() const {
+        return std::atomic_load_explicit(&db_sp_map_, std::memory_order_acquire);
+    }
+
+    void SetSnapshot(const std::shared_ptr<DbSpMap>& db_sp_map) {
+        std::atomic_store_explicit(&db_sp_map_, std::shared_ptr<const DbSpMap>(db_sp_map), std::memory_order_release);
     }
 
  private:
-    std::map<std::string, std::map<std::string, SQLProcedureCacheEntry>> db_sp_map_;
+    // copy on write, the lookups of every query load the snapshot without lock and
+    // spin_mutex_ only serializes the writers
+    std::shared_ptr<const DbSpMap> db_sp_map_;
     mutable SpinMutex spin_mutex_;
 };
 
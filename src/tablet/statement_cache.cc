@@ -0,0 +1,101 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/statement_cache.h"
+
+#include <random>
+
+namespace openmldb {
+namespace tablet {
+
+static uint64_t InitStatementId() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | 1;
+}
+
+StatementCache::StatementCache(uint32_t capacity)
+    : capacity_(capacity), next_id_(InitStatementId()), cache_(capacity > 0 ? capacity : 1), mu_(), versions_() {}
+
+std::shared_ptr<std::atomic<uint64_t>> StatementCache::GetDbVersion(const std::string& db) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto& version = versions_[db];
+    if (!version) {
+        version = std::make_shared<std::atomic<uint64_t>>(0);
+    }
+    return version;
+}
+
+uint64_t StatementCache::GetVersion(const std::string& db) {
+    if (!IsEnabled()) {
+        return 0;
+    }
+    return GetDbVersion(db)->load(std::memory_order_acquire);
+}
+
+uint64_t StatementCache::Put(const std::string& db, const std::string& sql,
+                             const ::hybridse::vm::BatchRunSession& session, uint64_t version) {
+    if (!IsEnabled()) {
+        return 0;
+    }
+    auto statement = std::make_shared<Statement>();
+    statement->db = db;
+    statement->sql = sql;
+    statement->session = std::make_shared<const ::hybridse::vm::BatchRunSession>(session);
+    statement->db_version = GetDbVersion(db);
+    statement->version = version;
+    uint64_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    if (id == 0) {
+        id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    }
+    cache_.Upsert(id, statement);
+    return id;
+}
+
+std::shared_ptr<const StatementCache::Statement> StatementCache::Get(uint64_t id) {
+    if (!IsEnabled() || id == 0) {
+        return {};
+    }
+    auto value = cache_.Get(id);
+    if (!value) {
+        return {};
+    }
+    const auto& statement = *value;
+    if (statement->db_version->load(std::memory_order_acquire) != statement->version) {
+        cache_.Remove(id);
+        return {};
+    }
+    return statement;
+}
+
+void StatementCache::Invalidate(const std::string& db) {
+    if (!IsEnabled()) {
+        return;
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    if (db.empty()) {
+        for (auto& kv : versions_) {
+            kv.second->fetch_add(1, std::memory_order_acq_rel);
+        }
+        return;
+    }
+    auto iter = versions_.find(db);
+    if (iter != versions_.end()) {
+        iter->second->fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+}  // namespace tablet
+}  // namespace openmldb
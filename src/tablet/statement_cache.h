@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_STATEMENT_CACHE_H_
+#define SRC_TABLET_STATEMENT_CACHE_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "base/sharded_lru_cache.h"
+#include "base/spinlock.h"
+#include "vm/engine.h"
+
+namespace openmldb {
+namespace tablet {
+
+// The batch queries prepared by the sdk, keyed by the statement id returned to it. The compiled session of a
+// statement is copied for every execution, so the sql is neither sent nor compiled again. A statement is
+// invalid once the engine cache of its db is cleared, and the sdk prepares it again on not found.
+class StatementCache {
+ public:
+    struct Statement {
+        std::string db;
+        std::string sql;
+        std::shared_ptr<const ::hybridse::vm::BatchRunSession> session;
+        std::shared_ptr<std::atomic<uint64_t>> db_version;
+        uint64_t version;
+    };
+
+    explicit StatementCache(uint32_t capacity);
+
+    bool IsEnabled() const { return capacity_ > 0; }
+
+    // the version of db should be taken before compiling the statement and passed to Put, so that the statement
+    // is invalid if the engine cache is cleared meanwhile
+    uint64_t GetVersion(const std::string& db);
+
+    // return the id of the statement, 0 if the cache is disabled
+    uint64_t Put(const std::string& db, const std::string& sql, const ::hybridse::vm::BatchRunSession& session,
+                 uint64_t version);
+
+    // return null if the statement is not found or invalid
+    std::shared_ptr<const Statement> Get(uint64_t id);
+
+    // invalidate the statements of db, all of them if db is empty
+    void Invalidate(const std::string& db);
+
+ private:
+    std::shared_ptr<std::atomic<uint64_t>> GetDbVersion(const std::string& db);
+
+ private:
+    uint32_t capacity_;
+    // the high 32 bits are random, so the ids of a restarted tablet do not hit the ones of the last run
+    std::atomic<uint64_t> next_id_;
+    ::openmldb::base::ShardedLRUCache<uint64_t, std::shared_ptr<const Statement>> cache_;
+    ::openmldb::base::SpinMutex mu_;
+    std::map<std::string, std::shared_ptr<std::atomic<uint64_t>>> versions_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_STATEMENT_CACHE_H_
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/statement_cache.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace tablet {
+
+class StatementCacheTest : public ::testing::Test {};
+
+TEST_F(StatementCacheTest, Disabled) {
+    StatementCache cache(0);
+    ASSERT_FALSE(cache.IsEnabled());
+    ::hybridse::vm::BatchRunSession session;
+    ASSERT_EQ(0u, cache.Put("db1", "select 1;", session, cache.GetVersion("db1")));
+    ASSERT_FALSE(cache.Get(0));
+}
+
+TEST_F(StatementCacheTest, PutAndGet) {
+    StatementCache cache(16);
+    ::hybridse::vm::BatchRunSession session;
+    uint64_t id1 = cache.Put("db1", "select 1;", session, cache.GetVersion("db1"));
+    uint64_t id2 = cache.Put("db1", "select 2;", session, cache.GetVersion("db1"));
+    ASSERT_NE(0u, id1);
+    ASSERT_NE(id1, id2);
+    auto statement = cache.Get(id1);
+    ASSERT_TRUE(statement);
+    ASSERT_EQ("db1", statement->db);
+    ASSERT_EQ("select 1;", statement->sql);
+    ASSERT_TRUE(statement->session);
+    ASSERT_EQ("select 2;", cache.Get(id2)->sql);
+    ASSERT_FALSE(cache.Get(id2 + 1));
+
+    // the ids of another tablet are not found
+    StatementCache other(16);
+    ASSERT_FALSE(other.Get(id1));
+}
+
+TEST_F(StatementCacheTest, Evict) {
+    StatementCache cache(1);
+    ::hybridse::vm::BatchRunSession session;
+    uint64_t id1 = cache.Put("db1", "select 1;", session, cache.GetVersion("db1"));
+    uint64_t id2 = cache.Put("db1", "select 2;", session, cache.GetVersion("db1"));
+    ASSERT_FALSE(cache.Get(id1));
+    ASSERT_TRUE(cache.Get(id2));
+}
+
+TEST_F(StatementCacheTest, Invalidate) {
+    StatementCache cache(16);
+    ::hybridse::vm::BatchRunSession session;
+    uint64_t id1 = cache.Put("db1", "select 1;", session, cache.GetVersion("db1"));
+    uint64_t id2 = cache.Put("db2", "select 1;", session, cache.GetVersion("db2"));
+    cache.Invalidate("db1");
+    ASSERT_FALSE(cache.Get(id1));
+    ASSERT_TRUE(cache.Get(id2));
+
+    // the cache is cleared between compiling and putting
+    uint64_t version = cache.GetVersion("db2");
+    cache.Invalidate("db2");
+    uint64_t id3 = cache.Put("db2", "select 2;", session, version);
+    ASSERT_FALSE(cache.Get(id3));
+
+    uint64_t id4 = cache.Put("db1", "select 2;", session, cache.GetVersion("db1"));
+    ASSERT_TRUE(cache.Get(id4));
+    cache.Invalidate("");
+    ASSERT_FALSE(cache.Get(id2));
+    ASSERT_FALSE(cache.Get(id4));
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
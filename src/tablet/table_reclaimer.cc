@@ -0,0 +1,108 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/table_reclaimer.h"
+
+#include <chrono>  // NOLINT
+#include <utility>
+
+#include "base/glog_wapper.h"
+#include "common/timer.h"
+#include "storage/mem_table.h"
+
+namespace openmldb {
+namespace tablet {
+
+// how often the tables still referred to are checked
+static constexpr uint32_t kCheckIntervalMs = 1000;
+
+TableReclaimer::TableReclaimer(uint32_t key_cnt, uint32_t interval_ms)
+    : key_cnt_(key_cnt), interval_ms_(interval_ms), stop_(false), tables_(), thread_(&TableReclaimer::Run, this) {}
+
+TableReclaimer::~TableReclaimer() { Stop(); }
+
+void TableReclaimer::Add(std::shared_ptr<::openmldb::storage::Table> table) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (stop_) {
+        return;
+    }
+    PDLOG(INFO, "add dropped table to reclaim. tid %u pid %u, %lu tables pending", table->GetId(), table->GetPid(),
+          tables_.size());
+    tables_.push_back(std::move(table));
+    cv_.notify_all();
+}
+
+void TableReclaimer::Stop() {
+    std::list<std::shared_ptr<::openmldb::storage::Table>> tables;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (stop_) {
+            return;
+        }
+        stop_ = true;
+        tables.swap(tables_);
+        cv_.notify_all();
+    }
+    thread_.join();
+}
+
+uint32_t TableReclaimer::GetPendingNum() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return tables_.size();
+}
+
+void TableReclaimer::Pause() {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait_for(lock, std::chrono::milliseconds(interval_ms_), [this] { return stop_; });
+}
+
+void TableReclaimer::Reclaim(std::shared_ptr<::openmldb::storage::Table> table) {
+    auto mem_table = std::dynamic_pointer_cast<::openmldb::storage::MemTable>(table);
+    if (mem_table) {
+        uint64_t start = ::baidu::common::timer::get_micros();
+        uint64_t cnt = mem_table->ReleaseForDrop(key_cnt_, [this] { Pause(); });
+        PDLOG(INFO, "reclaim dropped table tid %u pid %u with %lu records in %lu us", table->GetId(),
+              table->GetPid(), cnt, ::baidu::common::timer::get_micros() - start);
+    }
+    // the rest is freed with the last reference
+}
+
+void TableReclaimer::Run() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (!stop_) {
+        auto iter = tables_.begin();
+        while (iter != tables_.end() && iter->use_count() > 1) {
+            iter++;
+        }
+        if (iter == tables_.end()) {
+            if (tables_.empty()) {
+                cv_.wait(lock);
+            } else {
+                // the readers left are waited for
+                cv_.wait_for(lock, std::chrono::milliseconds(kCheckIntervalMs));
+            }
+            continue;
+        }
+        auto table = std::move(*iter);
+        tables_.erase(iter);
+        lock.unlock();
+        Reclaim(std::move(table));
+        lock.lock();
+    }
+}
+
+}  // namespace tablet
+}  // namespace openmldb
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_TABLE_RECLAIMER_H_
+#define SRC_TABLET_TABLE_RECLAIMER_H_
+
+#include <condition_variable>  // NOLINT
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "storage/table.h"
+
+namespace openmldb {
+namespace tablet {
+
+// TableReclaimer frees the memory of the dropped partitions in the background, so a drop returns once the partition
+// is unlinked from the tablet. A partition is released after the last reader of it is gone, key_cnt keys at a time
+// with a pause of interval_ms in between, so a large partition does not hold the allocator and the cpu for long.
+class TableReclaimer {
+ public:
+    TableReclaimer(uint32_t key_cnt, uint32_t interval_ms);
+    ~TableReclaimer();
+    TableReclaimer(const TableReclaimer&) = delete;
+    TableReclaimer& operator=(const TableReclaimer&) = delete;
+
+    // the table must have been unlinked from the tablet. only the memory tables are reclaimed here, a disk table
+    // keeps its rocksdb open until released and must be closed before its data directory is moved
+    void Add(std::shared_ptr<::openmldb::storage::Table> table);
+
+    // the pending tables are released at once
+    void Stop();
+
+    uint32_t GetPendingNum();
+
+ private:
+    void Run();
+    void Reclaim(std::shared_ptr<::openmldb::storage::Table> table);
+    // the pause between the chunks, cut short by Stop
+    void Pause();
+
+    const uint32_t key_cnt_;
+    const uint32_t interval_ms_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_;
+    std::list<std::shared_ptr<::openmldb::storage::Table>> tables_;
+    std::thread thread_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_TABLE_RECLAIMER_H_
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/table_reclaimer.h"
+
+#include <gflags/gflags.h>
+
+#include <chrono>  // NOLINT
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+#include "storage/mem_table.h"
+
+DECLARE_bool(enable_data_block_pool);
+
+namespace openmldb {
+namespace tablet {
+
+using ::openmldb::storage::MemTable;
+
+class TableReclaimerTest : public ::testing::Test {
+ public:
+    TableReclaimerTest() {}
+    ~TableReclaimerTest() {}
+};
+
+static std::shared_ptr<MemTable> CreateTable(uint32_t pid, uint32_t key_cnt) {
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    auto table = std::make_shared<MemTable>("t1", 1, pid, 8, mapping, 0, ::openmldb::type::kAbsoluteTime);
+    table->Init();
+    for (uint32_t i = 0; i < key_cnt; i++) {
+        std::string key = "key" + std::to_string(i);
+        table->Put(key, 1000 + i, "value", 5);
+        table->Put(key, 2000 + i, "value", 5);
+    }
+    return table;
+}
+
+static void WaitDone(TableReclaimer* reclaimer) {
+    while (reclaimer->GetPendingNum() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_F(TableReclaimerTest, ReleaseForDrop) {
+    for (bool pooled : {false, true}) {
+        FLAGS_enable_data_block_pool = pooled;
+        auto table = CreateTable(1, 100);
+        uint32_t yield_cnt = 0;
+        ASSERT_EQ(200u, table->ReleaseForDrop(10, [&yield_cnt] { yield_cnt++; }));
+        ASSERT_GE(yield_cnt, 2u);
+        // released once
+        ASSERT_EQ(0u, table->ReleaseForDrop(10, nullptr));
+    }
+    FLAGS_enable_data_block_pool = false;
+}
+
+TEST_F(TableReclaimerTest, WaitReaders) {
+    TableReclaimer reclaimer(10, 1);
+    auto table = CreateTable(1, 100);
+    std::weak_ptr<MemTable> weak_table = table;
+    auto reader = table;
+    reclaimer.Add(std::move(table));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // still referred to
+    ASSERT_EQ(1u, reclaimer.GetPendingNum());
+    ASSERT_EQ(200u, reader->GetRecordCnt());
+    reader.reset();
+    WaitDone(&reclaimer);
+    while (!weak_table.expired()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_F(TableReclaimerTest, Stop) {
+    TableReclaimer reclaimer(1, 1000);
+    std::weak_ptr<MemTable> weak_table;
+    {
+        auto table = CreateTable(1, 1000);
+        weak_table = table;
+        reclaimer.Add(std::move(table));
+    }
+    auto start = std::chrono::steady_clock::now();
+    reclaimer.Stop();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+    ASSERT_TRUE(weak_table.expired());
+    ASSERT_EQ(0u, reclaimer.GetPendingNum());
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
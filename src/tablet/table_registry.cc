@@ -0,0 +1,73 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/table_registry.h"
+
+#include <thread>  // NOLINT
+#include <utility>
+
+namespace openmldb {
+namespace tablet {
+
+TableRegistry::TableRegistry() : current_(new Partitions()), version_(0), slots_(), publish_mu_() {
+    for (auto& slot : slots_) {
+        slot.readers[0].store(0, std::memory_order_relaxed);
+        slot.readers[1].store(0, std::memory_order_relaxed);
+    }
+}
+
+TableRegistry::~TableRegistry() { delete current_.load(std::memory_order_relaxed); }
+
+uint32_t TableRegistry::GetSlot() {
+    static std::atomic<uint32_t> next_slot(0);
+    static thread_local uint32_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % kSlotCnt;
+    return slot;
+}
+
+const TableRegistry::Partitions* TableRegistry::Pin(uint32_t slot, uint64_t* version) const {
+    while (true) {
+        uint64_t cur = version_.load(std::memory_order_seq_cst);
+        slots_[slot].readers[cur & 1].fetch_add(1, std::memory_order_seq_cst);
+        // the version may be switched before the reader is counted, then Publish may not wait for it and the
+        // reader must pin the new version
+        if (version_.load(std::memory_order_seq_cst) == cur) {
+            *version = cur;
+            return current_.load(std::memory_order_seq_cst);
+        }
+        slots_[slot].readers[cur & 1].fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+void TableRegistry::Unpin(uint32_t slot, uint64_t version) const {
+    slots_[slot].readers[version & 1].fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void TableRegistry::Publish(Partitions partitions) {
+    std::lock_guard<std::mutex> lock(publish_mu_);
+    const Partitions* old = current_.exchange(new Partitions(std::move(partitions)), std::memory_order_seq_cst);
+    uint64_t version = version_.fetch_add(1, std::memory_order_seq_cst);
+    // the readers of the old parity may still read the old version. The readers of the version before it were
+    // waited by the last Publish, and the new readers count in the other parity, so the wait is short
+    for (auto& slot : slots_) {
+        while (slot.readers[version & 1].load(std::memory_order_seq_cst) > 0) {
+            std::this_thread::yield();
+        }
+    }
+    delete old;
+}
+
+}  // namespace tablet
+}  // namespace openmldb
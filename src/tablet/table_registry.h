@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_TABLE_REGISTRY_H_
+#define SRC_TABLET_TABLE_REGISTRY_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "replica/log_replicator.h"
+#include "storage/aggregator.h"
+#include "storage/snapshot.h"
+#include "storage/table.h"
+
+namespace openmldb {
+namespace tablet {
+
+// TableRegistry publishes the partitions of the tablet to the lookups of the requests. A lookup reads an immutable
+// version of the partitions without any lock. A writer builds a new version and publishes it, then the old version
+// is freed once the lookups which may still read it are gone.
+class TableRegistry {
+ public:
+    struct Partition {
+        std::shared_ptr<::openmldb::storage::Table> table;
+        std::shared_ptr<::openmldb::replica::LogReplicator> replicator;
+        std::shared_ptr<::openmldb::storage::Snapshot> snapshot;
+        std::shared_ptr<::openmldb::storage::Aggrs> aggrs;
+    };
+    // keyed by GetUid
+    using Partitions = std::unordered_map<uint64_t, Partition>;
+
+    TableRegistry();
+    ~TableRegistry();
+    TableRegistry(const TableRegistry&) = delete;
+    TableRegistry& operator=(const TableRegistry&) = delete;
+
+    static uint64_t GetUid(uint32_t tid, uint32_t pid) { return static_cast<uint64_t>(tid) << 32 | pid; }
+
+    std::shared_ptr<::openmldb::storage::Table> GetTable(uint32_t tid, uint32_t pid) const {
+        return Get(tid, pid, &Partition::table);
+    }
+    std::shared_ptr<::openmldb::replica::LogReplicator> GetReplicator(uint32_t tid, uint32_t pid) const {
+        return Get(tid, pid, &Partition::replicator);
+    }
+    std::shared_ptr<::openmldb::storage::Snapshot> GetSnapshot(uint32_t tid, uint32_t pid) const {
+        return Get(tid, pid, &Partition::snapshot);
+    }
+    std::shared_ptr<::openmldb::storage::Aggrs> GetAggrs(uint32_t tid, uint32_t pid) const {
+        return Get(tid, pid, &Partition::aggrs);
+    }
+
+    // replace the published partitions, it returns after the old version is freed. The members of a partition
+    // must not be modified after it is published
+    void Publish(Partitions partitions);
+
+ private:
+    static constexpr uint32_t kSlotCnt = 64;
+
+    // the lookups of one slot are counted by the parity of the version they pin
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> readers[2];
+    };
+
+    template <class T>
+    std::shared_ptr<T> Get(uint32_t tid, uint32_t pid, std::shared_ptr<T> Partition::*member) const {
+        uint32_t slot = GetSlot();
+        uint64_t version = 0;
+        const Partitions* partitions = Pin(slot, &version);
+        std::shared_ptr<T> value;
+        auto it = partitions->find(GetUid(tid, pid));
+        if (it != partitions->end()) {
+            value = it->second.*member;
+        }
+        Unpin(slot, version);
+        return value;
+    }
+
+    static uint32_t GetSlot();
+    const Partitions* Pin(uint32_t slot, uint64_t* version) const;
+    void Unpin(uint32_t slot, uint64_t version) const;
+
+    std::atomic<const Partitions*> current_;
+    std::atomic<uint64_t> version_;
+    mutable ReaderSlot slots_[kSlotCnt];
+    // the writers publish one by one
+    std::mutex publish_mu_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_TABLE_REGISTRY_H_
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/table_registry.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/mem_table.h"
+
+namespace openmldb {
+namespace tablet {
+
+using ::openmldb::storage::MemTable;
+
+class TableRegistryTest : public ::testing::Test {
+ public:
+    TableRegistryTest() {}
+    ~TableRegistryTest() {}
+};
+
+static std::shared_ptr<MemTable> CreateTable(uint32_t tid, uint32_t pid) {
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    auto table = std::make_shared<MemTable>("t1", tid, pid, 8, mapping, 0, ::openmldb::type::kAbsoluteTime);
+    table->Init();
+    return table;
+}
+
+TEST_F(TableRegistryTest, PublishAndGet) {
+    TableRegistry registry;
+    ASSERT_FALSE(registry.GetTable(1, 0));
+
+    auto table = CreateTable(1, 0);
+    auto aggrs = std::make_shared<::openmldb::storage::Aggrs>();
+    TableRegistry::Partitions partitions;
+    partitions[TableRegistry::GetUid(1, 0)].table = table;
+    partitions[TableRegistry::GetUid(2, 1)].aggrs = aggrs;
+    registry.Publish(partitions);
+    ASSERT_EQ(table, registry.GetTable(1, 0));
+    ASSERT_FALSE(registry.GetReplicator(1, 0));
+    ASSERT_FALSE(registry.GetSnapshot(1, 0));
+    ASSERT_FALSE(registry.GetTable(1, 1));
+    ASSERT_EQ(aggrs, registry.GetAggrs(2, 1));
+    ASSERT_FALSE(registry.GetTable(2, 1));
+
+    // the old version is freed once published
+    partitions.clear();
+    registry.Publish(partitions);
+    ASSERT_FALSE(registry.GetTable(1, 0));
+    ASSERT_EQ(1, table.use_count());
+}
+
+TEST_F(TableRegistryTest, ReadWhilePublish) {
+    TableRegistry registry;
+    auto table = CreateTable(1, 0);
+    TableRegistry::Partitions partitions;
+    partitions[TableRegistry::GetUid(1, 0)].table = table;
+    registry.Publish(partitions);
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> miss(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 8; i++) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (registry.GetTable(1, 0) != table) {
+                    miss++;
+                }
+            }
+        });
+    }
+    // the partition of table is kept in every version
+    for (uint32_t pid = 1; pid <= 200; pid++) {
+        partitions[TableRegistry::GetUid(2, pid)].table = CreateTable(2, pid);
+        registry.Publish(partitions);
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    ASSERT_EQ(0u, miss.load());
+    ASSERT_TRUE(registry.GetTable(2, 200));
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -17,11 +17,15 @@
 #include "tablet/tablet_impl.h"
 
 #include <gflags/gflags.h>
+#include <google/protobuf/arena.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/text_format.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory>
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #ifdef DISALLOW_COPY_AND_ASSIGN
@@ -30,7 +34,9 @@
 #include <snappy.h>
 
 #include <algorithm>
+#include <functional>
 #include <thread>  // NOLINT
+#include <tuple>
 #include <utility>
 #include <vector>
 #include <unordered_map>
@@ -44,6 +50,8 @@
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
 #include "base/hash.h"
+#include "base/numa.h"
+#include "base/prometheus_writer.h"
 #include "base/proto_util.h"
 #include "base/status.h"
 #include "base/strings.h"
@@ -57,9 +65,11 @@
 #include "schema/schema_adapter.h"
 #include "storage/binlog.h"
 #include "storage/segment.h"
+#include "storage/hybrid_table.h"
 #include "tablet/file_sender.h"
 #include "storage/table.h"
 #include "storage/disk_table_snapshot.h"
+#include "zk/table_change_log.h"
 #include "absl/cleanup/cleanup.h"
 
 using google::protobuf::RepeatedPtrField;
@@ -74,6 +84,7 @@ DECLARE_int32(gc_pool_size);
 DECLARE_int32(disk_gc_interval);
 DECLARE_int32(statdb_ttl);
 DECLARE_uint32(scan_max_bytes_size);
+DECLARE_uint32(scan_ref_row_min_size);
 DECLARE_uint32(scan_reserve_size);
 DECLARE_double(mem_release_rate);
 DECLARE_string(db_root_path);
@@ -96,8 +107,31 @@ DECLARE_uint32(task_check_interval);
 DECLARE_uint32(load_index_max_wait_time);
 DECLARE_bool(use_name);
 DECLARE_bool(enable_distsql);
+DECLARE_string(jit_object_cache_dir);
+DECLARE_uint32(jit_compile_parallelism);
+DECLARE_string(jit_target_cpu);
+DECLARE_bool(jit_enable_fast_math);
+DECLARE_uint32(batch_query_parallelism);
+DECLARE_uint64(batch_query_sort_memory_limit);
+DECLARE_string(batch_query_spill_dir);
+DECLARE_uint64(query_memory_limit);
+DECLARE_uint64(total_query_memory_limit);
+DECLARE_uint32(request_query_parallelism);
+DECLARE_uint32(request_window_cache_capacity);
+DECLARE_uint32(request_window_cache_ttl_ms);
+DECLARE_uint32(tiered_compile_threshold);
+DECLARE_bool(enable_literal_normalization);
+DECLARE_uint64(sql_cache_max_bytes);
+DECLARE_bool(enable_lazy_batch_request_compile);
+DECLARE_bool(hot_standby);
+DECLARE_bool(enable_shared_jit);
+DECLARE_uint64(jit_memory_budget_bytes);
+DECLARE_bool(enable_block_project);
+DECLARE_bool(enable_deploy_profile);
 DECLARE_string(snapshot_compression);
 DECLARE_string(file_compression);
+DECLARE_string(binlog_sync_compression);
+DECLARE_string(binlog_remote_channel_compression);
 
 // cluster config
 DECLARE_string(endpoint);
@@ -111,11 +145,43 @@ DECLARE_int32(binlog_delete_interval);
 DECLARE_uint32(absolute_ttl_max);
 DECLARE_uint32(latest_ttl_max);
 DECLARE_uint32(max_traverse_cnt);
+DECLARE_uint32(split_table_wait_ms);
 DECLARE_uint32(snapshot_ttl_time);
 DECLARE_uint32(snapshot_ttl_check_interval);
 DECLARE_uint32(put_slow_log_threshold);
 DECLARE_uint32(query_slow_log_threshold);
+DECLARE_uint32(slow_trace_capacity);
+DECLARE_uint32(workload_profile_hz);
+DECLARE_uint64(workload_profile_heap_sample_bytes);
+DECLARE_uint32(query_admission_max_concurrency);
+DECLARE_uint32(query_admission_reserved_concurrency);
+DECLARE_string(query_admission_quotas);
+DECLARE_uint64(write_throttle_max_memory_mb);
+DECLARE_uint64(write_throttle_max_lag);
+DECLARE_double(write_throttle_low_ratio);
+DECLARE_uint32(write_throttle_check_interval_ms);
+DECLARE_uint32(deploy_result_cache_capacity);
+DECLARE_uint32(deploy_result_cache_ttl_ms);
+DECLARE_uint32(prepared_statement_capacity);
+DECLARE_uint32(traverse_cursor_capacity);
+DECLARE_uint32(traverse_cursor_timeout_ms);
+DECLARE_uint32(query_result_cursor_capacity);
+DECLARE_uint32(query_result_cursor_timeout_ms);
 DECLARE_int32(snapshot_pool_size);
+DECLARE_int32(background_pool_size);
+DECLARE_int32(aggr_update_pool_size);
+DECLARE_uint32(numa_worker_thread_num);
+DECLARE_uint32(query_worker_thread_num);
+DECLARE_string(query_worker_cpus);
+DECLARE_uint32(query_worker_queue_size);
+DECLARE_int32(request_timeout_ms);
+DECLARE_uint32(zk_notify_coalesce_ms);
+DECLARE_uint32(recover_table_thread_num);
+DECLARE_uint64(recover_memory_budget_mb);
+DECLARE_uint32(recover_disk_concurrency);
+DECLARE_uint32(drop_table_reclaim_key_cnt);
+DECLARE_uint32(drop_table_reclaim_interval_ms);
+DECLARE_string(recover_priority_tables);
 
 namespace openmldb {
 namespace tablet {
@@ -125,36 +191,83 @@ static const uint32_t SEED = 0xe17a1465;
 
 static constexpr const char DEPLOY_STATS[] = "deploy_stats";
 
+// the queue size of the workers of one numa node
+static const uint32_t NUMA_WORKER_QUEUE_SIZE = 65536;
+// the queries longer than it are truncated in the memory stat
+static const size_t MAX_MEM_POOL_SQL_LEN = 128;
+// the arena of a put on the stack of the bthread, which holds the log entry of a row of a few index
+static const size_t PUT_ARENA_BLOCK_SIZE = 2048;
+// the rpc handlers running on the numa workers are not dispatched again
+static thread_local bool t_on_numa_worker = false;
+
+// the classes of background_pool_, the former one has the higher priority
+enum BackgroundTask : uint32_t {
+    kGcTask = 0,
+    kBinlogDeleteTask,
+    kSnapshotTask,
+    kIndexTask,
+    kSendFileTask,
+};
+
 TabletImpl::TabletImpl()
     : tables_(),
       mu_(),
-      gc_pool_(FLAGS_gc_pool_size),
       replicators_(),
       snapshots_(),
       zk_client_(NULL),
       keep_alive_pool_(1),
       task_pool_(FLAGS_task_pool_size),
       io_pool_(FLAGS_io_pool_size),
-      snapshot_pool_(FLAGS_snapshot_pool_size),
+      background_pool_(FLAGS_background_pool_size,
+                       {static_cast<uint32_t>(FLAGS_gc_pool_size), 0, static_cast<uint32_t>(FLAGS_snapshot_pool_size),
+                        0, 0}),
+      recovery_scheduler_(FLAGS_recover_table_thread_num, FLAGS_recover_memory_budget_mb * 1024 * 1024,
+                          FLAGS_recover_disk_concurrency),
+      table_reclaimer_(FLAGS_drop_table_reclaim_key_cnt > 0
+                           ? new TableReclaimer(FLAGS_drop_table_reclaim_key_cnt, FLAGS_drop_table_reclaim_interval_ms)
+                           : nullptr),
+      aggr_pool_(FLAGS_aggr_update_pool_size > 0 ? new ThreadPool(FLAGS_aggr_update_pool_size) : nullptr),
+      query_rejected_cnt_(0),
       mode_root_paths_(),
       mode_recycle_root_paths_(),
       follower_(false),
+      table_refresh_pending_(false),
+      table_info_version_(0),
       catalog_(new ::openmldb::catalog::TabletCatalog()),
       engine_(),
       zk_cluster_(),
       zk_path_(),
       endpoint_(),
       sp_cache_(std::shared_ptr<SpCache>(new SpCache())),
+      result_cache_(new ResultCache(FLAGS_deploy_result_cache_capacity, FLAGS_deploy_result_cache_ttl_ms)),
+      materialized_views_(new MaterializedViews()),
+      statement_cache_(new StatementCache(FLAGS_prepared_statement_capacity)),
+      traverse_cursors_(new TraverseCursors(FLAGS_traverse_cursor_capacity, FLAGS_traverse_cursor_timeout_ms)),
+      query_result_cursors_(
+          new QueryResultCursors(FLAGS_query_result_cursor_capacity, FLAGS_query_result_cursor_timeout_ms)),
+      slow_traces_(new SlowTraceRing(FLAGS_slow_trace_capacity)),
       notify_path_(),
       globalvar_changed_notify_path_(),
       startup_mode_(::openmldb::type::StartupMode::kStandalone) {}
 
 TabletImpl::~TabletImpl() {
+    for (auto& pool : numa_pools_) {
+        pool->Stop();
+    }
+    if (query_pool_) {
+        query_pool_->Stop();
+    }
+    if (aggr_pool_) {
+        aggr_pool_->Stop(true);
+    }
+    recovery_scheduler_.Stop();
+    if (table_reclaimer_) {
+        table_reclaimer_->Stop();
+    }
     task_pool_.Stop(true);
     keep_alive_pool_.Stop(true);
-    gc_pool_.Stop(true);
     io_pool_.Stop(true);
-    snapshot_pool_.Stop(true);
+    background_pool_.Stop(true);
     delete zk_client_;
 }
 
@@ -184,7 +297,14 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
                                   mode_recycle_root_paths_[::openmldb::common::kSSD]);
     ::openmldb::base::SplitString(FLAGS_recycle_bin_hdd_root_path, ",",
                                   mode_recycle_root_paths_[::openmldb::common::kHDD]);
+    std::vector<std::string> priority_tables;
+    ::openmldb::base::SplitString(FLAGS_recover_priority_tables, ",", priority_tables);
+    for (size_t i = 0; i < priority_tables.size(); i++) {
+        // the former table has the higher priority, the tables not listed have 0
+        recover_priorities_.emplace(priority_tables[i], static_cast<int32_t>(priority_tables.size() - i));
+    }
     deploy_collector_ = std::make_unique<::openmldb::statistics::DeployQueryTimeCollector>();
+    deploy_metrics_ = std::make_unique<::openmldb::statistics::DeployQueryTimeCollector>();
 
     if (!zk_cluster.empty()) {
         zk_client_ = new ZkClient(zk_cluster, real_endpoint, FLAGS_zk_session_timeout, endpoint, zk_path);
@@ -205,6 +325,24 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
     } else {
         options.SetClusterOptimized(false);
     }
+    options.jit_options().SetObjectCacheDir(FLAGS_jit_object_cache_dir);
+    options.jit_options().SetCompileParallelism(FLAGS_jit_compile_parallelism);
+    options.jit_options().SetTargetCpu(FLAGS_jit_target_cpu);
+    options.jit_options().SetEnableFastMath(FLAGS_jit_enable_fast_math);
+    options.SetBatchParallelism(FLAGS_batch_query_parallelism);
+    options.SetBatchSortMemoryLimit(FLAGS_batch_query_sort_memory_limit);
+    options.SetSpillDir(FLAGS_batch_query_spill_dir);
+    options.SetQueryMemoryLimit(FLAGS_query_memory_limit);
+    options.SetTotalQueryMemoryLimit(FLAGS_total_query_memory_limit);
+    options.SetRequestParallelism(FLAGS_request_query_parallelism);
+    options.SetRequestWindowCacheCapacity(FLAGS_request_window_cache_capacity);
+    options.SetRequestWindowCacheTtl(FLAGS_request_window_cache_ttl_ms);
+    options.SetTieredCompileThreshold(FLAGS_tiered_compile_threshold);
+    options.SetEnableLiteralNormalization(FLAGS_enable_literal_normalization);
+    options.SetMaxSqlCacheBytes(FLAGS_sql_cache_max_bytes);
+    options.SetEnableSharedJit(FLAGS_enable_shared_jit);
+    options.SetMaxJitMemoryBytes(FLAGS_jit_memory_budget_bytes);
+    options.SetEnableBlockProject(FLAGS_enable_block_project);
     engine_ = std::unique_ptr<::hybridse::vm::Engine>(new ::hybridse::vm::Engine(catalog_, options));
     catalog_->SetLocalTablet(
         std::shared_ptr<::hybridse::vm::Tablet>(new ::hybridse::vm::LocalTablet(engine_.get(), sp_cache_)));
@@ -213,6 +351,14 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
         LOG(ERROR) << "wrong snapshot_compression: " << FLAGS_snapshot_compression;
         return false;
     }
+    if (snapshot_compression_set.find(FLAGS_binlog_sync_compression) == snapshot_compression_set.end()) {
+        LOG(ERROR) << "wrong binlog_sync_compression: " << FLAGS_binlog_sync_compression;
+        return false;
+    }
+    if (snapshot_compression_set.find(FLAGS_binlog_remote_channel_compression) == snapshot_compression_set.end()) {
+        LOG(ERROR) << "wrong binlog_remote_channel_compression: " << FLAGS_binlog_remote_channel_compression;
+        return false;
+    }
     std::set<std::string> file_compression_set{"off", "zlib", "lz4"};
     if (file_compression_set.find(FLAGS_file_compression) == file_compression_set.end()) {
         LOG(ERROR) << "wrong FLAGS_file_compression: " << FLAGS_file_compression;
@@ -222,6 +368,42 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
         PDLOG(ERROR, "make_snapshot_time[%d] is illegal.", FLAGS_make_snapshot_time);
         return false;
     }
+    std::map<std::string, AdmissionQuota> quotas;
+    std::string quota_msg;
+    if (!AdmissionController::ParseQuotas(FLAGS_query_admission_quotas, &quotas, &quota_msg)) {
+        LOG(ERROR) << "wrong query_admission_quotas: " << quota_msg;
+        return false;
+    }
+    admission_ = std::make_unique<AdmissionController>(FLAGS_query_admission_max_concurrency,
+                                                       FLAGS_query_admission_reserved_concurrency, quotas);
+    if (FLAGS_write_throttle_max_memory_mb > 0 || FLAGS_write_throttle_max_lag > 0) {
+        write_throttler_ = std::make_unique<WriteThrottler>(FLAGS_write_throttle_max_memory_mb * 1024 * 1024,
+                                                            FLAGS_write_throttle_max_lag,
+                                                            FLAGS_write_throttle_low_ratio);
+    }
+    if (FLAGS_numa_worker_thread_num > 0) {
+        auto nodes = ::openmldb::base::GetNumaNodeCpus();
+        if (nodes.size() > 1) {
+            for (const auto& cpus : nodes) {
+                numa_pools_.emplace_back(new ::openmldb::base::TaskPool(FLAGS_numa_worker_thread_num,
+                                                                        NUMA_WORKER_QUEUE_SIZE, cpus));
+            }
+            PDLOG(INFO, "start %u workers on each of %u numa nodes", FLAGS_numa_worker_thread_num, nodes.size());
+        } else {
+            PDLOG(WARNING, "numa_worker_thread_num is ignored as the numa nodes are %u", nodes.size());
+        }
+    }
+    if (FLAGS_query_worker_thread_num > 0) {
+        auto cpus = ::openmldb::base::ParseCpuList(FLAGS_query_worker_cpus);
+        if (cpus.empty() && !FLAGS_query_worker_cpus.empty()) {
+            LOG(ERROR) << "wrong query_worker_cpus: " << FLAGS_query_worker_cpus;
+            return false;
+        }
+        query_pool_ = std::make_unique<::openmldb::base::TaskPool>(
+            FLAGS_query_worker_thread_num, std::max(FLAGS_query_worker_queue_size, 1u), cpus);
+        PDLOG(INFO, "start %u query workers on cpus %s", FLAGS_query_worker_thread_num,
+              FLAGS_query_worker_cpus.c_str());
+    }
 
     if (FLAGS_db_root_path != "") {
         if (!CreateMultiDir(mode_root_paths_[::openmldb::common::kMemory])) {
@@ -295,8 +477,13 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
         RecoverExternalFunction();
     }
 
-    snapshot_pool_.DelayTask(FLAGS_make_snapshot_check_interval, boost::bind(&TabletImpl::SchedMakeSnapshot, this));
+    background_pool_.DelayTask(kSnapshotTask, FLAGS_make_snapshot_check_interval,
+                               boost::bind(&TabletImpl::SchedMakeSnapshot, this));
     task_pool_.AddTask(boost::bind(&TabletImpl::GetDiskused, this));
+    if (write_throttler_) {
+        task_pool_.DelayTask(FLAGS_write_throttle_check_interval_ms,
+                             boost::bind(&TabletImpl::SchedWriteThrottle, this));
+    }
     if (FLAGS_recycle_ttl != 0) {
         task_pool_.DelayTask(FLAGS_recycle_ttl * 60 * 1000, boost::bind(&TabletImpl::SchedDelRecycle, this));
     }
@@ -304,6 +491,11 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
     MallocExtension* tcmalloc = MallocExtension::instance();
     tcmalloc->SetMemoryReleaseRate(FLAGS_mem_release_rate);
 #endif
+    // the profiler is shared by the tablets in the same process, e.g. in tests
+    if ((FLAGS_workload_profile_hz > 0 || FLAGS_workload_profile_heap_sample_bytes > 0) &&
+        !WorkloadProfiler::IsRunning()) {
+        WorkloadProfiler::Start(FLAGS_workload_profile_hz, FLAGS_workload_profile_heap_sample_bytes);
+    }
     return true;
 }
 
@@ -393,7 +585,7 @@ bool TabletImpl::RegisterZK() {
             LOG(WARNING) << "add global var changed watcher failed";
             return false;
         }
-        if (!zk_client_->WatchItem(notify_path_, boost::bind(&TabletImpl::RefreshTableInfo, this))) {
+        if (!zk_client_->WatchItem(notify_path_, boost::bind(&TabletImpl::ScheduleRefreshTableInfo, this))) {
             LOG(WARNING) << "add notify watcher failed";
             return false;
         }
@@ -433,8 +625,8 @@ bool TabletImpl::CheckGetDone(::openmldb::api::GetType type, uint64_t ts, uint64
 }
 
 int32_t TabletImpl::GetIndex(const ::openmldb::api::GetRequest* request, const ::openmldb::api::TableMeta& meta,
-                             const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, CombineIterator* it,
-                             std::string* value, uint64_t* ts) {
+                             const std::shared_ptr<Table>& table, CombineIterator* it, std::string* value,
+                             uint64_t* ts) {
     if (it == nullptr || value == nullptr || ts == nullptr) {
         PDLOG(WARNING, "invalid args");
         return -1;
@@ -456,18 +648,16 @@ int32_t TabletImpl::GetIndex(const ::openmldb::api::GetRequest* request, const :
     if (et < expire_time && et_type == ::openmldb::api::GetType::kSubKeyGt) {
         real_et_type = ::openmldb::api::GetType::kSubKeyGe;
     }
-    bool enable_project = false;
-    openmldb::codec::RowProject row_project(vers_schema, request->projection());
+    std::shared_ptr<::openmldb::codec::RowProjectPlan> project_plan;
     if (request->projection().size() > 0 && meta.format_version() == 1) {
         if (meta.compress_type() == ::openmldb::type::kSnappy) {
             return -1;
         }
-        bool ok = row_project.Init();
-        if (!ok) {
+        project_plan = table->GetProjectPlan(request->projection());
+        if (!project_plan) {
             PDLOG(WARNING, "invalid project list");
             return -1;
         }
-        enable_project = true;
     }
     if (st > 0 && st < et) {
         DEBUGLOG("invalid args for st %lu less than et %lu or expire time %lu", st, et, expire_time);
@@ -481,18 +671,12 @@ int32_t TabletImpl::GetIndex(const ::openmldb::api::GetRequest* request, const :
         bool jump_out = false;
         if (st_type == ::openmldb::api::GetType::kSubKeyGe || st_type == ::openmldb::api::GetType::kSubKeyGt) {
             ::openmldb::base::Slice it_value = it->GetValue();
-            if (enable_project) {
-                int8_t* ptr = nullptr;
-                uint32_t size = 0;
-                openmldb::base::Slice data = it->GetValue();
-                const int8_t* row_ptr = reinterpret_cast<const int8_t*>(data.data());
-                bool ok = row_project.Project(row_ptr, data.size(), &ptr, &size);
-                if (!ok) {
+            if (project_plan) {
+                const int8_t* row_ptr = reinterpret_cast<const int8_t*>(it_value.data());
+                if (!project_plan->Project(row_ptr, it_value.size(), value)) {
                     PDLOG(WARNING, "fail to make a projection");
                     return -4;
                 }
-                value->assign(reinterpret_cast<char*>(ptr), size);
-                delete[] ptr;
             } else {
                 value->assign(it_value.data(), it_value.size());
             }
@@ -524,18 +708,13 @@ int32_t TabletImpl::GetIndex(const ::openmldb::api::GetRequest* request, const :
         if (jump_out) {
             return 1;
         }
-        if (enable_project) {
-            int8_t* ptr = nullptr;
-            uint32_t size = 0;
+        if (project_plan) {
             openmldb::base::Slice data = it->GetValue();
             const int8_t* row_ptr = reinterpret_cast<const int8_t*>(data.data());
-            bool ok = row_project.Project(row_ptr, data.size(), &ptr, &size);
-            if (!ok) {
+            if (!project_plan->Project(row_ptr, data.size(), value)) {
                 PDLOG(WARNING, "fail to make a projection");
                 return -4;
             }
-            value->assign(reinterpret_cast<char*>(ptr), size);
-            delete[] ptr;
         } else {
             value->assign(it->GetValue().data(), it->GetValue().size());
         }
@@ -585,9 +764,53 @@ void TabletImpl::RecoverExternalFunction() {
     }
 }
 
+bool TabletImpl::DispatchToNumaNode(uint32_t tid, uint32_t pid, const ::openmldb::base::TaskPool::Task& task) {
+    if (numa_pools_.empty() || t_on_numa_worker) {
+        return false;
+    }
+    numa_pools_[(tid + pid) % numa_pools_.size()]->AddTask([task] {
+        t_on_numa_worker = true;
+        task();
+        t_on_numa_worker = false;
+    });
+    return true;
+}
+
+bool TabletImpl::DispatchQuery(const ::openmldb::base::TaskPool::Task& task) {
+    if (query_pool_->TryAddTask(task)) {
+        return true;
+    }
+    query_rejected_cnt_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool TabletImpl::StartQueryTask(absl::Time enqueue_time, std::chrono::steady_clock::time_point deadline,
+                                AdmissionController::Ticket* ticket) {
+    query_queue_time_.Collect(absl::Now() - enqueue_time);
+    // the cpu quota is charged by the cpu time of the query worker
+    ticket->Rebind();
+    return std::chrono::steady_clock::now() < deadline;
+}
+
 void TabletImpl::Get(RpcController* controller, const ::openmldb::api::GetRequest* request,
                      ::openmldb::api::GetResponse* response, Closure* done) {
+    if (DispatchToNumaNode(request->tid(), request->pid(), [=] { Get(controller, request, response, done); })) {
+        return;
+    }
+    brpc::ClosureGuard done_guard(done);
+    ProcessGet(request, response);
+}
+
+void TabletImpl::BatchGet(RpcController* controller, const ::openmldb::api::BatchGetRequest* request,
+                          ::openmldb::api::BatchGetResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
+    for (const auto& get_request : request->requests()) {
+        ProcessGet(&get_request, response->add_responses());
+    }
+    response->set_code(::openmldb::base::ReturnCode::kOk);
+}
+
+void TabletImpl::ProcessGet(const ::openmldb::api::GetRequest* request, ::openmldb::api::GetResponse* response) {
     uint64_t start_time = ::baidu::common::timer::get_micros();
     uint32_t tid = request->tid();
     uint32_t pid_num = 1;
@@ -617,6 +840,7 @@ void TabletImpl::Get(RpcController* controller, const ::openmldb::api::GetReques
             response->set_msg("table is loading");
             return;
         }
+        table->AddQueryCnt();
         std::string index_name;
         if (request->has_idx_name() && request->idx_name().size() > 0) {
             index_name = request->idx_name();
@@ -631,6 +855,7 @@ void TabletImpl::Get(RpcController* controller, const ::openmldb::api::GetReques
             return;
         }
         uint32_t index = index_def->GetId();
+        table->AddIndexQueryCnt(index);
         if (!ttl) {
             ttl = index_def->GetTTL();
             expired_value = *ttl;
@@ -645,12 +870,12 @@ void TabletImpl::Get(RpcController* controller, const ::openmldb::api::GetReques
         query_its[idx].table = table;
     }
     auto table_meta = query_its.begin()->table->GetTableMeta();
-    const std::map<int32_t, std::shared_ptr<Schema>> vers_schema = query_its.begin()->table->GetAllVersionSchema();
+    std::shared_ptr<Table> project_table = query_its.begin()->table;
     CombineIterator combine_it(std::move(query_its), request->ts(), request->type(), expired_value);
     combine_it.SeekToFirst();
     std::string* value = response->mutable_value();
     uint64_t ts = 0;
-    int32_t code = GetIndex(request, *table_meta, vers_schema, &combine_it, value, &ts);
+    int32_t code = GetIndex(request, *table_meta, project_table, &combine_it, value, &ts);
     response->set_ts(ts);
     response->set_code(code);
     uint64_t end_time = ::baidu::common::timer::get_micros();
@@ -684,53 +909,319 @@ void TabletImpl::Get(RpcController* controller, const ::openmldb::api::GetReques
 
 void TabletImpl::Put(RpcController* controller, const ::openmldb::api::PutRequest* request,
                      ::openmldb::api::PutResponse* response, Closure* done) {
+    if (DispatchToNumaNode(request->tid(), request->pid(), [=] { Put(controller, request, response, done); })) {
+        return;
+    }
     brpc::ClosureGuard done_guard(done);
     if (follower_.load(std::memory_order_relaxed)) {
         response->set_code(::openmldb::base::ReturnCode::kIsFollowerCluster);
         response->set_msg("is follower cluster");
         return;
     }
-    uint64_t start_time = ::baidu::common::timer::get_micros();
+    if (!AcquireWrite(request->tid(), request->pid(), 1, response)) {
+        return;
+    }
+    ::openmldb::api::PutRequest rest;
+    auto router = GetSplitRouter(request->tid(), request->pid());
+    if (router) {
+        if (!ForwardSplitPut(*router, *request, &rest, response)) {
+            return;
+        }
+        request = &rest;
+    }
+    auto replicator = ProcessPut(request, response);
+    if (replicator && FLAGS_binlog_notify_on_put) {
+        replicator->Notify();
+    }
+}
+
+void TabletImpl::BatchPut(RpcController* controller, const ::openmldb::api::BatchPutRequest* request,
+                          ::openmldb::api::BatchPutResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    if (follower_.load(std::memory_order_relaxed)) {
+        response->set_code(::openmldb::base::ReturnCode::kIsFollowerCluster);
+        response->set_msg("is follower cluster");
+        return;
+    }
+    // the rows of one partition are written together, the later rows of a key are still put later
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<int>> partition_rows;
+    // the rows left to the partitions split after the dimensions of the children are forwarded
+    ::google::protobuf::RepeatedPtrField<::openmldb::api::PutRequest> rest_requests;
+    for (int i = 0; i < request->requests_size(); i++) {
+        response->add_responses();
+    }
+    for (int i = 0; i < request->requests_size(); i++) {
+        const auto& put_request = request->requests(i);
+        if (!AcquireWrite(put_request.tid(), put_request.pid(), 1, response->mutable_responses(i))) {
+            continue;
+        }
+        auto router = GetSplitRouter(put_request.tid(), put_request.pid());
+        if (router) {
+            if (rest_requests.empty()) {
+                rest_requests.CopyFrom(request->requests());
+            }
+            if (!ForwardSplitPut(*router, put_request, rest_requests.Mutable(i), response->mutable_responses(i))) {
+                continue;
+            }
+        }
+        partition_rows[std::make_pair(put_request.tid(), put_request.pid())].push_back(i);
+    }
+    const auto& requests = rest_requests.empty() ? request->requests() : rest_requests;
+    for (const auto& kv : partition_rows) {
+        auto replicator = ProcessPartitionPut(kv.first.first, kv.first.second, requests, kv.second,
+                                              response->mutable_responses());
+        if (replicator && FLAGS_binlog_notify_on_put) {
+            replicator->Notify();
+        }
+    }
+    response->set_code(::openmldb::base::ReturnCode::kOk);
+}
+
+std::shared_ptr<const ::openmldb::base::PartitionRouter> TabletImpl::GetSplitRouter(uint32_t tid, uint32_t pid) {
+    std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+    if (split_routers_.empty()) {
+        return {};
+    }
+    auto it = split_routers_.find(std::make_pair(tid, pid));
+    return it != split_routers_.end() ? it->second : nullptr;
+}
+
+bool TabletImpl::ForwardSplitPut(const ::openmldb::base::PartitionRouter& router,
+                                 const ::openmldb::api::PutRequest& request, ::openmldb::api::PutRequest* rest,
+                                 ::openmldb::api::PutResponse* response) {
+    // pid -> the put of the dimensions routed to the child
+    std::map<uint32_t, ::openmldb::api::PutRequest> children;
+    ::google::protobuf::RepeatedPtrField<::openmldb::api::Dimension> dimensions;
+    for (const auto& dimension : request.dimensions()) {
+        uint32_t pid = router.GetPid(dimension.key());
+        if (pid == request.pid()) {
+            dimensions.Add()->CopyFrom(dimension);
+            continue;
+        }
+        auto it = children.find(pid);
+        if (it == children.end()) {
+            it = children.emplace(pid, request).first;
+            it->second.set_pid(pid);
+            it->second.clear_dimensions();
+        }
+        it->second.add_dimensions()->CopyFrom(dimension);
+    }
+    for (const auto& kv : children) {
+        ::openmldb::api::PutResponse child_response;
+        auto replicator = ProcessPut(&kv.second, &child_response);
+        if (replicator && FLAGS_binlog_notify_on_put) {
+            replicator->Notify();
+        }
+        if (child_response.code() != ::openmldb::base::ReturnCode::kOk) {
+            PDLOG(WARNING, "fail to forward the put to the split partition. tid %u, pid %u, code %d", request.tid(),
+                  kv.first, child_response.code());
+            response->CopyFrom(child_response);
+            return false;
+        }
+    }
+    if (dimensions.empty()) {
+        response->set_code(::openmldb::base::ReturnCode::kOk);
+        return false;
+    }
+    if (rest != &request) {
+        rest->CopyFrom(request);
+    }
+    rest->mutable_dimensions()->Swap(&dimensions);
+    return true;
+}
+
+std::shared_ptr<LogReplicator> TabletImpl::ProcessPartitionPut(
+    uint32_t tid, uint32_t pid, const ::google::protobuf::RepeatedPtrField<::openmldb::api::PutRequest>& requests,
+    const std::vector<int>& rows, ::google::protobuf::RepeatedPtrField<::openmldb::api::PutResponse>* responses) {
+    auto set_all = [&rows, responses](::openmldb::base::ReturnCode code, const std::string& msg) {
+        for (int row : rows) {
+            responses->Mutable(row)->set_code(code);
+            responses->Mutable(row)->set_msg(msg);
+        }
+    };
+    ScopedProfileTag profile_tag("put", tid);
+    SlowTrace trace;
+    uint64_t start_time = trace.GetStartTime();
+    std::shared_ptr<Table> table = GetTable(tid, pid);
+    if (!table) {
+        PDLOG(WARNING, "table is not exist. tid %u, pid %u", tid, pid);
+        set_all(::openmldb::base::ReturnCode::kTableIsNotExist, "table is not exist");
+        return {};
+    }
+    if (!table->IsLeader()) {
+        set_all(::openmldb::base::ReturnCode::kTableIsFollower, "table is follower");
+        return {};
+    }
+    if (IsLeaseExpired()) {
+        set_all(::openmldb::base::ReturnCode::kTableIsFollower, "the lease of tablet expired");
+        return {};
+    }
+    if (table->GetTableStat() == ::openmldb::storage::kLoading) {
+        PDLOG(WARNING, "table is loading. tid %u, pid %u", tid, pid);
+        set_all(::openmldb::base::ReturnCode::kTableIsLoading, "table is loading");
+        return {};
+    }
+    std::vector<int> valid_rows;
+    std::vector<const ::openmldb::api::PutRequest*> valid_requests;
+    for (int row : rows) {
+        const auto& request = requests.Get(row);
+        if (request.dimensions_size() == 0) {
+            responses->Mutable(row)->set_code(::openmldb::base::ReturnCode::kPutFailed);
+            responses->Mutable(row)->set_msg("put failed");
+            continue;
+        }
+        if (CheckDimessionPut(&request, table->GetIdxCnt()) != 0) {
+            responses->Mutable(row)->set_code(::openmldb::base::ReturnCode::kInvalidDimensionParameter);
+            responses->Mutable(row)->set_msg("invalid dimension parameter");
+            continue;
+        }
+        valid_rows.push_back(row);
+        valid_requests.push_back(&request);
+    }
+    std::vector<bool> results;
+    table->BatchPut(valid_requests, &results);
+    trace.Mark("table_put");
+    if (!materialized_views_->Empty()) {
+        for (size_t i = 0; i < valid_requests.size(); i++) {
+            if (results[i]) {
+                EraseMaterializedViews(table, valid_requests[i]->value());
+            }
+        }
+    }
+    std::vector<int> put_rows;
+    std::vector<::openmldb::api::LogEntry> entries;
+    for (size_t i = 0; i < valid_rows.size(); i++) {
+        if (!results[i]) {
+            responses->Mutable(valid_rows[i])->set_code(::openmldb::base::ReturnCode::kPutFailed);
+            responses->Mutable(valid_rows[i])->set_msg("put failed");
+            continue;
+        }
+        responses->Mutable(valid_rows[i])->set_code(::openmldb::base::ReturnCode::kOk);
+        put_rows.push_back(valid_rows[i]);
+        entries.emplace_back();
+        auto& entry = entries.back();
+        entry.set_pk(valid_requests[i]->pk());
+        entry.set_ts(valid_requests[i]->time());
+        entry.set_value(valid_requests[i]->value());
+        entry.mutable_dimensions()->CopyFrom(valid_requests[i]->dimensions());
+        if (valid_requests[i]->ts_dimensions_size() > 0) {
+            entry.mutable_ts_dimensions()->CopyFrom(valid_requests[i]->ts_dimensions());
+        }
+    }
+    if (put_rows.empty()) {
+        return {};
+    }
+    if (result_cache_->IsEnabled()) {
+        result_cache_->Invalidate(table->GetDB(), table->GetName());
+    }
+    std::shared_ptr<LogReplicator> replicator = GetReplicator(tid, pid);
+    if (!replicator) {
+        PDLOG(WARNING, "fail to find table tid %u pid %u leader's log replicator", tid, pid);
+    } else {
+        uint64_t term = replicator->GetLeaderTerm();
+        for (auto& entry : entries) {
+            entry.set_term(term);
+        }
+        // all rows of the partition go to the binlog in one append
+        absl::Time append_start = absl::Now();
+        replicator->AppendEntries(&entries);
+        binlog_append_time_.Collect(absl::Now() - append_start);
+    }
+    trace.Mark("binlog_append");
+    for (size_t i = 0; i < put_rows.size(); i++) {
+        const auto& request = requests.Get(put_rows[i]);
+        if (!UpdateAggrs(tid, pid, request.value(), request.dimensions(), entries[i].log_index())) {
+            responses->Mutable(put_rows[i])->set_code(::openmldb::base::ReturnCode::kError);
+            responses->Mutable(put_rows[i])->set_msg("update aggr failed");
+        }
+    }
+    trace.Mark("aggr_update");
+    uint64_t end_time = ::baidu::common::timer::get_micros();
+    if (start_time + FLAGS_put_slow_log_threshold < end_time) {
+        PDLOG(INFO, "slow log[batch put]. rows %lu time %lu. tid %u, pid %u", rows.size(), end_time - start_time,
+              tid, pid);
+        slow_traces_->Add("batch put", absl::StrCat("tid ", tid, " pid ", pid, " rows ", rows.size()), trace);
+    }
+    // update global var in standalone mode
+    if (!IsClusterMode() && table->GetDB() == openmldb::nameserver::INFORMATION_SCHEMA_DB &&
+        table->GetName() == openmldb::nameserver::GLOBAL_VARIABLES) {
+        UpdateGlobalVarTable();
+    }
+    return replicator;
+}
+
+std::shared_ptr<LogReplicator> TabletImpl::ProcessPut(const ::openmldb::api::PutRequest* request,
+                                                      ::openmldb::api::PutResponse* response) {
+    ScopedProfileTag profile_tag("put", request->tid());
+    SlowTrace trace;
+    uint64_t start_time = trace.GetStartTime();
     std::shared_ptr<Table> table = GetTable(request->tid(), request->pid());
     if (!table) {
         PDLOG(WARNING, "table is not exist. tid %u, pid %u", request->tid(), request->pid());
         response->set_code(::openmldb::base::ReturnCode::kTableIsNotExist);
         response->set_msg("table is not exist");
-        return;
+        return {};
     }
     DLOG(INFO) << "request dimension size " << request->dimensions_size() << " request time " << request->time();
     if (!table->IsLeader()) {
         response->set_code(::openmldb::base::ReturnCode::kTableIsFollower);
         response->set_msg("table is follower");
-        return;
+        return {};
+    }
+    if (IsLeaseExpired()) {
+        response->set_code(::openmldb::base::ReturnCode::kTableIsFollower);
+        response->set_msg("the lease of tablet expired");
+        return {};
     }
     if (table->GetTableStat() == ::openmldb::storage::kLoading) {
         PDLOG(WARNING, "table is loading. tid %u, pid %u", request->tid(), request->pid());
         response->set_code(::openmldb::base::ReturnCode::kTableIsLoading);
         response->set_msg("table is loading");
-        return;
+        return {};
     }
     bool ok = false;
+    std::vector<MaterializedUpdate> view_updates;
     if (request->dimensions_size() > 0) {
         int32_t ret_code = CheckDimessionPut(request, table->GetIdxCnt());
         if (ret_code != 0) {
             response->set_code(::openmldb::base::ReturnCode::kInvalidDimensionParameter);
             response->set_msg("invalid dimension parameter");
-            return;
+            return {};
         }
         DLOG(INFO) << "put data to tid " << request->tid() << " pid " << request->pid() << " with key "
                    << request->dimensions(0).key();
+        // the outputs of the materialized deployments are computed before the row is put, as the request row is
+        // the current row of their windows
+        if (!materialized_views_->Empty()) {
+            RunMaterializedViews(table, request->value(), &view_updates);
+            trace.Mark("materialized_view_run");
+        }
         ok = table->Put(request->time(), request->value(), request->dimensions());
     }
+    trace.Mark("table_put");
     if (!ok) {
         response->set_code(::openmldb::base::ReturnCode::kPutFailed);
         response->set_msg("put failed");
-        return;
+        return {};
+    }
+    for (auto& update : view_updates) {
+        update.view->Put(update.key, update.output);
+    }
+    view_updates.clear();
+    if (result_cache_->IsEnabled()) {
+        result_cache_->Invalidate(table->GetDB(), table->GetName());
     }
 
     response->set_code(::openmldb::base::ReturnCode::kOk);
     std::shared_ptr<LogReplicator> replicator;
-    ::openmldb::api::LogEntry entry;
+    // the entry and its dimensions are allocated on the block of the arena on the stack, which saves the heap
+    // allocations of every put unless the row is too large to fit in
+    char arena_block[PUT_ARENA_BLOCK_SIZE];
+    ::google::protobuf::ArenaOptions arena_options;
+    arena_options.initial_block = arena_block;
+    arena_options.initial_block_size = sizeof(arena_block);
+    ::google::protobuf::Arena arena(arena_options);
+    auto& entry = *::google::protobuf::Arena::CreateMessage<::openmldb::api::LogEntry>(&arena);
     do {
         replicator = GetReplicator(request->tid(), request->pid());
         if (!replicator) {
@@ -747,15 +1238,19 @@ void TabletImpl::Put(RpcController* controller, const ::openmldb::api::PutReques
         if (request->ts_dimensions_size() > 0) {
             entry.mutable_ts_dimensions()->CopyFrom(request->ts_dimensions());
         }
+        absl::Time append_start = absl::Now();
         replicator->AppendEntry(entry);
+        binlog_append_time_.Collect(absl::Now() - append_start);
     } while (false);
+    trace.Mark("binlog_append");
 
     ok = UpdateAggrs(request->tid(), request->pid(), request->value(),
                      request->dimensions(), entry.log_index());
+    trace.Mark("aggr_update");
     if (!ok) {
         response->set_code(::openmldb::base::ReturnCode::kError);
         response->set_msg("update aggr failed");
-        return;
+        return {};
     }
 
     uint64_t end_time = ::baidu::common::timer::get_micros();
@@ -775,18 +1270,15 @@ void TabletImpl::Put(RpcController* controller, const ::openmldb::api::PutReques
         }
         PDLOG(INFO, "slow log[put]. key %s time %lu. tid %u, pid %u", key.c_str(), end_time - start_time,
               request->tid(), request->pid());
+        slow_traces_->Add("put", absl::StrCat("tid ", request->tid(), " pid ", request->pid(), " key ", key), trace);
     }
 
-    if (replicator) {
-        if (FLAGS_binlog_notify_on_put) {
-            replicator->Notify();
-        }
-    }
     // update global var in standalone mode
     if (!IsClusterMode() && table->GetDB() == openmldb::nameserver::INFORMATION_SCHEMA_DB &&
         table->GetName() == openmldb::nameserver::GLOBAL_VARIABLES) {
         UpdateGlobalVarTable();
     }
+    return replicator;
 }
 
 int TabletImpl::CheckTableMeta(const openmldb::api::TableMeta* table_meta, std::string& msg) {
@@ -867,8 +1359,8 @@ int TabletImpl::CheckTableMeta(const openmldb::api::TableMeta* table_meta, std::
 }
 
 int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const ::openmldb::api::TableMeta& meta,
-                              const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema,
-                              CombineIterator* combine_it, butil::IOBuf* io_buf, uint32_t* count) {
+                              const std::shared_ptr<Table>& table, CombineIterator* combine_it, butil::IOBuf* io_buf,
+                              ::openmldb::codec::RowRefAppender* appender, uint32_t* count) {
     uint32_t limit = request->limit();
     uint32_t atleast = request->atleast();
     if (combine_it == NULL || io_buf == NULL || count == NULL || (atleast > limit && limit != 0)) {
@@ -894,20 +1386,20 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
         return -1;
     }
 
-    bool enable_project = false;
-    ::openmldb::codec::RowProject row_project(vers_schema, request->projection());
+    std::shared_ptr<::openmldb::codec::RowProjectPlan> project_plan;
     if (request->projection().size() > 0 && meta.format_version() == 1) {
         if (meta.compress_type() == ::openmldb::type::kSnappy) {
             LOG(WARNING) << "project on compress row data do not eing supported";
             return -1;
         }
-        bool ok = row_project.Init();
-        if (!ok) {
+        project_plan = table->GetProjectPlan(request->projection());
+        if (!project_plan) {
             PDLOG(WARNING, "invalid project list");
             return -1;
         }
-        enable_project = true;
     }
+    // the projected row is built here and then copied into io buf
+    std::string project_row;
     bool remove_duplicated_record =
         request->has_enable_remove_duplicated_record() && request->enable_remove_duplicated_record();
     uint64_t last_time = 0;
@@ -948,21 +1440,25 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
             if (jump_out) break;
         }
         last_time = ts;
-        if (enable_project) {
-            int8_t* ptr = nullptr;
-            uint32_t size = 0;
+        if (project_plan) {
             openmldb::base::Slice data = combine_it->GetValue();
             const int8_t* row_ptr = reinterpret_cast<const int8_t*>(data.data());
-            bool ok = row_project.Project(row_ptr, data.size(), &ptr, &size);
-            if (!ok) {
+            if (!project_plan->Project(row_ptr, data.size(), &project_row)) {
                 PDLOG(WARNING, "fail to make a projection");
                 return -4;
             }
-            io_buf->append(reinterpret_cast<void*>(ptr), size);
-            total_block_size += size;
+            io_buf->append(project_row.data(), project_row.size());
+            total_block_size += project_row.size();
         } else {
             openmldb::base::Slice data = combine_it->GetValue();
-            io_buf->append(reinterpret_cast<const void*>(data.data()), data.size());
+            if (appender != nullptr) {
+                if (!appender->Append(data.data(), data.size())) {
+                    PDLOG(WARNING, "fail to append the row");
+                    return -4;
+                }
+            } else {
+                io_buf->append(reinterpret_cast<const void*>(data.data()), data.size());
+            }
             total_block_size += data.size();
         }
         record_count++;
@@ -976,8 +1472,8 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
     return 0;
 }
 int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const ::openmldb::api::TableMeta& meta,
-                              const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema,
-                              CombineIterator* combine_it, std::string* pairs, uint32_t* count) {
+                              const std::shared_ptr<Table>& table, CombineIterator* combine_it, std::string* pairs,
+                              uint32_t* count) {
     uint32_t limit = request->limit();
     uint32_t atleast = request->atleast();
     if (combine_it == NULL || pairs == NULL || count == NULL || (atleast > limit && limit != 0)) {
@@ -1002,19 +1498,17 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
         return -1;
     }
 
-    bool enable_project = false;
-    ::openmldb::codec::RowProject row_project(vers_schema, request->projection());
+    std::shared_ptr<::openmldb::codec::RowProjectPlan> project_plan;
     if (!request->projection().empty() && meta.format_version() == 1) {
         if (meta.compress_type() == ::openmldb::type::kSnappy) {
             LOG(WARNING) << "project on compress row data, not supported";
             return -1;
         }
-        bool ok = row_project.Init();
-        if (!ok) {
+        project_plan = table->GetProjectPlan(request->projection());
+        if (!project_plan) {
             PDLOG(WARNING, "invalid project list");
             return -1;
         }
-        enable_project = true;
     }
     bool remove_duplicated_record =
         request->has_enable_remove_duplicated_record() && request->enable_remove_duplicated_record();
@@ -1056,12 +1550,12 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
             if (jump_out) break;
         }
         last_time = ts;
-        if (enable_project) {
+        if (project_plan) {
             int8_t* ptr = nullptr;
             uint32_t size = 0;
             openmldb::base::Slice data = combine_it->GetValue();
             const auto* row_ptr = reinterpret_cast<const int8_t*>(data.data());
-            bool ok = row_project.Project(row_ptr, data.size(), &ptr, &size);
+            bool ok = project_plan->Project(row_ptr, data.size(), &ptr, &size);
             if (!ok) {
                 PDLOG(WARNING, "fail to make a projection");
                 return -4;
@@ -1204,6 +1698,9 @@ int32_t TabletImpl::CountIndex(uint64_t expire_time, uint64_t expire_cnt, ::open
 
 void TabletImpl::Scan(RpcController* controller, const ::openmldb::api::ScanRequest* request,
                       ::openmldb::api::ScanResponse* response, Closure* done) {
+    if (DispatchToNumaNode(request->tid(), request->pid(), [=] { Scan(controller, request, response, done); })) {
+        return;
+    }
     brpc::ClosureGuard done_guard(done);
     uint64_t start_time = ::baidu::common::timer::get_micros();
     if (request->st() < request->et()) {
@@ -1211,6 +1708,12 @@ void TabletImpl::Scan(RpcController* controller, const ::openmldb::api::ScanRequ
         response->set_msg("starttime less than endtime");
         return;
     }
+    std::string msg;
+    if (request->has_follower_read() && !CheckFollowerRead(request->follower_read(), &msg)) {
+        response->set_code(::openmldb::base::ReturnCode::kFollowerLagBehind);
+        response->set_msg(msg);
+        return;
+    }
     uint32_t tid = request->tid();
     uint32_t pid_num = 1;
     if (request->pid_group_size() > 0) {
@@ -1239,6 +1742,7 @@ void TabletImpl::Scan(RpcController* controller, const ::openmldb::api::ScanRequ
             response->set_msg("table is loading");
             return;
         }
+        table->AddQueryCnt();
         uint32_t index = 0;
         std::string index_name;
         if (request->has_idx_name() && !request->idx_name().empty()) {
@@ -1255,6 +1759,7 @@ void TabletImpl::Scan(RpcController* controller, const ::openmldb::api::ScanRequ
             return;
         }
         index = index_def->GetId();
+        table->AddIndexQueryCnt(index);
         if (!ttl) {
             ttl = index_def->GetTTL();
             expired_value = *ttl;
@@ -1269,19 +1774,43 @@ void TabletImpl::Scan(RpcController* controller, const ::openmldb::api::ScanRequ
         query_its[idx].table = table;
     }
     auto table_meta = query_its.begin()->table->GetTableMeta();
-    const std::map<int32_t, std::shared_ptr<Schema>> vers_schema = query_its.begin()->table->GetAllVersionSchema();
+    std::shared_ptr<Table> project_table = query_its.begin()->table;
+    bool use_attachment = request->has_use_attachment() && request->use_attachment();
+    // the rows of the memory tables stay where they are as long as the tickets are held, so they are sent by
+    // reference, unless they are kept in the compact or cold format and decoded into the buffer of the iterator
+    std::unique_ptr<::openmldb::codec::RowRefAppender> appender;
+    if (use_attachment && FLAGS_scan_ref_row_min_size > 0) {
+        bool referable = true;
+        for (const auto& query_it : query_its) {
+            auto mem_table = std::dynamic_pointer_cast<MemTable>(query_it.table);
+            referable = referable && mem_table && mem_table->GetRowCodec() == nullptr &&
+                         mem_table->GetColdCodec() == nullptr;
+        }
+        if (referable) {
+            auto* cntl = dynamic_cast<brpc::Controller*>(controller);
+            appender = std::make_unique<::openmldb::codec::RowRefAppender>(&cntl->response_attachment(),
+                                                                            FLAGS_scan_ref_row_min_size);
+            for (const auto& query_it : query_its) {
+                appender->Hold(query_it.ticket);
+                appender->Hold(query_it.table);
+            }
+        }
+    }
     CombineIterator combine_it(std::move(query_its), request->st(), request->st_type(), expired_value);
     uint32_t count = 0;
     int32_t code = 0;
-    if (!request->has_use_attachment() || !request->use_attachment()) {
+    if (!use_attachment) {
         std::string* pairs = response->mutable_pairs();
-        code = ScanIndex(request, *table_meta, vers_schema, &combine_it, pairs, &count);
+        code = ScanIndex(request, *table_meta, project_table, &combine_it, pairs, &count);
         response->set_code(code);
         response->set_count(count);
     } else {
         auto* cntl = dynamic_cast<brpc::Controller*>(controller);
         butil::IOBuf& buf = cntl->response_attachment();
-        code = ScanIndex(request, *table_meta, vers_schema, &combine_it, &buf, &count);
+        code = ScanIndex(request, *table_meta, project_table, &combine_it, &buf, appender.get(), &count);
+        if (appender && !appender->Finish() && code == 0) {
+            code = -4;
+        }
         response->set_code(code);
         response->set_count(count);
         response->set_buf_size(buf.size());
@@ -1336,6 +1865,7 @@ void TabletImpl::Count(RpcController* controller, const ::openmldb::api::CountRe
         response->set_msg("table is loading");
         return;
     }
+    table->AddQueryCnt();
     uint32_t index = 0;
     ::openmldb::storage::TTLSt ttl;
     std::shared_ptr<IndexDef> index_def;
@@ -1354,6 +1884,7 @@ void TabletImpl::Count(RpcController* controller, const ::openmldb::api::CountRe
         return;
     }
     index = index_def->GetId();
+    table->AddIndexQueryCnt(index);
     ttl = *index_def->GetTTL();
     if (!request->filter_expired_data()) {
         uint64_t count = 0;
@@ -1365,6 +1896,17 @@ void TabletImpl::Count(RpcController* controller, const ::openmldb::api::CountRe
         response->set_count(count);
         return;
     }
+    // the count of all the unexpired rows is looked up in the count buckets of the key
+    if (request->st() == 0 && request->et() == 0 && request->et_type() == ::openmldb::api::GetType::kSubKeyGt &&
+        request->st_type() == ::openmldb::api::GetType::kSubKeyLe && !request->enable_remove_duplicated_record()) {
+        uint64_t count = 0;
+        if (table->GetUnexpiredCount(index, request->key(), table->GetExpireTime(ttl), ttl.lat_ttl, &count) == 0) {
+            response->set_code(::openmldb::base::ReturnCode::kOk);
+            response->set_msg("ok");
+            response->set_count(count);
+            return;
+        }
+    }
     ::openmldb::storage::Ticket ticket;
     ::openmldb::storage::TableIterator* it = table->NewIterator(index, request->key(), ticket);
     if (it == NULL) {
@@ -1418,6 +1960,14 @@ void TabletImpl::Traverse(RpcController* controller, const ::openmldb::api::Trav
         response->set_msg("table is loading");
         return;
     }
+#ifndef SNAPSHOT_READ_ENABLE
+    if (request->snapshot_read()) {
+        response->set_code(::openmldb::base::ReturnCode::kInvalidParameter);
+        response->set_msg("snapshot read needs the build with SNAPSHOT_READ_ENABLE");
+        return;
+    }
+#endif
+    table->AddQueryCnt();
     uint32_t index = 0;
     std::string index_name;
     if (request->has_idx_name() && !request->idx_name().empty()) {
@@ -1435,24 +1985,76 @@ void TabletImpl::Traverse(RpcController* controller, const ::openmldb::api::Trav
         return;
     }
     index = index_def->GetId();
-    ::openmldb::storage::TableIterator* it = NULL;
-    it = table->NewTraverseIterator(index);
-    if (it == NULL) {
-        response->set_code(::openmldb::base::ReturnCode::kTsNameNotFound);
-        response->set_msg("create iterator failed");
-        return;
-    }
+    table->AddIndexQueryCnt(index);
+    // the iterators of disk tables hold the snapshots of rocksdb, only the ones of memory tables are kept
+    bool use_cursor = request->use_cursor() && traverse_cursors_->IsEnabled() &&
+                      table->GetStorageMode() == ::openmldb::common::kMemory;
+    std::unique_ptr<TraverseCursors::Cursor> cursor;
+    uint64_t cursor_id = 0;
+    if (use_cursor && request->cursor_id() > 0) {
+        cursor = traverse_cursors_->Take(request->cursor_id());
+        if (cursor && (cursor->tid != request->tid() || cursor->pid != request->pid() || cursor->index != index ||
+                       cursor->table != table)) {
+            cursor.reset();
+        }
+        if (cursor) {
+            cursor_id = request->cursor_id();
+        }
+    }
+    ::openmldb::storage::TraverseIterator* it = NULL;
     uint64_t last_time = 0;
     std::string last_pk;
-    if (request->has_pk() && request->pk().size() > 0) {
-        DEBUGLOG("tid %u, pid %u seek pk %s ts %lu", request->tid(), request->pid(), request->pk().c_str(),
-                 request->ts());
-        it->Seek(request->pk(), request->ts());
-        last_pk = request->pk();
-        last_time = request->ts();
+    uint64_t read_seq = request->read_seq();
+    if (cursor) {
+        // the cursor is lost if it timed out, and the page seeks pk and ts below then
+        DEBUGLOG("tid %u, pid %u go on from cursor %lu", request->tid(), request->pid(), cursor_id);
+        it = cursor->it.get();
+        it->ResetCount();
+        if (cursor->returned) {
+            it->Next();
+        } else if (!it->Valid() && !it->GetPK().empty()) {
+            // the last page stopped at max_traverse_cnt between the keys, or the row it stopped at has expired
+            it->NextPK();
+        }
+        last_pk = cursor->last_pk;
+        last_time = cursor->last_ts;
     } else {
-        DEBUGLOG("tid %u, pid %u seek to first", request->tid(), request->pid());
-        it->SeekToFirst();
+        // the read seq of the first page is pinned and returned, the next pages read as of it
+        ::openmldb::storage::ReadSnapshot read_snapshot;
+        std::unique_ptr<::openmldb::storage::ReadSnapshot::Scope> read_scope;
+        if (request->snapshot_read()) {
+            if (request->read_seq() > 0) {
+                read_snapshot.Pin(request->tid(), request->pid(), request->read_seq());
+            }
+            read_scope.reset(new ::openmldb::storage::ReadSnapshot::Scope(&read_snapshot));
+        }
+        it = table->NewTraverseIterator(index);
+        if (request->snapshot_read()) {
+            read_seq = read_snapshot.Pin(request->tid(), request->pid(), 0);
+        }
+        if (it == NULL) {
+            response->set_code(::openmldb::base::ReturnCode::kTsNameNotFound);
+            response->set_msg("create iterator failed");
+            return;
+        }
+        if (use_cursor) {
+            cursor.reset(new TraverseCursors::Cursor());
+            cursor->tid = request->tid();
+            cursor->pid = request->pid();
+            cursor->index = index;
+            cursor->table = table;
+            cursor->it.reset(it);
+        }
+        if (request->has_pk() && request->pk().size() > 0) {
+            DEBUGLOG("tid %u, pid %u seek pk %s ts %lu", request->tid(), request->pid(), request->pk().c_str(),
+                     request->ts());
+            it->Seek(request->pk(), request->ts());
+            last_pk = request->pk();
+            last_time = request->ts();
+        } else {
+            DEBUGLOG("tid %u, pid %u seek to first", request->tid(), request->pid());
+            it->SeekToFirst();
+        }
     }
     std::map<std::string, std::vector<std::pair<uint64_t, openmldb::base::Slice>>> value_map;
     std::vector<std::string> key_seq;
@@ -1462,6 +2064,8 @@ void TabletImpl::Traverse(RpcController* controller, const ::openmldb::api::Trav
         remove_duplicated_record = request->enable_remove_duplicated_record();
     }
     uint32_t scount = 0;
+    // the row the iterator stops at has been returned
+    bool returned = false;
     for (; it->Valid(); it->Next()) {
         if (request->limit() > 0 && scount > request->limit() - 1) {
             DEBUGLOG("reache the limit %u ", request->limit());
@@ -1487,9 +2091,15 @@ void TabletImpl::Traverse(RpcController* controller, const ::openmldb::api::Trav
         if (it->GetCount() >= FLAGS_max_traverse_cnt) {
             DEBUGLOG("traverse cnt %lu max %lu, key %s ts %lu", it->GetCount(), FLAGS_max_traverse_cnt, last_pk.c_str(),
                      last_time);
+            returned = true;
             break;
         }
     }
+    if (cursor) {
+        cursor->returned = returned;
+        cursor->last_pk = last_pk;
+        cursor->last_ts = last_time;
+    }
     bool is_finish = false;
     if (it->GetCount() >= FLAGS_max_traverse_cnt) {
         DEBUGLOG("traverse cnt %lu is great than max %lu, key %s ts %lu", it->GetCount(), FLAGS_max_traverse_cnt,
@@ -1502,81 +2112,127 @@ void TabletImpl::Traverse(RpcController* controller, const ::openmldb::api::Trav
     } else if (scount < request->limit()) {
         is_finish = true;
     }
-    uint32_t total_size = scount * (8 + 4 + 4) + total_block_size;
-    std::string* pairs = response->mutable_pairs();
-    if (scount <= 0) {
-        pairs->resize(0);
+    if (request->use_attachment()) {
+        // the pairs are appended to the attachment as they are, rather than flattened into the response and
+        // copied again by its serialization
+        butil::IOBuf& buf = dynamic_cast<brpc::Controller*>(controller)->response_attachment();
+        char head[::openmldb::codec::FULL_HEAD_SIZE];
+        for (const auto& key : key_seq) {
+            auto iter = value_map.find(key);
+            if (iter == value_map.end()) {
+                continue;
+            }
+            for (const auto& pair : iter->second) {
+                ::openmldb::codec::EncodeFullHead(key.length(), pair.first, pair.second.size(), head);
+                buf.append(head, ::openmldb::codec::FULL_HEAD_SIZE);
+                buf.append(key);
+                buf.append(pair.second.data(), pair.second.size());
+            }
+        }
+        response->set_buf_size(buf.size());
     } else {
-        pairs->resize(total_size);
-    }
-    char* rbuffer = reinterpret_cast<char*>(&((*pairs)[0]));
-    uint32_t offset = 0;
-    for (const auto& key : key_seq) {
-        auto iter = value_map.find(key);
-        if (iter == value_map.end()) {
-            continue;
+        uint32_t total_size = scount * (8 + 4 + 4) + total_block_size;
+        std::string* pairs = response->mutable_pairs();
+        if (scount <= 0) {
+            pairs->resize(0);
+        } else {
+            pairs->resize(total_size);
         }
-        for (const auto& pair : iter->second) {
-            DEBUGLOG("encode pk %s ts %lu size %u", key.c_str(), pair.first, pair.second.size());
-            ::openmldb::codec::EncodeFull(key, pair.first, pair.second.data(), pair.second.size(), rbuffer,
-                                          offset);
-            offset += (4 + 4 + 8 + key.length() + pair.second.size());
+        char* rbuffer = reinterpret_cast<char*>(&((*pairs)[0]));
+        uint32_t offset = 0;
+        for (const auto& key : key_seq) {
+            auto iter = value_map.find(key);
+            if (iter == value_map.end()) {
+                continue;
+            }
+            for (const auto& pair : iter->second) {
+                DEBUGLOG("encode pk %s ts %lu size %u", key.c_str(), pair.first, pair.second.size());
+                ::openmldb::codec::EncodeFull(key, pair.first, pair.second.data(), pair.second.size(), rbuffer,
+                                              offset);
+                offset += (4 + 4 + 8 + key.length() + pair.second.size());
+            }
         }
     }
-    delete it;
+    if (cursor) {
+        // put back after the values are copied, as the next page may take it at once
+        if (!is_finish) {
+            cursor_id = traverse_cursors_->Put(cursor_id, std::move(cursor));
+            response->set_cursor_id(cursor_id);
+        }
+    } else {
+        delete it;
+    }
     DEBUGLOG("traverse count %d. last_pk %s last_time %lu", scount, last_pk.c_str(), last_time);
     response->set_code(::openmldb::base::ReturnCode::kOk);
     response->set_count(scount);
     response->set_pk(last_pk);
     response->set_ts(last_time);
     response->set_is_finish(is_finish);
+    if (request->snapshot_read()) {
+        response->set_read_seq(read_seq);
+    }
 }
 
-void TabletImpl::Delete(RpcController* controller, const ::openmldb::api::DeleteRequest* request,
-                        openmldb::api::GeneralResponse* response, Closure* done) {
-    brpc::ClosureGuard done_guard(done);
+std::shared_ptr<Table> TabletImpl::GetDeleteTable(uint32_t tid, uint32_t pid, const std::string& idx_name,
+                                                  uint32_t* idx, ::openmldb::api::GeneralResponse* response) {
     if (follower_.load(std::memory_order_relaxed)) {
         response->set_code(::openmldb::base::ReturnCode::kIsFollowerCluster);
         response->set_msg("is follower cluster");
-        return;
+        return nullptr;
     }
-    std::shared_ptr<Table> table = GetTable(request->tid(), request->pid());
+    std::shared_ptr<Table> table = GetTable(tid, pid);
     if (!table) {
-        PDLOG(WARNING, "table is not exist. tid %u, pid %u", request->tid(), request->pid());
+        PDLOG(WARNING, "table is not exist. tid %u, pid %u", tid, pid);
         response->set_code(::openmldb::base::ReturnCode::kTableIsNotExist);
         response->set_msg("table is not exist");
-        return;
+        return nullptr;
     }
     if (!table->IsLeader()) {
-        DEBUGLOG("table is follower. tid %u, pid %u", request->tid(), request->pid());
+        DEBUGLOG("table is follower. tid %u, pid %u", tid, pid);
         response->set_code(::openmldb::base::ReturnCode::kTableIsFollower);
         response->set_msg("table is follower");
-        return;
+        return nullptr;
+    }
+    if (IsLeaseExpired()) {
+        response->set_code(::openmldb::base::ReturnCode::kTableIsFollower);
+        response->set_msg("the lease of tablet expired");
+        return nullptr;
     }
     if (table->GetTableStat() == ::openmldb::storage::kLoading) {
-        PDLOG(WARNING, "table is loading. tid %u, pid %u", request->tid(), request->pid());
+        PDLOG(WARNING, "table is loading. tid %u, pid %u", tid, pid);
         response->set_code(::openmldb::base::ReturnCode::kTableIsLoading);
         response->set_msg("table is loading");
-        return;
+        return nullptr;
     }
-    uint32_t idx = 0;
-    if (request->has_idx_name() && request->idx_name().size() > 0) {
-        std::shared_ptr<IndexDef> index_def = table->GetIndex(request->idx_name());
+    *idx = 0;
+    if (!idx_name.empty()) {
+        std::shared_ptr<IndexDef> index_def = table->GetIndex(idx_name);
         if (!index_def || !index_def->IsReady()) {
-            PDLOG(WARNING, "idx name %s not found in table tid %u, pid %u", request->idx_name().c_str(), request->tid(),
-                  request->pid());
+            PDLOG(WARNING, "idx name %s not found in table tid %u, pid %u", idx_name.c_str(), tid, pid);
             response->set_code(::openmldb::base::ReturnCode::kIdxNameNotFound);
             response->set_msg("idx name not found");
-            return;
+            return nullptr;
         }
-        idx = index_def->GetId();
+        *idx = index_def->GetId();
     }
-    if (table->Delete(request->key(), idx)) {
-        response->set_code(::openmldb::base::ReturnCode::kOk);
-        response->set_msg("ok");
-        DEBUGLOG("delete ok. tid %u, pid %u, key %s", request->tid(), request->pid(), request->key().c_str());
-    } else {
-        response->set_code(::openmldb::base::ReturnCode::kDeleteFailed);
+    return table;
+}
+
+void TabletImpl::Delete(RpcController* controller, const ::openmldb::api::DeleteRequest* request,
+                        openmldb::api::GeneralResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    uint32_t idx = 0;
+    std::shared_ptr<Table> table = GetDeleteTable(request->tid(), request->pid(), request->idx_name(), &idx, response);
+    if (!table) {
+        return;
+    }
+    if (table->Delete(request->key(), idx)) {
+        materialized_views_->Clear(table->GetDB(), table->GetName());
+        response->set_code(::openmldb::base::ReturnCode::kOk);
+        response->set_msg("ok");
+        DEBUGLOG("delete ok. tid %u, pid %u, key %s", request->tid(), request->pid(), request->key().c_str());
+    } else {
+        response->set_code(::openmldb::base::ReturnCode::kDeleteFailed);
         response->set_msg("delete failed");
         return;
     }
@@ -1601,21 +2257,224 @@ void TabletImpl::Delete(RpcController* controller, const ::openmldb::api::Delete
     return;
 }
 
+void TabletImpl::DeleteBatch(RpcController* controller, const ::openmldb::api::DeleteBatchRequest* request,
+                             ::openmldb::api::GeneralResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    uint32_t idx = 0;
+    std::shared_ptr<Table> table = GetDeleteTable(request->tid(), request->pid(), request->idx_name(), &idx, response);
+    if (!table) {
+        return;
+    }
+    std::shared_ptr<LogReplicator> replicator = GetReplicator(request->tid(), request->pid());
+    if (!replicator) {
+        PDLOG(WARNING, "fail to find table tid %u pid %u leader's log replicator", request->tid(), request->pid());
+    }
+    uint32_t deleted_cnt = 0;
+    for (const auto& key : request->keys()) {
+        // the keys not found are skipped rather than fail the others
+        if (!table->Delete(key, idx)) {
+            continue;
+        }
+        deleted_cnt++;
+        if (replicator) {
+            ::openmldb::api::LogEntry entry;
+            entry.set_term(replicator->GetLeaderTerm());
+            entry.set_method_type(::openmldb::api::MethodType::kDelete);
+            ::openmldb::api::Dimension* dimension = entry.add_dimensions();
+            dimension->set_key(key);
+            dimension->set_idx(idx);
+            replicator->AppendEntry(entry);
+        }
+    }
+    if (deleted_cnt > 0) {
+        materialized_views_->Clear(table->GetDB(), table->GetName());
+    }
+    if (replicator && deleted_cnt > 0 && FLAGS_binlog_notify_on_put) {
+        replicator->Notify();
+    }
+    DEBUGLOG("delete %u of %d keys. tid %u, pid %u", deleted_cnt, request->keys_size(), request->tid(),
+             request->pid());
+    response->set_code(::openmldb::base::ReturnCode::kOk);
+    response->set_msg("ok");
+    response->set_count(deleted_cnt);
+}
+
+// the time a query may wait for admission, the timeout of the caller or the default rpc timeout if unknown
+static uint64_t GetAdmissionTimeout(uint64_t timeout_ms) {
+    return (timeout_ms > 0 ? timeout_ms : static_cast<uint64_t>(FLAGS_request_timeout_ms)) * 1000;
+}
+
+// the time the caller waits for the query by, there is no deadline if the caller doesn't tell its timeout
+static std::chrono::steady_clock::time_point GetQueryDeadline(uint64_t timeout_ms) {
+    return timeout_ms > 0 ? std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms)
+                          : std::chrono::steady_clock::time_point::max();
+}
+
 void TabletImpl::Query(RpcController* ctrl, const openmldb::api::QueryRequest* request,
                        openmldb::api::QueryResponse* response, Closure* done) {
     DLOG(INFO) << "handle query request begin!";
     brpc::ClosureGuard done_guard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(ctrl);
     butil::IOBuf& buf = cntl->response_attachment();
-    ProcessQuery(ctrl, request, response, &buf);
+    if (request->has_result_id()) {
+        // the query has been admitted with its first chunk
+        FetchQueryResult(request, response, &buf);
+        return;
+    }
+    auto deadline = GetQueryDeadline(request->timeout_ms());
+    // only the queries from the clients are admitted, a sub query is a part of the query admitted already
+    auto ticket = std::make_shared<AdmissionController::Ticket>();
+    std::string msg;
+    if (!admission_->Admit(request->db(), request->is_procedure() ? request->sp_name() : "",
+                           GetAdmissionTimeout(request->timeout_ms()), ticket.get(), &msg)) {
+        response->set_code(::openmldb::base::ReturnCode::kQueryRejected);
+        response->set_msg(msg);
+        return;
+    }
+    if (!query_pool_) {
+        ExecuteQuery(ctrl, request, response, deadline);
+        return;
+    }
+    // the sub queries stay on the rpc workers, so a query worker waiting for them never waits for another one
+    auto enqueue_time = absl::Now();
+    if (!DispatchQuery([=] {
+            brpc::ClosureGuard task_guard(done);
+            if (StartQueryTask(enqueue_time, deadline, ticket.get())) {
+                ExecuteQuery(ctrl, request, response, deadline);
+            } else {
+                response->set_code(::openmldb::base::kQueryDeadlineExceeded);
+                response->set_msg("deadline exceeded in the query queue");
+            }
+            ticket->Release();
+        })) {
+        response->set_code(::openmldb::base::ReturnCode::kQueryRejected);
+        response->set_msg("the query queue is full");
+        return;
+    }
+    done_guard.release();
+}
+
+void TabletImpl::ExecuteQuery(RpcController* ctrl, const openmldb::api::QueryRequest* request,
+                              openmldb::api::QueryResponse* response,
+                              std::chrono::steady_clock::time_point deadline) {
+    std::string msg;
+    if (request->has_follower_read() && !CheckFollowerRead(request->follower_read(), &msg)) {
+        response->set_code(::openmldb::base::ReturnCode::kFollowerLagBehind);
+        response->set_msg(msg);
+        return;
+    }
+    ::openmldb::catalog::FollowerReadScope follower_scope(request->has_follower_read());
+    butil::IOBuf& buf = static_cast<brpc::Controller*>(ctrl)->response_attachment();
+    ProcessQuery(ctrl, request, response, &buf, deadline);
+}
+
+bool TabletImpl::CheckFollowerRead(const ::openmldb::api::FollowerRead& follower_read, std::string* msg) {
+    uint32_t tid = follower_read.tid();
+    uint32_t pid = follower_read.pid();
+    std::shared_ptr<Table> table = GetTable(tid, pid);
+    std::shared_ptr<LogReplicator> replicator = GetReplicator(tid, pid);
+    if (!table || !replicator) {
+        *msg = absl::StrCat("table is not exist. tid ", tid, " pid ", pid);
+        return false;
+    }
+    if (table->IsLeader() || table->GetTableStat() != ::openmldb::storage::kNormal) {
+        *msg = absl::StrCat("table is not a normal follower. tid ", tid, " pid ", pid);
+        return false;
+    }
+    uint64_t lag = replicator->GetLagBehindLeader();
+    if (lag > follower_read.max_lag()) {
+        *msg = absl::StrCat("follower lags behind the leader by ", lag, " log entries. tid ", tid, " pid ", pid);
+        return false;
+    }
+    return true;
+}
+
+// append the rows from *offset until more than max_bytes are appended, the rows appended are released
+static uint32_t AppendQueryRows(std::vector<::hybridse::codec::Row>* rows, uint32_t max_bytes, size_t* offset,
+                                butil::IOBuf* buf, uint32_t* byte_size) {
+    uint32_t count = 0;
+    for (; *offset < rows->size(); (*offset)++) {
+        if (*byte_size > max_bytes) {
+            break;
+        }
+        auto& row = (*rows)[*offset];
+        *byte_size += row.size();
+        buf->append(reinterpret_cast<void*>(row.buf()), row.size());
+        row = ::hybridse::codec::Row();
+        count++;
+    }
+    return count;
+}
+
+static uint32_t GetChunkBytes(uint32_t chunk_bytes) {
+    return chunk_bytes > 0 ? std::min(chunk_bytes, FLAGS_scan_max_bytes_size) : FLAGS_scan_max_bytes_size;
+}
+
+void TabletImpl::FetchQueryResult(const openmldb::api::QueryRequest* request,
+                                  ::openmldb::api::QueryResponse* response, butil::IOBuf* buf) {
+    auto cursor = query_result_cursors_->Take(request->result_id());
+    if (!cursor) {
+        response->set_code(::openmldb::base::ReturnCode::kQueryResultNotFound);
+        response->set_msg("query result " + std::to_string(request->result_id()) + " not found");
+        return;
+    }
+    uint32_t byte_size = 0;
+    uint32_t count = AppendQueryRows(&cursor->rows, GetChunkBytes(request->chunk_bytes()), &cursor->offset, buf,
+                                     &byte_size);
+    response->set_schema(cursor->schema);
+    response->set_total_count(cursor->rows.size());
+    response->set_byte_size(byte_size);
+    response->set_count(count);
+    if (cursor->offset < cursor->rows.size()) {
+        uint64_t result_id = query_result_cursors_->Put(request->result_id(), std::move(cursor));
+        if (result_id == 0) {
+            LOG(WARNING) << "fail to keep the query result " << request->result_id() << ", truncate result";
+        } else {
+            response->set_result_id(result_id);
+        }
+    }
+    response->set_code(::openmldb::base::kOk);
+}
+
+static void SetRunnerStats(const ::hybridse::vm::RunnerProfile& profile,
+                           ::google::protobuf::RepeatedPtrField<::openmldb::api::RunnerStat>* runner_stats) {
+    for (const auto& stat : profile.GetStats()) {
+        auto runner_stat = runner_stats->Add();
+        runner_stat->set_id(stat.id);
+        runner_stat->set_type(stat.type);
+        runner_stat->set_run_cnt(stat.run_cnt);
+        runner_stat->set_time_us(stat.time_us);
+        runner_stat->set_rows_in(stat.rows_in);
+        runner_stat->set_rows_out(stat.rows_out);
+        runner_stat->set_bytes_out(stat.bytes_out);
+    }
+}
+
+// the follower read runs in the bthread of the request, which the runner pool does not follow, and its rows are
+// not put in the window cache shared with the leader reads
+static void DisableSharedState(::hybridse::vm::RequestRunSession* session) {
+    session->SetRunnerPool({});
+    session->SetWindowCache({});
 }
 
 void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryRequest* request,
-                              ::openmldb::api::QueryResponse* response, butil::IOBuf* buf) {
+                              ::openmldb::api::QueryResponse* response, butil::IOBuf* buf,
+                              std::chrono::steady_clock::time_point deadline) {
+    ScopedProfileTag profile_tag(request->is_procedure() ? "deploy" : "query", request->db(),
+                                 request->is_procedure() ? request->sp_name() : "");
     auto start = absl::Now();
+    SlowTrace trace;
+    absl::Cleanup slow_trace_task = [this, request, &trace]() {
+        if (slow_traces_->IsEnabled() && trace.GetElapsed() > FLAGS_query_slow_log_threshold) {
+            slow_traces_->Add(request->is_batch() ? "batch query" : "request query",
+                              request->is_procedure() ? request->db() + "." + request->sp_name() : request->sql(),
+                              trace);
+        }
+    };
     absl::Cleanup deploy_collect_task = [this, request, start]() {
-        if (this->IsCollectDeployStatsEnabled()) {
-            if (request->is_procedure() && request->has_db() && request->has_sp_name()) {
+        if (request->is_procedure() && request->has_db() && request->has_sp_name()) {
+            this->CollectDeployMetrics(request->db(), request->sp_name(), start);
+            if (this->IsCollectDeployStatsEnabled()) {
                 this->TryCollectDeployStats(request->db(), request->sp_name(), start);
             }
         }
@@ -1623,26 +2482,43 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
 
     ::hybridse::base::Status status;
     if (request->is_batch()) {
-        // convert repeated openmldb:type::DataType into hybridse::codec::Schema
-        hybridse::codec::Schema parameter_schema;
-        for (int i = 0; i < request->parameter_types().size(); i++) {
-            auto column = parameter_schema.Add();
-            hybridse::type::Type hybridse_type;
-
-            if (!openmldb::schema::SchemaAdapter::ConvertType(request->parameter_types(i), &hybridse_type)) {
-                response->set_msg("Invalid parameter type: " +
-                                  openmldb::type::DataType_Name(request->parameter_types(i)));
-                response->set_code(::openmldb::base::kSQLCompileError);
+        ::hybridse::vm::BatchRunSession session;
+        if (request->has_statement_id()) {
+            auto statement = statement_cache_->Get(request->statement_id());
+            if (!statement) {
+                response->set_msg("statement " + std::to_string(request->statement_id()) + " not found");
+                response->set_code(::openmldb::base::kStatementNotFound);
                 return;
             }
-            column->set_type(hybridse_type);
-        }
-        ::hybridse::vm::BatchRunSession session;
-        if (request->is_debug()) {
-            session.EnableDebug();
-        }
-        session.SetParameterSchema(parameter_schema);
-        {
+            session = *statement->session;
+            session.SetCompileInfo(engine_->RecordRun(session.GetCompileInfo()));
+            if (request->is_debug()) {
+                session.EnableDebug();
+            }
+            session.SetDeadline(deadline);
+            trace.Mark("statement_cache_lookup");
+        } else {
+            // convert repeated openmldb:type::DataType into hybridse::codec::Schema
+            hybridse::codec::Schema parameter_schema;
+            for (int i = 0; i < request->parameter_types().size(); i++) {
+                auto column = parameter_schema.Add();
+                hybridse::type::Type hybridse_type;
+
+                if (!openmldb::schema::SchemaAdapter::ConvertType(request->parameter_types(i), &hybridse_type)) {
+                    response->set_msg("Invalid parameter type: " +
+                                      openmldb::type::DataType_Name(request->parameter_types(i)));
+                    response->set_code(::openmldb::base::kSQLCompileError);
+                    return;
+                }
+                column->set_type(hybridse_type);
+            }
+            if (request->is_debug()) {
+                session.EnableDebug();
+            }
+            session.SetDeadline(deadline);
+            session.SetParameterSchema(parameter_schema);
+            bool prepare = request->prepare() && !request->is_debug() && statement_cache_->IsEnabled();
+            uint64_t version = prepare ? statement_cache_->GetVersion(request->db()) : 0;
             bool ok = engine_->Get(request->sql(), request->db(), session, status);
             if (!ok) {
                 response->set_msg(status.msg);
@@ -1650,6 +2526,10 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
                 DLOG(WARNING) << "fail to compile sql " << request->sql() << ", message: " << status.msg;
                 return;
             }
+            if (prepare) {
+                response->set_statement_id(statement_cache_->Put(request->db(), request->sql(), session, version));
+            }
+            trace.Mark("compile");
         }
 
         ::hybridse::codec::Row parameter_row;
@@ -1661,30 +2541,70 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
             response->set_msg("fail to decode parameter row");
             return;
         }
+        if (request->is_profile()) {
+            session.SetProfile(std::make_shared<::hybridse::vm::RunnerProfile>());
+        }
+        ::openmldb::storage::ReadSnapshot read_snapshot;
+        std::unique_ptr<::openmldb::storage::ReadSnapshot::Scope> read_scope;
+        if (request->snapshot_read()) {
+#ifndef SNAPSHOT_READ_ENABLE
+            response->set_code(::openmldb::base::kSQLRunError);
+            response->set_msg("snapshot read needs the build with SNAPSHOT_READ_ENABLE");
+            return;
+#endif
+            PinReadSnapshot(&read_snapshot);
+            read_scope.reset(new ::openmldb::storage::ReadSnapshot::Scope(&read_snapshot));
+            // the snapshot is set on this thread only, so the partitions are not read by the workers
+            session.SetParallelism(1);
+            trace.Mark("pin_snapshot");
+        }
         std::vector<::hybridse::codec::Row> output_rows;
         int32_t run_ret = session.Run(parameter_row, output_rows);
+        read_scope.reset();
+        trace.Mark("run");
+        if (run_ret == ::hybridse::vm::RunSession::RUN_DEADLINE_EXCEEDED) {
+            response->set_msg("deadline exceeded");
+            response->set_code(::openmldb::base::kQueryDeadlineExceeded);
+            return;
+        }
+        if (run_ret == ::hybridse::vm::RunSession::RUN_MEMORY_LIMIT_EXCEEDED) {
+            response->set_msg("memory limit exceeded");
+            response->set_code(::openmldb::base::kQueryMemoryLimitExceeded);
+            return;
+        }
         if (run_ret != 0) {
             response->set_msg(status.msg);
             response->set_code(::openmldb::base::kSQLRunError);
             DLOG(WARNING) << "fail to run sql: " << request->sql();
             return;
         }
+        if (session.GetProfile()) {
+            SetRunnerStats(*session.GetProfile(), response->mutable_runner_stats());
+        }
         uint32_t byte_size = 0;
-        uint32_t count = 0;
-        for (auto& output_row : output_rows) {
-            if (byte_size > FLAGS_scan_max_bytes_size) {
+        size_t offset = 0;
+        bool chunked = request->chunk_bytes() > 0 && query_result_cursors_->IsEnabled();
+        uint32_t count = AppendQueryRows(&output_rows, chunked ? GetChunkBytes(request->chunk_bytes())
+                                                               : FLAGS_scan_max_bytes_size,
+                                         &offset, buf, &byte_size);
+        trace.Mark("encode_output");
+        response->set_schema(session.GetEncodedSchema());
+        response->set_total_count(output_rows.size());
+        if (offset < output_rows.size()) {
+            uint64_t result_id = 0;
+            if (chunked) {
+                std::unique_ptr<QueryResultCursor> cursor(new QueryResultCursor());
+                cursor->schema = session.GetEncodedSchema();
+                cursor->rows = std::move(output_rows);
+                cursor->offset = offset;
+                result_id = query_result_cursors_->Put(0, std::move(cursor));
+            }
+            if (result_id == 0) {
                 LOG(WARNING) << "reach the max byte size truncate result";
-                response->set_schema(session.GetEncodedSchema());
-                response->set_byte_size(byte_size);
-                response->set_count(count);
-                response->set_code(::openmldb::base::kOk);
-                return;
+            } else {
+                response->set_result_id(result_id);
             }
-            byte_size += output_row.size();
-            buf->append(reinterpret_cast<void*>(output_row.buf()), output_row.size());
-            count += 1;
         }
-        response->set_schema(session.GetEncodedSchema());
         response->set_byte_size(byte_size);
         response->set_count(count);
         response->set_code(::openmldb::base::kOk);
@@ -1695,6 +2615,7 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
         if (request->is_debug()) {
             session.EnableDebug();
         }
+        session.SetDeadline(deadline);
         if (request->is_procedure()) {
             const std::string& db_name = request->db();
             const std::string& sp_name = request->sp_name();
@@ -1709,9 +2630,26 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
                     return;
                 }
             }
-            session.SetCompileInfo(request_compile_info);
+            session.SetCompileInfo(engine_->RecordRun(request_compile_info));
             session.SetSpName(sp_name);
-            RunRequestQuery(ctrl, *request, session, *response, *buf);
+            engine_->InitRequestSession(&session);
+            if (request->has_follower_read()) {
+                DisableSharedState(&session);
+            }
+            trace.Mark("compile_cache_lookup");
+            if (request->is_profile()) {
+                session.SetProfile(std::make_shared<::hybridse::vm::RunnerProfile>());
+            } else {
+                session.SetProfile(GetDeployProfile(db_name, sp_name));
+            }
+            bool plain = !request->is_debug() && !request->is_profile() && !request->has_follower_read();
+            if (plain && LookupMaterializedView(ctrl, *request, *response, *buf, &trace)) {
+                DLOG(INFO) << "answer procedure " << sp_name << " by its materialized output";
+            } else if (result_cache_->IsEnabled() && plain) {
+                RunCachedRequestQuery(ctrl, *request, session, *response, *buf, &trace);
+            } else {
+                RunRequestQuery(ctrl, *request, session, *response, *buf, &trace);
+            }
         } else {
             bool ok = engine_->Get(request->sql(), request->db(), session, status);
             if (!ok || session.GetCompileInfo() == nullptr) {
@@ -1720,7 +2658,17 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
                 DLOG(WARNING) << "fail to compile sql in request mode:\n" << request->sql();
                 return;
             }
-            RunRequestQuery(ctrl, *request, session, *response, *buf);
+            trace.Mark("compile");
+            if (request->has_follower_read()) {
+                DisableSharedState(&session);
+            }
+            if (request->is_profile()) {
+                session.SetProfile(std::make_shared<::hybridse::vm::RunnerProfile>());
+            }
+            RunRequestQuery(ctrl, *request, session, *response, *buf, &trace);
+        }
+        if (request->is_profile() && response->code() == ::openmldb::base::kOk) {
+            SetRunnerStats(*session.GetProfile(), response->mutable_runner_stats());
         }
         const std::string& sql = session.GetCompileInfo()->GetSql();
         if (response->code() != ::openmldb::base::kOk) {
@@ -1737,7 +2685,14 @@ void TabletImpl::SubQuery(RpcController* ctrl, const openmldb::api::QueryRequest
     brpc::ClosureGuard done_guard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(ctrl);
     butil::IOBuf& buf = cntl->response_attachment();
-    ProcessQuery(ctrl, request, response, &buf);
+    std::string msg;
+    if (request->has_follower_read() && !CheckFollowerRead(request->follower_read(), &msg)) {
+        response->set_code(::openmldb::base::ReturnCode::kFollowerLagBehind);
+        response->set_msg(msg);
+        return;
+    }
+    ::openmldb::catalog::FollowerReadScope follower_scope(request->has_follower_read());
+    ProcessQuery(ctrl, request, response, &buf, GetQueryDeadline(request->timeout_ms()));
 }
 
 void TabletImpl::SQLBatchRequestQuery(RpcController* ctrl, const openmldb::api::SQLBatchRequestQueryRequest* request,
@@ -1746,15 +2701,50 @@ void TabletImpl::SQLBatchRequestQuery(RpcController* ctrl, const openmldb::api::
     brpc::ClosureGuard done_guard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(ctrl);
     butil::IOBuf& buf = cntl->response_attachment();
-    return ProcessBatchRequestQuery(ctrl, request, response, buf);
+    auto deadline = GetQueryDeadline(request->timeout_ms());
+    // the sub queries of the batch request queries are sent here with their task ids
+    if (request->has_task_id()) {
+        return ProcessBatchRequestQuery(ctrl, request, response, buf, deadline);
+    }
+    auto ticket = std::make_shared<AdmissionController::Ticket>();
+    std::string msg;
+    if (!admission_->Admit(request->db(), request->is_procedure() ? request->sp_name() : "",
+                           GetAdmissionTimeout(request->timeout_ms()), ticket.get(), &msg)) {
+        response->set_code(::openmldb::base::ReturnCode::kQueryRejected);
+        response->set_msg(msg);
+        return;
+    }
+    if (!query_pool_) {
+        return ProcessBatchRequestQuery(ctrl, request, response, buf, deadline);
+    }
+    auto enqueue_time = absl::Now();
+    if (!DispatchQuery([=, &buf] {
+            brpc::ClosureGuard task_guard(done);
+            if (StartQueryTask(enqueue_time, deadline, ticket.get())) {
+                ProcessBatchRequestQuery(ctrl, request, response, buf, deadline);
+            } else {
+                response->set_code(::openmldb::base::kQueryDeadlineExceeded);
+                response->set_msg("deadline exceeded in the query queue");
+            }
+            ticket->Release();
+        })) {
+        response->set_code(::openmldb::base::ReturnCode::kQueryRejected);
+        response->set_msg("the query queue is full");
+        return;
+    }
+    done_guard.release();
 }
 void TabletImpl::ProcessBatchRequestQuery(RpcController* ctrl,
                                           const openmldb::api::SQLBatchRequestQueryRequest* request,
-                                          openmldb::api::SQLBatchRequestQueryResponse* response, butil::IOBuf& buf) {
+                                          openmldb::api::SQLBatchRequestQueryResponse* response, butil::IOBuf& buf,
+                                          std::chrono::steady_clock::time_point deadline) {
+    ScopedProfileTag profile_tag(request->is_procedure() ? "deploy" : "query", request->db(),
+                                 request->is_procedure() ? request->sp_name() : "");
     absl::Time start = absl::Now();
     absl::Cleanup deploy_collect_task = [this, request, start]() {
-        if (this->IsCollectDeployStatsEnabled()) {
-            if (request->is_procedure() && request->has_db() && request->has_sp_name()) {
+        if (request->is_procedure() && request->has_db() && request->has_sp_name()) {
+            this->CollectDeployMetrics(request->db(), request->sp_name(), start);
+            if (this->IsCollectDeployStatsEnabled()) {
                 this->TryCollectDeployStats(request->db(), request->sp_name(), start);
             }
         }
@@ -1779,7 +2769,7 @@ void TabletImpl::ProcessBatchRequestQuery(RpcController* ctrl,
                 PDLOG(WARNING, status.msg.c_str());
                 return;
             }
-            session.SetCompileInfo(request_compile_info);
+            session.SetCompileInfo(engine_->RecordRun(request_compile_info));
             session.SetSpName(request->sp_name());
         }
     } else {
@@ -1817,7 +2807,17 @@ void TabletImpl::ProcessBatchRequestQuery(RpcController* ctrl,
         return;
     }
 
-    auto& io_buf = static_cast<brpc::Controller*>(ctrl)->request_attachment();
+    butil::IOBuf uncompressed_buf;
+    auto* request_buf = &static_cast<brpc::Controller*>(ctrl)->request_attachment();
+    if (request->compress_type() == ::openmldb::type::CompressType::kSnappy) {
+        if (!codec::UncompressRpcRows(*request_buf, &uncompressed_buf)) {
+            response->set_msg("uncompress input rows failed");
+            response->set_code(::openmldb::base::kSQLRunError);
+            return;
+        }
+        request_buf = &uncompressed_buf;
+    }
+    const auto& io_buf = *request_buf;
     size_t buf_offset = 0;
     std::vector<::hybridse::codec::Row> input_rows(input_row_num);
     if (has_common_and_uncommon_row) {
@@ -1855,11 +2855,22 @@ void TabletImpl::ProcessBatchRequestQuery(RpcController* ctrl,
     }
     std::vector<::hybridse::codec::Row> output_rows;
     int32_t run_ret = 0;
+    session.SetDeadline(deadline);
     if (request->has_task_id()) {
         run_ret = session.Run(request->task_id(), input_rows, output_rows);
     } else {
         run_ret = session.Run(input_rows, output_rows);
     }
+    if (run_ret == ::hybridse::vm::RunSession::RUN_DEADLINE_EXCEEDED) {
+        response->set_msg("deadline exceeded");
+        response->set_code(::openmldb::base::kQueryDeadlineExceeded);
+        return;
+    }
+    if (run_ret == ::hybridse::vm::RunSession::RUN_MEMORY_LIMIT_EXCEEDED) {
+        response->set_msg("memory limit exceeded");
+        response->set_code(::openmldb::base::kQueryMemoryLimitExceeded);
+        return;
+    }
     if (run_ret != 0) {
         response->set_msg(status.msg);
         response->set_code(::openmldb::base::kSQLRunError);
@@ -1926,7 +2937,7 @@ void TabletImpl::SubBatchRequestQuery(RpcController* ctrl, const openmldb::api::
     brpc::ClosureGuard done_guard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(ctrl);
     butil::IOBuf& buf = cntl->response_attachment();
-    return ProcessBatchRequestQuery(ctrl, request, response, buf);
+    return ProcessBatchRequestQuery(ctrl, request, response, buf, GetQueryDeadline(request->timeout_ms()));
 }
 
 void TabletImpl::ChangeRole(RpcController* controller, const ::openmldb::api::ChangeRoleRequest* request,
@@ -2018,7 +3029,7 @@ void TabletImpl::ChangeRole(RpcController* controller, const ::openmldb::api::Ch
         }
         PDLOG(INFO, "change to follower. tid[%u] pid[%u]", tid, pid);
         if (!table->GetDB().empty()) {
-            catalog_->DeleteTable(table->GetDB(), table->GetName(), pid);
+            catalog_->AddFollowerTable(*(table->GetTableMeta()), table);
         }
     }
     response->set_code(::openmldb::base::ReturnCode::kOk);
@@ -2088,6 +3099,7 @@ void TabletImpl::AddReplica(RpcController* controller, const ::openmldb::api::Re
         if (task_ptr) {
             std::lock_guard<std::mutex> lock(mu_);
             task_ptr->set_status(::openmldb::api::TaskStatus::kDone);
+            NotifyTaskFinished(task_ptr);
         }
         return;
     } while (0);
@@ -2146,6 +3158,7 @@ void TabletImpl::DelReplica(RpcController* controller, const ::openmldb::api::Re
         if (task_ptr) {
             std::lock_guard<std::mutex> lock(mu_);
             task_ptr->set_status(::openmldb::api::TaskStatus::kDone);
+            NotifyTaskFinished(task_ptr);
         }
         return;
     } while (0);
@@ -2195,6 +3208,9 @@ void TabletImpl::AppendEntries(RpcController* controller, const ::openmldb::api:
     }
     response->set_code(::openmldb::base::ReturnCode::kOk);
     response->set_msg("ok");
+    if (request->has_leader_log_offset()) {
+        replicator->UpdateLeaderLogOffset(request->leader_log_offset());
+    }
     uint64_t last_log_offset = replicator->GetOffset();
     if (request->pre_log_index() == 0 && request->entries_size() == 0) {
         response->set_log_offset(last_log_offset);
@@ -2207,6 +3223,14 @@ void TabletImpl::AppendEntries(RpcController* controller, const ::openmldb::api:
         PDLOG(INFO, "first sync log_index! log_offset[%lu] tid[%u] pid[%u]", last_log_offset, tid, pid);
         return;
     }
+    if (request->check_pre_log_index() && request->pre_log_index() > last_log_offset) {
+        PDLOG(WARNING, "pre log index %lu is greater than cur log_offset %lu. tid %u pid %u", request->pre_log_index(),
+              last_log_offset, tid, pid);
+        response->set_code(::openmldb::base::ReturnCode::kFailToAppendEntriesToReplicator);
+        response->set_msg("pre log index is greater than log offset");
+        response->set_log_offset(last_log_offset);
+        return;
+    }
     for (int32_t i = 0; i < request->entries_size(); i++) {
         const auto& entry = request->entries(i);
         if (entry.log_index() <= last_log_offset) {
@@ -2239,6 +3263,16 @@ void TabletImpl::AppendEntries(RpcController* controller, const ::openmldb::api:
     response->set_log_offset(replicator->GetOffset());
 }
 
+void TabletImpl::AppendEntriesBatch(RpcController* controller,
+                                    const ::openmldb::api::AppendEntriesBatchRequest* request,
+                                    ::openmldb::api::AppendEntriesBatchResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    // every partition has one request in a batch at most, so they are applied one by one as they come alone
+    for (const auto& append_request : request->requests()) {
+        AppendEntries(controller, &append_request, response->add_responses(), nullptr);
+    }
+}
+
 void TabletImpl::GetTableSchema(RpcController* controller, const ::openmldb::api::GetTableSchemaRequest* request,
                                 ::openmldb::api::GetTableSchemaResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -2360,6 +3394,7 @@ void TabletImpl::GetTableStatus(RpcController* controller, const ::openmldb::api
             status->set_storage_mode(table->GetStorageMode());
             status->set_name(table->GetName());
             status->set_diskused(table->GetDiskused());
+            status->set_query_cnt(table->GetQueryCnt());
             if (::openmldb::api::TableState_IsValid(table->GetTableStat())) {
                 status->set_state(::openmldb::api::TableState(table->GetTableStat()));
             }
@@ -2390,6 +3425,13 @@ void TabletImpl::GetTableStatus(RpcController* controller, const ::openmldb::api
                             }
                         }
                         delete[] stats;
+                        ::openmldb::storage::IndexStat index_stat;
+                        if (mem_table->GetIndexStat(index_def->GetId(), &index_stat)) {
+                            ts_idx_status->set_key_cnt(index_stat.key_cnt);
+                            ts_idx_status->set_min_ts(index_stat.min_ts);
+                            ts_idx_status->set_max_ts(index_stat.max_ts);
+                        }
+                        ts_idx_status->set_query_cnt(table->GetIndexQueryCnt(index_def->GetId()));
                     }
                     status->set_idx_cnt(record_idx_cnt);
                 }
@@ -2459,6 +3501,7 @@ void TabletImpl::MakeSnapshotInternal(uint32_t tid, uint32_t pid, uint64_t end_o
         if (task) {
             std::lock_guard<std::mutex> lock(mu_);
             task->set_status(::openmldb::api::kFailed);
+            NotifyTaskFinished(task);
         }
         return;
     }
@@ -2479,6 +3522,14 @@ void TabletImpl::MakeSnapshotInternal(uint32_t tid, uint32_t pid, uint64_t end_o
         ret = snapshot->MakeSnapshot(table, offset, end_offset, replicator->GetLeaderTerm());
         if (ret == 0) {
             replicator->SetSnapshotLogPartIndex(offset);
+            // the puts up to the snapshot offset have updated the aggregators, so their recovery starts from here
+            // rather than the last flushed buckets
+            auto aggrs = GetAggregators(tid, pid);
+            if (aggrs) {
+                for (auto& aggr : *aggrs) {
+                    aggr->Checkpoint(offset);
+                }
+            }
         }
     }
     {
@@ -2490,11 +3541,13 @@ void TabletImpl::MakeSnapshotInternal(uint32_t tid, uint32_t pid, uint64_t end_o
         if (task) {
             if (ret == 0) {
                 task->set_status(::openmldb::api::kDone);
+                NotifyTaskFinished(task);
                 auto right_now = std::chrono::system_clock::now().time_since_epoch();
                 int64_t ts = std::chrono::duration_cast<std::chrono::seconds>(right_now).count();
                 table->SetMakeSnapshotTime(ts);
             } else {
                 task->set_status(::openmldb::api::kFailed);
+                NotifyTaskFinished(task);
             }
         }
     }
@@ -2542,7 +3595,8 @@ void TabletImpl::MakeSnapshot(RpcController* controller, const ::openmldb::api::
                 break;
             }
         }
-        snapshot_pool_.AddTask(boost::bind(&TabletImpl::MakeSnapshotInternal, this, tid, pid, offset, task_ptr));
+        background_pool_.AddTask(kSnapshotTask,
+                                 boost::bind(&TabletImpl::MakeSnapshotInternal, this, tid, pid, offset, task_ptr));
         response->set_code(::openmldb::base::ReturnCode::kOk);
         response->set_msg("ok");
         return;
@@ -2553,7 +3607,8 @@ void TabletImpl::MakeSnapshot(RpcController* controller, const ::openmldb::api::
 void TabletImpl::SchedMakeSnapshot() {
     int now_hour = ::openmldb::base::GetNowHour();
     if (now_hour != FLAGS_make_snapshot_time) {
-        snapshot_pool_.DelayTask(FLAGS_make_snapshot_check_interval, boost::bind(&TabletImpl::SchedMakeSnapshot, this));
+        background_pool_.DelayTask(kSnapshotTask, FLAGS_make_snapshot_check_interval,
+                                   boost::bind(&TabletImpl::SchedMakeSnapshot, this));
         return;
     }
     std::vector<std::pair<uint32_t, uint32_t>> table_set;
@@ -2579,8 +3634,8 @@ void TabletImpl::SchedMakeSnapshot() {
         MakeSnapshotInternal(iter->first, iter->second, 0, std::shared_ptr<::openmldb::api::TaskInfo>());
     }
     // delay task one hour later avoid execute  more than one time
-    snapshot_pool_.DelayTask(FLAGS_make_snapshot_check_interval + 60 * 60 * 1000,
-                             boost::bind(&TabletImpl::SchedMakeSnapshot, this));
+    background_pool_.DelayTask(kSnapshotTask, FLAGS_make_snapshot_check_interval + 60 * 60 * 1000,
+                               boost::bind(&TabletImpl::SchedMakeSnapshot, this));
 }
 
 void TabletImpl::SendData(RpcController* controller, const ::openmldb::api::SendDataRequest* request,
@@ -2673,12 +3728,12 @@ void TabletImpl::SendData(RpcController* controller, const ::openmldb::api::Send
         response->set_code(::openmldb::base::ReturnCode::kBlockIdMismatch);
         return;
     }
-    std::string data = cntl->request_attachment().to_string();
-    if (data.length() != request->block_size()) {
+    const butil::IOBuf& data = cntl->request_attachment();
+    if (data.size() != request->block_size()) {
         PDLOG(WARNING,
               "receive data error. tid %u, pid %u, file_name %s, expected "
               "length %u real length %u",
-              tid, pid, request->file_name().c_str(), request->block_size(), data.length());
+              tid, pid, request->file_name().c_str(), request->block_size(), data.size());
         response->set_code(::openmldb::base::ReturnCode::kReceiveDataError);
         response->set_msg("receive data error");
         return;
@@ -2744,8 +3799,9 @@ void TabletImpl::SendSnapshot(RpcController* controller, const ::openmldb::api::
             break;
         }
         sync_snapshot_set_.insert(sync_snapshot_key);
-        task_pool_.AddTask(boost::bind(&TabletImpl::SendSnapshotInternal, this, request->endpoint(), tid, pid,
-                                       request->remote_tid(), task_ptr));
+        background_pool_.AddTask(kSendFileTask,
+                                 boost::bind(&TabletImpl::SendSnapshotInternal, this, request->endpoint(), tid, pid,
+                                             request->remote_tid(), task_ptr));
         response->set_code(::openmldb::base::ReturnCode::kOk);
         response->set_msg("ok");
         return;
@@ -2796,6 +3852,7 @@ void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid,
         full_path.append("snapshot/");
         std::string manifest_file = full_path + "MANIFEST";
         std::string snapshot_file;
+        std::vector<std::string> delta_files;
         {
             int fd = open(manifest_file.c_str(), O_RDONLY);
             if (fd < 0) {
@@ -2811,9 +3868,11 @@ void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid,
                 break;
             }
             snapshot_file = manifest.name();
+            delta_files.assign(manifest.delta_name().begin(), manifest.delta_name().end());
         }
-        if (table->GetStorageMode() == common::kMemory) {
-            // send snapshot file
+        if (table->GetStorageMode() == common::kMemory &&
+            !::openmldb::base::IsFolder(full_path + snapshot_file)) {
+            // send snapshot file, it is a directory of part files if made with snapshot_part_num
             if (sender.SendFile(snapshot_file, full_path + snapshot_file) < 0) {
                 PDLOG(WARNING, "send snapshot failed. tid[%u] pid[%u]", tid, pid);
                 break;
@@ -2824,6 +3883,18 @@ void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid,
                 break;
             }
         }
+        // the incremental snapshots of memory table
+        bool delta_failed = false;
+        for (const auto& delta_file : delta_files) {
+            if (sender.SendFile(delta_file, full_path + delta_file) < 0) {
+                PDLOG(WARNING, "send snapshot %s failed. tid[%u] pid[%u]", delta_file.c_str(), tid, pid);
+                delta_failed = true;
+                break;
+            }
+        }
+        if (delta_failed) {
+            break;
+        }
         // send manifest file
         file_name = "MANIFEST";
         if (sender.SendFile(file_name, full_path + file_name) < 0) {
@@ -2840,6 +3911,7 @@ void TabletImpl::SendSnapshotInternal(const std::string& endpoint, uint32_t tid,
         } else {
             task->set_status(::openmldb::api::kDone);
         }
+        NotifyTaskFinished(task);
     }
     std::string sync_snapshot_key = endpoint + "_" + std::to_string(tid) + "_" + std::to_string(pid);
     sync_snapshot_set_.erase(sync_snapshot_key);
@@ -2886,6 +3958,7 @@ void TabletImpl::PauseSnapshot(RpcController* controller, const ::openmldb::api:
         if (task_ptr) {
             std::lock_guard<std::mutex> lock(mu_);
             task_ptr->set_status(::openmldb::api::TaskStatus::kDone);
+            NotifyTaskFinished(task_ptr);
         }
         response->set_code(::openmldb::base::ReturnCode::kOk);
         response->set_msg("ok");
@@ -2936,6 +4009,7 @@ void TabletImpl::RecoverSnapshot(RpcController* controller, const ::openmldb::ap
         std::lock_guard<std::mutex> lock(mu_);
         if (task_ptr) {
             task_ptr->set_status(::openmldb::api::TaskStatus::kDone);
+            NotifyTaskFinished(task_ptr);
         }
         response->set_code(::openmldb::base::ReturnCode::kOk);
         response->set_msg("ok");
@@ -3013,12 +4087,28 @@ void TabletImpl::LoadTable(RpcController* controller, const ::openmldb::api::Loa
             }
             PDLOG(INFO, "start to recover table with id %u pid %u name %s seg_cnt %d ", tid, pid, name.c_str(),
                   seg_cnt);
-            task_pool_.AddTask(boost::bind(&TabletImpl::LoadTableInternal, this, tid, pid, task_ptr));
         } else {
-            task_pool_.AddTask(boost::bind(&TabletImpl::LoadDiskTableInternal, this, tid, pid, table_meta, task_ptr));
             PDLOG(INFO, "load table tid[%u] pid[%u] storage mode[%s]", tid, pid,
                   ::openmldb::common::StorageMode_Name(table_meta.storage_mode()).c_str());
         }
+        RecoveryJob job;
+        job.tid = tid;
+        job.pid = pid;
+        auto priority_iter = recover_priorities_.find(table_meta.db() + "." + table_meta.name());
+        if (priority_iter != recover_priorities_.end()) {
+            job.priority = priority_iter->second;
+        }
+        job.disk = root_path;
+        if (table_meta.storage_mode() == openmldb::common::kMemory) {
+            // the snapshot and the binlog are all read into memory
+            ::openmldb::base::GetDirSizeRecur(db_path, job.cost);
+            job.task = boost::bind(&TabletImpl::LoadTableInternal, this, tid, pid, task_ptr);
+        } else {
+            // only the binlog is replayed, the data stays in rocksdb
+            ::openmldb::base::GetDirSizeRecur(db_path + "/binlog", job.cost);
+            job.task = boost::bind(&TabletImpl::LoadDiskTableInternal, this, tid, pid, table_meta, task_ptr);
+        }
+        recovery_scheduler_.Add(std::move(job));
 
         response->set_code(::openmldb::base::ReturnCode::kOk);
         response->set_msg("ok");
@@ -3099,15 +4189,17 @@ int TabletImpl::LoadTableInternal(uint32_t tid, uint32_t pid, std::shared_ptr<::
             replicator->SetSnapshotLogPartIndex(snapshot->GetOffset());
             replicator->StartSyncing();
             table->SchedGc();
-            gc_pool_.DelayTask(FLAGS_gc_interval * 60 * 1000, boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
+            background_pool_.DelayTask(kGcTask, FLAGS_gc_interval * 60 * 1000,
+                                       boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
             io_pool_.DelayTask(FLAGS_binlog_sync_to_disk_interval,
                                boost::bind(&TabletImpl::SchedSyncDisk, this, tid, pid));
-            task_pool_.DelayTask(FLAGS_binlog_delete_interval,
-                                 boost::bind(&TabletImpl::SchedDelBinlog, this, tid, pid));
+            background_pool_.DelayTask(kBinlogDeleteTask, FLAGS_binlog_delete_interval,
+                                       boost::bind(&TabletImpl::SchedDelBinlog, this, tid, pid));
             PDLOG(INFO, "load table success. tid %u pid %u", tid, pid);
             if (task_ptr) {
                 std::lock_guard<std::mutex> lock(mu_);
                 task_ptr->set_status(::openmldb::api::TaskStatus::kDone);
+                NotifyTaskFinished(task_ptr);
                 return 0;
             }
         } else {
@@ -3194,12 +4286,12 @@ int TabletImpl::LoadDiskTableInternal(uint32_t tid, uint32_t pid, const ::openml
             replicator->StartSyncing();
             disk_table->SetOffset(latest_offset);
             table->SchedGc();
-            gc_pool_.DelayTask(FLAGS_disk_gc_interval * 60 * 1000,
-                               boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
+            background_pool_.DelayTask(kGcTask, FLAGS_disk_gc_interval * 60 * 1000,
+                                       boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
             io_pool_.DelayTask(FLAGS_binlog_sync_to_disk_interval,
                                boost::bind(&TabletImpl::SchedSyncDisk, this, tid, pid));
-            task_pool_.DelayTask(FLAGS_binlog_delete_interval,
-                                 boost::bind(&TabletImpl::SchedDelBinlog, this, tid, pid));
+            background_pool_.DelayTask(kBinlogDeleteTask, FLAGS_binlog_delete_interval,
+                                       boost::bind(&TabletImpl::SchedDelBinlog, this, tid, pid));
             PDLOG(INFO, "load table success. tid %u pid %u", tid, pid);
             MakeSnapshotInternal(tid, pid, 0, std::shared_ptr<::openmldb::api::TaskInfo>());
             std::string old_data_path = table_path + "/old_data";
@@ -3212,6 +4304,7 @@ int TabletImpl::LoadDiskTableInternal(uint32_t tid, uint32_t pid, const ::openml
             if (task_ptr) {
                 std::lock_guard<std::mutex> lock(mu_);
                 task_ptr->set_status(::openmldb::api::TaskStatus::kDone);
+                NotifyTaskFinished(task_ptr);
                 return 0;
             }
         } else {
@@ -3248,9 +4341,11 @@ int32_t TabletImpl::DeleteTableInternal(uint32_t tid, uint32_t pid,
         {
             std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
             engine_->ClearCacheLocked(table->GetTableMeta()->db());
+            statement_cache_->Invalidate(table->GetTableMeta()->db());
             tables_[tid].erase(pid);
             replicators_[tid].erase(pid);
             snapshots_[tid].erase(pid);
+            split_routers_.erase(std::make_pair(tid, pid));
             if (tables_[tid].empty()) {
                 tables_.erase(tid);
             }
@@ -3260,6 +4355,7 @@ int32_t TabletImpl::DeleteTableInternal(uint32_t tid, uint32_t pid,
             if (snapshots_[tid].empty()) {
                 snapshots_.erase(tid);
             }
+            PublishTablesUnLock();
         }
         if (replicator) {
             replicator->DelAllReplicateNode();
@@ -3271,12 +4367,18 @@ int32_t TabletImpl::DeleteTableInternal(uint32_t tid, uint32_t pid,
         // bulk load data receiver should be destroyed too, and can't do table and data receiver destroy at the same
         // time. So keep data receiver destroy before table destroy.
         bulk_load_mgr_.RemoveReceiver(tid, pid);
+        if (table_reclaimer_ && table->GetStorageMode() == ::openmldb::common::kMemory) {
+            table_reclaimer_->Add(std::move(table));
+        }
+        // a disk table is closed here, as its data directory is moved away next
+        table.reset();
         code = 0;
     } while (false);
     if (code < 0) {
         if (task_ptr) {
             std::lock_guard<std::mutex> lock(mu_);
             task_ptr->set_status(::openmldb::api::TaskStatus::kFailed);
+            NotifyTaskFinished(task_ptr);
         }
         return code;
     }
@@ -3286,6 +4388,7 @@ int32_t TabletImpl::DeleteTableInternal(uint32_t tid, uint32_t pid,
         if (task_ptr) {
             std::lock_guard<std::mutex> lock(mu_);
             task_ptr->set_status(::openmldb::api::TaskStatus::kDone);
+            NotifyTaskFinished(task_ptr);
         }
         PDLOG(INFO, "drop table ok. tid[%u] pid[%u]", tid, pid);
         return 0;
@@ -3302,6 +4405,7 @@ int32_t TabletImpl::DeleteTableInternal(uint32_t tid, uint32_t pid,
     if (task_ptr) {
         std::lock_guard<std::mutex> lock(mu_);
         task_ptr->set_status(::openmldb::api::TaskStatus::kDone);
+        NotifyTaskFinished(task_ptr);
     }
 
     PDLOG(INFO, "drop table ok. tid[%u] pid[%u]", tid, pid);
@@ -3334,56 +4438,56 @@ void TabletImpl::CreateTable(RpcController* controller, const ::openmldb::api::C
         response->set_msg("table already exists");
         return;
     }
+    auto status = CreateLocalTable(table_meta);
+    response->set_code(status.code);
+    response->set_msg(status.msg);
+}
+
+base::Status TabletImpl::CreateLocalTable(const ::openmldb::api::TableMeta* table_meta) {
+    uint32_t tid = table_meta->tid();
+    uint32_t pid = table_meta->pid();
     std::string name = table_meta->name();
     PDLOG(INFO, "start creating table tid[%u] pid[%u] with mode %s", tid, pid,
-          ::openmldb::api::TableMode_Name(request->table_meta().mode()).c_str());
+          ::openmldb::api::TableMode_Name(table_meta->mode()).c_str());
     std::string db_root_path;
     bool ok = ChooseDBRootPath(tid, pid, table_meta->storage_mode(), db_root_path);
     if (!ok) {
         PDLOG(WARNING, "fail to find db root path tid[%u] pid[%u] storage_mode[%s]", tid, pid,
               common::StorageMode_Name(table_meta->storage_mode()));
-        response->set_code(::openmldb::base::ReturnCode::kFailToGetDbRootPath);
-        response->set_msg("fail to find db root path");
-        return;
+        return {::openmldb::base::ReturnCode::kFailToGetDbRootPath, "fail to find db root path"};
     }
     std::string table_db_path = GetDBPath(db_root_path, tid, pid);
 
     if (WriteTableMeta(table_db_path, table_meta) < 0) {
         PDLOG(WARNING, "write table_meta failed. tid[%u] pid[%u]", tid, pid);
-        response->set_code(::openmldb::base::ReturnCode::kWriteDataFailed);
-        response->set_msg("write data failed");
-        return;
+        return {::openmldb::base::ReturnCode::kWriteDataFailed, "write data failed"};
     }
+    std::string msg;
     if (CreateTableInternal(table_meta, msg) < 0) {
-        response->set_code(::openmldb::base::ReturnCode::kCreateTableFailed);
-        response->set_msg(msg.c_str());
-        return;
+        return {::openmldb::base::ReturnCode::kCreateTableFailed, msg};
     }
-    table = GetTable(tid, pid);
+    std::shared_ptr<Table> table = GetTable(tid, pid);
     if (!table) {
-        response->set_code(::openmldb::base::ReturnCode::kCreateTableFailed);
-        response->set_msg("table is not exist");
         PDLOG(WARNING, "table with tid %u and pid %u does not exist", tid, pid);
-        return;
+        return {::openmldb::base::ReturnCode::kCreateTableFailed, "table is not exist"};
     }
     std::shared_ptr<LogReplicator> replicator = GetReplicator(tid, pid);
     if (!replicator) {
-        response->set_code(::openmldb::base::ReturnCode::kCreateTableFailed);
-        response->set_msg("replicator is not exist");
         PDLOG(WARNING, "replicator with tid %u and pid %u does not exist", tid, pid);
-        return;
+        return {::openmldb::base::ReturnCode::kCreateTableFailed, "replicator is not exist"};
     }
 
     table->SetTableStat(::openmldb::storage::kNormal);
     replicator->StartSyncing();
     io_pool_.DelayTask(FLAGS_binlog_sync_to_disk_interval, boost::bind(&TabletImpl::SchedSyncDisk, this, tid, pid));
-    task_pool_.DelayTask(FLAGS_binlog_delete_interval, boost::bind(&TabletImpl::SchedDelBinlog, this, tid, pid));
+    background_pool_.DelayTask(kBinlogDeleteTask, FLAGS_binlog_delete_interval,
+                               boost::bind(&TabletImpl::SchedDelBinlog, this, tid, pid));
     PDLOG(INFO, "create table with id %u pid %u name %s", tid, pid, name.c_str());
 
     int gc_interval = table->GetStorageMode() == common::kMemory ? FLAGS_gc_interval : FLAGS_disk_gc_interval;
-    gc_pool_.DelayTask(gc_interval * 60 * 1000, boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
-    response->set_code(::openmldb::base::ReturnCode::kOk);
-    response->set_msg("ok");
+    background_pool_.DelayTask(kGcTask, gc_interval * 60 * 1000,
+                               boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
+    return {};
 }
 
 void TabletImpl::ExecuteGc(RpcController* controller, const ::openmldb::api::ExecuteGcRequest* request,
@@ -3398,7 +4502,7 @@ void TabletImpl::ExecuteGc(RpcController* controller, const ::openmldb::api::Exe
         response->set_msg("table not found");
         return;
     }
-    gc_pool_.AddTask(boost::bind(&TabletImpl::GcTable, this, tid, pid, true));
+    background_pool_.AddTask(kGcTask, boost::bind(&TabletImpl::GcTable, this, tid, pid, true));
     response->set_code(::openmldb::base::ReturnCode::kOk);
     response->set_msg("ok");
     PDLOG(INFO, "ExecuteGc. tid %u pid %u", tid, pid);
@@ -3477,6 +4581,25 @@ int32_t TabletImpl::GetSnapshotOffset(uint32_t tid, uint32_t pid, openmldb::comm
     term = manifest.term();
     return 0;
 }
+
+void TabletImpl::Heartbeat(RpcController* controller, const ::openmldb::api::HeartbeatRequest* request,
+                           ::openmldb::api::GeneralResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    lease_time_.store(::baidu::common::timer::get_micros() / 1000, std::memory_order_release);
+    lease_timeout_.store(request->lease_timeout(), std::memory_order_release);
+    response->set_code(::openmldb::base::ReturnCode::kOk);
+    response->set_msg("ok");
+}
+
+bool TabletImpl::IsLeaseExpired() const {
+    uint32_t lease_timeout = lease_timeout_.load(std::memory_order_acquire);
+    if (lease_timeout == 0) {
+        return false;
+    }
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    return cur_time >= lease_time_.load(std::memory_order_acquire) + lease_timeout;
+}
+
 void TabletImpl::GetAllSnapshotOffset(RpcController* controller, const ::openmldb::api::EmptyRequest* request,
                                       ::openmldb::api::TableSnapshotOffsetResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -3797,6 +4920,8 @@ int TabletImpl::CreateTableInternal(const ::openmldb::api::TableMeta* table_meta
     Table* table_ptr;
     if (table_meta->storage_mode() == openmldb::common::kMemory) {
         table_ptr = new MemTable(*table_meta);
+    } else if (table_meta->hot_ttl() > 0) {
+        table_ptr = new ::openmldb::storage::HybridTable(*table_meta, table_db_path);
     } else {
         table_ptr = new DiskTable(*table_meta, table_db_path);
     }
@@ -3849,6 +4974,7 @@ int TabletImpl::CreateTableInternal(const ::openmldb::api::TableMeta* table_meta
     tables_[table_meta->tid()].insert(std::make_pair(table_meta->pid(), table));
     snapshots_[table_meta->tid()].insert(std::make_pair(table_meta->pid(), snapshot));
     replicators_[table_meta->tid()].insert(std::make_pair(table_meta->pid(), replicator));
+    PublishTablesUnLock();
     if (!table_meta->db().empty() && table_meta->mode() == ::openmldb::api::TableMode::kTableLeader) {
         if (catalog_->AddTable(*table_meta, table)) {
             LOG(INFO) << "add table " << table_meta->name() << " to catalog with db " << table_meta->db();
@@ -3856,11 +4982,15 @@ int TabletImpl::CreateTableInternal(const ::openmldb::api::TableMeta* table_meta
             LOG(WARNING) << "fail to add table " << table_meta->name() << " to catalog with db " << table_meta->db();
         }
         engine_->ClearCacheLocked(table_meta->db());
+        statement_cache_->Invalidate(table_meta->db());
 
         // we always refresh the aggr catalog in case zk notification arrives later than the `deploy` sql
         if (boost::iequals(table_meta->db(), openmldb::nameserver::PRE_AGG_DB)) {
             RefreshAggrCatalog();
         }
+    } else if (!table_meta->db().empty()) {
+        // the follower partitions only serve the hedged requests
+        catalog_->AddFollowerTable(*table_meta, table);
     }
     return 0;
 }
@@ -3968,6 +5098,41 @@ void TabletImpl::SetTaskStatus(std::shared_ptr<::openmldb::api::TaskInfo>& task_
     }
     std::lock_guard<std::mutex> lock(mu_);
     task_ptr->set_status(status);
+    if (status == ::openmldb::api::TaskStatus::kDone || status == ::openmldb::api::TaskStatus::kFailed) {
+        NotifyTaskFinished(task_ptr);
+    }
+}
+
+void TabletImpl::NotifyTaskFinished(const std::shared_ptr<::openmldb::api::TaskInfo>& task_ptr) {
+    if (task_ptr && task_ptr->has_notify_endpoint() && !task_ptr->notify_endpoint().empty()) {
+        task_pool_.AddTask(boost::bind(&TabletImpl::SendTaskNotify, this, task_ptr->notify_endpoint()));
+    }
+}
+
+void TabletImpl::SendTaskNotify(const std::string& ns_endpoint) {
+    std::shared_ptr<::openmldb::RpcClient<::openmldb::nameserver::NameServer_Stub>> client;
+    {
+        std::lock_guard<std::mutex> lock(notify_mu_);
+        if (!notify_client_ || notify_ns_endpoint_ != ns_endpoint) {
+            auto new_client = std::make_shared<::openmldb::RpcClient<::openmldb::nameserver::NameServer_Stub>>(
+                ns_endpoint);
+            if (new_client->Init() < 0) {
+                PDLOG(WARNING, "init nameserver client failed. endpoint[%s]", ns_endpoint.c_str());
+                return;
+            }
+            notify_client_ = new_client;
+            notify_ns_endpoint_ = ns_endpoint;
+        }
+        client = notify_client_;
+    }
+    // the nameserver polls the task status as well, so the notify is not retried
+    ::openmldb::nameserver::NotifyTaskStatusRequest request;
+    request.set_endpoint(endpoint_);
+    ::openmldb::nameserver::GeneralResponse response;
+    if (!client->SendRequest(&::openmldb::nameserver::NameServer_Stub::NotifyTaskStatus, &request, &response,
+                             FLAGS_request_timeout_ms, 1)) {
+        PDLOG(WARNING, "notify task status to nameserver[%s] failed", ns_endpoint.c_str());
+    }
 }
 
 int TabletImpl::GetTaskStatus(std::shared_ptr<::openmldb::api::TaskInfo>& task_ptr,
@@ -4001,6 +5166,7 @@ int TabletImpl::AddOPTask(const ::openmldb::api::TaskInfo& task_info, ::openmldb
         PDLOG(WARNING, "task type is not match. type is[%s]",
               ::openmldb::api::TaskType_Name(task_info.task_type()).c_str());
         task_ptr->set_status(::openmldb::api::TaskStatus::kFailed);
+        NotifyTaskFinished(task_ptr);
         return -1;
     }
     PDLOG(INFO, "add task map success, op_id[%lu] op_type[%s] task_type[%s]", task_info.op_id(),
@@ -4043,6 +5209,7 @@ int TabletImpl::AddOPMultiTask(const ::openmldb::api::TaskInfo& task_info, ::ope
         PDLOG(WARNING, "task type is not match. type is[%s]",
               ::openmldb::api::TaskType_Name(task_info.task_type()).c_str());
         task_ptr->set_status(::openmldb::api::TaskStatus::kFailed);
+        NotifyTaskFinished(task_ptr);
         return -1;
     }
     return 0;
@@ -4063,20 +5230,21 @@ std::shared_ptr<::openmldb::api::TaskInfo> TabletImpl::FindMultiTask(const ::ope
 }
 
 void TabletImpl::GcTable(uint32_t tid, uint32_t pid, bool execute_once) {
+    ScopedProfileTag profile_tag("gc", tid);
     std::shared_ptr<Table> table = GetTable(tid, pid);
     if (table) {
         int32_t gc_interval = table->GetStorageMode() == common::kMemory ? FLAGS_gc_interval : FLAGS_disk_gc_interval;
         table->SchedGc();
         if (!execute_once) {
-            gc_pool_.DelayTask(gc_interval * 60 * 1000, boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
+            background_pool_.DelayTask(kGcTask, gc_interval * 60 * 1000,
+                                       boost::bind(&TabletImpl::GcTable, this, tid, pid, false));
         }
         return;
     }
 }
 
 std::shared_ptr<Snapshot> TabletImpl::GetSnapshot(uint32_t tid, uint32_t pid) {
-    std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-    return GetSnapshotUnLock(tid, pid);
+    return table_registry_.GetSnapshot(tid, pid);
 }
 
 std::shared_ptr<Snapshot> TabletImpl::GetSnapshotUnLock(uint32_t tid, uint32_t pid) {
@@ -4102,14 +5270,10 @@ std::shared_ptr<LogReplicator> TabletImpl::GetReplicatorUnLock(uint32_t tid, uin
 }
 
 std::shared_ptr<LogReplicator> TabletImpl::GetReplicator(uint32_t tid, uint32_t pid) {
-    std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-    return GetReplicatorUnLock(tid, pid);
+    return table_registry_.GetReplicator(tid, pid);
 }
 
-std::shared_ptr<Table> TabletImpl::GetTable(uint32_t tid, uint32_t pid) {
-    std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-    return GetTableUnLock(tid, pid);
-}
+std::shared_ptr<Table> TabletImpl::GetTable(uint32_t tid, uint32_t pid) { return table_registry_.GetTable(tid, pid); }
 
 std::shared_ptr<Table> TabletImpl::GetTableUnLock(uint32_t tid, uint32_t pid) {
     Tables::iterator it = tables_.find(tid);
@@ -4123,8 +5287,7 @@ std::shared_ptr<Table> TabletImpl::GetTableUnLock(uint32_t tid, uint32_t pid) {
 }
 
 std::shared_ptr<Aggrs> TabletImpl::GetAggregators(uint32_t tid, uint32_t pid) {
-    std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-    return GetAggregatorsUnLock(tid, pid);
+    return table_registry_.GetAggrs(tid, pid);
 }
 
 std::shared_ptr<Aggrs> TabletImpl::GetAggregatorsUnLock(uint32_t tid, uint32_t pid) {
@@ -4136,6 +5299,40 @@ std::shared_ptr<Aggrs> TabletImpl::GetAggregatorsUnLock(uint32_t tid, uint32_t p
     return std::shared_ptr<Aggrs>();
 }
 
+void TabletImpl::PinReadSnapshot(::openmldb::storage::ReadSnapshot* snapshot) {
+    std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+    for (const auto& kv : tables_) {
+        for (const auto& table_kv : kv.second) {
+            if (auto* mem_table = dynamic_cast<MemTable*>(table_kv.second.get())) {
+                snapshot->Pin(kv.first, table_kv.first, mem_table->GetReadSeq());
+            }
+        }
+    }
+}
+
+void TabletImpl::PublishTablesUnLock() {
+    TableRegistry::Partitions partitions;
+    for (const auto& kv : tables_) {
+        for (const auto& table_kv : kv.second) {
+            partitions[TableRegistry::GetUid(kv.first, table_kv.first)].table = table_kv.second;
+        }
+    }
+    for (const auto& kv : replicators_) {
+        for (const auto& replicator_kv : kv.second) {
+            partitions[TableRegistry::GetUid(kv.first, replicator_kv.first)].replicator = replicator_kv.second;
+        }
+    }
+    for (const auto& kv : snapshots_) {
+        for (const auto& snapshot_kv : kv.second) {
+            partitions[TableRegistry::GetUid(kv.first, snapshot_kv.first)].snapshot = snapshot_kv.second;
+        }
+    }
+    for (const auto& kv : aggregators_) {
+        partitions[kv.first].aggrs = kv.second;
+    }
+    table_registry_.Publish(std::move(partitions));
+}
+
 bool TabletImpl::UpdateAggrs(uint32_t tid, uint32_t pid, const std::string& value,
                  const ::openmldb::storage::Dimensions& dimensions, uint64_t log_offset) {
     auto aggrs = GetAggregators(tid, pid);
@@ -4147,6 +5344,13 @@ bool TabletImpl::UpdateAggrs(uint32_t tid, uint32_t pid, const std::string& valu
             if (aggr->GetIndexPos() != iter->idx()) {
                 continue;
             }
+            if (aggr_pool_) {
+                // the binlog is written already, the updates lost on crash are recovered from it
+                if (aggr->AsyncUpdate(iter->key(), value, log_offset)) {
+                    aggr_pool_->AddTask(boost::bind(&Aggregator::ConsumeUpdates, aggr));
+                }
+                continue;
+            }
             auto ok = aggr->Update(iter->key(), value, log_offset);
             if (!ok) {
                 PDLOG(WARNING, "update aggr failed. tid[%u] pid[%u] index[%u] key[%s] value[%s]",
@@ -4162,20 +5366,358 @@ bool TabletImpl::UpdateAggrs(uint32_t tid, uint32_t pid, const std::string& valu
 void TabletImpl::ShowMemPool(RpcController* controller, const ::openmldb::api::HttpRequest* request,
                              ::openmldb::api::HttpResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
-#ifdef TCMALLOC_ENABLE
     brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    cntl->response_attachment().append("<html><head><title>Mem Stat</title></head><body><pre>");
+#ifdef TCMALLOC_ENABLE
     MallocExtension* tcmalloc = MallocExtension::instance();
     std::string stat;
     stat.resize(1024);
     char* buffer = reinterpret_cast<char*>(&(stat[0]));
     tcmalloc->GetStats(buffer, 1024);
-    cntl->response_attachment().append("<html><head><title>Mem Stat</title></head><body><pre>");
     cntl->response_attachment().append(stat);
-    cntl->response_attachment().append("</pre></body></html>");
 #endif
-}
-
-void TabletImpl::CheckZkClient() {
+    std::vector<std::shared_ptr<MemTable>> mem_tables;
+    {
+        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+        for (auto it = tables_.begin(); it != tables_.end(); ++it) {
+            for (auto pit = it->second.begin(); pit != it->second.end(); ++pit) {
+                auto mem_table = std::dynamic_pointer_cast<MemTable>(pit->second);
+                if (mem_table && mem_table->GetDataBlockPool() != nullptr) {
+                    mem_tables.push_back(mem_table);
+                }
+            }
+        }
+    }
+    if (!mem_tables.empty()) {
+        std::string pool_stat = "\n------------------------------------------------\n";
+        pool_stat.append("DataBlockPool: tid pid slab_cnt slab_bytes used_bytes\n");
+        for (const auto& mem_table : mem_tables) {
+            const auto* pool = mem_table->GetDataBlockPool();
+            pool_stat.append(absl::StrCat(mem_table->GetId(), " ", mem_table->GetPid(), " ", pool->GetSlabCnt(), " ",
+                                          pool->GetSlabByteSize(), " ", pool->GetUsedByteSize(), "\n"));
+        }
+        cntl->response_attachment().append(pool_stat);
+    }
+    uint64_t code_bytes = 0;
+    uint64_t data_bytes = 0;
+    ::hybridse::vm::Engine::GetJitMemory(&code_bytes, &data_bytes);
+    std::string jit_stat = "\n------------------------------------------------\n";
+    jit_stat.append(absl::StrCat("JIT: code_bytes ", code_bytes, " data_bytes ", data_bytes, "\n"));
+    jit_stat.append("mode db code_bytes data_bytes ir_instructions sql\n");
+    for (const auto& stat : engine_->GetCompileInfoStats()) {
+        // the shared modules are counted by every query using them
+        std::string sql = stat.sql.substr(0, MAX_MEM_POOL_SQL_LEN);
+        std::replace(sql.begin(), sql.end(), '\n', ' ');
+        jit_stat.append(absl::StrCat(::hybridse::vm::EngineModeName(stat.mode), " ", stat.db, " ", stat.code_bytes,
+                                     " ", stat.data_bytes, " ", stat.ir_instruction_cnt, " ", sql, "\n"));
+    }
+    cntl->response_attachment().append(jit_stat);
+    cntl->response_attachment().append("</pre></body></html>");
+}
+
+void TabletImpl::ShowGcStat(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                            ::openmldb::api::HttpResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    std::vector<std::shared_ptr<MemTable>> mem_tables;
+    {
+        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+        for (auto it = tables_.begin(); it != tables_.end(); ++it) {
+            for (auto pit = it->second.begin(); pit != it->second.end(); ++pit) {
+                auto mem_table = std::dynamic_pointer_cast<MemTable>(pit->second);
+                if (mem_table) {
+                    mem_tables.push_back(mem_table);
+                }
+            }
+        }
+    }
+    std::string stat = "<html><head><title>Gc Stat</title></head><body><pre>";
+    stat.append("tid pid round slice progress max_pause_us total_pause_us pause_distribution\n");
+    for (const auto& mem_table : mem_tables) {
+        const auto& gc_stat = mem_table->GetGcStat();
+        absl::StrAppend(&stat, mem_table->GetId(), " ", mem_table->GetPid(), " ", gc_stat.GetRoundCnt(), " ",
+                        gc_stat.GetSliceCnt(), " ", gc_stat.GetDoneSegmentCnt(), "/", gc_stat.GetTotalSegmentCnt(),
+                        " ", gc_stat.GetMaxPause(), " ", gc_stat.GetTotalPause(), " <1ms:", gc_stat.GetPauseCnt(0));
+        for (uint32_t idx = 1; idx < ::openmldb::storage::GcStat::kPauseBucketCnt; idx++) {
+            absl::StrAppend(&stat, idx + 1 < ::openmldb::storage::GcStat::kPauseBucketCnt ? " <" : " >=",
+                            1u << (idx + 1 < ::openmldb::storage::GcStat::kPauseBucketCnt ? idx : idx - 1),
+                            "ms:", gc_stat.GetPauseCnt(idx));
+        }
+        stat.append("\n");
+    }
+    stat.append("</pre></body></html>");
+    cntl->response_attachment().append(stat);
+}
+
+void TabletImpl::ShowIndexMemory(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                                 ::openmldb::api::HttpResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    const std::string* tid_str = cntl->http_request().uri().GetQuery("tid");
+    const std::string* pid_str = cntl->http_request().uri().GetQuery("pid");
+    uint32_t tid = 0;
+    uint32_t pid = 0;
+    if ((tid_str != nullptr && !absl::SimpleAtoi(*tid_str, &tid)) ||
+        (pid_str != nullptr && !absl::SimpleAtoi(*pid_str, &pid))) {
+        cntl->http_response().set_status_code(brpc::HTTP_STATUS_BAD_REQUEST);
+        cntl->response_attachment().append("invalid tid or pid\n");
+        return;
+    }
+    std::vector<std::shared_ptr<MemTable>> mem_tables;
+    {
+        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+        for (auto it = tables_.begin(); it != tables_.end(); ++it) {
+            if (tid_str != nullptr && it->first != tid) {
+                continue;
+            }
+            for (auto pit = it->second.begin(); pit != it->second.end(); ++pit) {
+                if (pid_str != nullptr && pit->first != pid) {
+                    continue;
+                }
+                auto mem_table = std::dynamic_pointer_cast<MemTable>(pit->second);
+                if (mem_table) {
+                    mem_tables.push_back(mem_table);
+                }
+            }
+        }
+    }
+    std::string stat = "<html><head><title>Index Memory</title></head><body><pre>";
+    stat.append("tid pid index key_cnt record_cnt key_bytes key_node_bytes row_node_bytes payload_bytes "
+                "shared_payload_bytes fragment_bytes\n");
+    for (const auto& mem_table : mem_tables) {
+        for (const auto& index_def : mem_table->GetAllIndex()) {
+            ::openmldb::storage::IndexMemStat mem_stat;
+            if (!index_def || !mem_table->GetIndexMemStat(index_def->GetId(), &mem_stat)) {
+                continue;
+            }
+            absl::StrAppend(&stat, mem_table->GetId(), " ", mem_table->GetPid(), " ", index_def->GetName(), " ",
+                            mem_stat.key_cnt, " ", mem_stat.record_cnt, " ", mem_stat.key_byte_size, " ",
+                            mem_stat.key_node_byte_size, " ", mem_stat.row_node_byte_size, " ",
+                            mem_stat.payload_byte_size, " ", mem_stat.shared_payload_byte_size, " ",
+                            mem_stat.fragment_byte_size, "\n");
+        }
+        const auto* pool = mem_table->GetDataBlockPool();
+        // the free bytes of the slabs are not taken by any index
+        absl::StrAppend(&stat, mem_table->GetId(), " ", mem_table->GetPid(), " [table] record_cnt ",
+                        mem_table->GetRecordCnt(), " record_bytes ", mem_table->GetRecordByteSize(), " idx_bytes ",
+                        mem_table->GetRecordIdxByteSize(), " pool_free_bytes ",
+                        pool != nullptr ? pool->GetSlabByteSize() - pool->GetUsedByteSize() : 0, "\n");
+    }
+    stat.append("</pre></body></html>");
+    cntl->response_attachment().append(stat);
+}
+
+void TabletImpl::ShowSlowTrace(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                               ::openmldb::api::HttpResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    std::string stat = "<html><head><title>Slow Trace</title></head><body><pre>";
+    stat.append("start_time type total_us stages(us) desc\n");
+    for (const auto& record : slow_traces_->GetRecords()) {
+        absl::StrAppend(&stat, record.start_time, " ", record.type, " ", record.total_us, " ");
+        for (size_t i = 0; i < record.stages.size(); i++) {
+            absl::StrAppend(&stat, i > 0 ? "," : "", record.stages[i].first, ":", record.stages[i].second);
+        }
+        absl::StrAppend(&stat, " ", record.desc, "\n");
+    }
+    stat.append("</pre></body></html>");
+    cntl->response_attachment().append(stat);
+}
+
+void TabletImpl::ShowWorkloadProfile(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                                     ::openmldb::api::HttpResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    const std::string* type = cntl->http_request().uri().GetQuery("type");
+    const std::string* tag = cntl->http_request().uri().GetQuery("tag");
+    const std::string* reset = cntl->http_request().uri().GetQuery("reset");
+    std::string tag_prefix = tag == nullptr ? "" : *tag;
+    if (type != nullptr && (*type == "cpu" || *type == "heap")) {
+        cntl->http_response().set_content_type("text/plain");
+        cntl->response_attachment().append(*type == "cpu" ? WorkloadProfiler::DumpCpuStacks(tag_prefix)
+                                                          : WorkloadProfiler::DumpHeapStacks(tag_prefix));
+    } else {
+        std::string stat = "<html><head><title>Workload Profile</title></head><body><pre>";
+        if (!WorkloadProfiler::IsRunning()) {
+            stat.append("the profiler is not running, set --workload_profile_hz or "
+                        "--workload_profile_heap_sample_bytes to enable it\n");
+        }
+        stat.append("tag scope_cnt cpu_ms cpu_samples alloc_bytes\n");
+        for (const auto& tag_stat : WorkloadProfiler::GetTagStats()) {
+            if (tag_stat.name.compare(0, tag_prefix.size(), tag_prefix) != 0) {
+                continue;
+            }
+            absl::StrAppend(&stat, tag_stat.name, " ", tag_stat.scope_cnt, " ", tag_stat.cpu_ns / 1000000, " ",
+                            tag_stat.cpu_samples, " ", tag_stat.alloc_bytes, "\n");
+        }
+        stat.append("</pre></body></html>");
+        cntl->response_attachment().append(stat);
+    }
+    if (reset != nullptr && *reset == "true") {
+        WorkloadProfiler::Reset();
+    }
+}
+
+// append the rows of a time collector as a histogram in seconds, the last row is the infinite bucket
+static void AddTimeHistogram(const std::vector<::openmldb::statistics::ResponseTimeRow>& rows,
+                             const std::string& name, const ::openmldb::base::PrometheusWriter::Labels& labels,
+                             ::openmldb::base::PrometheusWriter* writer) {
+    std::vector<std::pair<double, uint64_t>> buckets;
+    uint64_t count = 0;
+    absl::Duration total;
+    for (const auto& row : rows) {
+        count += row.count_;
+        total += row.total_;
+        if (row.time_ != absl::InfiniteDuration()) {
+            buckets.emplace_back(absl::ToDoubleSeconds(row.time_), count);
+        }
+    }
+    writer->AddHistogram(name, labels, buckets, absl::ToDoubleSeconds(total), count);
+}
+
+void TabletImpl::Metrics(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                         ::openmldb::api::HttpResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    std::vector<std::shared_ptr<Table>> tables;
+    // tid, pid and the replicator of the leader partitions
+    std::vector<std::tuple<uint32_t, uint32_t, std::shared_ptr<LogReplicator>>> replicators;
+    {
+        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+        for (const auto& kv : tables_) {
+            for (const auto& pkv : kv.second) {
+                tables.push_back(pkv.second);
+                auto replicator = GetReplicatorUnLock(kv.first, pkv.first);
+                if (replicator && pkv.second->IsLeader()) {
+                    replicators.emplace_back(kv.first, pkv.first, replicator);
+                }
+            }
+        }
+    }
+    using ::openmldb::base::PrometheusWriter;
+    PrometheusWriter writer;
+    writer.Declare("openmldb_table_rows", "gauge", "The rows of the table partition.");
+    writer.Declare("openmldb_table_bytes", "gauge", "The bytes of the rows of the table partition in memory.");
+    writer.Declare("openmldb_table_index_bytes", "gauge", "The bytes of the index of the table partition in memory.");
+    writer.Declare("openmldb_table_keys", "gauge", "The keys of the table partition.");
+    writer.Declare("openmldb_gc_rounds_total", "counter", "The finished gc rounds of the table partition.");
+    writer.Declare("openmldb_gc_seconds_total", "counter", "The time of the finished gc rounds.");
+    writer.Declare("openmldb_gc_pause_seconds_total", "counter", "The time the gc holds the segments.");
+    writer.Declare("openmldb_gc_max_pause_seconds", "gauge", "The longest time the gc holds the segments at once.");
+    writer.Declare("openmldb_gc_reclaimed_rows_total", "counter", "The rows reclaimed by the gc.");
+    writer.Declare("openmldb_gc_reclaimed_bytes_total", "counter", "The bytes reclaimed by the gc.");
+    writer.Declare("openmldb_gc_cold_rows_total", "counter", "The cold rows compressed by the gc.");
+    writer.Declare("openmldb_gc_cold_saved_bytes_total", "counter", "The bytes saved by compressing the cold rows.");
+    for (const auto& table : tables) {
+        PrometheusWriter::Labels labels = {{"db", table->GetDB()},
+                                           {"table", table->GetName()},
+                                           {"tid", std::to_string(table->GetId())},
+                                           {"pid", std::to_string(table->GetPid())},
+                                           {"role", table->IsLeader() ? "leader" : "follower"}};
+        writer.Add("openmldb_table_rows", labels, table->GetRecordCnt());
+        writer.Add("openmldb_table_bytes", labels, table->GetRecordByteSize());
+        writer.Add("openmldb_table_index_bytes", labels, table->GetRecordIdxByteSize());
+        writer.Add("openmldb_table_keys", labels, table->GetRecordPkCnt());
+        auto mem_table = std::dynamic_pointer_cast<MemTable>(table);
+        if (!mem_table) {
+            continue;
+        }
+        const auto& gc_stat = mem_table->GetGcStat();
+        writer.Add("openmldb_gc_rounds_total", labels, gc_stat.GetRoundCnt());
+        writer.Add("openmldb_gc_seconds_total", labels, gc_stat.GetTotalRoundTime() / 1e6);
+        writer.Add("openmldb_gc_pause_seconds_total", labels, gc_stat.GetTotalPause() / 1e6);
+        writer.Add("openmldb_gc_max_pause_seconds", labels, gc_stat.GetMaxPause() / 1e6);
+        writer.Add("openmldb_gc_reclaimed_rows_total", labels, gc_stat.GetReclaimedRecordCnt());
+        writer.Add("openmldb_gc_reclaimed_bytes_total", labels, gc_stat.GetReclaimedByteSize());
+        writer.Add("openmldb_gc_cold_rows_total", labels, gc_stat.GetColdRowCnt());
+        writer.Add("openmldb_gc_cold_saved_bytes_total", labels, gc_stat.GetColdSavedByteSize());
+    }
+
+    writer.Declare("openmldb_binlog_offset", "gauge", "The offset of the latest binlog of the leader partition.");
+    writer.Declare("openmldb_replication_lag_entries", "gauge",
+                   "The binlog entries of the leader partition not synced to the follower yet.");
+    for (const auto& item : replicators) {
+        const auto& replicator = std::get<2>(item);
+        std::map<std::string, uint64_t> follower_offsets;
+        replicator->GetReplicateInfo(follower_offsets);
+        uint64_t offset = replicator->GetOffset();
+        PrometheusWriter::Labels labels = {{"tid", std::to_string(std::get<0>(item))},
+                                           {"pid", std::to_string(std::get<1>(item))}};
+        writer.Add("openmldb_binlog_offset", labels, offset);
+        labels.emplace_back("follower", "");
+        for (const auto& kv : follower_offsets) {
+            labels.back().second = kv.first;
+            writer.Add("openmldb_replication_lag_entries", labels, offset > kv.second ? offset - kv.second : 0);
+        }
+    }
+    writer.Declare("openmldb_binlog_append_seconds", "histogram", "The latency of the binlog appends of the puts.");
+    std::vector<::openmldb::statistics::ResponseTimeRow> binlog_rows;
+    for (size_t idx = 0; idx < binlog_append_time_.BucketCount(); idx++) {
+        binlog_rows.push_back(binlog_append_time_.GetRow(idx).value());
+    }
+    AddTimeHistogram(binlog_rows, "openmldb_binlog_append_seconds", {}, &writer);
+
+    writer.Declare("openmldb_query_queue_wait_seconds", "histogram",
+                   "The time the queries wait for the query workers.");
+    writer.Declare("openmldb_query_queue_size", "gauge", "The queries waiting for the query workers.");
+    writer.Declare("openmldb_query_queue_rejected_total", "counter",
+                   "The queries rejected as the queue of the query workers is full.");
+    if (query_pool_) {
+        std::vector<::openmldb::statistics::ResponseTimeRow> queue_rows;
+        for (size_t idx = 0; idx < query_queue_time_.BucketCount(); idx++) {
+            queue_rows.push_back(query_queue_time_.GetRow(idx).value());
+        }
+        AddTimeHistogram(queue_rows, "openmldb_query_queue_wait_seconds", {}, &writer);
+        writer.Add("openmldb_query_queue_size", {}, query_pool_->GetQueueSize());
+        writer.Add("openmldb_query_queue_rejected_total", {}, query_rejected_cnt_.load(std::memory_order_relaxed));
+    }
+
+    writer.Declare("openmldb_deploy_seconds", "histogram", "The latency of the procedure requests.");
+    std::map<std::string, std::vector<::openmldb::statistics::ResponseTimeRow>> deploy_rows;
+    for (const auto& row : deploy_metrics_->GetRows()) {
+        deploy_rows[row.deploy_name_].push_back(row);
+    }
+    for (const auto& kv : deploy_rows) {
+        AddTimeHistogram(kv.second, "openmldb_deploy_seconds", {{"deploy", kv.first}}, &writer);
+    }
+
+    uint64_t hit_cnt = 0;
+    uint64_t miss_cnt = 0;
+    engine_->GetCacheStats(&hit_cnt, &miss_cnt);
+    writer.Declare("openmldb_compile_cache_lookups_total", "counter", "The lookups of the compile cache of the sqls.");
+    writer.Add("openmldb_compile_cache_lookups_total", {{"result", "hit"}}, hit_cnt);
+    writer.Add("openmldb_compile_cache_lookups_total", {{"result", "miss"}}, miss_cnt);
+    uint64_t code_bytes = 0;
+    uint64_t data_bytes = 0;
+    ::hybridse::vm::Engine::GetJitMemory(&code_bytes, &data_bytes);
+    writer.Declare("openmldb_jit_bytes", "gauge", "The bytes of the jitted modules alive.");
+    writer.Add("openmldb_jit_bytes", {{"section", "code"}}, code_bytes);
+    writer.Add("openmldb_jit_bytes", {{"section", "data"}}, data_bytes);
+
+    writer.Declare("openmldb_admission_running", "gauge", "The queries admitted and running by the quota key.");
+    writer.Declare("openmldb_admission_waiting", "gauge", "The queries waiting for admission by the quota key.");
+    writer.Declare("openmldb_admission_admitted_total", "counter", "The queries admitted by the quota key.");
+    writer.Declare("openmldb_admission_rejected_total", "counter", "The queries rejected by the quota key.");
+    if (admission_->IsEnabled()) {
+        for (const auto& stat : admission_->GetStats()) {
+            PrometheusWriter::Labels labels = {{"key", stat.key.empty() ? "default" : stat.key}};
+            writer.Add("openmldb_admission_running", labels, stat.running);
+            writer.Add("openmldb_admission_waiting", labels, stat.waiting);
+            writer.Add("openmldb_admission_admitted_total", labels, stat.admitted_cnt);
+            writer.Add("openmldb_admission_rejected_total", labels, stat.rejected_cnt);
+        }
+    }
+
+    writer.Declare("openmldb_write_throttled_total", "counter", "The puts rejected by the write throttler.");
+    if (write_throttler_) {
+        writer.Add("openmldb_write_throttled_total", {}, write_throttler_->GetThrottledCnt());
+    }
+
+    cntl->http_response().set_content_type("text/plain; version=0.0.4");
+    cntl->response_attachment().append(writer.Dump());
+}
+
+void TabletImpl::CheckZkClient() {
     if (zk_client_) {
         if (!zk_client_->IsConnected()) {
             PDLOG(WARNING, "reconnect zk");
@@ -4241,6 +5783,19 @@ void TabletImpl::UpdateGlobalVarTable() {
     return;
 }
 
+void TabletImpl::ScheduleRefreshTableInfo() {
+    if (!table_refresh_pending_.exchange(true, std::memory_order_acq_rel)) {
+        task_pool_.DelayTask(FLAGS_zk_notify_coalesce_ms, boost::bind(&TabletImpl::RunRefreshTableInfo, this));
+    }
+}
+
+void TabletImpl::RunRefreshTableInfo() {
+    std::lock_guard<std::mutex> lock(table_refresh_mu_);
+    // the notifies after here will schedule another refresh
+    table_refresh_pending_.store(false, std::memory_order_release);
+    RefreshTableInfo();
+}
+
 void TabletImpl::RefreshTableInfo() {
     if (!zk_client_) {
         return;
@@ -4258,29 +5813,61 @@ void TabletImpl::RefreshTableInfo() {
         LOG(WARNING) << "value is not integer";
     }
     std::string db_table_data_path = zk_path_ + "/table/db_table_data";
-    std::vector<std::string> table_datas;
-    if (zk_client_->IsExistNode(db_table_data_path) == 0) {
-        bool ok = zk_client_->GetChildren(db_table_data_path, table_datas);
-        if (!ok) {
-            LOG(WARNING) << "fail to get table list with path " << db_table_data_path;
-            return;
+    std::vector<::openmldb::nameserver::TableInfo> table_info_vec;
+    // read the changed tables only if the change log covers all versions since the last refresh
+    std::set<std::string> changed_tables;
+    std::set<uint32_t> deleted_tids;
+    ::openmldb::zk::TableChangeLog change_log(zk_client_, zk_path_ + "/table/change_log");
+    bool is_delta = table_info_version_ > 0 && version >= table_info_version_ &&
+                    change_log.GetChanges(table_info_version_, version, &changed_tables);
+    if (is_delta) {
+        for (const auto& node : changed_tables) {
+            std::string value;
+            if (!zk_client_->GetNodeValue(db_table_data_path + "/" + node, value)) {
+                uint32_t tid = 0;
+                if (zk_client_->IsExistNode(db_table_data_path + "/" + node) != 1 ||
+                    !::absl::SimpleAtoi(node, &tid)) {
+                    LOG(WARNING) << "fail to get table data. node: " << node << ", refresh all tables";
+                    is_delta = false;
+                    break;
+                }
+                deleted_tids.insert(tid);
+                continue;
+            }
+            ::openmldb::nameserver::TableInfo table_info;
+            if (!table_info.ParseFromString(value)) {
+                LOG(WARNING) << "fail to parse table proto. node: " << node << " value: " << value;
+                continue;
+            }
+            table_info_vec.push_back(std::move(table_info));
         }
-    } else {
-        LOG(INFO) << "no tables in db";
     }
-    std::vector<::openmldb::nameserver::TableInfo> table_info_vec;
-    for (const auto& node : table_datas) {
-        std::string value;
-        if (!zk_client_->GetNodeValue(db_table_data_path + "/" + node, value)) {
-            LOG(WARNING) << "fail to get table data. node: " << node;
-            continue;
+    if (!is_delta) {
+        table_info_vec.clear();
+        deleted_tids.clear();
+        std::vector<std::string> table_datas;
+        if (zk_client_->IsExistNode(db_table_data_path) == 0) {
+            bool ok = zk_client_->GetChildren(db_table_data_path, table_datas);
+            if (!ok) {
+                LOG(WARNING) << "fail to get table list with path " << db_table_data_path;
+                return;
+            }
+        } else {
+            LOG(INFO) << "no tables in db";
         }
-        ::openmldb::nameserver::TableInfo table_info;
-        if (!table_info.ParseFromString(value)) {
-            LOG(WARNING) << "fail to parse table proto. node: " << node << " value: " << value;
-            continue;
+        for (const auto& node : table_datas) {
+            std::string value;
+            if (!zk_client_->GetNodeValue(db_table_data_path + "/" + node, value)) {
+                LOG(WARNING) << "fail to get table data. node: " << node;
+                continue;
+            }
+            ::openmldb::nameserver::TableInfo table_info;
+            if (!table_info.ParseFromString(value)) {
+                LOG(WARNING) << "fail to parse table proto. node: " << node << " value: " << value;
+                continue;
+            }
+            table_info_vec.push_back(std::move(table_info));
         }
-        table_info_vec.push_back(std::move(table_info));
     }
     // procedure part
     std::vector<std::string> sp_datas;
@@ -4326,7 +5913,12 @@ void TabletImpl::RefreshTableInfo() {
         }
     }
     auto old_db_sp_map = catalog_->GetProcedures();
-    catalog_->Refresh(table_info_vec, version, db_sp_map);
+    if (is_delta) {
+        catalog_->Refresh(table_info_vec, deleted_tids, version, db_sp_map);
+    } else {
+        catalog_->Refresh(table_info_vec, version, db_sp_map);
+    }
+    table_info_version_ = version;
     // skip exist procedure, don`t need recompile
     for (const auto& db_sp_map_kv : db_sp_map) {
         const auto& db = db_sp_map_kv.first;
@@ -4439,7 +6031,8 @@ void TabletImpl::SchedDelBinlog(uint32_t tid, uint32_t pid) {
                 }
             }
         }
-        task_pool_.DelayTask(FLAGS_binlog_delete_interval, boost::bind(&TabletImpl::SchedDelBinlog, this, tid, pid));
+        background_pool_.DelayTask(kBinlogDeleteTask, FLAGS_binlog_delete_interval,
+                                   boost::bind(&TabletImpl::SchedDelBinlog, this, tid, pid));
     }
 }
 
@@ -4569,6 +6162,74 @@ void TabletImpl::GetDiskused() {
     task_pool_.DelayTask(FLAGS_get_table_diskused_interval, boost::bind(&TabletImpl::GetDiskused, this));
 }
 
+bool TabletImpl::AcquireWrite(uint32_t tid, uint32_t pid, uint64_t rows, ::openmldb::api::PutResponse* response) {
+    if (!write_throttler_) {
+        return true;
+    }
+    std::string msg;
+    if (write_throttler_->Acquire(tid, pid, rows, ::baidu::common::timer::get_micros(), &msg)) {
+        return true;
+    }
+    DEBUGLOG("put is throttled. tid %u, pid %u, %s", tid, pid, msg.c_str());
+    response->set_code(::openmldb::base::ReturnCode::kWriteThrottled);
+    response->set_msg(msg);
+    return false;
+}
+
+void TabletImpl::SchedWriteThrottle() {
+    std::vector<std::tuple<uint32_t, uint32_t, std::shared_ptr<LogReplicator>>> replicators;
+    uint64_t used_bytes = 0;
+    {
+        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+        for (const auto& kv : tables_) {
+            for (const auto& pkv : kv.second) {
+                if (pkv.second->GetStorageMode() == ::openmldb::common::kMemory) {
+                    used_bytes += pkv.second->GetRecordByteSize();
+                }
+                auto replicator = GetReplicatorUnLock(kv.first, pkv.first);
+                if (replicator && pkv.second->IsLeader()) {
+                    replicators.emplace_back(kv.first, pkv.first, replicator);
+                }
+            }
+        }
+    }
+#ifdef TCMALLOC_ENABLE
+    // the allocated bytes count the index and the queries as well as the rows
+    size_t allocated_bytes = 0;
+    if (MallocExtension::instance()->GetNumericProperty("generic.current_allocated_bytes", &allocated_bytes)) {
+        used_bytes = allocated_bytes;
+    }
+#endif
+    write_throttler_->UpdateMemory(used_bytes);
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> offsets;
+    for (const auto& item : replicators) {
+        uint32_t tid = std::get<0>(item);
+        uint32_t pid = std::get<1>(item);
+        const auto& replicator = std::get<2>(item);
+        uint64_t offset = replicator->GetOffset();
+        std::map<std::string, uint64_t> follower_offsets;
+        replicator->GetReplicateInfo(follower_offsets);
+        uint64_t lag = 0;
+        for (const auto& kv : follower_offsets) {
+            lag = std::max(lag, offset > kv.second ? offset - kv.second : 0);
+        }
+        uint64_t put_rate = 0;
+        auto it = write_offsets_.find(std::make_pair(tid, pid));
+        if (it != write_offsets_.end() && offset > it->second) {
+            put_rate = (offset - it->second) * 1000 / std::max(FLAGS_write_throttle_check_interval_ms, 1u);
+        }
+        write_throttler_->UpdatePartition(tid, pid, lag, put_rate);
+        offsets.emplace(std::make_pair(tid, pid), offset);
+    }
+    for (const auto& kv : write_offsets_) {
+        if (offsets.find(kv.first) == offsets.end()) {
+            write_throttler_->RemovePartition(kv.first.first, kv.first.second);
+        }
+    }
+    write_offsets_.swap(offsets);
+    task_pool_.DelayTask(FLAGS_write_throttle_check_interval_ms, boost::bind(&TabletImpl::SchedWriteThrottle, this));
+}
+
 void TabletImpl::SetMode(RpcController* controller, const ::openmldb::api::SetModeRequest* request,
                          ::openmldb::api::GeneralResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -4659,8 +6320,9 @@ void TabletImpl::SendIndexData(RpcController* controller, const ::openmldb::api:
             PDLOG(INFO, "pid endpoint map is empty. tid %u, pid %u", request->tid(), request->pid());
             SetTaskStatus(task_ptr, ::openmldb::api::TaskStatus::kDone);
         } else {
-            task_pool_.AddTask(
-                boost::bind(&TabletImpl::SendIndexDataInternal, this, table, pid_endpoint_map, task_ptr));
+            background_pool_.AddTask(kSendFileTask,
+                                     boost::bind(&TabletImpl::SendIndexDataInternal, this, table, pid_endpoint_map,
+                                                 task_ptr));
         }
         return;
     } while (0);
@@ -4763,6 +6425,262 @@ void TabletImpl::SendIndexDataInternal(std::shared_ptr<::openmldb::storage::Tabl
     SetTaskStatus(task_ptr, ::openmldb::api::TaskStatus::kDone);
 }
 
+// visit the entries of the index in the order of the traverse, fun moves the iterator on and returns false to stop.
+// the traverse stopped on max_traverse_cnt is resumed at the pk it stops at
+static bool TraverseIndex(const std::shared_ptr<::openmldb::storage::Table>& table, uint32_t idx,
+                          const std::function<bool(::openmldb::storage::TraverseIterator*)>& fun) {
+    std::string pk;
+    bool first = true;
+    while (true) {
+        std::unique_ptr<::openmldb::storage::TraverseIterator> it(table->NewTraverseIterator(idx));
+        if (!it) {
+            return false;
+        }
+        if (first) {
+            it->SeekToFirst();
+            first = false;
+        } else {
+            it->Seek(pk, 0);
+        }
+        while (it->Valid()) {
+            if (!fun(it.get())) {
+                return false;
+            }
+        }
+        pk = it->GetPK();
+        if (pk.empty()) {
+            return true;
+        }
+    }
+}
+
+void TabletImpl::SplitTable(RpcController* controller, const ::openmldb::api::SplitTableRequest* request,
+                            ::openmldb::api::GeneralResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    std::shared_ptr<::openmldb::api::TaskInfo> task_ptr;
+    if (request->has_task_info() && request->task_info().IsInitialized()) {
+        if (AddOPTask(request->task_info(), ::openmldb::api::TaskType::kSplitTable, task_ptr) < 0) {
+            response->set_code(-1);
+            response->set_msg("add task failed");
+            return;
+        }
+    }
+    uint32_t tid = request->tid();
+    uint32_t pid = request->pid();
+    uint32_t child_pid = request->child_pid();
+    do {
+        std::shared_ptr<Table> table = GetTable(tid, pid);
+        if (!table) {
+            PDLOG(WARNING, "table is not exist. tid[%u] pid[%u]", tid, pid);
+            response->set_code(::openmldb::base::ReturnCode::kTableIsNotExist);
+            response->set_msg("table is not exist");
+            break;
+        }
+        if (table->GetStorageMode() != ::openmldb::common::kMemory) {
+            response->set_code(::openmldb::base::ReturnCode::kOperatorNotSupport);
+            response->set_msg("only support mem_table");
+            break;
+        }
+        if (!table->IsLeader()) {
+            response->set_code(::openmldb::base::ReturnCode::kTableIsFollower);
+            response->set_msg("table is follower");
+            break;
+        }
+        if (table->GetTableStat() != ::openmldb::storage::kNormal) {
+            PDLOG(WARNING, "table state is %d, cannot split. tid %u, pid %u", table->GetTableStat(), tid, pid);
+            response->set_code(::openmldb::base::ReturnCode::kTableStatusIsNotKnormal);
+            response->set_msg("table status is not kNormal");
+            break;
+        }
+        auto router = std::make_shared<const ::openmldb::base::PartitionRouter>(request->partition_num(),
+                                                                                request->partition_split());
+        if (child_pid == pid || child_pid >= router->GetPartitionNum()) {
+            response->set_code(::openmldb::base::ReturnCode::kPidIsNotExist);
+            response->set_msg("child pid is not in the splits");
+            break;
+        }
+        if (!GetTable(tid, child_pid)) {
+            ::openmldb::api::TableMeta table_meta(*table->GetTableMeta());
+            table_meta.set_pid(child_pid);
+            table_meta.set_mode(::openmldb::api::TableMode::kTableLeader);
+            table_meta.clear_replicas();
+            auto status = CreateLocalTable(&table_meta);
+            if (!status.OK()) {
+                PDLOG(WARNING, "fail to create the child partition. tid %u, pid %u, msg %s", tid, child_pid,
+                      status.msg.c_str());
+                response->set_code(status.code);
+                response->set_msg(status.msg);
+                break;
+            }
+        }
+        {
+            std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+            split_routers_[std::make_pair(tid, pid)] = router;
+        }
+        task_pool_.AddTask(boost::bind(&TabletImpl::SplitTableInternal, this, table, child_pid, router, task_ptr));
+        response->set_code(::openmldb::base::ReturnCode::kOk);
+        response->set_msg("ok");
+        PDLOG(INFO, "split table tid[%u] pid[%u] to child pid[%u]", tid, pid, child_pid);
+        return;
+    } while (0);
+    SetTaskStatus(task_ptr, ::openmldb::api::TaskStatus::kFailed);
+}
+
+void TabletImpl::SplitTableInternal(std::shared_ptr<::openmldb::storage::Table> table, uint32_t child_pid,
+                                    std::shared_ptr<const ::openmldb::base::PartitionRouter> router,
+                                    std::shared_ptr<::openmldb::api::TaskInfo> task) {
+    uint32_t tid = table->GetId();
+    uint32_t pid = table->GetPid();
+    // the puts already running with the old route are finished before the rows are copied
+    std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_split_table_wait_ms));
+    uint64_t cnt = 0;
+    bool ok = true;
+    for (const auto& index : table->GetAllIndex()) {
+        if (!index->IsReady()) {
+            continue;
+        }
+        uint32_t idx = index->GetId();
+        std::string last_pk;
+        bool routed = false;
+        ok = TraverseIndex(table, idx, [&](::openmldb::storage::TraverseIterator* it) {
+            std::string pk = it->GetPK();
+            if (pk != last_pk) {
+                last_pk = pk;
+                routed = router->GetPid(pk) == child_pid;
+            }
+            if (!routed) {
+                it->NextPK();
+                return true;
+            }
+            ::openmldb::api::PutRequest request;
+            request.set_tid(tid);
+            request.set_pid(child_pid);
+            request.set_time(it->GetKey());
+            auto value = it->GetValue();
+            request.set_value(value.data(), value.size());
+            auto dimension = request.add_dimensions();
+            dimension->set_key(pk);
+            dimension->set_idx(idx);
+            ::openmldb::api::PutResponse response;
+            ProcessPut(&request, &response);
+            if (response.code() != ::openmldb::base::ReturnCode::kOk) {
+                PDLOG(WARNING, "fail to put to the child partition. tid %u, pid %u, msg %s", tid, child_pid,
+                      response.msg().c_str());
+                return false;
+            }
+            cnt++;
+            it->Next();
+            return true;
+        });
+        if (!ok) {
+            break;
+        }
+    }
+    auto replicator = GetReplicator(tid, child_pid);
+    if (replicator) {
+        replicator->Notify();
+    }
+    if (ok) {
+        PDLOG(INFO, "split table tid %u pid %u to child pid %u done, %lu rows copied", tid, pid, child_pid, cnt);
+        SetTaskStatus(task, ::openmldb::api::kDone);
+    } else {
+        PDLOG(WARNING, "fail to split table tid %u pid %u to child pid %u", tid, pid, child_pid);
+        SetTaskStatus(task, ::openmldb::api::kFailed);
+    }
+}
+
+void TabletImpl::DeleteSplitData(RpcController* controller, const ::openmldb::api::DeleteSplitDataRequest* request,
+                                 ::openmldb::api::GeneralResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    std::shared_ptr<::openmldb::api::TaskInfo> task_ptr;
+    if (request->has_task_info() && request->task_info().IsInitialized()) {
+        if (AddOPTask(request->task_info(), ::openmldb::api::TaskType::kDeleteSplitData, task_ptr) < 0) {
+            response->set_code(-1);
+            response->set_msg("add task failed");
+            return;
+        }
+    }
+    uint32_t tid = request->tid();
+    uint32_t pid = request->pid();
+    do {
+        std::shared_ptr<Table> table = GetTable(tid, pid);
+        if (!table) {
+            PDLOG(WARNING, "table is not exist. tid[%u] pid[%u]", tid, pid);
+            response->set_code(::openmldb::base::ReturnCode::kTableIsNotExist);
+            response->set_msg("table is not exist");
+            break;
+        }
+        if (!table->IsLeader()) {
+            response->set_code(::openmldb::base::ReturnCode::kTableIsFollower);
+            response->set_msg("table is follower");
+            break;
+        }
+        auto router = std::make_shared<const ::openmldb::base::PartitionRouter>(request->partition_num(),
+                                                                                request->partition_split());
+        {
+            std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+            split_routers_[std::make_pair(tid, pid)] = router;
+        }
+        task_pool_.AddTask(boost::bind(&TabletImpl::DeleteSplitDataInternal, this, table, router, task_ptr));
+        response->set_code(::openmldb::base::ReturnCode::kOk);
+        response->set_msg("ok");
+        PDLOG(INFO, "delete split data of table tid[%u] pid[%u]", tid, pid);
+        return;
+    } while (0);
+    SetTaskStatus(task_ptr, ::openmldb::api::TaskStatus::kFailed);
+}
+
+void TabletImpl::DeleteSplitDataInternal(std::shared_ptr<::openmldb::storage::Table> table,
+                                         std::shared_ptr<const ::openmldb::base::PartitionRouter> router,
+                                         std::shared_ptr<::openmldb::api::TaskInfo> task) {
+    uint32_t tid = table->GetId();
+    uint32_t pid = table->GetPid();
+    auto replicator = GetReplicator(tid, pid);
+    if (!replicator) {
+        PDLOG(WARNING, "fail to find table tid %u pid %u leader's log replicator", tid, pid);
+        SetTaskStatus(task, ::openmldb::api::kFailed);
+        return;
+    }
+    uint64_t cnt = 0;
+    for (const auto& index : table->GetAllIndex()) {
+        if (!index->IsReady()) {
+            continue;
+        }
+        uint32_t idx = index->GetId();
+        // the pks are deleted after the traverse, which is not to be changed under it
+        std::vector<std::string> pks;
+        bool ok = TraverseIndex(table, idx, [&](::openmldb::storage::TraverseIterator* it) {
+            std::string pk = it->GetPK();
+            if (router->GetPid(pk) != pid) {
+                pks.push_back(pk);
+            }
+            it->NextPK();
+            return true;
+        });
+        if (!ok) {
+            PDLOG(WARNING, "fail to traverse index %u of table tid %u pid %u", idx, tid, pid);
+            SetTaskStatus(task, ::openmldb::api::kFailed);
+            return;
+        }
+        for (const auto& pk : pks) {
+            if (!table->Delete(pk, idx)) {
+                continue;
+            }
+            ::openmldb::api::LogEntry entry;
+            entry.set_term(replicator->GetLeaderTerm());
+            entry.set_method_type(::openmldb::api::MethodType::kDelete);
+            ::openmldb::api::Dimension* dimension = entry.add_dimensions();
+            dimension->set_key(pk);
+            dimension->set_idx(idx);
+            replicator->AppendEntry(entry);
+            cnt++;
+        }
+    }
+    replicator->Notify();
+    PDLOG(INFO, "delete split data of table tid %u pid %u done, %lu keys deleted", tid, pid, cnt);
+    SetTaskStatus(task, ::openmldb::api::kDone);
+}
+
 void TabletImpl::DumpIndexData(RpcController* controller, const ::openmldb::api::DumpIndexDataRequest* request,
                                ::openmldb::api::GeneralResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -4810,8 +6728,10 @@ void TabletImpl::DumpIndexData(RpcController* controller, const ::openmldb::api:
         }
         std::shared_ptr<::openmldb::storage::MemTableSnapshot> memtable_snapshot =
             std::static_pointer_cast<::openmldb::storage::MemTableSnapshot>(snapshot);
-        task_pool_.AddTask(boost::bind(&TabletImpl::DumpIndexDataInternal, this, table, memtable_snapshot,
-                                       request->partition_num(), request->column_key(), request->idx(), task_ptr));
+        background_pool_.AddTask(kIndexTask,
+                                 boost::bind(&TabletImpl::DumpIndexDataInternal, this, table, memtable_snapshot,
+                                             request->partition_num(), request->column_key(), request->idx(),
+                                             task_ptr));
         response->set_code(::openmldb::base::ReturnCode::kOk);
         response->set_msg("ok");
         PDLOG(INFO, "dump index tid[%u] pid[%u]", tid, pid);
@@ -4911,8 +6831,9 @@ void TabletImpl::LoadIndexData(RpcController* controller, const ::openmldb::api:
             SetTaskStatus(task_ptr, ::openmldb::api::TaskStatus::kDone);
         } else {
             uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
-            task_pool_.AddTask(boost::bind(&TabletImpl::LoadIndexDataInternal, this, tid, pid, 0,
-                                           request->partition_num(), cur_time, task_ptr));
+            background_pool_.AddTask(kIndexTask,
+                                     boost::bind(&TabletImpl::LoadIndexDataInternal, this, tid, pid, 0,
+                                                 request->partition_num(), cur_time, task_ptr));
         }
         return;
     } while (0);
@@ -4923,8 +6844,9 @@ void TabletImpl::LoadIndexDataInternal(uint32_t tid, uint32_t pid, uint32_t cur_
                                        uint64_t last_time, std::shared_ptr<::openmldb::api::TaskInfo> task) {
     uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
     if (cur_pid == pid) {
-        task_pool_.AddTask(boost::bind(&TabletImpl::LoadIndexDataInternal, this, tid, pid, cur_pid + 1, partition_num,
-                                       cur_time, task));
+        background_pool_.AddTask(kIndexTask,
+                                 boost::bind(&TabletImpl::LoadIndexDataInternal, this, tid, pid, cur_pid + 1,
+                                             partition_num, cur_time, task));
         return;
     }
     ::openmldb::api::TaskStatus status = ::openmldb::api::TaskStatus::kFailed;
@@ -4960,8 +6882,9 @@ void TabletImpl::LoadIndexDataInternal(uint32_t tid, uint32_t pid, uint32_t cur_
             SetTaskStatus(task, ::openmldb::api::TaskStatus::kFailed);
             return;
         }
-        task_pool_.DelayTask(FLAGS_task_check_interval, boost::bind(&TabletImpl::LoadIndexDataInternal, this, tid, pid,
-                                                                    cur_pid, partition_num, last_time, task));
+        background_pool_.DelayTask(kIndexTask, FLAGS_task_check_interval,
+                                   boost::bind(&TabletImpl::LoadIndexDataInternal, this, tid, pid, cur_pid,
+                                               partition_num, last_time, task));
         return;
     }
     FILE* fd = fopen(index_file_path.c_str(), "rb");
@@ -5026,8 +6949,9 @@ void TabletImpl::LoadIndexDataInternal(uint32_t tid, uint32_t pid, uint32_t cur_
         return;
     }
     cur_time = ::baidu::common::timer::get_micros() / 1000;
-    task_pool_.AddTask(
-        boost::bind(&TabletImpl::LoadIndexDataInternal, this, tid, pid, cur_pid + 1, partition_num, cur_time, task));
+    background_pool_.AddTask(kIndexTask,
+                             boost::bind(&TabletImpl::LoadIndexDataInternal, this, tid, pid, cur_pid + 1, partition_num,
+                                         cur_time, task));
 }
 
 void TabletImpl::ExtractMultiIndexData(RpcController* controller,
@@ -5124,8 +7048,10 @@ void TabletImpl::ExtractIndexData(RpcController* controller, const ::openmldb::a
             }
         }
         auto memtable_snapshot = std::static_pointer_cast<::openmldb::storage::MemTableSnapshot>(snapshot);
-        task_pool_.AddTask(boost::bind(&TabletImpl::ExtractIndexDataInternal, this, table, memtable_snapshot,
-                                       request->column_key(), request->idx(), request->partition_num(), task_ptr));
+        background_pool_.AddTask(kIndexTask,
+                                 boost::bind(&TabletImpl::ExtractIndexDataInternal, this, table, memtable_snapshot,
+                                             request->column_key(), request->idx(), request->partition_num(),
+                                             task_ptr));
         base::SetResponseOK(response);
         return;
     } while (0);
@@ -5289,6 +7215,22 @@ bool TabletImpl::GetRealEp(uint64_t tid, uint64_t pid, std::map<std::string, std
     return true;
 }
 
+// the deploy options which change how the sql is compiled, null if there is none
+static std::shared_ptr<std::unordered_map<std::string, std::string>> GetCompileOptions(
+    const hybridse::sdk::ProcedureInfo& sp_info) {
+    std::shared_ptr<std::unordered_map<std::string, std::string>> options = nullptr;
+    for (auto name : {hybridse::vm::LONG_WINDOWS, hybridse::vm::FAST_MATH}) {
+        auto value = sp_info.GetOption(name);
+        if (value) {
+            if (!options) {
+                options = std::make_shared<std::unordered_map<std::string, std::string>>();
+            }
+            options->emplace(name, *value);
+        }
+    }
+    return options;
+}
+
 void TabletImpl::CreateProcedure(RpcController* controller, const openmldb::api::CreateProcedureRequest* request,
                                  openmldb::api::GeneralResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -5305,12 +7247,7 @@ void TabletImpl::CreateProcedure(RpcController* controller, const openmldb::api:
     ::hybridse::base::Status status;
     auto sp_info_impl = std::make_shared<openmldb::catalog::ProcedureInfoImpl>(sp_info);
 
-    auto long_windows = sp_info_impl->GetOption(hybridse::vm::LONG_WINDOWS);
-    std::shared_ptr<std::unordered_map<std::string, std::string>> options = nullptr;
-    if (long_windows) {
-        options = std::make_shared<std::unordered_map<std::string, std::string>>();
-        options->emplace(hybridse::vm::LONG_WINDOWS, *long_windows);
-    }
+    auto options = GetCompileOptions(*sp_info_impl);
 
     // build for single request
     ::hybridse::vm::RequestRunSession session;
@@ -5322,21 +7259,23 @@ void TabletImpl::CreateProcedure(RpcController* controller, const openmldb::api:
         LOG(WARNING) << "fail to compile sql " << sql << std::endl << status.str();
         return;
     }
+    if (FLAGS_hot_standby) {
+        // run at full speed from the first request after the tablet is promoted
+        engine_->OptimizeInBackground(session.GetCompileInfo());
+    }
 
     // build for batch request
-    ::hybridse::vm::BatchRequestRunSession batch_session;
-    batch_session.SetOptions(options);
+    std::set<size_t> common_column_indices;
     for (auto i = 0; i < sp_info.input_schema_size(); ++i) {
         bool is_constant = sp_info.input_schema().Get(i).is_constant();
         if (is_constant) {
-            batch_session.AddCommonColumnIdx(i);
+            common_column_indices.insert(i);
         }
     }
-    ok = engine_->Get(sql, db_name, batch_session, status);
-    if (!ok || batch_session.GetCompileInfo() == nullptr) {
+    auto batch_request_info = BuildBatchRequestInfo(sql, db_name, options, common_column_indices, &status);
+    if (!batch_request_info) {
         response->set_msg(status.str());
         response->set_code(::openmldb::base::kSQLCompileError);
-        LOG(WARNING) << "fail to compile batch request for sql " << sql;
         return;
     }
 
@@ -5354,7 +7293,9 @@ void TabletImpl::CreateProcedure(RpcController* controller, const openmldb::api:
     }
 
     sp_cache_->InsertSQLProcedureCacheEntry(db_name, sp_name, sp_info_impl, session.GetCompileInfo(),
-                                            batch_session.GetCompileInfo());
+                                            batch_request_info);
+    AddResultCacheDeployment(sp_info_impl);
+    AddMaterializedView(sp_info_impl);
 
     response->set_code(::openmldb::base::ReturnCode::kOk);
     response->set_msg("ok");
@@ -5371,10 +7312,20 @@ void TabletImpl::DropProcedure(RpcController* controller, const ::openmldb::api:
     auto is_deployment_procedure = sp_info.ok() && sp_info.value()->GetType() == hybridse::sdk::kReqDeployment;
 
     sp_cache_->DropSQLProcedureCacheEntry(db_name, sp_name);
+    result_cache_->DropDeployment(db_name, sp_name);
+    materialized_views_->DropDeployment(db_name, sp_name);
     if (!catalog_->DropProcedure(db_name, sp_name)) {
         LOG(WARNING) << "drop procedure" << db_name << "." << sp_name << " in catalog failed";
     }
 
+    {
+        std::lock_guard<std::mutex> lock(deploy_profile_mu_);
+        auto it = deploy_profiles_.find(db_name);
+        if (it != deploy_profiles_.end()) {
+            it->second.erase(sp_name);
+        }
+    }
+    deploy_metrics_->DeleteDeploy(absl::StrCat(db_name, ".", sp_name));
     if (is_deployment_procedure) {
         auto collector_key = absl::StrCat(db_name, ".", sp_name);
         auto s = deploy_collector_->DeleteDeploy(collector_key);
@@ -5391,7 +7342,7 @@ void TabletImpl::DropProcedure(RpcController* controller, const ::openmldb::api:
 
 void TabletImpl::RunRequestQuery(RpcController* ctrl, const openmldb::api::QueryRequest& request,
                                  ::hybridse::vm::RequestRunSession& session, openmldb::api::QueryResponse& response,
-                                 butil::IOBuf& buf) {
+                                 butil::IOBuf& buf, SlowTrace* trace) {
     if (request.is_debug()) {
         session.EnableDebug();
     }
@@ -5403,6 +7354,7 @@ void TabletImpl::RunRequestQuery(RpcController* ctrl, const openmldb::api::Query
         response.set_msg("fail to decode input row");
         return;
     }
+    trace->Mark("decode_input");
     ::hybridse::codec::Row output;
     int32_t ret = 0;
     if (request.has_task_id()) {
@@ -5410,7 +7362,16 @@ void TabletImpl::RunRequestQuery(RpcController* ctrl, const openmldb::api::Query
     } else {
         ret = session.Run(row, &output);
     }
-    if (ret != 0) {
+    trace->Mark("run");
+    if (ret == ::hybridse::vm::RunSession::RUN_DEADLINE_EXCEEDED) {
+        response.set_code(::openmldb::base::kQueryDeadlineExceeded);
+        response.set_msg("deadline exceeded");
+        return;
+    } else if (ret == ::hybridse::vm::RunSession::RUN_MEMORY_LIMIT_EXCEEDED) {
+        response.set_code(::openmldb::base::kQueryMemoryLimitExceeded);
+        response.set_msg("memory limit exceeded");
+        return;
+    } else if (ret != 0) {
         response.set_code(::openmldb::base::kSQLRunError);
         response.set_msg("fail to run sql");
         return;
@@ -5425,6 +7386,7 @@ void TabletImpl::RunRequestQuery(RpcController* ctrl, const openmldb::api::Query
         response.set_msg("fail to encode sql output row");
         return;
     }
+    trace->Mark("encode_output");
     if (!request.has_task_id()) {
         response.set_schema(session.GetEncodedSchema());
     }
@@ -5434,16 +7396,206 @@ void TabletImpl::RunRequestQuery(RpcController* ctrl, const openmldb::api::Query
     response.set_code(::openmldb::base::kOk);
 }
 
+void TabletImpl::RunCachedRequestQuery(RpcController* ctrl, const openmldb::api::QueryRequest& request,
+                                       ::hybridse::vm::RequestRunSession& session,
+                                       openmldb::api::QueryResponse& response, butil::IOBuf& buf, SlowTrace* trace) {
+    // the task id and the encoded input row make up the key
+    std::string key = request.has_task_id() ? std::to_string(request.task_id()) : "";
+    key.push_back('|');
+    auto& request_buf = static_cast<brpc::Controller*>(ctrl)->request_attachment();
+    request_buf.append_to(&key, request.row_size(), 0);
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    ResultCache::Result result;
+    std::vector<uint64_t> versions;
+    bool hit = result_cache_->Get(request.db(), request.sp_name(), key, cur_time, &result, &versions);
+    trace->Mark("result_cache_lookup");
+    if (hit) {
+        response.CopyFrom(result.response);
+        buf.append(result.data);
+        return;
+    }
+    RunRequestQuery(ctrl, request, session, response, buf, trace);
+    if (response.code() == ::openmldb::base::kOk) {
+        result.response.CopyFrom(response);
+        result.data = buf.to_string();
+        result_cache_->Put(request.db(), request.sp_name(), key, cur_time, result, versions);
+    }
+}
+
+void TabletImpl::AddResultCacheDeployment(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info) {
+    if (!result_cache_->IsEnabled()) {
+        return;
+    }
+    std::vector<std::pair<std::string, std::string>> tables;
+    const auto& dbs = sp_info->GetDbs();
+    const auto& names = sp_info->GetTables();
+    for (size_t i = 0; i < names.size() && i < dbs.size(); i++) {
+        tables.emplace_back(dbs[i], names[i]);
+    }
+    result_cache_->AddDeployment(sp_info->GetDbName(), sp_info->GetSpName(), tables);
+}
+
+void TabletImpl::AddMaterializedView(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info) {
+    auto value = sp_info->GetOption(MATERIALIZED);
+    if (value == nullptr || absl::EqualsIgnoreCase(*value, "false")) {
+        return;
+    }
+    std::string index_name = absl::EqualsIgnoreCase(*value, "true") ? "" : *value;
+    materialized_views_->AddDeployment(std::make_shared<MaterializedView>(
+        sp_info->GetDbName(), sp_info->GetSpName(), sp_info->GetMainDb(), sp_info->GetMainTable(), index_name));
+    LOG(INFO) << "materialize deployment " << sp_info->GetDbName() << "." << sp_info->GetSpName() << " on table "
+              << sp_info->GetMainDb() << "." << sp_info->GetMainTable();
+}
+
+void TabletImpl::RunMaterializedViews(const std::shared_ptr<Table>& table, const std::string& value,
+                                      std::vector<MaterializedUpdate>* updates) {
+    auto views = materialized_views_->GetViews(table->GetDB(), table->GetName());
+    if (!views) {
+        return;
+    }
+    const int8_t* row = reinterpret_cast<const int8_t*>(value.data());
+    for (const auto& view : *views) {
+        if (!view->IsReady() && !view->Init(*table->GetTableMeta())) {
+            continue;
+        }
+        MaterializedUpdate update;
+        uint64_t ts = 0;
+        if (!view->GetKey(row, value.size(), &update.key, &ts)) {
+            continue;
+        }
+        update.lock = view->Lock(update.key);
+        update.output = RunMaterializedView(*view, table->GetId(), table->GetPid(), value, ts);
+        if (!update.output) {
+            // the key is computed by its next request instead
+            view->Erase(update.key);
+            continue;
+        }
+        update.view = view;
+        updates->push_back(std::move(update));
+    }
+}
+
+std::shared_ptr<MaterializedView::Output> TabletImpl::RunMaterializedView(const MaterializedView& view, uint32_t tid,
+                                                                          uint32_t pid, const std::string& value,
+                                                                          uint64_t ts) {
+    ::hybridse::base::Status status;
+    auto compile_info = sp_cache_->GetRequestInfo(view.GetDB(), view.GetSpName(), status);
+    if (!status.isOK() || !compile_info) {
+        return {};
+    }
+    ::hybridse::vm::RequestRunSession session;
+    session.SetCompileInfo(engine_->RecordRun(compile_info));
+    session.SetSpName(view.GetSpName());
+    engine_->InitRequestSession(&session);
+    ::hybridse::codec::Row output_row;
+    if (session.Run(::hybridse::codec::Row(value), &output_row) != 0) {
+        DLOG(WARNING) << "fail to run materialized deployment " << view.GetDB() << "." << view.GetSpName();
+        return {};
+    }
+    butil::IOBuf buf;
+    size_t byte_size = 0;
+    if (!codec::EncodeRpcRow(output_row, &buf, &byte_size)) {
+        return {};
+    }
+    auto output = std::make_shared<MaterializedView::Output>();
+    output->tid = tid;
+    output->pid = pid;
+    output->ts = ts;
+    output->data = buf.to_string();
+    output->response.set_schema(session.GetEncodedSchema());
+    output->response.set_byte_size(byte_size);
+    output->response.set_count(1);
+    output->response.set_row_slices(1);
+    output->response.set_code(::openmldb::base::kOk);
+    return output;
+}
+
+void TabletImpl::EraseMaterializedViews(const std::shared_ptr<Table>& table, const std::string& value) {
+    auto views = materialized_views_->GetViews(table->GetDB(), table->GetName());
+    if (!views) {
+        return;
+    }
+    const int8_t* row = reinterpret_cast<const int8_t*>(value.data());
+    for (const auto& view : *views) {
+        std::string key;
+        uint64_t ts = 0;
+        if ((view->IsReady() || view->Init(*table->GetTableMeta())) && view->GetKey(row, value.size(), &key, &ts)) {
+            // the output being computed by a put of the key is kept before it is dropped
+            auto lock = view->Lock(key);
+            view->Erase(key);
+        }
+    }
+}
+
+bool TabletImpl::LookupMaterializedView(RpcController* ctrl, const openmldb::api::QueryRequest& request,
+                                        openmldb::api::QueryResponse& response, butil::IOBuf& buf,
+                                        SlowTrace* trace) {
+    if (materialized_views_->Empty() || request.has_task_id() || request.row_slices() != 1) {
+        return false;
+    }
+    auto view = materialized_views_->GetView(request.db(), request.sp_name());
+    if (!view || !view->IsReady()) {
+        return false;
+    }
+    std::string input;
+    static_cast<brpc::Controller*>(ctrl)->request_attachment().copy_to(&input, request.row_size(), 0);
+    std::string key;
+    uint64_t ts = 0;
+    // only the request of now is answered, the others see the windows of their own ts
+    if (!view->GetKey(reinterpret_cast<const int8_t*>(input.data()), input.size(), &key, &ts) || ts != 0) {
+        return false;
+    }
+    auto output = view->Get(key);
+    trace->Mark("materialized_view_lookup");
+    if (!output) {
+        return false;
+    }
+    auto table = GetTable(output->tid, output->pid);
+    if (!table || !table->IsLeader()) {
+        // the puts go to the new leader now
+        view->Erase(key);
+        return false;
+    }
+    response.CopyFrom(output->response);
+    buf.append(output->data);
+    return true;
+}
+
+std::shared_ptr<LazyCompileInfo> TabletImpl::BuildBatchRequestInfo(
+    const std::string& sql, const std::string& db,
+    const std::shared_ptr<std::unordered_map<std::string, std::string>>& options,
+    const std::set<size_t>& common_column_indices, ::hybridse::base::Status* status) {
+    auto engine = engine_.get();
+    auto compiler = [engine, sql, db, options, common_column_indices](::hybridse::base::Status* compile_status) {
+        ::hybridse::vm::BatchRequestRunSession session;
+        session.SetOptions(options);
+        for (auto idx : common_column_indices) {
+            session.AddCommonColumnIdx(idx);
+        }
+        if (!engine->Get(sql, db, session, *compile_status) || session.GetCompileInfo() == nullptr) {
+            LOG(WARNING) << "fail to compile batch request for sql " << sql;
+            return std::shared_ptr<::hybridse::vm::CompileInfo>();
+        }
+        return session.GetCompileInfo();
+    };
+    if (FLAGS_enable_lazy_batch_request_compile && !FLAGS_hot_standby) {
+        return std::make_shared<LazyCompileInfo>(compiler);
+    }
+    auto info = compiler(status);
+    if (!info) {
+        return {};
+    }
+    if (FLAGS_hot_standby) {
+        engine_->OptimizeInBackground(info);
+    }
+    return std::make_shared<LazyCompileInfo>(info);
+}
+
 void TabletImpl::CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info) {
     const std::string& db_name = sp_info->GetDbName();
     const std::string& sp_name = sp_info->GetSpName();
     const std::string& sql = sp_info->GetSql();
-    auto long_windows = sp_info->GetOption(hybridse::vm::LONG_WINDOWS);
-    std::shared_ptr<std::unordered_map<std::string, std::string>> options = nullptr;
-    if (long_windows) {
-        options = std::make_shared<std::unordered_map<std::string, std::string>>();
-        options->emplace(hybridse::vm::LONG_WINDOWS, *long_windows);
-    }
+    auto options = GetCompileOptions(*sp_info);
 
     ::hybridse::base::Status status;
     // build for single request
@@ -5454,22 +7606,25 @@ void TabletImpl::CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureI
         LOG(WARNING) << "fail to compile sql " << sql;
         return;
     }
+    if (FLAGS_hot_standby) {
+        engine_->OptimizeInBackground(session.GetCompileInfo());
+    }
     // build for batch request
-    ::hybridse::vm::BatchRequestRunSession batch_session;
-    batch_session.SetOptions(options);
+    std::set<size_t> common_column_indices;
     for (auto i = 0; i < sp_info->GetInputSchema().GetColumnCnt(); ++i) {
         bool is_constant = sp_info->GetInputSchema().IsConstant(i);
         if (is_constant) {
-            batch_session.AddCommonColumnIdx(i);
+            common_column_indices.insert(i);
         }
     }
-    ok = engine_->Get(sql, db_name, batch_session, status);
-    if (!ok || batch_session.GetCompileInfo() == nullptr) {
-        LOG(WARNING) << "fail to compile batch request for sql " << sql;
+    auto batch_request_info = BuildBatchRequestInfo(sql, db_name, options, common_column_indices, &status);
+    if (!batch_request_info) {
         return;
     }
     sp_cache_->InsertSQLProcedureCacheEntry(db_name, sp_name, sp_info, session.GetCompileInfo(),
-                                            batch_session.GetCompileInfo());
+                                            batch_request_info);
+    AddResultCacheDeployment(sp_info);
+    AddMaterializedView(sp_info);
 
     LOG(INFO) << "refresh procedure success! sp_name: " << sp_name << ", db: " << db_name << ", sql: " << sql;
 }
@@ -5554,7 +7709,18 @@ void TabletImpl::TryCollectDeployStats(const std::string& db, const std::string&
     if (!s.ok()) {
         LOG(ERROR) << "[ERROR] collect deploy stat: " << s;
     }
-    LOG(INFO) << "collected " << deploy_name << " for " << time;
+    DLOG(INFO) << "collected " << deploy_name << " for " << time;
+}
+
+void TabletImpl::CollectDeployMetrics(const std::string& db, const std::string& name, absl::Time start_time) {
+    absl::Duration time = absl::Now() - start_time;
+    const std::string deploy_name = absl::StrCat(db, ".", name);
+    auto s = deploy_metrics_->Collect(deploy_name, time);
+    if (absl::IsNotFound(s)) {
+        // the error of the deploy added by a concurrent call is ignored
+        deploy_metrics_->AddDeploy(deploy_name);
+        deploy_metrics_->Collect(deploy_name, time);
+    }
 }
 
 void TabletImpl::BulkLoad(RpcController* controller, const ::openmldb::api::BulkLoadRequest* request,
@@ -5584,6 +7750,11 @@ void TabletImpl::BulkLoad(RpcController* controller, const ::openmldb::api::Bulk
         response->set_msg("table is follower");
         return;
     }
+    if (IsLeaseExpired()) {
+        response->set_code(::openmldb::base::ReturnCode::kTableIsFollower);
+        response->set_msg("the lease of tablet expired");
+        return;
+    }
     if (table->GetTableStat() == ::openmldb::storage::kLoading) {
         PDLOG(WARNING, "table %u-%u is loading.", request->tid(), request->pid());
         response->set_code(::openmldb::base::ReturnCode::kTableIsLoading);
@@ -5591,6 +7762,11 @@ void TabletImpl::BulkLoad(RpcController* controller, const ::openmldb::api::Bulk
         return;
     }
 
+    if (table->GetStorageMode() != ::openmldb::common::kMemory) {
+        DiskBulkLoad(table, request, response);
+        return;
+    }
+
     // first DataRegion, then IndexRegion, when we get IndexRegion rpc, empty DataRegion is available
     auto* cntl = dynamic_cast<brpc::Controller*>(controller);
     const auto& data = cntl->request_attachment();
@@ -5667,6 +7843,60 @@ void TabletImpl::BulkLoad(RpcController* controller, const ::openmldb::api::Bulk
     }
 }
 
+void TabletImpl::DiskBulkLoad(const std::shared_ptr<Table>& table, const ::openmldb::api::BulkLoadRequest* request,
+                              ::openmldb::api::GeneralResponse* response) {
+    uint32_t tid = request->tid();
+    uint32_t pid = request->pid();
+    if (request->rows_size() == 0) {
+        if (!request->eof()) {
+            response->set_code(::openmldb::base::ReturnCode::kReceiveDataError);
+            response->set_msg("no rows to bulk load for disk table");
+        }
+        return;
+    }
+    uint64_t start_time = ::baidu::common::timer::get_micros();
+    std::vector<const ::openmldb::api::PutRequest*> rows;
+    for (const auto& row : request->rows()) {
+        if (row.dimensions_size() == 0 || CheckDimessionPut(&row, table->GetIdxCnt()) != 0) {
+            response->set_code(::openmldb::base::ReturnCode::kInvalidDimensionParameter);
+            response->set_msg("invalid dimension parameter");
+            return;
+        }
+        rows.push_back(&row);
+    }
+    auto disk_table = std::dynamic_pointer_cast<DiskTable>(table);
+    if (!disk_table || !disk_table->BulkLoad(rows)) {
+        response->set_code(::openmldb::base::ReturnCode::kWriteDataFailed);
+        response->set_msg("bulk load to table failed");
+        LOG(WARNING) << tid << "-" << pid << " " << response->msg();
+        return;
+    }
+    uint64_t load_time = ::baidu::common::timer::get_micros();
+    std::shared_ptr<LogReplicator> replicator = GetReplicator(tid, pid);
+    if (!replicator) {
+        PDLOG(WARNING, "fail to find table tid %u pid %u leader's log replicator", tid, pid);
+    } else {
+        // the followers replay the binlog, so the rows are still written to it
+        std::vector<::openmldb::api::LogEntry> entries(rows.size());
+        uint64_t term = replicator->GetLeaderTerm();
+        for (size_t i = 0; i < rows.size(); i++) {
+            entries[i].set_ts(rows[i]->time());
+            entries[i].set_value(rows[i]->value());
+            entries[i].mutable_dimensions()->CopyFrom(rows[i]->dimensions());
+            entries[i].set_term(term);
+        }
+        if (!replicator->AppendEntries(&entries)) {
+            LOG(WARNING) << tid << "-" << pid << " write binlog failed";
+        }
+        if (FLAGS_binlog_notify_on_put) {
+            replicator->Notify();
+        }
+    }
+    PDLOG(INFO, "%u-%u, bulk load %d rows to disk table part %d. ingest cost %lu us, binlog cost %lu us", tid, pid,
+          request->rows_size(), request->part_id(), load_time - start_time,
+          ::baidu::common::timer::get_micros() - load_time);
+}
+
 void TabletImpl::CreateFunction(RpcController* controller, const openmldb::api::CreateFunctionRequest* request,
         openmldb::api::CreateFunctionResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
@@ -5708,6 +7938,7 @@ void TabletImpl::DropFunction(RpcController* controller, const openmldb::api::Dr
         arg_types.emplace_back(data_type);
     }
     engine_->ClearCacheLocked("");
+    statement_cache_->Invalidate("");
     auto status = engine_->RemoveExternalFunction(fun.name(), arg_types, fun.file());
     if (status.isOK()) {
         LOG(INFO) << "Drop function success. name " << fun.name() << " path " << fun.file();
@@ -5788,6 +8019,12 @@ bool TabletImpl::CreateAggregatorInternal(const ::openmldb::api::CreateAggregato
         msg.assign("create aggregator failed");
         return false;
     }
+    std::string aggr_root_path;
+    if (ChooseDBRootPath(request->aggr_table_tid(), request->aggr_table_pid(), aggr_table->GetStorageMode(),
+                         aggr_root_path)) {
+        aggregator->SetCheckpointPath(
+            GetDBPath(aggr_root_path, request->aggr_table_tid(), request->aggr_table_pid()) + "/aggr_checkpoint");
+    }
 
     auto base_replicator = GetReplicator(base_meta->tid(), base_meta->pid());
     if (!aggregator->Init(base_replicator)) {
@@ -5796,10 +8033,15 @@ bool TabletImpl::CreateAggregatorInternal(const ::openmldb::api::CreateAggregato
     uint64_t uid = (uint64_t) base_meta->tid() << 32 | base_meta->pid();
     {
         std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
-        if (aggregators_.find(uid) == aggregators_.end()) {
-            aggregators_.emplace(uid, std::make_shared<Aggrs>());
+        // the published aggregators are read without lock, so the list is copied rather than modified
+        auto aggrs = std::make_shared<Aggrs>();
+        auto it = aggregators_.find(uid);
+        if (it != aggregators_.end()) {
+            *aggrs = *it->second;
         }
-        aggregators_[uid]->push_back(aggregator);
+        aggrs->push_back(aggregator);
+        aggregators_[uid] = aggrs;
+        PublishTablesUnLock();
     }
     return true;
 }
@@ -5821,5 +8063,40 @@ void TabletImpl::GetAndFlushDeployStats(::google::protobuf::RpcController* contr
     response->set_code(ReturnCode::kOk);
 }
 
+std::shared_ptr<::hybridse::vm::RunnerProfile> TabletImpl::GetDeployProfile(const std::string& db,
+                                                                            const std::string& name) {
+    if (!FLAGS_enable_deploy_profile) {
+        return {};
+    }
+    std::lock_guard<std::mutex> lock(deploy_profile_mu_);
+    auto& profile = deploy_profiles_[db][name];
+    if (!profile) {
+        profile = std::make_shared<::hybridse::vm::RunnerProfile>();
+    }
+    return profile;
+}
+
+void TabletImpl::GetDeployProfile(::google::protobuf::RpcController* controller,
+                                  const ::openmldb::api::DeployProfileRequest* request,
+                                  ::openmldb::api::DeployProfileResponse* response,
+                                  ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    std::lock_guard<std::mutex> lock(deploy_profile_mu_);
+    auto db_it = deploy_profiles_.find(request->db());
+    if (db_it != deploy_profiles_.end()) {
+        for (const auto& kv : db_it->second) {
+            if (!request->deploy_name().empty() && kv.first != request->deploy_name()) {
+                continue;
+            }
+            auto profile = response->add_profiles();
+            profile->set_db(request->db());
+            profile->set_deploy_name(kv.first);
+            SetRunnerStats(*kv.second, profile->mutable_runner_stats());
+            profile->set_peak_memory(kv.second->GetPeakMemory());
+        }
+    }
+    response->set_code(ReturnCode::kOk);
+}
+
 }  // namespace tablet
 }  // namespace openmldb
@@ -19,6 +19,7 @@
 
 #include <brpc/server.h>
 
+#include <chrono>  // NOLINT
 #include <list>
 #include <map>
 #include <memory>
@@ -28,21 +29,41 @@
 #include <utility>
 #include <vector>
 
+#include "absl/time/time.h"
+#include "base/partition_router.h"
 #include "base/spinlock.h"
+#include "base/task_scheduler.h"
+#include "base/taskpool.hpp"
+#include "codec/row_ref_appender.h"
 #include "catalog/tablet_catalog.h"
 #include "common/thread_pool.h"
 #include "nameserver/system_table.h"
+#include "proto/name_server.pb.h"
 #include "proto/tablet.pb.h"
 #include "replica/log_replicator.h"
+#include "rpc/rpc_client.h"
 #include "storage/aggregator.h"
 #include "sdk/sql_cluster_router.h"
 #include "statistics/query_response_time/deploy_query_response_time.h"
 #include "storage/mem_table.h"
 #include "storage/mem_table_snapshot.h"
+#include "storage/read_snapshot.h"
+#include "tablet/admission_controller.h"
 #include "tablet/bulk_load_mgr.h"
 #include "tablet/combine_iterator.h"
 #include "tablet/file_receiver.h"
+#include "tablet/materialized_view.h"
+#include "tablet/query_result_cursor.h"
+#include "tablet/recovery_scheduler.h"
+#include "tablet/table_reclaimer.h"
+#include "tablet/table_registry.h"
+#include "tablet/result_cache.h"
+#include "tablet/slow_trace.h"
 #include "tablet/sp_cache.h"
+#include "tablet/statement_cache.h"
+#include "tablet/traverse_cursor.h"
+#include "tablet/workload_profiler.h"
+#include "tablet/write_throttler.h"
 #include "vm/engine.h"
 #include "zk/zk_client.h"
 
@@ -86,15 +107,27 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void Put(RpcController* controller, const ::openmldb::api::PutRequest* request,
              ::openmldb::api::PutResponse* response, Closure* done);
 
+    // put the rows of several partitions in one rpc, the rows of one partition are written in one binlog append and
+    // the responses are in the order of the requests
+    void BatchPut(RpcController* controller, const ::openmldb::api::BatchPutRequest* request,
+                  ::openmldb::api::BatchPutResponse* response, Closure* done);
+
     void Get(RpcController* controller, const ::openmldb::api::GetRequest* request,
              ::openmldb::api::GetResponse* response, Closure* done);
 
+    // get the keys of several partitions in one rpc, the responses are in the order of the requests
+    void BatchGet(RpcController* controller, const ::openmldb::api::BatchGetRequest* request,
+                  ::openmldb::api::BatchGetResponse* response, Closure* done);
+
     void Scan(RpcController* controller, const ::openmldb::api::ScanRequest* request,
               ::openmldb::api::ScanResponse* response, Closure* done);
 
     void Delete(RpcController* controller, const ::openmldb::api::DeleteRequest* request,
                 ::openmldb::api::GeneralResponse* response, Closure* done);
 
+    void DeleteBatch(RpcController* controller, const ::openmldb::api::DeleteBatchRequest* request,
+                     ::openmldb::api::GeneralResponse* response, Closure* done);
+
     void Count(RpcController* controller, const ::openmldb::api::CountRequest* request,
                ::openmldb::api::CountResponse* response, Closure* done);
 
@@ -122,6 +155,9 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void AppendEntries(RpcController* controller, const ::openmldb::api::AppendEntriesRequest* request,
                        ::openmldb::api::AppendEntriesResponse* response, Closure* done);
 
+    void AppendEntriesBatch(RpcController* controller, const ::openmldb::api::AppendEntriesBatchRequest* request,
+                            ::openmldb::api::AppendEntriesBatchResponse* response, Closure* done);
+
     void UpdateTableMetaForAddField(RpcController* controller,
                                     const ::openmldb::api::UpdateTableMetaForAddFieldRequest* request,
                                     ::openmldb::api::GeneralResponse* response, Closure* done);
@@ -168,9 +204,31 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void ShowMemPool(RpcController* controller, const ::openmldb::api::HttpRequest* request,
                      ::openmldb::api::HttpResponse* response, Closure* done);
 
+    void ShowGcStat(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                    ::openmldb::api::HttpResponse* response, Closure* done);
+
+    // the memory of each index of the memory tables by walking their rows, ?tid=x&pid=y limits the tables walked
+    void ShowIndexMemory(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                         ::openmldb::api::HttpResponse* response, Closure* done);
+
+    void ShowSlowTrace(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                       ::openmldb::api::HttpResponse* response, Closure* done);
+
+    // the cpu and the allocations by the tags, or the folded stacks with ?type=cpu or ?type=heap for
+    // flamegraph.pl. ?tag=prefix filters the stacks and ?reset=true clears the profile after shown
+    void ShowWorkloadProfile(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                             ::openmldb::api::HttpResponse* response, Closure* done);
+
+    // the metrics of the tables, gc, replication and engine in the text format of prometheus
+    void Metrics(RpcController* controller, const ::openmldb::api::HttpRequest* request,
+                 ::openmldb::api::HttpResponse* response, Closure* done);
+
     void GetAllSnapshotOffset(RpcController* controller, const ::openmldb::api::EmptyRequest* request,
                               ::openmldb::api::TableSnapshotOffsetResponse* response, Closure* done);
 
+    void Heartbeat(RpcController* controller, const ::openmldb::api::HeartbeatRequest* request,
+                   ::openmldb::api::GeneralResponse* response, Closure* done);
+
     void GetTermPair(RpcController* controller, const ::openmldb::api::GetTermPairRequest* request,
                      ::openmldb::api::GetTermPairResponse* response, Closure* done);
 
@@ -207,6 +265,12 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void LoadIndexData(RpcController* controller, const ::openmldb::api::LoadIndexDataRequest* request,
                        ::openmldb::api::GeneralResponse* response, Closure* done);
 
+    void SplitTable(RpcController* controller, const ::openmldb::api::SplitTableRequest* request,
+                    ::openmldb::api::GeneralResponse* response, Closure* done);
+
+    void DeleteSplitData(RpcController* controller, const ::openmldb::api::DeleteSplitDataRequest* request,
+                         ::openmldb::api::GeneralResponse* response, Closure* done);
+
     void ExtractIndexData(RpcController* controller, const ::openmldb::api::ExtractIndexDataRequest* request,
                           ::openmldb::api::GeneralResponse* response, Closure* done);
 
@@ -243,17 +307,18 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     // get on value from specified ttl type index
     int32_t GetIndex(const ::openmldb::api::GetRequest* request, const ::openmldb::api::TableMeta& meta,
-                     const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, CombineIterator* combine_it,
+                     const std::shared_ptr<Table>& table, CombineIterator* combine_it,
                      std::string* value, uint64_t* ts);
 
     // scan specified ttl type index
     int32_t ScanIndex(const ::openmldb::api::ScanRequest* request, const ::openmldb::api::TableMeta& meta,
-                      const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, CombineIterator* combine_it,
+                      const std::shared_ptr<Table>& table, CombineIterator* combine_it,
                       std::string* pairs, uint32_t* count);
 
+    // the rows are appended by the appender if it is set, which refers to them rather than copies
     int32_t ScanIndex(const ::openmldb::api::ScanRequest* request, const ::openmldb::api::TableMeta& meta,
-                      const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, CombineIterator* combine_it,
-                      butil::IOBuf* buf, uint32_t* count);
+                      const std::shared_ptr<Table>& table, CombineIterator* combine_it,
+                      butil::IOBuf* buf, ::openmldb::codec::RowRefAppender* appender, uint32_t* count);
 
     int32_t CountIndex(uint64_t expire_time, uint64_t expire_cnt, ::openmldb::storage::TTLType ttl_type,
                        ::openmldb::storage::TableIterator* it, const ::openmldb::api::CountRequest* request,
@@ -261,6 +326,14 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     std::shared_ptr<Table> GetTable(uint32_t tid, uint32_t pid);
 
+    // no heartbeat of nameserver came in the lease timeout, so the leader tables may be failed over already and
+    // take no writes
+    bool IsLeaseExpired() const;
+
+    // the leader table to delete the keys of idx_name from, null with the error set in response if not available
+    std::shared_ptr<Table> GetDeleteTable(uint32_t tid, uint32_t pid, const std::string& idx_name, uint32_t* idx,
+                                          ::openmldb::api::GeneralResponse* response);
+
     void CreateProcedure(RpcController* controller, const openmldb::api::CreateProcedureRequest* request,
                          openmldb::api::GeneralResponse* response, Closure* done);
 
@@ -283,6 +356,11 @@ class TabletImpl : public ::openmldb::api::TabletServer {
                                 ::openmldb::api::DeployStatsResponse* response,
                                 ::google::protobuf::Closure* done) override;
 
+    void GetDeployProfile(::google::protobuf::RpcController* controller,
+                          const ::openmldb::api::DeployProfileRequest* request,
+                          ::openmldb::api::DeployProfileResponse* response,
+                          ::google::protobuf::Closure* done) override;
+
  private:
     bool CreateMultiDir(const std::vector<std::string>& dirs);
     // Get table by table id , no need external synchronization
@@ -299,6 +377,23 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     std::shared_ptr<Aggrs> GetAggregatorsUnLock(uint32_t tid, uint32_t pid);
 
+    // pin the read seqs of all the memory tables of the tablet at once
+    void PinReadSnapshot(::openmldb::storage::ReadSnapshot* snapshot);
+
+    // publish the partitions to table_registry_ after tables_, replicators_, snapshots_ or aggregators_ changes,
+    // spin_mutex_ must be held
+    void PublishTablesUnLock();
+
+    // run the task on the workers of the numa node of the partition, so the memory of its segments stays on
+    // the node. return false if the task should run on the current thread
+    bool DispatchToNumaNode(uint32_t tid, uint32_t pid, const ::openmldb::base::TaskPool::Task& task);
+
+    // queue the query task to query_pool_, return false if the queue is full
+    bool DispatchQuery(const ::openmldb::base::TaskPool::Task& task);
+    // called by a query task once it is taken by a query worker, return false if the deadline passed in the queue
+    bool StartQueryTask(absl::Time enqueue_time, std::chrono::steady_clock::time_point deadline,
+                        AdmissionController::Ticket* ticket);
+
     void GcTable(uint32_t tid, uint32_t pid, bool execute_once);
 
     void GcTableSnapshot(uint32_t tid, uint32_t pid);
@@ -308,6 +403,9 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     int CreateTableInternal(const ::openmldb::api::TableMeta* table_meta, std::string& msg);  // NOLINT
 
+    // create the table of table_meta on this tablet with its binlog, snapshot and the background tasks
+    base::Status CreateLocalTable(const ::openmldb::api::TableMeta* table_meta);
+
     void MakeSnapshotInternal(uint32_t tid, uint32_t pid, uint64_t end_offset,
                               std::shared_ptr<::openmldb::api::TaskInfo> task);
 
@@ -332,12 +430,41 @@ class TabletImpl : public ::openmldb::api::TabletServer {
                                   ::openmldb::common::ColumnKey& column_key, uint32_t idx,  // NOLINT
                                   uint32_t partition_num, std::shared_ptr<::openmldb::api::TaskInfo> task);
 
+    // copy the keys of the table routed to child_pid by router to the child partition
+    void SplitTableInternal(std::shared_ptr<::openmldb::storage::Table> table, uint32_t child_pid,
+                            std::shared_ptr<const ::openmldb::base::PartitionRouter> router,
+                            std::shared_ptr<::openmldb::api::TaskInfo> task);
+
+    // delete the keys of the table not routed to it by router
+    void DeleteSplitDataInternal(std::shared_ptr<::openmldb::storage::Table> table,
+                                 std::shared_ptr<const ::openmldb::base::PartitionRouter> router,
+                                 std::shared_ptr<::openmldb::api::TaskInfo> task);
+
+    // the router of the partition split, null if it is not split on this tablet
+    std::shared_ptr<const ::openmldb::base::PartitionRouter> GetSplitRouter(uint32_t tid, uint32_t pid);
+
+    // put the dimensions of request routed to the children to them and leave the others in rest, return false
+    // if none is left or a child fails, the response is set then
+    bool ForwardSplitPut(const ::openmldb::base::PartitionRouter& router, const ::openmldb::api::PutRequest& request,
+                         ::openmldb::api::PutRequest* rest, ::openmldb::api::PutResponse* response);
+
     void SchedMakeSnapshot();
 
     void GetDiskused();
 
+    // update the write throttler with the memory of the tablet and the follower lag of the leader partitions
+    void SchedWriteThrottle();
+
+    // check the put of rows to the partition with the write throttler, the response is set if it is rejected
+    bool AcquireWrite(uint32_t tid, uint32_t pid, uint64_t rows, ::openmldb::api::PutResponse* response);
+
     void CheckZkClient();
 
+    // merge the table changed notifies in a short time into one RefreshTableInfo
+    void ScheduleRefreshTableInfo();
+
+    void RunRefreshTableInfo();
+
     void RefreshTableInfo();
 
     void UpdateGlobalVarTable();
@@ -368,6 +495,11 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     int GetTaskStatus(std::shared_ptr<::openmldb::api::TaskInfo>& task_ptr,  // NOLINT
                       ::openmldb::api::TaskStatus* status);
 
+    // tell the nameserver that the task is finished, mu_ should be held
+    void NotifyTaskFinished(const std::shared_ptr<::openmldb::api::TaskInfo>& task_ptr);
+
+    void SendTaskNotify(const std::string& ns_endpoint);
+
     std::shared_ptr<::openmldb::api::TaskInfo> FindTask(uint64_t op_id, ::openmldb::api::TaskType task_type);
 
     int AddOPMultiTask(const ::openmldb::api::TaskInfo& task_info, ::openmldb::api::TaskType task_type,
@@ -408,11 +540,39 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     bool GetRealEp(uint64_t tid, uint64_t pid, std::map<std::string, std::string>* real_ep_map);
 
+    void ProcessGet(const ::openmldb::api::GetRequest* request, ::openmldb::api::GetResponse* response);
+
+    // write one row to the leader partition and append it to the binlog, the replicator is returned to be
+    // notified by the caller
+    // write the rows of a disk table as sst files and ingest them, the rows are appended to the binlog too
+    void DiskBulkLoad(const std::shared_ptr<Table>& table, const ::openmldb::api::BulkLoadRequest* request,
+                      ::openmldb::api::GeneralResponse* response);
+
+    std::shared_ptr<LogReplicator> ProcessPut(const ::openmldb::api::PutRequest* request,
+                                              ::openmldb::api::PutResponse* response);
+
+    // write the rows of one partition with one batch put to the table and one binlog append, the response of
+    // each row is set at the same position of responses
+    std::shared_ptr<LogReplicator> ProcessPartitionPut(
+        uint32_t tid, uint32_t pid, const ::google::protobuf::RepeatedPtrField<::openmldb::api::PutRequest>& requests,
+        const std::vector<int>& rows, ::google::protobuf::RepeatedPtrField<::openmldb::api::PutResponse>* responses);
+
+    // the query is aborted with kQueryDeadlineExceeded once the deadline passes
     void ProcessQuery(RpcController* controller, const openmldb::api::QueryRequest* request,
-                      ::openmldb::api::QueryResponse* response, butil::IOBuf* buf);
+                      ::openmldb::api::QueryResponse* response, butil::IOBuf* buf,
+                      std::chrono::steady_clock::time_point deadline);
+    // send the next chunk of the output rows kept under the result id
+    void FetchQueryResult(const openmldb::api::QueryRequest* request, ::openmldb::api::QueryResponse* response,
+                          butil::IOBuf* buf);
+    // check the follower read of the query and run it
+    void ExecuteQuery(RpcController* controller, const openmldb::api::QueryRequest* request,
+                      ::openmldb::api::QueryResponse* response, std::chrono::steady_clock::time_point deadline);
+    // a hedged request is only served by the follower close enough to the leader
+    bool CheckFollowerRead(const ::openmldb::api::FollowerRead& follower_read, std::string* msg);
     void ProcessBatchRequestQuery(RpcController* controller, const openmldb::api::SQLBatchRequestQueryRequest* request,
                                   openmldb::api::SQLBatchRequestQueryResponse* response,
-                                  butil::IOBuf& buf);  // NOLINT
+                                  butil::IOBuf& buf,  // NOLINT
+                                  std::chrono::steady_clock::time_point deadline);
 
     bool UpdateAggrs(uint32_t tid, uint32_t pid, const std::string& value,
                      const ::openmldb::storage::Dimensions& dimensions, uint64_t log_offset);
@@ -431,9 +591,51 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     // collect deploy statistics into memory
     void TryCollectDeployStats(const std::string& db, const std::string& name, absl::Time start_time);
 
+    // collect the latency of a procedure for the metrics, unlike the deploy stats it is never flushed
+    void CollectDeployMetrics(const std::string& db, const std::string& name, absl::Time start_time);
+
+    // the runner profile aggregated over the runs of a deployment, null if --enable_deploy_profile is off
+    std::shared_ptr<::hybridse::vm::RunnerProfile> GetDeployProfile(const std::string& db, const std::string& name);
+
+    // the stages are marked in trace
     void RunRequestQuery(RpcController* controller, const openmldb::api::QueryRequest& request,
-                         ::hybridse::vm::RequestRunSession& session,                  // NOLINT
-                         openmldb::api::QueryResponse& response, butil::IOBuf& buf);  // NOLINT
+                         ::hybridse::vm::RequestRunSession& session,                 // NOLINT
+                         openmldb::api::QueryResponse& response, butil::IOBuf& buf,  // NOLINT
+                         SlowTrace* trace);
+
+    // run the procedure query through result_cache_, the hits skip the runner
+    void RunCachedRequestQuery(RpcController* controller, const openmldb::api::QueryRequest& request,
+                               ::hybridse::vm::RequestRunSession& session,                 // NOLINT
+                               openmldb::api::QueryResponse& response, butil::IOBuf& buf,  // NOLINT
+                               SlowTrace* trace);
+
+    void AddResultCacheDeployment(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info);
+
+    void AddMaterializedView(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info);
+
+    // compute the outputs of the materialized deployments of the table for the row before it is put
+    void RunMaterializedViews(const std::shared_ptr<Table>& table, const std::string& value,
+                              std::vector<MaterializedUpdate>* updates);
+
+    // the output of the deployment with the put row as the request row, null if the query fails
+    std::shared_ptr<MaterializedView::Output> RunMaterializedView(const MaterializedView& view, uint32_t tid,
+                                                                  uint32_t pid, const std::string& value,
+                                                                  uint64_t ts);
+
+    // drop the outputs of the keys of the rows put in batch, which are computed by their next requests instead
+    void EraseMaterializedViews(const std::shared_ptr<Table>& table, const std::string& value);
+
+    // answer the procedure query of ts 0 by the output of the last put of its key, false if it is missing
+    bool LookupMaterializedView(RpcController* controller, const openmldb::api::QueryRequest& request,
+                                openmldb::api::QueryResponse& response, butil::IOBuf& buf,  // NOLINT
+                                SlowTrace* trace);
+
+    // the batch request plan of a deployment, compiled on the first batch request call if it is lazy.
+    // return null if the eager compile fails
+    std::shared_ptr<LazyCompileInfo> BuildBatchRequestInfo(
+        const std::string& sql, const std::string& db,
+        const std::shared_ptr<std::unordered_map<std::string, std::string>>& options,
+        const std::set<size_t>& common_column_indices, ::hybridse::base::Status* status);
 
     void CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info);
 
@@ -444,16 +646,38 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     Tables tables_;
     std::mutex mu_;
     SpinMutex spin_mutex_;
-    ThreadPool gc_pool_;
+    // (tid, pid) -> the router of the partitions split on this tablet, to forward the puts of the stale clients
+    std::map<std::pair<uint32_t, uint32_t>, std::shared_ptr<const ::openmldb::base::PartitionRouter>> split_routers_;
     Replicators replicators_;
     Snapshots snapshots_;
     Aggregators aggregators_;
+    // the copy of the partitions above for GetTable, GetReplicator, GetSnapshot and GetAggregators without
+    // spin_mutex_
+    TableRegistry table_registry_;
     ZkClient* zk_client_;
     ThreadPool keep_alive_pool_;
     ThreadPool task_pool_;
     ThreadPool io_pool_;
-    ThreadPool snapshot_pool_;
+    // the gc, snapshot, binlog deleting, index building and file sending tasks share the workers of it
+    ::openmldb::base::TaskScheduler background_pool_;
+    // loads the partitions by priority under the recover budget
+    RecoveryScheduler recovery_scheduler_;
+    // frees the memory of the dropped partitions off the drop, null if drop_table_reclaim_key_cnt is 0
+    std::unique_ptr<TableReclaimer> table_reclaimer_;
+    // "db.table" -> the recover priority of it, from recover_priority_tables
+    std::map<std::string, int32_t> recover_priorities_;
+    // update the pre-aggr tables off the put path, null if aggr_update_pool_size is 0
+    std::unique_ptr<ThreadPool> aggr_pool_;
+    // the workers bound to each numa node, empty if numa_worker_thread_num is 0 or not a numa machine
+    std::vector<std::unique_ptr<::openmldb::base::TaskPool>> numa_pools_;
+    // runs the queries from the clients off the rpc workers, null if query_worker_thread_num is 0
+    std::unique_ptr<::openmldb::base::TaskPool> query_pool_;
+    std::atomic<uint64_t> query_rejected_cnt_;
+    ::openmldb::statistics::TimeCollector query_queue_time_;
     std::map<uint64_t, std::list<std::shared_ptr<::openmldb::api::TaskInfo>>> task_map_;
+    std::mutex notify_mu_;
+    std::string notify_ns_endpoint_;
+    std::shared_ptr<::openmldb::RpcClient<::openmldb::nameserver::NameServer_Stub>> notify_client_;
     std::set<std::string> sync_snapshot_set_;
     std::map<std::string, std::shared_ptr<FileReceiver>> file_receiver_map_;
     BulkLoadMgr bulk_load_mgr_;
@@ -462,6 +686,14 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     std::map<::openmldb::common::StorageMode, std::vector<std::string>>
         mode_recycle_root_paths_;
     std::atomic<bool> follower_;
+    // the time in ms of the last heartbeat of nameserver and the lease timeout it set, see IsLeaseExpired
+    std::atomic<uint64_t> lease_time_{0};
+    std::atomic<uint32_t> lease_timeout_{0};
+    // a refresh of table info is scheduled and not started yet
+    std::atomic<bool> table_refresh_pending_;
+    std::mutex table_refresh_mu_;
+    // the table notify version of the last refresh, guarded by table_refresh_mu_
+    uint64_t table_info_version_;
     std::shared_ptr<std::map<std::string, std::string>> real_ep_map_;
     // thread safe
     std::shared_ptr<::openmldb::catalog::TabletCatalog> catalog_;
@@ -472,6 +704,21 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     std::string zk_path_;
     std::string endpoint_;
     std::shared_ptr<SpCache> sp_cache_;
+    std::unique_ptr<ResultCache> result_cache_;
+    std::unique_ptr<MaterializedViews> materialized_views_;
+    // the batch queries prepared by the sdk
+    std::unique_ptr<StatementCache> statement_cache_;
+    // the traverse iterators kept between the pages
+    std::unique_ptr<TraverseCursors> traverse_cursors_;
+    // the output rows of the batch queries not fetched yet
+    std::unique_ptr<QueryResultCursors> query_result_cursors_;
+    // the stages of the latest slow puts and queries
+    std::unique_ptr<SlowTraceRing> slow_traces_;
+    std::unique_ptr<AdmissionController> admission_;
+    // null if no write throttle limit is set
+    std::unique_ptr<WriteThrottler> write_throttler_;
+    // (tid, pid) -> the binlog offset of the leader partitions at the last write throttle check
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> write_offsets_;
     std::string notify_path_;
     std::string sp_root_path_;
     std::string globalvar_changed_notify_path_;
@@ -480,6 +727,13 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     std::shared_ptr<std::map<std::string, std::string>> global_variables_;
 
     std::unique_ptr<openmldb::statistics::DeployQueryTimeCollector> deploy_collector_;
+    // the cumulative latencies of the procedures and the binlog appends of the puts for the metrics
+    std::unique_ptr<openmldb::statistics::DeployQueryTimeCollector> deploy_metrics_;
+    ::openmldb::statistics::TimeCollector binlog_append_time_;
+
+    std::mutex deploy_profile_mu_;
+    // db -> deployment -> profile
+    std::map<std::string, std::map<std::string, std::shared_ptr<::hybridse::vm::RunnerProfile>>> deploy_profiles_;
 };
 
 }  // namespace tablet
@@ -126,7 +126,7 @@ void RunGetTimeIndexAssert(std::vector<QueryIt>* q_its, uint64_t base_ts, uint64
     int32_t code = 0;
     ::openmldb::api::TableMeta meta = GetTableMeta();
     ::openmldb::codec::SDKCodec sdk_codec(meta);
-    std::map<int32_t, std::shared_ptr<Schema>> vers_schema = q_its->begin()->table->GetAllVersionSchema();
+    std::shared_ptr<::openmldb::storage::Table> table = q_its->begin()->table;
     ::openmldb::storage::TTLSt ttl(expired_ts, 0, ::openmldb::storage::kAbsoluteTime);
     ttl.abs_ttl = expired_ts;
     // get the st kSubKeyGt
@@ -139,7 +139,7 @@ void RunGetTimeIndexAssert(std::vector<QueryIt>* q_its, uint64_t base_ts, uint64
         request.set_et_type(::openmldb::api::GetType::kSubKeyEq);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         std::vector<std::string> row;
         sdk_codec.DecodeRow(value, &row);
         ASSERT_EQ(0, code);
@@ -157,7 +157,7 @@ void RunGetTimeIndexAssert(std::vector<QueryIt>* q_its, uint64_t base_ts, uint64
         request.set_et_type(::openmldb::api::GetType::kSubKeyGe);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(0, code);
         ASSERT_EQ(ts, 100 + base_ts);
         std::vector<std::string> row;
@@ -175,7 +175,7 @@ void RunGetTimeIndexAssert(std::vector<QueryIt>* q_its, uint64_t base_ts, uint64
         request.set_et_type(::openmldb::api::GetType::kSubKeyGe);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(0, code);
         ASSERT_EQ(ts, 900 + base_ts);
         std::vector<std::string> row;
@@ -193,7 +193,7 @@ void RunGetTimeIndexAssert(std::vector<QueryIt>* q_its, uint64_t base_ts, uint64
         request.set_et_type(::openmldb::api::GetType::kSubKeyGe);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(0, code);
         ASSERT_EQ(ts, 800 + base_ts);
         std::vector<std::string> row;
@@ -211,7 +211,7 @@ void RunGetTimeIndexAssert(std::vector<QueryIt>* q_its, uint64_t base_ts, uint64
         request.set_et_type(::openmldb::api::GetType::kSubKeyGe);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(0, code);
         ASSERT_EQ(ts, 800 + base_ts);
         std::vector<std::string> row;
@@ -229,7 +229,7 @@ void RunGetTimeIndexAssert(std::vector<QueryIt>* q_its, uint64_t base_ts, uint64
         request.set_et_type(::openmldb::api::GetType::kSubKeyGt);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(1, code);
     }
 }
@@ -241,7 +241,7 @@ void RunGetLatestIndexAssert(std::vector<QueryIt>* q_its) {
     int32_t code = 0;
     ::openmldb::api::TableMeta meta = GetTableMeta();
     ::openmldb::codec::SDKCodec sdk_codec(meta);
-    std::map<int32_t, std::shared_ptr<Schema>> vers_schema = q_its->begin()->table->GetAllVersionSchema();
+    std::shared_ptr<::openmldb::storage::Table> table = q_its->begin()->table;
     ::openmldb::storage::TTLSt ttl(0, 10, ::openmldb::storage::kLatestTime);
     // get the st kSubKeyGt
     {
@@ -253,7 +253,7 @@ void RunGetLatestIndexAssert(std::vector<QueryIt>* q_its) {
         request.set_et_type(::openmldb::api::GetType::kSubKeyEq);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(0, code);
         ASSERT_EQ((int64_t)ts, 1900);
         std::vector<std::string> row;
@@ -270,7 +270,7 @@ void RunGetLatestIndexAssert(std::vector<QueryIt>* q_its) {
         request.set_et_type(::openmldb::api::GetType::kSubKeyEq);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(0, code);
         ASSERT_EQ((int64_t)ts, 1100);
         std::vector<std::string> row;
@@ -287,7 +287,7 @@ void RunGetLatestIndexAssert(std::vector<QueryIt>* q_its) {
         request.set_et_type(::openmldb::api::GetType::kSubKeyEq);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(-1, code);
     }
 
@@ -300,7 +300,7 @@ void RunGetLatestIndexAssert(std::vector<QueryIt>* q_its) {
         request.set_et_type(::openmldb::api::GetType::kSubKeyEq);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(-1, code);
     }
 
@@ -313,7 +313,7 @@ void RunGetLatestIndexAssert(std::vector<QueryIt>* q_its) {
         request.set_et_type(::openmldb::api::GetType::kSubKeyEq);
         CombineIterator combine_it(*q_its, request.ts(), request.type(), ttl);
         combine_it.SeekToFirst();
-        code = tablet_impl.GetIndex(&request, meta, vers_schema, &combine_it, &value, &ts);
+        code = tablet_impl.GetIndex(&request, meta, table, &combine_it, &value, &ts);
         ASSERT_EQ(0, code);
         ASSERT_EQ((signed)ts, 1200);
         std::vector<std::string> row;
@@ -23,8 +23,10 @@
 #include <sys/stat.h>
 
 #include <algorithm>
+#include <set>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
 #include "base/kv_iterator.h"
@@ -39,6 +41,7 @@
 #include "log/log_writer.h"
 #include "proto/tablet.pb.h"
 #include "proto/type.pb.h"
+#include "sdk/bulk_load_builder.h"
 #include "test/util.h"
 
 DECLARE_string(db_root_path);
@@ -57,6 +60,7 @@ DECLARE_string(recycle_bin_ssd_root_path);
 DECLARE_string(recycle_bin_hdd_root_path);
 DECLARE_string(endpoint);
 DECLARE_uint32(recycle_ttl);
+DECLARE_uint32(cold_row_age_min);
 
 namespace openmldb {
 namespace tablet {
@@ -398,6 +402,185 @@ TEST_F(TabletImplTest, ChangeRole) {
     }
 }
 
+TEST_F(TabletImplTest, LeaseExpired) {
+    TabletImpl tablet;
+    tablet.Init("");
+    MockClosure closure;
+    uint32_t id = counter++;
+    ASSERT_EQ(0, CreateDefaultTable("db0", "t0", id, 0, 0, 0, ::openmldb::type::TTLType::kLatestTime, common::kMemory,
+                                    &tablet));
+    auto put = [&tablet, id](const std::string& key) {
+        ::openmldb::api::PutRequest request;
+        PackDefaultDimension(key, &request);
+        request.set_value(::openmldb::test::EncodeKV(key, "value"));
+        request.set_time(9527);
+        request.set_tid(id);
+        request.set_pid(0);
+        ::openmldb::api::PutResponse response;
+        MockClosure closure;
+        tablet.Put(NULL, &request, &response, &closure);
+        return response.code();
+    };
+    auto heartbeat = [&tablet](uint32_t lease_timeout) {
+        ::openmldb::api::HeartbeatRequest request;
+        request.set_lease_timeout(lease_timeout);
+        ::openmldb::api::GeneralResponse response;
+        MockClosure closure;
+        tablet.Heartbeat(NULL, &request, &response, &closure);
+        return response.code();
+    };
+    // no lease is taken until the first heartbeat
+    ASSERT_EQ(0, put("key1"));
+    ASSERT_EQ(0, heartbeat(200));
+    ASSERT_EQ(0, put("key2"));
+    usleep(300 * 1000);
+    ASSERT_EQ(::openmldb::base::ReturnCode::kTableIsFollower, put("key3"));
+    ::openmldb::api::DeleteRequest request;
+    request.set_tid(id);
+    request.set_pid(0);
+    request.set_key("key1");
+    ::openmldb::api::GeneralResponse response;
+    tablet.Delete(NULL, &request, &response, &closure);
+    ASSERT_EQ(::openmldb::base::ReturnCode::kTableIsFollower, response.code());
+    // renewed
+    ASSERT_EQ(0, heartbeat(200));
+    ASSERT_EQ(0, put("key3"));
+    // the heartbeats are off
+    usleep(300 * 1000);
+    ASSERT_EQ(0, heartbeat(0));
+    usleep(300 * 1000);
+    ASSERT_EQ(0, put("key4"));
+}
+
+TEST_F(TabletImplTest, ScanColdRowsWithAttachment) {
+    TabletImpl tablet;
+    tablet.Init("");
+    uint32_t id = counter++;
+    FLAGS_cold_row_age_min = 1;
+    ASSERT_EQ(0, CreateDefaultTable("db0", "t0", id, 0, 0, 0, ::openmldb::type::TTLType::kAbsoluteTime,
+                                    common::kMemory, &tablet));
+    FLAGS_cold_row_age_min = 0;
+    // the rows are big enough to be sent by reference, and are put 10 minutes ago, so they are cold
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    std::string expected;
+    for (int i = 0; i < 10; i++) {
+        std::string value = std::string(2048, 'a' + i) + std::to_string(i);
+        ASSERT_EQ(0, PutKVData(id, 0, "key1", value, now - 10 * 60 * 1000 + i, &tablet));
+        // the rows are scanned in the desc order of the time
+        expected = ::openmldb::test::EncodeKV("key1", value) + expected;
+    }
+    auto table = std::dynamic_pointer_cast<::openmldb::storage::MemTable>(tablet.GetTable(id, 0));
+    ASSERT_TRUE(table && table->GetColdCodec() != nullptr);
+    table->SchedGc();
+    ASSERT_EQ(10u, table->GetGcStat().GetColdRowCnt());
+
+    ::openmldb::api::ScanRequest sr;
+    sr.set_tid(id);
+    sr.set_pid(0);
+    sr.set_pk("key1");
+    sr.set_st(0);
+    sr.set_et(0);
+    sr.set_use_attachment(true);
+    ::openmldb::api::ScanResponse srp;
+    MockClosure closure;
+    brpc::Controller cntl;
+    tablet.Scan(&cntl, &sr, &srp, &closure);
+    ASSERT_EQ(0, srp.code());
+    ASSERT_EQ(10u, srp.count());
+    // the cold rows are decoded into the buffer of the iterator, so they are copied rather than referred to
+    ASSERT_EQ(expected, cntl.response_attachment().to_string());
+}
+
+TEST_F(TabletImplTest, Metrics) {
+    TabletImpl tablet;
+    tablet.Init("");
+    MockClosure closure;
+    uint32_t id = counter++;
+    ASSERT_EQ(0, CreateDefaultTable("db0", "t0", id, 0, 0, 0, ::openmldb::type::TTLType::kLatestTime, common::kMemory,
+                                    &tablet));
+    ASSERT_EQ(0, PutKVData(id, 0, "key1", "value1", 1, &tablet));
+    ASSERT_EQ(0, PutKVData(id, 0, "key2", "value2", 2, &tablet));
+    for (int i = 0; i < 2; i++) {
+        ::openmldb::api::QueryRequest request;
+        request.set_db("db0");
+        request.set_sql("select * from t0;");
+        request.set_is_batch(true);
+        request.set_parameter_row_size(0);
+        request.set_parameter_row_slices(1);
+        ::openmldb::api::QueryResponse response;
+        brpc::Controller cntl;
+        tablet.Query(&cntl, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+    }
+    ::openmldb::api::HttpRequest request;
+    ::openmldb::api::HttpResponse response;
+    brpc::Controller cntl;
+    tablet.Metrics(&cntl, &request, &response, &closure);
+    std::string metrics = cntl.response_attachment().to_string();
+    std::string labels = absl::StrCat("{db=\"db0\",table=\"t0\",tid=\"", id, "\",pid=\"0\",role=\"leader\"}");
+    ASSERT_NE(std::string::npos, metrics.find("openmldb_table_rows" + labels + " 2\n")) << metrics;
+    ASSERT_NE(std::string::npos, metrics.find("openmldb_table_keys" + labels + " 2\n")) << metrics;
+    ASSERT_NE(std::string::npos, metrics.find("openmldb_gc_rounds_total" + labels + " 0\n")) << metrics;
+    ASSERT_NE(std::string::npos, metrics.find("openmldb_binlog_append_seconds_count 2\n")) << metrics;
+    ASSERT_NE(std::string::npos, metrics.find("openmldb_compile_cache_lookups_total{result=\"hit\"}")) << metrics;
+    ASSERT_NE(std::string::npos, metrics.find("# TYPE openmldb_deploy_seconds histogram\n")) << metrics;
+}
+
+TEST_F(TabletImplTest, QueryResultChunks) {
+    TabletImpl tablet;
+    tablet.Init("");
+    MockClosure closure;
+    uint32_t id = counter++;
+    ASSERT_EQ(0, CreateDefaultTable("db0", "t0", id, 0, 0, 0, ::openmldb::type::TTLType::kLatestTime, common::kMemory,
+                                    &tablet));
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(0, PutKVData(id, 0, "key" + std::to_string(i), "value" + std::to_string(i), i + 1, &tablet));
+    }
+    ::openmldb::api::QueryRequest request;
+    request.set_db("db0");
+    request.set_sql("select * from t0;");
+    request.set_is_batch(true);
+    request.set_parameter_row_size(0);
+    request.set_parameter_row_slices(1);
+    // a chunk is cut once it is over the bytes, so every chunk has one row
+    request.set_chunk_bytes(1);
+    ::openmldb::api::QueryResponse response;
+    brpc::Controller cntl;
+    tablet.Query(&cntl, &request, &response, &closure);
+    ASSERT_EQ(0, response.code());
+    ASSERT_EQ(1u, response.count());
+    ASSERT_EQ(10u, response.total_count());
+    ASSERT_NE(0u, response.result_id());
+    uint64_t result_id = response.result_id();
+    uint32_t total = response.count();
+    while (result_id != 0) {
+        ::openmldb::api::QueryRequest fetch_request;
+        fetch_request.set_result_id(result_id);
+        fetch_request.set_chunk_bytes(1);
+        ::openmldb::api::QueryResponse fetch_response;
+        brpc::Controller fetch_cntl;
+        tablet.Query(&fetch_cntl, &fetch_request, &fetch_response, &closure);
+        ASSERT_EQ(0, fetch_response.code());
+        ASSERT_EQ(1u, fetch_response.count());
+        ASSERT_EQ(response.schema(), fetch_response.schema());
+        ASSERT_EQ(fetch_response.byte_size(), fetch_cntl.response_attachment().size());
+        total += fetch_response.count();
+        // the rows are kept under the same id until all are fetched
+        if (fetch_response.result_id() != 0) {
+            ASSERT_EQ(result_id, fetch_response.result_id());
+        }
+        result_id = fetch_response.result_id();
+    }
+    ASSERT_EQ(10u, total);
+    // the rows are released once all are fetched
+    ::openmldb::api::QueryRequest fetch_request;
+    fetch_request.set_result_id(response.result_id());
+    ::openmldb::api::QueryResponse fetch_response;
+    brpc::Controller fetch_cntl;
+    tablet.Query(&fetch_cntl, &fetch_request, &fetch_response, &closure);
+    ASSERT_EQ(::openmldb::base::kQueryResultNotFound, fetch_response.code());
+}
+
 TEST_P(TabletImplTest, CountLatestTable) {
     ::openmldb::common::StorageMode storage_mode = GetParam();
     TabletImpl tablet;
@@ -951,6 +1134,209 @@ TEST_P(TabletImplTest, Get) {
     }
 }
 
+TEST_P(TabletImplTest, BatchGet) {
+    ::openmldb::common::StorageMode storage_mode = GetParam();
+    TabletImpl tablet;
+    tablet.Init("");
+    uint32_t id = counter++;
+    for (uint32_t pid = 0; pid < 2; pid++) {
+        ::openmldb::api::CreateTableRequest request;
+        ::openmldb::api::TableMeta* table_meta = request.mutable_table_meta();
+        table_meta->set_name("t0");
+        table_meta->set_tid(id);
+        table_meta->set_pid(pid);
+        table_meta->set_storage_mode(storage_mode);
+        table_meta->set_mode(::openmldb::api::TableMode::kTableLeader);
+        AddDefaultSchema(0, 0, ::openmldb::type::TTLType::kAbsoluteTime, table_meta);
+        ::openmldb::api::CreateTableResponse response;
+        MockClosure closure;
+        tablet.CreateTable(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+    }
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    for (uint32_t i = 0; i < 10; i++) {
+        std::string key = "key" + std::to_string(i);
+        ::openmldb::api::PutRequest prequest;
+        PackDefaultDimension(key, &prequest);
+        prequest.set_time(now);
+        prequest.set_value(::openmldb::test::EncodeKV(key, "value" + std::to_string(i)));
+        prequest.set_tid(id);
+        prequest.set_pid(i % 2);
+        ::openmldb::api::PutResponse presponse;
+        MockClosure closure;
+        tablet.Put(NULL, &prequest, &presponse, &closure);
+        ASSERT_EQ(0, presponse.code());
+    }
+    ::openmldb::api::BatchGetRequest request;
+    for (uint32_t i = 0; i < 10; i++) {
+        auto get_request = request.add_requests();
+        get_request->set_tid(id);
+        get_request->set_pid((9 - i) % 2);
+        get_request->set_key("key" + std::to_string(9 - i));
+        get_request->set_ts(0);
+    }
+    // the key in the other partition is not found
+    auto get_request = request.add_requests();
+    get_request->set_tid(id);
+    get_request->set_pid(1);
+    get_request->set_key("key0");
+    // the table is not found
+    get_request = request.add_requests();
+    get_request->set_tid(id + 10000);
+    get_request->set_pid(0);
+    get_request->set_key("key0");
+    ::openmldb::api::BatchGetResponse response;
+    MockClosure closure;
+    tablet.BatchGet(NULL, &request, &response, &closure);
+    ASSERT_EQ(0, response.code());
+    ASSERT_EQ(12, response.responses_size());
+    for (uint32_t i = 0; i < 10; i++) {
+        const auto& get_response = response.responses(i);
+        ASSERT_EQ(0, get_response.code());
+        ASSERT_EQ("value" + std::to_string(9 - i), ::openmldb::test::DecodeV(get_response.value()));
+    }
+    ASSERT_EQ(109, response.responses(10).code());
+    ASSERT_EQ(100, response.responses(11).code());
+}
+
+TEST_P(TabletImplTest, BatchPut) {
+    ::openmldb::common::StorageMode storage_mode = GetParam();
+    TabletImpl tablet;
+    tablet.Init("");
+    uint32_t id = counter++;
+    for (uint32_t pid = 0; pid < 2; pid++) {
+        ::openmldb::api::CreateTableRequest request;
+        ::openmldb::api::TableMeta* table_meta = request.mutable_table_meta();
+        table_meta->set_name("t0");
+        table_meta->set_tid(id);
+        table_meta->set_pid(pid);
+        table_meta->set_storage_mode(storage_mode);
+        table_meta->set_mode(::openmldb::api::TableMode::kTableLeader);
+        AddDefaultSchema(0, 0, ::openmldb::type::TTLType::kAbsoluteTime, table_meta);
+        ::openmldb::api::CreateTableResponse response;
+        MockClosure closure;
+        tablet.CreateTable(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+    }
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    ::openmldb::api::BatchPutRequest request;
+    for (uint32_t i = 0; i < 10; i++) {
+        std::string key = "key" + std::to_string(i);
+        auto put_request = request.add_requests();
+        PackDefaultDimension(key, put_request);
+        put_request->set_time(now);
+        put_request->set_value(::openmldb::test::EncodeKV(key, "value" + std::to_string(i)));
+        put_request->set_tid(id);
+        put_request->set_pid(i % 2);
+    }
+    // the table is not found
+    auto put_request = request.add_requests();
+    PackDefaultDimension("key0", put_request);
+    put_request->set_time(now);
+    put_request->set_value(::openmldb::test::EncodeKV("key0", "value0"));
+    put_request->set_tid(id + 10000);
+    put_request->set_pid(0);
+    ::openmldb::api::BatchPutResponse response;
+    MockClosure closure;
+    tablet.BatchPut(NULL, &request, &response, &closure);
+    ASSERT_EQ(0, response.code());
+    ASSERT_EQ(11, response.responses_size());
+    for (uint32_t i = 0; i < 10; i++) {
+        ASSERT_EQ(0, response.responses(i).code());
+    }
+    ASSERT_EQ(100, response.responses(10).code());
+    for (uint32_t i = 0; i < 10; i++) {
+        ::openmldb::api::GetRequest get_request;
+        get_request.set_tid(id);
+        get_request.set_pid(i % 2);
+        get_request.set_key("key" + std::to_string(i));
+        get_request.set_ts(0);
+        ::openmldb::api::GetResponse get_response;
+        tablet.Get(NULL, &get_request, &get_response, &closure);
+        ASSERT_EQ(0, get_response.code());
+        ASSERT_EQ("value" + std::to_string(i), ::openmldb::test::DecodeV(get_response.value()));
+    }
+}
+
+TEST_P(TabletImplTest, DeleteBatch) {
+    ::openmldb::common::StorageMode storage_mode = GetParam();
+    TabletImpl tablet;
+    tablet.Init("");
+    uint32_t id = counter++;
+    MockClosure closure;
+    {
+        ::openmldb::api::CreateTableRequest request;
+        ::openmldb::api::TableMeta* table_meta = request.mutable_table_meta();
+        table_meta->set_name("t0");
+        table_meta->set_tid(id);
+        table_meta->set_pid(0);
+        table_meta->set_storage_mode(storage_mode);
+        table_meta->set_mode(::openmldb::api::TableMode::kTableLeader);
+        AddDefaultSchema(0, 0, ::openmldb::type::TTLType::kAbsoluteTime, table_meta);
+        ::openmldb::api::CreateTableResponse response;
+        tablet.CreateTable(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+    }
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    {
+        ::openmldb::api::BatchPutRequest request;
+        for (uint32_t i = 0; i < 10; i++) {
+            std::string key = "key" + std::to_string(i);
+            auto put_request = request.add_requests();
+            PackDefaultDimension(key, put_request);
+            put_request->set_time(now);
+            put_request->set_value(::openmldb::test::EncodeKV(key, "value" + std::to_string(i)));
+            put_request->set_tid(id);
+            put_request->set_pid(0);
+        }
+        ::openmldb::api::BatchPutResponse response;
+        tablet.BatchPut(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+    }
+    {
+        ::openmldb::api::DeleteBatchRequest request;
+        request.set_tid(id);
+        request.set_pid(0);
+        for (uint32_t i = 0; i < 5; i++) {
+            request.add_keys("key" + std::to_string(i));
+        }
+        // not found, skipped by the memory table
+        request.add_keys("key100");
+        ::openmldb::api::GeneralResponse response;
+        tablet.DeleteBatch(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        if (storage_mode == ::openmldb::common::kMemory) {
+            ASSERT_EQ(5u, response.count());
+        } else {
+            ASSERT_GE(response.count(), 5u);
+        }
+    }
+    {
+        ::openmldb::api::DeleteBatchRequest request;
+        request.set_tid(id);
+        request.set_pid(0);
+        request.set_idx_name("no_such_idx");
+        request.add_keys("key5");
+        ::openmldb::api::GeneralResponse response;
+        tablet.DeleteBatch(NULL, &request, &response, &closure);
+        ASSERT_EQ(::openmldb::base::ReturnCode::kIdxNameNotFound, response.code());
+    }
+    for (uint32_t i = 0; i < 10; i++) {
+        ::openmldb::api::GetRequest get_request;
+        get_request.set_tid(id);
+        get_request.set_pid(0);
+        get_request.set_key("key" + std::to_string(i));
+        get_request.set_ts(0);
+        ::openmldb::api::GetResponse get_response;
+        tablet.Get(NULL, &get_request, &get_response, &closure);
+        if (i < 5) {
+            ASSERT_NE(0, get_response.code());
+        } else {
+            ASSERT_EQ(0, get_response.code());
+        }
+    }
+}
+
 
 TEST_P(TabletImplTest, UpdateTTLAbsoluteTime) {
     ::openmldb::common::StorageMode storage_mode = GetParam();
@@ -1634,6 +2020,86 @@ TEST_P(TabletImplTest, Traverse) {
     delete kv_it;
 }
 
+TEST_P(TabletImplTest, TraverseCursor) {
+    ::openmldb::common::StorageMode storage_mode = GetParam();
+    // the cursors only keep the iterators of memory tables
+    if (storage_mode != openmldb::common::kMemory) {
+        GTEST_SKIP();
+    }
+    uint32_t old_max_traverse = FLAGS_max_traverse_cnt;
+    FLAGS_max_traverse_cnt = 7;
+    TabletImpl tablet;
+    uint32_t id = counter++;
+    tablet.Init("");
+    ::openmldb::api::CreateTableRequest request;
+    ::openmldb::api::TableMeta* table_meta = request.mutable_table_meta();
+    table_meta->set_name("t0");
+    table_meta->set_tid(id);
+    table_meta->set_pid(1);
+    table_meta->set_storage_mode(storage_mode);
+    AddDefaultSchema(0, 0, ::openmldb::type::TTLType::kAbsoluteTime, table_meta);
+    ::openmldb::api::CreateTableResponse response;
+    MockClosure closure;
+    tablet.CreateTable(NULL, &request, &response, &closure);
+    ASSERT_EQ(0, response.code());
+    std::set<std::string> expected;
+    for (int key = 0; key < 10; key++) {
+        for (int ts = 1; ts <= key; ts++) {
+            ::openmldb::api::PutRequest prequest;
+            std::string pk = "key" + std::to_string(key);
+            PackDefaultDimension(pk, &prequest);
+            prequest.set_time(ts);
+            prequest.set_value(::openmldb::test::EncodeKV(pk, "value" + std::to_string(ts)));
+            prequest.set_tid(id);
+            prequest.set_pid(1);
+            ::openmldb::api::PutResponse presponse;
+            tablet.Put(NULL, &prequest, &presponse, &closure);
+            ASSERT_EQ(0, presponse.code());
+            expected.insert(pk + "|" + std::to_string(ts));
+        }
+    }
+    std::set<std::string> traversed;
+    uint64_t cursor_id = 0;
+    std::string last_pk;
+    uint64_t last_ts = 0;
+    int page_cnt = 0;
+    while (true) {
+        ::openmldb::api::TraverseRequest sr;
+        sr.set_tid(id);
+        sr.set_pid(1);
+        sr.set_limit(4);
+        sr.set_use_cursor(true);
+        sr.set_pk(last_pk);
+        sr.set_ts(last_ts);
+        if (cursor_id > 0) {
+            sr.set_cursor_id(cursor_id);
+        }
+        ::openmldb::api::TraverseResponse* srp = new ::openmldb::api::TraverseResponse();
+        tablet.Traverse(NULL, &sr, srp, &closure);
+        ASSERT_EQ(0, srp->code());
+        // the cursor of the last page is kept under the same id
+        if (cursor_id > 0 && !srp->is_finish()) {
+            ASSERT_EQ(cursor_id, srp->cursor_id());
+        }
+        cursor_id = srp->cursor_id();
+        ::openmldb::base::KvIterator kv_it(srp);
+        for (; kv_it.Valid(); kv_it.Next()) {
+            ASSERT_TRUE(traversed.insert(kv_it.GetPK() + "|" + std::to_string(kv_it.GetKey())).second);
+        }
+        page_cnt++;
+        if (kv_it.IsFinish()) {
+            ASSERT_EQ(0u, cursor_id);
+            break;
+        }
+        ASSERT_GT(cursor_id, 0u);
+        last_pk = kv_it.GetLastPK();
+        last_ts = kv_it.GetLastTS();
+        ASSERT_LT(page_cnt, 100);
+    }
+    ASSERT_EQ(expected, traversed);
+    FLAGS_max_traverse_cnt = old_max_traverse;
+}
+
 TEST_P(TabletImplTest, TraverseTTL) {
     ::openmldb::common::StorageMode storage_mode = GetParam();
     // disktable and memtable behave inconsistently with max_traverse_cnt
@@ -6258,6 +6724,115 @@ TEST_P(TabletImplTest, BulkLoad) {
     // TODO(hw): bulk load meaningful data, and get data from the table
 }
 
+TEST_P(TabletImplTest, BulkLoadBuilder) {
+    ::openmldb::common::StorageMode storage_mode = GetParam();
+    if (storage_mode != openmldb::common::kMemory) {
+        GTEST_SKIP();
+    }
+    TabletImpl tablet;
+    tablet.Init("");
+    uint32_t id = counter++;
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_name("t0");
+    table_meta.set_tid(id);
+    table_meta.set_pid(1);
+    table_meta.set_format_version(1);
+    table_meta.set_storage_mode(storage_mode);
+    table_meta.set_mode(::openmldb::api::TableMode::kTableLeader);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "amt", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts", ::openmldb::type::kTimestamp);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts", ::openmldb::type::kAbsoluteTime, 0, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "amt", "amt", "ts", ::openmldb::type::kAbsoluteTime, 0, 0);
+    {
+        ::openmldb::api::CreateTableRequest request;
+        request.mutable_table_meta()->CopyFrom(table_meta);
+        ::openmldb::api::CreateTableResponse response;
+        MockClosure closure;
+        tablet.CreateTable(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+    }
+    ::openmldb::api::BulkLoadInfoResponse info;
+    {
+        ::openmldb::api::BulkLoadInfoRequest request;
+        request.set_tid(id);
+        request.set_pid(1);
+        MockClosure closure;
+        brpc::Controller cntl;
+        tablet.GetBulkLoadInfo(&cntl, &request, &info, &closure);
+        ASSERT_EQ(0, info.code()) << info.msg();
+    }
+    ::openmldb::sdk::BulkLoadBuilder builder(id, 1, table_meta.column_desc(), info);
+    ::openmldb::codec::SDKCodec sdk_codec(table_meta);
+    // the rows of a key are not added in order of time
+    std::vector<uint64_t> times = {1005, 1001, 1003, 1002, 1004};
+    for (int i = 0; i < 3; i++) {
+        for (auto time : times) {
+            std::string row;
+            std::string card = "card" + std::to_string(i);
+            std::string amt = "amt" + std::to_string(time % 2);
+            sdk_codec.EncodeRow({card, amt, std::to_string(time)}, &row);
+            ASSERT_TRUE(builder.AddRow(row, {{card, 0}, {amt, 1}}, time).OK());
+        }
+    }
+    std::vector<std::pair<::openmldb::api::BulkLoadRequest, std::string>> requests(1);
+    ASSERT_TRUE(builder.BuildDataRequest(&requests[0].first, &requests[0].second));
+    ASSERT_EQ(15, requests[0].first.block_info_size());
+    ::openmldb::api::BulkLoadRequest index_request;
+    // a small limit splits the index region into parts of one key
+    while (builder.BuildIndexRequest(1, &index_request)) {
+        requests.emplace_back(index_request, "");
+        index_request.Clear();
+    }
+    ASSERT_GT(requests.size(), 2u);
+    ASSERT_TRUE(requests.back().first.eof());
+    for (auto& request : requests) {
+        ::openmldb::api::GeneralResponse response;
+        MockClosure closure;
+        brpc::Controller cntl;
+        cntl.request_attachment().append(request.second);
+        tablet.BulkLoad(&cntl, &request.first, &response, &closure);
+        ASSERT_EQ(0, response.code()) << response.msg();
+    }
+    for (int i = 0; i < 3; i++) {
+        ::openmldb::api::CountRequest request;
+        request.set_tid(id);
+        request.set_pid(1);
+        request.set_key("card" + std::to_string(i));
+        request.set_idx_name("card");
+        ::openmldb::api::CountResponse response;
+        MockClosure closure;
+        tablet.Count(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        ASSERT_EQ(5u, response.count());
+    }
+    {
+        ::openmldb::api::GetRequest request;
+        request.set_tid(id);
+        request.set_pid(1);
+        request.set_key("amt1");
+        request.set_idx_name("amt");
+        request.set_ts(0);
+        ::openmldb::api::GetResponse response;
+        MockClosure closure;
+        tablet.Get(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        ASSERT_EQ(1005u, response.ts());
+    }
+    {
+        ::openmldb::api::TraverseRequest request;
+        request.set_tid(id);
+        request.set_pid(1);
+        request.set_idx_name("card");
+        request.set_limit(100);
+        ::openmldb::api::TraverseResponse response;
+        MockClosure closure;
+        tablet.Traverse(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        ASSERT_EQ(15u, response.count());
+    }
+}
+
 TEST_P(TabletImplTest, AddIndex) {
     ::openmldb::common::StorageMode storage_mode = GetParam();
     TabletImpl tablet;
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_TRAVERSE_CURSOR_H_
+#define SRC_TABLET_TRAVERSE_CURSOR_H_
+
+#include <memory>
+#include <string>
+
+#include "storage/table.h"
+#include "tablet/cursor_store.h"
+
+namespace openmldb {
+namespace tablet {
+
+// The traverse iterator kept between the pages of a traverse, so the next page goes on from the iterator rather
+// than seeking the last pk and ts again. The ticket of the iterator pins the epoch of the segments.
+struct TraverseCursor {
+    uint32_t tid = 0;
+    uint32_t pid = 0;
+    uint32_t index = 0;
+    std::shared_ptr<::openmldb::storage::Table> table;
+    std::unique_ptr<::openmldb::storage::TraverseIterator> it;
+    // the row the iterator is on has been returned by the last page
+    bool returned = false;
+    // the last row returned, to remove the duplicated records
+    std::string last_pk;
+    uint64_t last_ts = 0;
+};
+
+using TraverseCursors = CursorStore<TraverseCursor>;
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_TRAVERSE_CURSOR_H_
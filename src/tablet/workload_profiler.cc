@@ -0,0 +1,419 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/workload_profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "base/glog_wapper.h"
+#ifdef TCMALLOC_ENABLE
+#include "gperftools/malloc_hook.h"
+#endif
+
+namespace openmldb {
+namespace tablet {
+
+static constexpr uint32_t kRingCapacity = 8192;
+// the distinct stacks beyond it are only counted by their tags
+static constexpr uint32_t kMaxStackCnt = 100000;
+static constexpr uint32_t kDrainIntervalMs = 100;
+
+static thread_local std::atomic<const ProfileTag*> t_tag{nullptr};
+// the cpu time and the allocated bytes when the current tag of the thread takes effect
+static thread_local uint64_t t_seg_cpu_ns = 0;
+static thread_local uint64_t t_seg_alloc_bytes = 0;
+static thread_local uint64_t t_alloc_bytes = 0;
+static thread_local uint64_t t_unsampled_bytes = 0;
+static thread_local bool t_in_hook = false;
+
+WorkloadProfiler::SampleRing WorkloadProfiler::cpu_ring_(kRingCapacity);
+WorkloadProfiler::SampleRing WorkloadProfiler::heap_ring_(kRingCapacity);
+std::atomic<bool> WorkloadProfiler::running_(false);
+std::atomic<uint64_t> WorkloadProfiler::heap_sample_bytes_(0);
+std::mutex WorkloadProfiler::mu_;
+std::unordered_map<std::string, std::unique_ptr<ProfileTag>> WorkloadProfiler::tags_;
+WorkloadProfiler::StackMap WorkloadProfiler::cpu_stacks_;
+WorkloadProfiler::StackMap WorkloadProfiler::heap_stacks_;
+std::map<const ProfileTag*, uint64_t> WorkloadProfiler::cpu_samples_;
+uint64_t WorkloadProfiler::cpu_read_ = 0;
+uint64_t WorkloadProfiler::heap_read_ = 0;
+std::thread WorkloadProfiler::drain_thread_;
+
+static uint64_t GetThreadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// the seq of the sample at pos is 2 * pos + 1 while it is written and 2 * pos + 2 once done
+void WorkloadProfiler::SampleRing::Add(const ProfileTag* tag, uint64_t weight, void** pcs, uint32_t depth) {
+    uint64_t pos = next_.fetch_add(1, std::memory_order_relaxed);
+    Sample& sample = samples_[pos % capacity_];
+    sample.seq.store(2 * pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    sample.tag = tag;
+    sample.weight = weight;
+    sample.depth = std::min(depth, kMaxDepth);
+    std::copy(pcs, pcs + sample.depth, sample.pcs);
+    sample.seq.store(2 * pos + 2, std::memory_order_release);
+}
+
+template <typename F>
+void WorkloadProfiler::SampleRing::Drain(uint64_t* read, F&& f) {
+    uint64_t end = next_.load(std::memory_order_acquire);
+    if (end - *read > capacity_) {
+        *read = end - capacity_;
+    }
+    for (; *read < end; (*read)++) {
+        uint64_t pos = *read;
+        const Sample& sample = samples_[pos % capacity_];
+        uint64_t seq = sample.seq.load(std::memory_order_acquire);
+        if (seq < 2 * pos + 2) {
+            // still being written, read it next time
+            break;
+        }
+        if (seq > 2 * pos + 2) {
+            continue;
+        }
+        const ProfileTag* tag = sample.tag;
+        uint64_t weight = sample.weight;
+        std::vector<void*> pcs(sample.pcs, sample.pcs + sample.depth);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sample.seq.load(std::memory_order_relaxed) != seq) {
+            continue;
+        }
+        f(tag, weight, std::move(pcs));
+    }
+}
+
+bool WorkloadProfiler::Start(uint32_t hz, uint64_t heap_sample_bytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (running_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    // the first call of backtrace loads the unwinder, which is not safe in the signal handler
+    void* pcs[1];
+    backtrace(pcs, 1);
+#ifdef TCMALLOC_ENABLE
+    if (heap_sample_bytes > 0 && !MallocHook::AddNewHook(&WorkloadProfiler::OnAlloc)) {
+        PDLOG(WARNING, "fail to add the allocation hook, the allocations are not profiled");
+    }
+#else
+    if (heap_sample_bytes > 0) {
+        PDLOG(WARNING, "the allocations are not profiled without tcmalloc");
+    }
+#endif
+    heap_sample_bytes_.store(heap_sample_bytes, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_relaxed);
+    if (hz > 0) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = &WorkloadProfiler::OnSignal;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGPROF, &sa, nullptr);
+        struct itimerval timer;
+        timer.it_interval.tv_sec = 0;
+        timer.it_interval.tv_usec = std::max<uint32_t>(1000000 / hz, 1);
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_PROF, &timer, nullptr);
+    }
+    drain_thread_ = std::thread(&WorkloadProfiler::DrainLoop);
+    PDLOG(INFO, "start workload profiler. hz %u heap_sample_bytes %lu", hz, heap_sample_bytes);
+    return true;
+}
+
+void WorkloadProfiler::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!running_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        struct itimerval timer;
+        memset(&timer, 0, sizeof(timer));
+        setitimer(ITIMER_PROF, &timer, nullptr);
+        // a pending signal is dropped
+        signal(SIGPROF, SIG_IGN);
+#ifdef TCMALLOC_ENABLE
+        if (heap_sample_bytes_.load(std::memory_order_relaxed) > 0) {
+            MallocHook::RemoveNewHook(&WorkloadProfiler::OnAlloc);
+        }
+#endif
+        running_.store(false, std::memory_order_relaxed);
+    }
+    if (drain_thread_.joinable()) {
+        drain_thread_.join();
+    }
+    DrainOnce();
+    PDLOG(INFO, "stop workload profiler");
+}
+
+ProfileTag* WorkloadProfiler::GetTag(const std::string& name) {
+    // the lookups are cached by the threads, as the tags are never freed
+    static thread_local std::unordered_map<std::string, ProfileTag*> cache;
+    auto it = cache.find(name);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    ProfileTag* tag = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto& entry = tags_[name];
+        if (!entry) {
+            entry.reset(new ProfileTag(name));
+        }
+        tag = entry.get();
+    }
+    cache.emplace(name, tag);
+    return tag;
+}
+
+void WorkloadProfiler::OnSignal(int sig) {
+    if (t_in_hook) {
+        return;
+    }
+    int saved_errno = errno;
+    // the frames of the handler and the signal trampoline are skipped
+    void* pcs[kMaxDepth + 2];
+    int depth = backtrace(pcs, kMaxDepth + 2);
+    if (depth > 2) {
+        cpu_ring_.Add(t_tag.load(std::memory_order_relaxed), 1, pcs + 2, depth - 2);
+    }
+    errno = saved_errno;
+}
+
+void WorkloadProfiler::OnAlloc(const void* ptr, size_t size) {
+    const ProfileTag* tag = t_tag.load(std::memory_order_relaxed);
+    if (tag == nullptr || t_in_hook) {
+        return;
+    }
+    t_alloc_bytes += size;
+    uint64_t sample_bytes = heap_sample_bytes_.load(std::memory_order_relaxed);
+    t_unsampled_bytes += size;
+    if (sample_bytes == 0 || t_unsampled_bytes < sample_bytes) {
+        return;
+    }
+    // the sample stands for all the bytes since the last one
+    uint64_t weight = t_unsampled_bytes;
+    t_unsampled_bytes = 0;
+    t_in_hook = true;
+    void* pcs[kMaxDepth + 1];
+    int depth = backtrace(pcs, kMaxDepth + 1);
+    if (depth > 1) {
+        heap_ring_.Add(tag, weight, pcs + 1, depth - 1);
+    }
+    t_in_hook = false;
+}
+
+void WorkloadProfiler::DrainLoop() {
+    while (running_.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kDrainIntervalMs));
+        DrainOnce();
+    }
+}
+
+void WorkloadProfiler::DrainOnce() {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto add = [](StackMap* stacks, const ProfileTag* tag, uint64_t weight, std::vector<void*> pcs) {
+        StackKey key{tag, std::move(pcs)};
+        if (stacks->size() >= kMaxStackCnt && stacks->find(key) == stacks->end()) {
+            key.pcs.clear();
+        }
+        (*stacks)[key] += weight;
+    };
+    cpu_ring_.Drain(&cpu_read_, [&add](const ProfileTag* tag, uint64_t weight, std::vector<void*> pcs) {
+        cpu_samples_[tag] += weight;
+        add(&cpu_stacks_, tag, weight, std::move(pcs));
+    });
+    heap_ring_.Drain(&heap_read_, [&add](const ProfileTag* tag, uint64_t weight, std::vector<void*> pcs) {
+        add(&heap_stacks_, tag, weight, std::move(pcs));
+    });
+}
+
+std::vector<WorkloadProfiler::TagStat> WorkloadProfiler::GetTagStats() {
+    DrainOnce();
+    std::vector<TagStat> stats;
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& kv : tags_) {
+        const ProfileTag* tag = kv.second.get();
+        TagStat stat;
+        stat.name = tag->name;
+        stat.cpu_ns = tag->cpu_ns.load(std::memory_order_relaxed);
+        stat.alloc_bytes = tag->alloc_bytes.load(std::memory_order_relaxed);
+        stat.scope_cnt = tag->scope_cnt.load(std::memory_order_relaxed);
+        auto it = cpu_samples_.find(tag);
+        stat.cpu_samples = it == cpu_samples_.end() ? 0 : it->second;
+        stats.push_back(std::move(stat));
+    }
+    std::sort(stats.begin(), stats.end(), [](const TagStat& a, const TagStat& b) { return a.cpu_ns > b.cpu_ns; });
+    return stats;
+}
+
+// the function name if it is exported, e.g. linked with -rdynamic, or module+offset for addr2line
+static std::string Symbolize(void* pc) {
+    Dl_info info;
+    char buf[64];
+    if (dladdr(pc, &info) == 0) {
+        snprintf(buf, sizeof(buf), "%p", pc);
+        return buf;
+    }
+    if (info.dli_sname == nullptr) {
+        const char* module = info.dli_fname == nullptr ? "" : strrchr(info.dli_fname, '/');
+        module = module == nullptr ? info.dli_fname : module + 1;
+        snprintf(buf, sizeof(buf), "%s+0x%lx", module,
+                 reinterpret_cast<uintptr_t>(pc) - reinterpret_cast<uintptr_t>(info.dli_fbase));
+        return buf;
+    }
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    std::string name = status == 0 && demangled != nullptr ? demangled : info.dli_sname;
+    free(demangled);
+    // ; separates the frames in the folded format
+    std::replace(name.begin(), name.end(), ';', ',');
+    return name;
+}
+
+std::string WorkloadProfiler::Dump(const StackMap& stacks, const std::string& tag_prefix) {
+    std::map<void*, std::string> symbols;
+    // the stacks of different pcs in the same functions are merged
+    std::map<std::string, uint64_t> folded;
+    for (const auto& kv : stacks) {
+        std::string line = kv.first.tag == nullptr ? "untagged" : kv.first.tag->name;
+        if (line.compare(0, tag_prefix.size(), tag_prefix) != 0) {
+            continue;
+        }
+        for (auto it = kv.first.pcs.rbegin(); it != kv.first.pcs.rend(); ++it) {
+            auto sit = symbols.find(*it);
+            if (sit == symbols.end()) {
+                sit = symbols.emplace(*it, Symbolize(*it)).first;
+            }
+            line.append(";").append(sit->second);
+        }
+        folded[line] += kv.second;
+    }
+    std::string out;
+    for (const auto& kv : folded) {
+        out.append(kv.first).append(" ").append(std::to_string(kv.second)).append("\n");
+    }
+    return out;
+}
+
+std::string WorkloadProfiler::DumpCpuStacks(const std::string& tag_prefix) {
+    DrainOnce();
+    StackMap stacks;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stacks = cpu_stacks_;
+    }
+    return Dump(stacks, tag_prefix);
+}
+
+std::string WorkloadProfiler::DumpHeapStacks(const std::string& tag_prefix) {
+    DrainOnce();
+    StackMap stacks;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stacks = heap_stacks_;
+    }
+    return Dump(stacks, tag_prefix);
+}
+
+void WorkloadProfiler::Reset() {
+    DrainOnce();
+    std::lock_guard<std::mutex> lock(mu_);
+    cpu_stacks_.clear();
+    heap_stacks_.clear();
+    cpu_samples_.clear();
+    for (auto& kv : tags_) {
+        kv.second->cpu_ns.store(0, std::memory_order_relaxed);
+        kv.second->alloc_bytes.store(0, std::memory_order_relaxed);
+        kv.second->scope_cnt.store(0, std::memory_order_relaxed);
+    }
+}
+
+// the cpu time and the allocated bytes since the current tag of the thread takes effect go to the tag
+static void FlushSegment(const ProfileTag* tag) {
+    uint64_t cpu_ns = GetThreadCpuNs();
+    if (tag != nullptr) {
+        auto* mutable_tag = const_cast<ProfileTag*>(tag);
+        mutable_tag->cpu_ns.fetch_add(cpu_ns - t_seg_cpu_ns, std::memory_order_relaxed);
+        mutable_tag->alloc_bytes.fetch_add(t_alloc_bytes - t_seg_alloc_bytes, std::memory_order_relaxed);
+    }
+    t_seg_cpu_ns = cpu_ns;
+    t_seg_alloc_bytes = t_alloc_bytes;
+}
+
+ScopedProfileTag::ScopedProfileTag(const std::string& name)
+    : tag_(nullptr), prev_tag_(nullptr), thread_(), slot_(nullptr) {
+    if (WorkloadProfiler::IsRunning()) {
+        Enter(name);
+    }
+}
+
+ScopedProfileTag::ScopedProfileTag(const char* kind, uint32_t tid)
+    : tag_(nullptr), prev_tag_(nullptr), thread_(), slot_(nullptr) {
+    if (WorkloadProfiler::IsRunning()) {
+        Enter(std::string(kind) + ":" + std::to_string(tid));
+    }
+}
+
+ScopedProfileTag::ScopedProfileTag(const char* kind, const std::string& db, const std::string& name)
+    : tag_(nullptr), prev_tag_(nullptr), thread_(), slot_(nullptr) {
+    if (WorkloadProfiler::IsRunning()) {
+        Enter(name.empty() ? std::string(kind) + ":" + db : std::string(kind) + ":" + db + "." + name);
+    }
+}
+
+void ScopedProfileTag::Enter(const std::string& name) {
+    thread_ = pthread_self();
+    tag_ = WorkloadProfiler::GetTag(name);
+    tag_->scope_cnt.fetch_add(1, std::memory_order_relaxed);
+    slot_ = &t_tag;
+    prev_tag_ = slot_->load(std::memory_order_relaxed);
+    FlushSegment(prev_tag_);
+    slot_->store(tag_, std::memory_order_relaxed);
+}
+
+ScopedProfileTag::~ScopedProfileTag() {
+    if (tag_ == nullptr) {
+        return;
+    }
+    if (pthread_equal(thread_, pthread_self())) {
+        FlushSegment(tag_);
+        slot_->store(prev_tag_, std::memory_order_relaxed);
+    } else {
+        // the bthread is switched to another worker, untag the thread it starts on unless it is tagged again
+        const ProfileTag* expected = tag_;
+        slot_->compare_exchange_strong(expected, prev_tag_, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace tablet
+}  // namespace openmldb
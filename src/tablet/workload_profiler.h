@@ -0,0 +1,166 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_WORKLOAD_PROFILER_H_
+#define SRC_TABLET_WORKLOAD_PROFILER_H_
+
+#include <pthread.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+namespace openmldb {
+namespace tablet {
+
+// the workload a thread is working for, e.g. deploy:db.name or put:tid. the tags are never freed, so a
+// sample refers to its tag by pointer
+struct ProfileTag {
+    explicit ProfileTag(const std::string& n) : name(n), cpu_ns(0), alloc_bytes(0), scope_cnt(0) {}
+    const std::string name;
+    std::atomic<uint64_t> cpu_ns;
+    std::atomic<uint64_t> alloc_bytes;
+    std::atomic<uint64_t> scope_cnt;
+};
+
+// WorkloadProfiler samples the cpu stacks with SIGPROF and the allocation stacks every heap_sample_bytes
+// allocated bytes, and attributes them to the tag of the thread set by ScopedProfileTag. The cpu time and
+// the allocated bytes of the scopes are summed up by the tags as well. It is process wide, so the cpu
+// profiler of gperftools, e.g. /hotspots/cpu of brpc, must not be used while it is running. The allocations
+// are hooked only with tcmalloc.
+class WorkloadProfiler {
+ public:
+    struct TagStat {
+        std::string name;
+        uint64_t cpu_ns = 0;
+        uint64_t alloc_bytes = 0;
+        uint64_t scope_cnt = 0;
+        uint64_t cpu_samples = 0;
+    };
+
+    // hz 0 disables the cpu sampling and heap_sample_bytes 0 disables the allocation sampling and counting,
+    // the cpu time of the scopes is still accounted. return false if it is running already
+    static bool Start(uint32_t hz, uint64_t heap_sample_bytes);
+    static void Stop();
+    static bool IsRunning() { return running_.load(std::memory_order_relaxed); }
+
+    // the tag of the name, created on the first call
+    static ProfileTag* GetTag(const std::string& name);
+
+    static std::vector<TagStat> GetTagStats();
+
+    // the aggregated stacks in the folded format of flamegraph.pl, one stack per line as
+    // `tag;outermost_frame;...;innermost_frame weight`. the weight is the count of samples for cpu and the
+    // sampled bytes for heap. only the stacks of the tags starting with `tag_prefix` are dumped
+    static std::string DumpCpuStacks(const std::string& tag_prefix);
+    static std::string DumpHeapStacks(const std::string& tag_prefix);
+
+    // clear the aggregated stacks and the stats of the tags
+    static void Reset();
+
+    // called by the allocation hook, public for tests
+    static void OnAlloc(const void* ptr, size_t size);
+
+ private:
+    friend class ScopedProfileTag;
+
+    static constexpr uint32_t kMaxDepth = 32;
+
+    struct Sample {
+        std::atomic<uint64_t> seq{0};
+        const ProfileTag* tag = nullptr;
+        uint64_t weight = 0;
+        uint32_t depth = 0;
+        void* pcs[kMaxDepth];
+    };
+
+    // the samples are written by the signal handler and the allocation hook without lock, and drained
+    // into the aggregated stacks in background. the samples overwritten before drained are lost
+    class SampleRing {
+     public:
+        explicit SampleRing(uint32_t capacity) : samples_(new Sample[capacity]), capacity_(capacity), next_(0) {}
+        void Add(const ProfileTag* tag, uint64_t weight, void** pcs, uint32_t depth);
+        // the samples since the last call, `read` is the position to read from
+        template <typename F>
+        void Drain(uint64_t* read, F&& f);
+
+     private:
+        std::unique_ptr<Sample[]> samples_;
+        uint32_t capacity_;
+        std::atomic<uint64_t> next_;
+    };
+
+    struct StackKey {
+        const ProfileTag* tag;
+        std::vector<void*> pcs;
+        bool operator<(const StackKey& o) const { return tag != o.tag ? tag < o.tag : pcs < o.pcs; }
+    };
+    using StackMap = std::map<StackKey, uint64_t>;
+
+    static void OnSignal(int sig);
+    static void DrainLoop();
+    static void DrainOnce();
+    static std::string Dump(const StackMap& stacks, const std::string& tag_prefix);
+
+    static SampleRing cpu_ring_;
+    static SampleRing heap_ring_;
+    static std::atomic<bool> running_;
+    static std::atomic<uint64_t> heap_sample_bytes_;
+
+    static std::mutex mu_;
+    static std::unordered_map<std::string, std::unique_ptr<ProfileTag>> tags_;
+    static StackMap cpu_stacks_;
+    static StackMap heap_stacks_;
+    static std::map<const ProfileTag*, uint64_t> cpu_samples_;
+    static uint64_t cpu_read_;
+    static uint64_t heap_read_;
+    static std::thread drain_thread_;
+};
+
+// ScopedProfileTag tags the current thread with the tag until the scope ends, and adds the cpu time and the
+// allocated bytes of the thread in the scope to the tag, excluding the nested scopes. It does nothing unless
+// the profiler is running. The work after the bthread in the scope is switched to another worker, e.g.
+// waiting for a remote sub query, is not attributed to the tag.
+class ScopedProfileTag {
+ public:
+    explicit ScopedProfileTag(const std::string& name);
+    // the tag of kind:tid, e.g. put:1. the name is only built if the profiler is running
+    ScopedProfileTag(const char* kind, uint32_t tid);
+    // the tag of kind:db.name, e.g. deploy:db.name, or kind:db if the name is empty
+    ScopedProfileTag(const char* kind, const std::string& db, const std::string& name);
+    ~ScopedProfileTag();
+    ScopedProfileTag(const ScopedProfileTag&) = delete;
+    ScopedProfileTag& operator=(const ScopedProfileTag&) = delete;
+
+ private:
+    void Enter(const std::string& name);
+
+    ProfileTag* tag_;
+    const ProfileTag* prev_tag_;
+    pthread_t thread_;
+    // the tag of the thread the scope starts on
+    std::atomic<const ProfileTag*>* slot_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_WORKLOAD_PROFILER_H_
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/workload_profiler.h"
+
+#include <time.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace tablet {
+
+class WorkloadProfilerTest : public ::testing::Test {
+ public:
+    void TearDown() override {
+        WorkloadProfiler::Stop();
+        WorkloadProfiler::Reset();
+    }
+};
+
+static uint64_t GetThreadCpuMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void BurnCpu(uint64_t ms) {
+    uint64_t end = GetThreadCpuMs() + ms;
+    volatile uint64_t sum = 0;
+    while (GetThreadCpuMs() < end) {
+        for (int i = 0; i < 10000; i++) {
+            sum += i;
+        }
+    }
+}
+
+static WorkloadProfiler::TagStat GetStat(const std::string& name) {
+    for (const auto& stat : WorkloadProfiler::GetTagStats()) {
+        if (stat.name == name) {
+            return stat;
+        }
+    }
+    return {};
+}
+
+// the total weight of the folded stacks, every line must start with the prefix
+static uint64_t SumWeight(const std::string& folded, const std::string& prefix) {
+    std::istringstream in(folded);
+    std::string line;
+    uint64_t sum = 0;
+    while (std::getline(in, line)) {
+        EXPECT_EQ(0u, line.find(prefix)) << line;
+        sum += std::stoull(line.substr(line.rfind(' ') + 1));
+    }
+    return sum;
+}
+
+TEST_F(WorkloadProfilerTest, NotRunning) {
+    ASSERT_FALSE(WorkloadProfiler::IsRunning());
+    {
+        ScopedProfileTag tag("deploy:db.not_running");
+        BurnCpu(10);
+    }
+    ASSERT_TRUE(GetStat("deploy:db.not_running").name.empty());
+}
+
+TEST_F(WorkloadProfilerTest, ScopeAccounting) {
+    ASSERT_TRUE(WorkloadProfiler::Start(0, 0));
+    ASSERT_FALSE(WorkloadProfiler::Start(0, 0));
+    {
+        ScopedProfileTag outer("deploy", "db", "outer");
+        BurnCpu(50);
+        {
+            ScopedProfileTag inner("put", 1);
+            BurnCpu(50);
+        }
+    }
+    auto outer = GetStat("deploy:db.outer");
+    auto inner = GetStat("put:1");
+    ASSERT_EQ(1u, outer.scope_cnt);
+    ASSERT_EQ(1u, inner.scope_cnt);
+    // the nested scope is excluded from the outer one
+    ASSERT_GE(outer.cpu_ns, 45000000u);
+    ASSERT_LT(outer.cpu_ns, 95000000u);
+    ASSERT_GE(inner.cpu_ns, 45000000u);
+
+    WorkloadProfiler::Reset();
+    ASSERT_EQ(0u, GetStat("deploy:db.outer").cpu_ns);
+    ASSERT_EQ(0u, GetStat("deploy:db.outer").scope_cnt);
+}
+
+TEST_F(WorkloadProfilerTest, CpuStacks) {
+    ASSERT_TRUE(WorkloadProfiler::Start(1000, 0));
+    {
+        ScopedProfileTag tag("deploy:db.cpu");
+        BurnCpu(300);
+    }
+    WorkloadProfiler::Stop();
+    ASSERT_GT(GetStat("deploy:db.cpu").cpu_samples, 0u);
+    std::string folded = WorkloadProfiler::DumpCpuStacks("deploy:db.cpu");
+    ASSERT_FALSE(folded.empty());
+    ASSERT_EQ(GetStat("deploy:db.cpu").cpu_samples, SumWeight(folded, "deploy:db.cpu;"));
+    ASSERT_TRUE(WorkloadProfiler::DumpCpuStacks("deploy:db.none").empty());
+}
+
+TEST_F(WorkloadProfilerTest, HeapStacks) {
+    ASSERT_TRUE(WorkloadProfiler::Start(0, 1024));
+    {
+        ScopedProfileTag tag("deploy:db.heap");
+        for (int i = 0; i < 4; i++) {
+            WorkloadProfiler::OnAlloc(nullptr, 600);
+        }
+    }
+    // the allocations out of the scopes are not counted
+    WorkloadProfiler::OnAlloc(nullptr, 4096);
+    ASSERT_GE(GetStat("deploy:db.heap").alloc_bytes, 2400u);
+    ASSERT_GE(SumWeight(WorkloadProfiler::DumpHeapStacks("deploy:db.heap"), "deploy:db.heap;"), 2400u);
+    ASSERT_TRUE(WorkloadProfiler::DumpHeapStacks("untagged").empty());
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/write_throttler.h"
+
+#include <algorithm>
+
+namespace openmldb {
+namespace tablet {
+
+WriteThrottler::WriteThrottler(uint64_t max_memory_bytes, uint64_t max_lag, double low_ratio)
+    : max_memory_bytes_(max_memory_bytes),
+      max_lag_(max_lag),
+      low_ratio_(std::min(std::max(low_ratio, 0.0), 1.0)),
+      memory_bytes_(0),
+      throttled_cnt_(0),
+      idle_(true),
+      mu_(),
+      limits_() {}
+
+double WriteThrottler::GetPressure(uint64_t value, uint64_t limit) const {
+    if (limit == 0) {
+        return 0;
+    }
+    if (value >= limit) {
+        return 1;
+    }
+    double low = limit * low_ratio_;
+    if (value <= low) {
+        return 0;
+    }
+    return (value - low) / (limit - low);
+}
+
+double WriteThrottler::GetMemoryPressure() const {
+    return GetPressure(memory_bytes_.load(std::memory_order_relaxed), max_memory_bytes_);
+}
+
+void WriteThrottler::UpdateMemory(uint64_t used_bytes) { memory_bytes_.store(used_bytes, std::memory_order_relaxed); }
+
+void WriteThrottler::UpdatePartition(uint32_t tid, uint32_t pid, uint64_t lag, uint64_t put_rate) {
+    double memory_pressure = GetMemoryPressure();
+    double lag_pressure = GetPressure(lag, max_lag_);
+    double pressure = std::max(memory_pressure, lag_pressure);
+    auto key = std::make_pair(tid, pid);
+    std::lock_guard<std::mutex> lock(mu_);
+    if (pressure <= 0) {
+        limits_.erase(key);
+        idle_.store(limits_.empty(), std::memory_order_relaxed);
+        return;
+    }
+    auto& limit = limits_[key];
+    if (!limit) {
+        limit = std::make_shared<Limit>();
+    }
+    limit->by_lag = lag_pressure > memory_pressure;
+    if (pressure >= 1) {
+        limit->rate = 0;
+    } else {
+        // the put rate is held under the last rate, so the rate goes down at each interval
+        limit->rate = std::max(kMinRate, static_cast<uint64_t>(put_rate * (1 - pressure)));
+        limit->bucket.SetRate(limit->rate);
+    }
+    idle_.store(false, std::memory_order_relaxed);
+}
+
+void WriteThrottler::RemovePartition(uint32_t tid, uint32_t pid) {
+    std::lock_guard<std::mutex> lock(mu_);
+    limits_.erase(std::make_pair(tid, pid));
+    idle_.store(limits_.empty(), std::memory_order_relaxed);
+}
+
+bool WriteThrottler::Acquire(uint32_t tid, uint32_t pid, uint64_t rows, uint64_t now_us, std::string* msg) {
+    if (max_memory_bytes_ > 0 && memory_bytes_.load(std::memory_order_relaxed) >= max_memory_bytes_) {
+        throttled_cnt_.fetch_add(1, std::memory_order_relaxed);
+        *msg = "write throttled, the memory of the tablet reaches the limit";
+        return false;
+    }
+    if (idle_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    std::shared_ptr<Limit> limit;
+    uint64_t rate = 0;
+    bool by_lag = false;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = limits_.find(std::make_pair(tid, pid));
+        if (it == limits_.end()) {
+            return true;
+        }
+        limit = it->second;
+        rate = limit->rate;
+        by_lag = limit->by_lag;
+    }
+    if (rate > 0 && limit->bucket.TryAcquire(rows, now_us)) {
+        return true;
+    }
+    throttled_cnt_.fetch_add(1, std::memory_order_relaxed);
+    *msg = by_lag ? "write throttled, the followers of the partition lag behind"
+                  : "write throttled, the memory of the tablet is near the limit";
+    return false;
+}
+
+}  // namespace tablet
+}  // namespace openmldb
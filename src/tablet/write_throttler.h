@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_WRITE_THROTTLER_H_
+#define SRC_TABLET_WRITE_THROTTLER_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+
+#include "base/token_bucket.h"
+
+namespace openmldb {
+namespace tablet {
+
+// WriteThrottler slows down the puts of the leader partitions once the memory of the tablet or the lag of the
+// slowest follower of a partition passes low_ratio of its limit, and rejects them at the limit. In between the
+// puts of a partition are limited by a token bucket of rows, its rate is the put rate of the last interval cut in
+// proportion to the pressure, so it keeps going down while the pressure stays and it is lifted once the pressure
+// is gone. The rejected puts are to be retried by the clients.
+class WriteThrottler {
+ public:
+    // the rows per second a partition is always allowed below the limits
+    static constexpr uint64_t kMinRate = 100;
+
+    // max_memory_bytes and max_lag of 0 disable the limit
+    WriteThrottler(uint64_t max_memory_bytes, uint64_t max_lag, double low_ratio);
+    ~WriteThrottler() {}
+    WriteThrottler(const WriteThrottler&) = delete;
+    WriteThrottler& operator=(const WriteThrottler&) = delete;
+
+    bool IsEnabled() const { return max_memory_bytes_ > 0 || max_lag_ > 0; }
+
+    // set the memory used by the tablet, the partitions are updated with the pressure of it
+    void UpdateMemory(uint64_t used_bytes);
+
+    // update the limit of the leader partition at the interval, lag is the log entries its slowest follower lags
+    // behind and put_rate the rows put per second in the last interval
+    void UpdatePartition(uint32_t tid, uint32_t pid, uint64_t lag, uint64_t put_rate);
+
+    void RemovePartition(uint32_t tid, uint32_t pid);
+
+    // take the tokens of rows put to the partition at now_us, return false with the reason if rejected
+    bool Acquire(uint32_t tid, uint32_t pid, uint64_t rows, uint64_t now_us, std::string* msg);
+
+    // the pressure of the tablet memory, 0 below the low watermark and 1 at the limit
+    double GetMemoryPressure() const;
+
+    uint64_t GetThrottledCnt() const { return throttled_cnt_.load(std::memory_order_relaxed); }
+
+ private:
+    struct Limit {
+        // the rate the bucket is set to, 0 if the puts are rejected
+        uint64_t rate = 0;
+        // the pressure is taken from the follower lag rather than the memory
+        bool by_lag = false;
+        ::openmldb::base::TokenBucket bucket;
+    };
+
+    double GetPressure(uint64_t value, uint64_t limit) const;
+
+    const uint64_t max_memory_bytes_;
+    const uint64_t max_lag_;
+    const double low_ratio_;
+    std::atomic<uint64_t> memory_bytes_;
+    std::atomic<uint64_t> throttled_cnt_;
+    // no partition is limited, so the puts take no lock
+    std::atomic<bool> idle_;
+    std::mutex mu_;
+    // (tid, pid) -> the limit of the partitions under pressure
+    std::map<std::pair<uint32_t, uint32_t>, std::shared_ptr<Limit>> limits_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_WRITE_THROTTLER_H_
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/write_throttler.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace tablet {
+
+class WriteThrottlerTest : public ::testing::Test {
+ public:
+    WriteThrottlerTest() {}
+    ~WriteThrottlerTest() {}
+};
+
+TEST_F(WriteThrottlerTest, Disabled) {
+    WriteThrottler throttler(0, 0, 0.8);
+    ASSERT_FALSE(throttler.IsEnabled());
+    throttler.UpdateMemory(1 << 30);
+    throttler.UpdatePartition(1, 0, 1 << 20, 1000);
+    std::string msg;
+    ASSERT_TRUE(throttler.Acquire(1, 0, 1 << 20, 1000000, &msg));
+    ASSERT_EQ(0u, throttler.GetThrottledCnt());
+}
+
+TEST_F(WriteThrottlerTest, Memory) {
+    WriteThrottler throttler(1000, 0, 0.5);
+    std::string msg;
+    throttler.UpdateMemory(400);
+    throttler.UpdatePartition(1, 0, 0, 10000);
+    ASSERT_DOUBLE_EQ(0, throttler.GetMemoryPressure());
+    ASSERT_TRUE(throttler.Acquire(1, 0, 100000, 1000000, &msg));
+    // half way to the limit halves the rate of the last interval
+    throttler.UpdateMemory(750);
+    ASSERT_DOUBLE_EQ(0.5, throttler.GetMemoryPressure());
+    throttler.UpdatePartition(1, 0, 0, 10000);
+    ASSERT_TRUE(throttler.Acquire(1, 0, 5000, 2000000, &msg));
+    ASSERT_FALSE(throttler.Acquire(1, 0, 1, 2000000, &msg));
+    ASSERT_EQ(1u, throttler.GetThrottledCnt());
+    // the partitions not updated yet are rejected at the limit too
+    throttler.UpdateMemory(1000);
+    ASSERT_FALSE(throttler.Acquire(2, 0, 1, 2000000, &msg));
+    // the limit is lifted once the memory falls below the low watermark
+    throttler.UpdateMemory(100);
+    throttler.UpdatePartition(1, 0, 0, 100);
+    ASSERT_TRUE(throttler.Acquire(1, 0, 100000, 3000000, &msg));
+}
+
+TEST_F(WriteThrottlerTest, Lag) {
+    WriteThrottler throttler(0, 1000, 0.5);
+    std::string msg;
+    throttler.UpdatePartition(1, 0, 2000, 10000);
+    throttler.UpdatePartition(1, 1, 100, 10000);
+    // only the partition lagging behind is rejected
+    ASSERT_FALSE(throttler.Acquire(1, 0, 1, 1000000, &msg));
+    ASSERT_NE(std::string::npos, msg.find("lag"));
+    ASSERT_TRUE(throttler.Acquire(1, 1, 100000, 1000000, &msg));
+    // the rate is no less than kMinRate below the limit
+    throttler.UpdatePartition(1, 0, 999, 0);
+    ASSERT_TRUE(throttler.Acquire(1, 0, WriteThrottler::kMinRate, 2000000, &msg));
+    ASSERT_FALSE(throttler.Acquire(1, 0, 1, 2000000, &msg));
+    throttler.RemovePartition(1, 0);
+    ASSERT_TRUE(throttler.Acquire(1, 0, 100000, 2000000, &msg));
+}
+
+}  // namespace tablet
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
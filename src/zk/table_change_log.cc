@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "zk/table_change_log.h"
+
+#include "base/glog_wapper.h"
+#include "boost/algorithm/string.hpp"
+#include "boost/lexical_cast.hpp"
+
+namespace openmldb {
+namespace zk {
+
+bool TableChangeLog::Increment(const std::string& notify_node, const std::vector<std::string>& table_nodes) {
+    std::string entry = Encode(table_nodes);
+    int try_num = 3;
+    while (try_num-- > 0) {
+        std::string value;
+        Stat stat;
+        if (!zk_client_->GetNodeValueAndStat(notify_node.c_str(), &value, &stat)) {
+            continue;
+        }
+        uint64_t version = 0;
+        try {
+            version = boost::lexical_cast<uint64_t>(value) + 1;
+        } catch (const std::exception& e) {
+            return false;
+        }
+        std::vector<ZkOp> ops = {{ZkOpType::kCreate, log_path_ + "/" + std::to_string(version), entry},
+                                 {ZkOpType::kSet, notify_node, std::to_string(version), stat.version}};
+        if (!zk_client_->Multi(ops)) {
+            PDLOG(INFO, "retry increment %s", notify_node.c_str());
+            continue;
+        }
+        if (version > kMaxEntryNum) {
+            zk_client_->DeleteNode(log_path_ + "/" + std::to_string(version - kMaxEntryNum));
+        }
+        return true;
+    }
+    return false;
+}
+
+bool TableChangeLog::GetChanges(uint64_t from_version, uint64_t to_version, std::set<std::string>* table_nodes) {
+    if (from_version >= to_version) {
+        return true;
+    }
+    if (to_version - from_version > kMaxEntryNum) {
+        return false;
+    }
+    for (uint64_t version = from_version + 1; version <= to_version; version++) {
+        std::string value;
+        if (!zk_client_->GetNodeValue(log_path_ + "/" + std::to_string(version), value)) {
+            DLOG(INFO) << "no table change log of version " << version;
+            return false;
+        }
+        Decode(value, table_nodes);
+    }
+    return true;
+}
+
+std::string TableChangeLog::Encode(const std::vector<std::string>& table_nodes) {
+    return boost::algorithm::join(table_nodes, ",");
+}
+
+void TableChangeLog::Decode(const std::string& value, std::set<std::string>* table_nodes) {
+    if (value.empty()) {
+        return;
+    }
+    std::vector<std::string> nodes;
+    boost::split(nodes, value, boost::is_any_of(","));
+    for (auto& node : nodes) {
+        if (!node.empty()) {
+            table_nodes->insert(std::move(node));
+        }
+    }
+}
+
+}  // namespace zk
+}  // namespace openmldb
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_ZK_TABLE_CHANGE_LOG_H_
+#define SRC_ZK_TABLE_CHANGE_LOG_H_
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "zk/zk_client.h"
+
+namespace openmldb {
+namespace zk {
+
+// The change log of the table info in zk. Every version of the table changed
+// notify node may have an entry {log_path}/{version}, the value is the names of
+// table nodes in db_table_data that are created, updated or deleted in the
+// version. A version without entry means the changes are unknown, then the
+// readers have to read all table nodes.
+class TableChangeLog {
+ public:
+    // the entries older than it are deleted
+    static constexpr uint64_t kMaxEntryNum = 1000;
+
+    TableChangeLog(ZkClient* zk_client, const std::string& log_path) : zk_client_(zk_client), log_path_(log_path) {}
+
+    // increment the notify node and write the entry of the new version in one
+    // transaction, then delete the expired entry
+    bool Increment(const std::string& notify_node, const std::vector<std::string>& table_nodes);
+
+    // get the table nodes changed in the versions (from_version, to_version], return
+    // false if any entry is missing
+    bool GetChanges(uint64_t from_version, uint64_t to_version, std::set<std::string>* table_nodes);
+
+    static std::string Encode(const std::vector<std::string>& table_nodes);
+    static void Decode(const std::string& value, std::set<std::string>* table_nodes);
+
+ private:
+    ZkClient* zk_client_;
+    std::string log_path_;
+};
+
+}  // namespace zk
+}  // namespace openmldb
+
+#endif  // SRC_ZK_TABLE_CHANGE_LOG_H_
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "zk/table_change_log.h"
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace openmldb {
+namespace zk {
+
+class TableChangeLogTest : public ::testing::Test {
+ public:
+    TableChangeLogTest() {}
+
+    ~TableChangeLogTest() {}
+};
+
+inline std::string GenRand() { return std::to_string(rand() % 10000000 + 1); }  // NOLINT
+
+TEST_F(TableChangeLogTest, EncodeDecode) {
+    std::set<std::string> nodes;
+    TableChangeLog::Decode(TableChangeLog::Encode({}), &nodes);
+    ASSERT_TRUE(nodes.empty());
+    TableChangeLog::Decode(TableChangeLog::Encode({"1", "20"}), &nodes);
+    TableChangeLog::Decode(TableChangeLog::Encode({"20", "3"}), &nodes);
+    ASSERT_EQ(std::set<std::string>({"1", "20", "3"}), nodes);
+}
+
+TEST_F(TableChangeLogTest, GetChanges) {
+    ZkClient client("127.0.0.1:6181", "", 30000, "127.0.0.1:9527", "/rtidb1");
+    ASSERT_TRUE(client.Init());
+    std::string root = "/rtidb1/test/change_log" + GenRand();
+    std::string notify_node = root + "/notify";
+    ASSERT_TRUE(client.CreateNode(notify_node, "1"));
+    TableChangeLog change_log(&client, root + "/change_log");
+
+    ASSERT_TRUE(change_log.Increment(notify_node, {"1", "2"}));
+    ASSERT_TRUE(change_log.Increment(notify_node, {}));
+    ASSERT_TRUE(change_log.Increment(notify_node, {"2", "3"}));
+    std::string value;
+    ASSERT_TRUE(client.GetNodeValue(notify_node, value));
+    ASSERT_EQ("4", value);
+
+    std::set<std::string> nodes;
+    ASSERT_TRUE(change_log.GetChanges(1, 4, &nodes));
+    ASSERT_EQ(std::set<std::string>({"1", "2", "3"}), nodes);
+    nodes.clear();
+    ASSERT_TRUE(change_log.GetChanges(3, 4, &nodes));
+    ASSERT_EQ(std::set<std::string>({"2", "3"}), nodes);
+    nodes.clear();
+    ASSERT_TRUE(change_log.GetChanges(4, 4, &nodes));
+    ASSERT_TRUE(nodes.empty());
+
+    // the version increased without change log can't be read by delta
+    ASSERT_TRUE(client.Increment(notify_node));
+    ASSERT_FALSE(change_log.GetChanges(3, 5, &nodes));
+    ASSERT_FALSE(change_log.GetChanges(0, 4, &nodes));
+}
+
+}  // namespace zk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -367,6 +367,62 @@ bool ZkClient::DeleteNode(const std::string& node) {
     return false;
 }
 
+bool ZkClient::Multi(const std::vector<ZkOp>& ops) {
+    for (const auto& op : ops) {
+        if (op.node.empty()) {
+            PDLOG(WARNING, "node path is empty");
+            return false;
+        }
+        if (op.type == ZkOpType::kCreate) {
+            size_t pos = op.node.find_last_of('/');
+            if (pos != std::string::npos && pos != op.node.find_first_of('/') && !Mkdir(op.node.substr(0, pos))) {
+                return false;
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    if (zk_ == NULL || !connected_) {
+        return false;
+    }
+    size_t start = 0;
+    while (start < ops.size()) {
+        // keep the request far below the jute.maxbuffer of zookeeper
+        size_t end = start;
+        size_t request_size = 0;
+        while (end < ops.size() && end - start < ZK_MAX_MULTI_OP_NUM &&
+               (end == start || request_size + ops[end].node.size() + ops[end].value.size() < ZK_MAX_BUFFER_SIZE / 2)) {
+            request_size += ops[end].node.size() + ops[end].value.size();
+            end++;
+        }
+        std::vector<zoo_op_t> zoo_ops(end - start);
+        std::vector<zoo_op_result_t> results(end - start);
+        for (size_t i = start; i < end; i++) {
+            const ZkOp& op = ops[i];
+            zoo_op_t* zoo_op = &zoo_ops[i - start];
+            if (op.type == ZkOpType::kCreate) {
+                zoo_create_op_init(zoo_op, op.node.c_str(), op.value.c_str(), op.value.size(), &ZOO_OPEN_ACL_UNSAFE, 0,
+                                   NULL, 0);
+            } else if (op.type == ZkOpType::kSet) {
+                zoo_set_op_init(zoo_op, op.node.c_str(), op.value.c_str(), op.value.size(), op.version, NULL);
+            } else {
+                zoo_delete_op_init(zoo_op, op.node.c_str(), op.version);
+            }
+        }
+        int ret = zoo_multi(zk_, zoo_ops.size(), zoo_ops.data(), results.data());
+        if (ret != ZOK) {
+            for (size_t i = 0; i < results.size(); i++) {
+                if (results[i].err != ZOK && results[i].err != ZRUNTIMEINCONSISTENCY) {
+                    PDLOG(WARNING, "fail to write node %s with errno %d", ops[start + i].node.c_str(), results[i].err);
+                }
+            }
+            PDLOG(WARNING, "multi request failed with errno %d. op num %lu", ret, zoo_ops.size());
+            return false;
+        }
+        start = end;
+    }
+    return true;
+}
+
 bool ZkClient::GetNodeValue(const std::string& node, std::string& value) {
     std::lock_guard<std::mutex> lock(mu_);
     return GetNodeValueUnLocked(node, value);
@@ -384,6 +440,11 @@ bool ZkClient::SetNodeValue(const std::string& node, const std::string& value) {
 }
 
 bool ZkClient::Increment(const std::string& node) {
+    uint64_t new_number = 0;
+    return Increment(node, &new_number);
+}
+
+bool ZkClient::Increment(const std::string& node, uint64_t* new_number) {
     int try_num = 3;
     while (try_num-- > 0) {
         std::string value;
@@ -403,6 +464,7 @@ bool ZkClient::Increment(const std::string& node) {
         }
         std::string new_value = std::to_string(number + 1);
         if (zoo_set(zk_, node.c_str(), new_value.c_str(), new_value.length(), stat.version) == ZOK) {
+            *new_number = number + 1;
             return true;
         }
         PDLOG(INFO, "retry increment %s", node);
@@ -39,6 +39,19 @@ typedef boost::function<void(void)> ItemChangedCallback;
 
 const uint32_t ZK_MAX_BUFFER_SIZE = 1024 * 1024;
 
+const uint32_t ZK_MAX_MULTI_OP_NUM = 128;
+
+enum class ZkOpType { kCreate, kSet, kDelete };
+
+// one write of a multi request
+struct ZkOp {
+    ZkOpType type;
+    std::string node;
+    std::string value;
+    // the expected version of node for set and delete, -1 matches any version
+    int32_t version = -1;
+};
+
 class ZkClient {
  public:
     // hosts , the zookeeper server lists eg host1:2181,host2:2181
@@ -95,6 +108,9 @@ class ZkClient {
 
     bool Increment(const std::string& node);
 
+    // increment the number in node and get the new number
+    bool Increment(const std::string& node, uint64_t* new_number);
+
     bool WatchChildren(const std::string& node, NodesChangedCallback callback);
 
     void CancelWatchChildren(const std::string& node);
@@ -103,6 +119,11 @@ class ZkClient {
 
     bool DeleteNode(const std::string& node);
 
+    // write the ops with zookeeper multi requests. the ops are split into several
+    // requests if they are too many or too large, each request is atomic but the
+    // whole batch is not. the parent of a node to create will be created if not exist
+    bool Multi(const std::vector<ZkOp>& ops);
+
     // create a persistence node
     bool CreateNode(const std::string& node, const std::string& value);
 
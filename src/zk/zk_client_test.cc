@@ -146,6 +146,38 @@ TEST_F(ZkClientTest, ZkNodeChange) {
     ASSERT_TRUE(detect.load());
 }
 
+TEST_F(ZkClientTest, Multi) {
+    ZkClient client("127.0.0.1:6181", "", session_timeout, "127.0.0.1:9527", "/rtidb1");
+    bool ok = client.Init();
+    ASSERT_TRUE(ok);
+
+    std::string dir = "/rtidb1/test/multi" + GenRand();
+    std::vector<ZkOp> ops;
+    // more ops than one multi request holds
+    for (uint32_t i = 0; i < ZK_MAX_MULTI_OP_NUM + 10; i++) {
+        ops.push_back({ZkOpType::kCreate, dir + "/node" + std::to_string(i), "1"});
+    }
+    ASSERT_TRUE(client.Multi(ops));
+    for (auto& op : ops) {
+        op.type = ZkOpType::kSet;
+        op.value = "2";
+    }
+    ASSERT_TRUE(client.Multi(ops));
+    for (const auto& op : ops) {
+        std::string value;
+        ASSERT_TRUE(client.GetNodeValue(op.node, value));
+        ASSERT_EQ("2", value);
+    }
+    ops[0].type = ZkOpType::kDelete;
+    ops[1].type = ZkOpType::kDelete;
+    ASSERT_TRUE(client.Multi({ops[0], ops[1]}));
+    ASSERT_EQ(1, client.IsExistNode(ops[0].node));
+    // the request fails as a whole
+    ops[2].type = ZkOpType::kDelete;
+    ASSERT_FALSE(client.Multi({ops[2], ops[1]}));
+    ASSERT_EQ(0, client.IsExistNode(ops[2].node));
+}
+
 }  // namespace zk
 }  // namespace openmldb
 